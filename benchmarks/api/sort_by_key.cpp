@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * benchmarks/api/sort_by_key.cpp
+ *
+ * Benchmark Sort() with a comparator against radix sorting SortByKey() on
+ * TeraSort-like 100 byte records with 10 byte keys, or on 64-bit integers.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sort.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <tlx/cmdline_parser.hpp>
+
+#include <array>
+#include <random>
+#include <string>
+#include <utility>
+
+using namespace thrill; // NOLINT
+
+struct Record {
+    std::array<uint8_t, 10> key;
+    std::array<uint8_t, 90> value;
+};
+
+static_assert(sizeof(Record) == 100, "struct Record packing incorrect.");
+
+int main(int argc, char* argv[]) {
+
+    tlx::CmdlineParser clp;
+
+    int iterations = 1;
+    clp.add_int('n', "iterations", iterations, "Iterations, default: 1");
+
+    bool comparison = false;
+    clp.add_bool('c', "comparison", comparison,
+                 "use comparison Sort() instead of SortByKey()");
+
+    bool integers = false;
+    clp.add_bool('i', "integers", integers,
+                 "sort 64-bit integers instead of 100 byte records");
+
+    uint64_t size;
+    clp.add_param_bytes("size", size,
+                        "Amount of data to sort (example: 1 GiB).");
+
+    if (!clp.process(argc, argv)) {
+        return -1;
+    }
+
+    clp.print_result();
+
+    api::Run(
+        [&](api::Context& ctx) {
+            for (int i = 0; i < iterations; i++) {
+                std::default_random_engine rng(std::random_device { } ());
+
+                common::StatsTimerStart timer;
+                size_t result;
+
+                if (integers) {
+                    auto input = api::Generate(
+                        ctx, size / sizeof(uint64_t),
+                        [&rng](size_t) -> uint64_t {
+                            return (static_cast<uint64_t>(rng()) << 32) ^ rng();
+                        });
+
+                    if (comparison) {
+                        result = input.Sort().Size();
+                    }
+                    else {
+                        result = input.SortByKey(
+                            [](const uint64_t& x) { return x; }).Size();
+                    }
+                }
+                else {
+                    auto input = api::Generate(
+                        ctx, size / sizeof(Record),
+                        [&rng](size_t index) -> Record {
+                            Record r;
+                            for (size_t k = 0; k < r.key.size(); ++k)
+                                r.key[k] = static_cast<uint8_t>(rng());
+                            r.value.fill(static_cast<uint8_t>(index));
+                            return r;
+                        });
+
+                    if (comparison) {
+                        result = input.Sort(
+                            [](const Record& a, const Record& b) {
+                                return a.key < b.key;
+                            }).Size();
+                    }
+                    else {
+                        result = input.SortByKey(
+                            [](const Record& r) { return r.key; }).Size();
+                    }
+                }
+
+                timer.Stop();
+                if (!ctx.my_rank()) {
+                    LOG1 << "ITERATION " << i << " RESULT"
+                         << " benchmark=sort_by_key"
+                         << " comparison=" << comparison
+                         << " integers=" << integers
+                         << " size=" << result
+                         << " time=" << timer;
+                }
+            }
+        });
+}
+
+/******************************************************************************/
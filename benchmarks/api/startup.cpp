@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * benchmarks/api/startup.cpp
+ *
+ * Startup and small job latency: time from launching a Thrill job to entering
+ * the job function, to finishing its first Stage, and to the end of the job,
+ * for trivial Generate + Size jobs.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/context.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/logger.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+using Clock = std::chrono::steady_clock;
+
+//! seconds since a time point
+static double SecondsSince(const Clock::time_point& tp) {
+    return std::chrono::duration<double>(Clock::now() - tp).count();
+}
+
+//! measurements of one job, filled by the worker with rank 0
+struct JobTimes {
+    //! time from launch until the last worker entered the job
+    double start = 0;
+    //! time from launch until the first Stage finished
+    double first_stage = 0;
+    //! average time of the following Stages
+    double stage = 0;
+    //! number of hosts and workers
+    size_t hosts = 0, workers = 0;
+};
+
+//! the trivial job: Generate + Size Stages
+static void Job(api::Context& ctx, const Clock::time_point& launch,
+                size_t size, size_t stages, JobTimes* times) {
+
+    double start = ctx.net.AllReduce(
+        SecondsSince(launch), common::maximum<double>());
+
+    die_unequal(Generate(ctx, size).Size(), size);
+    double first_stage = SecondsSince(launch);
+
+    Clock::time_point stages_begin = Clock::now();
+    for (size_t s = 0; s < stages; ++s)
+        die_unequal(Generate(ctx, size).Size(), size);
+    double stage = stages ? SecondsSince(stages_begin) / stages : 0.0;
+
+    if (ctx.my_rank() == 0) {
+        times->start = start;
+        times->first_stage = first_stage;
+        times->stage = stage;
+        times->hosts = ctx.num_hosts();
+        times->workers = ctx.num_workers();
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    tlx::CmdlineParser clp;
+
+    clp.set_description(
+        "Startup and small job latency of trivial Generate + Size jobs. "
+        "Without -H the job runs on the network backend selected by "
+        "THRILL_NET, such that each job is one launch of the program. With -H "
+        "the jobs run on in-process loopback networks of the listed host "
+        "counts.");
+
+    std::string host_list;
+    clp.add_string('H', "hosts", host_list,
+                   "comma separated list of host counts of local loopback "
+                   "jobs, default: run on THRILL_NET");
+
+    unsigned workers_per_host = 1;
+    clp.add_unsigned('w', "workers", workers_per_host,
+                     "workers per host of local loopback jobs, default: 1");
+
+    unsigned repeats = 1;
+    clp.add_unsigned('r', "repeats", repeats,
+                     "jobs launched per host count, default: 1");
+
+    unsigned stages = 10;
+    clp.add_unsigned('s', "stages", stages,
+                     "Stages after the first one, default: 10");
+
+    uint64_t size = 1000;
+    clp.add_bytes('n', "size", size,
+                  "items generated in each Stage, default: 1000");
+
+    if (!clp.process(argc, argv)) {
+        return -1;
+    }
+
+    const char* env_net = getenv("THRILL_NET");
+    std::string backend =
+        !host_list.empty() ? "local" : env_net ? env_net : "auto";
+
+    std::vector<std::string> hosts_list = tlx::split(',', host_list);
+    if (hosts_list.empty()) hosts_list.emplace_back("");
+
+    for (const std::string& hosts : hosts_list) {
+        for (size_t r = 0; r < repeats; ++r) {
+            JobTimes times;
+            Clock::time_point launch = Clock::now();
+
+            auto job = [&](api::Context& ctx) {
+                           Job(ctx, launch, size, stages, &times);
+                       };
+
+            if (hosts.empty()) {
+                if (api::Run(job) != 0) return -1;
+            }
+            else {
+                api::MemoryConfig mem_config;
+                mem_config.verbose_ = false;
+                mem_config.enable_proc_profiler_ = false;
+                mem_config.setup(4 * 1024 * 1024 * 1024llu);
+
+                api::RunLocalMock(mem_config, std::stoul(hosts),
+                                  workers_per_host, job);
+            }
+
+            double total = SecondsSince(launch);
+
+            // only the process of the worker with rank 0 has measurements
+            if (times.hosts == 0) continue;
+
+            std::cout
+                << "RESULT"
+                << " benchmark=startup"
+                << " backend=" << backend
+                << " hosts=" << times.hosts
+                << " workers=" << times.workers
+                << " size=" << size
+                << " start_time=" << times.start
+                << " first_stage_time=" << times.first_stage
+                << " stage_time=" << times.stage
+                << " time=" << total
+                << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -12,6 +12,7 @@
 #include <thrill/common/math.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/core/golomb_bit_stream.hpp>
+#include <thrill/core/rice_bit_stream.hpp>
 #include <thrill/data/file.hpp>
 #include <tlx/cmdline_parser.hpp>
 #include <tlx/die.hpp>
@@ -19,28 +20,15 @@
 #include <cmath>
 #include <iostream>
 #include <random>
+#include <string>
 
 using namespace thrill; // NOLINT
 
-int main(int argc, char* argv[]) {
-
-    size_t golomb_param = 5;
-    size_t num_elements = 1;
-    size_t average_distance = 10;
-
-    tlx::CmdlineParser clp;
-
-    clp.add_size_t('g', "golomb_param", golomb_param,
-                   "Set Golomb Parameter, default: 5");
-
-    clp.add_size_t('n', "elements", num_elements,
-                   "Set the number of elements");
-
-    clp.add_size_t('d', "avg_dist", average_distance,
-                   "Average distance between numbers, default: 10");
-
-    if (!clp.process(argc, argv))
-        return -1;
+//! encode and decode num_elements random values with the Writer and Reader
+//! coder and print the bytes and times.
+template <template <typename> class Writer, template <typename> class Reader>
+void RunBenchmark(const char* name, size_t param,
+                  size_t num_elements, size_t average_distance) {
 
     data::BlockPool block_pool_;
     data::File file(block_pool_, 0, /* dia_id */ 0);
@@ -51,7 +39,7 @@ int main(int argc, char* argv[]) {
 
     {
         data::File::Writer fw = file.GetWriter(16);
-        core::GolombBitStreamWriter<data::File::Writer> gbsw(fw, golomb_param);
+        Writer<data::File::Writer> bsw(fw, param);
 
         std::default_random_engine generator(seed);
         std::uniform_int_distribution<size_t> distribution(
@@ -60,7 +48,7 @@ int main(int argc, char* argv[]) {
         write_timer.Start();
 
         for (size_t i = 0; i < num_elements; ++i) {
-            gbsw.PutGolomb(distribution(generator));
+            bsw.Put(distribution(generator));
         }
 
         write_timer.Stop();
@@ -70,7 +58,7 @@ int main(int argc, char* argv[]) {
 
     {
         data::File::Reader fr = file.GetReader(/* consume */ true);
-        core::GolombBitStreamReader<data::File::Reader> gbsr(fr, golomb_param);
+        Reader<data::File::Reader> bsr(fr, param);
 
         std::default_random_engine generator(seed);
         std::uniform_int_distribution<size_t> distribution(
@@ -79,7 +67,8 @@ int main(int argc, char* argv[]) {
         read_timer.Start();
 
         for (size_t i = 0; i < num_elements; ++i) {
-            size_t a = distribution(generator), b = gbsr.GetGolomb();
+            size_t a = distribution(generator),
+                b = bsr.template Next<size_t>();
             die_unequal(a, b);
         }
 
@@ -88,14 +77,51 @@ int main(int argc, char* argv[]) {
 
     std::cout
         << "RESULT"
-        << " benchmark=golomb"
+        << " benchmark=" << name
         << " write_timer=" << write_timer
         << " read_timer=" << read_timer
         << " size=" << file_size
+        << " bits_per_element="
+        << static_cast<double>(file_size * 8) / static_cast<double>(num_elements)
         << " num_elements=" << num_elements
         << " average_distance=" << average_distance
-        << " golomb_param=" << golomb_param
+        << " param=" << param
         << std::endl;
 }
 
+int main(int argc, char* argv[]) {
+
+    size_t golomb_param = 5;
+    size_t num_elements = 1;
+    size_t average_distance = 10;
+    std::string coder = "all";
+
+    tlx::CmdlineParser clp;
+
+    clp.add_size_t('g', "golomb_param", golomb_param,
+                   "Set Golomb Parameter, default: 5");
+
+    clp.add_size_t('n', "elements", num_elements,
+                   "Set the number of elements");
+
+    clp.add_size_t('d', "avg_dist", average_distance,
+                   "Average distance between numbers, default: 10");
+
+    clp.add_string('c', "coder", coder,
+                   "Coder to run: golomb, rice, or all (default)");
+
+    if (!clp.process(argc, argv))
+        return -1;
+
+    if (coder == "golomb" || coder == "all") {
+        RunBenchmark<core::GolombBitStreamWriter, core::GolombBitStreamReader>(
+            "golomb", golomb_param, num_elements, average_distance);
+    }
+    if (coder == "rice" || coder == "all") {
+        // the Rice parameter is the mean value, as estimated by RiceCoder
+        RunBenchmark<core::RiceBitStreamWriter, core::RiceBitStreamReader>(
+            "rice", average_distance, num_elements, average_distance);
+    }
+}
+
 /******************************************************************************/
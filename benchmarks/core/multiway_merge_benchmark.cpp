@@ -0,0 +1,424 @@
+/*******************************************************************************
+ * benchmarks/core/multiway_merge_benchmark.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/key_prefix.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/core/buffered_multiway_merge.hpp>
+#include <thrill/core/multiway_merge.hpp>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/file.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
+#include <tlx/unused.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+using common::StatsTimerStart;
+
+/******************************************************************************/
+// Item Types: construction from a 64-bit key, and the key compared
+
+//! 64-byte item with a key and a payload, like the records of TeraSort
+using PairItem = std::pair<uint64_t, std::array<uint64_t, 7> >;
+
+template <typename Type>
+struct ItemTraits;
+
+template <>
+struct ItemTraits<uint64_t> {
+    using Key = uint64_t;
+    static uint64_t Make(uint64_t key, size_t) { return key; }
+    static const Key& GetKey(const uint64_t& v) { return v; }
+    static size_t Size(const uint64_t&) { return sizeof(uint64_t); }
+};
+
+template <>
+struct ItemTraits<PairItem> {
+    using Key = uint64_t;
+    static PairItem Make(uint64_t key, size_t) {
+        PairItem p;
+        p.first = key;
+        p.second.fill(key);
+        return p;
+    }
+    static const Key& GetKey(const PairItem& v) { return v.first; }
+    static size_t Size(const PairItem&) { return sizeof(PairItem); }
+};
+
+template <>
+struct ItemTraits<std::string> {
+    using Key = std::string;
+    //! the key in 16 hex digits padded to length, such that the order of the
+    //! strings is that of the keys, and equal keys have long common prefixes.
+    static std::string Make(uint64_t key, size_t length) {
+        static const char digits[] = "0123456789abcdef";
+        std::string s(std::max<size_t>(length, 16), 'x');
+        for (size_t i = 0; i < 16; ++i)
+            s[i] = digits[(key >> (60 - 4 * i)) & 0xF];
+        return s;
+    }
+    static const Key& GetKey(const std::string& v) { return v; }
+    static size_t Size(const std::string& v) { return v.size(); }
+};
+
+/******************************************************************************/
+
+class MultiwayMergeExperiment
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.set_description(
+            "thrill::core multiway merge benchmark: merges sorted Files with "
+            "the merge trees used by Sort, Merge, GroupByKey, and InnerJoin, "
+            "for all combinations of fan-in, item type, key distribution, "
+            "reader, and tree, and prints one RESULT line for each.");
+
+        clp.add_bytes('b', "bytes", bytes_,
+                      "total bytes of the merged Files (default 256 MiB)");
+
+        clp.add_string('k', "fanins", fanins_,
+                       "comma separated fan-ins, the number of merged Files, "
+                       "default: 2,4,8,16,32,64,128,256");
+
+        clp.add_string('i', "items", items_,
+                       "comma separated item types: uint64 (8 bytes), pair "
+                       "(64-byte items with a uint64 key), string (hex key "
+                       "padded to a random length), default: uint64,pair,"
+                       "string");
+
+        clp.add_string('d', "dists", dists_,
+                       "comma separated key distributions: uniform (random "
+                       "keys), duplicates (16 distinct keys), disjoint (each "
+                       "File holds a key range, the merge takes long runs), "
+                       "skewed (File i holds 1/2^(i+1) of the items), "
+                       "default: uniform,duplicates,disjoint,skewed");
+
+        clp.add_string('r', "readers", readers_,
+                       "comma separated File readers: keep, consume, swapped "
+                       "(consume Files evicted to external memory), "
+                       "default: keep,consume,swapped");
+
+        clp.add_string('t', "trees", trees_,
+                       "comma separated merge trees: plain, stable, buffered, "
+                       "prefix (caching 64-bit key prefixes), "
+                       "default: plain,stable,buffered,prefix");
+
+        clp.add_bytes('s', "soft_ram", soft_ram_,
+                      "soft RAM limit of the BlockPool of swapped readers "
+                      "(default 16 MiB)");
+
+        clp.add_bytes('p', "prefetch", prefetch_,
+                      "prefetch size of each reader (default: File default)");
+
+        clp.add_bytes('l', "lower", min_size_,
+                      "lower bound of string lengths (default 16)");
+
+        clp.add_bytes('u', "upper", max_size_,
+                      "upper bound of string lengths (default 64)");
+
+        clp.add_bool('c', "check", check_,
+                     "verify that the merged items are sorted");
+
+        clp.add_unsigned(
+            'n', "iterations", iterations_, "Iterations (default: 1)");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        for (const std::string& item : tlx::split(',', items_)) {
+            if (item == "uint64")
+                RunItems<uint64_t>(item);
+            else if (item == "pair")
+                RunItems<PairItem>(item);
+            else if (item == "string")
+                RunItems<std::string>(item);
+            else
+                die("Unknown item type " << item);
+        }
+
+        return 0;
+    }
+
+private:
+    //! total bytes of the merged Files
+    uint64_t bytes_ = 256 * 1024 * 1024;
+
+    //! soft RAM limit of the BlockPool of swapped readers, the hard limit is
+    //! twice as large
+    uint64_t soft_ram_ = 16 * 1024 * 1024;
+
+    //! prefetch size of each reader
+    uint64_t prefetch_ = data::File::default_prefetch_size_;
+
+    //! bounds of string lengths
+    uint64_t min_size_ = 16;
+    uint64_t max_size_ = 64;
+
+    //! verify the order of the merged items
+    bool check_ = false;
+
+    //! repetitions of each test
+    unsigned iterations_ = 1;
+
+    //! comma separated parameter lists
+    std::string fanins_ = "2,4,8,16,32,64,128,256";
+    std::string items_ = "uint64,pair,string";
+    std::string dists_ = "uniform,duplicates,disjoint,skewed";
+    std::string readers_ = "keep,consume,swapped";
+    std::string trees_ = "plain,stable,buffered,prefix";
+
+    template <typename ValueType>
+    void RunItems(const std::string& item) {
+        for (const std::string& k : tlx::split(',', fanins_)) {
+            size_t fanin = std::stoul(k);
+            die_unless(fanin >= 1);
+            for (const std::string& dist : tlx::split(',', dists_)) {
+                for (const std::string& reader : tlx::split(',', readers_)) {
+                    for (const std::string& tree : tlx::split(',', trees_)) {
+                        for (unsigned i = 0; i < iterations_; ++i) {
+                            Test<ValueType>(item, fanin, dist, reader, tree);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //! number of items in each of the fanin Files
+    std::vector<size_t> FileSizes(
+        size_t num_items, size_t fanin, const std::string& dist) const {
+        std::vector<size_t> sizes(fanin, num_items / fanin);
+        if (dist == "skewed") {
+            size_t rest = num_items;
+            for (size_t i = 0; i + 1 < fanin; ++i) {
+                sizes[i] = rest / 2;
+                rest -= sizes[i];
+            }
+            sizes[fanin - 1] = rest;
+        }
+        return sizes;
+    }
+
+    //! generate the sorted keys of File i
+    std::vector<uint64_t> GenerateKeys(
+        size_t i, size_t size, const std::string& dist) const {
+        std::default_random_engine rng(i);
+        std::vector<uint64_t> keys(size);
+        if (dist == "uniform" || dist == "skewed") {
+            for (uint64_t& k : keys) k = rng();
+            std::sort(keys.begin(), keys.end());
+        }
+        else if (dist == "duplicates") {
+            for (uint64_t& k : keys) k = rng() % 16;
+            std::sort(keys.begin(), keys.end());
+        }
+        else if (dist == "disjoint") {
+            for (size_t j = 0; j < size; ++j)
+                keys[j] = (static_cast<uint64_t>(i) << 40) + j;
+        }
+        else {
+            die("Unknown key distribution " << dist);
+        }
+        return keys;
+    }
+
+    //! write the sorted Files, returns the number of items and bytes
+    template <typename ValueType>
+    std::pair<size_t, size_t> WriteFiles(
+        data::BlockPool& block_pool, std::vector<data::File>& files,
+        size_t fanin, const std::string& dist) const {
+        using Traits = ItemTraits<ValueType>;
+
+        std::default_random_engine rng(fanin);
+        std::uniform_int_distribution<size_t> length(min_size_, max_size_);
+
+        size_t item_size = Traits::Size(
+            Traits::Make(0, (min_size_ + max_size_) / 2));
+        std::vector<size_t> sizes = FileSizes(
+            std::max<size_t>(bytes_ / item_size, fanin), fanin, dist);
+
+        size_t num_items = 0, num_bytes = 0;
+        files.reserve(fanin);
+        for (size_t i = 0; i < fanin; ++i) {
+            files.emplace_back(block_pool, 0, /* dia_id */ 0);
+            data::File::Writer writer = files.back().GetWriter();
+            for (const uint64_t& key : GenerateKeys(i, sizes[i], dist)) {
+                ValueType v = Traits::Make(key, length(rng));
+                num_bytes += Traits::Size(v);
+                writer.Put(v);
+            }
+            num_items += sizes[i];
+        }
+        return std::make_pair(num_items, num_bytes);
+    }
+
+    //! pull all items from a merge tree with Next(), returns the item count
+    template <typename ValueType, typename Tree, typename Comparator>
+    size_t PullAll(Tree& tree, const Comparator& comp) const {
+        size_t count = 0;
+        if (check_) {
+            ValueType prev = tree.Next();
+            ++count;
+            while (tree.HasNext()) {
+                ValueType v = tree.Next();
+                die_if(comp(v, prev));
+                prev = std::move(v);
+                ++count;
+            }
+        }
+        else {
+            while (tree.HasNext()) {
+                ValueType v = tree.Next();
+                tlx::unused(v);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    //! pull all items from a BufferedMultiwayMergeTree with Top() and Update()
+    template <typename ValueType, typename Tree, typename Comparator>
+    size_t PullAllBuffered(Tree& tree, const Comparator& comp) const {
+        size_t count = 0;
+        if (!tree.HasNext()) return count;
+        ValueType prev = tree.Top();
+        do {
+            const ValueType& v = tree.Top();
+            if (check_) {
+                die_if(comp(v, prev));
+                prev = v;
+            }
+            ++count;
+        } while (tree.Update());
+        return count;
+    }
+
+    template <typename ValueType>
+    size_t Merge(std::vector<data::File::Reader>& readers,
+                 const std::string& tree) const {
+        using Traits = ItemTraits<ValueType>;
+        using Key = typename Traits::Key;
+
+        auto comp = [](const ValueType& a, const ValueType& b) {
+                        return Traits::GetKey(a) < Traits::GetKey(b);
+                    };
+
+        if (readers.empty()) return 0;
+
+        if (tree == "plain") {
+            auto t = core::make_multiway_merge_tree<ValueType>(
+                readers.begin(), readers.end(), comp);
+            return PullAll<ValueType>(t, comp);
+        }
+        else if (tree == "stable") {
+            auto t = core::make_stable_multiway_merge_tree<ValueType>(
+                readers.begin(), readers.end(), comp);
+            return PullAll<ValueType>(t, comp);
+        }
+        else if (tree == "buffered") {
+            auto t = core::make_buffered_multiway_merge_tree<ValueType>(
+                readers.begin(), readers.end(), comp);
+            return PullAllBuffered<ValueType>(t, comp);
+        }
+        else if (tree == "prefix") {
+            auto t = core::make_prefix_multiway_merge_tree<
+                ValueType, /* Stable */ false,
+                common::KeyPrefixTraits<Key>::is_exact>(
+                readers.begin(), readers.end(), comp,
+                [](const ValueType& v) {
+                    return common::KeyPrefixTraits<Key>::prefix(
+                        Traits::GetKey(v));
+                });
+            return PullAll<ValueType>(t, comp);
+        }
+        die("Unknown merge tree " << tree);
+        return 0;
+    }
+
+    template <typename ValueType>
+    void Test(const std::string& item, size_t fanin, const std::string& dist,
+              const std::string& reader, const std::string& tree) {
+
+        if (reader != "keep" && reader != "consume" && reader != "swapped")
+            die("Unknown reader " << reader);
+
+        bool swapped = (reader == "swapped");
+
+        // swapped Files are written into a BlockPool with a low RAM limit,
+        // and the remaining unpinned Blocks are evicted before merging.
+        std::unique_ptr<data::BlockPool> block_pool =
+            swapped
+            ? std::make_unique<data::BlockPool>(
+                soft_ram_, 2 * soft_ram_, /* logger */ nullptr,
+                /* mem_manager */ nullptr, /* workers_per_host */ 1)
+            : std::make_unique<data::BlockPool>();
+
+        std::vector<data::File> files;
+        size_t num_items, num_bytes;
+        std::tie(num_items, num_bytes) =
+            WriteFiles<ValueType>(*block_pool, files, fanin, dist);
+
+        if (swapped) {
+            while (foxxll::request_ptr req = block_pool->EvictUnpinnedBlock())
+                req->wait();
+        }
+        size_t swapped_blocks = block_pool->swapped_blocks();
+
+        StatsTimerStart timer;
+
+        std::vector<data::File::Reader> readers;
+        readers.reserve(fanin);
+        for (data::File& file : files)
+            readers.emplace_back(file.GetReader(reader != "keep", prefetch_));
+
+        size_t count = Merge<ValueType>(readers, tree);
+
+        timer.Stop();
+
+        die_unequal(count, num_items);
+
+        double seconds = timer.SecondsDouble();
+        LOG1 << "RESULT"
+             << " experiment=" << "multiway_merge"
+             << " tree=" << tree
+             << " item=" << item
+             << " dist=" << dist
+             << " reader=" << reader
+             << " fanin=" << fanin
+             << " items=" << num_items
+             << " bytes=" << num_bytes
+             << " block_size=" << data::default_block_size
+             << " prefetch=" << prefetch_
+             << " swapped_blocks=" << swapped_blocks
+             << " time=" << seconds
+             << " ns_per_item=" << seconds * 1e9 / num_items
+             << " items_per_sec=" << num_items / seconds
+             << " MiBs=" << num_bytes / seconds / 1024.0 / 1024.0;
+    }
+};
+
+/******************************************************************************/
+
+int main(int argc, char* argv[]) {
+    return MultiwayMergeExperiment().Run(argc, argv);
+}
+
+/******************************************************************************/
@@ -11,17 +11,27 @@
 
 #include <thrill/api/context.hpp>
 #include <thrill/common/aggregate.hpp>
+#include <thrill/common/functional.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/matrix.hpp>
+#include <thrill/common/porting.hpp>
 #include <thrill/common/stats_timer.hpp>
+#include <thrill/data/block_pool.hpp>
 #include <thrill/data/block_queue.hpp>
+#include <thrill/data/file.hpp>
 #include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
 #include <tlx/thread_pool.hpp>
 
 #include <algorithm>
+#include <array>
+#include <ctime>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -922,6 +932,425 @@ private:
     std::string reader_type_;
 };
 
+/******************************************************************************/
+//! All-to-all shuffle of fixed-size items: each worker writes its items
+//! round-robin to all workers while a second thread reads its stream. The items
+//! are not generated, such that the Multiplexer and StreamSink costs dominate.
+//! The block size is set by THRILL_BLOCK_SIZE.
+
+//! fixed-size POD item of the ShuffleExperiment
+template <size_t Size>
+struct ShuffleItem {
+    std::array<uint8_t, Size> data;
+};
+
+class ShuffleExperiment
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.set_description(
+            "thrill::data all-to-all shuffle benchmark, reports aggregate "
+            "bandwidth and CPU time per GB. Set the block size with "
+            "THRILL_BLOCK_SIZE and the workers per host with "
+            "THRILL_WORKERS_PER_HOST.");
+
+        clp.add_bytes('b', "bytes", bytes_,
+                      "number of bytes sent by each worker (default 64 MiB)");
+
+        clp.add_string('i', "item_sizes", item_sizes_,
+                       "comma separated item sizes in bytes: 8, 16, 64, 256, "
+                       "1024, 4096 (default 8,64,1024)");
+
+        clp.add_string('t', "streams", streams_,
+                       "comma separated stream types: cat, mix "
+                       "(default cat,mix)");
+
+        clp.add_unsigned(
+            'n', "iterations", iterations_, "Iterations (default: 1)");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        api::Run(
+            [=](api::Context& ctx) {
+                // make a copy of this for local workers
+                ShuffleExperiment local = *this;
+
+                for (const std::string& stream : tlx::split(',', streams_)) {
+                    for (const std::string& size :
+                         tlx::split(',', item_sizes_)) {
+                        if (stream == "cat")
+                            local.TestSize<data::CatStream>(
+                                ctx, stream, std::stoul(size));
+                        else if (stream == "mix")
+                            local.TestSize<data::MixStream>(
+                                ctx, stream, std::stoul(size));
+                        else
+                            die("Unknown stream type " << stream);
+                    }
+                }
+            });
+
+        return 0;
+    }
+
+    template <typename Stream>
+    void TestSize(api::Context& ctx, const std::string& stream, size_t size) {
+        switch (size) {
+        case 8:
+            return Test<Stream, 8>(ctx, stream);
+        case 16:
+            return Test<Stream, 16>(ctx, stream);
+        case 64:
+            return Test<Stream, 64>(ctx, stream);
+        case 256:
+            return Test<Stream, 256>(ctx, stream);
+        case 1024:
+            return Test<Stream, 1024>(ctx, stream);
+        case 4096:
+            return Test<Stream, 4096>(ctx, stream);
+        default:
+            die("Unsupported item size " << size);
+        }
+    }
+
+    template <typename Stream, size_t Size>
+    void Test(api::Context& ctx, const std::string& stream_name) {
+
+        using Item = ShuffleItem<Size>;
+        Item item;
+        item.data.fill(0x42);
+
+        size_t num_workers = ctx.num_workers();
+        size_t num_items = bytes_ / Size;
+
+        for (unsigned i = 0; i < iterations_; i++) {
+
+            auto stream = ctx.GetNewStream<Stream>(/* dia_id */ 0);
+            ctx.net.Barrier();
+
+            // process CPU time of all threads of the host
+            std::clock_t cpu_start = std::clock();
+            StatsTimerStart timer;
+
+            size_t received = 0;
+            std::thread reader_thread = common::CreateThread(
+                [&]() {
+                    auto reader = stream->GetReader(/* consume */ true);
+                    while (reader.HasNext()) {
+                        reader.template Next<Item>();
+                        ++received;
+                    }
+                });
+
+            auto writers = stream->GetWriters();
+            for (size_t j = 0; j < num_items; ++j)
+                writers[j % num_workers].Put(item);
+            writers.Close();
+
+            reader_thread.join();
+            timer.Stop();
+
+            ctx.net.Barrier();
+            double cpu = static_cast<double>(std::clock() - cpu_start)
+                         / CLOCKS_PER_SEC;
+            stream.reset();
+
+            // count the CPU time of each host once
+            double host_cpu = ctx.local_worker_id() == 0 ? cpu : 0.0;
+
+            size_t total_received = ctx.net.AllReduce(received);
+            die_unequal(total_received, num_items * num_workers);
+
+            double time = ctx.net.AllReduce(
+                timer.SecondsDouble(), common::maximum<double>());
+            double total_cpu = ctx.net.AllReduce(host_cpu);
+            size_t total_bytes = num_items * Size * num_workers;
+
+            if (ctx.my_rank() != 0) continue;
+
+            LOG1 << "RESULT"
+                 << " experiment=" << "shuffle"
+                 << " stream=" << stream_name
+                 << " hosts=" << ctx.num_hosts()
+                 << " workers=" << num_workers
+                 << " workers_per_host=" << ctx.workers_per_host()
+                 << " item_size=" << Size
+                 << " block_size=" << data::default_block_size
+                 << " bytes=" << total_bytes
+                 << " time=" << time
+                 << " bandwidth_MiBs="
+                 << static_cast<double>(total_bytes) / 1024.0 / 1024.0 / time
+                 << " host_bandwidth_MiBs="
+                 << static_cast<double>(total_bytes) / 1024.0 / 1024.0 / time
+                    / static_cast<double>(ctx.num_hosts())
+                 << " cpu_time=" << total_cpu
+                 << " cpu_s_per_GB="
+                 << total_cpu / (static_cast<double>(total_bytes) / 1e9);
+        }
+    }
+
+private:
+    //! number of bytes sent by each worker
+    uint64_t bytes_ = 64 * 1024 * 1024;
+
+    //! comma separated item sizes
+    std::string item_sizes_ = "8,64,1024";
+
+    //! comma separated stream types
+    std::string streams_ = "cat,mix";
+
+    //! number of iterations to run
+    unsigned iterations_ = 1;
+};
+
+/******************************************************************************/
+//! BlockPool and External Memory Stress Test
+
+class BlockPoolExperiment
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.set_description(
+            "thrill::data BlockPool stress benchmark: writes Files beyond the "
+            "soft and hard RAM limits and reads them back with an access "
+            "pattern, reports eviction throughput, pin latencies, and the "
+            "bandwidth of reads from external memory.");
+
+        clp.add_bytes('b', "bytes", bytes_,
+                      "total bytes written into Files (default 1 GiB)");
+
+        clp.add_bytes('s', "soft_ram", soft_ram_,
+                      "soft RAM limit of the BlockPool (default 64 MiB)");
+
+        clp.add_bytes('r', "hard_ram", hard_ram_,
+                      "hard RAM limit of the BlockPool (default 128 MiB)");
+
+        clp.add_string('p', "patterns", patterns_,
+                       "comma separated access patterns: sequential (replay "
+                       "all Files), random (pin random Blocks), concurrent "
+                       "(threads write and replay their own Files), "
+                       "default: sequential,random,concurrent");
+
+        clp.add_unsigned('f', "files", files_,
+                         "Files of each thread, written interleaved, each "
+                         "open Writer pins one Block (default 16)");
+
+        clp.add_unsigned('t', "threads", threads_,
+                         "threads of the concurrent pattern (default 4)");
+
+        clp.add_unsigned('k', "pins", pins_,
+                         "Blocks pinned by the random pattern (default 4096)");
+
+        clp.add_string('e', "eviction", eviction_,
+                       "eviction policy: lru, mru, dia (default lru)");
+
+        clp.add_bool('c', "compress", compress_,
+                     "compress Blocks evicted to external memory");
+
+        clp.add_unsigned(
+            'n', "iterations", iterations_, "Iterations (default: 1)");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        for (const std::string& pattern : tlx::split(',', patterns_)) {
+            if (pattern != "sequential" && pattern != "random" &&
+                pattern != "concurrent")
+                die("Unknown access pattern " << pattern);
+
+            for (unsigned i = 0; i < iterations_; ++i)
+                Test(pattern);
+        }
+
+        return 0;
+    }
+
+    //! run a function for each thread in parallel
+    template <typename Function>
+    static void RunThreads(size_t threads, const Function& function) {
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t)
+            pool.emplace_back(common::CreateThread([&function, t]() {
+                                                       function(t);
+                                                   }));
+        for (std::thread& thread : pool)
+            thread.join();
+    }
+
+    //! write bytes interleaved into files_ new Files of a local worker
+    std::vector<data::File> WriteFiles(
+        data::BlockPool& block_pool, size_t local_worker_id, size_t bytes) {
+
+        std::vector<data::File> files;
+        // the Writers point to the Files, hence they must not be moved.
+        files.reserve(files_);
+        std::vector<data::File::Writer> writers;
+        for (size_t f = 0; f < files_; ++f) {
+            files.emplace_back(block_pool, local_worker_id, /* dia_id */ 0);
+            writers.emplace_back(files.back().GetWriter());
+        }
+
+        size_t num_items = bytes / sizeof(uint64_t);
+        for (size_t i = 0; i < num_items; ++i)
+            writers[i % files_].Put(static_cast<uint64_t>(i));
+
+        for (data::File::Writer& w : writers)
+            w.Close();
+        return files;
+    }
+
+    //! read the Files back one after another, returns the number of items
+    static size_t ReadFiles(const std::vector<data::File>& files) {
+        size_t num_items = 0;
+        for (const data::File& file : files) {
+            data::File::KeepReader reader = file.GetKeepReader();
+            while (reader.HasNext()) {
+                reader.Next<uint64_t>();
+                ++num_items;
+            }
+        }
+        return num_items;
+    }
+
+    //! pin random Blocks of the Files, returns the latencies in microseconds
+    std::vector<double> PinRandom(const std::vector<data::File>& files) {
+        std::default_random_engine rng(std::random_device { } ());
+        std::vector<double> latencies;
+        latencies.reserve(pins_);
+        for (size_t i = 0; i < pins_; ++i) {
+            const data::File& file = files[rng() % files.size()];
+            const data::Block& block = file.block(rng() % file.num_blocks());
+            StatsTimerStart timer;
+            data::PinnedBlock pinned = block.PinWait(/* local_worker_id */ 0);
+            timer.Stop();
+            latencies.push_back(static_cast<double>(timer.Microseconds()));
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return latencies;
+    }
+
+    void Test(const std::string& pattern) {
+        size_t threads = pattern == "concurrent" ? threads_ : 1;
+
+        data::BlockPool block_pool(
+            soft_ram_, hard_ram_, /* logger */ nullptr, /* mem_manager */ nullptr,
+            threads, compress_, /* huge_pages */ false, eviction_);
+
+        std::vector<std::vector<data::File> > files(threads);
+
+        StatsTimerStart write_timer;
+        RunThreads(threads, [&](size_t t) {
+                       files[t] = WriteFiles(block_pool, t, bytes_ / threads);
+                   });
+        write_timer.Stop();
+
+        size_t evicted_blocks = 0, evicted_bytes = 0;
+        for (const auto& s : block_pool.dia_io_stats()) {
+            evicted_blocks += s.second.evicted_blocks;
+            evicted_bytes += s.second.evicted_bytes;
+        }
+        data::BlockPool::ReadStats reads_before = block_pool.read_stats();
+
+        std::vector<double> latencies;
+        std::vector<size_t> num_items(threads);
+        StatsTimerStart read_timer;
+        if (pattern == "random") {
+            latencies = PinRandom(files[0]);
+        }
+        else {
+            RunThreads(threads, [&](size_t t) {
+                           num_items[t] = ReadFiles(files[t]);
+                       });
+        }
+        read_timer.Stop();
+
+        data::BlockPool::ReadStats reads = block_pool.read_stats();
+        size_t read_bytes = reads.bytes - reads_before.bytes;
+        size_t read_requests = reads.requests - reads_before.requests;
+
+        if (pattern != "random") {
+            die_unequal(std::accumulate(num_items.begin(), num_items.end(),
+                                        size_t(0)),
+                        threads * (bytes_ / threads / sizeof(uint64_t)));
+        }
+
+        std::ostringstream pin_stats;
+        if (!latencies.empty()) {
+            auto percentile = [&](double p) {
+                                  return latencies[std::min(
+                                                       latencies.size() - 1,
+                                                       static_cast<size_t>(
+                                                           p * latencies.size()))];
+                              };
+            pin_stats
+                << " pins=" << latencies.size()
+                << " pin_avg_us="
+                << std::accumulate(latencies.begin(), latencies.end(), 0.0)
+                / static_cast<double>(latencies.size())
+                << " pin_p50_us=" << percentile(0.5)
+                << " pin_p90_us=" << percentile(0.9)
+                << " pin_p99_us=" << percentile(0.99)
+                << " pin_max_us=" << latencies.back();
+        }
+
+        LOG1 << "RESULT"
+             << " experiment=" << "block_pool"
+             << " pattern=" << pattern
+             << " bytes=" << bytes_
+             << " files=" << files_
+             << " threads=" << threads
+             << " soft_ram=" << soft_ram_
+             << " hard_ram=" << hard_ram_
+             << " eviction=" << eviction_
+             << " compress=" << compress_
+             << " block_size=" << data::default_block_size
+             << " write_time=" << write_timer.SecondsDouble()
+             << " evicted_blocks=" << evicted_blocks
+             << " evicted_bytes=" << evicted_bytes
+             << " eviction_MiBs=" << CalcMiBs(evicted_bytes, write_timer)
+             << " read_time=" << read_timer.SecondsDouble()
+             << " read_requests=" << read_requests
+             << " read_bytes=" << read_bytes
+             << " read_MiBs=" << CalcMiBs(read_bytes, read_timer)
+             << " max_total_bytes=" << block_pool.max_total_bytes()
+             << pin_stats.str();
+    }
+
+private:
+    //! total bytes written into Files
+    uint64_t bytes_ = 1024 * 1024 * 1024;
+
+    //! soft and hard RAM limit of the BlockPool
+    uint64_t soft_ram_ = 64 * 1024 * 1024;
+    uint64_t hard_ram_ = 128 * 1024 * 1024;
+
+    //! comma separated access patterns
+    std::string patterns_ = "sequential,random,concurrent";
+
+    //! Files of each thread
+    unsigned files_ = 16;
+
+    //! threads of the concurrent pattern
+    unsigned threads_ = 4;
+
+    //! Blocks pinned by the random pattern
+    unsigned pins_ = 4096;
+
+    //! eviction policy of the BlockPool
+    std::string eviction_ = "lru";
+
+    //! compress Blocks evicted to external memory
+    bool compress_ = false;
+
+    //! number of iterations to run
+    unsigned iterations_ = 1;
+};
+
 /******************************************************************************/
 
 void Usage(const char* argv0) {
@@ -936,6 +1365,8 @@ void Usage(const char* argv0) {
         << "    mix_stream_all2all   - full bandwidth test using MixStream" << std::endl
         << "    stream_all2all_check - full bandwidth test using CatStream with verification" << std::endl
         << "    scatter              - CatStream scatter test" << std::endl
+        << "    shuffle              - all-to-all shuffle bandwidth and CPU per GB" << std::endl
+        << "    block_pool           - BlockPool eviction and external memory stress test" << std::endl
         << std::endl;
 }
 
@@ -979,6 +1410,12 @@ int main(int argc, char* argv[]) {
     else if (benchmark == "scatter") {
         return ScatterExperiment().Run(argc - 1, argv + 1);
     }
+    else if (benchmark == "shuffle") {
+        return ShuffleExperiment().Run(argc - 1, argv + 1);
+    }
+    else if (benchmark == "block_pool") {
+        return BlockPoolExperiment().Run(argc - 1, argv + 1);
+    }
     else {
         Usage(argv[0]);
         return -1;
@@ -1,6 +1,9 @@
 /*******************************************************************************
  * benchmarks/hashtable/bench_hashtable.cpp
  *
+ * Benchmark matrix of the reduce hash tables over table implementations, item
+ * sizes, key distributions, fill rate limits, and numbers of workers.
+ *
  * Part of Project Thrill - http://project-thrill.org
  *
  * Copyright (C) 2015 Alexander Noe <aleexnoe@gmail.com>
@@ -10,14 +13,19 @@
  ******************************************************************************/
 
 #include <thrill/common/stats_timer.hpp>
+#include <thrill/common/zipf_distribution.hpp>
 #include <thrill/core/reduce_by_hash_post_phase.hpp>
+#include <thrill/core/reduce_pre_phase.hpp>
 #include <thrill/data/block_writer.hpp>
 #include <thrill/data/discard_sink.hpp>
 #include <thrill/data/file.hpp>
 #include <tlx/cmdline_parser.hpp>
+#include <tlx/string/split.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -28,107 +36,299 @@
 #include <vector>
 
 using Key = uint64_t;
-using KeyPair = std::pair<uint64_t, uint64_t>;
 
 using namespace thrill; // NOLINT
 
-std::string title;
-uint64_t size = 64 * 1024 * 1024;
-unsigned int workers = 100;
+//! item of Size bytes with a Key
+template <size_t Size>
+struct Item {
+    Key key;
+    std::array<uint8_t, Size - sizeof(Key)> payload;
+};
+
+//! make an item from a key
+template <size_t Size>
+struct MakeItem {
+    using Type = Item<Size>;
+    static Type Make(const Key& k) {
+        Type t;
+        t.key = k;
+        t.payload.fill(0);
+        return t;
+    }
+    static const Key& GetKey(const Type& t) { return t.key; }
+};
+
+//! items of eight bytes are plain keys
+template <>
+struct MakeItem<sizeof(Key)> {
+    using Type = Key;
+    static Type Make(const Key& k) { return k; }
+    static const Key& GetKey(const Type& t) { return t; }
+};
+
+//! parameters of one benchmark of the matrix
+struct Setup {
+    std::string title;
+    std::string phase;
+    std::string table;
+    std::string distribution;
+    size_t item_size;
+    size_t workers;
+    double fill_rate;
+    double bucket_rate;
+    uint64_t size;
+    uint64_t mem_limit;
+};
+
+//! generate the keys of a distribution in [1,range]
+std::vector<Key> GenerateKeys(const std::string& distribution,
+                              size_t num_items, uint64_t range,
+                              double zipf_exponent) {
+    std::vector<Key> keys(num_items);
+    std::default_random_engine rng(std::random_device { } ());
 
-uint64_t item_range = std::numeric_limits<Key>::max();
+    if (distribution == "uniform") {
+        std::uniform_int_distribution<Key> dist(1, range);
+        for (Key& k : keys) k = dist(rng);
+    }
+    else if (distribution == "zipf") {
+        // the distribution's table has one entry per key
+        size_t n = static_cast<size_t>(
+            std::min<uint64_t>(range, std::max<size_t>(num_items, 2)));
+        common::ZipfDistribution dist(n, zipf_exponent);
+        for (Key& k : keys) k = dist(rng);
+    }
+    else if (distribution == "sorted") {
+        for (size_t i = 0; i < num_items; ++i) keys[i] = 1 + i % range;
+    }
+    else {
+        std::cerr << "Unknown key distribution " << distribution << std::endl;
+        abort();
+    }
+    return keys;
+}
 
-template <core::ReduceTableImpl table_impl>
-void RunBenchmark(api::Context& ctx, core::DefaultReduceConfig& base_config) {
+//! print the RESULT line of a benchmark
+void PrintResult(const Setup& s, size_t num_items,
+                 const common::StatsTimer& timer, size_t spilled_items) {
+    std::cout
+        << "RESULT"
+        << " benchmark=" << s.title
+        << " phase=" << s.phase
+        << " table=" << s.table
+        << " distribution=" << s.distribution
+        << " item_size=" << s.item_size
+        << " size=" << s.size
+        << " items=" << num_items
+        << " workers=" << s.workers
+        << " max_partition_fill_rate=" << s.fill_rate
+        << " bucket_rate=" << s.bucket_rate
+        << " mem_limit=" << s.mem_limit
+        << " time=" << timer
+        << " items_per_s=" << num_items / timer.SecondsDouble()
+        << " spilled_items=" << spilled_items
+        << std::endl;
+}
+
+template <core::ReduceTableImpl table_impl, size_t ItemSize>
+void RunBenchmark(api::Context& ctx, const Setup& s,
+                  const std::vector<Key>& keys) {
 
-    auto key_ex = [](const Key& in) { return in; };
+    using Make = MakeItem<ItemSize>;
+    using Value = typename Make::Type;
 
-    auto red_fn = [](const Key& in1, const Key& in2) {
+    auto key_ex = [](const Value& in) { return Make::GetKey(in); };
+
+    auto red_fn = [](const Value& in1, const Value& in2) {
                       (void)in2;
                       return in1;
                   };
 
-    auto emit_fn = [](const Key&) { };
+    core::DefaultReduceConfigSelect<table_impl> config;
+    config.limit_partition_fill_rate_ = s.fill_rate;
+    config.bucket_rate_ = s.bucket_rate;
 
-    uint64_t num_items = size / sizeof(KeyPair);
+    size_t spilled_items = 0;
+    common::StatsTimerStopped timer;
 
-    std::default_random_engine rng(std::random_device { } ());
-    std::uniform_int_distribution<Key> dist(1, item_range);
+    if (s.phase == "post") {
+        auto emit_fn = [](const Value&) { };
 
-    core::DefaultReduceConfigSelect<table_impl> config;
-    config.limit_partition_fill_rate_ = base_config.limit_partition_fill_rate_;
-    config.bucket_rate_ = base_config.bucket_rate_;
+        core::ReduceByHashPostPhase<
+            Value, Key, Value,
+            decltype(key_ex), decltype(red_fn), decltype(emit_fn),
+            /* VolatileKey */ false,
+            core::DefaultReduceConfigSelect<table_impl> >
+        phase(ctx, 0, key_ex, red_fn, emit_fn, config);
+        phase.Initialize(s.mem_limit);
 
-    core::ReduceByHashPostPhase<
-        Key, Key, Key,
-        decltype(key_ex), decltype(red_fn), decltype(emit_fn),
-        /* VolatileKey */ false,
-        core::DefaultReduceConfigSelect<table_impl> >
-    phase(ctx, 0, key_ex, red_fn, emit_fn,
-          config);
+        timer.Start();
+        for (const Key& k : keys)
+            phase.Insert(Make::Make(k));
 
-    common::StatsTimerStart timer;
+        for (const data::File& f : phase.table().partition_files())
+            spilled_items += f.num_items();
 
-    for (uint64_t i = 0; i < num_items; i++)
-        phase.Insert(dist(rng));
+        phase.PushData(/* consume */ true);
+        timer.Stop();
+    }
+    else {
+        // the pre phase partitions the items for the workers
+        std::vector<data::DiscardWriter> writers;
+        for (size_t w = 0; w < s.workers; ++w) {
+            writers.emplace_back(
+                data::DiscardSink(ctx.block_pool(), ctx.local_worker_id()));
+        }
+
+        core::ReducePrePhase<
+            Value, Key, Value,
+            decltype(key_ex), decltype(red_fn),
+            /* VolatileKey */ false, data::DiscardWriter,
+            core::DefaultReduceConfigSelect<table_impl> >
+        phase(ctx, 0, s.workers, key_ex, red_fn, writers, config);
+        phase.Initialize(s.mem_limit);
+
+        timer.Start();
+        for (const Key& k : keys)
+            phase.Insert(Make::Make(k));
+
+        spilled_items = phase.num_emitted();
+
+        phase.FlushAll();
+        phase.CloseAll();
+        timer.Stop();
+    }
 
-    phase.PushData(/* consume */ true);
+    PrintResult(s, keys.size(), timer, spilled_items);
+}
 
-    timer.Stop();
+template <core::ReduceTableImpl table_impl>
+void RunItemSize(api::Context& ctx, const Setup& s,
+                 const std::vector<Key>& keys) {
+    if (s.item_size == 8)
+        return RunBenchmark<table_impl, 8>(ctx, s, keys);
+    else if (s.item_size == 16)
+        return RunBenchmark<table_impl, 16>(ctx, s, keys);
+    else if (s.item_size == 64)
+        return RunBenchmark<table_impl, 64>(ctx, s, keys);
+    std::cerr << "Unsupported item size " << s.item_size
+              << ", use 8, 16, or 64." << std::endl;
+    abort();
+}
 
-    std::cout
-        << "RESULT"
-        << " benchmark=" << title
-        << " size=" << size
-        << " workers=" << workers
-        << " max_partition_fill_rate=" << config.limit_partition_fill_rate()
-        << " bucket_rate=" << config.bucket_rate()
-        << " time=" << timer
-        << std::endl;
+void RunTable(api::Context& ctx, const Setup& s, const std::vector<Key>& keys) {
+    if (s.table == "probing")
+        return RunItemSize<core::ReduceTableImpl::PROBING>(ctx, s, keys);
+    else if (s.table == "old_probing")
+        return RunItemSize<core::ReduceTableImpl::OLD_PROBING>(ctx, s, keys);
+    else if (s.table == "bucket")
+        return RunItemSize<core::ReduceTableImpl::BUCKET>(ctx, s, keys);
+    else if (s.table == "simd_probing")
+        return RunItemSize<core::ReduceTableImpl::SIMD_PROBING>(ctx, s, keys);
+    else if (s.table == "robin_hood")
+        return RunItemSize<core::ReduceTableImpl::ROBIN_HOOD>(ctx, s, keys);
+    else if (s.table == "soa_probing")
+        return RunItemSize<core::ReduceTableImpl::SOA_PROBING>(ctx, s, keys);
+    std::cerr << "Unknown hash table " << s.table << std::endl;
+    abort();
 }
 
 int main(int argc, char* argv[]) {
 
     tlx::CmdlineParser clp;
+    clp.set_description(
+        "Benchmark matrix of the reduce hash tables. Options taking lists "
+        "run all combinations of their comma separated values.");
 
     core::DefaultReduceConfig config;
 
-    std::string hashtable;
+    std::string title = "hashtable";
+    uint64_t size = 64 * 1024 * 1024;
+    uint64_t mem_limit = 128 * 1024 * 1024;
+    uint64_t item_range = std::numeric_limits<Key>::max();
+    double zipf_exponent = 1.2;
+    std::string phases = "post";
+    std::string tables = "probing,bucket";
+    std::string distributions = "uniform";
+    std::string item_sizes = "8";
+    std::string fill_rates = std::to_string(config.limit_partition_fill_rate_);
+    std::string workers = "1";
 
     clp.add_bytes('s', "size", "S", size,
                   "Set amount of bytes to be inserted, default = 64 MiB");
 
     clp.add_string('t', "title", "T", title,
-                   "Load in byte to be inserted");
+                   "Title of the benchmark in the RESULT lines");
+
+    clp.add_string('p', "phase", "P", phases,
+                   "List of reduce phases: pre, post, default = post");
 
-    clp.add_string('h', "hash-table", "H", hashtable,
-                   "Set hashtable: probing or bucket");
+    clp.add_string('h', "hash-table", "H", tables,
+                   "List of hash tables: probing, old_probing, bucket, "
+                   "simd_probing, robin_hood, soa_probing, "
+                   "default = probing,bucket");
 
-    clp.add_unsigned('w', "workers", "W", workers,
-                     "Open hashtable with W workers, default = 1.");
+    clp.add_string('d', "distribution", "D", distributions,
+                   "List of key distributions: uniform, zipf, sorted, "
+                   "default = uniform");
 
-    clp.add_double('f', "fill_rate", "F",
-                   config.limit_partition_fill_rate_,
-                   "set limit_partition_fill_rate, default = 0.5.");
+    clp.add_string('i', "item-size", "I", item_sizes,
+                   "List of item sizes in bytes: 8, 16, 64, default = 8");
+
+    clp.add_string('w', "workers", "W", workers,
+                   "List of numbers of workers the pre phase partitions "
+                   "for, default = 1");
+
+    clp.add_string('f', "fill_rate", "F", fill_rates,
+                   "List of limit_partition_fill_rate values.");
 
     clp.add_double('b', "bucket_rate", "B",
                    config.bucket_rate_,
                    "set bucket_rate, default = 0.5.");
 
+    clp.add_bytes('m', "mem-limit", "M", mem_limit,
+                  "Memory limit of the table, default = 128 MiB");
+
     clp.add_bytes('r', "range", "N",
                   item_range,
                   "set upper bound on item values, default = UINT_MAX.");
 
+    clp.add_double('z', "zipf", "Z", zipf_exponent,
+                   "exponent of the zipf distribution, default = 1.2");
+
     if (!clp.process(argc, argv)) {
         return -1;
     }
 
     api::RunLocalSameThread(
         [&](api::Context& ctx) {
-            if (hashtable == "bucket")
-                return RunBenchmark<core::ReduceTableImpl::BUCKET>(ctx, config);
-            else
-                return RunBenchmark<core::ReduceTableImpl::PROBING>(ctx, config);
+            for (const std::string& item_size : tlx::split(',', item_sizes)) {
+                size_t isize = std::stoul(item_size);
+                size_t num_items = size / isize;
+
+                for (const std::string& dist : tlx::split(',', distributions)) {
+                    std::vector<Key> keys = GenerateKeys(
+                        dist, num_items, item_range, zipf_exponent);
+
+                    for (const std::string& phase : tlx::split(',', phases)) {
+                        for (const std::string& table : tlx::split(',', tables)) {
+                            for (const std::string& fill :
+                                 tlx::split(',', fill_rates)) {
+                                for (const std::string& w :
+                                     tlx::split(',', workers)) {
+                                    Setup s {
+                                        title, phase, table, dist, isize,
+                                        std::stoul(w), std::stod(fill),
+                                        config.bucket_rate_, size, mem_limit
+                                    };
+                                    RunTable(ctx, s, keys);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
         });
 
     return 0;
@@ -10,13 +10,17 @@
 
 #include <thrill/common/logger.hpp>
 #include <thrill/common/stats_timer.hpp>
+#include <thrill/mem/pool.hpp>
 #include <tlx/cmdline_parser.hpp>
 #include <tlx/thread_pool.hpp>
 
 #include <algorithm>
+#include <deque>
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace thrill; // NOLINT
 using common::StatsTimer;
@@ -77,10 +81,81 @@ int BenchmarkOneSize(int argc, char* argv[]) {
 
 /******************************************************************************/
 
+//! Many threads allocating and deallocating small objects concurrently, as
+//! done by the worker and dispatcher threads with GPool().
+int BenchmarkContention(int argc, char* argv[]) {
+    tlx::CmdlineParser clp;
+
+    size_t size = 64;
+    size_t iterations = 1000000;
+    size_t num_threads = std::thread::hardware_concurrency();
+    size_t live = 16;
+    bool thread_cache = false;
+
+    clp.add_size_t(
+        's', "size", size, "size (default: 64)");
+    clp.add_size_t(
+        'n', "iterations", iterations,
+        "Iterations per thread (default: 1000000)");
+    clp.add_size_t(
+        't', "threads", num_threads, "Threads (default: all cores)");
+    clp.add_size_t(
+        'l', "live", live,
+        "Allocations kept alive per thread (default: 16)");
+    clp.add_bool(
+        'c', "cache", thread_cache, "enable per-thread caches of the Pool");
+
+    if (!clp.process(argc, argv)) return -1;
+
+    mem::Pool pool(16384, thread_cache);
+
+    StatsTimerStart timer;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back(
+            [&pool, size, iterations, live]() {
+                std::deque<void*> list;
+                for (size_t i = 0; i < iterations; ++i) {
+                    list.emplace_back(pool.allocate(size));
+                    if (list.size() > live) {
+                        pool.deallocate(list.front(), size);
+                        list.pop_front();
+                    }
+                }
+                while (!list.empty()) {
+                    pool.deallocate(list.front(), size);
+                    list.pop_front();
+                }
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    timer.Stop();
+
+    LOG1 << "RESULT"
+         << " experiment=" << "contention"
+         << " size=" << size
+         << " iterations=" << iterations
+         << " threads=" << num_threads
+         << " thread_cache=" << thread_cache
+         << " time=" << timer.Microseconds()
+         << " ops_per_sec="
+         << static_cast<double>(2 * iterations * num_threads)
+        / timer.SecondsDouble();
+
+    return 0;
+}
+
+/******************************************************************************/
+
 void Usage(const char* argv0) {
     std::cout
         << "Usage: " << argv0 << " <benchmark>" << std::endl
         << std::endl
+        << "    one_size            - one thread with a single object size" << std::endl
+        << "    contention          - many threads allocating small objects" << std::endl
         // << "    file                - File and serialization speed" << std::endl
         // << "    blockqueue          - BlockQueue test" << std::endl
         // << "    cat_stream_1factor  - 1-factor bandwidth test using CatStream" << std::endl
@@ -103,6 +178,9 @@ int main(int argc, char* argv[]) {
     if (benchmark == "one_size") {
         return BenchmarkOneSize(argc - 1, argv + 1);
     }
+    else if (benchmark == "contention") {
+        return BenchmarkContention(argc - 1, argv + 1);
+    }
     else {
         Usage(argv[0]);
         return -1;
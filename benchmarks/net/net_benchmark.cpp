@@ -6,6 +6,8 @@
  * - 1-factor full bandwidth test
  * - fcc Broadcast
  * - fcc PrefixSum
+ * - latency of fcc and net::Group collectives over value sizes
+ * - all-to-all Stream bandwidth over the data connections
  *
  * Part of Project Thrill - http://project-thrill.org
  *
@@ -17,14 +19,27 @@
 
 #include <thrill/api/context.hpp>
 #include <thrill/common/aggregate.hpp>
+#include <thrill/common/functional.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/matrix.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/common/string.hpp>
 #include <thrill/net/dispatcher.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
+#include <thrill/net/tcp/group.hpp>
+#include <thrill/net/tcp/select_dispatcher.hpp>
 #include <tlx/cmdline_parser.hpp>
-
+#include <tlx/die.hpp>
+#include <tlx/math/is_power_of_two.hpp>
+#include <tlx/string/ends_with.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
+#include <tlx/string/split.hpp>
+#include <tlx/string/starts_with.hpp>
+
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -623,6 +638,216 @@ private:
     unsigned int inner_repeats_ = 200;
 };
 
+/******************************************************************************/
+//! latency of the FlowControlChannel collectives and of the net::Group
+//! algorithm variants over vectors of different sizes
+
+class Collectives
+{
+public:
+    using Value = std::vector<size_t>;
+    using ValueSum = common::ComponentSum<Value>;
+
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.add_unsigned('r', "inner_repeats", inner_repeats_,
+                         "Repeat inner experiment a number of times.");
+
+        clp.add_unsigned('R', "outer_repeats", outer_repeats_,
+                         "Repeat whole experiment a number of times.");
+
+        clp.add_string('o', "operations", operations_,
+                       "Comma separated list of operations, default = all: "
+                       "fcc_allreduce, fcc_prefixsum, fcc_broadcast, "
+                       "fcc_allgather, fcc_predecessor, allreduce_simple, "
+                       "allreduce_at_root, allreduce_hypercube, "
+                       "allreduce_elimination, broadcast_trivial, "
+                       "broadcast_binomial_tree, prefixsum_doubling, "
+                       "prefixsum_hypercube");
+
+        clp.add_string('s', "sizes", sizes_,
+                       "Comma separated list of value sizes in bytes, "
+                       "default = 8,64,1Ki,64Ki,1Mi");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        if (operations_ == "all") {
+            operations_ =
+                "fcc_allreduce,fcc_prefixsum,fcc_broadcast,fcc_allgather,"
+                "fcc_predecessor,allreduce_simple,allreduce_at_root,"
+                "allreduce_hypercube,allreduce_elimination,broadcast_trivial,"
+                "broadcast_binomial_tree,prefixsum_doubling,prefixsum_hypercube";
+        }
+
+        for (const std::string& s : tlx::split(',', sizes_)) {
+            uint64_t bytes;
+            if (!tlx::parse_si_iec_units(s, &bytes))
+                die("Invalid value size " << s);
+            bytes_.push_back(bytes);
+        }
+
+        return api::Run(
+            [=](api::Context& ctx) {
+                // make a copy of this for local workers
+                Collectives local = *this;
+                return local.Test(ctx);
+            });
+    }
+
+    void Test(api::Context& ctx) {
+        for (const std::string& op : tlx::split(',', operations_)) {
+            // the hypercube variants require a power of two hosts
+            if (tlx::ends_with(op, "_hypercube") &&
+                !tlx::is_power_of_two(ctx.num_hosts())) {
+                if (ctx.my_rank() == 0) {
+                    LOG1 << "Skipping " << op << " on " << ctx.num_hosts()
+                         << " hosts, which is not a power of two.";
+                }
+                continue;
+            }
+            for (const uint64_t& bytes : bytes_) {
+                for (size_t outer = 0; outer < outer_repeats_; ++outer)
+                    Measure(ctx, op, bytes);
+            }
+        }
+    }
+
+    void Measure(api::Context& ctx, const std::string& op, uint64_t bytes) {
+
+        size_t elements = std::max<size_t>(1, bytes / sizeof(size_t));
+        Value value(elements);
+
+        // the net::Group algorithms run once per host
+        bool group_op = !tlx::starts_with(op, "fcc_");
+        bool active = !group_op || ctx.local_worker_id() == 0;
+        net::Group& group = ctx.net.group();
+
+        // one untimed run to open connections and warm up buffers
+        ctx.net.Barrier();
+        if (active) RunOperation(ctx, group, op, value);
+        ctx.net.Barrier();
+
+        common::StatsTimerStopped t;
+
+        t.Start();
+        if (active) {
+            for (size_t inner = 0; inner < inner_repeats_; ++inner)
+                RunOperation(ctx, group, op, value);
+        }
+        t.Stop();
+
+        ctx.net.Barrier();
+
+        size_t time = t.Microseconds();
+        // calculate maximum time.
+        time = ctx.net.AllReduce(time, common::maximum<size_t>());
+
+        if (ctx.my_rank() == 0) {
+            std::cout
+                << "RESULT"
+                << " datatype=" << "vector<size_t>"
+                << " operation=" << op
+                << " net=" << (getenv("THRILL_NET") ? getenv("THRILL_NET")
+                               : "default")
+                << " hosts=" << ctx.num_hosts()
+                << " workers=" << ctx.num_workers()
+                << " value_bytes=" << elements * sizeof(size_t)
+                << " inner_repeats=" << inner_repeats_
+                << " time[us]=" << time
+                << " time_per_op[us]="
+                << static_cast<double>(time) / inner_repeats_
+                << std::endl;
+        }
+    }
+
+    //! run one operation and check its result
+    void RunOperation(api::Context& ctx, net::Group& group,
+                      const std::string& op, Value& value) {
+
+        // ranks among the participants of the operation
+        size_t rank = tlx::starts_with(op, "fcc_")
+                      ? ctx.my_rank() : group.my_host_rank();
+        size_t num = tlx::starts_with(op, "fcc_")
+                     ? ctx.num_workers() : group.num_hosts();
+
+        std::fill(value.begin(), value.end(), rank + 1);
+
+        if (op == "fcc_allreduce") {
+            value = ctx.net.AllReduce(value, ValueSum());
+            die_unequal(value.front(), num * (num + 1) / 2);
+        }
+        else if (op == "fcc_prefixsum") {
+            value = ctx.net.PrefixSum(value, ValueSum(), Value(value.size()));
+            die_unequal(value.front(), (rank + 1) * (rank + 2) / 2);
+        }
+        else if (op == "fcc_broadcast") {
+            value = ctx.net.Broadcast(value);
+            die_unequal(value.front(), 1u);
+        }
+        else if (op == "fcc_allgather") {
+            std::shared_ptr<std::vector<Value> > all = ctx.net.AllGather(value);
+            die_unequal(all->size(), num);
+        }
+        else if (op == "fcc_predecessor") {
+            Value pred = ctx.net.Predecessor(value.size(), value);
+            die_unequal(pred.size(), rank == 0 ? 0u : value.size());
+        }
+        else if (op == "allreduce_simple") {
+            group.AllReduceSimple(value, ValueSum());
+            die_unequal(value.front(), num * (num + 1) / 2);
+        }
+        else if (op == "allreduce_at_root") {
+            group.AllReduceAtRoot(value, ValueSum());
+            die_unequal(value.front(), num * (num + 1) / 2);
+        }
+        else if (op == "allreduce_hypercube") {
+            group.AllReduceHypercube(value, ValueSum());
+            die_unequal(value.front(), num * (num + 1) / 2);
+        }
+        else if (op == "allreduce_elimination") {
+            group.AllReduceElimination(value, ValueSum());
+            die_unequal(value.front(), num * (num + 1) / 2);
+        }
+        else if (op == "broadcast_trivial") {
+            group.BroadcastTrivial(value);
+            die_unequal(value.front(), 1u);
+        }
+        else if (op == "broadcast_binomial_tree") {
+            group.BroadcastBinomialTree(value);
+            die_unequal(value.front(), 1u);
+        }
+        else if (op == "prefixsum_doubling") {
+            group.PrefixSumDoubling(value, ValueSum(), Value(value.size()));
+            die_unequal(value.front(), (rank + 1) * (rank + 2) / 2);
+        }
+        else if (op == "prefixsum_hypercube") {
+            group.PrefixSumHypercube(value, ValueSum());
+            die_unequal(value.front(), (rank + 1) * (rank + 2) / 2);
+        }
+        else {
+            die("Unknown collective operation " << op);
+        }
+    }
+
+private:
+    //! whole experiment
+    unsigned int outer_repeats_ = 1;
+
+    //! inner repetitions
+    unsigned int inner_repeats_ = 200;
+
+    //! comma separated list of operations
+    std::string operations_ = "all";
+
+    //! comma separated list of value sizes
+    std::string sizes_ = "8,64,1Ki,64Ki,1Mi";
+
+    //! parsed value sizes
+    std::vector<uint64_t> bytes_;
+};
+
 /******************************************************************************/
 
 class RandomBlocks
@@ -646,6 +871,10 @@ public:
         clp.add_unsigned('R', "outer_repeats", outer_repeats_,
                          "Repeat whole experiment a number of times.");
 
+        clp.add_string('d', "dispatcher", dispatcher_type_,
+                       "TCP dispatcher: default, select, epoll, or both "
+                       "for a side-by-side comparison, default: default");
+
         if (!clp.process(argc, argv)) return -1;
 
         return api::Run(
@@ -656,7 +885,37 @@ public:
             });
     }
 
+    //! run the experiment with each dispatcher selected by dispatcher_type_
     void Test(api::Context& ctx) {
+        if (dispatcher_type_ == "both") {
+            for (const char* type : { "select", "epoll" })
+                TestDispatcher(ctx, type);
+        }
+        else {
+            TestDispatcher(ctx, dispatcher_type_);
+        }
+    }
+
+    //! construct a dispatcher of the given type for the group
+    std::unique_ptr<net::Dispatcher> ConstructDispatcher(
+        const std::string& type) const {
+        if (type == "default")
+            return group_->ConstructDispatcher();
+
+        die_unless(dynamic_cast<net::tcp::Group*>(group_) &&
+                   "dispatcher type requires the tcp network backend");
+
+        if (type == "select")
+            return std::make_unique<net::tcp::SelectDispatcher>();
+#if __linux__
+        if (type == "epoll")
+            return std::make_unique<net::tcp::EPollDispatcher>();
+#endif
+        die("Unknown dispatcher type " << type);
+        return nullptr;
+    }
+
+    void TestDispatcher(api::Context& ctx, const std::string& type) {
 
         common::StatsTimerStopped t;
 
@@ -667,7 +926,7 @@ public:
 
             group_ = &ctx.net.group();
             std::unique_ptr<net::Dispatcher> dispatcher =
-                group_->ConstructDispatcher();
+                ConstructDispatcher(type);
             dispatcher_ = dispatcher.get();
 
             t.Start();
@@ -702,6 +961,7 @@ public:
             std::cout
                 << "RESULT"
                 << " operation=" << "rblocks"
+                << " dispatcher=" << type
                 << " hosts=" << group_->num_hosts()
                 << " requests=" << num_requests_
                 << " block_size=" << block_size_
@@ -793,6 +1053,9 @@ protected:
     //! limit on the number of simultaneous active requests
     unsigned int limit_active_ = 16;
 
+    //! type of dispatcher to use
+    std::string dispatcher_type_ = "default";
+
     //! communication group
     net::Group* group_;
 
@@ -837,6 +1100,10 @@ public:
         clp.add_bytes('L', "max_limit_active", max_limit_active_,
                       "maximum number of simultaneous active requests, default: 512");
 
+        clp.add_string('d', "dispatcher", dispatcher_type_,
+                       "TCP dispatcher: default, select, epoll, or both "
+                       "for a side-by-side comparison, default: default");
+
         if (!clp.process(argc, argv)) return -1;
 
         return api::Run(
@@ -880,6 +1147,120 @@ protected:
     unsigned int max_limit_active_ = 512;
 };
 
+/******************************************************************************/
+//! measure all-to-all CatStream bandwidth, run with different
+//! THRILL_TCP_CONNECTIONS to compare the number of connections per peer.
+
+class StreamBandwidth
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.add_unsigned('R', "outer_repeats", outer_repeats_,
+                         "Repeat whole experiment a number of times.");
+
+        clp.add_bytes('c', "chunk_size", chunk_size_,
+                      "Size of chunks appended to the writers, default: 64 KiB");
+
+        clp.add_param_bytes("size", data_size_,
+                            "Amount of data sent by each worker to other hosts "
+                            "(example: 1 GiB).");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        return api::Run(
+            [=](api::Context& ctx) {
+                // make a copy of this for local workers
+                StreamBandwidth local = *this;
+                return local.Test(ctx);
+            });
+    }
+
+    void Test(api::Context& ctx) {
+
+        size_t workers_per_host = ctx.workers_per_host();
+        size_t num_remote = ctx.num_workers() - workers_per_host;
+        if (num_remote == 0) {
+            if (ctx.my_rank() == 0)
+                LOG1 << "stream_bandwidth requires more than one host";
+            return;
+        }
+
+        std::vector<uint8_t> chunk(chunk_size_, 42u);
+        size_t rounds = data_size_ / num_remote / chunk_size_;
+
+        for (size_t outer = 0; outer < outer_repeats_; ++outer) {
+
+            auto stream = ctx.GetNewStream<data::CatStream>(/* dia_id */ 0);
+
+            common::StatsTimerStart t;
+
+            // send chunks round-robin to all workers on other hosts
+            {
+                auto writers = stream->GetWriters();
+                for (size_t r = 0; r < rounds; ++r) {
+                    for (size_t w = 0; w < writers.size(); ++w) {
+                        if (w / workers_per_host == ctx.host_rank()) continue;
+                        writers[w].Append(chunk.data(), chunk.size());
+                    }
+                }
+                writers.Close();
+            }
+
+            // receive chunks from all workers on other hosts
+            {
+                auto readers = stream->GetReaders();
+                for (size_t w = 0; w < readers.size(); ++w) {
+                    if (w / workers_per_host == ctx.host_rank()) continue;
+                    for (size_t r = 0; r < rounds; ++r) {
+                        readers[w].Read(chunk.data(), chunk.size());
+                        die_unequal(chunk.front(), uint8_t(42));
+                    }
+                    die_unless(!readers[w].HasNext());
+                }
+            }
+            t.Stop();
+
+            stream.reset();
+
+            size_t time = t.Microseconds();
+            // calculate maximum time.
+            time = ctx.net.AllReduce(time, common::maximum<size_t>());
+
+            // bytes sent by all workers of a host
+            size_t host_bytes = workers_per_host * rounds * num_remote * chunk_size_;
+
+            if (ctx.my_rank() == 0) {
+                std::cout
+                    << "RESULT"
+                    << " benchmark=" << benchmark
+                    << " hosts=" << ctx.num_hosts()
+                    << " workers_per_host=" << workers_per_host
+                    << " data_connections="
+                    << ctx.net_manager().num_data_lanes()
+                    << " outer_repeat=" << outer
+                    << " chunk_size=" << chunk_size_
+                    << " host_bytes=" << host_bytes
+                    << " time[us]=" << time
+                    << " host_bandwidth[MiB/s]=" << CalcMiBs(host_bytes, time)
+                    << std::endl;
+            }
+        }
+    }
+
+private:
+    //! whole experiment
+    unsigned int outer_repeats_ = 1;
+
+    //! size of chunks appended to writers
+    uint64_t chunk_size_ = 64 * 1024;
+
+    //! total data sent by each worker
+    uint64_t data_size_ = 128 * 1024 * 1024llu;
+};
+
 /******************************************************************************/
 
 void Usage(const char* argv0) {
@@ -890,9 +1271,12 @@ void Usage(const char* argv0) {
         << "    bandwidth  - 1-factor bandwidth" << std::endl
         << "    broadcast  - FCC Broadcast operation" << std::endl
         << "    prefixsum  - FCC PrefixSum operation" << std::endl
-        << "    allreduce  - FCC PrefixSum operation" << std::endl
+        << "    allreduce  - FCC AllReduce operation" << std::endl
+        << "    collectives - FCC and Group collectives over value sizes"
+        << std::endl
         << "    rblocks    - random block transmissions" << std::endl
         << "    rblocks_series - series of rblocks experiments" << std::endl
+        << "    stream_bandwidth - all-to-all CatStream bandwidth" << std::endl
         << std::endl;
 }
 
@@ -920,12 +1304,18 @@ int main(int argc, char** argv) {
     else if (benchmark == "allreduce") {
         return AllReduce().Run(argc - 1, argv + 1);
     }
+    else if (benchmark == "collectives") {
+        return Collectives().Run(argc - 1, argv + 1);
+    }
     else if (benchmark == "rblocks") {
         return RandomBlocks().Run(argc - 1, argv + 1);
     }
     else if (benchmark == "rblocks_series") {
         return RandomBlocksSeries().Run(argc - 1, argv + 1);
     }
+    else if (benchmark == "stream_bandwidth") {
+        return StreamBandwidth().Run(argc - 1, argv + 1);
+    }
     else {
         Usage(argv[0]);
         return -1;
@@ -0,0 +1,290 @@
+/*******************************************************************************
+ * benchmarks/serialization/bench_block_serialization.cpp
+ *
+ * Throughput of writing items with BlockWriter::PutUnsafe() and PutSafe() into
+ * a data::File and reading them back with BlockReader::Next(), for typical item
+ * types of the serialization paths: fixed-size PODs, class methods, pairs,
+ * tuples, strings, vectors, and cereal.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/file.hpp>
+#include <thrill/data/serialization.hpp>
+#include <thrill/data/serialization_cereal.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+using Rng = std::default_random_engine;
+
+//! a struct serialized by cereal
+struct CerealItem {
+    uint64_t            id;
+    std::string         name;
+    std::vector<double> values;
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+        ar(id, name, values);
+    }
+};
+
+//! a fixed-size struct serialized by class methods
+class MethodItem
+{
+public:
+    explicit MethodItem(uint64_t a = 0, uint32_t b = 0) : a_(a), b_(b) { }
+
+    static constexpr bool thrill_is_fixed_size = true;
+    static constexpr size_t thrill_fixed_size =
+        sizeof(uint64_t) + sizeof(uint32_t);
+
+    template <typename Archive>
+    void ThrillSerialize(Archive& ar) const {
+        ar.template PutRaw<uint64_t>(a_);
+        ar.template PutRaw<uint32_t>(b_);
+    }
+
+    template <typename Archive>
+    static MethodItem ThrillDeserialize(Archive& ar) {
+        uint64_t a = ar.template GetRaw<uint64_t>();
+        uint32_t b = ar.template GetRaw<uint32_t>();
+        return MethodItem(a, b);
+    }
+
+private:
+    uint64_t a_;
+    uint32_t b_;
+};
+
+//! a TeraSort-like record, serialized as POD
+using Record = std::array<uint8_t, 100>;
+
+/******************************************************************************/
+// random item generators
+
+std::string RandomString(Rng& rng, size_t size) {
+    std::uniform_int_distribution<int> dist('a', 'z');
+    std::string s(size, 0);
+    for (char& c : s) c = static_cast<char>(dist(rng));
+    return s;
+}
+
+void MakeItem(Rng& rng, size_t& x) { x = rng(); }
+
+void MakeItem(Rng& rng, Record& x) {
+    for (uint8_t& b : x) b = static_cast<uint8_t>(rng());
+}
+
+void MakeItem(Rng& rng, MethodItem& x) {
+    x = MethodItem(rng(), static_cast<uint32_t>(rng()));
+}
+
+void MakeItem(Rng& rng, std::pair<size_t, size_t>& x) {
+    x = std::make_pair(rng(), rng());
+}
+
+void MakeItem(Rng& rng, std::tuple<size_t, double, uint32_t>& x) {
+    x = std::make_tuple(rng(), static_cast<double>(rng()),
+                        static_cast<uint32_t>(rng()));
+}
+
+void MakeItem(Rng& rng, std::pair<std::string, size_t>& x) {
+    x = std::make_pair(RandomString(rng, 4 + rng() % 28), rng());
+}
+
+void MakeItem(Rng& rng, std::string& x) {
+    x = RandomString(rng, 1 + rng() % 256);
+}
+
+void MakeItem(Rng& rng, std::vector<int64_t>& x) {
+    x.resize(rng() % 32);
+    for (int64_t& v : x) v = static_cast<int64_t>(rng());
+}
+
+void MakeItem(Rng& rng, CerealItem& x) {
+    x.id = rng();
+    x.name = RandomString(rng, 4 + rng() % 28);
+    x.values.resize(rng() % 16);
+    for (double& v : x.values) v = static_cast<double>(rng());
+}
+
+/******************************************************************************/
+
+class BlockSerialization
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.set_description(
+            "Throughput of BlockWriter and BlockReader serialization of "
+            "different item types through a data::File.");
+
+        clp.add_bytes('b', "bytes", bytes_,
+                      "serialized bytes of each type (default 64 MiB)");
+
+        clp.add_unsigned('r', "repeats", repeats_,
+                         "repetitions of each type (default 3)");
+
+        clp.add_string('t', "types", types_,
+                       "comma separated list of types, default = all: "
+                       "size_t, record, method, pair, tuple, string_pair, "
+                       "string, vector, cereal");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        if (types_ == "all") {
+            types_ = "size_t,record,method,pair,tuple,string_pair,"
+                     "string,vector,cereal";
+        }
+
+        for (const std::string& type : tlx::split(',', types_)) {
+            if (type == "size_t")
+                Test<size_t>(type);
+            else if (type == "record")
+                Test<Record>(type);
+            else if (type == "method")
+                Test<MethodItem>(type);
+            else if (type == "pair")
+                Test<std::pair<size_t, size_t> >(type);
+            else if (type == "tuple")
+                Test<std::tuple<size_t, double, uint32_t> >(type);
+            else if (type == "string_pair")
+                Test<std::pair<std::string, size_t> >(type);
+            else if (type == "string")
+                Test<std::string>(type);
+            else if (type == "vector")
+                Test<std::vector<int64_t> >(type);
+            else if (type == "cereal")
+                Test<CerealItem>(type);
+            else
+                die("Unknown item type " << type);
+        }
+
+        return 0;
+    }
+
+    //! write items with PutUnsafe() or PutSafe() into a new File
+    template <typename Type, bool Safe>
+    data::File Write(const std::vector<Type>& items,
+                     common::StatsTimer& timer) {
+        data::File file(block_pool_, 0, /* dia_id */ 0);
+        timer.Start();
+        {
+            data::File::Writer writer = file.GetWriter();
+            for (const Type& item : items) {
+                if (Safe)
+                    writer.PutSafe(item);
+                else
+                    writer.PutUnsafe(item);
+            }
+        }
+        timer.Stop();
+        return file;
+    }
+
+    template <typename Type>
+    void Test(const std::string& type) {
+
+        // generate items until the flushed blocks of their serialization
+        // reach bytes_
+        Rng rng(std::random_device { } ());
+        std::vector<Type> items;
+        {
+            data::File sizer(block_pool_, 0, /* dia_id */ 0);
+            data::File::Writer writer = sizer.GetWriter();
+            Type item;
+            while (sizer.size_bytes() < bytes_) {
+                MakeItem(rng, item);
+                writer.Put(item);
+                items.emplace_back(item);
+            }
+        }
+
+        for (size_t r = 0; r < repeats_; ++r) {
+            common::StatsTimerStopped unsafe_timer, safe_timer, read_timer;
+
+            Write<Type, /* Safe */ true>(items, safe_timer);
+            data::File file =
+                Write<Type, /* Safe */ false>(items, unsafe_timer);
+
+            size_t num_items = 0;
+            read_timer.Start();
+            {
+                data::File::ConsumeReader reader = file.GetConsumeReader();
+                while (reader.HasNext()) {
+                    reader.Next<Type>();
+                    ++num_items;
+                }
+            }
+            read_timer.Stop();
+
+            die_unequal(num_items, items.size());
+
+            Print(type, items.size(), file.size_bytes(), "put_unsafe",
+                  unsafe_timer);
+            Print(type, items.size(), file.size_bytes(), "put_safe",
+                  safe_timer);
+            Print(type, items.size(), file.size_bytes(), "next",
+                  read_timer);
+        }
+    }
+
+    static void Print(const std::string& type, size_t items, size_t bytes,
+                      const char* path, const common::StatsTimer& timer) {
+        double seconds = timer.SecondsDouble();
+        std::cout
+            << "RESULT"
+            << " benchmark=block_serialization"
+            << " type=" << type
+            << " path=" << path
+            << " items=" << items
+            << " bytes=" << bytes
+            << " block_size=" << data::default_block_size
+            << " time=" << seconds
+            << " items_per_s=" << static_cast<double>(items) / seconds
+            << " MiB_per_s="
+            << static_cast<double>(bytes) / 1024.0 / 1024.0 / seconds
+            << std::endl;
+    }
+
+private:
+    //! serialized bytes of each type
+    uint64_t bytes_ = 64 * 1024 * 1024;
+
+    //! repetitions of each type
+    unsigned int repeats_ = 3;
+
+    //! comma separated list of types
+    std::string types_ = "all";
+
+    //! block pool of the Files
+    data::BlockPool block_pool_;
+};
+
+int main(int argc, char* argv[]) {
+    return BlockSerialization().Run(argc, argv);
+}
+
+/******************************************************************************/
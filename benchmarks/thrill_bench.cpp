@@ -0,0 +1,434 @@
+/*******************************************************************************
+ * benchmarks/thrill_bench.cpp
+ *
+ * Runs a suite of benchmark programs, summarizes their RESULT lines in a common
+ * schema, and compares the summaries against a stored baseline.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
+#include <tlx/string/split.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//! key=value fields of a RESULT line
+using Fields = std::map<std::string, std::string>;
+
+//! parse the key=value fields following "RESULT" in a line, returns false if
+//! the line has none.
+static bool ParseResultLine(const std::string& line, Fields* fields) {
+    std::vector<std::string> tokens = tlx::split(' ', line);
+    auto it = std::find(tokens.begin(), tokens.end(), "RESULT");
+    if (it == tokens.end()) return false;
+
+    fields->clear();
+    for (++it; it != tokens.end(); ++it) {
+        std::string::size_type eq = it->find('=');
+        if (eq == std::string::npos) continue;
+        (*fields)[it->substr(0, eq)] = it->substr(eq + 1);
+    }
+    return true;
+}
+
+/******************************************************************************/
+// Suite
+
+//! one benchmark of the suite
+struct Benchmark {
+    std::string name;
+    //! RESULT field with the time of an iteration, and its unit in seconds
+    std::string time_key = "time";
+    double time_scale = 1.0;
+    //! bytes processed by an iteration, or 0
+    uint64_t bytes = 0;
+    //! shell command
+    std::string command;
+};
+
+//! read a suite file, see benchmarks/thrill_bench.suite for the format.
+static bool ReadSuite(const std::string& path, std::vector<Benchmark>* suite) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        std::cerr << "Could not open suite " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::string::size_type sep = line.find(" -- ");
+        if (sep == std::string::npos) {
+            std::cerr << path << ":" << lineno << ": missing ' -- '"
+                      << std::endl;
+            return false;
+        }
+
+        Benchmark b;
+        b.command = line.substr(sep + 4);
+
+        std::istringstream iss(line.substr(0, sep));
+        iss >> b.name;
+        std::string opt;
+        while (iss >> opt) {
+            std::string::size_type eq = opt.find('=');
+            std::string key = opt.substr(0, eq);
+            std::string value =
+                eq == std::string::npos ? std::string() : opt.substr(eq + 1);
+
+            if (key == "time_key") {
+                b.time_key = value;
+            }
+            else if (key == "time_scale") {
+                b.time_scale = std::strtod(value.c_str(), nullptr);
+            }
+            else if (key == "bytes") {
+                if (!tlx::parse_si_iec_units(value, &b.bytes)) {
+                    std::cerr << path << ":" << lineno
+                              << ": invalid bytes " << value << std::endl;
+                    return false;
+                }
+            }
+            else {
+                std::cerr << path << ":" << lineno
+                          << ": unknown option " << opt << std::endl;
+                return false;
+            }
+        }
+        suite->emplace_back(b);
+    }
+    return true;
+}
+
+/******************************************************************************/
+// Running
+
+//! output and resource usage of a command
+struct RunResult {
+    bool ok = false;
+    std::string output;
+    double wall_time = 0;
+    uint64_t max_rss = 0;
+};
+
+//! run a command with /bin/sh, capturing its stdout and stderr
+static RunResult RunCommand(const std::string& command, bool verbose) {
+    RunResult r;
+
+    int pipefd[2];
+    if (pipe(pipefd) != 0) {
+        perror("pipe");
+        return r;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return r;
+    }
+    if (pid == 0) {
+        dup2(pipefd[1], STDOUT_FILENO);
+        dup2(pipefd[1], STDERR_FILENO);
+        close(pipefd[0]);
+        close(pipefd[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), nullptr);
+        _exit(127);
+    }
+    close(pipefd[1]);
+
+    char buffer[4096];
+    ssize_t rb;
+    while ((rb = read(pipefd[0], buffer, sizeof(buffer))) > 0) {
+        r.output.append(buffer, rb);
+        if (verbose) std::cerr.write(buffer, rb);
+    }
+    close(pipefd[0]);
+
+    // the rusage of wait4() includes the children the shell waited for, hence
+    // the maximum RSS is that of the benchmark.
+    int status;
+    struct rusage ru;
+    if (wait4(pid, &status, 0, &ru) != pid) {
+        perror("wait4");
+        return r;
+    }
+
+    r.wall_time = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    // ru_maxrss is in KiB on Linux
+    r.max_rss = static_cast<uint64_t>(ru.ru_maxrss) * 1024;
+    r.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return r;
+}
+
+//! nearest-rank percentile of sorted values
+static double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+//! run a benchmark repeat times and summarize its RESULT lines. Returns false
+//! if a run failed or printed no time.
+static bool RunBenchmark(const Benchmark& b, size_t repeat, bool verbose,
+                         Fields* summary) {
+    std::vector<double> times;
+    double wall_time = 0;
+    uint64_t max_rss = 0;
+
+    for (size_t i = 0; i < repeat; ++i) {
+        RunResult r = RunCommand(b.command, verbose);
+        if (!r.ok) {
+            std::cerr << b.name << ": command failed: " << b.command
+                      << std::endl << r.output;
+            return false;
+        }
+        wall_time += r.wall_time;
+        max_rss = std::max(max_rss, r.max_rss);
+
+        std::istringstream iss(r.output);
+        std::string line;
+        Fields fields;
+        while (std::getline(iss, line)) {
+            if (!ParseResultLine(line, &fields)) continue;
+            auto it = fields.find(b.time_key);
+            if (it == fields.end()) continue;
+            times.push_back(std::strtod(it->second.c_str(), nullptr)
+                            * b.time_scale);
+        }
+    }
+
+    if (times.empty()) {
+        std::cerr << b.name << ": no RESULT lines with "
+                  << b.time_key << "=" << std::endl;
+        return false;
+    }
+    std::sort(times.begin(), times.end());
+
+    double mean = 0;
+    for (const double& t : times) mean += t;
+    mean /= times.size();
+
+    auto put = [summary](const std::string& key, double value) {
+                   std::ostringstream oss;
+                   oss << std::setprecision(6) << value;
+                   (*summary)[key] = oss.str();
+               };
+
+    summary->clear();
+    (*summary)["bench"] = b.name;
+    (*summary)["runs"] = std::to_string(repeat);
+    (*summary)["samples"] = std::to_string(times.size());
+    put("time_mean", mean);
+    put("time_p50", Percentile(times, 0.5));
+    put("time_p90", Percentile(times, 0.9));
+    put("time_p99", Percentile(times, 0.99));
+    put("time_max", times.back());
+    if (b.bytes != 0) {
+        (*summary)["bytes"] = std::to_string(b.bytes);
+        put("throughput_MiBs",
+            static_cast<double>(b.bytes) / Percentile(times, 0.5)
+            / 1024.0 / 1024.0);
+    }
+    (*summary)["max_rss"] = std::to_string(max_rss);
+    put("wall_time", wall_time / repeat);
+    return true;
+}
+
+//! format a summary as RESULT line, with the bench name first
+static std::string FormatSummary(const Fields& summary) {
+    std::ostringstream oss;
+    oss << "RESULT bench=" << summary.at("bench");
+    for (const auto& f : summary) {
+        if (f.first != "bench") oss << ' ' << f.first << '=' << f.second;
+    }
+    return oss.str();
+}
+
+/******************************************************************************/
+// Comparison
+
+//! read the summaries of a results file, keyed by bench name
+static bool ReadResults(const std::string& path,
+                        std::map<std::string, Fields>* results) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        std::cerr << "Could not open results " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    Fields fields;
+    while (std::getline(in, line)) {
+        if (!ParseResultLine(line, &fields) || !fields.count("bench"))
+            continue;
+        (*results)[fields["bench"]] = fields;
+    }
+    return true;
+}
+
+//! compare results against a baseline and print the relative changes of the
+//! times and the maximum RSS. Returns the number of regressions beyond
+//! threshold.
+static size_t Compare(const std::map<std::string, Fields>& baseline,
+                      const std::map<std::string, Fields>& results,
+                      double threshold) {
+    // metrics where larger values are regressions
+    static const char* metrics[] = { "time_p50", "time_p90", "max_rss" };
+
+    size_t regressions = 0;
+    std::cout << std::left << std::setw(24) << "benchmark";
+    for (const char* m : metrics)
+        std::cout << std::right << std::setw(12) << m;
+    std::cout << std::endl;
+
+    for (const auto& r : results) {
+        auto base = baseline.find(r.first);
+        if (base == baseline.end()) {
+            std::cout << std::left << std::setw(24) << r.first
+                      << "  (not in baseline)" << std::endl;
+            continue;
+        }
+
+        std::string flagged;
+        std::cout << std::left << std::setw(24) << r.first;
+        for (const char* m : metrics) {
+            auto rv = r.second.find(m), bv = base->second.find(m);
+            if (rv == r.second.end() || bv == base->second.end()) {
+                std::cout << std::right << std::setw(12) << "-";
+                continue;
+            }
+            double now = std::strtod(rv->second.c_str(), nullptr);
+            double before = std::strtod(bv->second.c_str(), nullptr);
+            double change = before > 0 ? now / before - 1.0 : 0.0;
+
+            std::ostringstream oss;
+            oss << std::showpos << std::fixed << std::setprecision(1)
+                << change * 100.0 << '%';
+            std::cout << std::right << std::setw(12) << oss.str();
+
+            if (change > threshold) {
+                ++regressions;
+                flagged += std::string(" ") + m;
+            }
+        }
+        if (!flagged.empty()) std::cout << "  REGRESSION:" << flagged;
+        std::cout << std::endl;
+    }
+    return regressions;
+}
+
+/******************************************************************************/
+
+int main(int argc, char* argv[]) {
+    tlx::CmdlineParser clp;
+    clp.set_description(
+        "Run a suite of Thrill benchmarks, summarize their RESULT lines, and "
+        "compare them against a baseline. To store a baseline, write the "
+        "results with -o.");
+
+    std::string suite_path, output_path, baseline_path, compare_path, filter;
+    unsigned repeat = 1;
+    double threshold = 0.1;
+    bool verbose = false;
+
+    clp.add_opt_param_string(
+        "suite", suite_path, "suite file, see benchmarks/thrill_bench.suite");
+    clp.add_string('o', "output", output_path,
+                   "write the results to this file");
+    clp.add_string('b', "baseline", baseline_path,
+                   "compare the results against this baseline");
+    clp.add_string('c', "compare", compare_path,
+                   "compare this results file instead of running the suite");
+    clp.add_string('f', "filter", filter,
+                   "run only benchmarks whose name contains this string");
+    clp.add_unsigned('r', "repeat", repeat,
+                     "number of runs of each benchmark, default: 1");
+    clp.add_double('t', "threshold", threshold,
+                   "relative increase which is a regression, default: 0.1");
+    clp.add_flag('v', "verbose", verbose, "echo the benchmarks' output");
+
+    if (!clp.process(argc, argv)) return -1;
+
+    std::map<std::string, Fields> results;
+    bool failed = false;
+
+    if (!compare_path.empty()) {
+        if (!ReadResults(compare_path, &results)) return -1;
+    }
+    else {
+        if (suite_path.empty()) {
+            std::cerr << "Either a suite or --compare is required." << std::endl;
+            return -1;
+        }
+
+        std::vector<Benchmark> suite;
+        if (!ReadSuite(suite_path, &suite)) return -1;
+
+        std::ofstream out;
+        if (!output_path.empty()) {
+            out.open(output_path);
+            if (!out.good()) {
+                std::cerr << "Could not open " << output_path << std::endl;
+                return -1;
+            }
+        }
+
+        for (const Benchmark& b : suite) {
+            if (!filter.empty() && b.name.find(filter) == std::string::npos)
+                continue;
+
+            std::cerr << "Running " << b.name << " ..." << std::endl;
+            Fields summary;
+            if (!RunBenchmark(b, std::max(repeat, 1u), verbose, &summary)) {
+                failed = true;
+                continue;
+            }
+
+            std::string line = FormatSummary(summary);
+            std::cout << line << std::endl;
+            if (out.is_open()) out << line << std::endl;
+            results[b.name] = summary;
+        }
+    }
+
+    if (baseline_path.empty()) return failed ? 1 : 0;
+
+    std::map<std::string, Fields> baseline;
+    if (!ReadResults(baseline_path, &baseline)) return -1;
+
+    size_t regressions = Compare(baseline, results, threshold);
+    if (regressions != 0) {
+        std::cout << regressions << " regression(s) beyond "
+                  << threshold * 100.0 << "%." << std::endl;
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
+
+/******************************************************************************/
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "bfs.hpp"
+#include "frontier.hpp"
 
 #include <thrill/api/cache.hpp>
 #include <thrill/api/generate.hpp>
@@ -80,8 +81,47 @@ DIA<BfsNode> LoadBFSGraph(thrill::Context& ctx, size_t& graphSize,
     return graph.Cache();
 }
 
-// returns true if new nodes have been possibly added to the next BFS level
-bool BFSNextLevel(DIA<BfsNode>& graph, size_t& currentLevel,
+//! sizes of the current BFS level, which select its direction
+struct LevelStats {
+    //! number of vertices in the frontier
+    size_t frontier_nodes;
+    //! number of edges leaving the frontier
+    size_t frontier_edges;
+    //! number of edges leaving unvisited vertices
+    size_t unvisited_edges;
+};
+
+/*!
+ * Direction of the BFS levels. Top-down levels push the edges of the frontier
+ * to their targets, which requires a full shuffle of all frontier edges.
+ * Bottom-up levels instead broadcast the compressed frontier vertex set, and
+ * each unvisited vertex pulls a parent from its edges, which is cheaper once
+ * the frontier holds a large part of the edges. Bottom-up levels require an
+ * undirected graph, since a vertex looks for frontier vertices among its own
+ * edges. The switching thresholds alpha and beta are those of Beamer et al.
+ * "Direction-Optimizing Breadth-First Search" (SC 2012).
+ */
+struct Direction {
+    //! switch between top-down and bottom-up levels
+    bool optimizing = false;
+    //! whether the current level is bottom-up
+    bool bottom_up = false;
+
+    static constexpr size_t alpha = 14;
+    static constexpr size_t beta = 24;
+
+    void Update(const LevelStats& stats, size_t graphSize) {
+        if (!optimizing) return;
+        if (!bottom_up && stats.frontier_edges > stats.unvisited_edges / alpha)
+            bottom_up = true;
+        else if (bottom_up && stats.frontier_nodes < graphSize / beta)
+            bottom_up = false;
+    }
+};
+
+// top-down level: emit the edges of the frontier and reduce them at their
+// target vertices
+void BFSPushLevel(DIA<BfsNode>& graph, const size_t currentLevel,
                   const size_t currentTreeIndex, const size_t graphSize) {
 
     auto neighbors =
@@ -95,9 +135,6 @@ bool BFSNextLevel(DIA<BfsNode>& graph, size_t& currentLevel,
                 }
             });
 
-    if (neighbors.Size() == 0)
-        return false;
-
     auto reducedNeighbors = neighbors.ReduceToIndex(
         [](const NodeParentPair& pair) {
             return pair.node == INVALID ? 0 : pair.node;
@@ -110,12 +147,12 @@ bool BFSNextLevel(DIA<BfsNode>& graph, size_t& currentLevel,
         graphSize,
         NodeParentPair { INVALID, INVALID });
 
-    currentLevel++;
+    const size_t nextLevel = currentLevel + 1;
 
     graph = Zip(
         [=](BfsNode node, NodeParentPair pair) {
             if (pair.node != INVALID && node.level == INVALID) {
-                node.level = currentLevel;
+                node.level = nextLevel;
                 node.parent = pair.parent;
                 node.treeIndex = currentTreeIndex;
             }
@@ -123,6 +160,87 @@ bool BFSNextLevel(DIA<BfsNode>& graph, size_t& currentLevel,
         },
         graph,
         reducedNeighbors);
+}
+
+// bottom-up level: broadcast the frontier vertex set, and let unvisited
+// vertices pick a parent from their edges
+void BFSPullLevel(DIA<BfsNode>& graph, const size_t currentLevel,
+                  const size_t currentTreeIndex, const size_t graphSize,
+                  const std::vector<VertexId>& frontier) {
+
+    std::vector<bool> inFrontier = ExchangeFrontier(
+        graph.context(), graph.id(), frontier, graphSize);
+
+    const size_t nextLevel = currentLevel + 1;
+
+    graph =
+        graph
+        .Map([&inFrontier, nextLevel, currentTreeIndex](BfsNode node) {
+                 if (node.level != INVALID)
+                     return node;
+                 for (auto neighbor : node.edges) {
+                     if (inFrontier[neighbor]) {
+                         node.level = nextLevel;
+                         node.parent = neighbor;
+                         node.treeIndex = currentTreeIndex;
+                         break;
+                     }
+                 }
+                 return node;
+             })
+        .Cache();
+
+    // the Map refers to inFrontier, hence run it now
+    graph.Execute();
+}
+
+// returns true if new nodes have been possibly added to the next BFS level
+bool BFSNextLevel(DIA<BfsNode>& graph, size_t& currentLevel,
+                  const size_t currentTreeIndex, const size_t graphSize,
+                  Direction& direction) {
+
+    // collect the local frontier for bottom-up levels, and count the edges to
+    // select the direction.
+    std::vector<VertexId> frontier;
+    const bool collect = direction.optimizing;
+
+    LevelStats stats =
+        graph
+        .Map([&frontier, collect, currentLevel, currentTreeIndex](
+                 const BfsNode& node) {
+                 if (node.level == currentLevel &&
+                     node.treeIndex == currentTreeIndex) {
+                     if (collect) frontier.push_back(node.nodeIndex);
+                     return LevelStats { 1, node.edges.size(), 0 };
+                 }
+                 if (node.level == INVALID)
+                     return LevelStats { 0, 0, node.edges.size() };
+                 return LevelStats { 0, 0, 0 };
+             })
+        .Sum([](const LevelStats& a, const LevelStats& b) {
+                 return LevelStats {
+                     a.frontier_nodes + b.frontier_nodes,
+                     a.frontier_edges + b.frontier_edges,
+                     a.unvisited_edges + b.unvisited_edges
+                 };
+             },
+             LevelStats { 0, 0, 0 });
+
+    if (stats.frontier_edges == 0)
+        return false;
+
+    direction.Update(stats, graphSize);
+
+    if (direction.bottom_up) {
+        std::sort(frontier.begin(), frontier.end());
+        BFSPullLevel(graph, currentLevel, currentTreeIndex, graphSize,
+                     frontier);
+    }
+    else {
+        BFSPushLevel(graph, currentLevel, currentTreeIndex, graphSize);
+    }
+
+    currentLevel++;
 
     return true;
 }
@@ -215,15 +333,19 @@ void outputBFSResult(DIA<BfsNode>& graph, size_t num_trees,
  * simple tree
 */
 BfsResult BFS(DIA<BfsNode>& graph, size_t graphSize,
-              VertexId startIndex, bool full_bfs = false) {
+              VertexId startIndex, bool full_bfs = false,
+              bool direction_optimizing = false) {
 
     std::vector<TreeInfo> treeInfos;
     size_t currentTreeIndex = 0;
 
     do {
         size_t currentLevel = 0;
+        Direction direction;
+        direction.optimizing = direction_optimizing;
 
-        while (BFSNextLevel(graph, currentLevel, currentTreeIndex, graphSize))
+        while (BFSNextLevel(graph, currentLevel, currentTreeIndex, graphSize,
+                            direction))
         { }
 
         treeInfos.emplace_back(TreeInfo { startIndex, currentLevel });
@@ -236,12 +358,14 @@ BfsResult BFS(DIA<BfsNode>& graph, size_t graphSize,
 
 BfsResult BFS(thrill::Context& ctx,
               std::string input_path, std::string output_path,
-              VertexId startIndex, bool full_bfs = false) {
+              VertexId startIndex, bool full_bfs = false,
+              bool direction_optimizing = false) {
 
     size_t graphSize;
     DIA<BfsNode> graph = LoadBFSGraph(ctx, graphSize, input_path, startIndex);
 
-    auto result = BFS(graph, graphSize, startIndex, full_bfs);
+    auto result = BFS(graph, graphSize, startIndex, full_bfs,
+                      direction_optimizing);
     outputBFSResult(result.graph, result.treeInfos.size(), output_path);
     return result;
 }
@@ -249,11 +373,12 @@ BfsResult BFS(thrill::Context& ctx,
 size_t doubleSweepDiameter(
     thrill::Context& ctx,
     std::string input_path, std::string output_path, std::string output_path2,
-    VertexId startIndex) {
+    VertexId startIndex, bool direction_optimizing = false) {
 
     size_t graphSize;
     DIA<BfsNode> graph = LoadBFSGraph(ctx, graphSize, input_path, startIndex);
-    auto firstBFS = BFS(graph, graphSize, startIndex);
+    auto firstBFS = BFS(graph, graphSize, startIndex, /* full_bfs */ false,
+                        direction_optimizing);
 
     outputBFSResult(firstBFS.graph, firstBFS.treeInfos.size(), output_path);
 
@@ -286,7 +411,8 @@ size_t doubleSweepDiameter(
                  return emitNode;
              }).Collapse();
 
-    auto secondBFS = BFS(secondGraph, graphSize, startIndex);
+    auto secondBFS = BFS(secondGraph, graphSize, startIndex,
+                         /* full_bfs */ false, direction_optimizing);
 
     auto diameter = secondBFS.treeInfos.front().levels;
 
@@ -325,6 +451,11 @@ int main(int argc, char* argv[]) {
     clp.add_flag('d', "diameter", diameter,
                  "calculate approximate diameter using two BFS sweeps");
 
+    bool direction_optimizing = false;
+    clp.add_flag('o', "direction-optimizing", direction_optimizing,
+                 "switch to bottom-up levels with compressed frontiers when "
+                 "the frontier is large, requires an undirected graph");
+
     if (!clp.process(argc, argv))
         return -1;
 
@@ -333,10 +464,11 @@ int main(int argc, char* argv[]) {
     return thrill::Run(
         [&](thrill::Context& ctx) {
             if (!diameter)
-                BFS(ctx, input_path, output_path, /* startIndex */ 0, full_bfs);
+                BFS(ctx, input_path, output_path, /* startIndex */ 0, full_bfs,
+                    direction_optimizing);
             else
                 doubleSweepDiameter(ctx, input_path, output_path, output_path2,
-                                    /* startIndex */ 0);
+                                    /* startIndex */ 0, direction_optimizing);
         });
 }
 
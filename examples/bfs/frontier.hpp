@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * examples/bfs/frontier.hpp
+ *
+ * Exchange of compressed BFS frontier vertex sets between all workers.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_EXAMPLES_BFS_FRONTIER_HEADER
+#define THRILL_EXAMPLES_BFS_FRONTIER_HEADER
+
+#include "bfs.hpp"
+
+#include <thrill/api/context.hpp>
+#include <thrill/core/delta_stream.hpp>
+#include <thrill/core/golomb_bit_stream.hpp>
+#include <thrill/data/cat_stream.hpp>
+#include <tlx/math/integer_log2.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace examples {
+namespace bfs {
+
+//! encodings of a local frontier on the wire
+enum class FrontierCoding : size_t { Golomb = 0, Bitmap = 1 };
+
+//! Golomb parameter for count sorted vertices spread over range: ln(2) times
+//! the mean gap is optimal for geometrically distributed gaps. The Golomb
+//! reader requires b >= 3.
+static inline size_t FrontierGolombParameter(size_t range, size_t count) {
+    return std::max<size_t>(3, range / count * 69 / 100);
+}
+
+/*!
+ * Write the sorted local frontier vertices either as Golomb-coded deltas or as
+ * a bitmap of the vertex range they span, whichever is estimated smaller.
+ * Sparse frontiers of the first and last BFS levels are therefore Golomb-coded,
+ * while the dense frontiers of the middle levels of low-diameter graphs are
+ * shipped with one bit per vertex.
+ */
+template <typename BlockWriter>
+void WriteFrontier(BlockWriter& writer, const std::vector<VertexId>& frontier) {
+    if (frontier.empty()) {
+        writer.PutRaw(FrontierCoding::Golomb);
+        writer.PutRaw(size_t(0));
+        return;
+    }
+
+    const VertexId first = frontier.front();
+    const size_t range = frontier.back() - first + 1;
+    const size_t count = frontier.size();
+    const size_t b = FrontierGolombParameter(range, count);
+
+    // estimated bits of the Golomb code: unary quotient, stop bit, remainder
+    size_t golomb_bits =
+        count * (range / count / b + 1 + tlx::integer_log2_ceil(b));
+
+    if (range <= golomb_bits) {
+        writer.PutRaw(FrontierCoding::Bitmap);
+        writer.PutRaw(first);
+        size_t num_words = (range + 63) / 64;
+        writer.PutRaw(num_words);
+
+        auto it = frontier.begin();
+        for (size_t w = 0; w < num_words; ++w) {
+            size_t word = 0;
+            VertexId end = first + (w + 1) * 64;
+            for ( ; it != frontier.end() && *it < end; ++it)
+                word |= size_t(1) << ((*it - first) % 64);
+            writer.PutRaw(word);
+        }
+    }
+    else {
+        writer.PutRaw(FrontierCoding::Golomb);
+        writer.PutRaw(count);
+        writer.PutRaw(b);
+
+        thrill::core::GolombBitStreamWriter<BlockWriter> golomb_writer(
+            writer, b);
+        thrill::core::DeltaStreamWriter<
+            thrill::core::GolombBitStreamWriter<BlockWriter>,
+            size_t, /* offset */ 1> delta_writer(
+            golomb_writer, /* initial */ size_t(-1) /* cancels with +1 bias */);
+
+        for (const VertexId& v : frontier)
+            delta_writer.Put(v);
+    }
+}
+
+//! Read a local frontier written by WriteFrontier() into the bitmap.
+template <typename BlockReader>
+void ReadFrontier(BlockReader& reader, std::vector<bool>& bitmap) {
+    FrontierCoding coding = reader.template GetRaw<FrontierCoding>();
+
+    if (coding == FrontierCoding::Bitmap) {
+        VertexId first = reader.template GetRaw<VertexId>();
+        size_t num_words = reader.template GetRaw<size_t>();
+        for (size_t w = 0; w < num_words; ++w) {
+            size_t word = reader.template GetRaw<size_t>();
+            for (size_t bit = 0; word != 0; ++bit, word >>= 1) {
+                if (word & 1)
+                    bitmap[first + w * 64 + bit] = true;
+            }
+        }
+    }
+    else {
+        size_t count = reader.template GetRaw<size_t>();
+        if (count == 0) return;
+        size_t b = reader.template GetRaw<size_t>();
+
+        thrill::core::GolombBitStreamReader<BlockReader> golomb_reader(
+            reader, b);
+        thrill::core::DeltaStreamReader<
+            thrill::core::GolombBitStreamReader<BlockReader>,
+            size_t, /* offset */ 1> delta_reader(
+            golomb_reader, /* initial */ size_t(-1) /* cancels with +1 bias */);
+
+        for (size_t i = 0; i < count; ++i)
+            bitmap[delta_reader.template Next<size_t>()] = true;
+    }
+}
+
+/*!
+ * Broadcast the sorted local frontier of each worker to all workers, and
+ * return the global frontier as a bitmap over all graph_size vertices. This is
+ * a collective operation, which must be called on all workers with the same
+ * dia_id.
+ */
+static inline std::vector<bool> ExchangeFrontier(
+    thrill::Context& ctx, size_t dia_id,
+    const std::vector<VertexId>& frontier, size_t graph_size) {
+
+    thrill::data::CatStreamPtr stream = ctx.GetNewCatStream(dia_id);
+
+    thrill::data::CatStream::Writers writers = stream->GetWriters();
+    for (size_t i = 0; i < writers.size(); ++i)
+        WriteFrontier(writers[i], frontier);
+    writers.Close();
+
+    std::vector<bool> bitmap(graph_size);
+    std::vector<thrill::data::CatStream::Reader> readers =
+        stream->GetReaders();
+    for (thrill::data::CatStream::Reader& reader : readers)
+        ReadFrontier(reader, bitmap);
+
+    return bitmap;
+}
+
+} // namespace bfs
+} // namespace examples
+
+#endif // !THRILL_EXAMPLES_BFS_FRONTIER_HEADER
+
+/******************************************************************************/
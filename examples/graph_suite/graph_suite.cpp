@@ -0,0 +1,416 @@
+/*******************************************************************************
+ * examples/graph_suite/graph_suite.cpp
+ *
+ * Graph analytics benchmark suite: generates a Zipf or R-MAT graph, then runs
+ * BFS, PageRank, connected components, and triangle counting on it and reports
+ * the processed edges per second and host of each algorithm.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <examples/page_rank/page_rank.hpp>
+#include <examples/page_rank/zipf_graph_gen.hpp>
+#include <examples/triangles/triangles.hpp>
+
+#include <thrill/api/cache.hpp>
+#include <thrill/api/collapse.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/group_to_index.hpp>
+#include <thrill/api/reduce_by_key.hpp>
+#include <thrill/api/reduce_to_index.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sum.hpp>
+#include <thrill/api/zip.hpp>
+#include <thrill/api/zip_with_index.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill;              // NOLINT
+using examples::page_rank::OutgoingLinks;
+using examples::page_rank::ZipfGraphGen;
+
+using Node = size_t;
+using Edge = std::pair<Node, Node>;
+
+//! label of nodes not reached by BFS
+static constexpr size_t kUnreached = std::numeric_limits<size_t>::max();
+
+//! a node and a value sent to it: a BFS level or a component label
+struct NodeValue {
+    Node   node;
+    size_t value;
+} TLX_ATTRIBUTE_PACKED;
+
+/******************************************************************************/
+// Graph Generation
+
+/*!
+ * R-MAT edge generator with the parameters of the Graph500 benchmark: each edge
+ * recursively picks one of the four quadrants of the adjacency matrix with
+ * probabilities a, b, c, and 1-a-b-c. The node ids are scrambled to remove the
+ * locality of low ids.
+ */
+class RmatGraphGen
+{
+public:
+    RmatGraphGen(size_t scale, double a, double b, double c)
+        : scale_(scale), a_(a), b_(b), c_(c) { }
+
+    size_t num_nodes() const { return size_t(1) << scale_; }
+
+    template <typename Generator>
+    Edge GenerateEdge(Generator& rng) {
+        Node src = 0, tgt = 0;
+        for (size_t i = 0; i < scale_; ++i) {
+            double r = dist_(rng);
+            src <<= 1, tgt <<= 1;
+            if (r < a_) { }
+            else if (r < a_ + b_) tgt |= 1;
+            else if (r < a_ + b_ + c_) src |= 1;
+            else src |= 1, tgt |= 1;
+        }
+        return Edge(Scramble(src), Scramble(tgt));
+    }
+
+private:
+    //! log2 of the number of nodes
+    size_t scale_;
+
+    //! quadrant probabilities
+    double a_, b_, c_;
+
+    std::uniform_real_distribution<double> dist_ { 0.0, 1.0 };
+
+    //! multiplication by an odd number is a permutation modulo 2^scale
+    Node Scramble(Node x) const {
+        return (x * 0x9E3779B97F4A7C15ull) & (num_nodes() - 1);
+    }
+};
+
+//! group the edges into an adjacency list of each node, indexed by node
+template <typename Stack>
+static DIA<OutgoingLinks> AdjacencyLists(
+    const DIA<Edge, Stack>& edges, size_t num_nodes) {
+    return edges.template GroupToIndex<OutgoingLinks>(
+        [](const Edge& e) { return e.first; },
+        [all = OutgoingLinks()](auto& r, const Node&) mutable {
+            all.clear();
+            while (r.HasNext()) {
+                all.push_back(r.Next().second);
+            }
+            return all;
+        },
+        num_nodes).Cache();
+}
+
+/******************************************************************************/
+// Algorithms, each returns the number of iterations
+
+//! level-synchronous BFS from node 0 along the directed edges
+static size_t Bfs(const DIA<OutgoingLinks>& links, size_t num_nodes,
+                  size_t* reached) {
+    api::Context& ctx = links.context();
+
+    DIA<size_t> levels =
+        Generate(ctx, num_nodes,
+                 [](size_t index) { return index == 0 ? 0 : kUnreached; })
+        .Cache();
+
+    size_t level = 0;
+    for (size_t frontier = 1; frontier != 0; ++level) {
+        // send level + 1 to the neighbors of the frontier, keep the minimum
+        auto next =
+            links.Zip(levels,
+                      [](const OutgoingLinks& ol, const size_t& l) {
+                          return std::make_pair(ol, l);
+                      })
+            .template FlatMap<NodeValue>(
+                [level](const std::pair<OutgoingLinks, size_t>& p, auto emit) {
+                    if (p.second != level) return;
+                    for (const Node& tgt : p.first)
+                        emit(NodeValue { tgt, level + 1 });
+                })
+            .ReduceToIndex(
+                [](const NodeValue& m) { return m.node; },
+                [](const NodeValue& a, const NodeValue&) { return a; },
+                num_nodes, NodeValue { 0, kUnreached });
+
+        levels =
+            next.Zip(levels,
+                     [](const NodeValue& m, const size_t& l) {
+                         return std::min(m.value, l);
+                     })
+            .Cache();
+
+        frontier =
+            levels.Filter([level](const size_t& l) { return l == level + 1; })
+            .Size();
+    }
+
+    *reached =
+        levels.Filter([](const size_t& l) { return l != kUnreached; }).Size();
+    return level;
+}
+
+//! connected components of the undirected graph by label propagation of the
+//! minimum node id
+static size_t ConnectedComponents(const DIA<OutgoingLinks>& links,
+                                  size_t num_nodes, size_t* components) {
+    api::Context& ctx = links.context();
+
+    DIA<size_t> labels =
+        Generate(ctx, num_nodes, [](size_t index) { return index; }).Cache();
+
+    size_t iterations = 0;
+    for (size_t changed = 1; changed != 0; ++iterations) {
+        auto messages =
+            links.Zip(labels,
+                      [](const OutgoingLinks& ol, const size_t& l) {
+                          return std::make_pair(ol, l);
+                      })
+            .template FlatMap<NodeValue>(
+                [](const std::pair<OutgoingLinks, size_t>& p, auto emit) {
+                    for (const Node& tgt : p.first)
+                        emit(NodeValue { tgt, p.second });
+                })
+            .ReduceToIndex(
+                [](const NodeValue& m) { return m.node; },
+                [](const NodeValue& a, const NodeValue& b) {
+                    return a.value < b.value ? a : b;
+                },
+                num_nodes, NodeValue { 0, kUnreached });
+
+        DIA<size_t> next =
+            messages.Zip(labels,
+                         [](const NodeValue& m, const size_t& l) {
+                             return std::min(m.value, l);
+                         })
+            .Cache();
+
+        changed =
+            next.Zip(labels,
+                     [](const size_t& a, const size_t& b) {
+                         return static_cast<size_t>(a != b);
+                     })
+            .Sum();
+
+        labels = next;
+    }
+
+    // each component is labeled by its minimum node id
+    *components =
+        labels.ZipWithIndex(
+            [](const size_t& label, const size_t& index) {
+                return static_cast<size_t>(label == index);
+            })
+        .Sum();
+    return iterations;
+}
+
+//! count the triangles of the undirected graph without self-loops
+template <typename Stack>
+static size_t Triangles(const DIA<Edge, Stack>& edges, size_t* triangles) {
+    // orient each edge from the smaller to the larger id, without duplicates
+    auto oriented =
+        edges
+        .Filter([](const Edge& e) { return e.first != e.second; })
+        .Map([](const Edge& e) {
+                 return Edge(std::min(e.first, e.second),
+                             std::max(e.first, e.second));
+             })
+        .ReduceByKey(
+            [](const Edge& e) { return e; },
+            [](const Edge& a, const Edge&) { return a; })
+        .Cache();
+
+    *triangles = examples::triangles::CountTriangles(oriented);
+    return 1;
+}
+
+/******************************************************************************/
+
+int main(int argc, char* argv[]) {
+
+    tlx::CmdlineParser clp;
+
+    clp.set_description(
+        "Graph analytics benchmark suite on a generated Zipf or R-MAT graph: "
+        "BFS, PageRank, connected components, and triangle counting.");
+
+    std::string graph = "rmat";
+    clp.add_string('g', "graph", graph,
+                   "graph generator: zipf (page_rank's ZipfGraphGen), "
+                   "rmat (Graph500 R-MAT), default: rmat");
+
+    std::string algorithms = "bfs,pagerank,cc,triangles";
+    clp.add_string('a', "algorithms", algorithms,
+                   "comma separated list of algorithms: bfs, pagerank, cc, "
+                   "triangles, default: all");
+
+    unsigned scale = 16;
+    clp.add_unsigned('s', "scale", scale,
+                     "R-MAT: log2 of the number of nodes, default: 16");
+
+    unsigned edge_factor = 16;
+    clp.add_unsigned('e', "edge_factor", edge_factor,
+                     "R-MAT: edges per node, default: 16");
+
+    double rmat_a = 0.57, rmat_b = 0.19, rmat_c = 0.19;
+    clp.add_double('A', "rmat_a", rmat_a, "R-MAT: probability a, default: 0.57");
+    clp.add_double('B', "rmat_b", rmat_b, "R-MAT: probability b, default: 0.19");
+    clp.add_double('C', "rmat_c", rmat_c, "R-MAT: probability c, default: 0.19");
+
+    uint64_t pages = 65536;
+    clp.add_bytes('n', "pages", pages,
+                  "Zipf: number of nodes, default: 65536");
+
+    ZipfGraphGen gen(1);
+    clp.add_double('m', "size_mean", gen.size_mean,
+                   "Zipf: mean of outgoing links, default: "
+                   + std::to_string(gen.size_mean));
+    clp.add_double('z', "link_zipf_exponent", gen.link_zipf_exponent,
+                   "Zipf: exponent of link targets, default: "
+                   + std::to_string(gen.link_zipf_exponent));
+
+    unsigned iterations = 10;
+    clp.add_unsigned('i', "iterations", iterations,
+                     "PageRank iterations, default: 10");
+
+    if (!clp.process(argc, argv)) {
+        return -1;
+    }
+
+    clp.print_result();
+
+    die_unless(graph == "zipf" || graph == "rmat");
+
+    return api::Run(
+        [&](api::Context& ctx) {
+            common::StatsTimerStart gen_timer;
+
+            size_t num_nodes;
+            DIA<Edge> edges;
+
+            if (graph == "zipf") {
+                num_nodes = pages;
+                edges =
+                    Generate(
+                        ctx, num_nodes,
+                        [graph_gen = ZipfGraphGen(gen, num_nodes),
+                         rng = std::default_random_engine(
+                             std::random_device { } ())](
+                            size_t index) mutable {
+                            return std::make_pair(
+                                index, graph_gen.GenerateOutgoing(rng));
+                        })
+                    .template FlatMap<Edge>(
+                        [](const std::pair<Node, OutgoingLinks>& p, auto emit) {
+                            for (const Node& tgt : p.second)
+                                emit(Edge(p.first, tgt));
+                        })
+                    .Cache().Execute();
+            }
+            else {
+                RmatGraphGen rmat(scale, rmat_a, rmat_b, rmat_c);
+                num_nodes = rmat.num_nodes();
+                edges =
+                    Generate(
+                        ctx, num_nodes * edge_factor,
+                        [rmat, rng = std::default_random_engine(
+                             std::random_device { } ())](size_t) mutable {
+                            return rmat.GenerateEdge(rng);
+                        })
+                    .Cache().Execute();
+            }
+
+            size_t num_edges = edges.Size();
+            ctx.net.Barrier();
+            gen_timer.Stop();
+
+            auto print_result =
+                [&](const std::string& algorithm, size_t iters,
+                    const common::StatsTimer& timer, const std::string& extra) {
+                    if (ctx.my_rank() != 0) return;
+                    double edges_per_s =
+                        static_cast<double>(num_edges) / timer.SecondsDouble();
+                    LOG1 << "RESULT benchmark=graph_suite"
+                         << " algorithm=" << algorithm
+                         << " graph=" << graph
+                         << " nodes=" << num_nodes
+                         << " edges=" << num_edges
+                         << " iterations=" << iters
+                         << " time=" << timer
+                         << " edges_per_s=" << edges_per_s
+                         << " edges_per_s_per_host="
+                         << edges_per_s / static_cast<double>(ctx.num_hosts())
+                         << extra
+                         << " traffic=" << ctx.net_manager().Traffic()
+                         << " hosts=" << ctx.num_hosts()
+                         << " workers=" << ctx.num_workers();
+                };
+
+            print_result("generate", 1, gen_timer, "");
+
+            // adjacency lists are built once, outside the algorithm timers
+            DIA<OutgoingLinks> links, undirected;
+            for (const std::string& a : tlx::split(',', algorithms)) {
+                if ((a == "bfs" || a == "pagerank") && !links.IsValid())
+                    links = AdjacencyLists(edges, num_nodes);
+                if (a == "cc" && !undirected.IsValid()) {
+                    undirected = AdjacencyLists(
+                        edges.template FlatMap<Edge>(
+                            [](const Edge& e, auto emit) {
+                                emit(e);
+                                emit(Edge(e.second, e.first));
+                            }),
+                        num_nodes);
+                }
+            }
+
+            for (const std::string& a : tlx::split(',', algorithms)) {
+                ctx.net.Barrier();
+                common::StatsTimerStart timer;
+                size_t iters, count;
+                std::string extra;
+
+                if (a == "bfs") {
+                    iters = Bfs(links, num_nodes, &count);
+                    extra = " reached=" + std::to_string(count);
+                }
+                else if (a == "pagerank") {
+                    examples::page_rank::PageRank(
+                        links, num_nodes, iterations).Execute();
+                    iters = iterations;
+                }
+                else if (a == "cc") {
+                    iters = ConnectedComponents(undirected, num_nodes, &count);
+                    extra = " components=" + std::to_string(count);
+                }
+                else if (a == "triangles") {
+                    iters = Triangles(edges, &count);
+                    extra = " triangles=" + std::to_string(count);
+                }
+                else {
+                    die("Unknown algorithm " << a);
+                }
+
+                ctx.net.Barrier();
+                timer.Stop();
+                print_result(a, iters, timer, extra);
+            }
+        });
+}
+
+/******************************************************************************/
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * examples/job_server/job_server.cpp
+ *
+ * A long-running job server, which reads job requests from stdin or a named
+ * pipe, and runs them without setting up the hosts and network for each job.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/generate.hpp>
+#include <thrill/api/job_server.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/common/logger.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+int main(int argc, char* argv[]) {
+
+    tlx::CmdlineParser clp;
+    clp.set_description(
+        "Reads lines \"[mem=<size>] <library> <function> [args...]\" and runs "
+        "the extern \"C\" function of the shared library as a job, or one of "
+        "the built-in jobs \"- sleep <seconds>\" and \"- size <n>\".");
+
+    std::string requests_path;
+    clp.add_opt_param_string(
+        "requests", requests_path,
+        "file or named pipe to read requests from, default: stdin");
+
+    if (!clp.process(argc, argv))
+        return -1;
+
+    // built-in jobs to measure the remaining per-job overhead
+    api::RegisterJobFunction(
+        "sleep", [](api::Context& ctx, const std::vector<std::string>& args) {
+            unsigned seconds = args.empty() ? 0 : std::stoul(args[0]);
+            Generate(ctx, ctx.num_workers())
+            .Map([seconds](size_t i) {
+                     std::this_thread::sleep_for(std::chrono::seconds(seconds));
+                     return i;
+                 })
+            .Size();
+        });
+
+    api::RegisterJobFunction(
+        "size", [](api::Context& ctx, const std::vector<std::string>& args) {
+            size_t n = args.empty() ? 0 : std::stoul(args[0]);
+            size_t size = Generate(ctx, n).Size();
+            if (ctx.my_rank() == 0)
+                LOG1 << "size: " << size;
+        });
+
+    if (requests_path.empty())
+        return api::RunJobServer(std::cin);
+
+    std::ifstream requests(requests_path);
+    die_unless(requests.good());
+    return api::RunJobServer(requests);
+}
+
+/******************************************************************************/
@@ -14,17 +14,24 @@
 #define THRILL_EXAMPLES_K_MEANS_K_MEANS_HEADER
 
 #include <thrill/api/all_gather.hpp>
+#include <thrill/api/bernoulli_sample.hpp>
 #include <thrill/api/cache.hpp>
 #include <thrill/api/collapse.hpp>
+#include <thrill/api/gather.hpp>
+#include <thrill/api/iterate.hpp>
 #include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/sample.hpp>
+#include <thrill/api/size.hpp>
 #include <thrill/api/sum.hpp>
 #include <thrill/common/vector.hpp>
 
 #include <cereal/types/vector.hpp>
 #include <thrill/data/serialization_cereal.hpp>
 
+#include <algorithm>
 #include <limits>
+#include <memory>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -68,6 +75,106 @@ struct ClosestCentroid {
     }
 };
 
+/*!
+ * The centroids in a transposed layout for the blocked distance kernel. The
+ * squared distances of a point to a tile of centroids are calculated as
+ * |c|^2 - 2 p.c (plus |p|^2), dimension by dimension. The coordinates of the
+ * tile's centroids in each dimension are contiguous, hence the inner loops run
+ * over plain arrays of doubles, which the compiler vectorizes with whatever
+ * SIMD instructions the target has.
+ */
+template <typename Point>
+class CentroidTable
+{
+public:
+    //! number of centroids whose distances are kept in registers together
+    static constexpr size_t tile_size = 64;
+
+    CentroidTable() = default;
+
+    explicit CentroidTable(const std::vector<Point>& centroids)
+        : centroids_(centroids) {
+        const size_t k = centroids_.size();
+        dim_ = k ? centroids_[0].size() : 0;
+
+        coords_.resize(dim_ * k);
+        norms_.resize(k);
+        for (size_t j = 0; j < k; ++j) {
+            double norm = 0.0;
+            for (size_t d = 0; d < dim_; ++d) {
+                double x = centroids_[j].x[d];
+                coords_[d * k + j] = x;
+                norm += x * x;
+            }
+            norms_[j] = norm;
+        }
+    }
+
+    //! the centroids in cluster id order
+    const std::vector<Point>& centroids() const { return centroids_; }
+
+    //! number of centroids
+    size_t size() const { return centroids_.size(); }
+
+    //! Calculate the closest centroid to p, and optionally its squared
+    //! distance.
+    size_t Closest(const Point& p, double* min_dist = nullptr) const {
+        assert(!centroids_.empty());
+        const size_t k = centroids_.size();
+
+        double tile[tile_size];
+        double best = std::numeric_limits<double>::max();
+        size_t best_id = 0;
+
+        for (size_t t = 0; t < k; t += tile_size) {
+            const size_t n = k - t < tile_size ? k - t : tile_size;
+
+            const double* norms = norms_.data() + t;
+            for (size_t j = 0; j < n; ++j) tile[j] = norms[j];
+
+            for (size_t d = 0; d < dim_; ++d) {
+                const double px = -2.0 * p.x[d];
+                const double* row = coords_.data() + d * k + t;
+                for (size_t j = 0; j < n; ++j) tile[j] += px * row[j];
+            }
+
+            for (size_t j = 0; j < n; ++j) {
+                if (tile[j] < best) {
+                    best = tile[j];
+                    best_id = t + j;
+                }
+            }
+        }
+
+        if (min_dist) {
+            double norm = 0.0;
+            for (size_t d = 0; d < dim_; ++d) norm += p.x[d] * p.x[d];
+            // the expansion may cancel slightly below zero
+            *min_dist = std::max(0.0, best + norm);
+        }
+        return best_id;
+    }
+
+    //! serialization method for cereal, e.g. for Context::Broadcast().
+    template <typename Archive>
+    void serialize(Archive& archive) {
+        archive(dim_, centroids_, coords_, norms_);
+    }
+
+private:
+    //! dimensions of the points
+    size_t dim_ = 0;
+
+    //! centroids in cluster id order
+    std::vector<Point> centroids_;
+
+    //! coordinates of centroid j in dimension d at [d * size() + j]
+    std::vector<double> coords_;
+
+    //! squared norms of the centroids
+    std::vector<double> norms_;
+};
+
 //! Model returned by KMeans algorithm containing results.
 template <typename Point>
 class KMeansModel
@@ -76,7 +183,7 @@ public:
     KMeansModel(size_t dimensions, size_t num_clusters, size_t iterations,
                 const std::vector<Point>& centroids)
         : dimensions_(dimensions), num_clusters_(num_clusters),
-          iterations_(iterations), centroids_(centroids)
+          iterations_(iterations), table_(centroids)
     { }
 
     //! \name Accessors
@@ -91,8 +198,8 @@ public:
     //! Returns iterations_
     size_t iterations() const { return iterations_; }
 
-    //! Returns centroids_
-    const std::vector<Point>& centroids() const { return centroids_; }
+    //! Returns centroids
+    const std::vector<Point>& centroids() const { return table_.centroids(); }
 
     //! \}
 
@@ -101,16 +208,7 @@ public:
 
     //! Calculate closest cluster to point
     size_t Classify(const Point& p) const {
-        double min_dist = p.DistanceSquare(centroids_[0]);
-        size_t closest_id = 0;
-        for (size_t i = 1; i < centroids_.size(); ++i) {
-            double dist = p.DistanceSquare(centroids_[i]);
-            if (dist < min_dist) {
-                min_dist = dist;
-                closest_id = i;
-            }
-        }
-        return closest_id;
+        return table_.Closest(p);
     }
 
     //! Calculate closest cluster to all points, returns DIA containing only the
@@ -133,13 +231,8 @@ public:
 
     //! Calculate the k-means cost: the squared distance to the nearest center.
     double ComputeCost(const Point& p) const {
-        double min_dist = p.DistanceSquare(centroids_[0]);
-        for (size_t i = 1; i < centroids_.size(); ++i) {
-            double dist = p.DistanceSquare(centroids_[i]);
-            if (dist < min_dist) {
-                min_dist = dist;
-            }
-        }
+        double min_dist;
+        table_.Closest(p, &min_dist);
         return min_dist;
     }
 
@@ -165,92 +258,295 @@ private:
     size_t iterations_;
 
     //! computed centroids in cluster id order
-    std::vector<Point> centroids_;
+    CentroidTable<Point> table_;
 };
 
-//! Calculate k-Means using Lloyd's Algorithm. The DIA centroids is both an
-//! input and an output parameter. The method returns a std::pair<Point2D,
-//! size_t> = Point2DClusterId into the centroids for each input point.
-template <typename Point, typename InStack>
-auto KMeans(const DIA<Point, InStack>& input_points, size_t dimensions,
-            size_t num_clusters, size_t iterations, double epsilon = 0.0) {
+//! Method to choose the initial centroids
+enum class KMeansInit {
+    //! a uniform random sample of the points
+    Random,
+    //! k-means|| by Bahmani et al.: oversample points by their distance to the
+    //! candidates in a few rounds, and reduce the weighted candidates with
+    //! k-means++.
+    Parallel
+};
 
-    auto points = input_points.Cache();
+//! Broadcast the centroids of worker 0 to all workers, which share one
+//! CentroidTable per host.
+template <typename Point>
+std::shared_ptr<const CentroidTable<Point> >
+BroadcastCentroids(thrill::Context& ctx, const std::vector<Point>& centroids) {
+    return ctx.Broadcast(
+        ctx.my_rank() == 0 ? CentroidTable<Point>(centroids)
+        : CentroidTable<Point>());
+}
 
-    bool break_condition = false;
+//! Sum up the points closest to each centroid, returns a DIA of
+//! ClosestCentroid with the sum and count of the points of each cluster.
+template <typename Point, typename PointDIA>
+auto SumClosest(const PointDIA& points,
+                const std::shared_ptr<const CentroidTable<Point> >& table) {
 
     using ClosestCentroid = ClosestCentroid<Point>;
     using CentroidAccumulated = CentroidAccumulated<Point>;
 
-    std::vector<Point> local_centroids =
-        points.Keep().Sample(num_clusters).AllGather();
+    return points
+           .Map([table](const Point& p) {
+                    return ClosestCentroid {
+                        table->Closest(p), CentroidAccumulated { p, 1 }
+                    };
+                })
+           .ReduceByKey(
+               [](const ClosestCentroid& cc) { return cc.cluster_id; },
+               [](const ClosestCentroid& a, const ClosestCentroid& b) {
+                   return ClosestCentroid {
+                       a.cluster_id,
+                       CentroidAccumulated { a.center.p + b.center.p,
+                                             a.center.count + b.center.count }
+                   };
+               });
+}
 
-    for (size_t iter = 0; iter < iterations && !break_condition; ++iter) {
+/*!
+ * Choose num_clusters of the weighted candidates with k-means++: the first
+ * proportional to its weight, and each further one proportional to its weight
+ * times its squared distance to the chosen ones. The result depends only on
+ * the arguments, hence it is equal on all workers.
+ */
+template <typename Point>
+std::vector<Point> WeightedKMeansPlusPlus(
+    const std::vector<Point>& candidates, const std::vector<double>& weights,
+    size_t num_clusters, size_t seed) {
+
+    if (candidates.size() <= num_clusters) return candidates;
+
+    std::default_random_engine rng(seed);
+
+    std::vector<Point> centers;
+    centers.push_back(
+        candidates[std::discrete_distribution<size_t>(
+                       weights.begin(), weights.end())(rng)]);
+
+    std::vector<double> min_dist(
+        candidates.size(), std::numeric_limits<double>::max());
+    std::vector<double> prob(candidates.size());
+
+    while (centers.size() < num_clusters) {
+        double total = 0.0;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            min_dist[i] = std::min(
+                min_dist[i], candidates[i].DistanceSquare(centers.back()));
+            prob[i] = weights[i] * min_dist[i];
+            total += prob[i];
+        }
+        // all remaining candidates coincide with centers
+        if (total == 0.0) break;
 
-        std::vector<Point> old_centroids = local_centroids;
+        centers.push_back(
+            candidates[std::discrete_distribution<size_t>(
+                           prob.begin(), prob.end())(rng)]);
+    }
+    return centers;
+}
 
-        // calculate the closest centroid for each point
-        auto closest = points.Keep().Map(
-            [&local_centroids](const Point& p) {
-                assert(local_centroids.size());
-                double min_dist = p.DistanceSquare(local_centroids[0]);
-                size_t closest_id = 0;
+/*!
+ * Choose initial centroids with k-means|| (Bahmani et al., Scalable K-Means++,
+ * VLDB 2012). Starting with one random point, each round samples every point
+ * with probability proportional to its squared distance to the candidates,
+ * such that about 2 * num_clusters points are added per round. The candidates
+ * are then weighted by the number of points closest to them and reduced to
+ * num_clusters with k-means++. The points should be cached.
+ */
+template <typename Point, typename InStack>
+std::vector<Point> KMeansParallelInit(
+    const DIA<Point, InStack>& points, size_t num_clusters,
+    size_t rounds = 5, size_t seed = 123456) {
 
-                for (size_t i = 1; i < local_centroids.size(); ++i) {
-                    double dist = p.DistanceSquare(local_centroids[i]);
-                    if (dist < min_dist) {
-                        min_dist = dist;
-                        closest_id = i;
-                    }
-                }
-                return ClosestCentroid {
-                    closest_id, CentroidAccumulated { p, 1 }
-                };
-            });
+    thrill::Context& ctx = points.context();
 
-        // Calculate new centroids as the mean of all points associated with it.
-        auto centroids =
-            closest
-            .ReduceByKey(
-                [](const ClosestCentroid& cc) { return cc.cluster_id; },
-                [](const ClosestCentroid& a, const ClosestCentroid& b) {
-                    return ClosestCentroid {
-                        a.cluster_id,
-                        CentroidAccumulated { a.center.p + b.center.p,
-                                              a.center.count + b.center.count }
-                    };
-                })
-            .Map([](const ClosestCentroid& cc) {
-                     return CentroidAccumulated {
-                         cc.center.p / static_cast<double>(cc.center.count),
-                         cc.cluster_id
-                     };
+    std::default_random_engine rng(seed + ctx.my_rank());
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    std::vector<Point> candidates = points.Keep().Sample(1).AllGather();
+    const double oversampling = 2.0 * num_clusters;
+
+    for (size_t r = 0; r < rounds; ++r) {
+        auto table = BroadcastCentroids(ctx, candidates);
+
+        double cost =
+            points.Keep()
+            .Map([table](const Point& p) {
+                     double dist;
+                     table->Closest(p, &dist);
+                     return dist;
                  })
-            .Collapse();
+            .Sum();
+        if (cost == 0.0) break;
+
+        std::vector<Point> sampled =
+            points.Keep()
+            .Filter([table, &rng, &uniform,
+                     factor = oversampling / cost](const Point& p) {
+                        double dist;
+                        table->Closest(p, &dist);
+                        return uniform(rng) < factor * dist;
+                    })
+            .AllGather();
+
+        candidates.insert(candidates.end(), sampled.begin(), sampled.end());
+    }
+
+    // weight the candidates by the number of points closest to them
+    auto table = BroadcastCentroids(ctx, candidates);
+
+    std::vector<double> weights(candidates.size());
+    for (const std::pair<size_t, size_t>& w :
+         points.Keep()
+         .Map([table](const Point& p) {
+                  return std::make_pair(table->Closest(p), size_t(1));
+              })
+         .ReducePair([](const size_t& a, const size_t& b) { return a + b; })
+         .AllGather()) {
+        weights[w.first] = static_cast<double>(w.second);
+    }
 
-        // collect centroids again, and put back into cluster order
-        for (const CentroidAccumulated& uc : centroids.AllGather()) {
-            local_centroids[uc.count] = uc.p;
+    std::vector<Point> centroids =
+        WeightedKMeansPlusPlus(candidates, weights, num_clusters, seed);
+
+    // few distinct points: fill up with random ones
+    if (centroids.size() < num_clusters) {
+        std::vector<Point> more =
+            points.Keep().Sample(num_clusters - centroids.size()).AllGather();
+        centroids.insert(centroids.end(), more.begin(), more.end());
+    }
+    return centroids;
+}
+
+//! Choose the initial centroids of the cached points
+template <typename Point, typename InStack>
+std::vector<Point> KMeansInitialCentroids(
+    const DIA<Point, InStack>& points, size_t num_clusters, KMeansInit init) {
+    if (init == KMeansInit::Parallel)
+        return KMeansParallelInit(points, num_clusters);
+    return points.Keep().Sample(num_clusters).AllGather();
+}
+
+/*!
+ * Calculate k-Means using Lloyd's Algorithm. In each iteration, the centroids
+ * are broadcast once per host into a shared CentroidTable, the points are
+ * classified with its blocked distance kernel, and the new centroids are the
+ * means of the points of each cluster.
+ */
+template <typename Point, typename InStack>
+auto KMeans(const DIA<Point, InStack>& input_points, size_t dimensions,
+            size_t num_clusters, size_t iterations, double epsilon = 0.0,
+            KMeansInit init = KMeansInit::Random) {
+
+    auto points = input_points.Cache();
+    thrill::Context& ctx = points.context();
+
+    using ClosestCentroid = ClosestCentroid<Point>;
+
+    auto table = BroadcastCentroids(
+        ctx, KMeansInitialCentroids(points, num_clusters, init));
+
+    for (size_t iter = 0; iter < iterations; ++iter) {
+
+        // Calculate new centroids as the mean of all points associated with
+        // it, and put them back into cluster order on worker 0.
+        std::vector<Point> new_centroids = table->centroids();
+        for (const ClosestCentroid& cc :
+             SumClosest(points.Keep(), table).Gather(0)) {
+            new_centroids[cc.cluster_id] =
+                cc.center.p / static_cast<double>(cc.center.count);
         }
 
+        auto old_table = table;
+        table = BroadcastCentroids(ctx, new_centroids);
+
         // Check whether centroid positions changed significantly, if yes do
         // another iteration. only check if epsilon > 0, otherwise we run a
         // fixed number of iterations.
         if (epsilon > 0) {
-            break_condition = true;
+            bool break_condition = true;
 
-            for (size_t i = 0; i < local_centroids.size(); ++i) {
-                if (local_centroids[i].Distance(old_centroids[i]) > epsilon) {
+            for (size_t i = 0; i < table->size(); ++i) {
+                if (table->centroids()[i].Distance(
+                        old_table->centroids()[i]) > epsilon) {
                     break_condition = false;
                     break;
                 }
             }
+            if (break_condition) break;
         }
     }
 
     return KMeansModel<Point>(
         dimensions, num_clusters, iterations,
-        local_centroids);
+        table->centroids());
+}
+
+/*!
+ * Calculate k-Means with mini-batches (Sculley, Web-Scale K-Means Clustering,
+ * WWW 2010). Each iteration classifies a Bernoulli sample of about batch_size
+ * points only, and moves each centroid towards the mean of its batch points
+ * by the fraction of all points its cluster has seen so far.
+ */
+template <typename Point, typename InStack>
+auto MiniBatchKMeans(const DIA<Point, InStack>& input_points,
+                     size_t dimensions, size_t num_clusters, size_t iterations,
+                     size_t batch_size,
+                     KMeansInit init = KMeansInit::Random) {
+
+    auto points = input_points.Cache();
+    thrill::Context& ctx = points.context();
+
+    using ClosestCentroid = ClosestCentroid<Point>;
+
+    const size_t total = points.Keep().Size();
+    const double fraction =
+        total ? std::min(1.0, static_cast<double>(batch_size) / total) : 1.0;
+
+    auto table = BroadcastCentroids(
+        ctx, KMeansInitialCentroids(points, num_clusters, init));
+
+    // number of points per cluster seen so far, only used on worker 0
+    std::vector<double> counts(table->size());
+
+    // sum up the points of a batch closest to each current centroid
+    auto classify_batch =
+        [&]() {
+            return SumClosest(points.Keep().BernoulliSample(fraction), table);
+        };
+
+    // move each centroid towards the mean of its batch points
+    auto update_centroids =
+        [&](const DIA<ClosestCentroid>& batch_sums) {
+            std::vector<Point> new_centroids = table->centroids();
+            for (const ClosestCentroid& cc : batch_sums.Gather(0)) {
+                Point& c = new_centroids[cc.cluster_id];
+                double n = static_cast<double>(cc.center.count);
+                counts[cc.cluster_id] += n;
+                c += (cc.center.p / n - c) / (counts[cc.cluster_id] / n);
+            }
+            table = BroadcastCentroids(ctx, new_centroids);
+        };
+
+    if (iterations != 0) {
+        // each iteration updates the centroids with the previous batch and
+        // classifies the next one.
+        DIA<ClosestCentroid> sums = Iterate(
+            classify_batch(), iterations - 1,
+            [&](const DIA<ClosestCentroid>& batch_sums, size_t /* iter */) {
+                update_centroids(batch_sums);
+                return classify_batch();
+            });
+        update_centroids(sums);
+    }
+
+    return KMeansModel<Point>(
+        dimensions, num_clusters, iterations,
+        table->centroids());
 }
 
 //! Calculate k-Means using bisecting method
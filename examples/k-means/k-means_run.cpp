@@ -105,10 +105,26 @@ void OutputSVG(const std::string& svg_path, double svg_scale,
     os << "</svg>\n";
 }
 
+//! Run the selected variant of k-means on the points
+template <typename Point, typename PointDIA>
+static KMeansModel<Point> RunKMeans(
+    const PointDIA& points, bool bisecting,
+    size_t dimensions, size_t num_clusters, size_t iterations, double eps,
+    KMeansInit init, size_t batch_size) {
+    if (bisecting)
+        return BisecKMeans(points, dimensions, num_clusters, iterations, eps);
+    if (batch_size != 0) {
+        return MiniBatchKMeans(points, dimensions, num_clusters, iterations,
+                               batch_size, init);
+    }
+    return KMeans(points, dimensions, num_clusters, iterations, eps, init);
+}
+
 template <typename Point>
 static void RunKMeansGenerated(
     thrill::Context& ctx, bool bisecting,
     size_t dimensions, size_t num_clusters, size_t iterations, double eps,
+    KMeansInit init, size_t batch_size,
     const std::string& svg_path, double svg_scale,
     const std::vector<std::string>& input_paths) {
 
@@ -130,9 +146,9 @@ static void RunKMeansGenerated(
             })
         .Cache().KeepForever();
 
-    auto result = bisecting ?
-                  BisecKMeans(points.Keep(), dimensions, num_clusters, iterations, eps) :
-                  KMeans(points.Keep(), dimensions, num_clusters, iterations, eps);
+    auto result = RunKMeans<Point>(
+        points.Keep(), bisecting, dimensions, num_clusters, iterations, eps,
+        init, batch_size);
 
     double cost = result.ComputeCost(points);
     if (ctx.my_rank() == 0)
@@ -152,6 +168,8 @@ static void RunKMeansGenerated(
              << " num_clusters=" << num_clusters
              << " iterations=" << iterations
              << " eps=" << eps
+             << " parallel_init=" << (init == KMeansInit::Parallel)
+             << " batch_size=" << batch_size
              << " cost=" << cost
              << " time=" << timer
              << " traffic=" << traffic.total()
@@ -163,6 +181,7 @@ template <typename Point>
 static void RunKMeansFile(
     thrill::Context& ctx, bool bisecting,
     size_t dimensions, size_t num_clusters, size_t iterations, double eps,
+    KMeansInit init, size_t batch_size,
     const std::string& svg_path, double svg_scale,
     const std::vector<std::string>& input_paths) {
 
@@ -188,9 +207,9 @@ static void RunKMeansFile(
                 return p;
             });
 
-    auto result = bisecting ?
-                  BisecKMeans(points.Keep(), dimensions, num_clusters, iterations, eps) :
-                  KMeans(points.Keep(), dimensions, num_clusters, iterations, eps);
+    auto result = RunKMeans<Point>(
+        points.Keep(), bisecting, dimensions, num_clusters, iterations, eps,
+        init, batch_size);
 
     double cost = result.ComputeCost(points.Keep());
     if (ctx.my_rank() == 0)
@@ -210,6 +229,8 @@ static void RunKMeansFile(
              << " num_clusters=" << num_clusters
              << " iterations=" << iterations
              << " eps=" << eps
+             << " parallel_init=" << (init == KMeansInit::Parallel)
+             << " batch_size=" << batch_size
              << " cost=" << cost
              << " time=" << timer
              << " traffic=" << traffic.total()
@@ -244,6 +265,15 @@ int main(int argc, char* argv[]) {
     clp.add_double('e', "epsilon", epsilon,
                    "centroid position delta for break condition, default: 0");
 
+    bool parallel_init = false;
+    clp.add_bool('p', "parallel-init", parallel_init,
+                 "choose initial centroids with k-means||");
+
+    size_t batch_size = 0;
+    clp.add_size_t('m', "mini-batch", batch_size,
+                   "run mini-batch k-Means with this many points per "
+                   "iteration, default: 0 (off)");
+
     std::string svg_path;
     clp.add_string('s', "svg", svg_path,
                    "output path for svg drawing (only for dim = 2)");
@@ -262,6 +292,9 @@ int main(int argc, char* argv[]) {
 
     clp.print_result();
 
+    KMeansInit init =
+        parallel_init ? KMeansInit::Parallel : KMeansInit::Random;
+
     auto start_func =
         [&](thrill::Context& ctx) {
             ctx.enable_consume();
@@ -273,17 +306,20 @@ int main(int argc, char* argv[]) {
                 case 2:
                     RunKMeansGenerated<Point<2> >(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                     break;
                 case 3:
                     RunKMeansGenerated<Point<3> >(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                     break;
                 default:
                     RunKMeansGenerated<VPoint>(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                 }
             }
             else {
@@ -293,17 +329,20 @@ int main(int argc, char* argv[]) {
                 case 2:
                     RunKMeansFile<Point<2> >(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                     break;
                 case 3:
                     RunKMeansFile<Point<3> >(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                     break;
                 default:
                     RunKMeansFile<VPoint>(
                         ctx, bisecting, dimensions, num_clusters, iterations,
-                        epsilon, svg_path, svg_scale, input_paths);
+                        epsilon, init, batch_size, svg_path, svg_scale,
+                        input_paths);
                 }
             }
         };
@@ -14,19 +14,25 @@
 #define THRILL_EXAMPLES_PAGE_RANK_PAGE_RANK_HEADER
 
 #include <thrill/api/collapse.hpp>
+#include <thrill/api/concat_to_dia.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/inner_join.hpp>
+#include <thrill/api/iterate.hpp>
 #include <thrill/api/print.hpp>
 #include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/reduce_to_index.hpp>
 #include <thrill/api/size.hpp>
 #include <thrill/api/zip.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/data/cat_stream.hpp>
 
 #include <tlx/string/join_generic.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <future>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -76,66 +82,245 @@ auto PageRank(const DIA<OutgoingLinks, InStack>& links,
 
     // initialize all ranks to 1.0 / n: (url, rank)
 
-    DIA<Rank> ranks =
+    auto initial_ranks =
         Generate(
             ctx, num_pages,
-            [num_pages_d](size_t) { return Rank(1.0) / num_pages_d; })
-        .Collapse();
+            [num_pages_d](size_t) { return Rank(1.0) / num_pages_d; });
 
     // do iterations
-    for (size_t iter = 0; iter < iterations; ++iter) {
+    return Iterate(
+        initial_ranks, iterations,
+        [&](const DIA<Rank>& ranks, size_t /* iter */) {
+
+            // for all outgoing link, get their rank contribution from all
+            // links by doing:
+            //
+            // 1) group all outgoing links with rank of its parent page: (Zip)
+            // ([linked_url, linked_url, ...], rank_parent)
+            //
+            // 2) compute rank contribution for each linked_url: (FlatMap)
+            // (linked_url, rank / outgoing.size)
+
+            auto outs_rank = links.Zip(
+                ranks,
+                [](const OutgoingLinks& ol, const Rank& r) {
+                    return OutgoingLinksRank(ol, r);
+                });
+
+            if (debug) {
+                outs_rank
+                .Map([](const OutgoingLinksRank& ol) {
+                         return tlx::join(',', ol.first)
+                         + " <- " + std::to_string(ol.second);
+                     })
+                .Print("outs_rank");
+            }
+
+            auto contribs = outs_rank.template FlatMap<PageRankPair>(
+                [](const OutgoingLinksRank& p, auto emit) {
+                    if (p.first.size() == 0)
+                        return;
+
+                    Rank rank_contrib =
+                        p.second / static_cast<double>(p.first.size());
+                    for (const PageId& tgt : p.first)
+                        emit(PageRankPair { tgt, rank_contrib });
+                });
+
+            // reduce all rank contributions by adding all rank contributions
+            // and compute the new rank: (url, rank)
+
+            return
+                contribs
+                .ReduceToIndex(
+                    [](const PageRankPair& p) { return p.page; },
+                    [](const PageRankPair& p1, const PageRankPair& p2) {
+                        return PageRankPair { p1.page, p1.rank + p2.rank };
+                    }, num_pages,
+                    /* neutral_element */ PageRankPair(),
+                    // the rank vector is a dense index range: reduce
+                    // contributions into a flat array instead of a hash table.
+                    core::DefaultReduceConfigSelect<
+                        core::ReduceTableImpl::DENSE>())
+                .Map([num_pages_d](const PageRankPair& p) {
+                         return dampening * p.rank +
+                         (1 - dampening) / num_pages_d;
+                     });
+        });
+}
 
-        // for all outgoing link, get their rank contribution from all
-        // links by doing:
-        //
-        // 1) group all outgoing links with rank of its parent page: (Zip)
-        // ([linked_url, linked_url, ...], rank_parent)
-        //
-        // 2) compute rank contribution for each linked_url: (FlatMap)
-        // (linked_url, rank / outgoing.size)
-
-        auto outs_rank = links.Zip(
-            ranks,
-            [](const OutgoingLinks& ol, const Rank& r) {
-                return OutgoingLinksRank(ol, r);
-            });
+//! Parameters of PageRankStreaming()
+struct PageRankStreamingConfig {
+    //! after the first iteration, send the changes of the ranks instead of the
+    //! ranks, which is exact as the iteration is linear.
+    bool delta = false;
+    //! with delta: hold back a page's rank change while its absolute value is
+    //! at most epsilon, and send the accumulated change later.
+    double epsilon = 0.0;
+    //! stop when the sum of the absolute rank changes of an iteration is at
+    //! most tolerance. The check is asynchronous, hence one more iteration is
+    //! run after convergence.
+    double tolerance = 0.0;
+};
+
+//! The outgoing links of the pages of one worker in compressed sparse rows.
+struct LocalLinks {
+    //! first page of the worker, the pages are consecutive
+    PageId begin = 0;
+    //! offsets of the pages' links in targets, one more than pages
+    std::vector<size_t> offsets { 0 };
+    //! the targets of all links
+    std::vector<PageId> targets;
+
+    size_t num_pages() const { return offsets.size() - 1; }
+    size_t degree(size_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+/*!
+ * Send the rank contributions of the pages with non-zero entries in send to
+ * the workers holding their targets, and return the sums of the contributions
+ * received for the local pages. Contributions to the same target are added up
+ * before sending.
+ */
+static inline std::vector<Rank> ExchangeContributions(
+    api::Context& ctx, size_t dia_id, const LocalLinks& links,
+    const std::vector<size_t>& worker_begin, const std::vector<Rank>& send) {
+
+    std::unordered_map<PageId, Rank> combined;
+    for (size_t i = 0; i < links.num_pages(); ++i) {
+        if (send[i] == 0.0 || links.degree(i) == 0) continue;
+        Rank contrib = send[i] / static_cast<double>(links.degree(i));
+        for (size_t j = links.offsets[i]; j < links.offsets[i + 1]; ++j)
+            combined[links.targets[j]] += contrib;
+    }
+
+    data::CatStreamPtr stream = ctx.GetNewCatStream(dia_id);
+    data::CatStream::Writers writers = stream->GetWriters();
+    for (const auto& c : combined) {
+        size_t worker =
+            std::upper_bound(worker_begin.begin(), worker_begin.end(),
+                             c.first) - worker_begin.begin() - 1;
+        writers[worker].Put(PageRankStdPair(c.first, c.second));
+    }
+    writers.Close();
+
+    std::vector<Rank> sums(links.num_pages(), 0.0);
+    data::CatStream::CatReader reader =
+        stream->GetCatReader(/* consume */ true);
+    while (reader.HasNext()) {
+        PageRankStdPair c = reader.Next<PageRankStdPair>();
+        sums[c.first - links.begin] += c.second;
+    }
+    return sums;
+}
+
+/*!
+ * PageRank without Zip of links and ranks in each iteration: the link lists
+ * stay on the worker which holds the source page in the input, which also
+ * keeps the ranks of these pages. Each iteration only sends the combined rank
+ * contributions to the workers holding their target pages, and needs no DIA
+ * operations. With config.delta, only the rank changes are propagated, and
+ * the convergence is checked by an asynchronous all-reduce which overlaps
+ * with the next iteration.
+ *
+ * links must contain the outgoing links of page i at position i. Returns the
+ * ranks in page order, like PageRank().
+ */
+template <typename InStack>
+DIA<Rank> PageRankStreaming(
+    const DIA<OutgoingLinks, InStack>& links, size_t num_pages,
+    size_t iterations,
+    const PageRankStreamingConfig& config = PageRankStreamingConfig()) {
+
+    api::Context& ctx = links.context();
+    double num_pages_d = static_cast<double>(num_pages);
+
+    // load the link lists of the local pages, in page order
+    LocalLinks local;
+    links
+    .Filter([&local](const OutgoingLinks& ol) {
+                local.targets.insert(local.targets.end(), ol.begin(), ol.end());
+                local.offsets.push_back(local.targets.size());
+                return false;
+            })
+    .Size();
+
+    // first page of each worker, to route contributions to their targets
+    local.begin = ctx.net.ExPrefixSum(local.num_pages());
+    std::vector<size_t> worker_begin(ctx.num_workers(), 0);
+    worker_begin[ctx.my_rank()] = local.begin;
+    worker_begin = ctx.net.AllReduce(
+        worker_begin,
+        [](const std::vector<size_t>& a, const std::vector<size_t>& b) {
+            std::vector<size_t> c(a.size());
+            for (size_t i = 0; i < a.size(); ++i) c[i] = a[i] + b[i];
+            return c;
+        });
+
+    size_t dia_id = ctx.next_dia_id();
+
+    // initialize all ranks to 1.0 / n
+    std::vector<Rank> ranks(local.num_pages(), Rank(1.0) / num_pages_d);
+    // contributions of the local pages sent in the next iteration
+    std::vector<Rank> send = ranks;
+    // with delta: rank changes which are not propagated yet
+    std::vector<Rank> pending(local.num_pages(), 0.0);
+
+    std::shared_future<double> change_future;
+
+    for (size_t iter = 0; iter < iterations; ++iter) {
 
-        if (debug) {
-            outs_rank
-            .Map([](const OutgoingLinksRank& ol) {
-                     return tlx::join(',', ol.first)
-                     + " <- " + std::to_string(ol.second);
-                 })
-            .Print("outs_rank");
+        if (config.delta && iter != 0) {
+            // send accumulated changes above epsilon, hold back the others
+            for (size_t i = 0; i < pending.size(); ++i) {
+                if (std::abs(pending[i]) > config.epsilon) {
+                    send[i] = pending[i];
+                    pending[i] = 0.0;
+                }
+                else {
+                    send[i] = 0.0;
+                }
+            }
         }
 
-        auto contribs = outs_rank.template FlatMap<PageRankPair>(
-            [](const OutgoingLinksRank& p, auto emit) {
-                if (p.first.size() == 0)
-                    return;
+        std::vector<Rank> sums =
+            ExchangeContributions(ctx, dia_id, local, worker_begin, send);
+
+        double local_change = 0.0;
+        for (size_t i = 0; i < ranks.size(); ++i) {
+            Rank change;
+            if (iter == 0 || !config.delta) {
+                Rank rank = dampening * sums[i] + (1 - dampening) / num_pages_d;
+                change = rank - ranks[i];
+                ranks[i] = rank;
+            }
+            else {
+                // the iteration is linear in the ranks: propagate the changes
+                change = dampening * sums[i];
+                ranks[i] += change;
+            }
+            local_change += std::abs(change);
+
+            if (config.delta)
+                pending[i] += change;
+            else
+                send[i] = ranks[i];
+        }
 
-                Rank rank_contrib = p.second / static_cast<double>(p.first.size());
-                for (const PageId& tgt : p.first)
-                    emit(PageRankPair { tgt, rank_contrib });
-            });
+        sLOG << "PageRankStreaming() iteration" << iter
+             << "local_change" << local_change;
 
-        // reduce all rank contributions by adding all rank contributions and
-        // compute the new rank: (url, rank)
-
-        ranks =
-            contribs
-            .ReduceToIndex(
-                [](const PageRankPair& p) { return p.page; },
-                [](const PageRankPair& p1, const PageRankPair& p2) {
-                    return PageRankPair { p1.page, p1.rank + p2.rank };
-                }, num_pages)
-            .Map([num_pages_d](const PageRankPair& p) {
-                     return dampening * p.rank + (1 - dampening) / num_pages_d;
-                 })
-            .Collapse();
+        if (config.tolerance > 0.0) {
+            // check the previous iteration's change, which is finished while
+            // this iteration ran.
+            if (change_future.valid() &&
+                change_future.get() <= config.tolerance)
+                break;
+            change_future = ctx.net.AllReduceAsync(local_change);
+        }
     }
 
-    return ranks;
+    return ConcatToDIA(ctx, ranks);
 }
 
 template <const bool UseLocationDetection = false, typename InStack>
@@ -147,72 +332,71 @@ auto PageRankJoin(const DIA<LinkedPage, InStack>& links, size_t num_pages,
 
     // initialize all ranks to 1.0 / n: (url, rank)
 
-    DIA<RankedPage> ranks =
+    auto initial_ranks =
         Generate(
             ctx, num_pages,
             [num_pages_d](size_t idx) {
                 return std::make_pair(idx, Rank(1.0) / num_pages_d);
-            })
-        .Collapse();
-
-    // do iterations
-    for (size_t iter = 0; iter < iterations; ++iter) {
-
-        // for all outgoing link, get their rank contribution from all
-        // links by doing:
-        //
-        // 1) group all outgoing links with rank of its parent page: (Zip)
-        // ([linked_url, linked_url, ...], rank_parent)
-        //
-        // 2) compute rank contribution for each linked_url: (FlatMap)
-        // (linked_url, rank / outgoing.size)
-
-        auto outs_rank = InnerJoin(
-            LocationDetectionFlag<UseLocationDetection>(),
-            links, ranks,
-            [](const LinkedPage& lp) { return lp.first; },
-            [](const RankedPage& rp) { return rp.first; },
-            [](const LinkedPage& lp, const RankedPage& rp) {
-                return std::make_pair(lp.second, rp.second);
             });
 
-        if (debug) {
-            outs_rank
-            .Map([](const OutgoingLinksRank& ol) {
-                     return tlx::join(',', ol.first)
-                     + " <- " + std::to_string(ol.second);
-                 })
-            .Print("outs_rank");
-        }
-
-        auto contribs = outs_rank.template FlatMap<PageRankStdPair>(
-            [](const OutgoingLinksRank& p, auto emit) {
-                if (p.first.size() > 0) {
-                    Rank rank_contrib = p.second / static_cast<double>(p.first.size());
-                    for (const PageId& tgt : p.first)
-                        emit(std::make_pair(tgt, rank_contrib));
-                }
-            });
-
-        // reduce all rank contributions by adding all rank contributions and
-        // compute the new rank: (url, rank)
-
-        ranks =
-            contribs
-            .ReducePair(
-                [](const Rank& p1, const Rank& p2) {
-                    return p1 + p2;
-                })
-            .Map([num_pages_d](const PageRankStdPair& p) {
-                     return std::make_pair(
-                         p.first,
-                         dampening * p.second + (1 - dampening) / num_pages_d);
-                 }).Collapse();
-
-        ranks.Execute();
-    }
-
-    return ranks;
+    // do iterations
+    return Iterate(
+        initial_ranks, iterations,
+        [&](const DIA<RankedPage>& ranks, size_t /* iter */) {
+
+            // for all outgoing link, get their rank contribution from all
+            // links by doing:
+            //
+            // 1) group all outgoing links with rank of its parent page: (Zip)
+            // ([linked_url, linked_url, ...], rank_parent)
+            //
+            // 2) compute rank contribution for each linked_url: (FlatMap)
+            // (linked_url, rank / outgoing.size)
+
+            auto outs_rank = InnerJoin(
+                LocationDetectionFlag<UseLocationDetection>(),
+                links, ranks,
+                [](const LinkedPage& lp) { return lp.first; },
+                [](const RankedPage& rp) { return rp.first; },
+                [](const LinkedPage& lp, const RankedPage& rp) {
+                    return std::make_pair(lp.second, rp.second);
+                });
+
+            if (debug) {
+                outs_rank
+                .Map([](const OutgoingLinksRank& ol) {
+                         return tlx::join(',', ol.first)
+                         + " <- " + std::to_string(ol.second);
+                     })
+                .Print("outs_rank");
+            }
+
+            auto contribs = outs_rank.template FlatMap<PageRankStdPair>(
+                [](const OutgoingLinksRank& p, auto emit) {
+                    if (p.first.size() > 0) {
+                        Rank rank_contrib =
+                            p.second / static_cast<double>(p.first.size());
+                        for (const PageId& tgt : p.first)
+                            emit(std::make_pair(tgt, rank_contrib));
+                    }
+                });
+
+            // reduce all rank contributions by adding all rank contributions
+            // and compute the new rank: (url, rank)
+
+            return
+                contribs
+                .ReducePair(
+                    [](const Rank& p1, const Rank& p2) {
+                        return p1 + p2;
+                    })
+                .Map([num_pages_d](const PageRankStdPair& p) {
+                         return std::make_pair(
+                             p.first,
+                             dampening * p.second +
+                             (1 - dampening) / num_pages_d);
+                     });
+        });
 }
 
 } // namespace page_rank
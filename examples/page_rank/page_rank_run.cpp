@@ -46,10 +46,20 @@ struct PageRankLineParser {
     }
 };
 
+//! run the Zip-based PageRank, or PageRankStreaming if streaming is set
+template <typename InStack>
+static DIA<Rank> RunPageRank(
+    const DIA<OutgoingLinks, InStack>& links, size_t num_pages,
+    size_t iterations, bool streaming, const PageRankStreamingConfig& config) {
+    if (streaming)
+        return PageRankStreaming(links, num_pages, iterations, config);
+    return PageRank(links, num_pages, iterations);
+}
+
 static void RunPageRankEdgePerLine(
     api::Context& ctx,
     const std::vector<std::string>& input_path, const std::string& output_path,
-    size_t iterations) {
+    size_t iterations, bool streaming, const PageRankStreamingConfig& config) {
     ctx.enable_consume();
 
     common::StatsTimerStart timer;
@@ -89,7 +99,7 @@ static void RunPageRankEdgePerLine(
 
     // perform actual page rank calculation iterations
 
-    auto ranks = PageRank(links, num_pages, iterations);
+    auto ranks = RunPageRank(links, num_pages, iterations, streaming, config);
 
     // construct output as "pageid: rank"
 
@@ -199,7 +209,8 @@ static void RunJoinPageRankEdgePerLine(
 static void RunPageRankGenerated(
     api::Context& ctx,
     const std::string& input_path, const ZipfGraphGen& base_graph_gen,
-    const std::string& output_path, size_t iterations) {
+    const std::string& output_path, size_t iterations,
+    bool streaming, const PageRankStreamingConfig& config) {
     ctx.enable_consume();
 
     common::StatsTimerStart timer;
@@ -222,7 +233,7 @@ static void RunPageRankGenerated(
 
     // perform actual page rank calculation iterations
 
-    auto ranks = PageRank(links, num_pages, iterations);
+    auto ranks = RunPageRank(links, num_pages, iterations, streaming, config);
 
     // construct output as "pageid: rank"
 
@@ -345,6 +356,19 @@ int main(int argc, char* argv[]) {
     size_t iter = 10;
     clp.add_size_t('n', "iterations", iter, "PageRank iterations, default: 10");
 
+    bool streaming = false;
+    clp.add_bool('s', "streaming", streaming,
+                 "keep links and ranks local, send only contributions");
+
+    PageRankStreamingConfig config;
+    clp.add_bool('d', "delta", config.delta,
+                 "streaming: propagate rank changes instead of ranks");
+    clp.add_double(0, "epsilon", config.epsilon,
+                   "streaming delta: hold back rank changes up to epsilon");
+    clp.add_double(0, "tolerance", config.tolerance,
+                   "streaming: stop when the sum of rank changes is at most "
+                   "tolerance, default: 0 = run all iterations");
+
     std::vector<std::string> input_path;
     clp.add_param_stringlist("input", input_path,
                              "input file pattern(s)");
@@ -361,10 +385,11 @@ int main(int argc, char* argv[]) {
         [&](api::Context& ctx) {
             if (generate && !use_join)
                 return RunPageRankGenerated(
-                    ctx, input_path[0], gg, output_path, iter);
+                    ctx, input_path[0], gg, output_path, iter,
+                    streaming, config);
             else if (!generate && !use_join)
                 return RunPageRankEdgePerLine(
-                    ctx, input_path, output_path, iter);
+                    ctx, input_path, output_path, iter, streaming, config);
             else if (generate && use_join)
                 return RunPageRankJoinGenerated(
                     ctx, input_path[0], gg, output_path, iter);
@@ -11,6 +11,7 @@
 #include <thrill/api/cache.hpp>
 #include <thrill/api/dia.hpp>
 #include <thrill/api/group_by_key.hpp>
+#include <thrill/api/quantiles.hpp>
 #include <thrill/api/read_lines.hpp>
 #include <thrill/api/size.hpp>
 #include <thrill/api/sort.hpp>
@@ -91,6 +92,25 @@ void Percentiles(api::Context& ctx, const std::string& input_path) {
                  << " hosts=" << ctx.num_hosts();
         }
     }
+
+    // approximate percentiles of all temperatures from one merged sketch
+    ctx.net.Barrier();
+    timer.Reset().Start();
+    auto sketch =
+        temps.Map([](const std::pair<time_t, double>& p) { return p.second; })
+        .Quantiles(/* sketch_size */ 400);
+    std::vector<double> pct = sketch.Quantiles({ 0.5, 0.9, 0.99 });
+
+    ctx.net.Barrier();
+    timer.Stop();
+
+    if (ctx.my_rank() == 0) {
+        LOG1 << "RESULT " << "benchmark=quantiles"
+             << " p50=" << pct[0] << " p90=" << pct[1] << " p99=" << pct[2]
+             << " time=" << timer
+             << " traffic=" << ctx.net_manager().Traffic()
+             << " hosts=" << ctx.num_hosts();
+    }
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,346 @@
+/*******************************************************************************
+ * examples/stochastic_gradient_descent/sparse_sgd.hpp
+ *
+ * Stochastic gradient descent for linear models on sparse feature vectors,
+ * which accumulates sparse gradients per worker and all-reduces them
+ * compressed through the FlowControlChannel.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_EXAMPLES_STOCHASTIC_GRADIENT_DESCENT_SPARSE_SGD_HEADER
+#define THRILL_EXAMPLES_STOCHASTIC_GRADIENT_DESCENT_SPARSE_SGD_HEADER
+
+#include <thrill/api/bernoulli_sample.hpp>
+#include <thrill/api/cache.hpp>
+#include <thrill/api/context.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/common/logger.hpp>
+
+#include <cereal/types/vector.hpp>
+#include <thrill/data/serialization_cereal.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace examples {
+namespace stochastic_gradient_descent {
+
+using thrill::DIA;
+
+//! One non-zero coordinate of a sparse vector
+struct SparseEntry {
+    uint64_t index;
+    double   value;
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+        ar(index, value);
+    }
+};
+
+//! A sparse vector: its non-zero coordinates in increasing index order
+using SparseVector = std::vector<SparseEntry>;
+
+//! Model for one point consisting of sparse features and a label
+struct SparseDataPoint {
+    SparseVector features;
+    double       label;
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+        ar(features, label);
+    }
+};
+
+//! Dot product of a sparse vector and dense weights
+static inline
+double SparseDot(const SparseVector& x, const std::vector<double>& weights) {
+    double sum = 0.0;
+    for (const SparseEntry& e : x) {
+        assert(e.index < weights.size());
+        sum += e.value * weights[e.index];
+    }
+    return sum;
+}
+
+//! Add two sparse vectors by merging their coordinates
+static inline
+SparseVector SparseAdd(const SparseVector& a, const SparseVector& b) {
+    SparseVector out;
+    out.reserve(a.size() + b.size());
+
+    auto ia = a.begin(), ib = b.begin();
+    while (ia != a.end() && ib != b.end()) {
+        if (ia->index < ib->index)
+            out.push_back(*ia++);
+        else if (ib->index < ia->index)
+            out.push_back(*ib++);
+        else {
+            out.push_back(SparseEntry { ia->index, ia->value + ib->value });
+            ++ia, ++ib;
+        }
+    }
+    out.insert(out.end(), ia, a.end());
+    out.insert(out.end(), ib, b.end());
+    return out;
+}
+
+//! Squared loss of a linear model, y = w*x
+class LeastSquaresLoss
+{
+public:
+    static double Predict(double dot) { return dot; }
+    static double Loss(double dot, double label) {
+        return 0.5 * (dot - label) * (dot - label);
+    }
+    //! derivative of the loss by the dot product
+    static double Derivative(double dot, double label) {
+        return dot - label;
+    }
+};
+
+//! Logistic loss of a linear model with labels 0 and 1
+class LogisticLoss
+{
+public:
+    static double Predict(double dot) { return 1.0 / (1.0 + std::exp(-dot)); }
+    static double Loss(double dot, double label) {
+        // log(1 + exp(dot)) - label * dot, evaluated without overflow
+        double softplus = dot > 0 ? dot + std::log1p(std::exp(-dot))
+                          : std::log1p(std::exp(dot));
+        return softplus - label * dot;
+    }
+    //! derivative of the loss by the dot product
+    static double Derivative(double dot, double label) {
+        return Predict(dot) - label;
+    }
+};
+
+/*!
+ * Sums sparse gradients of the items of one worker in a hash map, such that
+ * its size grows with the number of touched features, not the dimensions.
+ */
+class SparseGradientAccumulator
+{
+public:
+    //! add scale * x
+    void Add(const SparseVector& x, double scale) {
+        for (const SparseEntry& e : x)
+            sums_[e.index] += scale * e.value;
+    }
+
+    //! return the sum as a sparse vector, and reset the accumulator
+    SparseVector Extract() {
+        SparseVector out;
+        out.reserve(sums_.size());
+        for (const auto& s : sums_)
+            out.push_back(SparseEntry { s.first, s.second });
+        std::sort(out.begin(), out.end(),
+                  [](const SparseEntry& a, const SparseEntry& b) {
+                      return a.index < b.index;
+                  });
+        sums_.clear();
+        return out;
+    }
+
+private:
+    std::unordered_map<uint64_t, double> sums_;
+};
+
+/*!
+ * A sparse vector whose values are quantized to 16-bit integers relative to
+ * its largest absolute value, which about quarters the bytes of the values
+ * sent in the all-reduce, at a relative error of 2^-15 per reduction step.
+ */
+struct QuantizedSparseVector {
+    std::vector<uint64_t> index;
+    std::vector<int16_t>  value;
+    double                scale = 0.0;
+
+    static QuantizedSparseVector Encode(const SparseVector& x) {
+        QuantizedSparseVector q;
+        double max_abs = 0.0;
+        for (const SparseEntry& e : x)
+            max_abs = std::max(max_abs, std::abs(e.value));
+        q.scale = max_abs / std::numeric_limits<int16_t>::max();
+
+        q.index.reserve(x.size());
+        q.value.reserve(x.size());
+        for (const SparseEntry& e : x) {
+            q.index.push_back(e.index);
+            q.value.push_back(
+                q.scale == 0.0 ? 0 :
+                static_cast<int16_t>(std::lround(e.value / q.scale)));
+        }
+        return q;
+    }
+
+    SparseVector Decode() const {
+        SparseVector x(index.size());
+        for (size_t i = 0; i < index.size(); ++i)
+            x[i] = SparseEntry { index[i], value[i] * scale };
+        return x;
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+        ar(index, value, scale);
+    }
+};
+
+//! How sparse gradients are sent in the all-reduce
+enum class GradientCompression {
+    //! exact coordinates and double values
+    Sparse,
+    //! exact coordinates and 16-bit quantized values
+    Quantized
+};
+
+/*!
+ * All-reduce the sparse vectors of all workers through the
+ * FlowControlChannel. Each reduction step merges two sparse vectors, hence the
+ * messages only contain the union of the touched coordinates.
+ */
+static inline
+SparseVector AllReduceSparse(thrill::Context& ctx, const SparseVector& local,
+                             GradientCompression compression) {
+    if (compression == GradientCompression::Quantized) {
+        return ctx.net.AllReduce(
+            QuantizedSparseVector::Encode(local),
+            [](const QuantizedSparseVector& a, const QuantizedSparseVector& b) {
+                return QuantizedSparseVector::Encode(
+                    SparseAdd(a.Decode(), b.Decode()));
+            }).Decode();
+    }
+    return ctx.net.AllReduce(
+        local, [](const SparseVector& a, const SparseVector& b) {
+            return SparseAdd(a, b);
+        });
+}
+
+/*!
+ * Mini-batch stochastic gradient descent of a linear model with the given
+ * Loss on sparse data points. Each worker accumulates the sparse gradient of
+ * its sample locally, and only the touched coordinates are all-reduced. All
+ * workers hold the dense weights, which they update identically.
+ */
+template <typename Loss>
+class SparseStochasticGradientDescent
+{
+    static constexpr bool debug = false;
+
+public:
+    SparseStochasticGradientDescent(
+        size_t dimensions, size_t num_iterations, double mini_batch_fraction,
+        double step_size, double tolerance,
+        GradientCompression compression = GradientCompression::Sparse)
+        : dimensions_(dimensions), num_iterations_(num_iterations),
+          mini_batch_fraction_(mini_batch_fraction),
+          step_size_(step_size), tolerance_(tolerance),
+          compression_(compression)
+    { }
+
+    //! do the actual computation, returns the weights
+    template <typename InStack>
+    std::vector<double> optimize(
+        const DIA<SparseDataPoint, InStack>& input_points) {
+
+        thrill::Context& ctx = input_points.context();
+        auto points = input_points.Cache();
+
+        std::vector<double> weights(dimensions_, 0.0);
+        SparseGradientAccumulator accumulator;
+
+        // squared norm of the weights, updated on the touched coordinates
+        double norm = 0.0;
+
+        size_t i = 1;
+        for ( ; i <= num_iterations_; ++i) {
+            double local_loss = 0.0, local_count = 0.0;
+
+            // accumulate the gradients of the local sample as a side effect,
+            // and let Size() pull the items through without emitting any.
+            points.Keep().BernoulliSample(mini_batch_fraction_)
+            .Filter([&](const SparseDataPoint& p) {
+                        double dot = SparseDot(p.features, weights);
+                        accumulator.Add(p.features,
+                                        Loss::Derivative(dot, p.label));
+                        local_loss += Loss::Loss(dot, p.label);
+                        local_count += 1.0;
+                        return false;
+                    })
+            .Size();
+
+            SparseVector gradient = AllReduceSparse(
+                ctx, accumulator.Extract(), compression_);
+
+            std::pair<double, double> sums = ctx.net.AllReduce(
+                std::make_pair(local_loss, local_count),
+                [](const std::pair<double, double>& a,
+                   const std::pair<double, double>& b) {
+                    return std::make_pair(a.first + b.first,
+                                          a.second + b.second);
+                });
+
+            loss_ = sums.second ? sums.first / sums.second : 0.0;
+            LOG << "iteration " << i << " n: " << sums.second
+                << " touched: " << gradient.size() << " loss: " << loss_;
+
+            if (sums.second == 0) continue;
+
+            // w = w - eta sum_i=0^n Q(w_i) / n, only on touched coordinates
+            // with adaptive step_size eta, and gradient Q(w_i)
+            double eta = step_size_ / std::sqrt(i) / sums.second;
+            double delta = 0.0;
+            for (const SparseEntry& e : gradient) {
+                double& w = weights[e.index];
+                double d = eta * e.value;
+                norm -= w * w;
+                w -= d;
+                norm += w * w;
+                delta += d * d;
+            }
+            norm = std::max(norm, 0.0);
+
+            if (std::sqrt(delta) < tolerance_ * std::max(std::sqrt(norm), 1.0))
+                break;
+        }
+        iterations_ = std::min(i, num_iterations_);
+        return weights;
+    }
+
+    //! mean loss of the last iteration's sample
+    double loss() const { return loss_; }
+
+    //! number of iterations run
+    size_t iterations() const { return iterations_; }
+
+private:
+    size_t dimensions_;
+    size_t num_iterations_;
+    double mini_batch_fraction_;
+    double step_size_;
+    double tolerance_;
+    GradientCompression compression_;
+
+    double loss_ = 0.0;
+    size_t iterations_ = 0;
+};
+
+} // namespace stochastic_gradient_descent
+} // namespace examples
+
+#endif // !THRILL_EXAMPLES_STOCHASTIC_GRADIENT_DESCENT_SPARSE_SGD_HEADER
+
+/******************************************************************************/
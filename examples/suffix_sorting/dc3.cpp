@@ -396,12 +396,11 @@ DC3Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
         // by all ranks at mod 2 indices.
         auto triple_ranks_sorted =
             triple_ranks
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      if (a.index % 3 == b.index % 3)
-                          return a.index < b.index;
-                      else
-                          return a.index % 3 < b.index % 3;
-                  });
+            .SortByKey([input_size](const IndexRank& a) {
+                           // order by (index % 3, index)
+                           return uint64_t(a.index % 3) * (input_size / 3 + 2)
+                           + uint64_t(a.index / 3);
+                       });
 
         if (debug_print)
             triple_ranks_sorted.Keep().Print("triple_ranks_sorted");
@@ -434,12 +433,13 @@ DC3Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
                       // for suffixes beyond the end of the string.
                               return IndexRank { sa.index, Index(i + 1) };
                           })
-            .Sort([size_mod1](const IndexRank& a, const IndexRank& b) {
-                      // use sort order to interleave ranks mod 1/2
-                      return a.index % size_mod1 < b.index % size_mod1 || (
-                          a.index % size_mod1 == b.index % size_mod1 &&
-                          a.index < b.index);
-                  });
+            .SortByKey([size_mod1](const IndexRank& a) {
+                           // use sort order to interleave ranks mod 1/2, which
+                           // is (index % size_mod1, index) as index < 2 *
+                           // size_mod1.
+                           return uint64_t(a.index % size_mod1) * 2
+                           + uint64_t(a.index / size_mod1);
+                       });
 
         if (debug_print) {
             // check that ranks are correctly interleaved
@@ -469,12 +469,11 @@ DC3Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
                       // for suffixes beyond the end of the string.
                               return IndexRank { sa, Index(i + 1) };
                           })
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      // use sort order to interleave ranks mod 1/2
-                      return a.index / 3 < b.index / 3 || (
-                          a.index / 3 == b.index / 3 &&
-                          a.index < b.index);
-                  });
+            .SortByKey([](const IndexRank& a) {
+                           // use sort order to interleave ranks mod 1/2, which
+                           // is the order of the index.
+                           return uint64_t(a.index);
+                       });
 
         if (debug_print) {
             // check that ranks are correctly interleaved
@@ -557,12 +557,11 @@ DC7Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
         // by all ranks at mod 1 indices followed by all ranks at mod 3 indices.
         DIA<Index> string_mod013 =
             tuple_ranks
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      if (a.index % 7 == b.index % 7)
-                          return a.index < b.index;
-                      else
-                          return a.index % 7 < b.index % 7;
-                  })
+            .SortByKey([input_size](const IndexRank& a) {
+                           // order by (index % 7, index)
+                           return uint64_t(a.index % 7) * (input_size / 7 + 2)
+                           + uint64_t(a.index / 7);
+                       })
             .Map([](const IndexRank& tr) {
                      return tr.rank;
                  })
@@ -591,20 +590,15 @@ DC7Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
                               // for suffixes beyond the end of the string.
                               return IndexRank { sa.index, Index(i + 1) };
                           })
-            .Sort([size_mod0, size_mod01](
-                      const IndexRank& a, const IndexRank& b) {
-
-                      Index ai = (a.index < size_mod0 ? a.index :
-                                  a.index < size_mod01 ? a.index - size_mod0 :
-                                  a.index - size_mod01);
-
-                      Index bi = (b.index < size_mod0 ? b.index :
-                                  b.index < size_mod01 ? b.index - size_mod0 :
-                                  b.index - size_mod01);
-
-                      // use sort order to interleave ranks mod 0/1/3
-                      return ai < bi || (ai == bi && a.index < b.index);
-                  });
+            .SortByKey([size_mod0, size_mod01](const IndexRank& a) {
+                           // use sort order to interleave ranks mod 0/1/3 by
+                           // (position in the group, group).
+                           if (a.index < size_mod0)
+                               return uint64_t(a.index) * 3;
+                           if (a.index < size_mod01)
+                               return uint64_t(a.index - size_mod0) * 3 + 1;
+                           return uint64_t(a.index - size_mod01) * 3 + 2;
+                       });
 
         if (debug_print) {
             // check that ranks are correctly interleaved
@@ -636,12 +630,11 @@ DC7Recursive(const InputDIA& input_dia, size_t input_size, size_t K) {
                     // for suffixes beyond the end of the string.
                     return IndexRank { sa, Index(i + 1) };
                 })
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      // use sort order for better locality later.
-                      return a.index / 7 < b.index / 7 || (
-                          a.index / 7 == b.index / 7 &&
-                          a.index < b.index);
-                  });
+            .SortByKey([](const IndexRank& a) {
+                           // use sort order for better locality later, which
+                           // is the order of the index.
+                           return uint64_t(a.index);
+                       });
 
         if (debug_print) {
             // check that ranks are correctly interleaved
@@ -253,9 +253,7 @@ DIA<IndexRank<Index> > PrefixDoublingPack(
                         }
                     }
                 })
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      return a.rank < b.rank;
-                  });
+            .SortByKey([](const IndexRank& a) { return uint64_t(a.rank); });
 
         if (debug_print)
             chars_sorted.Keep().Print("chars_sorted packed");
@@ -373,15 +371,9 @@ DIA<Index> PrefixDoublingSorting(
         // reorder names such that 2^k+i and 2^(k+1)+i are adjacent
         auto names_sorted =
             names
-            .Sort([iteration](const IndexRank& a, const IndexRank& b) {
-                      Index mod_mask = (Index(1) << iteration) - 1;
-                      Index div_mask = ~mod_mask;
-
-                      if ((a.index & mod_mask) == (b.index & mod_mask))
-                          return (a.index & div_mask) < (b.index & div_mask);
-                      else
-                          return (a.index & mod_mask) < (b.index & mod_mask);
-                  });
+            .SortByKey([iteration](const IndexRank& a) {
+                           return ResidueKey(a.index, iteration);
+                       });
 
         if (debug_print)
             names_sorted.Keep().Print("names_sorted");
@@ -660,15 +652,9 @@ DIA<Index> PrefixDoublingDiscarding(
 
     auto names_unique_sorted =
         names_unique
-        .Sort([iteration](const IndexRankStatus& a, const IndexRankStatus& b) {
-                  Index mod_mask = (Index(1) << iteration) - 1;
-                  Index div_mask = ~mod_mask;
-
-                  if ((a.index & mod_mask) == (b.index & mod_mask))
-                      return (a.index & div_mask) < (b.index & div_mask);
-                  else
-                      return (a.index & mod_mask) < (b.index & mod_mask);
-              });
+        .SortByKey([iteration](const IndexRankStatus& a) {
+                       return ResidueKey(a.index, iteration);
+                   });
 
     std::vector<DIA<IndexRank> > fully_discarded;
 
@@ -768,9 +754,7 @@ DIA<Index> PrefixDoublingDiscarding(
         if (duplicates == 0) {
             auto sa =
                 Union(fully_discarded)
-                .Sort([](const IndexRank& a, const IndexRank& b) {
-                          return a.rank < b.rank;
-                      })
+                .SortByKey([](const IndexRank& a) { return uint64_t(a.rank); })
                 .Map([](const IndexRank& ir) {
                          return ir.index;
                      });
@@ -843,15 +827,9 @@ DIA<Index> PrefixDoublingDiscarding(
         names_unique_sorted =
             names_unique
             .Union(partial_discarded)
-            .Sort([iteration](const IndexRankStatus& a, const IndexRankStatus& b) {
-                      Index mod_mask = (Index(1) << iteration) - 1;
-                      Index div_mask = ~mod_mask;
-
-                      if ((a.index & mod_mask) == (b.index & mod_mask))
-                          return (a.index & div_mask) < (b.index & div_mask);
-                      else
-                          return (a.index & mod_mask) < (b.index & mod_mask);
-                  });
+            .SortByKey([iteration](const IndexRankStatus& a) {
+                           return ResidueKey(a.index, iteration);
+                       });
     }
 }
 
@@ -221,9 +221,7 @@ DIA<Index> PrefixQuadruplingDiscarding(const InputDIA& input_dia, size_t input_s
                         }
                     }
                 })
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      return a.rank < b.rank;
-                  });
+            .SortByKey([](const IndexRank& a) { return uint64_t(a.rank); });
 
         if (debug_print)
             chars_sorted.Keep().Print("chars_sorted packed");
@@ -327,15 +325,9 @@ DIA<Index> PrefixQuadruplingDiscarding(const InputDIA& input_dia, size_t input_s
 
     auto names_unique_sorted =
         names_unique.Keep()
-        .Sort([iteration](const IndexRankStatus& a, const IndexRankStatus& b) {
-                  Index mod_mask = (Index(1) << (iteration << 1)) - 1;
-                  Index div_mask = ~mod_mask;
-
-                  if ((a.index & mod_mask) == (b.index & mod_mask))
-                      return (a.index & div_mask) < (b.index & div_mask);
-                  else
-                      return (a.index & mod_mask) < (b.index & mod_mask);
-              });
+        .SortByKey([iteration](const IndexRankStatus& a) {
+                       return ResidueKey(a.index, iteration << 1);
+                   });
 
     if (debug_print)
         names_unique_sorted.Keep().Print("Names unique sorted");
@@ -617,15 +609,9 @@ DIA<Index> PrefixQuadruplingDiscarding(const InputDIA& input_dia, size_t input_s
         names_unique_sorted =
             names_unique
             .Union(partial_discarded)
-            .Sort([iteration](const IndexRankStatus& a, const IndexRankStatus& b) {
-                      Index mod_mask = (Index(1) << (iteration << 1)) - 1;
-                      Index div_mask = ~mod_mask;
-
-                      if ((a.index & mod_mask) == (b.index & mod_mask))
-                          return (a.index & div_mask) < (b.index & div_mask);
-                      else
-                          return (a.index & mod_mask) < (b.index & mod_mask);
-                  });
+            .SortByKey([iteration](const IndexRankStatus& a) {
+                           return ResidueKey(a.index, iteration << 1);
+                       });
 
         if (debug_print)
             names_unique_sorted.Keep().Print("names_unique_sorted");
@@ -686,9 +672,7 @@ DIA<Index> PrefixQuadrupling(const InputDIA& input_dia, size_t input_size, bool
                         }
                     }
                 })
-            .Sort([](const IndexRank& a, const IndexRank& b) {
-                      return a.rank < b.rank;
-                  });
+            .SortByKey([](const IndexRank& a) { return uint64_t(a.rank); });
 
         if (debug_print)
             chars_sorted.Keep().Print("chars_sorted packed");
@@ -786,15 +770,9 @@ DIA<Index> PrefixQuadrupling(const InputDIA& input_dia, size_t input_size, bool
     while (true) {
         auto names_sorted =
             names
-            .Sort([iteration](const IndexRank& a, const IndexRank& b) {
-                      Index mod_mask = (Index(1) << (iteration << 1)) - 1;
-                      Index div_mask = ~mod_mask;
-
-                      if ((a.index & mod_mask) == (b.index & mod_mask))
-                          return (a.index & div_mask) < (b.index & div_mask);
-                      else
-                          return (a.index & mod_mask) < (b.index & mod_mask);
-                  });
+            .SortByKey([iteration](const IndexRank& a) {
+                           return ResidueKey(a.index, iteration << 1);
+                       });
 
         size_t next_index = size_t(1) << (iteration << 1);
         ++iteration;
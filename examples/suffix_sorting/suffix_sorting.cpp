@@ -241,6 +241,8 @@ public:
         if (input_dia.context().my_rank() == 0) {
             std::cerr << "RESULT"
                       << " algo=" << algorithm_
+                      << " input_size=" << input_size
+                      << " index_bytes=" << sizeof(Index)
                       << " hosts=" << input_dia.context().num_hosts()
                       << " check_result=" << check_result
                       << " time=" << timer
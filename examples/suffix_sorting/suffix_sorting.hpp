@@ -14,11 +14,26 @@
 
 #include <thrill/api/dia.hpp>
 
+#include <cstddef>
+#include <cstdint>
+
 namespace examples {
 namespace suffix_sorting {
 
 extern bool debug_print;
 
+/*!
+ * Order-preserving integer key of the pair (index mod 2^k, index div 2^k),
+ * which lets SortByKey() radix sort indexes by their residue classes instead
+ * of comparing masked indexes.
+ */
+template <typename Index>
+uint64_t ResidueKey(const Index& index, size_t k) {
+    uint64_t i = index;
+    if (k == 0) return i;
+    return ((i & ((uint64_t(1) << k) - 1)) << (64 - k)) | (i >> k);
+}
+
 } // namespace suffix_sorting
 } // namespace examples
 
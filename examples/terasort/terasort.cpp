@@ -1,6 +1,10 @@
 /*******************************************************************************
  * examples/terasort/terasort.cpp
  *
+ * TeraSort benchmark: generates or reads 100 byte records, sorts them, and
+ * reports the throughput per host and the time of the sort phases. Optionally
+ * validates order, count and checksum of the output.
+ *
  * Part of Project Thrill - http://project-thrill.org
  *
  * Copyright (C) 2016 Timo Bingmann <tb@panthema.net>
@@ -12,8 +16,13 @@
 #include <thrill/api/read_binary.hpp>
 #include <thrill/api/size.hpp>
 #include <thrill/api/sort.hpp>
+#include <thrill/api/sum.hpp>
+#include <thrill/api/window.hpp>
 #include <thrill/api/write_binary.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
 #include <thrill/common/string.hpp>
 #include <tlx/cmdline_parser.hpp>
 
@@ -21,7 +30,6 @@
 #include <tlx/string/parse_si_iec_units.hpp>
 
 #include <algorithm>
-#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -58,17 +66,25 @@ struct RecordSigned {
 
 /*!
  * Generate a Record in a similar way as the "binary" version of Hadoop's
- * GenSort does. The underlying random generator is different.
+ * GenSort does. The underlying random generator is different, the keys are
+ * pseudo-random hashes of seed and record index, such that the same data set is
+ * generated independent of the number of hosts and workers.
  */
 class GenerateRecord
 {
 public:
-    Record operator () (size_t index) {
+    explicit GenerateRecord(uint64_t seed) : seed_(seed) { }
+
+    Record operator () (size_t index) const {
         Record r;
 
         // generate random key record
-        for (size_t i = 0; i < 10; ++i)
-            r.key[i] = static_cast<unsigned char>(rng_());
+        uint64_t k0 = common::Hash128to64(seed_, index);
+        uint64_t k1 = common::Hash128to64(k0, index);
+        for (size_t i = 0; i < 8; ++i)
+            r.key[i] = static_cast<uint8_t>(k0 >> (8 * i));
+        for (size_t i = 8; i < 10; ++i)
+            r.key[i] = static_cast<uint8_t>(k1 >> (8 * (i - 8)));
 
         uint8_t* v = r.value;
 
@@ -114,9 +130,115 @@ public:
     }
 
 private:
-    std::default_random_engine rng_ { std::random_device { } () };
+    uint64_t seed_;
 };
 
+//! checksum of a record, the output's sum equals the input's if no record was
+//! lost or modified.
+template <typename Record>
+uint64_t RecordChecksum(const Record& r) {
+    return common::HashCrc32<Record>()(r);
+}
+
+//! count and checksum pair
+using CountChecksum = std::pair<size_t, uint64_t>;
+
+/*!
+ * Sort the DIA created by make_input(), write it to output or count it, and
+ * print a RESULT line with the throughput and the maximum time of the sort
+ * phases over all workers. If validate is set, checks that the output is
+ * ordered, and that count and checksum match those of a second input pass.
+ */
+template <typename Record, typename MakeInput>
+void RunTeraSort(api::Context& ctx, const MakeInput& make_input,
+                 const std::string& output, bool validate) {
+
+    common::StatsTimerStart timer;
+
+    auto sorted = make_input().Sort();
+    // kept for the ordering and checksum passes
+    if (validate) sorted.Keep(2);
+
+    if (output.size())
+        sorted.WriteBinary(output);
+    else
+        sorted.Size();
+
+    ctx.net.Barrier();
+    timer.Stop();
+
+    const api::SortPhaseStats* stats = api::GetSortPhaseStats(sorted);
+    die_unless(stats != nullptr);
+
+    auto max_time = [&ctx](double x) {
+                        return ctx.net.AllReduce(x, common::maximum<double>());
+                    };
+    double preop = max_time(stats->preop), sample = max_time(stats->sample);
+    double exchange = max_time(stats->exchange);
+    double local_sort = max_time(stats->local_sort);
+    double merge = max_time(stats->merge);
+    double merge_pull = max_time(stats->merge_pull);
+    size_t items = ctx.net.AllReduce(stats->items);
+    size_t runs = ctx.net.AllReduce(stats->runs, common::maximum<size_t>());
+
+    auto traffic = ctx.net_manager().Traffic();
+    double bytes = static_cast<double>(items * sizeof(Record));
+
+    if (ctx.my_rank() == 0) {
+        LOG1 << "RESULT"
+             << " benchmark=terasort"
+             << " items=" << items
+             << " bytes=" << items * sizeof(Record)
+             << " time=" << timer
+             << " gbps_per_host="
+             << bytes / timer.SecondsDouble() / ctx.num_hosts() / 1e9
+             << " preop_time=" << preop
+             << " sample_time=" << sample
+             << " exchange_time=" << exchange
+             << " local_sort_time=" << local_sort
+             << " merge_time=" << merge
+             << " merge_pull_time=" << merge_pull
+             << " max_runs=" << runs
+             << " traffic=" << traffic.total()
+             << " hosts=" << ctx.num_hosts()
+             << " workers=" << ctx.num_workers();
+    }
+
+    if (!validate) return;
+
+    size_t unordered =
+        sorted.Window(
+            2, [](size_t, const common::RingBuffer<Record>& w) -> size_t {
+                return w[1] < w[0] ? 1 : 0;
+            })
+        .Sum();
+
+    auto to_count_checksum = [](const Record& r) {
+                                 return CountChecksum(1, RecordChecksum(r));
+                             };
+    auto add_count_checksum =
+        [](const CountChecksum& a, const CountChecksum& b) {
+            return CountChecksum(a.first + b.first, a.second + b.second);
+        };
+    CountChecksum out_sum =
+        sorted.Map(to_count_checksum).Sum(add_count_checksum);
+    CountChecksum in_sum =
+        make_input().Map(to_count_checksum).Sum(add_count_checksum);
+
+    if (ctx.my_rank() == 0) {
+        LOG1 << "RESULT"
+             << " benchmark=terasort_validate"
+             << " items=" << out_sum.first
+             << " unordered=" << unordered
+             << " checksum=" << out_sum.second
+             << " input_checksum=" << in_sum.second;
+    }
+
+    die_unequal(unordered, 0u);
+    die_unequal(out_sum.first, in_sum.first);
+    die_unequal(out_sum.second, in_sum.second);
+}
+
 int main(int argc, char* argv[]) {
 
     tlx::CmdlineParser clp;
@@ -139,6 +261,15 @@ int main(int argc, char* argv[]) {
     clp.add_string('o', "output", output,
                    "output file pattern");
 
+    size_t seed = 42;
+    clp.add_size_t('S', "seed", seed,
+                   "seed of the generated records, default: 42");
+
+    bool validate = false;
+    clp.add_bool('V', "validate", validate,
+                 "check order, count and checksum of the sorted records,"
+                 " default: false");
+
     std::vector<std::string> input;
     clp.add_param_stringlist("input", input,
                              "input file pattern(s)");
@@ -153,8 +284,6 @@ int main(int argc, char* argv[]) {
         [&](api::Context& ctx) {
             ctx.enable_consume();
 
-            common::StatsTimerStart timer;
-
             if (generate_only) {
                 die_unequal(input.size(), 1u);
                 // parse first argument like "100mib" size
@@ -162,8 +291,19 @@ int main(int argc, char* argv[]) {
                 die_unless(tlx::parse_si_iec_units(input[0].c_str(), &size));
                 die_unless(!use_signed_char);
 
-                Generate(ctx, size / sizeof(Record), GenerateRecord())
+                common::StatsTimerStart timer;
+
+                Generate(ctx, size / sizeof(Record), GenerateRecord(seed))
                 .WriteBinary(output);
+
+                ctx.net.Barrier();
+                if (ctx.my_rank() == 0) {
+                    LOG1 << "RESULT"
+                         << " benchmark=terasort_generate"
+                         << " bytes=" << size / sizeof(Record) * sizeof(Record)
+                         << " time=" << timer
+                         << " hosts=" << ctx.num_hosts();
+                }
             }
             else if (generate) {
                 die_unequal(input.size(), 1u);
@@ -172,42 +312,23 @@ int main(int argc, char* argv[]) {
                 die_unless(tlx::parse_si_iec_units(input[0].c_str(), &size));
                 die_unless(!use_signed_char);
 
-                auto r =
-                    Generate(ctx, size / sizeof(Record), GenerateRecord())
-                    .Sort();
-
-                if (output.size())
-                    r.WriteBinary(output);
-                else
-                    r.Size();
+                RunTeraSort<Record>(
+                    ctx, [&]() {
+                        return Generate(ctx, size / sizeof(Record),
+                                        GenerateRecord(seed));
+                    }, output, validate);
             }
-            else {
-                if (use_signed_char) {
-                    auto r = ReadBinary<RecordSigned>(ctx, input).Sort();
-
-                    if (output.size())
-                        r.WriteBinary(output);
-                    else
-                        r.Size();
-                }
-                else {
-                    auto r = ReadBinary<Record>(ctx, input).Sort();
-
-                    if (output.size())
-                        r.WriteBinary(output);
-                    else
-                        r.Size();
-                }
+            else if (use_signed_char) {
+                RunTeraSort<RecordSigned>(
+                    ctx, [&]() {
+                        return ReadBinary<RecordSigned>(ctx, input);
+                    }, output, validate);
             }
-
-            ctx.net.Barrier();
-            if (ctx.my_rank() == 0) {
-                auto traffic = ctx.net_manager().Traffic();
-                LOG1 << "RESULT"
-                     << " benchmark=terasort"
-                     << " time=" << timer
-                     << " traffic=" << traffic.total()
-                     << " hosts=" << ctx.num_hosts();
+            else {
+                RunTeraSort<Record>(
+                    ctx, [&]() {
+                        return ReadBinary<Record>(ctx, input);
+                    }, output, validate);
             }
         });
 }
@@ -0,0 +1,887 @@
+/*******************************************************************************
+ * examples/tpch/tpch_queries.cpp
+ *
+ * TPC-H queries Q1, Q3, Q5, Q6, Q9, and Q18 as benchmark, on tables read from
+ * dbgen's .tbl files or generated at a scale factor.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/all_gather.hpp>
+#include <thrill/api/cache.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/inner_join.hpp>
+#include <thrill/api/read_lines.hpp>
+#include <thrill/api/reduce_by_key.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sort.hpp>
+#include <thrill/api/sum.hpp>
+#include <thrill/api/top_k.hpp>
+#include <thrill/common/hash.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/split.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill;              // NOLINT
+
+//! dates are stored as yyyymmdd, which compares like the date
+using Date = uint32_t;
+
+/******************************************************************************/
+// Table Rows, with the columns used by the queries
+
+struct LineItem {
+    size_t orderkey;
+    size_t partkey;
+    size_t suppkey;
+    double quantity;
+    double extendedprice;
+    double discount;
+    double tax;
+    char   returnflag;
+    char   linestatus;
+    Date   shipdate;
+} TLX_ATTRIBUTE_PACKED;
+
+struct Order {
+    size_t orderkey;
+    size_t custkey;
+    double totalprice;
+    Date   orderdate;
+    int    shippriority;
+} TLX_ATTRIBUTE_PACKED;
+
+struct Customer {
+    size_t custkey;
+    size_t nationkey;
+    char   mktsegment[11];
+} TLX_ATTRIBUTE_PACKED;
+
+struct Supplier {
+    size_t suppkey;
+    size_t nationkey;
+} TLX_ATTRIBUTE_PACKED;
+
+struct Part {
+    size_t partkey;
+    char   name[56];
+} TLX_ATTRIBUTE_PACKED;
+
+struct PartSupp {
+    size_t partkey;
+    size_t suppkey;
+    double supplycost;
+} TLX_ATTRIBUTE_PACKED;
+
+//! the fixed NATION table of the TPC-H specification
+struct Nation {
+    const char* name;
+    size_t      regionkey;
+};
+
+static const Nation nations[25] = {
+    { "ALGERIA", 0 }, { "ARGENTINA", 1 }, { "BRAZIL", 1 }, { "CANADA", 1 },
+    { "EGYPT", 4 }, { "ETHIOPIA", 0 }, { "FRANCE", 3 }, { "GERMANY", 3 },
+    { "INDIA", 2 }, { "INDONESIA", 2 }, { "IRAN", 4 }, { "IRAQ", 4 },
+    { "JAPAN", 2 }, { "JORDAN", 4 }, { "KENYA", 0 }, { "MOROCCO", 0 },
+    { "MOZAMBIQUE", 0 }, { "PERU", 1 }, { "CHINA", 2 }, { "ROMANIA", 3 },
+    { "SAUDI ARABIA", 4 }, { "VIETNAM", 2 }, { "RUSSIA", 3 },
+    { "UNITED KINGDOM", 3 }, { "UNITED STATES", 1 }
+};
+
+//! the fixed REGION table of the TPC-H specification
+static const char* regions[5] = {
+    "AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"
+};
+
+//! all tables, cached
+struct Tables {
+    DIA<LineItem> lineitem;
+    DIA<Order>    orders;
+    DIA<Customer> customer;
+    DIA<Supplier> supplier;
+    DIA<Part>     part;
+    DIA<PartSupp> partsupp;
+};
+
+/******************************************************************************/
+// Dates
+
+static bool IsLeapYear(uint32_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+//! date of a number of days after 1992-01-01
+static Date DateFromDays(uint32_t days) {
+    static const uint32_t month_days[12] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+    uint32_t year = 1992;
+    while (days >= (IsLeapYear(year) ? 366u : 365u))
+        days -= IsLeapYear(year++) ? 366 : 365;
+    uint32_t month = 0;
+    while (days >= month_days[month] + (month == 1 && IsLeapYear(year)))
+        days -= month_days[month] + (month == 1 && IsLeapYear(year)), ++month;
+    return year * 10000 + (month + 1) * 100 + days + 1;
+}
+
+//! parse a date "1995-03-15"
+static Date ParseDate(const std::string& str) {
+    char* end;
+    return std::strtoul(str.substr(0, 4).c_str(), &end, 10) * 10000
+           + std::strtoul(str.substr(5, 2).c_str(), &end, 10) * 100
+           + std::strtoul(str.substr(8, 2).c_str(), &end, 10);
+}
+
+/******************************************************************************/
+// Table Generation
+
+/*!
+ * Pseudo-random numbers of a table row, such that each row is generated
+ * independently of the number of workers. This follows the cardinalities and
+ * key relations of dbgen, but with simpler value distributions.
+ */
+class RowRandom
+{
+public:
+    RowRandom(uint64_t table, uint64_t row)
+        : state_(common::Hash128to64(table, row)) { }
+
+    //! splitmix64
+    uint64_t operator () () {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //! uniform in [lo,hi]
+    uint64_t Uniform(uint64_t lo, uint64_t hi) {
+        return lo + (*this)() % (hi - lo + 1);
+    }
+
+private:
+    uint64_t state_;
+};
+
+//! cardinalities of the tables at a scale factor
+struct ScaleFactor {
+    explicit ScaleFactor(double sf)
+        : orders(std::max<size_t>(1, static_cast<size_t>(1500000 * sf))),
+          customers(std::max<size_t>(1, static_cast<size_t>(150000 * sf))),
+          parts(std::max<size_t>(1, static_cast<size_t>(200000 * sf))),
+          suppliers(std::max<size_t>(4, static_cast<size_t>(10000 * sf))) { }
+
+    size_t orders, customers, parts, suppliers;
+};
+
+//! the j-th of four suppliers of a part, as in dbgen
+static size_t PartSupplier(size_t partkey, size_t j, size_t suppliers) {
+    return (partkey + j * (suppliers / 4 + (partkey - 1) / suppliers))
+           % suppliers + 1;
+}
+
+//! retail price of a part, as in dbgen
+static double RetailPrice(size_t partkey) {
+    return static_cast<double>(
+        90000 + ((partkey / 10) % 20001) + 100 * (partkey % 1000)) / 100.0;
+}
+
+static const char* segments[5] = {
+    "AUTOMOBILE", "BUILDING", "FURNITURE", "HOUSEHOLD", "MACHINERY"
+};
+
+static const char* colors[] = {
+    "almond", "antique", "aquamarine", "azure", "beige", "bisque", "black",
+    "blanched", "blue", "blush", "brown", "burlywood", "burnished",
+    "chartreuse", "chiffon", "chocolate", "coral", "cornflower", "cornsilk",
+    "cream", "cyan", "dark", "deep", "dim", "dodger", "drab", "firebrick",
+    "floral", "forest", "frosted", "gainsboro", "ghost", "goldenrod", "green",
+    "grey", "honeydew", "hot", "indian", "ivory", "khaki", "lace", "lavender",
+    "lawn", "lemon", "light", "lime", "linen", "magenta", "maroon", "medium",
+    "metallic", "midnight", "mint", "misty", "moccasin", "navajo", "navy",
+    "olive", "orange", "orchid", "pale", "papaya", "peach", "peru", "pink",
+    "plum", "powder", "puff", "purple", "red", "rose", "rosy", "royal",
+    "saddle", "salmon", "sandy", "seashell", "sienna", "sky", "slate", "smoke",
+    "snow", "spring", "steel", "tan", "thistle", "tomato", "turquoise",
+    "violet", "wheat", "white", "yellow"
+};
+
+enum GeneratedTable : uint64_t {
+    kOrders = 1, kLineItem, kCustomer, kSupplier, kPart, kPartSupp
+};
+
+//! an order and its number of line items
+static Order GenerateOrder(size_t orderkey, const ScaleFactor& sf,
+                           uint32_t* order_days, size_t* num_lines) {
+    RowRandom r(kOrders, orderkey);
+    Order o;
+    o.orderkey = orderkey;
+    // order dates from 1992-01-01 to 1998-08-02
+    *order_days = static_cast<uint32_t>(r.Uniform(0, 2405));
+    o.orderdate = DateFromDays(*order_days);
+    o.custkey = r.Uniform(1, sf.customers);
+    o.totalprice = static_cast<double>(r.Uniform(100000, 50000000)) / 100.0;
+    o.shippriority = 0;
+    *num_lines = r.Uniform(1, 7);
+    return o;
+}
+
+static LineItem GenerateLineItem(size_t orderkey, uint32_t order_days,
+                                 size_t line, const ScaleFactor& sf) {
+    RowRandom r(kLineItem, orderkey * 8 + line);
+    LineItem li;
+    li.orderkey = orderkey;
+    li.partkey = r.Uniform(1, sf.parts);
+    li.suppkey = PartSupplier(li.partkey, r.Uniform(0, 3), sf.suppliers);
+    li.quantity = static_cast<double>(r.Uniform(1, 50));
+    li.extendedprice = li.quantity * RetailPrice(li.partkey);
+    li.discount = static_cast<double>(r.Uniform(0, 10)) / 100.0;
+    li.tax = static_cast<double>(r.Uniform(0, 8)) / 100.0;
+    uint32_t ship_days = order_days + static_cast<uint32_t>(r.Uniform(1, 121));
+    li.shipdate = DateFromDays(ship_days);
+    Date receipt = DateFromDays(
+        ship_days + static_cast<uint32_t>(r.Uniform(1, 30)));
+    li.returnflag = receipt <= 19950617 ? (r() % 2 ? 'R' : 'A') : 'N';
+    li.linestatus = li.shipdate > 19950617 ? 'O' : 'F';
+    return li;
+}
+
+static Tables GenerateTables(api::Context& ctx, const ScaleFactor& sf) {
+    Tables t;
+
+    t.orders = Generate(
+        ctx, sf.orders,
+        [sf](size_t index) {
+            uint32_t days;
+            size_t lines;
+            return GenerateOrder(index + 1, sf, &days, &lines);
+        }).Cache().Execute();
+
+    t.lineitem = Generate(ctx, sf.orders)
+                 .FlatMap<LineItem>(
+        [sf](size_t index, auto emit) {
+            uint32_t days;
+            size_t lines;
+            GenerateOrder(index + 1, sf, &days, &lines);
+            for (size_t l = 1; l <= lines; ++l)
+                emit(GenerateLineItem(index + 1, days, l, sf));
+        }).Cache().Execute();
+
+    t.customer = Generate(
+        ctx, sf.customers,
+        [](size_t index) {
+            RowRandom r(kCustomer, index + 1);
+            Customer c;
+            c.custkey = index + 1;
+            c.nationkey = r.Uniform(0, 24);
+            snprintf(c.mktsegment, sizeof(c.mktsegment),
+                     "%s", segments[r.Uniform(0, 4)]);
+            return c;
+        }).Cache().Execute();
+
+    t.supplier = Generate(
+        ctx, sf.suppliers,
+        [](size_t index) {
+            RowRandom r(kSupplier, index + 1);
+            Supplier s;
+            s.suppkey = index + 1;
+            s.nationkey = r.Uniform(0, 24);
+            return s;
+        }).Cache().Execute();
+
+    t.part = Generate(
+        ctx, sf.parts,
+        [](size_t index) {
+            RowRandom r(kPart, index + 1);
+            Part p;
+            p.partkey = index + 1;
+            std::string name;
+            for (size_t w = 0; w < 5; ++w) {
+                if (w) name += ' ';
+                name += colors[r.Uniform(0, sizeof(colors) / sizeof(*colors) - 1)];
+            }
+            snprintf(p.name, sizeof(p.name), "%s", name.c_str());
+            return p;
+        }).Cache().Execute();
+
+    t.partsupp = Generate(
+        ctx, 4 * sf.parts,
+        [sf](size_t index) {
+            RowRandom r(kPartSupp, index);
+            PartSupp ps;
+            ps.partkey = index / 4 + 1;
+            ps.suppkey = PartSupplier(ps.partkey, index % 4, sf.suppliers);
+            ps.supplycost = static_cast<double>(r.Uniform(100, 100000)) / 100.0;
+            return ps;
+        }).Cache().Execute();
+
+    return t;
+}
+
+/******************************************************************************/
+// Table Reading
+
+//! read the rows of a dbgen .tbl file with a parse function on its fields
+template <typename Row, typename ParseFunction>
+static DIA<Row> ReadTable(api::Context& ctx, const std::string& path,
+                          const ParseFunction& parse) {
+    return ReadLines(ctx, path).Map(
+        [parse](const std::string& line) {
+            return parse(tlx::split('|', line));
+        }).Cache().Execute();
+}
+
+static Tables ReadTables(api::Context& ctx, const std::string& prefix) {
+    using Fields = std::vector<std::string>;
+    Tables t;
+
+    t.lineitem = ReadTable<LineItem>(
+        ctx, prefix + "lineitem.tbl",
+        [](const Fields& f) {
+            LineItem li;
+            li.orderkey = std::stoul(f[0]);
+            li.partkey = std::stoul(f[1]);
+            li.suppkey = std::stoul(f[2]);
+            li.quantity = std::stod(f[4]);
+            li.extendedprice = std::stod(f[5]);
+            li.discount = std::stod(f[6]);
+            li.tax = std::stod(f[7]);
+            li.returnflag = f[8][0];
+            li.linestatus = f[9][0];
+            li.shipdate = ParseDate(f[10]);
+            return li;
+        });
+
+    t.orders = ReadTable<Order>(
+        ctx, prefix + "orders.tbl",
+        [](const Fields& f) {
+            Order o;
+            o.orderkey = std::stoul(f[0]);
+            o.custkey = std::stoul(f[1]);
+            o.totalprice = std::stod(f[3]);
+            o.orderdate = ParseDate(f[4]);
+            o.shippriority = std::stoi(f[7]);
+            return o;
+        });
+
+    t.customer = ReadTable<Customer>(
+        ctx, prefix + "customer.tbl",
+        [](const Fields& f) {
+            Customer c;
+            c.custkey = std::stoul(f[0]);
+            c.nationkey = std::stoul(f[3]);
+            snprintf(c.mktsegment, sizeof(c.mktsegment), "%s", f[6].c_str());
+            return c;
+        });
+
+    t.supplier = ReadTable<Supplier>(
+        ctx, prefix + "supplier.tbl",
+        [](const Fields& f) {
+            Supplier s;
+            s.suppkey = std::stoul(f[0]);
+            s.nationkey = std::stoul(f[3]);
+            return s;
+        });
+
+    t.part = ReadTable<Part>(
+        ctx, prefix + "part.tbl",
+        [](const Fields& f) {
+            Part p;
+            p.partkey = std::stoul(f[0]);
+            snprintf(p.name, sizeof(p.name), "%s", f[1].c_str());
+            return p;
+        });
+
+    t.partsupp = ReadTable<PartSupp>(
+        ctx, prefix + "partsupp.tbl",
+        [](const Fields& f) {
+            PartSupp ps;
+            ps.partkey = std::stoul(f[0]);
+            ps.suppkey = std::stoul(f[1]);
+            ps.supplycost = std::stod(f[3]);
+            return ps;
+        });
+
+    return t;
+}
+
+/******************************************************************************/
+// Queries, each returns the number of result rows and prints them on worker 0
+// if verbose.
+
+//! Q1: pricing summary report
+static size_t Query1(api::Context& ctx, const Tables& t, bool verbose) {
+    struct Row {
+        char   returnflag, linestatus;
+        double sum_qty, sum_base_price, sum_disc_price, sum_charge, sum_disc;
+        size_t count;
+    };
+
+    std::vector<Row> result =
+        t.lineitem
+        .Filter([](const LineItem& li) { return li.shipdate <= 19980902; })
+        .Map([](const LineItem& li) {
+                 double disc_price = li.extendedprice * (1 - li.discount);
+                 return Row {
+                     li.returnflag, li.linestatus, li.quantity,
+                     li.extendedprice, disc_price, disc_price * (1 + li.tax),
+                     li.discount, 1
+                 };
+             })
+        .ReduceByKey(
+            [](const Row& r) { return r.returnflag * 256 + r.linestatus; },
+            [](const Row& a, const Row& b) {
+                return Row {
+                    a.returnflag, a.linestatus, a.sum_qty + b.sum_qty,
+                    a.sum_base_price + b.sum_base_price,
+                    a.sum_disc_price + b.sum_disc_price,
+                    a.sum_charge + b.sum_charge, a.sum_disc + b.sum_disc,
+                    a.count + b.count
+                };
+            })
+        .Sort([](const Row& a, const Row& b) {
+                  return std::make_pair(a.returnflag, a.linestatus)
+                  < std::make_pair(b.returnflag, b.linestatus);
+              })
+        .AllGather();
+
+    if (verbose && ctx.my_rank() == 0) {
+        for (const Row& r : result) {
+            double n = static_cast<double>(r.count);
+            LOG1 << "Q1 " << r.returnflag << ' ' << r.linestatus
+                 << " sum_qty=" << r.sum_qty
+                 << " sum_base_price=" << r.sum_base_price
+                 << " sum_disc_price=" << r.sum_disc_price
+                 << " sum_charge=" << r.sum_charge
+                 << " avg_qty=" << r.sum_qty / n
+                 << " avg_price=" << r.sum_base_price / n
+                 << " avg_disc=" << r.sum_disc / n
+                 << " count_order=" << r.count;
+        }
+    }
+    return result.size();
+}
+
+//! Q3: shipping priority, top 10 unshipped orders of the BUILDING segment
+static size_t Query3(api::Context& ctx, const Tables& t, bool verbose) {
+    struct Row {
+        size_t orderkey;
+        Date   orderdate;
+        int    shippriority;
+        double revenue;
+    };
+
+    auto customers =
+        t.customer
+        .Filter([](const Customer& c) {
+                    return strcmp(c.mktsegment, "BUILDING") == 0;
+                })
+        .Map([](const Customer& c) { return c.custkey; });
+
+    auto orders =
+        InnerJoin(
+            customers,
+            t.orders.Filter(
+                [](const Order& o) { return o.orderdate < 19950315; }),
+            [](const size_t& custkey) { return custkey; },
+            [](const Order& o) { return o.custkey; },
+            [](const size_t&, const Order& o) { return o; });
+
+    std::vector<Row> result =
+        InnerJoin(
+            orders,
+            t.lineitem.Filter(
+                [](const LineItem& li) { return li.shipdate > 19950315; }),
+            [](const Order& o) { return o.orderkey; },
+            [](const LineItem& li) { return li.orderkey; },
+            [](const Order& o, const LineItem& li) {
+                return Row {
+                    o.orderkey, o.orderdate, o.shippriority,
+                    li.extendedprice * (1 - li.discount)
+                };
+            })
+        .ReduceByKey(
+            [](const Row& r) { return r.orderkey; },
+            [](const Row& a, const Row& b) {
+                return Row {
+                    a.orderkey, a.orderdate, a.shippriority,
+                    a.revenue + b.revenue
+                };
+            })
+        .TopK(10, [](const Row& a, const Row& b) {
+                  return a.revenue > b.revenue ||
+                  (a.revenue == b.revenue && a.orderdate < b.orderdate);
+              });
+
+    if (verbose && ctx.my_rank() == 0) {
+        for (const Row& r : result) {
+            LOG1 << "Q3 orderkey=" << r.orderkey
+                 << " revenue=" << r.revenue
+                 << " orderdate=" << r.orderdate
+                 << " shippriority=" << r.shippriority;
+        }
+    }
+    return result.size();
+}
+
+//! Q5: local supplier volume of the ASIA region in 1994
+static size_t Query5(api::Context& ctx, const Tables& t, bool verbose) {
+    struct KeyNation {
+        size_t key, nationkey;
+    };
+    struct SuppRevenue {
+        size_t suppkey, nationkey;
+        double revenue;
+    };
+    struct Row {
+        size_t nationkey;
+        double revenue;
+    };
+    static constexpr size_t kRegion = 2; // ASIA
+    static constexpr size_t kNoNation = size_t(-1);
+
+    auto customers =
+        t.customer
+        .Filter([](const Customer& c) {
+                    return nations[c.nationkey].regionkey == kRegion;
+                })
+        .Map([](const Customer& c) {
+                 return KeyNation { c.custkey, c.nationkey };
+             });
+
+    auto orders =
+        InnerJoin(
+            customers,
+            t.orders.Filter([](const Order& o) {
+                                return o.orderdate >= 19940101 &&
+                                o.orderdate < 19950101;
+                            }),
+            [](const KeyNation& c) { return c.key; },
+            [](const Order& o) { return o.custkey; },
+            [](const KeyNation& c, const Order& o) {
+                return KeyNation { o.orderkey, c.nationkey };
+            });
+
+    auto lines =
+        InnerJoin(
+            orders, t.lineitem,
+            [](const KeyNation& o) { return o.key; },
+            [](const LineItem& li) { return li.orderkey; },
+            [](const KeyNation& o, const LineItem& li) {
+                return SuppRevenue {
+                    li.suppkey, o.nationkey,
+                    li.extendedprice * (1 - li.discount)
+                };
+            });
+
+    std::vector<Row> result =
+        InnerJoin(
+            BroadcastJoinTag, lines, t.supplier,
+            [](const SuppRevenue& l) { return l.suppkey; },
+            [](const Supplier& s) { return s.suppkey; },
+            [](const SuppRevenue& l, const Supplier& s) {
+                // customer and supplier must be of the same nation
+                return Row {
+                    s.nationkey == l.nationkey ? l.nationkey : kNoNation,
+                    l.revenue
+                };
+            })
+        .Filter([](const Row& r) { return r.nationkey != kNoNation; })
+        .ReduceByKey(
+            [](const Row& r) { return r.nationkey; },
+            [](const Row& a, const Row& b) {
+                return Row { a.nationkey, a.revenue + b.revenue };
+            })
+        .Sort([](const Row& a, const Row& b) { return a.revenue > b.revenue; })
+        .AllGather();
+
+    if (verbose && ctx.my_rank() == 0) {
+        for (const Row& r : result) {
+            LOG1 << "Q5 nation=" << nations[r.nationkey].name
+                 << " revenue=" << r.revenue;
+        }
+    }
+    return result.size();
+}
+
+//! Q6: forecasting revenue change
+static size_t Query6(api::Context& ctx, const Tables& t, bool verbose) {
+    double revenue =
+        t.lineitem
+        .Filter([](const LineItem& li) {
+                    return li.shipdate >= 19940101 && li.shipdate < 19950101 &&
+                    li.discount >= 0.05 - 1e-9 && li.discount <= 0.07 + 1e-9 &&
+                    li.quantity < 24;
+                })
+        .Map([](const LineItem& li) { return li.extendedprice * li.discount; })
+        .Sum();
+
+    if (verbose && ctx.my_rank() == 0)
+        LOG1 << "Q6 revenue=" << revenue;
+    return 1;
+}
+
+//! Q9: product type profit of parts named "green" by nation and year
+static size_t Query9(api::Context& ctx, const Tables& t, bool verbose) {
+    struct GreenLine {
+        size_t orderkey, partkey, suppkey;
+        double quantity, revenue;
+    };
+    struct OrderProfit {
+        size_t orderkey, suppkey;
+        double amount;
+    };
+    struct Row {
+        size_t   nationkey;
+        uint32_t year;
+        double   amount;
+    };
+
+    //! combined key of (partkey, suppkey)
+    auto ps_key = [](size_t partkey, size_t suppkey) {
+                      return (partkey << 32) | suppkey;
+                  };
+
+    auto green_parts =
+        t.part
+        .Filter([](const Part& p) { return strstr(p.name, "green") != nullptr; })
+        .Map([](const Part& p) { return p.partkey; });
+
+    auto lines =
+        InnerJoin(
+            green_parts, t.lineitem,
+            [](const size_t& partkey) { return partkey; },
+            [](const LineItem& li) { return li.partkey; },
+            [](const size_t&, const LineItem& li) {
+                return GreenLine {
+                    li.orderkey, li.partkey, li.suppkey, li.quantity,
+                    li.extendedprice * (1 - li.discount)
+                };
+            });
+
+    auto profits =
+        InnerJoin(
+            lines, t.partsupp,
+            [ps_key](const GreenLine& l) { return ps_key(l.partkey, l.suppkey); },
+            [ps_key](const PartSupp& ps) {
+                return ps_key(ps.partkey, ps.suppkey);
+            },
+            [](const GreenLine& l, const PartSupp& ps) {
+                return OrderProfit {
+                    l.orderkey, l.suppkey,
+                    l.revenue - ps.supplycost * l.quantity
+                };
+            });
+
+    auto nation_profits =
+        InnerJoin(
+            BroadcastJoinTag, profits, t.supplier,
+            [](const OrderProfit& p) { return p.suppkey; },
+            [](const Supplier& s) { return s.suppkey; },
+            [](const OrderProfit& p, const Supplier& s) {
+                // reuse suppkey for the supplier's nation
+                return OrderProfit { p.orderkey, s.nationkey, p.amount };
+            });
+
+    std::vector<Row> result =
+        InnerJoin(
+            nation_profits, t.orders,
+            [](const OrderProfit& p) { return p.orderkey; },
+            [](const Order& o) { return o.orderkey; },
+            [](const OrderProfit& p, const Order& o) {
+                return Row { p.suppkey, o.orderdate / 10000, p.amount };
+            })
+        .ReduceByKey(
+            [](const Row& r) { return r.nationkey * 10000 + r.year; },
+            [](const Row& a, const Row& b) {
+                return Row { a.nationkey, a.year, a.amount + b.amount };
+            })
+        .Sort([](const Row& a, const Row& b) {
+                  int c = strcmp(nations[a.nationkey].name,
+                                 nations[b.nationkey].name);
+                  return c < 0 || (c == 0 && a.year > b.year);
+              })
+        .AllGather();
+
+    if (verbose && ctx.my_rank() == 0) {
+        for (const Row& r : result) {
+            LOG1 << "Q9 nation=" << nations[r.nationkey].name
+                 << " year=" << r.year << " sum_profit=" << r.amount;
+        }
+    }
+    return result.size();
+}
+
+//! Q18: large volume customers, top 100 orders with quantity above 300
+static size_t Query18(api::Context& ctx, const Tables& t, bool verbose) {
+    struct OrderQuantity {
+        size_t orderkey;
+        double quantity;
+    };
+    struct Row {
+        size_t custkey, orderkey;
+        Date   orderdate;
+        double totalprice, quantity;
+    };
+
+    auto large_orders =
+        t.lineitem
+        .Map([](const LineItem& li) {
+                 return OrderQuantity { li.orderkey, li.quantity };
+             })
+        .ReduceByKey(
+            [](const OrderQuantity& q) { return q.orderkey; },
+            [](const OrderQuantity& a, const OrderQuantity& b) {
+                return OrderQuantity { a.orderkey, a.quantity + b.quantity };
+            })
+        .Filter([](const OrderQuantity& q) { return q.quantity > 300; });
+
+    auto orders =
+        InnerJoin(
+            large_orders, t.orders,
+            [](const OrderQuantity& q) { return q.orderkey; },
+            [](const Order& o) { return o.orderkey; },
+            [](const OrderQuantity& q, const Order& o) {
+                return Row {
+                    o.custkey, o.orderkey, o.orderdate, o.totalprice,
+                    q.quantity
+                };
+            });
+
+    std::vector<Row> result =
+        InnerJoin(
+            orders, t.customer,
+            [](const Row& r) { return r.custkey; },
+            [](const Customer& c) { return c.custkey; },
+            [](const Row& r, const Customer&) { return r; })
+        .TopK(100, [](const Row& a, const Row& b) {
+                  return a.totalprice > b.totalprice ||
+                  (a.totalprice == b.totalprice && a.orderdate < b.orderdate);
+              });
+
+    if (verbose && ctx.my_rank() == 0) {
+        for (const Row& r : result) {
+            char name[32];
+            snprintf(name, sizeof(name), "Customer#%09zu", r.custkey);
+            LOG1 << "Q18 c_name=" << name << " c_custkey=" << r.custkey
+                 << " o_orderkey=" << r.orderkey
+                 << " o_orderdate=" << r.orderdate
+                 << " o_totalprice=" << r.totalprice
+                 << " sum_quantity=" << r.quantity;
+        }
+    }
+    return result.size();
+}
+
+/******************************************************************************/
+
+int main(int argc, char* argv[]) {
+
+    tlx::CmdlineParser clp;
+
+    clp.set_description(
+        "TPC-H queries Q1, Q3, Q5, Q6, Q9, and Q18 on tables read from "
+        "dbgen's .tbl files in a directory, or generated with dbgen's "
+        "cardinalities but simpler value distributions.");
+
+    double scale_factor = 1.0;
+    clp.add_double('s', "scale_factor", scale_factor,
+                   "scale factor of generated tables, default: 1");
+
+    std::string queries = "1,3,5,6,9,18";
+    clp.add_string('q', "queries", queries,
+                   "comma separated list of queries, default: 1,3,5,6,9,18");
+
+    unsigned repeats = 1;
+    clp.add_unsigned('r', "repeats", repeats,
+                     "run each query a number of times, default: 1");
+
+    bool verbose = false;
+    clp.add_bool('v', "verbose", verbose, "print the query results");
+
+    std::string input_path;
+    clp.add_opt_param_string(
+        "input", input_path,
+        "path prefix of dbgen's .tbl files, e.g. \"sf1/\", "
+        "default: generate tables");
+
+    if (!clp.process(argc, argv)) {
+        return -1;
+    }
+
+    clp.print_result();
+
+    return api::Run(
+        [&](api::Context& ctx) {
+            common::StatsTimerStart load_timer;
+
+            Tables tables = input_path.size()
+                            ? ReadTables(ctx, input_path)
+                            : GenerateTables(ctx, ScaleFactor(scale_factor));
+
+            size_t lineitems = tables.lineitem.Size();
+            ctx.net.Barrier();
+            load_timer.Stop();
+
+            if (ctx.my_rank() == 0) {
+                LOG1 << "RESULT benchmark=tpch_queries query=load"
+                     << " scale_factor=" << scale_factor
+                     << " lineitems=" << lineitems
+                     << " load_time=" << load_timer
+                     << " hosts=" << ctx.num_hosts()
+                     << " workers=" << ctx.num_workers();
+            }
+
+            for (const std::string& q : tlx::split(',', queries)) {
+                for (size_t r = 0; r < repeats; ++r) {
+                    ctx.net.Barrier();
+                    common::StatsTimerStart timer;
+
+                    size_t rows;
+                    if (q == "1")
+                        rows = Query1(ctx, tables, verbose);
+                    else if (q == "3")
+                        rows = Query3(ctx, tables, verbose);
+                    else if (q == "5")
+                        rows = Query5(ctx, tables, verbose);
+                    else if (q == "6")
+                        rows = Query6(ctx, tables, verbose);
+                    else if (q == "9")
+                        rows = Query9(ctx, tables, verbose);
+                    else if (q == "18")
+                        rows = Query18(ctx, tables, verbose);
+                    else
+                        die("Unknown query Q" << q);
+
+                    ctx.net.Barrier();
+                    timer.Stop();
+
+                    if (ctx.my_rank() == 0) {
+                        LOG1 << "RESULT benchmark=tpch_queries query=Q" << q
+                             << " scale_factor=" << scale_factor
+                             << " rows=" << rows
+                             << " time=" << timer
+                             << " traffic=" << ctx.net_manager().Traffic()
+                             << " hosts=" << ctx.num_hosts()
+                             << " workers=" << ctx.num_workers();
+                    }
+                }
+            }
+        });
+}
+
+/******************************************************************************/
@@ -12,10 +12,24 @@
 #ifndef THRILL_EXAMPLES_TRIANGLES_TRIANGLES_HEADER
 #define THRILL_EXAMPLES_TRIANGLES_TRIANGLES_HEADER
 
+#include <thrill/api/cache.hpp>
+#include <thrill/api/group_to_index.hpp>
 #include <thrill/api/inner_join.hpp>
+#include <thrill/api/max.hpp>
+#include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/size.hpp>
+#include <thrill/api/sum.hpp>
+#include <thrill/common/config.hpp>
 
+#include <tlx/math/popcount.hpp>
+
+#include <algorithm>
 #include <utility>
+#include <vector>
+
+#if defined(THRILL_HAVE_AVX2)
+#include <immintrin.h>
+#endif
 
 using Node = size_t;
 using Edge = std::pair<Node, Node>;
@@ -42,6 +56,12 @@ struct hash<Edge> {
 namespace examples {
 namespace triangles {
 
+/*!
+ * Count triangles of directed edges (u,v), (v,w), (u,w) with two InnerJoins,
+ * which materializes all wedges of length two. Parallel edges are counted
+ * with their multiplicity. This is kept for comparison with
+ * CountTrianglesOriented().
+ */
 template <bool UseDetection = false, typename Stack>
 size_t CountTriangles(const DIA<Edge, Stack>& edges) {
 
@@ -69,6 +89,185 @@ size_t CountTriangles(const DIA<Edge, Stack>& edges) {
     return triangles.Size();
 }
 
+//! Number of nodes contained in both sorted lists of unique nodes
+static inline
+size_t IntersectionSize(const std::vector<Node>& a,
+                        const std::vector<Node>& b) {
+    const Node* pa = a.data(), * ea = pa + a.size();
+    const Node* pb = b.data(), * eb = pb + b.size();
+    size_t count = 0;
+
+    // gallop through the longer list if the lengths are very skewed
+    if (a.size() > 32 * b.size() || b.size() > 32 * a.size()) {
+        if (a.size() < b.size()) {
+            std::swap(pa, pb);
+            std::swap(ea, eb);
+        }
+        for ( ; pb != eb && pa != ea; ++pb) {
+            pa = std::lower_bound(pa, ea, *pb);
+            if (pa != ea && *pa == *pb) ++count, ++pa;
+        }
+        return count;
+    }
+
+#if defined(THRILL_HAVE_AVX2)
+    // compare blocks of four against all four rotations of the other block,
+    // then advance the block(s) with the smaller last node.
+    while (pa + 4 <= ea && pb + 4 <= eb) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb));
+
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi64(va, vb),
+                _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+            _mm256_or_si256(
+                _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4E)),
+                _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+
+        count += tlx::popcount(static_cast<unsigned>(
+                                   _mm256_movemask_pd(_mm256_castsi256_pd(m))));
+
+        Node last_a = pa[3], last_b = pb[3];
+        if (last_a <= last_b) pa += 4;
+        if (last_b <= last_a) pb += 4;
+    }
+#endif
+
+    // branch-light merge of the remaining nodes
+    while (pa != ea && pb != eb) {
+        Node x = *pa, y = *pb;
+        count += (x == y);
+        pa += (x <= y);
+        pb += (y <= x);
+    }
+    return count;
+}
+
+/*!
+ * Count the triangles of the undirected simple graph of the edges, i.e.
+ * ignoring edge directions, self-loops, and parallel edges, without
+ * materializing wedges.
+ *
+ * Each edge is oriented from the node of lower degree to the node of higher
+ * degree (ties broken by id), which bounds every out-degree by O(sqrt(m)).
+ * The out-adjacency lists are grouped with GroupToIndex, and each triangle
+ * u < v < w in this order is counted exactly once at v, by intersecting the
+ * out-list of v with the out-list of u, which u sends to v.
+ */
+template <typename Stack>
+size_t CountTrianglesOriented(const DIA<Edge, Stack>& edges) {
+
+    using Adjacency = std::pair<Node, std::vector<Node> >;
+    using NodeDegree = std::pair<Node, size_t>;
+    using DegreeMessage = std::pair<Node, NodeDegree>;
+    // (target, (source, out-list of source)): source == target for the
+    // target's own out-list.
+    using ListMessage = std::pair<Node, Adjacency>;
+
+    // both directions of each undirected edge, once
+    auto undirected =
+        edges
+        .Filter([](const Edge& e) { return e.first != e.second; })
+        .Map([](const Edge& e) {
+                 return std::make_pair(std::min(e.first, e.second),
+                                       std::max(e.first, e.second));
+             })
+        .ReduceByKey(
+            [](const Edge& e) { return e; },
+            [](const Edge& a, const Edge& /* b */) { return a; })
+        .template FlatMap<Edge>(
+            [](const Edge& e, auto emit) {
+                emit(e);
+                emit(std::make_pair(e.second, e.first));
+            })
+        .Cache();
+
+    const size_t num_nodes =
+        undirected.Keep()
+        .Map([](const Edge& e) { return e.first; })
+        .Max() + 1;
+
+    // tell each neighbor the degree of the node
+    auto degree_messages =
+        undirected
+        .template GroupToIndex<Adjacency>(
+            [](const Edge& e) { return e.first; },
+            [](auto& r, const Node& v) {
+                Adjacency adj(v, std::vector<Node>());
+                while (r.HasNext()) adj.second.push_back(r.Next().second);
+                return adj;
+            },
+            num_nodes)
+        .template FlatMap<DegreeMessage>(
+            [](const Adjacency& adj, auto emit) {
+                for (const Node& w : adj.second) {
+                    emit(DegreeMessage(
+                             w, NodeDegree(adj.first, adj.second.size())));
+                }
+            });
+
+    // keep the neighbors of higher (degree, id) as the sorted out-list
+    auto oriented =
+        degree_messages
+        .template GroupToIndex<Adjacency>(
+            [](const DegreeMessage& m) { return m.first; },
+            [](auto& r, const Node& w) {
+                std::vector<NodeDegree> in;
+                while (r.HasNext()) in.push_back(r.Next().second);
+
+                NodeDegree self(w, in.size());
+                auto rank = [](const NodeDegree& n) {
+                                return std::make_pair(n.second, n.first);
+                            };
+
+                Adjacency adj(w, std::vector<Node>());
+                for (const NodeDegree& n : in) {
+                    if (rank(self) < rank(n)) adj.second.push_back(n.first);
+                }
+                std::sort(adj.second.begin(), adj.second.end());
+                return adj;
+            },
+            num_nodes);
+
+    // send each out-list to the node itself and to its out-neighbors, and
+    // intersect the received lists with the own one.
+    return oriented
+           .template FlatMap<ListMessage>(
+               [](const Adjacency& adj, auto emit) {
+                   if (adj.second.empty()) return;
+                   emit(ListMessage(adj.first, adj));
+                   for (const Node& v : adj.second)
+                       emit(ListMessage(v, adj));
+               })
+           .template GroupToIndex<size_t>(
+               [](const ListMessage& m) { return m.first; },
+               [](auto& r, const Node& v) {
+                   std::vector<std::vector<Node> > pending;
+                   std::vector<Node> own;
+                   bool have_own = false;
+                   size_t count = 0;
+
+                   while (r.HasNext()) {
+                       ListMessage m = r.Next();
+                       if (m.second.first == v) {
+                           own = std::move(m.second.second);
+                           have_own = true;
+                           for (const std::vector<Node>& list : pending)
+                               count += IntersectionSize(own, list);
+                           pending.clear();
+                       }
+                       else if (have_own)
+                           count += IntersectionSize(own, m.second.second);
+                       else
+                           pending.emplace_back(std::move(m.second.second));
+                   }
+                   return count;
+               },
+               num_nodes)
+           .Sum();
+}
+
 } // namespace triangles
 } // namespace examples
 
@@ -0,0 +1,313 @@
+/*******************************************************************************
+ * examples/vfs_tool/vfs_benchmark.cpp
+ *
+ * Measures the read throughput and CPU cost of the VFS backends and filters.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/vfs/file_io.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/die.hpp>
+#include <tlx/string/ends_with.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
+#include <tlx/string/split.hpp>
+#include <tlx/string/starts_with.hpp>
+#include <tlx/unused.hpp>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+//! compression filter extensions, selected by OpenReadStream()
+static const char* filter_extensions[] = {
+    ".gz", ".bgz", ".bz2", ".zst", ".lz4"
+};
+
+//! backend of path: sys, s3, or hdfs
+static std::string Backend(const std::string& path) {
+    if (tlx::starts_with(path, "s3://")) return "s3";
+    if (tlx::starts_with(path, "hdfs://")) return "hdfs";
+    return "sys";
+}
+
+//! filter of path by its extension, or plain
+static std::string Format(const std::string& path) {
+    for (const char* ext : filter_extensions) {
+        if (tlx::ends_with(path, ext)) return ext + 1;
+    }
+    return "plain";
+}
+
+//! user and system CPU time of the process in seconds
+static double CpuSeconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+           + static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec)
+           / 1e6;
+}
+
+//! read the byte range [begin,end) of path, or all of it if end is zero.
+//! Returns the number of bytes delivered by the stream.
+static uint64_t ReadRange(const std::string& path, uint64_t begin,
+                          uint64_t end, std::vector<char>& buffer) {
+    vfs::ReadStreamPtr rs = vfs::OpenReadStream(
+        path, common::Range(begin, end));
+
+    // SysFile only seeks to begin, hence stop at end ourselves.
+    uint64_t rest = end == 0 ? uint64_t(-1) : end - begin, total = 0;
+    while (rest != 0) {
+        ssize_t rb = rs->read(
+            buffer.data(), std::min<uint64_t>(buffer.size(), rest));
+        if (rb <= 0) break;
+        total += rb;
+        rest -= rb;
+    }
+    rs->close();
+    return total;
+}
+
+//! evict the cached pages of local files, such that they are read from disk
+static void DropPageCache(const vfs::FileList& files) {
+#if defined(POSIX_FADV_DONTNEED)
+    for (const vfs::FileInfo& fi : files) {
+        if (fi.IsRemoteUri()) continue;
+        int fd = ::open(fi.path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    tlx::unused(files);
+#endif
+}
+
+class VfsReadBenchmark
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        tlx::CmdlineParser clp;
+
+        clp.set_description(
+            "Thrill VFS read benchmark: reads files with each worker count "
+            "and buffer size, sequentially (whole files round-robin to the "
+            "workers) and range-split (the total size split into byte ranges "
+            "like ReadLines, compressed files whole), and prints one RESULT "
+            "line with MB/s and CPU seconds per MB for each backend and "
+            "compression filter of the files.");
+
+        clp.add_string('w', "workers", workers_,
+                       "comma separated worker thread counts "
+                       "(default 1,2,4,8)");
+
+        clp.add_string('B', "buffers", buffers_,
+                       "comma separated read buffer sizes "
+                       "(default 4ki,64ki,1mi)");
+
+        clp.add_string('m', "modes", modes_,
+                       "comma separated modes: sequential, split "
+                       "(default sequential,split)");
+
+        clp.add_bytes('g', "generate", generate_,
+                      "generate this many bytes of text into a temporary "
+                      "directory in each format instead of reading paths");
+
+        clp.add_string('f', "formats", formats_,
+                       "comma separated formats to generate: plain, gz, bgz, "
+                       "bz2, zst, lz4 (default plain,gz,bgz,bz2)");
+
+        clp.add_unsigned('F', "files", generate_files_,
+                         "number of files generated per format (default 8)");
+
+        clp.add_bool('D', "drop_cache", drop_cache_,
+                     "evict local files from the page cache before each run");
+
+        clp.add_unsigned(
+            'n', "iterations", iterations_, "Iterations (default: 1)");
+
+        clp.add_opt_param_stringlist("paths", paths_,
+                                     "file path(s) or globs to read");
+
+        if (!clp.process(argc, argv)) return -1;
+
+        die_unless(generate_files_ >= 1);
+
+        vfs::Initialize();
+
+        std::unique_ptr<vfs::TemporaryDirectory> tmpdir;
+        if (generate_ != 0) {
+            tmpdir = std::make_unique<vfs::TemporaryDirectory>();
+            Generate(tmpdir->get());
+            paths_.push_back(tmpdir->get() + "/*");
+        }
+        die_unless(!paths_.empty());
+
+        // benchmark each backend and filter separately
+        std::map<std::string, vfs::FileList> groups;
+        for (const vfs::FileInfo& fi :
+             vfs::Glob(paths_, vfs::GlobType::File)) {
+            groups[Backend(fi.path) + " " + Format(fi.path)].push_back(fi);
+        }
+
+        for (auto& g : groups) {
+            g.second.CalculateStats();
+            for (const std::string& mode : tlx::split(',', modes_)) {
+                for (const std::string& w : tlx::split(',', workers_)) {
+                    for (const std::string& b : tlx::split(',', buffers_)) {
+                        uint64_t buffer_size;
+                        die_unless(tlx::parse_si_iec_units(b, &buffer_size));
+                        for (unsigned i = 0; i < iterations_; ++i) {
+                            Test(g.second, mode, std::stoul(w), buffer_size);
+                        }
+                    }
+                }
+            }
+        }
+
+        tmpdir.reset();
+        vfs::Deinitialize();
+        return 0;
+    }
+
+private:
+    std::string workers_ = "1,2,4,8";
+    std::string buffers_ = "4ki,64ki,1mi";
+    std::string modes_ = "sequential,split";
+    std::string formats_ = "plain,gz,bgz,bz2";
+    uint64_t generate_ = 0;
+    unsigned generate_files_ = 8;
+    bool drop_cache_ = false;
+    unsigned iterations_ = 1;
+    std::vector<std::string> paths_;
+
+    //! write generate_ bytes of random words in generate_files_ files per
+    //! format into dir
+    void Generate(const std::string& dir) {
+        std::default_random_engine rng(42);
+        std::string text;
+        while (text.size() < generate_ / generate_files_) {
+            text += "word" + std::to_string(rng() % 100000);
+            text += (rng() % 8 == 0) ? '\n' : ' ';
+        }
+
+        for (const std::string& format : tlx::split(',', formats_)) {
+            for (size_t f = 0; f < generate_files_; ++f) {
+                std::string path = dir + "/data-" + std::to_string(f) + ".txt";
+                if (format != "plain") path += "." + format;
+
+                common::StatsTimerStart timer;
+                vfs::WriteStreamPtr ws = vfs::OpenWriteStream(path);
+                ws->write(text.data(), text.size());
+                ws->close();
+
+                sLOG1 << "generated" << path << "in" << timer;
+            }
+        }
+    }
+
+    //! byte ranges read by worker: [begin,end) of each file, end zero for
+    //! whole files.
+    struct Part {
+        std::string path;
+        uint64_t    begin, end;
+    };
+
+    static std::vector<Part> Parts(const vfs::FileList& files,
+                                   const std::string& mode,
+                                   size_t worker, size_t num_workers) {
+        std::vector<Part> parts;
+        if (mode == "sequential") {
+            for (size_t i = worker; i < files.size(); i += num_workers)
+                parts.push_back(Part { files[i].path, 0, 0 });
+            return parts;
+        }
+        die_unless(mode == "split");
+
+        uint64_t begin = files.total_size * worker / num_workers;
+        uint64_t end = files.total_size * (worker + 1) / num_workers;
+        for (const vfs::FileInfo& fi : files) {
+            if (fi.IsCompressed()) {
+                // compressed files are not splittable, like in ReadLines
+                if (fi.size_ex_psum >= begin && fi.size_ex_psum < end)
+                    parts.push_back(Part { fi.path, 0, 0 });
+                continue;
+            }
+            uint64_t b = std::max(begin, fi.size_ex_psum);
+            uint64_t e = std::min(end, fi.size_inc_psum());
+            if (b < e)
+                parts.push_back(
+                    Part { fi.path, b - fi.size_ex_psum, e - fi.size_ex_psum });
+        }
+        return parts;
+    }
+
+    void Test(const vfs::FileList& files, const std::string& mode,
+              size_t num_workers, size_t buffer_size) {
+        die_unless(num_workers >= 1 && buffer_size >= 1);
+
+        if (drop_cache_) DropPageCache(files);
+
+        std::atomic<uint64_t> bytes { 0 };
+        double cpu_start = CpuSeconds();
+        common::StatsTimerStart timer;
+
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < num_workers; ++w) {
+            threads.emplace_back(
+                [&, w]() {
+                    std::vector<char> buffer(buffer_size);
+                    uint64_t sum = 0;
+                    for (const Part& p : Parts(files, mode, w, num_workers))
+                        sum += ReadRange(p.path, p.begin, p.end, buffer);
+                    bytes += sum;
+                });
+        }
+        for (std::thread& t : threads)
+            t.join();
+
+        timer.Stop();
+        double cpu = CpuSeconds() - cpu_start;
+        double seconds = timer.SecondsDouble();
+        double mb = static_cast<double>(bytes.load()) / 1e6;
+
+        LOG1 << "RESULT"
+             << " experiment=" << "vfs_read"
+             << " backend=" << Backend(files[0].path)
+             << " format=" << Format(files[0].path)
+             << " mode=" << mode
+             << " workers=" << num_workers
+             << " buffer_size=" << buffer_size
+             << " files=" << files.size()
+             << " stored_bytes=" << files.total_size
+             << " bytes=" << bytes.load()
+             << " time=" << seconds
+             << " MBs=" << mb / seconds
+             << " stored_MBs=" << files.total_size / 1e6 / seconds
+             << " cpu_time=" << cpu
+             << " cpu_s_per_MB=" << cpu / mb;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    return VfsReadBenchmark().Run(argc, argv);
+}
+
+/******************************************************************************/
@@ -57,52 +57,29 @@ auto WordCount(const DIA<std::string, InputStack>& input) {
 
 /******************************************************************************/
 
-using HashWord = std::pair<size_t, std::string>;
-using HashWordCount = std::pair<HashWord, size_t>;
-
-struct HashWordHasher {
-    size_t operator () (const HashWord& w) const {
-        // return first which is the hash of the word
-        return w.first;
-    }
-};
-
 //! The second WordCount user program: reads a DIA containing std::string words,
-//! creates hash values from the words prior to reducing by hash and
-//! word. Returns a DIA containing WordCountPairs.
+//! and reduces WordCountPairs with ReducePair and PreHashKeyTag, which hashes
+//! each word only once before the pre-phase and carries the hash to the
+//! post-phase. Returns a DIA containing WordCountPairs.
 template <typename InputStack>
 auto HashWordCountExample(const DIA<std::string, InputStack>& input) {
 
-    std::hash<std::string> string_hasher;
-
-    auto r =
-        input
-        .template FlatMap<std::string>(
-            [](const std::string& line, auto emit) {
-                /* map lambda: emit each word */
-                tlx::split_view(
-                    ' ', line, [&](const tlx::string_view& sv) {
-                        if (sv.size() == 0) return;
-                        emit(sv.to_string());
-                    });
-            })
-        .Map([&](const std::string& word) {
-                 return HashWordCount(HashWord(string_hasher(word), word), 1);
-             })
-        .ReduceByKey(
-            [](const HashWordCount& in) {
-                /* reduction key: the word string */
-                return in.first;
-            },
-            [](const HashWordCount& a, const HashWordCount& b) {
-                /* associative reduction operator: add counters */
-                return HashWordCount(a.first, a.second + b.second);
-            },
-            api::DefaultReduceConfig(), HashWordHasher())
-        .Map([](const HashWordCount& in) {
-                 return WordCountPair(in.first.second, in.second);
-             });
-    return r;
+    auto word_pairs = input.template FlatMap<WordCountPair>(
+        [](const std::string& line, auto emit) -> void {
+            /* map lambda: emit each word */
+            tlx::split_view(
+                ' ', line, [&](const tlx::string_view& sv) {
+                    if (sv.size() == 0) return;
+                    emit(WordCountPair(sv.to_string(), 1));
+                });
+        });
+
+    return word_pairs.ReducePair(
+        PreHashKeyTag,
+        [](const size_t& a, const size_t& b) -> size_t {
+            /* associative reduction operator: add counters */
+            return a + b;
+        });
 }
 
 } // namespace word_count
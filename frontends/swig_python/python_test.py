@@ -9,6 +9,7 @@
 # All rights reserved. Published under the BSD-2 license in the LICENSE file.
 ##########################################################################
 
+import array
 import unittest
 import threading
 import sys
@@ -112,6 +113,56 @@ class TestOperations(unittest.TestCase):
 
         run_tests(test)
 
+    def test_batch_map_filter_reduce(self):
+
+        def test(ctx):
+            test_size = 1000
+
+            dia1 = ctx.Generate(lambda x: int(x), test_size)
+
+            dia2 = dia1.MapBatch(
+                lambda xs: [x + y for x in xs for y in (0, 1)], 64)
+            self.assertEqual(dia2.Size(), 2 * test_size)
+
+            dia3 = dia2.FilterBatch(lambda xs: [x % 3 == 0 for x in xs])
+            check = [x + y for x in range(0, test_size) for y in (0, 1)
+                     if (x + y) % 3 == 0]
+            self.assertEqual(dia3.AllGather(), check)
+
+            dia4 = dia1.ReduceByBatch(lambda xs: [x % 10 for x in xs],
+                                      lambda x, y: x + y, 100)
+            self.assertEqual(sorted(dia4.AllGather()),
+                             sorted([sum(range(k, test_size, 10))
+                                     for k in range(0, 10)]))
+
+        run_tests(test)
+
+    def test_numeric_buffers(self):
+
+        def test(ctx):
+            test_size = 1000
+
+            buf = array.array('d', [x * 0.5 for x in range(0, test_size)])
+            dia1 = ctx.EqualToDIADoubles(buf)
+            self.assertEqual(dia1.Size(), test_size)
+            self.assertEqual(dia1.Sum(), sum(buf))
+            self.assertEqual(dia1.AllGather().tolist(), buf.tolist())
+
+            dia2 = ctx.EqualToDIAInt64s(array.array('q', range(0, test_size)))
+            gathered = dia2.Gather(0)
+            if ctx.my_rank() == 0:
+                self.assertEqual(gathered.tolist(), list(range(0, test_size)))
+            else:
+                self.assertEqual(len(gathered), 0)
+
+            dia3 = dia2.ToObjects().Map(lambda x: x * 2).ToInt64s()
+            self.assertEqual(dia3.Sum(), test_size * (test_size - 1))
+
+            with self.assertRaises(RuntimeError):
+                ctx.EqualToDIADoubles(array.array('i', [1, 2, 3]))
+
+        run_tests(test)
+
     def my_generator(self, index):
         #print("generator at index", index)
         return (index, "hello at %d" % (index))
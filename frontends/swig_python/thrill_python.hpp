@@ -18,17 +18,26 @@
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
 #include <thrill/api/distribute.hpp>
+#include <thrill/api/gather.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/reduce.hpp>
+#include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/size.hpp>
+#include <thrill/api/sum.hpp>
+#include <thrill/api/window.hpp>
 #include <thrill/common/string.hpp>
 
 #include <bytesobject.h>
 #include <marshal.h>
 #include <Python.h>
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -55,6 +64,12 @@ public:
         SWIG_PYTHON_THREAD_END_BLOCK;
     }
 
+    //! move-constructor: steals the reference, hence needs no GIL.
+    PyObjectRef(PyObjectRef&& pyref) noexcept
+        : obj_(pyref.obj_) {
+        pyref.obj_ = nullptr;
+    }
+
     explicit PyObjectRef(PyObject* obj, bool initial_ref = true)
         : obj_(obj) {
         if (initial_ref) {
@@ -73,9 +88,23 @@ public:
         return *this;
     }
 
+    //! move-assignment: only takes the GIL to release a held reference.
+    PyObjectRef& operator = (PyObjectRef&& pyref) noexcept {
+        if (this == &pyref) return *this;
+        if (obj_) {
+            SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+            Py_DECREF(obj_);
+            SWIG_PYTHON_THREAD_END_BLOCK;
+        }
+        obj_ = pyref.obj_;
+        pyref.obj_ = nullptr;
+        return *this;
+    }
+
     ~PyObjectRef() {
+        if (!obj_) return;
         SWIG_PYTHON_THREAD_BEGIN_BLOCK;
-        Py_XDECREF(obj_);
+        Py_DECREF(obj_);
         SWIG_PYTHON_THREAD_END_BLOCK;
     }
 
@@ -193,6 +222,34 @@ public:
     virtual PyObjectVarRef operator () (PyObject* obj1, PyObject* obj2) = 0;
 };
 
+/*!
+ * Batch callbacks receive a Python list of many items at once, which saves the
+ * per-item call and GIL overhead.
+ */
+class BatchMapFunction
+{
+public:
+    virtual ~BatchMapFunction() { }
+    //! return a sequence of any number of output items for the list
+    virtual PyObjectVarRef operator () (PyObject* list) = 0;
+};
+
+class BatchFilterFunction
+{
+public:
+    virtual ~BatchFilterFunction() { }
+    //! return a sequence of truth values, one for each item of the list
+    virtual PyObjectVarRef operator () (PyObject* list) = 0;
+};
+
+class BatchKeyExtractorFunction
+{
+public:
+    virtual ~BatchKeyExtractorFunction() { }
+    //! return a sequence of keys, one for each item of the list
+    virtual PyObjectVarRef operator () (PyObject* list) = 0;
+};
+
 } // namespace thrill
 
 // import Swig Director classes.
@@ -224,6 +281,9 @@ namespace thrill {
 //! counted PyObjects.
 typedef api::DIA<PyObjectRef> PyObjDIA;
 
+template <typename Type>
+class PyNumericDIA;
+
 /*!
  * This is a wrapper around the C++ DIA class, which returns plain PyDIAs
  * again. The C++ function stack is always collapsed.
@@ -248,6 +308,9 @@ public:
         sLOG << "delete PyDIA" << this;
     }
 
+    //! default number of items passed to the batch callbacks at once
+    static const size_t default_batch_size = 1024;
+
     PyDIA Map(MapFunction& map_function) const {
         assert(dia_.IsValid());
 
@@ -329,11 +392,132 @@ public:
             .Cache());
     }
 
+    /*!
+     * Map with a callback receiving batch_size consecutive items as a list,
+     * which returns a sequence of output items of any length.
+     */
+    PyDIA MapBatch(BatchMapFunction& map_function,
+                   size_t batch_size = default_batch_size) const {
+        assert(dia_.IsValid());
+        assert(batch_size > 0);
+
+        SwigDirector_BatchMapFunction& director =
+            *dynamic_cast<SwigDirector_BatchMapFunction*>(&map_function);
+
+        return PyDIA(
+            dia_.template FlatWindow<PyObjectRef>(
+                DisjointTag, batch_size,
+                [&map_function,
+                 // this holds a reference count to the callback object for the
+                 // lifetime of the capture object.
+                 ref = PyObjectRef(director.swig_get_self())
+                ](size_t /* index */, const std::vector<PyObjectRef>& batch,
+                  auto emit) {
+                    for (const PyObjectRef& out :
+                         CallBatch(map_function, batch, 0))
+                        emit(out);
+                }));
+    }
+
+    /*!
+     * Filter with a callback receiving batch_size consecutive items as a
+     * list, which returns a sequence of one truth value per item.
+     */
+    PyDIA FilterBatch(BatchFilterFunction& filter_function,
+                      size_t batch_size = default_batch_size) const {
+        assert(dia_.IsValid());
+        assert(batch_size > 0);
+
+        SwigDirector_BatchFilterFunction& director =
+            *dynamic_cast<SwigDirector_BatchFilterFunction*>(&filter_function);
+
+        return PyDIA(
+            dia_.template FlatWindow<PyObjectRef>(
+                DisjointTag, batch_size,
+                [&filter_function,
+                 // this holds a reference count to the callback object for the
+                 // lifetime of the capture object.
+                 ref = PyObjectRef(director.swig_get_self())
+                ](size_t /* index */, const std::vector<PyObjectRef>& batch,
+                  auto emit) {
+                    std::vector<PyObjectRef> keep =
+                        CallBatch(filter_function, batch, batch.size());
+
+                    std::vector<bool> truth(keep.size());
+                    {
+                        SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+                        for (size_t i = 0; i < keep.size(); ++i)
+                            truth[i] = PyObject_IsTrue(keep[i].get()) == 1;
+                        SWIG_PYTHON_THREAD_END_BLOCK;
+                    }
+
+                    for (size_t i = 0; i < batch.size(); ++i) {
+                        if (truth[i]) emit(batch[i]);
+                    }
+                }));
+    }
+
+    /*!
+     * ReduceBy with a key extractor receiving batch_size consecutive items as
+     * a list, which returns a sequence of one key per item. The items are
+     * reduced per key with the reduce_function.
+     */
+    PyDIA ReduceByBatch(BatchKeyExtractorFunction& key_extractor,
+                        ReduceFunction& reduce_function,
+                        size_t batch_size = default_batch_size) const {
+        assert(dia_.IsValid());
+        assert(batch_size > 0);
+
+        SwigDirector_BatchKeyExtractorFunction& director1 =
+            *dynamic_cast<SwigDirector_BatchKeyExtractorFunction*>(
+                &key_extractor);
+        SwigDirector_ReduceFunction& director2 =
+            *dynamic_cast<SwigDirector_ReduceFunction*>(&reduce_function);
+
+        using PyObjectPair = std::pair<PyObjectRef, PyObjectRef>;
+
+        return PyDIA(
+            dia_.template FlatWindow<PyObjectPair>(
+                DisjointTag, batch_size,
+                [&key_extractor,
+                 // this holds a reference count to the callback object for the
+                 // lifetime of the capture object.
+                 ref1 = PyObjectRef(director1.swig_get_self())
+                ](size_t /* index */, const std::vector<PyObjectRef>& batch,
+                  auto emit) {
+                    std::vector<PyObjectRef> keys =
+                        CallBatch(key_extractor, batch, batch.size());
+                    for (size_t i = 0; i < batch.size(); ++i)
+                        emit(PyObjectPair(std::move(keys[i]), batch[i]));
+                })
+            .ReducePair(
+                [&reduce_function,
+                 // this holds a reference count to the callback object for the
+                 // lifetime of the capture object.
+                 ref2 = PyObjectRef(director2.swig_get_self())
+                ](const PyObjectRef& obj1, const PyObjectRef& obj2) -> PyObjectRef {
+                    // increase reference count, since calling the map_function
+                    // implicitly passed ownership of the reference to the
+                    // caller.
+                    return PyObjectRef(
+                        reduce_function(obj1.get_incref(), obj2.get_incref()),
+                        true);
+                })
+            .Map([](const PyObjectPair& p) { return p.second; })
+            .Cache());
+    }
+
     PyDIA Cache() const {
         assert(dia_.IsValid());
         return PyDIA(dia_.Cache());
     }
 
+    //! convert the items with float() into a DIA of doubles
+    PyNumericDIA<double> ToDoubles() const;
+
+    //! convert the items with int() into a DIA of 64-bit integers
+    PyNumericDIA<int64_t> ToInt64s() const;
+
     size_t Size() const {
         assert(dia_.IsValid());
         return dia_.Size();
@@ -351,8 +535,269 @@ public:
         SWIG_PYTHON_THREAD_END_BLOCK;
         return pylist;
     }
+
+private:
+    /*!
+     * Pass the batch to the callback as one list, and return the items of the
+     * sequence it returns, which must have expected_size items unless that is
+     * zero. The GIL is held only during the call, such that it is released
+     * between the batches.
+     */
+    template <typename BatchFunction>
+    static std::vector<PyObjectRef> CallBatch(
+        BatchFunction& function, const std::vector<PyObjectRef>& batch,
+        size_t expected_size) {
+
+        std::vector<PyObjectRef> result;
+        bool valid = true;
+        {
+            SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+            PyObject* list = PyList_New(batch.size());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                // the list steals a reference
+                Py_XINCREF(batch[i].get());
+                PyList_SET_ITEM(list, i, batch[i].get());
+            }
+
+            // calling the function implicitly passed ownership of the list to
+            // the callee.
+            PyObjectRef out(function(list), true);
+
+            PyObject* seq = PySequence_Fast(
+                out.get(), "batch callback must return a sequence");
+            if (seq != nullptr) {
+                Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+                result.reserve(size);
+                for (Py_ssize_t i = 0; i < size; ++i) {
+                    PyObject* item = PySequence_Fast_GET_ITEM(seq, i);
+                    Py_XINCREF(item);
+                    result.emplace_back(item, /* initial_ref */ false);
+                }
+                Py_DECREF(seq);
+            }
+            else {
+                PyErr_PrintEx(0);
+                valid = false;
+            }
+            SWIG_PYTHON_THREAD_END_BLOCK;
+        }
+
+        if (!valid)
+            throw std::runtime_error("batch callback returned no sequence");
+        if (expected_size != 0 && result.size() != expected_size) {
+            throw std::runtime_error(
+                      "batch callback returned " +
+                      std::to_string(result.size()) + " instead of " +
+                      std::to_string(expected_size) + " items");
+        }
+        return result;
+    }
+};
+
+#ifndef SWIG
+
+/*!
+ * Conversions of the numeric item types of PyNumericDIA from and to Python
+ * objects, and their format characters in the buffer protocol.
+ */
+template <typename Type>
+struct PyNumericTraits;
+
+template <>
+struct PyNumericTraits<double> {
+    static const char * format() { return "d"; }
+    static bool IsFormat(const char* f) { return strcmp(f, "d") == 0; }
+    static double FromPy(PyObject* obj) { return PyFloat_AsDouble(obj); }
+    static PyObject * ToPy(double value) { return PyFloat_FromDouble(value); }
+};
+
+template <>
+struct PyNumericTraits<int64_t> {
+    static const char * format() { return "q"; }
+    static bool IsFormat(const char* f) {
+        // NumPy exports int64 as "l" where long has 64 bits.
+        return strcmp(f, "q") == 0 ||
+               (sizeof(long) == sizeof(int64_t) && strcmp(f, "l") == 0);
+    }
+    static int64_t FromPy(PyObject* obj) { return PyLong_AsLongLong(obj); }
+    static PyObject * ToPy(int64_t value) {
+        return PyLong_FromLongLong(value);
+    }
+};
+
+/*!
+ * Holds a Py_buffer view of an object, which keeps the object and the memory
+ * of the buffer alive, such that it can be read without the GIL.
+ */
+class PyBufferRef
+{
+public:
+    //! acquire a C-contiguous, one-dimensional buffer of Type items from obj
+    template <typename Type>
+    static std::shared_ptr<PyBufferRef> Acquire(PyObject* obj) {
+        std::shared_ptr<PyBufferRef> ref = std::make_shared<PyBufferRef>();
+        std::string error;
+
+        SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+        if (PyObject_GetBuffer(obj, &ref->view_,
+                               PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            PyErr_Clear();
+            error = "object does not support the buffer protocol";
+        }
+        else {
+            ref->valid_ = true;
+            // skip native byte order and alignment prefixes
+            const char* f = ref->view_.format ? ref->view_.format : "B";
+            if (*f == '@' || *f == '=') ++f;
+
+            if (ref->view_.ndim > 1)
+                error = "buffer must be one-dimensional";
+            else if (ref->view_.itemsize != sizeof(Type) ||
+                     !PyNumericTraits<Type>::IsFormat(f))
+                error = std::string("buffer must contain items of format ") +
+                        PyNumericTraits<Type>::format() + ", not " + f;
+        }
+        SWIG_PYTHON_THREAD_END_BLOCK;
+
+        if (!error.empty())
+            throw std::runtime_error(error);
+        return ref;
+    }
+
+    //! non-copyable: delete copy-constructor
+    PyBufferRef(const PyBufferRef&) = delete;
+    //! non-copyable: delete assignment operator
+    PyBufferRef& operator = (const PyBufferRef&) = delete;
+
+    PyBufferRef() = default;
+
+    ~PyBufferRef() {
+        if (!valid_) return;
+        SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+        PyBuffer_Release(&view_);
+        SWIG_PYTHON_THREAD_END_BLOCK;
+    }
+
+    //! pointer to the items
+    template <typename Type>
+    const Type * data() const {
+        return reinterpret_cast<const Type*>(view_.buf);
+    }
+
+    //! number of items
+    size_t size() const {
+        return valid_ ? view_.len / view_.itemsize : 0;
+    }
+
+private:
+    Py_buffer view_;
+    bool valid_ = false;
+};
+
+//! copy a vector of numbers into a new bytearray, and return a memoryview of
+//! it cast to the items' format, which NumPy wraps without copying.
+template <typename Type>
+static inline PyObject * VectorToMemoryView(const std::vector<Type>& vec) {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+    PyObject* bytes = PyByteArray_FromStringAndSize(
+        reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(Type));
+    PyObject* view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    PyObject* cast = PyObject_CallMethod(
+        view, const_cast<char*>("cast"), const_cast<char*>("s"),
+        PyNumericTraits<Type>::format());
+    Py_DECREF(view);
+    SWIG_PYTHON_THREAD_END_BLOCK;
+    return cast;
+}
+
+#endif
+
+/*!
+ * A DIA of plain numbers, which are stored as fixed-size items in the Blocks
+ * instead of as marshalled Python objects. Its sources read the memory of
+ * Python buffers, e.g. NumPy arrays, and its sinks return memoryviews which
+ * NumPy wraps without copying. Neither needs a Python object per item.
+ */
+template <typename Type>
+class PyNumericDIA
+{
+    static const bool debug = false;
+
+public:
+    //! underlying C++ DIA class, which can be freely copied by the object.
+    api::DIA<Type> dia_;
+
+    explicit PyNumericDIA(const api::DIA<Type>& dia)
+        : dia_(dia) { }
+
+    size_t Size() const {
+        assert(dia_.IsValid());
+        return dia_.Size();
+    }
+
+    Type Sum() const {
+        assert(dia_.IsValid());
+        return dia_.Sum();
+    }
+
+    PyNumericDIA Cache() const {
+        assert(dia_.IsValid());
+        return PyNumericDIA(dia_.Cache());
+    }
+
+    //! return all items as a memoryview on all workers
+    PyObject * AllGather() const {
+        assert(dia_.IsValid());
+        return VectorToMemoryView(dia_.AllGather());
+    }
+
+    //! return all items as a memoryview on target_id, and an empty one on all
+    //! other workers
+    PyObject * Gather(size_t target_id = 0) const {
+        assert(dia_.IsValid());
+        return VectorToMemoryView(dia_.Gather(target_id));
+    }
+
+    //! convert the items into Python objects
+    PyDIA ToObjects() const {
+        assert(dia_.IsValid());
+        return PyDIA(
+            dia_.Map([](const Type& value) {
+                         SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+                         PyObject* obj = PyNumericTraits<Type>::ToPy(value);
+                         SWIG_PYTHON_THREAD_END_BLOCK;
+                         return PyObjectRef(obj, /* initial_ref */ false);
+                     })
+            .Collapse());
+    }
 };
 
+#ifndef SWIG
+
+template <typename Type>
+static inline PyNumericDIA<Type> PyObjectsToNumbers(const PyObjDIA& dia) {
+    assert(dia.IsValid());
+    return PyNumericDIA<Type>(
+        dia.Map([](const PyObjectRef& obj) {
+                    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+                    Type value = PyNumericTraits<Type>::FromPy(obj.get());
+                    SWIG_PYTHON_THREAD_END_BLOCK;
+                    return value;
+                })
+        .Collapse());
+}
+
+inline PyNumericDIA<double> PyDIA::ToDoubles() const {
+    return PyObjectsToNumbers<double>(dia_);
+}
+
+inline PyNumericDIA<int64_t> PyDIA::ToInt64s() const {
+    return PyObjectsToNumbers<int64_t>(dia_);
+}
+
+#endif
+
 class PyContext : public api::Context
 {
     static const bool debug = true;
@@ -420,8 +865,38 @@ public:
         return PyDIA(dia);
     }
 
+    /*!
+     * Create a DIA of doubles from a buffer, e.g. a NumPy float64 array. Like
+     * EqualToDIA, all workers must pass equal buffers, and each worker reads
+     * its range directly from the buffer, without the GIL.
+     */
+    PyNumericDIA<double> EqualToDIADoubles(PyObject* buffer) {
+        return EqualToDIABuffer<double>(buffer);
+    }
+
+    //! Create a DIA of 64-bit integers from a buffer, e.g. a NumPy int64
+    //! array, see EqualToDIADoubles().
+    PyNumericDIA<int64_t> EqualToDIAInt64s(PyObject* buffer) {
+        return EqualToDIABuffer<int64_t>(buffer);
+    }
+
 protected:
     std::unique_ptr<HostContext> host_context_;
+
+#ifndef SWIG
+    template <typename Type>
+    PyNumericDIA<Type> EqualToDIABuffer(PyObject* obj) {
+        std::shared_ptr<PyBufferRef> buffer = PyBufferRef::Acquire<Type>(obj);
+        size_t size = buffer->size();
+
+        return PyNumericDIA<Type>(
+            api::Generate(
+                *this, size,
+                [buffer = std::move(buffer)](size_t index) {
+                    return buffer->data<Type>()[index];
+                }));
+    }
+#endif
 };
 
 } // namespace thrill
@@ -28,6 +28,10 @@ using namespace thrill;
 %feature("director") KeyExtractorFunction;
 %feature("director") ReduceFunction;
 
+%feature("director") BatchMapFunction;
+%feature("director") BatchFilterFunction;
+%feature("director") BatchKeyExtractorFunction;
+
 %feature("director:except") {
     if ($error != NULL) {
         // print backtrace
@@ -36,6 +40,18 @@ using namespace thrill;
     }
 }
 
+%include <exception.i>
+
+// raise C++ exceptions, e.g. of invalid buffers, as Python RuntimeErrors.
+%exception {
+    try {
+        $action
+    }
+    catch (const std::exception& e) {
+        SWIG_exception(SWIG_RuntimeError, e.what());
+    }
+}
+
 /*[[[perl
 sub callback_wrapper {
     my $func = shift @_;
@@ -45,7 +61,7 @@ sub callback_wrapper {
     foreach my $i (0..@arglist-1) {
         my $arg = $arglist[$i];
         if ($arg) {
-            print("  if not isinstance(args[$i], $arg) and callable(args[0]):\n");
+            print("  if not isinstance(args[$i], $arg) and callable(args[$i]):\n");
             print("    class CallableWrapper($arg):\n");
             print("      def __init__(self, f):\n");
             print("        super(CallableWrapper, self).__init__()\n");
@@ -57,7 +73,8 @@ sub callback_wrapper {
             print("    wa.append(args[$i])\n");
         }
         else {
-            print("  wa.append(args[$i])\n");
+            # slice, since trailing arguments may be defaulted
+            print("  wa.extend(args[$i:".($i+1)."])\n");
         }
     }
     print("  args = tuple(wa)\n");
@@ -72,6 +89,17 @@ callback_wrapper('thrill::PyDIA::Map(MapFunction&) const',
 
 callback_wrapper('thrill::PyDIA::Filter(FilterFunction&) const',
                  'FilterFunction');
+
+callback_wrapper('thrill::PyDIA::MapBatch(BatchMapFunction&, size_t) const',
+                 'BatchMapFunction', '');
+
+callback_wrapper('thrill::PyDIA::FilterBatch(BatchFilterFunction&, size_t) '.
+                 'const',
+                 'BatchFilterFunction', '');
+
+callback_wrapper('thrill::PyDIA::ReduceByBatch(BatchKeyExtractorFunction&, '.
+                 'ReduceFunction&, size_t) const',
+                 'BatchKeyExtractorFunction', 'ReduceFunction', '');
 ]]]*/
 %feature("pythonprepend") thrill::PyContext::Generate(GeneratorFunction&, size_t) %{
   wa = []
@@ -85,7 +113,7 @@ callback_wrapper('thrill::PyDIA::Filter(FilterFunction&) const',
     wa.append(CallableWrapper(args[0]))
   else:
     wa.append(args[0])
-  wa.append(args[1])
+  wa.extend(args[1:2])
   args = tuple(wa)
 %}
 %feature("pythonprepend") thrill::PyDIA::Map(MapFunction&) const %{
@@ -116,6 +144,61 @@ callback_wrapper('thrill::PyDIA::Filter(FilterFunction&) const',
     wa.append(args[0])
   args = tuple(wa)
 %}
+%feature("pythonprepend") thrill::PyDIA::MapBatch(BatchMapFunction&, size_t) const %{
+  wa = []
+  if not isinstance(args[0], BatchMapFunction) and callable(args[0]):
+    class CallableWrapper(BatchMapFunction):
+      def __init__(self, f):
+        super(CallableWrapper, self).__init__()
+        self.f_ = f
+      def __call__(self, *args):
+        return self.f_(*args)
+    wa.append(CallableWrapper(args[0]))
+  else:
+    wa.append(args[0])
+  wa.extend(args[1:2])
+  args = tuple(wa)
+%}
+%feature("pythonprepend") thrill::PyDIA::FilterBatch(BatchFilterFunction&, size_t) const %{
+  wa = []
+  if not isinstance(args[0], BatchFilterFunction) and callable(args[0]):
+    class CallableWrapper(BatchFilterFunction):
+      def __init__(self, f):
+        super(CallableWrapper, self).__init__()
+        self.f_ = f
+      def __call__(self, *args):
+        return self.f_(*args)
+    wa.append(CallableWrapper(args[0]))
+  else:
+    wa.append(args[0])
+  wa.extend(args[1:2])
+  args = tuple(wa)
+%}
+%feature("pythonprepend") thrill::PyDIA::ReduceByBatch(BatchKeyExtractorFunction&, ReduceFunction&, size_t) const %{
+  wa = []
+  if not isinstance(args[0], BatchKeyExtractorFunction) and callable(args[0]):
+    class CallableWrapper(BatchKeyExtractorFunction):
+      def __init__(self, f):
+        super(CallableWrapper, self).__init__()
+        self.f_ = f
+      def __call__(self, *args):
+        return self.f_(*args)
+    wa.append(CallableWrapper(args[0]))
+  else:
+    wa.append(args[0])
+  if not isinstance(args[1], ReduceFunction) and callable(args[1]):
+    class CallableWrapper(ReduceFunction):
+      def __init__(self, f):
+        super(CallableWrapper, self).__init__()
+        self.f_ = f
+      def __call__(self, *args):
+        return self.f_(*args)
+    wa.append(CallableWrapper(args[1]))
+  else:
+    wa.append(args[1])
+  wa.extend(args[2:3])
+  args = tuple(wa)
+%}
 // [[[end]]]
 
 
@@ -154,6 +237,7 @@ callback_wrapper('thrill::PyDIA::Filter(FilterFunction&) const',
 %feature("pythonprepend") thrill::PyDIA::ReduceBy(KeyExtractorFunction&, ReduceFunction&) const
 CallbackHelper2(KeyExtractorFunction, key_extractor, ReduceFunction, reduce_function)
 
+%include <stdint.i>
 %include <std_string.i>
 %include <std_vector.i>
 %include <std_shared_ptr.i>
@@ -181,6 +265,9 @@ CallbackHelper2(KeyExtractorFunction, key_extractor, ReduceFunction, reduce_func
 %include <thrill/api/context.hpp>
 %include "thrill_python.hpp"
 
+%template(PyDoubleDIA) thrill::PyNumericDIA<double>;
+%template(PyInt64DIA) thrill::PyNumericDIA<int64_t>;
+
 // Local Variables:
 // mode: c++
 // mode: mmm
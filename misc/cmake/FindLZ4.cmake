@@ -0,0 +1,47 @@
+################################################################################
+#
+# - Try to find lz4 headers and libraries.
+#
+# Usage of this module as follows:
+#
+#     find_package(LZ4)
+#
+# Variables used by this module, they can change the default behaviour and need
+# to be set before calling find_package:
+#
+#  LZ4_ROOT_DIR Set this variable to the root installation of lz4 if the module
+#               has problems finding the proper installation path.
+#
+# Variables defined by this module:
+#
+#  LZ4_FOUND             System has lz4 libs/headers
+#  LZ4_LIBRARIES         The lz4 library/libraries
+#  LZ4_INCLUDE_DIRS      The location of lz4 headers
+
+find_path(LZ4_ROOT_DIR
+  NAMES include/lz4.h
+  )
+
+find_library(LZ4_LIBRARIES
+  NAMES lz4
+  HINTS ${LZ4_ROOT_DIR}/lib
+  )
+
+find_path(LZ4_INCLUDE_DIRS
+  NAMES lz4.h
+  HINTS ${LZ4_ROOT_DIR}/include
+  )
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4 DEFAULT_MSG
+  LZ4_LIBRARIES
+  LZ4_INCLUDE_DIRS
+  )
+
+mark_as_advanced(
+  LZ4_ROOT_DIR
+  LZ4_LIBRARIES
+  LZ4_INCLUDE_DIRS
+  )
+
+################################################################################
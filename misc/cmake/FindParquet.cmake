@@ -0,0 +1,58 @@
+################################################################################
+#
+# - Try to find Apache Parquet C++ (part of Apache Arrow) headers and libraries.
+#
+# Usage of this module as follows:
+#
+#     find_package(Parquet)
+#
+# Variables used by this module, they can change the default behaviour and need
+# to be set before calling find_package:
+#
+#  PARQUET_ROOT_DIR Set this variable to the root installation of Arrow and
+#                   Parquet if the module has problems finding the proper
+#                   installation path.
+#
+# Variables defined by this module:
+#
+#  PARQUET_FOUND            System has parquet and arrow libs/headers
+#  PARQUET_LIBRARIES        The parquet and arrow libraries
+#  PARQUET_INCLUDE_DIRS     The location of parquet and arrow headers
+
+find_path(PARQUET_ROOT_DIR
+  NAMES include/parquet/api/reader.h
+  )
+
+find_library(PARQUET_LIBRARY
+  NAMES parquet
+  HINTS ${PARQUET_ROOT_DIR}/lib
+  )
+
+find_library(PARQUET_ARROW_LIBRARY
+  NAMES arrow
+  HINTS ${PARQUET_ROOT_DIR}/lib
+  )
+
+find_path(PARQUET_INCLUDE_DIRS
+  NAMES parquet/api/reader.h
+  HINTS ${PARQUET_ROOT_DIR}/include
+  )
+
+if(PARQUET_LIBRARY AND PARQUET_ARROW_LIBRARY)
+  set(PARQUET_LIBRARIES ${PARQUET_LIBRARY} ${PARQUET_ARROW_LIBRARY})
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Parquet DEFAULT_MSG
+  PARQUET_LIBRARIES
+  PARQUET_INCLUDE_DIRS
+  )
+
+mark_as_advanced(
+  PARQUET_ROOT_DIR
+  PARQUET_LIBRARY
+  PARQUET_ARROW_LIBRARY
+  PARQUET_INCLUDE_DIRS
+  )
+
+################################################################################
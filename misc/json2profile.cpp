@@ -21,9 +21,11 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -142,13 +144,24 @@ public:
     double total;
     double float_;
     double base;
+    //! net allocation peaks of DIA nodes, if allocations were tagged
+    std::vector<uint32_t> dia_ids;
+    std::vector<int64_t> dia_peak;
 
     explicit CMemProfile(const rapidjson::Document& d)
         : CEvent(d),
           total(GetDouble(d, "total")),
           float_(GetDouble(d, "float")),
-          base(GetDouble(d, "base"))
-    { }
+          base(GetDouble(d, "base")) {
+        if (d.HasMember("dia_ids") && d["dia_ids"].IsArray()) {
+            const rapidjson::Value& a = d["dia_ids"];
+            for (auto it = a.Begin(); it != a.End(); ++it)
+                dia_ids.emplace_back(it->GetUint());
+            const rapidjson::Value& p = d["dia_peak"];
+            for (auto it = p.Begin(); it != p.End(); ++it)
+                dia_peak.emplace_back(it->GetInt64());
+        }
+    }
 
     bool operator < (const CMemProfile& o) const {
         return ts < o.ts;
@@ -283,6 +296,9 @@ public:
     uint64_t rx_int_bytes;
     uint64_t tx_int_bytes;
 
+    //! bytes sent over the network to each host
+    std::vector<uint64_t> tx_net_bytes_per_host;
+
     explicit CStream(const rapidjson::Document& d)
         : CEvent(d),
           event(GetString(d, "event")),
@@ -296,8 +312,15 @@ public:
           rx_int_items(GetUint64(d, "rx_int_items")),
           tx_int_items(GetUint64(d, "tx_int_items")),
           rx_int_bytes(GetUint64(d, "rx_int_bytes")),
-          tx_int_bytes(GetUint64(d, "tx_int_bytes"))
-    { }
+          tx_int_bytes(GetUint64(d, "tx_int_bytes")) {
+        // extract per host array
+        if (d.HasMember("tx_net_bytes_per_host") &&
+            d["tx_net_bytes_per_host"].IsArray()) {
+            const rapidjson::Value& a = d["tx_net_bytes_per_host"];
+            for (auto it = a.Begin(); it != a.End(); ++it)
+                tx_net_bytes_per_host.emplace_back(it->GetUint64());
+        }
+    }
 
     bool operator < (const CStream& o) const {
         return std::tie(id, host_rank, worker_rank)
@@ -493,18 +516,39 @@ public:
     std::string label;
     std::string event;
     std::vector<uint32_t> targets;
+    //! hardware performance counters of done events, if enabled
+    uint64_t perf_cycles, perf_instructions;
+    uint64_t perf_cache_misses, perf_branch_misses;
+    //! external memory I/O of the host during done events, by dia_id
+    std::vector<uint32_t> io_dia_ids;
+    std::vector<uint64_t> io_evicted_bytes, io_read_bytes;
 
     explicit CStageBuilder(const rapidjson::Document& d)
         : CEvent(d),
           worker_rank(GetUint32(d, "worker_rank")),
           id(GetUint32(d, "dia_id")),
           label(GetString(d, "label")),
-          event(GetString(d, "event")) {
+          event(GetString(d, "event")),
+          perf_cycles(GetUint64(d, "perf_cycles")),
+          perf_instructions(GetUint64(d, "perf_instructions")),
+          perf_cache_misses(GetUint64(d, "perf_cache_misses")),
+          perf_branch_misses(GetUint64(d, "perf_branch_misses")) {
         // extract targets array
         if (d["targets"].IsArray()) {
             for (auto it = d["targets"].Begin(); it != d["targets"].End(); ++it)
                 targets.emplace_back(it->GetUint());
         }
+        if (d.HasMember("io_dia_ids") && d["io_dia_ids"].IsArray()) {
+            const rapidjson::Value& a = d["io_dia_ids"];
+            for (auto it = a.Begin(); it != a.End(); ++it)
+                io_dia_ids.emplace_back(it->GetUint());
+            const rapidjson::Value& e = d["io_evicted_bytes"];
+            for (auto it = e.Begin(); it != e.End(); ++it)
+                io_evicted_bytes.emplace_back(it->GetUint64());
+            const rapidjson::Value& r = d["io_read_bytes"];
+            for (auto it = r.Begin(); it != r.End(); ++it)
+                io_read_bytes.emplace_back(it->GetUint64());
+        }
     }
 
     bool operator < (const CStageBuilder& o) const {
@@ -517,6 +561,145 @@ std::vector<CStageBuilder> c_StageBuilder;
 
 /******************************************************************************/
 
+//! A run of a stage, the Execute() or a PushData() of a DIA node, on all
+//! workers, paired from the StageBuilder start and done events.
+class CStageRun
+{
+public:
+    uint32_t id = 0;
+    std::string label;
+    //! "execute" or "pushdata"
+    std::string phase;
+    //! start and done timestamp on each worker
+    std::map<uint32_t, std::pair<uint64_t, uint64_t> > workers;
+    //! hardware performance counters summed over all workers
+    uint64_t perf_cycles = 0, perf_instructions = 0;
+    uint64_t perf_cache_misses = 0, perf_branch_misses = 0;
+
+    //! instructions per cycle, 0 if no counters were logged
+    double ipc() const {
+        return perf_cycles == 0 ? 0.0 :
+               static_cast<double>(perf_instructions) / perf_cycles;
+    }
+
+    //! first start on any worker
+    uint64_t begin() const {
+        uint64_t ts = std::numeric_limits<uint64_t>::max();
+        for (const auto& w : workers) ts = std::min(ts, w.second.first);
+        return ts;
+    }
+
+    //! last done on any worker
+    uint64_t end() const {
+        uint64_t ts = 0;
+        for (const auto& w : workers) ts = std::max(ts, w.second.second);
+        return ts;
+    }
+
+    //! wall time of the stage across all workers
+    uint64_t wall() const { return end() - begin(); }
+
+    //! time the worker spent in the stage
+    static uint64_t busy(const std::pair<uint64_t, uint64_t>& w) {
+        return w.second - w.first;
+    }
+
+    //! busy time of the given worker
+    uint64_t busy(uint32_t worker) const { return busy(workers.at(worker)); }
+
+    //! time the worker waited for the others, before starting late or after
+    //! finishing early, which is spent at the barriers around stages.
+    uint64_t wait(uint32_t worker) const { return wall() - busy(worker); }
+
+    //! the worker finishing last, which held back the stage
+    uint32_t slowest() const {
+        auto it = std::max_element(
+            workers.begin(), workers.end(),
+            [](const auto& a, const auto& b) {
+                return std::make_pair(a.second.second, busy(a.second))
+                < std::make_pair(b.second.second, busy(b.second));
+            });
+        return it->first;
+    }
+
+    //! average busy time of all workers
+    double busy_avg() const {
+        uint64_t sum = 0;
+        for (const auto& w : workers) sum += busy(w.second);
+        return static_cast<double>(sum) / workers.size();
+    }
+
+    //! maximum busy time of all workers
+    uint64_t busy_max() const {
+        uint64_t max = 0;
+        for (const auto& w : workers) max = std::max(max, busy(w.second));
+        return max;
+    }
+
+    //! maximum over average busy time, 1.0 is perfectly balanced
+    double imbalance() const {
+        double avg = busy_avg();
+        return avg == 0 ? 1.0 : busy_max() / avg;
+    }
+};
+
+std::vector<CStageRun> c_StageRun;
+
+//! pair the StageBuilder start/done events of each worker into runs. The k-th
+//! run of a DIA node's phase on each worker belongs to the same CStageRun.
+void CalcStageRuns() {
+    using WorkerKey = std::tuple<uint32_t, uint32_t, std::string>;
+    using RunKey = std::tuple<uint32_t, std::string, size_t>;
+
+    // start timestamp of open runs and number of finished runs per worker
+    std::map<WorkerKey, uint64_t> open;
+    std::map<WorkerKey, size_t> finished;
+    // index of runs in c_StageRun
+    std::map<RunKey, size_t> runs;
+
+    for (const CStageBuilder& c : c_StageBuilder) {
+        std::string::size_type dash = c.event.rfind('-');
+        if (dash == std::string::npos) continue;
+
+        std::string phase = c.event.substr(0, dash);
+        if (phase != "execute" && phase != "pushdata") continue;
+
+        WorkerKey wkey(c.worker_rank, c.id, phase);
+        if (c.event.compare(dash + 1, std::string::npos, "start") == 0) {
+            open[wkey] = c.ts;
+            continue;
+        }
+
+        auto it = open.find(wkey);
+        if (it == open.end()) continue;
+
+        RunKey rkey(c.id, phase, finished[wkey]++);
+        auto rit = runs.find(rkey);
+        if (rit == runs.end()) {
+            rit = runs.emplace(rkey, c_StageRun.size()).first;
+            c_StageRun.emplace_back();
+            c_StageRun.back().id = c.id;
+            c_StageRun.back().label = c.label;
+            c_StageRun.back().phase = phase;
+        }
+        CStageRun& run = c_StageRun[rit->second];
+        run.workers[c.worker_rank] = std::make_pair(it->second, c.ts);
+        run.perf_cycles += c.perf_cycles;
+        run.perf_instructions += c.perf_instructions;
+        run.perf_cache_misses += c.perf_cache_misses;
+        run.perf_branch_misses += c.perf_branch_misses;
+        open.erase(it);
+    }
+
+    std::sort(c_StageRun.begin(), c_StageRun.end(),
+              [](const CStageRun& a, const CStageRun& b) {
+                  return std::make_pair(a.begin(), a.id)
+                  < std::make_pair(b.begin(), b.id);
+              });
+}
+
+/******************************************************************************/
+
 size_t s_num_events = 0;
 
 void LoadJsonProfile(FILE* in) {
@@ -548,7 +731,7 @@ void LoadJsonProfile(FILE* in) {
         else if (class_str == "LinuxProcStats") {
             c_LinuxProcStats.emplace_back(d);
         }
-        else if (class_str == "Stream") {
+        else if (class_str == "Stream" || class_str == "StreamData") {
             c_Stream.emplace_back(d);
         }
         else if (class_str == "File") {
@@ -625,6 +808,8 @@ void ProcessJsonProfile() {
 
     g_min_ts = min_ts;
     g_max_ts = max_ts;
+
+    CalcStageRuns();
 }
 
 /******************************************************************************/
@@ -1259,6 +1444,105 @@ std::string PageMain() {
 
     /**************************************************************************/
 
+    if (c_StageRun.size() != 0)
+    {
+        uint64_t total_wall = 0;
+        bool perf = false;
+        for (const CStageRun& r : c_StageRun) {
+            total_wall += r.wall();
+            perf = perf || r.perf_cycles != 0;
+        }
+
+        oss << "<h2>Stage Critical Path</h2>\n";
+        oss << "<p>Stages run one after another, hence the critical path"
+            << " is the sum of their wall times: "
+            << total_wall / 1000.0 << " ms. The slowest worker finished"
+            << " last and held back all others at the stage's barrier.</p>\n";
+
+        oss << "<table border=\"1\" class=\"dataframe\">";
+        oss << "<thead><tr>";
+        oss << "<th>stage</th>";
+        oss << "<th>phase</th>";
+        oss << "<th>begin [ms]</th>";
+        oss << "<th>wall [ms]</th>";
+        oss << "<th>share [%]</th>";
+        oss << "<th>busy avg [ms]</th>";
+        oss << "<th>busy max [ms]</th>";
+        oss << "<th>wait avg [ms]</th>";
+        oss << "<th>slowest worker</th>";
+        oss << "<th>imbalance</th>";
+        if (perf) {
+            oss << "<th>IPC</th>";
+            oss << "<th>cache misses</th>";
+            oss << "<th>branch misses</th>";
+        }
+        oss << "</tr></thead>";
+        oss << "<tbody>";
+
+        for (const CStageRun& r : c_StageRun) {
+            oss << "<tr>"
+                << "<td class=\"left\">" << r.label << "." << r.id << "</td>"
+                << "<td class=\"left\">" << r.phase << "</td>"
+                << "<td>" << r.begin() / 1000.0 << "</td>"
+                << "<td>" << r.wall() / 1000.0 << "</td>"
+                << "<td>" << (total_wall ? 100.0 * r.wall() / total_wall : 0.0)
+                << "</td>"
+                << "<td>" << r.busy_avg() / 1000.0 << "</td>"
+                << "<td>" << r.busy_max() / 1000.0 << "</td>"
+                << "<td>" << r.wall() / 1000.0 - r.busy_avg() / 1000.0 << "</td>"
+                << "<td>" << r.slowest() << "</td>"
+                << "<td>" << r.imbalance() << "</td>";
+            if (perf) {
+                oss << "<td>" << r.ipc() << "</td>"
+                    << "<td>" << r.perf_cache_misses << "</td>"
+                    << "<td>" << r.perf_branch_misses << "</td>";
+            }
+            oss << "</tr>";
+        }
+
+        oss << "</tbody>";
+        oss << "</table>";
+        oss << "\n";
+    }
+
+    /**************************************************************************/
+
+    if (s_detail_tables && c_StageRun.size() != 0)
+    {
+        oss << "<h2>Stage Worker Details</h2>\n";
+
+        oss << "<table border=\"1\" class=\"dataframe\">";
+        oss << "<thead><tr>";
+        oss << "<th>stage</th>";
+        oss << "<th>phase</th>";
+        oss << "<th>worker</th>";
+        oss << "<th>start [ms]</th>";
+        oss << "<th>busy [ms]</th>";
+        oss << "<th>wait [ms]</th>";
+        oss << "</tr></thead>";
+        oss << "<tbody>";
+
+        for (const CStageRun& r : c_StageRun) {
+            for (const auto& w : r.workers) {
+                oss << "<tr>"
+                    << "<td class=\"left\">" << r.label << "." << r.id
+                    << "</td>"
+                    << "<td class=\"left\">" << r.phase << "</td>"
+                    << "<td>" << w.first << "</td>"
+                    << "<td>" << w.second.first / 1000.0 << "</td>"
+                    << "<td>" << r.busy(w.first) / 1000.0 << "</td>"
+                    << "<td>" << r.wait(w.first) / 1000.0 << "</td>"
+                    << "</tr>";
+            }
+        }
+
+        oss << "</tbody>";
+        oss << "</table>";
+        oss << "\n";
+    }
+
+    /**************************************************************************/
+
     if (c_Stream.size() != 0)
     {
         oss << "<h2>Stream Summary</h2>\n";
@@ -1290,6 +1574,143 @@ std::string PageMain() {
 
     /**************************************************************************/
 
+    if (c_Stream.size() != 0)
+    {
+        // traffic matrix [sender host][receiver host] of each DIA node
+        using Matrix = std::vector<std::vector<uint64_t> >;
+        std::map<uint32_t, Matrix> matrices;
+        size_t num_hosts = 0;
+        for (const CStream& c : c_Stream) {
+            num_hosts = std::max(num_hosts, c.host_rank + 1);
+            num_hosts = std::max(num_hosts, c.tx_net_bytes_per_host.size());
+        }
+        for (const CStream& c : c_Stream) {
+            if (c.event != "close" || c.tx_net_bytes == 0) continue;
+            if (c.tx_net_bytes_per_host.empty()) continue;
+            Matrix& m = matrices[c.dia_id];
+            if (m.empty())
+                m.resize(num_hosts, std::vector<uint64_t>(num_hosts));
+            for (size_t h = 0; h < c.tx_net_bytes_per_host.size(); ++h)
+                m[c.host_rank][h] += c.tx_net_bytes_per_host[h];
+        }
+
+        if (matrices.size() != 0)
+            oss << "<h2>Network Traffic Matrix</h2>\n";
+
+        for (const auto& dm : matrices) {
+            const Matrix& m = dm.second;
+            uint64_t total = 0, max = 0;
+            for (const auto& row : m) {
+                for (const uint64_t& v : row) {
+                    total += v;
+                    max = std::max(max, v);
+                }
+            }
+
+            oss << "<h3>" << m_DIABase[dm.first] << ": "
+                << tlx::format_iec_units(total) << "B sent over network"
+                << "</h3>\n";
+
+            oss << "<table border=\"1\" class=\"dataframe\">";
+            oss << "<thead><tr><th>sender \\ receiver</th>";
+            for (size_t h = 0; h < num_hosts; ++h)
+                oss << "<th>host " << h << "</th>";
+            oss << "</tr></thead>";
+            oss << "<tbody>";
+            for (size_t s = 0; s < num_hosts; ++s) {
+                oss << "<tr><th>host " << s << "</th>";
+                for (size_t h = 0; h < num_hosts; ++h) {
+                    // shade the cell by its share of the largest link
+                    double shade = max ? static_cast<double>(m[s][h]) / max : 0;
+                    oss << "<td style=\"background-color: rgba(255,0,0,"
+                        << shade << ")\">"
+                        << tlx::format_iec_units(m[s][h]) << "B</td>";
+                }
+                oss << "</tr>";
+            }
+            oss << "</tbody>";
+            oss << "</table>";
+            oss << "\n";
+        }
+    }
+
+    /**************************************************************************/
+
+    {
+        // maximum net allocation peak of each DIA node over all hosts
+        std::map<uint32_t, int64_t> peaks;
+        for (const CMemProfile& c : c_MemProfile) {
+            for (size_t i = 0; i < c.dia_ids.size(); ++i) {
+                if (c.dia_ids[i] == 0) continue;
+                int64_t& p = peaks[c.dia_ids[i]];
+                p = std::max(p, c.dia_peak[i]);
+            }
+        }
+
+        if (peaks.size() != 0)
+        {
+            oss << "<h2>Memory Allocation Peaks</h2>\n";
+
+            oss << "<table border=\"1\" class=\"dataframe\">";
+            oss << "<thead><tr>"
+                << "<th>DIA node</th><th>net allocation peak</th>"
+                << "</tr></thead>";
+            oss << "<tbody>";
+            for (const auto& p : peaks) {
+                oss << "<tr>"
+                    << "<td>" << m_DIABase[p.first] << "</td>"
+                    << "<td>" << tlx::format_iec_units(p.second) << "B</td>"
+                    << "</tr>";
+            }
+            oss << "</tbody>";
+            oss << "</table>";
+            oss << "\n";
+        }
+    }
+
+    /**************************************************************************/
+
+    {
+        // external memory I/O of each DIA node's Blocks, summed over hosts
+        std::map<uint32_t, std::pair<uint64_t, uint64_t> > io;
+        for (const CStageBuilder& c : c_StageBuilder) {
+            for (size_t i = 0; i < c.io_dia_ids.size(); ++i) {
+                auto& v = io[c.io_dia_ids[i]];
+                v.first += c.io_evicted_bytes[i];
+                v.second += c.io_read_bytes[i];
+            }
+        }
+
+        if (io.size() != 0)
+        {
+            oss << "<h2>External Memory I/O</h2>\n";
+
+            oss << "<table border=\"1\" class=\"dataframe\">";
+            oss << "<thead><tr>"
+                << "<th>DIA node</th><th>evicted</th><th>read back</th>"
+                << "</tr></thead>";
+            oss << "<tbody>";
+            for (const auto& v : io) {
+                oss << "<tr><td>";
+                if (v.first)
+                    oss << m_DIABase[v.first];
+                else
+                    oss << "[no DIA node]";
+                oss << "</td>"
+                    << "<td>" << tlx::format_iec_units(v.second.first)
+                    << "B</td>"
+                    << "<td>" << tlx::format_iec_units(v.second.second)
+                    << "B</td>"
+                    << "</tr>";
+            }
+            oss << "</tbody>";
+            oss << "</table>";
+            oss << "\n";
+        }
+    }
+
+    /**************************************************************************/
+
     if (s_detail_tables && c_Stream.size() != 0)
     {
         oss << "<h2>Stream Details</h2>\n";
@@ -1453,6 +1874,38 @@ std::string ResultLines() {
 
 /******************************************************************************/
 
+std::string StageLines() {
+    std::ostringstream oss;
+
+    std::string title = GetProgramName();
+
+    for (const CStageRun& r : c_StageRun) {
+        oss << "RESULT"
+            << "\ttitle=" << title
+            << "\tdia_id=" << r.id
+            << "\tlabel=" << r.label
+            << "\tphase=" << r.phase
+            << "\tworkers=" << r.workers.size()
+            << "\tbegin=" << r.begin() / 1000.0
+            << "\twall=" << r.wall() / 1000.0
+            << "\tbusy_avg=" << r.busy_avg() / 1000.0
+            << "\tbusy_max=" << r.busy_max() / 1000.0
+            << "\twait_avg=" << r.wall() / 1000.0 - r.busy_avg() / 1000.0
+            << "\tslowest_worker=" << r.slowest()
+            << "\timbalance=" << r.imbalance();
+        if (r.perf_cycles != 0) {
+            oss << "\tipc=" << r.ipc()
+                << "\tcache_misses=" << r.perf_cache_misses
+                << "\tbranch_misses=" << r.perf_branch_misses;
+        }
+        oss << "\n";
+    }
+
+    return oss.str();
+}
+
+/******************************************************************************/
+
 int main(int argc, char* argv[]) {
     tlx::CmdlineParser clp;
     clp.set_description("Thrill Json Profile Parser");
@@ -1468,6 +1921,11 @@ int main(int argc, char* argv[]) {
     clp.add_bool('r', "result", output_RESULT_lines,
                  "output data as RESULT lines");
 
+    bool output_stage_lines = false;
+    clp.add_bool('s', "stages", output_stage_lines,
+                 "output per-stage wall, busy, and wait times in ms and the "
+                 "slowest worker as RESULT lines");
+
     if (!clp.process(argc, argv)) return -1;
 
     if (inputs.size() == 0) {
@@ -1496,6 +1954,24 @@ int main(int argc, char* argv[]) {
                 LoadJsonProfile(in);
                 pclose(in);
             }
+            else if (tlx::ends_with(input, ".tlog")) {
+                // convert the binary log to json lines in a temporary file
+                std::ifstream tlog(input, std::ios::binary);
+                std::ostringstream json;
+                if (!tlog.good() || !common::JsonBinaryToText(tlog, json)) {
+                    std::cerr << "Could not convert " << input;
+                    continue;
+                }
+                FILE* in = tmpfile();
+                if (in == nullptr) {
+                    std::cerr << "Could not create temporary file";
+                    continue;
+                }
+                fwrite(json.str().data(), 1, json.str().size(), in);
+                rewind(in);
+                LoadJsonProfile(in);
+                fclose(in);
+            }
             else {
                 FILE* in = fopen(input.c_str(), "rb");
                 if (in == nullptr) {
@@ -1513,7 +1989,9 @@ int main(int argc, char* argv[]) {
     std::cerr << "Parsed " << s_num_events << " events "
               << "from " << inputs.size() << " files" << std::endl;
 
-    if (output_RESULT_lines)
+    if (output_stage_lines)
+        std::cout << StageLines();
+    else if (output_RESULT_lines)
         std::cout << ResultLines();
     else
         std::cout << PageMain();
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ * misc/json2trace.cpp
+ *
+ * Convert the trace events of Thrill json logs, written with THRILL_TRACE=1,
+ * into the Chrome trace event format for chrome://tracing and Perfetto.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/json_logger.hpp>
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/string/ends_with.hpp>
+
+#include <cereal/external/rapidjson/document.h>
+#include <cereal/external/rapidjson/stringbuffer.h>
+#include <cereal/external/rapidjson/writer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+//! one event of a timeline row
+struct TraceEvent {
+    std::string ph, cat, name;
+    uint64_t    ts, dur, id;
+    uint32_t    pid, tid;
+    //! dia_id and worker_rank, or -1 if not given
+    int64_t     dia_id, worker_rank;
+};
+
+static std::vector<TraceEvent> s_events;
+
+static inline uint64_t GetUint64(const rapidjson::Document& d, const char* key) {
+    if (!d.HasMember(key) || !d[key].IsUint64()) return 0;
+    return d[key].GetUint64();
+}
+
+static inline int64_t GetInt64(const rapidjson::Document& d, const char* key) {
+    if (!d.HasMember(key) || !d[key].IsInt64()) return -1;
+    return d[key].GetInt64();
+}
+
+static inline std::string GetString(const rapidjson::Document& d, const char* key) {
+    if (!d.HasMember(key) || !d[key].IsString()) return std::string();
+    return d[key].GetString();
+}
+
+void LoadTraceEvents(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        rapidjson::Document d;
+        d.Parse<0>(line.c_str());
+        if (d.HasParseError() || !d.IsObject() ||
+            GetString(d, "class") != "Trace") continue;
+
+        TraceEvent ev;
+        ev.ph = GetString(d, "ph");
+        ev.cat = GetString(d, "cat");
+        ev.name = GetString(d, "name");
+        ev.dur = GetUint64(d, "dur");
+        ev.id = GetUint64(d, "id");
+        // the log line is written at the end of complete events
+        ev.ts = GetUint64(d, "ts") - (ev.ph == "X" ? ev.dur : 0);
+        ev.pid = static_cast<uint32_t>(GetUint64(d, "host_rank"));
+        ev.tid = static_cast<uint32_t>(GetUint64(d, "tid"));
+        ev.dia_id = GetInt64(d, "dia_id");
+        ev.worker_rank = GetInt64(d, "worker_rank");
+
+        std::string label = GetString(d, "label");
+        if (!label.empty())
+            ev.name = label + "." + std::to_string(ev.dia_id) + " " + ev.name;
+
+        s_events.emplace_back(std::move(ev));
+    }
+}
+
+void WriteChromeTrace(std::ostream& os) {
+    uint64_t ts_begin = std::numeric_limits<uint64_t>::max();
+    for (const TraceEvent& ev : s_events)
+        ts_begin = std::min(ts_begin, ev.ts);
+
+    // name the rows by the worker whose stages ran on them
+    std::map<std::pair<uint32_t, uint32_t>, int64_t> rows;
+    for (const TraceEvent& ev : s_events) {
+        int64_t& worker = rows.emplace(
+            std::make_pair(ev.pid, ev.tid), -1).first->second;
+        if (ev.worker_rank >= 0) worker = ev.worker_rank;
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> w(buffer);
+
+    w.StartObject();
+    w.Key("displayTimeUnit");
+    w.String("ms");
+    w.Key("traceEvents");
+    w.StartArray();
+
+    for (const auto& row : rows) {
+        std::string name = row.second >= 0
+                           ? "worker " + std::to_string(row.second)
+                           : "thread " + std::to_string(row.first.second);
+        w.StartObject();
+        w.Key("ph");
+        w.String("M");
+        w.Key("name");
+        w.String("thread_name");
+        w.Key("pid");
+        w.Uint(row.first.first);
+        w.Key("tid");
+        w.Uint(row.first.second);
+        w.Key("args");
+        w.StartObject();
+        w.Key("name");
+        w.String(name.c_str());
+        w.EndObject();
+        w.EndObject();
+    }
+
+    for (const TraceEvent& ev : s_events) {
+        w.StartObject();
+        w.Key("ph");
+        w.String(ev.ph.c_str());
+        w.Key("cat");
+        w.String(ev.cat.c_str());
+        w.Key("name");
+        w.String(ev.name.c_str());
+        w.Key("ts");
+        w.Uint64(ev.ts - ts_begin);
+        if (ev.ph == "X") {
+            w.Key("dur");
+            w.Uint64(ev.dur);
+        }
+        if (ev.ph == "b" || ev.ph == "e") {
+            std::ostringstream id;
+            id << "0x" << std::hex << ev.id;
+            w.Key("id");
+            w.String(id.str().c_str());
+        }
+        if (ev.ph == "i") {
+            w.Key("s");
+            w.String("t");
+        }
+        w.Key("pid");
+        w.Uint(ev.pid);
+        w.Key("tid");
+        w.Uint(ev.tid);
+        if (ev.dia_id >= 0) {
+            w.Key("args");
+            w.StartObject();
+            w.Key("dia_id");
+            w.Int64(ev.dia_id);
+            w.EndObject();
+        }
+        w.EndObject();
+    }
+
+    w.EndArray();
+    w.EndObject();
+
+    os << buffer.GetString() << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    tlx::CmdlineParser clp;
+    clp.set_description(
+        "Convert the trace events of Thrill json logs (written with "
+        "THRILL_TRACE=1) to Chrome trace format on stdout");
+
+    std::vector<std::string> inputs;
+    clp.add_param_stringlist("inputs", inputs, "json or tlog inputs");
+
+    if (!clp.process(argc, argv)) return -1;
+
+    int result = 0;
+    for (const std::string& input : inputs) {
+        std::ifstream in(input, std::ios::binary);
+        if (!in.good()) {
+            std::cerr << "Could not open " << input << std::endl;
+            result = -1;
+            continue;
+        }
+        if (tlx::ends_with(input, ".tlog")) {
+            std::stringstream json;
+            if (!common::JsonBinaryToText(in, json)) {
+                std::cerr << "Invalid binary log " << input << std::endl;
+                result = -1;
+                continue;
+            }
+            LoadTraceEvents(json);
+        }
+        else {
+            LoadTraceEvents(in);
+        }
+    }
+
+    std::cerr << "Converted " << s_events.size() << " trace events"
+              << std::endl;
+
+    WriteChromeTrace(std::cout);
+
+    return result;
+}
+
+/******************************************************************************/
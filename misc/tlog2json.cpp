@@ -0,0 +1,47 @@
+/*******************************************************************************
+ * misc/tlog2json.cpp
+ *
+ * Convert binary logs written to THRILL_LOG=<path>.tlog into json lines.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/json_logger.hpp>
+#include <tlx/cmdline_parser.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+int main(int argc, char* argv[]) {
+    tlx::CmdlineParser clp;
+    clp.set_description("Convert Thrill binary logs to json lines on stdout");
+
+    std::vector<std::string> inputs;
+    clp.add_param_stringlist("inputs", inputs, "tlog inputs");
+
+    if (!clp.process(argc, argv)) return -1;
+
+    int result = 0;
+    for (const std::string& input : inputs) {
+        std::ifstream in(input, std::ios::binary);
+        if (!in.good()) {
+            std::cerr << "Could not open " << input << std::endl;
+            result = -1;
+            continue;
+        }
+        if (!common::JsonBinaryToText(in, std::cout)) {
+            std::cerr << "Invalid binary log " << input << std::endl;
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+/******************************************************************************/
@@ -16,11 +16,13 @@
 #include <thrill/api/size.hpp>
 #include <thrill/api/sum.hpp>
 #include <thrill/common/logger.hpp>
+#include <tlx/die.hpp>
 
 #include <gtest/gtest.h>
 
 #include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <limits>
 #include <string>
 #include <vector>
@@ -125,6 +127,157 @@ TEST(GroupByNode, Median) {
     api::RunLocalTests(start_func);
 }
 
+TEST(GroupByNode, BatchedIteratorRuns) {
+
+    auto start_func =
+        [](Context& ctx) {
+            // many items per group, such that groups span lookahead buffers.
+            static constexpr size_t n = 100000;
+            static constexpr size_t m = 7;
+
+            auto modulo_keyfn = [](size_t in) { return (in % m); };
+
+            auto run_sum_fn =
+                [](auto& r, size_t key) {
+                    size_t res = 0, size;
+                    while (const size_t* run = r.NextRun(size)) {
+                        for (size_t i = 0; i < size; ++i) {
+                            die_unequal(key, run[i] % m);
+                            res += run[i];
+                        }
+                    }
+                    return res;
+                };
+
+            auto batch_sum_fn =
+                [](auto& r, size_t key) {
+                    size_t res = 0, size;
+                    std::vector<size_t> batch(13);
+                    while ((size = r.NextBatch(batch.data(), batch.size()))
+                           != 0) {
+                        for (size_t i = 0; i < size; ++i) {
+                            die_unequal(key, batch[i] % m);
+                            res += batch[i];
+                        }
+                    }
+                    return res;
+                };
+
+            std::vector<size_t> res_vec(m, 0);
+            for (size_t t = 0; t < n; ++t)
+                res_vec[t % m] += t;
+            std::sort(res_vec.begin(), res_vec.end());
+
+            std::vector<size_t> out_runs =
+                Generate(ctx, n)
+                .GroupByKey<size_t>(modulo_keyfn, run_sum_fn).AllGather();
+            std::vector<size_t> out_batches =
+                Generate(ctx, n)
+                .GroupByKey<size_t>(modulo_keyfn, batch_sum_fn).AllGather();
+
+            std::sort(out_runs.begin(), out_runs.end());
+            std::sort(out_batches.begin(), out_batches.end());
+            ASSERT_EQ(res_vec, out_runs);
+            ASSERT_EQ(res_vec, out_batches);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(GroupByNode, HashGroupingSum) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 99999;
+            static constexpr size_t m = 1013;
+
+            auto sizets = Generate(ctx, n);
+
+            auto modulo_keyfn = [](size_t in) { return (in % m); };
+
+            // return key in upper and sum of group in lower bits
+            auto sum_fn =
+                [](auto& r, size_t key) {
+                    size_t res = 0;
+                    while (r.HasNext()) {
+                        res += r.Next();
+                    }
+                    return (key << 32) + res;
+                };
+
+            // group by hashing and gather results
+            auto reduced = sizets.GroupByKey<size_t>(
+                HashGroupingTag, modulo_keyfn, sum_fn);
+            std::vector<size_t> out_vec = reduced.AllGather();
+
+            // compute vector with expected results
+            std::vector<size_t> res_vec(m, 0);
+            for (size_t t = 0; t < n; ++t) {
+                res_vec[t % m] += t;
+            }
+            for (size_t k = 0; k < m; ++k) {
+                res_vec[k] += k << 32;
+            }
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(res_vec, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(GroupByNode, CombineTopTwo) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 99999;
+            static constexpr size_t m = 101;
+
+            auto sizets = Generate(ctx, n);
+
+            auto modulo_keyfn = [](size_t in) { return (in % m); };
+
+            // keep only the two largest items of a key on the sending side
+            auto top_two_combine =
+                [](std::vector<size_t>& items, size_t /* key */) {
+                    std::sort(items.begin(), items.end(),
+                              std::greater<size_t>());
+                    if (items.size() > 2) items.resize(2);
+                };
+
+            auto top_two_sum_fn =
+                [](auto& r, size_t /* key */) {
+                    std::vector<size_t> all;
+                    while (r.HasNext()) {
+                        all.push_back(r.Next());
+                    }
+                    std::sort(all.begin(), all.end(), std::greater<size_t>());
+                    return all[0] + all[1];
+                };
+
+            auto reduced = sizets.GroupByKey<size_t>(
+                GroupCombineTag, modulo_keyfn, top_two_sum_fn,
+                top_two_combine);
+            std::vector<size_t> out_vec = reduced.AllGather();
+
+            // compute vector with expected results: the two largest items of
+            // each key are the last two occurrences.
+            std::vector<size_t> res_vec;
+            for (size_t k = 0; k < m; ++k) {
+                size_t last = (n - 1) - ((n - 1 - k) % m);
+                res_vec.push_back(last + (last - m));
+            }
+
+            std::sort(out_vec.begin(), out_vec.end());
+            std::sort(res_vec.begin(), res_vec.end());
+
+            ASSERT_EQ(res_vec, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(GroupByNode, GroupToIndexCorrectResults) {
 
     auto start_func =
@@ -167,6 +320,49 @@ TEST(GroupByNode, GroupToIndexCorrectResults) {
     api::RunLocalTests(start_func);
 }
 
+TEST(GroupByNode, GroupToIndexSparseKeys) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 9999;
+            // many more indexes than items, such that several keys share the
+            // buckets of the counting pass
+            static constexpr size_t m = 1000003;
+
+            auto integers = Generate(ctx, n);
+
+            auto key = [](size_t in) {
+                           return in * 7919 % m;
+                       };
+
+            auto add_function =
+                [](auto& r, size_t /* key */) {
+                    size_t res = 42;
+                    while (r.HasNext()) {
+                        res += r.Next();
+                    }
+                    return res;
+                };
+
+            auto reduced = integers.GroupToIndex<size_t>(key, add_function, m);
+
+            std::vector<size_t> out_vec = reduced.AllGather();
+            ASSERT_EQ(m, out_vec.size());
+
+            // compute vector with expected results, zero for empty indexes
+            std::vector<size_t> res_vec(m, 0);
+            for (size_t t = 0; t < n; ++t) {
+                res_vec[t * 7919 % m] = 42 + t;
+            }
+
+            for (size_t i = 0; i < res_vec.size(); ++i) {
+                ASSERT_EQ(res_vec[i], out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(GroupByNode, GroupToIndexCorrectSize) {
 
     auto start_func =
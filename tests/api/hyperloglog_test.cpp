@@ -9,6 +9,7 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <thrill/api/all_gather.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/hyperloglog.hpp>
 #include <tlx/math/clz.hpp>
@@ -134,6 +135,55 @@ TEST(Operations, HyperLogLog) {
     thrill::Run([&](thrill::Context& ctx) { start_func(ctx); });
 }
 
+TEST(Operations, HyperLogLogByKey) {
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 30000;
+
+            auto items = Generate(ctx, n);
+
+            // key 0: 10000 distinct values, key 1: 1000, key 2: a single one.
+            auto sketches = items.HyperLogLogByKey<12>(
+                [](const size_t& i) { return i % 3; },
+                [](const size_t& i) -> size_t {
+                    return i % 3 == 0 ? i : i % 3 == 1 ? i / 30 : 5;
+                });
+
+            std::vector<std::pair<size_t, core::HyperLogLogRegisters<12> > >
+            result = sketches.AllGather();
+
+            ASSERT_EQ(3u, result.size());
+            std::sort(result.begin(), result.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.first < b.first;
+                      });
+
+            const double counts[3] = { 10000, 1000, 1 };
+            for (size_t k = 0; k < 3; ++k) {
+                ASSERT_EQ(k, result[k].first);
+                double estimate = result[k].second.result();
+                ASSERT_LE(std::abs(relativeError(counts[k], estimate)), 0.05);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Operations, HyperLogLogMergeEqualsInsert) {
+    for (size_t n : { 100, 5000, 100000 }) {
+        core::HyperLogLogRegisters<14> a, b, c;
+        for (size_t i = 0; i < n; ++i) {
+            // a and b overlap in the middle third
+            if (i < 2 * n / 3) a.insert(i);
+            if (i >= n / 3) b.insert(i);
+            c.insert(i);
+        }
+        core::HyperLogLogRegisters<14> ab = a + b;
+        // c may have switched to the dense format at a different time
+        ASSERT_LE(std::abs(relativeError(c.result(), ab.result())), 0.02);
+    }
+}
+
 TEST(Operations, encodeHash) {
     // decidingBits = 0 => 1 as last Bit, vale (aka number of leading zeroes) should be 5
     uint64_t random = 0b0000100000000000000000000000100000000000000000000000000000000000;
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * tests/api/job_server_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/generate.hpp>
+#include <thrill/api/job_server.hpp>
+#include <thrill/api/sum.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+TEST(JobServer, ParseJobRequest) {
+    api::JobRequest request;
+
+    ASSERT_TRUE(api::ParseJobRequest("./libjobs.so count a  b", &request));
+    ASSERT_EQ("./libjobs.so", request.library);
+    ASSERT_EQ("count", request.function);
+    ASSERT_EQ(std::vector<std::string>({ "a", "b" }), request.args);
+    ASSERT_EQ(0u, request.mem_limit);
+
+    ASSERT_TRUE(api::ParseJobRequest(" mem=16Mi - sum ", &request));
+    ASSERT_EQ("-", request.library);
+    ASSERT_EQ("sum", request.function);
+    ASSERT_TRUE(request.args.empty());
+    ASSERT_EQ(16u * 1024 * 1024, request.mem_limit);
+
+    ASSERT_FALSE(api::ParseJobRequest("", &request));
+    ASSERT_FALSE(api::ParseJobRequest("libjobs.so", &request));
+    ASSERT_FALSE(api::ParseJobRequest("mem=lots - sum", &request));
+}
+
+TEST(JobServer, ServeRegisteredJobs) {
+
+    std::atomic<size_t> sum_runs { 0 }, mem_runs { 0 };
+
+    api::RegisterJobFunction(
+        "sum", [&sum_runs](Context& ctx, const std::vector<std::string>& args) {
+            ASSERT_EQ(1u, args.size());
+            size_t n = std::stoul(args[0]);
+            size_t sum = Generate(ctx, n).Sum();
+            ASSERT_EQ(n * (n - 1) / 2, sum);
+            ++sum_runs;
+        });
+
+    api::RegisterJobFunction(
+        "mem", [&mem_runs](Context& ctx, const std::vector<std::string>&) {
+            ASSERT_EQ(16u * 1024 * 1024, ctx.mem_limit());
+            ++mem_runs;
+        });
+
+    size_t num_workers = 0;
+
+    auto start_func =
+        [&num_workers](Context& ctx) {
+            std::vector<std::string> lines = {
+                "- sum 1000", "", "mem=16Mi - mem", "- missing", "garbage",
+                "- sum 10", "quit", "- sum 5"
+            };
+            size_t next = 0;
+
+            size_t jobs = ServeJobs(
+                ctx, [lines, next](std::string* line) mutable {
+                    if (next == lines.size()) return false;
+                    *line = lines[next++];
+                    return true;
+                },
+                std::chrono::milliseconds(1));
+
+            ASSERT_EQ(3u, jobs);
+            if (ctx.my_rank() == 0) num_workers += ctx.num_workers();
+        };
+
+    api::RunLocalTests(start_func);
+
+    ASSERT_EQ(2 * num_workers, sum_runs);
+    ASSERT_EQ(num_workers, mem_runs);
+}
+
+/******************************************************************************/
@@ -9,8 +9,12 @@
  ******************************************************************************/
 
 #include <thrill/api/all_gather.hpp>
+#include <thrill/api/cache.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/inner_join.hpp>
+#include <thrill/api/multiway_join.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sort.hpp>
 #include <thrill/api/sum.hpp>
 #include <thrill/common/logger.hpp>
 
@@ -168,6 +172,318 @@ TEST(Join, PairsSameKeyDiffSizes) {
     api::RunLocalTests(start_func);
 }
 
+//! Join n1 pairs (i, i * i) with n2 pairs (i, i * i * i), check the result and
+//! the build side of the local hash join (0 for the merge join).
+static void JoinPairsWithBuildSide(
+    Context& ctx, size_t n1, size_t n2, size_t build_side) {
+
+    using IntPair = std::pair<size_t, size_t>;
+    using IntTuple = std::tuple<size_t, size_t, size_t>;
+
+    auto dia1 = Generate(ctx, n1, [](const size_t& e) {
+                             return std::make_pair(e, e * e);
+                         });
+
+    auto dia2 = Generate(ctx, n2, [](const size_t& e) {
+                             return std::make_pair(e, e * e * e);
+                         });
+
+    auto key_ex = [](const IntPair& input) {
+                      return input.first;
+                  };
+
+    auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                       return std::make_tuple(
+                           input1.first, input1.second, input2.second);
+                   };
+
+    auto joined = InnerJoin(dia1, dia2, key_ex, key_ex, join_fn);
+    std::vector<IntTuple> out_vec = joined.AllGather();
+
+    const size_t* hash_build_side = api::GetJoinHashBuildSide(joined);
+    ASSERT_NE(nullptr, hash_build_side);
+    ASSERT_EQ(build_side, *hash_build_side);
+
+    std::sort(out_vec.begin(), out_vec.end(),
+              [](const IntTuple& in1, const IntTuple& in2) {
+                  return std::get<0>(in1) < std::get<0>(in2);
+              });
+
+    ASSERT_EQ(std::min(n1, n2), out_vec.size());
+    for (size_t i = 0; i < out_vec.size(); i++) {
+        ASSERT_EQ(std::make_tuple(i, i * i, i * i * i), out_vec[i]);
+    }
+}
+
+TEST(Join, HashBuildFirstSide) {
+
+    auto start_func =
+        [](Context& ctx) {
+            // the keys of the first DIA are a subset of those of the second,
+            // hence it is smaller on every worker.
+            JoinPairsWithBuildSide(ctx, 999, 9999, 1);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, HashBuildSecondSide) {
+
+    auto start_func =
+        [](Context& ctx) {
+            JoinPairsWithBuildSide(ctx, 9999, 999, 2);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, MergeJoinFallback) {
+
+    auto start_func =
+        [](Context& ctx) {
+            // each worker receives 500000 items of both DIAs, whose hash table
+            // indexes exceed half of the worker's 21 MiB.
+            JoinPairsWithBuildSide(ctx, 1000000, 1000000, 0);
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+
+    api::RunLocalMock(mem_config, 2, 1, start_func);
+}
+
+TEST(Join, HeavyKeyParallelProduct) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+
+            // a single key whose cartesian product is joined in parallel
+            size_t n = 1500;
+            size_t m = 1600;
+
+            auto dia1 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(1, e);
+                                 });
+
+            auto dia2 = Generate(ctx, m, [](const size_t& e) {
+                                     return std::make_pair(1, e);
+                                 });
+
+            auto key_ex = [](const IntPair& input) {
+                              return input.first;
+                          };
+
+            auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                               return std::make_pair(input1.second,
+                                                     input2.second);
+                           };
+
+            auto joined =
+                InnerJoin(dia1, dia2, key_ex, key_ex, join_fn).Cache();
+
+            ASSERT_EQ(n * m, joined.Keep().Size());
+
+            size_t sum = joined.Map([](const IntPair& p) {
+                                        return p.first + p.second;
+                                    }).Sum();
+            ASSERT_EQ(m * n * (n - 1) / 2 + n * m * (m - 1) / 2, sum);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, BroadcastPairs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+            using IntTuple = std::tuple<size_t, size_t, size_t>;
+
+            size_t n = 9999;
+            size_t m = 100;
+
+            auto dia1 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(e, e * e);
+                                 });
+
+            // small side with two items per key
+            auto dia2 = Generate(ctx, 2 * m, [m](const size_t& e) {
+                                     return std::make_pair(e % m, e);
+                                 });
+
+            auto key_ex = [](const IntPair& input) {
+                              return input.first;
+                          };
+
+            auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                               return std::make_tuple(input1.first,
+                                                      input1.second,
+                                                      input2.second);
+                           };
+
+            auto joined = InnerJoin(
+                BroadcastJoinTag, dia1, dia2, key_ex, key_ex, join_fn);
+            std::vector<IntTuple> out_vec = joined.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(2 * m, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); i++) {
+                size_t k = i / 2;
+                ASSERT_EQ(std::make_tuple(k, k * k, k + (i % 2) * m),
+                          out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, SemiJoinFilterPairs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+            using IntTuple = std::tuple<size_t, size_t, size_t>;
+
+            size_t n = 9999;
+            size_t m = 100;
+
+            auto dia1 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(e, e * e);
+                                 });
+
+            // small side whose keys only match every seventh key of dia1
+            auto dia2 = Generate(ctx, m, [](const size_t& e) {
+                                     return std::make_pair(7 * e, e);
+                                 });
+
+            auto key_ex = [](const IntPair& input) {
+                              return input.first;
+                          };
+
+            auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                               return std::make_tuple(input1.first,
+                                                      input1.second,
+                                                      input2.second);
+                           };
+
+            auto joined = InnerJoin(
+                SemiJoinFilterTag, dia1, dia2, key_ex, key_ex, join_fn);
+            std::vector<IntTuple> out_vec = joined.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(m, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); i++) {
+                ASSERT_EQ(std::make_tuple(7 * i, 49 * i * i, i), out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, SkewedKeys) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+
+            size_t n = 9999;
+            size_t m = 30;
+
+            // half of the items of dia1 have the hot key 0
+            auto dia1 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(e % 2 ? e : 0, e);
+                                 });
+
+            auto dia2 = Generate(ctx, m, [](const size_t& e) {
+                                     return std::make_pair(e, e);
+                                 });
+
+            auto key_ex = [](const IntPair& input) {
+                              return input.first;
+                          };
+
+            auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                               return std::make_pair(input1.second,
+                                                     input2.second);
+                           };
+
+            auto joined = InnerJoin(
+                SkewJoinTag, dia1, dia2, key_ex, key_ex, join_fn);
+            std::vector<IntPair> out_vec = joined.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            // compute expected results
+            std::vector<IntPair> res_vec;
+            for (size_t e = 0; e < n; ++e) {
+                size_t key = e % 2 ? e : 0;
+                if (key < m) res_vec.emplace_back(e, key);
+            }
+
+            ASSERT_EQ(res_vec, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Join, SortedInputs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+
+            size_t n = 9999;
+
+            auto key_ex = [](const IntPair& input) {
+                              return input.first;
+                          };
+
+            auto compare_fn = [](const IntPair& a, const IntPair& b) {
+                                  return a.first < b.first;
+                              };
+
+            // keys 0, 0, 1, 1, ... in scrambled order, then sorted
+            auto dia1 = Generate(ctx, n, [n](const size_t& e) {
+                                     size_t x = (e * 7919) % n;
+                                     return std::make_pair(x / 2, x);
+                                 }).Sort(compare_fn);
+
+            auto dia2 = Generate(ctx, n / 3, [](const size_t& e) {
+                                     return std::make_pair(3 * e, e);
+                                 }).Sort(compare_fn);
+
+            auto join_fn = [](const IntPair& input1, const IntPair& input2) {
+                               return std::make_pair(input1.second,
+                                                     input2.second);
+                           };
+
+            auto joined = InnerJoin(
+                SortedJoinTag, dia1, dia2, key_ex, key_ex, join_fn);
+            std::vector<IntPair> out_vec = joined.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            // compute expected results
+            std::vector<IntPair> res_vec;
+            for (size_t x = 0; x < n; ++x) {
+                if ((x / 2) % 3 == 0 && x / 2 / 3 < n / 3)
+                    res_vec.emplace_back(x, x / 2 / 3);
+            }
+
+            ASSERT_EQ(res_vec, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Join, DifferentTypes) {
 
     auto start_func =
@@ -220,4 +536,66 @@ TEST(Join, DifferentTypes) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Join, MultiwayJoinOfThree) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using IntPair = std::pair<size_t, size_t>;
+            using IntTuple = std::tuple<size_t, size_t, size_t>;
+
+            size_t n = 3000;
+
+            // keys of dia1 are unique, dia2 has two items for each even key,
+            // and dia3 three items for each key divisible by three.
+            auto dia1 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(e, e * e);
+                                 });
+
+            auto dia2 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_pair(e / 2 * 2, e % 2);
+                                 });
+
+            auto dia3 = Generate(ctx, n, [](const size_t& e) {
+                                     return std::make_tuple(
+                                         e / 3 * 3, e % 3, e);
+                                 });
+
+            auto key_ex = [](IntPair input) {
+                              return input.first;
+                          };
+
+            auto key_ex3 = [](IntTuple input) {
+                               return std::get<0>(input);
+                           };
+
+            auto join_fn = [](IntPair input1, IntPair input2, IntTuple input3) {
+                               return std::make_tuple(input1.second,
+                                                      input2.second,
+                                                      std::get<2>(input3));
+                           };
+
+            auto joined = InnerJoin(std::make_tuple(dia1, dia2, dia3),
+                                    std::make_tuple(key_ex, key_ex, key_ex3),
+                                    join_fn);
+            std::vector<IntTuple> out_vec = joined.AllGather();
+            std::sort(out_vec.begin(), out_vec.end());
+
+            std::vector<IntTuple> check;
+            for (size_t k = 0; k < n; ++k) {
+                if (k % 6 != 0) continue;
+                for (size_t j = 0; j < 2; ++j) {
+                    for (size_t e = k; e < k + 3; ++e) {
+                        check.emplace_back(k * k, j, e);
+                    }
+                }
+            }
+            std::sort(check.begin(), check.end());
+
+            ASSERT_EQ(check, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
@@ -179,4 +179,43 @@ TEST(MergeNode, TwoIntegerArraysOfDifferentSize) {
     api::RunLocalTests(start_func);
 }
 
+TEST(MergeNode, ExactBalanceWithManyEqualItems) {
+
+    static constexpr size_t test_size = 4999;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // long runs of equal numbers, which must be split between workers
+            auto merge_input1 = Generate(
+                ctx, test_size,
+                [](size_t index) { return index / 100; });
+
+            auto merge_input2 = Generate(
+                ctx, test_size * 2 + 3,
+                [](size_t index) { return index / 300; });
+
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < test_size; i++)
+                expected.push_back(i / 100);
+            for (size_t i = 0; i < test_size * 2 + 3; i++)
+                expected.push_back(i / 300);
+            std::sort(expected.begin(), expected.end());
+
+            size_t count = 0;
+            auto res = Merge(std::less<size_t>(), merge_input1, merge_input2)
+                       .Map([&count](size_t in) { count++; return in; })
+                       .AllGather();
+
+            ASSERT_EQ(expected, res);
+
+            // every worker receives exactly n/p items, +1 for the first ones.
+            size_t p = ctx.num_workers();
+            ASSERT_EQ(res.size() / p + (ctx.my_rank() < res.size() % p),
+                      count);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * tests/api/metrics_server_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/metrics_server.hpp>
+#include <thrill/common/config.hpp>
+
+#include <gtest/gtest.h>
+
+#if THRILL_HAVE_NET_TCP
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <string>
+
+using namespace thrill;
+
+#if THRILL_HAVE_NET_TCP
+
+//! send an HTTP request to localhost:port and return the whole response
+static std::string HttpRequest(uint16_t port, const std::string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return std::string();
+
+    struct sockaddr_in sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sa.sin_port = htons(port);
+
+    std::string response;
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&sa),
+                  sizeof(sa)) == 0 &&
+        ::send(fd, request.data(), request.size(), 0) ==
+        static_cast<ssize_t>(request.size())) {
+        char buffer[1024];
+        ssize_t rb;
+        while ((rb = ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+            response.append(buffer, rb);
+    }
+    ::close(fd);
+    return response;
+}
+
+TEST(MetricsServer, ScrapeMetrics) {
+    api::MetricsServer server(0);
+    ASSERT_NE(0u, server.port());
+
+    size_t scrapes = 0;
+    server.Add(
+        [&scrapes](common::MetricsWriter& mw) {
+            mw.Counter("test_scrapes_total", "Number of scrapes.", ++scrapes);
+            mw.Family("test_value", "gauge", "Labeled test values.");
+            mw.Sample(42, "worker=\"0\"");
+            mw.Sample(7, "worker=\"1\"");
+        });
+
+    std::string response = HttpRequest(
+        server.port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    ASSERT_EQ(0u, response.find("HTTP/1.0 200 OK\r\n"));
+    ASSERT_NE(std::string::npos, response.find(
+                  "# TYPE thrill_test_scrapes_total counter\n"
+                  "thrill_test_scrapes_total 1\n"));
+    ASSERT_NE(std::string::npos, response.find(
+                  "# TYPE thrill_test_value gauge\n"
+                  "thrill_test_value{worker=\"0\"} 42\n"
+                  "thrill_test_value{worker=\"1\"} 7\n"));
+
+    // other paths are not served and do not run the collectors
+    response = HttpRequest(server.port(), "GET / HTTP/1.0\r\n\r\n");
+    ASSERT_EQ(0u, response.find("HTTP/1.0 404 Not Found\r\n"));
+    ASSERT_EQ(1u, scrapes);
+}
+
+#endif
+
+/******************************************************************************/
@@ -20,27 +20,37 @@
 #include <thrill/api/ex_prefix_sum.hpp>
 #include <thrill/api/gather.hpp>
 #include <thrill/api/generate.hpp>
+#include <thrill/api/iterate.hpp>
 #include <thrill/api/max.hpp>
 #include <thrill/api/min.hpp>
 #include <thrill/api/prefix_sum.hpp>
 #include <thrill/api/print.hpp>
 #include <thrill/api/read_lines.hpp>
 #include <thrill/api/rebalance.hpp>
+#include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/sample.hpp>
+#include <thrill/api/sample_by_key.hpp>
 #include <thrill/api/size.hpp>
 #include <thrill/api/sort.hpp>
 #include <thrill/api/sum.hpp>
+#include <thrill/api/top_k.hpp>
 #include <thrill/api/union.hpp>
+#include <thrill/api/weighted_sample.hpp>
 #include <thrill/api/window.hpp>
+#include <thrill/api/zip.hpp>
+#include <thrill/api/zip_with_index.hpp>
 
 #include <tlx/string/join_generic.hpp>
 
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace thrill; // NOLINT
@@ -169,6 +179,49 @@ TEST(Operations, DistributeAndAllGatherElements) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, TreeDistributeKeepsOrder) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            static constexpr size_t test_size = 1000;
+
+            for (size_t source = 0; source < ctx.num_workers(); ++source) {
+                std::vector<size_t> in_vector;
+                if (ctx.my_rank() == source) {
+                    for (size_t i = 0; i < test_size; ++i)
+                        in_vector.push_back(i);
+                }
+
+                DIA<size_t> integers = Distribute(ctx, in_vector, source);
+
+                // each worker gets its equal share of the vector in order
+                std::vector<size_t> local;
+                integers.Keep().Map([&local](const size_t& i) {
+                                        local.push_back(i);
+                                        return i;
+                                    }).Size();
+                common::Range range = common::CalculateLocalRange(
+                    test_size, ctx.num_workers(), ctx.my_rank());
+                ASSERT_EQ(range.size(), local.size());
+                for (size_t i = 0; i < local.size(); ++i)
+                    ASSERT_EQ(range.begin + i, local[i]);
+
+                std::vector<size_t> out_vec = integers.AllGather();
+                ASSERT_EQ(test_size, out_vec.size());
+                for (size_t i = 0; i < out_vec.size(); ++i)
+                    ASSERT_EQ(i, out_vec[i]);
+            }
+        };
+
+    // use the binomial tree for all sizes
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.gather_tree_bytes_ = 0;
+
+    api::RunLocalMock(mem_config, 3, 2, start_func);
+}
+
 TEST(Operations, EqualToDIAAndGatherElements) {
 
     auto start_func =
@@ -207,6 +260,42 @@ TEST(Operations, EqualToDIAAndGatherElements) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, TreeGatherAndRingAllGatherKeepOrder) {
+
+    auto start_func =
+        [](Context& ctx) {
+            static constexpr size_t test_size = 1000;
+
+            DIA<size_t> integers = Generate(ctx, test_size).Cache();
+
+            for (size_t target = 0; target < ctx.num_workers(); ++target) {
+                std::vector<size_t> out_vec = integers.Keep().Gather(target);
+
+                if (ctx.my_rank() == target) {
+                    ASSERT_EQ(test_size, out_vec.size());
+                    for (size_t i = 0; i < out_vec.size(); ++i)
+                        ASSERT_EQ(i, out_vec[i]);
+                }
+                else {
+                    ASSERT_EQ(0u, out_vec.size());
+                }
+            }
+
+            std::vector<size_t> out_vec = integers.AllGather();
+            ASSERT_EQ(test_size, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); ++i)
+                ASSERT_EQ(i, out_vec[i]);
+        };
+
+    // use the tree and ring algorithms for all sizes, on a number of workers
+    // which is not a power of two.
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.gather_tree_bytes_ = 0;
+
+    api::RunLocalMock(mem_config, 3, 2, start_func);
+}
+
 TEST(Operations, GenerateIntegers) {
 
     static constexpr size_t test_size = 1000;
@@ -253,6 +342,45 @@ TEST(Operations, GenerateAndConcatTwo) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, GenerateAndConcatUnordered) {
+
+    static constexpr size_t test_size = 1024;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto dia1 = Generate(ctx, test_size).Cache();
+            auto dia2 = Generate(ctx, 2 * test_size);
+
+            auto cdia = dia1.Concat(dia2).Keep();
+
+            // the ReduceByKey ignores the order, hence Concat skips the
+            // exchange
+            std::vector<std::pair<size_t, size_t> > counts =
+                cdia.Map([](size_t i) { return std::make_pair(i % 10, i); })
+                .ReducePair(std::plus<size_t>())
+                .Sort().AllGather();
+
+            ASSERT_EQ(10u, counts.size());
+            for (size_t k = 0; k < counts.size(); ++k) {
+                size_t sum = 0;
+                for (size_t i = k; i < test_size; i += 10) sum += i;
+                for (size_t i = k; i < 2 * test_size; i += 10) sum += i;
+                ASSERT_EQ(std::make_pair(k, sum), counts[k]);
+            }
+
+            // the later AllGather depends on the order, and gets it
+            std::vector<size_t> out_vec = cdia.AllGather();
+
+            ASSERT_EQ(3 * test_size, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); ++i) {
+                ASSERT_EQ(i < test_size ? i : i - test_size, out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Operations, GenerateAndConcatThree) {
 
     static constexpr size_t test_size = 1024;
@@ -401,6 +529,111 @@ TEST(Operations, GenerateFilterRebalance) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, GenerateRebalanceHostWeights) {
+
+    static constexpr size_t test_size = 4000;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // host 0 of weight 3 gets 1500 items per worker, host 1 500.
+            size_t expected = ctx.host_rank() == 0 ? 1500 : 500;
+
+            size_t generated = 0;
+            auto dia = Generate(ctx, test_size,
+                                [&generated](size_t index) {
+                                    ++generated;
+                                    return index;
+                                }).Cache().Execute();
+            ASSERT_EQ(expected, generated);
+
+            // unbalance the items, and let Rebalance restore the weights
+            size_t rebalanced = 0;
+            auto rdia = dia.Filter([](size_t index) { return index % 3 != 0; })
+                        .Rebalance()
+                        .Map([&rebalanced](size_t index) {
+                                 ++rebalanced;
+                                 return index;
+                             });
+
+            std::vector<size_t> out_vec = rdia.AllGather();
+
+            size_t filtered = test_size - (test_size + 2) / 3;
+            ASSERT_EQ(filtered, out_vec.size());
+            ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+
+            size_t begin = ctx.CalculatePartBegin(filtered, ctx.my_rank());
+            size_t end = ctx.CalculatePartBegin(filtered, ctx.my_rank() + 1);
+            ASSERT_EQ(end - begin, rebalanced);
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.host_weights_ = { 3, 1 };
+
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+}
+
+TEST(Operations, KnownSizesSkipCollectives) {
+
+    static constexpr size_t test_size = 4000;
+
+    using IntPair = std::pair<size_t, size_t>;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto dia = Generate(ctx, test_size).Cache().Execute();
+            ASSERT_TRUE(dia.node()->known_size().known_balanced());
+            ASSERT_EQ(test_size, dia.node()->known_size().total);
+            ASSERT_EQ(test_size, dia.Size());
+
+            // already balanced items stay in place, and keep their ranks
+            auto rdia = dia.Rebalance().Execute();
+            ASSERT_TRUE(rdia.node()->known_size().known_balanced());
+
+            std::vector<IntPair> ranks =
+                rdia.ZipWithIndex([](size_t v, size_t i) {
+                                      return std::make_pair(v, i);
+                                  }).AllGather();
+            ASSERT_EQ(test_size, ranks.size());
+            for (size_t i = 0; i < ranks.size(); ++i)
+                ASSERT_EQ(IntPair(i, i), ranks[i]);
+
+            // the size of filtered items is unknown until Rebalance
+            auto fdia = dia.Filter([](size_t index) { return index % 3 != 0; })
+                        .Rebalance().Execute();
+            size_t filtered = test_size - (test_size + 2) / 3;
+            ASSERT_TRUE(fdia.node()->known_size().known_balanced());
+            ASSERT_EQ(filtered, fdia.node()->known_size().total);
+            ASSERT_EQ(filtered, fdia.Size());
+
+            auto zip_fn = [](size_t a, size_t b) {
+                              return std::make_pair(a, b);
+                          };
+
+            // same known sizes are zipped in place, others are exchanged
+            std::vector<IntPair> zipped = Zip(zip_fn, dia, rdia).AllGather();
+            ASSERT_EQ(test_size, zipped.size());
+            for (size_t i = 0; i < zipped.size(); ++i)
+                ASSERT_EQ(IntPair(i, i), zipped[i]);
+
+            std::vector<IntPair> cut =
+                Zip(CutTag, zip_fn, dia, fdia).AllGather();
+            ASSERT_EQ(filtered, cut.size());
+            for (size_t i = 0; i < cut.size(); ++i)
+                ASSERT_EQ(IntPair(i, i + i / 2 + 1), cut[i]);
+        };
+
+    api::RunLocalTests(start_func);
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.host_weights_ = { 3, 1 };
+
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+}
+
 TEST(Operations, MapResultsCorrectChangingType) {
 
     auto start_func =
@@ -599,6 +832,39 @@ TEST(Operations, GenerateAndSumHaveEqualAmount2) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, TopKCorrectResults) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // a permutation of 0..9999 with duplicates of each value
+            auto integers = Generate(
+                ctx, 20000,
+                [](const size_t& index) {
+                    return (index * 7919) % 10000;
+                }).Cache();
+
+            std::vector<size_t> smallest = integers.TopK(10);
+            ASSERT_EQ(10u, smallest.size());
+            for (size_t i = 0; i < smallest.size(); ++i) {
+                ASSERT_EQ(i / 2, smallest[i]);
+            }
+
+            std::vector<size_t> largest = integers.TopK(
+                5, [](const size_t& a, const size_t& b) { return a > b; });
+            ASSERT_EQ(5u, largest.size());
+            for (size_t i = 0; i < largest.size(); ++i) {
+                ASSERT_EQ(9999u - i / 2, largest[i]);
+            }
+
+            // more than contained
+            ASSERT_EQ(20000u, integers.TopK(30000).size());
+            ASSERT_EQ(0u, integers.TopK(0).size());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Operations, WindowCorrectResults) {
 
     static constexpr bool debug = false;
@@ -722,6 +988,50 @@ TEST(Operations, WindowCorrectResultsPartialWindows) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, WindowSlidingAggregates) {
+
+    auto start_func =
+        [](Context& ctx) {
+            static constexpr size_t test_size = 1000;
+            static constexpr size_t window_size = 10;
+
+            // a zig-zag sequence, such that minimum and maximum move around
+            auto item = [](size_t i) { return (i * 7919) % 101; };
+
+            auto integers = Generate(ctx, test_size, item).Cache();
+
+            std::vector<size_t> sums =
+                integers.WindowSum(window_size).AllGather();
+            std::vector<size_t> mins =
+                integers.WindowMin(window_size).AllGather();
+            std::vector<size_t> maxs =
+                integers.WindowMax(window_size).AllGather();
+            std::vector<double> means =
+                integers.WindowMean(window_size).AllGather();
+
+            ASSERT_EQ(test_size - window_size + 1, sums.size());
+            ASSERT_EQ(sums.size(), mins.size());
+            ASSERT_EQ(sums.size(), maxs.size());
+            ASSERT_EQ(sums.size(), means.size());
+
+            for (size_t r = 0; r < sums.size(); ++r) {
+                size_t sum = 0, min = item(r), max = item(r);
+                for (size_t i = r; i < r + window_size; ++i) {
+                    sum += item(i);
+                    min = std::min(min, item(i));
+                    max = std::max(max, item(i));
+                }
+                ASSERT_EQ(sum, sums[r]);
+                ASSERT_EQ(min, mins[r]);
+                ASSERT_EQ(max, maxs[r]);
+                ASSERT_DOUBLE_EQ(
+                    static_cast<double>(sum) / window_size, means[r]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Operations, DisjointWindowCorrectResults) {
 
     static constexpr bool debug = false;
@@ -880,6 +1190,76 @@ TEST(Operations, Sample) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, WeightedSample) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 9999;
+
+            // only odd items have weight, heavy items are preferred
+            auto int_sampled =
+                Generate(ctx, n).WeightedSample(
+                    100, [](const size_t& i) {
+                        return i % 2 == 0 ? 0.0 : static_cast<double>(i);
+                    });
+
+            std::vector<size_t> int_vec = int_sampled.AllGather();
+            ASSERT_EQ(100u, int_vec.size());
+
+            std::sort(int_vec.begin(), int_vec.end());
+            ASSERT_TRUE(std::unique(int_vec.begin(), int_vec.end()) ==
+                        int_vec.end());
+
+            size_t heavy = 0;
+            for (const size_t& i : int_vec) {
+                ASSERT_EQ(1u, i % 2);
+                heavy += (i >= n / 2);
+            }
+            // expected share of the upper half is 3/4
+            ASSERT_GT(heavy, 55u);
+
+            // sample larger than the items with weight
+            auto all_sampled =
+                Generate(ctx, 100).WeightedSample(
+                    1000, [](const size_t& i) {
+                        return i % 2 == 0 ? 0.0 : 1.0;
+                    });
+            ASSERT_EQ(50u, all_sampled.Size());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Operations, SampleByKey) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 9999;
+
+            // key 0 has only three items, all of which are sampled
+            auto key_fn = [](const size_t& i) {
+                              return i < 3 ? size_t(0) : 1 + i % 7;
+                          };
+
+            std::vector<size_t> int_vec =
+                Generate(ctx, n).SampleByKey(key_fn, 10).AllGather();
+
+            std::vector<size_t> count(8);
+            for (const size_t& i : int_vec)
+                ++count[key_fn(i)];
+
+            ASSERT_EQ(3u, count[0]);
+            for (size_t k = 1; k < 8; ++k)
+                ASSERT_EQ(10u, count[k]);
+
+            std::sort(int_vec.begin(), int_vec.end());
+            ASSERT_TRUE(std::unique(int_vec.begin(), int_vec.end()) ==
+                        int_vec.end());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Operations, ForLoop) {
 
     auto start_func =
@@ -964,6 +1344,98 @@ TEST(Operations, WhileLoop) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, IterateLoop) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto integers = Generate(
+                ctx, 16,
+                [](const size_t& index) -> size_t {
+                    return index;
+                });
+
+            // run loop four times, inflating DIA of 16 items -> 256
+            DIA<size_t> squares = Iterate(
+                integers, 4,
+                [](const DIA<size_t>& in, size_t /* iter */) {
+                    return in.FlatMap<size_t>(
+                        [](size_t x, auto emit) {
+                            emit(2 * x);
+                            emit(2 * x);
+                        });
+                });
+
+            std::vector<size_t> out_vec = squares.AllGather();
+
+            ASSERT_EQ(256u, out_vec.size());
+            for (size_t i = 0; i != 256; ++i) {
+                ASSERT_EQ(out_vec[i], 16 * (i / 16));
+            }
+            ASSERT_EQ(256u, squares.Size());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Operations, IterateDeltaShortestPaths) {
+
+    // implicit graph with edges v -> v + 1 and v -> 2 * v
+    static constexpr size_t n = 1000;
+    static constexpr size_t inf = std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> dist(n, inf);
+    std::deque<size_t> queue { 0 };
+    dist[0] = 0;
+    while (!queue.empty()) {
+        size_t v = queue.front();
+        queue.pop_front();
+        for (size_t w : { v + 1, 2 * v }) {
+            if (w < n && dist[w] == inf)
+                dist[w] = dist[v] + 1, queue.push_back(w);
+        }
+    }
+
+    auto start_func =
+        [&dist](Context& ctx) {
+            using Vertex = std::pair<size_t, size_t>;
+
+            auto solution = Generate(
+                ctx, n,
+                [](size_t v) { return Vertex(v, v == 0 ? 0 : inf); });
+
+            auto workset = Generate(
+                ctx, 1, [](size_t) { return Vertex(0, 0); });
+
+            DIA<Vertex> result = IterateDelta(
+                solution, workset,
+                [](const Vertex& v) { return v.first; },
+                [](const Vertex& a, const Vertex& b) {
+                    return a.second <= b.second ? a : b;
+                },
+                n, /* max_iterations */ 100,
+                [](const DIA<Vertex>& /* solution */,
+                   const DIA<Vertex>& work, size_t /* iter */) {
+                    return work.FlatMap<Vertex>(
+                        [](const Vertex& v, auto emit) {
+                            for (size_t w : { v.first + 1, 2 * v.first }) {
+                                if (w < n) emit(Vertex(w, v.second + 1));
+                            }
+                        });
+                });
+
+            std::vector<Vertex> out_vec = result.AllGather();
+
+            ASSERT_EQ(n, out_vec.size());
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(i, out_vec[i].first);
+                ASSERT_EQ(dist[i], out_vec[i].second);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Operations, ActionFutures) {
 
     auto start_func =
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * tests/api/quantiles_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/generate.hpp>
+#include <thrill/api/quantiles.hpp>
+#include <thrill/core/kll_sketch.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+TEST(KllSketch, RankErrorAndMerge) {
+    static constexpr size_t n = 100000;
+    static constexpr size_t k = 200;
+
+    std::vector<size_t> values(n);
+    for (size_t i = 0; i < n; ++i) values[i] = i;
+    std::shuffle(values.begin(), values.end(), std::mt19937(42));
+
+    core::KllSketch<size_t> full(k), a(k), b(k);
+    for (size_t i = 0; i < n; ++i) {
+        full.insert(values[i]);
+        (i % 3 == 0 ? a : b).insert(values[i]);
+    }
+    core::KllSketch<size_t> merged = a + b;
+
+    ASSERT_EQ(n, full.num_items());
+    ASSERT_EQ(n, merged.num_items());
+    // the sketch stores only O(k) items
+    ASSERT_LT(full.size(), 4 * k);
+    ASSERT_LT(merged.size(), 4 * k);
+
+    for (double phi : { 0.01, 0.1, 0.5, 0.9, 0.99 }) {
+        double exact = phi * n;
+        ASSERT_NEAR(exact, static_cast<double>(full.Quantile(phi)), 0.02 * n);
+        ASSERT_NEAR(exact, static_cast<double>(merged.Quantile(phi)), 0.02 * n);
+        ASSERT_NEAR(exact, static_cast<double>(
+                        merged.Rank(static_cast<size_t>(exact))), 0.02 * n);
+    }
+}
+
+TEST(Operations, QuantilesOfGenerate) {
+    auto start_func =
+        [](Context& ctx) {
+            static constexpr size_t n = 100000;
+
+            auto integers = Generate(ctx, n);
+
+            auto sketch = integers.Quantiles(200);
+            ASSERT_EQ(n, sketch.num_items());
+
+            std::vector<size_t> q = sketch.Quantiles({ 0.5, 0.9, 0.99 });
+            ASSERT_NEAR(0.5 * n, static_cast<double>(q[0]), 0.02 * n);
+            ASSERT_NEAR(0.9 * n, static_cast<double>(q[1]), 0.02 * n);
+            ASSERT_NEAR(0.99 * n, static_cast<double>(q[2]), 0.02 * n);
+
+            // reversed order: the 0.1-quantile is near the 0.9-quantile
+            auto future = integers.QuantilesFuture(200, std::greater<size_t>());
+            double top = static_cast<double>(future.get().Quantile(0.1));
+            ASSERT_NEAR(0.9 * n, top, 0.02 * n);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+/******************************************************************************/
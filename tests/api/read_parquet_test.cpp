@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * tests/api/read_parquet_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/api/all_gather.hpp>
+#include <thrill/api/read_parquet.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
+
+#include <arrow/io/file.h>
+#include <parquet/api/writer.h>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace thrill;
+
+//! write a Parquet file with columns id, value, and name, and a row group of
+//! rows_per_group rows each.
+static void WriteParquetFile(const std::string& path, size_t num_rows,
+                             size_t rows_per_group) {
+    using parquet::schema::GroupNode;
+    using parquet::schema::PrimitiveNode;
+
+    parquet::schema::NodeVector fields;
+    fields.push_back(PrimitiveNode::Make(
+                         "id", parquet::Repetition::REQUIRED,
+                         parquet::Type::INT64, parquet::ConvertedType::NONE));
+    fields.push_back(PrimitiveNode::Make(
+                         "value", parquet::Repetition::REQUIRED,
+                         parquet::Type::DOUBLE, parquet::ConvertedType::NONE));
+    fields.push_back(PrimitiveNode::Make(
+                         "name", parquet::Repetition::OPTIONAL,
+                         parquet::Type::BYTE_ARRAY, parquet::ConvertedType::UTF8));
+
+    std::shared_ptr<GroupNode> schema = std::static_pointer_cast<GroupNode>(
+        GroupNode::Make("schema", parquet::Repetition::REQUIRED, fields));
+
+    std::shared_ptr<arrow::io::FileOutputStream> out;
+    PARQUET_ASSIGN_OR_THROW(out, arrow::io::FileOutputStream::Open(path));
+
+    std::unique_ptr<parquet::ParquetFileWriter> writer =
+        parquet::ParquetFileWriter::Open(out, schema);
+
+    for (size_t begin = 0; begin < num_rows; begin += rows_per_group) {
+        size_t end = std::min(begin + rows_per_group, num_rows);
+
+        std::vector<int64_t> ids;
+        std::vector<double> values;
+        std::vector<std::string> names;
+        std::vector<parquet::ByteArray> name_values;
+        std::vector<int16_t> name_levels;
+        for (size_t i = begin; i < end; ++i) {
+            ids.push_back(static_cast<int64_t>(i));
+            values.push_back(static_cast<double>(i) / 2.0);
+            // every third name is null
+            name_levels.push_back(i % 3 == 0 ? 0 : 1);
+            if (i % 3 != 0)
+                names.push_back("row" + std::to_string(i));
+        }
+        for (const std::string& n : names) {
+            name_values.emplace_back(
+                static_cast<uint32_t>(n.size()),
+                reinterpret_cast<const uint8_t*>(n.data()));
+        }
+
+        parquet::RowGroupWriter* rg = writer->AppendRowGroup();
+        static_cast<parquet::Int64Writer*>(rg->NextColumn())->WriteBatch(
+            ids.size(), nullptr, nullptr, ids.data());
+        static_cast<parquet::DoubleWriter*>(rg->NextColumn())->WriteBatch(
+            values.size(), nullptr, nullptr, values.data());
+        static_cast<parquet::ByteArrayWriter*>(rg->NextColumn())->WriteBatch(
+            name_levels.size(), name_levels.data(), nullptr,
+            name_values.data());
+        rg->Close();
+    }
+
+    writer->Close();
+    PARQUET_THROW_NOT_OK(out->Close());
+}
+
+TEST(ReadParquet, ReadColumnsOfRowGroups) {
+    vfs::TemporaryDirectory tmpdir;
+
+    static constexpr size_t num_rows = 10000;
+    WriteParquetFile(tmpdir.get() + "/a.parquet", num_rows, 700);
+    WriteParquetFile(tmpdir.get() + "/b.parquet", num_rows, 1300);
+
+    auto start_func =
+        [&](Context& ctx) {
+            using Row = std::tuple<int64_t, std::string>;
+
+            std::vector<Row> rows =
+                ReadParquet<Row>(ctx, tmpdir.get() + "/*.parquet",
+                                 { "id", "name" }).AllGather();
+
+            ASSERT_EQ(2 * num_rows, rows.size());
+
+            // rows of both files in order
+            for (size_t i = 0; i < rows.size(); ++i) {
+                size_t id = i % num_rows;
+                ASSERT_EQ(static_cast<int64_t>(id), std::get<0>(rows[i]));
+                ASSERT_EQ(id % 3 == 0 ? "" : "row" + std::to_string(id),
+                          std::get<1>(rows[i]));
+            }
+
+            using Pair = std::pair<double, int64_t>;
+
+            std::vector<Pair> pairs =
+                ReadParquet<Pair>(ctx, tmpdir.get() + "/a.parquet",
+                                  { "value", "id" }).AllGather();
+
+            ASSERT_EQ(num_rows, pairs.size());
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                ASSERT_EQ(static_cast<double>(i) / 2.0, pairs[i].first);
+                ASSERT_EQ(static_cast<int64_t>(i), pairs[i].second);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+/******************************************************************************/
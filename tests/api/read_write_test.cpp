@@ -11,6 +11,9 @@
 
 #include <gtest/gtest.h>
 #include <thrill/api/all_gather.hpp>
+#include <thrill/api/binary_index.hpp>
+#include <thrill/api/checkpoint.hpp>
+#include <thrill/api/distributed_glob.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/read_binary.hpp>
 #include <thrill/api/read_lines.hpp>
@@ -26,11 +29,14 @@
 #include <sys/stat.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
 #include <random>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -57,6 +63,28 @@ TEST(IO, ReadSingleFile) {
     api::RunLocalTests(start_func);
 }
 
+TEST(IO, ReadSingleFileMapView) {
+    auto start_func =
+        [](Context& ctx) {
+            auto integers = ReadLines(
+                ctx, "inputs/test1",
+                [](const tlx::string_view& line) {
+                    return std::stoi(std::string(line.data(), line.size()));
+                });
+
+            std::vector<int> out_vec = integers.AllGather();
+
+            int i = 1;
+            for (int element : out_vec) {
+                ASSERT_EQ(element, i++);
+            }
+
+            ASSERT_EQ(16u, out_vec.size());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(IO, ReadSingleFileLocalStorageTag) {
     auto start_func =
         [](Context& ctx) {
@@ -87,6 +115,27 @@ TEST(IO, ReadFolder) {
     api::RunLocalTests(start_func);
 }
 
+TEST(IO, DistributedGlobLocalFiles) {
+    auto start_func =
+        [](Context& ctx) {
+            std::vector<std::string> globlist = {
+                "inputs/read_folder/*", "inputs/test1"
+            };
+            vfs::FileList files =
+                api::DistributedGlob(ctx, globlist, vfs::GlobType::File);
+            vfs::FileList expected = vfs::Glob(globlist, vfs::GlobType::File);
+
+            ASSERT_EQ(expected.size(), files.size());
+            for (size_t i = 0; i < files.size(); ++i) {
+                ASSERT_EQ(expected[i].path, files[i].path);
+                ASSERT_EQ(expected[i].size_ex_psum, files[i].size_ex_psum);
+            }
+            ASSERT_EQ(expected.total_size, files.total_size);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 // need all decompressors in folder
 #if THRILL_HAVE_ZLIB && THRILL_HAVE_BZIP2
 
@@ -162,6 +211,56 @@ TEST(IO, GenerateIntegerWriteReadBinary) {
         });
 }
 
+TEST(IO, GenerateIntegerWriteReadBinarySample) {
+    vfs::TemporaryDirectory tmpdir;
+
+    api::RunLocalTests(
+        [&tmpdir](api::Context& ctx) {
+
+            // wipe directory from last test
+            if (ctx.my_rank() == 0) {
+                tmpdir.wipe();
+            }
+            ctx.net.Barrier();
+
+            size_t generate_size = 32000;
+            {
+                auto dia = Generate(
+                    ctx, generate_size,
+                    [](const size_t index) { return index + 42; });
+
+                dia.WriteBinary(tmpdir.get() + "/IntegerBinary",
+                                16 * 1024);
+            }
+            ctx.net.Barrier();
+
+            // read a 5% sample, the expected size is 1600 +/- 39
+            {
+                auto dia = api::ReadBinarySample<size_t>(
+                    ctx, tmpdir.get() + "/IntegerBinary*", 0.05);
+
+                std::vector<size_t> vec = dia.AllGather();
+
+                ASSERT_LT(1300u, vec.size());
+                ASSERT_GT(1900u, vec.size());
+
+                // the sample is a subsequence of the items
+                for (size_t i = 0; i < vec.size(); ++i) {
+                    ASSERT_LE(42u, vec[i]);
+                    ASSERT_GT(42 + generate_size, vec[i]);
+                    if (i != 0) ASSERT_LT(vec[i - 1], vec[i]);
+                }
+            }
+
+            // an empty sample
+            {
+                auto dia = api::ReadBinarySample<size_t>(
+                    ctx, tmpdir.get() + "/IntegerBinary*", 0.0);
+                ASSERT_EQ(0u, dia.Size());
+            }
+        });
+}
+
 #if THRILL_HAVE_ZLIB
 
 TEST(IO, GenerateIntegerWriteReadBinaryCompressed) {
@@ -267,6 +366,74 @@ TEST(IO, GenerateStringWriteBinary) {
         });
 }
 
+TEST(IO, GenerateStringWriteBinaryIndex) {
+    vfs::TemporaryDirectory tmpdir;
+
+    api::RunLocalTests(
+        [&tmpdir](api::Context& ctx) {
+
+            // wipe directory from last test
+            if (ctx.my_rank() == 0) {
+                tmpdir.wipe();
+            }
+            ctx.net.Barrier();
+
+            // generate a dia of strings and write them into large files
+            size_t generate_size = 32000;
+            {
+                auto dia = Generate(
+                    ctx, generate_size,
+                    [](const size_t index) { return test_string(index); });
+
+                dia.WriteBinary(tmpdir.get() + "/IndexBinary");
+            }
+            ctx.net.Barrier();
+
+            // check that the index of all files counts all items
+            {
+                vfs::FileList files = vfs::Glob(
+                    tmpdir.get() + "/IndexBinary*", vfs::GlobType::File);
+
+                uint64_t num_items = 0;
+                for (size_t i = 0; i < files.size(); ++i) {
+                    api::BinaryIndex index;
+                    ASSERT_TRUE(index.Read(files[i].path, files[i].size));
+                    ASSERT_LT(index.data_size, files[i].size);
+                    num_items += index.num_items();
+                }
+                ASSERT_EQ(generate_size, num_items);
+            }
+
+            // read the strings split at the indexed item boundaries
+            {
+                auto dia = api::ReadBinary<std::string>(
+                    ctx, tmpdir.get() + "/IndexBinary*");
+
+                std::vector<std::string> vec = dia.AllGather();
+
+                ASSERT_EQ(generate_size, vec.size());
+                for (size_t i = 0; i < vec.size(); ++i) {
+                    ASSERT_EQ(test_string(i), vec[i]);
+                }
+            }
+
+            // read a prefix with a size limit
+            {
+                auto dia = api::ReadBinary<std::string>(
+                    ctx, tmpdir.get() + "/IndexBinary*", 100000);
+
+                std::vector<std::string> vec = dia.AllGather();
+
+                // the limit is rounded up to the next indexed Block
+                ASSERT_LT(0u, vec.size());
+                ASSERT_GE(generate_size, vec.size());
+                for (size_t i = 0; i < vec.size(); ++i) {
+                    ASSERT_EQ(test_string(i), vec[i]);
+                }
+            }
+        });
+}
+
 TEST(IO, WriteAndReadBinaryEqualDIAs) {
     vfs::TemporaryDirectory tmpdir;
 
@@ -429,4 +596,191 @@ TEST(IO, IntegerWriteReadBinaryLinesFutures) {
         });
 }
 
+TEST(IO, ReadLinesIoThreads) {
+    vfs::TemporaryDirectory tmpdir;
+
+    // lines of varying length, such that the parts of the I/O threads split
+    // lines and blocks at arbitrary positions.
+    size_t num_lines = 200000;
+    std::vector<std::string> lines;
+    {
+        std::ofstream file(tmpdir.get() + "/lines");
+        for (size_t i = 0; i < num_lines; ++i) {
+            lines.emplace_back(std::to_string(i) + std::string(i % 13, 'x'));
+            file << lines.back() << '\n';
+        }
+    }
+
+    // small Blocks, such that each worker's range is split among the threads
+    size_t saved_block_size = data::default_block_size;
+    data::default_block_size = 16 * 1024;
+
+    auto start_func =
+        [&](Context& ctx) {
+            ASSERT_EQ(lines, ReadLines(ctx, tmpdir.get() + "/lines")
+                      .AllGather());
+
+            std::vector<size_t> sizes =
+                ReadLines(ctx, tmpdir.get() + "/lines",
+                          [](const tlx::string_view& line) {
+                              return line.size();
+                          })
+                .AllGather();
+
+            ASSERT_EQ(num_lines, sizes.size());
+            for (size_t i = 0; i < num_lines; ++i)
+                ASSERT_EQ(lines[i].size(), sizes[i]);
+        };
+
+    for (size_t io_threads : { 1, 3, 8 }) {
+        api::MemoryConfig mem_config;
+        mem_config.setup(128 * 1024 * 1024llu);
+        mem_config.io_threads_ = io_threads;
+
+        api::RunLocalMock(mem_config, 2, 2, start_func);
+    }
+
+    data::default_block_size = saved_block_size;
+}
+
+TEST(IO, ReadLinesSourceStealing) {
+    vfs::TemporaryDirectory tmpdir;
+
+    size_t num_lines = 100000;
+    std::vector<std::string> lines;
+    {
+        std::ofstream file(tmpdir.get() + "/lines");
+        for (size_t i = 0; i < num_lines; ++i) {
+            lines.emplace_back(std::to_string(i) + std::string(i % 7, 'y'));
+            file << lines.back() << '\n';
+        }
+    }
+
+    // small Blocks, such that each worker's range has many chunks
+    size_t saved_block_size = data::default_block_size;
+    data::default_block_size = 1024;
+
+    auto start_func =
+        [&](Context& ctx) {
+            // the first worker is slow, such that the others steal its chunks
+            auto slow_lines = ReadLines(
+                ctx, tmpdir.get() + "/lines",
+                [&ctx](const tlx::string_view& line) {
+                    if (ctx.my_rank() == 0)
+                        std::this_thread::sleep_for(
+                            std::chrono::microseconds(2));
+                    return std::string(line.data(), line.size());
+                });
+
+            ASSERT_EQ(lines, slow_lines.AllGather());
+            ASSERT_EQ(lines, ReadLines(ctx, tmpdir.get() + "/lines")
+                      .AllGather());
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.source_steal_interval_ = 1;
+
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+
+    data::default_block_size = saved_block_size;
+}
+
+TEST(IO, CheckpointRestore) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string path = tmpdir.get() + "/ckpt";
+
+    size_t num_items = 100000;
+    std::atomic<size_t> computed { 0 };
+
+    auto start_func =
+        [&](Context& ctx) {
+            auto squares =
+                Generate(ctx, num_items)
+                .Map([&computed](const size_t& i) {
+                         ++computed;
+                         return std::to_string(i * i);
+                     })
+                .Checkpoint(path);
+
+            std::vector<std::string> out = squares.AllGather();
+            ASSERT_EQ(num_items, out.size());
+            for (size_t i = 0; i < num_items; ++i)
+                ASSERT_EQ(std::to_string(i * i), out[i]);
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+
+    // the first run computes and writes the checkpoint
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(num_items, computed.load());
+
+    // the second run with the same layout restores it
+    computed = 0;
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(0u, computed.load());
+
+    // another layout recomputes the items
+    api::RunLocalMock(mem_config, 1, 3, start_func);
+    ASSERT_EQ(num_items, computed.load());
+}
+
+TEST(IO, CacheSourceReadLines) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string input = tmpdir.get() + "/input.txt";
+    std::string cache_dir = tmpdir.get();
+
+    auto write_input = [&](size_t lines) {
+                           std::ofstream of(input);
+                           for (size_t i = 0; i < lines; ++i)
+                               of << i << '\n';
+                       };
+
+    std::atomic<size_t> parsed { 0 };
+    std::string version = "v1";
+    size_t num_lines = 10000;
+
+    auto start_func =
+        [&](Context& ctx) {
+            auto numbers =
+                ReadLines(ctx, input)
+                .Map([&parsed](const std::string& line) {
+                         ++parsed;
+                         return std::stoul(line);
+                     })
+                .CacheSource(cache_dir, { input }, version);
+
+            std::vector<size_t> out = numbers.AllGather();
+            ASSERT_EQ(num_lines, out.size());
+            for (size_t i = 0; i < num_lines; ++i)
+                ASSERT_EQ(i, out[i]);
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+
+    // the first run parses the input and fills the cache
+    write_input(num_lines);
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(num_lines, parsed.load());
+
+    // the same input and version load the cached Blocks
+    parsed = 0;
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(0u, parsed.load());
+
+    // a new version parses again
+    version = "v2";
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(num_lines, parsed.load());
+
+    // and so does a changed input
+    parsed = 0;
+    num_lines = 12000;
+    write_input(num_lines);
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+    ASSERT_EQ(num_lines, parsed.load());
+}
+
 /******************************************************************************/
@@ -12,7 +12,9 @@
 
 #include <gtest/gtest.h>
 #include <thrill/api/all_gather.hpp>
+#include <thrill/api/cache.hpp>
 #include <thrill/api/generate.hpp>
+#include <thrill/api/group_by_key.hpp>
 #include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/reduce_to_index.hpp>
 #include <thrill/api/size.hpp>
@@ -20,6 +22,7 @@
 #include <thrill/common/logger.hpp>
 
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -87,6 +90,12 @@ TEST(ReduceNode, ReduceModulo2CorrectResults) {
         TestReduceModulo2CorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceModulo2CorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModulo2CorrectResults<ReduceTableImpl::SIMD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModulo2CorrectResults<ReduceTableImpl::ROBIN_HOOD>());
+    api::RunLocalTests(
+        TestReduceModulo2CorrectResults<ReduceTableImpl::SOA_PROBING>());
 }
 
 //! Test sums of integers 0..n-1 for n=100 in 1000 buckets in the reduce table
@@ -136,6 +145,195 @@ TEST(ReduceNode, ReduceModuloPairsCorrectResults) {
         TestReduceModuloPairsCorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceModuloPairsCorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModuloPairsCorrectResults<ReduceTableImpl::SIMD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModuloPairsCorrectResults<ReduceTableImpl::ROBIN_HOOD>());
+    api::RunLocalTests(
+        TestReduceModuloPairsCorrectResults<ReduceTableImpl::SOA_PROBING>());
+}
+
+//! ReduceConfig which pre-aggregates sums on an accelerator, if available
+class AcceleratorReduceConfig : public api::DefaultReduceConfig
+{
+public:
+    static constexpr bool use_accelerator_ = true;
+};
+
+TEST(ReduceNode, ReducePairAccelerator) {
+
+    auto start_func =
+        [](Context& ctx) {
+            static constexpr size_t test_size = 1000000u;
+            static constexpr size_t mod_size = 1000u;
+
+            using IntPair = std::pair<int, uint64_t>;
+            using DoublePair = std::pair<uint32_t, double>;
+
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) {
+                    return IntPair(static_cast<int>(index % mod_size) - 500,
+                                   index / mod_size);
+                });
+
+            std::vector<IntPair> out_vec =
+                integers.ReducePair(std::plus<uint64_t>(),
+                                    AcceleratorReduceConfig()).AllGather();
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(mod_size, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); ++i) {
+                ASSERT_EQ(static_cast<int>(i) - 500, out_vec[i].first);
+                ASSERT_EQ(999u * 1000u / 2u, out_vec[i].second);
+            }
+
+            auto doubles = Generate(
+                ctx, test_size,
+                [](const size_t& index) {
+                    return DoublePair(
+                        static_cast<uint32_t>(index % mod_size), 0.5);
+                });
+
+            std::vector<DoublePair> out_doubles =
+                doubles.ReducePair(std::plus<double>(),
+                                   AcceleratorReduceConfig()).AllGather();
+
+            ASSERT_EQ(mod_size, out_doubles.size());
+            for (const DoublePair& p : out_doubles)
+                ASSERT_DOUBLE_EQ(500.0, p.second);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+//! Test ReducePair of string keys with PreHashKeyTag, also with a degenerate
+//! hash function, such that the key comparisons decide.
+template <ReduceTableImpl table_impl>
+class TestReducePreHashKeyCorrectResults
+{
+public:
+    void operator () (Context& ctx) {
+        static constexpr size_t test_size = 100000u;
+        static constexpr size_t mod_size = 1000u;
+        static constexpr size_t div_size = test_size / mod_size;
+
+        using StringPair = std::pair<std::string, size_t>;
+
+        auto pairs = Generate(
+            ctx, test_size,
+            [](const size_t& index) {
+                return StringPair(
+                    "a long key prefix " + std::to_string(index % mod_size),
+                    index / mod_size);
+            }).Cache();
+
+        auto add_function = [](const size_t& in1, const size_t& in2) {
+                                return in1 + in2;
+                            };
+
+        auto check = [](std::vector<StringPair> out_vec) {
+                         ASSERT_EQ(mod_size, out_vec.size());
+                         std::sort(out_vec.begin(), out_vec.end());
+                         for (size_t i = 1; i < out_vec.size(); ++i)
+                             ASSERT_NE(out_vec[i - 1].first, out_vec[i].first);
+                         for (const auto& element : out_vec) {
+                             ASSERT_EQ((div_size * (div_size - 1)) / 2u,
+                                       element.second);
+                         }
+                     };
+
+        check(pairs.Keep().ReducePair(
+                  PreHashKeyTag, add_function,
+                  core::DefaultReduceConfigSelect<table_impl>())
+              .AllGather());
+
+        check(pairs.ReducePair(
+                  PreHashKeyTag, add_function,
+                  core::DefaultReduceConfigSelect<table_impl>(),
+                  [](const std::string& s) { return s.size(); },
+                  std::equal_to<std::string>())
+              .AllGather());
+    }
+};
+
+TEST(ReduceNode, ReducePreHashKeyCorrectResults) {
+    api::RunLocalTests(
+        TestReducePreHashKeyCorrectResults<ReduceTableImpl::PROBING>());
+    api::RunLocalTests(
+        TestReducePreHashKeyCorrectResults<ReduceTableImpl::BUCKET>());
+    api::RunLocalTests(
+        TestReducePreHashKeyCorrectResults<ReduceTableImpl::SIMD_PROBING>());
+    api::RunLocalTests(
+        TestReducePreHashKeyCorrectResults<ReduceTableImpl::ROBIN_HOOD>());
+    api::RunLocalTests(
+        TestReducePreHashKeyCorrectResults<ReduceTableImpl::SOA_PROBING>());
+}
+
+//! stateless key extractor, whose type identifies the key
+struct Modulo10Key {
+    size_t operator () (const size_t& in) const {
+        return in % 10;
+    }
+};
+
+TEST(ReduceNode, ReduceOnPartitionedParent) {
+
+    auto start_func =
+        [](Context& ctx) {
+            using IntPair = std::pair<size_t, size_t>;
+
+            // ReducePair of a ReducePair result needs no exchange.
+            auto pairs = Generate(
+                ctx, 100000,
+                [](const size_t& index) { return IntPair(index % 1000, 1); });
+
+            auto reduced = pairs.ReducePair(
+                [](const size_t& a, const size_t& b) { return a + b; });
+
+            ASSERT_TRUE(reduced.node()->partitioned_by<
+                            api::ReducePairKeyExtractor<IntPair> >());
+
+            auto twice = reduced.ReducePair(
+                [](const size_t& a, const size_t& b) { return a + b; });
+
+            std::vector<IntPair> out_pairs = twice.AllGather();
+            std::sort(out_pairs.begin(), out_pairs.end());
+
+            ASSERT_EQ(1000u, out_pairs.size());
+            for (size_t i = 0; i < out_pairs.size(); ++i) {
+                ASSERT_EQ(IntPair(i, 100), out_pairs[i]);
+            }
+
+            // GroupByKey on the result of a ReduceByKey with the same key.
+            auto integers = Generate(
+                ctx, 1000, [](const size_t& index) { return index; });
+
+            auto maxima = integers.ReduceByKey(
+                Modulo10Key(),
+                [](const size_t& a, const size_t& b) { return std::max(a, b); });
+
+            auto counts = maxima.GroupByKey<IntPair>(
+                Modulo10Key(),
+                [](auto& iter, const size_t& key) {
+                    size_t count = 0;
+                    while (iter.HasNext()) {
+                        iter.Next();
+                        ++count;
+                    }
+                    return IntPair(key, count);
+                });
+
+            std::vector<IntPair> out_counts = counts.AllGather();
+            std::sort(out_counts.begin(), out_counts.end());
+
+            ASSERT_EQ(10u, out_counts.size());
+            for (size_t i = 0; i < out_counts.size(); ++i) {
+                ASSERT_EQ(IntPair(i, 1), out_counts[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
 }
 
 template <ReduceTableImpl table_impl>
@@ -212,6 +410,14 @@ TEST(ReduceNode, ReduceToIndexCorrectResults) {
         TestReduceToIndexCorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceToIndexCorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<ReduceTableImpl::SIMD_PROBING>());
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<ReduceTableImpl::ROBIN_HOOD>());
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<ReduceTableImpl::SOA_PROBING>());
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<ReduceTableImpl::DENSE>());
 }
 
 TEST(ReduceToIndexNode, OutputSizeCheck) {
@@ -12,10 +12,13 @@
 #include <thrill/api/generate.hpp>
 #include <thrill/api/read_binary.hpp>
 #include <thrill/api/sort.hpp>
+#include <thrill/common/functional.hpp>
 
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -52,6 +55,83 @@ TEST(Sort, SortKnownIntegers) {
     api::RunLocalMock(mem_config, 2, 1, start_func);
 }
 
+TEST(Sort, SortRandomIntegersReplacementSelection) {
+
+    static constexpr size_t test_size = 6000000u;
+
+    size_t runs[2] = { 0, 0 };
+
+    for (bool replacement_selection : { false, true }) {
+        auto start_func =
+            [&](Context& ctx) {
+
+                std::default_random_engine generator(std::random_device { } ());
+                std::uniform_int_distribution<size_t> distribution(0, 1000000);
+
+                auto integers = Generate(
+                    ctx, test_size,
+                    [&distribution, &generator](const size_t&) -> size_t {
+                        return distribution(generator);
+                    });
+
+                auto sorted = integers.Sort();
+
+                std::vector<size_t> out_vec = sorted.AllGather();
+
+                ASSERT_EQ(test_size, out_vec.size());
+                ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+
+                size_t local_runs = api::GetSortPhaseStats(sorted)->runs;
+                local_runs = ctx.net.AllReduce(local_runs);
+                if (ctx.my_rank() == 0)
+                    runs[replacement_selection] = local_runs;
+            };
+
+        // set fixed amount of RAM for testing, such that the items overflow
+        api::MemoryConfig mem_config;
+        mem_config.setup(128 * 1024 * 1024llu);
+        mem_config.enable_replacement_selection_ = replacement_selection;
+
+        api::RunLocalMock(mem_config, 2, 1, start_func);
+    }
+
+    // random items form runs about twice as long
+    if (runs[0] >= 4)
+        ASSERT_LT(runs[1], runs[0]);
+}
+
+TEST(Sort, SortRandomIntegersParallelLocalSort) {
+
+    static constexpr size_t test_size = 1000000u;
+
+    for (bool parallel_local_sort : { false, true }) {
+        auto start_func =
+            [](Context& ctx) {
+
+                std::default_random_engine generator(std::random_device { } ());
+                std::uniform_int_distribution<size_t> distribution(0, 1000000);
+
+                auto integers = Generate(
+                    ctx, test_size,
+                    [&distribution, &generator](const size_t&) -> size_t {
+                        return distribution(generator);
+                    });
+
+                std::vector<size_t> out_vec = integers.Sort().AllGather();
+
+                ASSERT_EQ(test_size, out_vec.size());
+                ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+            };
+
+        // two workers per host, such that an idle one may lend its core
+        api::MemoryConfig mem_config;
+        mem_config.setup(128 * 1024 * 1024llu);
+        mem_config.enable_parallel_local_sort_ = parallel_local_sort;
+
+        api::RunLocalMock(mem_config, 1, 2, start_func);
+    }
+}
+
 TEST(Sort, SortRandomIntegers) {
 
     auto start_func =
@@ -209,6 +289,71 @@ TEST(Sort, SortZeroToThree) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Sort, SortDuplicateHeavyKeys) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // nine in ten items have the same key, which repeats as splitter
+            size_t size = 100000;
+            auto integers = Generate(
+                ctx, size,
+                [](const size_t& index) -> size_t {
+                    return index % 10 == 0 ? index : 42;
+                });
+
+            auto sorted = integers.Sort();
+
+            std::vector<size_t> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(size, out_vec.size());
+            ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+
+            // the hot key is spread across the workers of its splitters
+            const api::SortPhaseStats* stats = api::GetSortPhaseStats(sorted);
+            ASSERT_TRUE(stats != nullptr);
+            size_t max_items = ctx.net.AllReduce(
+                stats->items, common::maximum<size_t>());
+            ASSERT_LE(max_items, 2 * size / ctx.num_workers() + 1000);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Sort, SortHostWeights) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            size_t size = 200000;
+            auto integers = Generate(
+                ctx, size,
+                [](const size_t& index) -> size_t {
+                    return (index * 7919) % 200003;
+                });
+
+            auto sorted = integers.Sort();
+
+            std::vector<size_t> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(size, out_vec.size());
+            ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+
+            // the workers of host 0 with weight 3 receive about three times
+            // the items of those of host 1.
+            size_t items = api::GetSortPhaseStats(sorted)->items;
+            size_t expected = ctx.host_rank() == 0 ? 3 * size / 8 : size / 8;
+            ASSERT_GT(items, expected * 8 / 10);
+            ASSERT_LT(items, expected * 12 / 10);
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    mem_config.host_weights_ = { 3, 1 };
+
+    api::RunLocalMock(mem_config, 2, 2, start_func);
+}
+
 TEST(Sort, SortWithEmptyWorkers) {
 
     auto start_func =
@@ -275,6 +420,161 @@ TEST(Sort, SortZeroIntegers) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Sort, SortByKeyRandomIntegers) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            std::default_random_engine generator(std::random_device { } ());
+            std::uniform_int_distribution<int> distribution(-10000, 10000);
+
+            auto integers = Generate(
+                ctx, 1000000,
+                [&distribution, &generator](const size_t&) -> int {
+                    return distribution(generator);
+                });
+
+            auto sorted = integers.SortByKey([](const int& i) { return i; });
+
+            std::vector<int> out_vec = sorted.AllGather();
+
+            for (size_t i = 0; i + 1 < out_vec.size(); i++) {
+                ASSERT_FALSE(out_vec[i + 1] < out_vec[i]);
+            }
+
+            ASSERT_EQ(1000000u, out_vec.size());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+// record with a TeraSort-like 10 byte key
+struct Record10 {
+    std::array<uint8_t, 10> key;
+    size_t                  value;
+};
+
+TEST(Sort, SortByKeyByteArrayRecords) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto records = Generate(
+                ctx, 100000,
+                [](const size_t& index) -> Record10 {
+                    std::default_random_engine generator(index);
+                    Record10 r;
+                    for (size_t i = 0; i < r.key.size(); ++i)
+                        r.key[i] = static_cast<uint8_t>(generator() % 8);
+                    r.value = index;
+                    return r;
+                });
+
+            auto sorted = records.SortByKey(
+                [](const Record10& r) { return r.key; });
+
+            std::vector<Record10> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(100000u, out_vec.size());
+            for (size_t i = 1; i < out_vec.size(); i++) {
+                ASSERT_FALSE(out_vec[i].key < out_vec[i - 1].key);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Sort, SortByKeyStrings) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto pairs = Generate(
+                ctx, 10000,
+                [](const size_t& index) -> std::pair<std::string, size_t> {
+                    return std::make_pair(
+                        std::to_string((index * 7919) % 10000), index);
+                });
+
+            // string keys are not radix sortable: std::sort on cached prefixes
+            auto sorted = pairs.SortByKey(
+                [](const std::pair<std::string, size_t>& p) {
+                    return p.first;
+                });
+
+            std::vector<std::pair<std::string, size_t> > out_vec =
+                sorted.AllGather();
+
+            ASSERT_EQ(10000u, out_vec.size());
+            for (size_t i = 1; i < out_vec.size(); i++) {
+                ASSERT_LE(out_vec[i - 1].first, out_vec[i].first);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Sort, SortByKeyStringsCommonPrefix) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // all keys share a prefix longer than the cached key prefix,
+            // hence all comparisons fall back to the full keys.
+            auto strings = Generate(
+                ctx, 10000,
+                [](const size_t& index) -> std::string {
+                    return "common_prefix_" +
+                           std::to_string((index * 7919) % 1000);
+                });
+
+            auto sorted = strings.SortByKey(
+                [](const std::string& s) -> const std::string& { return s; });
+
+            std::vector<std::string> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(10000u, out_vec.size());
+            for (size_t i = 1; i < out_vec.size(); i++) {
+                ASSERT_LE(out_vec[i - 1], out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Sort, SortAcceleratorSortAlgorithm) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using Pair = std::pair<int64_t, std::string>;
+
+            // runs are sorted on the device if available, else on the CPU
+            auto pairs = Generate(
+                ctx, 200000,
+                [](const size_t& index) -> Pair {
+                    int64_t key = static_cast<int64_t>(
+                        (index * 7919) % 200000) - 100000;
+                    return Pair(key, std::to_string(key));
+                });
+
+            auto key = [](const Pair& p) { return p.first; };
+            auto sorted = pairs.Sort(
+                [key](const Pair& a, const Pair& b) { return key(a) < key(b); },
+                api::AcceleratorSortAlgorithm<decltype(key)>(key));
+
+            std::vector<Pair> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(200000u, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); i++) {
+                ASSERT_EQ(static_cast<int64_t>(i) - 100000, out_vec[i].first);
+                ASSERT_EQ(std::to_string(out_vec[i].first), out_vec[i].second);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
 
 // struct for stable sorting tests
@@ -11,11 +11,13 @@
 #include <thrill/api/all_gather.hpp>
 #include <thrill/api/cache.hpp>
 #include <thrill/api/generate.hpp>
+#include <thrill/api/inner_join.hpp>
 #include <thrill/api/reduce_by_key.hpp>
 
 #include <algorithm>
 #include <random>
 #include <string>
+#include <tuple>
 #include <vector>
 
 using namespace thrill; // NOLINT
@@ -219,4 +221,82 @@ TEST(Stage, AdditionalChildReferences) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Stage, OverlapIndependentBranches) {
+
+    using Pair = std::pair<size_t, size_t>;
+    using Triple = std::tuple<size_t, size_t, size_t>;
+    static constexpr size_t size = 10000, keys = 100;
+
+    auto start_func =
+        [](Context& ctx) {
+            auto key_fn = [](const Pair& p) { return p.first; };
+            auto sum_fn = [](const Pair& a, const Pair& b) {
+                              return Pair(a.first, a.second + b.second);
+                          };
+
+            // two independent branches feeding a join
+            auto sums1 = Generate(
+                ctx, size,
+                [](size_t i) { return Pair(i % keys, i); })
+                         .ReduceByKey(key_fn, sum_fn);
+            auto sums2 = Generate(
+                ctx, size,
+                [](size_t i) { return Pair(i % keys, 2 * i); })
+                         .ReduceByKey(key_fn, sum_fn);
+
+            std::vector<Triple> out = InnerJoin(
+                sums1, sums2, key_fn, key_fn,
+                [](const Pair& a, const Pair& b) {
+                    return Triple(a.first, a.second, b.second);
+                }).AllGather();
+
+            std::sort(out.begin(), out.end());
+
+            ASSERT_EQ(keys, out.size());
+            for (size_t k = 0; k < keys; ++k) {
+                size_t n = size / keys;
+                size_t sum = k * n + keys * n * (n - 1) / 2;
+                ASSERT_EQ(Triple(k, sum, 2 * sum), out[k]);
+            }
+        };
+
+    for (bool overlap : { false, true }) {
+        api::MemoryConfig mem_config;
+        mem_config.setup(128 * 1024 * 1024llu);
+        mem_config.enable_stage_overlap_ = overlap;
+
+        api::RunLocalMock(mem_config, 2, 2, start_func);
+    }
+}
+
+TEST(Stage, DistributeMemory) {
+    using api::DIAMemUse;
+
+    // equal weights split evenly
+    std::vector<size_t> b = api::DistributeMemory(
+        1000, { DIAMemUse::Max(), DIAMemUse::Max() });
+    ASSERT_EQ(std::vector<size_t>({ 500, 500 }), b);
+
+    // weights split proportionally
+    b = api::DistributeMemory(
+        900, { DIAMemUse::MaxWeighted(2.0), DIAMemUse::Max() });
+    ASSERT_EQ(std::vector<size_t>({ 600, 300 }), b);
+
+    // minimum is granted, preferred caps, excess flows to the others
+    b = api::DistributeMemory(
+        1000, { DIAMemUse::Max(/* min */ 0, /* preferred */ 100),
+                DIAMemUse::Max(/* min */ 400), DIAMemUse::Max() });
+    ASSERT_EQ(std::vector<size_t>({ 100, 650, 250 }), b);
+
+    // all capped: the rest remains unused
+    b = api::DistributeMemory(
+        1000, { DIAMemUse::Max(0, 100), DIAMemUse::Max(0, 200) });
+    ASSERT_EQ(std::vector<size_t>({ 100, 200 }), b);
+
+    // minimums exceeding the memory are scaled down
+    b = api::DistributeMemory(
+        100, { DIAMemUse::Max(100), DIAMemUse::Max(300) });
+    ASSERT_EQ(std::vector<size_t>({ 25, 75 }), b);
+}
+
 /******************************************************************************/
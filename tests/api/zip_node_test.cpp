@@ -99,6 +99,43 @@ TEST(ZipNode, TwoBalancedIntegerArraysNoRebalance) {
     api::RunLocalTests(start_func);
 }
 
+TEST(ZipNode, TwoIntegerArraysShiftedBoundaries) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // numbers 0..999 (evenly distributed to workers)
+            auto zip_input1 = Generate(
+                ctx, test_size,
+                [](size_t index) { return index; });
+
+            // numbers 0..999 again, but distributed like 1001 items, hence
+            // only the items at the workers' boundaries are misplaced.
+            auto zip_input2 =
+                Generate(ctx, test_size + 1,
+                         [](size_t index) { return index; })
+                .Filter([](size_t i) { return i != test_size / 2; })
+                .Map([](size_t i) { return i < test_size / 2 ? i : i - 1; });
+
+            // zip
+            auto zip_result = zip_input1.Zip(
+                zip_input2, [](size_t a, size_t b) -> long {
+                    return static_cast<long>(a) - static_cast<long>(b);
+                });
+
+            // check result
+            std::vector<long> res = zip_result.AllGather();
+
+            ASSERT_EQ(test_size, res.size());
+
+            for (size_t i = 0; i != res.size(); ++i) {
+                ASSERT_EQ(0, res[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(ZipNode, TwoDisbalancedIntegerArrays) {
 
     // first DIA is heavily balanced to the first workers, second DIA is
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * tests/common/accelerator_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/accelerator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace thrill;
+
+//! check that the keys map order-preservingly and back
+template <typename Key>
+static void CheckKeyRoundtrip(const std::vector<Key>& keys) {
+    using Traits = common::AcceleratorKeyTraits<Key>;
+    static_assert(Traits::is_supported, "Key is not supported");
+
+    for (const Key& a : keys) {
+        ASSERT_EQ(a, Traits::FromKey(Traits::ToKey(a)));
+        for (const Key& b : keys)
+            ASSERT_EQ(a < b, Traits::ToKey(a) < Traits::ToKey(b));
+    }
+}
+
+TEST(Accelerator, KeyTraits) {
+    std::default_random_engine rng(std::random_device { } ());
+
+    std::vector<int> ints = { 0, -1, 1, INT32_MIN, INT32_MAX };
+    std::vector<int64_t> longs = { 0, -1, 1, INT64_MIN, INT64_MAX };
+    std::vector<uint32_t> uints = { 0, 1, UINT32_MAX };
+    std::vector<uint64_t> ulongs = { 0, 1, UINT64_MAX };
+    for (size_t i = 0; i < 100; ++i) {
+        ints.push_back(static_cast<int>(rng()));
+        longs.push_back(static_cast<int64_t>((uint64_t(rng()) << 32) | rng()));
+        uints.push_back(static_cast<uint32_t>(rng()));
+        ulongs.push_back((uint64_t(rng()) << 32) | rng());
+    }
+
+    CheckKeyRoundtrip(ints);
+    CheckKeyRoundtrip(longs);
+    CheckKeyRoundtrip(uints);
+    CheckKeyRoundtrip(ulongs);
+
+    static_assert(!common::AcceleratorKeyTraits<bool>::is_supported, "");
+    static_assert(!common::AcceleratorKeyTraits<double>::is_supported, "");
+}
+
+TEST(Accelerator, SumTraits) {
+    using common::AcceleratorSumTraits;
+    static_assert(std::is_same<AcceleratorSumTraits<int>::type,
+                               int32_t>::value, "");
+    static_assert(std::is_same<AcceleratorSumTraits<size_t>::type,
+                               uint64_t>::value, "");
+    static_assert(std::is_same<AcceleratorSumTraits<long long>::type,
+                               int64_t>::value, "");
+    static_assert(std::is_same<AcceleratorSumTraits<float>::type,
+                               float>::value, "");
+    static_assert(!AcceleratorSumTraits<bool>::is_supported, "");
+    static_assert(!AcceleratorSumTraits<int16_t>::is_supported, "");
+}
+
+//! the kernels either run correctly or leave the arrays unchanged
+TEST(Accelerator, SortAndReduce) {
+    static constexpr size_t n = 2 * common::accelerator_min_items;
+    std::default_random_engine rng(std::random_device { } ());
+
+    std::vector<uint64_t> keys(n), orig_keys;
+    std::vector<uint32_t> index(n);
+    std::map<uint64_t, uint64_t> sums;
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = rng() % 1000;
+        index[i] = static_cast<uint32_t>(i);
+        sums[keys[i]] += i;
+    }
+    orig_keys = keys;
+
+    if (common::AcceleratorSortPairs(keys.data(), index.data(), n)) {
+        ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(orig_keys[index[i]], keys[i]);
+    }
+    else {
+        ASSERT_EQ(orig_keys, keys);
+    }
+
+    keys = orig_keys;
+    std::vector<uint64_t> values(n);
+    for (size_t i = 0; i < n; ++i) values[i] = i;
+
+    size_t m = n;
+    if (common::AcceleratorReduceSum(keys.data(), values.data(), &m)) {
+        ASSERT_EQ(sums.size(), m);
+        for (size_t i = 0; i < m; ++i)
+            ASSERT_EQ(sums[keys[i]], values[i]);
+    }
+    else {
+        ASSERT_EQ(n, m);
+        ASSERT_EQ(orig_keys, keys);
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * tests/common/concurrent_mpsc_queue_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/common/concurrent_mpsc_queue.hpp>
+#include <tlx/thread_pool.hpp>
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill::common;
+
+TEST(ConcurrentMpscQueue, ParallelPushPopKeepsProducerOrder) {
+    tlx::ThreadPool pool(8);
+
+    ConcurrentMpscQueue<std::pair<size_t, size_t> > queue;
+    std::atomic<size_t> count(0);
+
+    static constexpr size_t num_threads = 4;
+    static constexpr size_t num_pushes = 10000;
+
+    // have threads push (thread, sequence number) items
+
+    for (size_t t = 0; t != num_threads; ++t) {
+        pool.enqueue([&queue, t]() {
+                         for (size_t i = 0; i != num_pushes; ++i) {
+                             queue.emplace(t, i);
+                         }
+                     });
+    }
+
+    // have one thread pop() items, waiting for new ones as needed, and check
+    // that the items of each thread arrive in order.
+
+    std::vector<size_t> next(num_threads, 0);
+    bool in_order = true;
+
+    pool.enqueue([&]() {
+                     while (count != num_threads * num_pushes) {
+                         std::pair<size_t, size_t> item;
+                         queue.pop(item);
+                         in_order &= (item.second == next[item.first]++);
+                         ++count;
+                     }
+                 });
+
+    pool.loop_until_empty();
+
+    ASSERT_TRUE(queue.empty());
+    ASSERT_TRUE(in_order);
+    ASSERT_EQ(count, num_threads * num_pushes);
+}
+
+TEST(ConcurrentMpscQueue, TryPopAndMove) {
+    ConcurrentMpscQueue<std::string> queue;
+
+    std::string item;
+    ASSERT_FALSE(queue.try_pop(item));
+
+    queue.push("first");
+    queue.emplace(3u, 'x');
+    ASSERT_EQ(2u, queue.size());
+
+    // moved queue takes over all items, the remaining queue is empty
+    ConcurrentMpscQueue<std::string> moved(std::move(queue));
+    ASSERT_TRUE(queue.empty());
+
+    ASSERT_TRUE(moved.try_pop(item));
+    ASSERT_EQ("first", item);
+    moved.pop(item);
+    ASSERT_EQ("xxx", item);
+    ASSERT_TRUE(moved.empty());
+
+    // items left in the queue are destroyed with it
+    moved.push("left");
+}
+
+/******************************************************************************/
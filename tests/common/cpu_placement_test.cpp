@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * tests/common/cpu_placement_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/cpu_placement.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace thrill;
+
+//! two packages with two cores of two hyperthreads each, numbered like Linux
+//! does: the first hyperthreads of all cores, then the second ones.
+static std::vector<common::CpuInfo> SmtTopology() {
+    return std::vector<common::CpuInfo>({
+        { 0, 0, 0 }, { 1, 0, 1 }, { 2, 1, 0 }, { 3, 1, 1 },
+        { 4, 0, 0 }, { 5, 0, 1 }, { 6, 1, 0 }, { 7, 1, 1 }
+    });
+}
+
+TEST(CpuPlacement, Policies) {
+    std::vector<common::CpuInfo> topo = SmtTopology();
+
+    ASSERT_EQ(std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7 }),
+              common::CpuPlacementOrder(common::CpuPlacement::Linear, topo));
+
+    // hyperthread siblings are adjacent
+    ASSERT_EQ(std::vector<size_t>({ 0, 4, 1, 5, 2, 6, 3, 7 }),
+              common::CpuPlacementOrder(common::CpuPlacement::Compact, topo));
+
+    // alternate packages, siblings last
+    ASSERT_EQ(std::vector<size_t>({ 0, 2, 1, 3, 4, 6, 5, 7 }),
+              common::CpuPlacementOrder(common::CpuPlacement::Scatter, topo));
+
+    // one hyperthread per core
+    ASSERT_EQ(std::vector<size_t>({ 0, 1, 2, 3 }),
+              common::CpuPlacementOrder(common::CpuPlacement::Physical, topo));
+}
+
+TEST(CpuPlacement, ParseAndSlots) {
+    common::CpuPlacement p = common::CpuPlacement::Linear;
+    ASSERT_TRUE(common::ParseCpuPlacement("scatter", &p));
+    ASSERT_EQ(common::CpuPlacement::Scatter, p);
+    ASSERT_FALSE(common::ParseCpuPlacement("spread", &p));
+    ASSERT_EQ(common::CpuPlacement::Scatter, p);
+
+    // slots wrap around for all policies
+    for (common::CpuPlacement policy :
+         { common::CpuPlacement::Physical, common::CpuPlacement::Linear }) {
+        common::SetCpuPlacement(policy);
+        size_t slots = common::CpuPlacementSlots();
+        ASSERT_GE(slots, 1u);
+        ASSERT_EQ(common::CpuPlacementCpu(0), common::CpuPlacementCpu(slots));
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * tests/common/cycle_timer_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/common/cycle_timer.hpp>
+
+#include <thread>
+
+using namespace thrill::common;
+
+TEST(CycleTimer, Test1) {
+    CycleTimerBase<true> timer1(/* start_immediately */ false);
+    CycleTimerBase<false> timer2(/* start_immediately */ false);
+
+    timer1.Start();
+    timer2.Start();
+
+    // sleep just once
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    timer1.Stop();
+    timer2.Stop();
+
+    ASSERT_EQ(timer1.Real(), true);
+    ASSERT_EQ(timer2.Real(), false);
+
+    ASSERT_GT(CycleCounterFrequency(), 0.0);
+
+    ASSERT_GT(timer1.Microseconds(), 150000);
+    ASSERT_LT(timer1.Microseconds(), 10000000);
+    ASSERT_EQ(timer2.Microseconds(), 0);
+    ASSERT_EQ(timer2.Cycles(), 0u);
+}
+
+TEST(CycleTimer, AccumulateThreads) {
+    CycleTimer timers[2];
+
+    // each thread accumulates into its own timer
+    std::thread threads[2];
+    for (size_t t = 0; t < 2; ++t) {
+        threads[t] = std::thread(
+            [&timers, t]() {
+                for (size_t i = 0; i < 10; ++i) {
+                    timers[t].Start();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    timers[t].Stop();
+                }
+            });
+    }
+    for (size_t t = 0; t < 2; ++t) threads[t].join();
+
+    CycleTimer total;
+    total += timers[0];
+    total += timers[1];
+    ASSERT_EQ(timers[0].Cycles() + timers[1].Cycles(), total.Cycles());
+    ASSERT_GT(total.Microseconds(), 80000);
+}
+
+/******************************************************************************/
@@ -13,6 +13,10 @@
 #include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
 
+#include <cstring>
+#include <functional>
+#include <string>
+
 using namespace thrill;
 
 template <typename T>
@@ -62,4 +66,47 @@ TEST(Hash, TestCRC32) {
     check_hash(0x3cc762b0, "123456789");
 }
 
+TEST(Hash, TestWyhash) {
+    // test vectors of wyhash final version 4, seeded with their index
+    const char* msgs[] = {
+        "", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "123456789012345678901234567890123456789012345678901234567890"
+        "12345678901234567890"
+    };
+    const uint64_t hashes[] = {
+        0x93228a4de0eec5a2ull, 0xc5bac3db178713c4ull, 0xa97f2f7b1d9b3314ull,
+        0x786d1f1df3801df4ull, 0xdca5a8138ad37c87ull, 0xb9e734f117cfaf70ull,
+        0x6cc5eab49a92d617ull
+    };
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_EQ(hashes[i],
+                  common::HashWyhashBytes(msgs[i], strlen(msgs[i]), i));
+        ASSERT_EQ(hashes[i],
+                  common::HashWyhash<std::string>()(msgs[i], i));
+    }
+}
+
+TEST(Hash, TestHashDefault) {
+    // strings and integers are hashed with wyhash
+    ASSERT_EQ(common::HashWyhashBytes("hello world", 11),
+              common::HashDefault<std::string>()("hello world"));
+    ASSERT_EQ(common::HashWyhash64(42),
+              common::HashDefault<size_t>()(42));
+    ASSERT_NE(common::HashDefault<size_t>()(1),
+              common::HashDefault<size_t>()(2));
+
+    // other types fall back to std::hash
+    ASSERT_EQ(std::hash<double>()(1.5), common::HashDefault<double>()(1.5));
+
+    // consecutive integers spread evenly over the low bits
+    size_t buckets[16] = { 0 };
+    for (size_t i = 0; i < 16000; ++i)
+        ++buckets[common::HashDefault<size_t>()(i) % 16];
+    for (size_t b = 0; b < 16; ++b) {
+        ASSERT_GT(buckets[b], 800u);
+        ASSERT_LT(buckets[b], 1200u);
+    }
+}
+
 /******************************************************************************/
@@ -11,7 +11,11 @@
 #include <thrill/common/json_logger.hpp>
 
 #include <gtest/gtest.h>
+#include <thrill/vfs/temporary_directory.hpp>
 
+#include <fstream>
+#include <regex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -53,4 +57,47 @@ TEST(JsonLogger, Sublogger) {
     sub_sub_logger << "test" << "output";
 }
 
+//! write the same lines with a JsonLogger to path
+static void WriteTestLines(const std::string& path) {
+    common::JsonLogger base_logger(path);
+    common::JsonLogger logger(&base_logger, "host_rank", 3);
+
+    logger << "Node" << "Sort\nNode"
+           << "bool" << false
+           << "int" << -5
+           << "size" << (size_t(1) << 40)
+           << "double" << 1.5
+           << "vector" << std::vector<int>({ 6, -9, 42 })
+           << "plain_array" << (common::Array<size_t>{ 1, 2, 3 });
+
+    common::JsonLine line = logger.line();
+    line << "Node" << "LongerLine";
+    {
+        common::JsonLine subitem = line.sub("sub");
+        subitem << "inside" << std::string("\"stuff\"");
+        subitem.Close();
+    }
+    line << "more" << 42;
+}
+
+TEST(JsonLogger, BinaryToText) {
+    vfs::TemporaryDirectory tmpdir;
+
+    WriteTestLines(tmpdir.get() + "/log.json");
+    WriteTestLines(tmpdir.get() + "/log.tlog");
+
+    std::ifstream json(tmpdir.get() + "/log.json");
+    std::stringstream expected;
+    expected << json.rdbuf();
+
+    std::ifstream tlog(tmpdir.get() + "/log.tlog", std::ios::binary);
+    std::ostringstream converted;
+    ASSERT_TRUE(common::JsonBinaryToText(tlog, converted));
+
+    // timestamps differ
+    std::regex ts("\"ts\":[0-9]+");
+    ASSERT_EQ(std::regex_replace(expected.str(), ts, "ts"),
+              std::regex_replace(converted.str(), ts, "ts"));
+}
+
 /******************************************************************************/
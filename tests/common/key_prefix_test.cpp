@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * tests/common/key_prefix_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/key_prefix.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill;
+
+//! check that the prefixes of all pairs of keys are order-preserving
+template <typename Key>
+static void CheckKeyPrefixOrder(const std::vector<Key>& keys) {
+    using Traits = common::KeyPrefixTraits<Key>;
+    static_assert(Traits::is_prefix_key, "Key has no prefix");
+
+    for (const Key& a : keys) {
+        for (const Key& b : keys) {
+            uint64_t pa = Traits::prefix(a), pb = Traits::prefix(b);
+            if (pa < pb)
+                ASSERT_TRUE(a < b);
+            else if (pb < pa)
+                ASSERT_TRUE(b < a);
+            else if (Traits::is_exact)
+                ASSERT_TRUE(!(a < b) && !(b < a));
+        }
+    }
+}
+
+TEST(KeyPrefix, Integers) {
+    std::default_random_engine rng(std::random_device { } ());
+
+    std::vector<int> ints;
+    std::vector<uint64_t> uints;
+    for (size_t i = 0; i < 200; ++i) {
+        ints.push_back(static_cast<int>(rng()));
+        uints.push_back((uint64_t(rng()) << 32) | rng());
+    }
+    ints.push_back(0), ints.push_back(-1);
+
+    CheckKeyPrefixOrder(ints);
+    CheckKeyPrefixOrder(uints);
+}
+
+TEST(KeyPrefix, StringsAndArrays) {
+    std::default_random_engine rng(std::random_device { } ());
+
+    std::vector<std::string> strings;
+    std::vector<std::array<uint8_t, 10> > arrays;
+    std::vector<std::pair<std::string, size_t> > pairs;
+    for (size_t i = 0; i < 200; ++i) {
+        // small alphabet to get many common prefixes, and some high bytes
+        std::string s(rng() % 12, 0);
+        for (char& c : s)
+            c = static_cast<char>(rng() % 4 ? 'a' + rng() % 3 : rng() % 256);
+        strings.push_back(s);
+
+        std::array<uint8_t, 10> a;
+        for (uint8_t& c : a) c = static_cast<uint8_t>(rng() % 3);
+        arrays.push_back(a);
+
+        pairs.emplace_back(s, rng() % 3);
+    }
+
+    CheckKeyPrefixOrder(strings);
+    CheckKeyPrefixOrder(arrays);
+    CheckKeyPrefixOrder(pairs);
+
+    static_assert(!common::KeyPrefixTraits<double>::is_prefix_key,
+                  "double has no key prefix");
+}
+
+/******************************************************************************/
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * tests/common/log_histogram_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/log_histogram.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace thrill::common;
+
+TEST(LogHistogram, Buckets) {
+    // small values are exact
+    for (uint64_t v = 0; v < LogHistogram::kSubBuckets; ++v) {
+        ASSERT_EQ(v, LogHistogram::Index(v));
+        ASSERT_EQ(v, LogHistogram::LowerBound(LogHistogram::Index(v)));
+    }
+
+    // larger values lie in their bucket, and buckets are consecutive
+    for (uint64_t v = 1; v < (uint64_t(1) << 62); v = v * 3 + 1) {
+        unsigned i = LogHistogram::Index(v);
+        ASSERT_LE(LogHistogram::LowerBound(i), v);
+        ASSERT_GE(LogHistogram::UpperBound(i), v);
+        ASSERT_EQ(LogHistogram::UpperBound(i) + 1,
+                  LogHistogram::LowerBound(i + 1));
+        // relative error below 1 / kSubBuckets
+        ASSERT_LE(LogHistogram::UpperBound(i) - LogHistogram::LowerBound(i),
+                  v / LogHistogram::kSubBuckets);
+    }
+
+    uint64_t max = std::numeric_limits<uint64_t>::max();
+    ASSERT_EQ(LogHistogram::kBuckets - 1, LogHistogram::Index(max));
+    ASSERT_EQ(max, LogHistogram::UpperBound(LogHistogram::kBuckets - 1));
+}
+
+TEST(LogHistogram, Quantiles) {
+    LogHistogram hist;
+    for (uint64_t v = 1; v <= 1000; ++v)
+        hist.Add(v);
+
+    LogHistogram::Snapshot s = hist.GetSnapshot();
+    ASSERT_EQ(1000u, s.count());
+    ASSERT_EQ(500500u, s.sum());
+    ASSERT_DOUBLE_EQ(500.5, s.mean());
+
+    ASSERT_GE(s.Quantile(0.5), 500u);
+    ASSERT_LE(s.Quantile(0.5), 500u + 500u / LogHistogram::kSubBuckets);
+    ASSERT_GE(s.Quantile(0.99), 990u);
+    ASSERT_GE(s.max(), 1000u);
+    ASSERT_LE(s.max(), 1000u + 1000u / LogHistogram::kSubBuckets);
+
+    // difference contains only values recorded in between
+    hist.Add(5);
+    hist.Add(5);
+    LogHistogram::Snapshot d = hist.GetSnapshot() - s;
+    ASSERT_EQ(2u, d.count());
+    ASSERT_EQ(10u, d.sum());
+    ASSERT_EQ(5u, d.Quantile(0.5));
+    ASSERT_EQ(5u, d.max());
+
+    LogHistogram::Snapshot empty;
+    ASSERT_EQ(0u, empty.Quantile(0.5));
+    ASSERT_EQ(0u, empty.max());
+}
+
+/******************************************************************************/
@@ -0,0 +1,37 @@
+/*******************************************************************************
+ * tests/common/perf_counters_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/perf_counters.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace thrill::common;
+
+TEST(PerfCounters, CountLoop) {
+    PerfCounters counters;
+
+    PerfCounters::Values start = counters.Read();
+    volatile size_t sum = 0;
+    for (size_t i = 0; i < 1000000; ++i)
+        sum = sum + i;
+    PerfCounters::Values delta = counters.Read() - start;
+
+    if (counters.available()) {
+        ASSERT_GT(delta.cycles, 0u);
+        ASSERT_GT(delta.instructions, 1000000u);
+        ASSERT_GT(delta.ipc(), 0.0);
+    }
+    else {
+        // counters denied by the kernel read as zero
+        ASSERT_EQ(0u, delta.cycles);
+        ASSERT_EQ(0u, delta.instructions);
+        ASSERT_EQ(0.0, delta.ipc());
+    }
+}
+
+/******************************************************************************/
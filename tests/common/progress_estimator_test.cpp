@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * tests/common/progress_estimator_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/progress_estimator.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace thrill::common;
+
+TEST(ProgressEstimator, RateAndEta) {
+    ProgressEstimator pe;
+    ASSERT_EQ(0.0, pe.rate());
+    ASSERT_EQ(-1.0, pe.eta());
+
+    pe.Update(10.0, 1, 100, 1100);
+    // no rate from a single reading
+    ASSERT_EQ(0.0, pe.rate());
+    ASSERT_EQ(-1.0, pe.eta());
+
+    pe.Update(12.0, 1, 300, 1100);
+    ASSERT_DOUBLE_EQ(100.0, pe.rate());
+    ASSERT_DOUBLE_EQ(8.0, pe.eta());
+    ASSERT_DOUBLE_EQ(300.0 / 1100.0, pe.fraction());
+
+    pe.Update(20.0, 1, 1100, 1100);
+    ASSERT_EQ(0.0, pe.eta());
+    ASSERT_EQ(1.0, pe.fraction());
+}
+
+TEST(ProgressEstimator, UnknownTotal) {
+    ProgressEstimator pe;
+    pe.Update(0.0, 1, 0, 0);
+    pe.Update(4.0, 1, 400, 0);
+    ASSERT_DOUBLE_EQ(100.0, pe.rate());
+    ASSERT_EQ(-1.0, pe.eta());
+    ASSERT_EQ(-1.0, pe.fraction());
+}
+
+TEST(ProgressEstimator, Restart) {
+    ProgressEstimator pe;
+    pe.Update(0.0, 1, 0, 1000);
+    pe.Update(1.0, 1, 500, 1000);
+    ASSERT_DOUBLE_EQ(500.0, pe.rate());
+
+    // a new phase restarts the measurement
+    pe.Update(2.0, 2, 0, 1000);
+    ASSERT_EQ(0.0, pe.rate());
+    pe.Update(4.0, 2, 200, 1000);
+    ASSERT_DOUBLE_EQ(100.0, pe.rate());
+
+    // so does a new pass of the same phase
+    pe.Update(5.0, 2, 50, 1000);
+    ASSERT_EQ(0.0, pe.rate());
+    pe.Update(6.0, 2, 150, 1000);
+    ASSERT_DOUBLE_EQ(100.0, pe.rate());
+}
+
+/******************************************************************************/
@@ -13,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <random>
 #include <vector>
 
@@ -51,4 +52,74 @@ TEST(RadixSort, RandomStrings) {
     ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end()));
 }
 
+TEST(RadixSort, KeyExtractorIntegers) {
+
+    std::default_random_engine rng(std::random_device { } ());
+
+    for (size_t test_size : { 0, 1, 100, 10000, 1024000 }) {
+        std::vector<int64_t> vec(test_size);
+        for (size_t i = 0; i < test_size; ++i)
+            vec[i] = static_cast<int64_t>(rng()) - (1LL << 30);
+
+        common::radix_sort_key(
+            vec.begin(), vec.end(), [](const int64_t& x) { return x; });
+
+        ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end()));
+    }
+}
+
+TEST(RadixSort, KeyExtractorBoundedHashes) {
+
+    std::default_random_engine rng(std::random_device { } ());
+
+    for (size_t key_bound : { 1, 200, 70000, 123456789 }) {
+        std::vector<size_t> vec(100000);
+        for (size_t i = 0; i < vec.size(); ++i)
+            vec[i] = rng() % key_bound;
+
+        std::vector<size_t> check = vec;
+        std::sort(check.begin(), check.end());
+
+        common::radix_sort_key_bounded(
+            vec.begin(), vec.end(), [](const size_t& x) { return x; },
+            key_bound);
+
+        ASSERT_EQ(check, vec);
+    }
+}
+
+struct MyRecord {
+    std::array<uint8_t, 10> key;
+    uint32_t                value;
+};
+
+TEST(RadixSort, KeyExtractorByteArrays) {
+
+    std::default_random_engine rng(std::random_device { } ());
+
+    // generate vector with random 10 byte keys of small alphabet
+    size_t test_size = 1024000 + rng() % 20480;
+    std::vector<MyRecord> vec(test_size);
+
+    for (size_t i = 0; i < test_size; ++i) {
+        for (size_t j = 0; j < 10; ++j)
+            vec[i].key[j] = static_cast<uint8_t>(rng() % 10);
+        vec[i].value = static_cast<uint32_t>(i);
+    }
+
+    // use small LSD block size to exercise the MSD pass
+    common::radix_sort_key(
+        vec.begin(), vec.end(),
+        [](const MyRecord& r) -> const std::array<uint8_t, 10>& {
+            return r.key;
+        },
+        /* block_bytes */ 64 * 1024);
+
+    ASSERT_TRUE(std::is_sorted(
+                    vec.begin(), vec.end(),
+                    [](const MyRecord& a, const MyRecord& b) {
+                        return a.key < b.key;
+                    }));
+}
+
 /******************************************************************************/
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * tests/common/sampling_profiler_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/sampling_profiler.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace thrill::common;
+
+TEST(SamplingProfiler, TagsSamplesWithNode) {
+    std::string path = "sampling_profiler_test.folded";
+    {
+        SamplingProfiler profiler(path, /* frequency */ 1000);
+        if (!profiler.running()) return;
+
+        // burn CPU time inside a tagged scope
+        SamplingProfiler::Scope scope(42, "Busy");
+        volatile size_t sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start
+               < std::chrono::milliseconds(300)) {
+            for (size_t i = 0; i < 10000; ++i) sum = sum + i;
+        }
+
+        std::ostringstream oss;
+        profiler.Write(oss);
+        ASSERT_GT(profiler.num_samples(), 0u);
+    }
+
+    FILE* in = fopen(path.c_str(), "r");
+    ASSERT_TRUE(in != nullptr);
+    char line[4096];
+    size_t tagged = 0;
+    while (fgets(line, sizeof(line), in)) {
+        // collapsed stack: "Busy.42;frame;...;frame count"
+        if (std::string(line).compare(0, 8, "Busy.42;") == 0) ++tagged;
+    }
+    fclose(in);
+    remove(path.c_str());
+
+    ASSERT_GT(tagged, 0u);
+}
+
+/******************************************************************************/
@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * tests/common/spill_disks_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/spill_disks.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+TEST(SpillDisks, ParseList) {
+    std::vector<common::SpillDisk> disks;
+
+    ASSERT_TRUE(common::ParseSpillDisks(
+                    "/mnt/nvme0, /mnt/nvme1:syscall,/mnt/nvme2", &disks));
+    ASSERT_EQ(3u, disks.size());
+    ASSERT_EQ("/mnt/nvme0", disks[0].dir);
+    ASSERT_EQ("", disks[0].io_impl);
+    ASSERT_EQ("/mnt/nvme1", disks[1].dir);
+    ASSERT_EQ("syscall", disks[1].io_impl);
+    ASSERT_EQ("/mnt/nvme2", disks[2].dir);
+
+    ASSERT_FALSE(common::ParseSpillDisks("/mnt/nvme0,,/mnt/nvme1", &disks));
+    ASSERT_FALSE(common::ParseSpillDisks(":linuxaio", &disks));
+}
+
+TEST(SpillDisks, DetectNvmeMounts) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string dir = tmpdir.get();
+    std::string mounts = dir + "/mounts";
+    {
+        std::ofstream out(mounts);
+        out << "/dev/sda1 / ext4 rw,relatime 0 0\n"
+            << "/dev/nvme0n1p1 " << dir << " ext4 rw,noatime 0 0\n"
+            << "/dev/nvme0n1p2 /second/partition ext4 rw 0 0\n"
+            << "/dev/nvme1n1 /read/only xfs ro,noatime 0 0\n"
+            << "/dev/nvme2n1 /does/not/exist xfs rw 0 0\n"
+            << "tmpfs /tmp tmpfs rw 0 0\n";
+    }
+
+    std::vector<common::SpillDisk> disks = common::DetectSpillDisks(mounts);
+    ASSERT_EQ(1u, disks.size());
+    ASSERT_EQ(dir, disks[0].dir);
+    ASSERT_EQ("", disks[0].io_impl);
+}
+
+/******************************************************************************/
@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 #include <thrill/common/thread_barrier.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdlib>
@@ -74,4 +75,40 @@ TEST(ThreadBarrier, TestWaitFor) {
     TestWaitFor(32);
 }
 
+TEST(ThreadBarrier, AdaptiveManyRounds) {
+    // more threads than cores, such that waiting threads must park
+    size_t count = 2 * std::max(std::thread::hardware_concurrency(), 2u);
+    size_t rounds = 1000;
+
+    ThreadBarrierAdaptive barrier(count);
+    std::atomic<size_t> arrived { 0 };
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < count; i++) {
+        threads.emplace_back(
+            [&, i]() {
+                for (size_t r = 0; r < rounds; r++) {
+                    if (i == r % count) {
+                        std::this_thread::sleep_for(
+                            std::chrono::microseconds(100));
+                    }
+                    ++arrived;
+                    // the lambda runs once all threads arrived
+                    barrier.wait(
+                        [&]() { ASSERT_EQ((r + 1) * count, arrived.load()); });
+                    ASSERT_LE((r + 1) * count, arrived.load());
+                    ASSERT_LE(r + 1, barrier.step());
+                }
+            });
+    }
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    ASSERT_EQ(rounds, barrier.step());
+    ASSERT_GE(barrier.spin_limit(), ThreadBarrierAdaptive::min_spins_);
+    ASSERT_LE(barrier.spin_limit(), ThreadBarrierAdaptive::max_spins_);
+}
+
 /******************************************************************************/
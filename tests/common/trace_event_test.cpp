@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * tests/common/trace_event_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/common/trace_event.hpp>
+
+#include <thread>
+
+using namespace thrill::common;
+
+TEST(TraceEvent, ThreadIds) {
+    uint32_t tid = TraceThreadId();
+    ASSERT_EQ(tid, TraceThreadId());
+
+    uint32_t other_tid = tid;
+    std::thread thread([&other_tid]() { other_tid = TraceThreadId(); });
+    thread.join();
+    ASSERT_NE(tid, other_tid);
+}
+
+TEST(TraceEvent, ScopesWithoutOutput) {
+    // a logger without output discards the events, if they are enabled
+    JsonLogger logger;
+    {
+        TraceScope scope(logger, "test", "scope");
+        TraceEvent(logger, 'b', "test", "async", 42);
+        TraceEvent(logger, 'e', "test", "async", 42);
+    }
+}
+
+/******************************************************************************/
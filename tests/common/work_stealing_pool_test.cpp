@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * tests/common/work_stealing_pool_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/work_stealing_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace thrill;
+
+TEST(WorkStealingPool, RunOwnTasks) {
+
+    common::WorkStealingPool pool(4);
+    common::WorkStealingPool::TaskGroup group;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < 10; ++i)
+        pool.Submit(2, group, [&order, i]() { order.push_back(i); });
+
+    ASSERT_FALSE(group.done());
+    pool.Wait(2, group);
+    ASSERT_TRUE(group.done());
+
+    // own tasks are run newest first
+    ASSERT_EQ(10u, order.size());
+    for (size_t i = 0; i < 10; ++i)
+        ASSERT_EQ(9 - i, order[i]);
+
+    ASSERT_FALSE(pool.RunOne(2));
+    ASSERT_EQ(0u, pool.steals());
+}
+
+TEST(WorkStealingPool, StealFromStraggler) {
+
+    static constexpr size_t num_workers = 4;
+    static constexpr size_t num_tasks = 1000;
+
+    common::WorkStealingPool pool(num_workers);
+
+    // worker 0 has all the tasks, the others have one group each with only a
+    // single task and then steal from worker 0 while waiting.
+    common::WorkStealingPool::TaskGroup straggler;
+    std::vector<std::atomic<size_t> > runs(num_tasks);
+    std::atomic<size_t> done_by_others { 0 };
+
+    for (size_t i = 0; i < num_tasks; ++i) {
+        pool.Submit(0, straggler, [&runs, i]() {
+                        runs[i]++;
+                        std::this_thread::yield();
+                    });
+    }
+
+    std::atomic<bool> straggler_done { false };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < num_workers; ++w) {
+        threads.emplace_back(
+            [&, w]() {
+                common::WorkStealingPool::TaskGroup group;
+                pool.Submit(w, group, [&done_by_others]() {
+                                done_by_others++;
+                            });
+                pool.Wait(w, group);
+
+                // help until the straggler is finished
+                while (!straggler_done) {
+                    if (!pool.RunOne(w))
+                        std::this_thread::yield();
+                }
+            });
+    }
+
+    pool.Wait(0, straggler);
+    straggler_done = true;
+
+    for (std::thread& t : threads)
+        t.join();
+
+    for (size_t i = 0; i < num_tasks; ++i)
+        ASSERT_EQ(1u, runs[i]);
+    ASSERT_EQ(num_workers - 1, done_by_others.load());
+    for (size_t w = 0; w < num_workers; ++w)
+        ASSERT_FALSE(pool.RunOne(w));
+}
+
+/******************************************************************************/
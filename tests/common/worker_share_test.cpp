@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * tests/common/worker_share_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/worker_share.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace thrill;
+
+TEST(WorkerShare, BorrowFairShare) {
+
+    common::WorkerShare share(8);
+
+    // no one is busy: cores of all others can be borrowed
+    {
+        common::WorkerShare::BusyScope busy(share, 3);
+        ASSERT_EQ(1u, share.num_busy());
+
+        std::vector<size_t> cores = share.Borrow(100);
+        ASSERT_EQ(7u, cores.size());
+        for (const size_t& c : cores)
+            ASSERT_NE(3u, c);
+
+        // all cores are lent
+        ASSERT_EQ(0u, share.Borrow(100).size());
+        share.Return(cores);
+    }
+    ASSERT_EQ(0u, share.num_busy());
+
+    // two busy workers share the six idle cores
+    share.SetBusy(0, true);
+    share.SetBusy(1, true);
+
+    std::vector<size_t> cores0 = share.Borrow(100);
+    ASSERT_EQ(3u, cores0.size());
+
+    std::vector<size_t> cores1 = share.Borrow(2);
+    ASSERT_EQ(2u, cores1.size());
+
+    // a worker becoming busy does not get lent cores
+    share.SetBusy(7, true);
+    std::vector<size_t> cores7 = share.Borrow(100);
+    ASSERT_LE(cores7.size(), 1u);
+
+    share.Return(cores0);
+    share.Return(cores1);
+    share.Return(cores7);
+
+    share.SetBusy(0, false);
+    share.SetBusy(1, false);
+    share.SetBusy(7, false);
+    ASSERT_EQ(0u, share.num_busy());
+}
+
+/******************************************************************************/
@@ -233,4 +233,37 @@ TEST(DuplicateDetection, AllDuplicatedHash) {
     api::RunLocalTests(start_func);
 }
 
+TEST(DuplicateDetection, RiceCoderMatchesGolombCoder) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t elements = 5000;
+
+            // overlapping pseudo-random hashes with large and small gaps
+            std::vector<size_t> hashes;
+            for (size_t i = 0; i < elements; ++i) {
+                hashes.push_back(
+                    ((i + ctx.my_rank() * 1000) * 2654435761u) % 1000003);
+            }
+
+            std::vector<size_t> hashes_rice = hashes;
+            std::vector<bool> non_duplicates, non_duplicates_rice;
+
+            core::DuplicateDetection duplicate_detection;
+
+            size_t max_hash =
+                duplicate_detection.FindNonDuplicates<core::GolombCoder>(
+                    non_duplicates, hashes, ctx, 0);
+
+            size_t max_hash_rice =
+                duplicate_detection.FindNonDuplicates<core::RiceCoder>(
+                    non_duplicates_rice, hashes_rice, ctx, 0);
+
+            ASSERT_EQ(max_hash, max_hash_rice);
+            ASSERT_EQ(non_duplicates, non_duplicates_rice);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
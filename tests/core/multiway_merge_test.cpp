@@ -17,6 +17,7 @@
 #include <thrill/common/logger.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <random>
@@ -87,4 +88,88 @@ TEST_F(MultiwayMerge, GetMultiwayMergePuller) {
     ASSERT_FALSE(puller.HasNext());
 }
 
+TEST_F(MultiwayMerge, PrefixMergeOfRawItemsInBatches) {
+    using Item = std::pair<uint64_t, uint64_t>;
+    static constexpr size_t num_files = 5;
+    static constexpr size_t size = 3000;
+
+    std::mt19937 gen(0);
+    std::vector<data::File> in;
+    std::vector<Item> ref;
+    in.reserve(num_files);
+
+    // small blocks, such that batches of items cross block boundaries.
+    for (size_t i = 0; i < num_files; ++i) {
+        std::vector<Item> tmp;
+        for (size_t j = 0; j < size; ++j)
+            tmp.emplace_back(gen() % 1000, ref.size() + tmp.size());
+        std::sort(tmp.begin(), tmp.end());
+        ref.insert(ref.end(), tmp.begin(), tmp.end());
+
+        in.emplace_back(block_pool_, 0, /* dia_id */ 0);
+        data::File::Writer w = in.back().GetWriter(100);
+        for (const Item& t : tmp) w.Put(t);
+    }
+    std::sort(ref.begin(), ref.end());
+
+    std::vector<data::File::ConsumeReader> seq;
+    for (size_t t = 0; t < in.size(); ++t)
+        seq.emplace_back(in[t].GetConsumeReader());
+
+    auto puller = core::make_prefix_multiway_merge_tree<
+        Item, /* Stable */ false, /* ExactPrefix */ false>(
+        seq.begin(), seq.end(), std::less<Item>(),
+        [](const Item& i) { return i.first; });
+
+    for (size_t i = 0; i < ref.size(); ++i) {
+        ASSERT_TRUE(puller.HasNext());
+        ASSERT_EQ(ref[i], puller.Next());
+    }
+    ASSERT_FALSE(puller.HasNext());
+}
+
+TEST_F(MultiwayMerge, LazyMergeComparesKeysInBlocks) {
+    using Item = std::pair<uint64_t, uint64_t>;
+    static constexpr size_t num_files = 5;
+    static constexpr size_t size = 3000;
+
+    // unique keys distributed randomly over the files
+    std::vector<uint64_t> keys(num_files * size);
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = i;
+    std::mt19937 gen(0);
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    std::vector<data::File> in;
+    std::vector<Item> ref;
+    in.reserve(num_files);
+
+    // small blocks, such that some items are split between blocks.
+    for (size_t i = 0; i < num_files; ++i) {
+        std::vector<Item> tmp;
+        for (size_t j = 0; j < size; ++j)
+            tmp.emplace_back(keys[i * size + j], gen());
+        std::sort(tmp.begin(), tmp.end());
+        ref.insert(ref.end(), tmp.begin(), tmp.end());
+
+        in.emplace_back(block_pool_, 0, /* dia_id */ 0);
+        data::File::Writer w = in.back().GetWriter(100);
+        for (const Item& t : tmp) w.Put(t);
+    }
+    std::sort(ref.begin(), ref.end());
+
+    std::vector<data::File::ConsumeReader> seq;
+    for (size_t t = 0; t < in.size(); ++t)
+        seq.emplace_back(in[t].GetConsumeReader());
+
+    auto puller = core::make_lazy_multiway_merge_tree<Item>(
+        seq.begin(), seq.end(),
+        data::LazyField<Item, uint64_t, &Item::first>());
+
+    for (size_t i = 0; i < ref.size(); ++i) {
+        ASSERT_TRUE(puller.HasNext());
+        ASSERT_EQ(ref[i], puller.Next());
+    }
+    ASSERT_FALSE(puller.HasNext());
+}
+
 /******************************************************************************/
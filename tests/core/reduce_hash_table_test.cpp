@@ -12,12 +12,17 @@
 #include <thrill/core/reduce_bucket_hash_table.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_robin_hood_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
+#include <thrill/core/reduce_soa_probing_hash_table.hpp>
 
 #include <thrill/core/reduce_pre_phase.hpp>
 
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <utility>
 #include <vector>
@@ -136,6 +141,20 @@ TEST(ReduceHashTable, ProbingAddIntegers) {
         });
 }
 
+TEST(ReduceHashTable, SimdProbingAddIntegers) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructModulo<core::ReduceSimdProbingHashTable>(ctx);
+        });
+}
+
+TEST(ReduceHashTable, RobinHoodAddIntegers) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructModulo<core::ReduceRobinHoodHashTable>(ctx);
+        });
+}
+
 TEST(ReduceHashTable, OldProbingAddIntegers) {
     api::RunLocalSameThread(
         [](Context& ctx) {
@@ -143,4 +162,103 @@ TEST(ReduceHashTable, OldProbingAddIntegers) {
         });
 }
 
+TEST(ReduceHashTable, SoaProbingAddIntegers) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructModulo<core::ReduceSoaProbingHashTable>(ctx);
+        });
+}
+
+//! Insert (key, value) pairs with VolatileKey into the SoA table, whose plain
+//! reduce functions are accumulated in place.
+template <typename Value, typename ReduceFunction, typename MakeValue>
+void TestSoaProbingNativePairs(Context& ctx, const MakeValue& make_value,
+                               const ReduceFunction& red_fn) {
+    static constexpr size_t test_size = 50000;
+    static constexpr size_t mod_size = 500;
+
+    using TableItem = std::pair<size_t, Value>;
+
+    auto key_ex = [](const Value&) { return size_t(0); };
+
+    using Collector = TableCollector<TableItem>;
+
+    Collector collector(13);
+
+    using Table = core::ReduceSoaProbingHashTable<
+        TableItem, size_t, Value,
+        decltype(key_ex), ReduceFunction, Collector,
+        /* VolatileKey */ true, MyReduceConfig, core::ReduceByHash<size_t> >;
+
+    static_assert(Table::native_accumulate,
+                  "reduce function must be accumulated in place");
+
+    Table table(ctx, 0, key_ex, red_fn, collector,
+                /* num_partitions */ 13,
+                typename Table::ReduceConfig(),
+                /* immediate_flush */ true);
+    table.Initialize(/* limit_memory_bytes */ 1024 * 1024);
+
+    // key zero is the sentinel key, which the table reduces separately
+    for (size_t i = 0; i < test_size; ++i) {
+        table.Insert(TableItem(i % mod_size, make_value(i / mod_size)));
+    }
+
+    table.FlushAll();
+
+    std::vector<TableItem> result;
+    for (const auto& partition : collector) {
+        result.insert(result.end(), partition.begin(), partition.end());
+    }
+    std::sort(result.begin(), result.end(),
+              [](const TableItem& a, const TableItem& b) {
+                  return a.first < b.first;
+              });
+
+    // each key got the values 0..test_size / mod_size - 1 in order
+    Value expected = make_value(0);
+    for (size_t j = 1; j < test_size / mod_size; ++j)
+        expected = red_fn(expected, make_value(j));
+
+    ASSERT_EQ(mod_size, result.size());
+
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(i, result[i].first);
+        ASSERT_EQ(expected, result[i].second);
+    }
+}
+
+TEST(ReduceHashTable, SoaProbingNativeSum) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestSoaProbingNativePairs<size_t>(
+                ctx, [](size_t v) { return v; }, std::plus<size_t>());
+        });
+}
+
+TEST(ReduceHashTable, SoaProbingNativeMax) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestSoaProbingNativePairs<double>(
+                ctx, [](size_t v) { return static_cast<double>(v); },
+                common::maximum<double>());
+        });
+}
+
+TEST(ReduceHashTable, SoaProbingNativeComponentSum) {
+    using Counters = std::array<uint32_t, 8>;
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestSoaProbingNativePairs<Counters>(
+                ctx,
+                [](size_t v) {
+                    Counters c;
+                    for (size_t i = 0; i < c.size(); ++i)
+                        c[i] = static_cast<uint32_t>(v * i);
+                    return c;
+                },
+                common::ComponentSum<Counters>());
+        });
+}
+
 /******************************************************************************/
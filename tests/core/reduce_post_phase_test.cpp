@@ -111,6 +111,95 @@ TEST(ReduceHashPhase, ProbingAddMyStructByHash) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, RobinHoodAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::ROBIN_HOOD>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, SoaProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SOA_PROBING>(ctx);
+        });
+}
+
+//! many more distinct keys than fit into the table, such that partitions are
+//! spilled and re-reduced.
+static void TestAddMyStructByHashSpilled(Context& ctx) {
+    static constexpr size_t mod_size = 40000;
+    static constexpr size_t val_size = 4;
+    static constexpr size_t test_size = mod_size * val_size;
+
+    auto key_ex = [](const MyStruct& in) {
+                      return in.key % mod_size;
+                  };
+
+    auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                      return MyStruct {
+                          in1.key, in1.value + in2.value
+                      };
+                  };
+
+    std::vector<MyStruct> result;
+
+    auto emit_fn = [&result](const MyStruct& in) {
+                       result.emplace_back(in);
+                   };
+
+    using Phase = core::ReduceByHashPostPhase<
+        MyStruct, size_t, MyStruct,
+        decltype(key_ex), decltype(red_fn), decltype(emit_fn),
+        /* VolatileKey */ false,
+        core::DefaultReduceConfigSelect<core::ReduceTableImpl::PROBING> >;
+
+    Phase phase(ctx, 0, key_ex, red_fn, emit_fn);
+    phase.Initialize(/* limit_memory_bytes */ 64 * 1024);
+
+    for (size_t i = 0; i < test_size; ++i) {
+        phase.Insert(MyStruct { i, i / mod_size });
+    }
+
+    phase.PushData(/* consume */ true);
+
+    std::sort(result.begin(), result.end(),
+              [](const MyStruct& a, const MyStruct& b) {
+                  return a.key % mod_size < b.key % mod_size;
+              });
+
+    ASSERT_EQ(mod_size, result.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(i, result[i].key % mod_size);
+        ASSERT_EQ(val_size * (val_size - 1) / 2, result[i].value);
+    }
+}
+
+TEST(ReduceHashPhase, ProbingAddMyStructByHashSpilled) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHashSpilled(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, ProbingAddMyStructByHashSpilledParallel) {
+    // several workers on one host: those which finish early lend their cores
+    // to re-reduce the spilled partitions of the others in parallel.
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+
+    api::RunLocalMock(mem_config, 1, 4, [](Context& ctx) {
+                          TestAddMyStructByHashSpilled(ctx);
+                      });
+}
+
 /******************************************************************************/
 
 TEST(ReduceHashPhase, PostReduceByIndex) {
@@ -223,6 +312,27 @@ TEST(ReduceHashPhase, ProbingAddMyStructByIndex) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, RobinHoodAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::ROBIN_HOOD>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, SoaProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SOA_PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
 
 template <core::ReduceTableImpl table_impl>
@@ -306,4 +416,25 @@ TEST(ReduceHashPhase, ProbingAddMyStructByIndexWithHoles) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByIndexWithHoles) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, RobinHoodAddMyStructByIndexWithHoles) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<core::ReduceTableImpl::ROBIN_HOOD>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, SoaProbingAddMyStructByIndexWithHoles) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<core::ReduceTableImpl::SOA_PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
@@ -126,6 +126,27 @@ TEST(ReducePrePhase, ProbingAddMyStructByHash) {
         });
 }
 
+TEST(ReducePrePhase, SimdProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, RobinHoodAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::ROBIN_HOOD>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, SoaProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SOA_PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
 
 template <core::ReduceTableImpl table_impl>
@@ -217,4 +238,343 @@ TEST(ReducePrePhase, ProbingAddMyStructByIndex) {
         });
 }
 
+TEST(ReducePrePhase, SimdProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, RobinHoodAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::ROBIN_HOOD>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, SoaProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SOA_PROBING>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, DenseAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::DENSE>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, DenseAddMyStructByIndexEvicting) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            static constexpr size_t mod_size = 60100;
+            static constexpr size_t val_size = 5;
+            static constexpr size_t test_size = mod_size * val_size;
+
+            auto key_ex = [](const MyStruct& in) {
+                              return in.key % mod_size;
+                          };
+
+            auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                              return MyStruct {
+                                  in1.key, in1.value + in2.value
+                              };
+                          };
+
+            const size_t num_partitions = 13;
+
+            std::vector<data::File> files;
+            for (size_t i = 0; i < num_partitions; ++i)
+                files.emplace_back(ctx.GetFile(nullptr));
+
+            std::vector<data::File::Writer> emitters;
+            for (size_t i = 0; i < num_partitions; ++i)
+                emitters.emplace_back(files[i].GetWriter());
+
+            using Phase = core::ReducePrePhase<
+                MyStruct, size_t, MyStruct,
+                decltype(key_ex), decltype(red_fn),
+                /* VolatileKey */ false,
+                data::File::Writer,
+                core::DefaultReduceConfigSelect<core::ReduceTableImpl::DENSE>,
+                core::ReduceByIndex<size_t> >;
+
+            Phase phase(ctx, 0,
+                        num_partitions,
+                        key_ex, red_fn, emitters,
+                        typename Phase::ReduceConfig(),
+                        core::ReduceByIndex<size_t>(0, mod_size));
+
+            // the index range does not fit, hence items evict each other
+            phase.Initialize(/* limit_memory_bytes */ 64 * 1024);
+
+            for (size_t i = 0; i < test_size; ++i) {
+                // interleave keys to cause collisions of partially reduced
+                // items in the direct-mapped slots
+                phase.Insert(MyStruct { i * 7919 % test_size, 1 });
+            }
+
+            phase.FlushAll();
+            phase.CloseAll();
+
+            // sum up partial results per key
+            std::vector<size_t> sums(mod_size);
+            for (size_t i = 0; i < num_partitions; ++i) {
+                data::File::Reader r = files[i].GetReader(/* consume */ true);
+                while (r.HasNext()) {
+                    MyStruct m = r.Next<MyStruct>();
+                    sums[m.key % mod_size] += m.value;
+                }
+            }
+
+            for (size_t i = 0; i < mod_size; ++i)
+                ASSERT_EQ(val_size, sums[i]);
+        });
+}
+
+/******************************************************************************/
+
+struct MyKeyDomainReduceConfig : public core::DefaultReduceConfig {
+    explicit MyKeyDomainReduceConfig(size_t key_domain_size) {
+        key_domain_size_ = key_domain_size;
+    }
+};
+
+//! reduce pairs whose keys mostly lie in a small domain given as hint
+static void TestKeyDomain(Context& ctx, size_t key_domain_size, bool direct) {
+    static constexpr size_t test_size = 20000;
+    static constexpr size_t mod_size = 168;
+
+    using IntPair = std::pair<size_t, size_t>;
+
+    auto key_ex = [](const IntPair& p) { return p.first; };
+
+    auto red_fn = [](const size_t& a, const size_t& b) { return a + b; };
+
+    const size_t num_partitions = 13;
+
+    std::vector<data::File> files;
+    for (size_t i = 0; i < num_partitions; ++i)
+        files.emplace_back(ctx.GetFile(nullptr));
+
+    std::vector<data::File::Writer> emitters;
+    for (size_t i = 0; i < num_partitions; ++i)
+        emitters.emplace_back(files[i].GetWriter());
+
+    using Phase = core::ReducePrePhase<
+        IntPair, size_t, IntPair,
+        decltype(key_ex), decltype(red_fn),
+        /* VolatileKey */ true, data::File::Writer,
+        MyKeyDomainReduceConfig>;
+
+    Phase phase(ctx, 0, num_partitions, key_ex, red_fn, emitters,
+                MyKeyDomainReduceConfig(key_domain_size));
+
+    phase.Initialize(/* limit_memory_bytes */ 1024 * 1024);
+    ASSERT_EQ(direct, phase.direct());
+
+    // every tenth key lies beyond the domain and goes into the hash table
+    for (size_t i = 0; i < test_size; ++i) {
+        size_t key = i % 10 == 0 ? mod_size + i % 100 : i % mod_size;
+        phase.Insert(IntPair(key, 1));
+    }
+
+    phase.FlushAll();
+    phase.CloseAll();
+
+    // each key is emitted exactly once, to the partition of its hash
+    core::ReduceByHash<size_t> index_function;
+    std::vector<size_t> count(mod_size + 100);
+    for (size_t i = 0; i < num_partitions; ++i) {
+        data::File::Reader r = files[i].GetReader(/* consume */ true);
+        while (r.HasNext()) {
+            IntPair p = r.Next<IntPair>();
+            ASSERT_EQ(0u, count[p.first]);
+            ASSERT_EQ(i, index_function(p.first, num_partitions, 0, 0)
+                      .partition_id);
+            count[p.first] = p.second;
+        }
+    }
+
+    std::vector<size_t> expected(mod_size + 100);
+    for (size_t i = 0; i < test_size; ++i)
+        ++expected[i % 10 == 0 ? mod_size + i % 100 : i % mod_size];
+
+    ASSERT_EQ(expected, count);
+}
+
+TEST(ReducePrePhase, KeyDomainFlatArray) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestKeyDomain(ctx, /* key_domain_size */ 168, /* direct */ true);
+        });
+}
+
+TEST(ReducePrePhase, KeyDomainTooLarge) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestKeyDomain(ctx, /* key_domain_size */ 1u << 30,
+                          /* direct */ false);
+        });
+}
+
+/******************************************************************************/
+
+struct MyBypassReduceConfig : public core::DefaultReduceConfig {
+    MyBypassReduceConfig() {
+        bypass_sample_items_ = 1000;
+        bypass_reduction_threshold_ = 0.1;
+    }
+};
+
+static void TestAdaptiveBypass(Context& ctx, size_t mod_size, bool bypass) {
+    static constexpr size_t test_size = 20000;
+
+    auto key_ex = [mod_size](const MyStruct& in) {
+                      return in.key % mod_size;
+                  };
+
+    auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                      return MyStruct {
+                          in1.key, in1.value + in2.value
+                      };
+                  };
+
+    const size_t num_partitions = 13;
+
+    std::vector<data::File> files;
+    for (size_t i = 0; i < num_partitions; ++i)
+        files.emplace_back(ctx.GetFile(nullptr));
+
+    std::vector<data::File::Writer> emitters;
+    for (size_t i = 0; i < num_partitions; ++i)
+        emitters.emplace_back(files[i].GetWriter());
+
+    using Phase = core::ReducePrePhase<
+        MyStruct, size_t, MyStruct,
+        decltype(key_ex), decltype(red_fn),
+        /* VolatileKey */ false, data::File::Writer,
+        MyBypassReduceConfig>;
+
+    Phase phase(ctx, 0, num_partitions, key_ex, red_fn, emitters);
+
+    phase.Initialize(/* limit_memory_bytes */ 1024 * 1024);
+
+    for (size_t i = 0; i < test_size; ++i) {
+        phase.Insert(MyStruct { i, 1 });
+    }
+
+    ASSERT_EQ(bypass, phase.bypass());
+
+    phase.FlushAll();
+    phase.CloseAll();
+
+    // sum up partially reduced items, the total count must be unchanged
+    std::vector<size_t> count(mod_size);
+    size_t items = 0;
+
+    for (size_t i = 0; i < num_partitions; ++i) {
+        data::File::Reader r = files[i].GetReader(/* consume */ true);
+        while (r.HasNext()) {
+            MyStruct m = r.Next<MyStruct>();
+            count[m.key % mod_size] += m.value;
+            ++items;
+        }
+    }
+
+    if (!bypass)
+        ASSERT_EQ(mod_size, items);
+
+    for (size_t i = 0; i < mod_size; ++i)
+        ASSERT_EQ(test_size / mod_size, count[i]);
+}
+
+TEST(ReducePrePhase, AdaptiveBypassUniqueKeys) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAdaptiveBypass(ctx, /* mod_size */ 20000, /* bypass */ true);
+        });
+}
+
+TEST(ReducePrePhase, AdaptiveBypassReducingKeys) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAdaptiveBypass(ctx, /* mod_size */ 100, /* bypass */ false);
+        });
+}
+
+struct MyEstimatedReduceConfig : public MyBypassReduceConfig {
+    explicit MyEstimatedReduceConfig(size_t estimated_keys) {
+        estimated_keys_ = estimated_keys;
+        estimate_keys_ = true;
+    }
+};
+
+TEST(ReducePrePhase, EstimatedKeysFitDisableBypass) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            static constexpr size_t test_size = 20000;
+            static constexpr size_t mod_size = 5000;
+
+            auto key_ex = [](const MyStruct& in) {
+                              return in.key % mod_size;
+                          };
+
+            auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                              return MyStruct {
+                                  in1.key, in1.value + in2.value
+                              };
+                          };
+
+            const size_t num_partitions = 13;
+
+            std::vector<data::File> files;
+            for (size_t i = 0; i < num_partitions; ++i)
+                files.emplace_back(ctx.GetFile(nullptr));
+
+            std::vector<data::File::Writer> emitters;
+            for (size_t i = 0; i < num_partitions; ++i)
+                emitters.emplace_back(files[i].GetWriter());
+
+            using Phase = core::ReducePrePhase<
+                MyStruct, size_t, MyStruct,
+                decltype(key_ex), decltype(red_fn),
+                /* VolatileKey */ false, data::File::Writer,
+                MyEstimatedReduceConfig>;
+
+            // the sample alone would bypass the table: all of its items have
+            // new keys.
+            Phase phase(ctx, 0, num_partitions, key_ex, red_fn, emitters,
+                        MyEstimatedReduceConfig(mod_size));
+
+            phase.Initialize(/* limit_memory_bytes */ 1024 * 1024);
+
+            for (size_t i = 0; i < test_size; ++i) {
+                phase.Insert(MyStruct { i, 1 });
+            }
+
+            ASSERT_FALSE(phase.bypass());
+
+            // HyperLogLog with 2^14 registers has about 1% standard error
+            double estimate = static_cast<double>(phase.estimated_keys());
+            ASSERT_NEAR(1.0, estimate / mod_size, 0.05);
+
+            phase.FlushAll();
+            phase.CloseAll();
+
+            size_t items = 0;
+            for (size_t i = 0; i < num_partitions; ++i) {
+                data::File::Reader r = files[i].GetReader(/* consume */ true);
+                while (r.HasNext()) {
+                    MyStruct m = r.Next<MyStruct>();
+                    ASSERT_EQ(test_size / mod_size, m.value);
+                    ++items;
+                }
+            }
+            ASSERT_EQ(mod_size, items);
+        });
+}
+
 /******************************************************************************/
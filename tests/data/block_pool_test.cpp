@@ -11,8 +11,14 @@
 #include <gtest/gtest.h>
 #include <thrill/data/block.hpp>
 #include <thrill/data/block_pool.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
 #include <string>
+#include <vector>
 
 using namespace thrill;
 
@@ -109,4 +115,121 @@ TEST_F(BlockPoolTest, EvictBlock) {
     ASSERT_EQ(0u, block_pool_.writing_blocks() + block_pool_.swapped_blocks());
 }
 
+TEST_F(BlockPoolTest, JobResidentBytes) {
+    data::Block unpinned_block;
+    {
+        data::BlockPool::JobScope scope(3);
+        data::PinnedByteBlockPtr block = block_pool_.AllocateByteBlock(4096, 0);
+        ASSERT_EQ(3u, block->job_id());
+        data::PinnedBlock pinned_block(std::move(block), 0, 4096, 0, 0, false);
+        unpinned_block = pinned_block.ToBlock();
+    }
+    block_pool_.SetJobQuota(3, 8192);
+    ASSERT_EQ(4096u, block_pool_.job_resident_bytes(3));
+    ASSERT_EQ(0u, block_pool_.job_resident_bytes(0));
+
+    // the block leaves RAM when evicted, and counts again when swapped in
+    block_pool_.EvictBlock(unpinned_block.byte_block().get());
+    ASSERT_EQ(0u, block_pool_.job_resident_bytes(3));
+    {
+        data::PinnedBlock pinned = unpinned_block.PinWait(0);
+        ASSERT_EQ(4096u, block_pool_.job_resident_bytes(3));
+    }
+
+    block_pool_.ReleaseJob(3);
+    unpinned_block = data::Block();
+    ASSERT_EQ(0u, block_pool_.job_resident_bytes(3));
+}
+
+TEST(BlockPool, EvictCompressedBlock) {
+    // block pool compressing evicted blocks, if compression is available.
+    data::BlockPool block_pool(0, 0, nullptr, nullptr, 1, true);
+
+    static constexpr size_t size = 65536;
+    data::Block unpinned_block;
+    {
+        data::PinnedByteBlockPtr block = block_pool.AllocateByteBlock(size, 0);
+        for (size_t i = 0; i < size; ++i)
+            block->data()[i] = static_cast<data::Byte>(i % 13);
+        data::PinnedBlock pinned_block(std::move(block), 0, size, 0, 0, false);
+        unpinned_block = pinned_block.ToBlock();
+    }
+    block_pool.EvictBlock(unpinned_block.byte_block().get());
+    ASSERT_EQ(0u, block_pool.unpinned_blocks());
+
+    // swap block back in and check its contents
+    data::PinnedBlock pinned = unpinned_block.PinWait(0);
+    ASSERT_EQ(1u, block_pool.pinned_blocks());
+    for (size_t i = 0; i < size; ++i)
+        ASSERT_EQ(i % 13, pinned.data_begin()[i]);
+}
+
+TEST_F(BlockPoolTest, MmapExternalBlock) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string path = tmpdir.get() + "/test.dat";
+
+    static constexpr size_t size = 100000;
+    {
+        std::ofstream of(path);
+        for (size_t i = 0; i < size; ++i)
+            of.put(static_cast<char>(i % 251));
+    }
+
+    {
+        // map an unaligned range, the file may be closed afterwards.
+        int fd = ::open(path.c_str(), O_RDONLY);
+        ASSERT_GE(fd, 0);
+        data::ByteBlockPtr bbp = block_pool_.MmapExternalBlock(fd, 5000, 20000);
+        ::close(fd);
+
+        ASSERT_TRUE(bbp->is_ext_mapped());
+        ASSERT_EQ(20000u, block_pool_.total_bytes());
+
+        data::Block unpinned_block(std::move(bbp), 0, 20000, 0, 0, false);
+        {
+            data::PinnedBlock pinned = unpinned_block.PinWait(0);
+            ASSERT_EQ(1u, block_pool_.pinned_blocks());
+            for (size_t i = 0; i < 20000; ++i)
+                ASSERT_EQ((5000 + i) % 251, pinned.data_begin()[i]);
+        }
+
+        // mapped blocks are never swapped out
+        ASSERT_EQ(0u, block_pool_.pinned_blocks());
+        ASSERT_EQ(0u, block_pool_.unpinned_blocks());
+    }
+    ASSERT_EQ(0u, block_pool_.total_bytes());
+}
+
+TEST_F(BlockPoolTest, RecycleDefaultSizeBlocks) {
+    data::Byte* data;
+    {
+        data::PinnedByteBlockPtr block =
+            block_pool_.AllocateByteBlock(data::default_block_size, 0);
+        data = block->data();
+    }
+    ASSERT_EQ(0u, block_pool_.total_blocks());
+
+    // the buffer of the destroyed block is handed out again
+    data::PinnedByteBlockPtr block =
+        block_pool_.AllocateByteBlock(data::default_block_size, 0);
+    ASSERT_EQ(data, block->data());
+}
+
+TEST(BlockPool, ReclaimFlag) {
+    static constexpr size_t size = 4096;
+    // soft limit of two blocks, hard limit well above
+    data::BlockPool block_pool(2 * size, 8 * size, nullptr, nullptr, 1);
+    data::ReclaimFlag reclaim(block_pool);
+
+    std::vector<data::PinnedByteBlockPtr> blocks;
+    blocks.emplace_back(block_pool.AllocateByteBlock(size, 0));
+    blocks.emplace_back(block_pool.AllocateByteBlock(size, 0));
+    ASSERT_FALSE(reclaim.test_and_clear());
+
+    // all blocks are pinned, nothing can be evicted: nodes are asked to flush
+    blocks.emplace_back(block_pool.AllocateByteBlock(size, 0));
+    ASSERT_TRUE(reclaim.test_and_clear());
+    ASSERT_FALSE(reclaim.test_and_clear());
+}
+
 /******************************************************************************/
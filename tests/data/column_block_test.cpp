@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * tests/data/column_block_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/data/column_block.hpp>
+#include <thrill/data/file.hpp>
+
+#include <cstdint>
+#include <tuple>
+
+using namespace thrill;
+
+struct ColumnBlock : public ::testing::Test {
+    data::BlockPool block_pool_;
+};
+
+TEST_F(ColumnBlock, WriteReadSegments) {
+    static constexpr size_t size = 10000;
+    static constexpr size_t segment_rows = 999;
+
+    using Writer = data::ColumnWriter<
+              data::File::Writer, uint64_t, double, int32_t>;
+    using Reader = data::ColumnReader<
+              data::File::KeepReader, uint64_t, double, int32_t>;
+
+    static_assert(Writer::Segment::row_size == 20, "wrong row_size");
+
+    // small blocks, such that segments are split between blocks.
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(4096);
+        Writer cw(fw, segment_rows);
+        for (size_t i = 0; i < size; ++i)
+            cw.Put(std::make_tuple(
+                       uint64_t(i), 0.5 * i, -static_cast<int32_t>(i)));
+    }
+    ASSERT_EQ((size + segment_rows - 1) / segment_rows, file.num_items());
+
+    data::File::KeepReader fr = file.GetKeepReader();
+    Reader cr(fr);
+    size_t i = 0;
+    uint64_t sum = 0;
+    while (cr.HasNext()) {
+        const Reader::Segment& seg = cr.NextSegment();
+        ASSERT_TRUE(seg.size() == segment_rows || i + seg.size() == size);
+
+        const double* c1 = seg.column<1>();
+        for (size_t j = 0; j < seg.size(); ++j, ++i) {
+            ASSERT_DOUBLE_EQ(0.5 * i, c1[j]);
+            ASSERT_EQ(-static_cast<int32_t>(i), std::get<2>(seg.row(j)));
+        }
+        sum += seg.Sum<0>();
+    }
+    ASSERT_EQ(size, i);
+    ASSERT_EQ(size * (size - 1) / 2, sum);
+}
+
+/******************************************************************************/
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * tests/data/eviction_policy_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/eviction_policy.hpp>
+
+#include <vector>
+
+using namespace thrill;
+
+struct EvictionPolicyTest : public ::testing::Test {
+    data::BlockPool block_pool_;
+    std::vector<data::PinnedByteBlockPtr> blocks_;
+
+    //! allocate ByteBlocks, only their addresses are used by the policies.
+    void Allocate(size_t num) {
+        for (size_t i = 0; i < num; ++i)
+            blocks_.emplace_back(block_pool_.AllocateByteBlock(8, 0));
+    }
+
+    data::ByteBlock * bb(size_t i) { return blocks_[i].get(); }
+};
+
+TEST_F(EvictionPolicyTest, LruMru) {
+    Allocate(4);
+
+    auto lru = data::MakeEvictionPolicy("lru");
+    auto mru = data::MakeEvictionPolicy("mru");
+    ASSERT_TRUE(lru && mru);
+    ASSERT_FALSE(data::MakeEvictionPolicy("fifo"));
+
+    for (size_t i = 0; i < 4; ++i) {
+        lru->put(bb(i));
+        mru->put(bb(i));
+    }
+    lru->erase(bb(0));
+    mru->erase(bb(3));
+    ASSERT_FALSE(lru->exists(bb(0)));
+    ASSERT_TRUE(lru->exists(bb(3)));
+    ASSERT_EQ(3u, lru->size());
+
+    ASSERT_EQ(bb(1), lru->pop());
+    ASSERT_EQ(bb(2), lru->pop());
+    ASSERT_EQ(bb(3), lru->pop());
+    ASSERT_EQ(0u, lru->size());
+
+    ASSERT_EQ(bb(2), mru->pop());
+    ASSERT_EQ(bb(1), mru->pop());
+    ASSERT_EQ(bb(0), mru->pop());
+    ASSERT_EQ(0u, mru->size());
+}
+
+TEST_F(EvictionPolicyTest, DiaSchedule) {
+    Allocate(5);
+
+    // blocks 0,1 belong to dia 10, 2,3 to dia 20, block 4 is untagged.
+    bb(0)->set_dia_id(10);
+    bb(1)->set_dia_id(10);
+    bb(2)->set_dia_id(20);
+    bb(3)->set_dia_id(20);
+    // tags are only set once
+    bb(3)->set_dia_id(30);
+    ASSERT_EQ(20u, bb(3)->dia_id());
+
+    auto dia = data::MakeEvictionPolicy("dia");
+    ASSERT_TRUE(dia);
+    for (size_t i = 0; i < 5; ++i)
+        dia->put(bb(i));
+
+    // dia 10 is used after dia 20: its most recent block is evicted first
+    dia->SetSchedule({ 20, 10 });
+    ASSERT_EQ(bb(1), dia->pop());
+
+    // now dia 20 is not scheduled anymore
+    dia->SetSchedule({ 10 });
+    ASSERT_EQ(bb(3), dia->pop());
+    dia->erase(bb(2));
+    ASSERT_EQ(bb(0), dia->pop());
+
+    // untagged blocks are evicted last
+    ASSERT_EQ(bb(4), dia->pop());
+    ASSERT_EQ(0u, dia->size());
+}
+
+TEST_F(EvictionPolicyTest, JobQuota) {
+    // blocks 0,1 of the default job, 2,3,4 of job 1, and 5 of job 2.
+    Allocate(2);
+    {
+        data::BlockPool::JobScope scope(1);
+        Allocate(3);
+        ASSERT_EQ(1u, data::BlockPool::current_job_id());
+    }
+    {
+        data::BlockPool::JobScope scope(2);
+        Allocate(1);
+    }
+    ASSERT_EQ(0u, data::BlockPool::current_job_id());
+    ASSERT_EQ(0u, bb(1)->job_id());
+    ASSERT_EQ(1u, bb(2)->job_id());
+    ASSERT_EQ(2u, bb(5)->job_id());
+
+    data::JobEvictionPolicy jobs("lru");
+    ASSERT_STREQ("lru", jobs.name());
+    for (size_t i = 0; i < 6; ++i) {
+        jobs.AddResident(bb(i)->job_id(), bb(i)->size());
+        jobs.put(bb(i));
+    }
+    ASSERT_EQ(3u, jobs.num_jobs());
+    ASSERT_EQ(6u, jobs.size());
+    ASSERT_TRUE(jobs.exists(bb(4)));
+
+    // job 1 holds most RAM, it is evicted first in LRU order
+    ASSERT_EQ(bb(2), jobs.pop());
+    jobs.SubResident(1, bb(2)->size());
+
+    // protect job 1 by a quota: now the default job exceeds it the most
+    jobs.SetQuota(1, 2 * bb(3)->size());
+    ASSERT_EQ(bb(0), jobs.pop());
+    jobs.SubResident(0, bb(0)->size());
+
+    // equal excess of jobs 0 and 2, ties go to the smaller id
+    ASSERT_EQ(bb(1), jobs.pop());
+    jobs.SubResident(0, bb(1)->size());
+    ASSERT_EQ(bb(5), jobs.pop());
+    jobs.SubResident(2, bb(5)->size());
+
+    // only the protected job is left
+    ASSERT_EQ(bb(3), jobs.pop());
+    jobs.SubResident(1, bb(3)->size());
+
+    // a released job is dropped once its last block left RAM
+    jobs.ReleaseJob(2);
+    ASSERT_EQ(2u, jobs.num_jobs());
+    jobs.ReleaseJob(1);
+    ASSERT_EQ(0u, jobs.quota(1));
+    ASSERT_EQ(2u, jobs.num_jobs());
+    jobs.erase(bb(4));
+    jobs.SubResident(1, bb(4)->size());
+    ASSERT_EQ(1u, jobs.num_jobs());
+    ASSERT_EQ(0u, jobs.size());
+}
+
+/******************************************************************************/
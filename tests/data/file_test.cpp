@@ -254,6 +254,193 @@ TEST_F(File, SerializeSomeItemsConsumeReader) {
     ASSERT_EQ(0u, file.num_items());
 }
 
+TEST_F(File, NextStringViewBorrowsFromPinnedBlocks) {
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < 200; ++i)
+        strings.emplace_back(std::string(i % 40, static_cast<char>('a' + i % 26)));
+
+    // small blocks, such that some strings are split between blocks.
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(64);
+        for (const std::string& s : strings)
+            fw.Put(s);
+    }
+
+    std::vector<data::PinnedStringView> views;
+    size_t borrowed = 0;
+    {
+        data::File::ConsumeReader fr = file.GetConsumeReader();
+        while (fr.HasNext()) {
+            views.emplace_back(fr.NextStringView());
+            borrowed += views.back().borrowed();
+        }
+    }
+    // the views keep their blocks alive after they were consumed.
+    ASSERT_EQ(strings.size(), views.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        ASSERT_EQ(strings[i], views[i].ToString());
+        ASSERT_TRUE(views[i] == strings[i]);
+        ASSERT_EQ(strings[i] < strings[(i + 1) % strings.size()],
+                  views[i] < views[(i + 1) % strings.size()]);
+    }
+    ASSERT_GT(borrowed, 0u);
+    ASSERT_LT(borrowed, strings.size());
+}
+
+TEST_F(File, NextLazyReferencesRawItems) {
+    using MyPair = std::pair<uint64_t, uint64_t>;
+    static constexpr size_t size = 1000;
+
+    // small blocks whose size is not a multiple of the item size, such that
+    // some items are split between blocks.
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(100);
+        for (size_t i = 0; i < size; ++i)
+            fw.Put(MyPair(i * i, i));
+    }
+
+    data::LazyField<MyPair, uint64_t, &MyPair::first> key;
+    size_t owned = 0;
+    {
+        data::File::ConsumeReader fr = file.GetConsumeReader();
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_TRUE(fr.HasNext());
+            data::LazyItem<MyPair> item = fr.NextLazy<MyPair>();
+            owned += item.owned();
+            ASSERT_EQ(i * i, key(item));
+            ASSERT_EQ(i, item.Get(&MyPair::second));
+            ASSERT_EQ(MyPair(i * i, i), item.Materialize());
+        }
+        ASSERT_FALSE(fr.HasNext());
+    }
+    ASSERT_GT(owned, 0u);
+    ASSERT_LT(owned, size);
+}
+
+TEST_F(File, NextBatchRawAndSplitItems) {
+    static constexpr size_t size = 5000;
+
+    using MyPair = std::pair<uint64_t, uint64_t>;
+    static_assert(data::IsRawSerializable<MyPair>::value,
+                  "pair of uint64_t should be raw serializable");
+    static_assert(!data::IsRawSerializable<std::pair<int, std::string> >::value,
+                  "pair with string must not be raw serializable");
+
+    // very small blocks whose size is not a multiple of the item size, such
+    // that items are split between blocks.
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(53);
+        for (size_t i = 0; i < size; ++i)
+            fw.Put(MyPair(i, 3 * i));
+    }
+
+    for (size_t batch : { 1, 2, 7, 1000 }) {
+        data::File::KeepReader fr = file.GetKeepReader();
+        std::vector<MyPair> items(batch);
+        size_t i = 0, n;
+        while ((n = fr.NextBatch<MyPair>(items.data(), batch)) != 0) {
+            ASSERT_TRUE(n == batch || i + n == size);
+            for (size_t j = 0; j < n; ++j, ++i)
+                ASSERT_EQ(MyPair(i, 3 * i), items[j]);
+        }
+        ASSERT_EQ(size, i);
+        ASSERT_FALSE(fr.HasNext());
+    }
+
+    // non-raw items are deserialized one by one
+    data::File sfile(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = sfile.GetWriter(53);
+        for (size_t i = 0; i < 100; ++i)
+            fw.Put(std::to_string(i));
+    }
+    {
+        data::File::KeepReader fr = sfile.GetKeepReader();
+        std::vector<std::string> items(64);
+        ASSERT_EQ(64u, fr.NextBatch<std::string>(items.data(), 64));
+        ASSERT_EQ("63", items[63]);
+        ASSERT_EQ(36u, fr.NextBatch<std::string>(items.data(), 64));
+        ASSERT_EQ("99", items[35]);
+        ASSERT_EQ(0u, fr.NextBatch<std::string>(items.data(), 64));
+    }
+}
+
+TEST_F(File, PutBatchRawAndSerializedItems) {
+    static constexpr size_t size = 5000;
+
+    using MyPair = std::pair<uint32_t, uint32_t>;
+    std::vector<MyPair> items;
+    for (size_t i = 0; i < size; ++i)
+        items.emplace_back(i, 7 * i);
+
+    // blocks of 53 bytes split items, batches are appended in pieces
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(53);
+        fw.PutBatch(items.data(), 1);
+        fw.PutBatch(items.data() + 1, 999);
+        fw.Put(items[1000]);
+        fw.PutBatch(items.data() + 1001, size - 1001);
+    }
+    ASSERT_EQ(size, file.num_items());
+    {
+        data::File::KeepReader fr = file.GetKeepReader();
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_TRUE(fr.HasNext());
+            ASSERT_EQ(items[i], fr.Next<MyPair>());
+        }
+        ASSERT_FALSE(fr.HasNext());
+    }
+    // random access must find the item boundaries of each block
+    ASSERT_EQ(items[4321], file.GetItemAt<MyPair>(4321));
+
+    std::vector<std::string> strings = { "a", "bc", "", "def" };
+    data::File sfile(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = sfile.GetWriter(53);
+        fw.PutBatch(strings.data(), strings.size());
+    }
+    ASSERT_EQ(4u, sfile.num_items());
+    {
+        data::File::KeepReader fr = sfile.GetKeepReader();
+        ASSERT_EQ(strings, fr.ReadComplete<std::string>());
+    }
+}
+
+TEST_F(File, SerializeSomeItemsAutoPrefetch) {
+    static constexpr size_t size = 5000;
+
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(53);
+        for (unsigned i = 0; i < size; ++i) {
+            fw.Put<unsigned>(i);
+        }
+    }
+
+    // read twice keeping the File, then consume it.
+    for (size_t r = 0; r < 3; ++r) {
+        bool consume = (r == 2);
+        data::File::Reader fr =
+            file.GetReader(consume, data::File::auto_prefetch_size_);
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_TRUE(fr.HasNext());
+            unsigned iread = fr.Next<unsigned>();
+            ASSERT_EQ(i, iread);
+        }
+        ASSERT_TRUE(!fr.HasNext());
+    }
+    ASSERT_TRUE(file.empty());
+
+    // read ahead a quarter of the free RAM of a limited BlockPool
+    data::BlockPool limited_pool(
+        0, 64 * data::default_block_size, nullptr, nullptr, 1);
+    ASSERT_EQ(16 * data::default_block_size, limited_pool.ReadAheadSize());
+}
+
 TEST_F(File, RandomGetIndexOf) {
     static constexpr size_t size = 500;
 
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * tests/data/mmap_spill_area_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/data/mmap_spill_area.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace thrill;
+
+TEST(MmapSpillArea, AllocateDeallocate) {
+    vfs::TemporaryDirectory tmpdir;
+
+    static constexpr size_t region_size = 1024 * 1024;
+    static constexpr size_t slot_size = 64 * 1024;
+
+    data::MmapSpillArea area(tmpdir.get(), region_size);
+
+    // slots larger than a region are not possible
+    ASSERT_EQ(nullptr, area.Allocate(2 * region_size));
+
+    // fill more than one region, each slot with a different byte.
+    std::vector<uint8_t*> slots;
+    for (size_t i = 0; i < 20; ++i) {
+        uint8_t* slot = area.Allocate(slot_size);
+        ASSERT_NE(nullptr, slot);
+        std::fill(slot, slot + slot_size, static_cast<uint8_t>(i));
+        slots.push_back(slot);
+    }
+    ASSERT_EQ(20 * slot_size, area.used_bytes());
+    ASSERT_EQ(2 * region_size, area.file_size());
+
+    for (size_t i = 0; i < 20; ++i) {
+        ASSERT_EQ(static_cast<uint8_t>(i), slots[i][0]);
+        ASSERT_EQ(static_cast<uint8_t>(i), slots[i][slot_size - 1]);
+    }
+
+    // freed slots are reused
+    area.Deallocate(slots[3], slot_size);
+    ASSERT_EQ(slots[3], area.Allocate(slot_size));
+
+    for (uint8_t* slot : slots)
+        area.Deallocate(slot, slot_size);
+    ASSERT_EQ(0u, area.used_bytes());
+}
+
+/******************************************************************************/
@@ -18,8 +18,15 @@
 #include <thrill/net/group.hpp>
 #include <thrill/net/mock/group.hpp>
 
+#if THRILL_HAVE_NET_TCP
+#include <thrill/net/tcp/group.hpp>
+#endif
+
 #include <algorithm>
+#include <functional>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace thrill;
@@ -170,8 +177,12 @@ struct Multiplexer : public ::testing::Test {
 };
 
 // open a Stream via data::Multiplexer, and send a short message to all workers,
-// receive and check the message.
-void TalkAllToAllViaCatStream(net::Group* net) {
+// receive and check the message. The Multiplexer uses the Groups as lanes, and
+// shards their connections across num_dispatchers DispatcherThreads.
+void TalkAllToAllViaCatStreamDispatchers(
+    const std::vector<net::Group*>& lanes, size_t num_dispatchers,
+    bool flow_control = false) {
+    net::Group* net = lanes[0];
     common::NameThisThread("chmp" + std::to_string(net->my_host_rank()));
 
     unsigned char send_buffer[123];
@@ -185,9 +196,16 @@ void TalkAllToAllViaCatStream(net::Group* net) {
 
     mem::Manager mem_manager(nullptr, "Benchmark");
     data::BlockPool block_pool(num_workers_per_host);
-    net::DispatcherThread disp(net->ConstructDispatcher(), 0);
+    std::vector<std::unique_ptr<net::DispatcherThread> > disps;
+    std::vector<net::DispatcherThread*> disp_ptrs;
+    for (size_t d = 0; d < num_dispatchers; ++d) {
+        disps.emplace_back(std::make_unique<net::DispatcherThread>(
+                               net->ConstructDispatcher(), 0));
+        disp_ptrs.push_back(disps.back().get());
+    }
     data::Multiplexer multiplexer(
-        mem_manager, block_pool, disp, *net, num_workers_per_host);
+        mem_manager, block_pool, disp_ptrs, lanes, num_workers_per_host,
+        /* compress_blocks */ false, flow_control);
 
     auto thread_func =
         [&](size_t my_local_worker_id) {
@@ -287,8 +305,45 @@ void TalkAllToAllViaCatStream(net::Group* net) {
     std::thread t1 = std::thread(thread_func, 1);
     t0.join(), t1.join();
 
-    // stop DispatcherThread before Multiplexer
-    disp.Terminate();
+    // stop DispatcherThreads before Multiplexer
+    for (std::unique_ptr<net::DispatcherThread>& disp : disps)
+        disp->Terminate();
+}
+
+void TalkAllToAllViaCatStreamLanes(const std::vector<net::Group*>& lanes) {
+    TalkAllToAllViaCatStreamDispatchers(lanes, 1);
+}
+
+void TalkAllToAllViaCatStream(net::Group* net) {
+    TalkAllToAllViaCatStreamLanes(std::vector<net::Group*>({ net }));
+}
+
+//! run a thread for each of num_hosts hosts, each with num_lanes loopback
+//! Groups to the others.
+static void RunLoopbackLanesTest(
+    size_t num_hosts, size_t num_lanes,
+    const std::function<void(const std::vector<net::Group*>&)>& thread_function) {
+#if THRILL_HAVE_NET_TCP
+    using TestGroup = net::tcp::Group;
+#else
+    using TestGroup = net::mock::Group;
+#endif
+    std::vector<std::vector<std::unique_ptr<TestGroup> > > meshes;
+    for (size_t l = 0; l < num_lanes; ++l)
+        meshes.emplace_back(TestGroup::ConstructLoopbackMesh(num_hosts));
+
+    std::vector<std::thread> threads(num_hosts);
+    for (size_t h = 0; h < num_hosts; ++h) {
+        threads[h] = std::thread(
+            [&, h]() {
+                std::vector<net::Group*> lanes;
+                for (size_t l = 0; l < num_lanes; ++l)
+                    lanes.push_back(meshes[l][h].get());
+                thread_function(lanes);
+            });
+    }
+    for (size_t h = 0; h < num_hosts; ++h)
+        threads[h].join();
 }
 
 TEST_F(Multiplexer, TalkAllToAllViaCatStreamForManyNetSizes) {
@@ -300,6 +355,246 @@ TEST_F(Multiplexer, TalkAllToAllViaCatStreamForManyNetSizes) {
     net::RunLoopbackGroupTest(9, TalkAllToAllViaCatStream);
 }
 
+TEST_F(Multiplexer, TalkAllToAllViaCatStreamWithLanes) {
+    data::default_block_size = test_block_size;
+    RunLoopbackLanesTest(2, 3, TalkAllToAllViaCatStreamLanes);
+    RunLoopbackLanesTest(5, 2, TalkAllToAllViaCatStreamLanes);
+}
+
+TEST_F(Multiplexer, TalkAllToAllViaCatStreamShardedDispatchers) {
+    data::default_block_size = test_block_size;
+    RunLoopbackLanesTest(
+        5, 1, [](const std::vector<net::Group*>& lanes) {
+            TalkAllToAllViaCatStreamDispatchers(lanes, 3);
+        });
+    RunLoopbackLanesTest(
+        3, 2, [](const std::vector<net::Group*>& lanes) {
+            TalkAllToAllViaCatStreamDispatchers(lanes, 4);
+        });
+}
+
+TEST_F(Multiplexer, TalkAllToAllViaCatStreamFlowControl) {
+    data::default_block_size = test_block_size;
+    // the window of two Blocks makes the senders hold most Blocks
+    RunLoopbackLanesTest(
+        5, 1, [](const std::vector<net::Group*>& lanes) {
+            TalkAllToAllViaCatStreamDispatchers(lanes, 1, true);
+        });
+    RunLoopbackLanesTest(
+        3, 2, [](const std::vector<net::Group*>& lanes) {
+            TalkAllToAllViaCatStreamDispatchers(lanes, 2, true);
+        });
+}
+
+// send many Blocks from all workers to all workers on several lanes, and count
+// the items of the Blocks of each sender delivered out of order.
+void CountBlockItemsOutOfOrder(const std::vector<net::Group*>& lanes) {
+    net::Group* net = lanes[0];
+
+    static constexpr size_t num_items = 10000;
+    size_t num_workers_per_host = 2;
+
+    mem::Manager mem_manager(nullptr, "Benchmark");
+    data::BlockPool block_pool(num_workers_per_host);
+    net::DispatcherThread disp0(net->ConstructDispatcher(), 0);
+    net::DispatcherThread disp1(net->ConstructDispatcher(), 0);
+    data::Multiplexer multiplexer(
+        mem_manager, block_pool,
+        std::vector<net::DispatcherThread*>({ &disp0, &disp1 }),
+        lanes, num_workers_per_host);
+
+    auto thread_func =
+        [&](size_t my_local_worker_id) {
+            auto stream = multiplexer.GetNewCatStream(
+                my_local_worker_id, /* dia_id */ 0);
+            stream->set_out_of_order();
+
+            auto writers = stream->GetWriters();
+            for (size_t tgt = 0; tgt != writers.size(); ++tgt) {
+                for (size_t i = 0; i < num_items; ++i)
+                    writers[tgt].Put<size_t>(i);
+                writers[tgt].Close();
+            }
+
+            auto readers = stream->GetReaders();
+            for (size_t src = 0; src != readers.size(); ++src) {
+                size_t count = 0;
+                data::PinnedBlock b;
+                while ((b = readers[src].source().NextBlock()).IsValid())
+                    count += b.num_items();
+                ASSERT_EQ(num_items, count);
+            }
+
+            stream->Close();
+        };
+
+    std::thread t0 = std::thread(thread_func, 0);
+    std::thread t1 = std::thread(thread_func, 1);
+    t0.join(), t1.join();
+
+    // stop DispatcherThreads before Multiplexer
+    disp0.Terminate();
+    disp1.Terminate();
+}
+
+TEST_F(Multiplexer, CountBlockItemsOutOfOrder) {
+    data::default_block_size = test_block_size;
+    RunLoopbackLanesTest(3, 3, CountBlockItemsOutOfOrder);
+}
+
+// flush a Block after each item, which the StreamSinks to remote workers
+// coalesce with adaptive Block sizes, and check the items.
+void CoalesceSmallBlocks(const std::vector<net::Group*>& lanes) {
+    net::Group* net = lanes[0];
+
+    static constexpr size_t num_items = 1000;
+    size_t num_workers_per_host = 2;
+    size_t num_remote = (net->num_hosts() - 1) * num_workers_per_host;
+
+    mem::Manager mem_manager(nullptr, "Benchmark");
+    data::BlockPool block_pool(num_workers_per_host);
+    net::DispatcherThread disp(net->ConstructDispatcher(), 0);
+    data::Multiplexer multiplexer(
+        mem_manager, block_pool, disp, lanes, num_workers_per_host,
+        /* compress_blocks */ false, /* flow_control */ false,
+        /* adaptive_block_size */ true);
+
+    auto thread_func =
+        [&](size_t my_local_worker_id) {
+            auto stream = multiplexer.GetNewCatStream(
+                my_local_worker_id, /* dia_id */ 0);
+
+            auto writers = stream->GetWriters();
+            for (size_t tgt = 0; tgt != writers.size(); ++tgt) {
+                for (size_t i = 0; i < num_items; ++i) {
+                    writers[tgt].Put<size_t>(i);
+                    writers[tgt].Flush();
+                }
+                writers[tgt].Close();
+            }
+
+            auto readers = stream->GetReaders();
+            for (size_t src = 0; src != readers.size(); ++src) {
+                for (size_t i = 0; i < num_items; ++i) {
+                    ASSERT_TRUE(readers[src].HasNext());
+                    ASSERT_EQ(i, readers[src].Next<size_t>());
+                }
+                ASSERT_FALSE(readers[src].HasNext());
+            }
+
+            stream->Close();
+
+            // many items were sent in each Block over the network
+            ASSERT_LT(stream->tx_net_blocks(), num_remote * num_items / 10);
+        };
+
+    std::thread t0 = std::thread(thread_func, 0);
+    std::thread t1 = std::thread(thread_func, 1);
+    t0.join(), t1.join();
+
+    // stop DispatcherThread before Multiplexer
+    disp.Terminate();
+}
+
+TEST_F(Multiplexer, CoalesceSmallBlocks) {
+    data::default_block_size = test_block_size;
+    RunLoopbackLanesTest(3, 1, CoalesceSmallBlocks);
+    RunLoopbackLanesTest(3, 2, CoalesceSmallBlocks);
+}
+
+TEST_F(Multiplexer, StreamIdsPerJob) {
+    auto groups = net::mock::Group::ConstructLoopbackMesh(1);
+    mem::Manager mem_manager(nullptr, "Benchmark");
+    net::DispatcherThread disp(groups[0]->ConstructDispatcher(), 0);
+    data::BlockPool block_pool(2);
+    data::Multiplexer multiplexer(mem_manager, block_pool, disp, *groups[0], 2);
+
+    const size_t job1 = size_t(1) << data::Multiplexer::job_id_shift;
+
+    ASSERT_EQ(1u, multiplexer.AllocateCatStreamId(0));
+    ASSERT_EQ(job1 | 1, multiplexer.AllocateCatStreamId(0, 1));
+    ASSERT_EQ(job1 | 2, multiplexer.AllocateMixStreamId(0, 1));
+    ASSERT_EQ(job1 | 1, multiplexer.AllocateMixStreamId(1, 1));
+    ASSERT_EQ(1u, data::Multiplexer::StreamJobId(job1 | 2));
+
+    // the default job's sequence is not disturbed by job 1
+    ASSERT_EQ(2u, multiplexer.AllocateCatStreamId(0));
+
+    // a released job's sequences restart
+    multiplexer.ReleaseJob(1);
+    ASSERT_EQ(job1 | 1, multiplexer.AllocateCatStreamId(0, 1));
+
+    disp.Terminate();
+}
+
+// run two jobs with two workers each on one Multiplexer per host, which
+// allocate different numbers of streams concurrently.
+void ConcurrentJobs(const std::vector<net::Group*>& lanes) {
+    net::Group* net = lanes[0];
+
+    static constexpr size_t num_items = 20000;
+    size_t num_workers_per_host = 2;
+
+    mem::Manager mem_manager(nullptr, "Benchmark");
+    data::BlockPool block_pool(num_workers_per_host);
+    net::DispatcherThread disp(net->ConstructDispatcher(), 0);
+    data::Multiplexer multiplexer(
+        mem_manager, block_pool, disp, lanes, num_workers_per_host);
+
+    auto thread_func =
+        [&](size_t job_id, size_t my_local_worker_id) {
+            data::BlockPool::JobScope scope(job_id);
+
+            // job 2 skips streams, which would shift the ids of job 1 if
+            // both allocated from one sequence.
+            for (size_t s = 1; s < job_id; ++s)
+                multiplexer.AllocateCatStreamId(my_local_worker_id, job_id);
+
+            auto stream = multiplexer.GetNewCatStream(
+                my_local_worker_id, /* dia_id */ 0, job_id);
+            ASSERT_EQ(job_id, data::Multiplexer::StreamJobId(stream->id()));
+
+            auto writers = stream->GetWriters();
+            for (size_t tgt = 0; tgt != writers.size(); ++tgt) {
+                for (size_t i = 0; i < num_items; ++i)
+                    writers[tgt].Put<size_t>(job_id * i);
+                writers[tgt].Close();
+            }
+
+            auto readers = stream->GetReaders();
+            for (size_t src = 0; src != readers.size(); ++src) {
+                for (size_t i = 0; i < num_items; ++i) {
+                    ASSERT_TRUE(readers[src].HasNext());
+                    ASSERT_EQ(job_id * i, readers[src].Next<size_t>());
+                }
+                ASSERT_FALSE(readers[src].HasNext());
+            }
+
+            stream->Close();
+        };
+
+    std::vector<std::thread> threads;
+    for (size_t job_id = 1; job_id <= 2; ++job_id) {
+        for (size_t w = 0; w < num_workers_per_host; ++w)
+            threads.emplace_back(thread_func, job_id, w);
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    multiplexer.ReleaseJob(1);
+    multiplexer.ReleaseJob(2);
+    ASSERT_EQ(0u, multiplexer.sending_jobs());
+
+    // stop DispatcherThread before Multiplexer
+    disp.Terminate();
+}
+
+TEST_F(Multiplexer, ConcurrentJobs) {
+    data::default_block_size = test_block_size;
+    RunLoopbackLanesTest(3, 1, ConcurrentJobs);
+    RunLoopbackLanesTest(2, 2, ConcurrentJobs);
+}
+
 TEST_F(Multiplexer, ReadCompleteCatStream) {
     data::default_block_size = test_block_size;
     auto w0 =
@@ -130,4 +130,61 @@ TEST_F(SerializationCereal, cereal_w_BlockQueue)
     }
 }
 
+//! a non-POD struct of fixed-size members, copied raw instead of via cereal
+struct CerealFixedObject {
+    CerealFixedObject() = default;
+    CerealFixedObject(uint64_t id, double w, uint32_t c)
+        : id_(id), weight_(w), count_(c) { }
+
+    uint64_t id_;
+    double   weight_;
+    uint32_t count_;
+
+    template <typename Archive>
+    void serialize(Archive& archive) {
+        archive(id_, weight_, count_);
+    }
+};
+
+THRILL_CEREAL_RAW_COPY(CerealFixedObject)
+
+TEST_F(SerializationCereal, RawCopyOfFixedSizeObject)
+{
+    using FixedSerialization =
+        data::Serialization<data::File::Writer, CerealFixedObject>;
+    static_assert(FixedSerialization::is_fixed_size,
+                  "CerealRawCopy types must be fixed size");
+    static_assert(FixedSerialization::fixed_size == sizeof(CerealFixedObject),
+                  "CerealRawCopy types must be copied raw");
+    static_assert(data::IsRawSerializable<CerealFixedObject>::value,
+                  "CerealRawCopy types must be raw serializable");
+    static_assert(
+        !data::Serialization<data::File::Writer, CerealObject2>::is_fixed_size,
+        "other cereal types are not fixed size");
+
+    static constexpr size_t size = 1000;
+
+    data::File f(block_pool_, 0, /* dia_id */ 0);
+    {
+        auto w = f.GetWriter(100);
+        for (size_t i = 0; i < size; ++i)
+            w.Put(CerealFixedObject(i, 0.5 * i, static_cast<uint32_t>(3 * i)));
+    }
+    ASSERT_EQ(size, f.num_items());
+
+    data::File::KeepReader r = f.GetKeepReader();
+    std::vector<CerealFixedObject> items(size);
+    ASSERT_EQ(size, r.NextBatch(items.data(), size));
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(i, items[i].id_);
+        ASSERT_DOUBLE_EQ(0.5 * i, items[i].weight_);
+        ASSERT_EQ(3 * i, items[i].count_);
+    }
+    ASSERT_FALSE(r.HasNext());
+
+    // seeking by fixed item size
+    CerealFixedObject o = f.GetItemAt<CerealFixedObject>(size / 2);
+    ASSERT_EQ(size / 2, o.id_);
+}
+
 /******************************************************************************/
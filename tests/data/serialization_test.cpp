@@ -12,7 +12,10 @@
 #include <thrill/data/block_queue.hpp>
 #include <thrill/data/file.hpp>
 #include <thrill/data/serialization.hpp>
+#include <thrill/data/serialization_compact.hpp>
+#include <thrill/data/serialization_macro.hpp>
 
+#include <cstdint>
 #include <string>
 #include <tuple>
 #include <typeinfo>
@@ -21,6 +24,21 @@
 
 using namespace thrill; // NOLINT
 
+struct MyMacroFixed {
+    uint64_t id;
+    double   weight;
+    uint16_t flags;
+};
+
+struct MyMacroVariable {
+    std::string      name;
+    uint32_t         count;
+    std::vector<int> values;
+};
+
+THRILL_SERIALIZE(MyMacroFixed, id, weight, flags)
+THRILL_SERIALIZE(MyMacroVariable, name, count, values)
+
 struct Serialization : public ::testing::Test {
     data::BlockPool block_pool_;
 };
@@ -236,4 +254,90 @@ TEST_F(Serialization, MethodStruct) {
         "Serialization::is_fixed_size is wrong");
 }
 
+TEST_F(Serialization, CompactVarintAndPrefixStrings) {
+    using Item = std::pair<std::string, uint64_t>;
+    using Tuple = std::tuple<int64_t, uint32_t, double, MyMethodStruct>;
+
+    std::vector<Item> items;
+    for (size_t i = 0; i < 1000; ++i)
+        items.emplace_back("word" + std::to_string(1000 + i), i % 10);
+    items.emplace_back("word9999", uint64_t(-1));
+
+    std::vector<Tuple> tuples = {
+        Tuple(-1, 300, 2.5, MyMethodStruct(-42, 1.5, "x")),
+        Tuple(INT64_MIN, UINT32_MAX, -0.5, MyMethodStruct(7, 0, "")),
+        Tuple(INT64_MAX, 0, 0, MyMethodStruct(0, 3.25, "foo"))
+    };
+
+    for (bool prefix_strings : { false, true }) {
+        data::File plain(block_pool_, 0, /* dia_id */ 0);
+        data::File compact(block_pool_, 0, /* dia_id */ 0);
+        {
+            auto w = plain.GetWriter();
+            for (const Item& item : items) w.Put(item);
+
+            auto cw = compact.GetWriter();
+            data::CompactWriter<data::File::Writer> ar(cw, prefix_strings);
+            for (const Item& item : items) ar.Put(item);
+            for (const Tuple& t : tuples) ar.Put(t);
+        }
+        ASSERT_EQ(items.size() + tuples.size(), compact.num_items());
+        ASSERT_LT(compact.size_bytes(), plain.size_bytes());
+
+        auto r = compact.GetKeepReader();
+        data::CompactReader<data::File::KeepReader> ar(r, prefix_strings);
+        for (const Item& item : items) {
+            ASSERT_TRUE(ar.HasNext());
+            ASSERT_EQ(item, ar.Next<Item>());
+        }
+        for (const Tuple& t : tuples) {
+            Tuple out = ar.Next<Tuple>();
+            ASSERT_EQ(std::get<0>(t), std::get<0>(out));
+            ASSERT_EQ(std::get<1>(t), std::get<1>(out));
+            ASSERT_DOUBLE_EQ(std::get<2>(t), std::get<2>(out));
+            ASSERT_EQ(std::get<3>(t).i1, std::get<3>(out).i1);
+            ASSERT_DOUBLE_EQ(std::get<3>(t).d2, std::get<3>(out).d2);
+            ASSERT_EQ(std::get<3>(t).s3, std::get<3>(out).s3);
+        }
+        ASSERT_FALSE(ar.HasNext());
+    }
+}
+
+TEST_F(Serialization, MacroGeneratedSerialization) {
+    using FixedSerialization =
+        data::Serialization<data::File::Writer, MyMacroFixed>;
+    static_assert(FixedSerialization::is_fixed_size,
+                  "macro serialization of PODs must be fixed size");
+    static_assert(FixedSerialization::fixed_size ==
+                  sizeof(uint64_t) + sizeof(double) + sizeof(uint16_t),
+                  "macro serialization must not contain padding");
+    static_assert(
+        !data::Serialization<data::File::Writer, MyMacroVariable>::is_fixed_size,
+        "macro serialization of strings must not be fixed size");
+
+    data::File f(block_pool_, 0, /* dia_id */ 0);
+    {
+        auto w = f.GetWriter();
+        for (size_t i = 0; i < 100; ++i) {
+            w.Put(MyMacroFixed { i, 0.5 * i, static_cast<uint16_t>(i) });
+            w.Put(MyMacroVariable {
+                      std::to_string(i), static_cast<uint32_t>(2 * i),
+                      std::vector<int>(i % 5, static_cast<int>(i))
+                  });
+        }
+    }
+    auto r = f.GetKeepReader();
+    for (size_t i = 0; i < 100; ++i) {
+        MyMacroFixed a = r.Next<MyMacroFixed>();
+        ASSERT_EQ(i, a.id);
+        ASSERT_DOUBLE_EQ(0.5 * i, a.weight);
+        ASSERT_EQ(i, a.flags);
+        MyMacroVariable b = r.Next<MyMacroVariable>();
+        ASSERT_EQ(std::to_string(i), b.name);
+        ASSERT_EQ(2 * i, b.count);
+        ASSERT_EQ(std::vector<int>(i % 5, static_cast<int>(i)), b.values);
+    }
+    ASSERT_FALSE(r.HasNext());
+}
+
 /******************************************************************************/
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * tests/data/tiered_file_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/tiered_file.hpp>
+
+#include <gtest/gtest.h>
+#include <thrill/data/block_compression.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+struct TieredFile : public ::testing::Test {
+    data::BlockPool block_pool_;
+};
+
+TEST_F(TieredFile, AssembleTiers) {
+    static constexpr size_t block_size = 1024;
+    static constexpr size_t num_items = 10000;
+
+    data::File file(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = file.GetWriter(block_size);
+        // compressible items
+        for (size_t i = 0; i < num_items; ++i)
+            fw.Put<std::string>("item" + std::to_string(i % 16));
+    }
+    size_t num_blocks = file.num_blocks();
+    ASSERT_GT(num_blocks, 12u);
+
+    data::TieredFile tiered(std::move(file), /* dia_id */ 0,
+                            4 * block_size, 8 * block_size);
+    ASSERT_EQ(num_items, tiered.num_items());
+
+    for (size_t read = 1; read <= 2; ++read) {
+        data::File f = tiered.Assemble();
+        ASSERT_EQ(num_items, f.num_items());
+
+        data::File::ConsumeReader fr = f.GetConsumeReader();
+        for (size_t i = 0; i < num_items; ++i) {
+            ASSERT_TRUE(fr.HasNext());
+            ASSERT_EQ("item" + std::to_string(i % 16), fr.Next<std::string>());
+        }
+        ASSERT_FALSE(fr.HasNext());
+
+        const data::TieredFile::Stats& stats = tiered.stats();
+        ASSERT_EQ(read, stats.reads);
+        ASSERT_EQ(4u, stats.hot_blocks);
+        ASSERT_EQ(num_blocks, stats.hot_blocks + stats.warm_blocks
+                  + stats.cold_blocks);
+
+        if (data::BlockCompressionAvailable()) {
+            ASSERT_EQ(8u, stats.warm_blocks);
+            ASSERT_LT(stats.warm_compressed_bytes, stats.warm_raw_bytes);
+        }
+        else {
+            ASSERT_EQ(0u, stats.warm_blocks);
+        }
+
+        // nothing was evicted
+        ASSERT_EQ(stats.cold_blocks, stats.cold_in_memory);
+        ASSERT_EQ(1.0, stats.hit_rate());
+    }
+
+    tiered.Clear();
+    ASSERT_EQ(0u, tiered.num_items());
+}
+
+/******************************************************************************/
@@ -29,82 +29,89 @@ using namespace examples::k_means;
 
 using Point2D = Point<2>;
 
-TEST(KMeans, RandomPoints) {
-
-    static constexpr size_t iterations = 4;
-    static constexpr size_t num_points = 1000;
-    static constexpr size_t num_clusters = 20;
-
-    // generate some random points and centroids
-    std::vector<Point2D> points, centroids;
+static constexpr size_t iterations = 4;
+static constexpr size_t num_points = 1000;
+static constexpr size_t num_clusters = 20;
 
-    std::default_random_engine rng(123456);
+//! generate some random points
+static std::vector<Point2D> RandomPoints(std::default_random_engine& rng) {
     std::uniform_real_distribution<float> coord_dist(0.0, 100000.0);
 
+    std::vector<Point2D> points;
     points.reserve(num_points);
     for (size_t i = 0; i < num_points; ++i) {
         points.emplace_back(Point2D {
                                 { coord_dist(rng), coord_dist(rng) }
                             });
     }
+    return points;
+}
 
-    centroids.reserve(num_clusters);
-    for (size_t i = 0; i < num_clusters; ++i) {
-        centroids.emplace_back(points[rng() % points.size()]);
-    }
-
-    const std::vector<Point2D> orig_centroids = centroids;
-
-    double correct_cost = 0.0;
-
-    // calculate "correct" results with Lloyd's Algorithm
-    {
-        std::vector<size_t> closest(num_points);
-        std::vector<size_t> point_count(num_clusters);
+//! calculate "correct" results with Lloyd's Algorithm
+static double LloydCost(const std::vector<Point2D>& points,
+                        std::vector<Point2D> centroids) {
+    std::vector<size_t> closest(num_points);
+    std::vector<size_t> point_count(num_clusters);
 
-        for (size_t iter = 0; iter < iterations; ++iter) {
+    for (size_t iter = 0; iter < iterations; ++iter) {
 
-            // for each point, find the closest centroid
-            for (size_t i = 0; i < num_points; ++i) {
-                const Point2D& p = points[i];
-                double min_dist = std::numeric_limits<double>::max();
+        // for each point, find the closest centroid
+        for (size_t i = 0; i < num_points; ++i) {
+            const Point2D& p = points[i];
+            double min_dist = std::numeric_limits<double>::max();
 
-                for (size_t c = 0; c < num_clusters; ++c) {
-                    double dist = p.DistanceSquare(centroids[c]);
-                    if (dist < min_dist) {
-                        min_dist = dist;
-                        closest[i] = c;
-                    }
+            for (size_t c = 0; c < num_clusters; ++c) {
+                double dist = p.DistanceSquare(centroids[c]);
+                if (dist < min_dist) {
+                    min_dist = dist;
+                    closest[i] = c;
                 }
             }
+        }
 
-            // calculate new centroids from associated points
-            std::fill(point_count.begin(), point_count.end(), 0);
-            std::fill(centroids.begin(), centroids.end(), Point2D::Origin());
+        // calculate new centroids from associated points
+        std::fill(point_count.begin(), point_count.end(), 0);
+        std::fill(centroids.begin(), centroids.end(), Point2D::Origin());
 
-            for (size_t i = 0; i < num_points; ++i) {
-                centroids[closest[i]] += points[i];
-                point_count[closest[i]]++;
-            }
-            for (size_t c = 0; c < num_clusters; ++c) {
-                centroids[c] /= static_cast<double>(point_count[c]);
-            }
+        for (size_t i = 0; i < num_points; ++i) {
+            centroids[closest[i]] += points[i];
+            point_count[closest[i]]++;
         }
+        for (size_t c = 0; c < num_clusters; ++c) {
+            centroids[c] /= static_cast<double>(point_count[c]);
+        }
+    }
 
-        // calculate distance squared for each point to the closest centroid
-        for (size_t i = 0; i < num_points; ++i) {
-            const Point2D& p = points[i];
-            double min_dist = p.DistanceSquare(centroids[0]);
+    // calculate distance squared for each point to the closest centroid
+    double cost = 0.0;
+    for (size_t i = 0; i < num_points; ++i) {
+        const Point2D& p = points[i];
+        double min_dist = p.DistanceSquare(centroids[0]);
 
-            for (size_t c = 1; c < num_clusters; ++c) {
-                double dist = p.DistanceSquare(centroids[c]);
-                if (dist < min_dist) {
-                    min_dist = dist;
-                }
+        for (size_t c = 1; c < num_clusters; ++c) {
+            double dist = p.DistanceSquare(centroids[c]);
+            if (dist < min_dist) {
+                min_dist = dist;
             }
-            correct_cost += min_dist;
         }
+        cost += min_dist;
     }
+    return cost;
+}
+
+TEST(KMeans, RandomPoints) {
+
+    std::default_random_engine rng(123456);
+    std::vector<Point2D> points = RandomPoints(rng), centroids;
+
+    centroids.reserve(num_clusters);
+    for (size_t i = 0; i < num_clusters; ++i) {
+        centroids.emplace_back(points[rng() % points.size()]);
+    }
+
+    const std::vector<Point2D> orig_centroids = centroids;
+
+    double correct_cost = LloydCost(points, centroids);
 
     auto start_func =
         [&](Context& ctx) {
@@ -128,4 +135,67 @@ TEST(KMeans, RandomPoints) {
     api::RunLocalTests(start_func);
 }
 
+TEST(KMeans, CentroidTableMatchesDistances) {
+
+    std::default_random_engine rng(123456);
+    std::vector<Point2D> points = RandomPoints(rng);
+
+    // more centroids than one tile of the kernel
+    std::vector<Point2D> centroids(points.begin(), points.begin() + 100);
+    CentroidTable<Point2D> table(centroids);
+
+    for (const Point2D& p : points) {
+        double min_dist = std::numeric_limits<double>::max();
+        for (const Point2D& c : centroids)
+            min_dist = std::min(min_dist, p.DistanceSquare(c));
+
+        double dist;
+        size_t closest = table.Closest(p, &dist);
+        ASSERT_NEAR(min_dist, dist, 1e-6 * (1.0 + min_dist));
+        ASSERT_NEAR(min_dist, p.DistanceSquare(centroids[closest]),
+                    1e-6 * (1.0 + min_dist));
+    }
+}
+
+TEST(KMeans, ParallelInitAndMiniBatch) {
+
+    std::default_random_engine rng(123456);
+    std::vector<Point2D> points = RandomPoints(rng), centroids;
+
+    for (size_t i = 0; i < num_clusters; ++i) {
+        centroids.emplace_back(points[rng() % points.size()]);
+    }
+
+    double correct_cost = LloydCost(points, centroids);
+
+    auto start_func =
+        [&](Context& ctx) {
+            ctx.enable_consume();
+
+            auto input_points = EqualToDIA(ctx, points).Cache();
+
+            auto means = KMeans(input_points.Keep(), 2, num_clusters,
+                                iterations, 0.0, KMeansInit::Parallel);
+            ASSERT_EQ(num_clusters, means.centroids().size());
+
+            double cost = means.ComputeCost(input_points.Keep());
+            ASSERT_LE(tlx::abs_diff(cost, correct_cost) / correct_cost, 0.4);
+
+            auto batch_means = MiniBatchKMeans(
+                input_points.Keep(), 2, num_clusters, 4 * iterations,
+                num_points / 4, KMeansInit::Parallel);
+            ASSERT_EQ(num_clusters, batch_means.centroids().size());
+
+            double batch_cost = batch_means.ComputeCost(input_points);
+            if (ctx.my_rank() == 0) {
+                sLOG1 << "parallel init cost" << cost
+                      << "mini-batch cost" << batch_cost
+                      << "correct_cost" << correct_cost;
+            }
+            ASSERT_LE(batch_cost, 2.0 * correct_cost);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
@@ -98,6 +98,79 @@ TEST(PageRank, RandomZipfGraph) {
     api::RunLocalTests(start_func);
 }
 
+//! sequential PageRank iterations of the outgoing links graph
+static std::vector<double> SequentialPageRank(
+    const std::vector<OutgoingLinks>& outlinks, size_t iterations) {
+    const size_t num_pages = outlinks.size();
+    std::vector<double> ranks(num_pages, 1.0 / num_pages);
+    std::vector<double> contrib(num_pages, 0.0);
+
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t p = 0; p < num_pages; ++p) {
+            for (const PageId& tgt : outlinks[p]) {
+                contrib[tgt] +=
+                    ranks[p] / static_cast<double>(outlinks[p].size());
+            }
+        }
+        for (size_t p = 0; p < num_pages; ++p) {
+            ranks[p] = dampening * contrib[p] + (1 - dampening) / num_pages;
+            contrib[p] = 0.0;
+        }
+    }
+    return ranks;
+}
+
+TEST(PageRank, RandomZipfGraphStreaming) {
+    static constexpr size_t iterations = 5;
+    static constexpr size_t num_pages = 10000;
+
+    std::vector<OutgoingLinks> outlinks(num_pages);
+    {
+        ZipfGraphGen graph_gen(num_pages);
+        std::minstd_rand rng(123456);
+        for (size_t i = 0; i < num_pages; ++i) {
+            outlinks[i] = graph_gen.GenerateOutgoing(rng);
+        }
+    }
+
+    const std::vector<double> correct =
+        SequentialPageRank(outlinks, iterations);
+    const std::vector<double> converged = SequentialPageRank(outlinks, 100);
+
+    auto start_func =
+        [&outlinks, &correct, &converged](Context& ctx) {
+            auto links = EqualToDIA(ctx, outlinks).Cache();
+
+            auto check = [](const std::vector<double>& expected,
+                            const std::vector<double>& result, double eps) {
+                             ASSERT_EQ(expected.size(), result.size());
+                             for (size_t i = 0; i < result.size(); ++i)
+                                 ASSERT_NEAR(expected[i], result[i], eps);
+                         };
+
+            // full ranks and exact changes give the same iterations
+            PageRankStreamingConfig config;
+            check(correct, PageRankStreaming(
+                      links.Keep(), num_pages, iterations, config)
+                  .AllGather(), 1e-12);
+
+            config.delta = true;
+            check(correct, PageRankStreaming(
+                      links.Keep(), num_pages, iterations, config)
+                  .AllGather(), 1e-12);
+
+            // held back changes and the convergence check stay close to the
+            // fixed point
+            config.epsilon = 1e-12;
+            config.tolerance = 1e-9;
+            check(converged, PageRankStreaming(
+                      links.Keep(), num_pages, 100, config)
+                  .AllGather(), 1e-9);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(PageRank, RandomZipfGraphJoin) {
     static constexpr bool debug = false;
 
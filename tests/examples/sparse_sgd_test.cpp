@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * tests/examples/sparse_sgd_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <examples/stochastic_gradient_descent/sparse_sgd.hpp>
+
+#include <thrill/api/generate.hpp>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using namespace thrill;
+using namespace examples::stochastic_gradient_descent;
+
+TEST(SparseSGD, SparseAddAndQuantize) {
+    SparseVector a = {
+        { 1, 1.0 }, { 5, 2.0 }, { 9, -3.0 }
+    };
+    SparseVector b = {
+        { 0, 4.0 }, { 5, 1.0 }, { 12, 0.5 }
+    };
+
+    SparseVector c = SparseAdd(a, b);
+    ASSERT_EQ(5u, c.size());
+    const std::vector<uint64_t> index = { 0, 1, 5, 9, 12 };
+    const std::vector<double> value = { 4.0, 1.0, 3.0, -3.0, 0.5 };
+    for (size_t i = 0; i < c.size(); ++i) {
+        ASSERT_EQ(index[i], c[i].index);
+        ASSERT_DOUBLE_EQ(value[i], c[i].value);
+    }
+
+    SparseVector d = QuantizedSparseVector::Encode(c).Decode();
+    ASSERT_EQ(c.size(), d.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        ASSERT_EQ(c[i].index, d[i].index);
+        ASSERT_NEAR(c[i].value, d[i].value, 4.0 / 32767);
+    }
+}
+
+//! Generate points with a few features of many dimensions, whose labels are a
+//! linear function of the features.
+static auto GenerateSparsePoints(
+    Context& ctx, size_t num_points, size_t dimensions,
+    const std::vector<double>& model) {
+    return Generate(
+        ctx, num_points,
+        [dimensions, &model](const size_t& index) {
+            std::default_random_engine rng(index);
+            std::uniform_int_distribution<uint64_t> feature(0, dimensions - 1);
+
+            SparseDataPoint p;
+            p.features.push_back(SparseEntry { feature(rng), 1.0 });
+            uint64_t other = feature(rng);
+            if (other != p.features[0].index) {
+                p.features.push_back(SparseEntry { other, 1.0 });
+                if (other < p.features[0].index)
+                    std::swap(p.features[0], p.features[1]);
+            }
+            p.label = SparseDot(p.features, model);
+            return p;
+        })
+           .Cache();
+}
+
+static void TestLeastSquares(GradientCompression compression) {
+    static constexpr size_t dimensions = 10000;
+    static constexpr size_t num_points = 20000;
+
+    auto start_func =
+        [&](Context& ctx) {
+            std::vector<double> model(dimensions);
+            for (size_t i = 0; i < dimensions; ++i)
+                model[i] = static_cast<double>(i % 7) - 3.0;
+
+            auto points =
+                GenerateSparsePoints(ctx, num_points, dimensions, model);
+
+            SparseStochasticGradientDescent<LeastSquaresLoss> sgd(
+                dimensions, /* num_iterations */ 5, /* fraction */ 1.0,
+                /* step_size */ 2000.0, /* tolerance */ 0.0, compression);
+
+            sgd.optimize(points.Keep());
+            double first_loss = sgd.loss();
+
+            SparseStochasticGradientDescent<LeastSquaresLoss> sgd2(
+                dimensions, /* num_iterations */ 100, /* fraction */ 1.0,
+                /* step_size */ 2000.0, /* tolerance */ 0.0, compression);
+
+            std::vector<double> weights = sgd2.optimize(points);
+            ASSERT_EQ(dimensions, weights.size());
+            ASSERT_EQ(100u, sgd2.iterations());
+            ASSERT_LT(sgd2.loss(), 0.5 * first_loss);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(SparseSGD, LeastSquaresSparse) {
+    TestLeastSquares(GradientCompression::Sparse);
+}
+
+TEST(SparseSGD, LeastSquaresQuantized) {
+    TestLeastSquares(GradientCompression::Quantized);
+}
+
+/******************************************************************************/
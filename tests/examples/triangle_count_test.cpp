@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -44,6 +45,7 @@ TEST(TriangleCount, FullyConnected) {
             size_t size_over_3 = size * (size - 1) * (size - 2) / 6;
 
             ASSERT_EQ(CountTriangles(edges), size_over_3);
+            ASSERT_EQ(CountTrianglesOriented(edges), size_over_3);
         };
 
     api::RunLocalTests(start_func);
@@ -69,6 +71,8 @@ TEST(TriangleCount, FullyConnectedWithMultiEdges) {
             size_t size_over_3 = size * (size - 1) * (size - 2) / 6;
 
             ASSERT_EQ(CountTriangles(edges), size_over_3 * 8);
+            // the oriented count ignores parallel edges
+            ASSERT_EQ(CountTrianglesOriented(edges), size_over_3);
         };
 
     api::RunLocalTests(start_func);
@@ -94,6 +98,40 @@ TEST(TriangleCount, SomewhatSparse) {
             size_t size_over_3 = multiple * (size / multiple) * ((size / multiple) - 1) * ((size / multiple) - 2) / 6;
 
             ASSERT_EQ(CountTriangles(edges), size_over_3);
+            ASSERT_EQ(CountTrianglesOriented(edges), size_over_3);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(TriangleCount, OrientedMatchesJoinOnRandomGraph) {
+
+    auto start_func =
+        [&](Context& ctx) {
+            size_t size = 300;
+
+            // a hub connected to all nodes, plus random edges in both
+            // directions and self-loops, which reduce to a simple graph.
+            auto edges = Generate(ctx, size).template FlatMap<Edge>(
+                [&size](const size_t& index, auto emit) {
+                    std::default_random_engine rng(index);
+                    if (index != 0) emit(std::make_pair(index, size_t(0)));
+                    for (size_t i = 0; i < 8; ++i) {
+                        size_t target = rng() % size;
+                        emit(std::make_pair(index, target));
+                        emit(std::make_pair(target, index));
+                    }
+                }).Cache();
+
+            auto simple =
+                edges.Keep()
+                .Filter([](const Edge& e) { return e.first < e.second; })
+                .ReduceByKey(
+                    [](const Edge& e) { return e; },
+                    [](const Edge& a, const Edge& /* b */) { return a; })
+                .Cache();
+
+            ASSERT_EQ(CountTriangles(simple), CountTrianglesOriented(edges));
         };
 
     api::RunLocalTests(start_func);
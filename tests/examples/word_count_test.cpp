@@ -79,6 +79,26 @@ TEST(WordCount, BaconIpsum) {
     api::RunLocalTests(start_func);
 }
 
+TEST(WordCount, HashWordCountBaconIpsum) {
+
+    auto start_func =
+        [](Context& ctx) {
+            ctx.enable_consume();
+
+            auto lines = ReadLines(ctx, "inputs/wordcount.in");
+
+            std::vector<WordCountPair> result =
+                HashWordCountExample(lines).AllGather();
+
+            // sort result, because reducing delivers any order
+            std::sort(result.begin(), result.end());
+
+            ASSERT_EQ(bacon_ipsum_correct(), result);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 /******************************************************************************/
 // WordCount generated text
 
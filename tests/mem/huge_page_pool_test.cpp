@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * tests/mem/huge_page_pool_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/mem/huge_page_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace thrill;
+
+TEST(HugePagePool, AllocateDeallocate) {
+    mem::Manager manager(nullptr, "HugePagePoolTest");
+
+    static constexpr size_t chunk_size = 1024 * 1024;
+    mem::HugePagePool pool(manager, chunk_size, 4 * 1024 * 1024);
+
+    // allocate more chunks than fit into one slab
+    std::vector<char*> chunks;
+    for (size_t i = 0; i < 10; ++i) {
+        char* ptr = static_cast<char*>(pool.allocate());
+        if (ptr == nullptr) return; // no mmap() on this platform
+        memset(ptr, static_cast<int>(i), chunk_size);
+        chunks.push_back(ptr);
+    }
+
+    ASSERT_EQ(10 * chunk_size, manager.total());
+    ASSERT_EQ(3u, pool.num_slabs());
+
+    // chunks do not overlap and are not overwritten
+    std::vector<char*> sorted = chunks;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 1; i < sorted.size(); ++i)
+        ASSERT_GE(sorted[i], sorted[i - 1] + chunk_size);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        ASSERT_EQ(static_cast<char>(i), chunks[i][0]);
+        ASSERT_EQ(static_cast<char>(i), chunks[i][chunk_size - 1]);
+    }
+
+    // memory not from the pool is rejected
+    char other[16];
+    ASSERT_FALSE(pool.deallocate(other));
+
+    for (char* ptr : chunks)
+        ASSERT_TRUE(pool.deallocate(ptr));
+
+    ASSERT_EQ(0u, manager.total());
+    // one spare slab is kept
+    ASSERT_EQ(1u, pool.num_slabs());
+}
+
+/******************************************************************************/
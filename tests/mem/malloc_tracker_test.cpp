@@ -11,6 +11,9 @@
 #include <gtest/gtest.h>
 #include <thrill/mem/malloc_tracker.hpp>
 
+#include <limits>
+#include <vector>
+
 using namespace thrill;
 
 TEST(MallocTracker, Test1) {
@@ -35,4 +38,91 @@ TEST(MallocTracker, Test1) {
     ASSERT_LE(curr, curr2);
 }
 
+TEST(MallocTracker, MemoryLimitIndication) {
+
+    mem::flush_memory_statistics();
+    ssize_t curr = mem::malloc_tracker_current();
+
+    mem::set_memory_limit_indication(curr + 64 * 1024 * 1024);
+    ASSERT_FALSE(mem::memory_exceeded);
+
+    // allocate beyond the limit, the statistics are folded in by the threshold
+    // or at the latest by flushing.
+    char* a = reinterpret_cast<char*>(malloc(96 * 1024 * 1024));
+    a[0] = 0;
+    mem::flush_memory_statistics();
+
+    volatile char* av = a;
+    ASSERT_TRUE(mem::memory_exceeded || av[0] != 0);
+
+    free(a);
+    mem::flush_memory_statistics();
+    ASSERT_FALSE(mem::memory_exceeded);
+
+    // reset limit and threshold
+    mem::set_memory_limit_indication(std::numeric_limits<ssize_t>::max());
+    mem::set_memory_statistics_threshold(1024 * 1024);
+    ASSERT_FALSE(mem::memory_exceeded);
+}
+
+TEST(MallocTracker, DiaAttribution) {
+
+    auto find = [](size_t dia_id) {
+                    for (const mem::DiaAllocation& d :
+                         mem::malloc_tracker_dia_allocations()) {
+                        if (d.dia_id == dia_id) return d;
+                    }
+                    return mem::DiaAllocation { dia_id, 0, 0, 0 };
+                };
+
+    char* a = nullptr;
+    {
+        mem::AllocationScope scope(4242, "Test");
+        a = reinterpret_cast<char*>(malloc(8 * 1024 * 1024));
+        a[0] = 0;
+    }
+
+    volatile char* av = a;
+    mem::DiaAllocation d = find(4242);
+    ASSERT_GE(d.current + av[0], 8 * 1024 * 1024);
+    ASSERT_GE(d.peak, d.current);
+    ASSERT_GE(d.allocs, 1u);
+
+    // freeing outside the scope does not change the node's counters
+    free(a);
+    mem::flush_memory_statistics();
+    ASSERT_EQ(d.current, find(4242).current);
+}
+
+TEST(MallocTracker, AllocationSampling) {
+
+    mem::malloc_tracker_start_sampling(64 * 1024);
+    {
+        mem::AllocationScope scope(4343, "Sampled");
+        std::vector<char*> v;
+        for (size_t i = 0; i < 64; ++i) {
+            v.push_back(reinterpret_cast<char*>(malloc(16 * 1024)));
+            v.back()[0] = 0;
+        }
+        for (char* p : v) free(p);
+    }
+
+    size_t bytes = 0, depth = 0;
+    mem::malloc_tracker_stop_sampling(
+        [&](const char* label, size_t dia_id, void* const*, size_t d,
+            size_t b) {
+            if (dia_id != 4343) return;
+            ASSERT_STREQ("Sampled", label);
+            bytes += b;
+            depth = std::max(depth, d);
+        });
+
+#if defined(__linux__)
+    // one MiB allocated, sampled every 64 KiB
+    ASSERT_GE(bytes, 12u * 64 * 1024);
+    ASSERT_LE(bytes, 17u * 64 * 1024);
+    ASSERT_GT(depth, 1u);
+#endif
+}
+
 /******************************************************************************/
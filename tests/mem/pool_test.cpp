@@ -19,6 +19,7 @@
 #include <random>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -186,6 +187,55 @@ TEST(MemPool, UnorderedMap) {
     }
 }
 
+TEST(MemPool, ThreadCacheRandomAllocDealloc) {
+    mem::Pool pool(16384, /* thread_cache */ true);
+
+    auto worker = [&pool](size_t id) {
+        std::default_random_engine rng(static_cast<unsigned>(id));
+
+        size_t max_size = 512;
+        size_t iterations = 20000;
+
+        std::deque<std::pair<unsigned char*, size_t> > list;
+
+        while (iterations != 0)
+        {
+            if (rng() % 2 == 0) {
+                // allocate a memory piece and fill it
+                --iterations;
+                size_t size = (rng() % max_size) + 1;
+                unsigned char* ptr =
+                    static_cast<unsigned char*>(pool.allocate(size));
+                std::fill(ptr, ptr + size, static_cast<unsigned char>(id));
+                list.emplace_back(ptr, size);
+            }
+            else if (!list.empty()) {
+                // check and deallocate a memory piece
+                unsigned char* ptr = list.front().first;
+                size_t size = list.front().second;
+                ASSERT_EQ(size, static_cast<size_t>(std::count(
+                                                        ptr, ptr + size,
+                                                        static_cast<unsigned char>(id))));
+                pool.deallocate(ptr, size);
+                list.pop_front();
+            }
+        }
+
+        while (!list.empty()) {
+            pool.deallocate(list.front().first, list.front().second);
+            list.pop_front();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 8; ++i)
+        threads.emplace_back(worker, i);
+    for (std::thread& t : threads)
+        t.join();
+
+    pool.self_verify();
+}
+
 namespace thrill {
 namespace mem {
 
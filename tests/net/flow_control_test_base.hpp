@@ -13,12 +13,15 @@
 #define THRILL_TESTS_NET_FLOW_CONTROL_TEST_BASE_HEADER
 
 #include <gtest/gtest.h>
+#include <thrill/common/functional.hpp>
 #include <thrill/net/dispatcher.hpp>
 #include <thrill/net/flow_control_channel.hpp>
 #include <thrill/net/flow_control_manager.hpp>
 #include <thrill/net/group.hpp>
 
 #include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -135,6 +138,34 @@ static void TestMultiThreadBroadcast(net::Group* net) {
                 size_t res = channel.Broadcast(my_rank, origin);
 
                 ASSERT_EQ(res, magic);
+
+                // one copy of a vector shared by the workers of each host
+                std::vector<size_t> vec(
+                    origin == channel.my_rank() ? 1000 : 0, magic);
+
+                std::shared_ptr<const std::vector<size_t> > shared =
+                    channel.BroadcastShared(vec, origin);
+
+                ASSERT_EQ(1000u, shared->size());
+                ASSERT_EQ(magic, shared->back());
+            }
+
+            // one vector per host combined from the ranks of its workers
+            std::vector<size_t> ranks(1, channel.my_rank());
+
+            std::shared_ptr<const std::vector<size_t> > host_ranks =
+                channel.LocalCombineShared<std::vector<size_t> >(
+                    ranks, [](const std::vector<std::vector<size_t>*>& locals) {
+                        std::vector<size_t> all;
+                        for (std::vector<size_t>* l : locals)
+                            all.insert(all.end(), l->begin(), l->end());
+                        return all;
+                    });
+
+            ASSERT_EQ(count, host_ranks->size());
+            for (size_t i = 0; i < count; ++i) {
+                ASSERT_EQ(channel.my_rank() / count * count + i,
+                          (*host_ranks)[i]);
             }
         });
 }
@@ -205,6 +236,36 @@ static void TestMultiThreadAllReduce(net::Group* net) {
         });
 }
 
+/*!
+ * Starts several asynchronous AllReduces, Broadcasts, and ExPrefixSums,
+ * interleaved with synchronous collectives, and checks the results.
+ */
+static void TestMultiThreadAllReduceAsync(net::Group* net) {
+
+    const size_t count = 4;
+
+    ExecuteMultiThreads(
+        net, count, [=](net::FlowControlChannel& channel) {
+            size_t my_rank = channel.my_rank();
+            size_t num_workers = net->num_hosts() * count;
+
+            std::shared_future<size_t> f1 = channel.AllReduceAsync(my_rank);
+            std::shared_future<size_t> f2 =
+                channel.BroadcastAsync(my_rank + 42, num_workers - 1);
+            size_t res = channel.AllReduce(size_t(1));
+            std::shared_future<size_t> f3 = channel.AllReduceAsync(
+                my_rank, common::maximum<size_t>());
+            std::shared_future<size_t> f4 = channel.ExPrefixSumAsync(
+                my_rank, std::plus<size_t>(), size_t(42));
+
+            ASSERT_EQ(num_workers, res);
+            ASSERT_EQ(num_workers * (num_workers - 1) / 2, f1.get());
+            ASSERT_EQ(num_workers - 1 + 42, f2.get());
+            ASSERT_EQ(num_workers - 1, f3.get());
+            ASSERT_EQ(42 + my_rank * (my_rank + 1) / 2 - my_rank, f4.get());
+        });
+}
+
 /*!
  * Calculates a sum over all worker and thread ids.
  */
@@ -446,6 +507,39 @@ static void TestAllGatherString(net::Group* net) {
     }
 }
 
+/*!
+ * Runs the collectives hierarchically with two hosts per rack, and checks
+ * that the order of summation is kept.
+ */
+static void TestHierarchicalCollectives(net::Group* net) {
+    std::vector<size_t> racks(net->num_hosts());
+    for (size_t i = 0; i < racks.size(); ++i)
+        racks[i] = i / 2;
+
+    net::FlowControlChannelManager manager(*net, 1, racks);
+    net::FlowControlChannel& channel = manager.GetFlowControlChannel(0);
+
+    const std::string template_string = "abcdefghijklmnopqrstuvwxyz";
+    size_t my_rank = net->my_host_rank();
+    std::string my_value = template_string.substr(my_rank, 1);
+
+    std::string prefix = channel.ExPrefixSum(my_value);
+    ASSERT_EQ(template_string.substr(0, my_rank), prefix);
+
+    std::string total = channel.AllReduce(my_value);
+    ASSERT_EQ(template_string.substr(0, net->num_hosts()), total);
+
+    size_t res = channel.AllReduce(my_rank);
+    ASSERT_EQ(net->num_hosts() * (net->num_hosts() - 1) / 2, res);
+
+    for (size_t origin = 0; origin < net->num_hosts(); ++origin) {
+        size_t value = channel.Broadcast(my_rank + 42, origin);
+        ASSERT_EQ(origin + 42, value);
+    }
+
+    channel.Barrier();
+}
+
 #endif // !THRILL_TESTS_NET_FLOW_CONTROL_TEST_BASE_HEADER
 
 /******************************************************************************/
@@ -16,8 +16,10 @@
 #include <thrill/net/group.hpp>
 #include <tlx/math/round_to_power_of_two.hpp>
 
+#include <array>
 #include <functional>
 #include <future>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -214,6 +216,85 @@ static void TestAllReduceEliminationString(net::Group* net) {
     ASSERT_EQ(result.substr(0, net->num_hosts()), local_value);
 }
 
+//! broadcast large vectors, which are sent pipelined in segments
+static void TestBroadcastVectorPipelined(net::Group* net) {
+    for (size_t origin = 0; origin < net->num_hosts(); ++origin) {
+        std::vector<size_t> local_value;
+        if (net->my_host_rank() == origin) {
+            for (size_t i = 0; i < 100000; ++i)
+                local_value.push_back(i + origin);
+        }
+        net->Broadcast(local_value, origin);
+        ASSERT_EQ(100000u, local_value.size());
+        for (size_t i = 0; i < local_value.size(); ++i)
+            ASSERT_EQ(i + origin, local_value[i]);
+    }
+}
+
+//! let group of p hosts perform a segmented AllReduce on large vectors
+static void TestAllReduceVectorSegmented(net::Group* net) {
+    size_t p = net->num_hosts();
+    for (size_t size : { size_t(3), size_t(1000), size_t(100003) }) {
+        std::vector<size_t> local_value(size);
+        for (size_t i = 0; i < size; ++i)
+            local_value[i] = i * p + net->my_host_rank();
+
+        net->AllReduce(local_value, common::ComponentSum<std::vector<size_t> >());
+        ASSERT_EQ(size, local_value.size());
+        for (size_t i = 0; i < size; ++i)
+            ASSERT_EQ(i * p * p + p * (p - 1) / 2, local_value[i]);
+    }
+
+    // check that the order of summation is kept: pick left-most non-zero.
+    auto first = [](const size_t& a, const size_t& b) { return a ? a : b; };
+    using FirstSum = common::ComponentSum<std::vector<size_t>, decltype(first)>;
+
+    std::vector<size_t> first_value(1000, net->my_host_rank() + 1);
+    net->AllReduceRabenseifner(first_value, FirstSum(first));
+    for (size_t i = 0; i < first_value.size(); ++i)
+        ASSERT_EQ(1u, first_value[i]);
+}
+
+//! let group of p hosts perform pipelined prefix sums on large vectors
+static void TestPrefixSumVectorPipelined(net::Group* net) {
+    size_t p = net->num_hosts(), r = net->my_host_rank();
+    using VectorSum = common::ComponentSum<std::vector<size_t> >;
+    for (size_t size : { size_t(3), size_t(1000), size_t(100003) }) {
+        std::vector<size_t> initial(size), in_value(size);
+        for (size_t i = 0; i < size; ++i) {
+            initial[i] = i;
+            in_value[i] = i * p + r;
+        }
+        std::vector<size_t> ex_value = in_value;
+
+        net->PrefixSum(in_value, VectorSum(), initial);
+        net->ExPrefixSum(ex_value, VectorSum(), initial);
+        ASSERT_EQ(size, in_value.size());
+        ASSERT_EQ(size, ex_value.size());
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(i + (r + 1) * i * p + r * (r + 1) / 2, in_value[i]);
+            ASSERT_EQ(i + r * i * p + r * (r - 1) / 2, ex_value[i]);
+        }
+    }
+
+    // std::arrays of floats, which are summed exactly
+    using FloatArray = std::array<float, 70000>;
+    auto initial = std::make_unique<FloatArray>();
+    auto value = std::make_unique<FloatArray>();
+    initial->fill(1.0f), value->fill(static_cast<float>(r));
+    net->PrefixSum(*value, common::ComponentSum<FloatArray>(), *initial);
+    for (const float& f : *value)
+        ASSERT_EQ(static_cast<float>(1 + r * (r + 1) / 2), f);
+
+    // check that the order of summation is kept: pick left-most non-zero.
+    auto first = [](const size_t& a, const size_t& b) { return a ? a : b; };
+    std::vector<size_t> zeros(1000), first_value(1000, r + 1);
+    net->PrefixSumPipelined(first_value.data(), first_value.size(), first,
+                            zeros.data(), /* inclusive */ false);
+    for (size_t i = 0; i < first_value.size(); ++i)
+        ASSERT_EQ(r == 0 ? 0u : 1u, first_value[i]);
+}
+
 /******************************************************************************/
 // Dispatcher Tests
 
@@ -13,7 +13,10 @@
 #include <thrill/net/dispatcher_thread.hpp>
 #include <thrill/net/mock/group.hpp>
 
+#include <chrono>
+#include <functional>
 #include <thread>
+#include <vector>
 
 #include "flow_control_test_base.hpp"
 #include "group_test_base.hpp"
@@ -94,6 +97,15 @@ TEST(MockGroup, AllReduceHypercubeString) {
 TEST(MockGroup, AllReduceEliminationString) {
     MockTest(TestAllReduceEliminationString);
 }
+TEST(MockGroup, BroadcastVectorPipelined) {
+    MockTest(TestBroadcastVectorPipelined);
+}
+TEST(MockGroup, AllReduceVectorSegmented) {
+    MockTest(TestAllReduceVectorSegmented);
+}
+TEST(MockGroup, PrefixSumVectorPipelined) {
+    MockTest(TestPrefixSumVectorPipelined);
+}
 TEST(MockGroup, DispatcherSyncSendAsyncRead) {
     MockTest(TestDispatcherSyncSendAsyncRead);
 }
@@ -121,6 +133,9 @@ TEST(MockGroup, SingleThreadAllReduce) {
 TEST(MockGroup, MultiThreadAllReduce) {
     MockTestLess(TestMultiThreadAllReduce);
 }
+TEST(MockGroup, MultiThreadAllReduceAsync) {
+    MockTestLess(TestMultiThreadAllReduceAsync);
+}
 TEST(MockGroup, MultiThreadPrefixSum) {
     MockTestLess(TestMultiThreadPrefixSum);
 }
@@ -145,6 +160,58 @@ TEST(MockGroup, AllGatherMultiThreaded) {
 TEST(MockGroup, AllGatherString) {
     MockTestLess(TestAllGatherString);
 }
+TEST(MockGroup, HierarchicalCollectives) {
+    MockTestLess(TestHierarchicalCollectives);
+}
 // [[[end]]]
 
+TEST(MockGroup, NetworkModelDelays) {
+    using steady_clock = std::chrono::steady_clock;
+
+    net::mock::NetworkModel model;
+    model.latency_us = 20000;
+    model.bandwidth = 10e6;
+    model.rack_size = 2;
+    model.rack_latency_us = 60000;
+    model.rack_bandwidth = 10e6;
+
+    auto groups = net::mock::Group::ConstructLoopbackMesh(3, model);
+
+    // 1 MB at 10 MB/s plus 20 ms latency within the rack
+    std::vector<char> data(1000000, 'x'), recv(data.size());
+    steady_clock::time_point start = steady_clock::now();
+    groups[0]->connection(1).SyncSend(data.data(), data.size());
+    groups[1]->connection(0).SyncRecv(recv.data(), recv.size());
+    ASSERT_GE(steady_clock::now() - start, std::chrono::milliseconds(120));
+    ASSERT_EQ(data, recv);
+
+    // small message with 60 ms latency to the host in the other rack
+    size_t value = 42, out = 0;
+    start = steady_clock::now();
+    groups[0]->connection(2).SyncSend(&value, sizeof(value));
+    groups[2]->connection(0).SyncRecv(&out, sizeof(out));
+    ASSERT_GE(steady_clock::now() - start, std::chrono::milliseconds(60));
+    ASSERT_EQ(value, out);
+}
+
+TEST(MockGroup, NetworkModelCollectives) {
+    net::mock::NetworkModel model;
+    model.latency_us = 100;
+    model.bandwidth = 1e9;
+
+    std::function<void(net::Group*)> thread_function =
+        [](net::Group* net) {
+            TestSendReceiveAll2All(net);
+            TestPrefixSumHypercube(net);
+            TestAllReduceVectorSegmented(net);
+            TestDispatcherSyncSendAsyncRead(net);
+        };
+
+    for (size_t num_hosts : { 2, 5 }) {
+        net::ExecuteGroupThreads(
+            net::mock::Group::ConstructLoopbackMesh(num_hosts, model),
+            thread_function);
+    }
+}
+
 /******************************************************************************/
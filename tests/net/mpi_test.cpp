@@ -84,6 +84,15 @@ TEST(MpiGroup, AllReduceHypercubeString) {
 TEST(MpiGroup, AllReduceEliminationString) {
     MpiTest(TestAllReduceEliminationString);
 }
+TEST(MpiGroup, BroadcastVectorPipelined) {
+    MpiTest(TestBroadcastVectorPipelined);
+}
+TEST(MpiGroup, AllReduceVectorSegmented) {
+    MpiTest(TestAllReduceVectorSegmented);
+}
+TEST(MpiGroup, PrefixSumVectorPipelined) {
+    MpiTest(TestPrefixSumVectorPipelined);
+}
 TEST(MpiGroup, DispatcherSyncSendAsyncRead) {
     MpiTest(TestDispatcherSyncSendAsyncRead);
 }
@@ -111,6 +120,9 @@ TEST(MpiGroup, SingleThreadAllReduce) {
 TEST(MpiGroup, MultiThreadAllReduce) {
     MpiTest(TestMultiThreadAllReduce);
 }
+TEST(MpiGroup, MultiThreadAllReduceAsync) {
+    MpiTest(TestMultiThreadAllReduceAsync);
+}
 TEST(MpiGroup, MultiThreadPrefixSum) {
     MpiTest(TestMultiThreadPrefixSum);
 }
@@ -135,6 +147,9 @@ TEST(MpiGroup, AllGatherMultiThreaded) {
 TEST(MpiGroup, AllGatherString) {
     MpiTest(TestAllGatherString);
 }
+TEST(MpiGroup, HierarchicalCollectives) {
+    MpiTest(TestHierarchicalCollectives);
+}
 // [[[end]]]
 
 /******************************************************************************/
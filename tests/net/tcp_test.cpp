@@ -32,6 +32,14 @@ static void RealGroupTest(
         thread_function);
 }
 
+static void RealUnixGroupTest(
+    const std::function<void(net::Group*)>& thread_function) {
+    // execute Unix domain stream socket tests, as used for peers on one host
+    net::ExecuteGroupThreads(
+        net::tcp::Group::ConstructLocalRealTCPMesh(6, /* unix_sockets */ true),
+        thread_function);
+}
+
 static void LocalGroupTest(
     const std::function<void(net::Group*)>& thread_function) {
     // execute local stream socket tests
@@ -43,6 +51,7 @@ static void LocalGroupTest(
 /*[[[perl
   require("tests/net/test_gen.pm");
   generate_group_tests("RealTcpGroup", "RealGroupTest");
+  generate_group_tests("RealUnixGroup", "RealUnixGroupTest");
 
   generate_group_tests("LocalTcpGroup", "LocalGroupTest");
   generate_flow_control_tests("LocalTcpGroup", "LocalGroupTest");
@@ -86,12 +95,75 @@ TEST(RealTcpGroup, AllReduceHypercubeString) {
 TEST(RealTcpGroup, AllReduceEliminationString) {
     RealGroupTest(TestAllReduceEliminationString);
 }
+TEST(RealTcpGroup, BroadcastVectorPipelined) {
+    RealGroupTest(TestBroadcastVectorPipelined);
+}
+TEST(RealTcpGroup, AllReduceVectorSegmented) {
+    RealGroupTest(TestAllReduceVectorSegmented);
+}
+TEST(RealTcpGroup, PrefixSumVectorPipelined) {
+    RealGroupTest(TestPrefixSumVectorPipelined);
+}
 TEST(RealTcpGroup, DispatcherSyncSendAsyncRead) {
     RealGroupTest(TestDispatcherSyncSendAsyncRead);
 }
 TEST(RealTcpGroup, DispatcherLaunchAndTerminate) {
     RealGroupTest(TestDispatcherLaunchAndTerminate);
 }
+TEST(RealUnixGroup, NoOperation) {
+    RealUnixGroupTest(TestNoOperation);
+}
+TEST(RealUnixGroup, SendRecvCyclic) {
+    RealUnixGroupTest(TestSendRecvCyclic);
+}
+TEST(RealUnixGroup, BroadcastIntegral) {
+    RealUnixGroupTest(TestBroadcastIntegral);
+}
+TEST(RealUnixGroup, SendReceiveAll2All) {
+    RealUnixGroupTest(TestSendReceiveAll2All);
+}
+TEST(RealUnixGroup, PrefixSumHypercube) {
+    RealUnixGroupTest(TestPrefixSumHypercube);
+}
+TEST(RealUnixGroup, PrefixSumHypercubeString) {
+    RealUnixGroupTest(TestPrefixSumHypercubeString);
+}
+TEST(RealUnixGroup, PrefixSum) {
+    RealUnixGroupTest(TestPrefixSum);
+}
+TEST(RealUnixGroup, Broadcast) {
+    RealUnixGroupTest(TestBroadcast);
+}
+TEST(RealUnixGroup, Reduce) {
+    RealUnixGroupTest(TestReduce);
+}
+TEST(RealUnixGroup, ReduceString) {
+    RealUnixGroupTest(TestReduceString);
+}
+TEST(RealUnixGroup, AllReduceString) {
+    RealUnixGroupTest(TestAllReduceString);
+}
+TEST(RealUnixGroup, AllReduceHypercubeString) {
+    RealUnixGroupTest(TestAllReduceHypercubeString);
+}
+TEST(RealUnixGroup, AllReduceEliminationString) {
+    RealUnixGroupTest(TestAllReduceEliminationString);
+}
+TEST(RealUnixGroup, BroadcastVectorPipelined) {
+    RealUnixGroupTest(TestBroadcastVectorPipelined);
+}
+TEST(RealUnixGroup, AllReduceVectorSegmented) {
+    RealUnixGroupTest(TestAllReduceVectorSegmented);
+}
+TEST(RealUnixGroup, PrefixSumVectorPipelined) {
+    RealUnixGroupTest(TestPrefixSumVectorPipelined);
+}
+TEST(RealUnixGroup, DispatcherSyncSendAsyncRead) {
+    RealUnixGroupTest(TestDispatcherSyncSendAsyncRead);
+}
+TEST(RealUnixGroup, DispatcherLaunchAndTerminate) {
+    RealUnixGroupTest(TestDispatcherLaunchAndTerminate);
+}
 TEST(LocalTcpGroup, NoOperation) {
     LocalGroupTest(TestNoOperation);
 }
@@ -131,6 +203,15 @@ TEST(LocalTcpGroup, AllReduceHypercubeString) {
 TEST(LocalTcpGroup, AllReduceEliminationString) {
     LocalGroupTest(TestAllReduceEliminationString);
 }
+TEST(LocalTcpGroup, BroadcastVectorPipelined) {
+    LocalGroupTest(TestBroadcastVectorPipelined);
+}
+TEST(LocalTcpGroup, AllReduceVectorSegmented) {
+    LocalGroupTest(TestAllReduceVectorSegmented);
+}
+TEST(LocalTcpGroup, PrefixSumVectorPipelined) {
+    LocalGroupTest(TestPrefixSumVectorPipelined);
+}
 TEST(LocalTcpGroup, DispatcherSyncSendAsyncRead) {
     LocalGroupTest(TestDispatcherSyncSendAsyncRead);
 }
@@ -158,6 +239,9 @@ TEST(LocalTcpGroup, SingleThreadAllReduce) {
 TEST(LocalTcpGroup, MultiThreadAllReduce) {
     LocalGroupTest(TestMultiThreadAllReduce);
 }
+TEST(LocalTcpGroup, MultiThreadAllReduceAsync) {
+    LocalGroupTest(TestMultiThreadAllReduceAsync);
+}
 TEST(LocalTcpGroup, MultiThreadPrefixSum) {
     LocalGroupTest(TestMultiThreadPrefixSum);
 }
@@ -182,6 +266,9 @@ TEST(LocalTcpGroup, AllGatherMultiThreaded) {
 TEST(LocalTcpGroup, AllGatherString) {
     LocalGroupTest(TestAllGatherString);
 }
+TEST(LocalTcpGroup, HierarchicalCollectives) {
+    LocalGroupTest(TestHierarchicalCollectives);
+}
 // [[[end]]]
 
 /******************************************************************************/
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * tests/vfs/async_write_stream_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/async_write_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace thrill;
+
+//! collects the written bytes, optionally failing after some writes
+class StringWriteStream final : public virtual vfs::WriteStream
+{
+public:
+    StringWriteStream(std::string& out, size_t fail_after)
+        : out_(out), fail_after_(fail_after) { }
+
+    ssize_t write(const void* data, const size_t size) final {
+        if (writes_++ == fail_after_)
+            throw std::runtime_error("write failed");
+        out_.append(reinterpret_cast<const char*>(data), size);
+        return size;
+    }
+
+    void close() final { closed_ = true; }
+
+    bool closed_ = false;
+
+private:
+    std::string& out_;
+    size_t fail_after_;
+    size_t writes_ = 0;
+};
+
+TEST(AsyncWriteStream, WritesInOrder) {
+    std::string out, data;
+    auto output = tlx::make_counting<StringWriteStream>(out, size_t(-1));
+    {
+        vfs::WriteStreamPtr stream =
+            vfs::MakeAsyncWriteStream(output, /* buffer_size */ 100, 2);
+        for (size_t i = 0; i < 10000; ++i) {
+            std::string line = "line" + std::to_string(i) + "\n";
+            stream->write(line.data(), line.size());
+            data += line;
+        }
+        stream->close();
+    }
+    ASSERT_TRUE(output->closed_);
+    ASSERT_EQ(data, out);
+}
+
+TEST(AsyncWriteStream, RethrowsErrors) {
+    std::string out;
+    auto output = tlx::make_counting<StringWriteStream>(out, 3);
+    vfs::WriteStreamPtr stream =
+        vfs::MakeAsyncWriteStream(output, /* buffer_size */ 16, 1);
+
+    std::string data(16, 'x');
+    ASSERT_THROW(
+        {
+            for (size_t i = 0; i < 100; ++i)
+                stream->write(data.data(), data.size());
+            stream->close();
+        }, std::runtime_error);
+    ASSERT_EQ(std::string(3 * 16, 'x'), out);
+}
+
+/******************************************************************************/
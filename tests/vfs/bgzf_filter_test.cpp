@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * tests/vfs/bgzf_filter_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/bgzf_filter.hpp>
+
+#include <gtest/gtest.h>
+#include <thrill/vfs/gzip_filter.hpp>
+#include <thrill/vfs/sys_file.hpp>
+#include <thrill/vfs/temporary_directory.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+static std::string WriteTestFile(const std::string& path, size_t threads = 1) {
+    std::string data;
+    for (size_t i = 0; i < 100000; ++i)
+        data += "line" + std::to_string(i) + "\n";
+
+    vfs::WriteStreamPtr zs =
+        vfs::MakeBgzfWriteFilter(vfs::SysOpenWriteStream(path), threads);
+    zs->write(data.data(), data.size());
+    zs->close();
+
+    return data;
+}
+
+TEST(BgzfFilterTest, WriteReadBlocks) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string path = tmpdir.get() + "/test.dat.bgz";
+    std::string data = WriteTestFile(path);
+
+    ASSERT_TRUE(vfs::IsBgzf(path));
+
+    std::vector<uint8_t> block(vfs::BgzfReader::max_block_size);
+    std::vector<uint64_t> offsets;
+    std::string result;
+    {
+        vfs::BgzfReader reader(path, 0);
+        size_t size;
+        while (reader.ReadBlock(block.data(), &size)) {
+            offsets.push_back(reader.block_offset());
+            result.append(reinterpret_cast<char*>(block.data()), size);
+        }
+    }
+    ASSERT_GT(offsets.size(), 3u);
+    ASSERT_EQ(offsets[0], 0u);
+    ASSERT_EQ(data, result);
+
+    // BGZF files are also plain gzip files
+    {
+        vfs::ReadStreamPtr zs =
+            vfs::MakeGZipReadFilter(vfs::SysOpenReadStream(path));
+        std::string plain(data.size() + 1, 0);
+        size_t pos = 0;
+        ssize_t rb;
+        while ((rb = zs->read(&plain[pos], plain.size() - pos)) > 0)
+            pos += rb;
+        zs->close();
+        plain.resize(pos);
+        ASSERT_EQ(data, plain);
+    }
+
+    // seeking from any offset finds the next block
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        vfs::BgzfReader reader(path, offsets[i - 1] + 1);
+        size_t size;
+        ASSERT_TRUE(reader.ReadBlock(block.data(), &size));
+        ASSERT_EQ(offsets[i], reader.block_offset());
+    }
+}
+
+TEST(BgzfFilterTest, ParallelCompression) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string path1 = tmpdir.get() + "/test1.dat.bgz";
+    std::string path4 = tmpdir.get() + "/test4.dat.bgz";
+    WriteTestFile(path1, 1);
+    WriteTestFile(path4, 4);
+
+    // blocks are independent, hence the files are identical
+    auto read_file = [](const std::string& path) {
+                         vfs::ReadStreamPtr rs = vfs::SysOpenReadStream(path);
+                         std::string data, buffer(4096, 0);
+                         ssize_t rb;
+                         while ((rb = rs->read(&buffer[0], buffer.size())) > 0)
+                             data.append(buffer.data(), rb);
+                         rs->close();
+                         return data;
+                     };
+    ASSERT_EQ(read_file(path1), read_file(path4));
+}
+
+/******************************************************************************/
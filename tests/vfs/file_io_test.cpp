@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * tests/vfs/file_io_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+//! make a file list of files with blocks of 100 bytes on the given hosts
+static vfs::FileList MakeFileList(
+    const std::vector<std::vector<std::string> >& block_hosts,
+    size_t blocks_per_file) {
+    vfs::FileList files;
+    files.total_size = 0;
+    files.contains_block_locations = true;
+
+    for (size_t b = 0; b < block_hosts.size(); ++b) {
+        if (b % blocks_per_file == 0) {
+            vfs::FileInfo fi;
+            fi.type = vfs::Type::File;
+            fi.path = "hdfs://namenode/file" + std::to_string(files.size());
+            fi.size = 0;
+            fi.size_ex_psum = files.total_size;
+            files.emplace_back(fi);
+        }
+        vfs::FileInfo& fi = files.back();
+        fi.blocks.emplace_back(
+            vfs::FileBlock { fi.size, 100, block_hosts[b] });
+        fi.size += 100;
+        files.total_size += 100;
+    }
+    return files;
+}
+
+TEST(FileIO, AssignPartsByLocality) {
+    vfs::FileList files = MakeFileList(
+        { { "b" }, { "c.example.com" }, { "x", "a" }, { "a" } }, 2);
+
+    std::vector<size_t> parts = vfs::AssignPartsByLocality(
+        files, files.total_size, 1, { "a", "a.example.com", "b", "c" });
+
+    ASSERT_EQ(std::vector<size_t>({ 2, 3, 0, 1 }), parts);
+
+    // split by units of 4 bytes
+    parts = vfs::AssignPartsByLocality(
+        files, files.total_size / 4, 4, { "c", "b", "a", "a" });
+
+    ASSERT_EQ(std::vector<size_t>({ 1, 0, 2, 3 }), parts);
+}
+
+TEST(FileIO, AssignPartsByLocalityUnknownHosts) {
+    vfs::FileList files = MakeFileList(
+        { { "x" }, { "a" }, { "y" }, { "z" }, { "a" }, { "a" } }, 3);
+
+    // the workers on host a get the parts with most bytes on a, the others
+    // get the remaining parts in order.
+    std::vector<size_t> parts = vfs::AssignPartsByLocality(
+        files, files.total_size, 1, { "b", "a", "a" });
+
+    ASSERT_EQ(std::vector<size_t>({ 1, 2, 0 }), parts);
+}
+
+/******************************************************************************/
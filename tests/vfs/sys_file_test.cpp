@@ -13,7 +13,10 @@
 #include <gtest/gtest.h>
 #include <thrill/vfs/temporary_directory.hpp>
 
+#include <algorithm>
+#include <cstdlib>
 #include <string>
+#include <vector>
 
 using namespace thrill;
 
@@ -63,4 +66,47 @@ TEST(SysFileTest, WriteReadSingleFile) {
     }
 }
 
+TEST(SysFileTest, ReadDirectAndNoCache) {
+    vfs::TemporaryDirectory tmpdir;
+    std::string path = tmpdir.get() + "/test.dat";
+
+    std::vector<size_t> data(100000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = i;
+    {
+        vfs::WriteStreamPtr ws = vfs::SysOpenWriteStream(path);
+        ws->write(data.data(), data.size() * sizeof(size_t));
+    }
+
+    // small blocks to cross many block boundaries
+    setenv("THRILL_SYS_READ_BLOCK", "16Ki", 1);
+
+    for (const char* mode : { "direct", "nocache" }) {
+        setenv("THRILL_SYS_READ_MODE", mode, 1);
+
+        for (size_t begin : { 0, 1000, 77777 }) {
+            vfs::ReadStreamPtr rs = vfs::SysOpenReadStream(
+                path, common::Range(begin * sizeof(size_t), 0));
+
+            std::vector<size_t> out(data.size() - begin + 1);
+            size_t capacity = out.size() * sizeof(size_t), total = 0;
+            while (true) {
+                ssize_t rb = rs->read(
+                    reinterpret_cast<char*>(out.data()) + total,
+                    std::min<size_t>(10000, capacity - total));
+                ASSERT_GE(rb, 0);
+                if (rb == 0) break;
+                total += rb;
+            }
+            rs->close();
+
+            ASSERT_EQ((data.size() - begin) * sizeof(size_t), total);
+            for (size_t i = begin; i < data.size(); ++i)
+                ASSERT_EQ(i, out[i - begin]);
+        }
+    }
+
+    unsetenv("THRILL_SYS_READ_MODE");
+    unsetenv("THRILL_SYS_READ_BLOCK");
+}
+
 /******************************************************************************/
@@ -15,7 +15,9 @@
 
 #include <thrill/api/action_node.hpp>
 #include <thrill/api/dia.hpp>
+#include <thrill/api/gather_tree.hpp>
 
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -56,13 +58,11 @@ public:
     }
 
     void StartPreOp(size_t /* parent_index */) final {
-        emitters_ = stream_->GetWriters();
+        writer_ = file_.GetWriter();
     }
 
     void PreOp(const ValueType& element) {
-        for (size_t i = 0; i < emitters_.size(); i++) {
-            emitters_[i].Put(element);
-        }
+        writer_.Put(element);
     }
 
     bool OnPreOpFile(const data::File& file, size_t /* parent_index */) final {
@@ -72,24 +72,46 @@ public:
                 << "due to non-empty function stack.";
             return false;
         }
-        for (size_t i = 0; i < emitters_.size(); i++) {
-            emitters_[i].AppendBlocks(file.blocks());
-        }
+        writer_.AppendBlocks(file.blocks());
         return true;
     }
 
     void StopPreOp(size_t /* parent_index */) final {
-        // data has been pushed during pre-op -> close emitters
-        emitters_.Close();
+        writer_.Close();
     }
 
     //! Closes the output file
     void Execute() final {
-        auto reader = stream_->GetCatReader(/* consume */ true);
-        while (reader.HasNext()) {
-            out_vector_->push_back(reader.template Next<ValueType>());
+        size_t total_bytes = context_.net.AllReduce(file_.size_bytes());
+
+        if (UseGatherTree(context_, total_bytes)) {
+            // pass the Files around a ring of all workers
+            std::vector<data::File> files =
+                RingAllGather(context_, this->dia_id(), std::move(file_));
+            for (data::File& f : files) {
+                auto reader = f.GetConsumeReader();
+                data::ReadEachItem<ValueType>(
+                    reader, [this](const ValueType& item) {
+                        out_vector_->push_back(item);
+                    });
+            }
+            return;
+        }
+
+        // send the items directly to all workers
+        data::CatStreamPtr stream = context_.GetNewCatStream(this);
+        data::CatStream::Writers emitters = stream->GetWriters();
+        for (size_t i = 0; i < emitters.size(); i++) {
+            emitters[i].AppendBlocks(file_.blocks());
         }
-        stream_.reset();
+        file_.Clear();
+        emitters.Close();
+
+        auto reader = stream->GetCatReader(/* consume */ true);
+        data::ReadEachItem<ValueType>(
+            reader, [this](const ValueType& item) {
+                out_vector_->push_back(item);
+            });
     }
 
     const std::vector<ValueType>& result() const final {
@@ -106,8 +128,9 @@ private:
     //! take ownership of vector
     bool ownership_;
 
-    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
-    data::CatStream::Writers emitters_;
+    //! local items, which are sent in Execute() once the total size is known
+    data::File file_ { context_.GetFile(this) };
+    data::File::Writer writer_;
 };
 
 template <typename ValueType, typename Stack>
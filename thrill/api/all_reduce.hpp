@@ -16,6 +16,7 @@
 #include <thrill/api/action_node.hpp>
 #include <thrill/api/dia.hpp>
 
+#include <future>
 #include <type_traits>
 
 namespace thrill {
@@ -41,7 +42,8 @@ public:
         : Super(parent.ctx(), label, { parent.id() }, { parent.node() }),
           reduce_function_(reduce_function),
           sum_(initial_value),
-          first_(parent.ctx().my_rank() != 0) {
+          first_(parent.ctx().my_rank() != 0),
+          parent_stack_empty_(ParentDIA::stack_empty) {
         // Hook PreOp(s)
         auto pre_op_fn = [this](const ValueType& input) {
                              PreOp(input);
@@ -61,14 +63,33 @@ public:
         }
     }
 
+    //! Receive a whole data::File of ValueType, but only if our stack is empty.
+    bool OnPreOpFile(const data::File& file, size_t /* parent_index */) final {
+        if (!parent_stack_empty_) {
+            LOGC(common::g_debug_push_file)
+                << "AllReduce rejected File from parent "
+                << "due to non-empty function stack.";
+            return false;
+        }
+        // fold the File's items in batches, without a callback per item.
+        data::File::KeepReader reader = file.GetKeepReader();
+        data::ReadEachItem<ValueType>(
+            reader, [this](const ValueType& item) { PreOp(item); });
+        return true;
+    }
+
     //! Executes the sum operation.
     void Execute() final {
-        // process the reduce
-        sum_ = context_.net.AllReduce(sum_, reduce_function_);
+        // start the reduce, the result is only awaited in result().
+        future_sum_ = context_.net.AllReduceAsync(sum_, reduce_function_);
     }
 
     //! Returns result of global sum.
     const ValueType& result() const final {
+        if (future_sum_.valid()) {
+            sum_ = future_sum_.get();
+            future_sum_ = std::shared_future<ValueType>();
+        }
         return sum_;
     }
 
@@ -76,10 +97,14 @@ private:
     //! The sum function which is applied to two values.
     ReduceFunction reduce_function_;
     //! Local/global sum to be used in all reduce operation.
-    ValueType sum_;
+    mutable ValueType sum_;
+    //! Future of the global sum while the all reduce is running.
+    mutable std::shared_future<ValueType> future_sum_;
     //! indicate that sum_ is the default constructed first value. Worker 0's
     //! value is already set to initial_value.
     bool first_;
+    //! Whether the parent stack is empty
+    const bool parent_stack_empty_;
 };
 
 template <typename ValueType, typename Stack>
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * thrill/api/binary_index.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/binary_index.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/system_exception.hpp>
+
+namespace thrill {
+namespace api {
+
+static constexpr bool debug = false;
+
+//! size of number of entries and magic
+static constexpr uint64_t footer_tail_size = 2 * sizeof(uint64_t);
+
+//! read exactly size bytes from stream
+static bool ReadFull(vfs::ReadStream& stream, void* data, size_t size) {
+    char* cdata = reinterpret_cast<char*>(data);
+    while (size != 0) {
+        ssize_t rb = stream.read(cdata, size);
+        if (rb < 0)
+            throw common::ErrnoException("BinaryIndex: read error");
+        if (rb == 0)
+            return false;
+        cdata += rb, size -= rb;
+    }
+    return true;
+}
+
+uint64_t BinaryIndex::num_items() const {
+    uint64_t total = 0;
+    for (const Entry& e : entries)
+        total += e.num_items;
+    return total;
+}
+
+void BinaryIndex::Write(vfs::WriteStream& stream) const {
+    uint64_t tail[2] = { entries.size(), magic };
+    if (!entries.empty())
+        stream.write(entries.data(), entries.size() * sizeof(Entry));
+    stream.write(tail, sizeof(tail));
+}
+
+bool BinaryIndex::Read(const std::string& path, uint64_t file_size) {
+    entries.clear();
+    data_size = file_size;
+
+    if (file_size < footer_tail_size)
+        return false;
+
+    uint64_t tail[2];
+    {
+        vfs::ReadStreamPtr stream = vfs::OpenReadStream(
+            path, common::Range(file_size - footer_tail_size, file_size));
+        bool ok = ReadFull(*stream, tail, sizeof(tail));
+        stream->close();
+        if (!ok || tail[1] != magic)
+            return false;
+    }
+
+    uint64_t num_entries = tail[0];
+    if (num_entries > (file_size - footer_tail_size) / sizeof(Entry))
+        return false;
+
+    uint64_t footer_size = num_entries * sizeof(Entry) + footer_tail_size;
+    data_size = file_size - footer_size;
+
+    entries.resize(num_entries);
+    if (num_entries != 0) {
+        vfs::ReadStreamPtr stream = vfs::OpenReadStream(
+            path, common::Range(data_size, file_size - footer_tail_size));
+        bool ok = ReadFull(*stream, entries.data(),
+                           num_entries * sizeof(Entry));
+        stream->close();
+        if (!ok)
+            return false;
+    }
+
+    // verify that offsets are ascending and inside the data
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].offset >= data_size ||
+            (i != 0 && entries[i].offset <= entries[i - 1].offset)) {
+            entries.clear();
+            data_size = file_size;
+            return false;
+        }
+    }
+
+    sLOG << "BinaryIndex::Read()" << path
+         << "entries" << entries.size() << "data_size" << data_size;
+
+    return true;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
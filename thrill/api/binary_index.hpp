@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * thrill/api/binary_index.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_BINARY_INDEX_HEADER
+#define THRILL_API_BINARY_INDEX_HEADER
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Block index appended by WriteBinary to uncompressed files of variable-size
+ * items. For each written Block containing the start of an item, it records the
+ * byte offset of the first item starting in the Block and the number of items
+ * starting in it. ReadBinary uses the index to split files at item boundaries.
+ *
+ * The footer consists of the entries, followed by the number of entries and a
+ * magic number, all as native uint64_t.
+ */
+class BinaryIndex
+{
+public:
+    //! magic number at the end of a file with index ("THRLLIDX")
+    static constexpr uint64_t magic = 0x5844494C4C524854ull;
+
+    struct Entry {
+        //! byte offset of the first item starting in the block
+        uint64_t offset;
+        //! number of items starting in the block
+        uint64_t num_items;
+    };
+
+    //! index entries in order of the offsets
+    std::vector<Entry> entries;
+
+    //! size of the items in the file, excluding the footer
+    uint64_t data_size = 0;
+
+    //! add entry for a block
+    void Add(uint64_t offset, uint64_t num_items) {
+        entries.emplace_back(Entry { offset, num_items });
+    }
+
+    //! total number of items in the file
+    uint64_t num_items() const;
+
+    //! append the footer to the stream
+    void Write(vfs::WriteStream& stream) const;
+
+    //! read the footer of the uncompressed file at path of given size,
+    //! returns false if the file has no index.
+    bool Read(const std::string& path, uint64_t file_size);
+};
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_BINARY_INDEX_HEADER
+
+/******************************************************************************/
@@ -16,7 +16,9 @@
 #include <thrill/api/dia.hpp>
 #include <thrill/api/dia_node.hpp>
 #include <thrill/data/file.hpp>
+#include <thrill/data/tiered_file.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,6 +28,11 @@ namespace api {
 /*!
  * A DOpNode which caches all items in an external file.
  *
+ * With THRILL_CACHE_TIERING=1 the File is moved into a data::TieredFile after
+ * the PreOp, which keeps the first Blocks pinned, compresses the following
+ * ones, and leaves the rest to eviction, such that DIAs read in each iteration
+ * of a loop are not swapped in and out as a whole.
+ *
  * \ingroup api_layer
  */
 template <typename ValueType>
@@ -64,20 +71,55 @@ public:
     void StopPreOp(size_t /* parent_index */) final {
         // Push local elements to children
         writer_.Close();
+
+        // the cached items are those of the parent
+        const KnownSize& parent_size = this->parent_known_size(0);
+        if (parent_stack_empty_ && parent_size.known())
+            this->set_known_size(parent_size.total, parent_size.balanced);
+
+        if (context_.mem_config().enable_cache_tiering_) {
+            // per worker share of the BlockPool's hard limit
+            size_t ram = context_.mem_config().ram_block_pool_hard_
+                         / context_.workers_per_host();
+            tiered_ = std::make_unique<data::TieredFile>(
+                std::move(file_), this->dia_id(), ram / 8, ram / 4);
+        }
     }
 
     void Execute() final { }
 
     void PushData(bool consume) final {
-        this->PushFile(file_, consume);
+        if (!tiered_) {
+            this->PushFile(file_, consume);
+            return;
+        }
+
+        data::File file = tiered_->Assemble();
+        const data::TieredFile::Stats& stats = tiered_->stats();
+
+        Super::logger_
+            << "class" << "CacheNode"
+            << "event" << "tiers"
+            << "read" << stats.reads
+            << "hot_blocks" << stats.hot_blocks
+            << "warm_blocks" << stats.warm_blocks
+            << "cold_blocks" << stats.cold_blocks
+            << "cold_in_memory" << stats.cold_in_memory
+            << "warm_raw_bytes" << stats.warm_raw_bytes
+            << "warm_compressed_bytes" << stats.warm_compressed_bytes
+            << "hit_rate" << stats.hit_rate();
+
+        if (consume) tiered_->Clear();
+        this->PushFile(file, /* consume */ true);
     }
 
     void Dispose() final {
         file_.Clear();
+        tiered_.reset();
     }
 
     size_t NumItems() const {
-        return file_.num_items();
+        return tiered_ ? tiered_->num_items() : file_.num_items();
     }
 
 private:
@@ -87,6 +129,8 @@ private:
     data::File::Writer writer_ { file_.GetWriter() };
     //! Whether the parent stack is empty
     const bool parent_stack_empty_;
+    //! tiered storage of file_ after the PreOp, if enabled
+    std::unique_ptr<data::TieredFile> tiered_;
 };
 
 template <typename ValueType, typename Stack>
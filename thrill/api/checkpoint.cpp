@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * thrill/api/checkpoint.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/checkpoint.hpp>
+
+#include <thrill/common/hash.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/system_exception.hpp>
+#include <thrill/vfs/file_io.hpp>
+
+#include <tlx/string/ssprintf.hpp>
+
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+static constexpr bool debug = false;
+
+//! magic number at the end of a complete checkpoint file ("THRLLCKP")
+static constexpr uint64_t checkpoint_magic = 0x504B434C4C524854ull;
+
+//! header in front of the bytes of each Block
+struct CheckpointBlockHeader {
+    uint64_t size;
+    //! offset of the first item relative to the Block's bytes
+    uint64_t first_item;
+    uint64_t num_items;
+    uint64_t typecode_verify;
+};
+
+//! footer at the end of the file, written after all Blocks
+struct CheckpointFooter {
+    uint64_t num_blocks;
+    uint64_t num_items;
+    uint64_t num_workers;
+    uint64_t worker;
+    uint64_t magic;
+};
+
+//! read exactly size bytes from stream
+static bool ReadFull(vfs::ReadStream& stream, void* data, size_t size) {
+    char* cdata = reinterpret_cast<char*>(data);
+    while (size != 0) {
+        ssize_t rb = stream.read(cdata, size);
+        if (rb < 0)
+            throw common::ErrnoException("Checkpoint: read error");
+        if (rb == 0)
+            return false;
+        cdata += rb, size -= rb;
+    }
+    return true;
+}
+
+std::string CheckpointPath(const std::string& path, size_t worker) {
+    return path + tlx::ssprintf("-%05zu", worker);
+}
+
+//! read the footer of the worker's checkpoint file, returns false if the file
+//! is missing, incomplete, or written by another worker layout.
+static bool ReadCheckpointFooter(
+    Context& ctx, const std::string& file_path,
+    uint64_t* file_size, CheckpointFooter* footer) {
+
+    vfs::FileList files = vfs::Glob(file_path, vfs::GlobType::File);
+    if (files.size() != 1 || files[0].size < sizeof(CheckpointFooter))
+        return false;
+    *file_size = files[0].size;
+
+    vfs::ReadStreamPtr stream = vfs::OpenReadStream(
+        file_path, common::Range(*file_size - sizeof(CheckpointFooter),
+                                 *file_size));
+    bool ok = ReadFull(*stream, footer, sizeof(CheckpointFooter));
+    stream->close();
+
+    return ok && footer->magic == checkpoint_magic &&
+           footer->num_workers == ctx.num_workers() &&
+           footer->worker == ctx.my_rank();
+}
+
+void WriteCheckpoint(Context& ctx, const data::File& file,
+                     const std::string& path) {
+    std::string file_path = CheckpointPath(path, ctx.my_rank());
+    sLOG << "WriteCheckpoint()" << file_path
+         << "blocks" << file.num_blocks() << "items" << file.num_items();
+
+    vfs::WriteStreamPtr stream = vfs::OpenWriteStream(file_path);
+
+    for (const data::Block& block : file.blocks()) {
+        data::PinnedBlock pb = block.PinWait(ctx.local_worker_id());
+        CheckpointBlockHeader header {
+            pb.size(), pb.first_item_relative(), pb.num_items(),
+            pb.typecode_verify()
+        };
+        stream->write(&header, sizeof(header));
+        stream->write(pb.data_begin(), pb.size());
+    }
+
+    // the footer marks the file as complete
+    CheckpointFooter footer {
+        file.num_blocks(), file.num_items(), ctx.num_workers(), ctx.my_rank(),
+        checkpoint_magic
+    };
+    stream->write(&footer, sizeof(footer));
+    stream->close();
+}
+
+bool ReadCheckpoint(Context& ctx, const std::string& path, data::File* file) {
+    std::string file_path = CheckpointPath(path, ctx.my_rank());
+
+    uint64_t file_size;
+    CheckpointFooter footer;
+    if (!ReadCheckpointFooter(ctx, file_path, &file_size, &footer))
+        return false;
+
+    vfs::ReadStreamPtr stream = vfs::OpenReadStream(
+        file_path, common::Range(0, file_size - sizeof(CheckpointFooter)));
+
+    for (uint64_t i = 0; i < footer.num_blocks; ++i) {
+        CheckpointBlockHeader header;
+        if (!ReadFull(*stream, &header, sizeof(header)) ||
+            header.first_item > header.size)
+            return false;
+
+        data::PinnedByteBlockPtr bytes = ctx.block_pool().AllocateByteBlock(
+            header.size, ctx.local_worker_id());
+        if (!ReadFull(*stream, bytes->data(), header.size))
+            return false;
+
+        file->AppendBlock(
+            data::PinnedBlock(
+                std::move(bytes), 0, header.size, header.first_item,
+                header.num_items, header.typecode_verify != 0).MoveToBlock());
+    }
+    stream->close();
+
+    sLOG << "ReadCheckpoint()" << file_path
+         << "blocks" << file->num_blocks() << "items" << file->num_items();
+
+    return file->num_items() == footer.num_items;
+}
+
+bool CheckpointExists(Context& ctx, const std::string& path) {
+    uint64_t file_size;
+    CheckpointFooter footer;
+    bool exists = ReadCheckpointFooter(
+        ctx, CheckpointPath(path, ctx.my_rank()), &file_size, &footer);
+
+    // restore only if the checkpoint of every worker is complete
+    return ctx.net.AllReduce(size_t(exists ? 0 : 1)) == 0;
+}
+
+std::string SourceCachePath(
+    Context& ctx, const std::string& cache_dir,
+    const std::vector<std::string>& inputs, const std::string& version,
+    const char* type_name) {
+
+    std::string desc = version + '\0' + type_name + '\0' +
+                       std::to_string(ctx.num_workers());
+    for (const vfs::FileInfo& fi : vfs::Glob(inputs, vfs::GlobType::File)) {
+        desc += '\0' + fi.path + '\0' + std::to_string(fi.size) +
+                '\0' + std::to_string(fi.mtime);
+    }
+
+    std::string path = cache_dir + tlx::ssprintf(
+        "/source-%016llx", static_cast<unsigned long long>(
+            common::HashWyhashBytes(desc.data(), desc.size())));
+    sLOG << "SourceCachePath()" << path << "version" << version;
+    return path;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * thrill/api/checkpoint.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_CHECKPOINT_HEADER
+#define THRILL_API_CHECKPOINT_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dia_node.hpp>
+#include <thrill/data/file.hpp>
+
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Checkpoint files contain the Blocks of one worker's data::File, each as a
+ * header with its size, first item offset, and number of items followed by its
+ * bytes, and a footer with the worker layout and a magic number, which marks
+ * the file as complete. All fields are native uint64_t.
+ */
+
+//! path of the checkpoint file of worker
+std::string CheckpointPath(const std::string& path, size_t worker);
+
+//! write the Blocks of the local worker's file to its checkpoint file
+void WriteCheckpoint(Context& ctx, const data::File& file,
+                     const std::string& path);
+
+//! append the Blocks of the local worker's checkpoint file to file, returns
+//! false if the file is missing or damaged.
+bool ReadCheckpoint(Context& ctx, const std::string& path, data::File* file);
+
+//! whether the checkpoint files of all workers are complete and were written
+//! with the same number of workers. Must be called by all workers.
+bool CheckpointExists(Context& ctx, const std::string& path);
+
+//! base path of the checkpoint files of CacheSource() in cache_dir: a hash of
+//! the paths, sizes, and modification times of the files matched by the input
+//! globs, the version, the item type's name, and the number of workers.
+std::string SourceCachePath(
+    Context& ctx, const std::string& cache_dir,
+    const std::vector<std::string>& inputs, const std::string& version,
+    const char* type_name);
+
+/*!
+ * A DOpNode which caches all items like CacheNode and writes the Blocks of its
+ * File to a checkpoint file per worker. When restoring, the node has no
+ * parents and reads the Blocks back, such that the stages computing the items
+ * are not run.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType>
+class CheckpointNode final : public DIANode<ValueType>
+{
+public:
+    using Super = DIANode<ValueType>;
+    using Super::context_;
+
+    //! Constructor caching the parent's items and writing the checkpoint.
+    template <typename ParentDIA>
+    CheckpointNode(const ParentDIA& parent, const std::string& path)
+        : Super(parent.ctx(), "Checkpoint", { parent.id() }, { parent.node() }),
+          path_(path),
+          parent_stack_empty_(ParentDIA::stack_empty) {
+        auto save_fn = [this](const ValueType& input) {
+                           writer_.Put(input);
+                       };
+        auto lop_chain = parent.stack().push(save_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    //! Constructor restoring the items from the checkpoint.
+    CheckpointNode(Context& ctx, const std::string& path)
+        : Super(ctx, "Checkpoint", { /* parent_ids */ }, { /* parents */ }),
+          path_(path), parent_stack_empty_(true), restore_(true) {
+        // the Blocks are appended directly in Execute()
+        writer_.Close();
+    }
+
+    bool OnPreOpFile(const data::File& file, size_t /* parent_index */) final {
+        if (!parent_stack_empty_) {
+            LOGC(common::g_debug_push_file)
+                << "Checkpoint rejected File from parent "
+                << "due to non-empty function stack.";
+            return false;
+        }
+        assert(file_.num_items() == 0);
+        file_ = file.Copy();
+        return true;
+    }
+
+    void StopPreOp(size_t /* parent_index */) final {
+        writer_.Close();
+    }
+
+    void Execute() final {
+        if (restore_) {
+            if (!ReadCheckpoint(context_, path_, &file_))
+                die("Checkpoint: cannot restore " +
+                    CheckpointPath(path_, context_.my_rank()));
+        }
+        else {
+            WriteCheckpoint(context_, file_, path_);
+        }
+
+        Super::logger_
+            << "class" << "CheckpointNode"
+            << "event" << (restore_ ? "restored" : "written")
+            << "path" << path_
+            << "blocks" << file_.num_blocks()
+            << "items" << file_.num_items();
+    }
+
+    void PushData(bool consume) final {
+        this->PushFile(file_, consume);
+    }
+
+    void Dispose() final {
+        file_.Clear();
+    }
+
+private:
+    //! Local data file
+    data::File file_ { context_.GetFile(this) };
+    //! Data writer to local file (only active in PreOp).
+    data::File::Writer writer_ { file_.GetWriter() };
+    //! path of the checkpoint files
+    std::string path_;
+    //! Whether the parent stack is empty
+    const bool parent_stack_empty_;
+    //! Whether the items are read from the checkpoint
+    const bool restore_ = false;
+};
+
+template <typename ValueType, typename Stack>
+DIA<ValueType> DIA<ValueType, Stack>::Checkpoint(
+    const std::string& path) const {
+    assert(IsValid());
+
+    if (CheckpointExists(ctx(), path)) {
+        return DIA<ValueType>(
+            tlx::make_counting<api::CheckpointNode<ValueType> >(ctx(), path));
+    }
+    return DIA<ValueType>(
+        tlx::make_counting<api::CheckpointNode<ValueType> >(*this, path));
+}
+
+template <typename ValueType, typename Stack>
+DIA<ValueType> DIA<ValueType, Stack>::CacheSource(
+    const std::string& cache_dir, const std::vector<std::string>& inputs,
+    const std::string& version) const {
+    assert(IsValid());
+
+    return Checkpoint(
+        SourceCachePath(ctx(), cache_dir, inputs, version,
+                        typeid(ValueType).name()));
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_CHECKPOINT_HEADER
+
+/******************************************************************************/
@@ -188,6 +188,85 @@ public:
     void Execute() final {
         LOG << "ConcatNode::Execute() processing";
 
+        if (ChildrenOrderAgnostic()) {
+            // all consumers ignore the order of items: keep them local like a
+            // Union() and skip the exchange.
+            Super::logger_
+                << "class" << "ConcatNode"
+                << "event" << "skip-exchange";
+            return;
+        }
+
+        Exchange();
+    }
+
+    void PushData(bool consume) final {
+
+        // a child added after Execute() may depend on the order.
+        if (!exchanged_ && !ChildrenOrderAgnostic())
+            Exchange();
+
+        size_t total = 0;
+        // concatenate all local Files or all CatStreams
+        for (size_t in = 0; in < num_inputs_; ++in) {
+            if (!exchanged_) {
+                data::File::Reader reader = files_[in].GetReader(consume);
+
+                while (reader.HasNext()) {
+                    this->PushItem(reader.Next<ValueType>());
+                    ++total;
+                }
+                continue;
+            }
+
+            data::CatStream::CatReader reader =
+                streams_[in]->GetCatReader(consume);
+
+            while (reader.HasNext()) {
+                this->PushItem(reader.Next<ValueType>());
+                ++total;
+            }
+        }
+        LOG << "total = " << total;
+    }
+
+    void Dispose() final {
+        files_.clear();
+        writers_.clear();
+        streams_.clear();
+    }
+
+private:
+    //! number of input DIAs
+    const size_t num_inputs_;
+
+    //! Whether the parent stack is empty
+    const std::vector<bool> parent_stack_empty_;
+
+    //! Files for intermediate storage
+    std::vector<data::File> files_;
+    //! Writers to intermediate files
+    std::vector<data::File::Writer> writers_;
+
+    //! Array of CatStreams for exchange
+    std::vector<data::CatStreamPtr> streams_;
+
+    //! whether the Files were exchanged into the CatStreams
+    bool exchanged_ = false;
+
+    //! whether all children ignore the order of the concatenated items
+    bool ChildrenOrderAgnostic() const {
+        std::vector<DIABase*> children = this->children();
+        return !children.empty() &&
+               std::all_of(children.begin(), children.end(),
+                           [](DIABase* c) { return c->OrderAgnostic(); });
+    }
+
+    //! Redistribute the Files into CatStreams, such that the workers hold the
+    //! globally ordered concatenation in equal parts.
+    void Exchange() {
+        exchanged_ = true;
+
         using VectorSizeT = std::vector<size_t>;
 
         VectorSizeT local_sizes(num_inputs_);
@@ -276,43 +355,6 @@ public:
                 files_[in], offsets);
         }
     }
-
-    void PushData(bool consume) final {
-
-        size_t total = 0;
-        // concatenate all CatStreams
-        for (size_t in = 0; in < num_inputs_; ++in) {
-            data::CatStream::CatReader reader =
-                streams_[in]->GetCatReader(consume);
-
-            while (reader.HasNext()) {
-                this->PushItem(reader.Next<ValueType>());
-                ++total;
-            }
-        }
-        LOG << "total = " << total;
-    }
-
-    void Dispose() final {
-        files_.clear();
-        writers_.clear();
-        streams_.clear();
-    }
-
-private:
-    //! number of input DIAs
-    const size_t num_inputs_;
-
-    //! Whether the parent stack is empty
-    const std::vector<bool> parent_stack_empty_;
-
-    //! Files for intermediate storage
-    std::vector<data::File> files_;
-    //! Writers to intermediate files
-    std::vector<data::File::Writer> writers_;
-
-    //! Array of CatStreams for exchange
-    std::vector<data::CatStreamPtr> streams_;
 };
 
 /*!
@@ -322,6 +364,9 @@ private:
  * The concat operation balances all input data, so that each worker will have
  * an equal number of elements when the concat completes.
  *
+ * If all consumers ignore the order of items, like ReduceByKey(), the exchange
+ * is skipped and the workers keep their local items as with Union().
+ *
  * \param first_dia first DIA
  * \param dias DIAs, which are concatd with the first DIA.
  *
@@ -346,6 +391,9 @@ auto Concat(const FirstDIA& first_dia, const DIAs& ... dias) {
  * The concat operation balances all input data, so that each worker will have
  * an equal number of elements when the concat completes.
  *
+ * If all consumers ignore the order of items, like ReduceByKey(), the exchange
+ * is skipped and the workers keep their local items as with Union().
+ *
  * \param dias DIAs, which is concatenated.
  *
  * \ingroup dia_dops_free
@@ -368,6 +416,9 @@ auto Concat(const std::initializer_list<DIA<ValueType> >& dias) {
  * The concat operation balances all input data, so that each worker will have
  * an equal number of elements when the concat completes.
  *
+ * If all consumers ignore the order of items, like ReduceByKey(), the exchange
+ * is skipped and the workers keep their local items as with Union().
+ *
  * \param dias DIAs, which is concatenated.
  *
  * \ingroup dia_dops_free
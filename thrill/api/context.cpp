@@ -12,19 +12,26 @@
 #include <thrill/api/context.hpp>
 
 #include <thrill/api/dia_base.hpp>
+#include <thrill/api/progress_reporter.hpp>
+#include <thrill/common/cpu_placement.hpp>
 #include <thrill/common/linux_proc_stats.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/common/porting.hpp>
 #include <thrill/common/profile_thread.hpp>
+#include <thrill/common/spill_disks.hpp>
 #include <thrill/common/string.hpp>
 #include <thrill/common/system_exception.hpp>
+#include <thrill/data/eviction_policy.hpp>
+#include <thrill/mem/malloc_tracker.hpp>
 #include <thrill/vfs/file_io.hpp>
+#include <thrill/vfs/s3_file.hpp>
 
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/mng/config.hpp>
 #include <tlx/math/abs_diff.hpp>
 #include <tlx/port/setenv.hpp>
+#include <tlx/string/ends_with.hpp>
 #include <tlx/string/format_si_iec_units.hpp>
 #include <tlx/string/parse_si_iec_units.hpp>
 #include <tlx/string/split.hpp>
@@ -34,6 +41,7 @@
 
 #if THRILL_HAVE_NET_TCP
 #include <thrill/net/tcp/construct.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
 #include <thrill/net/tcp/select_dispatcher.hpp>
 #endif
 
@@ -43,6 +51,7 @@
 #endif
 
 #if THRILL_HAVE_NET_IB
+#include <thrill/net/ib/dispatcher.hpp>
 #include <thrill/net/ib/group.hpp>
 #endif
 
@@ -74,8 +83,12 @@
 
 #include <algorithm>
 #include <csignal>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -163,7 +176,8 @@ RunLoopbackThreads(
 
                     ctx.Launch(job_startpoint);
                 });
-            common::SetCpuAffinity(threads[id], core_offset + id);
+            common::SetCpuAffinity(
+                threads[id], common::CpuPlacementCpu(core_offset + id));
         }
     }
 
@@ -271,6 +285,23 @@ static inline size_t FindWorkersPerHost(
     return std::thread::hardware_concurrency();
 }
 
+//! parse a space- or comma-separated list of rack ids, one for each host.
+static inline bool ParseRackList(const char* str, std::vector<size_t>* racks) {
+    std::vector<std::string> list = tlx::split(' ', str);
+    if (list.size() == 1)
+        tlx::split(&list, ',', str);
+
+    racks->clear();
+    for (const std::string& rack : list) {
+        if (rack.empty()) continue;
+        char* endptr;
+        racks->push_back(std::strtoul(rack.c_str(), &endptr, 10));
+        if (endptr == nullptr || *endptr != 0)
+            return false;
+    }
+    return true;
+}
+
 static inline bool Initialize() {
 
     if (!SetupBlockSize()) return false;
@@ -509,6 +540,10 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
     }
 
     const char* env_hostlist = getenv("THRILL_HOSTLIST");
+    const char* env_connections = getenv("THRILL_TCP_CONNECTIONS");
+    const char* env_zerocopy = getenv("THRILL_TCP_ZEROCOPY");
+    const char* env_busy_poll = getenv("THRILL_TCP_BUSY_POLL");
+    const char* env_unix_sockets = getenv("THRILL_TCP_UNIX_SOCKETS");
 
     // parse environment variables
 
@@ -533,6 +568,8 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
     }
 
     std::vector<std::string> hostlist;
+    // rack ids annotated as host:port@rack
+    std::vector<size_t> hostlist_racks;
 
     if (env_hostlist != nullptr && *env_hostlist != 0) {
         // first try to split by spaces, then by commas
@@ -553,7 +590,28 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
                 return -1;
             }
 
-            hostlist.push_back(host);
+            std::string::size_type at = host.find('@');
+            if (at != std::string::npos) {
+                std::string rack = host.substr(at + 1);
+                hostlist_racks.push_back(
+                    std::strtoul(rack.c_str(), &endptr, 10));
+                if (rack.empty() || endptr == nullptr || *endptr != 0) {
+                    std::cerr << "Thrill: invalid rack annotation in \""
+                              << host << "\" in THRILL_HOSTLIST."
+                              << std::endl;
+                    return -1;
+                }
+            }
+
+            hostlist.push_back(host.substr(0, at));
+        }
+
+        if (!hostlist_racks.empty() &&
+            hostlist_racks.size() != hostlist.size()) {
+            std::cerr << "Thrill: either all or no hosts in THRILL_HOSTLIST"
+                      << " must be annotated with @rack."
+                      << std::endl;
+            return -1;
         }
 
         if (my_host_rank >= hostlist.size()) {
@@ -570,6 +628,68 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
         return -1;
     }
 
+    // number of parallel TCP connections per peer for the data Multiplexer
+
+    size_t data_connections = 1;
+
+    if (env_connections != nullptr && *env_connections != 0) {
+        data_connections = std::strtoul(env_connections, &endptr, 10);
+
+        if (endptr == nullptr || *endptr != 0 || data_connections == 0) {
+            std::cerr << "Thrill: environment variable THRILL_TCP_CONNECTIONS="
+                      << env_connections << " is not a valid number."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    // send large batches of the data Multiplexer with MSG_ZEROCOPY
+
+    bool zero_copy = false;
+
+    if (env_zerocopy != nullptr && *env_zerocopy != 0) {
+        int i = std::strtol(env_zerocopy, &endptr, 10);
+
+        if (endptr == nullptr || *endptr != 0 || (i != 0 && i != 1)) {
+            std::cerr << "Thrill: environment variable THRILL_TCP_ZEROCOPY="
+                      << env_zerocopy << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        zero_copy = (i == 1);
+    }
+
+    // connect peers with the same address via Unix domain sockets
+
+    bool unix_sockets = true;
+
+    if (env_unix_sockets != nullptr && *env_unix_sockets != 0) {
+        int i = std::strtol(env_unix_sockets, &endptr, 10);
+
+        if (endptr == nullptr || *endptr != 0 || (i != 0 && i != 1)) {
+            std::cerr << "Thrill: environment variable THRILL_TCP_UNIX_SOCKETS="
+                      << env_unix_sockets << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        unix_sockets = (i == 1);
+    }
+
+    // microseconds of busy polling in blocking receives of the collectives
+
+    size_t busy_poll = 0;
+
+    if (env_busy_poll != nullptr && *env_busy_poll != 0) {
+        busy_poll = std::strtoul(env_busy_poll, &endptr, 10);
+
+        if (endptr == nullptr || *endptr != 0) {
+            std::cerr << "Thrill: environment variable THRILL_TCP_BUSY_POLL="
+                      << env_busy_poll << " is not a valid number."
+                      << std::endl;
+            return -1;
+        }
+    }
+
     // determine number of local worker threads per process
 
     const char* str_workers_per_host;
@@ -587,6 +707,10 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
     if (mem_config.setup_detect() < 0) return -1;
     mem_config.print(workers_per_host);
 
+    // THRILL_RACKS takes precedence over the hostlist's annotations
+    if (mem_config.racks_.empty())
+        mem_config.racks_ = hostlist_racks;
+
     // okay, configuration is good.
 
     std::cerr << "Thrill: running in tcp network with " << hostlist.size()
@@ -595,28 +719,51 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
               << " as rank " << my_host_rank << " and endpoints";
     for (const std::string& ep : hostlist)
         std::cerr << ' ' << ep;
+    if (data_connections != 1)
+        std::cerr << " using " << data_connections
+                  << " data connections per peer";
     std::cerr << std::endl;
 
     if (!Initialize()) return -1;
 
     static constexpr size_t kGroupCount = net::Manager::kGroupCount;
 
-    // construct three TCP network groups
-    auto select_dispatcher = std::make_unique<net::tcp::SelectDispatcher>();
+    // construct TCP network groups: flow, data, and additional data lanes.
+    auto tcp_dispatcher = std::make_unique<net::tcp::Group::Dispatcher>();
 
-    std::array<std::unique_ptr<net::tcp::Group>, kGroupCount> groups;
+    std::vector<std::unique_ptr<net::tcp::Group> > groups(
+        kGroupCount + data_connections - 1);
     net::tcp::Construct(
-        *select_dispatcher, my_host_rank, hostlist,
-        groups.data(), net::Manager::kGroupCount);
+        *tcp_dispatcher, my_host_rank, hostlist,
+        groups.data(), groups.size(), unix_sockets);
+
+    size_t zero_copy_failed = 0;
+    for (size_t p = 0; p < hostlist.size(); ++p) {
+        if (p == my_host_rank) continue;
+        // the flow group's collectives wait in blocking receives
+        if (busy_poll != 0)
+            groups[0]->tcp_connection(p).GetSocket().SetBusyPoll(busy_poll);
+        // the data groups send pinned Blocks through the write queues
+        for (size_t g = 1; zero_copy && g < groups.size(); ++g) {
+            if (!groups[g]->tcp_connection(p).EnableZeroCopy())
+                ++zero_copy_failed;
+        }
+    }
+    if (zero_copy_failed != 0) {
+        // e.g. Unix domain sockets to peers on this host
+        std::cerr << "Thrill: MSG_ZEROCOPY is not supported on "
+                  << zero_copy_failed << " data connections,"
+                  << " which send with copies." << std::endl;
+    }
 
-    std::array<net::GroupPtr, kGroupCount> host_groups = {
-        { std::move(groups[0]), std::move(groups[1]) }
-    };
+    std::vector<net::GroupPtr> host_groups(
+        std::make_move_iterator(groups.begin()),
+        std::make_move_iterator(groups.end()));
 
     // construct HostContext
 
     auto dispatcher = std::make_unique<net::DispatcherThread>(
-        std::move(select_dispatcher), my_host_rank);
+        std::move(tcp_dispatcher), my_host_rank, mem_config.dispatcher_core(0));
 
     HostContext host_context(
         0, mem_config,
@@ -632,7 +779,8 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
 
                 ctx.Launch(job_startpoint);
             });
-        common::SetCpuAffinity(threads[worker], worker);
+        common::SetCpuAffinity(
+            threads[worker], common::CpuPlacementCpu(worker));
     }
 
     // join worker threads
@@ -661,6 +809,24 @@ int RunBackendMpi(const std::function<void(Context&)>& job_startpoint) {
     if (workers_per_host == 0)
         return -1;
 
+    // number of MPI communicators used for Stream data by the Multiplexer
+
+    size_t data_comms = 1;
+
+    const char* env_comms = getenv("THRILL_MPI_COMMUNICATORS");
+
+    if (env_comms != nullptr && *env_comms != 0) {
+        char* endptr;
+        data_comms = std::strtoul(env_comms, &endptr, 10);
+
+        if (endptr == nullptr || *endptr != 0 || data_comms == 0) {
+            std::cerr << "Thrill: environment variable THRILL_MPI_COMMUNICATORS="
+                      << env_comms << " is not a valid number."
+                      << std::endl;
+            return -1;
+        }
+    }
+
     // reserve one thread for MPI net::Dispatcher which runs a busy-waiting loop
 
     if (workers_per_host == 1) {
@@ -689,23 +855,28 @@ int RunBackendMpi(const std::function<void(Context&)>& job_startpoint) {
 
     std::cerr << "Thrill: running in MPI network with " << num_hosts
               << " hosts and " << workers_per_host << "+1 workers per host"
-              << " with " << hostname << " as rank " << mpi_rank << "."
-              << std::endl;
+              << " with " << hostname << " as rank " << mpi_rank;
+    if (data_comms != 1)
+        std::cerr << " using " << data_comms << " data communicators";
+    std::cerr << "." << std::endl;
 
     if (!Initialize()) return -1;
 
     static constexpr size_t kGroupCount = net::Manager::kGroupCount;
 
-    // construct three MPI network groups
+    // construct MPI network groups: flow, data, and additional data lanes,
+    // each with its own communicator.
     auto dispatcher = std::make_unique<net::DispatcherThread>(
-        std::make_unique<net::mpi::Dispatcher>(num_hosts), mpi_rank);
+        std::make_unique<net::mpi::Dispatcher>(num_hosts), mpi_rank,
+        mem_config.dispatcher_core(0));
 
-    std::array<std::unique_ptr<net::mpi::Group>, kGroupCount> groups;
-    net::mpi::Construct(num_hosts, *dispatcher, groups.data(), kGroupCount);
+    std::vector<std::unique_ptr<net::mpi::Group> > groups(
+        kGroupCount + data_comms - 1);
+    net::mpi::Construct(num_hosts, *dispatcher, groups.data(), groups.size());
 
-    std::array<net::GroupPtr, kGroupCount> host_groups = {
-        { std::move(groups[0]), std::move(groups[1]) }
-    };
+    std::vector<net::GroupPtr> host_groups(
+        std::make_move_iterator(groups.begin()),
+        std::make_move_iterator(groups.end()));
 
     // construct HostContext
     HostContext host_context(
@@ -724,7 +895,8 @@ int RunBackendMpi(const std::function<void(Context&)>& job_startpoint) {
 
                 ctx.Launch(job_startpoint);
             });
-        common::SetCpuAffinity(threads[worker], worker);
+        common::SetCpuAffinity(
+            threads[worker], common::CpuPlacementCpu(worker));
     }
 
     // join worker threads
@@ -774,9 +946,13 @@ int RunBackendIb(const std::function<void(Context&)>& job_startpoint) {
 
     static constexpr size_t kGroupCount = net::Manager::kGroupCount;
 
-    // construct two MPI network groups
+    // construct two InfiniBand network groups, which are bootstrapped via MPI
+    auto dispatcher = std::make_unique<net::DispatcherThread>(
+        std::make_unique<net::ib::Dispatcher>(), mpi_rank,
+        mem_config.dispatcher_core(0));
+
     std::array<std::unique_ptr<net::ib::Group>, kGroupCount> groups;
-    net::ib::Construct(num_hosts, groups.data(), kGroupCount);
+    net::ib::Construct(num_hosts, *dispatcher, groups.data(), kGroupCount);
 
     std::array<net::GroupPtr, kGroupCount> host_groups = {
         { std::move(groups[0]), std::move(groups[1]) }
@@ -784,7 +960,8 @@ int RunBackendIb(const std::function<void(Context&)>& job_startpoint) {
 
     // construct HostContext
     HostContext host_context(
-        0, mem_config, std::move(host_groups), workers_per_host);
+        0, mem_config,
+        std::move(dispatcher), std::move(host_groups), workers_per_host);
 
     // launch worker threads
     std::vector<std::thread> threads(workers_per_host);
@@ -798,7 +975,8 @@ int RunBackendIb(const std::function<void(Context&)>& job_startpoint) {
 
                 ctx.Launch(job_startpoint);
             });
-        common::SetCpuAffinity(threads[worker], worker);
+        common::SetCpuAffinity(
+            threads[worker], common::CpuPlacementCpu(worker));
     }
 
     // join worker threads
@@ -909,12 +1087,59 @@ public:
 };
 
 void FoxxllConfig::load_default_config() {
-    TLX_LOG1 << "foxxll: Using default disk configuration.";
-    foxxll::disk_config entry1(
-        default_disk_path(), 1000 * 1024 * 1024, default_disk_io_impl());
-    entry1.unlink_on_open = true;
-    entry1.autogrow = true;
-    add_disk(entry1);
+    // THRILL_SPILL_DIRS: one spill file in each directory, across which
+    // evicted Blocks are striped.
+    std::vector<common::SpillDisk> disks;
+    const char* env_spill_dirs = getenv("THRILL_SPILL_DIRS");
+    if (env_spill_dirs != nullptr && *env_spill_dirs != 0) {
+        if (!common::ParseSpillDisks(env_spill_dirs, &disks)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_SPILL_DIRS=" << env_spill_dirs
+                      << " is not a list of dir[:io_impl]."
+                      << " Using default disk." << std::endl;
+        }
+        else if (disks.empty()) {
+            std::cerr << "Thrill: THRILL_SPILL_DIRS=auto found no NVMe drives."
+                      << " Using default disk." << std::endl;
+        }
+    }
+
+    if (disks.empty()) {
+        TLX_LOG1 << "foxxll: Using default disk configuration.";
+        foxxll::disk_config entry1(
+            default_disk_path(), 1000 * 1024 * 1024, default_disk_io_impl());
+        entry1.unlink_on_open = true;
+        entry1.autogrow = true;
+        add_disk(entry1);
+        return;
+    }
+
+#if !FOXXLL_WINDOWS
+    std::string pid = common::to_str(getpid());
+#else
+    std::string pid = common::to_str(GetCurrentProcessId());
+#endif
+
+    for (size_t i = 0; i < disks.size(); ++i) {
+        std::string io_impl = disks[i].io_impl;
+        if (io_impl.empty()) {
+#if FOXXLL_HAVE_LINUXAIO_FILE
+            // asynchronous I/O keeps the queues of SSDs filled
+            io_impl = common::IsNonRotationalDisk(disks[i].dir)
+                      ? "linuxaio" : default_disk_io_impl();
+#else
+            io_impl = default_disk_io_impl();
+#endif
+        }
+        std::string path =
+            disks[i].dir + "/thrill." + pid + "." + common::to_str(i) + ".tmp";
+
+        TLX_LOG1 << "foxxll: spilling to " << path << " with " << io_impl;
+        foxxll::disk_config entry(path, 1000 * 1024 * 1024, io_impl);
+        entry.unlink_on_open = true;
+        entry.autogrow = true;
+        add_disk(entry);
+    }
 }
 
 std::string FoxxllConfig::default_disk_path() {
@@ -1074,6 +1299,342 @@ int MemoryConfig::setup_detect() {
 #endif
     }
 
+    const char* env_adaptive_merge = getenv("THRILL_ADAPTIVE_MERGE");
+    if (env_adaptive_merge != nullptr && *env_adaptive_merge != 0) {
+        char* endptr;
+        long adaptive_merge = std::strtol(env_adaptive_merge, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (adaptive_merge != 0 && adaptive_merge != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_ADAPTIVE_MERGE=" << env_adaptive_merge
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_adaptive_merge_ = (adaptive_merge != 0);
+    }
+
+    const char* env_replacement_selection =
+        getenv("THRILL_REPLACEMENT_SELECTION");
+    if (env_replacement_selection != nullptr &&
+        *env_replacement_selection != 0) {
+        char* endptr;
+        long replacement_selection =
+            std::strtol(env_replacement_selection, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (replacement_selection != 0 && replacement_selection != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_REPLACEMENT_SELECTION="
+                      << env_replacement_selection
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_replacement_selection_ = (replacement_selection != 0);
+    }
+
+    const char* env_parallel_local_sort =
+        getenv("THRILL_PARALLEL_LOCAL_SORT");
+    if (env_parallel_local_sort != nullptr && *env_parallel_local_sort != 0) {
+        char* endptr;
+        long parallel_local_sort =
+            std::strtol(env_parallel_local_sort, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (parallel_local_sort != 0 && parallel_local_sort != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_PARALLEL_LOCAL_SORT="
+                      << env_parallel_local_sort
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_parallel_local_sort_ = (parallel_local_sort != 0);
+    }
+
+    const char* env_stream_compression = getenv("THRILL_STREAM_COMPRESSION");
+    if (env_stream_compression != nullptr && *env_stream_compression != 0) {
+        char* endptr;
+        long stream_compression =
+            std::strtol(env_stream_compression, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (stream_compression != 0 && stream_compression != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_STREAM_COMPRESSION=" << env_stream_compression
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_stream_compression_ = (stream_compression != 0);
+    }
+
+    const char* env_flow_control = getenv("THRILL_FLOW_CONTROL");
+    if (env_flow_control != nullptr && *env_flow_control != 0) {
+        char* endptr;
+        long flow_control = std::strtol(env_flow_control, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (flow_control != 0 && flow_control != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_FLOW_CONTROL=" << env_flow_control
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_flow_control_ = (flow_control != 0);
+    }
+
+    const char* env_adaptive_block_size = getenv("THRILL_ADAPTIVE_BLOCK_SIZE");
+    if (env_adaptive_block_size != nullptr && *env_adaptive_block_size != 0) {
+        char* endptr;
+        long adaptive_block_size =
+            std::strtol(env_adaptive_block_size, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (adaptive_block_size != 0 && adaptive_block_size != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_ADAPTIVE_BLOCK_SIZE="
+                      << env_adaptive_block_size
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_adaptive_block_size_ = (adaptive_block_size != 0);
+    }
+
+    const char* env_spill_compression = getenv("THRILL_SPILL_COMPRESSION");
+    if (env_spill_compression != nullptr && *env_spill_compression != 0) {
+        char* endptr;
+        long spill_compression =
+            std::strtol(env_spill_compression, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (spill_compression != 0 && spill_compression != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_SPILL_COMPRESSION=" << env_spill_compression
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_spill_compression_ = (spill_compression != 0);
+    }
+
+    const char* env_huge_pages = getenv("THRILL_HUGE_PAGES");
+    if (env_huge_pages != nullptr && *env_huge_pages != 0) {
+        char* endptr;
+        long huge_pages = std::strtol(env_huge_pages, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (huge_pages != 0 && huge_pages != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_HUGE_PAGES=" << env_huge_pages
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_huge_pages_ = (huge_pages != 0);
+    }
+
+    const char* env_numa_arenas = getenv("THRILL_NUMA_ARENAS");
+    if (env_numa_arenas != nullptr && *env_numa_arenas != 0) {
+        char* endptr;
+        long numa_arenas = std::strtol(env_numa_arenas, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (numa_arenas != 0 && numa_arenas != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_NUMA_ARENAS=" << env_numa_arenas
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_numa_arenas_ = (numa_arenas != 0);
+    }
+
+    const char* env_mmap_read_binary = getenv("THRILL_MMAP_READ_BINARY");
+    if (env_mmap_read_binary != nullptr && *env_mmap_read_binary != 0) {
+        char* endptr;
+        long mmap_read_binary = std::strtol(env_mmap_read_binary, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (mmap_read_binary != 0 && mmap_read_binary != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_MMAP_READ_BINARY=" << env_mmap_read_binary
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_mmap_read_binary_ = (mmap_read_binary != 0);
+    }
+
+    const char* env_io_threads = getenv("THRILL_IO_THREADS");
+    if (env_io_threads != nullptr && *env_io_threads != 0) {
+        char* endptr;
+        io_threads_ = std::strtoul(env_io_threads, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 || io_threads_ == 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_IO_THREADS=" << env_io_threads
+                      << " is not a positive number of threads."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_steal_interval = getenv("THRILL_SOURCE_STEAL_INTERVAL");
+    if (env_steal_interval != nullptr && *env_steal_interval != 0) {
+        char* endptr;
+        source_steal_interval_ = std::strtoul(env_steal_interval, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_SOURCE_STEAL_INTERVAL=" << env_steal_interval
+                      << " is not a number of milliseconds."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_write_queue = getenv("THRILL_WRITE_QUEUE_BLOCKS");
+    if (env_write_queue != nullptr && *env_write_queue != 0) {
+        char* endptr;
+        write_queue_blocks_ = std::strtoul(env_write_queue, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_WRITE_QUEUE_BLOCKS=" << env_write_queue
+                      << " is not a number of blocks."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_gather_tree = getenv("THRILL_GATHER_TREE_BYTES");
+    if (env_gather_tree != nullptr && *env_gather_tree != 0) {
+        uint64_t gather_tree_bytes;
+        if (!tlx::parse_si_iec_units(env_gather_tree, &gather_tree_bytes)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_GATHER_TREE_BYTES=" << env_gather_tree
+                      << " is not a valid amount of bytes."
+                      << std::endl;
+            return -1;
+        }
+        gather_tree_bytes_ = static_cast<size_t>(gather_tree_bytes);
+    }
+
+    const char* env_stage_overlap = getenv("THRILL_STAGE_OVERLAP");
+    if (env_stage_overlap != nullptr && *env_stage_overlap != 0) {
+        char* endptr;
+        long stage_overlap = std::strtol(env_stage_overlap, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (stage_overlap != 0 && stage_overlap != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_STAGE_OVERLAP=" << env_stage_overlap
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_stage_overlap_ = (stage_overlap != 0);
+    }
+
+    const char* env_cache_tiering = getenv("THRILL_CACHE_TIERING");
+    if (env_cache_tiering != nullptr && *env_cache_tiering != 0) {
+        char* endptr;
+        long cache_tiering = std::strtol(env_cache_tiering, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (cache_tiering != 0 && cache_tiering != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_CACHE_TIERING=" << env_cache_tiering
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_cache_tiering_ = (cache_tiering != 0);
+    }
+
+    const char* env_perf_counters = getenv("THRILL_PERF_COUNTERS");
+    if (env_perf_counters != nullptr && *env_perf_counters != 0) {
+        char* endptr;
+        long perf_counters = std::strtol(env_perf_counters, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 ||
+            (perf_counters != 0 && perf_counters != 1)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_PERF_COUNTERS=" << env_perf_counters
+                      << " is not either 0 or 1."
+                      << std::endl;
+            return -1;
+        }
+        enable_perf_counters_ = (perf_counters != 0);
+    }
+
+    const char* env_eviction_policy = getenv("THRILL_EVICTION_POLICY");
+    if (env_eviction_policy != nullptr && *env_eviction_policy != 0) {
+        if (!data::MakeEvictionPolicy(env_eviction_policy)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_EVICTION_POLICY=" << env_eviction_policy
+                      << " is not one of lru, mru, or dia."
+                      << std::endl;
+            return -1;
+        }
+        eviction_policy_ = env_eviction_policy;
+    }
+
+    const char* env_mmap_spill = getenv("THRILL_MMAP_SPILL");
+    if (env_mmap_spill != nullptr && *env_mmap_spill != 0) {
+        mmap_spill_dir_ = env_mmap_spill;
+    }
+
+    const char* env_placement = getenv("THRILL_PLACEMENT");
+    if (env_placement != nullptr && *env_placement != 0) {
+        if (!common::ParseCpuPlacement(env_placement, &cpu_placement_)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_PLACEMENT=" << env_placement
+                      << " is not one of linear, compact, scatter, or physical."
+                      << std::endl;
+            return -1;
+        }
+    }
+    // place the threads launched hereafter
+    common::SetCpuPlacement(cpu_placement_);
+
+    const char* env_dispatcher_threads = getenv("THRILL_DISPATCHER_THREADS");
+    if (env_dispatcher_threads != nullptr && *env_dispatcher_threads != 0) {
+        char* endptr;
+        dispatcher_threads_ = std::strtoul(env_dispatcher_threads, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0 || dispatcher_threads_ == 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_DISPATCHER_THREADS=" << env_dispatcher_threads
+                      << " is not a positive number of threads."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_dispatcher_cores = getenv("THRILL_DISPATCHER_CORES");
+    if (env_dispatcher_cores != nullptr && *env_dispatcher_cores != 0) {
+        if (!ParseRackList(env_dispatcher_cores, &dispatcher_cores_)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_DISPATCHER_CORES=" << env_dispatcher_cores
+                      << " is not a list of core ids."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_racks = getenv("THRILL_RACKS");
+    if (env_racks != nullptr && *env_racks != 0) {
+        if (!ParseRackList(env_racks, &racks_)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_RACKS=" << env_racks
+                      << " is not a list of rack ids."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_host_weights = getenv("THRILL_HOST_WEIGHTS");
+    if (env_host_weights != nullptr && *env_host_weights != 0) {
+        if (!ParseRackList(env_host_weights, &host_weights_) ||
+            std::accumulate(host_weights_.begin(), host_weights_.end(),
+                            size_t(0)) == 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_HOST_WEIGHTS=" << env_host_weights
+                      << " is not a list of weights, of which one is positive."
+                      << std::endl;
+            return -1;
+        }
+    }
+
     apply();
 
     return 0;
@@ -1104,6 +1665,14 @@ MemoryConfig MemoryConfig::divide(size_t hosts) const {
     return mc;
 }
 
+size_t MemoryConfig::dispatcher_core(size_t i) const {
+    if (!dispatcher_cores_.empty())
+        return dispatcher_cores_[i % dispatcher_cores_.size()];
+
+    size_t num_slots = common::CpuPlacementSlots();
+    return common::CpuPlacementCpu(num_slots - 1 - i % num_slots);
+}
+
 void MemoryConfig::print(size_t workers_per_host) const {
     if (!verbose_) return;
 
@@ -1126,6 +1695,18 @@ HostContext::HostContext(
     std::unique_ptr<net::DispatcherThread> dispatcher,
     std::array<net::GroupPtr, net::Manager::kGroupCount>&& groups,
     size_t workers_per_host)
+    : HostContext(local_host_id, mem_config, std::move(dispatcher),
+                  std::vector<net::GroupPtr>(
+                      std::make_move_iterator(groups.begin()),
+                      std::make_move_iterator(groups.end())),
+                  workers_per_host) { }
+
+HostContext::HostContext(
+    size_t local_host_id,
+    const MemoryConfig& mem_config,
+    std::unique_ptr<net::DispatcherThread> dispatcher,
+    std::vector<net::GroupPtr>&& groups,
+    size_t workers_per_host)
     : mem_config_(mem_config),
       base_logger_(MakeHostLogPath(groups[0]->my_host_rank())),
       logger_(&base_logger_, "host_rank", groups[0]->my_host_rank()),
@@ -1138,17 +1719,195 @@ HostContext::HostContext(
     // write command line parameters to json log
     common::LogCmdlineParams(logger_);
 
+    if (!mem_config_.host_weights_.empty() &&
+        mem_config_.host_weights_.size() != net_manager_.num_hosts()) {
+        if (local_host_id == 0) {
+            std::cerr << "Thrill: THRILL_HOST_WEIGHTS contains "
+                      << mem_config_.host_weights_.size() << " weights for "
+                      << net_manager_.num_hosts() << " hosts, using equal"
+                      << " parts instead." << std::endl;
+        }
+        mem_config_.host_weights_.clear();
+    }
+
     if (mem_config_.enable_proc_profiler_)
         StartLinuxProcStatsProfiler(*profiler_, logger_);
 
     // run memory profiler only on local host 0 (especially for test runs)
     if (local_host_id == 0)
         mem::StartMemProfiler(*profiler_, logger_);
+
+    // the CPU profiler samples all threads of the process, hence also only
+    // on local host 0.
+    const char* env_cpu_profile = getenv("THRILL_CPU_PROFILE");
+    if (local_host_id == 0 && env_cpu_profile != nullptr &&
+        *env_cpu_profile != 0) {
+        cpu_profiler_ = std::make_unique<common::SamplingProfiler>(
+            std::string(env_cpu_profile) + "-host-"
+            + std::to_string(net_manager_.my_host_rank()) + ".folded");
+    }
+
+    // likewise, allocations are sampled process-wide.
+    const char* env_alloc_profile = getenv("THRILL_ALLOC_PROFILE");
+    if (local_host_id == 0 && env_alloc_profile != nullptr &&
+        *env_alloc_profile != 0) {
+        alloc_profile_path_ =
+            std::string(env_alloc_profile) + "-host-"
+            + std::to_string(net_manager_.my_host_rank()) + ".folded";
+        mem::malloc_tracker_start_sampling(512 * 1024);
+    }
+
+    StartMetricsServer();
+    StartProgressReporter();
 }
 
 HostContext::~HostContext() {
-    // stop dispatcher _before_ stopping multiplexer
+    // stop progress reports _before_ the Multiplexer closes
+    if (progress_reporter_) {
+        profiler_->Remove(progress_reporter_.get());
+        progress_reporter_.reset();
+    }
+
+    // stop serving metrics _before_ the collected objects are destroyed
+    metrics_server_.reset();
+
+    if (!alloc_profile_path_.empty()) {
+        std::map<common::SamplingProfiler::StackKey, size_t> stacks;
+        mem::malloc_tracker_stop_sampling(
+            [&stacks](const char* label, size_t dia_id,
+                      void* const* frames, size_t depth, size_t bytes) {
+                stacks[common::SamplingProfiler::StackKey(
+                           label, dia_id,
+                           std::vector<void*>(frames, frames + depth))]
+                    += bytes;
+            });
+
+        std::ofstream os(alloc_profile_path_);
+        if (os.good())
+            common::SamplingProfiler::WriteStacks(os, stacks);
+        else
+            LOG1 << "HostContext: could not open " << alloc_profile_path_;
+    }
+    // stop dispatchers _before_ stopping multiplexer
     dispatcher_->Terminate();
+    for (std::unique_ptr<net::DispatcherThread>& d : data_dispatchers_)
+        d->Terminate();
+}
+
+std::vector<std::unique_ptr<net::DispatcherThread> >
+HostContext::ConstructDataDispatchers() {
+    std::vector<std::unique_ptr<net::DispatcherThread> > dispatchers;
+
+    // the MPI and InfiniBand backends funnel all requests through the
+    // dispatcher of their Groups.
+    net::Group& group = *net_manager_.GetDataGroups()[0];
+    if (group.num_parallel_async() != 0)
+        return dispatchers;
+
+    for (size_t i = 1; i < mem_config_.dispatcher_threads_; ++i) {
+        dispatchers.emplace_back(
+            std::make_unique<net::DispatcherThread>(
+                group.ConstructDispatcher(), host_rank(),
+                mem_config_.dispatcher_core(i)));
+    }
+    return dispatchers;
+}
+
+std::vector<net::DispatcherThread*> HostContext::data_dispatchers() {
+    std::vector<net::DispatcherThread*> dispatchers = { dispatcher_.get() };
+    for (std::unique_ptr<net::DispatcherThread>& d : data_dispatchers_)
+        dispatchers.push_back(d.get());
+    return dispatchers;
+}
+
+void HostContext::StartProgressReporter() {
+    const char* env_progress = getenv("THRILL_PROGRESS");
+    if (env_progress == nullptr || *env_progress == 0)
+        return;
+
+    char* endptr;
+    double interval = strtod(env_progress, &endptr);
+    if (*endptr != 0 || !(interval > 0)) {
+        std::cerr << "Thrill: environment variable"
+                  << " THRILL_PROGRESS=" << env_progress
+                  << " is not a valid interval in seconds."
+                  << std::endl;
+        return;
+    }
+
+    progress_reporter_ = std::make_unique<ProgressReporter>(*this);
+    profiler_->Add(
+        std::chrono::milliseconds(static_cast<uint64_t>(interval * 1000)),
+        progress_reporter_.get());
+}
+
+void HostContext::StartMetricsServer() {
+    const char* env_port = getenv("THRILL_METRICS_PORT");
+    if (env_port == nullptr || *env_port == 0)
+        return;
+
+    char* endptr;
+    unsigned long port = strtoul(env_port, &endptr, 10);
+    if (*endptr != 0 || port == 0 || port + local_host_id_ > 65535) {
+        std::cerr << "Thrill: environment variable"
+                  << " THRILL_METRICS_PORT=" << env_port
+                  << " is not a valid port number."
+                  << std::endl;
+        return;
+    }
+
+    // local hosts of test runs listen on consecutive ports.
+    metrics_server_ = std::make_unique<MetricsServer>(
+        static_cast<uint16_t>(port + local_host_id_));
+
+    size_t host_rank = net_manager_.my_host_rank();
+    metrics_server_->Add(
+        [this, host_rank](common::MetricsWriter& mw) {
+            mw.Gauge("host_rank", "Rank of this host.", host_rank);
+
+            common::CollectLinuxProcMetrics(mw);
+
+            mw.Gauge("malloc_bytes", "Bytes currently allocated by malloc.",
+                     mem::malloc_tracker_current());
+            mw.Gauge("malloc_peak_bytes", "Peak bytes allocated by malloc.",
+                     mem::malloc_tracker_peak());
+            mw.Counter("malloc_allocs_total", "Number of malloc calls.",
+                       mem::malloc_tracker_total_allocs());
+
+            net::Traffic traffic = net_manager_.Traffic();
+            mw.Counter("net_tx_bytes_total", "Bytes sent over the network.",
+                       traffic.tx);
+            mw.Counter("net_rx_bytes_total",
+                       "Bytes received over the network.", traffic.rx);
+
+            block_pool_.CollectMetrics(mw);
+            data_multiplexer_.CollectMetrics(mw);
+
+            auto label = [](size_t w) {
+                             return "worker=\"" + std::to_string(w) + "\"";
+                         };
+
+            mw.Family("stages_executed_total", "counter",
+                      "Number of stages executed by a local worker.");
+            for (size_t w = 0; w < workers_per_host_; ++w)
+                mw.Sample(stage_progress_[w].executed.load(), label(w));
+
+            mw.Family("stages_pushed_total", "counter",
+                      "Number of stages which pushed data to their children.");
+            for (size_t w = 0; w < workers_per_host_; ++w)
+                mw.Sample(stage_progress_[w].pushed.load(), label(w));
+
+            mw.Family("stage_dia_id", "gauge",
+                      "DIA id of the running or last stage of a local worker.");
+            for (size_t w = 0; w < workers_per_host_; ++w)
+                mw.Sample(stage_progress_[w].dia_id.load(), label(w));
+        });
+
+    if (mem_config_.verbose_) {
+        std::cerr << "Thrill: serving metrics of host " << host_rank
+                  << " on port " << metrics_server_->port() << "."
+                  << std::endl;
+    }
 }
 
 std::string HostContext::MakeHostLogPath(size_t host_rank) {
@@ -1170,6 +1929,12 @@ std::string HostContext::MakeHostLogPath(size_t host_rank) {
     if (output == "stdout")
         return "/dev/stdout";
 
+    // a path ending with ".tlog" selects the binary log format
+    if (tlx::ends_with(output, ".tlog")) {
+        return output.substr(0, output.size() - 5)
+               + "-host-" + std::to_string(host_rank) + ".tlog";
+    }
+
     return output + "-host-" + std::to_string(host_rank) + ".json";
 }
 
@@ -1177,22 +1942,134 @@ std::string HostContext::MakeHostLogPath(size_t host_rank) {
 // Context methods
 
 Context::Context(HostContext& host_context, size_t local_worker_id)
-    : local_host_id_(host_context.local_host_id()),
+    : Context(host_context, local_worker_id, host_context.worker_mem_limit())
+{ }
+
+Context::Context(HostContext& host_context, size_t local_worker_id,
+                 size_t mem_limit, size_t job_id)
+    : host_context_(host_context),
+      local_host_id_(host_context.local_host_id()),
       local_worker_id_(local_worker_id),
       workers_per_host_(host_context.workers_per_host()),
-      mem_limit_(host_context.worker_mem_limit()),
+      mem_limit_(mem_limit),
+      job_id_(job_id),
       mem_config_(host_context.mem_config()),
       mem_manager_(host_context.mem_manager()),
       net_manager_(host_context.net_manager()),
       flow_manager_(host_context.flow_manager()),
       block_pool_(host_context.block_pool()),
       multiplexer_(host_context.data_multiplexer()),
+      worker_share_(host_context.worker_share()),
+      work_pool_(host_context.work_pool()),
+      stage_progress_(host_context.stage_progress(local_worker_id)),
       rng_(std::random_device { }
            () + (local_worker_id_ << 16)),
       base_logger_(&host_context.base_logger_) {
     assert(local_worker_id < workers_per_host());
 }
 
+common::PerfCounters* Context::perf_counters() {
+    if (!perf_counters_opened_) {
+        perf_counters_opened_ = true;
+        if (mem_config_.enable_perf_counters_) {
+            perf_counters_ = std::make_unique<common::PerfCounters>();
+            if (!perf_counters_->available()) {
+                if (my_rank() == 0) {
+                    std::cerr << "Thrill: could not open hardware performance"
+                              << " counters, check perf_event_paranoid."
+                              << std::endl;
+                }
+                perf_counters_.reset();
+            }
+        }
+    }
+    return perf_counters_.get();
+}
+
+size_t Context::CalculatePartBegin(size_t global_size, size_t worker) const {
+    assert(worker <= num_workers());
+
+    const std::vector<size_t>& weights = mem_config_.host_weights_;
+    if (weights.empty()) {
+        return common::Range(0, global_size)
+               .CalculateBeginOfPart(worker, num_workers());
+    }
+    assert(weights.size() == num_hosts());
+
+    // all workers of a host have the host's weight
+    size_t host = worker / workers_per_host();
+    size_t local = worker % workers_per_host();
+
+    uint64_t total = 0, prefix = 0;
+    for (size_t h = 0; h < weights.size(); ++h) {
+        if (h < host) prefix += weights[h];
+        total += weights[h];
+    }
+    prefix *= workers_per_host();
+    total *= workers_per_host();
+    if (host < weights.size())
+        prefix += local * weights[host];
+
+    if (prefix == total)
+        return global_size;
+    return static_cast<size_t>(
+        static_cast<long double>(global_size) * prefix / total);
+}
+
+common::Range Context::CalculateLocalRange(
+    const vfs::FileList& files, size_t global_size, size_t unit_size) {
+
+    if (!files.contains_block_locations)
+        return CalculateLocalRange(global_size);
+
+    // collect host names of all workers
+    std::vector<std::string> hosts(num_workers());
+    hosts[my_rank()] = common::GetHostname();
+    hosts = net.AllReduce(
+        hosts, [](std::vector<std::string> a, const std::vector<std::string>& b) {
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].empty()) a[i] = b[i];
+            }
+            return a;
+        });
+
+    std::vector<size_t> parts = vfs::AssignPartsByLocality(
+        files, global_size, unit_size, hosts);
+
+    return common::CalculateLocalRange(
+        global_size, num_workers(), parts[my_rank()]);
+}
+
+const char * ProgressPhaseName(ProgressPhase phase) {
+    switch (phase) {
+    case ProgressPhase::PreOp:
+        return "preop";
+    case ProgressPhase::Execute:
+        return "execute";
+    case ProgressPhase::PushData:
+        return "pushdata";
+    default:
+        return "none";
+    }
+}
+
+void Context::StartProgress(
+    DIABase* dia, ProgressPhase phase, uint64_t total_items) {
+    // reset the counters before publishing the new node, since the reporter
+    // may read them at any time.
+    stage_progress_.progress_dia_id.store(0, std::memory_order_relaxed);
+    stage_progress_.progress_items.store(0, std::memory_order_relaxed);
+    stage_progress_.progress_bytes.store(0, std::memory_order_relaxed);
+    stage_progress_.progress_total_items.store(
+        total_items, std::memory_order_relaxed);
+    stage_progress_.progress_phase.store(
+        static_cast<uint8_t>(phase), std::memory_order_relaxed);
+    stage_progress_.progress_label.store(
+        dia->label(), std::memory_order_relaxed);
+    stage_progress_.progress_dia_id.store(
+        dia->dia_id(), std::memory_order_release);
+}
+
 data::File Context::GetFile(DIABase* dia) {
     return GetFile(dia != nullptr ? dia->dia_id() : 0);
 }
@@ -1207,7 +2084,7 @@ data::FilePtr Context::GetFilePtr(DIABase* dia) {
 }
 
 data::CatStreamPtr Context::GetNewCatStream(size_t dia_id) {
-    return multiplexer_.GetNewCatStream(local_worker_id_, dia_id);
+    return multiplexer_.GetNewCatStream(local_worker_id_, dia_id, job_id_);
 }
 
 data::CatStreamPtr Context::GetNewCatStream(DIABase* dia) {
@@ -1215,7 +2092,7 @@ data::CatStreamPtr Context::GetNewCatStream(DIABase* dia) {
 }
 
 data::MixStreamPtr Context::GetNewMixStream(size_t dia_id) {
-    return multiplexer_.GetNewMixStream(local_worker_id_, dia_id);
+    return multiplexer_.GetNewMixStream(local_worker_id_, dia_id, job_id_);
 }
 
 data::MixStreamPtr Context::GetNewMixStream(DIABase* dia) {
@@ -1278,6 +2155,9 @@ void Context::Launch(const std::function<void(Context&)>& job_startpoint) {
 
     common::StatsTimerStart overall_timer;
 
+    // tag the ByteBlocks allocated by this thread with the job
+    data::BlockPool::JobScope job_scope(job_id_);
+
     try {
         job_startpoint(*this);
     }
@@ -1296,6 +2176,26 @@ void Context::Launch(const std::function<void(Context&)>& job_startpoint) {
             << "event" << "job-done"
             << "elapsed" << overall_timer;
 
+    if (local_worker_id_ == 0) {
+        // counters are per process, hence only logged by the first worker
+        vfs::S3ReadStats s3_stats = vfs::S3GetReadStats();
+        if (s3_stats.requests != 0) {
+            logger_ << "class" << "S3ReadStream"
+                    << "event" << "stats"
+                    << "requests" << s3_stats.requests
+                    << "retries" << s3_stats.retries
+                    << "bytes" << s3_stats.bytes;
+        }
+        vfs::S3WriteStats s3_write_stats = vfs::S3GetWriteStats();
+        if (s3_write_stats.requests != 0) {
+            logger_ << "class" << "S3WriteStream"
+                    << "event" << "stats"
+                    << "requests" << s3_write_stats.requests
+                    << "retries" << s3_write_stats.retries
+                    << "bytes" << s3_write_stats.bytes;
+        }
+    }
+
     overall_timer.Stop();
 
     // collect overall statistics
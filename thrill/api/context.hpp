@@ -14,22 +14,32 @@
 #ifndef THRILL_API_CONTEXT_HEADER
 #define THRILL_API_CONTEXT_HEADER
 
+#include <thrill/api/metrics_server.hpp>
 #include <thrill/common/config.hpp>
+#include <thrill/common/cpu_placement.hpp>
 #include <thrill/common/defines.hpp>
 #include <thrill/common/json_logger.hpp>
+#include <thrill/common/perf_counters.hpp>
 #include <thrill/common/profile_task.hpp>
+#include <thrill/common/sampling_profiler.hpp>
+#include <thrill/common/work_stealing_pool.hpp>
+#include <thrill/common/worker_share.hpp>
 #include <thrill/data/block_pool.hpp>
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/file.hpp>
 #include <thrill/data/mix_stream.hpp>
 #include <thrill/data/multiplexer.hpp>
+#include <thrill/net/dispatcher_thread.hpp>
 #include <thrill/net/flow_control_channel.hpp>
 #include <thrill/net/flow_control_manager.hpp>
 #include <thrill/net/manager.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <random>
 #include <string>
@@ -37,6 +47,11 @@
 #include <vector>
 
 namespace thrill {
+
+namespace vfs {
+struct FileList;
+} // namespace vfs
+
 namespace api {
 
 //! \ingroup api_layer
@@ -44,6 +59,15 @@ namespace api {
 
 // forward declarations
 class DIABase;
+class ProgressReporter;
+
+//! phase of a stage whose progress a DIA node reports
+enum class ProgressPhase : uint8_t {
+    None, PreOp, Execute, PushData
+};
+
+//! lower case name of a ProgressPhase
+const char * ProgressPhaseName(ProgressPhase phase);
 
 class MemoryConfig
 {
@@ -80,6 +104,123 @@ public:
 
     //! enable Linux /proc stats profiler (default: on)
     bool enable_proc_profiler_ = true;
+
+    //! adapt merge degree and prefetch to the observed read throughput in
+    //! external merges (default: off, set THRILL_ADAPTIVE_MERGE=1)
+    bool enable_adaptive_merge_ = false;
+
+    //! let Sort form runs longer than its memory by replacement selection
+    //! once the received items overflow (default: off, set
+    //! THRILL_REPLACEMENT_SELECTION=1)
+    bool enable_replacement_selection_ = false;
+
+    //! let Sort split large runs and sort the parts in parallel on cores
+    //! borrowed from idle local workers (default: on, set
+    //! THRILL_PARALLEL_LOCAL_SORT=0)
+    bool enable_parallel_local_sort_ = true;
+
+    //! compress Blocks sent over the network with LZ4, if available (default:
+    //! off, set THRILL_STREAM_COMPRESSION=1)
+    bool enable_stream_compression_ = false;
+
+    //! hold Blocks at the sender until the receiving worker returns credits,
+    //! which it defers while its BlockPool is over budget (default: off, set
+    //! THRILL_FLOW_CONTROL=1)
+    bool enable_flow_control_ = false;
+
+    //! let streams adapt their Block size to the observed volume per target
+    //! worker, and coalesce small Blocks sent over the network (default: off,
+    //! set THRILL_ADAPTIVE_BLOCK_SIZE=1)
+    bool enable_adaptive_block_size_ = false;
+
+    //! compress Blocks evicted to external memory with LZ4, if available
+    //! (default: off, set THRILL_SPILL_COMPRESSION=1)
+    bool enable_spill_compression_ = false;
+
+    //! allocate ByteBlocks from slabs backed by huge pages (default: off, set
+    //! THRILL_HUGE_PAGES=1)
+    bool enable_huge_pages_ = false;
+
+    //! policy selecting unpinned Blocks to evict: lru, mru, or dia (default:
+    //! lru, set THRILL_EVICTION_POLICY)
+    std::string eviction_policy_ = "lru";
+
+    //! directory of a memory-mapped spill file used instead of foxxll's disks
+    //! (default: empty, set THRILL_MMAP_SPILL=dir)
+    std::string mmap_spill_dir_;
+
+    //! place ByteBlocks on the NUMA node of the worker they are allocated for
+    //! (default: off, set THRILL_NUMA_ARENAS=1)
+    bool enable_numa_arenas_ = false;
+
+    //! let ReadBinary memory-map local files of fixed-size items into
+    //! ByteBlocks instead of reading them (default: off, set
+    //! THRILL_MMAP_READ_BINARY=1)
+    bool enable_mmap_read_binary_ = false;
+
+    //! threads reading the local range of uncompressed ReadLines inputs, which
+    //! may exceed the cores for I/O-bound sources like S3 (default: 1, set
+    //! THRILL_IO_THREADS)
+    size_t io_threads_ = 1;
+
+    //! interval in milliseconds in which the workers of uncompressed ReadLines
+    //! and of fixed-size ReadBinary inputs re-split the unread chunks of the
+    //! slowest workers to those which are done (default: 0 = off, set
+    //! THRILL_SOURCE_STEAL_INTERVAL)
+    size_t source_steal_interval_ = 0;
+
+    //! number of filled buffers which WriteLines and WriteBinary queue for a
+    //! background thread compressing and writing them, or zero to write
+    //! synchronously (default: 2, set THRILL_WRITE_QUEUE_BLOCKS)
+    size_t write_queue_blocks_ = 2;
+
+    //! total size of a Gather, AllGather, or Distribute over all workers from
+    //! which on it forwards the data in a binomial tree or a ring instead of
+    //! sending it directly to the targets (default: 64 MiB, set
+    //! THRILL_GATHER_TREE_BYTES)
+    size_t gather_tree_bytes_ = 64 * 1024 * 1024;
+
+    //! let the StageBuilder interleave the stages of independent branches,
+    //! such that their data exchanges overlap with other stages' work
+    //! (default: off, set THRILL_STAGE_OVERLAP=1)
+    bool enable_stage_overlap_ = false;
+
+    //! store Cache() DIAs in pinned, compressed, and spilled tiers, for DIAs
+    //! read in many iterations (default: off, set THRILL_CACHE_TIERING=1)
+    bool enable_cache_tiering_ = false;
+
+    //! bracket each stage's Execute() and PushData() with reads of hardware
+    //! performance counters and log the deltas (default: off, set
+    //! THRILL_PERF_COUNTERS=1)
+    bool enable_perf_counters_ = false;
+
+    //! policy placing worker, dispatcher, and profiling threads onto the cpus:
+    //! linear, compact, scatter, or physical (default: linear, set
+    //! THRILL_PLACEMENT)
+    common::CpuPlacement cpu_placement_ = common::CpuPlacement::Linear;
+
+    //! number of DispatcherThreads across which the data Multiplexer shards
+    //! its connections, only for the TCP and mock backends (default: 1, set
+    //! THRILL_DISPATCHER_THREADS)
+    size_t dispatcher_threads_ = 1;
+
+    //! cores to pin the DispatcherThreads to, e.g. those near the NIC
+    //! (default: empty for the last placement slots, set
+    //! THRILL_DISPATCHER_CORES)
+    std::vector<size_t> dispatcher_cores_;
+
+    //! core to pin the i-th DispatcherThread to: from dispatcher_cores_, or
+    //! else counting down from the last placement slot.
+    size_t dispatcher_core(size_t i) const;
+
+    //! rack id of each host for hierarchical collectives (default: empty,
+    //! set THRILL_RACKS or annotate THRILL_HOSTLIST entries with @rack)
+    std::vector<size_t> racks_;
+
+    //! capacity weight of each host, such that the workers of faster hosts
+    //! get proportionally more items in sources, Sort, and Rebalance (default:
+    //! empty for equal parts, set THRILL_HOST_WEIGHTS)
+    std::vector<size_t> host_weights_;
 };
 
 /*!
@@ -97,6 +238,13 @@ public:
                 std::array<net::GroupPtr, net::Manager::kGroupCount>&& groups,
                 size_t workers_per_host);
 
+    //! constructor from existing net Groups, where Groups beyond kGroupCount
+    //! are additional connections for the data Multiplexer.
+    HostContext(size_t local_host_id, const MemoryConfig& mem_config,
+                std::unique_ptr<net::DispatcherThread> dispatcher,
+                std::vector<net::GroupPtr>&& groups,
+                size_t workers_per_host);
+
     //! destructor
     ~HostContext();
 
@@ -141,6 +289,37 @@ public:
     //! data multiplexer transmits large amounts of data asynchronously.
     data::Multiplexer& data_multiplexer() { return data_multiplexer_; }
 
+    //! registry of busy local workers for lending cores among them.
+    common::WorkerShare& worker_share() { return worker_share_; }
+
+    //! deques of partition-level tasks, which local workers steal.
+    common::WorkStealingPool& work_pool() { return work_pool_; }
+
+    //! progress of a local worker's stages, exported as live metrics
+    struct StageProgress {
+        //! number of stages whose Execute() or PushData() finished
+        std::atomic<size_t> executed { 0 }, pushed { 0 };
+        //! id of the DIA node of the running or last stage
+        std::atomic<size_t> dia_id { 0 };
+
+        //! DIA node reporting the progress of a phase, and its label. Set by
+        //! Context::StartProgress().
+        std::atomic<size_t> progress_dia_id { 0 };
+        std::atomic<const char*> progress_label { nullptr };
+        //! phase reported, a ProgressPhase
+        std::atomic<uint8_t> progress_phase { 0 };
+        //! items and bytes processed in the phase, and the expected total of
+        //! items, or 0 if unknown.
+        std::atomic<uint64_t> progress_items { 0 }, progress_bytes { 0 },
+            progress_total_items { 0 };
+    };
+
+    //! stage progress of the local worker
+    StageProgress& stage_progress(size_t local_worker_id) {
+        assert(local_worker_id < stage_progress_.size());
+        return stage_progress_[local_worker_id];
+    }
+
 private:
     //! memory configuration
     MemoryConfig mem_config_;
@@ -175,25 +354,48 @@ private:
     //! main host network dispatcher thread backend
     std::unique_ptr<net::DispatcherThread> dispatcher_;
 
+    //! logs the latency histograms of dispatcher_
+    net::DispatcherProfiler dispatcher_profiler_ { *dispatcher_, logger_ };
+
     //! net manager constructs communication groups to other hosts.
     net::Manager net_manager_;
 
+    //! construct the additional DispatcherThreads of the data Multiplexer
+    std::vector<std::unique_ptr<net::DispatcherThread> >
+    ConstructDataDispatchers();
+
+    //! dispatcher_ and the additional ones, which share the data connections
+    std::vector<net::DispatcherThread*> data_dispatchers();
+
+    //! additional DispatcherThreads across which the data Multiplexer shards
+    //! its connections, if mem_config_.dispatcher_threads_ > 1.
+    std::vector<std::unique_ptr<net::DispatcherThread> > data_dispatchers_ =
+        ConstructDataDispatchers();
+
 #if !THRILL_HAVE_THREAD_SANITIZER
     //! register net_manager_'s profiling method
     common::ProfileTaskRegistration net_manager_profiler_ {
         std::chrono::milliseconds(500), *profiler_, &net_manager_
     };
+
+    //! register dispatcher_profiler_'s profiling method
+    common::ProfileTaskRegistration dispatcher_profiler_registration_ {
+        std::chrono::milliseconds(500), *profiler_, &dispatcher_profiler_
+    };
 #endif
 
     //! the flow control group is used for collective communication.
     net::FlowControlChannelManager flow_manager_ {
-        net_manager_.GetFlowGroup(), workers_per_host_
+        net_manager_.GetFlowGroup(), workers_per_host_, mem_config_.racks_
     };
 
     //! data block pool
     data::BlockPool block_pool_ {
         mem_config_.ram_block_pool_soft_, mem_config_.ram_block_pool_hard_,
-        &logger_, &mem_manager_, workers_per_host_
+        &logger_, &mem_manager_, workers_per_host_,
+        mem_config_.enable_spill_compression_, mem_config_.enable_huge_pages_,
+        mem_config_.eviction_policy_, mem_config_.mmap_spill_dir_,
+        mem_config_.enable_numa_arenas_
     };
 
 #if !THRILL_HAVE_THREAD_SANITIZER
@@ -206,8 +408,40 @@ private:
     //! data multiplexer transmits large amounts of data asynchronously.
     data::Multiplexer data_multiplexer_ {
         mem_manager_, block_pool_,
-        *dispatcher_, net_manager_.GetDataGroup(), workers_per_host_
+        data_dispatchers(), net_manager_.GetDataGroups(), workers_per_host_,
+        mem_config_.enable_stream_compression_,
+        mem_config_.enable_flow_control_,
+        mem_config_.enable_adaptive_block_size_
     };
+
+    //! registry of busy local workers for lending cores among them.
+    common::WorkerShare worker_share_ { workers_per_host_ };
+
+    //! deques of partition-level tasks, which local workers steal.
+    common::WorkStealingPool work_pool_ { workers_per_host_ };
+
+    //! stage progress of each local worker
+    std::vector<StageProgress> stage_progress_ =
+        std::vector<StageProgress>(workers_per_host_);
+
+    //! HTTP endpoint of live metrics, enabled by THRILL_METRICS_PORT
+    std::unique_ptr<MetricsServer> metrics_server_;
+
+    //! start the metrics endpoint if THRILL_METRICS_PORT is set
+    void StartMetricsServer();
+
+    //! sampling CPU profiler of the process, enabled by THRILL_CPU_PROFILE
+    std::unique_ptr<common::SamplingProfiler> cpu_profiler_;
+
+    //! aggregates the progress of all hosts on host 0, enabled by
+    //! THRILL_PROGRESS
+    std::unique_ptr<ProgressReporter> progress_reporter_;
+
+    //! start progress_reporter_ if THRILL_PROGRESS is set
+    void StartProgressReporter();
+
+    //! output path of sampled allocation stacks, set by THRILL_ALLOC_PROFILE
+    std::string alloc_profile_path_;
 };
 
 /*!
@@ -223,6 +457,13 @@ class Context
 public:
     Context(HostContext& host_context, size_t local_worker_id);
 
+    //! constructor with a memory limit for local data structures other than
+    //! the HostContext's default, e.g. for the jobs of a JobServer. Jobs
+    //! sharing the HostContext need distinct job ids, which select their
+    //! stream id namespace and memory quota, zero is the default job.
+    Context(HostContext& host_context, size_t local_worker_id,
+            size_t mem_limit, size_t job_id = 0);
+
     //! method used to launch a job's main procedure. it wraps it in log output.
     void Launch(const std::function<void(Context&)>& job_startpoint);
 
@@ -247,6 +488,12 @@ public:
     //! memory limit of this worker Context for local data structures
     size_t mem_limit() const { return mem_limit_; }
 
+    //! the HostContext shared by the workers of this host
+    HostContext& host_context() { return host_context_; }
+
+    //! id of the job among those sharing the HostContext
+    size_t job_id() const { return job_id_; }
+
     //! Global number of workers in the system.
     size_t num_workers() const {
         return num_hosts() * workers_per_host();
@@ -325,6 +572,53 @@ public:
 
     //! \}
 
+    //! host-global registry of busy local workers, from which busy workers
+    //! may borrow the cores of idle workers.
+    common::WorkerShare& worker_share() { return worker_share_; }
+
+    //! host-global pool of partition-level tasks of DOps, which idle local
+    //! workers steal from stragglers.
+    common::WorkStealingPool& work_pool() { return work_pool_; }
+
+    //! progress of this worker's stages, exported as live metrics
+    HostContext::StageProgress& stage_progress() { return stage_progress_; }
+
+    //! \name Progress Reports
+    //! \{
+
+    //! Start reporting the progress of a phase of a DIA node, which replaces
+    //! the phase reported before by this worker. total_items is the expected
+    //! number of local items, or 0 if unknown. Aggregated by host 0 if
+    //! THRILL_PROGRESS is set.
+    void StartProgress(DIABase* dia, ProgressPhase phase,
+                       uint64_t total_items = 0);
+
+    //! Report the items and bytes processed so far in the phase of the DIA
+    //! node. Ignored if another node started a phase since. Call this every
+    //! few thousand items, not for each one.
+    void ReportProgress(size_t dia_id, uint64_t items, uint64_t bytes = 0) {
+        if (stage_progress_.progress_dia_id.load(std::memory_order_relaxed)
+            != dia_id) return;
+        stage_progress_.progress_items.store(items, std::memory_order_relaxed);
+        stage_progress_.progress_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    //! Mark the phase of the DIA node as complete, its total becomes the
+    //! items processed.
+    void StopProgress(size_t dia_id) {
+        if (stage_progress_.progress_dia_id.load(std::memory_order_relaxed)
+            != dia_id) return;
+        stage_progress_.progress_total_items.store(
+            stage_progress_.progress_items.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    }
+
+    //! \}
+
+    //! hardware performance counters of this worker's thread, opened on the
+    //! first call in that thread. nullptr if disabled or not available.
+    common::PerfCounters* perf_counters();
+
     //! host-global memory config
     const MemoryConfig& mem_config() const { return mem_config_; }
 
@@ -337,15 +631,36 @@ public:
     //! the [local_begin,local_end) index range assigned to the PE i. Takes the
     //! information from the Context.
     common::Range CalculateLocalRange(size_t global_size) const {
-        return common::CalculateLocalRange(
-            global_size, num_workers(), my_rank());
+        return common::Range(CalculatePartBegin(global_size, my_rank()),
+                             CalculatePartBegin(global_size, my_rank() + 1));
     }
 
+    //! calculate the begin of the part of worker in [0,global_size), where
+    //! the parts are proportional to the host weights, or equal if none are
+    //! configured. worker == num_workers() returns global_size.
+    size_t CalculatePartBegin(size_t global_size, size_t worker) const;
+
     common::Range CalculateLocalRangeOnHost(size_t global_size) const {
         return common::CalculateLocalRange(
             global_size, workers_per_host(), local_worker_id());
     }
 
+    //! calculate the local range of global_size units of unit_size bytes of
+    //! the files. If the files have block locations, the equal parts of the
+    //! range are assigned to workers on the hosts storing most of their
+    //! bytes, which is a collective operation.
+    common::Range CalculateLocalRange(
+        const vfs::FileList& files, size_t global_size, size_t unit_size = 1);
+
+    //! Broadcast a value from worker origin to all workers, which share one
+    //! immutable copy per host. Use this instead of AllGather() for large
+    //! read-only values captured by lambdas, like the centroids of k-means.
+    //! This is a collective operation.
+    template <typename Type>
+    std::shared_ptr<const Type> Broadcast(const Type& value, size_t origin = 0) {
+        return net.BroadcastShared(value, origin);
+    }
+
     //! Perform collectives and print min, max, mean, stdev, and all local
     //! values.
     template <typename Type>
@@ -391,6 +706,9 @@ public:
     size_t next_dia_id() { return ++last_dia_id_; }
 
 private:
+    //! HostContext of this worker
+    HostContext& host_context_;
+
     //! id among all _local_ hosts (in test program runs)
     size_t local_host_id_;
 
@@ -403,6 +721,9 @@ private:
     //! memory limit of this worker Context for local data structures
     size_t mem_limit_;
 
+    //! id of the job among those sharing the HostContext
+    size_t job_id_;
+
     //! memory configuration in HostContext
     const MemoryConfig& mem_config_;
 
@@ -421,6 +742,21 @@ private:
     //! data::Multiplexer instance that is shared among workers
     data::Multiplexer& multiplexer_;
 
+    //! registry of busy local workers that is shared among workers
+    common::WorkerShare& worker_share_;
+
+    //! pool of partition-level tasks that is shared among workers
+    common::WorkStealingPool& work_pool_;
+
+    //! progress of this worker's stages in HostContext
+    HostContext::StageProgress& stage_progress_;
+
+    //! hardware performance counters, see perf_counters()
+    std::unique_ptr<common::PerfCounters> perf_counters_;
+
+    //! whether opening perf_counters_ was already attempted
+    bool perf_counters_opened_ = false;
+
     //! flag to set which enables selective consumption of DIA contents!
     bool consume_ = false;
 
@@ -525,7 +861,8 @@ int RunCheckUnlinkBinary();
  * THRILL_RANK contains the rank of this worker
  *
  * THRILL_HOSTLIST contains a space- or comma-separated list of host:ports to
- * connect to.
+ * connect to. Each may be annotated as host:port@rack with the id of the rack
+ * (or switch) the host is in.
  *
  * THRILL_WORKERS_PER_HOST is the number of workers (threads) per host.
  *
@@ -534,6 +871,37 @@ int RunCheckUnlinkBinary();
  * THRILL_DIE_WITH_PARENT sets a flag which terminates the program if the caller
  * terminates (this is automatically set by ssh/invoke.sh). No more zombies.
  *
+ * THRILL_RACKS is a space- or comma-separated list of rack ids, one for each
+ * host. If the racks are contiguous ranges of hosts, the flow control
+ * collectives first combine values within each rack, and then across racks.
+ *
+ * THRILL_TCP_CONNECTIONS is the number of parallel TCP connections per peer
+ * used by the tcp backend to transmit Stream data (default: 1). Blocks are
+ * sent round-robin over them.
+ *
+ * THRILL_TCP_UNIX_SOCKETS=0 lets the tcp backend connect to peers with the same
+ * address via TCP loopback instead of Unix domain sockets (default: 1).
+ *
+ * THRILL_TCP_ZEROCOPY=1 lets the tcp backend send large batches of Stream data
+ * with MSG_ZEROCOPY on Linux, which holds the Blocks' pins until the kernel
+ * reports the completion (default: 0).
+ *
+ * THRILL_TCP_BUSY_POLL sets SO_BUSY_POLL in microseconds on the connections of
+ * the flow control collectives, which lowers their latency at the cost of
+ * spinning cores (default: 0, off).
+ *
+ * THRILL_MOCK_LATENCY and THRILL_MOCK_BANDWIDTH let the mock backend
+ * (THRILL_NET=mock) simulate each link between the THRILL_LOCAL hosts with a
+ * latency in microseconds and a bandwidth in bytes per second, e.g. 1G. With
+ * THRILL_MOCK_RACK_SIZE consecutive hosts per rack, THRILL_MOCK_RACK_LATENCY
+ * and THRILL_MOCK_RACK_BANDWIDTH apply to links between racks. This makes
+ * local runs of benchmarks useful for predicting their scaling.
+ *
+ * THRILL_MPI_COMMUNICATORS is the number of MPI communicators used by the mpi
+ * backend to transmit Stream data (default: 1). As with THRILL_TCP_CONNECTIONS,
+ * Blocks are sent round-robin over them, which avoids matching all messages in
+ * one queue inside the MPI library.
+ *
  * THRILL_UNLINK_BINARY deletes a file. Used by ssh/invoke.sh to unlink a copied
  * program binary while it is running. Hence, it can keep /tmp clean.
  *
@@ -22,6 +22,7 @@
 #include <thrill/api/dia_node.hpp>
 #include <thrill/common/function_traits.hpp>
 #include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
 #include <tlx/meta/function_stack.hpp>
 
 #include <cassert>
@@ -32,6 +33,13 @@
 #include <vector>
 
 namespace thrill {
+namespace core {
+
+template <typename ValueType, typename CompareFunction>
+class KllSketch;
+
+} // namespace core
+
 namespace api {
 
 //! \ingroup api_layer
@@ -111,6 +119,14 @@ const struct DuplicateDetectionFlag<true> DuplicateDetectionTag;
 //! global const DuplicateDetectionFlag instance
 const struct DuplicateDetectionFlag<false> NoDuplicateDetectionTag;
 
+//! tag structure for ReducePair()
+struct PreHashKeyTag {
+    PreHashKeyTag() { }
+};
+
+//! global const PreHashKeyTag instance
+const struct PreHashKeyTag PreHashKeyTag;
+
 //! tag structure for GroupByKey(), and InnerJoin()
 template <bool Value>
 struct LocationDetectionFlag {
@@ -124,6 +140,54 @@ const struct LocationDetectionFlag<true> LocationDetectionTag;
 //! global const LocationDetectionFlag instance
 const struct LocationDetectionFlag<false> NoLocationDetectionTag;
 
+//! tag structure for GroupByKey()
+struct HashGroupingTag {
+    HashGroupingTag() { }
+};
+
+//! global const HashGroupingTag instance
+const struct HashGroupingTag HashGroupingTag;
+
+//! tag structure for GroupByKey()
+struct GroupCombineTag {
+    GroupCombineTag() { }
+};
+
+//! global const GroupCombineTag instance
+const struct GroupCombineTag GroupCombineTag;
+
+//! tag structure for InnerJoin()
+struct BroadcastJoinTag {
+    BroadcastJoinTag() { }
+};
+
+//! global const BroadcastJoinTag instance
+const struct BroadcastJoinTag BroadcastJoinTag;
+
+//! tag structure for InnerJoin()
+struct SemiJoinFilterTag {
+    SemiJoinFilterTag() { }
+};
+
+//! global const SemiJoinFilterTag instance
+const struct SemiJoinFilterTag SemiJoinFilterTag;
+
+//! tag structure for InnerJoin()
+struct SkewJoinTag {
+    SkewJoinTag() { }
+};
+
+//! global const SkewJoinTag instance
+const struct SkewJoinTag SkewJoinTag;
+
+//! tag structure for InnerJoin()
+struct SortedJoinTag {
+    SortedJoinTag() { }
+};
+
+//! global const SortedJoinTag instance
+const struct SortedJoinTag SortedJoinTag;
+
 /*!
  * DIA is the interface between the user and the Thrill framework. A DIA can be
  * imagined as an immutable array, even though the data does not need to be
@@ -572,6 +636,43 @@ public:
      */
     auto Sample(size_t sample_size) const;
 
+    /*!
+     * WeightedSample is a DOp, which selects up to sample_size items at random
+     * without replacement, where each item is selected with probability
+     * proportional to the weight delivered by weight_function. Items with a
+     * non-positive weight are never selected. The items are sampled in one
+     * pass with a bounded reservoir on each worker, and only the random keys of
+     * the reservoirs are exchanged in a single collective.
+     *
+     * \param sample_size Number of items to select.
+     *
+     * \param weight_function Function which maps each item to its double
+     * weight.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename WeightFunction>
+    auto WeightedSample(size_t sample_size,
+                        const WeightFunction& weight_function) const;
+
+    /*!
+     * SampleByKey is a DOp, which performs stratified sampling: it selects up
+     * to sample_size items uniformly at random without replacement for each
+     * key delivered by key_extractor. The items are sampled in one pass with a
+     * bounded reservoir per key on each worker, and only the keys and the
+     * random keys of the reservoirs are exchanged in a single collective, hence
+     * the number of distinct keys should be moderate.
+     *
+     * \param key_extractor Function which maps each item to its key.
+     *
+     * \param sample_size Number of items to select per key.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename KeyExtractor>
+    auto SampleByKey(const KeyExtractor& key_extractor,
+                     size_t sample_size) const;
+
     /*!
      * AllReduce is an Action, which computes the reduction sum of all elements
      * globally and delivers the same value on all workers.
@@ -685,6 +786,40 @@ public:
     Future<ValueType> MaxFuture(
         const ValueType& initial_value = ValueType()) const;
 
+    /*!
+     * TopK is an Action, which returns the k smallest elements of the DIA
+     * according to compare_function in sorted order on all workers. Contrary
+     * to Sort(), only the k local candidates of each worker are exchanged in a
+     * single collective.
+     *
+     * \param k Number of elements to return.
+     *
+     * \param compare_function Function, which compares two elements. Returns
+     * true, if first element is smaller than second. False otherwise.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename CompareFunction = std::less<ValueType> >
+    std::vector<ValueType> TopK(
+        size_t k,
+        const CompareFunction& compare_function = CompareFunction()) const;
+
+    /*!
+     * TopK is an ActionFuture, which returns the k smallest elements of the
+     * DIA according to compare_function in sorted order on all workers.
+     *
+     * \param k Number of elements to return.
+     *
+     * \param compare_function Function, which compares two elements. Returns
+     * true, if first element is smaller than second. False otherwise.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename CompareFunction = std::less<ValueType> >
+    Future<std::vector<ValueType> > TopKFuture(
+        size_t k,
+        const CompareFunction& compare_function = CompareFunction()) const;
+
     /*!
      * Compute the approximate number of distinct elements in the DIA.
      *
@@ -694,6 +829,69 @@ public:
     template <size_t p>
     double HyperLogLog() const;
 
+    /*!
+     * HyperLogLogByKey is a DOp, which computes a HyperLogLog sketch of the
+     * distinct values of each key. The items are grouped by the key delivered
+     * by key_extractor, and the values delivered by value_extractor are
+     * inserted into the key's core::HyperLogLogRegisters<p>, which are merged
+     * like a ReducePair. The result is a DIA of std::pair<Key, Registers>, whose
+     * registers deliver the approximate distinct count of each key via result()
+     * and can be merged further with operator +. This avoids an exact
+     * GroupByKey for cardinality-per-group queries.
+     *
+     * \tparam p Number of bits to use for index. Should be between 4 and 16.
+     *
+     * \param key_extractor Function which maps each item to its key.
+     *
+     * \param value_extractor Function which maps each item to the value whose
+     * distinct occurrences are counted.
+     *
+     * \ingroup dia_dops
+     */
+    template <size_t p, typename KeyExtractor, typename ValueExtractor>
+    auto HyperLogLogByKey(const KeyExtractor& key_extractor,
+                          const ValueExtractor& value_extractor) const;
+
+    /*!
+     * Quantiles is an Action, which computes a mergeable core::KllSketch of
+     * all elements of the DIA on all workers. Each worker sketches its items
+     * locally, and the sketches are merged in a single collective, without
+     * sorting or exchanging the items. The sketch answers approximate
+     * Quantile(phi) and Rank(x) queries with a rank error of about n divided
+     * by sketch_size.
+     *
+     * \param sketch_size Capacity of the top level of the sketch, which stores
+     * a small multiple of sketch_size items.
+     *
+     * \param compare_function Function, which compares two elements. Returns
+     * true, if first element is smaller than second. False otherwise. Must be
+     * default-constructible, e.g. std::less or std::greater.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename CompareFunction = std::less<ValueType> >
+    core::KllSketch<ValueType, CompareFunction> Quantiles(
+        size_t sketch_size = 200,
+        const CompareFunction& compare_function = CompareFunction()) const;
+
+    /*!
+     * Quantiles is an ActionFuture, which computes a mergeable core::KllSketch
+     * of all elements of the DIA on all workers.
+     *
+     * \param sketch_size Capacity of the top level of the sketch, which stores
+     * a small multiple of sketch_size items.
+     *
+     * \param compare_function Function, which compares two elements. Returns
+     * true, if first element is smaller than second. False otherwise. Must be
+     * default-constructible, e.g. std::less or std::greater.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename CompareFunction = std::less<ValueType> >
+    Future<core::KllSketch<ValueType, CompareFunction> > QuantilesFuture(
+        size_t sketch_size = 200,
+        const CompareFunction& compare_function = CompareFunction()) const;
+
     /*!
      * WriteLinesOne is an Action, which writes std::strings to a single output
      * file.
@@ -967,8 +1165,8 @@ public:
     template <bool VolatileKeyValue,
               typename KeyExtractor, typename ReduceFunction,
               typename ReduceConfig = class DefaultReduceConfig,
-              typename KeyHashFunction =
-                  std::hash<typename FunctionTraits<KeyExtractor>::result_type>,
+              typename KeyHashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>,
               typename KeyEqualFunction =
                   std::equal_to<typename FunctionTraits<KeyExtractor>::result_type> >
     auto ReduceByKey(
@@ -1019,8 +1217,8 @@ public:
     template <bool DuplicateDetectionValue,
               typename KeyExtractor, typename ReduceFunction,
               typename ReduceConfig = class DefaultReduceConfig,
-              typename KeyHashFunction =
-                  std::hash<typename FunctionTraits<KeyExtractor>::result_type>,
+              typename KeyHashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>,
               typename KeyEqualFunction =
                   std::equal_to<typename FunctionTraits<KeyExtractor>::result_type> >
     auto ReduceByKey(
@@ -1070,8 +1268,8 @@ public:
               bool DuplicateDetectionValue,
               typename KeyExtractor, typename ReduceFunction,
               typename ReduceConfig = class DefaultReduceConfig,
-              typename KeyHashFunction =
-                  std::hash<typename FunctionTraits<KeyExtractor>::result_type>,
+              typename KeyHashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>,
               typename KeyEqualFunction =
                   std::equal_to<typename FunctionTraits<KeyExtractor>::result_type> >
     auto ReduceByKey(
@@ -1215,6 +1413,56 @@ public:
         const KeyHashFunction& key_hash_function = KeyHashFunction(),
         const KeyEqualFunction& key_equal_function = KeyEqualFunction()) const;
 
+    /*!
+     * ReducePair with PreHashKeyTag reduces key-value-pairs like ReducePair,
+     * but hashes each key only once before the pre-phase and carries the
+     * 64-bit hash with the pair. The post-phase on the receiving worker and
+     * the re-reads of spilled partitions take the stored hash, and key
+     * comparisons first compare the hashes. This pays off for long keys like
+     * strings, at the cost of eight more bytes per transmitted pair.
+     *
+     * \param reduce_function Reduce function, which reduces two values of the
+     * same key to a single value.
+     *
+     * \param reduce_config Reduce configuration.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename ReduceFunction,
+              typename ReduceConfig = class DefaultReduceConfig>
+    auto ReducePair(
+        const struct PreHashKeyTag&,
+        const ReduceFunction& reduce_function,
+        const ReduceConfig& reduce_config = ReduceConfig()) const;
+
+    /*!
+     * ReducePair with PreHashKeyTag reduces key-value-pairs like ReducePair,
+     * but hashes each key only once before the pre-phase and carries the
+     * 64-bit hash with the pair. The post-phase on the receiving worker and
+     * the re-reads of spilled partitions take the stored hash, and key
+     * comparisons first compare the hashes.
+     *
+     * \param reduce_function Reduce function, which reduces two values of the
+     * same key to a single value.
+     *
+     * \param reduce_config Reduce configuration.
+     *
+     * \param key_hash_function Function to hash the keys, called once per
+     * input pair.
+     *
+     * \param key_equal_function Function to compare keys with equal hashes.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename ReduceFunction, typename ReduceConfig,
+              typename KeyHashFunction, typename KeyEqualFunction>
+    auto ReducePair(
+        const struct PreHashKeyTag&,
+        const ReduceFunction& reduce_function,
+        const ReduceConfig& reduce_config,
+        const KeyHashFunction& key_hash_function,
+        const KeyEqualFunction& key_equal_function) const;
+
     /*!
      * ReduceToIndex is a DOp, which groups elements of the DIA with the
      * key_extractor returning an unsigned integers and reduces each key-bucket
@@ -1474,14 +1722,84 @@ public:
      */
     template <typename ValueOut, bool LocationDetectionTagValue,
               typename KeyExtractor, typename GroupByFunction,
-              typename HashFunction =
-                  std::hash<typename FunctionTraits<KeyExtractor>::result_type>
+              typename HashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>
               >
     auto GroupByKey(const LocationDetectionFlag<LocationDetectionTagValue>&,
                     const KeyExtractor& key_extractor,
                     const GroupByFunction& groupby_function,
                     const HashFunction& hash_function = HashFunction()) const;
 
+    /*!
+     * GroupByKey is a DOp, which groups elements of the DIA by its key. This
+     * variant groups the received items by hashing instead of sorting them:
+     * items are bucketed into hash partitions, which are spilled to Files if
+     * memory is exceeded, and the GroupByFunction is called once per group in
+     * arbitrary order. Keys must be comparable using operator ==, and unlike
+     * the sorting GroupByKey, the items of a group must fit into RAM.
+     *
+     * \tparam KeyExtractor Type of the key_extractor function.
+     * The key_extractor function is equal to a map function.
+     *
+     * \param key_extractor Key extractor function, which maps each element to a
+     * key of possibly different type.
+     *
+     * \tparam GroupByFunction Type of the groupby_function. This is a function
+     * taking an iterator for all elements of the same key as input.
+     *
+     * \param groupby_function Reduce function, which defines how the key
+     * buckets are grouped and processed.
+     *      input param: api::GroupByReader with functions HasNext() and Next()
+     *
+     * \param hash_function Hash method for Keys
+     *
+     * \ingroup dia_dops
+     */
+    template <typename ValueOut,
+              typename KeyExtractor, typename GroupByFunction,
+              typename HashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>
+              >
+    auto GroupByKey(const struct HashGroupingTag&,
+                    const KeyExtractor& key_extractor,
+                    const GroupByFunction& groupby_function,
+                    const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * GroupByKey is a DOp, which groups elements of the DIA by its key. This
+     * variant additionally runs a combine function on the sending side: items
+     * are collected per key in a table bounded by the DIA's memory limit, and
+     * before sending, combine_function(std::vector<ValueIn>& items, const Key&
+     * key) may shrink the items of a key, e.g. to the top-N or to distinct
+     * values. The GroupByFunction must yield the same result on combined and
+     * uncombined groups.
+     *
+     * \param key_extractor Key extractor function, which maps each element to a
+     * key of possibly different type.
+     *
+     * \param groupby_function Reduce function, which defines how the key
+     * buckets are grouped and processed.
+     *      input param: api::GroupByReader with functions HasNext() and Next()
+     *
+     * \param combine_function Partial group function on the sending side,
+     * which may remove or replace items of a key in the vector.
+     *
+     * \param hash_function Hash method for Keys
+     *
+     * \ingroup dia_dops
+     */
+    template <typename ValueOut,
+              typename KeyExtractor, typename GroupByFunction,
+              typename CombineFunction,
+              typename HashFunction = common::HashDefault<
+                  typename FunctionTraits<KeyExtractor>::result_type>
+              >
+    auto GroupByKey(const struct GroupCombineTag&,
+                    const KeyExtractor& key_extractor,
+                    const GroupByFunction& groupby_function,
+                    const CombineFunction& combine_function,
+                    const HashFunction& hash_function = HashFunction()) const;
+
     /*!
      * GroupBy is a DOp, which groups elements of the DIA by its key.
      * After having grouped all elements of one key, all elements of one key
@@ -1686,6 +2004,25 @@ public:
     auto Sort(const CompareFunction& compare_function,
               const SortAlgorithm& sort_algorithm) const;
 
+    /*!
+     * SortByKey is a DOp, which sorts a given DIA by the keys delivered by
+     * key_extractor in the order of operator < on the keys. If the key is a
+     * fixed-size integral type or a std::array of uint8_t (e.g. the 10 byte
+     * keys of TeraSort), then the local sort is a radix sort on the keys
+     * instead of a comparison sort.
+     *
+     * \image html dia_ops/Sort.svg
+     *
+     * \tparam KeyExtractor Type of the key_extractor function.
+     *  Should be ValueType->Key
+     *
+     * \param key_extractor Function, which maps each element to its key.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename KeyExtractor>
+    auto SortByKey(const KeyExtractor& key_extractor) const;
+
     /*!
      * SortStable is a DOp, which sorts a given DIA stably according to the
      * given compare_function.
@@ -1834,6 +2171,46 @@ public:
     auto Window(struct DisjointTag const&, size_t window_size,
                 const WindowFunction& window_function) const;
 
+    /*!
+     * WindowSum is a DOp, which delivers the sum of every k consecutive items
+     * in a DIA under an associative sum function. The sum is maintained while
+     * the window slides, hence each window costs O(1) amortized instead of
+     * O(k) applications of the sum function.
+     *
+     * \param window_size the number k of items summed.
+     *
+     * \param sum_function Sum function (any associative function).
+     *
+     * \ingroup dia_dops
+     */
+    template <typename SumFunction = std::plus<ValueType> >
+    auto WindowSum(size_t window_size,
+                   const SumFunction& sum_function = SumFunction()) const;
+
+    /*!
+     * WindowMin is a DOp, which delivers the minimum of every k consecutive
+     * items in a DIA, see WindowSum().
+     *
+     * \ingroup dia_dops
+     */
+    auto WindowMin(size_t window_size) const;
+
+    /*!
+     * WindowMax is a DOp, which delivers the maximum of every k consecutive
+     * items in a DIA, see WindowSum().
+     *
+     * \ingroup dia_dops
+     */
+    auto WindowMax(size_t window_size) const;
+
+    /*!
+     * WindowMean is a DOp, which delivers the mean of every k consecutive items
+     * in a DIA as double, see WindowSum().
+     *
+     * \ingroup dia_dops
+     */
+    auto WindowMean(size_t window_size) const;
+
     /*!
      * FlatWindow is a DOp, which applies a window function to every k
      * consecutive items in a DIA. The window function is also given the index
@@ -1899,6 +2276,10 @@ public:
      * The concat operation balances all input data, so that each worker will
      * have an equal number of elements when the concat completes.
      *
+     * If all consumers ignore the order of items, like ReduceByKey(), the
+     * exchange is skipped and the workers keep their local items as with
+     * Union().
+     *
      * \ingroup dia_dops
      */
     template <typename SecondDIA>
@@ -1932,6 +2313,42 @@ public:
      */
     DIA<ValueType> Cache() const;
 
+    /*!
+     * Create a CheckpointNode, which caches all items like Cache() and writes
+     * each worker's Blocks to the file path followed by "-" and the worker
+     * id. If complete checkpoint files of all workers written with the same
+     * number of workers exist, e.g. after restarting the job, the items are
+     * read from them instead, and the stages computing this DIA are not run.
+     *
+     * \param path base path of the checkpoint files, may be a remote URI.
+     *
+     * \ingroup dia_dops
+     */
+    DIA<ValueType> Checkpoint(const std::string& path) const;
+
+    /*!
+     * Checkpoint() of a DIA computed deterministically from immutable input
+     * files, e.g. by ReadLines() and parsing Map()s, into a node-local cache
+     * shared by later jobs. The checkpoint files are named by a hash of the
+     * paths, sizes, and modification times of the files matched by the input
+     * globs, the version, and the item type, such that jobs with the same
+     * inputs and number of workers load the Blocks instead of reading and
+     * parsing the inputs again. Changing the inputs or the version starts a
+     * new cache entry, old entries are not removed.
+     *
+     * \param cache_dir existing directory of the cache, e.g. on a local SSD.
+     *
+     * \param inputs globs of the input files read by the stages.
+     *
+     * \param version user-provided version of the stages, which must be
+     * changed whenever they compute different items.
+     *
+     * \ingroup dia_dops
+     */
+    DIA<ValueType> CacheSource(
+        const std::string& cache_dir, const std::vector<std::string>& inputs,
+        const std::string& version) const;
+
     //! \}
 
 private:
@@ -1993,6 +2410,9 @@ using api::DuplicateDetectionTag;
 //! imported from api namespace
 using api::NoDuplicateDetectionTag;
 
+//! imported from api namespace
+using api::PreHashKeyTag;
+
 //! imported from api namespace
 using api::LocationDetectionFlag;
 
@@ -2002,6 +2422,24 @@ using api::LocationDetectionTag;
 //! imported from api namespace
 using api::NoLocationDetectionTag;
 
+//! imported from api namespace
+using api::HashGroupingTag;
+
+//! imported from api namespace
+using api::GroupCombineTag;
+
+//! imported from api namespace
+using api::BroadcastJoinTag;
+
+//! imported from api namespace
+using api::SemiJoinFilterTag;
+
+//! imported from api namespace
+using api::SkewJoinTag;
+
+//! imported from api namespace
+using api::SortedJoinTag;
+
 } // namespace thrill
 
 #endif // !THRILL_API_DIA_HEADER
@@ -13,16 +13,23 @@
 #include <thrill/api/dia_base.hpp>
 #include <thrill/common/json_logger.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/perf_counters.hpp>
+#include <thrill/common/sampling_profiler.hpp>
 #include <thrill/common/stats_timer.hpp>
+#include <thrill/common/trace_event.hpp>
+#include <thrill/data/block_pool.hpp>
 #include <thrill/mem/allocator.hpp>
+#include <thrill/mem/malloc_tracker.hpp>
 
 #include <algorithm>
 #include <chrono>
 #include <deque>
 #include <functional>
 #include <iomanip>
+#include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -32,6 +39,34 @@ namespace api {
 /******************************************************************************/
 // DIABase StageBuilder
 
+using DiaIoStatsMap = std::map<size_t, data::BlockPool::DiaIoStats>;
+
+//! append the external memory I/O of the host's BlockPool between two
+//! snapshots as arrays by dia_id, if there was any. The I/O of all local
+//! workers is included, and may have been caused by other DIA nodes' memory
+//! demands.
+static void LogDiaIo(common::JsonLine& line,
+                     const DiaIoStatsMap& before, const DiaIoStatsMap& after) {
+    std::vector<size_t> dia_ids, evicted_bytes, read_bytes;
+    for (const auto& a : after) {
+        data::BlockPool::DiaIoStats b;
+        auto it = before.find(a.first);
+        if (it != before.end()) b = it->second;
+
+        if (a.second.evicted_bytes == b.evicted_bytes &&
+            a.second.read_bytes == b.read_bytes) continue;
+
+        dia_ids.push_back(a.first);
+        evicted_bytes.push_back(a.second.evicted_bytes - b.evicted_bytes);
+        read_bytes.push_back(a.second.read_bytes - b.read_bytes);
+    }
+    if (dia_ids.empty()) return;
+
+    line << "io_dia_ids" << dia_ids
+         << "io_evicted_bytes" << evicted_bytes
+         << "io_read_bytes" << read_bytes;
+}
+
 class Stage
 {
 public:
@@ -131,16 +166,31 @@ public:
         logger_ << "class" << "StageBuilder" << "event" << "execute-start"
                 << "targets" << target_ids;
 
+        context_.stage_progress().dia_id = node_->dia_id();
+
         DIAMemUse mem_use = node_->ExecuteMemUse();
         if (mem_use.is_max())
-            mem_use = context_.mem_limit();
+            mem_use = DistributeMemory(context_.mem_limit(), { mem_use })[0];
         node_->set_mem_limit(mem_use);
 
         // old: acquire memory from BlockPool -tb
         // data::BlockPoolMemoryHolder mem_holder(context_.block_pool(), mem_use);
 
+        common::PerfCounters* perf = context_.perf_counters();
+        common::PerfCounters::Values perf_start;
+        if (perf) perf_start = perf->Read();
+
+        // the I/O counters are per host, hence only local worker 0 logs them.
+        bool log_io = (context_.local_worker_id() == 0);
+        DiaIoStatsMap io_start;
+        if (log_io) io_start = context_.block_pool().dia_io_stats();
+
         common::StatsTimerStart timer;
         try {
+            common::SamplingProfiler::Scope profile_scope(
+                node_->dia_id(), node_->label());
+            mem::AllocationScope alloc_scope(node_->dia_id(), node_->label());
+            common::TraceScope trace(logger_, "stage", "Execute");
             node_->Execute();
         }
         catch (std::exception& e) {
@@ -154,8 +204,16 @@ public:
         sLOG << "FINISH (EXECUTE) stage" << *node_ << "targets" << TargetsString()
              << "took" << timer << "ms";
 
-        logger_ << "class" << "StageBuilder" << "event" << "execute-done"
-                << "targets" << target_ids << "elapsed" << timer;
+        {
+            common::JsonLine line = logger_.line();
+            line << "class" << "StageBuilder" << "event" << "execute-done"
+                 << "targets" << target_ids << "elapsed" << timer;
+            if (perf) (perf->Read() - perf_start).Log(line);
+            if (log_io)
+                LogDiaIo(line, io_start, context_.block_pool().dia_io_stats());
+        }
+
+        ++context_.stage_progress().executed;
 
         LOG << "DIA bytes: " << node_->context().block_pool().total_bytes();
     }
@@ -181,12 +239,15 @@ public:
         logger_ << "class" << "StageBuilder" << "event" << "pushdata-start"
                 << "targets" << target_ids;
 
+        context_.stage_progress().dia_id = node_->dia_id();
+
         // collect memory requests of source node and all targeted children
 
         std::vector<DIABase*> targets = TargetPtrs();
 
         const size_t mem_limit = context_.mem_limit();
         std::vector<DIABase*> max_mem_nodes;
+        std::vector<DIAMemUse> max_mem_requests;
         size_t const_mem = 0;
 
         {
@@ -194,6 +255,7 @@ public:
             DIAMemUse m = node_->PushDataMemUse();
             if (m.is_max()) {
                 max_mem_nodes.emplace_back(node_.get());
+                max_mem_requests.emplace_back(m);
             }
             else {
                 const_mem += m.limit();
@@ -206,6 +268,7 @@ public:
                 DIAMemUse m = target->PreOpMemUse();
                 if (m.is_max()) {
                     max_mem_nodes.emplace_back(target);
+                    max_mem_requests.emplace_back(m);
                 }
                 else {
                     const_mem += m.limit();
@@ -225,7 +288,8 @@ public:
 
         if (!max_mem_nodes.empty()) {
             size_t remaining_mem = mem_limit - const_mem;
-            remaining_mem /= max_mem_nodes.size();
+            std::vector<size_t> budgets =
+                DistributeMemory(remaining_mem, max_mem_requests);
 
             if (context_.my_rank() == 0) {
                 LOG << "StageBuilder: distribute remaining worker memory "
@@ -233,10 +297,13 @@ public:
                     << max_mem_nodes.size() << " DIANodes";
             }
 
-            for (DIABase* target : max_mem_nodes) {
-                target->set_mem_limit(remaining_mem);
+            for (size_t i = 0; i < max_mem_nodes.size(); ++i) {
+                max_mem_nodes[i]->set_mem_limit(budgets[i]);
             }
 
+            logger_ << "class" << "StageBuilder" << "event" << "mem-budgets"
+                    << "targets" << target_ids << "budgets" << budgets;
+
             // update const_mem: later allocate the mem limit of this worker
             const_mem = mem_limit;
         }
@@ -247,8 +314,23 @@ public:
         // old: acquire memory from BlockPool
         // data::BlockPoolMemoryHolder mem_holder(context_.block_pool(), const_mem);
 
+        // the targets' PreOps run inside PushData(), hence they are counted
+        // together.
+        common::PerfCounters* perf = context_.perf_counters();
+        common::PerfCounters::Values perf_start;
+        if (perf) perf_start = perf->Read();
+
+        // the I/O counters are per host, hence only local worker 0 logs them.
+        bool log_io = (context_.local_worker_id() == 0);
+        DiaIoStatsMap io_start;
+        if (log_io) io_start = context_.block_pool().dia_io_stats();
+
         common::StatsTimerStart timer;
         try {
+            common::SamplingProfiler::Scope profile_scope(
+                node_->dia_id(), node_->label());
+            mem::AllocationScope alloc_scope(node_->dia_id(), node_->label());
+            common::TraceScope trace(logger_, "stage", "PushData");
             node_->RunPushData();
         }
         catch (std::exception& e) {
@@ -263,8 +345,16 @@ public:
         sLOG << "FINISH (PUSHDATA) stage" << *node_ << "targets" << TargetsString()
              << "took" << timer << "ms";
 
-        logger_ << "class" << "StageBuilder" << "event" << "pushdata-done"
-                << "targets" << target_ids << "elapsed" << timer;
+        {
+            common::JsonLine line = logger_.line();
+            line << "class" << "StageBuilder" << "event" << "pushdata-done"
+                 << "targets" << target_ids << "elapsed" << timer;
+            if (perf) (perf->Read() - perf_start).Log(line);
+            if (log_io)
+                LogDiaIo(line, io_start, context_.block_pool().dia_io_stats());
+        }
+
+        ++context_.stage_progress().pushed;
 
         LOG << "DIA bytes: " << node_->context().block_pool().total_bytes();
     }
@@ -378,6 +468,100 @@ static void TopoSortStages(mm_set<Stage>* stages, mem::vector<Stage>* result) {
     }
 }
 
+//! Steps of the overlapped schedule: Execute() or PushData() of a Stage, given
+//! by its index in execution order.
+struct StageStep {
+    size_t stage;
+    bool   push;
+};
+
+//! Schedule the Execute() and PushData() steps of the stages such that the
+//! data exchange of independent branches overlaps with the work of other
+//! branches. PushData() starts the asynchronous exchange into its targets,
+//! hence ready PushData() steps run first, and Execute() steps of stages closer
+//! to the sources run before those further down, which wait for their data.
+//! The schedule depends only on the DIA graph, hence it is the same on all
+//! workers.
+static std::vector<StageStep> ScheduleOverlapped(
+    const std::vector<Stage*>& order, const DIABase* action) {
+
+    size_t n = order.size();
+    std::unordered_map<const DIABase*, size_t> index;
+    for (size_t i = 0; i < n; ++i)
+        index[order[i]->node_.get()] = i;
+
+    std::vector<bool> has_exec(n), has_push(n), done_exec(n), done_push(n);
+    std::vector<size_t> level(n), pending(n);
+    std::vector<std::vector<size_t> > targets(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const DIABase* node = order[i]->node_.get();
+        has_exec[i] = (node->state() == DIAState::NEW);
+        has_push[i] = (node != action);
+        if (!has_push[i]) continue;
+
+        for (DIABase* child : order[i]->TargetPtrs()) {
+            auto it = index.find(child);
+            if (it == index.end() || child->ForwardDataOnly()) continue;
+            targets[i].push_back(it->second);
+        }
+    }
+
+    // pending pushes into each stage and distance from sources; the order is
+    // topological.
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t t : targets[i]) {
+            pending[t]++;
+            level[t] = std::max(level[t], level[i] + 1);
+        }
+    }
+
+    std::vector<StageStep> steps;
+    while (true) {
+        size_t next = n;
+        bool push = false;
+
+        for (size_t i = 0; i < n; ++i) {
+            if (has_push[i] && !done_push[i] &&
+                (!has_exec[i] || done_exec[i])) {
+                next = i, push = true;
+                break;
+            }
+        }
+        for (size_t i = 0; i < n && !push; ++i) {
+            if (!has_exec[i] || done_exec[i] || pending[i] != 0) continue;
+            if (next == n || level[i] < level[next])
+                next = i;
+        }
+        if (next == n) break;
+
+        if (push) {
+            done_push[next] = true;
+            for (size_t t : targets[next])
+                pending[t]--;
+        }
+        else {
+            done_exec[next] = true;
+        }
+        steps.push_back(StageStep { next, push });
+    }
+
+    assert(steps.size() ==
+           static_cast<size_t>(std::count(has_exec.begin(), has_exec.end(), true)
+                               + std::count(has_push.begin(), has_push.end(), true)));
+
+    return steps;
+}
+
+bool DIABase::OrderAgnostic() const {
+    if (!ForwardDataOnly()) return false;
+
+    std::vector<DIABase*> c = children();
+    return !c.empty() &&
+           std::all_of(c.begin(), c.end(),
+                       [](DIABase* child) { return child->OrderAgnostic(); });
+}
+
 void DIABase::RunScope() {
     static constexpr bool debug = Stage::debug;
 
@@ -414,6 +598,44 @@ void DIABase::RunScope() {
 
     assert(toporder.front().node_.get() == this);
 
+    if (context_.mem_config().enable_stage_overlap_) {
+        // stages in execution order, skipping CollapseNodes
+        std::vector<Stage*> order;
+        for (auto it = toporder.rbegin(); it != toporder.rend(); ++it) {
+            if (!it->node_->ForwardDataOnly())
+                order.push_back(&*it);
+        }
+
+        std::vector<StageStep> steps = ScheduleOverlapped(order, this);
+
+        // index of the last step of each stage, after which it is released
+        std::vector<size_t> last_step(order.size());
+        for (size_t k = 0; k < steps.size(); ++k)
+            last_step[steps[k].stage] = k;
+
+        for (size_t k = 0; k < steps.size(); ++k) {
+            Stage& s = *order[steps[k].stage];
+
+            if (context_.local_worker_id() == 0) {
+                std::vector<size_t> schedule;
+                schedule.reserve(steps.size() - k);
+                for (size_t j = k; j < steps.size(); ++j)
+                    schedule.push_back(order[steps[j].stage]->node_->dia_id());
+                context_.block_pool().SetEvictionSchedule(schedule);
+            }
+
+            if (steps[k].push)
+                s.PushData();
+            else
+                s.Execute();
+
+            // this may destroy the last CountingPtr reference to a node.
+            if (last_step[steps[k].stage] == k && s.node_.get() != this)
+                s.node_.reset();
+        }
+        return;
+    }
+
     while (!toporder.empty())
     {
         Stage& s = toporder.back();
@@ -426,6 +648,16 @@ void DIABase::RunScope() {
         if (debug)
             mem::malloc_tracker_print_status();
 
+        // tell the BlockPool's eviction policy which nodes' Files are used
+        // next. The BlockPool is shared by all workers of the host.
+        if (context_.local_worker_id() == 0) {
+            std::vector<size_t> schedule;
+            schedule.reserve(toporder.size());
+            for (auto it = toporder.rbegin(); it != toporder.rend(); ++it)
+                schedule.push_back(it->node_->dia_id());
+            context_.block_pool().SetEvictionSchedule(schedule);
+        }
+
         if (s.node_->state() == DIAState::NEW) {
             s.Execute();
             if (s.node_.get() != this)
@@ -442,6 +674,76 @@ void DIABase::RunScope() {
     }
 }
 
+/******************************************************************************/
+// DIAMemUse
+
+std::vector<size_t> DistributeMemory(
+    size_t mem, const std::vector<DIAMemUse>& requests) {
+
+    std::vector<size_t> budgets(requests.size());
+
+    size_t sum_min = 0;
+    for (const DIAMemUse& r : requests) {
+        assert(r.is_max());
+        assert(r.min() <= r.preferred() && r.weight() > 0);
+        sum_min += r.min();
+    }
+
+    if (sum_min > mem) {
+        LOG1 << "StageBuilder: minimum memory of DIANodes in Stage: " << sum_min
+             << " exceeds available memory: " << mem << ", scaling down.";
+        for (size_t i = 0; i < requests.size(); ++i) {
+            budgets[i] = static_cast<size_t>(
+                static_cast<double>(mem) * requests[i].min() / sum_min);
+        }
+        return budgets;
+    }
+
+    // give each its minimum, then fill up weighted, capping at preferred.
+    std::vector<bool> capped(requests.size());
+    size_t remaining = mem - sum_min;
+    for (size_t i = 0; i < requests.size(); ++i)
+        budgets[i] = requests[i].min();
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        double sum_weight = 0;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (!capped[i]) sum_weight += requests[i].weight();
+        }
+        if (sum_weight == 0) break;
+
+        // cap all requests whose preferred amount is reached by their share of
+        // this round and repeat, since the others' shares increase.
+        const size_t round_remaining = remaining;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (capped[i]) continue;
+            double share = static_cast<double>(round_remaining)
+                           * requests[i].weight() / sum_weight;
+            if (static_cast<double>(budgets[i]) + share >=
+                static_cast<double>(requests[i].preferred())) {
+                remaining -= requests[i].preferred() - budgets[i];
+                budgets[i] = requests[i].preferred();
+                capped[i] = true;
+                changed = true;
+            }
+        }
+    }
+
+    double sum_weight = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!capped[i]) sum_weight += requests[i].weight();
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (capped[i]) continue;
+        budgets[i] += static_cast<size_t>(
+            static_cast<double>(remaining) * requests[i].weight() / sum_weight);
+    }
+
+    return budgets;
+}
+
 /******************************************************************************/
 // DIABase
 
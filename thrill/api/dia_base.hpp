@@ -19,6 +19,8 @@
 #include <thrill/api/context.hpp>
 
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 namespace thrill {
@@ -55,9 +57,27 @@ public:
     DIAMemUse(size_t limit = 0) // NOLINT: implicit conversions desired
         : limit_(limit) { }
 
-    //! Maximum available RAM requested (limit will be determined in
-    //! StageBuilder by detecting the DIANodes in a Stage)
-    static DIAMemUse Max() { return DIAMemUse(max_limit_); }
+    /*!
+     * Maximum available RAM requested (limit will be determined in StageBuilder
+     * by detecting the DIANodes in a Stage). The request can be refined: the
+     * node needs at least min bytes, does not benefit from more than preferred
+     * bytes, and RAM beyond all minimums is distributed proportionally to the
+     * weights of the requests.
+     */
+    static DIAMemUse Max(size_t min = 0, size_t preferred = max_limit_,
+                         double weight = 1.0) {
+        DIAMemUse m(max_limit_);
+        m.min_ = min;
+        m.preferred_ = preferred;
+        m.weight_ = weight;
+        return m;
+    }
+
+    //! Maximum available RAM requested with a weight relative to other
+    //! maximum requests in the Stage.
+    static DIAMemUse MaxWeighted(double weight) {
+        return Max(0, max_limit_, weight);
+    }
 
     //! return amount of RAM reserved
     size_t limit() const { return limit_; }
@@ -65,6 +85,15 @@ public:
     //! test if sentinel for maximum RAM request
     bool is_max() const { return limit_ == max_limit_; }
 
+    //! minimum amount of RAM of a maximum request
+    size_t min() const { return min_; }
+
+    //! amount of RAM beyond which a maximum request does not benefit
+    size_t preferred() const { return preferred_; }
+
+    //! weight of a maximum request when distributing RAM
+    double weight() const { return weight_; }
+
     //! implicit conversion to size_, but only if not is_max()
     operator size_t () const { assert(!is_max()); return limit_; }
 
@@ -72,10 +101,47 @@ private:
     //! amount of RAM requested or reserved.
     size_t limit_;
 
+    //! minimum, preferred, and weight of a maximum request
+    size_t min_ = 0, preferred_ = max_limit_;
+    double weight_ = 1.0;
+
     //! sentinel for maximum available RAM.
     static constexpr size_t max_limit_ = static_cast<size_t>(-1);
 };
 
+/*!
+ * Distribute mem bytes among maximum RAM requests: each receives its minimum,
+ * and the rest is split proportionally to the weights, where requests capped
+ * at their preferred amount pass their excess to the others. If the minimums
+ * exceed mem, they are scaled down proportionally.
+ */
+std::vector<size_t> DistributeMemory(
+    size_t mem, const std::vector<DIAMemUse>& requests);
+
+/*!
+ * Global number of items pushed by a DIANode, if it is known without further
+ * communication, e.g. that of a Generate() or after a Rebalance(). Children
+ * with an empty function stack reuse it instead of running size collectives.
+ */
+struct KnownSize {
+    //! sentinel for an unknown size
+    static constexpr size_t kUnknown = static_cast<size_t>(-1);
+
+    //! global number of items, or kUnknown
+    size_t total = kUnknown;
+
+    //! whether the items are partitioned among the workers as by
+    //! Context::CalculateLocalRange(total), hence the local sizes and ranks of
+    //! all workers are known as well.
+    bool balanced = false;
+
+    //! whether the global number of items is known
+    bool known() const { return total != kUnknown; }
+
+    //! whether the partition of the items among the workers is known
+    bool known_balanced() const { return known() && balanced; }
+};
+
 /*!
  * The DIABase is the untyped super class of DIANode. DIABases are used to build
  * the execution graph, which is used to execute the computation.
@@ -97,7 +163,8 @@ public:
             const std::initializer_list<size_t>& parent_ids,
             const std::initializer_list<DIABasePtr>& parents)
         : context_(ctx), dia_id_(ctx.next_dia_id()),
-          label_(label), parents_(parents) {
+          label_(label), parents_(parents),
+          parent_known_sizes_(parents_.size()) {
         logger_ << "class" << "DIABase"
                 << "event" << "create"
                 << "type" << "DOp"
@@ -112,7 +179,8 @@ public:
             std::vector<size_t>&& parent_ids,
             std::vector<DIABasePtr>&& parents)
         : context_(ctx), dia_id_(ctx.next_dia_id()),
-          label_(std::move(label)), parents_(std::move(parents)) {
+          label_(std::move(label)), parents_(std::move(parents)),
+          parent_known_sizes_(parents_.size()) {
         logger_ << "class" << "DIABase"
                 << "event" << "create"
                 << "type" << "DOp"
@@ -153,6 +221,12 @@ public:
     virtual bool RequireParentPushData(size_t /* parent_index */) const
     { return false; }
 
+    //! Virtual method to determine whether the result of this node does not
+    //! depend on the order of the items it receives, like that of a
+    //! ReduceByKey. Forwarding nodes ask their children. Used by Concat() to
+    //! skip the order-preserving exchange.
+    virtual bool OrderAgnostic() const;
+
     //! \name Pure Virtual Methods called by StageBuilder
     //! \{
 
@@ -285,6 +359,49 @@ public:
 
     void set_mem_limit(const DIAMemUse& mem_limit) { mem_limit_ = mem_limit; }
 
+    //! Mark the items pushed by this node as partitioned among the workers by
+    //! the key of KeyExtractor, such that all items with equal keys are on the
+    //! same worker. Only stateless key extractors are recorded, since then
+    //! their type identifies the key.
+    template <typename KeyExtractor>
+    void set_partition_key() {
+        if (std::is_empty<KeyExtractor>::value)
+            partition_key_ = &typeid(KeyExtractor);
+    }
+
+    //! Whether the items pushed by this node are partitioned by the key of
+    //! KeyExtractor, hence a child grouping by it needs no data exchange.
+    template <typename KeyExtractor>
+    bool partitioned_by() const {
+        return std::is_empty<KeyExtractor>::value &&
+               partition_key_ != nullptr &&
+               *partition_key_ == typeid(KeyExtractor);
+    }
+
+    //! Global number of items pushed by this node, if known.
+    const KnownSize& known_size() const { return known_size_; }
+
+    //! Record the global number of items pushed by this node, and whether they
+    //! are partitioned as by Context::CalculateLocalRange().
+    void set_known_size(size_t total, bool balanced) {
+        known_size_.total = total;
+        known_size_.balanced = balanced;
+    }
+
+    //! Known size of the items pushed by parent parent_index, which each
+    //! parent delivers before StartPreOp(). It is valid for the items received
+    //! in the PreOp only if the parent's function stack is empty.
+    const KnownSize& parent_known_size(size_t parent_index) const {
+        assert(parent_index < parent_known_sizes_.size());
+        return parent_known_sizes_[parent_index];
+    }
+
+    //! Called by parent parent_index before StartPreOp().
+    void set_parent_known_size(size_t parent_index, const KnownSize& size) {
+        if (parent_index < parent_known_sizes_.size())
+            parent_known_sizes_[parent_index] = size;
+    }
+
 protected:
     //! \name Fixed DIA Information
     //! \{
@@ -317,6 +434,17 @@ protected:
     //! consume = true
     size_t consume_counter_ = 1;
 
+    //! type of the key extractor by which the pushed items are partitioned, or
+    //! null if unknown.
+    const std::type_info* partition_key_ = nullptr;
+
+    //! global number of items pushed by this node, if known
+    KnownSize known_size_;
+
+    //! known sizes of the items pushed by each parent, indexed by the
+    //! parent_index, since parents_ shrinks when parents are done.
+    std::vector<KnownSize> parent_known_sizes_;
+
     //! \}
 
 public:
@@ -129,8 +129,10 @@ public:
             return;
         }
 
-        for (const Child& child : children_)
+        for (const Child& child : children_) {
+            child.node->set_parent_known_size(child.parent_index, known_size_);
             child.node->StartPreOp(child.parent_index);
+        }
 
         if (consume_counter() > 0 && consume_counter() != kNeverConsume)
             DecConsumeCounter(1);
@@ -165,15 +167,18 @@ public:
 
         if (nonfile_children.size() == 0) return;
 
-        // push into remaining which have a function stack or no direct File*
-        data::File::Reader reader = file.GetReader(consume);
-        while (reader.HasNext()) {
-            ValueType item = reader.Next<ValueType>();
-            for (const Child& child : nonfile_children) {
-                if (child.callback)
-                    child.callback(item);
-            }
-        }
+        // push into remaining which have a function stack or no direct File*,
+        // reading ahead as far as RAM allows, since spilled Files are
+        // otherwise bound by I/O latency.
+        data::File::Reader reader =
+            file.GetReader(consume, data::File::auto_prefetch_size_);
+        data::ReadEachItem<ValueType>(
+            reader, [&](const ValueType& item) {
+                for (const Child& child : nonfile_children) {
+                    if (child.callback)
+                        child.callback(item);
+                }
+            });
     }
 
 protected:
@@ -13,11 +13,13 @@
 #define THRILL_API_DISTRIBUTE_HEADER
 
 #include <thrill/api/dia.hpp>
+#include <thrill/api/gather_tree.hpp>
 #include <thrill/api/source_node.hpp>
 #include <thrill/common/logger.hpp>
 
 #include <tlx/vector_free.hpp>
 
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -54,36 +56,66 @@ public:
 
     //! Executes the scatter operation: source sends out its data.
     void Execute() final {
+        size_t p = context_.num_workers();
+        bool is_source = (context_.my_rank() == source_id_);
 
-        data::CatStream::Writers emitters = stream_->GetWriters();
+        // serialize the items in the order of the ranks relative to the
+        // source, such that each subtree's items are contiguous.
+        if (is_source) {
+            data::File::Writer writer = file_.GetWriter();
+            for (size_t r = 0; r < p; ++r) {
+                common::Range local = common::CalculateLocalRange(
+                    in_vector_.size(), p, (source_id_ + r) % p);
 
-        if (context_.my_rank() == source_id_)
-        {
-            size_t in_size = in_vector_.size();
+                for (size_t i = local.begin; i < local.end; ++i) {
+                    writer.Put(in_vector_[i]);
+                }
+            }
+        }
+
+        std::pair<size_t, size_t> sizes = context_.net.Broadcast(
+            std::make_pair(in_vector_.size(), file_.size_bytes()), source_id_);
 
-            for (size_t w = 0; w < emitters.size(); ++w) {
+        // item offsets of the relative ranks in the source's File
+        std::vector<size_t> offsets(p + 1);
+        for (size_t r = 0; r < p; ++r) {
+            offsets[r + 1] = offsets[r] + common::CalculateLocalRange(
+                sizes.first, p, (source_id_ + r) % p).size();
+        }
 
-                common::Range local =
-                    common::CalculateLocalRange(in_size, emitters.size(), w);
+        if (UseGatherTree(context_, sizes.second)) {
+            ScatterTree<ValueType>(
+                context_, this->dia_id(), source_id_, offsets, &file_);
+            return;
+        }
 
-                for (size_t i = local.begin; i < local.end; ++i) {
-                    emitters[w].Put(in_vector_[i]);
-                }
+        // send the items directly to their workers
+        data::CatStreamPtr stream = context_.GetNewCatStream(this);
+        data::CatStream::Writers emitters = stream->GetWriters();
+        if (is_source) {
+            for (size_t r = 0; r < p; ++r) {
+                if (offsets[r] == offsets[r + 1]) continue;
+                emitters[(source_id_ + r) % p].AppendBlocks(
+                    file_.GetItemRange<ValueType>(offsets[r], offsets[r + 1]));
             }
+            file_.Clear();
         }
+        emitters.Close();
+
+        ReceiveFile(*stream, source_id_, &file_);
     }
 
     void PushData(bool consume) final {
-        data::CatStream::CatReader readers = stream_->GetCatReader(consume);
+        data::File::Reader reader = file_.GetReader(consume);
 
-        while (readers.HasNext()) {
-            this->PushItem(readers.Next<ValueType>());
+        while (reader.HasNext()) {
+            this->PushItem(reader.Next<ValueType>());
         }
     }
 
     void Dispose() final {
         tlx::vector_free(in_vector_);
-        stream_.reset();
+        file_.Clear();
     }
 
 private:
@@ -92,7 +124,8 @@ private:
     //! source worker id, which sends vector
     size_t source_id_;
 
-    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
+    //! the items of this worker after Execute()
+    data::File file_ { context_.GetFile(this) };
 };
 
 /*!
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * thrill/api/distributed_glob.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/distributed_glob.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/data/serialization_macro.hpp>
+
+#include <string>
+#include <vector>
+
+THRILL_SERIALIZE(thrill::vfs::FileBlock, offset, size, hosts)
+THRILL_SERIALIZE(thrill::vfs::FileInfo, type, path, size, size_ex_psum, mtime,
+                 blocks)
+
+namespace thrill {
+namespace api {
+
+static constexpr bool debug = false;
+
+vfs::FileList DistributedGlob(
+    Context& ctx, const std::vector<std::string>& globlist,
+    const vfs::GlobType& gtype) {
+
+    const size_t num_workers = ctx.num_workers();
+
+    // list the remote entries assigned to this worker
+    std::vector<std::vector<vfs::FileInfo> > listed;
+    size_t num_remote = 0;
+    for (const std::string& path : globlist) {
+        if (!vfs::IsRemoteUri(path)) continue;
+        if (num_remote++ % num_workers == ctx.my_rank())
+            listed.emplace_back(vfs::Glob(path, gtype));
+    }
+
+    // all workers have the same globlist, hence skip the collective together
+    if (num_remote == 0)
+        return vfs::Glob(globlist, gtype);
+
+    auto all_listed = ctx.net.AllGather(listed);
+
+    // assemble the list in the order of the globs
+    vfs::FileList filelist;
+    size_t remote = 0;
+    for (const std::string& path : globlist) {
+        if (vfs::IsRemoteUri(path)) {
+            const std::vector<vfs::FileInfo>& files =
+                (*all_listed)[remote % num_workers][remote / num_workers];
+            filelist.insert(filelist.end(), files.begin(), files.end());
+            ++remote;
+        }
+        else {
+            vfs::FileList files = vfs::Glob(path, gtype);
+            filelist.insert(filelist.end(), files.begin(), files.end());
+        }
+    }
+    filelist.CalculateStats();
+
+    sLOG << "DistributedGlob() remote" << num_remote
+         << "files" << filelist.size() << "total_size" << filelist.total_size;
+
+    return filelist;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
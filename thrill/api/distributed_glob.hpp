@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * thrill/api/distributed_glob.hpp
+ *
+ * Glob of remote file systems, listed once and distributed to all workers.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_DISTRIBUTED_GLOB_HEADER
+#define THRILL_API_DISTRIBUTED_GLOB_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/vfs/file_io.hpp>
+
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \ingroup api_layer
+//! \{
+
+/*!
+ * Collective vfs::Glob() of a glob path list. The s3:// and hdfs:// entries
+ * are assigned round-robin to the workers, each lists only its entries
+ * (through the process-wide listing cache of vfs::Glob()), and the listings
+ * with sizes and block locations are exchanged with an AllGather over the
+ * FlowControlChannel. Hence, a remote prefix is listed once instead of once per
+ * worker. Local paths are globbed by each worker, as with local storage each
+ * host may see different files. Must be called by all workers with the same
+ * globlist.
+ */
+vfs::FileList DistributedGlob(
+    Context& ctx, const std::vector<std::string>& globlist,
+    const vfs::GlobType& gtype = vfs::GlobType::All);
+
+//! \}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_DISTRIBUTED_GLOB_HEADER
+
+/******************************************************************************/
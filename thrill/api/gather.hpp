@@ -14,7 +14,9 @@
 
 #include <thrill/api/action_node.hpp>
 #include <thrill/api/dia.hpp>
+#include <thrill/api/gather_tree.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -42,7 +44,7 @@ public:
         assert(target_id_ < context_.num_workers());
 
         auto pre_op_fn = [this](const ValueType& input) {
-                             emitters_[target_id_].Put(input);
+                             writer_.Put(input);
                          };
 
         // close the function stack with our pre op and register it at parent
@@ -52,25 +54,43 @@ public:
     }
 
     void StartPreOp(size_t /* parent_index */) final {
-        emitters_ = stream_->GetWriters();
-
-        // close all but the target
-        for (size_t i = 0; i < emitters_.size(); i++) {
-            if (i == target_id_) continue;
-            emitters_[i].Close();
-        }
+        writer_ = file_.GetWriter();
     }
 
     void StopPreOp(size_t /* parent_index */) final {
-        emitters_[target_id_].Close();
+        writer_.Close();
     }
 
     void Execute() final {
-        auto reader = stream_->GetCatReader(true /* consume */);
+        size_t total_bytes = context_.net.AllReduce(file_.size_bytes());
+
+        if (!UseGatherTree(context_, total_bytes)) {
+            // send the items directly to the target
+            data::CatStreamPtr stream = context_.GetNewCatStream(this);
+            data::CatStream::Writers emitters = stream->GetWriters();
+            emitters[target_id_].AppendBlocks(file_.blocks());
+            file_.Clear();
+            emitters.Close();
+
+            auto reader = stream->GetCatReader(true /* consume */);
+            while (reader.HasNext()) {
+                out_vector_->push_back(reader.template Next<ValueType>());
+            }
+            return;
+        }
+
+        // the tree delivers the items of the workers before the target last
+        size_t before_target = context_.net.ExPrefixSum(file_.num_items());
+        GatherTree(context_, this->dia_id(), target_id_, &file_);
+        if (context_.my_rank() != target_id_) return;
 
+        size_t begin = out_vector_->size();
+        auto reader = file_.GetConsumeReader();
         while (reader.HasNext()) {
             out_vector_->push_back(reader.template Next<ValueType>());
         }
+        std::rotate(out_vector_->begin() + begin,
+                    out_vector_->end() - before_target, out_vector_->end());
     }
 
     const std::vector<ValueType>& result() const final {
@@ -84,8 +104,9 @@ private:
     //! Vector pointer to write elements to.
     std::vector<ValueType>* out_vector_;
 
-    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
-    data::CatStream::Writers emitters_;
+    //! local items, which are sent in Execute() once the total size is known
+    data::File file_ { context_.GetFile(this) };
+    data::File::Writer writer_;
 };
 
 template <typename ValueType, typename Stack>
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * thrill/api/gather_tree.cpp
+ *
+ * Tree and ring algorithms for Gather, AllGather, and Distribute of large DIAs,
+ * which forward the workers' Files over a series of CatStreams.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/gather_tree.hpp>
+
+#include <utility>
+
+namespace thrill {
+namespace api {
+
+bool UseGatherTree(Context& ctx, size_t total_bytes) {
+    // with two workers, the direct transfer is already a tree
+    return ctx.num_workers() > 2 &&
+           total_bytes >= ctx.mem_config().gather_tree_bytes_;
+}
+
+void ReceiveFile(data::CatStream& stream, size_t source, data::File* file) {
+    std::vector<data::CatStream::Reader> readers = stream.GetReaders();
+    while (true) {
+        data::PinnedBlock b = readers[source].source().NextBlock();
+        if (!b.IsValid()) break;
+        file->AppendBlock(std::move(b).MoveToBlock());
+    }
+}
+
+void GatherTree(Context& ctx, size_t dia_id, size_t target, data::File* file) {
+    size_t p = ctx.num_workers();
+    size_t rel = (ctx.my_rank() + p - target) % p;
+    bool sent = false;
+
+    for (size_t mask = 1; mask < p; mask <<= 1) {
+        data::CatStreamPtr stream = ctx.GetNewCatStream(dia_id);
+        data::CatStream::Writers writers = stream->GetWriters();
+
+        if (!sent && (rel & mask)) {
+            // pass everything gathered so far down the tree
+            writers[(rel - mask + target) % p].AppendBlocks(file->blocks());
+            file->Clear();
+            sent = true;
+        }
+        writers.Close();
+
+        if (!sent && rel + mask < p)
+            ReceiveFile(*stream, (rel + mask + target) % p, file);
+    }
+}
+
+std::vector<data::File>
+RingAllGather(Context& ctx, size_t dia_id, data::File&& file) {
+    size_t p = ctx.num_workers(), rank = ctx.my_rank();
+    size_t succ = (rank + 1) % p, pred = (rank + p - 1) % p;
+
+    std::vector<data::File> files;
+    files.reserve(p);
+    for (size_t i = 0; i < p; ++i)
+        files.emplace_back(ctx.GetFile(dia_id));
+    files[rank] = std::move(file);
+
+    // in round r, forward the File of worker rank - r and receive that of
+    // worker rank - r - 1.
+    for (size_t r = 0; r + 1 < p; ++r) {
+        data::CatStreamPtr stream = ctx.GetNewCatStream(dia_id);
+        data::CatStream::Writers writers = stream->GetWriters();
+
+        writers[succ].AppendBlocks(files[(rank + p - r) % p].blocks());
+        writers.Close();
+
+        ReceiveFile(*stream, pred, &files[(rank + 2 * p - r - 1) % p]);
+    }
+    return files;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
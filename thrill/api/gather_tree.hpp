@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * thrill/api/gather_tree.hpp
+ *
+ * Tree and ring algorithms for Gather, AllGather, and Distribute of large DIAs,
+ * which forward the workers' Files over a series of CatStreams.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_GATHER_TREE_HEADER
+#define THRILL_API_GATHER_TREE_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/data/cat_stream.hpp>
+#include <thrill/data/file.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \ingroup api_layer
+//! \{
+
+//! whether Gather, AllGather, and Distribute of total_bytes over all workers
+//! use the tree and ring algorithms instead of sending directly to the
+//! targets.
+bool UseGatherTree(Context& ctx, size_t total_bytes);
+
+/*!
+ * Binomial tree gather of the Files of all workers to the target worker. In
+ * round k, the workers whose rank relative to the target has bit k set send
+ * their File to the worker 2^k below them, which appends it to its File.
+ * Hence, the target receives at most log2(p) streams, and afterwards holds the
+ * items in the order of the ranks relative to the target, i.e. the items of
+ * workers target..p-1 followed by those of 0..target-1. The other workers'
+ * Files are empty. Must be called by all workers.
+ */
+void GatherTree(Context& ctx, size_t dia_id, size_t target, data::File* file);
+
+/*!
+ * Ring all-gather of the Files of all workers: in each of the p-1 rounds, each
+ * worker sends the File received in the previous round to its successor, such
+ * that each worker receives from only one other worker at a time, and sends
+ * each File once. Returns the Files of all workers, indexed by their rank.
+ * Must be called by all workers.
+ */
+std::vector<data::File>
+RingAllGather(Context& ctx, size_t dia_id, data::File&& file);
+
+//! append the Blocks sent by worker source on the stream to file
+void ReceiveFile(data::CatStream& stream, size_t source, data::File* file);
+
+/*!
+ * Binomial tree scatter of the source worker's File, which contains the items
+ * of all workers in the order of their ranks relative to the source. The items
+ * of relative rank r are [offsets[r], offsets[r+1]). In each round, the
+ * workers holding items pass the upper half of their range on, such that the
+ * source sends only log2(p) sub-ranges, and all workers forward data. Finally,
+ * each worker's File contains only its own items. Must be called by all
+ * workers.
+ */
+template <typename ValueType>
+void ScatterTree(Context& ctx, size_t dia_id, size_t source,
+                 const std::vector<size_t>& offsets, data::File* file) {
+    size_t p = ctx.num_workers();
+    size_t rel = (ctx.my_rank() + p - source) % p;
+
+    size_t top = 1;
+    while (top < p) top <<= 1;
+
+    // the File holds the items of relative ranks [rel, rel + 2 * mask)
+    for (size_t mask = top / 2; mask != 0; mask >>= 1) {
+        data::CatStreamPtr stream = ctx.GetNewCatStream(dia_id);
+        data::CatStream::Writers writers = stream->GetWriters();
+
+        if (rel % (2 * mask) == 0 && rel + mask < p) {
+            size_t end = std::min(rel + 2 * mask, p);
+            if (offsets[rel + mask] != offsets[end]) {
+                writers[(rel + mask + source) % p].AppendBlocks(
+                    file->template GetItemRange<ValueType>(
+                        offsets[rel + mask] - offsets[rel],
+                        offsets[end] - offsets[rel]));
+            }
+        }
+        writers.Close();
+
+        if (rel % (2 * mask) == mask)
+            ReceiveFile(*stream, (rel - mask + source) % p, file);
+    }
+
+    // drop the Blocks of the items passed on
+    if (offsets[rel] == offsets[rel + 1]) {
+        file->Clear();
+        return;
+    }
+    std::vector<data::Block> own = file->template GetItemRange<ValueType>(
+        0, offsets[rel + 1] - offsets[rel]);
+    file->Clear();
+    for (data::Block& b : own)
+        file->AppendBlock(std::move(b));
+}
+
+//! \}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_GATHER_TREE_HEADER
+
+/******************************************************************************/
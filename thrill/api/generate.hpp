@@ -49,8 +49,10 @@ public:
                  size_t size)
         : Super(ctx, "Generate"),
           generate_function_(generate_function),
-          size_(size)
-    { }
+          size_(size) {
+        // items are pushed in the ranges of Context::CalculateLocalRange()
+        this->set_known_size(size_, /* balanced */ true);
+    }
 
     void PushData(bool /* consume */) final {
         common::Range local = context_.CalculateLocalRange(size_);
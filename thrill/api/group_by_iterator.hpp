@@ -19,6 +19,7 @@
 #include <thrill/common/logger.hpp>
 #include <thrill/core/multiway_merge.hpp>
 #include <thrill/data/file.hpp>
+#include <tlx/define.hpp>
 
 #include <algorithm>
 #include <utility>
@@ -35,7 +36,8 @@ namespace api {
 // forward declarations for friend classes
 template <typename ValueType,
           typename KeyExtractor, typename GroupFunction, typename HashFunction,
-          bool UseLocationDetection>
+          bool UseLocationDetection, bool UseHashGrouping,
+          typename CombineFunction>
 class GroupByNode;
 
 template <typename ValueType,
@@ -44,98 +46,210 @@ class GroupToIndexNode;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename ValueType, typename KeyExtractor, typename Comparator>
-class GroupByIterator
+/*!
+ * Common implementation of GroupByIterator and GroupByMultiwayMergeIterator:
+ * items are pulled from the Source in chunks into a lookahead buffer, from
+ * which they are returned one by one with Next(), in batches with NextBatch(),
+ * or as runs of the current group directly in the buffer with NextRun(). The
+ * key of each item is compared once with the key of the current group.
+ */
+template <typename ValueType, typename KeyExtractor, typename Source>
+class GroupByLookaheadIterator
 {
-    template <typename T1,
-              typename T2,
-              typename T3,
-              typename T4,
-              bool T5>
-    friend class GroupByNode;
-
-    template <typename T1,
-              typename T2,
-              typename T3>
-    friend class GroupToIndexNode;
-
 public:
-    static constexpr bool debug = false;
     using ValueIn = ValueType;
     using Key = typename common::FunctionTraits<KeyExtractor>::result_type;
-    using Reader = typename data::File::Reader;
 
-    GroupByIterator(Reader& reader, const KeyExtractor& key_extractor)
-        : reader_(reader),
+    //! number of items pulled from the Source at once
+    static constexpr size_t kBufferItems =
+        std::max<size_t>(4096 / sizeof(ValueIn), 1);
+
+    GroupByLookaheadIterator(Source& source, const KeyExtractor& key_extractor)
+        : source_(source),
           key_extractor_(key_extractor),
-          is_reader_empty_(false),
-          equal_key_(true),
-          elem_(reader_.template Next<ValueIn>()),
-          key_(key_extractor_(elem_)) { }
+          buffer_(kBufferItems),
+          key_(FirstKey()) { }
 
     //! non-copyable: delete copy-constructor
-    GroupByIterator(const GroupByIterator&) = delete;
+    GroupByLookaheadIterator(const GroupByLookaheadIterator&) = delete;
     //! non-copyable: delete assignment operator
-    GroupByIterator& operator = (const GroupByIterator&) = delete;
+    GroupByLookaheadIterator& operator = (
+        const GroupByLookaheadIterator&) = delete;
     //! move-constructor: default
-    GroupByIterator(GroupByIterator&&) = default;
+    GroupByLookaheadIterator(GroupByLookaheadIterator&&) = default;
     //! move-assignment operator: default
-    GroupByIterator& operator = (GroupByIterator&&) = default;
+    GroupByLookaheadIterator& operator = (GroupByLookaheadIterator&&) = default;
 
+    //! whether the current group has more items
     bool HasNext() {
+        Refill();
         return (!is_reader_empty_ && equal_key_);
     }
 
+    //! return the next item of the current group
     ValueIn Next() {
+        Refill();
         assert(!is_reader_empty_);
-        ValueIn elem = elem_;
-        GetNextElem();
+        ValueIn elem = std::move(buffer_[pos_]);
+        if (++pos_ != end_) CompareKey();
         return elem;
     }
 
-private:
+    /*!
+     * Copy up to n next items of the current group into out and return their
+     * number, which is less than n only if the group ends.
+     */
+    size_t NextBatch(ValueIn* out, size_t n) {
+        size_t done = 0;
+        while (done < n && HasNext()) {
+            out[done++] = std::move(buffer_[pos_]);
+            if (++pos_ != end_) CompareKey();
+        }
+        return done;
+    }
+
+    /*!
+     * Return a pointer to a run of size next items of the current group, at
+     * most max_size, directly inside the lookahead buffer. The run is valid
+     * until the next call of any method of the iterator. size is zero if the
+     * group has ended.
+     */
+    const ValueIn * NextRun(size_t& size, size_t max_size = size_t(-1)) {
+        if (!HasNext()) {
+            size = 0;
+            return nullptr;
+        }
+        const ValueIn* run = buffer_.data() + pos_;
+        size_t limit = pos_ + std::min(max_size, end_ - pos_);
+        // the item at pos_ is known to belong to the current group.
+        ++pos_;
+        while (pos_ != limit && CompareKey())
+            ++pos_;
+        size = buffer_.data() + pos_ - run;
+        return run;
+    }
+
+protected:
     bool HasNextForReal() {
+        Refill();
         return !is_reader_empty_;
     }
 
     const Key& GetNextKey() {
+        Refill();
         equal_key_ = true;
         return key_;
     }
 
 private:
-    Reader& reader_;
+    Source& source_;
     const KeyExtractor& key_extractor_;
-    bool is_reader_empty_;
-    bool equal_key_;
-    ValueIn elem_;
+    bool is_reader_empty_ = false;
+    bool equal_key_ = true;
+    //! lookahead buffer with items [pos_,end_) not yet delivered
+    std::vector<ValueIn> buffer_;
+    size_t pos_ = 0, end_ = 0;
     Key key_;
 
-    void GetNextElem() {
-        if (reader_.HasNext()) {
-            elem_ = reader_.template Next<ValueIn>();
-            Key key = key_extractor_(elem_);
-            if (key != key_) {
-                key_ = std::move(key);
-                equal_key_ = false;
-            }
-        }
-        else {
-            is_reader_empty_ = true;
+    //! pull the next chunk of items, if the buffer is exhausted.
+    void Refill() {
+        if (TLX_LIKELY(pos_ != end_) || is_reader_empty_) return;
+        Fill();
+        if (!is_reader_empty_) CompareKey();
+    }
+
+    //! pull the first chunk and return the key of the first item.
+    Key FirstKey() {
+        Fill();
+        assert(!is_reader_empty_);
+        return key_extractor_(buffer_[pos_]);
+    }
+
+    void Fill() {
+        pos_ = 0;
+        end_ = Pull(source_, buffer_.data(), buffer_.size());
+        if (end_ == 0) is_reader_empty_ = true;
+    }
+
+    //! compare the key of the item at pos_ with the current group's key, and
+    //! start a new group if they differ.
+    bool CompareKey() {
+        Key key = key_extractor_(buffer_[pos_]);
+        if (key != key_) {
+            key_ = std::move(key);
+            equal_key_ = false;
         }
+        return equal_key_;
+    }
+
+    //! pull items from a File reader, copying raw items in one run.
+    template <typename Reader>
+    static size_t Pull(Reader& reader, ValueIn* out, size_t n) {
+        return reader.template NextBatch<ValueIn>(out, n);
+    }
+
+    //! pull items from a MultiwayMergeTree one by one.
+    template <typename ReaderIterator, typename Comparator, bool Stable>
+    static size_t Pull(
+        core::MultiwayMergeTree<ValueIn, ReaderIterator, Comparator, Stable>&
+        puller, ValueIn* out, size_t n) {
+        size_t done = 0;
+        while (done < n && puller.HasNext())
+            out[done++] = puller.Next();
+        return done;
     }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+//! Iterator over the items of one group in a sorted File, see
+//! GroupByLookaheadIterator.
+template <typename ValueType, typename KeyExtractor, typename Comparator>
+class GroupByIterator
+    : public GroupByLookaheadIterator<
+          ValueType, KeyExtractor, typename data::File::Reader>
+{
+    template <typename T1,
+              typename T2,
+              typename T3,
+              typename T4,
+              bool T5,
+              bool T6,
+              typename T7>
+    friend class GroupByNode;
+
+    template <typename T1,
+              typename T2,
+              typename T3>
+    friend class GroupToIndexNode;
+
+public:
+    static constexpr bool debug = false;
+    using Reader = typename data::File::Reader;
+    using Super = GroupByLookaheadIterator<ValueType, KeyExtractor, Reader>;
+
+    GroupByIterator(Reader& reader, const KeyExtractor& key_extractor)
+        : Super(reader, key_extractor) { }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+//! Iterator over the items of one group merged from sorted Files, see
+//! GroupByLookaheadIterator.
 template <typename ValueType, typename KeyExtractor, typename Comparator>
 class GroupByMultiwayMergeIterator
+    : public GroupByLookaheadIterator<
+          ValueType, KeyExtractor,
+          core::MultiwayMergeTree<
+              ValueType, std::vector<data::File::Reader>::iterator, Comparator> >
 {
     template <typename T1,
               typename T2,
               typename T3,
               typename T4,
-              bool T5>
+              bool T5,
+              bool T6,
+              typename T7>
     friend class GroupByNode;
 
     template <typename T1,
@@ -145,70 +259,76 @@ class GroupByMultiwayMergeIterator
 
 public:
     static constexpr bool debug = false;
-    using ValueIn = ValueType;
-    using Key = typename common::FunctionTraits<KeyExtractor>::result_type;
     using Puller = core::MultiwayMergeTree<
-        ValueIn, std::vector<data::File::Reader>::iterator, Comparator>;
+        ValueType, std::vector<data::File::Reader>::iterator, Comparator>;
+    using Super = GroupByLookaheadIterator<ValueType, KeyExtractor, Puller>;
 
     GroupByMultiwayMergeIterator(Puller& reader, const KeyExtractor& key_extractor)
-        : reader_(reader),
-          key_extractor_(key_extractor),
-          is_reader_empty_(false),
-          equal_key_(true),
-          elem_(reader_.Next()),
-          key_(key_extractor_(elem_)) { }
+        : Super(reader, key_extractor) { }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/*!
+ * Iterator over the items of one group in hash grouping mode of GroupByNode.
+ * The items of all groups of a hash partition are stored in a vector, and the
+ * items of a group are chained via indexes in a second vector.
+ */
+template <typename ValueType>
+class GroupByHashIterator
+{
+public:
+    using ValueIn = ValueType;
+
+    //! index terminating the chain of a group
+    static constexpr size_t end_ = size_t(-1);
+
+    GroupByHashIterator(const std::vector<ValueIn>& items,
+                        const std::vector<size_t>& next, size_t head)
+        : items_(items), next_(next), index_(head) { }
 
     //! non-copyable: delete copy-constructor
-    GroupByMultiwayMergeIterator(const GroupByMultiwayMergeIterator&) = delete;
+    GroupByHashIterator(const GroupByHashIterator&) = delete;
     //! non-copyable: delete assignment operator
-    GroupByMultiwayMergeIterator& operator = (const GroupByMultiwayMergeIterator&) = delete;
-    //! move-constructor: default
-    GroupByMultiwayMergeIterator(GroupByMultiwayMergeIterator&&) = default;
-    //! move-assignment operator: default
-    GroupByMultiwayMergeIterator& operator = (GroupByMultiwayMergeIterator&&) = default;
+    GroupByHashIterator& operator = (const GroupByHashIterator&) = delete;
 
     bool HasNext() {
-        return (!is_reader_empty_ && equal_key_);
+        return index_ != end_;
     }
 
     ValueIn Next() {
-        assert(!is_reader_empty_);
-        ValueIn elem = elem_;
-        GetNextElem();
-        return elem;
+        assert(index_ != end_);
+        size_t i = index_;
+        index_ = next_[i];
+        return items_[i];
     }
 
-private:
-    bool HasNextForReal() {
-        return !is_reader_empty_;
+    //! copy up to n next items of the group into out, see
+    //! GroupByLookaheadIterator::NextBatch()
+    size_t NextBatch(ValueIn* out, size_t n) {
+        size_t done = 0;
+        while (done < n && HasNext())
+            out[done++] = Next();
+        return done;
     }
 
-    const Key& GetNextKey() {
-        equal_key_ = true;
-        return key_;
+    //! return the next item as a run of one item, since the items of a group
+    //! are not contiguous, see GroupByLookaheadIterator::NextRun()
+    const ValueIn * NextRun(size_t& size, size_t max_size = size_t(-1)) {
+        if (index_ == end_ || max_size == 0) {
+            size = 0;
+            return nullptr;
+        }
+        size_t i = index_;
+        index_ = next_[i];
+        size = 1;
+        return &items_[i];
     }
 
 private:
-    Puller& reader_;
-    const KeyExtractor& key_extractor_;
-    bool is_reader_empty_;
-    bool equal_key_;
-    ValueIn elem_;
-    Key key_;
-
-    void GetNextElem() {
-        if (reader_.HasNext()) {
-            elem_ = reader_.Next();
-            Key next_key = key_extractor_(elem_);
-            if (next_key != key_) {
-                key_ = std::move(next_key);
-                equal_key_ = false;
-            }
-        }
-        else {
-            is_reader_empty_ = true;
-        }
-    }
+    const std::vector<ValueIn>& items_;
+    const std::vector<size_t>& next_;
+    size_t index_;
 };
 
 //! \}
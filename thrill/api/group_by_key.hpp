@@ -19,6 +19,7 @@
 #include <thrill/api/dop_node.hpp>
 #include <thrill/api/group_by_iterator.hpp>
 #include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/core/location_detection.hpp>
 #include <thrill/core/reduce_functional.hpp>
@@ -38,12 +39,16 @@
 namespace thrill {
 namespace api {
 
+//! CombineFunction type of GroupByNode without sender-side combining
+struct GroupByNoCombine { };
+
 /*!
  * \ingroup api_layer
  */
 template <typename ValueType,
           typename KeyExtractor, typename GroupFunction, typename HashFunction,
-          bool UseLocationDetection>
+          bool UseLocationDetection, bool UseHashGrouping,
+          typename CombineFunction = GroupByNoCombine>
 class GroupByNode final : public DOpNode<ValueType>
 {
 private:
@@ -57,6 +62,14 @@ private:
     using ValueIn =
         typename common::FunctionTraits<KeyExtractor>::template arg_plain<0>;
 
+    static constexpr bool use_combine_ =
+        !std::is_same<CombineFunction, GroupByNoCombine>::value;
+
+    //! tag dispatch types of the optional modes, which require Keys to be
+    //! comparable using operator ==
+    using HashGroupingMode = std::integral_constant<bool, UseHashGrouping>;
+    using CombineMode = std::integral_constant<bool, use_combine_>;
+
     struct ValueComparator {
     public:
         explicit ValueComparator(const GroupByNode& node) : node_(node) { }
@@ -121,13 +134,18 @@ public:
     GroupByNode(const ParentDIA& parent,
                 const KeyExtractor& key_extractor,
                 const GroupFunction& groupby_function,
-                const HashFunction& hash_function = HashFunction())
+                const HashFunction& hash_function = HashFunction(),
+                const CombineFunction& combine_function = CombineFunction())
         : Super(parent.ctx(), "GroupByKey", { parent.id() }, { parent.node() }),
           key_extractor_(key_extractor),
           groupby_function_(groupby_function),
           hash_function_(hash_function),
+          combine_function_(combine_function),
+          local_(ParentDIA::stack_empty &&
+                 parent.node()->template partitioned_by<KeyExtractor>()),
           location_detection_(parent.ctx(), Super::dia_id()),
-          pre_file_(context_.GetFile(this)) {
+          pre_file_(context_.GetFile(this)),
+          combine_table_(0, hash_function) {
         // Hook PreOp
         auto pre_op_fn = [=](const ValueIn& input) {
                              PreOp(input);
@@ -141,24 +159,33 @@ public:
     void StartPreOp(size_t /* parent_index */) final {
         emitters_ = stream_->GetWriters();
         pre_writer_ = pre_file_.GetWriter();
-        if (UseLocationDetection)
+        if (UseLocationDetection && !local_)
             location_detection_.Initialize(DIABase::mem_limit_);
+        if (use_combine_)
+            combine_limit_ = DIABase::mem_limit_ / 2;
     }
 
     //! Send all elements to their designated PEs
     void PreOp(const ValueIn& v) {
+        if (use_combine_)
+            return PreOpCombine(v, CombineMode());
+
         size_t hash = hash_function_(key_extractor_(v));
-        if (UseLocationDetection) {
+        if (UseLocationDetection && !local_) {
             pre_writer_.Put(v);
             location_detection_.Insert(HashCount { hash, 1 });
         }
         else {
-            const size_t recipient = hash % emitters_.size();
-            emitters_[recipient].Put(v);
+            emitters_[Recipient(hash)].Put(v);
         }
     }
 
     void StopPreOp(size_t /* parent_index */) final {
+        if (use_combine_) {
+            FlushCombineTable(CombineMode());
+            sLOG << "GroupByKey: combiner reduced" << combine_in_
+                 << "items to" << combine_out_;
+        }
         pre_writer_.Close();
     }
 
@@ -171,7 +198,11 @@ public:
     }
 
     DIAMemUse PushDataMemUse() final {
-        if (files_.size() <= 1) {
+        if (UseHashGrouping) {
+            // hash partitions are loaded and grouped in memory
+            return DIAMemUse::Max();
+        }
+        else if (files_.size() <= 1) {
             // direct push, no merge necessary
             return 0;
         }
@@ -182,7 +213,7 @@ public:
     }
 
     void Execute() override {
-        if (UseLocationDetection) {
+        if (UseLocationDetection && !local_) {
             std::unordered_map<size_t, size_t> target_processors;
             size_t max_hash = location_detection_.Flush(target_processors);
             auto file_reader = pre_file_.GetConsumeReader();
@@ -198,10 +229,16 @@ public:
         // data has been pushed during pre-op -> close emitters
         emitters_.Close();
 
-        MainOp();
+        if (UseHashGrouping)
+            MainOpHash();
+        else
+            MainOp();
     }
 
     void PushData(bool consume) final {
+        if (UseHashGrouping)
+            return PushDataHash(consume, HashGroupingMode());
+
         LOG << "sort data";
         common::StatsTimerStart timer;
         const size_t num_runs = files_.size();
@@ -297,6 +334,11 @@ private:
     KeyExtractor key_extractor_;
     GroupFunction groupby_function_;
     HashFunction hash_function_;
+    CombineFunction combine_function_;
+
+    //! whether the parent's items are partitioned by the key, such that all
+    //! items stay on this worker.
+    const bool local_;
 
     core::LocationDetection<HashCount> location_detection_;
 
@@ -311,6 +353,202 @@ private:
     data::File pre_file_;
     data::File::Writer pre_writer_;
 
+    //! \name Sender-side Combining
+    //! \{
+
+    //! items of a key in the combine table
+    struct CombineGroup {
+        std::vector<ValueIn> items;
+        //! number of items after the last combine
+        size_t combined = 0;
+    };
+
+    //! bounded table of items per key, which are combined before sending
+    std::unordered_map<Key, CombineGroup, HashFunction> combine_table_;
+
+    //! estimated bytes in combine_table_ and limit on it
+    size_t combine_bytes_ = 0, combine_limit_ = 0;
+
+    //! statistics: items inserted and sent by the combiner
+    size_t combine_in_ = 0, combine_out_ = 0;
+
+    //! minimum number of items of a key before combining them
+    static constexpr size_t min_combine_items_ = 16;
+
+    //! Insert an item into the combine table. The items of a key are combined
+    //! whenever their number doubled since the last combine.
+    void PreOpCombine(const ValueIn& v, std::true_type /* use_combine */) {
+        ++combine_in_;
+        auto it = combine_table_.find(key_extractor_(v));
+        if (it == combine_table_.end()) {
+            it = combine_table_.emplace(
+                key_extractor_(v), CombineGroup()).first;
+            combine_bytes_ += sizeof(Key) + sizeof(CombineGroup)
+                              + 2 * sizeof(void*);
+        }
+
+        CombineGroup& g = it->second;
+        g.items.emplace_back(v);
+        combine_bytes_ += sizeof(ValueIn);
+
+        if (g.items.size() >= std::max(min_combine_items_, 2 * g.combined)) {
+            combine_bytes_ -= g.items.size() * sizeof(ValueIn);
+            combine_function_(g.items, it->first);
+            g.combined = g.items.size();
+            combine_bytes_ += g.items.size() * sizeof(ValueIn);
+        }
+
+        if (combine_bytes_ > combine_limit_ || mem::memory_exceeded)
+            FlushCombineTable(std::true_type());
+    }
+
+    void PreOpCombine(const ValueIn&, std::false_type /* use_combine */) { }
+
+    //! worker receiving the items with the given key hash
+    size_t Recipient(size_t hash) const {
+        return local_ ? context_.my_rank() : hash % emitters_.size();
+    }
+
+    //! Combine the items of all keys in the table and send them.
+    void FlushCombineTable(std::true_type /* use_combine */) {
+        for (auto& kg : combine_table_) {
+            CombineGroup& g = kg.second;
+            if (g.items.size() > g.combined)
+                combine_function_(g.items, kg.first);
+
+            const size_t recipient = Recipient(hash_function_(kg.first));
+            for (const ValueIn& e : g.items)
+                emitters_[recipient].Put(e);
+            combine_out_ += g.items.size();
+        }
+        combine_table_.clear();
+        combine_bytes_ = 0;
+    }
+
+    void FlushCombineTable(std::false_type /* use_combine */) { }
+
+    //! \}
+
+    //! \name Hash Grouping
+    //! \{
+
+    //! number of hash partitions of received items
+    static constexpr size_t num_hash_partitions_ = 64;
+
+    //! received items in memory, by hash partition
+    std::vector<std::vector<ValueIn> > hash_items_;
+
+    //! spilled items, by hash partition
+    std::vector<data::File> hash_files_;
+
+    //! hash partition of a key, using other bits than the worker selection.
+    size_t HashPartition(const Key& key) const {
+        return hash_function_(key) / context_.num_workers()
+               % num_hash_partitions_;
+    }
+
+    //! Spill the hash partition with the most items in memory to its File.
+    void SpillLargestHashPartition() {
+        size_t p = 0;
+        for (size_t i = 1; i < num_hash_partitions_; ++i) {
+            if (hash_items_[i].size() > hash_items_[p].size())
+                p = i;
+        }
+        if (hash_items_[p].empty()) return;
+
+        sLOG << "GroupByKey: spilling hash partition" << p
+             << "with" << hash_items_[p].size() << "items";
+
+        data::File::Writer w = hash_files_[p].GetWriter();
+        for (const ValueIn& e : hash_items_[p]) {
+            w.Put(e);
+        }
+        w.Close();
+        tlx::vector_free(hash_items_[p]);
+    }
+
+    //! Receive elements from other workers into hash partitions.
+    void MainOpHash() {
+        LOG << "running group by main op with hash grouping";
+
+        hash_items_.resize(num_hash_partitions_);
+        for (size_t p = 0; p < num_hash_partitions_; ++p)
+            hash_files_.emplace_back(context_.GetFile(this));
+
+        common::StatsTimerStart timer;
+        auto reader = stream_->GetCatReader(/* consume */ true);
+        while (reader.HasNext()) {
+            if (mem::memory_exceeded)
+                SpillLargestHashPartition();
+
+            ValueIn in = reader.template Next<ValueIn>();
+            hash_items_[HashPartition(key_extractor_(in))].emplace_back(
+                std::move(in));
+            ++totalsize_;
+        }
+        stream_.reset();
+
+        timer.Stop();
+
+        LOG << "RESULT"
+            << " name=mainop_hash"
+            << " time=" << timer
+            << " items=" << totalsize_;
+    }
+
+    //! Group the items of each hash partition and call the user function
+    //! once per group.
+    void PushDataHash(bool consume, std::true_type /* use_hash_grouping */) {
+        using Iterator = GroupByHashIterator<ValueIn>;
+
+        for (size_t p = 0; p < hash_items_.size(); ++p) {
+            std::vector<ValueIn> items;
+
+            // load spilled items of the partition and append those in memory
+            if (!hash_files_[p].empty()) {
+                items.reserve(
+                    hash_files_[p].num_items() + hash_items_[p].size());
+                auto r = hash_files_[p].GetReader(consume);
+                while (r.HasNext())
+                    items.emplace_back(r.template Next<ValueIn>());
+            }
+            if (consume && items.empty()) {
+                items.swap(hash_items_[p]);
+            }
+            else {
+                items.insert(items.end(),
+                             hash_items_[p].begin(), hash_items_[p].end());
+                if (consume) tlx::vector_free(hash_items_[p]);
+            }
+
+            // chain items of equal keys, in reverse such that each group is
+            // delivered in the received order.
+            std::unordered_map<Key, size_t, HashFunction> heads(
+                items.size(), hash_function_);
+            std::vector<size_t> next(items.size());
+
+            for (size_t i = items.size(); i-- > 0; ) {
+                auto it = heads.emplace(key_extractor_(items[i]),
+                                        size_t(Iterator::end_)).first;
+                next[i] = it->second;
+                it->second = i;
+            }
+
+            for (const auto& group : heads) {
+                Iterator user_iterator(items, next, group.second);
+                // call user function
+                const ValueOut res = groupby_function_(
+                    user_iterator, group.first);
+                // push result to callback functions
+                this->PushItem(res);
+            }
+        }
+    }
+
+    void PushDataHash(bool, std::false_type /* use_hash_grouping */) { }
+
+    //! \}
+
     void RunUserFunc(data::File& f, bool consume) {
         auto r = f.GetReader(consume);
         if (r.HasNext()) {
@@ -396,7 +634,7 @@ auto DIA<ValueType, Stack>::GroupByKey(
 
     using GroupByNode = api::GroupByNode<
         ValueOut, KeyExtractor, GroupFunction, HashFunction,
-        LocationDetectionValue>;
+        LocationDetectionValue, /* UseHashGrouping */ false>;
 
     auto node = tlx::make_counting<GroupByNode>(
         *this, key_extractor, groupby_function, hash_function);
@@ -404,6 +642,61 @@ auto DIA<ValueType, Stack>::GroupByKey(
     return DIA<ValueOut>(node);
 }
 
+template <typename ValueType, typename Stack>
+template <typename ValueOut,
+          typename KeyExtractor, typename GroupFunction, typename HashFunction>
+auto DIA<ValueType, Stack>::GroupByKey(
+    const struct HashGroupingTag&,
+    const KeyExtractor& key_extractor,
+    const GroupFunction& groupby_function,
+    const HashFunction& hash_function) const {
+
+    static_assert(
+        std::is_same<
+            typename std::decay<typename common::FunctionTraits<KeyExtractor>
+                                ::template arg<0> >::type,
+            ValueType>::value,
+        "KeyExtractor has the wrong input type");
+
+    using GroupByNode = api::GroupByNode<
+        ValueOut, KeyExtractor, GroupFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseHashGrouping */ true>;
+
+    auto node = tlx::make_counting<GroupByNode>(
+        *this, key_extractor, groupby_function, hash_function);
+
+    return DIA<ValueOut>(node);
+}
+
+template <typename ValueType, typename Stack>
+template <typename ValueOut, typename KeyExtractor, typename GroupFunction,
+          typename CombineFunction, typename HashFunction>
+auto DIA<ValueType, Stack>::GroupByKey(
+    const struct GroupCombineTag&,
+    const KeyExtractor& key_extractor,
+    const GroupFunction& groupby_function,
+    const CombineFunction& combine_function,
+    const HashFunction& hash_function) const {
+
+    static_assert(
+        std::is_same<
+            typename std::decay<typename common::FunctionTraits<KeyExtractor>
+                                ::template arg<0> >::type,
+            ValueType>::value,
+        "KeyExtractor has the wrong input type");
+
+    using GroupByNode = api::GroupByNode<
+        ValueOut, KeyExtractor, GroupFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseHashGrouping */ false,
+        CombineFunction>;
+
+    auto node = tlx::make_counting<GroupByNode>(
+        *this, key_extractor, groupby_function, hash_function,
+        combine_function);
+
+    return DIA<ValueOut>(node);
+}
+
 template <typename ValueType, typename Stack>
 template <typename ValueOut, typename KeyExtractor,
           typename GroupFunction, typename HashFunction>
@@ -424,7 +717,8 @@ auto DIA<ValueType, Stack>::GroupByKey(
     // forward to other method _without_ location detection
     return GroupByKey<ValueOut>(
         NoLocationDetectionTag, key_extractor, groupby_function,
-        std::hash<typename FunctionTraits<KeyExtractor>::result_type>());
+        common::HashDefault<
+            typename FunctionTraits<KeyExtractor>::result_type>());
 }
 
 } // namespace api
@@ -214,16 +214,63 @@ private:
         }
     }
 
-    //! Sort and store elements in a file
+    /*!
+     * Sort elements by a bucket pass over the worker's dense key range and
+     * store them in a file. The key range is divided into at most v.size()
+     * buckets of equal width, which are counted and then filled with the
+     * indexes of the elements. If the range is not larger than the number of
+     * elements, each bucket holds a single key and no comparisons are needed,
+     * otherwise the few elements of each bucket are sorted.
+     */
     void FlushVectorToFile(std::vector<ValueIn>& v) {
-        // sort run and sort to file
-        std::sort(v.begin(), v.end(), ValueComparator(*this));
         totalsize_ += v.size();
 
         data::File f = context_.GetFile(this);
         data::File::Writer w = f.GetWriter();
-        for (const ValueIn& e : v) {
-            w.Put(e);
+
+        if (!v.empty()) {
+            const size_t range_size = key_range_.size();
+            const size_t width = (range_size + v.size() - 1) / v.size();
+            const size_t num_buckets = (range_size + width - 1) / width;
+
+            auto bucket = [this, width](const ValueIn& e) {
+                              size_t k = key_extractor_(e);
+                              assert(k >= key_range_.begin &&
+                                     k < key_range_.end);
+                              return (k - key_range_.begin) / width;
+                          };
+
+            // count elements per bucket, and calculate bucket begins
+            std::vector<size_t> bucket_end(num_buckets + 1, 0);
+            for (const ValueIn& e : v)
+                ++bucket_end[bucket(e) + 1];
+            for (size_t b = 1; b <= num_buckets; ++b)
+                bucket_end[b] += bucket_end[b - 1];
+
+            // scatter indexes of elements into buckets, afterwards
+            // bucket_end[b] is the end of bucket b.
+            std::vector<size_t> order(v.size());
+            for (size_t i = 0; i < v.size(); ++i)
+                order[bucket_end[bucket(v[i])]++] = i;
+
+            if (width > 1) {
+                ValueComparator value_comparator(*this);
+                size_t begin = 0;
+                for (size_t b = 0; b < num_buckets; ++b) {
+                    if (bucket_end[b] - begin > 1) {
+                        std::sort(order.begin() + begin,
+                                  order.begin() + bucket_end[b],
+                                  [&v, &value_comparator](size_t x, size_t y) {
+                                      return value_comparator(v[x], v[y]);
+                                  });
+                    }
+                    begin = bucket_end[b];
+                }
+            }
+            tlx::vector_free(bucket_end);
+
+            for (const size_t& i : order)
+                w.Put(v[i]);
         }
         w.Close();
 
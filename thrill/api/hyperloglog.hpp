@@ -15,8 +15,13 @@
 
 #include <thrill/api/action_node.hpp>
 #include <thrill/api/dia.hpp>
+#include <thrill/api/reduce_by_key.hpp>
+#include <thrill/common/function_traits.hpp>
 #include <thrill/core/hyperloglog.hpp>
 
+#include <type_traits>
+#include <utility>
+
 namespace thrill {
 namespace api {
 
@@ -71,6 +76,31 @@ double DIA<ValueType, Stack>::HyperLogLog() const {
     return registers.result();
 }
 
+template <typename ValueType, typename Stack>
+template <size_t p, typename KeyExtractor, typename ValueExtractor>
+auto DIA<ValueType, Stack>::HyperLogLogByKey(
+    const KeyExtractor& key_extractor,
+    const ValueExtractor& value_extractor) const {
+    assert(IsValid());
+
+    using Key = typename std::decay<
+        typename common::FunctionTraits<KeyExtractor>::result_type>::type;
+    using Registers = core::HyperLogLogRegisters<p>;
+    using KeyRegisters = std::pair<Key, Registers>;
+
+    // sketch each item on its own, the sketches of each key are then merged
+    // in the reduce tables, mostly already in the local pre phase.
+    auto sketches = Map(
+        [key_extractor, value_extractor](const ValueType& input) {
+            Registers registers;
+            registers.insert(value_extractor(input));
+            return KeyRegisters(key_extractor(input), std::move(registers));
+        });
+
+    return sketches.ReducePair(
+        [](const Registers& a, const Registers& b) { return a + b; });
+}
+
 } // namespace api
 } // namespace thrill
 
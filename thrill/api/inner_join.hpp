@@ -15,17 +15,28 @@
 
 #include <thrill/api/dia.hpp>
 #include <thrill/api/dop_node.hpp>
+#include <thrill/common/cpu_placement.hpp>
 #include <thrill/common/function_traits.hpp>
 #include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/porting.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/core/buffered_multiway_merge.hpp>
+#include <thrill/core/heavy_hitters.hpp>
 #include <thrill/core/location_detection.hpp>
+#include <thrill/data/cat_stream.hpp>
 #include <thrill/data/file.hpp>
 
+#include <tlx/math/div_ceil.hpp>
+#include <tlx/vector_free.hpp>
+
 #include <algorithm>
 #include <deque>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -53,12 +64,66 @@ namespace api {
  * \param key_extractor2 Key extractor for second DIA
  *
  * \param join_function Join function applied to all equal key pairs
+ *
+ * With UseBroadcast the second DIA is sent once to each host and collected into
+ * one read-only hash table, which all local workers of the host share, while
+ * the items of the first DIA stay on their worker. This avoids shuffling the
+ * first DIA, but requires the complete second DIA to fit into the memory of
+ * each host.
+ *
+ * With UseSemiJoinFilter both DIAs are first stored locally, then a distributed
+ * Bloom filter of the key hashes of the globally smaller DIA is built, and
+ * items of the larger DIA which cannot have a join partner are dropped before
+ * they are sent.
+ *
+ * With UseSortedInputs the DIAs are expected to be sorted by key, e.g. as
+ * output of Sort(). This is verified while storing them locally. If the key
+ * ranges of the first DIA on all workers are in order, it is not moved at all,
+ * the second DIA is sent to the workers whose key range of the first DIA
+ * overlaps its keys, and both are joined by merging without forming sorted
+ * runs. Otherwise, the DIAs are hash-partitioned as usual.
+ *
+ * With UseSkewHandling both DIAs are first stored locally while a Misra-Gries
+ * summary of their key hashes is built. Hashes occurring much more often than
+ * the average load of a worker are considered hot: the items of a hot hash of
+ * the DIA with more of them are spread over all workers, and the items of the
+ * other DIA are replicated to all workers.
+ *
+ * After the items have been received, a DIA whose items fit into memory
+ * without being sorted is used as build side of a local hash join, which is
+ * probed by the items of the other DIA. Otherwise, both DIAs are sorted and
+ * joined by merging.
+ */
+//! Non-template base of JoinNode holding the selected local join algorithm.
+class JoinNodeBase
+{
+public:
+    //! build side of the local hash join: 1 or 2, or 0 for the merge join
+    const size_t& hash_build_side() const { return hash_build_side_; }
+
+protected:
+    size_t hash_build_side_ = 0;
+};
+
+/*!
+ * Returns the local hash join build side of the local worker (1 or 2, or 0 for
+ * the merge join) if the DIA was created by an InnerJoin() operation, otherwise
+ * nullptr.
  */
+template <typename DIAType>
+const size_t * GetJoinHashBuildSide(const DIAType& dia) {
+    const JoinNodeBase* node =
+        dynamic_cast<const JoinNodeBase*>(dia.node().get());
+    return node ? &node->hash_build_side() : nullptr;
+}
+
 template <typename ValueType, typename FirstDIA, typename SecondDIA,
           typename KeyExtractor1, typename KeyExtractor2,
           typename JoinFunction, typename HashFunction,
-          bool UseLocationDetection>
-class JoinNode final : public DOpNode<ValueType>
+          bool UseLocationDetection, bool UseBroadcast = false,
+          bool UseSemiJoinFilter = false, bool UseSkewHandling = false,
+          bool UseSortedInputs = false>
+class JoinNode final : public DOpNode<ValueType>, public JoinNodeBase
 {
 private:
     static constexpr bool debug = false;
@@ -72,6 +137,32 @@ private:
     //! Key type of join. must be equal to the other key extractor
     using Key = typename common::FunctionTraits<KeyExtractor1>::result_type;
 
+    static_assert(UseLocationDetection + UseBroadcast + UseSemiJoinFilter +
+                  UseSkewHandling + UseSortedInputs <= 1,
+                  "Location detection, broadcast join, semi-join filter, skew "
+                  "handling, and sorted inputs are mutually exclusive");
+
+    //! bits per item in the semi-join Bloom filter
+    static constexpr size_t semi_join_filter_bits_ = 8;
+
+    //! number of hash functions of the semi-join Bloom filter
+    static constexpr size_t semi_join_filter_hashes_ = 3;
+
+    //! a hash is hot if its items exceed this fraction of the average number
+    //! of items per worker
+    static constexpr double skew_hot_fraction_ = 0.5;
+
+    //! join the cartesian products of large equal-key groups in parallel using
+    //! cores borrowed from idle local workers.
+    static constexpr bool use_parallel_join_ = true;
+
+    //! minimum number of pairs per part of a parallel cartesian product
+    static constexpr size_t parallel_join_min_pairs_ = 1024 * 1024;
+
+    //! number of parts per thread of a parallel cartesian product, such that
+    //! parts can be stolen from threads which are slower.
+    static constexpr size_t parallel_join_parts_per_thread_ = 2;
+
     //! hash counter used by LocationDetection
     class HashCount
     {
@@ -186,6 +277,25 @@ public:
             }
         }
 
+        if (UseSemiJoinFilter)
+            FilterAndSendItems();
+
+        if (UseSkewHandling)
+            SkewSendItems();
+
+        if (UseSortedInputs) {
+            if (ExecuteSorted()) {
+                hash_writers1_.Close();
+                hash_writers2_.Close();
+                return;
+            }
+            // fall back to hash partitioning of both DIAs
+            SendItems<InputTypeFirst>(
+                pre_file1_, hash_writers1_, key_extractor1_, nullptr);
+            SendItems<InputTypeSecond>(
+                pre_file2_, hash_writers2_, key_extractor2_, nullptr);
+        }
+
         hash_writers1_.Close();
         hash_writers2_.Close();
 
@@ -212,6 +322,16 @@ public:
 
     void PushData(bool consume) final {
 
+        if (UseBroadcast) {
+            PushDataBroadcast(consume);
+            return;
+        }
+
+        if (hash_build_side_ != 0) {
+            PushDataHash(consume);
+            return;
+        }
+
         auto compare_function_1 =
             [this](const InputTypeFirst& in1, const InputTypeFirst& in2) {
                 return key_extractor1_(in1) < key_extractor1_(in2);
@@ -289,6 +409,12 @@ public:
     void Dispose() final {
         files1_.clear();
         files2_.clear();
+        pre_file1_.Clear();
+        broadcast_table_.reset();
+        hash_heads_.clear();
+        tlx::vector_free(hash_next_);
+        tlx::vector_free(mem_items1_);
+        tlx::vector_free(mem_items2_);
     }
 
 private:
@@ -317,7 +443,71 @@ private:
     core::LocationDetection<HashCount> location_detection_ { context_, Super::dia_id() };
     bool location_detection_initialized_ = false;
 
+    //! hash table of all items of the second DIA in broadcast mode
+    using BroadcastTable =
+        std::unordered_map<Key, std::vector<InputTypeSecond>, HashFunction>;
+
+    //! broadcast hash table shared by all local workers of the host
+    std::shared_ptr<const BroadcastTable> broadcast_table_;
+
+    //! received items kept in memory, if they did not need to be sorted
+    std::vector<InputTypeFirst> mem_items1_;
+    std::vector<InputTypeSecond> mem_items2_;
+
+    //! hash table index of the build side: first item of each key, and the
+    //! chain of further items with equal key
+    std::unordered_map<Key, size_t, HashFunction> hash_heads_ {
+        0, hash_function_
+    };
+    std::vector<size_t> hash_next_;
+
+    //! index terminating a chain of hash_next_
+    static constexpr size_t hash_end_ = size_t(-1);
+
+    //! summaries of frequent key hashes of both DIAs in skew handling mode
+    core::HeavyHitters heavy_hitters1_;
+    core::HeavyHitters heavy_hitters2_;
+
+    //! local key range and order of a DIA in sorted inputs mode
+    struct KeyRange {
+        bool sorted = true;
+        bool non_empty = false;
+        Key min, max;
+
+        void Insert(const Key& key) {
+            if (!non_empty) {
+                min = max = key;
+                non_empty = true;
+            }
+            else if (key < max) {
+                sorted = false;
+            }
+            else {
+                max = key;
+            }
+        }
+    };
+
+    KeyRange key_range1_;
+    KeyRange key_range2_;
+
     void PreOp1(const InputTypeFirst& input) {
+        if (UseSortedInputs) {
+            pre_writer1_.Put(input);
+            key_range1_.Insert(key_extractor1_(input));
+            return;
+        }
+        if (UseSkewHandling) {
+            pre_writer1_.Put(input);
+            heavy_hitters1_.Insert(hash_function_(key_extractor1_(input)));
+            return;
+        }
+        if (UseBroadcast || UseSemiJoinFilter) {
+            // broadcast: first DIA is joined locally against second DIA,
+            // semi-join filter: items are sent after the filter is built
+            pre_writer1_.Put(input);
+            return;
+        }
         size_t hash = hash_function_(key_extractor1_(input));
         if (UseLocationDetection) {
             pre_writer1_.Put(input);
@@ -329,6 +519,28 @@ private:
     }
 
     void PreOp2(const InputTypeSecond& input) {
+        if (UseSortedInputs) {
+            pre_writer2_.Put(input);
+            key_range2_.Insert(key_extractor2_(input));
+            return;
+        }
+        if (UseBroadcast) {
+            // send once to each host, to the worker with our local id
+            for (size_t h = 0; h < context_.num_hosts(); ++h) {
+                hash_writers2_[h * context_.workers_per_host() +
+                               context_.local_worker_id()].Put(input);
+            }
+            return;
+        }
+        if (UseSemiJoinFilter) {
+            pre_writer2_.Put(input);
+            return;
+        }
+        if (UseSkewHandling) {
+            pre_writer2_.Put(input);
+            heavy_hitters2_.Insert(hash_function_(key_extractor2_(input)));
+            return;
+        }
         size_t hash = hash_function_(key_extractor2_(input));
         if (UseLocationDetection) {
             pre_writer2_.Put(input);
@@ -339,21 +551,516 @@ private:
         }
     }
 
+    /*!
+     * Builds a distributed Bloom filter of the key hashes of the globally
+     * smaller DIA, and sends all items of the smaller DIA and those items of the
+     * larger DIA which pass the filter.
+     */
+    void FilterAndSendItems() {
+        using VectorSizeT = std::vector<size_t>;
+
+        VectorSizeT sizes = context_.net.AllReduce(
+            VectorSizeT { pre_file1_.num_items(), pre_file2_.num_items() },
+            common::ComponentSum<VectorSizeT>());
+
+        // filter the first DIA with the keys of the second, or vice versa
+        bool filter_first = (sizes[1] <= sizes[0]);
+
+        // size the filter for the smaller side, limited by the memory budget
+        size_t num_bits = std::min(
+            semi_join_filter_bits_ * std::min(sizes[0], sizes[1]),
+            8 * DIABase::mem_limit_ / 4);
+        size_t num_words = std::max<size_t>(1, (num_bits + 63) / 64);
+        num_bits = 64 * num_words;
+
+        std::vector<uint64_t> filter(num_words, 0);
+        if (filter_first) {
+            auto reader = pre_file2_.GetKeepReader();
+            while (reader.HasNext()) {
+                InsertFilter(filter, hash_function_(
+                                 key_extractor2_(
+                                     reader.template Next<InputTypeSecond>())));
+            }
+        }
+        else {
+            auto reader = pre_file1_.GetKeepReader();
+            while (reader.HasNext()) {
+                InsertFilter(filter, hash_function_(
+                                 key_extractor1_(
+                                     reader.template Next<InputTypeFirst>())));
+            }
+        }
+
+        filter = context_.net.AllReduce(
+            filter, common::ComponentSum<std::vector<uint64_t>,
+                                         std::bit_or<uint64_t> >());
+
+        size_t dropped =
+            SendItems<InputTypeFirst>(
+                pre_file1_, hash_writers1_, key_extractor1_,
+                filter_first ? &filter : nullptr) +
+            SendItems<InputTypeSecond>(
+                pre_file2_, hash_writers2_, key_extractor2_,
+                filter_first ? nullptr : &filter);
+
+        Super::logger_
+            << "class" << "JoinNode"
+            << "event" << "semi_join_filter"
+            << "filter_first" << filter_first
+            << "filter_bits" << num_bits
+            << "dropped" << dropped;
+    }
+
+    //! Set the bits of a hash in the semi-join Bloom filter
+    void InsertFilter(std::vector<uint64_t>& filter, size_t hash) {
+        size_t num_bits = 64 * filter.size();
+        for (size_t i = 0; i < semi_join_filter_hashes_; ++i) {
+            size_t bit = common::Hash128to64(hash, i) % num_bits;
+            filter[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+
+    //! Check if all bits of a hash are set in the semi-join Bloom filter
+    bool ContainsFilter(const std::vector<uint64_t>& filter, size_t hash) {
+        size_t num_bits = 64 * filter.size();
+        for (size_t i = 0; i < semi_join_filter_hashes_; ++i) {
+            size_t bit = common::Hash128to64(hash, i) % num_bits;
+            if (!(filter[bit / 64] & (uint64_t(1) << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
+    /*!
+     * Sends all items of a pre file to their hash target worker, dropping
+     * items not contained in the filter, if one is given. Returns the number of
+     * dropped items.
+     */
+    template <typename ItemType, typename KeyExtractor>
+    size_t SendItems(data::File& file, data::MixStream::Writers& writers,
+                     const KeyExtractor& key_extractor,
+                     const std::vector<uint64_t>* filter) {
+        size_t dropped = 0;
+        auto reader = file.GetConsumeReader();
+        while (reader.HasNext()) {
+            ItemType item = reader.template Next<ItemType>();
+            size_t hash = hash_function_(key_extractor(item));
+            if (filter && !ContainsFilter(*filter, hash)) {
+                ++dropped;
+                continue;
+            }
+            writers[hash % context_.num_workers()].Put(item);
+        }
+        return dropped;
+    }
+
+    /*!
+     * Detects hot hashes from the global heavy hitter summaries and sends all
+     * items, spreading or replicating those with hot hashes.
+     */
+    void SkewSendItems() {
+        using VectorSizeT = std::vector<size_t>;
+        using HashCount = core::HeavyHitters::HashCount;
+
+        size_t num_workers = context_.num_workers();
+
+        VectorSizeT sizes = context_.net.AllReduce(
+            VectorSizeT { heavy_hitters1_.num_items(),
+                          heavy_hitters2_.num_items() },
+            common::ComponentSum<VectorSizeT>());
+
+        std::vector<HashCount> summary1 = context_.net.AllReduce(
+            heavy_hitters1_.Summary(), core::HeavyHitters::MergeOp());
+        std::vector<HashCount> summary2 = context_.net.AllReduce(
+            heavy_hitters2_.Summary(), core::HeavyHitters::MergeOp());
+        heavy_hitters1_.Clear();
+        heavy_hitters2_.Clear();
+
+        // map of hot hashes to whether the items of the first DIA are spread
+        std::unordered_map<size_t, bool> hot_hashes;
+        VectorSizeT hot_list, hot_counts;
+
+        double hot_limit =
+            skew_hot_fraction_ * (sizes[0] + sizes[1]) / num_workers;
+
+        auto i1 = summary1.begin(), i2 = summary2.begin();
+        while (num_workers > 1 &&
+               (i1 != summary1.end() || i2 != summary2.end())) {
+            // merge both sorted summaries by hash
+            size_t hash, count1 = 0, count2 = 0;
+            if (i2 == summary2.end() ||
+                (i1 != summary1.end() && i1->first < i2->first)) {
+                hash = i1->first;
+                count1 = i1->second;
+                ++i1;
+            }
+            else if (i1 == summary1.end() || i2->first < i1->first) {
+                hash = i2->first;
+                count2 = i2->second;
+                ++i2;
+            }
+            else {
+                hash = i1->first;
+                count1 = i1->second;
+                count2 = i2->second;
+                ++i1, ++i2;
+            }
+            if (count1 + count2 > hot_limit) {
+                hot_hashes.emplace(hash, count1 >= count2);
+                hot_list.push_back(hash);
+                hot_counts.push_back(count1 + count2);
+            }
+        }
+
+        if (context_.my_rank() == 0) {
+            Super::logger_
+                << "class" << "JoinNode"
+                << "event" << "heavy_hitters"
+                << "hot_hashes" << hot_list
+                << "hot_counts" << hot_counts;
+        }
+
+        SkewSendFile<InputTypeFirst>(
+            pre_file1_, hash_writers1_, key_extractor1_, hot_hashes, true);
+        SkewSendFile<InputTypeSecond>(
+            pre_file2_, hash_writers2_, key_extractor2_, hot_hashes, false);
+    }
+
+    /*!
+     * Sends all items of a pre file: items of non-hot hashes to their hash
+     * target worker, items of hot hashes either round-robin to all workers or
+     * replicated to all workers.
+     */
+    template <typename ItemType, typename KeyExtractor>
+    void SkewSendFile(data::File& file, data::MixStream::Writers& writers,
+                      const KeyExtractor& key_extractor,
+                      const std::unordered_map<size_t, bool>& hot_hashes,
+                      bool is_first) {
+        size_t num_workers = context_.num_workers();
+        size_t next_worker = context_.my_rank();
+
+        auto reader = file.GetConsumeReader();
+        while (reader.HasNext()) {
+            ItemType item = reader.template Next<ItemType>();
+            size_t hash = hash_function_(key_extractor(item));
+
+            auto it = hot_hashes.find(hash);
+            if (it == hot_hashes.end()) {
+                writers[hash % num_workers].Put(item);
+            }
+            else if (it->second == is_first) {
+                // spread items of the larger side of a hot hash
+                writers[next_worker].Put(item);
+                if (++next_worker == num_workers) next_worker = 0;
+            }
+            else {
+                // replicate items of the smaller side of a hot hash
+                for (size_t w = 0; w < num_workers; ++w)
+                    writers[w].Put(item);
+            }
+        }
+    }
+
+    /*!
+     * Exchanges the local key ranges of both DIAs and checks whether they are
+     * globally sorted. If so, keeps the first DIA in place, sends the items of
+     * the second DIA to all workers whose key range of the first DIA contains
+     * their key, and stores both as single sorted files for the merge join.
+     * Returns false if the DIAs are not sorted.
+     */
+    bool ExecuteSorted() {
+        size_t num_workers = context_.num_workers();
+
+        data::CatStreamPtr range_stream = context_.GetNewCatStream(this);
+        {
+            data::CatStream::Writers writers = range_stream->GetWriters();
+            uint8_t mask =
+                (key_range1_.non_empty ? 1 : 0) |
+                (key_range2_.non_empty ? 2 : 0) |
+                (key_range1_.sorted && key_range2_.sorted ? 4 : 0);
+            for (size_t w = 0; w < num_workers; ++w) {
+                writers[w].Put(mask);
+                if (key_range1_.non_empty) {
+                    writers[w].Put(key_range1_.min);
+                    writers[w].Put(key_range1_.max);
+                }
+                if (key_range2_.non_empty) {
+                    writers[w].Put(key_range2_.min);
+                    writers[w].Put(key_range2_.max);
+                }
+            }
+            writers.Close();
+        }
+
+        // key ranges of the first DIA and the workers holding them
+        std::vector<std::pair<Key, Key> > ranges1;
+        std::vector<size_t> workers1;
+        bool sorted = true;
+        bool have_max2 = false;
+        Key max2;
+
+        std::vector<data::CatStream::Reader> readers =
+            range_stream->GetReaders();
+        for (size_t w = 0; w < num_workers; ++w) {
+            uint8_t mask = readers[w].template Next<uint8_t>();
+            if (!(mask & 4)) sorted = false;
+            if (mask & 1) {
+                Key min = readers[w].template Next<Key>();
+                Key max = readers[w].template Next<Key>();
+                if (!ranges1.empty() && min < ranges1.back().second)
+                    sorted = false;
+                ranges1.emplace_back(min, max);
+                workers1.push_back(w);
+            }
+            if (mask & 2) {
+                Key min = readers[w].template Next<Key>();
+                Key max = readers[w].template Next<Key>();
+                if (have_max2 && min < max2)
+                    sorted = false;
+                max2 = max;
+                have_max2 = true;
+            }
+        }
+        readers.clear();
+
+        Super::logger_
+            << "class" << "JoinNode"
+            << "event" << "sorted_inputs"
+            << "sorted" << sorted;
+
+        if (!sorted) return false;
+
+        // send items of the second DIA to all overlapping ranges of the first
+        data::CatStreamPtr stream2 = context_.GetNewCatStream(this);
+        {
+            data::CatStream::Writers writers = stream2->GetWriters();
+            size_t lo = 0;
+            auto reader = pre_file2_.GetConsumeReader();
+            while (reader.HasNext()) {
+                InputTypeSecond in2 = reader.template Next<InputTypeSecond>();
+                Key key = key_extractor2_(in2);
+                while (lo < ranges1.size() && ranges1[lo].second < key)
+                    ++lo;
+                for (size_t i = lo;
+                     i < ranges1.size() && !(key < ranges1[i].first); ++i) {
+                    writers[workers1[i]].Put(in2);
+                }
+            }
+            writers.Close();
+        }
+
+        // items arrive in order of the workers, hence they are sorted
+        data::File file2 = context_.GetFile(this);
+        {
+            data::File::Writer writer = file2.GetWriter();
+            auto reader = stream2->GetCatReader(/* consume */ true);
+            while (reader.HasNext())
+                writer.Put(reader.template Next<InputTypeSecond>());
+            writer.Close();
+        }
+
+        if (pre_file1_.num_items()) {
+            files1_.emplace_back(std::move(pre_file1_));
+            pre_file1_ = context_.GetFile(this);
+        }
+        if (file2.num_items())
+            files2_.emplace_back(std::move(file2));
+
+        return true;
+    }
+
     //! Receive elements from other workers, create pre-sorted files
     void MainOp() {
+        if (UseBroadcast) {
+            MainOpBroadcast();
+            return;
+        }
+
         data::MixStream::MixReader reader1_ =
             hash_stream1_->GetMixReader(/* consume */ true);
 
         size_t capacity = DIABase::mem_limit_ / sizeof(InputTypeFirst) / 2;
 
-        ReceiveItems<InputTypeFirst>(capacity, reader1_, files1_, key_extractor1_);
+        ReceiveItems<InputTypeFirst>(
+            capacity, reader1_, files1_, mem_items1_, key_extractor1_);
 
         data::MixStream::MixReader reader2_ =
             hash_stream2_->GetMixReader(/* consume */ true);
 
         capacity = DIABase::mem_limit_ / sizeof(InputTypeSecond) / 2;
 
-        ReceiveItems<InputTypeSecond>(capacity, reader2_, files2_, key_extractor2_);
+        ReceiveItems<InputTypeSecond>(
+            capacity, reader2_, files2_, mem_items2_, key_extractor2_);
+
+        SelectLocalJoin();
+    }
+
+    /*!
+     * Selects the local join algorithm from the received sizes: if the items
+     * of a DIA were kept in memory and its hash table fits into the memory
+     * budget, it becomes the build side of a hash join. Otherwise the
+     * in-memory items are written as sorted runs for the merge join.
+     */
+    void SelectLocalJoin() {
+        bool fits1 = files1_.empty() &&
+                     HashBuildFits<InputTypeFirst>(mem_items1_.size());
+        bool fits2 = files2_.empty() &&
+                     HashBuildFits<InputTypeSecond>(mem_items2_.size());
+
+        if (fits2 && (!fits1 || mem_items2_.size() <= mem_items1_.size())) {
+            hash_build_side_ = 2;
+            BuildHashTable(mem_items2_, key_extractor2_);
+        }
+        else if (fits1) {
+            hash_build_side_ = 1;
+            BuildHashTable(mem_items1_, key_extractor1_);
+        }
+        else {
+            hash_build_side_ = 0;
+            if (!mem_items1_.empty())
+                SortAndWriteToFile(mem_items1_, files1_, key_extractor1_);
+            if (!mem_items2_.empty())
+                SortAndWriteToFile(mem_items2_, files2_, key_extractor2_);
+        }
+
+        sLOG << "JoinNode::SelectLocalJoin()"
+             << "hash_build_side_" << hash_build_side_
+             << "mem_items1_" << mem_items1_.size()
+             << "mem_items2_" << mem_items2_.size();
+    }
+
+    //! Check if the hash table index of the build side fits into memory
+    template <typename ItemType>
+    bool HashBuildFits(size_t num_items) {
+        // items, chain index, and a hash node of key, head, and pointers
+        size_t item_bytes = sizeof(ItemType) + sizeof(size_t) +
+                            sizeof(Key) + sizeof(size_t) + 2 * sizeof(void*);
+        return num_items * item_bytes <= DIABase::mem_limit_ / 2;
+    }
+
+    //! Build chained hash table index on the items of the build side
+    template <typename ItemType, typename KeyExtractor>
+    void BuildHashTable(const std::vector<ItemType>& items,
+                        const KeyExtractor& key_extractor) {
+        hash_heads_.reserve(items.size());
+        hash_next_.resize(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            auto it = hash_heads_.emplace(key_extractor(items[i]), i);
+            if (it.second) {
+                hash_next_[i] = hash_end_;
+            }
+            else {
+                // prepend item to chain of its key
+                hash_next_[i] = it.first->second;
+                it.first->second = i;
+            }
+        }
+    }
+
+    //! Probe the build side hash table with all items of the other side
+    void PushDataHash(bool consume) {
+        if (hash_build_side_ == 2) {
+            auto probe = [this](const InputTypeFirst& in1) {
+                             auto it = hash_heads_.find(key_extractor1_(in1));
+                             if (it == hash_heads_.end()) return;
+                             for (size_t i = it->second; i != hash_end_;
+                                  i = hash_next_[i]) {
+                                 this->PushItem(join_function_(in1, mem_items2_[i]));
+                             }
+                         };
+            if (!mem_items2_.empty()) {
+                for (const InputTypeFirst& in1 : mem_items1_) probe(in1);
+                for (data::File& file : files1_) {
+                    auto reader = file.GetReader(consume);
+                    while (reader.HasNext())
+                        probe(reader.template Next<InputTypeFirst>());
+                }
+            }
+        }
+        else {
+            auto probe = [this](const InputTypeSecond& in2) {
+                             auto it = hash_heads_.find(key_extractor2_(in2));
+                             if (it == hash_heads_.end()) return;
+                             for (size_t i = it->second; i != hash_end_;
+                                  i = hash_next_[i]) {
+                                 this->PushItem(join_function_(mem_items1_[i], in2));
+                             }
+                         };
+            if (!mem_items1_.empty()) {
+                for (const InputTypeSecond& in2 : mem_items2_) probe(in2);
+                for (data::File& file : files2_) {
+                    auto reader = file.GetReader(consume);
+                    while (reader.HasNext())
+                        probe(reader.template Next<InputTypeSecond>());
+                }
+            }
+        }
+
+        if (consume) {
+            hash_heads_.clear();
+            tlx::vector_free(hash_next_);
+            tlx::vector_free(mem_items1_);
+            tlx::vector_free(mem_items2_);
+            files1_.clear();
+            files2_.clear();
+        }
+    }
+
+    /*!
+     * Receive the part of the second DIA sent to this worker, and combine the
+     * parts of all local workers into the broadcast hash table of the host.
+     */
+    void MainOpBroadcast() {
+        data::MixStream::MixReader reader2 =
+            hash_stream2_->GetMixReader(/* consume */ true);
+
+        std::vector<InputTypeSecond> items2;
+        while (reader2.HasNext())
+            items2.emplace_back(reader2.template Next<InputTypeSecond>());
+
+        size_t count = items2.size();
+
+        broadcast_table_ =
+            context_.net.template LocalCombineShared<BroadcastTable>(
+                items2,
+                [this](const std::vector<std::vector<InputTypeSecond>*>&
+                       parts) {
+                    BroadcastTable table(0, hash_function_);
+                    for (std::vector<InputTypeSecond>* part : parts) {
+                        for (InputTypeSecond& in2 : *part) {
+                            Key key = key_extractor2_(in2);
+                            table[key].emplace_back(std::move(in2));
+                        }
+                        tlx::vector_free(*part);
+                    }
+                    return table;
+                });
+
+        if (count > 0 && mem::memory_exceeded) {
+            LOG1 << "Thrill: Warning: Broadcast side of InnerJoin exceeds "
+                 << "main memory, use the regular join instead.";
+        }
+
+        Super::logger_
+            << "class" << "JoinNode"
+            << "event" << "broadcast"
+            << "items" << count
+            << "keys" << broadcast_table_->size();
+    }
+
+    //! Stream the local items of the first DIA against the hash table
+    void PushDataBroadcast(bool consume) {
+        if (!broadcast_table_ || broadcast_table_->empty())
+            return;
+
+        data::File::Reader reader = pre_file1_.GetReader(consume);
+        while (reader.HasNext()) {
+            InputTypeFirst in1 = reader.template Next<InputTypeFirst>();
+            auto it = broadcast_table_->find(key_extractor1_(in1));
+            if (it == broadcast_table_->end()) continue;
+            for (const InputTypeSecond& in2 : it->second)
+                this->PushItem(join_function_(in1, in2));
+        }
     }
 
     template <typename ItemType>
@@ -397,9 +1104,7 @@ private:
             else {
                 file_ptr = context_.GetFilePtr(this);
                 data::File::Writer writer = file_ptr->GetWriter();
-                for (const ItemType& item : vec) {
-                    writer.Put(item);
-                }
+                writer.PutBatch(vec.data(), vec.size());
                 writer.Put(puller.Top());
                 //! vec is very large when this happens
                 //! swap with empty vector to free the memory
@@ -490,11 +1195,13 @@ private:
 
     /*!
      * Recieve all elements from a stream and write them to files sorted by key.
+     * If all elements fit into memory, they are kept unsorted in mem_items.
      */
     template <typename ItemType, typename KeyExtractor>
     void ReceiveItems(
         size_t capacity, data::MixStream::MixReader& reader,
-        std::deque<data::File>& files, const KeyExtractor& key_extractor) {
+        std::deque<data::File>& files, std::vector<ItemType>& mem_items,
+        const KeyExtractor& key_extractor) {
 
         std::vector<ItemType> vec;
         vec.reserve(capacity);
@@ -508,8 +1215,13 @@ private:
             }
         }
 
-        if (vec.size())
+        if (files.empty()) {
+            vec.shrink_to_fit();
+            mem_items.swap(vec);
+        }
+        else if (vec.size()) {
             SortAndWriteToFile(vec, files, key_extractor);
+        }
     }
 
     /*!
@@ -571,103 +1283,209 @@ private:
         const std::vector<InputTypeSecond>& vec2, bool external2) {
 
         if (!external1 && !external2) {
-            for (const InputTypeFirst& join1 : vec1) {
-                for (const InputTypeSecond& join2 : vec2) {
-                    assert(key_extractor1_(join1) == key_extractor2_(join2));
-                    this->PushItem(join_function_(join1, join2));
-                }
-            }
+            JoinProduct(vec1, vec2);
         }
         else if (external1 && !external2) {
             LOG1 << "Thrill: Warning: Too many equal keys for main memory "
                  << "in first DIA";
 
+            std::vector<InputTypeFirst> chunk1;
             data::File::ConsumeReader reader = join_file1_->GetConsumeReader();
-
-            while (reader.HasNext()) {
-                InputTypeFirst join1 = reader.template Next<InputTypeFirst>();
-                for (auto const& join2 : vec2) {
-                    assert(key_extractor1_(join1) == key_extractor2_(join2));
-                    this->PushItem(join_function_(join1, join2));
-                }
-            }
+            while (ReadChunk(reader, chunk1, JoinCapacity<InputTypeFirst>()))
+                JoinProduct(chunk1, vec2);
         }
         else if (!external1 && external2) {
             LOG1 << "Thrill: Warning: Too many equal keys for main memory "
                  << "in second DIA";
 
+            std::vector<InputTypeSecond> chunk2;
             data::File::ConsumeReader reader = join_file2_->GetConsumeReader();
-
-            while (reader.HasNext()) {
-                InputTypeSecond join2 = reader.template Next<InputTypeSecond>();
-                for (const InputTypeFirst& join1 : vec1) {
-                    assert(key_extractor1_(join1) == key_extractor2_(join2));
-                    this->PushItem(join_function_(join1, join2));
-                }
-            }
+            while (ReadChunk(reader, chunk2, JoinCapacity<InputTypeSecond>()))
+                JoinProduct(vec1, chunk2);
         }
         else if (external1 && external2) {
             LOG1 << "Thrill: Warning: Too many equal keys for main memory "
                  << "in both DIAs. This is very slow.";
 
-            size_t capacity = JoinCapacity<InputTypeFirst>();
-
-            std::vector<InputTypeFirst> temp_vec;
-            temp_vec.reserve(capacity);
-
-            //! file 2 needs to be read multiple times
-            data::File::ConsumeReader reader1 = join_file1_->GetConsumeReader();
-
-            while (reader1.HasNext()) {
-
-                for (size_t i = 0; i < capacity && reader1.HasNext() &&
-                     !mem::memory_exceeded; ++i) {
-                    temp_vec.push_back(reader1.template Next<InputTypeFirst>());
+            // block nested loop join: the outer File is read once in chunks of
+            // half the memory, and the inner File in chunks of a quarter once
+            // per outer chunk. The outer side is the one whose re-reads of the
+            // other side cost less I/O.
+            size_t outer_cap1 = 2 * JoinCapacity<InputTypeFirst>();
+            size_t outer_cap2 = 2 * JoinCapacity<InputTypeSecond>();
+            size_t passes1 = tlx::div_ceil(
+                join_file1_->num_items(), std::max<size_t>(outer_cap1, 1));
+            size_t passes2 = tlx::div_ceil(
+                join_file2_->num_items(), std::max<size_t>(outer_cap2, 1));
+
+            std::vector<InputTypeFirst> chunk1;
+            std::vector<InputTypeSecond> chunk2;
+
+            if (passes1 * join_file2_->size_bytes() <=
+                passes2 * join_file1_->size_bytes()) {
+                data::File::ConsumeReader reader1 =
+                    join_file1_->GetConsumeReader();
+                while (ReadChunk(reader1, chunk1, outer_cap1)) {
+                    data::File::KeepReader reader2 =
+                        join_file2_->GetKeepReader();
+                    while (ReadChunk(
+                               reader2, chunk2,
+                               JoinCapacity<InputTypeSecond>()))
+                        JoinProduct(chunk1, chunk2);
                 }
-
-                data::File::Reader reader2 = join_file2_->GetReader(/* consume */ false);
-
-                while (reader2.HasNext()) {
-                    InputTypeSecond join2 = reader2.template Next<InputTypeSecond>();
-                    for (const InputTypeFirst& join1 : temp_vec) {
-                        assert(key_extractor1_(join1) == key_extractor2_(join2));
-                        this->PushItem(join_function_(join1, join2));
-                    }
+            }
+            else {
+                data::File::ConsumeReader reader2 =
+                    join_file2_->GetConsumeReader();
+                while (ReadChunk(reader2, chunk2, outer_cap2)) {
+                    data::File::KeepReader reader1 =
+                        join_file1_->GetKeepReader();
+                    while (ReadChunk(
+                               reader1, chunk1,
+                               JoinCapacity<InputTypeFirst>()))
+                        JoinProduct(chunk1, chunk2);
                 }
-                temp_vec.clear();
             }
 
-            //! non-consuming reader, need to clear now
+            //! the inner File was read with a non-consuming reader
+            join_file1_->Clear();
             join_file2_->Clear();
         }
     }
 
     /*!
-     * Sorts all elements in a vector and writes them to a file.
+     * Read the next chunk of up to capacity items into vec, but at least one,
+     * such that the join progresses even if memory is exceeded. Returns false
+     * if the reader is exhausted.
      */
-    template <typename ItemType, typename KeyExtractor>
-    void SortAndWriteToFile(
-        std::vector<ItemType>& vec, std::deque<data::File>& files,
-        const KeyExtractor& key_extractor) {
-
-        // advise block pool to write out data if necessary
-        context_.block_pool().AdviseFree(vec.size() * sizeof(ValueType));
-
-        std::sort(vec.begin(), vec.end(),
-                  [&key_extractor](const ItemType& i1, const ItemType& i2) {
-                      return key_extractor(i1) < key_extractor(i2);
-                  });
-
-        files.emplace_back(context_.GetFile(this));
-        auto writer = files.back().GetWriter();
-        for (const ItemType& elem : vec) {
-            writer.Put(elem);
-        }
-        writer.Close();
-
+    template <typename ItemType, typename Reader>
+    bool ReadChunk(Reader& reader, std::vector<ItemType>& vec,
+                   size_t capacity) {
         vec.clear();
+        while (reader.HasNext() &&
+               (vec.empty() ||
+                (vec.size() < capacity && !mem::memory_exceeded))) {
+            vec.push_back(reader.template Next<ItemType>());
+        }
+        return !vec.empty();
     }
-};
+
+    /*!
+     * Joins all pairs of items of vec1 and vec2, which have equal keys. Large
+     * products are split into ranges of vec1, which are joined as tasks of the
+     * host's work stealing pool on cores borrowed from idle local workers, and
+     * written to a File per range, which are then pushed in order.
+     */
+    void JoinProduct(const std::vector<InputTypeFirst>& vec1,
+                     const std::vector<InputTypeSecond>& vec2) {
+
+        size_t pairs = vec1.size() * vec2.size();
+        if (!use_parallel_join_ || vec1.size() < 2 ||
+            pairs < 2 * parallel_join_min_pairs_) {
+            for (const InputTypeFirst& join1 : vec1) {
+                for (const InputTypeSecond& join2 : vec2) {
+                    assert(key_extractor1_(join1) == key_extractor2_(join2));
+                    this->PushItem(join_function_(join1, join2));
+                }
+            }
+            return;
+        }
+
+        size_t local_worker_id = context_.local_worker_id();
+        std::vector<data::File> outputs;
+        {
+            common::WorkerShare::BusyScope busy_scope(
+                context_.worker_share(), local_worker_id);
+
+            std::vector<size_t> cores = context_.worker_share().Borrow(
+                std::min(pairs / parallel_join_min_pairs_, vec1.size()) - 1);
+
+            if (cores.empty()) {
+                for (const InputTypeFirst& join1 : vec1) {
+                    for (const InputTypeSecond& join2 : vec2)
+                        this->PushItem(join_function_(join1, join2));
+                }
+                return;
+            }
+
+            size_t num_parts = std::min(
+                vec1.size(), parallel_join_parts_per_thread_
+                * (cores.size() + 1));
+
+            outputs.reserve(num_parts);
+            for (size_t p = 0; p < num_parts; ++p)
+                outputs.emplace_back(context_.GetFile(this));
+
+            common::WorkStealingPool& pool = context_.work_pool();
+            common::WorkStealingPool::TaskGroup group;
+
+            for (size_t p = 0; p < num_parts; ++p) {
+                pool.Submit(
+                    local_worker_id, group,
+                    [this, &vec1, &vec2, &outputs, p, num_parts]() {
+                        size_t begin = vec1.size() * p / num_parts;
+                        size_t end = vec1.size() * (p + 1) / num_parts;
+                        data::File::Writer writer = outputs[p].GetWriter();
+                        for (size_t i = begin; i < end; ++i) {
+                            for (const InputTypeSecond& join2 : vec2)
+                                writer.Put(join_function_(vec1[i], join2));
+                        }
+                        writer.Close();
+                    });
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(cores.size());
+            for (size_t c = 0; c < cores.size(); ++c) {
+                size_t cpu = common::CpuPlacementCpu(cores[c]);
+                threads.emplace_back(common::CreateThread(
+                                         [&pool, &group,
+                                          local_worker_id, cpu]() {
+                                             common::SetCpuAffinity(cpu);
+                                             pool.Wait(local_worker_id, group);
+                                         }));
+            }
+
+            pool.Wait(local_worker_id, group);
+
+            for (std::thread& t : threads)
+                t.join();
+            context_.worker_share().Return(cores);
+        }
+
+        for (data::File& output : outputs) {
+            data::File::ConsumeReader reader = output.GetConsumeReader();
+            while (reader.HasNext())
+                this->PushItem(reader.template Next<ValueType>());
+        }
+    }
+
+    /*!
+     * Sorts all elements in a vector and writes them to a file.
+     */
+    template <typename ItemType, typename KeyExtractor>
+    void SortAndWriteToFile(
+        std::vector<ItemType>& vec, std::deque<data::File>& files,
+        const KeyExtractor& key_extractor) {
+
+        // advise block pool to write out data if necessary
+        context_.block_pool().AdviseFree(vec.size() * sizeof(ValueType));
+
+        std::sort(vec.begin(), vec.end(),
+                  [&key_extractor](const ItemType& i1, const ItemType& i2) {
+                      return key_extractor(i1) < key_extractor(i2);
+                  });
+
+        files.emplace_back(context_.GetFile(this));
+        auto writer = files.back().GetWriter();
+        for (const ItemType& elem : vec) {
+            writer.Put(elem);
+        }
+        writer.Close();
+
+        vec.clear();
+    }
+};
 
 /*!
  * Performs an inner join between this DIA and the DIA given in the first
@@ -705,8 +1523,8 @@ template <
     typename KeyExtractor1,
     typename KeyExtractor2,
     typename JoinFunction,
-    typename HashFunction =
-        std::hash<typename common::FunctionTraits<KeyExtractor1>::result_type> >
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
 auto InnerJoin(
     const LocationDetectionFlag<LocationDetectionValue>&,
     const FirstDIA& first_dia, const SecondDIA& second_dia,
@@ -801,8 +1619,8 @@ template <
     typename KeyExtractor1,
     typename KeyExtractor2,
     typename JoinFunction,
-    typename HashFunction =
-        std::hash<typename common::FunctionTraits<KeyExtractor1>::result_type> >
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
 auto InnerJoin(
     const FirstDIA& first_dia, const SecondDIA& second_dia,
     const KeyExtractor1& key_extractor1, const KeyExtractor2& key_extractor2,
@@ -815,6 +1633,346 @@ auto InnerJoin(
         join_function, hash_function);
 }
 
+/*!
+ * Performs an inner join between two DIAs by broadcasting the second DIA to
+ * all hosts. Each host collects the complete second DIA once into a read-only
+ * hash table, which all its local workers probe with their local items of the
+ * first DIA, hence the first DIA is not shuffled. Use this variant when the
+ * second DIA is small enough to fit into the memory of every host.
+ *
+ * \tparam KeyExtractor1 Type of the key_extractor1 function. This is a function
+ * from FirstDIA::ValueType to the key type.
+ *
+ * \tparam KeyExtractor2 Type of the key_extractor2 function. This is a function
+ * from SecondDIA::ValueType to the key type.
+ *
+ * \tparam JoinFunction Type of the join_function. This is a function from
+ * ValueType and SecondDIA::ValueType to the type of the output DIA.
+ *
+ * \param first_dia First DIA to join, which is not shuffled.
+ *
+ * \param second_dia Second DIA to join, which is broadcast to all hosts.
+ *
+ * \param key_extractor1 Key extractor for this DIA
+ *
+ * \param key_extractor2 Key extractor for second DIA
+ *
+ * \param join_function Join function applied to all equal key pairs
+ *
+ * \param hash_function If necessary a hash funtion for Key
+ *
+ * \ingroup dia_dops_free
+ */
+template <
+    typename FirstDIA,
+    typename SecondDIA,
+    typename KeyExtractor1,
+    typename KeyExtractor2,
+    typename JoinFunction,
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
+auto InnerJoin(
+    const struct BroadcastJoinTag&,
+    const FirstDIA& first_dia, const SecondDIA& second_dia,
+    const KeyExtractor1& key_extractor1, const KeyExtractor2& key_extractor2,
+    const JoinFunction& join_function,
+    const HashFunction& hash_function = HashFunction()) {
+
+    assert(first_dia.IsValid());
+    assert(second_dia.IsValid());
+
+    static_assert(
+        std::is_convertible<
+            typename common::FunctionTraits<KeyExtractor1>::result_type,
+            typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Keys have different types");
+
+    static_assert(
+        std::is_convertible<
+            typename FirstDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "Join Function has wrong input type in argument 0");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "Join Function has wrong input type in argument 1");
+
+    using JoinResult
+        = typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using JoinNode = api::JoinNode<
+        JoinResult, FirstDIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+        JoinFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseBroadcast */ true>;
+
+    auto node = tlx::make_counting<JoinNode>(
+        first_dia, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
+/*!
+ * Performs an inner join between two DIAs, which drops items without a join
+ * partner before they are sent. For this, a distributed Bloom filter of the
+ * keys of the globally smaller DIA is built, and items of the larger DIA are
+ * only sent if their key is contained in the filter. Use this variant when
+ * most keys of the larger DIA have no partner.
+ *
+ * \tparam KeyExtractor1 Type of the key_extractor1 function. This is a function
+ * from FirstDIA::ValueType to the key type.
+ *
+ * \tparam KeyExtractor2 Type of the key_extractor2 function. This is a function
+ * from SecondDIA::ValueType to the key type.
+ *
+ * \tparam JoinFunction Type of the join_function. This is a function from
+ * ValueType and SecondDIA::ValueType to the type of the output DIA.
+ *
+ * \param first_dia First DIA to join.
+ *
+ * \param second_dia Second DIA to join.
+ *
+ * \param key_extractor1 Key extractor for this DIA
+ *
+ * \param key_extractor2 Key extractor for second DIA
+ *
+ * \param join_function Join function applied to all equal key pairs
+ *
+ * \param hash_function If necessary a hash funtion for Key
+ *
+ * \ingroup dia_dops_free
+ */
+template <
+    typename FirstDIA,
+    typename SecondDIA,
+    typename KeyExtractor1,
+    typename KeyExtractor2,
+    typename JoinFunction,
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
+auto InnerJoin(
+    const struct SemiJoinFilterTag&,
+    const FirstDIA& first_dia, const SecondDIA& second_dia,
+    const KeyExtractor1& key_extractor1, const KeyExtractor2& key_extractor2,
+    const JoinFunction& join_function,
+    const HashFunction& hash_function = HashFunction()) {
+
+    assert(first_dia.IsValid());
+    assert(second_dia.IsValid());
+
+    static_assert(
+        std::is_convertible<
+            typename common::FunctionTraits<KeyExtractor1>::result_type,
+            typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Keys have different types");
+
+    static_assert(
+        std::is_convertible<
+            typename FirstDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "Join Function has wrong input type in argument 0");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "Join Function has wrong input type in argument 1");
+
+    using JoinResult
+        = typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using JoinNode = api::JoinNode<
+        JoinResult, FirstDIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+        JoinFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseBroadcast */ false,
+        /* UseSemiJoinFilter */ true>;
+
+    auto node = tlx::make_counting<JoinNode>(
+        first_dia, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
+/*!
+ * Performs an inner join between two DIAs, which detects keys occurring very
+ * often (heavy hitters) and splits their join work over all workers. The items
+ * of a hot key of the DIA with more of them are spread over all workers, while
+ * the items of the other DIA with this key are replicated to all workers. Use
+ * this variant for skewed key distributions, e.g. Zipf-distributed keys.
+ *
+ * \tparam KeyExtractor1 Type of the key_extractor1 function. This is a function
+ * from FirstDIA::ValueType to the key type.
+ *
+ * \tparam KeyExtractor2 Type of the key_extractor2 function. This is a function
+ * from SecondDIA::ValueType to the key type.
+ *
+ * \tparam JoinFunction Type of the join_function. This is a function from
+ * ValueType and SecondDIA::ValueType to the type of the output DIA.
+ *
+ * \param first_dia First DIA to join.
+ *
+ * \param second_dia Second DIA to join.
+ *
+ * \param key_extractor1 Key extractor for this DIA
+ *
+ * \param key_extractor2 Key extractor for second DIA
+ *
+ * \param join_function Join function applied to all equal key pairs
+ *
+ * \param hash_function If necessary a hash funtion for Key
+ *
+ * \ingroup dia_dops_free
+ */
+template <
+    typename FirstDIA,
+    typename SecondDIA,
+    typename KeyExtractor1,
+    typename KeyExtractor2,
+    typename JoinFunction,
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
+auto InnerJoin(
+    const struct SkewJoinTag&,
+    const FirstDIA& first_dia, const SecondDIA& second_dia,
+    const KeyExtractor1& key_extractor1, const KeyExtractor2& key_extractor2,
+    const JoinFunction& join_function,
+    const HashFunction& hash_function = HashFunction()) {
+
+    assert(first_dia.IsValid());
+    assert(second_dia.IsValid());
+
+    static_assert(
+        std::is_convertible<
+            typename common::FunctionTraits<KeyExtractor1>::result_type,
+            typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Keys have different types");
+
+    static_assert(
+        std::is_convertible<
+            typename FirstDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "Join Function has wrong input type in argument 0");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "Join Function has wrong input type in argument 1");
+
+    using JoinResult
+        = typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using JoinNode = api::JoinNode<
+        JoinResult, FirstDIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+        JoinFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseBroadcast */ false,
+        /* UseSemiJoinFilter */ false, /* UseSkewHandling */ true>;
+
+    auto node = tlx::make_counting<JoinNode>(
+        first_dia, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
+/*!
+ * Performs an inner join between two DIAs which are both sorted by the join
+ * key, e.g. as outputs of Sort(). The first DIA is not moved, the items of the
+ * second DIA are sent to the workers whose key range of the first DIA contains
+ * them, and both are joined by merging without sorting them again. If the
+ * inputs turn out not to be sorted, the regular hash join is performed.
+ *
+ * \tparam KeyExtractor1 Type of the key_extractor1 function. This is a function
+ * from FirstDIA::ValueType to the key type.
+ *
+ * \tparam KeyExtractor2 Type of the key_extractor2 function. This is a function
+ * from SecondDIA::ValueType to the key type.
+ *
+ * \tparam JoinFunction Type of the join_function. This is a function from
+ * ValueType and SecondDIA::ValueType to the type of the output DIA.
+ *
+ * \param first_dia First DIA to join, sorted by key.
+ *
+ * \param second_dia Second DIA to join, sorted by key.
+ *
+ * \param key_extractor1 Key extractor for this DIA
+ *
+ * \param key_extractor2 Key extractor for second DIA
+ *
+ * \param join_function Join function applied to all equal key pairs
+ *
+ * \param hash_function If necessary a hash funtion for Key
+ *
+ * \ingroup dia_dops_free
+ */
+template <
+    typename FirstDIA,
+    typename SecondDIA,
+    typename KeyExtractor1,
+    typename KeyExtractor2,
+    typename JoinFunction,
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<KeyExtractor1>::result_type> >
+auto InnerJoin(
+    const struct SortedJoinTag&,
+    const FirstDIA& first_dia, const SecondDIA& second_dia,
+    const KeyExtractor1& key_extractor1, const KeyExtractor2& key_extractor2,
+    const JoinFunction& join_function,
+    const HashFunction& hash_function = HashFunction()) {
+
+    assert(first_dia.IsValid());
+    assert(second_dia.IsValid());
+
+    static_assert(
+        std::is_convertible<
+            typename common::FunctionTraits<KeyExtractor1>::result_type,
+            typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Keys have different types");
+
+    static_assert(
+        std::is_convertible<
+            typename FirstDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "Join Function has wrong input type in argument 0");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "Join Function has wrong input type in argument 1");
+
+    using JoinResult
+        = typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using JoinNode = api::JoinNode<
+        JoinResult, FirstDIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+        JoinFunction, HashFunction,
+        /* UseLocationDetection */ false, /* UseBroadcast */ false,
+        /* UseSemiJoinFilter */ false, /* UseSkewHandling */ false,
+        /* UseSortedInputs */ true>;
+
+    auto node = tlx::make_counting<JoinNode>(
+        first_dia, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
 } // namespace api
 
 //! imported from api namespace
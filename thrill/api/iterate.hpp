@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * thrill/api/iterate.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_ITERATE_HEADER
+#define THRILL_API_ITERATE_HEADER
+
+#include <thrill/api/cache.hpp>
+#include <thrill/api/collapse.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/api/reduce_to_index.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/union.hpp>
+#include <thrill/common/stats_timer.hpp>
+
+#include <cstdint>
+#include <utility>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Iterate applies body to the DIA of the previous iteration, starting with
+ * init, and executes each iteration's result before building the next one.
+ * body is called as body(dia, iteration) and returns the DIA of the next
+ * iteration.
+ *
+ * The result of body is only Collapse()d, not Cached: a result of a DOp, like
+ * the ReduceToIndex() of PageRank, already keeps its data for the next
+ * iteration, and a chain of LOps is recomputed from the last executed DIA.
+ * Each iteration is a plain execution of its DIAs; no plan or data structures
+ * are reused between iterations.
+ *
+ * \param init DIA of the first iteration's input
+ *
+ * \param iterations Number of times body is applied
+ *
+ * \param body Function building the next iteration's DIA from the previous one
+ *
+ * \ingroup dia_actions
+ */
+template <typename ValueType, typename Stack, typename BodyFunction>
+DIA<ValueType> Iterate(const DIA<ValueType, Stack>& init, size_t iterations,
+                       const BodyFunction& body) {
+    assert(init.IsValid());
+
+    Context& ctx = init.context();
+
+    DIA<ValueType> current = init.Collapse();
+
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        common::StatsTimerStart timer;
+
+        DIA<ValueType> next = body(current, iter).Collapse();
+        next.Execute();
+        // drop the reference to the previous iteration's DIA
+        current = next;
+
+        ctx.logger_
+            << "class" << "Iterate"
+            << "event" << "iteration"
+            << "iteration" << iter
+            << "dia_id" << current.id()
+            << "elapsed" << timer;
+    }
+
+    return current;
+}
+
+/*!
+ * IterateDelta is an incremental loop construct for convergent algorithms,
+ * which keeps a solution set indexed by key_extractor and a workset of the
+ * elements changed in the last iteration. In each iteration, step is called
+ * as step(solution, workset, iteration) and returns a DIA of updates, which
+ * are merged into the solution with merge_function. The updates which change
+ * the solution form the next workset. The loop ends when the workset is empty
+ * or after max_iterations.
+ *
+ * The solution is stored partitioned by index like the output of
+ * ReduceToIndex. The updates are merged by a ReduceToIndex over both, hence
+ * only the updates are shuffled, while the solution's elements are already on
+ * their target worker.
+ *
+ * The solution must contain exactly one element for each index in [0,size),
+ * and ValueType must be equality comparable to detect changes.
+ *
+ * \param solution DIA of the initial solution, one element per index
+ *
+ * \param workset DIA of the first iteration's workset
+ *
+ * \param key_extractor Function mapping an element to its index in [0,size)
+ *
+ * \param merge_function Function merging an element of the solution (first)
+ * and an update or two updates of the same index, e.g. min for distances
+ *
+ * \param size Number of elements of the solution
+ *
+ * \param max_iterations Maximum number of times step is applied
+ *
+ * \param step Function building the updates from the solution and workset
+ *
+ * \ingroup dia_actions
+ */
+template <typename ValueType, typename SolutionStack, typename WorksetStack,
+          typename KeyExtractor, typename MergeFunction, typename StepFunction>
+DIA<ValueType> IterateDelta(
+    const DIA<ValueType, SolutionStack>& solution,
+    const DIA<ValueType, WorksetStack>& workset,
+    const KeyExtractor& key_extractor, const MergeFunction& merge_function,
+    size_t size, size_t max_iterations, const StepFunction& step) {
+    assert(solution.IsValid());
+    assert(workset.IsValid());
+
+    Context& ctx = solution.context();
+
+    //! element of the solution or an update, tagged with its state
+    using Tagged = std::pair<ValueType, uint8_t>;
+    //! element of the solution, unchanged in this iteration
+    static constexpr uint8_t kOld = 0;
+    //! update not yet merged into the solution
+    static constexpr uint8_t kUpdate = 1;
+    //! element of the solution changed by an update
+    static constexpr uint8_t kChanged = 2;
+
+    auto tagged_key =
+        [key_extractor](const Tagged& t) { return key_extractor(t.first); };
+
+    auto tagged_merge =
+        [merge_function](const Tagged& a, const Tagged& b) {
+            if (a.second == kUpdate && b.second == kUpdate)
+                return Tagged(merge_function(a.first, b.first), kUpdate);
+
+            const Tagged& old = (a.second == kUpdate) ? b : a;
+            const Tagged& update = (a.second == kUpdate) ? a : b;
+            ValueType merged = merge_function(old.first, update.first);
+            bool changed = (old.second == kChanged) || !(merged == old.first);
+            return Tagged(std::move(merged), changed ? kChanged : kOld);
+        };
+
+    DIA<Tagged> state =
+        solution
+        .Map([](const ValueType& v) { return Tagged(v, kOld); })
+        .ReduceToIndex(tagged_key, tagged_merge, size)
+        .Cache();
+
+    DIA<ValueType> work = workset.Cache();
+
+    for (size_t iter = 0; iter < max_iterations; ++iter) {
+        common::StatsTimerStart timer;
+
+        size_t work_size = work.Size();
+        if (work_size == 0) break;
+
+        auto updates = step(
+            state.Map([](const Tagged& t) { return t.first; }).Collapse(),
+            work, iter);
+
+        state =
+            state
+            .Map([](const Tagged& t) { return Tagged(t.first, kOld); })
+            .Union(updates.Map(
+                       [](const ValueType& v) { return Tagged(v, kUpdate); }))
+            .ReduceToIndex(tagged_key, tagged_merge, size)
+            .Cache();
+
+        work =
+            state
+            .Filter([](const Tagged& t) { return t.second != kOld; })
+            .Map([](const Tagged& t) { return t.first; })
+            .Cache();
+        work.Execute();
+
+        ctx.logger_
+            << "class" << "IterateDelta"
+            << "event" << "iteration"
+            << "iteration" << iter
+            << "workset_size" << work_size
+            << "elapsed" << timer;
+    }
+
+    return state.Map([](const Tagged& t) { return t.first; }).Collapse();
+}
+
+} // namespace api
+
+//! imported from api namespace
+using api::Iterate;
+using api::IterateDelta;
+
+} // namespace thrill
+
+#endif // !THRILL_API_ITERATE_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,252 @@
+/*******************************************************************************
+ * thrill/api/job_server.cpp
+ *
+ * Long-running server mode, which keeps the HostContexts and network groups
+ * alive and runs submitted jobs one after another.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/job_server.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/porting.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
+#include <tlx/string/split.hpp>
+#include <tlx/string/starts_with.hpp>
+#include <tlx/string/trim.hpp>
+
+#if !defined(_MSC_VER)
+#include <dlfcn.h>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace thrill {
+namespace api {
+
+bool ParseJobRequest(const std::string& line, JobRequest* request) {
+    std::vector<std::string> tokens;
+    for (const std::string& t : tlx::split(' ', tlx::trim(line))) {
+        if (!t.empty()) tokens.push_back(t);
+    }
+
+    *request = JobRequest();
+
+    size_t i = 0;
+    if (i < tokens.size() && tlx::starts_with(tokens[i], "mem=")) {
+        uint64_t mem_limit;
+        if (!tlx::parse_si_iec_units(tokens[i].substr(4), &mem_limit) ||
+            mem_limit == 0)
+            return false;
+        request->mem_limit = mem_limit;
+        ++i;
+    }
+
+    if (i + 2 > tokens.size())
+        return false;
+
+    request->library = tokens[i++];
+    request->function = tokens[i++];
+    request->args.assign(tokens.begin() + i, tokens.end());
+    return true;
+}
+
+//! protects the registered functions and the loaded libraries
+static std::mutex g_job_mutex;
+
+//! job functions registered in this process
+static std::map<std::string, JobFunction> g_job_functions;
+
+//! handles of the loaded libraries, which are never closed, since jobs may
+//! leave static objects behind.
+static std::map<std::string, void*> g_job_libraries;
+
+void RegisterJobFunction(const std::string& name, const JobFunction& function) {
+    std::unique_lock<std::mutex> lock(g_job_mutex);
+    g_job_functions[name] = function;
+}
+
+JobFunction LoadJobFunction(const JobRequest& request, std::string* error) {
+    std::unique_lock<std::mutex> lock(g_job_mutex);
+
+    if (request.library == "-") {
+        auto it = g_job_functions.find(request.function);
+        if (it == g_job_functions.end()) {
+            *error = "job function " + request.function + " is not registered";
+            return JobFunction();
+        }
+        return it->second;
+    }
+
+#if !defined(_MSC_VER)
+    auto it = g_job_libraries.find(request.library);
+    if (it == g_job_libraries.end()) {
+        void* handle = dlopen(request.library.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            *error = dlerror();
+            return JobFunction();
+        }
+        it = g_job_libraries.emplace(request.library, handle).first;
+    }
+
+    // clear old errors, since a symbol may legally be nullptr
+    dlerror();
+    void* symbol = dlsym(it->second, request.function.c_str());
+    if (symbol == nullptr) {
+        const char* dl_error = dlerror();
+        *error = dl_error ? dl_error : request.function + " is a null symbol";
+        return JobFunction();
+    }
+    return reinterpret_cast<JobFunctionPtr>(symbol);
+#else
+    *error = "loading job libraries is not supported on this platform";
+    return JobFunction();
+#endif
+}
+
+//! request lines read by the reader thread of the first worker. Shared with
+//! the thread, which may outlive ServeJobs() if a job throws.
+struct JobRequestQueue {
+    std::mutex mutex;
+    std::deque<std::string> lines;
+    //! whether the source ended or a quit request was read
+    bool done = false;
+};
+
+size_t ServeJobs(Context& ctx, const JobRequestSource& source,
+                 std::chrono::milliseconds poll_interval) {
+
+    auto queue = std::make_shared<JobRequestQueue>();
+    std::thread reader;
+
+    if (ctx.my_rank() == 0) {
+        reader = common::CreateThread(
+            [queue, source]() {
+                common::NameThisThread("job reader");
+                std::string line;
+                while (source(&line)) {
+                    line = tlx::trim(line);
+                    if (line.empty()) continue;
+
+                    std::unique_lock<std::mutex> lock(queue->mutex);
+                    queue->lines.push_back(line);
+                    if (line == "quit") break;
+                }
+                std::unique_lock<std::mutex> lock(queue->mutex);
+                queue->done = true;
+            });
+    }
+
+    size_t jobs = 0;
+
+    try {
+        while (true) {
+            // the first worker takes the next request, an empty line means
+            // that none is pending.
+            std::string line;
+            if (ctx.my_rank() == 0) {
+                std::unique_lock<std::mutex> lock(queue->mutex);
+                if (!queue->lines.empty()) {
+                    line = std::move(queue->lines.front());
+                    queue->lines.pop_front();
+                }
+                else if (queue->done) {
+                    line = "quit";
+                }
+            }
+            line = ctx.net.Broadcast(line);
+
+            if (line.empty()) {
+                std::this_thread::sleep_for(poll_interval);
+                continue;
+            }
+            if (line == "quit")
+                break;
+
+            JobRequest request;
+            JobFunction function;
+            std::string error = "malformed job request";
+            if (ParseJobRequest(line, &request))
+                function = LoadJobFunction(request, &error);
+
+            // skip the job unless all workers found its function
+            size_t failed = ctx.net.AllReduce(size_t(function ? 0 : 1));
+            if (failed != 0) {
+                if (!function) {
+                    std::cerr << "Thrill: job server worker " << ctx.my_rank()
+                              << " skips \"" << line << "\": " << error
+                              << std::endl;
+                }
+                continue;
+            }
+
+            size_t mem_limit = ctx.host_context().worker_mem_limit();
+            if (request.mem_limit != 0)
+                mem_limit = std::min<size_t>(mem_limit, request.mem_limit);
+
+            if (ctx.my_rank() == 0) {
+                std::cerr << "Thrill: job server runs job " << jobs
+                          << ": " << line << std::endl;
+            }
+
+            // the job id is the same on all hosts, since all run the same
+            // sequence of jobs. Zero is the id of the server's own Context.
+            size_t job_id = jobs + 1;
+            HostContext& host_context = ctx.host_context();
+            if (ctx.local_worker_id() == 0 && request.mem_limit != 0) {
+                host_context.block_pool().SetJobQuota(
+                    job_id, mem_limit * ctx.workers_per_host());
+            }
+
+            Context job_ctx(
+                host_context, ctx.local_worker_id(), mem_limit, job_id);
+            job_ctx.Launch(
+                [&function, &request](Context& c) {
+                    function(c, request.args);
+                });
+
+            // all local workers are done allocating the job's streams
+            ctx.net.LocalBarrier();
+            if (ctx.local_worker_id() == 0) {
+                host_context.block_pool().ReleaseJob(job_id);
+                host_context.data_multiplexer().ReleaseJob(job_id);
+            }
+
+            ++jobs;
+        }
+    }
+    catch (...) {
+        // the reader thread only holds the shared queue and the source
+        if (reader.joinable()) reader.detach();
+        throw;
+    }
+
+    if (reader.joinable()) reader.join();
+
+    return jobs;
+}
+
+int RunJobServer(std::istream& requests) {
+    return Run(
+        [&requests](Context& ctx) {
+            ServeJobs(ctx, [&requests](std::string* line) {
+                          return static_cast<bool>(
+                              std::getline(requests, *line));
+                      });
+        });
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
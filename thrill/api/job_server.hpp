@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * thrill/api/job_server.hpp
+ *
+ * Long-running server mode, which keeps the HostContexts and network groups
+ * alive and runs submitted jobs one after another.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_JOB_SERVER_HEADER
+#define THRILL_API_JOB_SERVER_HEADER
+
+#include <thrill/api/context.hpp>
+
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \ingroup api_layer
+//! \{
+
+//! A job function run by all workers, which gets the arguments of the request.
+using JobFunction =
+    std::function<void(Context& ctx, const std::vector<std::string>& args)>;
+
+//! Signature of the job functions which shared libraries export with
+//! extern "C" for the JobServer.
+using JobFunctionPtr =
+    void (*)(Context& ctx, const std::vector<std::string>& args);
+
+/*!
+ * A job request is one line "[mem=<size>] <library> <function> [args...]",
+ * where library is the path of a shared library exporting function with
+ * extern "C" linkage and the JobFunctionPtr signature, or "-" for a function
+ * registered with RegisterJobFunction(). The optional size, e.g. mem=2GiB,
+ * limits the memory of each worker's Context of the job, and the line "quit"
+ * stops the server.
+ */
+struct JobRequest {
+    std::string library;
+    std::string function;
+    std::vector<std::string> args;
+    //! memory limit of each worker's Context, or zero for the default
+    size_t mem_limit = 0;
+};
+
+//! parse a request line, returns false if it is malformed.
+bool ParseJobRequest(const std::string& line, JobRequest* request);
+
+//! register a job function in this process, which requests select with the
+//! library "-".
+void RegisterJobFunction(const std::string& name, const JobFunction& function);
+
+//! find the function of the request: dlopen() the library once per process,
+//! and look up the function. Returns an empty JobFunction and sets error on
+//! failure.
+JobFunction LoadJobFunction(const JobRequest& request, std::string* error);
+
+//! Source of request lines, called on a separate thread of the first worker.
+//! Returns false at the end of the requests.
+using JobRequestSource = std::function<bool(std::string* line)>;
+
+/*!
+ * Serve jobs within a long-running Run(), such that the processes, network
+ * connections, BlockPool, and dispatcher threads are set up only once for all
+ * jobs. The first worker reads request lines from source, and broadcasts each
+ * to all workers, which then run the job in a new Context with the request's
+ * memory limit. Idle workers poll for requests every poll_interval, instead of
+ * waiting in a collective. Each job gets its own job id, hence its own stream
+ * ids, and the request's memory limit of all local workers as quota of its
+ * Blocks in the BlockPool.
+ *
+ * Requests which cannot be parsed or loaded on all workers are skipped and
+ * reported on the first worker. An exception thrown by a job ends the server,
+ * since the other workers may be stuck in a collective of the job.
+ *
+ * Must be called by all workers of all hosts, returns the number of jobs run.
+ */
+size_t ServeJobs(Context& ctx, const JobRequestSource& source,
+                 std::chrono::milliseconds poll_interval =
+                     std::chrono::milliseconds(20));
+
+//! Run() a job server, whose first worker reads request lines from the
+//! stream, e.g. std::cin or a named pipe.
+int RunJobServer(std::istream& requests);
+
+//! \}
+
+} // namespace api
+
+//! imported from api namespace
+using api::ServeJobs;
+
+//! imported from api namespace
+using api::RunJobServer;
+
+} // namespace thrill
+
+#endif // !THRILL_API_JOB_SERVER_HEADER
+
+/******************************************************************************/
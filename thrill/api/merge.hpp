@@ -65,6 +65,12 @@ namespace api {
  *    ^
  *    local_ranks,  global_ranks = sum over all local_ranks
  *
+ * The search stops when all global_ranks are within kNumInputs + 1 of their
+ * target_ranks. The remaining differences are then corrected exactly by
+ * exchanging the few items next to each splitter, such that every worker
+ * receives exactly n/p items (+1 for the first n % p workers). All local
+ * workers of a host thus merge equal-sized ranges concurrently.
+ *
  * \tparam ValueType The type of the first and second input DIA
  * \tparam Comparator The comparator defining input and output order.
  * \tparam ParentDIA0 The type of the first input DIA
@@ -208,6 +214,15 @@ private:
         size_t    segment_len;
     };
 
+    //! An item next to a splitter, which may be moved across it to make the
+    //! split exact.
+    struct Candidate {
+        ValueType value;
+        size_t    idx;
+        size_t    worker;
+        size_t    file;
+    };
+
     //! Count of items on all prev workers.
     size_t prefix_size_;
 
@@ -235,6 +250,73 @@ private:
         }
     };
 
+    /*!
+     * Total order of Candidates: by value, then by local rank, as compared by
+     * File::GetIndexOf() with the tie of a pivot, then by worker and file.
+     * Each splitter found by the search separates a prefix of this order.
+     */
+    class CandidateLess
+    {
+    public:
+        explicit CandidateLess(const Comparator& comparator)
+            : comparator_(comparator) { }
+
+        bool operator () (const Candidate& a, const Candidate& b) const {
+            if (comparator_(a.value, b.value)) return true;
+            if (comparator_(b.value, a.value)) return false;
+            if (a.idx != b.idx) return a.idx < b.idx;
+            if (a.worker != b.worker) return a.worker < b.worker;
+            return a.file < b.file;
+        }
+
+    private:
+        Comparator comparator_;
+    };
+
+    /*!
+     * Reduce functor for the Candidates of all splitters: keeps the |target -
+     * global| smallest Candidates after each splitter, or the largest before
+     * it, in sorted order.
+     */
+    class ReduceCandidates
+    {
+    public:
+        ReduceCandidates(const std::vector<size_t>& global_ranks,
+                         const std::vector<size_t>& target_ranks,
+                         const Comparator& comparator)
+            : global_ranks_(global_ranks), target_ranks_(target_ranks),
+              less_(comparator) { }
+
+        std::vector<std::vector<Candidate> > operator () (
+            const std::vector<std::vector<Candidate> >& a,
+            const std::vector<std::vector<Candidate> >& b) const {
+            assert(a.size() == b.size());
+            std::vector<std::vector<Candidate> > out(a.size());
+            for (size_t s = 0; s < a.size(); ++s) {
+                size_t k = tlx::abs_diff(global_ranks_[s], target_ranks_[s]);
+                out[s].resize(a[s].size() + b[s].size());
+                if (global_ranks_[s] < target_ranks_[s]) {
+                    std::merge(a[s].begin(), a[s].end(),
+                               b[s].begin(), b[s].end(), out[s].begin(), less_);
+                }
+                else {
+                    std::merge(a[s].begin(), a[s].end(),
+                               b[s].begin(), b[s].end(), out[s].begin(),
+                               [this](const Candidate& x, const Candidate& y) {
+                                   return less_(y, x);
+                               });
+                }
+                if (out[s].size() > k) out[s].resize(k);
+            }
+            return out;
+        }
+
+    private:
+        const std::vector<size_t>& global_ranks_;
+        const std::vector<size_t>& target_ranks_;
+        CandidateLess less_;
+    };
+
     using StatsTimer = common::StatsTimerBaseStopped<stats_enabled>;
 
     /*!
@@ -458,6 +540,103 @@ private:
         }
     }
 
+    /*!
+     * Corrects the splitters found by the search, which are within kNumInputs
+     * + 1 of their target ranks, to match them exactly. For each splitter with
+     * global rank g and target rank t, each worker contributes the t - g items
+     * following the splitter in each File (or the g - t items preceding it).
+     * An AllReduce selects the t - g smallest of these (or the g - t largest)
+     * in the order of CandidateLess, and the workers owning them move their
+     * local_ranks across these items.
+     *
+     * \param global_ranks The global ranks of all splitters.
+     *
+     * \param target_ranks The desired ranks of the splitters.
+     *
+     * \param local_ranks The local ranks of each splitter in each file. This
+     * parameter will be modified.
+     */
+    void ExactSplitters(
+        const std::vector<size_t>& global_ranks,
+        const std::vector<size_t>& target_ranks,
+        std::vector<ArrayNumInputsSizeT>& local_ranks) {
+
+        size_t my_rank = context_.my_rank();
+        CandidateLess less(comparator_);
+
+        std::vector<std::vector<Candidate> > candidates(local_ranks.size());
+
+        stats_.file_op_timer_.Start();
+        for (size_t s = 0; s < local_ranks.size(); ++s) {
+            size_t k = tlx::abs_diff(global_ranks[s], target_ranks[s]);
+            if (k == 0) continue;
+
+            for (size_t i = 0; i < kNumInputs; ++i) {
+                size_t rank = local_ranks[s][i], begin, end;
+                if (global_ranks[s] < target_ranks[s]) {
+                    begin = rank;
+                    end = std::min(rank + k, files_[i]->num_items());
+                }
+                else {
+                    begin = rank - std::min(rank, k);
+                    end = rank;
+                }
+                if (begin == end) continue;
+
+                auto reader = files_[i]->template GetReaderAt<ValueType>(begin);
+                for (size_t idx = begin; idx < end; ++idx) {
+                    candidates[s].emplace_back(
+                        Candidate {
+                            reader.template Next<ValueType>(), idx, my_rank, i
+                        });
+                }
+            }
+
+            if (global_ranks[s] < target_ranks[s]) {
+                std::sort(candidates[s].begin(), candidates[s].end(), less);
+            }
+            else {
+                std::sort(candidates[s].begin(), candidates[s].end(),
+                          [&less](const Candidate& a, const Candidate& b) {
+                              return less(b, a);
+                          });
+            }
+            if (candidates[s].size() > k) candidates[s].resize(k);
+        }
+        stats_.file_op_timer_.Stop();
+
+        stats_.comm_timer_.Start();
+        candidates = context_.net.AllReduce(
+            candidates,
+            ReduceCandidates(global_ranks, target_ranks, comparator_));
+        stats_.comm_timer_.Stop();
+
+        // the selected items of each File are adjacent to the splitter, hence
+        // moving the splitter by their number moves it across them.
+        for (size_t s = 0; s < local_ranks.size(); ++s) {
+            assert(candidates[s].size() ==
+                   tlx::abs_diff(global_ranks[s], target_ranks[s]));
+            for (const Candidate& c : candidates[s]) {
+                if (c.worker != my_rank) continue;
+                if (global_ranks[s] < target_ranks[s])
+                    ++local_ranks[s][c.file];
+                else
+                    --local_ranks[s][c.file];
+            }
+        }
+
+        if (self_verify) {
+            std::vector<size_t> exact_ranks(local_ranks.size());
+            for (size_t s = 0; s < local_ranks.size(); ++s) {
+                for (size_t i = 0; i < kNumInputs; ++i)
+                    exact_ranks[s] += local_ranks[s][i];
+            }
+            exact_ranks = context_.net.AllReduce(
+                exact_ranks, common::ComponentSum<std::vector<size_t> >());
+            die_unless(exact_ranks == target_ranks);
+        }
+    }
+
     /*!
      * Receives elements from other workers and re-balance them, so each worker
      * has the same amount after merging.
@@ -507,10 +686,9 @@ private:
 
         for (size_t r = 0; r < p - 1; r++) {
             target_ranks[r] = (global_size / p) * (r + 1);
-            // Modify all ranks 0..(globalSize % p), in case global_size is not
-            // divisible by p.
-            if (r < global_size % p)
-                target_ranks[r] += 1;
+            // The first (global_size % p) workers receive one more item, in
+            // case global_size is not divisible by p.
+            target_ranks[r] += std::min(r + 1, global_size % p);
         }
 
         if (debug) {
@@ -601,6 +779,8 @@ private:
             stats_.search_step_timer_.Stop();
             stats_.iterations_++;
         }
+
+        ExactSplitters(global_ranks, target_ranks, local_ranks);
         stats_.balancing_timer_.Stop();
 
         LOG << "Finished after " << stats_.iterations_ << " iterations";
@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * thrill/api/metrics_server.cpp
+ *
+ * HTTP endpoint serving live metrics of a host.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/metrics_server.hpp>
+#include <thrill/common/config.hpp>
+#include <thrill/common/logger.hpp>
+
+#if THRILL_HAVE_NET_TCP
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace thrill {
+namespace api {
+
+static constexpr bool debug = false;
+
+MetricsServer::MetricsServer(uint16_t port) {
+#if THRILL_HAVE_NET_TCP
+    // ignore PIPE signals from scrapers closing early, like the dispatchers.
+    signal(SIGPIPE, SIG_IGN);
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        LOG1 << "MetricsServer: socket() failed: " << strerror(errno);
+        return;
+    }
+
+    int on = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    sa.sin_port = htons(port);
+
+    socklen_t salen = sizeof(sa);
+    if (::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&sa),
+               sizeof(sa)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&sa),
+                      &salen) != 0) {
+        LOG1 << "MetricsServer: could not listen on port " << port
+             << ": " << strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+    port_ = ntohs(sa.sin_port);
+
+    LOG << "MetricsServer: listening on port " << port_;
+
+    thread_ = std::thread([this]() { Worker(); });
+#else
+    LOG1 << "MetricsServer: not available without TCP sockets, port "
+         << port << " ignored.";
+#endif
+}
+
+MetricsServer::~MetricsServer() {
+    terminate_ = true;
+    if (thread_.joinable())
+        thread_.join();
+#if THRILL_HAVE_NET_TCP
+    if (listen_fd_ >= 0)
+        ::close(listen_fd_);
+#endif
+}
+
+void MetricsServer::Add(const Collector& collector) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    collectors_.emplace_back(collector);
+}
+
+void MetricsServer::Collect(common::MetricsWriter& mw) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const Collector& c : collectors_)
+        c(mw);
+}
+
+void MetricsServer::Worker() {
+#if THRILL_HAVE_NET_TCP
+    common::NameThisThread("metrics-server");
+
+    while (!terminate_) {
+        // wake up periodically to check for termination
+        struct pollfd pfd;
+        pfd.fd = listen_fd_;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, /* timeout ms */ 100) <= 0) continue;
+
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        Serve(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+void MetricsServer::Serve(int fd) {
+#if THRILL_HAVE_NET_TCP
+    // read the request header, only the request line is inspected.
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.size() < 16 * 1024) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, /* timeout ms */ 1000) <= 0) return;
+
+        ssize_t rb = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (rb <= 0) return;
+        request.append(buffer, rb);
+    }
+
+    std::string status, body;
+    if (request.compare(0, 13, "GET /metrics ") == 0 ||
+        request.compare(0, 13, "GET /metrics?") == 0) {
+        std::ostringstream oss;
+        common::MetricsWriter mw(oss);
+        Collect(mw);
+        status = "200 OK";
+        body = oss.str();
+    }
+    else {
+        status = "404 Not Found";
+        body = "only /metrics is served\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n"
+             << "\r\n"
+             << body;
+
+    std::string out = response.str();
+    size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t wb = ::send(fd, out.data() + sent, out.size() - sent, 0);
+        if (wb <= 0) return;
+        sent += wb;
+    }
+#else
+    (void)fd;
+#endif
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * thrill/api/metrics_server.hpp
+ *
+ * HTTP endpoint serving live metrics of a host.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_METRICS_SERVER_HEADER
+#define THRILL_API_METRICS_SERVER_HEADER
+
+#include <thrill/common/metrics_writer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \addtogroup api_layer
+//! \{
+
+/*!
+ * A minimal HTTP server in its own thread, which answers GET /metrics with the
+ * host's metrics in the Prometheus text format, such that dashboards can scrape
+ * running jobs. The metrics are gathered on each request by the registered
+ * collectors, which must be thread-safe. Enabled by THRILL_METRICS_PORT.
+ */
+class MetricsServer
+{
+public:
+    using Collector = std::function<void(common::MetricsWriter&)>;
+
+    //! listen on the port, 0 selects any free port.
+    explicit MetricsServer(uint16_t port);
+
+    //! non-copyable: delete copy-constructor
+    MetricsServer(const MetricsServer&) = delete;
+    //! non-copyable: delete assignment operator
+    MetricsServer& operator = (const MetricsServer&) = delete;
+
+    //! stop serving
+    ~MetricsServer();
+
+    //! register a collector writing metrics for each request
+    void Add(const Collector& collector);
+
+    //! port listened on, 0 if the socket could not be opened.
+    uint16_t port() const { return port_; }
+
+    //! write the metrics of all collectors
+    void Collect(common::MetricsWriter& mw);
+
+private:
+    //! listening socket
+    int listen_fd_ = -1;
+
+    //! port listened on
+    uint16_t port_ = 0;
+
+    //! registered collectors
+    std::vector<Collector> collectors_;
+
+    //! protects collectors_
+    std::mutex mutex_;
+
+    //! flag to stop the thread
+    std::atomic<bool> terminate_ { false };
+
+    //! server thread
+    std::thread thread_;
+
+    //! accept and answer requests until terminated
+    void Worker();
+
+    //! answer one HTTP request on the connection
+    void Serve(int fd);
+};
+
+//! \}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_METRICS_SERVER_HEADER
+
+/******************************************************************************/
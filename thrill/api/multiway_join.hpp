@@ -0,0 +1,548 @@
+/*******************************************************************************
+ * thrill/api/multiway_join.hpp
+ *
+ * DIANode for an inner join of three or more DIAs on the same key in a single
+ * shuffle.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_MULTIWAY_JOIN_HEADER
+#define THRILL_API_MULTIWAY_JOIN_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/function_traits.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/core/buffered_multiway_merge.hpp>
+#include <thrill/core/multiway_merge.hpp>
+#include <thrill/data/file.hpp>
+#include <thrill/data/mix_stream.hpp>
+#include <tlx/meta/apply_tuple.hpp>
+#include <tlx/meta/call_for_range.hpp>
+#include <tlx/meta/call_foreach_with_index.hpp>
+#include <tlx/meta/vmap_for_range.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs an inner join of kNumInputs DIAs on the same key.
+ * The items of all inputs are hash partitioned by key in one shuffle, and each
+ * worker forms sorted runs of the items it received for each input, like the
+ * JoinNode. PushData() then merges the runs of all inputs at once: the input
+ * with the largest key at its top decides the next candidate key, all other
+ * inputs skip their smaller keys, and if all inputs contain the candidate key,
+ * the cartesian product of their equal-key groups is joined.
+ *
+ * Compared to chaining InnerJoin() of two DIAs, the intermediate results are
+ * neither materialized nor shuffled again.
+ *
+ * The equal-key groups of all but the last input are collected in memory,
+ * while the group of the last input is streamed. Hence, the input with the
+ * largest groups should be the last one.
+ *
+ * \tparam ValueType Output type of the join.
+ *
+ * \tparam KeyExtractors std::tuple of the key extractors of all inputs.
+ *
+ * \tparam JoinFunction Type of the join_function, with one argument per input.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename KeyExtractors, typename JoinFunction,
+          typename HashFunction, size_t kNumInputs>
+class MultiwayJoinNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    static_assert(kNumInputs >= 2, "MultiwayJoin requires two or more inputs");
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    template <size_t Index>
+    using InputN = typename common::FunctionTraits<JoinFunction>
+                   ::template arg_plain<Index>;
+
+    //! type of the key extractor of input Index
+    template <size_t Index>
+    using KeyExtractorN =
+        typename std::tuple_element<Index, KeyExtractors>::type;
+
+    //! Key type of join. must be equal for all key extractors
+    using Key = typename common::FunctionTraits<KeyExtractorN<0> >::result_type;
+
+    //! input whose equal-key groups are streamed instead of collected
+    static constexpr size_t kLast = kNumInputs - 1;
+
+    //! compares items of input Index by key
+    template <size_t Index>
+    class KeyCompare
+    {
+    public:
+        explicit KeyCompare(const KeyExtractorN<Index>& key_extractor)
+            : key_extractor_(key_extractor) { }
+
+        bool operator () (const InputN<Index>& a,
+                          const InputN<Index>& b) const {
+            return key_extractor_(a) < key_extractor_(b);
+        }
+
+    private:
+        KeyExtractorN<Index> key_extractor_;
+    };
+
+    //! merge tree over the sorted runs of input Index
+    template <size_t Index>
+    using Puller = core::BufferedMultiwayMergeTree<
+        InputN<Index>, std::vector<data::File::Reader>::iterator,
+        KeyCompare<Index> >;
+
+public:
+    /*!
+     * Constructor for a MultiwayJoinNode.
+     */
+    template <typename ParentDIA0, typename... ParentDIAs>
+    MultiwayJoinNode(const KeyExtractors& key_extractors,
+                     const JoinFunction& join_function,
+                     const HashFunction& hash_function,
+                     const ParentDIA0& parent0, const ParentDIAs& ... parents)
+        : Super(parent0.ctx(), "MultiwayJoin",
+                { parent0.id(), parents.id() ... },
+                { parent0.node(), parents.node() ... }),
+          key_extractors_(key_extractors),
+          join_function_(join_function),
+          hash_function_(hash_function) {
+
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            streams_[i] = context_.GetNewMixStream(this);
+            hash_writers_[i] = streams_[i]->GetWriters();
+        }
+
+        // Hook PreOp(s)
+        tlx::call_foreach_with_index(
+            RegisterParent(this), parent0, parents...);
+    }
+
+    DIAMemUse PreOpMemUse() final {
+        return DIAMemUse::Max();
+    }
+
+    DIAMemUse ExecuteMemUse() final {
+        return DIAMemUse::Max();
+    }
+
+    DIAMemUse PushDataMemUse() final {
+        return DIAMemUse::Max();
+    }
+
+    void Execute() final {
+        for (size_t i = 0; i < kNumInputs; ++i)
+            hash_writers_[i].Close();
+
+        MainOp();
+    }
+
+    void PushData(bool consume) final {
+        // no possible join results when at least one input is empty
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            if (files_[i].empty()) return;
+        }
+
+        tlx::call_for_range<kNumInputs>(
+            [&](auto index) {
+                (void)index;
+                this->MergeFiles<decltype(index)::index>();
+            });
+
+        auto pullers = tlx::vmap_for_range<kNumInputs>(
+            [&](auto index) {
+                (void)index;
+                return this->MakePuller<decltype(index)::index>(consume);
+            });
+
+        //! cache for the equal-key groups of all inputs but the last
+        auto groups = tlx::vmap_for_range<kLast>(
+            [](auto index) {
+                (void)index;
+                return std::vector<InputN<decltype(index)::index> >();
+            });
+
+        size_t result_count = 0;
+
+        while (true) {
+            // the largest key at the top of all inputs is the next candidate
+            bool done = false;
+            bool first = true;
+            Key key { };
+            tlx::call_for_range<kNumInputs>(
+                [&](auto index) {
+                    auto& puller = *std::get<decltype(index)::index>(pullers);
+                    if (!puller.HasNext()) {
+                        done = true;
+                        return;
+                    }
+                    const Key& top = this->GetKey<decltype(index)::index>(
+                        puller.Top());
+                    if (first || key < top) key = top;
+                    first = false;
+                });
+            if (done) break;
+
+            // skip items with smaller keys, and check that all have the key
+            bool equal = true;
+            tlx::call_for_range<kNumInputs>(
+                [&](auto index) {
+                    constexpr size_t Index = decltype(index)::index;
+                    auto& puller = *std::get<Index>(pullers);
+                    while (puller.HasNext() &&
+                           this->GetKey<Index>(puller.Top()) < key) {
+                        puller.Update();
+                    }
+                    if (!puller.HasNext())
+                        done = true;
+                    else if (key < this->GetKey<Index>(puller.Top()))
+                        equal = false;
+                });
+            if (done) break;
+            if (!equal) continue;
+
+            tlx::call_for_range<kLast>(
+                [&](auto index) {
+                    constexpr size_t Index = decltype(index)::index;
+                    auto& puller = *std::get<Index>(pullers);
+                    auto& group = std::get<Index>(groups);
+                    group.clear();
+                    while (puller.HasNext() &&
+                           !(key < this->GetKey<Index>(puller.Top()))) {
+                        group.push_back(puller.Top());
+                        puller.Update();
+                    }
+                });
+
+            auto& last = *std::get<kLast>(pullers);
+            while (last.HasNext() && !(key < GetKey<kLast>(last.Top()))) {
+                InputN<kLast> item = last.Top();
+                JoinProduct(std::false_type(), groups, item, result_count);
+                last.Update();
+            }
+        }
+
+        sLOG << "MultiwayJoin() result_count" << result_count;
+    }
+
+    void Dispose() final {
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            files_[i].clear();
+            seqs_[i].clear();
+        }
+    }
+
+private:
+    //! user-defined functions
+    KeyExtractors key_extractors_;
+    JoinFunction join_function_;
+    HashFunction hash_function_;
+
+    //! data streams for inter-worker communication of DIA elements
+    data::MixStreamPtr streams_[kNumInputs];
+    data::MixStream::Writers hash_writers_[kNumInputs];
+
+    //! files for sorted runs of each input
+    std::deque<data::File> files_[kNumInputs];
+
+    //! readers of the sorted runs while merging
+    std::vector<data::File::Reader> seqs_[kNumInputs];
+
+    //! Register Parent PreOp Hooks, instantiated and called for each parent
+    class RegisterParent
+    {
+    public:
+        explicit RegisterParent(MultiwayJoinNode* node) : node_(node) { }
+
+        template <typename Index, typename Parent>
+        void operator () (const Index&, Parent& parent) {
+
+            using Input = InputN<Index::index>;
+
+            static_assert(
+                std::is_convertible<typename Parent::ValueType, Input>::value,
+                "JoinFunction argument does not match input DIA");
+
+            static_assert(
+                std::is_convertible<
+                    typename common::FunctionTraits<
+                        KeyExtractorN<Index::index> >::result_type,
+                    Key>::value,
+                "Keys have different types");
+
+            MultiwayJoinNode* node = node_;
+            auto pre_op_fn = [node](const Input& input) {
+                                 size_t hash = node->hash_function_(
+                                     node->GetKey<Index::index>(input));
+                                 node->hash_writers_[Index::index][
+                                     hash % node->context_.num_workers()]
+                                 .Put(input);
+                             };
+
+            // close the function stacks with our pre ops and register it at
+            // parent nodes for output
+            auto lop_chain = parent.stack().push(pre_op_fn).fold();
+            parent.node()->AddChild(node_, lop_chain, Index::index);
+        }
+
+    private:
+        MultiwayJoinNode* node_;
+    };
+
+    //! extract the key of an item of input Index
+    template <size_t Index>
+    Key GetKey(const InputN<Index>& item) const {
+        return std::get<Index>(key_extractors_)(item);
+    }
+
+    //! Receive the items of all inputs and write them to sorted runs.
+    void MainOp() {
+        tlx::call_for_range<kNumInputs>(
+            [&](auto index) {
+                (void)index;
+                this->ReceiveItems<decltype(index)::index>();
+            });
+    }
+
+    /*!
+     * Receive all items of input Index from its stream and write them to
+     * files sorted by key.
+     */
+    template <size_t Index>
+    void ReceiveItems() {
+        using ItemType = InputN<Index>;
+
+        data::MixStream::MixReader reader =
+            streams_[Index]->GetMixReader(/* consume */ true);
+
+        size_t capacity = DIABase::mem_limit_ / sizeof(ItemType) / 2;
+
+        std::vector<ItemType> vec;
+        vec.reserve(capacity);
+
+        while (reader.HasNext()) {
+            if (vec.size() < capacity) {
+                vec.push_back(reader.template Next<ItemType>());
+            }
+            else {
+                SortAndWriteToFile<Index>(vec);
+            }
+        }
+
+        if (vec.size())
+            SortAndWriteToFile<Index>(vec);
+
+        sLOG << "MultiwayJoin() input" << Index
+             << "runs" << files_[Index].size();
+    }
+
+    /*!
+     * Sorts all items of input Index in a vector and writes them to a file.
+     */
+    template <size_t Index>
+    void SortAndWriteToFile(std::vector<InputN<Index> >& vec) {
+        using ItemType = InputN<Index>;
+
+        // advise block pool to write out data if necessary
+        context_.block_pool().AdviseFree(vec.size() * sizeof(ItemType));
+
+        std::sort(vec.begin(), vec.end(),
+                  KeyCompare<Index>(std::get<Index>(key_extractors_)));
+
+        files_[Index].emplace_back(context_.GetFile(this));
+        auto writer = files_[Index].back().GetWriter();
+        for (const ItemType& elem : vec) {
+            writer.Put(elem);
+        }
+        writer.Close();
+
+        vec.clear();
+    }
+
+    /*!
+     * Merge the runs of input Index when there are too many for the merge
+     * tree. The merge trees of all inputs are open at the same time, hence
+     * each gets an equal share of the merge degree.
+     */
+    template <size_t Index>
+    void MergeFiles() {
+        using ItemType = InputN<Index>;
+        std::deque<data::File>& files = files_[Index];
+
+        size_t merge_degree, prefetch;
+
+        // merge batches of files if necessary
+        while (true) {
+            std::tie(merge_degree, prefetch) =
+                context_.block_pool().MaxMergeDegreePrefetch(
+                    kNumInputs * files.size());
+            merge_degree = std::max<size_t>(2, merge_degree / kNumInputs);
+            if (files.size() <= merge_degree) break;
+
+            sLOG1 << "Partial multi-way-merge of"
+                  << merge_degree << "files with prefetch" << prefetch;
+
+            // create merger for first merge_degree_ Files
+            std::vector<data::File::ConsumeReader> seq;
+            seq.reserve(merge_degree);
+
+            for (size_t t = 0; t < merge_degree; ++t)
+                seq.emplace_back(files[t].GetConsumeReader(/* prefetch */ 0));
+
+            StartPrefetch(seq, prefetch / kNumInputs);
+
+            auto puller = core::make_multiway_merge_tree<ItemType>(
+                seq.begin(), seq.end(),
+                KeyCompare<Index>(std::get<Index>(key_extractors_)));
+
+            // create new File for merged items
+            files.emplace_back(context_.GetFile(this));
+            auto writer = files.back().GetWriter();
+
+            while (puller.HasNext()) {
+                writer.Put(puller.Next());
+            }
+            writer.Close();
+
+            // this clear is important to release references to the files.
+            seq.clear();
+
+            // remove merged files
+            files.erase(files.begin(), files.begin() + merge_degree);
+        }
+    }
+
+    //! construct merge tree over the sorted runs of input Index
+    template <size_t Index>
+    std::unique_ptr<Puller<Index> > MakePuller(bool consume) {
+        std::deque<data::File>& files = files_[Index];
+        std::vector<data::File::Reader>& seq = seqs_[Index];
+
+        size_t merge_degree, prefetch;
+        std::tie(merge_degree, prefetch) =
+            context_.block_pool().MaxMergeDegreePrefetch(
+                kNumInputs * files.size());
+
+        seq.clear();
+        seq.reserve(files.size());
+        for (size_t t = 0; t < files.size(); ++t)
+            seq.emplace_back(files[t].GetReader(consume, /* prefetch */ 0));
+        StartPrefetch(seq, prefetch / kNumInputs);
+
+        return std::make_unique<Puller<Index> >(
+            seq.begin(), seq.end(),
+            KeyCompare<Index>(std::get<Index>(key_extractors_)));
+    }
+
+    //! Join item of the last input with all combinations of the groups,
+    //! after the items of all groups were selected.
+    template <typename Groups, typename... Items>
+    void JoinProduct(std::true_type, const Groups& /* groups */,
+                     const InputN<kLast>& item, size_t& result_count,
+                     const Items& ... items) {
+        this->PushItem(join_function_(items ..., item));
+        ++result_count;
+    }
+
+    //! Select each item of the next group and recurse.
+    template <typename Groups, typename... Items>
+    void JoinProduct(std::false_type, const Groups& groups,
+                     const InputN<kLast>& item, size_t& result_count,
+                     const Items& ... items) {
+        static constexpr size_t Index = sizeof ... (Items);
+        for (const InputN<Index>& next : std::get<Index>(groups)) {
+            JoinProduct(std::integral_constant<bool, Index + 2 == kNumInputs>(),
+                        groups, item, result_count, items ..., next);
+        }
+    }
+};
+
+/*!
+ * Performs an inner join of three or more DIAs on the same key in a single
+ * shuffle. The key of each item is extracted with the key extractor of its
+ * DIA, and all combinations of items with equal keys from all DIAs are joined
+ * with the join function, which takes one item of each DIA as arguments.
+ *
+ * This replaces a chain of two-way InnerJoin() calls, each of which shuffles
+ * the intermediate result of the previous one.
+ *
+ * \code
+ * auto joined = InnerJoin(std::make_tuple(dia1, dia2, dia3),
+ *                         std::make_tuple(key1, key2, key3), join_fn);
+ * \endcode
+ *
+ * \param dias std::tuple of the DIAs to join.
+ *
+ * \param key_extractors std::tuple of the key extractors of the DIAs, all
+ * returning the same key type.
+ *
+ * \param join_function Join function applied to all combinations of items with
+ * equal keys, the equal-key groups of all but the last DIA are kept in memory.
+ *
+ * \param hash_function If necessary a hash funtion for Key
+ *
+ * \ingroup dia_dops_free
+ */
+template <
+    typename... DIAs,
+    typename... KeyExtractors,
+    typename JoinFunction,
+    typename HashFunction = common::HashDefault<
+        typename common::FunctionTraits<
+            typename std::tuple_element<
+                0, std::tuple<KeyExtractors...> >::type>::result_type> >
+auto InnerJoin(
+    const std::tuple<DIAs...>& dias,
+    const std::tuple<KeyExtractors...>& key_extractors,
+    const JoinFunction& join_function,
+    const HashFunction& hash_function = HashFunction()) {
+
+    static constexpr size_t kNumInputs = sizeof ... (DIAs);
+
+    static_assert(sizeof ... (KeyExtractors) == kNumInputs,
+                  "InnerJoin requires one key extractor per DIA");
+
+    static_assert(common::FunctionTraits<JoinFunction>::arity == kNumInputs,
+                  "JoinFunction requires one argument per DIA");
+
+    using JoinResult
+        = typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using MultiwayJoinNode = api::MultiwayJoinNode<
+        JoinResult, std::tuple<KeyExtractors...>, JoinFunction,
+        HashFunction, kNumInputs>;
+
+    auto node = tlx::apply_tuple(
+        [&](const DIAs& ... parents) {
+            return tlx::make_counting<MultiwayJoinNode>(
+                key_extractors, join_function, hash_function, parents ...);
+        }, dias);
+
+    return DIA<JoinResult>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_MULTIWAY_JOIN_HEADER
+
+/******************************************************************************/
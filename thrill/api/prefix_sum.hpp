@@ -18,6 +18,8 @@
 #include <thrill/common/logger.hpp>
 #include <thrill/data/file.hpp>
 
+#include <future>
+
 namespace thrill {
 namespace api {
 
@@ -79,18 +81,31 @@ public:
 
     void StopPreOp(size_t /* parent_index */) final {
         writer_.Close();
+
+        // one prefix sum is pushed for each item of the parent
+        const KnownSize& parent_size = this->parent_known_size(0);
+        if (parent_stack_empty_ && parent_size.known())
+            this->set_known_size(parent_size.total, parent_size.balanced);
+
+        // the local sum is complete: start the prefix sum collective, which
+        // runs in the background until Execute() needs it.
+        StartPrefixSum();
     }
 
     //! Executes the prefixsum operation.
     void Execute() final {
         LOG << "MainOp processing";
 
-        local_sum_ = context_.net.ExPrefixSum(
-            local_sum_, sum_function_, initial_element_);
+        if (!prefix_future_.valid())
+            StartPrefixSum();
+        local_sum_ = prefix_future_.get();
     }
 
     void PushData(bool consume) final {
-        data::File::Reader reader = file_.GetReader(consume);
+        // read ahead as far as RAM allows, such that spilled Blocks are read
+        // while the items of those in memory are pushed.
+        data::File::Reader reader =
+            file_.GetReader(consume, data::File::auto_prefetch_size_);
         size_t num_items = file_.num_items();
 
         if (Inclusive) {
@@ -127,6 +142,14 @@ private:
     data::File file_ { context_.GetFile(this) };
     //! Data writer to local file (only active in PreOp).
     data::File::Writer writer_ { file_.GetWriter() };
+
+    //! future of the exclusive prefix sum of local_sum_
+    std::shared_future<ValueType> prefix_future_;
+
+    void StartPrefixSum() {
+        prefix_future_ = context_.net.ExPrefixSumAsync(
+            local_sum_, sum_function_, initial_element_);
+    }
 };
 
 template <typename ValueType, typename Stack>
@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * thrill/api/progress_reporter.cpp
+ *
+ * Aggregates the progress of the running stage of all hosts on host 0.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/progress_reporter.hpp>
+
+#include <tlx/string/format_si_iec_units.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace thrill {
+namespace api {
+
+ProgressReporter::ProgressReporter(HostContext& host_context)
+    : host_context_(host_context),
+      start_(std::chrono::steady_clock::now()) {
+    if (host_context_.host_rank() == 0) {
+        reports_.resize(host_context_.net_manager().num_hosts());
+        host_context_.data_multiplexer().set_progress_callback(
+            data::Multiplexer::ProgressCallback::make<
+                ProgressReporter, & ProgressReporter::OnReport>(this));
+    }
+}
+
+ProgressReporter::~ProgressReporter() {
+    if (host_context_.host_rank() == 0)
+        host_context_.data_multiplexer().set_progress_callback();
+}
+
+ProgressReporter::Report ProgressReporter::LocalReport(const char** label) {
+    Report r;
+    r.sender_host = static_cast<uint32_t>(host_context_.host_rank());
+
+    // the local workers run the same stages, sum the workers in the phase of
+    // the first one which reports.
+    bool total_known = true;
+    for (size_t w = 0; w < host_context_.workers_per_host(); ++w) {
+        const HostContext::StageProgress& p = host_context_.stage_progress(w);
+        size_t dia_id = p.progress_dia_id.load(std::memory_order_relaxed);
+        if (dia_id == 0) continue;
+
+        if (r.dia_id == 0) {
+            r.dia_id = static_cast<uint32_t>(dia_id);
+            r.phase = p.progress_phase.load(std::memory_order_relaxed);
+            *label = p.progress_label.load(std::memory_order_relaxed);
+        }
+        else if (r.dia_id != dia_id ||
+                 r.phase != p.progress_phase.load(std::memory_order_relaxed)) {
+            total_known = false;
+            continue;
+        }
+
+        uint64_t total = p.progress_total_items.load(std::memory_order_relaxed);
+        if (total == 0) total_known = false;
+
+        r.items += p.progress_items.load(std::memory_order_relaxed);
+        r.bytes += p.progress_bytes.load(std::memory_order_relaxed);
+        r.total_items += total;
+    }
+    if (!total_known) r.total_items = 0;
+    return r;
+}
+
+void ProgressReporter::OnReport(const Report& report) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (report.sender_host < reports_.size())
+        reports_[report.sender_host] = report;
+}
+
+//! format seconds as 1h02m03s
+static std::string FormatDuration(double seconds) {
+    uint64_t s = static_cast<uint64_t>(seconds + 0.5);
+    std::ostringstream oss;
+    if (s >= 3600)
+        oss << s / 3600 << 'h' << std::setw(2) << std::setfill('0');
+    if (s >= 60)
+        oss << (s / 60) % 60 << 'm' << std::setw(2) << std::setfill('0');
+    oss << s % 60 << 's';
+    return oss.str();
+}
+
+void ProgressReporter::RunTask(
+    const std::chrono::steady_clock::time_point& tp) {
+
+    const char* label = nullptr;
+    Report local = LocalReport(&label);
+
+    if (host_context_.host_rank() != 0) {
+        host_context_.data_multiplexer().SendProgress(local);
+        return;
+    }
+
+    uint32_t dia_id;
+    uint8_t phase;
+    uint64_t items = 0, bytes = 0, total_items = 0;
+    size_t hosts = 0;
+    bool total_known = true;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        reports_[0] = local;
+
+        // follow the phase of host 0, or of any other host once host 0 is idle
+        const Report* key = nullptr;
+        for (const Report& r : reports_) {
+            if (r.dia_id != 0) {
+                key = &r;
+                break;
+            }
+        }
+        if (key == nullptr) return;
+
+        dia_id = key->dia_id;
+        phase = key->phase;
+        if (key != &reports_[0]) label = nullptr;
+
+        for (const Report& r : reports_) {
+            if (r.dia_id != dia_id || r.phase != phase) continue;
+            ++hosts;
+            items += r.items;
+            bytes += r.bytes;
+            total_items += r.total_items;
+            if (r.total_items == 0) total_known = false;
+        }
+        // the total is only known once all hosts report the phase
+        if (hosts != reports_.size()) total_known = false;
+    }
+    if (!total_known) total_items = 0;
+
+    double seconds =
+        std::chrono::duration_cast<std::chrono::duration<double> >(
+            tp - start_).count();
+    estimator_.Update(
+        seconds, (uint64_t(dia_id) << 8) | phase, items, total_items);
+
+    const char* phase_name = ProgressPhaseName(static_cast<ProgressPhase>(phase));
+
+    host_context_.logger_
+        << "class" << "Progress"
+        << "event" << "report"
+        << "dia_id" << dia_id
+        << "phase" << phase_name
+        << "hosts" << hosts
+        << "items" << items
+        << "bytes" << bytes
+        << "total_items" << total_items
+        << "rate" << estimator_.rate()
+        << "eta" << estimator_.eta();
+
+    std::ostringstream oss;
+    oss << "Thrill: progress " << (label ? label : "DIA") << '.' << dia_id
+        << ' ' << phase_name
+        << " on " << hosts << '/' << reports_.size() << " hosts: ";
+    if (estimator_.fraction() >= 0) {
+        oss << std::fixed << std::setprecision(1)
+            << estimator_.fraction() * 100.0 << "% of "
+            << tlx::format_si_units(total_items) << " items";
+    }
+    else {
+        oss << tlx::format_si_units(items) << " items";
+    }
+    if (bytes != 0)
+        oss << ", " << tlx::format_iec_units(bytes) << 'B';
+    oss << ", " << tlx::format_si_units(
+        static_cast<uint64_t>(estimator_.rate())) << " items/s";
+    if (estimator_.eta() >= 0)
+        oss << ", ETA " << FormatDuration(estimator_.eta());
+    std::cerr << oss.str() << std::endl;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
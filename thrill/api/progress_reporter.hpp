@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * thrill/api/progress_reporter.hpp
+ *
+ * Aggregates the progress of the running stage of all hosts on host 0.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_PROGRESS_REPORTER_HEADER
+#define THRILL_API_PROGRESS_REPORTER_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/common/profile_task.hpp>
+#include <thrill/common/progress_estimator.hpp>
+#include <thrill/data/multiplexer_header.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \ingroup api_layer
+//! \{
+
+/*!
+ * ProfileTask which sums the progress reported by the local workers' DIA nodes,
+ * see Context::StartProgress(). All hosts except host 0 send their sum to host
+ * 0 as an out-of-band Multiplexer message, and host 0 combines the reports of
+ * the phase it runs, logs them as "Progress" events, and prints the progress
+ * and an estimate of the time remaining.
+ */
+class ProgressReporter final : public common::ProfileTask
+{
+public:
+    explicit ProgressReporter(HostContext& host_context);
+
+    //! non-copyable: delete copy-constructor
+    ProgressReporter(const ProgressReporter&) = delete;
+    //! non-copyable: delete assignment operator
+    ProgressReporter& operator = (const ProgressReporter&) = delete;
+
+    //! unregisters from the Multiplexer
+    ~ProgressReporter();
+
+    void RunTask(const std::chrono::steady_clock::time_point& tp) final;
+
+private:
+    using Report = data::ProgressMultiplexerHeader;
+
+    //! HostContext of the workers
+    HostContext& host_context_;
+
+    //! time of construction, the origin of the estimator's clock
+    std::chrono::steady_clock::time_point start_;
+
+    //! last report of each host, only on host 0
+    std::vector<Report> reports_;
+
+    //! protects reports_
+    std::mutex mutex_;
+
+    //! throughput and time remaining of the phase
+    common::ProgressEstimator estimator_;
+
+    //! sum the progress of the local workers
+    Report LocalReport(const char** label);
+
+    //! receive a report from another host
+    void OnReport(const Report& report);
+};
+
+//! \}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_PROGRESS_REPORTER_HEADER
+
+/******************************************************************************/
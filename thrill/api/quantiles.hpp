@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * thrill/api/quantiles.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_QUANTILES_HEADER
+#define THRILL_API_QUANTILES_HEADER
+
+#include <thrill/api/action_node.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/core/kll_sketch.hpp>
+
+#include <functional>
+#include <type_traits>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A ActionNode which builds an approximate quantile sketch of a DIA. Each
+ * worker inserts its items into a local core::KllSketch, and the sketches are
+ * merged in a single AllReduce collective, without exchanging the items.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename CompareFunction>
+class QuantilesNode final
+    : public ActionResultNode<core::KllSketch<ValueType, CompareFunction> >
+{
+    static constexpr bool debug = false;
+
+    using Sketch = core::KllSketch<ValueType, CompareFunction>;
+    using Super = ActionResultNode<Sketch>;
+    using Super::context_;
+
+public:
+    template <typename ParentDIA>
+    QuantilesNode(const ParentDIA& parent, size_t sketch_size,
+                  const CompareFunction& compare_function)
+        : Super(parent.ctx(), "Quantiles", { parent.id() }, { parent.node() }),
+          sketch_(sketch_size, compare_function) {
+        // Hook PreOp(s)
+        auto pre_op_fn = [this](const ValueType& input) {
+                             sketch_.insert(input);
+                         };
+
+        auto lop_chain = parent.stack().push(pre_op_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    //! Executes the quantiles operation.
+    void Execute() final {
+        LOG << "Quantiles() local sketch " << sketch_.size()
+            << " of " << sketch_.num_items() << " items";
+
+        sketch_ = context_.net.AllReduce(
+            sketch_, [](const Sketch& a, const Sketch& b) { return a + b; });
+    }
+
+    //! Returns the merged sketch of all items.
+    const Sketch& result() const final { return sketch_; }
+
+private:
+    //! local, and after Execute() global, sketch
+    Sketch sketch_;
+};
+
+template <typename ValueType, typename Stack>
+template <typename CompareFunction>
+core::KllSketch<ValueType, CompareFunction>
+DIA<ValueType, Stack>::Quantiles(
+    size_t sketch_size, const CompareFunction& compare_function) const {
+    assert(IsValid());
+
+    using QuantilesNode = api::QuantilesNode<ValueType, CompareFunction>;
+
+    static_assert(
+        std::is_default_constructible<CompareFunction>::value,
+        "CompareFunction must be default-constructible to transmit sketches");
+
+    auto node = tlx::make_counting<QuantilesNode>(
+        *this, sketch_size, compare_function);
+
+    node->RunScope();
+
+    return node->result();
+}
+
+template <typename ValueType, typename Stack>
+template <typename CompareFunction>
+Future<core::KllSketch<ValueType, CompareFunction> >
+DIA<ValueType, Stack>::QuantilesFuture(
+    size_t sketch_size, const CompareFunction& compare_function) const {
+    assert(IsValid());
+
+    using QuantilesNode = api::QuantilesNode<ValueType, CompareFunction>;
+
+    static_assert(
+        std::is_default_constructible<CompareFunction>::value,
+        "CompareFunction must be default-constructible to transmit sketches");
+
+    auto node = tlx::make_counting<QuantilesNode>(
+        *this, sketch_size, compare_function);
+
+    return Future<core::KllSketch<ValueType, CompareFunction> >(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_QUANTILES_HEADER
+
+/******************************************************************************/
@@ -13,11 +13,15 @@
 #ifndef THRILL_API_READ_BINARY_HEADER
 #define THRILL_API_READ_BINARY_HEADER
 
+#include <thrill/api/binary_index.hpp>
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
+#include <thrill/api/distributed_glob.hpp>
 #include <thrill/api/source_node.hpp>
+#include <thrill/api/source_stealer.hpp>
 #include <thrill/common/item_serialization_tools.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/system_exception.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/data/block_reader.hpp>
 #include <thrill/net/buffer_builder.hpp>
@@ -27,8 +31,12 @@
 #include <tlx/string/join.hpp>
 #include <tlx/vector_free.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <limits>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -80,10 +88,14 @@ public:
         std::numeric_limits<uint64_t>::max();
 
     ReadBinaryNode(Context& ctx, const std::vector<std::string>& globlist,
-                   uint64_t size_limit, bool local_storage)
-        : Super(ctx, "ReadBinary") {
+                   uint64_t size_limit, bool local_storage,
+                   double sample_rate = 1.0)
+        : Super(ctx, "ReadBinary"), sample_rate_(sample_rate) {
+
+        assert(sample_rate >= 0.0 && sample_rate <= 1.0);
 
-        vfs::FileList files = vfs::Glob(globlist, vfs::GlobType::File);
+        vfs::FileList files =
+            DistributedGlob(ctx, globlist, vfs::GlobType::File);
 
         if (files.size() == 0)
             die("ReadBinary: no files found in globs: " + tlx::join(' ', globlist));
@@ -111,7 +123,7 @@ public:
             }
             else {
                 my_range = context_.CalculateLocalRange(
-                    files.total_size / fixed_size_);
+                    files, files.total_size / fixed_size_, fixed_size_);
             }
 
             my_range.begin *= fixed_size_;
@@ -120,36 +132,44 @@ public:
             sLOG << "ReadBinaryNode:" << ctx.num_workers()
                  << "my_range" << my_range;
 
-            size_t i = 0;
-            while (i < files.size() &&
-                   files[i].size_inc_psum() <= my_range.begin) {
-                i++;
+            if ((files.contains_remote_uri || debug_no_extfile) &&
+                SourceStealer::Enabled(context_)) {
+                // read the range in chunks, which may be stolen, in PushData
+                steal_files_ = files;
+                steal_range_ = common::Range(
+                    my_range.begin / fixed_size_, my_range.end / fixed_size_);
+                steal_local_storage_ = local_storage;
+                use_steal_ = true;
+                return;
             }
 
-            for ( ; i < files.size() &&
-                  files.size_ex_psum(i) <= my_range.end; ++i) {
-
-                size_t file_begin = files.size_ex_psum(i);
-                size_t file_end = files.size_inc_psum(i);
-                size_t file_size = files[i].size;
-
-                FileInfo fi;
-                fi.path = files[i].path;
-                fi.range = common::Range(
-                    my_range.begin <= file_begin ? 0 : my_range.begin - file_begin,
-                    my_range.end >= file_end ? file_size : my_range.end - file_begin);
-                fi.is_compressed = false;
-
-                sLOG << "ReadBinary: fileinfo"
-                     << "path" << fi.path << "range" << fi.range;
-
-                if (fi.range.begin == fi.range.end) continue;
-
+            for (const FileInfo& fi : SplitRange(files, my_range)) {
                 if (files.contains_remote_uri || debug_no_extfile) {
                     // push file and range into file list for remote files
                     // (these cannot be mapped using the io layer)
                     my_files_.push_back(fi);
                 }
+                else if (context_.mem_config().enable_mmap_read_binary_) {
+                    // map blocks into a File using mmap(), which avoids
+                    // copying the data into allocated ByteBlocks.
+
+                    int fd = ::open(fi.path.c_str(), O_RDONLY);
+                    if (fd < 0) {
+                        throw common::ErrnoException(
+                                  "ReadBinary: cannot open file " + fi.path);
+                    }
+
+                    AppendBlocks(
+                        fi.range, [&](size_t off, size_t bsize) {
+                            return context_.block_pool().MmapExternalBlock(
+                                fd, off, bsize);
+                        });
+
+                    // the mappings remain valid after closing the file
+                    ::close(fd);
+
+                    use_ext_file_ = true;
+                }
                 else {
                     // new method: map blocks into a File using io layer
 
@@ -158,30 +178,11 @@ public:
                             fi.path,
                             foxxll::file::RDONLY | foxxll::file::NO_LOCK);
 
-                    size_t item_off = 0;
-
-                    for (size_t off = fi.range.begin; off < fi.range.end;
-                         off += data::default_block_size) {
-
-                        size_t bsize = std::min(
-                            off + data::default_block_size, fi.range.end) - off;
-
-                        data::ByteBlockPtr bbp =
-                            context_.block_pool().MapExternalBlock(
+                    AppendBlocks(
+                        fi.range, [&](size_t off, size_t bsize) {
+                            return context_.block_pool().MapExternalBlock(
                                 file, off, bsize);
-
-                        size_t item_num =
-                            (bsize - item_off + fixed_size_ - 1) / fixed_size_;
-
-                        data::Block block(
-                            std::move(bbp), 0, bsize, item_off, item_num,
-                            /* typecode_verify */ false);
-
-                        item_off += item_num * fixed_size_ - bsize;
-
-                        LOG << "ReadBinary: adding Block " << block;
-                        ext_file_.AppendBlock(std::move(block));
-                    }
+                        });
 
                     use_ext_file_ = true;
                 }
@@ -189,51 +190,43 @@ public:
         }
         else
         {
-            // split filelist by whole files.
-            size_t i = 0;
-
-            common::Range my_range;
-
-            if (local_storage) {
-                my_range = context_.CalculateLocalRangeOnHost(
-                    files.total_size);
-            }
-            else {
-                my_range = context_.CalculateLocalRange(files.total_size);
-            }
-
-            while (i < files.size() &&
-                   files[i].size_inc_psum() <= my_range.begin) {
-                i++;
-            }
+            // read the BinaryIndex footers of uncompressed files written by
+            // WriteBinary, which are not part of the items.
+            std::vector<BinaryIndex> indexes(files.size());
+            bool all_indexed = true;
 
-            while (i < files.size() &&
-                   files[i].size_inc_psum() <= my_range.end) {
-                my_files_.push_back(
-                    FileInfo { files[i].path,
-                               common::Range(0, std::numeric_limits<size_t>::max()),
-                               files[i].IsCompressed() });
-                i++;
+            for (size_t i = 0; i < files.size(); ++i) {
+                if (files[i].IsCompressed() ||
+                    !indexes[i].Read(files[i].path, files[i].size))
+                    all_indexed = false;
             }
 
-            sLOG << "ReadBinary:" << my_files_.size() << "files,"
-                 << "my_range" << my_range;
+            if (all_indexed)
+                SplitByIndex(files, indexes, size_limit, local_storage);
+            else
+                SplitByFiles(files, indexes, local_storage);
         }
     }
 
     ReadBinaryNode(Context& ctx, const std::string& glob, uint64_t size_limit,
-                   bool local_storage)
+                   bool local_storage, double sample_rate = 1.0)
         : ReadBinaryNode(ctx, std::vector<std::string>{ glob }, size_limit,
-                         local_storage) { }
+                         local_storage, sample_rate) { }
 
     void PushData(bool consume) final {
         LOG << "ReadBinaryNode::PushData() start " << *this
             << " consume=" << consume
             << " use_ext_file_=" << use_ext_file_;
 
+        if (sample_rate_ < 1.0)
+            return PushSample(consume);
+
         if (use_ext_file_)
             return this->PushFile(ext_file_, consume);
 
+        if (use_steal_)
+            return PushStealing();
+
         // Hook Read
         for (const FileInfo& file : my_files_) {
             LOG << "ReadBinaryNode::PushData() opening " << file.path;
@@ -256,10 +249,95 @@ public:
 
     void Dispose() final {
         tlx::vector_free(my_files_);
+        steal_files_ = vfs::FileList();
         ext_file_.Clear();
     }
 
 private:
+    //! probability of each item to be pushed, 1.0 pushes all items.
+    double sample_rate_;
+
+    //! random generator for sampling
+    std::default_random_engine rng_ { std::random_device { } () };
+
+    //! push a Bernoulli sample of the items. The number of items to skip until
+    //! the next sample is drawn from a geometric distribution. Fixed size items
+    //! are skipped without deserializing them, and the mapped Blocks of the
+    //! ext_file_ lying entirely between two samples are not even read.
+    void PushSample(bool consume) {
+        if (sample_rate_ <= 0.0) {
+            if (consume) ext_file_.Clear();
+            return;
+        }
+
+        std::geometric_distribution<size_t> gap_dist(sample_rate_);
+
+        if (use_ext_file_) {
+            const size_t total = ext_file_.num_items();
+
+            // number of items, beyond which seeking to the next sample is
+            // cheaper than reading through the Blocks in between.
+            const size_t block_items =
+                std::max(data::default_block_size / fixed_size_, size_t(1));
+
+            size_t index = gap_dist(rng_);
+            while (index < total) {
+                data::File::KeepReader reader =
+                    ext_file_.GetReaderAt<ValueType>(index, /* prefetch */ 0);
+
+                while (true) {
+                    this->PushItem(reader.template NextNoSelfVerify<ValueType>());
+
+                    size_t gap = gap_dist(rng_);
+                    index += gap + 1;
+                    if (index >= total || gap >= block_items) break;
+                    reader.Skip(gap, gap * fixed_size_);
+                }
+            }
+            if (consume) ext_file_.Clear();
+        }
+        else {
+            for (const FileInfo& file : my_files_) {
+                VfsFileBlockReader br(
+                    VfsFileBlockSource(file, context_,
+                                       stats_total_bytes, stats_total_reads));
+
+                size_t gap = gap_dist(rng_);
+
+                if (is_fixed_size_ && !file.is_compressed) {
+                    // the stream is read, but skipped items are not
+                    // deserialized.
+                    size_t remain = file.range.size() / fixed_size_;
+                    while (gap < remain) {
+                        br.Skip(gap, gap * fixed_size_);
+                        this->PushItem(br.template NextNoSelfVerify<ValueType>());
+                        remain -= gap + 1;
+                        gap = gap_dist(rng_);
+                    }
+                    continue;
+                }
+
+                while (br.HasNext()) {
+                    if (gap == 0) {
+                        this->PushItem(br.template NextNoSelfVerify<ValueType>());
+                        gap = gap_dist(rng_);
+                    }
+                    else {
+                        br.template NextNoSelfVerify<ValueType>();
+                        --gap;
+                    }
+                }
+            }
+        }
+
+        Super::logger_
+            << "class" << "ReadBinaryNode"
+            << "event" << "sampled"
+            << "sample_rate" << sample_rate_
+            << "total_bytes" << stats_total_bytes
+            << "total_reads" << stats_total_reads;
+    }
+
     //! list of files for non-mapped File push
     std::vector<FileInfo> my_files_;
 
@@ -267,9 +345,227 @@ private:
     bool use_ext_file_ = false;
     data::File ext_file_ { context_.GetFile(this) };
 
+    //! whether to read the files in chunks, which workers may steal
+    bool use_steal_ = false;
+    //! all files, of which the chunks are read
+    vfs::FileList steal_files_;
+    //! range of items read by the local worker, unless they are stolen
+    common::Range steal_range_;
+    //! whether the range is one of the files on the local host
+    bool steal_local_storage_ = false;
+
     size_t stats_total_bytes = 0;
     size_t stats_total_reads = 0;
 
+    //! Blocks per chunk into which SourceStealer splits the local ranges
+    static constexpr size_t blocks_per_steal_chunk_ = 16;
+
+    //! the parts of the files in the global byte range
+    static std::vector<FileInfo> SplitRange(
+        const vfs::FileList& files, const common::Range& range) {
+        std::vector<FileInfo> result;
+
+        size_t i = 0;
+        while (i < files.size() &&
+               files[i].size_inc_psum() <= range.begin) {
+            i++;
+        }
+
+        for ( ; i < files.size() &&
+              files.size_ex_psum(i) <= range.end; ++i) {
+
+            size_t file_begin = files.size_ex_psum(i);
+            size_t file_end = files.size_inc_psum(i);
+            size_t file_size = files[i].size;
+
+            FileInfo fi;
+            fi.path = files[i].path;
+            fi.range = common::Range(
+                range.begin <= file_begin ? 0 : range.begin - file_begin,
+                range.end >= file_end ? file_size : range.end - file_begin);
+            fi.is_compressed = false;
+
+            sLOG << "ReadBinary: fileinfo"
+                 << "path" << fi.path << "range" << fi.range;
+
+            if (fi.range.begin == fi.range.end) continue;
+
+            result.push_back(fi);
+        }
+        return result;
+    }
+
+    //! read the fixed size items of the chunk of items and emit them
+    template <typename Emit>
+    void ReadChunk(const common::Range& chunk, const Emit& emit) {
+        common::Range bytes(chunk.begin * fixed_size_, chunk.end * fixed_size_);
+        for (const FileInfo& file : SplitRange(steal_files_, bytes)) {
+            VfsFileBlockReader br(
+                VfsFileBlockSource(file, context_,
+                                   stats_total_bytes, stats_total_reads));
+
+            while (br.HasNext()) {
+                emit(br.template NextNoSelfVerify<ValueType>());
+            }
+        }
+    }
+
+    //! read the local range in chunks, and let workers which are done read
+    //! the unread chunks of the slowest ones, see SourceStealer.
+    void PushStealing() {
+        SourceStealer stealer(
+            context_, steal_range_,
+            std::max<size_t>(
+                blocks_per_steal_chunk_ * data::default_block_size
+                / fixed_size_, 1),
+            steal_local_storage_);
+
+        stealer.Run<ValueType>(
+            this->dia_id(),
+            [this](const common::Range& chunk) {
+                ReadChunk(chunk, [this](const ValueType& item) {
+                              this->PushItem(item);
+                          });
+            },
+            [this](const common::Range& chunk, const auto& emit) {
+                ReadChunk(chunk, emit);
+            },
+            [this](const ValueType& item) {
+                this->PushItem(item);
+            });
+
+        Super::logger_
+            << "class" << "ReadBinaryNode"
+            << "event" << "done"
+            << "total_bytes" << stats_total_bytes
+            << "total_reads" << stats_total_reads;
+    }
+
+    //! split variable size items in the files at the first item of the
+    //! Blocks recorded in the indexes.
+    void SplitByIndex(const vfs::FileList& files,
+                      const std::vector<BinaryIndex>& indexes,
+                      uint64_t size_limit, bool local_storage) {
+
+        // global byte offsets of the first item of each block
+        std::vector<uint64_t> splits;
+        uint64_t data_total = 0;
+        for (const BinaryIndex& index : indexes) {
+            for (const BinaryIndex::Entry& e : index.entries)
+                splits.push_back(data_total + e.offset);
+            data_total += index.data_size;
+        }
+        splits.push_back(data_total);
+
+        // round the size limit up to the next split, which is at the end of
+        // an item.
+        uint64_t total = *std::lower_bound(
+            splits.begin(), splits.end(), std::min(data_total, size_limit));
+        splits.erase(std::upper_bound(splits.begin(), splits.end(), total),
+                     splits.end());
+
+        common::Range my_range;
+
+        if (local_storage) {
+            my_range = context_.CalculateLocalRangeOnHost(total);
+        }
+        else {
+            my_range = context_.CalculateLocalRange(files, total);
+        }
+
+        // the worker reads all items starting in its range.
+        uint64_t begin = *std::lower_bound(
+            splits.begin(), splits.end(), my_range.begin);
+        uint64_t end = *std::lower_bound(
+            splits.begin(), splits.end(), my_range.end);
+
+        uint64_t file_begin = 0;
+        for (size_t i = 0; i < files.size(); ++i) {
+            uint64_t file_end = file_begin + indexes[i].data_size;
+            uint64_t rbegin = std::max(begin, file_begin);
+            uint64_t rend = std::min(end, file_end);
+
+            if (rbegin < rend) {
+                my_files_.push_back(
+                    FileInfo { files[i].path,
+                               common::Range(rbegin - file_begin,
+                                             rend - file_begin),
+                               /* is_compressed */ false });
+            }
+            file_begin = file_end;
+        }
+
+        sLOG << "ReadBinary:" << my_files_.size() << "files,"
+             << "split by index, my_range" << my_range
+             << "items in [" << begin << "," << end << ")";
+    }
+
+    //! split the files by whole files, excluding their index footers.
+    void SplitByFiles(const vfs::FileList& files,
+                      const std::vector<BinaryIndex>& indexes,
+                      bool local_storage) {
+        size_t i = 0;
+
+        common::Range my_range;
+
+        if (local_storage) {
+            my_range = context_.CalculateLocalRangeOnHost(
+                files.total_size);
+        }
+        else {
+            my_range = context_.CalculateLocalRange(
+                files, files.total_size);
+        }
+
+        while (i < files.size() &&
+               files[i].size_inc_psum() <= my_range.begin) {
+            i++;
+        }
+
+        while (i < files.size() &&
+               files[i].size_inc_psum() <= my_range.end) {
+            my_files_.push_back(
+                FileInfo { files[i].path,
+                           common::Range(
+                               0, files[i].IsCompressed()
+                               ? std::numeric_limits<size_t>::max()
+                               : indexes[i].data_size),
+                           files[i].IsCompressed() });
+            i++;
+        }
+
+        sLOG << "ReadBinary:" << my_files_.size() << "files,"
+             << "my_range" << my_range;
+    }
+
+    //! split the byte range of a file into Blocks of fixed size items, which
+    //! are created by map_block(offset, size), and append them to ext_file_.
+    template <typename MapBlock>
+    void AppendBlocks(const common::Range& range, const MapBlock& map_block) {
+        size_t item_off = 0;
+
+        for (size_t off = range.begin; off < range.end;
+             off += data::default_block_size) {
+
+            size_t bsize = std::min(
+                off + data::default_block_size, range.end) - off;
+
+            data::ByteBlockPtr bbp = map_block(off, bsize);
+
+            size_t item_num =
+                (bsize - item_off + fixed_size_ - 1) / fixed_size_;
+
+            data::Block block(
+                std::move(bbp), 0, bsize, item_off, item_num,
+                /* typecode_verify */ false);
+
+            item_off += item_num * fixed_size_ - bsize;
+
+            LOG << "ReadBinary: adding Block " << block;
+            ext_file_.AppendBlock(std::move(block));
+        }
+    }
+
     class VfsFileBlockSource
     {
     public:
@@ -437,10 +733,63 @@ DIA<ValueType> ReadBinary(
     return DIA<ValueType>(node);
 }
 
+/*!
+ * ReadBinarySample is a DOp, which reads a Bernoulli sample of the items of
+ * files written by WriteBinary: each item is contained with probability
+ * sample_rate. Contrary to ReadBinary().BernoulliSample(), the reader jumps
+ * over the items between two samples. Fixed size items are not deserialized,
+ * and Blocks of uncompressed local files containing no sample are not read.
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param sample_rate Probability of each item to be sampled
+ * \param size_limit Optional limit to the total file size (e.g. for testing
+ * algorithms on prefixes)
+ *
+ * \ingroup dia_sources
+ */
+template <typename ValueType>
+DIA<ValueType> ReadBinarySample(
+    Context& ctx, const std::vector<std::string>& filepath, double sample_rate,
+    uint64_t size_limit = ReadBinaryNode<ValueType>::no_size_limit_) {
+
+    auto node = tlx::make_counting<ReadBinaryNode<ValueType> >(
+        ctx, filepath, size_limit, /* local_storage */ false, sample_rate);
+
+    return DIA<ValueType>(node);
+}
+
+/*!
+ * ReadBinarySample is a DOp, which reads a Bernoulli sample of the items of
+ * files written by WriteBinary: each item is contained with probability
+ * sample_rate. Contrary to ReadBinary().BernoulliSample(), the reader jumps
+ * over the items between two samples. Fixed size items are not deserialized,
+ * and Blocks of uncompressed local files containing no sample are not read.
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param sample_rate Probability of each item to be sampled
+ * \param size_limit Optional limit to the total file size (e.g. for testing
+ * algorithms on prefixes)
+ *
+ * \ingroup dia_sources
+ */
+template <typename ValueType>
+DIA<ValueType> ReadBinarySample(
+    Context& ctx, const std::string& filepath, double sample_rate,
+    uint64_t size_limit = ReadBinaryNode<ValueType>::no_size_limit_) {
+
+    auto node = tlx::make_counting<ReadBinaryNode<ValueType> >(
+        ctx, filepath, size_limit, /* local_storage */ false, sample_rate);
+
+    return DIA<ValueType>(node);
+}
+
 } // namespace api
 
 //! imported from api namespace
 using api::ReadBinary;
+using api::ReadBinarySample;
 
 } // namespace thrill
 
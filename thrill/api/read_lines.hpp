@@ -15,96 +15,97 @@
 
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
+#include <thrill/api/distributed_glob.hpp>
 #include <thrill/api/source_node.hpp>
+#include <thrill/api/source_stealer.hpp>
 #include <thrill/common/defines.hpp>
+#include <thrill/common/function_traits.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/porting.hpp>
 #include <thrill/common/string.hpp>
 #include <thrill/common/system_exception.hpp>
+#include <thrill/data/file.hpp>
 #include <thrill/net/buffer_builder.hpp>
+#include <thrill/vfs/bgzf_filter.hpp>
 #include <thrill/vfs/file_io.hpp>
 
+#include <tlx/container/string_view.hpp>
 #include <tlx/string/join.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace thrill {
 namespace api {
 
+//! MapFunction of ReadLinesNode which delivers the lines as std::string
+struct ReadLinesKeepString { };
+
 /*!
- * A DIANode which performs a line-based Read operation. Reads a file from the
- * file system and delivers it as a DIA.
+ * The input files of a ReadLinesNode and the iterators which deliver the lines
+ * of the local part of the files.
  *
  * \ingroup api_layer
  */
-class ReadLinesNode final : public SourceNode<std::string>
+class ReadLinesInput
 {
     static constexpr bool debug = false;
 
 public:
-    using Super = SourceNode<std::string>;
-    using Super::context_;
-
-    //! Constructor for a ReadLinesNode. Sets the Context and file path.
-    ReadLinesNode(Context& ctx, const std::vector<std::string>& globlist,
-                  bool local_storage)
-        : Super(ctx, "ReadLines"),
-          local_storage_(local_storage) {
+    //! Constructor for a ReadLinesInput. Globs the file paths, must be called
+    //! by all workers.
+    ReadLinesInput(Context& ctx, const std::vector<std::string>& globlist) {
 
-        filelist_ = vfs::Glob(globlist, vfs::GlobType::File);
+        filelist_ = DistributedGlob(ctx, globlist, vfs::GlobType::File);
 
         if (filelist_.size() == 0)
             die("ReadLines: no files found in globs: " + tlx::join(' ', globlist));
 
+        // BGZF files can be split at block boundaries like uncompressed files
+        if (filelist_.contains_compressed) {
+            bgzf_ = std::all_of(
+                filelist_.begin(), filelist_.end(),
+                [](const vfs::FileInfo& fi) { return vfs::IsBgzf(fi.path); });
+        }
+
         sLOG << "ReadLines: creating for" << globlist.size() << "globs"
              << "matching" << filelist_.size() << "files";
     }
 
-    //! Constructor for a ReadLinesNode. Sets the Context and file path.
-    ReadLinesNode(Context& ctx, const std::string& glob, bool local_storage)
-        : ReadLinesNode(ctx, std::vector<std::string>{ glob }, local_storage)
-    { }
-
-    DIAMemUse PushDataMemUse() final {
-        // InputLineIterators read files block-wise
-        return data::default_block_size;
-    }
-
-    void PushData(bool /* consume */) final {
-        if (filelist_.contains_compressed) {
-            InputLineIteratorCompressed it(
-                filelist_, *this, local_storage_);
+    //! input files with size prefixsum
+    const vfs::FileList& filelist() const { return filelist_; }
 
-            // Hook Read
-            while (it.HasNext()) {
-                this->PushItem(it.Next());
-            }
-        }
-        else {
-            InputLineIteratorUncompressed it(
-                filelist_, *this, local_storage_);
+    //! true, if all files are BGZF compressed
+    bool bgzf() const { return bgzf_; }
 
-            // Hook Read
-            while (it.HasNext()) {
-                this->PushItem(it.Next());
-            }
-        }
+    //! byte range of the files read by the local worker
+    static common::Range LocalRange(
+        const vfs::FileList& files, Context& context, bool local_storage) {
+        if (local_storage)
+            return context.CalculateLocalRangeOnHost(files.total_size);
+        return context.CalculateLocalRange(files, files.total_size);
     }
 
 private:
     vfs::FileList filelist_;
 
-    //! true, if files are on a local file system, false: common global file
-    //! system.
-    bool local_storage_;
+    //! true, if all files are BGZF compressed
+    bool bgzf_ = false;
 
+public:
     class InputLineIterator
     {
     public:
-        InputLineIterator(const vfs::FileList& files,
-                          ReadLinesNode& node)
-            : files_(files), node_(node) { }
+        InputLineIterator(const vfs::FileList& files, Context& context,
+                          common::JsonLogger& logger)
+            : files_(files), context_(context), logger_(logger) { }
 
         //! non-copyable: delete copy-constructor
         InputLineIterator(const InputLineIterator&) = delete;
@@ -131,8 +132,10 @@ private:
         unsigned char* current_;
         //! (exclusive) [begin,end) of local block
         common::Range my_range_;
-        //! Reference to node
-        ReadLinesNode& node_;
+        //! Context of the node
+        Context& context_;
+        //! Logger of the node
+        common::JsonLogger& logger_;
 
         common::StatsTimerStopped read_timer;
 
@@ -140,6 +143,33 @@ private:
         size_t total_reads_ = 0;
         size_t total_elements_ = 0;
 
+        //! find next newline in [begin,end) using memchr(), which is
+        //! vectorized by the C library. Returns nullptr if there is none.
+        static unsigned char * FindNewline(
+            unsigned char* begin, unsigned char* end) {
+            return static_cast<unsigned char*>(
+                memchr(begin, '\n', end - begin));
+        }
+
+        //! view of the bytes [begin,end)
+        static tlx::string_view MakeView(
+            const unsigned char* begin, const unsigned char* end) {
+            return tlx::string_view(
+                reinterpret_cast<const char*>(begin), end - begin);
+        }
+
+        //! append the bytes [begin,end) to data_
+        void Append(const unsigned char* begin, const unsigned char* end) {
+            data_.append(reinterpret_cast<const char*>(begin), end - begin);
+        }
+
+        //! return line as std::string, which is data_ or a copy into data_
+        const std::string& MakeString(const tlx::string_view& line) {
+            if (line.data() != data_.data())
+                data_.assign(line.data(), line.size());
+            return data_;
+        }
+
         bool ReadBlock(vfs::ReadStreamPtr& file,
                        net::BufferBuilder& buffer) {
             read_timer.Start();
@@ -157,7 +187,7 @@ private:
         }
 
         ~InputLineIterator() {
-            node_.logger_
+            logger_
                 << "class" << "ReadLinesNode"
                 << "event" << "done"
                 << "total_bytes" << total_bytes_
@@ -173,18 +203,23 @@ private:
     public:
         //! Creates an instance of iterator that reads file line based
         InputLineIteratorUncompressed(const vfs::FileList& files,
-                                      ReadLinesNode& node, bool local_storage)
-            : InputLineIterator(files, node) {
+                                      Context& context,
+                                      common::JsonLogger& logger,
+                                      bool local_storage)
+            : InputLineIteratorUncompressed(
+                  files, context, logger,
+                  LocalRange(files, context, local_storage)) { }
+
+        //! Creates an instance of iterator that reads the lines beginning in
+        //! the byte range of the files, e.g. a part of the local range.
+        InputLineIteratorUncompressed(const vfs::FileList& files,
+                                      Context& context,
+                                      common::JsonLogger& logger,
+                                      const common::Range& range)
+            : InputLineIterator(files, context, logger) {
 
             // Go to start of 'local part'.
-            if (local_storage) {
-                my_range_ = node_.context_.CalculateLocalRangeOnHost(
-                    files.total_size);
-            }
-            else {
-                my_range_ = node_.context_.CalculateLocalRange(
-                    files.total_size);
-            }
+            my_range_ = range;
 
             assert(my_range_.begin <= my_range_.end);
             if (my_range_.begin == my_range_.end) return;
@@ -214,11 +249,10 @@ private:
                 // find next newline, discard all previous data as previous
                 // worker already covers it
                 while (!found_n) {
-                    while (current_ < buffer_.end()) {
-                        if (TLX_UNLIKELY(*current_++ == '\n')) {
-                            found_n = true;
-                            break;
-                        }
+                    unsigned char* nl = FindNewline(current_, buffer_.end());
+                    if (nl != nullptr) {
+                        current_ = nl + 1;
+                        found_n = true;
                     }
                     // no newline found: read new data into buffer_builder
                     if (!found_n) {
@@ -237,18 +271,35 @@ private:
         //!
         //! does no checks whether a next element exists!
         const std::string& Next() {
+            return MakeString(NextView());
+        }
+
+        //! returns a view of the next element, which points into the read
+        //! buffer or data_ and is valid until the next call.
+        //!
+        //! does no checks whether a next element exists!
+        tlx::string_view NextView() {
             total_elements_++;
+
+            // fast path: line is contained in the current block
+            unsigned char* nl = FindNewline(current_, buffer_.end());
+            if (TLX_LIKELY(nl != nullptr)) {
+                tlx::string_view line = MakeView(current_, nl);
+                current_ = nl + 1;
+                return line;
+            }
+
             data_.clear();
             while (true) {
-                while (TLX_LIKELY(current_ < buffer_.end())) {
-                    if (TLX_UNLIKELY(*current_ == '\n')) {
-                        current_++;
-                        return data_;
-                    }
-                    else {
-                        data_.push_back(*current_++);
-                    }
+                nl = FindNewline(current_, buffer_.end());
+                if (nl != nullptr) {
+                    Append(current_, nl);
+                    current_ = nl + 1;
+                    return data_;
                 }
+                Append(current_, buffer_.end());
+                current_ = buffer_.end();
+
                 offset_ += buffer_.size();
                 if (!ReadBlock(stream_, buffer_)) {
                     LOG << "ReadLines: opening next file";
@@ -298,17 +349,19 @@ private:
     public:
         //! Creates an instance of iterator that reads file line based
         InputLineIteratorCompressed(const vfs::FileList& files,
-                                    ReadLinesNode& node, bool local_storage)
-            : InputLineIterator(files, node) {
+                                    Context& context,
+                                    common::JsonLogger& logger,
+                                    bool local_storage)
+            : InputLineIterator(files, context, logger) {
 
             // Go to start of 'local part'.
             if (local_storage) {
-                my_range_ = node_.context_.CalculateLocalRangeOnHost(
+                my_range_ = context_.CalculateLocalRangeOnHost(
                     files.total_size);
             }
             else {
-                my_range_ = node_.context_.CalculateLocalRange(
-                    files.total_size);
+                my_range_ = context_.CalculateLocalRange(
+                    files, files.total_size);
             }
 
             file_nr_ = 0;
@@ -359,18 +412,34 @@ private:
         //!
         //! does no checks whether a next element exists!
         const std::string& Next() {
+            return MakeString(NextView());
+        }
+
+        //! returns a view of the next element, which points into the read
+        //! buffer or data_ and is valid until the next call.
+        //!
+        //! does no checks whether a next element exists!
+        tlx::string_view NextView() {
             total_elements_++;
+
+            // fast path: line is contained in the current block
+            unsigned char* nl = FindNewline(current_, buffer_.end());
+            if (TLX_LIKELY(nl != nullptr)) {
+                tlx::string_view line = MakeView(current_, nl);
+                current_ = nl + 1;
+                return line;
+            }
+
             data_.clear();
             while (true) {
-                while (current_ < buffer_.end()) {
-                    if (TLX_UNLIKELY(*current_ == '\n')) {
-                        current_++;
-                        return data_;
-                    }
-                    else {
-                        data_.push_back(*current_++);
-                    }
+                nl = FindNewline(current_, buffer_.end());
+                if (nl != nullptr) {
+                    Append(current_, nl);
+                    current_ = nl + 1;
+                    return data_;
                 }
+                Append(current_, buffer_.end());
+                current_ = buffer_.end();
 
                 if (!ReadBlock(stream_, buffer_)) {
                     LOG << "ReadLines: opening new compressed file!";
@@ -438,6 +507,382 @@ private:
         //! File handle to files_[file_nr_]
         vfs::ReadStreamPtr stream_;
     };
+
+    //! InputLineIterator gives you access to lines of BGZF files. The byte
+    //! range of each worker refers to the compressed data, a worker reads all
+    //! lines starting in blocks which begin inside its range, plus the line
+    //! starting at the first block behind it.
+    class InputLineIteratorBgzf : public InputLineIterator
+    {
+    public:
+        //! Creates an instance of iterator that reads file line based
+        InputLineIteratorBgzf(const vfs::FileList& files,
+                              Context& context,
+                              common::JsonLogger& logger,
+                              bool local_storage)
+            : InputLineIterator(files, context, logger) {
+
+            // Go to start of 'local part'.
+            if (local_storage) {
+                my_range_ = context_.CalculateLocalRangeOnHost(
+                    files.total_size);
+            }
+            else {
+                my_range_ = context_.CalculateLocalRange(
+                    files, files.total_size);
+            }
+
+            assert(my_range_.begin <= my_range_.end);
+            if (my_range_.begin == my_range_.end) return;
+
+            file_nr_ = 0;
+
+            while (files_[file_nr_].size_inc_psum() <= my_range_.begin) {
+                file_nr_++;
+            }
+
+            uint64_t offset = my_range_.begin - files_.size_ex_psum(file_nr_);
+
+            sLOG << "ReadLines: opening bgzf file" << file_nr_
+                 << "my_range_" << my_range_ << "offset" << offset;
+
+            buffer_.Reserve(vfs::BgzfReader::max_block_size);
+            current_ = buffer_.begin();
+
+            reader_ = std::make_unique<vfs::BgzfReader>(
+                files_[file_nr_].path, offset);
+
+            if (!NextBlock(/* next_file */ true) ||
+                block_global_ >= my_range_.end) {
+                // no block begins inside the local part
+                reader_.reset();
+                return;
+            }
+
+            if (reader_->block_offset() != 0) {
+                // find next newline, discard all previous data as previous
+                // worker already covers it. EOF = newline per definition.
+                bool found_n = false;
+                while (!found_n) {
+                    unsigned char* nl = FindNewline(current_, buffer_.end());
+                    if (nl != nullptr) {
+                        current_ = nl + 1;
+                        found_n = true;
+                    }
+                    else if (!NextBlock(/* next_file */ false)) {
+                        found_n = true;
+                    }
+                }
+            }
+            data_.reserve(4 * 1024);
+        }
+
+        //! returns the next element if one exists
+        //!
+        //! does no checks whether a next element exists!
+        const std::string& Next() {
+            return MakeString(NextView());
+        }
+
+        //! returns a view of the next element, which points into the read
+        //! buffer or data_ and is valid until the next call.
+        //!
+        //! does no checks whether a next element exists!
+        tlx::string_view NextView() {
+            total_elements_++;
+
+            // fast path: line is contained in the current block
+            unsigned char* nl = FindNewline(current_, buffer_.end());
+            if (TLX_LIKELY(nl != nullptr)) {
+                tlx::string_view line = MakeView(current_, nl);
+                current_ = nl + 1;
+                return line;
+            }
+
+            data_.clear();
+            while (true) {
+                nl = FindNewline(current_, buffer_.end());
+                if (nl != nullptr) {
+                    Append(current_, nl);
+                    current_ = nl + 1;
+                    return data_;
+                }
+                Append(current_, buffer_.end());
+                current_ = buffer_.end();
+
+                // lines do not continue into the next file
+                if (!NextBlock(/* next_file */ false))
+                    return data_;
+            }
+        }
+
+        //! returns true, if an element is available in local part
+        bool HasNext() {
+            if (!reader_) return false;
+            while (current_ >= buffer_.end()) {
+                if (!NextBlock(/* next_file */ true))
+                    return false;
+            }
+            // lines starting in blocks inside the range, and the line starting
+            // at the first block behind it, which the next worker skips.
+            return block_global_ < my_range_.end ||
+                   block_pos_ + (current_ - buffer_.begin()) == boundary_pos_;
+        }
+
+    private:
+        //! Reader of blocks of files_[file_nr_]
+        std::unique_ptr<vfs::BgzfReader> reader_;
+        //! Global compressed offset of the current block
+        uint64_t block_global_ = 0;
+        //! Uncompressed position of the current block in the data read
+        uint64_t block_pos_ = 0;
+        //! Uncompressed position of the first block beginning behind my_range_
+        uint64_t boundary_pos_ = std::numeric_limits<uint64_t>::max();
+
+        //! decompress the next block into buffer_, optionally continuing with
+        //! the next file if it starts inside the local part.
+        bool NextBlock(bool next_file) {
+            size_t size;
+            read_timer.Start();
+            while (!reader_->ReadBlock(buffer_.data(), &size)) {
+                if (!next_file ||
+                    files_.size_ex_psum(file_nr_ + 1) >= my_range_.end) {
+                    read_timer.Stop();
+                    return false;
+                }
+                LOG << "ReadLines: opening next bgzf file";
+                file_nr_++;
+                reader_ = std::make_unique<vfs::BgzfReader>(
+                    files_[file_nr_].path, 0);
+            }
+            read_timer.Stop();
+
+            block_pos_ += buffer_.size();
+            buffer_.set_size(size);
+            current_ = buffer_.begin();
+            block_global_ =
+                files_.size_ex_psum(file_nr_) + reader_->block_offset();
+
+            if (block_global_ >= my_range_.end &&
+                boundary_pos_ == std::numeric_limits<uint64_t>::max()) {
+                boundary_pos_ = block_pos_;
+            }
+
+            total_bytes_ += size;
+            total_reads_++;
+            LOG << "ReadLines: read bgzf block containing " << size
+                << " bytes.";
+            return true;
+        }
+    };
+};
+
+/*!
+ * A DIANode which performs a line-based Read operation. Reads a file from the
+ * file system and delivers it as a DIA. If a MapFunction is given, it is
+ * called with a tlx::string_view of each line, which points into the read
+ * buffer and is only valid during the call, and the results form the DIA.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType = std::string,
+          typename MapFunction = ReadLinesKeepString>
+class ReadLinesNode final : public SourceNode<ValueType>
+{
+public:
+    using Super = SourceNode<ValueType>;
+    using Super::context_;
+
+    //! Constructor for a ReadLinesNode. Sets the Context and file path.
+    ReadLinesNode(Context& ctx, const std::vector<std::string>& globlist,
+                  bool local_storage,
+                  const MapFunction& map_function = MapFunction())
+        : Super(ctx, "ReadLines"),
+          input_(ctx, globlist),
+          local_storage_(local_storage),
+          map_function_(map_function) { }
+
+    //! Constructor for a ReadLinesNode. Sets the Context and file path.
+    ReadLinesNode(Context& ctx, const std::string& glob, bool local_storage,
+                  const MapFunction& map_function = MapFunction())
+        : ReadLinesNode(ctx, std::vector<std::string>{ glob }, local_storage,
+                        map_function)
+    { }
+
+    DIAMemUse PushDataMemUse() final {
+        // InputLineIterators read files block-wise, one per I/O thread
+        return data::default_block_size * context_.mem_config().io_threads_;
+    }
+
+    void PushData(bool /* consume */) final {
+        if (input_.bgzf()) {
+            ReadLinesInput::InputLineIteratorBgzf it(
+                input_.filelist(), context_, this->logger_, local_storage_);
+            PushLines(it);
+        }
+        else if (input_.filelist().contains_compressed) {
+            ReadLinesInput::InputLineIteratorCompressed it(
+                input_.filelist(), context_, this->logger_, local_storage_);
+            PushLines(it);
+        }
+        else {
+            common::Range range = ReadLinesInput::LocalRange(
+                input_.filelist(), context_, local_storage_);
+            size_t threads = std::min(
+                context_.mem_config().io_threads_,
+                range.size() /
+                (min_blocks_per_io_thread_ * data::default_block_size));
+            if (SourceStealer::Enabled(context_)) {
+                PushLinesStealing(range);
+            }
+            else if (threads > 1) {
+                PushLinesParallel(range, threads);
+            }
+            else {
+                ReadLinesInput::InputLineIteratorUncompressed it(
+                    input_.filelist(), context_, this->logger_, range);
+                PushLines(it);
+            }
+        }
+    }
+
+private:
+    //! minimum Blocks of the local range per I/O thread
+    static constexpr size_t min_blocks_per_io_thread_ = 4;
+
+    //! Blocks per chunk into which SourceStealer splits the local ranges
+    static constexpr size_t blocks_per_steal_chunk_ = 16;
+
+    //! input files
+    ReadLinesInput input_;
+
+    //! true, if files are on a local file system, false: common global file
+    //! system.
+    bool local_storage_;
+
+    //! function applied to the line views, or ReadLinesKeepString
+    MapFunction map_function_;
+
+    //! Hook Read
+    template <typename Iterator>
+    void PushLines(Iterator& it) {
+        while (it.HasNext()) {
+            PushLine(it, map_function_);
+        }
+    }
+
+    //! deliver line as std::string
+    template <typename Iterator>
+    void PushLine(Iterator& it, const ReadLinesKeepString&) {
+        this->PushItem(it.Next());
+    }
+
+    //! deliver result of map_function on a view of the line
+    template <typename Iterator, typename Function>
+    void PushLine(Iterator& it, const Function& function) {
+        this->PushItem(function(it.NextView()));
+    }
+
+    //! deliver a buffered line as std::string
+    void PushBufferedLine(const std::string& line, const ReadLinesKeepString&) {
+        this->PushItem(line);
+    }
+
+    //! deliver result of map_function on a buffered line
+    template <typename Function>
+    void PushBufferedLine(const std::string& line, const Function& function) {
+        this->PushItem(function(tlx::string_view(line)));
+    }
+
+    /*!
+     * Read the local range with more threads than this worker, which pays off
+     * for I/O-bound sources like S3 independent of the number of cores, hence
+     * the threads are not borrowed from the WorkerShare. The range is split
+     * into parts, and the worker pushes the lines of the first part while it
+     * is read, and those of the other parts from the Files into which the
+     * threads buffered them, such that the order of the lines is kept.
+     */
+    void PushLinesParallel(const common::Range& range, size_t threads) {
+        std::vector<data::File> files;
+        for (size_t t = 1; t < threads; ++t)
+            files.emplace_back(context_.GetFile(this));
+
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> readers;
+        for (size_t t = 1; t < threads; ++t) {
+            readers.emplace_back(common::CreateThread(
+                [this, &range, threads, t, &files, &errors]() {
+                    common::NameThisThread(
+                        "io " + std::to_string(context_.my_rank()) +
+                        "." + std::to_string(t));
+                    data::BlockPool::JobScope job_scope(context_.job_id());
+                    try {
+                        ReadLinesInput::InputLineIteratorUncompressed it(
+                            input_.filelist(), context_, this->logger_,
+                            range.Partition(t, threads));
+                        data::File::Writer writer = files[t - 1].GetWriter();
+                        while (it.HasNext())
+                            writer.Put(it.Next());
+                    }
+                    catch (...) {
+                        errors[t] = std::current_exception();
+                    }
+                }));
+        }
+
+        try {
+            ReadLinesInput::InputLineIteratorUncompressed it(
+                input_.filelist(), context_, this->logger_,
+                range.Partition(0, threads));
+            PushLines(it);
+        }
+        catch (...) {
+            errors[0] = std::current_exception();
+        }
+
+        for (size_t t = 1; t < threads; ++t) {
+            readers[t - 1].join();
+            if (errors[0] || errors[t]) continue;
+
+            data::File::ConsumeReader reader = files[t - 1].GetConsumeReader();
+            while (reader.HasNext())
+                PushBufferedLine(reader.Next<std::string>(), map_function_);
+        }
+
+        for (std::exception_ptr& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    /*!
+     * Read the local range in chunks, and let workers which are done read the
+     * unread chunks of the slowest ones, see SourceStealer. The lines of
+     * stolen chunks are sent back and pushed after the own chunks, such that
+     * the order of the lines is kept.
+     */
+    void PushLinesStealing(const common::Range& range) {
+        SourceStealer stealer(
+            context_, range,
+            blocks_per_steal_chunk_ * data::default_block_size,
+            local_storage_);
+
+        stealer.Run<std::string>(
+            this->dia_id(),
+            [this](const common::Range& chunk) {
+                ReadLinesInput::InputLineIteratorUncompressed it(
+                    input_.filelist(), context_, this->logger_, chunk);
+                PushLines(it);
+            },
+            [this](const common::Range& chunk, const auto& emit) {
+                ReadLinesInput::InputLineIteratorUncompressed it(
+                    input_.filelist(), context_, this->logger_, chunk);
+                while (it.HasNext())
+                    emit(it.Next());
+            },
+            [this](const std::string& line) {
+                PushBufferedLine(line, map_function_);
+            });
+    }
 };
 
 /*!
@@ -453,7 +898,7 @@ private:
  */
 DIA<std::string> ReadLines(Context& ctx, const std::string& filepath) {
     return DIA<std::string>(
-        tlx::make_counting<ReadLinesNode>(
+        tlx::make_counting<ReadLinesNode<> >(
             ctx, filepath, /* local_storage */ false));
 }
 
@@ -471,7 +916,7 @@ DIA<std::string> ReadLines(Context& ctx, const std::string& filepath) {
 DIA<std::string> ReadLines(struct LocalStorageTag, Context& ctx,
                            const std::string& filepath) {
     return DIA<std::string>(
-        tlx::make_counting<ReadLinesNode>(
+        tlx::make_counting<ReadLinesNode<> >(
             ctx, filepath, /* local_storage */ true));
 }
 
@@ -489,7 +934,7 @@ DIA<std::string> ReadLines(struct LocalStorageTag, Context& ctx,
 DIA<std::string> ReadLines(
     Context& ctx, const std::vector<std::string>& filepaths) {
     return DIA<std::string>(
-        tlx::make_counting<ReadLinesNode>(
+        tlx::make_counting<ReadLinesNode<> >(
             ctx, filepaths, /* local_storage */ false));
 }
 
@@ -507,10 +952,108 @@ DIA<std::string> ReadLines(
 DIA<std::string> ReadLines(struct LocalStorageTag, Context& ctx,
                            const std::vector<std::string>& filepaths) {
     return DIA<std::string>(
-        tlx::make_counting<ReadLinesNode>(
+        tlx::make_counting<ReadLinesNode<> >(
             ctx, filepaths, /* local_storage */ true));
 }
 
+/*!
+ * ReadLines is a DOp, which reads a file from the file system and creates an
+ * ordered DIA by applying a map function to each line. The map function gets a
+ * tlx::string_view of the line, which points into the read buffer and is only
+ * valid during the call. This avoids creating a std::string for each line, if
+ * the lines are parsed immediately.
+ *
+ * \image html dia_ops/ReadLines.svg
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param map_function Map function for each line
+ *
+ * \ingroup dia_sources
+ */
+template <typename MapFunction>
+auto ReadLines(Context& ctx, const std::string& filepath,
+               const MapFunction& map_function) {
+    using ValueType =
+        typename common::FunctionTraits<MapFunction>::result_type;
+    return DIA<ValueType>(
+        tlx::make_counting<ReadLinesNode<ValueType, MapFunction> >(
+            ctx, filepath, /* local_storage */ false, map_function));
+}
+
+/*!
+ * ReadLines is a DOp, which reads a file from the file system and creates an
+ * ordered DIA by applying a map function to each line. The map function gets a
+ * tlx::string_view of the line, which points into the read buffer and is only
+ * valid during the call.
+ *
+ * \image html dia_ops/ReadLines.svg
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param map_function Map function for each line
+ *
+ * \ingroup dia_sources
+ */
+template <typename MapFunction>
+auto ReadLines(struct LocalStorageTag, Context& ctx,
+               const std::string& filepath, const MapFunction& map_function) {
+    using ValueType =
+        typename common::FunctionTraits<MapFunction>::result_type;
+    return DIA<ValueType>(
+        tlx::make_counting<ReadLinesNode<ValueType, MapFunction> >(
+            ctx, filepath, /* local_storage */ true, map_function));
+}
+
+/*!
+ * ReadLines is a DOp, which reads a file from the file system and creates an
+ * ordered DIA by applying a map function to each line. The map function gets a
+ * tlx::string_view of the line, which points into the read buffer and is only
+ * valid during the call.
+ *
+ * \image html dia_ops/ReadLines.svg
+ *
+ * \param ctx Reference to the context object
+ * \param filepaths Path of the file in the file system
+ * \param map_function Map function for each line
+ *
+ * \ingroup dia_sources
+ */
+template <typename MapFunction>
+auto ReadLines(Context& ctx, const std::vector<std::string>& filepaths,
+               const MapFunction& map_function) {
+    using ValueType =
+        typename common::FunctionTraits<MapFunction>::result_type;
+    return DIA<ValueType>(
+        tlx::make_counting<ReadLinesNode<ValueType, MapFunction> >(
+            ctx, filepaths, /* local_storage */ false, map_function));
+}
+
+/*!
+ * ReadLines is a DOp, which reads a file from the file system and creates an
+ * ordered DIA by applying a map function to each line. The map function gets a
+ * tlx::string_view of the line, which points into the read buffer and is only
+ * valid during the call.
+ *
+ * \image html dia_ops/ReadLines.svg
+ *
+ * \param ctx Reference to the context object
+ * \param filepaths Path of the file in the file system
+ * \param map_function Map function for each line
+ *
+ * \ingroup dia_sources
+ */
+template <typename MapFunction>
+auto ReadLines(struct LocalStorageTag, Context& ctx,
+               const std::vector<std::string>& filepaths,
+               const MapFunction& map_function) {
+    using ValueType =
+        typename common::FunctionTraits<MapFunction>::result_type;
+    return DIA<ValueType>(
+        tlx::make_counting<ReadLinesNode<ValueType, MapFunction> >(
+            ctx, filepaths, /* local_storage */ true, map_function));
+}
+
 } // namespace api
 
 //! imported from api namespace
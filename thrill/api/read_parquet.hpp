@@ -0,0 +1,377 @@
+/*******************************************************************************
+ * thrill/api/read_parquet.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_READ_PARQUET_HEADER
+#define THRILL_API_READ_PARQUET_HEADER
+
+#if !THRILL_HAVE_PARQUET
+#error "ReadParquet requires Thrill built with Apache Parquet C++ (THRILL_USE_PARQUET)."
+#endif
+
+#include <thrill/api/context.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/api/source_node.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/vfs/file_io.hpp>
+
+#include <parquet/api/reader.h>
+#include <tlx/die.hpp>
+#include <tlx/string/join.hpp>
+#include <tlx/unused.hpp>
+#include <tlx/vector_free.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Maps the C++ type of a field in ReadParquet's ValueType to the Parquet
+ * physical type of the column and converts the values.
+ */
+template <typename Type>
+struct ParquetColumnTraits;
+
+template <>
+struct ParquetColumnTraits<bool> {
+    using DType = parquet::BooleanType;
+    static bool Convert(bool v) { return v; }
+};
+
+template <>
+struct ParquetColumnTraits<int32_t> {
+    using DType = parquet::Int32Type;
+    static int32_t Convert(int32_t v) { return v; }
+};
+
+template <>
+struct ParquetColumnTraits<int64_t> {
+    using DType = parquet::Int64Type;
+    static int64_t Convert(int64_t v) { return v; }
+};
+
+template <>
+struct ParquetColumnTraits<float> {
+    using DType = parquet::FloatType;
+    static float Convert(float v) { return v; }
+};
+
+template <>
+struct ParquetColumnTraits<double> {
+    using DType = parquet::DoubleType;
+    static double Convert(double v) { return v; }
+};
+
+template <>
+struct ParquetColumnTraits<std::string> {
+    using DType = parquet::ByteArrayType;
+    static std::string Convert(const parquet::ByteArray& v) {
+        return std::string(reinterpret_cast<const char*>(v.ptr), v.len);
+    }
+};
+
+/*!
+ * Reads the values of one column of a row group in batches. Null values of
+ * optional columns are delivered as default constructed Type.
+ */
+template <typename Type>
+class ParquetColumnBatch
+{
+    using Traits = ParquetColumnTraits<Type>;
+    using DType = typename Traits::DType;
+    using CType = typename DType::c_type;
+    using Reader = parquet::TypedColumnReader<DType>;
+
+public:
+    //! number of values read per ReadBatch() call
+    static constexpr int64_t batch_size = 4096;
+
+    ParquetColumnBatch(const std::shared_ptr<parquet::ColumnReader>& reader,
+                       int16_t max_def_level)
+        : reader_(std::static_pointer_cast<Reader>(reader)),
+          max_def_level_(max_def_level),
+          values_(new CType[batch_size]),
+          def_levels_(new int16_t[batch_size]) { }
+
+    //! return the value of the next row
+    Type Next() {
+        if (pos_ == levels_)
+            ReadBatch();
+        bool is_null =
+            max_def_level_ != 0 && def_levels_[pos_] != max_def_level_;
+        ++pos_;
+        return is_null ? Type() : Traits::Convert(values_[value_pos_++]);
+    }
+
+private:
+    //! typed reader of the column
+    std::shared_ptr<Reader> reader_;
+
+    //! definition level of non-null values, zero for required columns
+    int16_t max_def_level_;
+
+    //! values of the current batch, excluding nulls
+    std::unique_ptr<CType[]> values_;
+
+    //! definition levels of the current batch
+    std::unique_ptr<int16_t[]> def_levels_;
+
+    //! number of rows in the current batch
+    int64_t levels_ = 0;
+
+    //! current row and value in the batch
+    int64_t pos_ = 0, value_pos_ = 0;
+
+    void ReadBatch() {
+        int64_t values_read = 0;
+        levels_ = reader_->ReadBatch(
+            batch_size, def_levels_.get(), nullptr, values_.get(), &values_read);
+        if (levels_ <= 0)
+            die("ReadParquet: column ended before the row group");
+        pos_ = value_pos_ = 0;
+    }
+};
+
+/*!
+ * A DIANode which reads selected columns of Parquet files and emits the rows as
+ * a DIA of tuples. Only the column chunks of the selected columns are read.
+ *
+ * The row groups of all files are distributed among the workers by the byte
+ * offset of their first column chunk, hence each worker only opens the files
+ * overlapping its part of the total size.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType>
+class ReadParquetNode final : public SourceNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    //! number of columns read, one for each field of ValueType.
+    static constexpr size_t num_columns_ = std::tuple_size<ValueType>::value;
+
+    using ColumnIndexes = std::make_index_sequence<num_columns_>;
+
+public:
+    using Super = SourceNode<ValueType>;
+    using Super::context_;
+
+    ReadParquetNode(Context& ctx, const std::vector<std::string>& globlist,
+                    const std::vector<std::string>& columns)
+        : Super(ctx, "ReadParquet") {
+
+        if (columns.size() != num_columns_) {
+            die("ReadParquet: " << columns.size() << " columns given for "
+                "a ValueType with " << num_columns_ << " fields");
+        }
+
+        vfs::FileList files = vfs::Glob(globlist, vfs::GlobType::File);
+
+        if (files.size() == 0)
+            die("ReadParquet: no files found in globs: " + tlx::join(' ', globlist));
+
+        if (files.contains_remote_uri)
+            die("ReadParquet: only local files are supported");
+
+        common::Range my_range = context_.CalculateLocalRange(files.total_size);
+
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (files.size_inc_psum(i) <= my_range.begin ||
+                files.size_ex_psum(i) >= my_range.end) continue;
+
+            std::unique_ptr<parquet::ParquetFileReader> reader =
+                parquet::ParquetFileReader::OpenFile(files[i].path);
+            std::shared_ptr<parquet::FileMetaData> metadata = reader->metadata();
+
+            FileInfo fi;
+            fi.path = files[i].path;
+            ResolveColumns(fi, *metadata->schema(), columns, ColumnIndexes());
+
+            for (int rg = 0; rg < metadata->num_row_groups(); ++rg) {
+                uint64_t offset = files.size_ex_psum(i)
+                                  + RowGroupOffset(*metadata->RowGroup(rg));
+                if (offset >= my_range.begin && offset < my_range.end)
+                    fi.row_groups.push_back(rg);
+            }
+
+            sLOG << "ReadParquet: file" << fi.path
+                 << "row_groups" << fi.row_groups.size()
+                 << "of" << metadata->num_row_groups();
+
+            if (!fi.row_groups.empty())
+                my_files_.emplace_back(std::move(fi));
+        }
+    }
+
+    void PushData(bool /* consume */) final {
+        LOG << "ReadParquetNode::PushData() start " << *this;
+
+        for (const FileInfo& fi : my_files_) {
+            std::unique_ptr<parquet::ParquetFileReader> reader =
+                parquet::ParquetFileReader::OpenFile(fi.path);
+
+            for (int rg : fi.row_groups) {
+                std::shared_ptr<parquet::RowGroupReader> row_group =
+                    reader->RowGroup(rg);
+                PushRowGroup(fi, *row_group, ColumnIndexes());
+                stats_row_groups_++;
+            }
+        }
+
+        Super::logger_
+            << "class" << "ReadParquetNode"
+            << "event" << "done"
+            << "total_rows" << stats_total_rows_
+            << "total_row_groups" << stats_row_groups_;
+    }
+
+    void Dispose() final {
+        tlx::vector_free(my_files_);
+    }
+
+private:
+    //! row groups of a file to read
+    struct FileInfo {
+        std::string          path;
+        //! index of each column in the file's schema
+        std::vector<int>     column_index;
+        //! maximum definition level of each column
+        std::vector<int16_t> max_def_level;
+        //! row groups assigned to this worker
+        std::vector<int>     row_groups;
+    };
+
+    //! list of files with row groups of this worker
+    std::vector<FileInfo> my_files_;
+
+    size_t stats_total_rows_ = 0;
+    size_t stats_row_groups_ = 0;
+
+    //! byte offset of the first column chunk of a row group
+    static uint64_t RowGroupOffset(const parquet::RowGroupMetaData& rg) {
+        std::unique_ptr<parquet::ColumnChunkMetaData> chunk = rg.ColumnChunk(0);
+        return chunk->has_dictionary_page()
+               ? chunk->dictionary_page_offset() : chunk->data_page_offset();
+    }
+
+    //! find columns in the schema and check their physical types
+    template <size_t... Is>
+    static void ResolveColumns(
+        FileInfo& fi, const parquet::SchemaDescriptor& schema,
+        const std::vector<std::string>& columns, std::index_sequence<Is...>) {
+        bool ok[] = {
+            ResolveColumn<typename std::tuple_element<Is, ValueType>::type>(
+                fi, schema, columns[Is])...
+        };
+        tlx::unused(ok);
+    }
+
+    template <typename Type>
+    static bool ResolveColumn(
+        FileInfo& fi, const parquet::SchemaDescriptor& schema,
+        const std::string& name) {
+        int index = schema.ColumnIndex(name);
+        if (index < 0)
+            die("ReadParquet: column " << name << " not found in " << fi.path);
+
+        const parquet::ColumnDescriptor* descr = schema.Column(index);
+        if (descr->physical_type() !=
+            ParquetColumnTraits<Type>::DType::type_num)
+            die("ReadParquet: column " << name << " in " << fi.path <<
+                " has a different type than the ValueType field");
+        if (descr->max_repetition_level() != 0)
+            die("ReadParquet: repeated column " << name << " in " << fi.path <<
+                " is not supported");
+
+        fi.column_index.push_back(index);
+        fi.max_def_level.push_back(descr->max_definition_level());
+        return true;
+    }
+
+    //! read the selected columns of a row group and push the rows
+    template <size_t... Is>
+    void PushRowGroup(const FileInfo& fi, parquet::RowGroupReader& row_group,
+                      std::index_sequence<Is...>) {
+        std::tuple<ParquetColumnBatch<
+                       typename std::tuple_element<Is, ValueType>::type>...>
+        batches(
+            ParquetColumnBatch<
+                typename std::tuple_element<Is, ValueType>::type>(
+                row_group.Column(fi.column_index[Is]),
+                fi.max_def_level[Is])...);
+
+        int64_t num_rows = row_group.metadata()->num_rows();
+        for (int64_t r = 0; r < num_rows; ++r)
+            this->PushItem(ValueType(std::get<Is>(batches).Next() ...));
+
+        stats_total_rows_ += num_rows;
+    }
+};
+
+/*!
+ * ReadParquet is a DOp, which reads the given columns of Parquet files from
+ * the file system and creates a DIA of rows. ValueType is a std::tuple or
+ * std::pair with one field per column, of type bool, int32_t, int64_t, float,
+ * double, or std::string matching the column's physical type. Nulls are
+ * delivered as default constructed values.
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param columns Names of the columns to read
+ *
+ * \ingroup dia_sources
+ */
+template <typename ValueType>
+DIA<ValueType> ReadParquet(
+    Context& ctx, const std::vector<std::string>& filepath,
+    const std::vector<std::string>& columns) {
+
+    auto node = tlx::make_counting<ReadParquetNode<ValueType> >(
+        ctx, filepath, columns);
+
+    return DIA<ValueType>(node);
+}
+
+/*!
+ * ReadParquet is a DOp, which reads the given columns of Parquet files from
+ * the file system and creates a DIA of rows. ValueType is a std::tuple or
+ * std::pair with one field per column, of type bool, int32_t, int64_t, float,
+ * double, or std::string matching the column's physical type. Nulls are
+ * delivered as default constructed values.
+ *
+ * \param ctx Reference to the context object
+ * \param filepath Path of the file in the file system
+ * \param columns Names of the columns to read
+ *
+ * \ingroup dia_sources
+ */
+template <typename ValueType>
+DIA<ValueType> ReadParquet(
+    Context& ctx, const std::string& filepath,
+    const std::vector<std::string>& columns) {
+
+    return ReadParquet<ValueType>(
+        ctx, std::vector<std::string>{ filepath }, columns);
+}
+
+} // namespace api
+
+//! imported from api namespace
+using api::ReadParquet;
+
+} // namespace thrill
+
+#endif // !THRILL_API_READ_PARQUET_HEADER
+
+/******************************************************************************/
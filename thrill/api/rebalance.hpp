@@ -68,6 +68,15 @@ public:
     void Execute() final {
         LOG << "RebalanceNode::Execute() processing";
 
+        const KnownSize& parent_size = this->parent_known_size(0);
+        if (parent_stack_empty_ && parent_size.known_balanced()) {
+            // the items are already balanced, keep them in place.
+            sLOG << "Rebalance() skipped, balanced size" << parent_size.total;
+            exchanged_ = false;
+            this->set_known_size(parent_size.total, /* balanced */ true);
+            return;
+        }
+
         size_t local_size;
         local_size = file_.num_items();
         sLOG << "local_size" << local_size;
@@ -78,13 +87,12 @@ public:
         sLOG << "global_size" << global_size;
 
         const size_t num_workers = context_.num_workers();
-        const double pre_pe =
-            static_cast<double>(global_size) / static_cast<double>(num_workers);
 
-        // calculate offset vector
+        // calculate offset vector, the parts of the workers are proportional
+        // to their host weights.
         std::vector<size_t> offsets(num_workers + 1, 0);
         for (size_t p = 0; p < num_workers; ++p) {
-            size_t limit = static_cast<size_t>(static_cast<double>(p) * pre_pe);
+            size_t limit = context_.CalculatePartBegin(global_size, p);
             if (limit < local_rank) continue;
 
             offsets[p] = std::min(limit - local_rank, file_.num_items());
@@ -92,10 +100,16 @@ public:
         offsets[num_workers] = file_.num_items();
         LOG << "offsets = " << offsets;
 
+        stream_ = context_.GetNewCatStream(this);
         stream_->template ScatterConsume<ValueType>(file_, offsets);
+        this->set_known_size(global_size, /* balanced */ true);
     }
 
     void PushData(bool consume) final {
+        if (!exchanged_) {
+            this->PushFile(file_, consume);
+            return;
+        }
         auto reader = stream_->GetCatReader(consume);
         while (reader.HasNext()) {
             this->PushItem(reader.template Next<ValueType>());
@@ -114,8 +128,11 @@ private:
     //! Whether the parent stack is empty
     const bool parent_stack_empty_;
 
-    //! CatStream for exchange
-    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
+    //! CatStream for exchange, only allocated if the items are not balanced
+    data::CatStreamPtr stream_;
+
+    //! whether the items were exchanged, or were already balanced in file_
+    bool exchanged_ = true;
 };
 
 template <typename ValueType, typename Stack>
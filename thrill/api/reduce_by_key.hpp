@@ -19,8 +19,11 @@
 #include <thrill/api/dia.hpp>
 #include <thrill/api/dop_node.hpp>
 #include <thrill/common/functional.hpp>
+#include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/porting.hpp>
+#include <thrill/core/accelerator_pre_reducer.hpp>
+#include <thrill/core/hashed_key.hpp>
 #include <thrill/core/reduce_by_hash_post_phase.hpp>
 #include <thrill/core/reduce_pre_phase.hpp>
 #include <tlx/meta/is_std_pair.hpp>
@@ -53,6 +56,8 @@ class DefaultReduceConfig : public core::DefaultReduceConfig
  * \tparam ReduceFunction Type of the reduce_function.
  * \tparam VolatileKey Whether to reuse the key once extracted in during pre reduce
  * (false) or let the post reduce extract the key again (true).
+ * \tparam UseAccelerator Whether to pre-aggregate batches of pairs on an
+ * accelerator device before the pre phase, only for ReducePair summing numbers.
  *
  * \ingroup api_layer
  */
@@ -60,7 +65,7 @@ template <typename ValueType,
           typename KeyExtractor, typename ReduceFunction,
           typename ReduceConfig, typename KeyHashFunction,
           typename KeyEqualFunction, const bool VolatileKey,
-          bool UseDuplicateDetection>
+          bool UseDuplicateDetection, bool UseAccelerator = false>
 class ReduceNode final : public DOpNode<ValueType>
 {
 private:
@@ -77,9 +82,16 @@ private:
 
     using HashIndexFunction = core::ReduceByHash<Key, KeyHashFunction>;
 
+    using MakeTableItem =
+        core::ReduceMakeTableItem<ValueType, TableItem, VolatileKey>;
+
     static constexpr bool use_mix_stream_ = ReduceConfig::use_mix_stream_;
     static constexpr bool use_post_thread_ = ReduceConfig::use_post_thread_;
 
+    using AcceleratorPreReducer = typename std::conditional<
+        UseAccelerator, core::AcceleratorPreReducer<ValueType>,
+        core::NoAcceleratorPreReducer>::type;
+
     //! Emitter for PostPhase to push elements to next DIA object.
     class Emitter
     {
@@ -106,6 +118,9 @@ public:
                const KeyHashFunction& key_hash_function,
                const KeyEqualFunction& key_equal_function)
         : Super(parent.ctx(), label, { parent.id() }, { parent.node() }),
+          local_(ParentDIA::stack_empty &&
+                 parent.node()->template partitioned_by<KeyExtractor>()),
+          key_extractor_(key_extractor),
           mix_stream_(use_mix_stream_ ?
                       parent.ctx().GetNewMixStream(this) : nullptr),
           cat_stream_(use_mix_stream_ ?
@@ -123,43 +138,85 @@ public:
               HashIndexFunction(key_hash_function), key_equal_function) {
         // Hook PreOp: Locally hash elements of the current DIA onto buckets and
         // reduce each bucket to a single value, afterwards send data to another
-        // worker given by the shuffle algorithm.
+        // worker given by the shuffle algorithm. If the parent is already
+        // partitioned by the key, insert directly into the post phase.
         auto pre_op_fn = [this](const ValueType& input) {
+                             if (local_) {
+                                 return post_phase_.Insert(
+                                     MakeTableItem::Make(input, key_extractor_));
+                             }
+                             if (UseAccelerator && accelerator_.enabled()) {
+                                 if (accelerator_.Put(input))
+                                     FlushAccelerator();
+                                 return true;
+                             }
                              return pre_phase_.Insert(input);
                          };
         // close the function stack with our pre op and register it at
         // parent node for output
         auto lop_chain = parent.stack().push(pre_op_fn).fold();
         parent.node()->AddChild(this, lop_chain);
+
+        // the reduced items are partitioned by the key, unless the
+        // reduce_function may change it.
+        if (!VolatileKey)
+            this->template set_partition_key<KeyExtractor>();
     }
 
     DIAMemUse PreOpMemUse() final {
         // request maximum RAM limit, the value is calculated by StageBuilder,
-        // and set as DIABase::mem_limit_.
-        return DIAMemUse::Max();
+        // and set as DIABase::mem_limit_. A full reduce table must flush
+        // partially reduced items, hence weigh it higher than e.g. a Sort
+        // receiving data in the same Stage.
+        return DIAMemUse::MaxWeighted(2.0);
     }
 
     void StartPreOp(size_t /* parent_index */) final {
         LOG << *this << " running StartPreOp";
-        if (!use_post_thread_) {
+        if (!local_)
+            context_.StartProgress(this, ProgressPhase::PreOp);
+        if (local_) {
+            // no pre phase, the items are reduced in the post phase
+            post_phase_.Initialize(DIABase::mem_limit_);
+        }
+        else if (!use_post_thread_) {
             // use pre_phase without extra thread
-            pre_phase_.Initialize(DIABase::mem_limit_);
+            InitializePrePhase(DIABase::mem_limit_);
         }
         else {
-            pre_phase_.Initialize(DIABase::mem_limit_ / 2);
+            InitializePrePhase(DIABase::mem_limit_ / 2);
             post_phase_.Initialize(DIABase::mem_limit_ / 2);
 
-            // start additional thread to receive from the channel
-            thread_ = common::CreateThread([this] { ProcessChannel(); });
+            // start additional thread to receive from the channel, on the
+            // same NUMA node as this worker and the post phase table
+            size_t numa_node = common::GetCurrentNumaNode();
+            thread_ = common::CreateThread(
+                [this, numa_node] {
+                    common::SetNumaNodeAffinity(numa_node);
+                    ProcessChannel();
+                });
         }
     }
 
     void StopPreOp(size_t /* parent_index */) final {
         LOG << *this << " running StopPreOp";
         // Flush hash table before the postOp
-        pre_phase_.FlushAll();
+        if (!local_) {
+            context_.ReportProgress(this->dia_id(), pre_phase_.num_inserted());
+            context_.StopProgress(this->dia_id());
+            if (UseAccelerator) {
+                FlushAccelerator();
+                Super::logger_
+                    << "class" << "ReduceNode"
+                    << "event" << "accelerator"
+                    << "batches" << accelerator_.num_batches()
+                    << "items_in" << accelerator_.num_items_in()
+                    << "items_out" << accelerator_.num_items_out();
+            }
+            pre_phase_.FlushAll();
+        }
         pre_phase_.CloseAll();
-        if (use_post_thread_) {
+        if (use_post_thread_ && !local_) {
             // waiting for the additional thread to finish the reduce
             thread_.join();
             // deallocate stream if already processed
@@ -169,15 +226,19 @@ public:
 
     void Execute() final { }
 
+    //! The reduced items do not depend on the order of the input items.
+    bool OrderAgnostic() const final { return true; }
+
     DIAMemUse PushDataMemUse() final {
         return DIAMemUse::Max();
     }
 
     void PushData(bool consume) final {
 
-        if (!use_post_thread_ && !reduced_) {
+        if ((!use_post_thread_ || local_) && !reduced_) {
             // not final reduced, and no additional thread, perform post reduce
-            post_phase_.Initialize(DIABase::mem_limit_);
+            if (!local_)
+                post_phase_.Initialize(DIABase::mem_limit_);
             ProcessChannel();
 
             // deallocate stream if already processed
@@ -195,18 +256,20 @@ public:
             auto reader = mix_stream_->GetMixReader(/* consume */ true);
             sLOG << "reading data from" << mix_stream_->id()
                  << "to push into post phase which flushes to" << this->dia_id();
-            while (reader.HasNext()) {
-                post_phase_.Insert(reader.template Next<TableItem>());
-            }
+            data::ReadEachItem<TableItem>(
+                reader, [this](const TableItem& item) {
+                    post_phase_.Insert(item);
+                });
         }
         else
         {
             auto reader = cat_stream_->GetCatReader(/* consume */ true);
             sLOG << "reading data from" << cat_stream_->id()
                  << "to push into post phase which flushes to" << this->dia_id();
-            while (reader.HasNext()) {
-                post_phase_.Insert(reader.template Next<TableItem>());
-            }
+            data::ReadEachItem<TableItem>(
+                reader, [this](const TableItem& item) {
+                    post_phase_.Insert(item);
+                });
         }
     }
 
@@ -215,6 +278,29 @@ public:
     }
 
 private:
+    //! initialize the pre phase, the accelerator's batch takes a quarter of
+    //! its memory
+    void InitializePrePhase(size_t limit_memory) {
+        if (UseAccelerator) {
+            accelerator_.Initialize(limit_memory / 4);
+            limit_memory -= accelerator_.memory();
+        }
+        pre_phase_.Initialize(limit_memory);
+    }
+
+    //! insert the partial sums of the accelerator's batch into the pre phase
+    void FlushAccelerator() {
+        accelerator_.Flush(
+            [this](const ValueType& v) { pre_phase_.Insert(v); });
+    }
+
+    //! whether the parent's items are partitioned by the key, such that they
+    //! are reduced locally without exchanging data.
+    const bool local_;
+
+    //! key extractor for inserting items directly into the post phase
+    KeyExtractor key_extractor_;
+
     // pointers for both Mix and CatStream. only one is used, the other costs
     // only a null pointer.
     data::MixStreamPtr mix_stream_;
@@ -230,6 +316,9 @@ private:
         HashIndexFunction, KeyEqualFunction, KeyHashFunction,
         UseDuplicateDetection> pre_phase_;
 
+    //! batches pairs for pre-aggregation on an accelerator device
+    AcceleratorPreReducer accelerator_;
+
     core::ReduceByHashPostPhase<
         TableItem, Key, ValueType, KeyExtractor, ReduceFunction, Emitter,
         VolatileKey, ReduceConfig,
@@ -249,7 +338,7 @@ auto DIA<ValueType, Stack>::ReduceByKey(
     return ReduceByKey(
         NoVolatileKeyTag, NoDuplicateDetectionTag,
         key_extractor, reduce_function, reduce_config,
-        std::hash<Key>(), std::equal_to<Key>());
+        common::HashDefault<Key>(), std::equal_to<Key>());
 }
 
 template <typename ValueType, typename Stack>
@@ -365,6 +454,20 @@ auto DIA<ValueType, Stack>::ReduceByKey(
 /******************************************************************************/
 // ReducePair
 
+/*!
+ * Key extractor of ReducePair. It is a named type instead of a lambda, such
+ * that a ReducePair on the result of another ReducePair recognizes that its
+ * input is already partitioned by the key.
+ */
+template <typename ValueType>
+class ReducePairKeyExtractor
+{
+public:
+    typename ValueType::first_type operator () (const ValueType& value) const {
+        return value.first;
+    }
+};
+
 template <typename ValueType, typename Stack>
 template <typename ReduceFunction, typename ReduceConfig>
 auto DIA<ValueType, Stack>::ReducePair(
@@ -373,7 +476,7 @@ auto DIA<ValueType, Stack>::ReducePair(
     // forward to main function
     using Key = typename ValueType::first_type;
     return ReducePair(reduce_function, reduce_config,
-                      std::hash<Key>(), std::equal_to<Key>());
+                      common::HashDefault<Key>(), std::equal_to<Key>());
 }
 
 template <typename ValueType, typename Stack>
@@ -441,27 +544,79 @@ auto DIA<ValueType, Stack>::ReducePair(
             typename ValueType::second_type>::value,
         "ReduceFunction has the wrong output type");
 
-    auto key_extractor = [](const ValueType& value) { return value.first; };
+    using KeyExtractor = ReducePairKeyExtractor<ValueType>;
 
     auto reduce_pair_function =
         [reduce_function](const ValueType& a, const ValueType& b) {
             return ValueType(a.first, reduce_function(a.second, b.second));
         };
 
+    // sums of numbers with integral keys may be pre-aggregated on a device
+    static constexpr bool use_accelerator =
+        ReduceConfig::use_accelerator_ &&
+        core::AcceleratorReducible<ValueType, ReduceFunction>::value;
+
     using ReduceNode = api::ReduceNode<
         ValueType,
-        decltype(key_extractor), decltype(reduce_pair_function),
+        KeyExtractor, decltype(reduce_pair_function),
         ReduceConfig, KeyHashFunction, KeyEqualFunction,
-        /* VolatileKey */ false, DuplicateDetectionValue>;
+        /* VolatileKey */ false, DuplicateDetectionValue, use_accelerator>;
 
     auto node = tlx::make_counting<ReduceNode>(
         *this, "ReducePair",
-        key_extractor, reduce_pair_function, reduce_config,
+        KeyExtractor(), reduce_pair_function, reduce_config,
         key_hash_function, key_equal_funtion);
 
     return DIA<ValueType>(node);
 }
 
+template <typename ValueType, typename Stack>
+template <typename ReduceFunction, typename ReduceConfig>
+auto DIA<ValueType, Stack>::ReducePair(
+    const struct PreHashKeyTag& pre_hash_key_tag,
+    const ReduceFunction& reduce_function,
+    const ReduceConfig& reduce_config) const {
+    // forward to main function
+    using Key = typename ValueType::first_type;
+    return ReducePair(pre_hash_key_tag, reduce_function, reduce_config,
+                      common::HashDefault<Key>(), std::equal_to<Key>());
+}
+
+template <typename ValueType, typename Stack>
+template <typename ReduceFunction, typename ReduceConfig,
+          typename KeyHashFunction, typename KeyEqualFunction>
+auto DIA<ValueType, Stack>::ReducePair(
+    const struct PreHashKeyTag&,
+    const ReduceFunction& reduce_function,
+    const ReduceConfig& reduce_config,
+    const KeyHashFunction& key_hash_function,
+    const KeyEqualFunction& key_equal_function) const {
+    assert(IsValid());
+
+    static_assert(tlx::is_std_pair<ValueType>::value,
+                  "ValueType is not a pair");
+
+    using Key = typename ValueType::first_type;
+    using Value = typename ValueType::second_type;
+    using HashedPair = std::pair<core::HashedKey<Key>, Value>;
+
+    // hash the key once, the LOp is fused into the pre-phase's insertion
+    auto hashed = Map(
+        [key_hash_function](const ValueType& p) {
+            return HashedPair(
+                core::HashedKey<Key>(p.first, key_hash_function(p.first)),
+                p.second);
+        });
+
+    return hashed.ReducePair(
+        reduce_function, reduce_config,
+        core::HashedKeyHash<Key>(),
+        core::HashedKeyEqual<Key, KeyEqualFunction>(key_equal_function))
+           .Map([](const HashedPair& p) {
+                    return ValueType(p.first.key, p.second);
+                });
+}
+
 } // namespace api
 } // namespace thrill
 
@@ -136,11 +136,14 @@ public:
 
     DIAMemUse PreOpMemUse() final {
         // request maximum RAM limit, the value is calculated by StageBuilder,
-        // and set as DIABase::mem_limit_.
-        return DIAMemUse::Max();
+        // and set as DIABase::mem_limit_. A full reduce table must flush
+        // partially reduced items, hence weigh it higher than e.g. a Sort
+        // receiving data in the same Stage.
+        return DIAMemUse::MaxWeighted(2.0);
     }
 
     void StartPreOp(size_t /* parent_index */) final {
+        context_.StartProgress(this, ProgressPhase::PreOp);
         if (!use_post_thread_) {
             // use pre_phase without extra thread
             if (!SkipPreReducePhase)
@@ -163,13 +166,21 @@ public:
             post_phase_.SetRange(pre_phase_.key_range(context_.my_rank()));
             post_phase_.Initialize(DIABase::mem_limit_ / 2);
 
-            // start additional thread to receive from the channel
-            thread_ = common::CreateThread([this] { ProcessChannel(); });
+            // start additional thread to receive from the channel, on the
+            // same NUMA node as this worker and the post phase table
+            size_t numa_node = common::GetCurrentNumaNode();
+            thread_ = common::CreateThread(
+                [this, numa_node] {
+                    common::SetNumaNodeAffinity(numa_node);
+                    ProcessChannel();
+                });
         }
     }
 
     void StopPreOp(size_t /* parent_index */) final {
         LOG << *this << " running StopPreOp";
+        context_.ReportProgress(this->dia_id(), pre_phase_.num_inserted());
+        context_.StopProgress(this->dia_id());
         // Flush hash table before the postOp
         if (!SkipPreReducePhase)
             pre_phase_.FlushAll();
@@ -184,6 +195,9 @@ public:
 
     void Execute() final { }
 
+    //! The reduced items do not depend on the order of the input items.
+    bool OrderAgnostic() const final { return true; }
+
     DIAMemUse PushDataMemUse() final {
         return DIAMemUse::Max();
     }
@@ -210,18 +224,20 @@ public:
             auto reader = mix_stream_->GetMixReader(/* consume */ true);
             sLOG << "reading data from" << mix_stream_->id()
                  << "to push into post table which flushes to" << this->dia_id();
-            while (reader.HasNext()) {
-                post_phase_.Insert(reader.template Next<TableItem>());
-            }
+            data::ReadEachItem<TableItem>(
+                reader, [this](const TableItem& item) {
+                    post_phase_.Insert(item);
+                });
         }
         else
         {
             auto reader = cat_stream_->GetCatReader(/* consume */ true);
             sLOG << "reading data from" << cat_stream_->id()
                  << "to push into post table which flushes to" << this->dia_id();
-            while (reader.HasNext()) {
-                post_phase_.Insert(reader.template Next<TableItem>());
-            }
+            data::ReadEachItem<TableItem>(
+                reader, [this](const TableItem& item) {
+                    post_phase_.Insert(item);
+                });
         }
     }
 
@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * thrill/api/sample_by_key.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_SAMPLE_BY_KEY_HEADER
+#define THRILL_API_SAMPLE_BY_KEY_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/reservoir_sampling.hpp>
+
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs stratified sampling *without* replacement: up to
+ * sample_size items are selected uniformly at random for each key.
+ *
+ * Each worker keeps one reservoir per local key, in which every item gets a
+ * uniform random key (a ReservoirSamplingWeighted with weight one). The global
+ * sample of a key consists of the sample_size items with the largest random
+ * keys. A single AllReduce of the sorted random keys per key determines the
+ * threshold of each stratum, and each worker then keeps its local samples
+ * reaching it. No items are exchanged, but the keys of all strata and their
+ * random keys are, hence the number of strata must be moderate.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename KeyExtractor>
+class SampleByKeyNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    using Key = typename std::decay<
+        typename common::FunctionTraits<KeyExtractor>::result_type>::type;
+
+    using RNG = std::mt19937_64;
+    using Sampler = common::ReservoirSamplingWeighted<ValueType, RNG>;
+    using KeyItem = typename Sampler::KeyItem;
+
+    //! pair of key and the sorted random keys of its reservoir
+    using KeyThresholds = std::pair<Key, std::vector<double> >;
+
+    //! reservoir of one key
+    struct Stratum {
+        Stratum(size_t sample_size, RNG& rng)
+            : sampler(sample_size, samples, rng) { }
+
+        //! non-copyable: delete copy-constructor
+        Stratum(const Stratum&) = delete;
+        //! non-copyable: delete assignment operator
+        Stratum& operator = (const Stratum&) = delete;
+
+        //! samples and their random keys
+        std::vector<KeyItem> samples;
+        //! reservoir sampler of the key
+        Sampler sampler;
+        //! smallest random key of the global sample of this key
+        double threshold = 0.0;
+    };
+
+public:
+    template <typename ParentDIA>
+    SampleByKeyNode(const ParentDIA& parent,
+                    const KeyExtractor& key_extractor, size_t sample_size)
+        : Super(parent.ctx(), "SampleByKey",
+                { parent.id() }, { parent.node() }),
+          key_extractor_(key_extractor), sample_size_(sample_size) {
+        auto presample_fn = [this](const ValueType& input) {
+                                PreOp(input);
+                            };
+        auto lop_chain = parent.stack().push(presample_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    void PreOp(const ValueType& input) {
+        auto it = strata_.find(key_extractor_(input));
+        if (it == strata_.end()) {
+            it = strata_.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(key_extractor_(input)),
+                std::forward_as_tuple(sample_size_, rng_)).first;
+        }
+        it->second.sampler.add(input, 1.0);
+    }
+
+    void Execute() final {
+        std::vector<KeyThresholds> local;
+        local.reserve(strata_.size());
+        for (const auto& s : strata_)
+            local.emplace_back(s.first, s.second.sampler.sorted_keys());
+
+        size_t sample_size = sample_size_;
+
+        // merge the random keys of the reservoirs of equal keys
+        std::vector<KeyThresholds> global = context_.net.AllReduce(
+            local,
+            [sample_size](const std::vector<KeyThresholds>& a,
+                          const std::vector<KeyThresholds>& b) {
+                std::unordered_map<Key, std::vector<double> > merged(
+                    a.begin(), a.end());
+                for (const KeyThresholds& kt : b) {
+                    std::vector<double>& keys = merged[kt.first];
+                    keys = Sampler::MergeKeys(keys, kt.second, sample_size);
+                }
+                return std::vector<KeyThresholds>(
+                    merged.begin(), merged.end());
+            });
+
+        for (const KeyThresholds& kt : global) {
+            auto it = strata_.find(kt.first);
+            if (it == strata_.end()) continue;
+            it->second.threshold =
+                kt.second.size() < sample_size_ ? 0.0 : kt.second.back();
+        }
+
+        sLOG << "SampleByKeyNode::Execute()" << strata_.size()
+             << "local strata of" << global.size();
+    }
+
+    void PushData(bool consume) final {
+        for (const auto& s : strata_) {
+            for (const KeyItem& ki : s.second.samples) {
+                if (ki.first >= s.second.threshold)
+                    this->PushItem(ki.second);
+            }
+        }
+        if (consume)
+            strata_.clear();
+    }
+
+    void Dispose() final {
+        strata_.clear();
+    }
+
+private:
+    //! key of each item
+    KeyExtractor key_extractor_;
+    //! number of samples to draw per key
+    size_t sample_size_;
+    //! Random generator for reservoir samplers
+    RNG rng_ { std::random_device { } () };
+    //! reservoir of each local key
+    std::unordered_map<Key, Stratum> strata_;
+};
+
+template <typename ValueType, typename Stack>
+template <typename KeyExtractor>
+auto DIA<ValueType, Stack>::SampleByKey(
+    const KeyExtractor& key_extractor, size_t sample_size) const {
+    assert(IsValid());
+
+    using SampleByKeyNode = api::SampleByKeyNode<ValueType, KeyExtractor>;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<KeyExtractor>::template arg<0> >::value,
+        "KeyExtractor has the wrong input type");
+
+    auto node = tlx::make_counting<SampleByKeyNode>(
+        *this, key_extractor, sample_size);
+
+    return DIA<ValueType>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_SAMPLE_BY_KEY_HEADER
+
+/******************************************************************************/
@@ -18,6 +18,8 @@
 #include <thrill/api/dia.hpp>
 #include <thrill/net/group.hpp>
 
+#include <future>
+
 namespace thrill {
 namespace api {
 
@@ -60,17 +62,32 @@ public:
         return true;
     }
 
+    //! The number of items does not depend on their order.
+    bool OrderAgnostic() const final { return true; }
+
     //! Executes the size operation.
     void Execute() final {
         // get the number of elements that are stored on this worker
         LOG << "MainOp processing, sum: " << local_size_;
 
-        // process the reduce, default argument is SumOp.
-        global_size_ = context_.net.AllReduce(local_size_);
+        // reuse the size recorded by the parent, e.g. Generate() or Cache()
+        const KnownSize& parent_size = this->parent_known_size(0);
+        if (parent_stack_empty_ && parent_size.known()) {
+            global_size_ = parent_size.total;
+            return;
+        }
+
+        // start the reduce, default argument is SumOp. The result is only
+        // awaited in result(), hence following stages may start meanwhile.
+        future_size_ = context_.net.AllReduceAsync(local_size_);
     }
 
     //! Returns result of global size.
     const size_t& result() const final {
+        if (future_size_.valid()) {
+            global_size_ = future_size_.get();
+            future_size_ = std::shared_future<size_t>();
+        }
         return global_size_;
     }
 
@@ -80,7 +97,9 @@ private:
     // Local size to be used.
     size_t local_size_ = 0;
     // Global size resulting from all reduce.
-    size_t global_size_ = 0;
+    mutable size_t global_size_ = 0;
+    // Future of the global size while the all reduce is running.
+    mutable std::shared_future<size_t> future_size_;
 };
 
 template <typename ValueType, typename Stack>
@@ -17,24 +17,35 @@
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
 #include <thrill/api/dop_node.hpp>
+#include <thrill/common/accelerator.hpp>
+#include <thrill/common/cpu_placement.hpp>
+#include <thrill/common/cycle_timer.hpp>
+#include <thrill/common/key_prefix.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/common/porting.hpp>
 #include <thrill/common/qsort.hpp>
+#include <thrill/common/radix_sort.hpp>
 #include <thrill/common/reservoir_sampling.hpp>
+#include <thrill/common/stats_timer.hpp>
 #include <thrill/core/multiway_merge.hpp>
 #include <thrill/data/file.hpp>
+#include <thrill/data/merge_prefetch_tuner.hpp>
 #include <thrill/net/group.hpp>
 
+#include <tlx/define/likely.hpp>
 #include <tlx/math/integer_log2.hpp>
 #include <tlx/vector_free.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <deque>
 #include <functional>
 #include <numeric>
 #include <random>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -42,6 +53,67 @@
 namespace thrill {
 namespace api {
 
+/*!
+ * Detects whether a SortAlgorithm class delivers order-preserving 64-bit key
+ * prefixes of items via a KeyPrefix() method, which SortNode then caches in its
+ * merge trees. Such classes set use_key_prefix and define exact_key_prefix.
+ */
+template <typename SortAlgorithm, typename Enable = void>
+struct SortAlgorithmUsesKeyPrefix : public std::false_type { };
+
+template <typename SortAlgorithm>
+struct SortAlgorithmUsesKeyPrefix<
+    SortAlgorithm,
+    typename std::enable_if<SortAlgorithm::use_key_prefix>::type>
+    : public std::true_type { };
+
+/*!
+ * Phase timings of a SortNode on the local worker in seconds. They remain
+ * available from the DIA after the Sort() was executed, see
+ * GetSortPhaseStats().
+ */
+struct SortPhaseStats {
+    //! receiving items from the parent and sampling them
+    double preop = 0;
+    //! storing and sampling the items in PreOp(), a part of preop
+    double preop_items = 0;
+    //! selecting and distributing the splitters
+    double sample = 0;
+    //! classifying, transmitting, and receiving items, including local_sort
+    double exchange = 0;
+    //! sorting the received runs
+    double local_sort = 0;
+    //! merging the sorted runs and pushing them to the children
+    double merge = 0;
+    //! pulling items from the final multiway merge tree, a part of merge
+    double merge_pull = 0;
+    //! number of items received by the worker
+    size_t items = 0;
+    //! number of sorted runs
+    size_t runs = 0;
+};
+
+//! Non-template base of SortNode holding its SortPhaseStats.
+class SortNodeBase
+{
+public:
+    const SortPhaseStats& phase_stats() const { return phase_stats_; }
+
+protected:
+    SortPhaseStats phase_stats_;
+};
+
+/*!
+ * Returns the SortPhaseStats of the local worker if the DIA was created by a
+ * Sort() operation, otherwise nullptr.
+ */
+template <typename DIAType>
+const SortPhaseStats * GetSortPhaseStats(const DIAType& dia) {
+    const SortNodeBase* node =
+        dynamic_cast<const SortNodeBase*>(dia.node().get());
+    return node ? &node->phase_stats() : nullptr;
+}
+
 /*!
  * A DIANode which performs a Sort operation. Sort sorts a DIA according to a
  * given compare function
@@ -61,7 +133,7 @@ template <
     typename CompareFunction,
     typename SortAlgorithm,
     bool Stable = false>
-class SortNode final : public DOpNode<ValueType>
+class SortNode final : public DOpNode<ValueType>, public SortNodeBase
 {
     static constexpr bool debug = false;
 
@@ -71,8 +143,8 @@ class SortNode final : public DOpNode<ValueType>
     using Super = DOpNode<ValueType>;
     using Super::context_;
 
-    //! Timer or FakeTimer
-    using Timer = common::StatsTimerBaseStopped<stats_enabled>;
+    //! Timer of the phases, which are always measured for phase_stats()
+    using Timer = common::StatsTimerStopped;
     //! RIAA class for running the timer
     using RunTimer = common::RunTimer<Timer>;
 
@@ -113,8 +185,22 @@ class SortNode final : public DOpNode<ValueType>
         Stable,
         MakeStableMultiwayMergeTree, MakeDefaultMultiwayMergeTree>::type;
 
+    //! Whether the merge trees cache key prefixes delivered by SortAlgorithm
+    static constexpr bool use_key_prefix_ =
+        SortAlgorithmUsesKeyPrefix<SortAlgorithm>::value;
+
     static const bool use_background_thread_ = false;
 
+    //! Minimum number of items per part if a run is sorted in parallel.
+    static const size_t parallel_sort_min_items_ = 64 * 1024;
+
+    //! Number of parts per thread if a run is sorted in parallel, such that
+    //! parts can be stolen from threads which are slower.
+    static const size_t parallel_sort_parts_per_thread_ = 2;
+
+    //! Number of items between progress reports.
+    static const size_t progress_interval_ = 64 * 1024;
+
 public:
     /*!
      * Constructor for a sort node.
@@ -139,12 +225,19 @@ public:
     void StartPreOp(size_t /* parent_index */) final {
         timer_preop_.Start();
         unsorted_writer_ = unsorted_file_.GetWriter();
+        context_.StartProgress(this, ProgressPhase::PreOp);
     }
 
     void PreOp(const ValueType& input) {
+        timer_preop_items_.Start();
         unsorted_writer_.Put(input);
         res_sampler_.add(SampleIndexPair(input, local_items_));
         local_items_++;
+        if (TLX_UNLIKELY(local_items_ % progress_interval_ == 0)) {
+            context_.ReportProgress(
+                this->dia_id(), local_items_, unsorted_file_.size_bytes());
+        }
+        timer_preop_items_.Stop();
     }
 
     //! Receive a whole data::File of ValueType, but only if our stack is empty.
@@ -176,11 +269,16 @@ public:
 
     void StopPreOp(size_t /* parent_index */) final {
         unsorted_writer_.Close();
+        context_.ReportProgress(
+            this->dia_id(), local_items_, unsorted_file_.size_bytes());
+        context_.StopProgress(this->dia_id());
 
         LOG0 << "wanted_sample_size()=" << wanted_sample_size()
              << " samples.size()= " << samples_.size();
 
         timer_preop_.Stop();
+        phase_stats_.preop = timer_preop_.SecondsDouble();
+        phase_stats_.preop_items = timer_preop_items_.SecondsDouble();
         if (stats_enabled) {
             context_.PrintCollectiveMeanStdev(
                 "Sort() timer_preop_", timer_preop_.SecondsDouble());
@@ -230,7 +328,7 @@ public:
 
             // merge batches of files if necessary
             while (std::tie(merge_degree, prefetch) =
-                       context_.block_pool().MaxMergeDegreePrefetch(files_.size()),
+                       merge_tuner_.MergeDegreePrefetch(files_.size()),
                    files_.size() > merge_degree)
             {
                 PartialMultiwayMerge(merge_degree, prefetch);
@@ -249,18 +347,32 @@ public:
                     files_[t].GetReader(consume, /* prefetch */ 0));
             }
 
-            StartPrefetch(seq, prefetch);
+            merge_tuner_.Start(seq, prefetch);
+            context_.StartProgress(
+                this, ProgressPhase::PushData, NumFileItems(files_));
 
-            auto puller = MakeMultiwayMergeTree()(
-                seq.begin(), seq.end(), compare_function_);
+            auto puller = MakeMergeTree(seq.begin(), seq.end());
+            common::CycleTimer timer_pull;
 
             while (puller.HasNext()) {
-                this->PushItem(puller.Next());
+                timer_pull.Start();
+                ValueType item = puller.Next();
+                timer_pull.Stop();
+                this->PushItem(item);
                 local_size++;
+                merge_tuner_.Tick(seq);
+                if (TLX_UNLIKELY(local_size % progress_interval_ == 0))
+                    context_.ReportProgress(this->dia_id(), local_size);
             }
+
+            context_.ReportProgress(this->dia_id(), local_size);
+            context_.StopProgress(this->dia_id());
+            LogMergeStats("merge");
+            phase_stats_.merge_pull = timer_pull.SecondsDouble();
         }
 
         timer_pushdata.Stop();
+        phase_stats_.merge = timer_pushdata.SecondsDouble();
 
         if (stats_enabled) {
             context_.PrintCollectiveMeanStdev(
@@ -278,12 +390,44 @@ private:
     //! The comparison function which is applied to two elements.
     CompareFunction compare_function_;
 
+    //! Create multiway merge tree for the readers, which caches key prefixes if
+    //! the SortAlgorithm delivers them.
+    template <typename ReaderIterator>
+    auto MakeMergeTree(ReaderIterator seqs_begin, ReaderIterator seqs_end) {
+        return MakeMergeTree(seqs_begin, seqs_end,
+                             std::integral_constant<bool, use_key_prefix_>());
+    }
+
+    template <typename ReaderIterator>
+    auto MakeMergeTree(ReaderIterator seqs_begin, ReaderIterator seqs_end,
+                       std::false_type /* use_key_prefix */) {
+        return MakeMultiwayMergeTree()(seqs_begin, seqs_end, compare_function_);
+    }
+
+    template <typename ReaderIterator>
+    auto MakeMergeTree(ReaderIterator seqs_begin, ReaderIterator seqs_end,
+                       std::true_type /* use_key_prefix */) {
+        const SortAlgorithm& sort_algorithm = sort_algorithm_;
+        return core::make_prefix_multiway_merge_tree<
+            ValueType, Stable, SortAlgorithm::exact_key_prefix>(
+            seqs_begin, seqs_end, compare_function_,
+            [&sort_algorithm](const ValueType& v) {
+                return sort_algorithm.KeyPrefix(v);
+            });
+    }
+
     //! Sort function class
     SortAlgorithm sort_algorithm_;
 
     //! Whether the parent stack is empty
     const bool parent_stack_empty_;
 
+    //! Selects merge degree and prefetch of the external merges and collects
+    //! their read statistics.
+    data::MergePrefetchTuner merge_tuner_ {
+        context_.block_pool(), context_.mem_config().enable_adaptive_merge_
+    };
+
     //! \name PreOp Phase
     //! \{
 
@@ -326,6 +470,9 @@ private:
     //! time spent in PreOp (including preceding Node's computation)
     Timer timer_preop_;
 
+    //! time spent in PreOp() itself, measured per item in cycles
+    common::CycleTimer timer_preop_items_;
+
     //! time spent in Execute
     Timer timer_execute_;
 
@@ -361,13 +508,12 @@ private:
                       return LessSampleIndex(a, b);
                   });
 
-        double splitting_size = static_cast<double>(samples.size())
-                                / static_cast<double>(num_total_workers);
-
-        // Send splitters to other workers
+        // Send splitters to other workers, which split the samples in
+        // proportion to the host weights of the workers.
         for (size_t i = 1; i < num_total_workers; ++i) {
             splitters.push_back(
-                samples[static_cast<size_t>(i * splitting_size)]);
+                samples[std::min(context_.CalculatePartBegin(samples.size(), i),
+                                 samples.size() - 1)]);
             for (size_t j = 1; j < num_total_workers; j++) {
                 sample_writers[j].Put(splitters.back());
             }
@@ -421,14 +567,77 @@ private:
             !compare_function_(b.first, a.first) && a.second < b.second);
     }
 
-    bool EqualSampleGreaterIndex(const SampleIndexPair& a, const SampleIndexPair& b) {
-        return !compare_function_(a.first, b.first) && a.second >= b.second;
+    /*!
+     * Calculate for each splitter the first splitter of the run of equal
+     * splitters it belongs to. Duplicate-heavy keys, like status codes or
+     * dates, are sampled many times and repeat as splitters.
+     */
+    std::vector<size_t> FindSplitterRuns(
+        const std::vector<SampleIndexPair>& splitters) {
+        std::vector<size_t> run_begin(splitters.size());
+        for (size_t s = 1; s < splitters.size(); ++s) {
+            run_begin[s] =
+                compare_function_(splitters[s - 1].first, splitters[s].first)
+                ? s : run_begin[s - 1];
+        }
+        return run_begin;
     }
 
-    //! round n down by k where k is a power of two.
-    template <typename Integral>
-    static inline size_t RoundDown(Integral n, Integral k) {
-        return (n & ~(k - 1));
+    //! number of items classified at once in TransmitItems()
+    static constexpr size_t classify_batch_ = 16;
+
+    /*!
+     * Classify a batch of up to classify_batch_ items from the reader using
+     * the splitter tree and transmit them to the writers of their bucket. The
+     * items of the batch descend the tree level by level, hence the
+     * comparisons of one level are independent of each other and are
+     * pipelined by the CPU instead of waiting on each other. The descent
+     * itself is branchless. The BlockWriters buffer items per bucket.
+     */
+    template <typename Reader, typename Writers>
+    void ClassifyBatch(
+        size_t batch_size, Reader& reader, Writers& writers,
+        const ValueType* const tree, size_t k, size_t log_k,
+        const SampleIndexPair* const sorted_splitters,
+        const size_t* const splitter_run_begin, size_t index) {
+
+        assert(batch_size <= classify_batch_);
+
+        std::array<ValueType, classify_batch_> items;
+        std::array<size_t, classify_batch_> bkt;
+
+        for (size_t b = 0; b < batch_size; ++b) {
+            items[b] = reader.template Next<ValueType>();
+            bkt[b] = 1;
+        }
+
+        // run items down the tree
+        for (size_t l = 0; l < log_k; ++l) {
+            for (size_t b = 0; b < batch_size; ++b) {
+                bkt[b] = 2 * bkt[b] + static_cast<size_t>(
+                    !compare_function_(items[b], tree[bkt[b]]));
+            }
+        }
+
+        for (size_t b = 0; b < batch_size; ++b) {
+            size_t b0 = bkt[b] - k;
+
+            // items equal to a run of splitters are spread across the run's
+            // buckets by their global index, which the splitters carry from
+            // their sample, and not all sent to the bucket right of the run.
+            if (b0 && !compare_function_(
+                    sorted_splitters[b0 - 1].first, items[b])) {
+                b0 = std::lower_bound(
+                    sorted_splitters + splitter_run_begin[b0 - 1],
+                    sorted_splitters + b0, index + b,
+                    [](const SampleIndexPair& s, size_t i) {
+                        return s.second < i;
+                    }) - sorted_splitters;
+            }
+
+            assert(writers[b0].IsValid());
+            writers[b0].Put(items[b]);
+        }
     }
 
     void TransmitItems(
@@ -440,6 +649,8 @@ private:
         // Number of actual workers to send to
         size_t actual_k,
         const SampleIndexPair* const sorted_splitters,
+        // First splitter of the run of equal splitters of each splitter
+        const size_t* const splitter_run_begin,
         size_t prefix_items,
         TranmissionStreamPtr& data_stream) {
 
@@ -460,75 +671,23 @@ private:
 
         std::swap(data_writers[actual_k - 1], data_writers[k - 1]);
 
-        // classify all items (take two at once) and immediately transmit them.
-
-        const size_t stepsize = 2;
+        // classify all items in batches and immediately transmit them.
 
         size_t i = prefix_items;
-        for ( ; i < prefix_items + RoundDown(local_items_, stepsize); i += stepsize)
+        for ( ; i + classify_batch_ <= prefix_items + local_items_;
+              i += classify_batch_)
         {
-            // take two items
-            size_t j0 = 1;
-            ValueType el0 = unsorted_reader.Next<ValueType>();
-
-            size_t j1 = 1;
-            ValueType el1 = unsorted_reader.Next<ValueType>();
-
-            // run items down the tree
-            for (size_t l = 0; l < log_k; l++)
-            {
-                j0 = 2 * j0 + (compare_function_(el0, tree[j0]) ? 0 : 1);
-                j1 = 2 * j1 + (compare_function_(el1, tree[j1]) ? 0 : 1);
-            }
-
-            size_t b0 = j0 - k;
-            size_t b1 = j1 - k;
-
-            while (b0 && EqualSampleGreaterIndex(
-                       sorted_splitters[b0 - 1], SampleIndexPair(el0, i + 0))) {
-                b0--;
-
-                // LOG0 << "el0 equal match b0 " << b0
-                //      << " prefix_items " << prefix_items
-                //      << " lhs.first = " << sorted_splitters[b0 - 1].first
-                //      << " lhs.second = " << sorted_splitters[b0 - 1].second
-                //      << " rhs.first = " << el0
-                //      << " rhs.second = " << i;
-            }
-
-            while (b1 && EqualSampleGreaterIndex(
-                       sorted_splitters[b1 - 1], SampleIndexPair(el1, i + 1))) {
-                b1--;
-            }
-
-            assert(data_writers[b0].IsValid());
-            assert(data_writers[b1].IsValid());
-
-            data_writers[b0].Put(el0);
-            data_writers[b1].Put(el1);
+            ClassifyBatch(classify_batch_, unsorted_reader, data_writers,
+                          tree, k, log_k, sorted_splitters,
+                          splitter_run_begin, i);
         }
 
-        // last iteration of loop if we have an odd number of items.
-        for ( ; i < prefix_items + local_items_; i++)
-        {
-            size_t j0 = 1;
-            ValueType el0 = unsorted_reader.Next<ValueType>();
-
-            // run item down the tree
-            for (size_t l = 0; l < log_k; l++)
-            {
-                j0 = 2 * j0 + (compare_function_(el0, tree[j0]) ? 0 : 1);
-            }
-
-            size_t b0 = j0 - k;
-
-            while (b0 && EqualSampleGreaterIndex(
-                       sorted_splitters[b0 - 1], SampleIndexPair(el0, i))) {
-                b0--;
-            }
-
-            assert(data_writers[b0].IsValid());
-            data_writers[b0].Put(el0);
+        // last batch if the number of items is not a multiple of the size.
+        if (i < prefix_items + local_items_) {
+            ClassifyBatch(prefix_items + local_items_ - i,
+                          unsorted_reader, data_writers,
+                          tree, k, log_k, sorted_splitters,
+                          splitter_run_begin, i);
         }
 
         // implicitly close writers and flush data
@@ -536,6 +695,14 @@ private:
 
     void MainOp() {
         RunTimer timer(timer_execute_);
+        common::StatsTimerStart phase_timer;
+
+        // register as busy worker until all runs are sorted, such that
+        // workers which finish early can lend their cores to others. This
+        // happens before the collective below, hence all local workers are
+        // registered before any of them starts borrowing.
+        common::WorkerShare::BusyScope busy_scope(
+            context_.worker_share(), context_.local_worker_id());
 
         size_t prefix_items = local_items_;
         size_t total_items = context_.net.ExPrefixSumTotal(prefix_items);
@@ -612,6 +779,12 @@ private:
                     splitters.data(),
                     splitter_count_algo);
 
+        std::vector<size_t> splitter_run_begin = FindSplitterRuns(splitters);
+
+        phase_timer.Stop();
+        phase_stats_.sample = phase_timer.SecondsDouble();
+        phase_timer.Reset().Start();
+
         auto data_stream = context_.template GetNewStream<TranmissionStreamType>(this->dia_id());
 
         std::thread thread;
@@ -619,7 +792,8 @@ private:
             // launch receiver thread.
             thread = common::CreateThread(
                 [this, &data_stream]() {
-                    common::SetCpuAffinity(context_.local_worker_id());
+                    common::SetCpuAffinity(
+                        common::CpuPlacementCpu(context_.local_worker_id()));
                     return ReceiveItems(data_stream);
                 });
         }
@@ -630,6 +804,7 @@ private:
             ceil_log,
             num_total_workers,
             splitters.data(),
+            splitter_run_begin.data(),
             prefix_items,
             data_stream);
 
@@ -642,6 +817,12 @@ private:
 
         data_stream.reset();
 
+        phase_timer.Stop();
+        phase_stats_.exchange = phase_timer.SecondsDouble();
+        phase_stats_.local_sort = timer_sort_.SecondsDouble();
+        phase_stats_.items = local_out_size_;
+        phase_stats_.runs = files_.size();
+
         double balance = 0;
         if (local_out_size_ > 0) {
             balance = static_cast<double>(local_out_size_)
@@ -674,11 +855,22 @@ private:
         std::vector<ValueType> vec;
         vec.reserve(capacity);
 
+        // write a run early if the BlockPool runs short of RAM
+        data::ReclaimFlag reclaim(context_.block_pool());
+
+        // replacement selection reorders equal items, hence not if Stable
+        const bool replacement_selection =
+            !Stable && context_.mem_config().enable_replacement_selection_;
+
         while (reader.HasNext()) {
             if (vec.size() < capacity_half ||
-                (vec.size() < capacity && !mem::memory_exceeded)) {
+                (vec.size() < capacity && !mem::memory_exceeded &&
+                 !reclaim.test_and_clear())) {
                 vec.push_back(reader.template Next<ValueType>());
             }
+            else if (replacement_selection) {
+                ReplacementSelection(reader, vec, capacity_half, reclaim);
+            }
             else {
                 SortAndWriteToFile(vec);
             }
@@ -693,6 +885,82 @@ private:
         }
     }
 
+    /*!
+     * Form runs from the full vec and the following items of the reader by
+     * replacement selection: vec[0,heap_size) is a min-heap of the current
+     * run, and its smallest item is written and replaced by the next item
+     * read. Items smaller than the last one written belong to the next run,
+     * and are stored behind the heap in the slot it frees. On random input,
+     * the runs are about twice as long as vec, and on presorted input only
+     * one run is written, such that fewer runs need to be merged.
+     *
+     * Returns when the reader is exhausted or the memory pressure emptied
+     * vec. The items of the next run are left in vec.
+     */
+    template <typename Reader>
+    void ReplacementSelection(Reader& reader, std::vector<ValueType>& vec,
+                              size_t capacity_half,
+                              data::ReclaimFlag& reclaim) {
+
+        auto heap_less = [this](const ValueType& a, const ValueType& b) {
+                             return compare_function_(b, a);
+                         };
+
+        RunTimer timer(timer_sort_);
+
+        // shrinks to capacity_half if the BlockPool runs short of RAM
+        size_t max_size = vec.size();
+        size_t heap_size = 0, run_items = 0;
+        data::File::Writer writer;
+
+        while (true) {
+            if (heap_size == 0) {
+                if (run_items != 0) {
+                    writer.Close();
+                    local_out_size_ += run_items;
+
+                    Super::logger_
+                        << "class" << "SortNode"
+                        << "event" << "replacement_selection"
+                        << "file_num" << (files_.size() - 1)
+                        << "items" << run_items;
+                }
+                if (vec.empty() || !reader.HasNext()) return;
+
+                // start the next run from the items behind the heap
+                heap_size = vec.size();
+                std::make_heap(vec.begin(), vec.end(), heap_less);
+                files_.emplace_back(context_.GetFile(this));
+                writer = files_.back().GetWriter();
+                run_items = 0;
+            }
+
+            std::pop_heap(vec.begin(), vec.begin() + heap_size, heap_less);
+            --heap_size;
+            writer.Put(vec[heap_size]);
+            ++run_items;
+
+            if (mem::memory_exceeded || reclaim.test_and_clear())
+                max_size = std::min(max_size, capacity_half);
+
+            if (vec.size() > max_size || !reader.HasNext()) {
+                // drop the written item, its slot takes the last item
+                if (heap_size + 1 != vec.size())
+                    vec[heap_size] = std::move(vec.back());
+                vec.pop_back();
+                continue;
+            }
+
+            ValueType item = reader.template Next<ValueType>();
+            bool same_run = !compare_function_(item, vec[heap_size]);
+            vec[heap_size] = std::move(item);
+            if (same_run) {
+                ++heap_size;
+                std::push_heap(vec.begin(), vec.begin() + heap_size, heap_less);
+            }
+        }
+    }
+
     void SortAndWriteToFile(std::vector<ValueType>& vec) {
 
         LOG << "SortAndWriteToFile() " << vec.size()
@@ -707,22 +975,84 @@ private:
         // context_.block_pool().AdviseFree(vec.size() * sizeof(ValueType));
 
         timer_sort_.Start();
-        sort_algorithm_(vec.begin(), vec.end(), compare_function_);
-        // common::qsort_two_pivots_yaroslavskiy(vec.begin(), vec.end(), compare_function_);
-        // common::qsort_three_pivots(vec.begin(), vec.end(), compare_function_);
+
+        // borrow cores of idle local workers and split the run into parts,
+        // which are sorted in parallel and written to separate files. The
+        // parts are then merged together with all other runs in PushData().
+        std::vector<size_t> cores;
+        if (context_.mem_config().enable_parallel_local_sort_ &&
+            vec_size >= 2 * parallel_sort_min_items_) {
+            cores = context_.worker_share().Borrow(
+                vec_size / parallel_sort_min_items_ - 1);
+        }
+
+        // with borrowed cores, the run is split into more parts than threads,
+        // and the parts are sorted as tasks of the host's work stealing pool,
+        // such that threads finishing early take over parts of stragglers.
+        size_t num_parts = 1;
+        if (!cores.empty()) {
+            num_parts = std::min(vec_size / parallel_sort_min_items_,
+                                 parallel_sort_parts_per_thread_
+                                 * (cores.size() + 1));
+        }
+
+        std::vector<size_t> bounds(num_parts + 1);
+        for (size_t p = 0; p <= num_parts; ++p)
+            bounds[p] = vec_size * p / num_parts;
+
+        if (num_parts == 1) {
+            sort_algorithm_(vec.begin(), vec.end(), compare_function_);
+            // common::qsort_two_pivots_yaroslavskiy(vec.begin(), vec.end(), compare_function_);
+            // common::qsort_three_pivots(vec.begin(), vec.end(), compare_function_);
+        }
+        else {
+            common::WorkStealingPool& pool = context_.work_pool();
+            common::WorkStealingPool::TaskGroup group;
+            size_t local_worker_id = context_.local_worker_id();
+
+            for (size_t p = 0; p < num_parts; ++p) {
+                pool.Submit(local_worker_id, group,
+                            [this, &vec, &bounds, p]() {
+                                sort_algorithm_(
+                                    vec.begin() + bounds[p],
+                                    vec.begin() + bounds[p + 1],
+                                    compare_function_);
+                            });
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(cores.size());
+            for (size_t c = 0; c < cores.size(); ++c) {
+                size_t cpu = common::CpuPlacementCpu(cores[c]);
+                threads.emplace_back(common::CreateThread(
+                                         [&pool, &group,
+                                          local_worker_id, cpu]() {
+                                             common::SetCpuAffinity(cpu);
+                                             pool.Wait(local_worker_id, group);
+                                         }));
+            }
+
+            pool.Wait(local_worker_id, group);
+
+            for (std::thread& t : threads)
+                t.join();
+        }
+        context_.worker_share().Return(cores);
+
         timer_sort_.Stop();
 
-        LOG0 << "SortAndWriteToFile() sort took " << timer_sort_;
+        LOG0 << "SortAndWriteToFile() sort took " << timer_sort_
+             << " in " << num_parts << " parts";
 
         Timer write_time;
         write_time.Start();
 
-        files_.emplace_back(context_.GetFile(this));
-        auto writer = files_.back().GetWriter();
-        for (const ValueType& elem : vec) {
-            writer.Put(elem);
+        for (size_t p = 0; p < num_parts; ++p) {
+            files_.emplace_back(context_.GetFile(this));
+            auto writer = files_.back().GetWriter();
+            writer.PutBatch(vec.data() + bounds[p], bounds[p + 1] - bounds[p]);
+            writer.Close();
         }
-        writer.Close();
 
         write_time.Stop();
 
@@ -737,10 +1067,35 @@ private:
             << "event" << "write_file"
             << "file_num" << (files_.size() - 1)
             << "items" << vec_size
+            << "parts" << num_parts
             << "timer_sort_" << timer_sort_
             << "write_time" << write_time;
     }
 
+    //! Write statistics of the last merge to the JSON log
+    void LogMergeStats(const char* event) {
+        data::MergePrefetchTuner::MergeStats ms = merge_tuner_.Finish();
+
+        Super::logger_
+            << "class" << "SortNode"
+            << "event" << event
+            << "degree" << ms.degree
+            << "prefetch_begin" << ms.prefetch_begin
+            << "prefetch_end" << ms.prefetch_end
+            << "read_bytes" << ms.read_bytes
+            << "read_requests" << ms.read_requests
+            << "read_latency" << ms.read_latency
+            << "read_throughput" << ms.read_throughput
+            << "seconds" << ms.seconds;
+    }
+
+    //! total number of items in files
+    static size_t NumFileItems(const std::vector<data::File>& files) {
+        size_t total = 0;
+        for (const data::File& f : files) total += f.num_items();
+        return total;
+    }
+
     void PartialMultiwayMerge(size_t merge_degree, size_t prefetch) {
         sLOG1 << "Partial multi-way-merge of" << files_.size()
               << "files with degree" << merge_degree
@@ -748,6 +1103,15 @@ private:
 
         std::vector<data::File> new_files;
 
+        // each pass over the files is reported as its own phase
+        size_t pass_items = 0, merged_items = 0;
+        for (size_t fi = 0; fi + merge_degree < files_.size();
+             fi += merge_degree) {
+            for (size_t t = 0; t < merge_degree; ++t)
+                pass_items += files_[fi + t].num_items();
+        }
+        context_.StartProgress(this, ProgressPhase::PushData, pass_items);
+
         // merge batches of merge_degree Files into new_files
         size_t fi;
         for (fi = 0; fi + merge_degree < files_.size(); fi += merge_degree) {
@@ -760,10 +1124,9 @@ private:
                     files_[fi + t].GetConsumeReader(/* prefetch */ 0));
             }
 
-            StartPrefetch(seq, prefetch);
+            merge_tuner_.Start(seq, prefetch);
 
-            auto puller = MakeMultiwayMergeTree()(
-                seq.begin(), seq.end(), compare_function_);
+            auto puller = MakeMergeTree(seq.begin(), seq.end());
 
             // create new File for merged items
             new_files.emplace_back(context_.GetFile(this));
@@ -771,11 +1134,18 @@ private:
 
             while (puller.HasNext()) {
                 writer.Put(puller.Next());
+                merge_tuner_.Tick(seq);
+                if (TLX_UNLIKELY(++merged_items % progress_interval_ == 0))
+                    context_.ReportProgress(this->dia_id(), merged_items);
             }
             writer.Close();
 
+            LogMergeStats("partial_merge");
+
             // merged files are cleared by the ConsumeReader
         }
+        context_.ReportProgress(this->dia_id(), merged_items);
+        context_.StopProgress(this->dia_id());
 
         // copy remaining files into new_files
         for ( ; fi < files_.size(); ++fi) {
@@ -859,6 +1229,203 @@ auto DIA<ValueType, Stack>::Sort(const CompareFunction& compare_function,
     return DIA<ValueType>(node);
 }
 
+/*!
+ * SortAlgorithm class used by DIA::SortByKey(). If the Key delivered by the
+ * KeyExtractor is a fixed-size integral type or byte array, then the items are
+ * radix sorted by their keys. Otherwise, if the Key has an order-preserving
+ * 64-bit prefix (e.g. strings), then the prefix is extracted once per item and
+ * std::sort() compares the cached prefixes first, and only calls the given
+ * comparator on equal prefixes. Else it falls back to std::sort() with the
+ * comparator. The key prefixes are also cached in the merge trees of SortNode.
+ */
+template <typename KeyExtractor>
+class SortByKeyAlgorithm
+{
+public:
+    using Key = typename std::decay<
+        typename common::FunctionTraits<KeyExtractor>::result_type>::type;
+
+private:
+    //! stand-in for the Serialization of keys which are not radix sortable,
+    //! since these may not even be serializable.
+    struct NoRadixKey {
+        static constexpr bool is_fixed_size = false;
+    };
+
+public:
+    //! whether the items are radix sorted by their fixed-size Key
+    static constexpr bool use_radix_sort =
+        std::conditional<
+            common::RadixKeyTraits<Key>::is_radix_key,
+            data::Serialization<data::File::Writer, Key>,
+            NoRadixKey>::type::is_fixed_size;
+
+    //! whether order-preserving prefixes of the Key are cached
+    static constexpr bool use_key_prefix =
+        common::KeyPrefixTraits<Key>::is_prefix_key;
+
+    //! whether equal key prefixes imply equal keys
+    static constexpr bool exact_key_prefix =
+        common::KeyPrefixTraits<Key>::is_exact;
+
+    explicit SortByKeyAlgorithm(const KeyExtractor& key_extractor)
+        : key_extractor_(key_extractor) { }
+
+    template <typename Iterator, typename CompareFunction>
+    void operator () (Iterator begin, Iterator end, CompareFunction cmp) const {
+        return Sort(begin, end, cmp,
+                    std::integral_constant<bool, use_radix_sort>(),
+                    std::integral_constant<bool, use_key_prefix>());
+    }
+
+    //! order-preserving 64-bit prefix of the key of an item
+    template <typename ValueType>
+    uint64_t KeyPrefix(const ValueType& v) const {
+        return common::KeyPrefixTraits<Key>::prefix(key_extractor_(v));
+    }
+
+private:
+    //! key extractor function
+    KeyExtractor key_extractor_;
+
+    template <typename Iterator, typename CompareFunction,
+              typename UseKeyPrefix>
+    void Sort(Iterator begin, Iterator end, CompareFunction /* cmp */,
+              std::true_type /* use_radix_sort */, UseKeyPrefix) const {
+        common::radix_sort_key(begin, end, key_extractor_);
+    }
+
+    template <typename Iterator, typename CompareFunction>
+    void Sort(Iterator begin, Iterator end, CompareFunction cmp,
+              std::false_type /* use_radix_sort */,
+              std::true_type /* use_key_prefix */) const {
+        using ValueType = typename std::iterator_traits<Iterator>::value_type;
+        using Entry = std::pair<uint64_t, ValueType>;
+
+        // move items next to their cached key prefix, sort, and move back.
+        std::vector<Entry> entries;
+        entries.reserve(end - begin);
+        for (Iterator it = begin; it != end; ++it)
+            entries.emplace_back(KeyPrefix(*it), std::move(*it));
+
+        std::sort(entries.begin(), entries.end(),
+                  [&cmp](const Entry& a, const Entry& b) {
+                      if (a.first != b.first) return a.first < b.first;
+                      return !exact_key_prefix && cmp(a.second, b.second);
+                  });
+
+        for (Entry& e : entries)
+            *begin++ = std::move(e.second);
+    }
+
+    template <typename Iterator, typename CompareFunction>
+    void Sort(Iterator begin, Iterator end, CompareFunction cmp,
+              std::false_type /* use_radix_sort */,
+              std::false_type /* use_key_prefix */) const {
+        std::sort(begin, end, cmp);
+    }
+};
+
+/*!
+ * SortAlgorithm class which sorts the runs of SortNode on a GPU, if Thrill was
+ * built with THRILL_USE_CUDA and a device is available. It applies to Keys
+ * with an exact order-preserving 64-bit prefix, i.e. integers and byte arrays
+ * of up to 8 bytes: the prefixes and the indexes of the items are sorted on
+ * the device, and then the items are permuted on the host. Hence only the
+ * keys are transferred and the items may be of any type. Other Keys, small
+ * runs, and runs which do not fit into device memory are sorted on the CPU
+ * like by SortByKeyAlgorithm, whose key prefixes also speed up the merges.
+ *
+ * \code
+ * auto key = [](const Item& i) { return i.key; };
+ * dia.Sort([key](const Item& a, const Item& b) { return key(a) < key(b); },
+ *          api::AcceleratorSortAlgorithm<decltype(key)>(key));
+ * \endcode
+ */
+template <typename KeyExtractor>
+class AcceleratorSortAlgorithm : public SortByKeyAlgorithm<KeyExtractor>
+{
+public:
+    using Super = SortByKeyAlgorithm<KeyExtractor>;
+    using Key = typename Super::Key;
+
+    //! whether runs are sorted on the accelerator if it is available
+    static constexpr bool use_accelerator =
+        common::KeyPrefixTraits<Key>::is_prefix_key &&
+        common::KeyPrefixTraits<Key>::is_exact;
+
+    explicit AcceleratorSortAlgorithm(const KeyExtractor& key_extractor)
+        : Super(key_extractor) { }
+
+    template <typename Iterator, typename CompareFunction>
+    void operator () (Iterator begin, Iterator end, CompareFunction cmp) const {
+        if (!SortOnDevice(begin, end,
+                          std::integral_constant<bool, use_accelerator>()))
+            Super::operator () (begin, end, cmp);
+    }
+
+private:
+    template <typename Iterator>
+    bool SortOnDevice(Iterator, Iterator, std::false_type) const {
+        return false;
+    }
+
+    template <typename Iterator>
+    bool SortOnDevice(Iterator begin, Iterator end, std::true_type) const {
+        using ValueType = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t n = end - begin;
+        if (n < common::accelerator_min_items || n > UINT32_MAX ||
+            !common::AcceleratorAvailable())
+            return false;
+
+        std::vector<uint64_t> keys(n);
+        std::vector<uint32_t> index(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = Super::KeyPrefix(begin[i]);
+            index[i] = static_cast<uint32_t>(i);
+        }
+
+        if (!common::AcceleratorSortPairs(keys.data(), index.data(), n))
+            return false;
+
+        std::vector<ValueType> sorted;
+        sorted.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            sorted.emplace_back(std::move(begin[index[i]]));
+        std::move(sorted.begin(), sorted.end(), begin);
+        return true;
+    }
+};
+
+template <typename ValueType, typename Stack>
+template <typename KeyExtractor>
+auto DIA<ValueType, Stack>::SortByKey(const KeyExtractor& key_extractor) const {
+    assert(IsValid());
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<KeyExtractor>::template arg<0> >::value,
+        "KeyExtractor has the wrong input type");
+
+    auto compare_function =
+        [key_extractor](const ValueType& a, const ValueType& b) {
+            return key_extractor(a) < key_extractor(b);
+        };
+
+    using CompareFunction = decltype(compare_function);
+    using SortAlgorithm = SortByKeyAlgorithm<KeyExtractor>;
+
+    using SortNode = api::SortNode<
+        ValueType, CompareFunction, SortAlgorithm>;
+
+    auto node = tlx::make_counting<SortNode>(
+        *this, compare_function, SortAlgorithm(key_extractor));
+
+    return DIA<ValueType>(node);
+}
+
 class DefaultStableSortAlgorithm
 {
 public:
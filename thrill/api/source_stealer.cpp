@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * thrill/api/source_stealer.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/source_stealer.hpp>
+
+#include <thrill/common/logger.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace thrill {
+namespace api {
+
+static constexpr bool debug = false;
+
+SourceStealer::SourceStealer(
+    Context& ctx, const common::Range& local_range, size_t chunk_size,
+    bool local_storage)
+    : ctx_(ctx), local_storage_(local_storage) {
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+
+    auto ranges = ctx_.net.AllGather(
+        std::make_pair(local_range.begin, local_range.end));
+
+    for (const std::pair<size_t, size_t>& r : *ranges) {
+        common::Range range(r.first, r.second);
+        size_t chunks = (range.size() + chunk_size - 1) / chunk_size;
+        ranges_.push_back(range);
+        num_chunks_.push_back(
+            std::max<size_t>(1, std::min<size_t>(chunks, max_chunks_)));
+    }
+    own_end_ = num_chunks_;
+}
+
+bool SourceStealer::Exchange() {
+    const size_t me = ctx_.my_rank();
+    const size_t workers_per_host = ctx_.workers_per_host();
+
+    // progress of all workers: next own chunk and pending stolen chunks
+    auto progress = ctx_.net.AllGather(
+        std::make_pair(next_own_, my_steals_.size() - next_steal_));
+
+    const size_t num_workers = progress->size();
+    std::vector<size_t> remaining(num_workers);
+    size_t total = 0;
+    for (size_t w = 0; w < num_workers; ++w) {
+        remaining[w] = own_end_[w] - (*progress)[w].first;
+        total += remaining[w] + (*progress)[w].second;
+    }
+
+    if (total == 0) return false;
+
+    // idle workers in order of their rank take the tail half of the unread
+    // chunks of the worker with most of them.
+    for (size_t thief = 0; thief < num_workers; ++thief) {
+        if (remaining[thief] != 0 || (*progress)[thief].second != 0)
+            continue;
+
+        size_t victim = num_workers;
+        for (size_t w = 0; w < num_workers; ++w) {
+            if (local_storage_ &&
+                w / workers_per_host != thief / workers_per_host)
+                continue;
+            if (remaining[w] >= 2 &&
+                (victim == num_workers || remaining[w] > remaining[victim]))
+                victim = w;
+        }
+        if (victim == num_workers) continue;
+
+        size_t take = remaining[victim] / 2;
+        own_end_[victim] -= take;
+        remaining[victim] -= take;
+
+        sLOG << "SourceStealer: worker" << thief << "steals" << take
+             << "chunks of worker" << victim;
+
+        for (size_t c = own_end_[victim]; c < own_end_[victim] + take; ++c) {
+            if (thief == me)
+                my_steals_.push_back(steals_.size());
+            steals_.push_back(Steal { victim, c, thief });
+        }
+    }
+
+    return true;
+}
+
+} // namespace api
+} // namespace thrill
+
+/******************************************************************************/
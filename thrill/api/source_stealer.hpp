@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * thrill/api/source_stealer.hpp
+ *
+ * Re-splitting of the unread parts of source nodes' ranges from straggling
+ * workers to those which are done.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_SOURCE_STEALER_HEADER
+#define THRILL_API_SOURCE_STEALER_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/common/math.hpp>
+#include <thrill/data/cat_stream.hpp>
+#include <thrill/data/file.hpp>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+//! \ingroup api_layer
+//! \{
+
+/*!
+ * Opt-in work re-splitting for source nodes, enabled by
+ * MemoryConfig::source_steal_interval_. The local range of each worker, e.g.
+ * of bytes of a vfs::FileList, is split into chunks, which the worker reads in
+ * order. Every interval, all workers exchange how many of their chunks they
+ * have read with an AllGather over the FlowControlChannel. Workers which are
+ * done take the tail half of the unread chunks of the worker with most of them,
+ * hence a slow disk or a noisy neighbour delays the stage by about one
+ * interval instead of its whole remaining range.
+ *
+ * To keep the order of the DIA, a thief sends the items of stolen chunks on a
+ * CatStream to the owner, which pushes them after its own chunks. With local
+ * storage, when each host reads its own files, only workers on the same host
+ * steal from each other.
+ *
+ * All workers exchange their progress every interval, hence idle workers wait
+ * in the collective for at most one interval and one chunk of the others.
+ */
+class SourceStealer
+{
+public:
+    //! a chunk of the range of owner, which thief reads
+    struct Steal {
+        size_t owner;
+        size_t chunk;
+        size_t thief;
+    };
+
+    //! maximum number of chunks of the local range of a worker
+    static constexpr size_t max_chunks_ = 1024;
+
+    /*!
+     * Gathers the local ranges of all workers, which are split into chunks of
+     * about chunk_size. Must be called by all workers.
+     */
+    SourceStealer(Context& ctx, const common::Range& local_range,
+                  size_t chunk_size, bool local_storage);
+
+    //! whether the source nodes should re-split their ranges
+    static bool Enabled(Context& ctx) {
+        return ctx.mem_config().source_steal_interval_ != 0;
+    }
+
+    //! number of chunks of the range of worker
+    size_t num_chunks(size_t worker) const { return num_chunks_[worker]; }
+
+    //! range of the chunk of worker
+    common::Range chunk_range(size_t worker, size_t chunk) const {
+        return ranges_[worker].Partition(chunk, num_chunks_[worker]);
+    }
+
+    //! all chunks stolen so far, in the order in which they were assigned
+    const std::vector<Steal>& steals() const { return steals_; }
+
+    /*!
+     * Read the local range and stolen chunks until all workers are done. The
+     * functor read_own(range) reads and pushes the items of an own chunk,
+     * read_items(range, emit) calls emit(item) for each item of a stolen
+     * chunk, and push_item(item) pushes the items which other workers read
+     * from the own chunks. Must be called by all workers.
+     */
+    template <typename ItemType, typename ReadOwn, typename ReadItems,
+              typename PushItem>
+    void Run(size_t dia_id, const ReadOwn& read_own,
+             const ReadItems& read_items, const PushItem& push_item) {
+        const size_t me = ctx_.my_rank();
+        const std::chrono::milliseconds interval(
+            ctx_.mem_config().source_steal_interval_);
+
+        data::CatStreamPtr stream = ctx_.GetNewCatStream(dia_id);
+        data::CatStream::Writers writers = stream->GetWriters();
+
+        do {
+            auto deadline = std::chrono::steady_clock::now() + interval;
+            // read at least one chunk per interval, if there is any
+            do {
+                if (next_own_ < own_end_[me]) {
+                    read_own(chunk_range(me, next_own_++));
+                }
+                else if (next_steal_ < my_steals_.size()) {
+                    const Steal& s = steals_[my_steals_[next_steal_++]];
+                    data::CatStream::Writer& writer = writers[s.owner];
+                    read_items(chunk_range(s.owner, s.chunk),
+                               [&writer](const ItemType& item) {
+                                   writer.Put(true);
+                                   writer.Put(item);
+                               });
+                    writer.Put(false);
+                }
+                else {
+                    break;
+                }
+            } while (std::chrono::steady_clock::now() < deadline);
+        } while (Exchange());
+
+        writers.Close();
+
+        // collect the items of stolen chunks: each thief sent them in the
+        // order of steals_, and they are pushed in the order of the chunks.
+        std::vector<data::CatStream::Reader> readers = stream->GetReaders();
+        std::map<size_t, data::File> stolen;
+        for (const Steal& s : steals_) {
+            if (s.owner != me) continue;
+            data::File& file =
+                stolen.emplace(s.chunk, ctx_.GetFile(dia_id)).first->second;
+            data::File::Writer writer = file.GetWriter();
+            data::CatStream::Reader& reader = readers[s.thief];
+            while (reader.template Next<bool>())
+                writer.Put(reader.template Next<ItemType>());
+        }
+
+        for (auto& chunk : stolen) {
+            data::File::ConsumeReader reader = chunk.second.GetConsumeReader();
+            while (reader.HasNext())
+                push_item(reader.template Next<ItemType>());
+        }
+    }
+
+private:
+    //! the context
+    Context& ctx_;
+
+    //! whether only workers on the same host steal from each other
+    bool local_storage_;
+
+    //! local ranges of all workers
+    std::vector<common::Range> ranges_;
+
+    //! number of chunks of the range of each worker
+    std::vector<size_t> num_chunks_;
+
+    //! end of the chunks each worker reads itself, the others are stolen
+    std::vector<size_t> own_end_;
+
+    //! all stolen chunks, in the order of their assignment
+    std::vector<Steal> steals_;
+
+    //! next own chunk to read
+    size_t next_own_ = 0;
+
+    //! indexes of the chunks in steals_ which this worker reads
+    std::vector<size_t> my_steals_;
+
+    //! next chunk in my_steals_ to read
+    size_t next_steal_ = 0;
+
+    /*!
+     * Exchange the progress of all workers, and assign the tail halves of the
+     * remaining chunks of the slowest workers to the idle ones. Returns false
+     * once all chunks are read. Must be called by all workers.
+     */
+    bool Exchange();
+};
+
+//! \}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_SOURCE_STEALER_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,184 @@
+/*******************************************************************************
+ * thrill/api/top_k.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_TOP_K_HEADER
+#define THRILL_API_TOP_K_HEADER
+
+#include <thrill/api/action_node.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/common/binary_heap.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A ActionNode which calculates the k smallest items of a DIA. Each worker
+ * keeps the k smallest items it has seen in a bounded max-heap. The sorted
+ * local candidates are then merged and truncated to k items in a single
+ * AllReduce collective, without exchanging any other items.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename CompareFunction>
+class TopKNode final : public ActionResultNode<std::vector<ValueType> >
+{
+    static constexpr bool debug = false;
+
+    using Super = ActionResultNode<std::vector<ValueType> >;
+    using Super::context_;
+
+public:
+    template <typename ParentDIA>
+    TopKNode(const ParentDIA& parent, size_t k,
+             const CompareFunction& compare_function)
+        : Super(parent.ctx(), "TopK", { parent.id() }, { parent.node() }),
+          k_(k), compare_function_(compare_function),
+          heap_(compare_function) {
+        // Hook PreOp(s)
+        auto pre_op_fn = [this](const ValueType& input) {
+                             PreOp(input);
+                         };
+
+        auto lop_chain = parent.stack().push(pre_op_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    void PreOp(const ValueType& input) {
+        if (heap_.size() < k_) {
+            heap_.emplace(input);
+        }
+        else if (k_ != 0 && compare_function_(input, heap_.top())) {
+            // replace largest of the k smallest items
+            heap_.pop();
+            heap_.emplace(input);
+        }
+    }
+
+    //! Executes the top-k operation.
+    void Execute() final {
+        std::vector<ValueType> local;
+        local.swap(heap_.container());
+        std::sort(local.begin(), local.end(), compare_function_);
+
+        LOG << "TopK() local candidates " << local.size();
+
+        size_t k = k_;
+        CompareFunction compare_function = compare_function_;
+
+        // merge two sorted candidate lists and keep only the k smallest
+        result_ = context_.net.AllReduce(
+            local,
+            [k, compare_function](const std::vector<ValueType>& a,
+                                  const std::vector<ValueType>& b) {
+                std::vector<ValueType> out;
+                out.reserve(std::min(k, a.size() + b.size()));
+
+                auto ia = a.begin(), ib = b.begin();
+                while (out.size() < k && (ia != a.end() || ib != b.end())) {
+                    if (ib == b.end() ||
+                        (ia != a.end() && !compare_function(*ib, *ia)))
+                        out.push_back(*ia++);
+                    else
+                        out.push_back(*ib++);
+                }
+                return out;
+            });
+    }
+
+    //! Returns the k smallest items in sorted order.
+    const std::vector<ValueType>& result() const final {
+        return result_;
+    }
+
+private:
+    //! number of items to return
+    size_t k_;
+    //! The comparison function which is applied to two elements.
+    CompareFunction compare_function_;
+    //! bounded max-heap of the k smallest local items
+    common::BinaryHeap<ValueType, CompareFunction> heap_;
+    //! global result
+    std::vector<ValueType> result_;
+};
+
+template <typename ValueType, typename Stack>
+template <typename CompareFunction>
+std::vector<ValueType> DIA<ValueType, Stack>::TopK(
+    size_t k, const CompareFunction& compare_function) const {
+    assert(IsValid());
+
+    using TopKNode = api::TopKNode<ValueType, CompareFunction>;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<CompareFunction>::template arg<0> >::value,
+        "CompareFunction has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<CompareFunction>::template arg<1> >::value,
+        "CompareFunction has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename FunctionTraits<CompareFunction>::result_type,
+            bool>::value,
+        "CompareFunction has the wrong output type (should be bool)");
+
+    auto node = tlx::make_counting<TopKNode>(*this, k, compare_function);
+
+    node->RunScope();
+
+    return node->result();
+}
+
+template <typename ValueType, typename Stack>
+template <typename CompareFunction>
+Future<std::vector<ValueType> > DIA<ValueType, Stack>::TopKFuture(
+    size_t k, const CompareFunction& compare_function) const {
+    assert(IsValid());
+
+    using TopKNode = api::TopKNode<ValueType, CompareFunction>;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<CompareFunction>::template arg<0> >::value,
+        "CompareFunction has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<CompareFunction>::template arg<1> >::value,
+        "CompareFunction has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename FunctionTraits<CompareFunction>::result_type,
+            bool>::value,
+        "CompareFunction has the wrong output type (should be bool)");
+
+    auto node = tlx::make_counting<TopKNode>(*this, k, compare_function);
+
+    return Future<std::vector<ValueType> >(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_TOP_K_HEADER
+
+/******************************************************************************/
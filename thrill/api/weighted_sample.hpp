@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * thrill/api/weighted_sample.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_WEIGHTED_SAMPLE_HEADER
+#define THRILL_API_WEIGHTED_SAMPLE_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/reservoir_sampling.hpp>
+
+#include <tlx/vector_free.hpp>
+
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs weighted sampling *without* replacement.
+ *
+ * Each worker samples its items in one pass into a weighted reservoir of
+ * sample_size items (Algorithm A-ExpJ of Efraimidis and Spirakis), which
+ * assigns each item a random key depending on its weight. The global sample
+ * consists of the sample_size items with the largest keys. A single AllReduce
+ * of the sorted local keys determines the smallest key of the global sample,
+ * and each worker then keeps its local samples with at least this key. Hence,
+ * no items are exchanged and the samples remain on the worker they were read
+ * on.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename WeightFunction>
+class WeightedSampleNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    using Sampler = common::ReservoirSamplingWeighted<ValueType, std::mt19937_64>;
+    using KeyItem = typename Sampler::KeyItem;
+
+public:
+    template <typename ParentDIA>
+    WeightedSampleNode(const ParentDIA& parent, size_t sample_size,
+                       const WeightFunction& weight_function)
+        : Super(parent.ctx(), "WeightedSample",
+                { parent.id() }, { parent.node() }),
+          sample_size_(sample_size), weight_function_(weight_function),
+          sampler_(sample_size, samples_, rng_) {
+        auto presample_fn = [this](const ValueType& input) {
+                                sampler_.add(input, weight_function_(input));
+                            };
+        auto lop_chain = parent.stack().push(presample_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    void Execute() final {
+        size_t sample_size = sample_size_;
+
+        // merge the keys of all reservoirs, the smallest one remaining is the
+        // threshold of the global sample.
+        std::vector<double> keys = context_.net.AllReduce(
+            sampler_.sorted_keys(),
+            [sample_size](const std::vector<double>& a,
+                          const std::vector<double>& b) {
+                return Sampler::MergeKeys(a, b, sample_size);
+            });
+
+        threshold_ = keys.size() < sample_size_ ? 0.0 : keys.back();
+
+        sLOG << "WeightedSampleNode::Execute() local reservoir"
+             << samples_.size() << "of" << sampler_.count() << "items"
+             << "global threshold" << threshold_;
+    }
+
+    void PushData(bool consume) final {
+        for (const KeyItem& s : samples_) {
+            if (s.first >= threshold_)
+                this->PushItem(s.second);
+        }
+        if (consume)
+            tlx::vector_free(samples_);
+    }
+
+    void Dispose() final {
+        tlx::vector_free(samples_);
+    }
+
+private:
+    //! number of samples to draw globally
+    size_t sample_size_;
+    //! weight of each item
+    WeightFunction weight_function_;
+    //! local reservoir of samples and their keys
+    std::vector<KeyItem> samples_;
+    //! Random generator for reservoir sampler
+    std::mt19937_64 rng_ { std::random_device { } () };
+    //! weighted reservoir sampler for pre-op
+    Sampler sampler_;
+    //! smallest key of the global sample
+    double threshold_ = 0.0;
+};
+
+template <typename ValueType, typename Stack>
+template <typename WeightFunction>
+auto DIA<ValueType, Stack>::WeightedSample(
+    size_t sample_size, const WeightFunction& weight_function) const {
+    assert(IsValid());
+
+    using WeightedSampleNode =
+        api::WeightedSampleNode<ValueType, WeightFunction>;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<WeightFunction>::template arg<0> >::value,
+        "WeightFunction has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename FunctionTraits<WeightFunction>::result_type,
+            double>::value,
+        "WeightFunction has the wrong output type (should be double)");
+
+    auto node = tlx::make_counting<WeightedSampleNode>(
+        *this, sample_size, weight_function);
+
+    return DIA<ValueType>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_WEIGHTED_SAMPLE_HEADER
+
+/******************************************************************************/
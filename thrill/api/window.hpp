@@ -16,9 +16,11 @@
 #include <thrill/api/dop_node.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/ring_buffer.hpp>
+#include <thrill/common/sliding_aggregate.hpp>
 #include <thrill/data/file.hpp>
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 namespace thrill {
@@ -379,6 +381,83 @@ auto DIA<ValueType, Stack>::Window(
     return DIA<Result>(node);
 }
 
+/*!
+ * FlatWindow function which emits the aggregate of each window under an
+ * associative sum function. The OverlapWindowNode delivers the windows with
+ * consecutive ranks, each differing from the previous one by dropping the
+ * oldest item and appending window.back(), hence the aggregate is maintained
+ * in a common::SlidingAggregate in O(1) amortized time per window instead of
+ * O(k). After a gap in the ranks (e.g. when PushData() is repeated) the
+ * aggregate is rebuilt from the window.
+ */
+template <typename Input, typename Aggregate, typename SumFunction>
+class SlidingWindowFunction
+{
+public:
+    explicit SlidingWindowFunction(const SumFunction& sum_function)
+        : aggregate_(sum_function) { }
+
+    template <typename Emitter>
+    void operator () (size_t index, const common::RingBuffer<Input>& window,
+                      Emitter emit) {
+        if (aggregate_.empty() || index != next_index_) {
+            aggregate_.clear();
+            for (size_t i = 0; i < window.size(); ++i)
+                aggregate_.push_back(Aggregate(window[i]));
+        }
+        else {
+            aggregate_.pop_front();
+            aggregate_.push_back(Aggregate(window.back()));
+        }
+        next_index_ = index + 1;
+        emit(aggregate_.sum());
+    }
+
+private:
+    //! aggregate of the current window
+    common::SlidingAggregate<Aggregate, SumFunction> aggregate_;
+    //! index of the window expected next
+    size_t next_index_ = 0;
+};
+
+template <typename ValueType, typename Stack>
+template <typename SumFunction>
+auto DIA<ValueType, Stack>::WindowSum(
+    size_t window_size, const SumFunction& sum_function) const {
+    assert(IsValid());
+
+    using WindowFunction =
+        api::SlidingWindowFunction<ValueType, ValueType, SumFunction>;
+
+    return FlatWindow<ValueType>(window_size, WindowFunction(sum_function));
+}
+
+template <typename ValueType, typename Stack>
+auto DIA<ValueType, Stack>::WindowMin(size_t window_size) const {
+    return WindowSum(window_size, common::minimum<ValueType>());
+}
+
+template <typename ValueType, typename Stack>
+auto DIA<ValueType, Stack>::WindowMax(size_t window_size) const {
+    return WindowSum(window_size, common::maximum<ValueType>());
+}
+
+template <typename ValueType, typename Stack>
+auto DIA<ValueType, Stack>::WindowMean(size_t window_size) const {
+    assert(IsValid());
+
+    static_assert(std::is_convertible<ValueType, double>::value,
+                  "WindowMean() requires items convertible to double");
+
+    using WindowFunction =
+        api::SlidingWindowFunction<ValueType, double, std::plus<double> >;
+
+    double scale = 1.0 / static_cast<double>(window_size);
+
+    return FlatWindow<double>(window_size, WindowFunction(std::plus<double>()))
+           .Map([scale](const double& sum) { return sum * scale; });
+}
+
 /******************************************************************************/
 
 /*!
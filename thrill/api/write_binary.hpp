@@ -14,11 +14,14 @@
 #define THRILL_API_WRITE_BINARY_HEADER
 
 #include <thrill/api/action_node.hpp>
+#include <thrill/api/binary_index.hpp>
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
 #include <thrill/common/string.hpp>
 #include <thrill/data/block_sink.hpp>
 #include <thrill/data/block_writer.hpp>
+#include <thrill/data/serialization.hpp>
+#include <thrill/vfs/async_write_stream.hpp>
 #include <thrill/vfs/file_io.hpp>
 #include <tlx/math/round_to_power_of_two.hpp>
 
@@ -65,7 +68,9 @@ public:
     }
 
     DIAMemUse PreOpMemUse() final {
-        return data::default_block_size;
+        // the BlockWriter's Block, plus the queued and the filling buffer
+        size_t queue = context_.mem_config().write_queue_blocks_;
+        return data::default_block_size * (queue == 0 ? 1 : queue + 2);
     }
 
     //! writer preop: put item into file, create files as needed.
@@ -113,11 +118,15 @@ private:
         SysFileSink(api::Context& context,
                     size_t local_worker_id,
                     const std::string& path, size_t max_file_size,
+                    size_t block_size, bool write_index,
                     size_t& stats_total_elements,
                     size_t& stats_total_writes)
             : BlockSink(context.block_pool(), local_worker_id),
               BoundedBlockSink(context.block_pool(), local_worker_id, max_file_size),
-              stream_(vfs::OpenWriteStream(path)),
+              stream_(vfs::OpenAsyncWriteStream(
+                          path, block_size,
+                          context.mem_config().write_queue_blocks_)),
+              write_index_(write_index),
               stats_total_elements_(stats_total_elements),
               stats_total_writes_(stats_total_writes) { }
 
@@ -125,6 +134,9 @@ private:
             data::PinnedBlock&& b, bool /* is_last_block */) final {
             sLOG << "SysFileSink::AppendBlock()" << b;
             stats_total_writes_++;
+            if (write_index_ && b.num_items() != 0)
+                index_.Add(file_pos_ + b.first_item_relative(), b.num_items());
+            file_pos_ += b.size();
             stream_->write(b.data_begin(), b.size());
         }
 
@@ -139,17 +151,32 @@ private:
         }
 
         void Close() final {
+            if (write_index_) {
+                index_.Write(*stream_);
+                write_index_ = false;
+            }
             stream_->close();
         }
 
     private:
         vfs::WriteStreamPtr stream_;
+        //! append a BinaryIndex footer on Close()
+        bool write_index_;
+        //! index of blocks written
+        BinaryIndex index_;
+        //! bytes written to stream_
+        uint64_t file_pos_ = 0;
         size_t& stats_total_elements_;
         size_t& stats_total_writes_;
     };
 
     using Writer = data::BlockWriter<SysFileSink>;
 
+    //! flag whether ValueType is fixed size, then files are split by size
+    //! and need no BinaryIndex.
+    static constexpr bool is_fixed_size_ =
+        data::Serialization<Writer, ValueType>::is_fixed_size;
+
     //! Base path of the output file.
     std::string out_pathbase_;
 
@@ -181,7 +208,8 @@ private:
         writer_ = std::make_unique<Writer>(
             SysFileSink(
                 context_, context_.local_worker_id(),
-                out_path, max_file_size_,
+                out_path, max_file_size_, block_size_,
+                /* write_index */ !is_fixed_size_ && !vfs::IsCompressed(out_path),
                 stats_total_elements_, stats_total_writes_),
             block_size_);
     }
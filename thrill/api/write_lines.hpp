@@ -18,6 +18,7 @@
 #include <thrill/api/dia.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/net/buffer_builder.hpp>
+#include <thrill/vfs/async_write_stream.hpp>
 #include <thrill/vfs/file_io.hpp>
 
 #include <algorithm>
@@ -48,9 +49,6 @@ public:
         : Super(parent.ctx(), "WriteLines",
                 { parent.id() }, { parent.node() }),
           out_pathbase_(path_out),
-          stream_(vfs::OpenWriteStream(
-                      vfs::FillFilePattern(
-                          out_pathbase_, context_.my_rank(), 0))),
           target_file_size_(target_file_size) {
         sLOG << "Creating write node.";
 
@@ -62,6 +60,9 @@ public:
             std::min(data::default_block_size,
                      tlx::round_up_to_power_of_two(target_file_size_));
 
+        stream_ = OpenStream(
+            vfs::FillFilePattern(out_pathbase_, context_.my_rank(), 0));
+
         // close the function stack with our pre op and register it at parent
         // node for output
         auto lop_chain = parent.stack().push(pre_op_fn).fold();
@@ -69,7 +70,9 @@ public:
     }
 
     DIAMemUse PreOpMemUse() final {
-        return max_buffer_size_;
+        // write buffer, plus the queued and the filling buffer of the stream
+        size_t queue = context_.mem_config().write_queue_blocks_;
+        return max_buffer_size_ * (queue == 0 ? 1 : queue + 2);
     }
 
     void StartPreOp(size_t /* parent_index */) final {
@@ -94,7 +97,7 @@ public:
                 stream_->close();
                 std::string new_path = vfs::FillFilePattern(
                     out_pathbase_, context_.my_rank(), out_serial_++);
-                stream_ = vfs::OpenWriteStream(new_path);
+                stream_ = OpenStream(new_path);
                 LOG << "Opening file: " << new_path;
                 current_file_size_ = 0;
             }
@@ -170,6 +173,12 @@ private:
     size_t stats_total_bytes_ = 0;
     size_t stats_total_elements_ = 0;
     size_t stats_total_writes_ = 0;
+
+    //! open path, compressed and written by a background thread if enabled
+    vfs::WriteStreamPtr OpenStream(const std::string& path) {
+        return vfs::OpenAsyncWriteStream(
+            path, max_buffer_size_, context_.mem_config().write_queue_blocks_);
+    }
 };
 
 template <typename ValueType, typename Stack>
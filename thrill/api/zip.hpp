@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <array>
 #include <functional>
+#include <memory>
 #include <tuple>
 #include <vector>
 
@@ -150,11 +151,15 @@ public:
         size_t result_count = 0;
 
         if (result_size_ != 0) {
-            if (NoRebalance) {
-                // get inbound readers from all Streams
+            if (NoRebalance || !all_exchanged()) {
+                // get readers from the local Files, and from the Streams of
+                // inputs which were exchanged
                 std::array<data::File::Reader, kNumInputs> readers;
-                for (size_t i = 0; i < kNumInputs; ++i)
-                    readers[i] = files_[i].GetReader(consume);
+                for (size_t i = 0; i < kNumInputs; ++i) {
+                    readers[i] = exchange_[i]
+                                 ? streams_[i]->GetDynReader(consume)
+                                 : files_[i].GetReader(consume);
+                }
 
                 ReaderNext<data::File::Reader> reader_next(*this, readers);
 
@@ -209,6 +214,16 @@ private:
     //! Array of inbound CatStreams
     data::CatStreamPtr streams_[kNumInputs];
 
+    //! whether the items of each input are exchanged over its CatStream, or
+    //! are read from the local File since they are already in place.
+    std::array<bool, kNumInputs> exchange_ {};
+
+    //! whether all inputs are exchanged
+    bool all_exchanged() const {
+        return std::all_of(exchange_.begin(), exchange_.end(),
+                           [](bool e) { return e; });
+    }
+
     //! \name Variables for Calculating Exchange
     //! \{
 
@@ -254,9 +269,12 @@ private:
         ZipNode* node_;
     };
 
-    //! Scatter items from DIA "Index" to other workers if necessary.
+    //! Scatter items from DIA "Index" to other workers if necessary, such that
+    //! each worker i receives the items [split[i],split[i+1]).
     template <size_t Index>
-    void DoScatter() {
+    void DoScatter(const std::vector<size_t>& split) {
+        if (!exchange_[Index]) return;
+
         const size_t workers = context_.num_workers();
 
         // range of items on local node
@@ -264,15 +282,12 @@ private:
         size_t local_end = std::min(
             result_size_, size_prefixsum_[Index] + files_[Index].num_items());
 
-        // number of elements per worker (double)
-        double per_pe =
-            static_cast<double>(result_size_) / static_cast<double>(workers);
         // offsets for scattering
         std::vector<size_t> offsets(workers + 1, 0);
 
         for (size_t i = 0; i <= workers; ++i) {
             // calculate range we have to send to each PE
-            size_t cut = static_cast<size_t>(std::ceil(i * per_pe));
+            size_t cut = split[i];
             offsets[i] =
                 cut < local_begin ? 0 : std::min(cut, local_end) - local_begin;
         }
@@ -303,12 +318,24 @@ private:
             return;
         }
 
+        // inputs which are balanced with the same known size are already
+        // zipped in place, without any size collective.
+        if (KnownBalancedSize(&result_size_)) {
+            sLOG << "Zip() known balanced size" << result_size_;
+            this->set_known_size(result_size_, /* balanced */ true);
+            return;
+        }
+
         // first: calculate total size of the DIAs to Zip
 
         using ArraySizeT = std::array<size_t, kNumInputs>;
 
-        // number of elements of this worker
+        // number of elements of this worker, followed by whether each input's
+        // local size differs from input 0's, and by how many items.
+        using ArrayCheckT = std::array<size_t, 3 * kNumInputs>;
+
         ArraySizeT local_size;
+        ArrayCheckT check;
         for (size_t i = 0; i < kNumInputs; ++i) {
             local_size[i] = files_[i].num_items();
             sLOG << "input" << i << "local_size" << local_size[i];
@@ -317,14 +344,25 @@ private:
                 context_.PrintCollectiveMeanStdev(
                     "Zip() local_size", local_size[i]);
             }
+
+            check[i] = local_size[i];
+            check[kNumInputs + i] = (local_size[i] != local_size[0]);
+            check[2 * kNumInputs + i] =
+                std::max(local_size[i], local_size[0])
+                - std::min(local_size[i], local_size[0]);
         }
 
         // exclusive prefixsum of number of elements: we have items from
         // [size_prefixsum, size_prefixsum + local_size). And get the total
         // number of items in each DIAs, over all worker.
-        size_prefixsum_ = local_size;
-        ArraySizeT total_size = context_.net.ExPrefixSumTotal(
-            size_prefixsum_, common::ComponentSum<ArraySizeT>());
+        ArrayCheckT check_total = context_.net.ExPrefixSumTotal(
+            check, common::ComponentSum<ArrayCheckT>());
+
+        ArraySizeT total_size;
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            size_prefixsum_[i] = check[i];
+            total_size[i] = check_total[i];
+        }
 
         size_t max_total_size =
             *std::max_element(total_size.begin(), total_size.end());
@@ -342,14 +380,65 @@ private:
 
         if (result_size_ == 0) return;
 
+        const size_t workers = context_.num_workers();
+
+        // inputs with the same local sizes as input 0 on all workers are
+        // co-partitioned with it.
+        bool equal_totals = true, few_differ = true;
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            exchange_[i] = (check_total[kNumInputs + i] != 0);
+            equal_totals = equal_totals && (total_size[i] == result_size_);
+            few_differ = few_differ &&
+                         8 * check_total[2 * kNumInputs + i] <= result_size_;
+        }
+
+        std::vector<size_t> split(workers + 1);
+
+        if (!all_exchanged() && equal_totals && few_differ) {
+            // keep the partition of input 0 and the inputs co-partitioned with
+            // it, and only move the items of the others which differ.
+            if (std::any_of(exchange_.begin(), exchange_.end(),
+                            [](bool e) { return e; })) {
+                std::shared_ptr<std::vector<size_t> > begins =
+                    context_.net.AllGather(size_prefixsum_[0]);
+                std::copy(begins->begin(), begins->end(), split.begin());
+            }
+            split[workers] = result_size_;
+        }
+        else {
+            // rebalance all inputs to equal parts
+            exchange_.fill(true);
+
+            // number of elements per worker (double)
+            double per_pe =
+                static_cast<double>(result_size_) / static_cast<double>(workers);
+            for (size_t i = 0; i <= workers; ++i)
+                split[i] = static_cast<size_t>(std::ceil(i * per_pe));
+        }
+
+        sLOG << "Zip() exchange" << common::VecToStr(exchange_);
+
         // perform scatters to exchange data, with different types.
         tlx::call_for_range<kNumInputs>(
-            [=](auto index) {
+            [&](auto index) {
                 (void)index;
-                this->DoScatter<decltype(index)::index>();
+                this->DoScatter<decltype(index)::index>(split);
             });
     }
 
+    //! Check whether all inputs are balanced with the same known size, which
+    //! is then stored in size.
+    bool KnownBalancedSize(size_t* size) const {
+        for (size_t i = 0; i < kNumInputs; ++i) {
+            const KnownSize& known = this->parent_known_size(i);
+            if (!parent_stack_empty_[i] || !known.known_balanced() ||
+                known.total != this->parent_known_size(0).total)
+                return false;
+        }
+        *size = this->parent_known_size(0).total;
+        return true;
+    }
+
     //! Access CatReaders for different different parents.
     template <typename Reader>
     class ReaderNext
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <future>
 
 namespace thrill {
 namespace api {
@@ -81,21 +82,42 @@ public:
 
     void StopPreOp(size_t /* parent_index */) final {
         writer_.Close();
+
+        // the ranks of balanced items of known size need no collective.
+        const KnownSize& parent_size = this->parent_known_size(0);
+        if (parent_stack_empty_ && parent_size.known_balanced()) {
+            dia_local_rank_ =
+                context_.CalculateLocalRange(parent_size.total).begin;
+            rank_known_ = true;
+            this->set_known_size(parent_size.total, /* balanced */ true);
+            return;
+        }
+
+        // the local size is known: start the prefix sum collective, which runs
+        // in the background until Execute() needs it.
+        StartRankPrefixSum();
     }
 
     void Execute() final {
-        //! number of elements of this worker
-        size_t dia_local_size = file_.num_items();
-        sLOG << "dia_local_size" << dia_local_size;
+        if (rank_known_) {
+            sLOG << "dia_local_rank_" << dia_local_rank_ << "known";
+            return;
+        }
+
+        if (!rank_future_.valid())
+            StartRankPrefixSum();
 
-        dia_local_rank_ = context_.net.ExPrefixSum(dia_local_size);
+        dia_local_rank_ = rank_future_.get();
         sLOG << "dia_local_rank_" << dia_local_rank_;
     }
 
     void PushData(bool consume) final {
         size_t result_count = file_.num_items();
 
-        data::File::Reader reader = file_.GetReader(consume);
+        // read ahead as far as RAM allows, such that spilled Blocks are read
+        // while the items of those in memory are pushed.
+        data::File::Reader reader =
+            file_.GetReader(consume, data::File::auto_prefetch_size_);
         size_t index = dia_local_rank_;
 
         while (reader.HasNext()) {
@@ -132,6 +154,20 @@ private:
     //! exclusive prefix sum over the number of items in workers
     size_t dia_local_rank_;
 
+    //! future of dia_local_rank_
+    std::shared_future<size_t> rank_future_;
+
+    //! whether dia_local_rank_ follows from the parent's known size
+    bool rank_known_ = false;
+
+    void StartRankPrefixSum() {
+        //! number of elements of this worker
+        size_t dia_local_size = file_.num_items();
+        sLOG << "dia_local_size" << dia_local_size;
+
+        rank_future_ = context_.net.ExPrefixSumAsync(dia_local_size);
+    }
+
     //! \}
 };
 
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * thrill/common/accelerator.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/accelerator.hpp>
+
+#include <thrill/common/logger.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace thrill {
+namespace common {
+
+static constexpr bool debug = false;
+
+bool AcceleratorAvailable() {
+    static const bool available = []() {
+        const char* env = getenv("THRILL_ACCELERATOR");
+        if (env != nullptr && strcmp(env, "0") == 0)
+            return false;
+        int devices = AcceleratorDeviceCount();
+        sLOG << "AcceleratorAvailable() devices" << devices;
+        return devices > 0;
+    } ();
+    return available;
+}
+
+#if !THRILL_HAVE_CUDA
+
+// without CUDA, all kernels fall back to the CPU.
+
+int AcceleratorDeviceCount() {
+    return 0;
+}
+
+bool AcceleratorSortPairs(uint64_t*, uint32_t*, size_t) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, int32_t*, size_t*) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, uint32_t*, size_t*) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, int64_t*, size_t*) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, uint64_t*, size_t*) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, float*, size_t*) {
+    return false;
+}
+
+bool AcceleratorReduceSum(uint64_t*, double*, size_t*) {
+    return false;
+}
+
+#endif // !THRILL_HAVE_CUDA
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
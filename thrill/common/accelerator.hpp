@@ -0,0 +1,115 @@
+/*******************************************************************************
+ * thrill/common/accelerator.hpp
+ *
+ * Offload of local sort and reduce kernels to a GPU.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_ACCELERATOR_HEADER
+#define THRILL_COMMON_ACCELERATOR_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * The accelerator kernels work on batches of 64-bit keys with 32-bit item
+ * indexes or numeric values in host arrays, which are pinned for the transfers
+ * to device memory and back. They are implemented with CUDA's Thrust in
+ * accelerator_cuda.cu if Thrill was built with THRILL_USE_CUDA. Otherwise, and
+ * if no device is present or the batch does not fit into device memory, the
+ * kernels return false and leave the arrays unchanged, such that the callers
+ * fall back to the CPU.
+ */
+
+//! number of CUDA devices, zero if Thrill was built without CUDA
+int AcceleratorDeviceCount();
+
+//! whether the kernels can run: a device is present and THRILL_ACCELERATOR is
+//! not 0. Evaluated once.
+bool AcceleratorAvailable();
+
+//! batches smaller than this are processed faster on the CPU than
+//! transferred to the device and back
+static constexpr size_t accelerator_min_items = 1 << 16;
+
+//! sort the n pairs (keys[i], index[i]) by key on the device, returns false if
+//! the kernel could not run.
+bool AcceleratorSortPairs(uint64_t* keys, uint32_t* index, size_t n);
+
+//! sort the *n pairs (keys[i], values[i]) by key on the device and sum the
+//! values of equal keys. The unique keys and their sums replace the first *n
+//! pairs. Returns false if the kernel could not run.
+bool AcceleratorReduceSum(uint64_t* keys, int32_t* values, size_t* n);
+bool AcceleratorReduceSum(uint64_t* keys, uint32_t* values, size_t* n);
+bool AcceleratorReduceSum(uint64_t* keys, int64_t* values, size_t* n);
+bool AcceleratorReduceSum(uint64_t* keys, uint64_t* values, size_t* n);
+bool AcceleratorReduceSum(uint64_t* keys, float* values, size_t* n);
+bool AcceleratorReduceSum(uint64_t* keys, double* values, size_t* n);
+
+//! Maps integral keys of up to 64 bits order-preservingly to the uint64_t keys
+//! of AcceleratorReduceSum() and back.
+template <typename Key, typename Enable = void>
+struct AcceleratorKeyTraits {
+    static constexpr bool is_supported = false;
+};
+
+template <typename Key>
+struct AcceleratorKeyTraits<
+    Key, typename std::enable_if<
+        std::is_integral<Key>::value && !std::is_same<Key, bool>::value &&
+        sizeof(Key) <= sizeof(uint64_t)>::type>
+{
+    static constexpr bool is_supported = true;
+
+    //! flip the sign bit of signed keys, such that negative keys come first
+    static constexpr uint64_t flip =
+        std::is_signed<Key>::value ? uint64_t(1) << 63 : 0;
+
+    static uint64_t ToKey(const Key& key) {
+        return static_cast<uint64_t>(static_cast<int64_t>(key)) ^ flip;
+    }
+    static Key FromKey(const uint64_t& key) {
+        return static_cast<Key>(static_cast<int64_t>(key ^ flip));
+    }
+};
+
+//! The value type of AcceleratorReduceSum() into which arithmetic values of 4
+//! or 8 bytes are converted without loss.
+template <typename Value, typename Enable = void>
+struct AcceleratorSumTraits {
+    static constexpr bool is_supported = false;
+};
+
+template <typename Value>
+struct AcceleratorSumTraits<
+    Value, typename std::enable_if<
+        std::is_arithmetic<Value>::value && !std::is_same<Value, bool>::value &&
+        (sizeof(Value) == 4 || sizeof(Value) == 8)>::type>
+{
+    static constexpr bool is_supported = true;
+
+    using type = typename std::conditional<
+        std::is_floating_point<Value>::value,
+        typename std::conditional<sizeof(Value) == 4, float, double>::type,
+        typename std::conditional<
+            std::is_signed<Value>::value,
+            typename std::conditional<
+                sizeof(Value) == 4, int32_t, int64_t>::type,
+            typename std::conditional<
+                sizeof(Value) == 4, uint32_t, uint64_t>::type>::type>::type;
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_ACCELERATOR_HEADER
+
+/******************************************************************************/
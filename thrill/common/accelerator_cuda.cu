@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * thrill/common/accelerator_cuda.cu
+ *
+ * CUDA kernels of thrill/common/accelerator.hpp, built with THRILL_USE_CUDA.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/accelerator.hpp>
+
+#include <cuda_runtime.h>
+#include <thrust/copy.h>
+#include <thrust/device_vector.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+
+#include <exception>
+
+namespace thrill {
+namespace common {
+
+int AcceleratorDeviceCount() {
+    int count = 0;
+    if (cudaGetDeviceCount(&count) != cudaSuccess)
+        return 0;
+    return count;
+}
+
+//! page-locks a host array for the duration of the transfers, such that they
+//! run by DMA without staging copies.
+class PinnedHostRange
+{
+public:
+    PinnedHostRange(void* ptr, size_t size)
+        : ptr_(ptr),
+          pinned_(cudaHostRegister(ptr, size, cudaHostRegisterDefault)
+                  == cudaSuccess) {
+        // registering fails e.g. for already pinned memory, which is fine.
+        if (!pinned_) cudaGetLastError();
+    }
+
+    ~PinnedHostRange() {
+        if (pinned_) cudaHostUnregister(ptr_);
+    }
+
+    PinnedHostRange(const PinnedHostRange&) = delete;
+    PinnedHostRange& operator = (const PinnedHostRange&) = delete;
+
+private:
+    void* ptr_;
+    bool pinned_;
+};
+
+bool AcceleratorSortPairs(uint64_t* keys, uint32_t* index, size_t n) {
+    try {
+        PinnedHostRange pin_keys(keys, n * sizeof(uint64_t));
+        PinnedHostRange pin_index(index, n * sizeof(uint32_t));
+
+        thrust::device_vector<uint64_t> d_keys(keys, keys + n);
+        thrust::device_vector<uint32_t> d_index(index, index + n);
+
+        thrust::sort_by_key(d_keys.begin(), d_keys.end(), d_index.begin());
+
+        thrust::copy(d_keys.begin(), d_keys.end(), keys);
+        thrust::copy(d_index.begin(), d_index.end(), index);
+        return true;
+    }
+    catch (std::exception&) {
+        // out of device memory or a CUDA error (thrust::system_error)
+        return false;
+    }
+}
+
+template <typename Value>
+static bool ReduceSum(uint64_t* keys, Value* values, size_t* n) {
+    try {
+        PinnedHostRange pin_keys(keys, *n * sizeof(uint64_t));
+        PinnedHostRange pin_values(values, *n * sizeof(Value));
+
+        thrust::device_vector<uint64_t> d_keys(keys, keys + *n);
+        thrust::device_vector<Value> d_values(values, values + *n);
+
+        thrust::sort_by_key(d_keys.begin(), d_keys.end(), d_values.begin());
+
+        thrust::device_vector<uint64_t> d_out_keys(*n);
+        thrust::device_vector<Value> d_out_values(*n);
+        auto end = thrust::reduce_by_key(
+            d_keys.begin(), d_keys.end(), d_values.begin(),
+            d_out_keys.begin(), d_out_values.begin());
+
+        size_t unique = end.first - d_out_keys.begin();
+        thrust::copy(d_out_keys.begin(), d_out_keys.begin() + unique, keys);
+        thrust::copy(d_out_values.begin(), d_out_values.begin() + unique,
+                     values);
+        *n = unique;
+        return true;
+    }
+    catch (std::exception&) {
+        return false;
+    }
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, int32_t* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, uint32_t* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, int64_t* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, uint64_t* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, float* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+bool AcceleratorReduceSum(uint64_t* keys, double* values, size_t* n) {
+    return ReduceSum(keys, values, n);
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
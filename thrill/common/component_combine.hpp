@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * thrill/common/component_combine.hpp
+ *
+ * In-place component-wise combination of arrays, vectorized with AVX2 or SSE2
+ * for sums of arithmetic types.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_COMPONENT_COMBINE_HEADER
+#define THRILL_COMMON_COMPONENT_COMBINE_HEADER
+
+#include <thrill/common/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(THRILL_HAVE_AVX2)
+#include <immintrin.h>
+#elif defined(THRILL_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace thrill {
+namespace common {
+
+//! b[i] = a[i] + b[i] for i in [0,n) with a plain loop, for all types which are
+//! not vectorized.
+template <typename Type, typename Enable = void>
+struct ComponentAddImpl {
+    static void Add(const Type* a, Type* b, size_t n) {
+        for (size_t i = 0; i < n; ++i) b[i] = a[i] + b[i];
+    }
+};
+
+#if defined(THRILL_HAVE_AVX2) || defined(THRILL_HAVE_SSE2)
+
+//! add the full vectors of Vec in [i,n) loaded and stored via Cast pointers
+#define THRILL_COMPONENT_ADD_LANES(Vec, Add, Load, Store, Cast) \
+    static constexpr size_t lanes = sizeof(Vec) / sizeof(Type); \
+    for ( ; i + lanes <= n; i += lanes) {                       \
+        Vec va = Load(reinterpret_cast<const Cast*>(a + i));    \
+        Vec vb = Load(reinterpret_cast<const Cast*>(b + i));    \
+        Store(reinterpret_cast<Cast*>(b + i), Add(va, vb));     \
+    }
+
+//! 32-bit integers, which wrap around like unsigned arithmetic
+template <typename Type>
+struct ComponentAddImpl<
+    Type, typename std::enable_if<
+        std::is_integral<Type>::value && sizeof(Type) == 4>::type>
+{
+    static void Add(const Type* a, Type* b, size_t n) {
+        size_t i = 0;
+#if defined(THRILL_HAVE_AVX2)
+        THRILL_COMPONENT_ADD_LANES(__m256i, _mm256_add_epi32,
+                                   _mm256_loadu_si256, _mm256_storeu_si256,
+                                   __m256i)
+#else
+        THRILL_COMPONENT_ADD_LANES(__m128i, _mm_add_epi32,
+                                   _mm_loadu_si128, _mm_storeu_si128, __m128i)
+#endif
+        for ( ; i < n; ++i) b[i] = a[i] + b[i];
+    }
+};
+
+//! 64-bit integers, which wrap around like unsigned arithmetic
+template <typename Type>
+struct ComponentAddImpl<
+    Type, typename std::enable_if<
+        std::is_integral<Type>::value && sizeof(Type) == 8>::type>
+{
+    static void Add(const Type* a, Type* b, size_t n) {
+        size_t i = 0;
+#if defined(THRILL_HAVE_AVX2)
+        THRILL_COMPONENT_ADD_LANES(__m256i, _mm256_add_epi64,
+                                   _mm256_loadu_si256, _mm256_storeu_si256,
+                                   __m256i)
+#else
+        THRILL_COMPONENT_ADD_LANES(__m128i, _mm_add_epi64,
+                                   _mm_loadu_si128, _mm_storeu_si128, __m128i)
+#endif
+        for ( ; i < n; ++i) b[i] = a[i] + b[i];
+    }
+};
+
+template <>
+struct ComponentAddImpl<float>
+{
+    using Type = float;
+    static void Add(const Type* a, Type* b, size_t n) {
+        size_t i = 0;
+#if defined(THRILL_HAVE_AVX2)
+        THRILL_COMPONENT_ADD_LANES(__m256, _mm256_add_ps,
+                                   _mm256_loadu_ps, _mm256_storeu_ps, float)
+#else
+        THRILL_COMPONENT_ADD_LANES(__m128, _mm_add_ps,
+                                   _mm_loadu_ps, _mm_storeu_ps, float)
+#endif
+        for ( ; i < n; ++i) b[i] = a[i] + b[i];
+    }
+};
+
+template <>
+struct ComponentAddImpl<double>
+{
+    using Type = double;
+    static void Add(const Type* a, Type* b, size_t n) {
+        size_t i = 0;
+#if defined(THRILL_HAVE_AVX2)
+        THRILL_COMPONENT_ADD_LANES(__m256d, _mm256_add_pd,
+                                   _mm256_loadu_pd, _mm256_storeu_pd, double)
+#else
+        THRILL_COMPONENT_ADD_LANES(__m128d, _mm_add_pd,
+                                   _mm_loadu_pd, _mm_storeu_pd, double)
+#endif
+        for ( ; i < n; ++i) b[i] = a[i] + b[i];
+    }
+};
+
+#undef THRILL_COMPONENT_ADD_LANES
+
+#endif // defined(THRILL_HAVE_AVX2) || defined(THRILL_HAVE_SSE2)
+
+//! b[i] = a[i] + b[i] for i in [0,n), vectorized for 32- and 64-bit integers,
+//! float, and double.
+template <typename Type>
+void ComponentAdd(const Type* a, Type* b, size_t n) {
+    ComponentAddImpl<Type>::Add(a, b, n);
+}
+
+//! b[i] = op(a[i], b[i]) for i in [0,n), hence a holds the left operands.
+template <typename Type, typename Operation>
+void ComponentCombine(const Operation& op, const Type* a, Type* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) b[i] = op(a[i], b[i]);
+}
+
+//! sums are combined with ComponentAdd()
+template <typename Type>
+void ComponentCombine(const std::plus<Type>&,
+                      const Type* a, Type* b, size_t n) {
+    ComponentAdd(a, b, n);
+}
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_COMPONENT_COMBINE_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * thrill/common/concurrent_mpsc_queue.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_CONCURRENT_MPSC_QUEUE_HEADER
+#define THRILL_COMMON_CONCURRENT_MPSC_QUEUE_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * This is an unbounded queue for many producer threads and a single consumer
+ * thread, with the same interface as ConcurrentBoundedQueue. Pushing and
+ * popping are lock-free: a producer links its node with one atomic exchange
+ * (Dmitry Vyukov's MPSC node queue), and the consumer unlinks nodes without
+ * any atomic read-modify-write. Items of each producer are popped in the order
+ * they were pushed.
+ *
+ * A mutex and condition variable are only used when the consumer finds the
+ * queue empty and goes to sleep: it publishes a waiting flag, and producers
+ * take the lock and signal only if they see this flag. Hence, delivering items
+ * to a busy consumer does not take a lock or a system call.
+ *
+ * For a single producer, this is a single-producer queue, since the exchange
+ * is then uncontended.
+ *
+ * StyleGuide is violated, because signatures are expected to match those of
+ * std::queue.
+ */
+template <typename T>
+class ConcurrentMpscQueue
+{
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    //! linked list node
+    struct Node {
+        template <typename... Arguments>
+        explicit Node(Arguments&& ... args)
+            : value(std::forward<Arguments>(args) ...) { }
+
+        std::atomic<Node*> next { nullptr };
+        T value;
+    };
+
+    //! number of try_pop() attempts before the consumer sleeps
+    static constexpr size_t spin_count_ = 64;
+
+    //! last node of the list, to which the producers append
+    std::atomic<Node*> head_;
+
+    //! stub node before the first item, only accessed by the consumer
+    Node* tail_;
+
+    //! number of items in the queue
+    std::atomic<size_t> size_ { 0 };
+
+    //! whether the consumer is (about to be) sleeping in pop()
+    std::atomic<bool> waiting_ { false };
+
+    //! the mutex to lock before sleeping or waking the consumer
+    std::mutex mutex_;
+
+    //! condition variable signaled when an item arrives for a waiting consumer
+    std::condition_variable cv_;
+
+    //! append node and wake the consumer if it is waiting.
+    void push_node(Node* node) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+
+        // sequentially consistent store and load pair with those in pop():
+        // either the consumer sees the node, or we see the waiting flag.
+        prev->next.store(node, std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_seq_cst)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.notify_one();
+        }
+    }
+
+public:
+    //! default constructor
+    ConcurrentMpscQueue()
+        : head_(new Node()), tail_(head_.load()) { }
+
+    //! non-copyable: delete copy-constructor
+    ConcurrentMpscQueue(const ConcurrentMpscQueue&) = delete;
+    //! non-copyable: delete assignment operator
+    ConcurrentMpscQueue& operator = (const ConcurrentMpscQueue&) = delete;
+
+    //! move-constructor, must not be used concurrently with other operations.
+    ConcurrentMpscQueue(ConcurrentMpscQueue&& other)
+        : ConcurrentMpscQueue() {
+        Node* head = head_.load();
+        head_.store(other.head_.load());
+        other.head_.store(head);
+        std::swap(tail_, other.tail_);
+        size_.store(other.size_.exchange(size_.load()));
+    }
+
+    //! destroy all remaining items
+    ~ConcurrentMpscQueue() {
+        while (tail_ != nullptr) {
+            Node* next = tail_->next.load(std::memory_order_relaxed);
+            delete tail_;
+            tail_ = next;
+        }
+    }
+
+    //! Pushes a copy of source onto back of the queue.
+    void push(const T& source) {
+        push_node(new Node(source));
+    }
+
+    //! Pushes given element into the queue by utilizing element's move
+    //! constructor
+    void push(T&& elem) {
+        push_node(new Node(std::move(elem)));
+    }
+
+    //! Pushes a new element into the queue. The element is constructed with
+    //! given arguments.
+    template <typename... Arguments>
+    void emplace(Arguments&& ... args) {
+        push_node(new Node(std::forward<Arguments>(args) ...));
+    }
+
+    //! Returns: true if queue has no items; false otherwise.
+    bool empty() const {
+        return size_.load(std::memory_order_acquire) == 0;
+    }
+
+    //! If value is available, pops it from the queue, move it to destination,
+    //! destroying the original position. Otherwise does nothing. Must only be
+    //! called by the consumer.
+    bool try_pop(T& destination) {
+        Node* next = tail_->next.load(std::memory_order_seq_cst);
+        if (next == nullptr)
+            return false;
+
+        // next becomes the new stub node
+        destination = std::move(next->value);
+        delete tail_;
+        tail_ = next;
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    //! If value is available, pops it from the queue, move it to
+    //! destination. If no item is in the queue, wait until there is one. Must
+    //! only be called by the consumer.
+    void pop(T& destination) {
+        for (size_t i = 0; i < spin_count_; ++i) {
+            if (try_pop(destination)) return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_.store(true, std::memory_order_seq_cst);
+
+        while (!try_pop(destination))
+            cv_.wait(lock);
+
+        waiting_.store(false, std::memory_order_relaxed);
+    }
+
+    //! return number of items available in the queue
+    size_t size() {
+        return size_.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_CONCURRENT_MPSC_QUEUE_HEADER
+
+/******************************************************************************/
@@ -60,6 +60,11 @@ static constexpr bool g_debug_push_file = false;
 #define THRILL_HAVE_MMAP_FILE 1
 #endif
 
+// MSVC doesn't define __SSE2__, but it is always available on x64 // NOLINT
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define THRILL_HAVE_SSE2
+#endif
+
 // MSVC doesn't define __SSE4_1__, so also check for __AVX__ // NOLINT
 #if defined(__SSE4_1__) || defined(__AVX__)
 #define THRILL_HAVE_SSE4_1
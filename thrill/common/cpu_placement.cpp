@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * thrill/common/cpu_placement.cpp
+ *
+ * Placement policies of Thrill's threads onto the cpus of a host, based on the
+ * package, core, and hyperthread topology.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/cpu_placement.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace thrill {
+namespace common {
+
+bool ParseCpuPlacement(const std::string& str, CpuPlacement* placement) {
+    if (str == "linear")
+        *placement = CpuPlacement::Linear;
+    else if (str == "compact")
+        *placement = CpuPlacement::Compact;
+    else if (str == "scatter")
+        *placement = CpuPlacement::Scatter;
+    else if (str == "physical")
+        *placement = CpuPlacement::Physical;
+    else
+        return false;
+    return true;
+}
+
+//! read a number from a sysfs file, or return def if it is unavailable.
+static size_t ReadSysfsNumber(const std::string& path, size_t def) {
+    std::ifstream in(path);
+    size_t value;
+    if (!in || !(in >> value)) return def;
+    return value;
+}
+
+std::vector<CpuInfo> ReadCpuTopology() {
+    size_t num_cpus = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    std::vector<CpuInfo> topology;
+    for (size_t cpu = 0; cpu < num_cpus; ++cpu) {
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu)
+                           + "/topology/";
+        topology.push_back(
+            CpuInfo { cpu, ReadSysfsNumber(path + "physical_package_id", 0),
+                      ReadSysfsNumber(path + "core_id", cpu) });
+    }
+    return topology;
+}
+
+std::vector<size_t> CpuPlacementOrder(
+    CpuPlacement placement, const std::vector<CpuInfo>& topology) {
+
+    // the hyperthreads of each core of each package, in cpu id order
+    std::map<std::pair<size_t, size_t>, std::vector<size_t> > cores;
+    for (const CpuInfo& c : topology)
+        cores[std::make_pair(c.package, c.core)].push_back(c.cpu);
+
+    // rank the cpus: (thread within core, core within package, package)
+    std::vector<std::tuple<size_t, size_t, size_t, size_t> > ranks;
+    size_t package = size_t(-1), core_rank = 0;
+    for (auto& core : cores) {
+        if (core.first.first != package) {
+            package = core.first.first;
+            core_rank = 0;
+        }
+        std::sort(core.second.begin(), core.second.end());
+        for (size_t t = 0; t < core.second.size(); ++t)
+            ranks.emplace_back(t, core_rank, package, core.second[t]);
+        ++core_rank;
+    }
+
+    switch (placement) {
+    case CpuPlacement::Linear:
+        std::sort(ranks.begin(), ranks.end(),
+                  [](const auto& a, const auto& b) {
+                      return std::get<3>(a) < std::get<3>(b);
+                  });
+        break;
+    case CpuPlacement::Compact:
+        std::sort(ranks.begin(), ranks.end(),
+                  [](const auto& a, const auto& b) {
+                      return std::tie(std::get<2>(a), std::get<1>(a),
+                                      std::get<0>(a)) <
+                             std::tie(std::get<2>(b), std::get<1>(b),
+                                      std::get<0>(b));
+                  });
+        break;
+    case CpuPlacement::Scatter:
+        std::sort(ranks.begin(), ranks.end());
+        break;
+    case CpuPlacement::Physical:
+        ranks.erase(
+            std::remove_if(ranks.begin(), ranks.end(),
+                           [](const auto& r) { return std::get<0>(r) != 0; }),
+            ranks.end());
+        std::sort(ranks.begin(), ranks.end(),
+                  [](const auto& a, const auto& b) {
+                      return std::tie(std::get<2>(a), std::get<1>(a)) <
+                             std::tie(std::get<2>(b), std::get<1>(b));
+                  });
+        break;
+    }
+
+    std::vector<size_t> order;
+    for (const auto& r : ranks)
+        order.push_back(std::get<3>(r));
+    return order;
+}
+
+//! protects g_placement_order
+static std::mutex g_placement_mutex;
+
+//! cpus of the placement slots, empty for the Linear default.
+static std::vector<size_t> g_placement_order;
+
+void SetCpuPlacement(CpuPlacement placement) {
+    std::vector<size_t> order;
+    if (placement != CpuPlacement::Linear)
+        order = CpuPlacementOrder(placement, ReadCpuTopology());
+
+    std::unique_lock<std::mutex> lock(g_placement_mutex);
+    g_placement_order = std::move(order);
+}
+
+size_t CpuPlacementSlots() {
+    std::unique_lock<std::mutex> lock(g_placement_mutex);
+    if (g_placement_order.empty())
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    return g_placement_order.size();
+}
+
+size_t CpuPlacementCpu(size_t slot) {
+    std::unique_lock<std::mutex> lock(g_placement_mutex);
+    if (g_placement_order.empty())
+        return slot % std::max<size_t>(1, std::thread::hardware_concurrency());
+    return g_placement_order[slot % g_placement_order.size()];
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * thrill/common/cpu_placement.hpp
+ *
+ * Placement policies of Thrill's threads onto the cpus of a host, based on the
+ * package, core, and hyperthread topology.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_CPU_PLACEMENT_HEADER
+#define THRILL_COMMON_CPU_PLACEMENT_HEADER
+
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Policies mapping placement slots to cpus. Worker threads take the slots from
+ * the front, i.e. local worker i is pinned to the cpu of slot i (plus
+ * THRILL_CORE_OFFSET), and the DispatcherThreads and the ProfileThread take
+ * the slots from the back.
+ */
+enum class CpuPlacement {
+    //! slots are the logical cpu ids, which was the only policy before.
+    Linear,
+    //! fill the hyperthreads of a core, then the cores of a package, then the
+    //! next package.
+    Compact,
+    //! spread over the packages, then over their cores, and only then use the
+    //! second hyperthreads of the cores.
+    Scatter,
+    //! use one hyperthread of each core only, such that no two slots share a
+    //! core's execution units.
+    Physical
+};
+
+//! parse "linear", "compact", "scatter", or "physical". Returns false if the
+//! string is none of them.
+bool ParseCpuPlacement(const std::string& str, CpuPlacement* placement);
+
+//! position of a logical cpu in the topology of the machine
+struct CpuInfo {
+    //! logical cpu id
+    size_t cpu;
+    //! id of the package (socket) containing the cpu
+    size_t package;
+    //! id of the core within the package, shared by hyperthread siblings
+    size_t core;
+};
+
+//! read the topology of the cpus from sysfs. If it is unavailable, each cpu is
+//! assumed to be its own core of a single package.
+std::vector<CpuInfo> ReadCpuTopology();
+
+//! calculate the cpus of the placement slots under the policy
+std::vector<size_t> CpuPlacementOrder(
+    CpuPlacement placement, const std::vector<CpuInfo>& topology);
+
+//! set the process-wide placement policy, which reads the topology. Must be
+//! called before launching the threads to place.
+void SetCpuPlacement(CpuPlacement placement);
+
+//! number of placement slots, i.e. of cpus, or of cores for Physical.
+size_t CpuPlacementSlots();
+
+//! return the cpu of a placement slot, wrapping around after the last slot.
+size_t CpuPlacementCpu(size_t slot);
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_CPU_PLACEMENT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * thrill/common/cycle_timer.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/cycle_timer.hpp>
+
+#include <thread>
+
+namespace thrill {
+namespace common {
+
+//! a pair of readings of both clocks
+struct CycleCounterSample {
+    std::chrono::steady_clock::time_point time;
+    uint64_t cycles;
+
+    static CycleCounterSample Now() {
+        return CycleCounterSample {
+                   std::chrono::steady_clock::now(), ReadCycleCounter()
+        };
+    }
+};
+
+//! reading at program start, taken during static initialization
+static const CycleCounterSample s_cycle_counter_start =
+    CycleCounterSample::Now();
+
+//! minimum interval over which the counter rate is measured
+static constexpr std::chrono::milliseconds calibration_interval(10);
+
+double CycleCounterFrequency() {
+    static const double frequency = [] {
+        std::this_thread::sleep_until(
+            s_cycle_counter_start.time + calibration_interval);
+        CycleCounterSample now = CycleCounterSample::Now();
+        double seconds = std::chrono::duration<double>(
+            now.time - s_cycle_counter_start.time).count();
+        return static_cast<double>(
+            now.cycles - s_cycle_counter_start.cycles) / seconds;
+    } ();
+    return frequency;
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
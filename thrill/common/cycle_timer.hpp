@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * thrill/common/cycle_timer.hpp
+ *
+ * Stop watch timer reading the processor's time stamp counter, for hot paths.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_CYCLE_TIMER_HEADER
+#define THRILL_COMMON_CYCLE_TIMER_HEADER
+
+#include <thrill/common/json_logger.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace thrill {
+namespace common {
+
+//! read the time stamp counter, or steady_clock nanoseconds on processors
+//! without one.
+static inline uint64_t ReadCycleCounter() {
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*!
+ * Return the rate of ReadCycleCounter() in ticks per second. It is calibrated
+ * against steady_clock from the start of the program on; the first call waits
+ * until at least 10 milliseconds have passed since then.
+ */
+double CycleCounterFrequency();
+
+/*!
+ * A statistical stop watch timer like StatsTimerBase, which reads the
+ * processor's time stamp counter instead of std::chrono::steady_clock. Start()
+ * and Stop() take a few dozen cycles and no system call, hence the timer may
+ * bracket per-item work in inner loops. The cycles are converted to time only
+ * when the accumulated time is read, using CycleCounterFrequency().
+ *
+ * The timer is not synchronized, each thread accumulates into its own timers,
+ * which can be summed up with operator += afterwards. The time stamp counter
+ * must be invariant, which all x86 processors of the last decade are.
+ */
+template <bool Active>
+class CycleTimerBase;
+
+template <>
+class CycleTimerBase<true>
+{
+public:
+    using duration = std::chrono::microseconds;
+
+    //! Initialize and optionally immediately start the timer
+    explicit CycleTimerBase(bool start_immediately = false) {
+        if (start_immediately) Start();
+    }
+
+    //! Whether the timer is real
+    bool Real() const { return true; }
+
+    //! Whether the timer is running
+    bool running() const { return running_; }
+
+    //! start timer
+    CycleTimerBase& Start() {
+        assert(!running_);
+        running_ = true;
+        last_start_ = ReadCycleCounter();
+        return *this;
+    }
+
+    //! stop timer
+    CycleTimerBase& Stop() {
+        assert(running_);
+        running_ = false;
+        accumulated_ += ReadCycleCounter() - last_start_;
+        return *this;
+    }
+
+    //! reset accumulated time
+    CycleTimerBase& Reset() {
+        accumulated_ = 0;
+        last_start_ = ReadCycleCounter();
+        return *this;
+    }
+
+    //! return currently accumulated cycles
+    uint64_t Cycles() const {
+        return accumulated_ +
+               (running_ ? ReadCycleCounter() - last_start_ : 0);
+    }
+
+    //! return currently accumulated time in seconds as double
+    double SecondsDouble() const {
+        return static_cast<double>(Cycles()) / CycleCounterFrequency();
+    }
+
+    //! return currently accumulated time in milliseconds as double
+    double MillisecondsDouble() const { return SecondsDouble() * 1e3; }
+
+    //! return currently accumulated time
+    duration Accumulated() const {
+        return duration(static_cast<duration::rep>(SecondsDouble() * 1e6));
+    }
+
+    //! return currently accumulated time in microseconds
+    duration::rep Microseconds() const { return Accumulated().count(); }
+
+    //! accumulate elapsed time from another timer
+    CycleTimerBase& operator += (const CycleTimerBase& tm) {
+        accumulated_ += tm.accumulated_;
+        return *this;
+    }
+
+    //! direct <<-operator for ostream. Can be used for printing with std::cout.
+    friend std::ostream& operator << (std::ostream& os, const CycleTimerBase& t) {
+        return os << t.SecondsDouble();
+    }
+
+    friend JsonLine& Put(JsonLine& line, const CycleTimerBase& t) {
+        return Put(line, t.SecondsDouble());
+    }
+
+private:
+    //! boolean whether the timer is currently running
+    bool running_ = false;
+
+    //! total accumulated cycles
+    uint64_t accumulated_ = 0;
+
+    //! cycle counter at the last start
+    uint64_t last_start_ = 0;
+};
+
+template <>
+class CycleTimerBase<false>
+{
+public:
+    using duration = std::chrono::microseconds;
+
+    //! Initialize and optionally immediately start the timer
+    explicit CycleTimerBase(bool /* start_immediately */ = false) { }
+
+    //! Whether the timer is real
+    bool Real() const { return false; }
+
+    //! Whether the timer is running
+    bool running() const { return false; }
+
+    //! start timer
+    CycleTimerBase& Start() { return *this; }
+
+    //! stop timer
+    CycleTimerBase& Stop() { return *this; }
+
+    //! reset accumulated time
+    CycleTimerBase& Reset() { return *this; }
+
+    //! return currently accumulated cycles
+    uint64_t Cycles() const { return 0; }
+
+    //! return currently accumulated time in seconds as double
+    double SecondsDouble() const { return 0; }
+
+    //! return currently accumulated time in milliseconds as double
+    double MillisecondsDouble() const { return 0; }
+
+    //! return currently accumulated time
+    duration Accumulated() const { return duration(); }
+
+    //! return currently accumulated time in microseconds
+    duration::rep Microseconds() const { return 0; }
+
+    //! accumulate elapsed time from another timer
+    CycleTimerBase& operator += (const CycleTimerBase&) { return *this; }
+
+    //! direct <<-operator for ostream. Can be used for printing with std::cout.
+    friend std::ostream& operator << (std::ostream& os, const CycleTimerBase&) {
+        return os << "<invalid>";
+    }
+
+    friend JsonLine& Put(JsonLine& line, const CycleTimerBase& t) {
+        return Put(line, t.SecondsDouble());
+    }
+};
+
+using CycleTimer = CycleTimerBase<true>;
+using FakeCycleTimer = CycleTimerBase<false>;
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_CYCLE_TIMER_HEADER
+
+/******************************************************************************/
@@ -108,6 +108,9 @@ public:
         return out;
     }
 
+    //! the component operation
+    const Operation& op() const { return op_; }
+
 private:
     Operation op_;
 };
@@ -130,6 +133,9 @@ public:
         return out;
     }
 
+    //! the component operation
+    const Operation& op() const { return op_; }
+
 private:
     Operation op_;
 };
@@ -14,11 +14,14 @@
 
 #include <thrill/common/config.hpp>
 #include <tlx/define/attribute_fallthrough.hpp>
+#include <tlx/define/likely.hpp>
 
 #include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <random>
 #include <string>
 #include <type_traits>
@@ -261,6 +264,162 @@ using HashTabulated = TabulationHashing<sizeof(T)>;
 template <typename T>
 using hash = HashCrc32<T>;
 
+/******************************************************************************/
+// wyhash
+
+namespace wyhash_detail {
+
+//! default secret of wyhash (final version 4)
+static constexpr uint64_t kSecret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+//! 64x64 -> 128 bit multiplication, returns low and high half in a and b.
+static inline void MulFull(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = static_cast<uint32_t>(*a), lb = static_cast<uint32_t>(*b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+//! multiply and fold the 128-bit product
+static inline uint64_t Mix(uint64_t a, uint64_t b) {
+    MulFull(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t Read8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t Read4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//! read 1-3 bytes
+static inline uint64_t Read3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) |
+           (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace wyhash_detail
+
+/*!
+ * wyhash by Wang Yi (public domain, https://github.com/wangyi-fudan/wyhash), a
+ * fast 64-bit hash passing SMHasher, which mixes with 64x64 -> 128 bit
+ * multiplications. Long inputs are consumed in 48 byte blocks by three
+ * independent multiply chains, which keeps superscalar cores busy, hence
+ * strings have the same fast hash on all standard libraries.
+ */
+static inline
+uint64_t HashWyhashBytes(const void* data, size_t size, uint64_t seed = 0) {
+    using namespace wyhash_detail;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+    uint64_t a, b;
+    if (TLX_LIKELY(size <= 16)) {
+        if (TLX_LIKELY(size >= 4)) {
+            a = (Read4(p) << 32) | Read4(p + ((size >> 3) << 2));
+            b = (Read4(p + size - 4) << 32) |
+                Read4(p + size - 4 - ((size >> 3) << 2));
+        }
+        else if (TLX_LIKELY(size > 0)) {
+            a = Read3(p, size);
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t i = size;
+        if (TLX_UNLIKELY(i > 48)) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+                see1 = Mix(Read8(p + 16) ^ kSecret[2], Read8(p + 24) ^ see1);
+                see2 = Mix(Read8(p + 32) ^ kSecret[3], Read8(p + 40) ^ see2);
+                p += 48, i -= 48;
+            } while (TLX_LIKELY(i > 48));
+            seed ^= see1 ^ see2;
+        }
+        while (TLX_UNLIKELY(i > 16)) {
+            seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+            p += 16, i -= 16;
+        }
+        a = Read8(p + i - 16);
+        b = Read8(p + i - 8);
+    }
+    a ^= kSecret[1];
+    b ^= seed;
+    MulFull(&a, &b);
+    return Mix(a ^ kSecret[0] ^ size, b ^ kSecret[1]);
+}
+
+//! wyhash's mixer of one 64-bit integer
+static inline uint64_t HashWyhash64(uint64_t x, uint64_t seed = 0) {
+    using namespace wyhash_detail;
+    return Mix(x ^ kSecret[0] ^ seed, x ^ kSecret[1]);
+}
+
+/*!
+ * wyhash of the bytes of a value.
+ *
+ * Note that you need to provide specializations of HashDataSwitch if you want
+ * to hash types with heap storage.
+ */
+template <typename ValueType>
+struct HashWyhash {
+    uint64_t operator () (const ValueType& val, uint64_t seed = 0) const {
+        const char* ptr = HashDataSwitch<ValueType>::ptr(val);
+        size_t size = HashDataSwitch<ValueType>::size(val);
+        return HashWyhashBytes(ptr, size, seed);
+    }
+};
+
+/*!
+ * Default hash function of keys in the reduce, group, and join DOps: wyhash
+ * for std::string and for integral and enum keys, whose std::hash is the
+ * identity in common standard libraries, and std::hash for all other types.
+ * Types whose bytes are not their value (padding, -0.0) keep std::hash.
+ */
+template <typename T, typename Enable = void>
+struct HashDefault {
+    size_t operator () (const T& x) const { return std::hash<T>()(x); }
+};
+
+template <>
+struct HashDefault<std::string> {
+    size_t operator () (const std::string& s) const {
+        return static_cast<size_t>(HashWyhashBytes(s.data(), s.size()));
+    }
+};
+
+template <typename T>
+struct HashDefault<
+    T, typename std::enable_if<
+        std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+    size_t operator () (const T& x) const {
+        return static_cast<size_t>(HashWyhash64(static_cast<uint64_t>(x)));
+    }
+};
+
 } // namespace common
 } // namespace thrill
 
@@ -11,25 +11,246 @@
  ******************************************************************************/
 
 #include <thrill/common/json_logger.hpp>
+#include <thrill/common/concurrent_bounded_queue.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/string.hpp>
 
 #include <tlx/die.hpp>
+#include <tlx/string/ends_with.hpp>
 
+#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace thrill {
 namespace common {
 
+/******************************************************************************/
+// JsonBinaryWriter
+
+//! header of binary log files
+static const char json_binary_magic[] = "thrill-tlog-1\n";
+static constexpr size_t json_binary_magic_size = sizeof(json_binary_magic) - 1;
+
+/*!
+ * Background writer of the binary log: each thread appends its lines to its
+ * own JsonBinaryBuffer without locking, and hands over full buffers, which a
+ * thread writes to the output stream.
+ */
+class JsonBinaryWriter
+{
+public:
+    //! size of buffers handed to the writer thread
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    explicit JsonBinaryWriter(std::ostream& os)
+        : os_(os), serial_(next_serial_++) {
+        os_.write(json_binary_magic, json_binary_magic_size);
+        thread_ = std::thread([this]() { Worker(); });
+    }
+
+    //! non-copyable: delete copy-constructor
+    JsonBinaryWriter(const JsonBinaryWriter&) = delete;
+    //! non-copyable: delete assignment operator
+    JsonBinaryWriter& operator = (const JsonBinaryWriter&) = delete;
+
+    ~JsonBinaryWriter() {
+        // write remaining lines of all threads, which have stopped logging.
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (std::unique_ptr<JsonBinaryBuffer>& b : buffers_) {
+                if (!b->data_.empty())
+                    queue_.push(std::move(b->data_));
+            }
+        }
+        // empty chunk terminates the writer thread
+        queue_.push(std::string());
+        thread_.join();
+        os_.flush();
+    }
+
+    //! the calling thread's buffer, allocated on first use
+    JsonBinaryBuffer* buffer() {
+        // buffers of this thread, by serial of their writer
+        static thread_local std::vector<
+            std::pair<size_t, JsonBinaryBuffer*> > cache;
+
+        for (const std::pair<size_t, JsonBinaryBuffer*>& c : cache) {
+            if (c.first == serial_) return c.second;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        buffers_.emplace_back(std::make_unique<JsonBinaryBuffer>());
+        JsonBinaryBuffer* b = buffers_.back().get();
+        b->data_.reserve(chunk_size);
+        cache.emplace_back(serial_, b);
+        return b;
+    }
+
+    //! hand the buffer to the writer thread once it is full
+    void Commit(JsonBinaryBuffer* buffer) {
+        if (buffer->data_.size() < chunk_size) return;
+        queue_.push(std::move(buffer->data_));
+        buffer->data_.clear();
+        buffer->data_.reserve(chunk_size);
+    }
+
+private:
+    //! output stream
+    std::ostream& os_;
+
+    //! unique serial to find this writer's buffers in the thread cache
+    size_t serial_;
+
+    //! counter of serials
+    static std::atomic<size_t> next_serial_;
+
+    //! all threads' buffers, locked only to register a new thread
+    std::vector<std::unique_ptr<JsonBinaryBuffer> > buffers_;
+    std::mutex mutex_;
+
+    //! full buffers for the writer thread
+    ConcurrentBoundedQueue<std::string> queue_;
+
+    //! writer thread
+    std::thread thread_;
+
+    void Worker() {
+        std::string chunk;
+        while (true) {
+            queue_.pop(chunk);
+            if (chunk.empty()) break;
+            os_.write(chunk.data(), chunk.size());
+        }
+    }
+};
+
+std::atomic<size_t> JsonBinaryWriter::next_serial_ { 0 };
+
+bool JsonBinaryToText(std::istream& is, std::ostream& os) {
+    std::string data((std::istreambuf_iterator<char>(is)),
+                     std::istreambuf_iterator<char>());
+
+    if (data.compare(0, json_binary_magic_size, json_binary_magic) != 0)
+        return false;
+
+    size_t pos = json_binary_magic_size;
+
+    auto get_varint =
+        [&](uint64_t* v) {
+            *v = 0;
+            for (size_t shift = 0; pos < data.size() && shift < 64; shift += 7) {
+                uint8_t b = static_cast<uint8_t>(data[pos++]);
+                *v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) return true;
+            }
+            return false;
+        };
+
+    auto get_string =
+        [&](std::string* str) {
+            uint64_t size;
+            if (!get_varint(&size) || data.size() - pos < size) return false;
+            str->assign(data, pos, size);
+            pos += size;
+            return true;
+        };
+
+    // format the values with the text JsonLine.
+    JsonLine line(nullptr, os);
+
+    // open objects (true) and arrays (false) with their number of items
+    std::vector<std::pair<bool, size_t> > stack;
+
+    // put ',' or ':' before an item, like JsonLine::PutSeparator()
+    auto separator =
+        [&]() {
+            if (stack.empty()) return;
+            std::pair<bool, size_t>& top = stack.back();
+            if (top.second > 0)
+                os << (top.first && top.second % 2 == 1 ? ':' : ',');
+            top.second++;
+        };
+
+    while (pos < data.size()) {
+        JsonBinaryTag tag = static_cast<JsonBinaryTag>(data[pos++]);
+        uint64_t v;
+        std::string str;
+
+        switch (tag) {
+        case JsonBinaryTag::False:
+        case JsonBinaryTag::True:
+            separator();
+            Put(line, tag == JsonBinaryTag::True);
+            break;
+        case JsonBinaryTag::Int:
+            if (!get_varint(&v)) return false;
+            separator();
+            Put(line, static_cast<long long>(
+                    static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1)));
+            break;
+        case JsonBinaryTag::UInt:
+            if (!get_varint(&v)) return false;
+            separator();
+            Put(line, static_cast<unsigned long long>(v));
+            break;
+        case JsonBinaryTag::Double: {
+            if (data.size() - pos < sizeof(double)) return false;
+            double d;
+            std::memcpy(&d, data.data() + pos, sizeof(double));
+            pos += sizeof(double);
+            separator();
+            Put(line, d);
+            break;
+        }
+        case JsonBinaryTag::String:
+            if (!get_string(&str)) return false;
+            separator();
+            Put(line, str);
+            break;
+        case JsonBinaryTag::Verbatim:
+            // items in verbatim text are not counted, see Put(JsonVerbatim)
+            if (!get_string(&str)) return false;
+            if (!stack.empty() && stack.back().second > 0) os << ',';
+            os << str;
+            break;
+        case JsonBinaryTag::BeginObj:
+        case JsonBinaryTag::BeginArray:
+            separator();
+            os << (tag == JsonBinaryTag::BeginObj ? '{' : '[');
+            stack.emplace_back(tag == JsonBinaryTag::BeginObj, 0);
+            break;
+        case JsonBinaryTag::EndObj:
+        case JsonBinaryTag::EndArray:
+            if (stack.empty() ||
+                stack.back().first != (tag == JsonBinaryTag::EndObj))
+                return false;
+            os << (tag == JsonBinaryTag::EndObj ? '}' : ']');
+            stack.pop_back();
+            if (stack.empty()) os << '\n';
+            break;
+        default:
+            return false;
+        }
+    }
+    return stack.empty();
+}
+
 /******************************************************************************/
 // JsonLogger
 
+JsonLogger::JsonLogger() = default;
+
+JsonLogger::~JsonLogger() = default;
+
 JsonLogger::JsonLogger(const std::string& path) {
     if (path.empty() || path == "/dev/null") {
         // os_ remains nullptr
@@ -44,11 +265,23 @@ JsonLogger::JsonLogger(const std::string& path) {
         return;
     }
 
-    os_ = std::make_unique<std::ofstream>(path.c_str());
+    if (tlx::ends_with(path, ".tlog")) {
+        os_ = std::make_unique<std::ofstream>(
+            path.c_str(), std::ios::out | std::ios::binary);
+    }
+    else {
+        os_ = std::make_unique<std::ofstream>(path.c_str());
+    }
     if (!os_->good()) {
         die("Could not open json log output: "
             << path << " : " << strerror(errno));
     }
+    if (tlx::ends_with(path, ".tlog"))
+        binary_ = std::make_unique<JsonBinaryWriter>(*os_);
+}
+
+void JsonLogger::CommitBinary(JsonBinaryBuffer* buffer) {
+    binary_->Commit(buffer);
 }
 
 JsonLogger::JsonLogger(JsonLogger* super)
@@ -70,8 +303,9 @@ JsonLine JsonLogger::line() {
         return JsonLine(this, dummy_of_);
     }
 
-    JsonLine out(this, *os_);
-    *os_ << '{';
+    JsonLine out = binary_
+                   ? JsonLine(this, *os_, binary_->buffer()) : JsonLine(this, *os_);
+    out.PutSyntax('{');
 
     // output timestamp in microseconds
     out << "ts"
@@ -18,6 +18,8 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <mutex>
@@ -30,6 +32,7 @@ namespace common {
 
 // forward declarations
 class JsonLine;
+class JsonBinaryWriter;
 class ScheduleThread;
 template <typename Type>
 struct JsonLinePutSwitch;
@@ -63,6 +66,65 @@ public:
 template <typename Type>
 using Array = Type[];
 
+//! Tags of the items in the compact binary log format
+enum class JsonBinaryTag : uint8_t {
+    False = 1, True, Int, UInt, Double, String, Verbatim,
+    BeginObj, EndObj, BeginArray, EndArray
+};
+
+/*!
+ * Buffer of one thread's lines in the compact binary log format. Each item is a
+ * JsonBinaryTag followed by its payload: integers as (zigzag) varints, doubles
+ * as their eight bytes, and strings as varint length and characters. The ','
+ * and ':' separators are not stored, JsonBinaryToText() restores them.
+ */
+class JsonBinaryBuffer
+{
+public:
+    void PutTag(JsonBinaryTag tag) {
+        data_.push_back(static_cast<char>(tag));
+    }
+
+    void PutVarint(uint64_t v) {
+        while (v >= 0x80) {
+            data_.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        data_.push_back(static_cast<char>(v));
+    }
+
+    void PutInt(int64_t v) {
+        PutTag(JsonBinaryTag::Int);
+        PutVarint((static_cast<uint64_t>(v) << 1) ^
+                  static_cast<uint64_t>(v >> 63));
+    }
+
+    void PutUInt(uint64_t v) {
+        PutTag(JsonBinaryTag::UInt);
+        PutVarint(v);
+    }
+
+    void PutDouble(double v) {
+        PutTag(JsonBinaryTag::Double);
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &v, sizeof(double));
+        data_.append(bytes, sizeof(double));
+    }
+
+    void PutString(JsonBinaryTag tag, const char* str, size_t size) {
+        PutTag(tag);
+        PutVarint(size);
+        data_.append(str, size);
+    }
+
+    //! encoded lines
+    std::string data_;
+};
+
+//! Convert a binary log written by a JsonLogger to a ".tlog" path into JSON
+//! lines. Returns false if the input is not a valid binary log.
+bool JsonBinaryToText(std::istream& is, std::ostream& os);
+
 /*!
  * JsonLogger is a receiver of JSON output objects for logging.
  */
@@ -70,9 +132,11 @@ class JsonLogger
 {
 public:
     //! open JsonLogger with ofstream uninitialized to discard log output.
-    JsonLogger() = default;
+    JsonLogger();
 
-    //! open JsonLogger with ofstream. if path is empty, output goes to stdout
+    //! open JsonLogger with ofstream. if path is empty, output goes to stdout.
+    //! Paths ending with ".tlog" are written in the compact binary format by a
+    //! background thread from per-thread buffers.
     explicit JsonLogger(const std::string& path);
 
     //! open JsonLogger with a super logger
@@ -83,6 +147,9 @@ public:
     template <typename... Args>
     explicit JsonLogger(JsonLogger* super, const Args& ... args);
 
+    //! flush and close the output
+    ~JsonLogger();
+
     //! create new JsonLine instance which will be written to this logger.
     JsonLine line();
 
@@ -102,6 +169,12 @@ public:
     //! mutex to lock logger output
     std::mutex mutex_;
 
+    //! writer of the binary log format, if enabled
+    std::unique_ptr<JsonBinaryWriter> binary_;
+
+    //! hand a thread's buffer with completed lines to the binary writer
+    void CommitBinary(JsonBinaryBuffer* buffer);
+
     //! common items outputted to each line
     JsonVerbatim common_;
 
@@ -119,10 +192,12 @@ public:
 class JsonLine
 {
 public:
-    //! ctor: bind output
-    JsonLine(JsonLogger* logger, std::ostream& os)
-        : logger_(logger), os_(os) {
-        if (logger)
+    //! ctor: bind output, or a thread's buffer of the binary log which
+    //! requires no lock.
+    JsonLine(JsonLogger* logger, std::ostream& os,
+             JsonBinaryBuffer* bin = nullptr)
+        : logger_(logger), os_(os), bin_(bin) {
+        if (logger && !bin)
             lock_ = std::unique_lock<std::mutex>(logger_->mutex_);
     }
 
@@ -133,7 +208,7 @@ public:
     //! move-constructor: unlink pointer
     JsonLine(JsonLine&& o)
         : logger_(o.logger_), lock_(std::move(o.lock_)),
-          os_(o.os_), items_(o.items_), sub_dict_(o.sub_dict_)
+          os_(o.os_), bin_(o.bin_), items_(o.items_), sub_dict_(o.sub_dict_)
     { o.logger_ = nullptr; }
 
     struct ArrayTag { };
@@ -147,13 +222,13 @@ public:
         // write key
         operator << (t.str_);
         PutSeparator();
-        os_ << '{';
+        PutSyntax('{');
         items_ = 0;
         return *this;
     }
 
     JsonLine& operator << (const JsonEndObj&) {
-        os_ << '}';
+        PutSyntax('}');
         return *this;
     }
 
@@ -166,15 +241,21 @@ public:
     void Close() {
         if (logger_ && items_ != 0) {
             assert(items_ % 2 == 0);
-            os_ << '}' << std::endl;
+            if (bin_) {
+                bin_->PutTag(JsonBinaryTag::EndObj);
+                logger_->CommitBinary(bin_);
+            }
+            else {
+                os_ << '}' << std::endl;
+            }
             items_ = 0;
         }
         else if (!logger_ && sub_dict_) {
-            os_ << '}';
+            PutSyntax('}');
             sub_dict_ = false;
         }
         else if (!logger_ && sub_array_) {
-            os_ << ']';
+            PutSyntax(']');
             sub_array_ = false;
         }
     }
@@ -188,7 +269,7 @@ public:
         // write key
         operator << (key);
         PutSeparator();
-        os_ << '{';
+        PutSyntax('{');
         return JsonLine(DictionaryTag(), *this);
     }
 
@@ -198,15 +279,15 @@ public:
         // write key
         operator << (key);
         PutSeparator();
-        os_ << '[';
+        PutSyntax('[');
         return JsonLine(ArrayTag(), *this);
     }
 
     //! return JsonLine has sub-dictionary of this one
     JsonLine obj() {
         if (items_ > 0)
-            os_ << ',';
-        os_ << '{';
+            PutSyntax(',');
+        PutSyntax('{');
         items_++;
         return JsonLine(DictionaryTag(), *this);
     }
@@ -214,11 +295,32 @@ public:
     //! put an items separator (either ',' or ':') and increment counter.
     void PutSeparator() {
         if (items_ > 0) {
-            os_ << (items_ % 2 == 0 ? ',' : ':');
+            PutSyntax(items_ % 2 == 0 ? ',' : ':');
         }
         items_++;
     }
 
+    //! put a bracket or separator. The binary format stores only brackets, as
+    //! tags.
+    void PutSyntax(char ch) {
+        if (!bin_) {
+            os_ << ch;
+            return;
+        }
+        switch (ch) {
+        case '{': bin_->PutTag(JsonBinaryTag::BeginObj);
+            break;
+        case '}': bin_->PutTag(JsonBinaryTag::EndObj);
+            break;
+        case '[': bin_->PutTag(JsonBinaryTag::BeginArray);
+            break;
+        case ']': bin_->PutTag(JsonBinaryTag::EndArray);
+            break;
+        default:
+            break;
+        }
+    }
+
     void PutEscapedChar(char ch) {
         // from: http://stackoverflow.com/a/7725289
         switch (ch) {
@@ -252,16 +354,19 @@ private:
 
     //! construct sub-dictionary
     JsonLine(struct DictionaryTag, JsonLine& parent)
-        : os_(parent.os_), sub_dict_(true) { }
+        : os_(parent.os_), bin_(parent.bin_), sub_dict_(true) { }
 
     //! construct sub-dictionary
     JsonLine(struct ArrayTag, JsonLine& parent)
-        : os_(parent.os_), sub_array_(true) { }
+        : os_(parent.os_), bin_(parent.bin_), sub_array_(true) { }
 
 public:
     //! reference to output stream
     std::ostream& os_;
 
+    //! thread's buffer of the binary log, or nullptr for text output to os_
+    JsonBinaryBuffer* bin_ = nullptr;
+
     //! items counter for output stream
     size_t items_ = 0;
 
@@ -277,54 +382,90 @@ public:
 
 static inline
 JsonLine& Put(JsonLine& line, bool const& value) {
+    if (line.bin_) {
+        line.bin_->PutTag(value ? JsonBinaryTag::True : JsonBinaryTag::False);
+        return line;
+    }
     line.os_ << (value ? "true" : "false");
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, int const& value) {
+    if (line.bin_) {
+        line.bin_->PutInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, unsigned int const& value) {
+    if (line.bin_) {
+        line.bin_->PutUInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, long const& value) {
+    if (line.bin_) {
+        line.bin_->PutInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, unsigned long const& value) {
+    if (line.bin_) {
+        line.bin_->PutUInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, long long const& value) {
+    if (line.bin_) {
+        line.bin_->PutInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, unsigned long long const& value) {
+    if (line.bin_) {
+        line.bin_->PutUInt(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, double const& value) {
+    if (line.bin_) {
+        line.bin_->PutDouble(value);
+        return line;
+    }
     line.os_ << value;
     return line;
 }
 
 static inline
 JsonLine& Put(JsonLine& line, const char* const& str) {
+    if (line.bin_) {
+        line.bin_->PutString(JsonBinaryTag::String, str, std::strlen(str));
+        return line;
+    }
     line.os_ << '"';
     for (const char* s = str; *s; ++s) line.PutEscapedChar(*s);
     line.os_ << '"';
@@ -333,6 +474,10 @@ JsonLine& Put(JsonLine& line, const char* const& str) {
 
 static inline
 JsonLine& Put(JsonLine& line, std::string const& str) {
+    if (line.bin_) {
+        line.bin_->PutString(JsonBinaryTag::String, str.data(), str.size());
+        return line;
+    }
     line.os_ << '"';
     for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
         line.PutEscapedChar(*i);
@@ -343,54 +488,54 @@ JsonLine& Put(JsonLine& line, std::string const& str) {
 template <typename Type, std::size_t N>
 static inline
 JsonLine& Put(JsonLine& line, const Type (& arr)[N]) {
-    line.os_ << '[';
+    line.PutSyntax('[');
     for (size_t i = 0; i < N; ++i) {
-        if (i != 0) line.os_ << ',';
+        if (i != 0) line.PutSyntax(',');
         Put(line, arr[i]);
     }
-    line.os_ << ']';
+    line.PutSyntax(']');
     return line;
 }
 
 template <typename Type>
 static inline
 JsonLine& Put(JsonLine& line, std::initializer_list<Type> const& list) {
-    line.os_ << '[';
+    line.PutSyntax('[');
     for (typename std::initializer_list<Type>::const_iterator it = list.begin();
          it != list.end(); ++it) {
         if (it != list.begin())
-            line.os_ << ',';
+            line.PutSyntax(',');
         Put(line, *it);
     }
-    line.os_ << ']';
+    line.PutSyntax(']');
     return line;
 }
 
 template <typename Type>
 static inline
 JsonLine& Put(JsonLine& line, std::vector<Type> const& vec) {
-    line.os_ << '[';
+    line.PutSyntax('[');
     for (typename std::vector<Type>::const_iterator it = vec.begin();
          it != vec.end(); ++it) {
         if (it != vec.begin())
-            line.os_ << ',';
+            line.PutSyntax(',');
         Put(line, *it);
     }
-    line.os_ << ']';
+    line.PutSyntax(']');
     return line;
 }
 
 template <typename Type, std::size_t N>
 static inline
 JsonLine& Put(JsonLine& line, std::array<Type, N> const& arr) {
-    line.os_ << '[';
+    line.PutSyntax('[');
     for (typename std::array<Type, N>::const_iterator it = arr.begin();
          it != arr.end(); ++it) {
         if (it != arr.begin())
-            line.os_ << ',';
+            line.PutSyntax(',');
         Put(line, *it);
     }
-    line.os_ << ']';
+    line.PutSyntax(']');
     return line;
 }
 
@@ -398,6 +543,11 @@ static inline
 JsonLine& Put(JsonLine& line, JsonVerbatim const& verbatim) {
     // undo increment of item counter
     --line.items_;
+    if (line.bin_) {
+        line.bin_->PutString(JsonBinaryTag::Verbatim,
+                             verbatim.str_.data(), verbatim.str_.size());
+        return line;
+    }
     line.os_ << verbatim.str_;
     return line;
 }
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * thrill/common/key_prefix.hpp
+ *
+ * Order-preserving 64-bit prefixes of sort keys, which are cached alongside
+ * items to avoid repeated expensive key comparisons.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_KEY_PREFIX_HEADER
+#define THRILL_COMMON_KEY_PREFIX_HEADER
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Traits class mapping keys to an order-preserving 64-bit prefix: if
+ * prefix(a) < prefix(b) then a < b. If the prefixes are equal, the full keys
+ * must be compared, unless is_exact is true, in which case equal prefixes
+ * imply equal keys. The general template is for keys without a prefix.
+ */
+template <typename Key, typename Enable = void>
+struct KeyPrefixTraits {
+    //! whether Key has an order-preserving prefix
+    static constexpr bool is_prefix_key = false;
+    //! whether equal prefixes imply equal keys
+    static constexpr bool is_exact = false;
+};
+
+//! prefix of unsigned integral keys of at most 64 bits is the key itself.
+template <typename Key>
+struct KeyPrefixTraits<
+    Key, typename std::enable_if<
+        std::is_integral<Key>::value && std::is_unsigned<Key>::value &&
+        !std::is_same<Key, bool>::value && sizeof(Key) <= 8>::type>
+{
+    static constexpr bool is_prefix_key = true;
+    static constexpr bool is_exact = true;
+
+    static uint64_t prefix(const Key& key) {
+        return static_cast<uint64_t>(key);
+    }
+};
+
+//! prefix of signed integral keys of at most 64 bits flips the sign bit.
+template <typename Key>
+struct KeyPrefixTraits<
+    Key, typename std::enable_if<
+        std::is_integral<Key>::value && std::is_signed<Key>::value &&
+        sizeof(Key) <= 8>::type>
+{
+    static constexpr bool is_prefix_key = true;
+    static constexpr bool is_exact = true;
+
+    static uint64_t prefix(const Key& key) {
+        return static_cast<uint64_t>(static_cast<int64_t>(key))
+               ^ (uint64_t(1) << 63);
+    }
+};
+
+//! prefix of strings are the first eight characters in big-endian order,
+//! padded with zeros.
+template <>
+struct KeyPrefixTraits<std::string>
+{
+    static constexpr bool is_prefix_key = true;
+    static constexpr bool is_exact = false;
+
+    static uint64_t prefix(const std::string& key) {
+        uint64_t p = 0;
+        size_t n = std::min<size_t>(key.size(), 8);
+        for (size_t i = 0; i < n; ++i)
+            p |= uint64_t(static_cast<uint8_t>(key[i])) << (56 - 8 * i);
+        return p;
+    }
+};
+
+//! prefix of fixed-size byte arrays are the first eight bytes in big-endian
+//! order.
+template <size_t N>
+struct KeyPrefixTraits<std::array<uint8_t, N> >
+{
+    static constexpr bool is_prefix_key = true;
+    static constexpr bool is_exact = (N <= 8);
+
+    static uint64_t prefix(const std::array<uint8_t, N>& key) {
+        uint64_t p = 0;
+        for (size_t i = 0; i < std::min<size_t>(N, 8); ++i)
+            p |= uint64_t(key[i]) << (56 - 8 * i);
+        return p;
+    }
+};
+
+//! prefix of pairs is the prefix of their first component.
+template <typename First, typename Second>
+struct KeyPrefixTraits<
+    std::pair<First, Second>,
+    typename std::enable_if<KeyPrefixTraits<First>::is_prefix_key>::type>
+{
+    static constexpr bool is_prefix_key = true;
+    static constexpr bool is_exact = false;
+
+    static uint64_t prefix(const std::pair<First, Second>& key) {
+        return KeyPrefixTraits<First>::prefix(key.first);
+    }
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_KEY_PREFIX_HEADER
+
+/******************************************************************************/
@@ -15,6 +15,7 @@
 
 #include <thrill/common/json_logger.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/metrics_writer.hpp>
 #include <thrill/common/porting.hpp>
 #include <thrill/common/profile_task.hpp>
 #include <thrill/common/profile_thread.hpp>
@@ -855,11 +856,62 @@ void StartLinuxProcStatsProfiler(ProfileThread& sched, JsonLogger& logger) {
               new LinuxProcStats(logger), /* own_task */ true);
 }
 
+void CollectLinuxProcMetrics(MetricsWriter& mw) {
+    std::string line;
+
+    std::ifstream file_pid_stat("/proc/self/stat");
+    if (std::getline(file_pid_stat, line)) {
+        // skip "pid (tcomm)", the executable name may contain spaces.
+        std::string::size_type pos = line.rfind(')');
+        unsigned long long utime, stime, num_threads, vsize, rss;
+        if (pos != std::string::npos &&
+            sscanf(line.data() + pos + 1,
+                   /* state ppid pgrp sid tty_nr tty_pgrp flags */
+                   " %*s %*u %*u %*u %*u %*u %*u "
+                   /* min_flt cmin_flt maj_flt cmaj_flt utime stime */
+                   "%*u %*u %*u %*u %llu %llu "
+                   /* cutime cstime priority nice num_threads */
+                   "%*u %*u %*u %*u %llu "
+                   /* it_real_value start_time vsize rss */
+                   "%*u %*u %llu %llu",
+                   &utime, &stime, &num_threads, &vsize, &rss) == 5)
+        {
+            double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+            mw.Counter("process_cpu_seconds_total",
+                       "User and system CPU time of the process.",
+                       static_cast<double>(utime + stime) / ticks);
+            mw.Gauge("process_threads", "Number of threads of the process.",
+                     num_threads);
+            mw.Gauge("process_virtual_memory_bytes",
+                     "Virtual memory size of the process.", vsize);
+            mw.Gauge("process_resident_memory_bytes",
+                     "Resident set size of the process.",
+                     rss * sysconf(_SC_PAGESIZE));
+        }
+    }
+
+    std::ifstream file_pid_io("/proc/self/io");
+    while (std::getline(file_pid_io, line)) {
+        unsigned long long value;
+        if (sscanf(line.data(), "read_bytes: %llu", &value) == 1) {
+            mw.Counter("process_disk_read_bytes_total",
+                       "Bytes read from storage by the process.", value);
+        }
+        else if (sscanf(line.data(), "write_bytes: %llu", &value) == 1) {
+            mw.Counter("process_disk_write_bytes_total",
+                       "Bytes written to storage by the process.", value);
+        }
+    }
+}
+
 #else
 
 void StartLinuxProcStatsProfiler(ProfileThread&, JsonLogger&)
 { }
 
+void CollectLinuxProcMetrics(MetricsWriter&)
+{ }
+
 #endif  // __linux__
 
 } // namespace common
@@ -20,11 +20,15 @@ namespace common {
 
 // forward declarations
 class JsonLogger;
+class MetricsWriter;
 class ProfileThread;
 
 //! launch profiler task
 void StartLinuxProcStatsProfiler(ProfileThread& sched, JsonLogger& logger);
 
+//! write CPU time, memory, and I/O of the process from /proc as live metrics
+void CollectLinuxProcMetrics(MetricsWriter& mw);
+
 } // namespace common
 } // namespace thrill
 
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * thrill/common/log_histogram.hpp
+ *
+ * Concurrent histogram with logarithmic buckets for latencies and sizes.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_LOG_HISTOGRAM_HEADER
+#define THRILL_COMMON_LOG_HISTOGRAM_HEADER
+
+#include <thrill/common/json_logger.hpp>
+
+#include <tlx/math/integer_log2.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Histogram of unsigned values in the style of HdrHistogram: each power of two
+ * range is split into kSubBuckets linear buckets, hence recorded values are
+ * kept with a relative error below 1 / kSubBuckets over the full 64-bit range,
+ * in a fixed array of counters. Add() consists of two relaxed atomic additions
+ * and may be called concurrently, while GetSnapshot() copies the counters for
+ * evaluation.
+ */
+class LogHistogram
+{
+public:
+    //! log2 of the number of linear buckets per power of two
+    static constexpr unsigned kSubBits = 3;
+
+    //! number of linear buckets per power of two
+    static constexpr unsigned kSubBuckets = 1u << kSubBits;
+
+    //! total number of buckets: values below kSubBuckets are exact.
+    static constexpr unsigned kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    //! bucket index of a value
+    static unsigned Index(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<unsigned>(v);
+        unsigned e = tlx::integer_log2_floor(v);
+        unsigned sub =
+            static_cast<unsigned>(v >> (e - kSubBits)) & (kSubBuckets - 1);
+        return (e - kSubBits + 1) * kSubBuckets + sub;
+    }
+
+    //! smallest value of a bucket
+    static uint64_t LowerBound(unsigned i) {
+        if (i < kSubBuckets) return i;
+        unsigned e = i / kSubBuckets + kSubBits - 1;
+        uint64_t sub = i % kSubBuckets;
+        return (kSubBuckets + sub) << (e - kSubBits);
+    }
+
+    //! largest value of a bucket
+    static uint64_t UpperBound(unsigned i) {
+        if (i < kSubBuckets) return i;
+        unsigned e = i / kSubBuckets + kSubBits - 1;
+        return LowerBound(i) + ((uint64_t(1) << (e - kSubBits)) - 1);
+    }
+
+    //! plain copy of the counters, which can be subtracted and evaluated
+    class Snapshot
+    {
+    public:
+        Snapshot() { counts_.fill(0); }
+
+        //! number of values recorded
+        uint64_t count() const { return count_; }
+
+        //! sum of values recorded
+        uint64_t sum() const { return sum_; }
+
+        //! average of values recorded
+        double mean() const {
+            return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_;
+        }
+
+        //! value below which the fraction q of the recorded values lie, up to
+        //! the relative error of the buckets. Returns 0 if empty.
+        uint64_t Quantile(double q) const {
+            if (count_ == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(q * count_);
+            if (rank >= count_) rank = count_ - 1;
+            uint64_t seen = 0;
+            for (unsigned i = 0; i < kBuckets; ++i) {
+                seen += counts_[i];
+                if (seen > rank) return UpperBound(i);
+            }
+            return 0;
+        }
+
+        //! largest value recorded, up to the relative error of the buckets
+        uint64_t max() const {
+            for (unsigned i = kBuckets; i != 0; --i) {
+                if (counts_[i - 1]) return UpperBound(i - 1);
+            }
+            return 0;
+        }
+
+        //! difference of two snapshots, the values recorded in between
+        Snapshot operator - (const Snapshot& b) const {
+            Snapshot s;
+            for (unsigned i = 0; i < kBuckets; ++i)
+                s.counts_[i] = counts_[i] - b.counts_[i];
+            s.count_ = count_ - b.count_;
+            s.sum_ = sum_ - b.sum_;
+            return s;
+        }
+
+        //! append "prefix_count", "prefix_mean", and percentiles of the values
+        //! as fields to a JsonLine
+        void Log(JsonLine& line, const std::string& prefix) const {
+            line << prefix + "_count" << count()
+                 << prefix + "_mean" << mean()
+                 << prefix + "_p50" << Quantile(0.5)
+                 << prefix + "_p90" << Quantile(0.9)
+                 << prefix + "_p99" << Quantile(0.99)
+                 << prefix + "_max" << max();
+        }
+
+    private:
+        std::array<uint64_t, kBuckets> counts_;
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+
+        friend class LogHistogram;
+    };
+
+    LogHistogram() {
+        for (unsigned i = 0; i < kBuckets; ++i) counts_[i] = 0;
+    }
+
+    //! non-copyable: delete copy-constructor
+    LogHistogram(const LogHistogram&) = delete;
+    //! non-copyable: delete assignment operator
+    LogHistogram& operator = (const LogHistogram&) = delete;
+
+    //! record a value
+    void Add(uint64_t v) {
+        counts_[Index(v)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    //! copy the current counters. The copy is not atomic as a whole, values
+    //! recorded concurrently may be missing in parts.
+    Snapshot GetSnapshot() const {
+        Snapshot s;
+        for (unsigned i = 0; i < kBuckets; ++i) {
+            s.counts_[i] = counts_[i].load(std::memory_order_relaxed);
+            s.count_ += s.counts_[i];
+        }
+        s.sum_ = sum_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    //! counters of the buckets
+    std::atomic<uint64_t> counts_[kBuckets];
+
+    //! sum of all values recorded
+    std::atomic<uint64_t> sum_ { 0 };
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_LOG_HISTOGRAM_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * thrill/common/metrics_writer.hpp
+ *
+ * Writer of live metrics in the Prometheus text exposition format.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_METRICS_WRITER_HEADER
+#define THRILL_COMMON_METRICS_WRITER_HEADER
+
+#include <ostream>
+#include <string>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Writes metrics in the Prometheus (OpenMetrics) text format, as served by the
+ * MetricsServer. Each metric family has a HELP and a TYPE line, followed by
+ * samples with optional labels. All names are prefixed with "thrill_".
+ */
+class MetricsWriter
+{
+public:
+    explicit MetricsWriter(std::ostream& os) : os_(os) { }
+
+    //! begin a metric family of type "gauge" or "counter"
+    void Family(const std::string& name, const char* type, const char* help) {
+        name_ = "thrill_" + name;
+        os_ << "# HELP " << name_ << ' ' << help << '\n'
+            << "# TYPE " << name_ << ' ' << type << '\n';
+    }
+
+    //! write a sample of the current family, labels are key="value" pairs
+    template <typename Value>
+    void Sample(const Value& value, const std::string& labels = std::string()) {
+        os_ << name_;
+        if (!labels.empty())
+            os_ << '{' << labels << '}';
+        os_ << ' ' << value << '\n';
+    }
+
+    //! write a gauge family with one sample
+    template <typename Value>
+    void Gauge(const std::string& name, const char* help, const Value& value) {
+        Family(name, "gauge", help);
+        Sample(value);
+    }
+
+    //! write a counter family with one sample, name should end with "_total"
+    template <typename Value>
+    void Counter(const std::string& name, const char* help, const Value& value) {
+        Family(name, "counter", help);
+        Sample(value);
+    }
+
+private:
+    //! output stream
+    std::ostream& os_;
+
+    //! name of the current family
+    std::string name_;
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_METRICS_WRITER_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * thrill/common/perf_counters.cpp
+ *
+ * Hardware performance counters of the calling thread via perf_event_open.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/perf_counters.hpp>
+
+#include <thrill/common/json_logger.hpp>
+#include <thrill/common/logger.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#if __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+namespace thrill {
+namespace common {
+
+static constexpr bool debug = false;
+
+void PerfCounters::Values::Log(JsonLine& line) const {
+    line << "perf_cycles" << cycles
+         << "perf_instructions" << instructions
+         << "perf_ipc" << ipc()
+         << "perf_cache_misses" << cache_misses
+         << "perf_branch_misses" << branch_misses;
+}
+
+#if __linux__
+
+PerfCounters::PerfCounters() {
+    static const uint64_t config[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (unsigned i = 0; i < kNumCounters; ++i) fd_[i] = -1;
+
+    for (unsigned i = 0; i < kNumCounters; ++i) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config[i];
+        attr.read_format = PERF_FORMAT_GROUP;
+        // start the whole group at once, and count only user space, which
+        // also works with perf_event_paranoid=2.
+        attr.disabled = (i == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // calling thread on any cpu, in the group of the first counter
+        fd_[i] = static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, fd_[0], 0));
+
+        if (fd_[i] < 0) {
+            LOG << "PerfCounters: perf_event_open() failed: "
+                << strerror(errno);
+            for (unsigned j = 0; j < i; ++j) {
+                close(fd_[j]);
+                fd_[j] = -1;
+            }
+            return;
+        }
+    }
+
+    ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters() {
+    for (unsigned i = 0; i < kNumCounters; ++i) {
+        if (fd_[i] >= 0) close(fd_[i]);
+    }
+}
+
+PerfCounters::Values PerfCounters::Read() const {
+    Values v;
+    if (!available()) return v;
+
+    // PERF_FORMAT_GROUP layout: number of counters, then their values
+    uint64_t data[1 + kNumCounters];
+    if (read(fd_[0], data, sizeof(data)) != sizeof(data) ||
+        data[0] != kNumCounters)
+        return v;
+
+    v.cycles = data[1];
+    v.instructions = data[2];
+    v.cache_misses = data[3];
+    v.branch_misses = data[4];
+    return v;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (unsigned i = 0; i < kNumCounters; ++i) fd_[i] = -1;
+}
+
+PerfCounters::~PerfCounters() { }
+
+PerfCounters::Values PerfCounters::Read() const {
+    return Values();
+}
+
+#endif  // __linux__
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * thrill/common/perf_counters.hpp
+ *
+ * Hardware performance counters of the calling thread via perf_event_open.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_PERF_COUNTERS_HEADER
+#define THRILL_COMMON_PERF_COUNTERS_HEADER
+
+#include <cstdint>
+
+namespace thrill {
+namespace common {
+
+class JsonLine;
+
+/*!
+ * Reads the cycles, instructions, cache misses, and branch mispredictions of
+ * the thread which constructed the object, using a Linux perf_event_open
+ * counter group. The counters are not available on other systems or if the
+ * kernel denies access, see /proc/sys/kernel/perf_event_paranoid.
+ */
+class PerfCounters
+{
+public:
+    //! counter values, all zero if not available
+    struct Values {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cache_misses = 0;
+        uint64_t branch_misses = 0;
+
+        //! difference of two readings
+        Values operator - (const Values& b) const {
+            Values v;
+            v.cycles = cycles - b.cycles;
+            v.instructions = instructions - b.instructions;
+            v.cache_misses = cache_misses - b.cache_misses;
+            v.branch_misses = branch_misses - b.branch_misses;
+            return v;
+        }
+
+        //! instructions per cycle
+        double ipc() const {
+            return cycles == 0 ? 0.0 :
+                   static_cast<double>(instructions) / cycles;
+        }
+
+        //! append the counters as "perf_*" fields to a JsonLine
+        void Log(JsonLine& line) const;
+    };
+
+    //! open and start the counters for the calling thread
+    PerfCounters();
+
+    //! non-copyable: delete copy-constructor
+    PerfCounters(const PerfCounters&) = delete;
+    //! non-copyable: delete assignment operator
+    PerfCounters& operator = (const PerfCounters&) = delete;
+
+    //! close the counters
+    ~PerfCounters();
+
+    //! whether the counters could be opened
+    bool available() const { return fd_[0] >= 0; }
+
+    //! read the current counter values
+    Values Read() const;
+
+private:
+    //! number of counters in the group
+    static constexpr unsigned kNumCounters = 4;
+
+    //! file descriptors of the counters, the first is the group leader
+    int fd_[kNumCounters];
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_PERF_COUNTERS_HEADER
+
+/******************************************************************************/
@@ -20,6 +20,13 @@
 
 #include <fcntl.h>
 
+#if __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <mutex>
 #include <sstream>
@@ -140,6 +147,111 @@ void SetCpuAffinity(size_t cpu_id) {
 #endif
 }
 
+size_t GetNumaNode(size_t cpu_id) {
+#if __linux__
+    // the cpu's sysfs directory contains a link nodeX to its NUMA node
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu_id);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return 0;
+
+    size_t numa_node = 0;
+    while (struct dirent* de = ts_readdir(dir)) {
+        if (strncmp(de->d_name, "node", 4) == 0 &&
+            de->d_name[4] >= '0' && de->d_name[4] <= '9') {
+            numa_node = std::strtoul(de->d_name + 4, nullptr, 10);
+            break;
+        }
+    }
+    closedir(dir);
+    return numa_node;
+#else
+    tlx::unused(cpu_id);
+    return 0;
+#endif
+}
+
+size_t GetCurrentNumaNode() {
+#if __linux__
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : GetNumaNode(static_cast<size_t>(cpu));
+#else
+    return 0;
+#endif
+}
+
+void SetNumaNodeAffinity(size_t numa_node) {
+#if __linux__ && !THRILL_ON_TRAVIS
+    std::ifstream in("/sys/devices/system/node/node" +
+                     std::to_string(numa_node) + "/cpulist");
+    std::string cpulist;
+    // no NUMA information: leave affinity unchanged
+    if (!in || !std::getline(in, cpulist)) return;
+
+    // parse list of cpu ranges like "0-7,16-23"
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    std::istringstream iss(cpulist);
+    std::string range;
+    while (std::getline(iss, range, ',')) {
+        char* endptr;
+        size_t first = std::strtoul(range.c_str(), &endptr, 10);
+        size_t last = (*endptr == '-')
+                      ? std::strtoul(endptr + 1, nullptr, 10) : first;
+        for (size_t c = first; c <= last && c < CPU_SETSIZE; ++c)
+            CPU_SET(c, &cpuset);
+    }
+    if (CPU_COUNT(&cpuset) == 0) return;
+
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    if (rc != 0) {
+        LOG1 << "Error calling pthread_setaffinity_np(): "
+             << rc << ": " << strerror(errno);
+    }
+#else
+    tlx::unused(numa_node);
+#endif
+}
+
+size_t GetNumaNodeCount() {
+#if __linux__
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (!dir) return 1;
+
+    size_t count = 0;
+    while (struct dirent* de = ts_readdir(dir)) {
+        if (strncmp(de->d_name, "node", 4) == 0 &&
+            de->d_name[4] >= '0' && de->d_name[4] <= '9')
+            ++count;
+    }
+    closedir(dir);
+    return count == 0 ? 1 : count;
+#else
+    return 1;
+#endif
+}
+
+bool BindMemoryToNumaNode(void* addr, size_t size, size_t numa_node) {
+#if __linux__ && defined(SYS_mbind)
+    // values from <linux/mempolicy.h>, which is not always installed
+    static constexpr int mpol_preferred = 1;
+    static constexpr unsigned mpol_mf_move = 1 << 1;
+
+    static constexpr size_t bits = 8 * sizeof(unsigned long);
+    if (numa_node >= 16 * bits) return false;
+
+    unsigned long nodemask[16] = { 0 };
+    nodemask[numa_node / bits] = 1ul << (numa_node % bits);
+
+    return syscall(SYS_mbind, addr, size, mpol_preferred,
+                   nodemask, 16 * bits, mpol_mf_move) == 0;
+#else
+    tlx::unused(addr);
+    tlx::unused(size);
+    tlx::unused(numa_node);
+    return false;
+#endif
+}
+
 std::string GetHostname() {
 #if __linux__
     char buffer[64];
@@ -62,6 +62,24 @@ void SetCpuAffinity(std::thread& thread, size_t cpu_id);
 //! set cpu/core affinity of current thread
 void SetCpuAffinity(size_t cpu_id);
 
+//! return NUMA node of a cpu/core, or zero if unknown
+size_t GetNumaNode(size_t cpu_id);
+
+//! return NUMA node of the cpu/core the current thread is running on
+size_t GetCurrentNumaNode();
+
+//! set affinity of current thread to all cpus/cores of a NUMA node, such that
+//! memory it first touches is allocated node-local
+void SetNumaNodeAffinity(size_t numa_node);
+
+//! return number of NUMA nodes of the machine, or one if unknown
+size_t GetNumaNodeCount();
+
+//! set the memory policy of the pages in [addr, addr + size) to prefer the
+//! given NUMA node. Pages already touched are migrated. addr must be aligned to
+//! the page size. Returns false if the policy could not be set.
+bool BindMemoryToNumaNode(void* addr, size_t size, size_t numa_node);
+
 //! get hostname
 std::string GetHostname();
 
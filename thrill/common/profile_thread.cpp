@@ -14,6 +14,8 @@
 #include <thrill/common/profile_thread.hpp>
 
 #include <thrill/common/config.hpp>
+#include <thrill/common/cpu_placement.hpp>
+#include <thrill/common/porting.hpp>
 
 namespace thrill {
 namespace common {
@@ -47,6 +49,10 @@ bool ProfileThread::Remove(ProfileTask* task) {
 }
 
 void ProfileThread::Worker() {
+    // share the last placement slot with the DispatcherThread
+    common::SetCpuAffinity(
+        common::CpuPlacementCpu(common::CpuPlacementSlots() - 1));
+
     std::unique_lock<std::timed_mutex> lock(mutex_);
 
     steady_clock::time_point tm = steady_clock::now();
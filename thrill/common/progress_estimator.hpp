@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * thrill/common/progress_estimator.hpp
+ *
+ * Estimates throughput and remaining time of a phase from progress readings.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_PROGRESS_ESTIMATOR_HEADER
+#define THRILL_COMMON_PROGRESS_ESTIMATOR_HEADER
+
+#include <cstdint>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Estimates the throughput and the time remaining of a phase from periodic
+ * readings of the items processed. The phase is identified by a key, and the
+ * estimate restarts whenever the key changes or the items decrease, such that
+ * repeated passes of a phase are measured separately. The rate is the average
+ * since the first reading of the phase, which is steadier than the rate of the
+ * last interval for long phases.
+ */
+class ProgressEstimator
+{
+public:
+    //! add a reading at time seconds. total_items is the expected number of
+    //! items of the phase, or 0 if unknown.
+    void Update(double seconds, uint64_t key,
+                uint64_t items, uint64_t total_items) {
+        if (!valid_ || key != key_ || items < items_) {
+            valid_ = true;
+            key_ = key;
+            start_seconds_ = seconds;
+            start_items_ = items;
+        }
+        seconds_ = seconds;
+        items_ = items;
+        total_items_ = total_items;
+    }
+
+    //! items processed per second since the phase started, 0 if unknown.
+    double rate() const {
+        if (!valid_ || seconds_ <= start_seconds_) return 0.0;
+        return static_cast<double>(items_ - start_items_)
+               / (seconds_ - start_seconds_);
+    }
+
+    //! fraction of the items processed, or -1 if the total is unknown.
+    double fraction() const {
+        if (!valid_ || total_items_ == 0) return -1.0;
+        if (items_ >= total_items_) return 1.0;
+        return static_cast<double>(items_) / total_items_;
+    }
+
+    //! estimated seconds remaining, or -1 if unknown.
+    double eta() const {
+        if (!valid_ || total_items_ == 0) return -1.0;
+        if (items_ >= total_items_) return 0.0;
+        double r = rate();
+        if (r <= 0.0) return -1.0;
+        return static_cast<double>(total_items_ - items_) / r;
+    }
+
+private:
+    //! whether there was a reading
+    bool valid_ = false;
+    //! key of the phase
+    uint64_t key_ = 0;
+    //! time and items of the first reading of the phase
+    double start_seconds_ = 0;
+    uint64_t start_items_ = 0;
+    //! last reading
+    double seconds_ = 0;
+    uint64_t items_ = 0;
+    uint64_t total_items_ = 0;
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_PROGRESS_ESTIMATOR_HEADER
+
+/******************************************************************************/
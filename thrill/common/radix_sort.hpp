@@ -2,7 +2,8 @@
  * thrill/common/radix_sort.hpp
  *
  * An implementations of generic 8-bit radix sort using key caching (requires n
- * extra bytes of memory) and in-place permutation reordering.
+ * extra bytes of memory) and in-place permutation reordering. Additionally, a
+ * hybrid MSD/LSD radix sort on fixed-width keys delivered by a key extractor.
  *
  * Part of Project Thrill - http://project-thrill.org
  *
@@ -20,8 +21,11 @@
 #include <tlx/meta/no_operation.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 namespace thrill {
 namespace common {
@@ -161,6 +165,332 @@ private:
     const size_t K_;
 };
 
+/******************************************************************************/
+// Radix Sort by Fixed-Width Keys
+
+/*!
+ * Traits class describing how a fixed-width Key is split into 8-bit digits,
+ * with the most significant digit first, such that the digit order matches
+ * std::less<Key>. Only keys with a specialization are radix sortable.
+ */
+template <typename Key, typename Enable = void>
+struct RadixKeyTraits {
+    static constexpr bool is_radix_key = false;
+};
+
+//! RadixKeyTraits for unsigned integral types.
+template <typename Key>
+struct RadixKeyTraits<
+    Key, typename std::enable_if<
+        std::is_integral<Key>::value && std::is_unsigned<Key>::value &&
+        !std::is_same<Key, bool>::value>::type>
+{
+    static constexpr bool is_radix_key = true;
+
+    //! number of 8-bit digits in the key
+    static constexpr size_t digits = sizeof(Key);
+
+    //! return digit at depth, counting from the most significant digit
+    static uint8_t digit(const Key& key, size_t depth) {
+        return static_cast<uint8_t>(key >> (8 * (digits - 1 - depth)));
+    }
+};
+
+//! RadixKeyTraits for signed integral types: the sign bit is flipped such that
+//! negative keys are ordered before positive ones.
+template <typename Key>
+struct RadixKeyTraits<
+    Key, typename std::enable_if<
+        std::is_integral<Key>::value && std::is_signed<Key>::value>::type>
+{
+    using Unsigned = typename std::make_unsigned<Key>::type;
+
+    static constexpr bool is_radix_key = true;
+
+    //! number of 8-bit digits in the key
+    static constexpr size_t digits = sizeof(Key);
+
+    //! return digit at depth, counting from the most significant digit
+    static uint8_t digit(const Key& key, size_t depth) {
+        return RadixKeyTraits<Unsigned>::digit(
+            static_cast<Unsigned>(
+                static_cast<Unsigned>(key) ^
+                static_cast<Unsigned>(Unsigned(1) << (8 * digits - 1))),
+            depth);
+    }
+};
+
+//! RadixKeyTraits for byte arrays, which are ordered lexicographically.
+template <size_t N>
+struct RadixKeyTraits<std::array<uint8_t, N> >{
+    static constexpr bool is_radix_key = true;
+
+    //! number of 8-bit digits in the key
+    static constexpr size_t digits = N;
+
+    //! return digit at depth, counting from the most significant digit
+    static uint8_t digit(const std::array<uint8_t, N>& key, size_t depth) {
+        return key[depth];
+    }
+};
+
+/*!
+ * Internal helper method, use radix_sort_key below. Distribute the items in
+ * [begin,end) to out using the digit at depth and the exclusive bucket
+ * prefix sums in bkt_index.
+ */
+template <typename Key, typename InputIterator, typename OutputIterator,
+          typename KeyExtractor>
+static inline
+void radix_sort_key_scatter(InputIterator begin, InputIterator end,
+                            OutputIterator out,
+                            const KeyExtractor& key_extractor, size_t depth,
+                            size_t* bkt_index) {
+    using Traits = RadixKeyTraits<Key>;
+
+    for (InputIterator it = begin; it != end; ++it) {
+        const Key& key = key_extractor(*it);
+        out[bkt_index[Traits::digit(key, depth)]++] = std::move(*it);
+    }
+}
+
+/*!
+ * Internal helper method, use radix_sort_key below. LSD radix sort of
+ * [begin,end) by the digits [depth,digits) using buffer as temporary space,
+ * which must hold at least (end - begin) items. The histograms of all digits
+ * are counted in a single sweep, and passes in which all items have the same
+ * digit are skipped.
+ */
+template <typename Key, typename Iterator, typename KeyExtractor,
+          typename Buffer>
+static inline
+void radix_sort_key_lsd(Iterator begin, Iterator end,
+                        const KeyExtractor& key_extractor, size_t depth,
+                        Buffer& buffer, std::vector<size_t>& hist) {
+    using Traits = RadixKeyTraits<Key>;
+
+    const size_t size = end - begin;
+    const size_t passes = Traits::digits - depth;
+
+    // count occurrences of all digits in a single sweep
+    hist.assign(passes * 256, 0);
+    for (Iterator it = begin; it != end; ++it) {
+        const Key& key = key_extractor(*it);
+        for (size_t p = 0; p < passes; ++p)
+            ++hist[p * 256 + Traits::digit(key, depth + p)];
+    }
+
+    // run passes from least to most significant digit, the items alternate
+    // between the range and the buffer.
+    bool in_buffer = false;
+    std::array<size_t, 256> bkt_index;
+
+    for (size_t p = passes; p-- > 0; )
+    {
+        const size_t* bkt_size = hist.data() + p * 256;
+
+        // skip passes in which all items are in the same bucket
+        {
+            const Key& first = in_buffer
+                               ? key_extractor(*buffer.begin())
+                               : key_extractor(*begin);
+            if (bkt_size[Traits::digit(first, depth + p)] == size)
+                continue;
+        }
+
+        // exclusive prefix sum
+        size_t sum = 0;
+        for (size_t i = 0; i < 256; ++i) {
+            bkt_index[i] = sum;
+            sum += bkt_size[i];
+        }
+
+        if (!in_buffer) {
+            radix_sort_key_scatter<Key>(
+                begin, end, buffer.begin(),
+                key_extractor, depth + p, bkt_index.data());
+        }
+        else {
+            radix_sort_key_scatter<Key>(
+                buffer.begin(), buffer.begin() + size, begin,
+                key_extractor, depth + p, bkt_index.data());
+        }
+        in_buffer = !in_buffer;
+    }
+
+    if (in_buffer)
+        std::move(buffer.begin(), buffer.begin() + size, begin);
+}
+
+/*!
+ * Internal helper method, use radix_sort_key below. In-place MSD radix sort of
+ * [begin,end) at digit depth, which switches to LSD radix sort for buckets
+ * that fit into buffer, and to std::sort() for tiny buckets.
+ */
+template <typename Key, typename Iterator, typename KeyExtractor,
+          typename Buffer>
+static inline
+void radix_sort_key_msd(Iterator begin, Iterator end,
+                        const KeyExtractor& key_extractor, size_t depth,
+                        uint8_t* digit_cache,
+                        Buffer& buffer, std::vector<size_t>& hist) {
+    using Traits = RadixKeyTraits<Key>;
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    const size_t size = end - begin;
+
+    if (size < 64) {
+        return std::sort(
+            begin, end,
+            [&key_extractor](const value_type& a, const value_type& b) {
+                return key_extractor(a) < key_extractor(b);
+            });
+    }
+
+    if (size <= buffer.size()) {
+        return radix_sort_key_lsd<Key>(
+            begin, end, key_extractor, depth, buffer, hist);
+    }
+
+    // cache digits
+    uint8_t* dc = digit_cache;
+    for (Iterator it = begin; it != end; ++it, ++dc)
+        *dc = Traits::digit(key_extractor(*it), depth);
+
+    // count digit occurrences
+    std::array<size_t, 256> bkt_size;
+    std::fill(bkt_size.begin(), bkt_size.end(), 0);
+    for (const uint8_t* dci = digit_cache; dci != digit_cache + size; ++dci)
+        ++bkt_size[*dci];
+
+    // inclusive prefix sum
+    std::array<size_t, 256> bkt_index;
+    bkt_index[0] = bkt_size[0];
+    size_t last_bkt_size = bkt_size[0];
+    for (size_t i = 1; i < 256; ++i) {
+        bkt_index[i] = bkt_index[i - 1] + bkt_size[i];
+        if (bkt_size[i]) last_bkt_size = bkt_size[i];
+    }
+
+    // premute in-place
+    for (size_t i = 0, j; i < size - last_bkt_size; )
+    {
+        value_type v = std::move(begin[i]);
+        uint8_t vd = digit_cache[i];
+        while ((j = --bkt_index[vd]) > i)
+        {
+            using std::swap;
+            swap(v, begin[j]);
+            swap(vd, digit_cache[j]);
+        }
+        begin[i] = std::move(v);
+        i += bkt_size[vd];
+    }
+
+    if (depth + 1 == Traits::digits) return;
+
+    // recurse
+    size_t bsum = 0;
+    for (size_t i = 0; i < 256; bsum += bkt_size[i++]) {
+        if (bkt_size[i] <= 1) continue;
+        radix_sort_key_msd<Key>(
+            begin + bsum, begin + bsum + bkt_size[i],
+            key_extractor, depth + 1, digit_cache, buffer, hist);
+    }
+}
+
+/*!
+ * Internal helper method, use radix_sort_key below. Radix sort [begin,end) by
+ * the digits [depth,digits) of the keys, the leading digits must be equal in
+ * all keys.
+ */
+template <typename Key, typename Iterator, typename KeyExtractor>
+static inline
+void radix_sort_key_from(Iterator begin, Iterator end,
+                         const KeyExtractor& key_extractor, size_t depth,
+                         size_t block_bytes) {
+
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    static_assert(RadixKeyTraits<Key>::is_radix_key,
+                  "Key type is not radix sortable");
+
+    const size_t size = end - begin;
+    if (size <= 1 || depth >= RadixKeyTraits<Key>::digits) return;
+
+    // allocate LSD buffer for one cache-sized block
+    std::vector<value_type> buffer(
+        std::min(size, std::max<size_t>(
+                     block_bytes / sizeof(value_type), 64)));
+    std::vector<size_t> hist;
+
+    if (size <= buffer.size()) {
+        return radix_sort_key_msd<Key>(
+            begin, end, key_extractor, depth,
+            /* digit_cache */ nullptr, buffer, hist);
+    }
+
+    // allocate digit cache once
+    std::vector<uint8_t> digit_cache(size);
+    radix_sort_key_msd<Key>(
+        begin, end, key_extractor, depth,
+        digit_cache.data(), buffer, hist);
+}
+
+/*!
+ * Radix sort the iterator range [begin,end) by the fixed-width keys delivered
+ * by key_extractor, which must be radix sortable as determined by
+ * RadixKeyTraits. Large ranges are partitioned by in-place MSD radix sort
+ * until the buckets contain at most block_bytes of items, these are then
+ * sorted cache-efficiently by LSD radix sort using a buffer of the same
+ * size. The sort is not stable.
+ */
+template <typename Iterator, typename KeyExtractor>
+static inline
+void radix_sort_key(Iterator begin, Iterator end,
+                    const KeyExtractor& key_extractor,
+                    size_t block_bytes = 256 * 1024) {
+
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    using Key = typename std::decay<
+        decltype(key_extractor(std::declval<const value_type&>()))>::type;
+
+    radix_sort_key_from<Key>(
+        begin, end, key_extractor, /* depth */ 0, block_bytes);
+}
+
+/*!
+ * Radix sort the iterator range [begin,end) by unsigned integral keys
+ * delivered by key_extractor, which are all less than key_bound, e.g. hashes
+ * modulo key_bound. The most significant digits, which are zero in all keys,
+ * are skipped, hence the first MSD pass partitions the items by the highest
+ * digit of the key range. For uniformly distributed keys, these partitions are
+ * contiguous, equal-sized key ranges. The sort is not stable.
+ */
+template <typename Iterator, typename KeyExtractor>
+static inline
+void radix_sort_key_bounded(Iterator begin, Iterator end,
+                            const KeyExtractor& key_extractor,
+                            size_t key_bound,
+                            size_t block_bytes = 256 * 1024) {
+
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    using Key = typename std::decay<
+        decltype(key_extractor(std::declval<const value_type&>()))>::type;
+
+    static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+                  "Bounded radix sort requires unsigned integral keys");
+
+    // number of leading digits which are zero in all keys < key_bound
+    size_t depth = sizeof(Key);
+    for (size_t max_key = key_bound ? key_bound - 1 : 0; max_key != 0;
+         max_key >>= 8) {
+        --depth;
+    }
+
+    radix_sort_key_from<Key>(begin, end, key_extractor, depth, block_bytes);
+}
+
 } // namespace common
 } // namespace thrill
 
@@ -15,9 +15,12 @@
 
 #include <thrill/common/logger.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <functional>
 #include <random>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -322,6 +325,133 @@ private:
     }
 };
 
+/*!
+ * Weighted reservoir sampling without replacement using Algorithm A-ExpJ from
+ * Efraimidis and Spirakis: "Weighted random sampling with a reservoir", IPL
+ * 2006. Each item gets the random key u^(1/w) with u uniform in (0,1) and its
+ * weight w, and the reservoir keeps the size items with the largest keys. The
+ * exponential jumps skip over items whose keys would not enter the reservoir,
+ * such that only O(size * log(n / size)) random numbers are drawn.
+ *
+ * The samples are stored together with their keys. Since the keys of all items
+ * are independent, reservoirs of different streams are merged by keeping the
+ * size largest keys of their union, see MergeKeys().
+ */
+template <typename Type, typename RNG = std::default_random_engine>
+class ReservoirSamplingWeighted
+{
+public:
+    //! pair of random key and item
+    using KeyItem = std::pair<double, Type>;
+
+    //! initialize reservoir sampler
+    ReservoirSamplingWeighted(size_t size, std::vector<KeyItem>& samples,
+                              RNG& rng)
+        : size_(size), samples_(samples), rng_(rng) {
+        samples_.reserve(size_);
+    }
+
+    //! visit item with the given weight, maybe add it to the sample. Items with
+    //! non-positive weight are never sampled.
+    void add(const Type& item, double weight) {
+        ++count_;
+        if (!(weight > 0.0) || size_ == 0) return;
+
+        if (samples_.size() < size_) {
+            // fill reservoir with keys u^(1/w)
+            samples_.emplace_back(
+                std::pow(uniform_open(), 1.0 / weight), item);
+            std::push_heap(samples_.begin(), samples_.end(), KeyGreater());
+            if (samples_.size() == size_)
+                calc_next_jump();
+            return;
+        }
+
+        jump_ -= weight;
+        if (jump_ > 0.0) return;
+
+        // this item replaces the smallest key: its key is uniform in
+        // (T^w, 1)^(1/w), where T is the smallest key in the reservoir.
+        double tw = std::pow(samples_.front().first, weight);
+        double r = tw + (1.0 - tw) * uniform_open();
+
+        std::pop_heap(samples_.begin(), samples_.end(), KeyGreater());
+        samples_.back() = KeyItem(std::pow(r, 1.0 / weight), item);
+        std::push_heap(samples_.begin(), samples_.end(), KeyGreater());
+
+        calc_next_jump();
+    }
+
+    //! size of reservoir
+    size_t size() const { return size_; }
+
+    //! number of items seen
+    size_t count() const { return count_; }
+
+    //! access to samples and their keys, in heap order
+    const std::vector<KeyItem>& samples() const { return samples_; }
+
+    //! smallest key in the reservoir, or zero if it is not full.
+    double threshold() const {
+        return samples_.size() < size_ ? 0.0 : samples_.front().first;
+    }
+
+    //! return the keys of the reservoir sorted in descending order, as
+    //! required by MergeKeys().
+    std::vector<double> sorted_keys() const {
+        std::vector<double> keys;
+        keys.reserve(samples_.size());
+        for (const KeyItem& s : samples_) keys.push_back(s.first);
+        std::sort(keys.begin(), keys.end(), std::greater<double>());
+        return keys;
+    }
+
+    //! merge two descending lists of keys and keep the size largest ones. The
+    //! smallest remaining key is the threshold of the merged reservoir.
+    static std::vector<double> MergeKeys(
+        const std::vector<double>& a, const std::vector<double>& b,
+        size_t size) {
+        size_t na = std::min(size, a.size()), nb = std::min(size, b.size());
+        std::vector<double> out(na + nb);
+        std::merge(a.begin(), a.begin() + na, b.begin(), b.begin() + nb,
+                   out.begin(), std::greater<double>());
+        out.resize(std::min(size, out.size()));
+        return out;
+    }
+
+private:
+    //! size of reservoir
+    size_t size_;
+    //! number of items seen
+    size_t count_ = 0;
+    //! remaining weight to skip until the next item enters the reservoir
+    double jump_ = 0.0;
+    //! reservoir as min-heap on the keys
+    std::vector<KeyItem>& samples_;
+    //! source of randomness
+    RNG& rng_;
+    //! uniform [0.0, 1.0) distribution
+    std::uniform_real_distribution<double> uniform;
+
+    struct KeyGreater {
+        bool operator () (const KeyItem& a, const KeyItem& b) const {
+            return a.first > b.first;
+        }
+    };
+
+    //! uniform random value in (0.0, 1.0)
+    double uniform_open() {
+        double u;
+        do u = uniform(rng_); while (u == 0.0);
+        return u;
+    }
+
+    //! draw the weight to skip: log(u) / log(T_w)
+    void calc_next_jump() {
+        jump_ = std::log(uniform_open()) / std::log(samples_.front().first);
+    }
+};
+
 } // namespace common
 } // namespace thrill
 
@@ -0,0 +1,285 @@
+/*******************************************************************************
+ * thrill/common/sampling_profiler.cpp
+ *
+ * In-process sampling CPU profiler with attribution of samples to DIA nodes.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/sampling_profiler.hpp>
+
+#include <thrill/common/logger.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+#if __linux__ || __APPLE__ || __FreeBSD__
+#define THRILL_HAVE_SAMPLING_PROFILER 1
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+namespace thrill {
+namespace common {
+
+static constexpr bool debug = false;
+
+/******************************************************************************/
+// Thread tag, read by the signal handler
+
+#if defined(__GNUC__) || defined(__clang__)
+#define THRILL_TLS_INITIAL_EXEC __attribute__ ((tls_model("initial-exec")))
+#else
+#define THRILL_TLS_INITIAL_EXEC
+#endif
+
+//! DIA node executed by the thread, set by SamplingProfiler::Scope
+static thread_local size_t s_tag_dia_id THRILL_TLS_INITIAL_EXEC = 0;
+static thread_local const char* s_tag_label THRILL_TLS_INITIAL_EXEC = nullptr;
+
+SamplingProfiler::Scope::Scope(size_t dia_id, const char* label)
+    : prev_dia_id_(s_tag_dia_id), prev_label_(s_tag_label) {
+    s_tag_label = label;
+    s_tag_dia_id = dia_id;
+}
+
+SamplingProfiler::Scope::~Scope() {
+    s_tag_label = prev_label_;
+    s_tag_dia_id = prev_dia_id_;
+}
+
+#if THRILL_HAVE_SAMPLING_PROFILER
+
+/******************************************************************************/
+// Sample slots, filled by the signal handler and drained by the collector
+
+//! maximum number of frames captured per sample
+static constexpr int kMaxFrames = 48;
+
+//! frames of the signal handler and trampoline to skip
+static constexpr int kSkipFrames = 2;
+
+//! number of sample slots, drained every 50ms
+static constexpr size_t kNumSlots = 4096;
+
+struct SampleSlot {
+    //! 0 = empty, 1 = being written, 2 = full
+    std::atomic<int> state;
+    int depth;
+    size_t dia_id;
+    const char* label;
+    void* frames[kMaxFrames];
+};
+
+static SampleSlot* s_slots = nullptr;
+static std::atomic<size_t> s_next_slot { 0 };
+static std::atomic<size_t> s_dropped { 0 };
+static std::atomic<bool> s_active { false };
+static struct sigaction s_prev_action;
+
+static void SigProfHandler(int) {
+    int saved_errno = errno;
+
+    size_t i = s_next_slot.fetch_add(1, std::memory_order_relaxed) % kNumSlots;
+    SampleSlot& slot = s_slots[i];
+
+    int empty = 0;
+    if (!slot.state.compare_exchange_strong(
+            empty, 1, std::memory_order_acquire)) {
+        // slot still full, the collector is behind
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        slot.depth = backtrace(slot.frames, kMaxFrames);
+        slot.dia_id = s_tag_dia_id;
+        slot.label = s_tag_label;
+        slot.state.store(2, std::memory_order_release);
+    }
+
+    errno = saved_errno;
+}
+
+SamplingProfiler::SamplingProfiler(const std::string& path, unsigned frequency)
+    : path_(path) {
+
+    bool expected = false;
+    if (!s_active.compare_exchange_strong(expected, true)) {
+        LOG1 << "SamplingProfiler: another profiler is already running.";
+        return;
+    }
+    running_ = true;
+
+    if (!s_slots) {
+        s_slots = new SampleSlot[kNumSlots];
+        for (size_t i = 0; i < kNumSlots; ++i) s_slots[i].state = 0;
+    }
+
+    // backtrace() loads libgcc on its first call, which must not happen in the
+    // signal handler.
+    void* warmup[4];
+    backtrace(warmup, 4);
+
+    thread_ = std::thread([this]() { Worker(); });
+
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SigProfHandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, &s_prev_action);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / std::max(frequency, 1u);
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+
+    LOG << "SamplingProfiler: started with " << frequency << " Hz";
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    if (!running_) return;
+
+    struct itimerval timer;
+    std::memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    sigaction(SIGPROF, &s_prev_action, nullptr);
+
+    terminate_ = true;
+    thread_.join();
+    Drain();
+
+    if (s_dropped) {
+        LOG1 << "SamplingProfiler: dropped " << s_dropped << " samples.";
+    }
+
+    std::ofstream os(path_);
+    if (!os.good()) {
+        LOG1 << "SamplingProfiler: could not open " << path_;
+    }
+    else {
+        Write(os);
+    }
+
+    s_dropped = 0;
+    s_active = false;
+}
+
+void SamplingProfiler::Drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // scan all slots, since the handler may skip full ones.
+    for (size_t i = 0; i < kNumSlots; ++i) {
+        SampleSlot& slot = s_slots[i];
+        if (slot.state.load(std::memory_order_acquire) != 2) continue;
+
+        std::vector<void*> frames;
+        if (slot.depth > kSkipFrames) {
+            frames.assign(slot.frames + kSkipFrames, slot.frames + slot.depth);
+        }
+        ++stacks_[StackKey(slot.label, slot.dia_id, std::move(frames))];
+        ++num_samples_;
+
+        slot.state.store(0, std::memory_order_release);
+    }
+}
+
+void SamplingProfiler::Worker() {
+    NameThisThread("sampling-profiler");
+    while (!terminate_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Drain();
+    }
+}
+
+//! symbol name of a return address, collapsed stack frames cannot contain ';'
+static std::string SymbolName(void* addr) {
+    Dl_info info;
+    std::string name;
+    if (dladdr(addr, &info) && info.dli_sname) {
+        int status;
+        char* demangled =
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        name = (status == 0 && demangled) ? demangled : info.dli_sname;
+        free(demangled);
+    }
+    else {
+        std::ostringstream oss;
+        oss << addr;
+        name = oss.str();
+    }
+    for (char& c : name) {
+        if (c == ';') c = ':';
+    }
+    return name;
+}
+
+void SamplingProfiler::Write(std::ostream& os) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    WriteStacks(os, stacks_);
+}
+
+void SamplingProfiler::WriteStacks(
+    std::ostream& os, const std::map<StackKey, size_t>& stacks) {
+
+    std::unordered_map<void*, std::string> symbols;
+    // merge stacks which differ only in addresses inside the same functions
+    std::map<std::string, size_t> collapsed;
+
+    for (const auto& s : stacks) {
+        std::ostringstream line;
+        if (std::get<0>(s.first))
+            line << std::get<0>(s.first) << '.' << std::get<1>(s.first);
+        else
+            line << "[no DIA node]";
+
+        const std::vector<void*>& frames = std::get<2>(s.first);
+        // frames are innermost first, collapsed stacks start at the root
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            auto sym = symbols.find(*it);
+            if (sym == symbols.end())
+                sym = symbols.emplace(*it, SymbolName(*it)).first;
+            line << ';' << sym->second;
+        }
+        collapsed[line.str()] += s.second;
+    }
+
+    for (const auto& c : collapsed)
+        os << c.first << ' ' << c.second << '\n';
+}
+
+#else
+
+SamplingProfiler::SamplingProfiler(const std::string& path, unsigned)
+    : path_(path) {
+    LOG1 << "SamplingProfiler: not available on this system.";
+}
+
+SamplingProfiler::~SamplingProfiler() { }
+
+void SamplingProfiler::Write(std::ostream&) { }
+
+void SamplingProfiler::WriteStacks(
+    std::ostream&, const std::map<StackKey, size_t>&) { }
+
+void SamplingProfiler::Drain() { }
+
+void SamplingProfiler::Worker() { }
+
+#endif  // THRILL_HAVE_SAMPLING_PROFILER
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
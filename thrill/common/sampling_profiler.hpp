@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * thrill/common/sampling_profiler.hpp
+ *
+ * In-process sampling CPU profiler with attribution of samples to DIA nodes.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_SAMPLING_PROFILER_HEADER
+#define THRILL_COMMON_SAMPLING_PROFILER_HEADER
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Sampling CPU profiler of the whole process: a SIGPROF timer interrupts the
+ * threads consuming CPU time, and the signal handler captures the stack of the
+ * interrupted thread, tagged with the DIA node which the thread currently
+ * executes, as set by a Scope. A background thread collects the samples, and
+ * on destruction they are written as collapsed stacks, one line per distinct
+ * stack with the node "label.dia_id" as root frame, which flamegraph.pl reads
+ * directly.
+ *
+ * Only one SamplingProfiler can run at a time, since the timer is process-wide.
+ * Enabled by THRILL_CPU_PROFILE.
+ */
+class SamplingProfiler
+{
+public:
+    //! start sampling with the given frequency, the stacks are written to path
+    explicit SamplingProfiler(const std::string& path, unsigned frequency = 99);
+
+    //! non-copyable: delete copy-constructor
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    //! non-copyable: delete assignment operator
+    SamplingProfiler& operator = (const SamplingProfiler&) = delete;
+
+    //! stop sampling and write the collapsed stacks
+    ~SamplingProfiler();
+
+    //! whether the profiler is sampling
+    bool running() const { return running_; }
+
+    //! number of samples collected so far
+    size_t num_samples() const { return num_samples_; }
+
+    //! write the collapsed stacks collected so far
+    void Write(std::ostream& os);
+
+    //! key of a distinct stack: node label, dia_id, and return addresses
+    //! innermost first
+    using StackKey = std::tuple<const char*, size_t, std::vector<void*> >;
+
+    //! write stacks with their weights as collapsed stacks rooted at the node
+    //! "label.dia_id", also used for sampled allocations.
+    static void WriteStacks(std::ostream& os,
+                            const std::map<StackKey, size_t>& stacks);
+
+    /*!
+     * Tags the samples of the calling thread with a DIA node while the Scope
+     * exists. Scopes may be nested, label must be a static string.
+     */
+    class Scope
+    {
+    public:
+        Scope(size_t dia_id, const char* label);
+        ~Scope();
+
+        //! non-copyable: delete copy-constructor
+        Scope(const Scope&) = delete;
+        //! non-copyable: delete assignment operator
+        Scope& operator = (const Scope&) = delete;
+
+    private:
+        //! previous tag of the thread
+        size_t prev_dia_id_;
+        const char* prev_label_;
+    };
+
+private:
+    //! output path
+    std::string path_;
+
+    //! whether this instance owns the timer
+    bool running_ = false;
+
+    //! flag to stop the collector thread
+    std::atomic<bool> terminate_ { false };
+
+    //! collector thread
+    std::thread thread_;
+
+    //! number of samples of each distinct stack
+    std::map<StackKey, size_t> stacks_;
+
+    //! protects stacks_
+    std::mutex mutex_;
+
+    //! number of samples collected
+    std::atomic<size_t> num_samples_ { 0 };
+
+    //! move filled sample slots into stacks_
+    void Drain();
+
+    //! drain periodically until terminated
+    void Worker();
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_SAMPLING_PROFILER_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * thrill/common/sliding_aggregate.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_SLIDING_AGGREGATE_HEADER
+#define THRILL_COMMON_SLIDING_AGGREGATE_HEADER
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Queue of items, which delivers the aggregate of all items it contains
+ * under an associative sum_function in O(1) amortized time per push_back() and
+ * pop_front(). This is the two-stack queue: new items are pushed onto a back
+ * stack, and their running sum is maintained. When the front stack runs empty,
+ * the back stack is flipped onto it while computing the suffix sums, such
+ * that the top of the front stack is the sum of all items in it. The sum
+ * function need not be commutative or invertible, hence this works for sums of
+ * floating point values without drift, minimum, and maximum alike.
+ */
+template <typename Type, typename SumFunction = std::plus<Type> >
+class SlidingAggregate
+{
+public:
+    explicit SlidingAggregate(const SumFunction& sum_function = SumFunction())
+        : sum_function_(sum_function) { }
+
+    //! append an item at the back
+    void push_back(const Type& item) {
+        back_sum_ = back_.empty() ? item : sum_function_(back_sum_, item);
+        back_.push_back(item);
+    }
+
+    //! remove the oldest item
+    void pop_front() {
+        assert(!empty());
+        if (front_.empty())
+            Flip();
+        front_.pop_back();
+    }
+
+    //! sum of all items from the oldest to the newest. Must not be empty.
+    Type sum() const {
+        assert(!empty());
+        if (front_.empty()) return back_sum_;
+        if (back_.empty()) return front_.back();
+        return sum_function_(front_.back(), back_sum_);
+    }
+
+    //! number of items
+    size_t size() const { return front_.size() + back_.size(); }
+
+    //! whether the queue is empty
+    bool empty() const { return front_.empty() && back_.empty(); }
+
+    //! remove all items
+    void clear() {
+        front_.clear();
+        back_.clear();
+    }
+
+private:
+    //! associative sum function
+    SumFunction sum_function_;
+
+    //! suffix sums of the older items, the sum of all of them on top
+    std::vector<Type> front_;
+
+    //! newer items in order of insertion
+    std::vector<Type> back_;
+
+    //! sum of the items in back_
+    Type back_sum_ = Type();
+
+    //! move the items of back_ onto front_ as suffix sums.
+    void Flip() {
+        assert(front_.empty() && !back_.empty());
+        front_.reserve(back_.size());
+
+        Type sum = back_.back();
+        front_.push_back(sum);
+        for (size_t i = back_.size() - 1; i != 0; --i) {
+            sum = sum_function_(back_[i - 1], sum);
+            front_.push_back(sum);
+        }
+        back_.clear();
+    }
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_SLIDING_AGGREGATE_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * thrill/common/spill_disks.cpp
+ *
+ * Selection of the local directories into which evicted Blocks are spilled,
+ * from an explicit list or detected from the mounted NVMe drives.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/spill_disks.hpp>
+
+#include <tlx/string/split.hpp>
+#include <tlx/string/starts_with.hpp>
+#include <tlx/string/trim.hpp>
+
+#if !defined(_MSC_VER)
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace thrill {
+namespace common {
+
+bool ParseSpillDisks(const std::string& str, std::vector<SpillDisk>* disks) {
+    disks->clear();
+
+    if (tlx::trim(str) == "auto") {
+        *disks = DetectSpillDisks();
+        return true;
+    }
+
+    for (const std::string& entry : tlx::split(',', str)) {
+        std::string e = tlx::trim(entry);
+        SpillDisk disk;
+        std::string::size_type colon = e.rfind(':');
+        if (colon != std::string::npos) {
+            disk.dir = e.substr(0, colon);
+            disk.io_impl = e.substr(colon + 1);
+        }
+        else {
+            disk.dir = e;
+        }
+        if (disk.dir.empty()) return false;
+        disks->emplace_back(std::move(disk));
+    }
+    return !disks->empty();
+}
+
+std::vector<SpillDisk> DetectSpillDisks(const std::string& mounts_path) {
+    std::vector<SpillDisk> disks;
+#if !defined(_MSC_VER)
+    std::ifstream in(mounts_path);
+    std::set<std::string> drives;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string device, dir, type, options;
+        if (!(fields >> device >> dir >> type >> options)) continue;
+        if (!tlx::starts_with(device, "/dev/nvme")) continue;
+
+        // only read-write mounts, and only the first one of each drive
+        bool rw = false;
+        for (const std::string& opt : tlx::split(',', options))
+            rw |= (opt == "rw");
+        if (!rw || access(dir.c_str(), W_OK) != 0) continue;
+
+        // partitions /dev/nvme0n1p2 of a drive /dev/nvme0n1 share the drive
+        std::string drive = device.substr(0, device.find('p', 5));
+        if (!drives.insert(drive).second) continue;
+
+        disks.emplace_back(SpillDisk { dir, std::string() });
+    }
+#else
+    (void)mounts_path;
+#endif
+    return disks;
+}
+
+bool IsNonRotationalDisk(const std::string& path) {
+#if !defined(_MSC_VER)
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+
+    // partitions have no queue, which their drive in the parent holds
+    std::string dev = "/sys/dev/block/" + std::to_string(major(st.st_dev))
+                      + ":" + std::to_string(minor(st.st_dev));
+    for (const char* queue : { "/queue/rotational", "/../queue/rotational" }) {
+        std::ifstream in(dev + queue);
+        int rotational;
+        if (in >> rotational) return rotational == 0;
+    }
+#else
+    (void)path;
+#endif
+    return false;
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
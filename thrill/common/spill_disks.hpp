@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * thrill/common/spill_disks.hpp
+ *
+ * Selection of the local directories into which evicted Blocks are spilled,
+ * from an explicit list or detected from the mounted NVMe drives.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_SPILL_DISKS_HEADER
+#define THRILL_COMMON_SPILL_DISKS_HEADER
+
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+//! a directory on a local disk, which gets one spill file
+struct SpillDisk {
+    //! directory of the spill file
+    std::string dir;
+    //! foxxll I/O implementation, e.g. syscall or linuxaio, or empty to choose
+    //! by the kind of device.
+    std::string io_impl;
+};
+
+/*!
+ * Parse a comma separated list "dir[:io_impl],..." of spill directories, or
+ * "auto" to detect them with DetectSpillDisks(). Returns false if an entry is
+ * empty.
+ */
+bool ParseSpillDisks(const std::string& str, std::vector<SpillDisk>* disks);
+
+/*!
+ * Detect one writable mount point of each NVMe drive listed in the mount
+ * table mounts_path, which are mounted read-write.
+ */
+std::vector<SpillDisk> DetectSpillDisks(
+    const std::string& mounts_path = "/proc/mounts");
+
+//! whether the block device containing path is non-rotational, e.g. an SSD,
+//! according to sysfs. Returns false if this is unknown.
+bool IsNonRotationalDisk(const std::string& path);
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_SPILL_DISKS_HEADER
+
+/******************************************************************************/
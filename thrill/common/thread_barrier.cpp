@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * thrill/common/thread_barrier.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/thread_barrier.hpp>
+
+#if __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+namespace thrill {
+namespace common {
+
+//! waits shorter than this are cheaper to spin through than to park for
+static constexpr std::chrono::microseconds park_cost(20);
+
+//! initial spin budget, unless the threads outnumber the cores
+static constexpr size_t initial_spins = 1 << 12;
+
+//! hint to the processor that this is a spin loop
+static inline void CpuRelax() {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+constexpr size_t ThreadBarrierAdaptive::min_spins_;
+constexpr size_t ThreadBarrierAdaptive::max_spins_;
+
+ThreadBarrierAdaptive::ThreadBarrierAdaptive(size_t thread_count)
+    : thread_count_(thread_count) {
+    // oversubscribed threads spin on cores which others need to arrive
+    size_t cores = std::thread::hardware_concurrency();
+    spin_limit_ = (cores != 0 && thread_count > cores)
+                  ? min_spins_ : initial_spins;
+}
+
+void ThreadBarrierAdaptive::WaitStep(uint32_t this_step) {
+    const size_t limit = spin_limit_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < limit; ++i) {
+        if (step_.load(std::memory_order_acquire) != this_step) {
+            // released while spinning: aim at twice the spins needed
+            Adapt(2 * i);
+            return;
+        }
+        CpuRelax();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // register as sleeper, sequentially consistent against the last thread's
+    // increment of step_, then park while the round is not complete.
+    sleeping_.fetch_add(1);
+    while (step_.load() == this_step) {
+#if __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&step_),
+                FUTEX_WAIT_PRIVATE, this_step, nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]() { return step_.load() != this_step; });
+#endif
+    }
+    sleeping_.fetch_sub(1);
+
+    // long waits are not worth spinning for, while short ones were only
+    // slowed down by parking.
+    if (std::chrono::steady_clock::now() - start < park_cost)
+        Adapt(2 * limit);
+    else
+        Adapt(limit / 2);
+}
+
+void ThreadBarrierAdaptive::WakeAll() {
+#if __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&step_),
+            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    { std::unique_lock<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+#endif
+}
+
+void ThreadBarrierAdaptive::Adapt(size_t target) {
+    // exponential moving average, racy updates only lose samples
+    size_t limit = spin_limit_.load(std::memory_order_relaxed);
+    limit = limit - limit / 8 + target / 8;
+    spin_limit_.store(std::min(std::max(limit, min_spins_), max_spins_),
+                      std::memory_order_relaxed);
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
@@ -16,14 +16,114 @@
 #include <tlx/thread_barrier_mutex.hpp>
 #include <tlx/thread_barrier_spin.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
 namespace thrill {
 namespace common {
 
+/*!
+ * Barrier for a fixed number of threads, which spins for a while and then
+ * parks the waiting threads on a futex (a condition variable on other systems)
+ * until the last thread arrives. The last thread runs a lambda before the
+ * others are released, like tlx::ThreadBarrierSpin.
+ *
+ * The spin budget adapts to recent waits: threads released while spinning
+ * move it towards twice the spins they needed, threads which had to park
+ * shrink it, unless the wait was shorter than parking and waking costs. Hence
+ * threads waiting for slow workers do not burn cores needed by others, which
+ * matters when the workers outnumber the cores.
+ */
+class ThreadBarrierAdaptive
+{
+public:
+    //! lambda doing nothing, the default for wait()
+    struct NoOperation {
+        void operator () () const { }
+    };
+
+    //! create a barrier for thread_count threads.
+    explicit ThreadBarrierAdaptive(size_t thread_count);
+
+    //! non-copyable: delete copy-constructor
+    ThreadBarrierAdaptive(const ThreadBarrierAdaptive&) = delete;
+    //! non-copyable: delete assignment operator
+    ThreadBarrierAdaptive& operator = (const ThreadBarrierAdaptive&) = delete;
+
+    /*!
+     * Waits for all threads, the last thread runs lambda before the others are
+     * released.
+     */
+    template <typename Lambda = NoOperation>
+    void wait(Lambda lambda = Lambda()) {
+        uint32_t this_step = step_.load(std::memory_order_acquire);
+
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1
+            == thread_count_) {
+            lambda();
+            waiting_.store(0, std::memory_order_relaxed);
+            // sequentially consistent against the sleepers' registration
+            step_.fetch_add(1);
+            if (sleeping_.load() != 0)
+                WakeAll();
+            return;
+        }
+
+        WaitStep(this_step);
+    }
+
+    //! return the number of completed rounds
+    size_t step() const { return step_.load(std::memory_order_acquire); }
+
+    //! current spin budget in iterations
+    size_t spin_limit() const {
+        return spin_limit_.load(std::memory_order_relaxed);
+    }
+
+    //! smallest and largest spin budget
+    static constexpr size_t min_spins_ = 16;
+    static constexpr size_t max_spins_ = 1 << 16;
+
+private:
+    //! number of threads
+    const size_t thread_count_;
+
+    //! number of threads arrived in the current round
+    std::atomic<size_t> waiting_ { 0 };
+
+    //! round counter, the futex word on which threads park
+    std::atomic<uint32_t> step_ { 0 };
+
+    //! number of parked threads
+    std::atomic<size_t> sleeping_ { 0 };
+
+    //! spin iterations before parking
+    std::atomic<size_t> spin_limit_;
+
+#if !__linux__
+    //! park threads without futexes
+    std::mutex mutex_;
+    std::condition_variable cv_;
+#endif
+
+    //! spin, then park until step_ differs from this_step
+    void WaitStep(uint32_t this_step);
+
+    //! wake all parked threads
+    void WakeAll();
+
+    //! move the spin budget towards target
+    void Adapt(size_t target);
+};
+
 // select thread barrier implementation.
 #if THRILL_HAVE_THREAD_SANITIZER
 using ThreadBarrier = tlx::ThreadBarrierMutex;
 #else
-using ThreadBarrier = tlx::ThreadBarrierSpin;
+using ThreadBarrier = ThreadBarrierAdaptive;
 #endif
 
 } // namespace common
@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * thrill/common/trace_event.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/trace_event.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace thrill {
+namespace common {
+
+static bool TraceEnabledFromEnv() {
+    const char* env = getenv("THRILL_TRACE");
+    return env != nullptr && strcmp(env, "1") == 0;
+}
+
+const bool g_trace_enabled = TraceEnabledFromEnv();
+
+//! next thread number
+static std::atomic<uint32_t> s_trace_next_tid { 0 };
+
+uint32_t TraceThreadId() {
+    static thread_local uint32_t tid = s_trace_next_tid++;
+    return tid;
+}
+
+void TraceEvent(JsonLogger& logger, char ph, const char* cat,
+                const char* name, uint64_t id) {
+    if (!g_trace_enabled) return;
+    logger << "class" << "Trace" << "ph" << std::string(1, ph)
+           << "cat" << cat << "name" << name << "tid" << TraceThreadId()
+           << "id" << id;
+}
+
+} // namespace common
+} // namespace thrill
+
+/******************************************************************************/
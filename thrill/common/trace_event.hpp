@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * thrill/common/trace_event.hpp
+ *
+ * Begin/end events of worker activity in the JSON log for timeline views.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_TRACE_EVENT_HEADER
+#define THRILL_COMMON_TRACE_EVENT_HEADER
+
+#include <thrill/common/json_logger.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * Trace events are JSON log lines with "class":"Trace", which misc/json2trace
+ * converts to the Chrome trace event format for chrome://tracing and Perfetto.
+ * Each line carries the phase "ph" of the Chrome format, a category "cat", a
+ * "name", and the number "tid" of the thread in order of their first event,
+ * which becomes the timeline row. The lines' "ts" and the logger's common
+ * fields like "host_rank" and "dia_id" complete the events.
+ *
+ * The events are off unless THRILL_TRACE=1 is set, then the StageBuilder,
+ * Multiplexer, and BlockPool emit them. When off, an event costs a test of
+ * g_trace_enabled.
+ */
+
+//! whether trace events are logged, set from THRILL_TRACE at startup
+extern const bool g_trace_enabled;
+
+//! number of the calling thread, assigned in order of the first call
+uint32_t TraceThreadId();
+
+//! log a trace event of phase ph without duration, e.g. 'i' for an instant or
+//! 'b' and 'e' for the begin and end of an asynchronous operation with id.
+void TraceEvent(JsonLogger& logger, char ph, const char* cat,
+                const char* name, uint64_t id = 0);
+
+/*!
+ * Logs a complete trace event ("ph":"X") with the duration from construction
+ * to destruction of the object, which thereby brackets the work on one thread.
+ */
+class TraceScope
+{
+public:
+    TraceScope(JsonLogger& logger, const char* cat, const char* name)
+        : logger_(g_trace_enabled ? &logger : nullptr),
+          cat_(cat), name_(name) {
+        if (logger_) start_ = std::chrono::steady_clock::now();
+    }
+
+    //! non-copyable: delete copy-constructor
+    TraceScope(const TraceScope&) = delete;
+    //! non-copyable: delete assignment operator
+    TraceScope& operator = (const TraceScope&) = delete;
+
+    ~TraceScope() {
+        if (!logger_) return;
+        *logger_
+            << "class" << "Trace" << "ph" << "X"
+            << "cat" << cat_ << "name" << name_ << "tid" << TraceThreadId()
+            << "dur" << std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    //! logger if enabled
+    JsonLogger* logger_;
+    //! category and name of the event
+    const char* cat_, * name_;
+    //! start of the scope
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_TRACE_EVENT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * thrill/common/work_stealing_pool.hpp
+ *
+ * Host-global pool of task deques, from which local workers and threads on
+ * borrowed cores steal partition-level tasks of DOps.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_WORK_STEALING_POOL_HEADER
+#define THRILL_COMMON_WORK_STEALING_POOL_HEADER
+
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * The WorkStealingPool holds one deque of tasks per local worker. A DOp splits
+ * its local work into partition-level tasks, e.g. sorting parts of a run,
+ * submits them to the deque of its worker as a TaskGroup, and then calls
+ * Wait(), which runs tasks until all tasks of the group are done.
+ *
+ * Each worker pops its own tasks from the back of its deque, and when that is
+ * empty, steals tasks from the front of the deques of other local workers.
+ * Hence, a worker which finished its own tasks helps stragglers while it waits
+ * for its group, and additional threads started on cores borrowed from the
+ * WorkerShare can join via Wait() on behalf of the submitting worker.
+ *
+ * Tasks must not throw, and a task must not wait for a group other than the
+ * ones it submitted itself.
+ */
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void()>;
+
+    //! A set of tasks submitted together, which can be waited for.
+    class TaskGroup
+    {
+    public:
+        TaskGroup() = default;
+
+        //! non-copyable: delete copy-constructor
+        TaskGroup(const TaskGroup&) = delete;
+        //! non-copyable: delete assignment operator
+        TaskGroup& operator = (const TaskGroup&) = delete;
+
+        ~TaskGroup() {
+            assert(done() && "TaskGroup destroyed with pending tasks");
+        }
+
+        //! whether all submitted tasks have finished
+        bool done() const {
+            return pending_.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        //! number of submitted tasks that have not finished
+        std::atomic<size_t> pending_ { 0 };
+
+        friend class WorkStealingPool;
+    };
+
+    explicit WorkStealingPool(size_t workers_per_host)
+        : queues_(workers_per_host) { }
+
+    //! non-copyable: delete copy-constructor
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    //! non-copyable: delete assignment operator
+    WorkStealingPool& operator = (const WorkStealingPool&) = delete;
+
+    //! number of workers on this host
+    size_t workers_per_host() const { return queues_.size(); }
+
+    //! submit a task of the group to the deque of local_worker_id.
+    void Submit(size_t local_worker_id, TaskGroup& group, Job&& job) {
+        assert(local_worker_id < queues_.size());
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+        Queue& q = queues_[local_worker_id];
+        std::unique_lock<std::mutex> lock(q.mutex);
+        q.tasks.emplace_back(std::move(job), &group);
+    }
+
+    /*!
+     * Run one task: the newest of local_worker_id's deque, or else the oldest
+     * of another worker's deque. Returns false if all deques were empty.
+     */
+    bool RunOne(size_t local_worker_id) {
+        assert(local_worker_id < queues_.size());
+        Task task;
+        if (!PopBack(queues_[local_worker_id], task)) {
+            size_t n = queues_.size();
+            size_t i = 1;
+            for ( ; i < n; ++i) {
+                if (PopFront(queues_[(local_worker_id + i) % n], task))
+                    break;
+            }
+            if (i == n) return false;
+            ++steals_;
+        }
+
+        task.job();
+        task.group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    //! run tasks as local_worker_id until all tasks of the group are done.
+    void Wait(size_t local_worker_id, const TaskGroup& group) {
+        while (!group.done()) {
+            if (!RunOne(local_worker_id))
+                std::this_thread::yield();
+        }
+    }
+
+    //! number of tasks run by other workers than the submitting one
+    size_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    //! a job and its group
+    struct Task {
+        Task() = default;
+        Task(Job&& _job, TaskGroup* _group)
+            : job(std::move(_job)), group(_group) { }
+
+        Job       job;
+        TaskGroup* group = nullptr;
+    };
+
+    //! deque of tasks of a local worker
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    //! deque of each local worker
+    std::vector<Queue> queues_;
+
+    //! number of stolen tasks, for statistics
+    std::atomic<size_t> steals_ { 0 };
+
+    static bool PopBack(Queue& q, Task& task) {
+        std::unique_lock<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    static bool PopFront(Queue& q, Task& task) {
+        std::unique_lock<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_WORK_STEALING_POOL_HEADER
+
+/******************************************************************************/
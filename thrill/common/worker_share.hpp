@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * thrill/common/worker_share.hpp
+ *
+ * Host-global registry of busy local workers, from which busy workers may
+ * borrow the cores of idle workers for shared-memory parallel local work.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_COMMON_WORKER_SHARE_HEADER
+#define THRILL_COMMON_WORKER_SHARE_HEADER
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+namespace thrill {
+namespace common {
+
+/*!
+ * The WorkerShare is a host-global registry of which local workers are busy
+ * with CPU-bound local computation of a DOp, like sorting runs in SortNode.
+ * Workers which are not busy, e.g. because they finished their part early and
+ * wait at the next barrier, lend their cores to the busy workers, which can
+ * then run additional threads on them. Borrowing is fair: each busy worker may
+ * borrow at most its share of the idle cores.
+ *
+ * Cores are identified by local worker ids, which is also how worker threads
+ * are pinned using SetCpuAffinity().
+ */
+class WorkerShare
+{
+public:
+    explicit WorkerShare(size_t workers_per_host)
+        : busy_(workers_per_host, false), lent_(workers_per_host, false) { }
+
+    //! non-copyable: delete copy-constructor
+    WorkerShare(const WorkerShare&) = delete;
+    //! non-copyable: delete assignment operator
+    WorkerShare& operator = (const WorkerShare&) = delete;
+
+    //! number of workers on this host
+    size_t workers_per_host() const { return busy_.size(); }
+
+    //! mark local worker as busy or idle
+    void SetBusy(size_t local_worker_id, bool busy) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        assert(local_worker_id < busy_.size());
+        if (busy_[local_worker_id] == busy) return;
+        busy_[local_worker_id] = busy;
+        if (busy) ++num_busy_;
+        else --num_busy_;
+    }
+
+    //! number of local workers currently marked as busy
+    size_t num_busy() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return num_busy_;
+    }
+
+    /*!
+     * Borrow up to max_cores cores of idle workers. Returns the ids of the
+     * borrowed cores, which may be empty. The cores must be given back using
+     * Return().
+     */
+    std::vector<size_t> Borrow(size_t max_cores) {
+        std::vector<size_t> cores;
+        if (max_cores == 0) return cores;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        size_t idle = 0;
+        for (size_t i = 0; i < busy_.size(); ++i)
+            idle += (!busy_[i] && !lent_[i]);
+
+        if (idle == 0) return cores;
+
+        // fair share of idle cores per busy worker, rounded up
+        size_t busy = num_busy_ != 0 ? num_busy_ : 1;
+        size_t share = std::min(max_cores, (idle + busy - 1) / busy);
+
+        for (size_t i = 0; i < busy_.size() && cores.size() < share; ++i) {
+            if (busy_[i] || lent_[i]) continue;
+            lent_[i] = true;
+            cores.push_back(i);
+        }
+        return cores;
+    }
+
+    //! give back cores borrowed using Borrow().
+    void Return(const std::vector<size_t>& cores) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (const size_t& c : cores) {
+            assert(lent_[c]);
+            lent_[c] = false;
+        }
+    }
+
+    //! RAII class to mark a local worker as busy during its lifetime.
+    class BusyScope
+    {
+    public:
+        BusyScope(WorkerShare& share, size_t local_worker_id)
+            : share_(share), local_worker_id_(local_worker_id) {
+            share_.SetBusy(local_worker_id_, true);
+        }
+
+        //! non-copyable: delete copy-constructor
+        BusyScope(const BusyScope&) = delete;
+        //! non-copyable: delete assignment operator
+        BusyScope& operator = (const BusyScope&) = delete;
+
+        ~BusyScope() {
+            share_.SetBusy(local_worker_id_, false);
+        }
+
+    private:
+        WorkerShare& share_;
+        size_t local_worker_id_;
+    };
+
+private:
+    //! mutex protecting the state
+    mutable std::mutex mutex_;
+
+    //! flag per local worker whether it is busy
+    std::vector<bool> busy_;
+
+    //! flag per local worker whether its core is lent to another worker
+    std::vector<bool> lent_;
+
+    //! number of busy workers
+    size_t num_busy_ = 0;
+};
+
+} // namespace common
+} // namespace thrill
+
+#endif // !THRILL_COMMON_WORKER_SHARE_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * thrill/core/accelerator_pre_reducer.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_ACCELERATOR_PRE_REDUCER_HEADER
+#define THRILL_CORE_ACCELERATOR_PRE_REDUCER_HEADER
+
+#include <thrill/common/accelerator.hpp>
+#include <tlx/vector_free.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+//! whether ReducePair of ValueType with ReduceFunction can be pre-aggregated
+//! on the accelerator: integral keys and numeric values summed with
+//! std::plus.
+template <typename ValueType, typename ReduceFunction>
+struct AcceleratorReducible : public std::false_type { };
+
+template <typename Key, typename Value>
+struct AcceleratorReducible<std::pair<Key, Value>, std::plus<Value> >
+    : public std::integral_constant<
+          bool, common::AcceleratorKeyTraits<Key>::is_supported &&
+          common::AcceleratorSumTraits<Value>::is_supported>{ };
+
+/*!
+ * Collects the pairs inserted into a ReducePair pre phase in batches of keys
+ * and values, which are sorted and summed per key on the accelerator. The
+ * partial sums are then inserted into the pre phase's table, which hence sees
+ * each key only once per batch. If a batch fails on the device, it is passed
+ * on unreduced and the remaining pairs are no longer batched.
+ */
+template <typename ValueType>
+class AcceleratorPreReducer
+{
+public:
+    using Key = typename ValueType::first_type;
+    using Value = typename ValueType::second_type;
+    using KeyTraits = common::AcceleratorKeyTraits<Key>;
+    using SumType = typename common::AcceleratorSumTraits<Value>::type;
+
+    //! maximum number of pairs per batch
+    static constexpr size_t max_batch_items_ = size_t(1) << 24;
+
+    //! enable batching if an accelerator is available, with batches using at
+    //! most limit_memory bytes.
+    void Initialize(size_t limit_memory) {
+        batch_items_ = std::min(
+            max_batch_items_, std::max(
+                common::accelerator_min_items,
+                limit_memory / (sizeof(uint64_t) + sizeof(SumType))));
+        enabled_ = common::AcceleratorAvailable();
+        if (enabled_) {
+            keys_.reserve(batch_items_);
+            values_.reserve(batch_items_);
+        }
+    }
+
+    //! whether pairs are batched
+    bool enabled() const { return enabled_; }
+
+    //! bytes used by the batch
+    size_t memory() const {
+        return enabled_ ? batch_items_ * (sizeof(uint64_t) + sizeof(SumType))
+               : 0;
+    }
+
+    //! add a pair to the batch, returns true if the batch is full
+    bool Put(const ValueType& p) {
+        keys_.push_back(KeyTraits::ToKey(p.first));
+        values_.push_back(static_cast<SumType>(p.second));
+        return keys_.size() >= batch_items_;
+    }
+
+    //! reduce the batch on the device and emit the partial sums
+    template <typename Emit>
+    void Flush(const Emit& emit) {
+        size_t n = keys_.size();
+        if (n == 0) return;
+
+        num_batches_++;
+        num_items_in_ += n;
+
+        if (!common::AcceleratorReduceSum(keys_.data(), values_.data(), &n)) {
+            // pass the pairs on unreduced, the device is of no further use
+            n = keys_.size();
+            enabled_ = false;
+        }
+        num_items_out_ += n;
+
+        for (size_t i = 0; i < n; ++i) {
+            emit(ValueType(KeyTraits::FromKey(keys_[i]),
+                           static_cast<Value>(values_[i])));
+        }
+        keys_.clear();
+        values_.clear();
+        if (!enabled_) {
+            tlx::vector_free(keys_);
+            tlx::vector_free(values_);
+        }
+    }
+
+    //! \name Statistics
+    //! \{
+
+    size_t num_batches() const { return num_batches_; }
+    size_t num_items_in() const { return num_items_in_; }
+    size_t num_items_out() const { return num_items_out_; }
+
+    //! \}
+
+private:
+    //! whether pairs are batched
+    bool enabled_ = false;
+    //! number of pairs per batch
+    size_t batch_items_ = 0;
+    //! keys and values of the batch
+    std::vector<uint64_t> keys_;
+    std::vector<SumType> values_;
+
+    size_t num_batches_ = 0;
+    size_t num_items_in_ = 0;
+    size_t num_items_out_ = 0;
+};
+
+template <typename ValueType>
+constexpr size_t AcceleratorPreReducer<ValueType>::max_batch_items_;
+
+//! stand-in for AcceleratorPreReducer if the reduction cannot be offloaded
+class NoAcceleratorPreReducer
+{
+public:
+    void Initialize(size_t /* limit_memory */) { }
+    bool enabled() const { return false; }
+    size_t memory() const { return 0; }
+    template <typename ValueType>
+    bool Put(const ValueType&) { return false; }
+    template <typename Emit>
+    void Flush(const Emit&) { }
+    size_t num_batches() const { return 0; }
+    size_t num_items_in() const { return 0; }
+    size_t num_items_out() const { return 0; }
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_ACCELERATOR_PRE_REDUCER_HEADER
+
+/******************************************************************************/
@@ -19,6 +19,7 @@
 #include <thrill/data/block_writer.hpp>
 
 #include <tlx/die.hpp>
+#include <tlx/math/clz.hpp>
 
 namespace thrill {
 namespace core {
@@ -194,25 +195,28 @@ public:
     unsigned GetNumberOfOnesUntilNextZero() {
         unsigned no_ones = 0;
 
-        if (pos_ == buffer_bits_) {
-            pos_ = 0;
-            buffer_ = block_reader_.template GetRaw<size_t>();
-        }
-
-        while (buffer_ & msb_set) {
-            buffer_ <<= 1;
-            pos_++;
-            no_ones++;
+        while (true) {
             if (pos_ == buffer_bits_) {
                 pos_ = 0;
                 buffer_ = block_reader_.template GetRaw<size_t>();
             }
-        }
 
-        // skip 0
-        buffer_ <<= 1;
-        pos_++;
-        return no_ones;
+            // count the leading ones of the remaining bits at once
+            size_t remaining = buffer_bits_ - pos_;
+            size_t ones = ~buffer_ == 0 ? buffer_bits_ : tlx::clz(~buffer_);
+
+            if (ones < remaining) {
+                // skip ones and the 0
+                buffer_ <<= ones;
+                buffer_ <<= 1;
+                pos_ += ones + 1;
+                return no_ones + static_cast<unsigned>(ones);
+            }
+
+            // all remaining bits are ones
+            no_ones += static_cast<unsigned>(remaining);
+            pos_ = buffer_bits_;
+        }
     }
 
 protected:
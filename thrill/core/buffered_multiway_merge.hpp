@@ -12,6 +12,7 @@
 #ifndef THRILL_CORE_BUFFERED_MULTIWAY_MERGE_HEADER
 #define THRILL_CORE_BUFFERED_MULTIWAY_MERGE_HEADER
 
+#include <thrill/core/multiway_merge.hpp>
 #include <tlx/container/loser_tree.hpp>
 
 #include <algorithm>
@@ -36,13 +37,14 @@ public:
           num_inputs_(static_cast<unsigned>(readers_end - readers_begin)),
           remaining_inputs_(num_inputs_),
           lt_(static_cast<unsigned>(num_inputs_), comp),
-          current_(num_inputs_) {
+          current_(num_inputs_),
+          inputs_(num_inputs_) {
 
         for (unsigned t = 0; t < num_inputs_; ++t)
         {
-            if (TLX_LIKELY(readers_[t].HasNext())) {
+            if (TLX_LIKELY(
+                    inputs_[t].Next(readers_[t], current_[t].second))) {
                 current_[t].first = true;
-                current_[t].second = readers_[t].template Next<ValueType>();
                 lt_.insert_start(&current_[t].second, t, false);
             }
             else {
@@ -67,9 +69,9 @@ public:
     bool Update() {
         unsigned top = lt_.min_source();
 
-        if (TLX_LIKELY(readers_[top].HasNext())) {
+        if (TLX_LIKELY(
+                inputs_[top].Next(readers_[top], current_[top].second))) {
             current_[top].first = true;
-            current_[top].second = readers_[top].template Next<ValueType>();
             lt_.delete_min_insert(&current_[top].second, false);
             return true;
         }
@@ -90,6 +92,8 @@ private:
     LoserTreeType lt_;
     //! current values in each input (exist flag, value)
     std::vector<std::pair<bool, ValueType> > current_;
+    //! buffered inputs
+    std::vector<detail::MultiwayMergeInput<ValueType, Reader> > inputs_;
 };
 
 /*!
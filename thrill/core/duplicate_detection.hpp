@@ -17,9 +17,11 @@
 
 #include <thrill/api/context.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/radix_sort.hpp>
 #include <thrill/core/delta_stream.hpp>
 #include <thrill/core/golomb_bit_stream.hpp>
 #include <thrill/core/multiway_merge.hpp>
+#include <thrill/core/rice_bit_stream.hpp>
 
 #include <algorithm>
 #include <memory>
@@ -42,28 +44,34 @@ namespace core {
  *
  * Should only be used when a large amount of uniquely-occuring elements are
  * expected.
+ *
+ * The hash deltas are encoded by the Coder given to FindNonDuplicates(): the
+ * GolombCoder with one global parameter, or the RiceCoder, which tunes the
+ * parameter of each stream to its hash range and decodes faster.
  */
 class DuplicateDetection
 {
     static constexpr bool debug = false;
 
 private:
-    using GolombBitStreamWriter =
-        core::GolombBitStreamWriter<data::CatStream::Writer>;
+    template <typename Coder>
+    using CoderWriter = typename Coder::template Writer<data::CatStream::Writer>;
 
-    using GolombBitStreamReader =
-        core::GolombBitStreamReader<data::CatStream::Reader>;
+    template <typename Coder>
+    using CoderReader = typename Coder::template Reader<data::CatStream::Reader>;
 
-    using GolumbDeltaWriter =
-        core::DeltaStreamWriter<GolombBitStreamWriter, size_t, /* offset */ 1>;
+    template <typename Coder>
+    using DeltaWriter =
+        core::DeltaStreamWriter<CoderWriter<Coder>, size_t, /* offset */ 1>;
 
-    using GolumbDeltaReader =
-        core::DeltaStreamReader<GolombBitStreamReader, size_t, /* offset */ 1>;
+    template <typename Coder>
+    using DeltaReader =
+        core::DeltaStreamReader<CoderReader<Coder>, size_t, /* offset */ 1>;
 
     /*!
      * Sends all hashes in the range
      * [max_hash / num_workers * p, max_hash / num_workers * (p + 1)) to worker
-     * p. These hashes are encoded with a Golomb encoder in core.
+     * p. These hashes are encoded with the Coder's encoder in core.
      *
      * \param stream_pointer Pointer to data stream
      * \param hashes Sorted vector of all hashes modulo max_hash
@@ -71,6 +79,7 @@ private:
      * \param num_workers Number of workers in this Thrill process
      * \param max_hash Modulo for all hashes
      */
+    template <typename Coder>
     void WriteEncodedHashes(const data::CatStreamPtr& stream_pointer,
                             const std::vector<size_t>& hashes,
                             size_t golomb_param,
@@ -85,8 +94,14 @@ private:
             common::Range range_i =
                 common::CalculateLocalRange(max_hash, num_workers, i);
 
-            GolombBitStreamWriter golomb_writer(writers[i], golomb_param);
-            GolumbDeltaWriter delta_writer(
+            size_t count =
+                std::lower_bound(hashes.begin() + j, hashes.end(), range_i.end)
+                - (hashes.begin() + j);
+
+            CoderWriter<Coder> golomb_writer(
+                writers[i],
+                Coder::Parameter(golomb_param, range_i.size(), count));
+            DeltaWriter<Coder> delta_writer(
                 golomb_writer,
                 /* initial */ size_t(-1) /* cancels with +1 bias */);
 
@@ -109,6 +124,7 @@ private:
      * \param non_duplicates Target vector for hashes, should be empty beforehand
      * \param golomb_param Golomb parameter
      */
+    template <typename Coder>
     void ReadEncodedHashesToVector(const data::CatStreamPtr& stream_pointer,
                                    std::vector<bool>& non_duplicates,
                                    size_t golomb_param) {
@@ -118,14 +134,14 @@ private:
 
         for (data::CatStream::Reader& reader : readers)
         {
-            GolombBitStreamReader golomb_reader(reader, golomb_param);
-            GolumbDeltaReader delta_reader(
+            CoderReader<Coder> golomb_reader(reader, golomb_param);
+            DeltaReader<Coder> delta_reader(
                 golomb_reader, /* initial */ size_t(-1) /* cancels at +1 */);
 
             // Builds golomb encoded bitset from data received by the stream.
             while (delta_reader.HasNext()) {
                 // Golomb code contains deltas, we want the actual values
-                size_t hash = delta_reader.Next<size_t>();
+                size_t hash = delta_reader.template Next<size_t>();
                 assert(hash < non_duplicates.size());
                 non_duplicates[hash] = true;
             }
@@ -146,7 +162,10 @@ public:
      *
      * \return Modulo used on all hashes. (Use this modulo on all hashes to
      *  identify possible non-duplicates)
+     *
+     * \tparam Coder GolombCoder or RiceCoder for the hash deltas.
      */
+    template <typename Coder = GolombCoder>
     size_t FindNonDuplicates(std::vector<bool>& non_duplicates,
                              std::vector<size_t>& hashes,
                              Context& context,
@@ -167,11 +186,15 @@ public:
             hashes[i] = hashes[i] % max_hash;
         }
 
-        std::sort(hashes.begin(), hashes.end());
+        // radix sort the hashes < max_hash, whose first pass partitions them
+        // into the contiguous hash ranges of the workers.
+        common::radix_sort_key_bounded(
+            hashes.begin(), hashes.end(),
+            [](const size_t& h) { return h; }, max_hash);
 
         data::CatStreamPtr golomb_data_stream = context.GetNewCatStream(dia_id);
 
-        WriteEncodedHashes(golomb_data_stream,
+        WriteEncodedHashes<Coder>(golomb_data_stream,
                            hashes, golomb_param,
                            context.num_workers(),
                            max_hash);
@@ -181,8 +204,8 @@ public:
         std::vector<data::CatStream::Reader> readers =
             golomb_data_stream->GetReaders();
 
-        std::vector<GolombBitStreamReader> g_readers;
-        std::vector<GolumbDeltaReader> delta_readers;
+        std::vector<CoderReader<Coder> > g_readers;
+        std::vector<DeltaReader<Coder> > delta_readers;
         g_readers.reserve(context.num_workers());
         delta_readers.reserve(context.num_workers());
 
@@ -205,13 +228,20 @@ public:
         data::CatStream::Writers duplicates_writers =
             duplicates_stream->GetWriters();
 
-        std::vector<GolombBitStreamWriter> duplicates_gbsw;
-        std::vector<GolumbDeltaWriter> duplicates_dw;
+        std::vector<CoderWriter<Coder> > duplicates_gbsw;
+        std::vector<DeltaWriter<Coder> > duplicates_dw;
         duplicates_gbsw.reserve(context.num_workers());
         duplicates_dw.reserve(context.num_workers());
 
+        // each worker is sent about 1/p of its hashes in our range
+        size_t num_workers = context.num_workers();
+        size_t duplicates_param = Coder::Parameter(
+            golomb_param, max_hash / num_workers,
+            upper_bound_uniques / (num_workers * num_workers));
+
         for (size_t i = 0; i < context.num_workers(); ++i) {
-            duplicates_gbsw.emplace_back(duplicates_writers[i], golomb_param);
+            duplicates_gbsw.emplace_back(
+                duplicates_writers[i], duplicates_param);
             duplicates_dw.emplace_back(
                 duplicates_gbsw.back(),
                 /* initial */ size_t(-1) /* cancels with +1 bias */);
@@ -264,7 +294,7 @@ public:
         // read inbound duplicate hash bits into non_duplicates hash table
         assert(non_duplicates.size() == 0);
         non_duplicates.resize(max_hash);
-        ReadEncodedHashesToVector(
+        ReadEncodedHashesToVector<Coder>(
             duplicates_stream, non_duplicates, golomb_param);
 
         return max_hash;
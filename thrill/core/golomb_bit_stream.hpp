@@ -209,6 +209,28 @@ private:
     bool first_call_ = true;
 };
 
+/******************************************************************************/
+// GolombCoder
+
+/*!
+ * Delta coder selecting GolombBitStreamWriter and GolombBitStreamReader in
+ * DuplicateDetection and LocationDetection. All streams use the same global
+ * Golomb parameter, which the readers must know.
+ */
+struct GolombCoder {
+    template <typename BlockWriter>
+    using Writer = GolombBitStreamWriter<BlockWriter>;
+
+    template <typename BlockReader>
+    using Reader = GolombBitStreamReader<BlockReader>;
+
+    //! parameter of a stream of about count values in a range of size range
+    static size_t Parameter(size_t golomb_param,
+                            size_t /* range */, size_t /* count */) {
+        return golomb_param;
+    }
+};
+
 /******************************************************************************/
 
 } // namespace core
@@ -0,0 +1,115 @@
+/*******************************************************************************
+ * thrill/core/hashed_key.hpp
+ *
+ * A reduce key carrying its precomputed 64-bit hash, which hash tables and
+ * post-phases use instead of hashing the key again.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_HASHED_KEY_HEADER
+#define THRILL_CORE_HASHED_KEY_HEADER
+
+#include <thrill/data/serialization.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <utility>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A key and its 64-bit hash, which is calculated once when the item enters the
+ * pre-phase. The hash is serialized with the key, hence the post-phase on the
+ * receiving worker and all re-reads of spilled partitions take the stored hash
+ * instead of hashing long keys again.
+ */
+template <typename Key>
+struct HashedKey {
+    Key      key;
+    uint64_t hash;
+
+    HashedKey() = default;
+
+    HashedKey(const Key& _key, uint64_t _hash)
+        : key(_key), hash(_hash) { }
+
+    HashedKey(Key&& _key, uint64_t _hash)
+        : key(std::move(_key)), hash(_hash) { }
+
+    bool operator == (const HashedKey& b) const {
+        return hash == b.hash && key == b.key;
+    }
+    bool operator != (const HashedKey& b) const {
+        return !operator == (b);
+    }
+    //! order by key, such that results sort like the plain keys
+    bool operator < (const HashedKey& b) const {
+        return key < b.key;
+    }
+
+    friend std::ostream& operator << (std::ostream& os, const HashedKey& h) {
+        return os << '(' << h.key << '|' << h.hash << ')';
+    }
+};
+
+//! Hash function of HashedKey, which returns the stored hash.
+template <typename Key>
+class HashedKeyHash
+{
+public:
+    uint64_t operator () (const HashedKey<Key>& k) const {
+        return k.hash;
+    }
+};
+
+//! Equality of HashedKey, which compares the stored hashes before the keys,
+//! such that most unequal long keys are rejected by one integer comparison.
+template <typename Key, typename KeyEqualFunction = std::equal_to<Key> >
+class HashedKeyEqual
+{
+public:
+    explicit HashedKeyEqual(
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : key_equal_function_(key_equal_function) { }
+
+    bool operator () (const HashedKey<Key>& a, const HashedKey<Key>& b) const {
+        return a.hash == b.hash && key_equal_function_(a.key, b.key);
+    }
+
+private:
+    KeyEqualFunction key_equal_function_;
+};
+
+} // namespace core
+
+namespace data {
+
+template <typename Archive, typename Key>
+struct Serialization<Archive, core::HashedKey<Key> > {
+    static void Serialize(const core::HashedKey<Key>& x, Archive& ar) {
+        Serialization<Archive, Key>::Serialize(x.key, ar);
+        Serialization<Archive, uint64_t>::Serialize(x.hash, ar);
+    }
+    static core::HashedKey<Key> Deserialize(Archive& ar) {
+        Key key = Serialization<Archive, Key>::Deserialize(ar);
+        uint64_t hash = Serialization<Archive, uint64_t>::Deserialize(ar);
+        return core::HashedKey<Key>(std::move(key), hash);
+    }
+    static constexpr bool   is_fixed_size =
+        Serialization<Archive, Key>::is_fixed_size;
+    static constexpr size_t fixed_size =
+        Serialization<Archive, Key>::fixed_size + sizeof(uint64_t);
+};
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_CORE_HASHED_KEY_HEADER
+
+/******************************************************************************/
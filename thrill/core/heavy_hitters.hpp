@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * thrill/core/heavy_hitters.hpp
+ *
+ * Detection of frequent hashes using a distributed Misra-Gries summary
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_HEAVY_HITTERS_HEADER
+#define THRILL_CORE_HEAVY_HITTERS_HEADER
+
+#include <thrill/common/logger.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * Misra-Gries summary of item hashes, which keeps at most capacity counters.
+ * Every hash occurring more than num_items / (capacity + 1) times is
+ * guaranteed to have a counter, and each counter underestimates the true
+ * frequency by at most num_items / (capacity + 1).
+ *
+ * The local summaries of all workers are combined with an AllReduce using
+ * HeavyHitters::MergeOp, which sums the counters of equal hashes.
+ */
+class HeavyHitters
+{
+    static constexpr bool debug = false;
+
+public:
+    //! pair of hash and (estimated) count
+    using HashCount = std::pair<size_t, size_t>;
+
+    explicit HeavyHitters(size_t capacity = 64)
+        : capacity_(capacity) {
+        counters_.reserve(capacity_ + 1);
+    }
+
+    //! insert a hash into the summary
+    void Insert(size_t hash) {
+        ++num_items_;
+
+        auto it = counters_.find(hash);
+        if (it != counters_.end()) {
+            ++it->second;
+            return;
+        }
+        if (counters_.size() < capacity_) {
+            counters_.emplace(hash, 1);
+            return;
+        }
+        // decrement all counters and drop those reaching zero
+        for (auto jt = counters_.begin(); jt != counters_.end(); ) {
+            if (--jt->second == 0)
+                jt = counters_.erase(jt);
+            else
+                ++jt;
+        }
+    }
+
+    //! number of inserted hashes
+    size_t num_items() const { return num_items_; }
+
+    //! returns the counters sorted by hash, as required by MergeOp
+    std::vector<HashCount> Summary() const {
+        std::vector<HashCount> summary(counters_.begin(), counters_.end());
+        std::sort(summary.begin(), summary.end());
+        return summary;
+    }
+
+    //! clear the summary
+    void Clear() {
+        counters_.clear();
+        num_items_ = 0;
+    }
+
+    //! merge operation for two sorted summaries: sums counters of equal hashes
+    class MergeOp
+    {
+    public:
+        std::vector<HashCount> operator () (
+            const std::vector<HashCount>& a,
+            const std::vector<HashCount>& b) const {
+            std::vector<HashCount> out;
+            out.reserve(a.size() + b.size());
+            auto ia = a.begin(), ib = b.begin();
+            while (ia != a.end() && ib != b.end()) {
+                if (ia->first < ib->first)
+                    out.emplace_back(*ia++);
+                else if (ib->first < ia->first)
+                    out.emplace_back(*ib++);
+                else {
+                    out.emplace_back(ia->first, ia->second + ib->second);
+                    ++ia, ++ib;
+                }
+            }
+            out.insert(out.end(), ia, a.end());
+            out.insert(out.end(), ib, b.end());
+            return out;
+        }
+    };
+
+private:
+    //! maximum number of counters
+    size_t capacity_;
+
+    //! counter for each candidate hash
+    std::unordered_map<size_t, size_t> counters_;
+
+    //! number of inserted hashes
+    size_t num_items_ = 0;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_HEAVY_HITTERS_HEADER
+
+/******************************************************************************/
@@ -11,15 +11,21 @@
 
 #include <thrill/core/hyperloglog.hpp>
 
+#include <thrill/common/config.hpp>
 #include <thrill/common/functional.hpp>
 #include <thrill/common/item_serialization_tools.hpp>
 #include <thrill/data/serialization.hpp>
-#include <thrill/net/buffer_builder.hpp>
-#include <thrill/net/buffer_reader.hpp>
 
+#include <algorithm>
 #include <climits>
 #include <limits>
 
+#if defined(THRILL_HAVE_AVX2)
+#include <immintrin.h>
+#elif defined(THRILL_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
 namespace thrill {
 namespace core {
 namespace hyperloglog {
@@ -1757,13 +1763,71 @@ void HyperLogLogRegisters<p>::mergeSparse() {
     sparseListBuffer_ = hyperloglog::encodeSparseList(vec);
 }
 
+template <size_t p>
+void HyperLogLogRegisters<p>::mergeSparse(const HyperLogLogRegisters<p>& b) {
+    assert(format_ == HyperLogLogRegisterFormat::SPARSE);
+    assert(b.format_ == HyperLogLogRegisterFormat::SPARSE);
+
+    // the sparse lists are sorted already, only the small unsorted delta sets
+    // need to be sorted before merging all linearly.
+    std::vector<HyperLogLogSparseRegister> deltas = deltaSet_;
+    deltas.insert(deltas.end(), b.deltaSet_.begin(), b.deltaSet_.end());
+    std::sort(deltas.begin(), deltas.end());
+
+    hyperloglog::DecodedSparseList sparseList(sparseListBuffer_);
+    hyperloglog::DecodedSparseList sparseList2(b.sparseListBuffer_);
+
+    std::vector<HyperLogLogSparseRegister> lists;
+    lists.reserve(sparse_size_ + b.sparse_size_);
+    std::merge(sparseList.begin(), sparseList.end(),
+               sparseList2.begin(), sparseList2.end(),
+               std::back_inserter(lists));
+
+    std::vector<HyperLogLogSparseRegister> resultVec;
+    resultVec.reserve(lists.size() + deltas.size());
+    std::merge(lists.begin(), lists.end(), deltas.begin(), deltas.end(),
+               std::back_inserter(resultVec));
+
+    deltaSet_.clear();
+    deltaSet_.shrink_to_fit();
+    std::vector<HyperLogLogSparseRegister> vec =
+        hyperloglog::mergeSameIndices<25>(resultVec);
+    sparse_size_ = vec.size();
+    sparseListBuffer_ = hyperloglog::encodeSparseList(vec);
+}
+
 template <size_t p>
 void HyperLogLogRegisters<p>::mergeDense(const HyperLogLogRegisters<p>& b) {
     assert(format_ == HyperLogLogRegisterFormat::DENSE);
     const size_t m = 1 << p;
     assert(m == size() && m == b.size());
-    for (size_t i = 0; i < m; ++i) {
-        entries_[i] = std::max(entries_[i], b.entries_[i]);
+
+    uint8_t* a_entries = entries_.data();
+    const uint8_t* b_entries = b.entries_.data();
+    size_t i = 0;
+
+#if defined(THRILL_HAVE_AVX2)
+    for ( ; i + 32 <= m; i += 32) {
+        __m256i va = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(a_entries + i));
+        __m256i vb = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(b_entries + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a_entries + i),
+                            _mm256_max_epu8(va, vb));
+    }
+#elif defined(THRILL_HAVE_SSE2)
+    for ( ; i + 16 <= m; i += 16) {
+        __m128i va = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(a_entries + i));
+        __m128i vb = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(b_entries + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a_entries + i),
+                         _mm_max_epu8(va, vb));
+    }
+#endif
+
+    for ( ; i < m; ++i) {
+        a_entries[i] = std::max(a_entries[i], b_entries[i]);
     }
 }
 
@@ -1820,13 +1884,7 @@ HyperLogLogRegisters<p>::operator + (const HyperLogLogRegisters<p>& regs2) const
         regs2.format_ == HyperLogLogRegisterFormat::SPARSE) {
 
         HyperLogLogRegisters<p> result = *this;
-
-        hyperloglog::DecodedSparseList sparseList2(regs2.sparseListBuffer_);
-        std::copy(sparseList2.begin(), sparseList2.end(),
-                  std::back_inserter(result.deltaSet_));
-        std::copy(regs2.deltaSet_.begin(), regs2.deltaSet_.end(),
-                  std::back_inserter(result.deltaSet_));
-        result.mergeSparse();
+        result.mergeSparse(regs2);
         if (result.shouldConvertToDense()) {
             result.toDense();
         }
@@ -1877,86 +1935,6 @@ template class HyperLogLogRegisters<17>;
 template class HyperLogLogRegisters<18>;
 
 } // namespace core
-
-/*----------------------------------------------------------------------------*/
-
-namespace data {
-
-using core::HyperLogLogRegisterFormat;
-
-template <typename Archive, size_t p>
-void Serialization<Archive, core::HyperLogLogRegisters<p> >::
-Serialize(const core::HyperLogLogRegisters<p>& x, Archive& ar) {
-    Serialization<Archive, HyperLogLogRegisterFormat>::Serialize(x.format_, ar);
-    switch (x.format_) {
-    case HyperLogLogRegisterFormat::SPARSE:
-        Serialization<Archive, decltype(x.sparseListBuffer_)>::Serialize(
-            x.sparseListBuffer_, ar);
-        Serialization<Archive, decltype(x.deltaSet_)>::Serialize(x.deltaSet_, ar);
-        break;
-    case HyperLogLogRegisterFormat::DENSE:
-        for (auto it = x.entries_.begin(); it != x.entries_.end(); ++it) {
-            Serialization<Archive, uint64_t>::Serialize(*it, ar);
-        }
-        break;
-    }
-}
-
-template <typename Archive, size_t p>
-core::HyperLogLogRegisters<p>
-Serialization<Archive, core::HyperLogLogRegisters<p> >::Deserialize(Archive& ar) {
-    core::HyperLogLogRegisters<p> out;
-    out.format_ =
-        std::move(Serialization<Archive, HyperLogLogRegisterFormat>::Deserialize(ar));
-    switch (out.format_) {
-    case HyperLogLogRegisterFormat::SPARSE:
-        out.sparseListBuffer_ = std::move(
-            Serialization<Archive, decltype(out.sparseListBuffer_)>::Deserialize(ar));
-        out.deltaSet_ = std::move(
-            Serialization<Archive, decltype(out.deltaSet_)>::Deserialize(ar));
-        break;
-    case HyperLogLogRegisterFormat::DENSE:
-        out.entries_.resize(1 << p);
-        for (size_t i = 0; i != out.size(); ++i) {
-            out.entries_[i] = std::move(
-                Serialization<Archive, uint64_t>::Deserialize(ar));
-        }
-        break;
-    }
-    return out;
-}
-
-#ifndef THRILL_DOXYGEN_IGNORE
-
-// make serialization instantiations
-#define MAKE_INSTANTIATIONS(X)                                              \
-    template void Serialization<                                            \
-        net::BufferBuilder, core::HyperLogLogRegisters<X> >                 \
-    ::Serialize(const core::HyperLogLogRegisters<X>&, net::BufferBuilder&); \
-                                                                            \
-    template core::HyperLogLogRegisters<X>                                  \
-    Serialization<net::BufferReader, core::HyperLogLogRegisters<X> >        \
-    ::Deserialize(net::BufferReader&);
-
-MAKE_INSTANTIATIONS(4)
-MAKE_INSTANTIATIONS(5)
-MAKE_INSTANTIATIONS(6)
-MAKE_INSTANTIATIONS(7)
-MAKE_INSTANTIATIONS(8)
-MAKE_INSTANTIATIONS(9)
-MAKE_INSTANTIATIONS(10)
-MAKE_INSTANTIATIONS(11)
-MAKE_INSTANTIATIONS(12)
-MAKE_INSTANTIATIONS(13)
-MAKE_INSTANTIATIONS(14)
-MAKE_INSTANTIATIONS(15)
-MAKE_INSTANTIATIONS(16)
-MAKE_INSTANTIATIONS(17)
-MAKE_INSTANTIATIONS(18)
-
-#endif  // THRILL_DOXYGEN_IGNORE
-
-} // namespace data
 } // namespace thrill
 
 /******************************************************************************/
@@ -13,7 +13,7 @@
 #ifndef THRILL_CORE_HYPERLOGLOG_HEADER
 #define THRILL_CORE_HYPERLOGLOG_HEADER
 
-#include <thrill/data/serialization_fwd.hpp>
+#include <thrill/data/serialization.hpp>
 #include <tlx/die.hpp>
 #include <tlx/math/clz.hpp>
 #include <tlx/siphash.hpp>
@@ -52,6 +52,12 @@ public:
     void insert_hash(const uint64_t& hash_value);
     void mergeSparse();
 
+    //! merge the sparse registers b into these sparse registers by linearly
+    //! merging the sorted sparse lists.
+    void mergeSparse(const HyperLogLogRegisters<p>& b);
+
+    //! merge the dense registers b into these dense registers, vectorized with
+    //! SSE2 or AVX2 if available.
     void mergeDense(const HyperLogLogRegisters<p>& b);
 
     //! calculate count estimation result adjusted for bias
@@ -100,8 +106,47 @@ namespace data {
 template <typename Archive, size_t p>
 struct Serialization<Archive, core::HyperLogLogRegisters<p> > {
 
-    static void Serialize(const core::HyperLogLogRegisters<p>& x, Archive& ar);
-    static core::HyperLogLogRegisters<p> Deserialize(Archive& ar);
+    using Format = core::HyperLogLogRegisterFormat;
+
+    static void Serialize(const core::HyperLogLogRegisters<p>& x, Archive& ar) {
+        Serialization<Archive, Format>::Serialize(x.format_, ar);
+        switch (x.format_) {
+        case Format::SPARSE:
+            Serialization<Archive, decltype(x.sparseListBuffer_)>::Serialize(
+                x.sparseListBuffer_, ar);
+            Serialization<Archive, decltype(x.deltaSet_)>::Serialize(
+                x.deltaSet_, ar);
+            break;
+        case Format::DENSE:
+            for (auto it = x.entries_.begin(); it != x.entries_.end(); ++it) {
+                Serialization<Archive, uint64_t>::Serialize(*it, ar);
+            }
+            break;
+        }
+    }
+
+    static core::HyperLogLogRegisters<p> Deserialize(Archive& ar) {
+        core::HyperLogLogRegisters<p> out;
+        out.format_ = Serialization<Archive, Format>::Deserialize(ar);
+        switch (out.format_) {
+        case Format::SPARSE:
+            out.sparseListBuffer_ =
+                Serialization<Archive, decltype(out.sparseListBuffer_)>::
+                Deserialize(ar);
+            out.deltaSet_ =
+                Serialization<Archive, decltype(out.deltaSet_)>::
+                Deserialize(ar);
+            break;
+        case Format::DENSE:
+            out.entries_.resize(1 << p);
+            for (size_t i = 0; i != out.size(); ++i) {
+                out.entries_[i] = static_cast<uint8_t>(
+                    Serialization<Archive, uint64_t>::Deserialize(ar));
+            }
+            break;
+        }
+        return out;
+    }
 
     static constexpr bool   is_fixed_size = false;
     static constexpr size_t fixed_size = 0;
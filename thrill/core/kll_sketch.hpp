@@ -0,0 +1,266 @@
+/*******************************************************************************
+ * thrill/core/kll_sketch.hpp
+ *
+ * Mergeable KLL sketch for approximate quantiles and ranks
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_KLL_SKETCH_HEADER
+#define THRILL_CORE_KLL_SKETCH_HEADER
+
+#include <thrill/common/logger.hpp>
+#include <thrill/data/serialization.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * KLL sketch (Karnin, Lang, Liberty) of a stream of items for approximate
+ * quantile and rank queries. The sketch keeps a hierarchy of compactors: items
+ * on level h stand for 2^h original items. If a level exceeds its capacity, it
+ * is sorted and every second item is promoted to the next level. The capacity
+ * of the top level is k, and it decreases by a factor of 2/3 on each level
+ * below, such that the sketch stores O(k) items and ranks have an error of
+ * about n / k.
+ *
+ * Sketches of different workers are combined with operator +, which
+ * concatenates the levels and compacts them again. The coin choosing which half
+ * of a level is promoted is derived from the number of items and the level,
+ * hence merging the same sketches results in the same multisets of items on all
+ * workers, as required by an AllReduce.
+ */
+template <typename ValueType, typename CompareFunction = std::less<ValueType> >
+class KllSketch
+{
+    static constexpr bool debug = false;
+
+public:
+    //! create an empty sketch with top level capacity k
+    explicit KllSketch(size_t k = 200,
+                       const CompareFunction& compare = CompareFunction())
+        : k_(std::max(k, size_t(8))), compare_(compare) {
+        Grow();
+    }
+
+    //! insert an item into the sketch
+    void insert(const ValueType& value) {
+        levels_[0].push_back(value);
+        ++num_items_;
+        if (++size_ >= max_size_)
+            Compress();
+    }
+
+    //! merge the sketch b into this one
+    KllSketch& operator += (const KllSketch& b) {
+        while (levels_.size() < b.levels_.size())
+            Grow();
+        for (size_t h = 0; h < b.levels_.size(); ++h) {
+            levels_[h].insert(
+                levels_[h].end(), b.levels_[h].begin(), b.levels_[h].end());
+        }
+        num_items_ += b.num_items_;
+        size_ += b.size_;
+        while (size_ >= max_size_)
+            Compress();
+        return *this;
+    }
+
+    //! return merge of this sketch and b
+    KllSketch operator + (const KllSketch& b) const {
+        KllSketch result = *this;
+        result += b;
+        return result;
+    }
+
+    //! number of items inserted into all merged sketches
+    size_t num_items() const { return num_items_; }
+
+    //! number of items stored in the sketch
+    size_t size() const { return size_; }
+
+    //! top level capacity
+    size_t k() const { return k_; }
+
+    //! whether no item was inserted
+    bool empty() const { return num_items_ == 0; }
+
+    //! approximate number of items less than value
+    size_t Rank(const ValueType& value) const {
+        size_t rank = 0;
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            for (const ValueType& v : levels_[h]) {
+                if (compare_(v, value)) rank += size_t(1) << h;
+            }
+        }
+        return rank;
+    }
+
+    //! approximate phi-quantile, with phi in [0,1]. The sketch must not be
+    //! empty.
+    ValueType Quantile(double phi) const {
+        return Quantiles(std::vector<double>({ phi }))[0];
+    }
+
+    //! approximate phi-quantiles for each entry of phis. The sketch must not be
+    //! empty.
+    std::vector<ValueType> Quantiles(const std::vector<double>& phis) const {
+        assert(!empty());
+
+        // sort all stored items together with their weights
+        std::vector<std::pair<ValueType, size_t> > items;
+        items.reserve(size_);
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            for (const ValueType& v : levels_[h])
+                items.emplace_back(v, size_t(1) << h);
+        }
+        std::sort(items.begin(), items.end(),
+                  [this](const std::pair<ValueType, size_t>& a,
+                         const std::pair<ValueType, size_t>& b) {
+                      return compare_(a.first, b.first);
+                  });
+
+        size_t total = 0;
+        for (const auto& i : items) total += i.second;
+
+        std::vector<ValueType> out;
+        out.reserve(phis.size());
+        for (const double& phi : phis) {
+            double target = std::min(std::max(phi, 0.0), 1.0)
+                            * static_cast<double>(total);
+            size_t cum = 0;
+            auto it = items.begin();
+            for ( ; it + 1 != items.end(); ++it) {
+                cum += it->second;
+                if (static_cast<double>(cum) > target) break;
+            }
+            out.emplace_back(it->first);
+        }
+        return out;
+    }
+
+    //! \name Serialization via Class Methods
+    //! \{
+
+    static constexpr bool thrill_is_fixed_size = false;
+    static constexpr size_t thrill_fixed_size = 0;
+
+    template <typename Archive>
+    void ThrillSerialize(Archive& ar) const {
+        ar.PutVarint(k_);
+        ar.PutVarint(num_items_);
+        data::Serialization<Archive, std::vector<std::vector<ValueType> > >
+        ::Serialize(levels_, ar);
+    }
+
+    template <typename Archive>
+    static KllSketch ThrillDeserialize(Archive& ar) {
+        KllSketch s(ar.GetVarint());
+        s.num_items_ = ar.GetVarint();
+        s.levels_ =
+            data::Serialization<Archive, std::vector<std::vector<ValueType> > >
+            ::Deserialize(ar);
+        s.size_ = 0;
+        for (const std::vector<ValueType>& l : s.levels_)
+            s.size_ += l.size();
+        s.UpdateMaxSize();
+        return s;
+    }
+
+    //! \}
+
+private:
+    //! top level capacity
+    size_t k_;
+
+    //! item comparison function
+    CompareFunction compare_;
+
+    //! items of each level, level h items have weight 2^h
+    std::vector<std::vector<ValueType> > levels_;
+
+    //! number of items inserted into all merged sketches
+    size_t num_items_ = 0;
+
+    //! number of items stored on all levels
+    size_t size_ = 0;
+
+    //! sum of level capacities, compress if size_ reaches it
+    size_t max_size_ = 0;
+
+    //! capacity of level h
+    size_t capacity(size_t h) const {
+        size_t depth = levels_.size() - h - 1;
+        return std::max(
+            size_t(2), static_cast<size_t>(std::ceil(
+                                               static_cast<double>(k_)
+                                               * std::pow(2.0 / 3.0, depth))));
+    }
+
+    void UpdateMaxSize() {
+        max_size_ = 0;
+        for (size_t h = 0; h < levels_.size(); ++h)
+            max_size_ += capacity(h);
+    }
+
+    //! add a new top level
+    void Grow() {
+        levels_.emplace_back();
+        UpdateMaxSize();
+    }
+
+    //! deterministic coin for compacting level h
+    bool Coin(size_t h) const {
+        uint64_t x = num_items_ + (static_cast<uint64_t>(h) << 56);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return ((x ^ (x >> 31)) & 1) != 0;
+    }
+
+    //! compact the lowest level exceeding its capacity
+    void Compress() {
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            if (levels_[h].size() < capacity(h)) continue;
+
+            if (h + 1 == levels_.size())
+                Grow();
+
+            std::vector<ValueType>& level = levels_[h];
+            std::sort(level.begin(), level.end(), compare_);
+
+            // keep the largest item of odd-sized levels, promote every second
+            // one of the others.
+            size_t n = level.size() & ~size_t(1);
+            std::vector<ValueType>& up = levels_[h + 1];
+            for (size_t i = Coin(h) ? 1 : 0; i < n; i += 2)
+                up.emplace_back(std::move(level[i]));
+
+            if (level.size() != n)
+                level[0] = std::move(level[n]);
+            level.resize(level.size() - n);
+
+            size_ -= n / 2;
+
+            sLOG << "KllSketch: compacted level" << h << "size" << size_;
+            return;
+        }
+    }
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_KLL_SKETCH_HEADER
+
+/******************************************************************************/
@@ -17,6 +17,7 @@
 
 #include <thrill/common/function_traits.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/radix_sort.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/core/delta_stream.hpp>
 #include <thrill/core/golomb_bit_stream.hpp>
@@ -25,7 +26,10 @@
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_robin_hood_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 #include <thrill/core/reduce_table.hpp>
+#include <thrill/core/rice_bit_stream.hpp>
 #include <thrill/data/cat_stream.hpp>
 
 #include <tlx/math/integer_log2.hpp>
@@ -66,31 +70,37 @@ private:
     size_t modulo_ = 1;
 };
 
-template <typename HashCount>
+/*!
+ * Detection of the worker holding most items of each key, via a distributed
+ * bloom filter of delta-encoded hashes. The hash deltas are encoded by the
+ * Coder: the GolombCoder with one global parameter, or the RiceCoder, which
+ * tunes the parameter of each stream to its hash range and decodes faster.
+ */
+template <typename HashCount, typename Coder = GolombCoder>
 class LocationDetection
 {
 private:
     static constexpr bool debug = false;
 
-    using GolombBitStreamWriter =
-        core::GolombBitStreamWriter<data::CatStream::Writer>;
+    using CoderWriter =
+        typename Coder::template Writer<data::CatStream::Writer>;
 
-    using GolombBitStreamReader =
-        core::GolombBitStreamReader<data::CatStream::Reader>;
+    using CoderReader =
+        typename Coder::template Reader<data::CatStream::Reader>;
 
-    using GolumbDeltaWriter =
-        core::DeltaStreamWriter<GolombBitStreamWriter, size_t, /* offset */ 1>;
+    using DeltaWriter =
+        core::DeltaStreamWriter<CoderWriter, size_t, /* offset */ 1>;
 
-    using GolumbDeltaReader =
-        core::DeltaStreamReader<GolombBitStreamReader, size_t, /* offset */ 1>;
+    using DeltaReader =
+        core::DeltaStreamReader<CoderReader, size_t, /* offset */ 1>;
 
     using CounterType = typename HashCount::CounterType;
 
     class GolombPairReader
     {
     public:
-        GolombPairReader(GolombBitStreamReader& bit_reader,
-                         GolumbDeltaReader& delta_reader)
+        GolombPairReader(CoderReader& bit_reader,
+                         DeltaReader& delta_reader)
             : bit_reader_(bit_reader), delta_reader_(delta_reader) { }
 
         bool HasNext() {
@@ -100,14 +110,14 @@ private:
         template <typename Type>
         HashCount Next() {
             HashCount hc;
-            hc.hash = delta_reader_.Next<size_t>();
+            hc.hash = delta_reader_.template Next<size_t>();
             hc.ReadBits(bit_reader_);
             return hc;
         }
 
     private:
-        GolombBitStreamReader& bit_reader_;
-        GolumbDeltaReader& delta_reader_;
+        CoderReader& bit_reader_;
+        DeltaReader& delta_reader_;
     };
 
     struct ExtractHash {
@@ -127,8 +137,17 @@ private:
             common::Range range_i =
                 common::CalculateLocalRange(max_hash, num_workers, i);
 
-            GolombBitStreamWriter golomb_writer(writers[i], golomb_param);
-            GolumbDeltaWriter delta_writer(
+            size_t count =
+                std::lower_bound(hash_occ.begin() + j, hash_occ.end(),
+                                 range_i.end,
+                                 [](const HashCount& hc, size_t h) {
+                                     return hc.hash < h;
+                                 }) - (hash_occ.begin() + j);
+
+            CoderWriter golomb_writer(
+                writers[i],
+                Coder::Parameter(golomb_param, range_i.size(), count));
+            DeltaWriter delta_writer(
                 golomb_writer,
                 /* initial */ size_t(-1) /* cancels with +1 bias */);
 
@@ -216,7 +235,11 @@ public:
             }
         }
 
-        std::sort(hash_occ_.begin(), hash_occ_.end());
+        // radix sort the hashes < max_hash, whose first pass partitions them
+        // into the contiguous hash ranges of the workers.
+        common::radix_sort_key_bounded(
+            hash_occ_.begin(), hash_occ_.end(),
+            [](const HashCount& hc) { return hc.hash; }, max_hash);
 
         data::CatStreamPtr golomb_data_stream =
             context_.GetNewCatStream(dia_id_);
@@ -233,8 +256,8 @@ public:
         std::vector<data::CatStream::Reader> hash_readers =
             golomb_data_stream->GetReaders();
 
-        std::vector<GolombBitStreamReader> golomb_readers;
-        std::vector<GolumbDeltaReader> delta_readers;
+        std::vector<CoderReader> golomb_readers;
+        std::vector<DeltaReader> delta_readers;
         std::vector<GolombPairReader> pair_readers;
 
         golomb_readers.reserve(context_.num_workers());
@@ -265,13 +288,19 @@ public:
         data::CatStream::Writers location_writers =
             location_stream->GetWriters();
 
-        std::vector<GolombBitStreamWriter> location_gbsw;
-        std::vector<GolumbDeltaWriter> location_dw;
+        std::vector<CoderWriter> location_gbsw;
+        std::vector<DeltaWriter> location_dw;
         location_gbsw.reserve(context_.num_workers());
         location_dw.reserve(context_.num_workers());
 
+        // each worker is sent about 1/p of its hashes in our range
+        size_t num_workers = context_.num_workers();
+        size_t location_param = Coder::Parameter(
+            golomb_param, max_hash / num_workers,
+            upper_bound_uniques / (num_workers * num_workers));
+
         for (size_t i = 0; i < context_.num_workers(); ++i) {
-            location_gbsw.emplace_back(location_writers[i], golomb_param);
+            location_gbsw.emplace_back(location_writers[i], location_param);
             location_dw.emplace_back(
                 location_gbsw.back(),
                 /* initial */ size_t(-1) /* cancels with +1 bias */);
@@ -338,14 +367,14 @@ public:
 
         for (data::CatStream::Reader& reader : location_readers)
         {
-            GolombBitStreamReader golomb_reader(reader, golomb_param);
-            GolumbDeltaReader delta_reader(
+            CoderReader golomb_reader(reader, golomb_param);
+            DeltaReader delta_reader(
                 golomb_reader, /* initial */ size_t(-1) /* cancels at +1 */);
 
             // Builds golomb encoded bitset from data received by the stream.
             while (delta_reader.HasNext()) {
                 // Golomb code contains deltas, we want the actual values
-                size_t hash = delta_reader.Next<size_t>();
+                size_t hash = delta_reader.template Next<size_t>();
                 size_t worker = golomb_reader.GetBits(worker_bitsize);
 
                 LOG << "Hash " << hash << " on worker " << worker;
@@ -12,9 +12,13 @@
 #ifndef THRILL_CORE_MULTIWAY_MERGE_HEADER
 #define THRILL_CORE_MULTIWAY_MERGE_HEADER
 
+#include <thrill/data/lazy_item.hpp>
+#include <thrill/data/serialization.hpp>
 #include <tlx/container/loser_tree.hpp>
+#include <tlx/define.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <utility>
 #include <vector>
@@ -22,6 +26,68 @@
 namespace thrill {
 namespace core {
 
+namespace detail {
+
+//! read up to n items with the reader's NextBatch(), if it has one.
+template <typename ValueType, typename Reader>
+auto MergeReadBatch(Reader& reader, ValueType* out, size_t n, int)
+->decltype(reader.template NextBatch<ValueType>(out, n)) {
+    return reader.template NextBatch<ValueType>(out, n);
+}
+
+//! read up to n items one by one from readers without NextBatch().
+template <typename ValueType, typename Reader>
+size_t MergeReadBatch(Reader& reader, ValueType* out, size_t n, long) {
+    size_t done = 0;
+    while (done < n && reader.HasNext())
+        out[done++] = reader.template Next<ValueType>();
+    return done;
+}
+
+/*!
+ * Input leaf of the multiway merge trees, which refills a small buffer of items
+ * of raw serializable type in batches from its reader, such that runs of items
+ * in a Block are copied at once instead of deserialized one by one. Other
+ * items are read directly from the reader.
+ */
+template <typename ValueType, typename Reader>
+class MultiwayMergeInput
+{
+public:
+    //! number of items read at once
+    static constexpr size_t kBatchItems =
+        data::IsRawSerializable<ValueType>::value
+        ? std::max<size_t>(4096 / sizeof(ValueType), 1) : 1;
+
+    MultiwayMergeInput() {
+        if (kBatchItems > 1) buffer_.resize(kBatchItems);
+    }
+
+    //! move the next item of reader into out, or return false if exhausted.
+    bool Next(Reader& reader, ValueType& out) {
+        if (kBatchItems == 1) {
+            if (!reader.HasNext()) return false;
+            out = reader.template Next<ValueType>();
+            return true;
+        }
+        if (TLX_UNLIKELY(pos_ == end_)) {
+            pos_ = 0;
+            end_ = MergeReadBatch<ValueType>(
+                reader, buffer_.data(), kBatchItems, 0);
+            if (end_ == 0) return false;
+        }
+        out = std::move(buffer_[pos_++]);
+        return true;
+    }
+
+private:
+    //! buffered items [pos_,end_)
+    std::vector<ValueType> buffer_;
+    size_t pos_ = 0, end_ = 0;
+};
+
+} // namespace detail
+
 template <
     typename ValueType,
     typename ReaderIterator,
@@ -40,13 +106,14 @@ public:
           num_inputs_(static_cast<unsigned>(readers_end - readers_begin)),
           remaining_inputs_(num_inputs_),
           lt_(static_cast<unsigned>(num_inputs_), comp),
-          current_(num_inputs_) {
+          current_(num_inputs_),
+          inputs_(num_inputs_) {
 
         for (unsigned t = 0; t < num_inputs_; ++t)
         {
-            if (TLX_LIKELY(readers_[t].HasNext())) {
+            if (TLX_LIKELY(
+                    inputs_[t].Next(readers_[t], current_[t].second))) {
                 current_[t].first = true;
-                current_[t].second = readers_[t].template Next<ValueType>();
                 lt_.insert_start(&current_[t].second, t, false);
             }
             else {
@@ -69,9 +136,9 @@ public:
         unsigned top = lt_.min_source();
         ValueType res = std::move(current_[top].second);
 
-        if (TLX_LIKELY(readers_[top].HasNext())) {
+        if (TLX_LIKELY(
+                inputs_[top].Next(readers_[top], current_[top].second))) {
             current_[top].first = true;
-            current_[top].second = readers_[top].template Next<ValueType>();
             lt_.delete_min_insert(&current_[top].second, false);
         }
         else {
@@ -90,9 +157,9 @@ public:
         unsigned top = lt_.min_source();
         ValueType res = std::move(current_[top].second);
 
-        if (TLX_LIKELY(readers_[top].HasNext())) {
+        if (TLX_LIKELY(
+                inputs_[top].Next(readers_[top], current_[top].second))) {
             current_[top].first = true;
-            current_[top].second = readers_[top].template Next<ValueType>();
             lt_.delete_min_insert(&current_[top].second, false);
         }
         else {
@@ -113,6 +180,216 @@ private:
     LoserTreeType lt_;
     //! current values in each input (exist flag, value)
     std::vector<std::pair<bool, ValueType> > current_;
+    //! buffered inputs
+    std::vector<detail::MultiwayMergeInput<ValueType, Reader> > inputs_;
+};
+
+/*!
+ * Multiway merge tree which caches an order-preserving 64-bit key prefix of
+ * each current item, delivered by the PrefixFunction, and compares the prefixes
+ * first. The full Comparator is only called if the prefixes are equal, and not
+ * at all if ExactPrefix is set, which declares that equal prefixes imply equal
+ * items.
+ */
+template <
+    typename ValueType,
+    typename ReaderIterator,
+    typename Comparator,
+    typename PrefixFunction,
+    bool Stable = false,
+    bool ExactPrefix = false>
+class PrefixMultiwayMergeTree
+{
+public:
+    using Reader = typename std::iterator_traits<ReaderIterator>::value_type;
+
+    //! item with cached key prefix
+    using Entry = std::pair<uint64_t, ValueType>;
+
+    //! comparator of entries: prefixes first, then full items
+    class EntryComparator
+    {
+    public:
+        explicit EntryComparator(const Comparator& comp) : comp_(comp) { }
+
+        bool operator () (const Entry& a, const Entry& b) const {
+            // exact prefixes need a single branch-free integer comparison
+            if (ExactPrefix) return a.first < b.first;
+            if (a.first != b.first) return a.first < b.first;
+            return comp_(a.second, b.second);
+        }
+
+    private:
+        Comparator comp_;
+    };
+
+    using LoserTreeType = tlx::LoserTree<Stable, Entry, EntryComparator>;
+
+    PrefixMultiwayMergeTree(
+        ReaderIterator readers_begin, ReaderIterator readers_end,
+        const Comparator& comp, const PrefixFunction& prefix)
+        : readers_(readers_begin),
+          num_inputs_(static_cast<unsigned>(readers_end - readers_begin)),
+          remaining_inputs_(num_inputs_),
+          prefix_(prefix),
+          lt_(static_cast<unsigned>(num_inputs_), EntryComparator(comp)),
+          current_(num_inputs_),
+          inputs_(num_inputs_) {
+
+        for (unsigned t = 0; t < num_inputs_; ++t)
+        {
+            if (TLX_LIKELY(ReadNext(t))) {
+                lt_.insert_start(&current_[t], t, false);
+            }
+            else {
+                lt_.insert_start(nullptr, t, true);
+                assert(remaining_inputs_ > 0);
+                --remaining_inputs_;
+            }
+        }
+
+        lt_.init();
+    }
+
+    bool HasNext() const {
+        return (remaining_inputs_ != 0);
+    }
+
+    std::pair<ValueType, unsigned> NextWithSource() {
+        unsigned top = lt_.min_source();
+        return std::make_pair(Next(), top);
+    }
+
+    ValueType Next() {
+
+        // take next smallest element out
+        unsigned top = lt_.min_source();
+        ValueType res = std::move(current_[top].second);
+
+        if (TLX_LIKELY(ReadNext(top))) {
+            lt_.delete_min_insert(&current_[top], false);
+        }
+        else {
+            lt_.delete_min_insert(nullptr, true);
+            assert(remaining_inputs_ > 0);
+            --remaining_inputs_;
+        }
+
+        return res;
+    }
+
+private:
+    ReaderIterator readers_;
+    unsigned num_inputs_;
+    size_t remaining_inputs_;
+
+    //! function delivering key prefixes of items
+    PrefixFunction prefix_;
+
+    LoserTreeType lt_;
+    //! current values in each input (cached prefix, value)
+    std::vector<Entry> current_;
+    //! buffered inputs
+    std::vector<detail::MultiwayMergeInput<ValueType, Reader> > inputs_;
+
+    //! read next item from input t and cache its prefix, or return false if
+    //! input t is exhausted.
+    bool ReadNext(unsigned t) {
+        if (!inputs_[t].Next(readers_[t], current_[t].second)) return false;
+        current_[t].first = prefix_(current_[t].second);
+        return true;
+    }
+};
+
+/*!
+ * Multiway merge tree on raw serializable items, which compares LazyItems
+ * referencing the items inside the readers' current Blocks instead of
+ * deserialized copies. Hence, the Comparator works on data::LazyItem<ValueType>
+ * and loads only the fields it needs, e.g. with data::LazyField. Only the
+ * smallest item is deserialized when it is taken out, before its reader
+ * advances.
+ */
+template <
+    typename ValueType,
+    typename ReaderIterator,
+    typename Comparator,
+    bool Stable = false>
+class LazyMultiwayMergeTree
+{
+public:
+    using LazyItem = data::LazyItem<ValueType>;
+
+    using LoserTreeType = tlx::LoserTree<Stable, LazyItem, Comparator>;
+
+    LazyMultiwayMergeTree(
+        ReaderIterator readers_begin, ReaderIterator readers_end,
+        const Comparator& comp)
+        : readers_(readers_begin),
+          num_inputs_(static_cast<unsigned>(readers_end - readers_begin)),
+          remaining_inputs_(num_inputs_),
+          lt_(static_cast<unsigned>(num_inputs_), comp),
+          current_(num_inputs_) {
+
+        for (unsigned t = 0; t < num_inputs_; ++t)
+        {
+            if (TLX_LIKELY(ReadNext(t))) {
+                lt_.insert_start(&current_[t].second, t, false);
+            }
+            else {
+                lt_.insert_start(nullptr, t, true);
+                assert(remaining_inputs_ > 0);
+                --remaining_inputs_;
+            }
+        }
+
+        lt_.init();
+    }
+
+    bool HasNext() const {
+        return (remaining_inputs_ != 0);
+    }
+
+    std::pair<ValueType, unsigned> NextWithSource() {
+        unsigned top = lt_.min_source();
+        return std::make_pair(Next(), top);
+    }
+
+    ValueType Next() {
+
+        // take next smallest element out, its lazy item is invalidated by
+        // reading from its reader.
+        unsigned top = lt_.min_source();
+        ValueType res = current_[top].second.Materialize();
+
+        if (TLX_LIKELY(ReadNext(top))) {
+            lt_.delete_min_insert(&current_[top].second, false);
+        }
+        else {
+            lt_.delete_min_insert(nullptr, true);
+            assert(remaining_inputs_ > 0);
+            --remaining_inputs_;
+        }
+
+        return res;
+    }
+
+private:
+    ReaderIterator readers_;
+    unsigned num_inputs_;
+    size_t remaining_inputs_;
+
+    LoserTreeType lt_;
+    //! current lazy items in each input (exist flag, item)
+    std::vector<std::pair<bool, LazyItem> > current_;
+
+    //! read next lazy item from input t, or return false if input t is
+    //! exhausted.
+    bool ReadNext(unsigned t) {
+        current_[t].first = readers_[t].HasNext();
+        if (current_[t].first)
+            current_[t].second = readers_[t].template NextLazy<ValueType>();
+        return current_[t].first;
+    }
 };
 
 /*!
@@ -164,6 +441,50 @@ auto make_stable_multiway_merge_tree(
         seqs_begin, seqs_end, comp);
 }
 
+/*!
+ * Sequential multi-way merging of readers, which caches the 64-bit key prefix
+ * delivered by prefix for each current item. See PrefixMultiwayMergeTree.
+ *
+ * \param seqs_begin Begin iterator of iterator pair input sequence.
+ * \param seqs_end End iterator of iterator pair input sequence.
+ * \param comp Comparator.
+ * \param prefix Order-preserving prefix function of items.
+ * \tparam Stable Stable merging incurs a performance penalty.
+ * \tparam ExactPrefix Whether equal prefixes imply equal items.
+ */
+template <typename ValueType, bool Stable, bool ExactPrefix,
+          typename ReaderIterator, typename Comparator,
+          typename PrefixFunction>
+auto make_prefix_multiway_merge_tree(
+    ReaderIterator seqs_begin, ReaderIterator seqs_end,
+    const Comparator& comp, const PrefixFunction& prefix) {
+
+    assert(seqs_end - seqs_begin >= 1);
+    return PrefixMultiwayMergeTree<
+        ValueType, ReaderIterator, Comparator, PrefixFunction,
+        Stable, ExactPrefix>(seqs_begin, seqs_end, comp, prefix);
+}
+
+/*!
+ * Sequential multi-way merging of readers of raw serializable items, whose
+ * comparator works on lazy items. See LazyMultiwayMergeTree.
+ *
+ * \param seqs_begin Begin iterator of iterator pair input sequence.
+ * \param seqs_end End iterator of iterator pair input sequence.
+ * \param comp Comparator of data::LazyItem<ValueType>.
+ * \tparam Stable Stable merging incurs a performance penalty.
+ */
+template <typename ValueType, bool Stable = false,
+          typename ReaderIterator, typename Comparator>
+auto make_lazy_multiway_merge_tree(
+    ReaderIterator seqs_begin, ReaderIterator seqs_end,
+    const Comparator& comp) {
+
+    assert(seqs_end - seqs_begin >= 1);
+    return LazyMultiwayMergeTree<ValueType, ReaderIterator, Comparator, Stable>(
+        seqs_begin, seqs_end, comp);
+}
+
 } // namespace core
 } // namespace thrill
 
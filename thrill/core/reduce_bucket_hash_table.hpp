@@ -14,14 +14,16 @@
 #define THRILL_CORE_REDUCE_BUCKET_HASH_TABLE_HEADER
 
 #include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 #include <thrill/core/reduce_table.hpp>
 
+#include <tlx/math/ffs.hpp>
 #include <tlx/vector_free.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <limits>
-#include <stack>
 #include <utility>
 #include <vector>
 
@@ -59,6 +61,13 @@ namespace core {
  * blocks. Bucket blocks are connected by pointers. Key/value pairs are directly
  * stored in a bucket block, no pointers are required here.
  *
+ * Each bucket block keeps a one byte tag of the hash of each item in an array
+ * ahead of the items. Lookups compare a group of tags with one SIMD
+ * instruction (see ReduceProbingGroup) and only compare the keys of items with
+ * matching tags. The BucketBlockPool cuts the blocks of each partition from
+ * contiguous slabs, such that spilling and flushing a partition walks through
+ * few memory areas.
+ *
  *
  *     Partition 0 Partition 1 Partition 2 Partition 3 Partition 4
  *     B00 B01 B02 B10 B11 B12 B20 B21 B22 B30 B31 B32 B40 B41 B42
@@ -100,15 +109,21 @@ class ReduceBucketHashTable
     using Super::debug;
     static constexpr bool debug_items = false;
 
+    using Group = ReduceProbingGroup;
+
     //! target number of bytes in a BucketBlock.
     static constexpr size_t bucket_block_size
         = ReduceConfig::bucket_block_size_;
 
 public:
-    //! calculate number of items such that each BucketBlock has about 1 MiB of
-    //! size, or at least 8 items.
+    //! calculate number of items such that each BucketBlock including the
+    //! tags has about bucket_block_size bytes, or at least one item.
     static constexpr size_t block_size_ =
-        common::max<size_t>(1, bucket_block_size / sizeof(TableItem));
+        common::max<size_t>(1, bucket_block_size / (sizeof(TableItem) + 1));
+
+    //! number of tags, rounded up to whole groups compared at once
+    static constexpr size_t tag_size_ =
+        (block_size_ + Group::width - 1) / Group::width * Group::width;
 
     //! Block holding reduce key/value pairs.
     struct BucketBlock {
@@ -119,6 +134,9 @@ public:
         //! link of linked list to next block
         BucketBlock* next;
 
+        //! tags of the items' hashes, compared before the keys
+        uint8_t    tags[tag_size_]; // NOLINT
+
         //! memory area of items
         TableItem  items[block_size_]; // NOLINT
 
@@ -229,6 +247,14 @@ public:
              << "num_buckets_" << num_buckets_;
 
         buckets_.resize(num_buckets_, nullptr);
+
+        // slabs of a few blocks per partition, such that the partially used
+        // slabs take little of the memory limit.
+        block_pool_.Initialize(
+            num_partitions_,
+            std::min<size_t>(
+                std::max<size_t>(max_blocks_per_partition_ / 8, 1),
+                max_slab_blocks_));
     }
 
     //! non-copyable: delete copy-constructor
@@ -261,7 +287,10 @@ public:
         while (TLX_UNLIKELY(mem::memory_exceeded && num_items_ != 0))
             SpillAnyPartition();
 
-        typename IndexFunction::Result h = calculate_index(kv);
+        // extract the key once for the index and all comparisons
+        const Key& k = key(kv);
+
+        typename IndexFunction::Result h = calculate_key_index(k);
 
         size_t local_index = h.local_index(num_buckets_per_partition_);
 
@@ -272,17 +301,27 @@ public:
             h.partition_id * num_buckets_per_partition_ + local_index;
         BucketBlock* current = buckets_[global_index];
 
+        const uint8_t tag = Group::Fingerprint(Group::FingerprintBits(h, 0));
+
         while (current != nullptr)
         {
-            // iterate over valid items in a block
-            for (TableItem* bi = current->items;
-                 bi != current->items + current->size; ++bi)
+            // compare the tags of valid items in groups, and the keys of items
+            // with matching tags.
+            for (size_t pos = 0; pos < current->size; pos += Group::width)
             {
-                // if item and key equals, then reduce.
-                if (key_equal_function_(key(kv), key(*bi)))
-                {
-                    *bi = reduce(*bi, kv);
-                    return false;
+                size_t n = std::min(size_t(Group::width), current->size - pos);
+                uint32_t match = Group::Match(current->tags + pos, tag);
+                if (n != 32) match &= (uint32_t(1) << n) - 1;
+
+                while (match) {
+                    TableItem* bi = current->items + pos + tlx::ffs(match) - 1;
+                    // if item and key equals, then reduce.
+                    if (key_equal_function_(k, key(*bi)))
+                    {
+                        *bi = reduce(*bi, kv);
+                        return false;
+                    }
+                    match &= match - 1;
                 }
             }
             current = current->next;
@@ -301,7 +340,7 @@ public:
                 SpillAnyPartition();
 
             // allocate a new block of uninitialized items, prepend to bucket
-            current = block_pool_.GetBlock();
+            current = block_pool_.GetBlock(h.partition_id);
             current->next = buckets_[global_index];
             buckets_[global_index] = current;
 
@@ -309,7 +348,8 @@ public:
             ++num_blocks_;
         }
 
-        // in-place construct/insert new item in current bucket block
+        // in-place construct/insert new item and its tag in current block
+        current->tags[current->size] = tag;
         new (current->items + current->size++)TableItem(kv);
 
         LOGC(debug_items)
@@ -338,11 +378,10 @@ public:
             BucketBlock* current = b_block;
             while (current != nullptr)
             {
-                // destroy block and advance to next
-                BucketBlock* next = current->next;
+                // destroy items and advance to next, the slabs are freed by
+                // the block pool
                 current->destroy_items();
-                operator delete (current);
-                current = next;
+                current = current->next;
             }
         }
 
@@ -399,7 +438,7 @@ public:
 
                 // destroy block and advance to next
                 BucketBlock* next = current->next;
-                block_pool_.Deallocate(current);
+                block_pool_.Deallocate(current, partition_id);
                 --num_blocks_;
                 current = next;
             }
@@ -493,7 +532,7 @@ public:
                 if (consume) {
                     // destroy block and advance to next
                     BucketBlock* next = current->next;
-                    block_pool_.Deallocate(current);
+                    block_pool_.Deallocate(current, partition_id);
                     --num_blocks_;
                     current = next;
                 }
@@ -548,7 +587,7 @@ public:
     //! \}
 
 protected:
-    //! BucketBlockPool to stack allocated BucketBlocks
+    //! BucketBlockPool to allocate BucketBlocks from slabs per partition
     class BucketBlockPool
     {
     public:
@@ -567,44 +606,79 @@ protected:
             Destroy();
         }
 
-        // allocate a chunk of memory as big as Type needs:
-        BucketBlock * GetBlock() {
-            BucketBlock* place;
+        //! set the number of partitions and of blocks per slab
+        void Initialize(size_t num_partitions, size_t slab_blocks) {
+            free_.resize(num_partitions);
+            slab_next_.resize(num_partitions, nullptr);
+            slab_end_.resize(num_partitions, nullptr);
+            slab_blocks_ = slab_blocks;
+        }
+
+        //! get a block for the partition: a free one of the partition, the
+        //! next of its slab, a free one of another partition, or the first of
+        //! a new slab.
+        BucketBlock * GetBlock(size_t partition_id) {
+            std::vector<BucketBlock*>& free = free_[partition_id];
             if (!free.empty()) {
-                place = static_cast<BucketBlock*>(free.top());
-                free.pop();
+                BucketBlock* place = free.back();
+                free.pop_back();
+                return place;
             }
-            else {
-                place = static_cast<BucketBlock*>(operator new (sizeof(BucketBlock)));
-                place->size = 0;
-                place->next = nullptr;
+
+            if (slab_next_[partition_id] == slab_end_[partition_id]) {
+                // reuse blocks released by other partitions first
+                for (std::vector<BucketBlock*>& other : free_) {
+                    if (other.empty()) continue;
+                    BucketBlock* place = other.back();
+                    other.pop_back();
+                    return place;
+                }
+
+                BucketBlock* slab = static_cast<BucketBlock*>(
+                    operator new (slab_blocks_ * sizeof(BucketBlock)));
+                slabs_.push_back(slab);
+                slab_next_[partition_id] = slab;
+                slab_end_[partition_id] = slab + slab_blocks_;
             }
 
+            BucketBlock* place = slab_next_[partition_id]++;
+            place->size = 0;
+            place->next = nullptr;
             return place;
         }
 
-        // mark some memory as available (no longer used):
-        void Deallocate(BucketBlock* o) {
+        //! destroy the items of a block and mark it as free
+        void Deallocate(BucketBlock* o, size_t partition_id) {
+            o->destroy_items();
             o->size = 0;
             o->next = nullptr;
-            free.push(static_cast<BucketBlock*>(o));
+            free_[partition_id].push_back(o);
         }
 
+        //! free all slabs, the items of used blocks must be destroyed.
         void Destroy() {
-            while (!free.empty()) {
-                free.top()->destroy_items();
-                operator delete (free.top());
-                free.pop();
-            }
+            for (BucketBlock* slab : slabs_)
+                operator delete (slab);
+            tlx::vector_free(slabs_);
+            tlx::vector_free(free_);
+            tlx::vector_free(slab_next_);
+            tlx::vector_free(slab_end_);
         }
 
     private:
-        // stack to hold pointers to free chunks:
-        std::stack<BucketBlock*> free;
+        //! free blocks of each partition
+        std::vector<std::vector<BucketBlock*> > free_;
+        //! next unused block and end of each partition's current slab
+        std::vector<BucketBlock*> slab_next_, slab_end_;
+        //! all allocated slabs
+        std::vector<BucketBlock*> slabs_;
+        //! number of blocks per slab
+        size_t slab_blocks_ = 1;
     };
 
 public:
     using Super::calculate_index;
+    using Super::calculate_key_index;
 
 private:
     using Super::config_;
@@ -628,6 +702,9 @@ private:
     //! Bucket block pool.
     BucketBlockPool block_pool_;
 
+    //! maximum number of blocks per slab
+    static constexpr size_t max_slab_blocks_ = 64;
+
     //! \name Fixed Operational Parameters
     //! \{
 
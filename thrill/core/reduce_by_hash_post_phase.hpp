@@ -17,11 +17,17 @@
 #define THRILL_CORE_REDUCE_BY_HASH_POST_PHASE_HEADER
 
 #include <thrill/api/context.hpp>
+#include <thrill/common/cpu_placement.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/porting.hpp>
 #include <thrill/core/reduce_bucket_hash_table.hpp>
+#include <thrill/core/reduce_dense_array_table.hpp>
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_robin_hood_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
+#include <thrill/core/reduce_soa_probing_hash_table.hpp>
 #include <thrill/data/file.hpp>
 
 #include <algorithm>
@@ -29,6 +35,7 @@
 #include <cmath>
 #include <functional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -88,6 +95,8 @@ public:
     }
 
     bool Insert(const TableItem& kv) {
+        if (TLX_UNLIKELY(table_.reclaim_requested()) && table_.num_items())
+            table_.SpillAnyPartition();
         return table_.Insert(kv);
     }
 
@@ -148,7 +157,75 @@ public:
         // if partially reduce files remain, create new hash tables to process
         // them iteratively.
 
-        size_t iteration = 1;
+        auto emit = [this, writer](const TableItem& p) {
+                        if (DoCache) writer->Put(p);
+                        emitter_.Emit(p);
+                    };
+
+        if (ReduceConfig::use_parallel_post_phase_ &&
+            remaining_files.size() > 1) {
+            ReReduceParallel(remaining_files, emit);
+        }
+        else {
+            ReReduce(remaining_files, /* iteration */ 1,
+                     table_.limit_memory_bytes(), emit);
+        }
+
+        LOG << "Flushed items";
+    }
+
+    //! Push data into emitter
+    void PushData(bool consume = false) {
+        if (!cache_)
+        {
+            if (!table_.has_spilled_data()) {
+                // no items were spilled to disk, hence we can emit all data
+                // from RAM.
+                Flush</* DoCache */ false>(consume);
+            }
+            else {
+                // items were spilled, hence the reduce table must be emptied
+                // and we have to cache the output stream.
+                cache_ = table_.ctx().GetFilePtr(table_.dia_id());
+                data::File::Writer writer = cache_->GetWriter();
+                Flush</* DoCache */ true>(true, &writer);
+            }
+        }
+        else
+        {
+            // previous PushData() has stored data in cache_
+            data::File::Reader reader = cache_->GetReader(consume);
+            while (reader.HasNext())
+                emitter_.Emit(reader.Next<TableItem>());
+        }
+    }
+
+    void Dispose() {
+        table_.Dispose();
+        if (cache_) cache_.reset();
+    }
+
+    //! \name Accessors
+    //! \{
+
+    //! Returns mutable reference to first table_
+    Table& table() { return table_; }
+
+    //! Returns the total num of items in the table.
+    size_t num_items() const { return table_.num_items(); }
+
+    //! \}
+
+private:
+    /*!
+     * Re-reduce the partially reduced items in the files using subtables with
+     * a different hash function in each iteration, and emit the items of
+     * fully reduced partitions. Partitions which are spilled again are
+     * re-reduced in the next iteration.
+     */
+    template <typename Emit>
+    void ReReduce(std::vector<data::File>& remaining_files, size_t iteration,
+                  size_t limit_memory_bytes, const Emit& emit) {
 
         while (remaining_files.size())
         {
@@ -166,22 +243,33 @@ public:
                 IndexFunction(iteration, table_.index_function()),
                 table_.key_equal_function());
 
-            subtable.Initialize(table_.limit_memory_bytes());
+            subtable.Initialize(limit_memory_bytes);
 
-            size_t num_subfile = 0;
+            // readers of the files, the next one is opened before inserting
+            // the items of the current one, such that its blocks are
+            // prefetched meanwhile.
+            std::vector<data::File::ConsumeReader> readers;
+            readers.reserve(remaining_files.size());
+            readers.emplace_back(remaining_files[0].GetConsumeReader());
 
-            for (data::File& file : remaining_files)
+            for (size_t num_subfile = 0; num_subfile < remaining_files.size();
+                 ++num_subfile)
             {
                 // insert all items from the partially reduced file
-                sLOG << "re-reducing subfile" << num_subfile++
-                     << "containing" << file.num_items() << "items";
+                sLOG << "re-reducing subfile" << num_subfile
+                     << "containing"
+                     << remaining_files[num_subfile].num_items() << "items";
 
-                data::File::ConsumeReader reader = file.GetConsumeReader();
-
-                while (reader.HasNext()) {
-                    subtable.Insert(reader.Next<TableItem>());
+                if (num_subfile + 1 < remaining_files.size()) {
+                    readers.emplace_back(
+                        remaining_files[num_subfile + 1].GetConsumeReader());
                 }
 
+                data::ReadEachItem<TableItem>(
+                    readers[num_subfile], [&subtable](const TableItem& item) {
+                        subtable.Insert(item);
+                    });
+
                 // after insertion, flush fully reduced partitions and save
                 // remaining files for next iteration.
 
@@ -200,6 +288,7 @@ public:
                              << subfile.num_items() << "partially reduced items";
 
                         next_remaining_files.emplace_back(std::move(subfile));
+                        subfile = table_.ctx().GetFile(table_.dia_id());
                     }
                     else {
                         sLOG << "partition" << id << "contains"
@@ -208,65 +297,101 @@ public:
 
                         subtable.FlushPartitionEmit(
                             id, /* consume */ true, /* grow */ false,
-                            [this, writer](
-                                const size_t& partition_id, const TableItem& p) {
-                                if (DoCache) writer->Put(p);
-                                emitter_.Emit(partition_id, p);
+                            [&emit](const size_t& /* partition_id */,
+                                    const TableItem& p) {
+                                emit(p);
                             });
                     }
                 }
             }
 
+            readers.clear();
             remaining_files = std::move(next_remaining_files);
             ++iteration;
         }
-
-        LOG << "Flushed items";
     }
 
-    //! Push data into emitter
-    void PushData(bool consume = false) {
-        if (!cache_)
+    /*!
+     * Re-reduce the spilled files in parallel as tasks of the host's work
+     * stealing pool, with threads on cores borrowed from idle local workers.
+     * Each task re-reduces one file recursively in its own slice of the memory
+     * budget and writes its fully reduced items into an output file. Since the
+     * emitter is not thread-safe, the output files are emitted afterwards.
+     */
+    template <typename Emit>
+    void ReReduceParallel(std::vector<data::File>& files, const Emit& emit) {
+        Context& ctx = table_.ctx();
+        size_t local_worker_id = ctx.local_worker_id();
+
+        std::vector<data::File> outputs;
         {
-            if (!table_.has_spilled_data()) {
-                // no items were spilled to disk, hence we can emit all data
-                // from RAM.
-                Flush</* DoCache */ false>(consume);
+            common::WorkerShare::BusyScope busy_scope(
+                ctx.worker_share(), local_worker_id);
+
+            std::vector<size_t> cores =
+                ctx.worker_share().Borrow(files.size() - 1);
+
+            if (cores.empty()) {
+                return ReReduce(files, /* iteration */ 1,
+                                table_.limit_memory_bytes(), emit);
             }
-            else {
-                // items were spilled, hence the reduce table must be emptied
-                // and we have to cache the output stream.
-                cache_ = table_.ctx().GetFilePtr(table_.dia_id());
-                data::File::Writer writer = cache_->GetWriter();
-                Flush</* DoCache */ true>(true, &writer);
+
+            sLOG << "ReducePostPhase: re-reducing" << files.size()
+                 << "spilled files with" << cores.size() + 1 << "threads";
+
+            size_t limit_memory_bytes =
+                table_.limit_memory_bytes() / (cores.size() + 1);
+
+            outputs.reserve(files.size());
+            for (size_t i = 0; i < files.size(); ++i)
+                outputs.emplace_back(ctx.GetFile(table_.dia_id()));
+
+            common::WorkStealingPool& pool = ctx.work_pool();
+            common::WorkStealingPool::TaskGroup group;
+
+            for (size_t i = 0; i < files.size(); ++i) {
+                pool.Submit(
+                    local_worker_id, group,
+                    [this, &files, &outputs, i, limit_memory_bytes]() {
+                        std::vector<data::File> file;
+                        file.emplace_back(std::move(files[i]));
+
+                        data::File::Writer writer = outputs[i].GetWriter();
+                        ReReduce(file, /* iteration */ 1, limit_memory_bytes,
+                                 [&writer](const TableItem& p) {
+                                     writer.Put(p);
+                                 });
+                        writer.Close();
+                    });
             }
-        }
-        else
-        {
-            // previous PushData() has stored data in cache_
-            data::File::Reader reader = cache_->GetReader(consume);
-            while (reader.HasNext())
-                emitter_.Emit(reader.Next<TableItem>());
-        }
-    }
 
-    void Dispose() {
-        table_.Dispose();
-        if (cache_) cache_.reset();
-    }
+            std::vector<std::thread> threads;
+            threads.reserve(cores.size());
+            for (size_t c = 0; c < cores.size(); ++c) {
+                size_t cpu = common::CpuPlacementCpu(cores[c]);
+                threads.emplace_back(common::CreateThread(
+                                         [&pool, &group,
+                                          local_worker_id, cpu]() {
+                                             common::SetCpuAffinity(cpu);
+                                             pool.Wait(local_worker_id, group);
+                                         }));
+            }
 
-    //! \name Accessors
-    //! \{
+            pool.Wait(local_worker_id, group);
 
-    //! Returns mutable reference to first table_
-    Table& table() { return table_; }
+            for (std::thread& t : threads)
+                t.join();
+            ctx.worker_share().Return(cores);
+        }
 
-    //! Returns the total num of items in the table.
-    size_t num_items() const { return table_.num_items(); }
+        files.clear();
 
-    //! \}
+        for (data::File& output : outputs) {
+            data::File::ConsumeReader reader = output.GetConsumeReader();
+            data::ReadEachItem<TableItem>(reader, emit);
+        }
+    }
 
-private:
     //! Stored reduce config to initialize the subtable.
     ReduceConfig config_;
 
@@ -20,6 +20,9 @@
 #include <thrill/core/reduce_bucket_hash_table.hpp>
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_robin_hood_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
+#include <thrill/core/reduce_soa_probing_hash_table.hpp>
 #include <thrill/data/file.hpp>
 
 #include <tlx/vector_free.hpp>
@@ -237,9 +240,10 @@ public:
             {
                 // insert items
                 auto reader = subrange_files_[i]->GetConsumeReader();
-                while (reader.HasNext()) {
-                    subtable.Insert(reader.template Next<TableItem>());
-                }
+                data::ReadEachItem<TableItem>(
+                    reader, [&subtable](const TableItem& item) {
+                        subtable.Insert(item);
+                    });
             }
 
             subtable.PushData(consume || pwriter, pwriter);
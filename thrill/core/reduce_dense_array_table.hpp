@@ -0,0 +1,325 @@
+/*******************************************************************************
+ * thrill/core/reduce_dense_array_table.hpp
+ *
+ * Reduce table for dense index keys, which aggregates directly into a flat
+ * array instead of hashing and probing.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_DENSE_ARRAY_TABLE_HEADER
+#define THRILL_CORE_REDUCE_DENSE_ARRAY_TABLE_HEADER
+
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_table.hpp>
+
+#include <tlx/define/likely.hpp>
+#include <tlx/vector_free.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A reduce table for the dense index keys of ReduceToIndex, which requires the
+ * ReduceByIndex index function. Each index is mapped to exactly one slot of a
+ * flat array, hence an Insert() is an index calculation, a bit test, and a
+ * reduce, without any hashing, probing, or key comparisons.
+ *
+ * If the whole index range fits into limit_memory_bytes, the mapping from
+ * indexes to slots is injective, and all items are reduced in the array. If
+ * not, several indexes share a slot, and the array acts as a direct-mapped
+ * cache: an item colliding with the stored item of another index evicts it to
+ * the next phase (with immediate_flush), or spills its partition.
+ *
+ * The partitions are contiguous slices of the array, and each partition is
+ * flushed in index order.
+ */
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction, typename Emitter,
+          const bool VolatileKey,
+          typename ReduceConfig_,
+          typename IndexFunction,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class ReduceDenseArrayTable
+    : public ReduceTable<TableItem, Key, Value,
+                         KeyExtractor, ReduceFunction, Emitter,
+                         VolatileKey, ReduceConfig_,
+                         IndexFunction, KeyEqualFunction>
+{
+    using Super = ReduceTable<TableItem, Key, Value,
+                              KeyExtractor, ReduceFunction, Emitter,
+                              VolatileKey, ReduceConfig_, IndexFunction,
+                              KeyEqualFunction>;
+    using Super::debug;
+
+    static_assert(std::is_same<IndexFunction, ReduceByIndex<Key> >::value,
+                  "ReduceDenseArrayTable requires the ReduceByIndex index "
+                  "function, i.e. it can only be used by ReduceToIndex");
+
+public:
+    using ReduceConfig = ReduceConfig_;
+
+    ReduceDenseArrayTable(
+        Context& ctx, size_t dia_id,
+        const KeyExtractor& key_extractor,
+        const ReduceFunction& reduce_function,
+        Emitter& emitter,
+        size_t num_partitions,
+        const ReduceConfig& config = ReduceConfig(),
+        bool immediate_flush = false,
+        const IndexFunction& index_function = IndexFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : Super(ctx, dia_id,
+                key_extractor, reduce_function, emitter,
+                num_partitions, config, immediate_flush,
+                index_function, key_equal_function)
+    { assert(num_partitions > 0); }
+
+    //! Allocate the array: one slot per index if the index range fits into
+    //! limit_memory_bytes, otherwise as many slots as fit.
+    void Initialize(size_t limit_memory_bytes) {
+        assert(items_.empty());
+
+        limit_memory_bytes_ = limit_memory_bytes;
+
+        // each slot costs an item and an occupancy bit
+        size_t max_buckets = std::max<size_t>(
+            num_partitions_,
+            limit_memory_bytes_ * 8 / (8 * sizeof(TableItem) + 1));
+
+        size_t range_size = index_function_.range().size();
+        dense_ = (range_size <= max_buckets);
+
+        num_buckets_per_partition_ = std::max<size_t>(
+            1, dense_
+            ? (range_size + num_partitions_ - 1) / num_partitions_
+            : max_buckets / num_partitions_);
+
+        num_buckets_ = num_buckets_per_partition_ * num_partitions_;
+        limit_items_per_partition_ = num_buckets_per_partition_;
+
+        sLOG << "ReduceDenseArrayTable::Initialize()"
+             << "range_size" << range_size
+             << "num_buckets" << num_buckets_
+             << "dense" << dense_;
+
+        items_.resize(num_buckets_);
+        occupied_.resize(num_buckets_, false);
+    }
+
+    /*!
+     * Inserts a value into the table, reducing it with the item in its slot if
+     * it has the same index.
+     *
+     * \param kv Value to be inserted into the table.
+     *
+     * \return true if a new key was inserted to the table
+     */
+    bool Insert(const TableItem& kv) {
+
+        typename IndexFunction::Result h = calculate_index(kv);
+        assert(h.partition_id < num_partitions_);
+        assert(h.global_index < num_buckets_);
+
+        TableItem& slot = items_[h.global_index];
+
+        if (!occupied_[h.global_index]) {
+            slot = kv;
+            occupied_[h.global_index] = true;
+            ++items_per_partition_[h.partition_id];
+            ++num_items_;
+            return true;
+        }
+
+        // indexes map to slots injectively, if the whole range fits
+        if (TLX_LIKELY(dense_) || key_equal_function_(key(slot), key(kv))) {
+            slot = reduce(slot, kv);
+            return false;
+        }
+
+        if (immediate_flush_) {
+            // evict the item of the other index to the next phase
+            emitter_.Emit(h.partition_id, slot);
+            slot = kv;
+            return true;
+        }
+
+        SpillPartition(h.partition_id);
+        return Insert(kv);
+    }
+
+    //! Deallocate items and memory
+    void Dispose() {
+        tlx::vector_free(items_);
+        tlx::vector_free(occupied_);
+        Super::Dispose();
+    }
+
+    //! \name Spilling Mechanisms to External Memory Files
+    //! \{
+
+    //! Spill all items of a partition into an external memory File.
+    void SpillPartition(size_t partition_id) {
+
+        if (immediate_flush_) {
+            return FlushPartition(
+                partition_id, /* consume */ true, /* grow */ false);
+        }
+
+        LOG << "Spilling " << items_per_partition_[partition_id]
+            << " items of partition with id: " << partition_id;
+
+        if (items_per_partition_[partition_id] == 0)
+            return;
+
+        data::File::Writer writer = partition_files_[partition_id].GetWriter();
+
+        FlushPartitionEmit(
+            partition_id, /* consume */ true, /* grow */ false,
+            [&writer](const size_t& /* partition_id */, const TableItem& p) {
+                writer.Put(p);
+            });
+    }
+
+    //! Spill all items of an arbitrary partition into an external memory File.
+    void SpillAnyPartition() {
+        return SpillLargestPartition();
+    }
+
+    //! Spill all items of the largest partition into an external memory File.
+    void SpillLargestPartition() {
+        size_t size_max = 0, index = 0;
+
+        for (size_t i = 0; i < num_partitions_; ++i)
+        {
+            if (items_per_partition_[i] > size_max)
+            {
+                size_max = items_per_partition_[i];
+                index = i;
+            }
+        }
+
+        if (size_max == 0) {
+            return;
+        }
+
+        return SpillPartition(index);
+    }
+
+    //! \}
+
+    //! \name Flushing Mechanisms to Next Stage or Phase
+    //! \{
+
+    template <typename Emit>
+    void FlushPartitionEmit(
+        size_t partition_id, bool consume, bool /* grow */, Emit emit) {
+
+        LOG << "Flushing " << items_per_partition_[partition_id]
+            << " items of partition: " << partition_id;
+
+        size_t begin = partition_id * num_buckets_per_partition_;
+        size_t end = begin + num_buckets_per_partition_;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (!occupied_[i]) continue;
+
+            emit(partition_id, items_[i]);
+
+            if (consume) {
+                items_[i] = TableItem();
+                occupied_[i] = false;
+            }
+        }
+
+        if (consume) {
+            // reset partition specific counter
+            num_items_ -= items_per_partition_[partition_id];
+            items_per_partition_[partition_id] = 0;
+            assert(num_items_ == this->num_items_calc());
+        }
+
+        LOG << "Done flushed items of partition: " << partition_id;
+    }
+
+    void FlushPartition(size_t partition_id, bool consume, bool grow) {
+        FlushPartitionEmit(
+            partition_id, consume, grow,
+            [this](const size_t& partition_id, const TableItem& p) {
+                this->emitter_.Emit(partition_id, p);
+            });
+    }
+
+    void FlushAll() {
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            FlushPartition(i, /* consume */ true, /* grow */ false);
+        }
+    }
+
+    //! \}
+
+    //! whether the whole index range is reduced in the array
+    bool dense() const { return dense_; }
+
+public:
+    using Super::calculate_index;
+
+private:
+    using Super::emitter_;
+    using Super::immediate_flush_;
+    using Super::index_function_;
+    using Super::items_per_partition_;
+    using Super::key;
+    using Super::key_equal_function_;
+    using Super::limit_items_per_partition_;
+    using Super::limit_memory_bytes_;
+    using Super::num_buckets_;
+    using Super::num_buckets_per_partition_;
+    using Super::num_items_;
+    using Super::num_partitions_;
+    using Super::partition_files_;
+    using Super::reduce;
+
+    //! the flat array of items, one slot per index if dense_.
+    std::vector<TableItem> items_;
+
+    //! whether a slot holds an item
+    std::vector<bool> occupied_;
+
+    //! whether the whole index range fits into the array
+    bool dense_ = false;
+};
+
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction,
+          typename Emitter, const bool VolatileKey,
+          typename ReduceConfig, typename IndexFunction,
+          typename KeyEqualFunction>
+class ReduceTableSelect<
+        ReduceTableImpl::DENSE,
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>
+{
+public:
+    using type = ReduceDenseArrayTable<
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig,
+        IndexFunction, KeyEqualFunction>;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_DENSE_ARRAY_TABLE_HEADER
+
+/******************************************************************************/
@@ -20,6 +20,8 @@
 #include <thrill/common/hash.hpp>
 #include <thrill/common/math.hpp>
 
+#include <type_traits>
+
 namespace thrill {
 namespace core {
 
@@ -27,7 +29,7 @@ namespace core {
  * A reduce index function which returns a hash index and partition. It is used
  * by ReduceByKey.
  */
-template <typename Key, typename HashFunction = std::hash<Key> >
+template <typename Key, typename HashFunction = common::HashDefault<Key> >
 class ReduceByHash
 {
 public:
@@ -160,8 +162,14 @@ template <typename Value, typename TableItem>
 class ReduceMakeTableItem<Value, TableItem, /* VolatileKey */ false>
 {
 public:
+    static_assert(std::is_same<Value, TableItem>::value,
+                  "TableItem must be Value for non-volatile keys");
+
+    //! the item is the value itself: pass on a reference without copying, the
+    //! table copies it only when inserting a new key.
     template <typename KeyExtractor>
-    static TableItem Make(const Value& v, KeyExtractor& /* key_extractor */) {
+    static const TableItem& Make(const Value& v,
+                                 KeyExtractor& /* key_extractor */) {
         return v;
     }
 
@@ -192,7 +200,8 @@ public:
     }
 
     template <typename KeyExtractor>
-    static auto GetKey(const TableItem& t, KeyExtractor& /* key_extractor */) {
+    static const auto& GetKey(const TableItem& t,
+                              KeyExtractor& /* key_extractor */) {
         return t.first;
     }
 
@@ -17,22 +17,31 @@
 #define THRILL_CORE_REDUCE_PRE_PHASE_HEADER
 
 #include <thrill/common/defines.hpp>
+#include <thrill/common/hash.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/core/duplicate_detection.hpp>
+#include <thrill/core/hyperloglog.hpp>
 #include <thrill/core/reduce_bucket_hash_table.hpp>
+#include <thrill/core/reduce_dense_array_table.hpp>
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_robin_hood_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
+#include <thrill/core/reduce_soa_probing_hash_table.hpp>
 #include <thrill/data/block_reader.hpp>
 #include <thrill/data/block_writer.hpp>
 #include <thrill/data/file.hpp>
 
+#include <tlx/vector_free.hpp>
+
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -89,7 +98,7 @@ template <typename TableItem, typename Key, typename Value,
           typename ReduceConfig_ = DefaultReduceConfig,
           typename IndexFunction = ReduceByHash<Key>,
           typename KeyEqualFunction = std::equal_to<Key>,
-          typename HashFunction = std::hash<Key>,
+          typename HashFunction = common::HashDefault<Key>,
           bool UseDuplicateDetection = false>
 class ReducePrePhase;
 
@@ -142,9 +151,19 @@ public:
           table_(ctx, dia_id,
                  key_extractor, reduce_function, emit_,
                  num_partitions, config, !duplicates,
-                 index_function, key_equal_function) {
-
-        tlx::unused(hash_function);
+                 index_function, key_equal_function),
+          hash_function_(hash_function),
+          bypass_threshold_(config.bypass_reduction_threshold()),
+          estimated_keys_(config.estimated_keys()),
+          estimate_keys_(config.estimate_keys()),
+          // duplicate detection reads all items from the table
+          key_domain_size_(
+              duplicates || !std::is_integral<Key>::value
+              ? 0 : config.key_domain_size()) {
+
+        // duplicate detection needs all items in the table
+        if (!duplicates)
+            sample_left_ = sample_items_ = config.bypass_sample_items();
 
         sLOG << "creating ReducePrePhase with" << emit.size() << "output emitters";
 
@@ -157,7 +176,35 @@ public:
     ReducePrePhase& operator = (const ReducePrePhase&) = delete;
 
     void Initialize(size_t limit_memory_bytes) {
+        // take the flat array of the small key domain from the memory, if
+        // it fits into half.
+        if (key_domain_size_ != 0 &&
+            key_domain_size_ <=
+            limit_memory_bytes / 2 / (sizeof(TableItem) + 1)) {
+            size_t direct_bytes =
+                key_domain_size_ * sizeof(TableItem) + key_domain_size_ / 8;
+            direct_items_.resize(key_domain_size_);
+            direct_used_.resize(key_domain_size_, false);
+            limit_memory_bytes -= direct_bytes;
+
+            // a small domain reduces well, sampling only costs time.
+            sample_left_ = 0;
+
+            sLOG << "ReducePrePhase: key_domain_size" << key_domain_size_
+                 << "reduced in flat array of" << direct_bytes << "bytes";
+        }
+
         table_.Initialize(limit_memory_bytes);
+
+        // if the expected keys fit into the table, all further items are
+        // reduced in memory. The sample would underestimate the reduction,
+        // since it contains the first occurrences of all keys.
+        if (estimated_keys_ != 0 && sample_left_ != 0 &&
+            estimated_keys_ <= table_capacity(limit_memory_bytes)) {
+            sLOG << "ReducePrePhase: estimated_keys" << estimated_keys_
+                 << "fit into table -> no bypass";
+            sample_left_ = 0;
+        }
     }
 
     void InitializeSkip() {
@@ -165,24 +212,51 @@ public:
     }
 
     bool Insert(const Value& v) {
+        CountInsert();
+        if (TLX_UNLIKELY(estimate_keys_))
+            EstimateInsert(v);
+        if (TLX_UNLIKELY(bypass_)) {
+            EmitDirect(v);
+            return true;
+        }
+        if (TLX_UNLIKELY(table_.reclaim_requested()) && table_.num_items())
+            table_.SpillAnyPartition();
         // for VolatileKey this makes std::pair and extracts the key
-        return table_.Insert(MakeTableItem::Make(v, table_.key_extractor()));
+        const TableItem& t = MakeTableItem::Make(v, table_.key_extractor());
+        size_t direct_index =
+            direct_items_.empty() ? size_t(-1) : DirectIndex(
+                MakeTableItem::GetKey(t, table_.key_extractor()),
+                std::is_integral<Key>());
+        bool new_key = direct_index < direct_items_.size()
+                       ? DirectInsert(direct_index, t) : table_.Insert(t);
+        if (TLX_UNLIKELY(sample_left_ != 0))
+            SampleInsert(new_key);
+        return new_key;
     }
 
     void InsertSkip(const Value& v) {
-        TableItem t = MakeTableItem::Make(v, table_.key_extractor());
+        CountInsert();
+        if (TLX_UNLIKELY(estimate_keys_))
+            EstimateInsert(v);
+        EmitDirect(v);
+    }
+
+    //! emit an item to its partition without reducing it in the table
+    void EmitDirect(const Value& v) {
+        const TableItem& t = MakeTableItem::Make(v, table_.key_extractor());
         typename IndexFunction::Result h = table_.calculate_index(t);
         emit_.Emit(h.partition_id, t);
     }
 
-    //! Flush all partitions
+    //! Flush all partitions and the flat array of the small key domain
     void FlushAll() {
+        FlushDirect();
         for (size_t id = 0; id < table_.num_partitions(); ++id) {
             FlushPartition(id, /* consume */ true, /* grow */ false);
         }
     }
 
-    //! Flushes a partition
+    //! Flushes a partition of the table, but not the flat array.
     void FlushPartition(size_t partition_id, bool consume, bool grow) {
         table_.FlushPartition(partition_id, consume, grow);
         // data is flushed immediately, there is no spilled data
@@ -190,15 +264,48 @@ public:
 
     //! Closes all emitter
     void CloseAll() {
+        if (estimate_keys_) {
+            table_.ctx().logger_
+                << "class" << "ReducePrePhase"
+                << "event" << "estimate_keys"
+                << "dia_id" << table_.dia_id()
+                << "num_inserted" << num_inserted_
+                << "estimated_keys" << estimated_keys();
+        }
         emit_.CloseAll();
         table_.Dispose();
+        tlx::vector_free(direct_items_);
+        tlx::vector_free(direct_used_);
     }
 
     //! \name Accessors
     //! \{
 
-    //! Returns the total num of items in the table.
-    size_t num_items() const { return table_.num_items(); }
+    //! Returns the total num of items in the table and the flat array.
+    size_t num_items() const { return table_.num_items() + direct_num_items_; }
+
+    //! Returns the number of items inserted.
+    size_t num_inserted() const { return num_inserted_; }
+
+    //! Returns the number of items emitted so far, by spilling full partitions
+    //! or bypassing the table.
+    size_t num_emitted() const {
+        size_t total = 0;
+        for (const size_t& s : emit_.stats_) total += s;
+        return total;
+    }
+
+    //! Returns whether the table is bypassed due to ineffective reduction.
+    bool bypass() const { return bypass_; }
+
+    //! Returns whether keys of the small domain are reduced in a flat array.
+    bool direct() const { return !direct_items_.empty(); }
+
+    //! Returns the HyperLogLog estimate of the number of distinct keys
+    //! inserted, if estimate_keys_ is set in the config.
+    size_t estimated_keys() {
+        return static_cast<size_t>(std::llround(key_registers_.result()));
+    }
 
     //! calculate key range for the given output partition
     common::Range key_range(size_t partition_id)
@@ -215,6 +322,137 @@ protected:
 
     //! the first-level hash table implementation
     Table table_;
+
+    //! hash function of the keys for duplicate detection and estimation
+    HashFunction hash_function_;
+
+    //! number of items inserted, reported as progress of the DIA node
+    size_t num_inserted_ = 0;
+
+    //! number of items between progress reports
+    static constexpr size_t progress_interval_ = 64 * 1024;
+
+    //! count an inserted item, and report the progress periodically
+    void CountInsert() {
+        if (TLX_UNLIKELY(++num_inserted_ % progress_interval_ == 0)) {
+            table_.ctx().ReportProgress(table_.dia_id(), num_inserted_);
+        }
+    }
+
+    //! \name Adaptive Bypass
+    //! \{
+
+    //! number of items to sample and remaining ones, zero if decided.
+    size_t sample_items_ = 0, sample_left_ = 0;
+    //! number of sampled items which inserted a new key
+    size_t sample_new_keys_ = 0;
+    //! minimum fraction of reduced items to keep using the table
+    double bypass_threshold_;
+    //! whether items are emitted directly, bypassing the table
+    bool bypass_ = false;
+
+    //! count an insert of the sample, and decide whether to bypass the table
+    //! once the sample is complete.
+    void SampleInsert(bool new_key) {
+        sample_new_keys_ += new_key;
+        if (--sample_left_ != 0) return;
+
+        double reduction =
+            1.0 - static_cast<double>(sample_new_keys_)
+            / static_cast<double>(sample_items_);
+        bypass_ = (reduction < bypass_threshold_);
+
+        table_.ctx().logger_
+            << "class" << "ReducePrePhase"
+            << "event" << "bypass"
+            << "dia_id" << table_.dia_id()
+            << "sample_items" << sample_items_
+            << "new_keys" << sample_new_keys_
+            << "reduction" << reduction
+            << "threshold" << bypass_threshold_
+            << "bypass" << bypass_;
+
+        sLOG << "ReducePrePhase: reduction" << reduction
+             << "in sample of" << sample_items_ << "-> bypass" << bypass_;
+    }
+
+    //! number of items the table holds within limit_memory_bytes before
+    //! partitions are flushed.
+    size_t table_capacity(size_t limit_memory_bytes) const {
+        return static_cast<size_t>(
+            static_cast<double>(limit_memory_bytes)
+            / static_cast<double>(sizeof(TableItem))
+            * table_.config().limit_partition_fill_rate());
+    }
+
+    //! \}
+
+    //! \name Estimation of Distinct Keys
+    //! \{
+
+    //! expected number of distinct keys from the config, or zero
+    size_t estimated_keys_;
+    //! whether to estimate the number of distinct keys
+    bool estimate_keys_;
+    //! HyperLogLog registers of the inserted keys' hashes
+    HyperLogLogRegisters<14> key_registers_;
+
+    //! add the key of v to the HyperLogLog estimate. The hash function's
+    //! result is hashed again, since HyperLogLog needs uniform 64-bit hashes.
+    void EstimateInsert(const Value& v) {
+        key_registers_.insert(hash_function_(key_extractor_(v)));
+    }
+
+    //! \}
+
+    //! \name Flat Array of a Small Key Domain
+    //! \{
+
+    //! size of the key domain hint, zero if not applicable
+    size_t key_domain_size_;
+    //! items of the keys [0, key_domain_size_), empty if not used
+    std::vector<TableItem> direct_items_;
+    //! whether a slot of direct_items_ holds an item
+    std::vector<bool> direct_used_;
+    //! number of items in direct_items_
+    size_t direct_num_items_ = 0;
+
+    //! slot of an integral key, negative keys are mapped beyond the domain.
+    template <typename K>
+    static size_t DirectIndex(const K& k, std::true_type /* integral */) {
+        return static_cast<size_t>(k);
+    }
+    template <typename K>
+    static size_t DirectIndex(const K& /* k */, std::false_type) {
+        return size_t(-1);
+    }
+
+    //! reduce an item into its slot of the flat array
+    bool DirectInsert(size_t index, const TableItem& t) {
+        if (!direct_used_[index]) {
+            direct_items_[index] = t;
+            direct_used_[index] = true;
+            ++direct_num_items_;
+            return true;
+        }
+        direct_items_[index] = MakeTableItem::Reduce(
+            direct_items_[index], t, table_.reduce_function());
+        return false;
+    }
+
+    //! emit the items of the flat array to their partitions
+    void FlushDirect() {
+        for (size_t i = 0; i < direct_items_.size(); ++i) {
+            if (!direct_used_[i]) continue;
+            const TableItem& t = direct_items_[i];
+            emit_.Emit(table_.calculate_index(t).partition_id, t);
+            direct_items_[i] = TableItem();
+            direct_used_[i] = false;
+        }
+        direct_num_items_ = 0;
+    }
+
+    //! \}
 };
 
 template <typename TableItem, typename Key, typename Value,
@@ -265,10 +503,15 @@ public:
                    const HashFunction hash_function = HashFunction())
         : Super(ctx, dia_id, num_partitions, key_extractor, reduce_function,
                 emit, config, index_function, equal_to_function, hash_function,
-                /*duplicates*/ true),
-          hash_function_(hash_function) { }
+                /*duplicates*/ true) { }
 
     void Insert(const Value& v) {
+        Super::CountInsert();
+        if (TLX_UNLIKELY(Super::estimate_keys_))
+            Super::EstimateInsert(v);
+        if (TLX_UNLIKELY(Super::table_.reclaim_requested()) &&
+            Super::table_.num_items())
+            Super::table_.SpillAnyPartition();
         if (Super::table_.Insert(
                 Super::MakeTableItem::Make(v, Super::table_.key_extractor()))) {
             hashes_.push_back(hash_function_(Super::key_extractor_(v)));
@@ -332,7 +575,8 @@ public:
     //! \name Duplicate Detection
     //! \{
 
-    HashFunction hash_function_;
+    using Super::hash_function_;
+
     //! Hashes of all keys.
     std::vector<size_t> hashes_;
     //! All elements occuring on more than one worker. (Elements not appearing here
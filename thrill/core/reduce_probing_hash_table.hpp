@@ -133,7 +133,7 @@ public:
 
         partition_size_.resize(
             num_partitions_,
-            std::min(size_t(config_.initial_items_per_partition_),
+            std::min(Super::initial_partition_size(),
                      num_buckets_per_partition_));
 
         // calculate limit on the number of items in a partition before these
@@ -189,10 +189,13 @@ public:
      */
     bool Insert(const TableItem& kv) {
 
-        typename IndexFunction::Result h = calculate_index(kv);
+        // extract the key once for the index and all comparisons
+        const Key& k = key(kv);
+
+        typename IndexFunction::Result h = calculate_key_index(k);
         assert(h.partition_id < num_partitions_);
 
-        if (TLX_UNLIKELY(key_equal_function_(key(kv), Key()))) {
+        if (TLX_UNLIKELY(key_equal_function_(k, Key()))) {
             // handle pairs with sentinel key specially by reducing into last
             // element of items.
             TableItem& sentinel = items_[num_buckets_];
@@ -228,7 +231,7 @@ public:
 
         while (!key_equal_function_(key(*iter), Key()))
         {
-            if (key_equal_function_(key(*iter), key(kv)))
+            if (key_equal_function_(key(*iter), k))
             {
                 *iter = reduce(*iter, kv);
                 return false;
@@ -499,6 +502,7 @@ public:
 
 public:
     using Super::calculate_index;
+    using Super::calculate_key_index;
 
 private:
     using Super::config_;
@@ -0,0 +1,405 @@
+/*******************************************************************************
+ * thrill/core/reduce_robin_hood_hash_table.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_ROBIN_HOOD_HASH_TABLE_HEADER
+#define THRILL_CORE_REDUCE_ROBIN_HOOD_HASH_TABLE_HEADER
+
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_table.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A linear probing reduce table using Robin Hood hashing: on insertion, an
+ * item which is further away from its home slot than the item in the probed
+ * slot takes the slot, and the displaced item continues probing. This evens
+ * out the probe sequence lengths, such that the table can run at fill rates of
+ * 0.85-0.9, while ReduceProbingHashTable needs about 0.5.
+ *
+ * Each slot stores its probe distance plus one in a byte array next to the
+ * items, zero marks empty slots. Hence, no sentinel key is needed, and a key is
+ * only compared on slots with the same probe distance. Lookups of absent keys
+ * stop at the first slot that is closer to its home than the probe.
+ *
+ * Probe distances are bounded by max_probe_. If an insertion would exceed it,
+ * the partition is spilled (or flushed) and the insertion is retried. Unlike
+ * ReduceProbingHashTable, partitions do not grow, since Robin Hood ordering
+ * does not survive in place rehashing. Items are only constructed in occupied
+ * slots, hence initialization only clears the distance bytes.
+ */
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction, typename Emitter,
+          const bool VolatileKey,
+          typename ReduceConfig_,
+          typename IndexFunction,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class ReduceRobinHoodHashTable
+    : public ReduceTable<TableItem, Key, Value,
+                         KeyExtractor, ReduceFunction, Emitter,
+                         VolatileKey, ReduceConfig_,
+                         IndexFunction, KeyEqualFunction>
+{
+    using Super = ReduceTable<TableItem, Key, Value,
+                              KeyExtractor, ReduceFunction, Emitter,
+                              VolatileKey, ReduceConfig_, IndexFunction,
+                              KeyEqualFunction>;
+    using Super::debug;
+
+public:
+    using ReduceConfig = ReduceConfig_;
+
+    //! maximum probe distance plus one of an item
+    static constexpr size_t max_probe_ = 128;
+
+    ReduceRobinHoodHashTable(
+        Context& ctx, size_t dia_id,
+        const KeyExtractor& key_extractor,
+        const ReduceFunction& reduce_function,
+        Emitter& emitter,
+        size_t num_partitions,
+        const ReduceConfig& config = ReduceConfig(),
+        bool immediate_flush = false,
+        const IndexFunction& index_function = IndexFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : Super(ctx, dia_id,
+                key_extractor, reduce_function, emitter,
+                num_partitions, config, immediate_flush,
+                index_function, key_equal_function)
+    { assert(num_partitions > 0); }
+
+    //! Allocate the hash table and clear the probe distances.
+    void Initialize(size_t limit_memory_bytes) {
+        assert(!items_);
+
+        limit_memory_bytes_ = limit_memory_bytes;
+
+        // calculate num_buckets_per_partition_ from the memory limit and the
+        // number of partitions required
+
+        num_buckets_per_partition_ = std::max<size_t>(
+            1,
+            (size_t)(static_cast<double>(limit_memory_bytes_)
+                     / static_cast<double>(sizeof(TableItem) + 1)
+                     / static_cast<double>(num_partitions_)));
+
+        num_buckets_ = num_buckets_per_partition_ * num_partitions_;
+
+        assert(num_buckets_per_partition_ > 0);
+        assert(num_buckets_ > 0);
+
+        // calculate limit on the number of items in a partition before these
+        // are spilled to disk or flushed to network.
+
+        double limit_fill_rate = config_.limit_partition_fill_rate();
+
+        assert(limit_fill_rate >= 0.0 && limit_fill_rate <= 1.0
+               && "limit_partition_fill_rate must be between 0.0 and 1.0. "
+               "with a fill rate of 0.0, items are immediately flushed.");
+
+        limit_items_per_partition_ = (size_t)(
+            static_cast<double>(num_buckets_per_partition_) * limit_fill_rate);
+
+        // actually allocate the table, items are constructed on insertion.
+
+        items_ = static_cast<TableItem*>(
+            operator new (num_buckets_ * sizeof(TableItem)));
+
+        dist_ = new uint8_t[num_buckets_];
+        std::fill(dist_, dist_ + num_buckets_, uint8_t(0));
+    }
+
+    ~ReduceRobinHoodHashTable() {
+        if (items_) Dispose();
+    }
+
+    /*!
+     * Inserts a value into the table, potentially reducing it in case both the
+     * key of the value already in the table and the key of the value to be
+     * inserted are the same.
+     *
+     * An insert may trigger a spill or flush of the partition, if its fill
+     * rate limit is reached or the probe distance exceeds max_probe_.
+     *
+     * \param kv Value to be inserted into the table.
+     *
+     * \return true if a new key was inserted to the table
+     */
+    bool Insert(const TableItem& kv) {
+
+        while (TLX_UNLIKELY(mem::memory_exceeded && num_items_ != 0))
+            SpillAnyPartition();
+
+        // extract the key once for the index and all comparisons
+        const Key& k = key(kv);
+
+        typename IndexFunction::Result h = calculate_key_index(k);
+        assert(h.partition_id < num_partitions_);
+
+        const size_t psize = num_buckets_per_partition_;
+        TableItem* pitems = items_ + h.partition_id * psize;
+        uint8_t* pdist = dist_ + h.partition_id * psize;
+
+        size_t pos = h.local_index(psize);
+        size_t dist = 1;
+
+        // search for the key until a slot closer to its home is found, which
+        // includes empty slots. Stored distances are at most max_probe_.
+        while (pdist[pos] >= dist)
+        {
+            if (pdist[pos] == dist && key_equal_function_(key(pitems[pos]), k))
+            {
+                pitems[pos] = reduce(pitems[pos], kv);
+                return false;
+            }
+
+            ++dist;
+            if (TLX_UNLIKELY(++pos == psize)) pos = 0;
+        }
+
+        if (TLX_UNLIKELY(dist > max_probe_)) {
+            SpillPartition(h.partition_id);
+            return Insert(kv);
+        }
+
+        // insert the new item, displacing items closer to their home slot until
+        // an empty slot is found.
+        TableItem carry = kv;
+
+        while (pdist[pos] != 0)
+        {
+            if (pdist[pos] < dist) {
+                std::swap(carry, pitems[pos]);
+                size_t carry_dist = pdist[pos];
+                pdist[pos] = static_cast<uint8_t>(dist);
+                dist = carry_dist;
+            }
+
+            ++dist;
+            if (TLX_UNLIKELY(++pos == psize)) pos = 0;
+
+            if (TLX_UNLIKELY(dist > max_probe_)) {
+                // the new item is placed, but the displaced carry item has no
+                // slot within the bounded distance: spill and reinsert it.
+                SpillPartition(h.partition_id);
+                Insert(carry);
+                return true;
+            }
+        }
+
+        new (pitems + pos)TableItem(std::move(carry));
+        pdist[pos] = static_cast<uint8_t>(dist);
+
+        // increase counter for partition
+        ++items_per_partition_[h.partition_id];
+        ++num_items_;
+
+        while (TLX_UNLIKELY(
+                   items_per_partition_[h.partition_id] >
+                   limit_items_per_partition_))
+            SpillPartition(h.partition_id);
+
+        return true;
+    }
+
+    //! Deallocate items and memory
+    void Dispose() {
+        if (!items_) return;
+
+        // dispose the items in occupied slots by destructor
+
+        for (size_t i = 0; i < num_buckets_; ++i) {
+            if (dist_[i] != 0)
+                items_[i].~TableItem();
+        }
+
+        operator delete (items_);
+        items_ = nullptr;
+
+        delete[] dist_;
+        dist_ = nullptr;
+
+        Super::Dispose();
+    }
+
+    //! \name Spilling Mechanisms to External Memory Files
+    //! \{
+
+    //! Spill all items of a partition into an external memory File.
+    void SpillPartition(size_t partition_id) {
+
+        if (immediate_flush_) {
+            return FlushPartition(
+                partition_id, /* consume */ true, /* grow */ false);
+        }
+
+        LOG << "Spilling " << items_per_partition_[partition_id]
+            << " items of partition with id: " << partition_id;
+
+        if (items_per_partition_[partition_id] == 0)
+            return;
+
+        data::File::Writer writer = partition_files_[partition_id].GetWriter();
+
+        size_t offset = partition_id * num_buckets_per_partition_;
+        TableItem* pitems = items_ + offset;
+        uint8_t* pdist = dist_ + offset;
+
+        for (size_t i = 0; i < num_buckets_per_partition_; ++i) {
+            if (pdist[i] != 0) {
+                writer.Put(pitems[i]);
+                pitems[i].~TableItem();
+                pdist[i] = 0;
+            }
+        }
+
+        // reset partition specific counter
+        num_items_ -= items_per_partition_[partition_id];
+        items_per_partition_[partition_id] = 0;
+        assert(num_items_ == this->num_items_calc());
+
+        LOG << "Spilled items of partition with id: " << partition_id;
+    }
+
+    //! Spill all items of an arbitrary partition into an external memory File.
+    void SpillAnyPartition() {
+        return SpillLargestPartition();
+    }
+
+    //! Spill all items of the largest partition into an external memory File.
+    void SpillLargestPartition() {
+        // get partition with max size
+        size_t size_max = 0, index = 0;
+
+        for (size_t i = 0; i < num_partitions_; ++i)
+        {
+            if (items_per_partition_[i] > size_max)
+            {
+                size_max = items_per_partition_[i];
+                index = i;
+            }
+        }
+
+        if (size_max == 0) {
+            return;
+        }
+
+        return SpillPartition(index);
+    }
+
+    //! \}
+
+    //! \name Flushing Mechanisms to Next Stage or Phase
+    //! \{
+
+    template <typename Emit>
+    void FlushPartitionEmit(
+        size_t partition_id, bool consume, bool /* grow */, Emit emit) {
+
+        LOG << "Flushing " << items_per_partition_[partition_id]
+            << " items of partition: " << partition_id;
+
+        size_t offset = partition_id * num_buckets_per_partition_;
+        TableItem* pitems = items_ + offset;
+        uint8_t* pdist = dist_ + offset;
+
+        for (size_t i = 0; i < num_buckets_per_partition_; ++i)
+        {
+            if (pdist[i] != 0) {
+                emit(partition_id, pitems[i]);
+
+                if (consume) {
+                    pitems[i].~TableItem();
+                    pdist[i] = 0;
+                }
+            }
+        }
+
+        if (consume) {
+            // reset partition specific counter
+            num_items_ -= items_per_partition_[partition_id];
+            items_per_partition_[partition_id] = 0;
+            assert(num_items_ == this->num_items_calc());
+        }
+
+        LOG << "Done flushed items of partition: " << partition_id;
+    }
+
+    void FlushPartition(size_t partition_id, bool consume, bool grow) {
+        FlushPartitionEmit(
+            partition_id, consume, grow,
+            [this](const size_t& partition_id, const TableItem& p) {
+                this->emitter_.Emit(partition_id, p);
+            });
+    }
+
+    void FlushAll() {
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            FlushPartition(i, /* consume */ true, /* grow */ false);
+        }
+    }
+
+    //! \}
+
+public:
+    using Super::calculate_index;
+    using Super::calculate_key_index;
+
+private:
+    using Super::config_;
+    using Super::immediate_flush_;
+    using Super::index_function_;
+    using Super::items_per_partition_;
+    using Super::key;
+    using Super::key_equal_function_;
+    using Super::limit_items_per_partition_;
+    using Super::limit_memory_bytes_;
+    using Super::num_buckets_;
+    using Super::num_buckets_per_partition_;
+    using Super::num_items_;
+    using Super::num_partitions_;
+    using Super::partition_files_;
+    using Super::reduce;
+
+    //! Storing the actual hash table, only occupied slots are constructed.
+    TableItem* items_ = nullptr;
+
+    //! Probe distance plus one of the items in the slots, zero if empty.
+    uint8_t* dist_ = nullptr;
+};
+
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction,
+          typename Emitter, const bool VolatileKey,
+          typename ReduceConfig, typename IndexFunction,
+          typename KeyEqualFunction>
+class ReduceTableSelect<
+        ReduceTableImpl::ROBIN_HOOD,
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>
+{
+public:
+    using type = ReduceRobinHoodHashTable<
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig,
+        IndexFunction, KeyEqualFunction>;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_ROBIN_HOOD_HASH_TABLE_HEADER
+
+/******************************************************************************/
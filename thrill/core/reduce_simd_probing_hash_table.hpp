@@ -0,0 +1,576 @@
+/*******************************************************************************
+ * thrill/core/reduce_simd_probing_hash_table.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+#define THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+
+#include <thrill/common/config.hpp>
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_table.hpp>
+
+#include <tlx/math/ffs.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#if defined(THRILL_HAVE_AVX2)
+#include <immintrin.h>
+#elif defined(THRILL_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A group of control bytes of ReduceSimdProbingHashTable, which are compared
+ * at once using AVX2 (32 bytes), SSE2 (16 bytes), or a plain loop.
+ */
+class ReduceProbingGroup
+{
+public:
+#if defined(THRILL_HAVE_AVX2)
+    //! number of control bytes compared at once
+    static constexpr size_t width = 32;
+
+    //! bit mask of the bytes in p[0,width) equal to b
+    static uint32_t Match(const uint8_t* p, uint8_t b) {
+        __m256i ctrl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(
+                                         _mm256_cmpeq_epi8(
+                                             ctrl, _mm256_set1_epi8(
+                                                 static_cast<char>(b)))));
+    }
+#elif defined(THRILL_HAVE_SSE2)
+    //! number of control bytes compared at once
+    static constexpr size_t width = 16;
+
+    //! bit mask of the bytes in p[0,width) equal to b
+    static uint32_t Match(const uint8_t* p, uint8_t b) {
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return static_cast<uint32_t>(_mm_movemask_epi8(
+                                         _mm_cmpeq_epi8(
+                                             ctrl, _mm_set1_epi8(
+                                                 static_cast<char>(b)))));
+    }
+#else
+    //! number of control bytes compared at once
+    static constexpr size_t width = 16;
+
+    //! bit mask of the bytes in p[0,width) equal to b
+    static uint32_t Match(const uint8_t* p, uint8_t b) {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < width; ++i)
+            mask |= static_cast<uint32_t>(p[i] == b) << i;
+        return mask;
+    }
+#endif
+
+    //! control byte of empty slots
+    static constexpr uint8_t empty = 0;
+
+    //! make the control byte of an occupied slot from seven bits of hash
+    static uint8_t Fingerprint(uint64_t bits) {
+        return static_cast<uint8_t>(
+            0x80 | ((bits * 0x9E3779B97F4A7C15ull) >> 57));
+    }
+
+    //! fingerprint bits of a ReduceByHash index result: the remaining hash.
+    template <typename Result>
+    static auto FingerprintBits(const Result& r, int)
+    ->decltype(r.remaining_hash, uint64_t()) {
+        return r.remaining_hash;
+    }
+
+    //! fingerprint bits of a ReduceByIndex index result: the global index.
+    template <typename Result>
+    static auto FingerprintBits(const Result& r, long)
+    ->decltype(r.global_index, uint64_t()) {
+        return r.global_index;
+    }
+};
+
+/*!
+ * A linear probing reduce table like ReduceProbingHashTable, which additionally
+ * stores a control byte per slot in an array next to the items: zero for empty
+ * slots and otherwise the high bit plus a seven bit fingerprint of the key's
+ * hash. Probing compares a whole group of control bytes at once with SIMD
+ * instructions (see ReduceProbingGroup), and keys are only compared on slots
+ * with matching fingerprints. Hence, probe misses rarely touch the items
+ * themselves.
+ *
+ * Since empty slots are determined by their control byte, this table needs no
+ * sentinel key, and Key() is an ordinary key.
+ *
+ * The table is partitioned and grows partitions in place, exactly like
+ * ReduceProbingHashTable.
+ */
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction, typename Emitter,
+          const bool VolatileKey,
+          typename ReduceConfig_,
+          typename IndexFunction,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class ReduceSimdProbingHashTable
+    : public ReduceTable<TableItem, Key, Value,
+                         KeyExtractor, ReduceFunction, Emitter,
+                         VolatileKey, ReduceConfig_,
+                         IndexFunction, KeyEqualFunction>
+{
+    using Super = ReduceTable<TableItem, Key, Value,
+                              KeyExtractor, ReduceFunction, Emitter,
+                              VolatileKey, ReduceConfig_, IndexFunction,
+                              KeyEqualFunction>;
+    using Super::debug;
+
+    using Group = ReduceProbingGroup;
+
+public:
+    using ReduceConfig = ReduceConfig_;
+
+    ReduceSimdProbingHashTable(
+        Context& ctx, size_t dia_id,
+        const KeyExtractor& key_extractor,
+        const ReduceFunction& reduce_function,
+        Emitter& emitter,
+        size_t num_partitions,
+        const ReduceConfig& config = ReduceConfig(),
+        bool immediate_flush = false,
+        const IndexFunction& index_function = IndexFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : Super(ctx, dia_id,
+                key_extractor, reduce_function, emitter,
+                num_partitions, config, immediate_flush,
+                index_function, key_equal_function)
+    { assert(num_partitions > 0); }
+
+    //! Construct the hash table itself and the control bytes, which are padded
+    //! by one group such that groups can be loaded at the end of the table.
+    void Initialize(size_t limit_memory_bytes) {
+        assert(!items_);
+
+        limit_memory_bytes_ = limit_memory_bytes;
+
+        // calculate num_buckets_per_partition_ from the memory limit and the
+        // number of partitions required, initialize partition_size_ array.
+
+        num_buckets_per_partition_ = std::max<size_t>(
+            1,
+            (size_t)(static_cast<double>(limit_memory_bytes_)
+                     / static_cast<double>(sizeof(TableItem) + 1)
+                     / static_cast<double>(num_partitions_)));
+
+        num_buckets_ = num_buckets_per_partition_ * num_partitions_;
+
+        assert(num_buckets_per_partition_ > 0);
+        assert(num_buckets_ > 0);
+
+        partition_size_.resize(
+            num_partitions_,
+            std::min(Super::initial_partition_size(),
+                     num_buckets_per_partition_));
+
+        // calculate limit on the number of items in a partition before these
+        // are spilled to disk or flushed to network.
+
+        double limit_fill_rate = config_.limit_partition_fill_rate();
+
+        assert(limit_fill_rate >= 0.0 && limit_fill_rate <= 1.0
+               && "limit_partition_fill_rate must be between 0.0 and 1.0. "
+               "with a fill rate of 0.0, items are immediately flushed.");
+
+        limit_items_per_partition_.resize(
+            num_partitions_,
+            static_cast<size_t>(
+                static_cast<double>(partition_size_[0]) * limit_fill_rate));
+
+        // actually allocate the table and the control bytes.
+
+        items_ = static_cast<TableItem*>(
+            operator new (num_buckets_ * sizeof(TableItem)));
+
+        ctrl_ = new uint8_t[num_buckets_ + Group::width];
+        std::fill(ctrl_, ctrl_ + num_buckets_ + Group::width,
+                  uint8_t(Group::empty));
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            TableItem* iter = items_ + id * num_buckets_per_partition_;
+            TableItem* pend = iter + partition_size_[id];
+
+            for ( ; iter != pend; ++iter)
+                new (iter)TableItem();
+        }
+    }
+
+    ~ReduceSimdProbingHashTable() {
+        if (items_) Dispose();
+    }
+
+    /*!
+     * Inserts a value into the table, potentially reducing it in case both the
+     * key of the value already in the table and the key of the value to be
+     * inserted are the same.
+     *
+     * An insert may trigger a resize of the partition, or a spill or flush of
+     * it if it cannot grow further.
+     *
+     * \param kv Value to be inserted into the table.
+     *
+     * \return true if a new key was inserted to the table
+     */
+    bool Insert(const TableItem& kv) {
+
+        // extract the key once for the index and all comparisons
+        const Key& k = key(kv);
+
+        typename IndexFunction::Result h = calculate_key_index(k);
+        assert(h.partition_id < num_partitions_);
+
+        const size_t psize = partition_size_[h.partition_id];
+        TableItem* pitems = items_ + h.partition_id * num_buckets_per_partition_;
+        uint8_t* pctrl = ctrl_ + h.partition_id * num_buckets_per_partition_;
+
+        const uint8_t fp = Group::Fingerprint(Group::FingerprintBits(h, 0));
+
+        size_t pos = h.local_index(psize);
+        size_t probed = 0;
+
+        while (probed < psize)
+        {
+            // mask out control bytes beyond the partition's current size
+            size_t n = std::min(size_t(Group::width), psize - pos);
+            uint32_t valid =
+                n == 32 ? ~uint32_t(0) : ((uint32_t(1) << n) - 1);
+
+            uint32_t match = Group::Match(pctrl + pos, fp) & valid;
+            while (match) {
+                size_t i = pos + tlx::ffs(match) - 1;
+                if (key_equal_function_(key(pitems[i]), k)) {
+                    pitems[i] = reduce(pitems[i], kv);
+                    return false;
+                }
+                match &= match - 1;
+            }
+
+            uint32_t empty = Group::Match(pctrl + pos, Group::empty) & valid;
+            if (empty) {
+                size_t i = pos + tlx::ffs(empty) - 1;
+
+                // insert new pair
+                pitems[i] = kv;
+                pctrl[i] = fp;
+
+                // increase counter for partition
+                ++items_per_partition_[h.partition_id];
+                ++num_items_;
+
+                while (TLX_UNLIKELY(
+                           items_per_partition_[h.partition_id] >=
+                           limit_items_per_partition_[h.partition_id])) {
+                    LOG << "Grow due to "
+                        << items_per_partition_[h.partition_id] << " >= "
+                        << limit_items_per_partition_[h.partition_id]
+                        << " among " << partition_size_[h.partition_id];
+                    GrowAndRehash(h.partition_id);
+                }
+
+                return true;
+            }
+
+            probed += n;
+            pos += n;
+
+            // wrap around if beyond the current partition
+            if (pos == psize) pos = 0;
+        }
+
+        // flush partition and retry, if all slots are reserved
+        GrowAndRehash(h.partition_id);
+        return Insert(kv);
+    }
+
+    //! Deallocate items and memory
+    void Dispose() {
+        if (!items_) return;
+
+        // dispose the items by destructor
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            TableItem* iter = items_ + id * num_buckets_per_partition_;
+            TableItem* pend = iter + partition_size_[id];
+
+            for ( ; iter != pend; ++iter)
+                iter->~TableItem();
+        }
+
+        operator delete (items_);
+        items_ = nullptr;
+
+        delete[] ctrl_;
+        ctrl_ = nullptr;
+
+        Super::Dispose();
+    }
+
+    void GrowAndRehash(size_t partition_id) {
+
+        size_t old_size = partition_size_[partition_id];
+        GrowPartition(partition_id);
+        if (partition_size_[partition_id] == old_size) {
+            SpillPartition(partition_id);
+            return;
+        }
+
+        if (partition_size_[partition_id] % old_size != 0) {
+            // in place rehashing won't work properly so we spill rather than
+            // potentially blasting memory limits by using an extra vector for
+            // temporary item storage
+            SpillPartition(partition_id);
+            return;
+        }
+
+        // reinsert items in the old range until passed it and found a hole in
+        // the second half. Same as ReduceProbingHashTable::GrowAndRehash().
+        size_t offset = partition_id * num_buckets_per_partition_;
+        TableItem* pitems = items_ + offset;
+        uint8_t* pctrl = ctrl_ + offset;
+
+        bool passed_first_half = false;
+        bool found_hole = false;
+        for (size_t i = 0; !passed_first_half || !found_hole; ++i) {
+            bool is_empty = (pctrl[i] == Group::empty);
+            if (!is_empty) {
+                --items_per_partition_[partition_id];
+                --num_items_;
+                TableItem item = std::move(pitems[i]);
+                new (pitems + i)TableItem();
+                pctrl[i] = Group::empty;
+                Insert(item);
+            }
+
+            found_hole = passed_first_half && is_empty;
+            passed_first_half = passed_first_half || i + 1 == old_size;
+        }
+    }
+
+    //! Grow a partition after a spill or flush (if possible)
+    void GrowPartition(size_t partition_id) {
+
+        if (TLX_UNLIKELY(mem::memory_exceeded)) {
+            SpillPartition(partition_id);
+            return;
+        }
+
+        if (partition_size_[partition_id] == num_buckets_per_partition_)
+            return;
+
+        size_t new_size = std::min(
+            num_buckets_per_partition_, 2 * partition_size_[partition_id]);
+
+        sLOG << "Growing partition" << partition_id
+             << "from" << partition_size_[partition_id] << "to" << new_size
+             << "limit_items" << new_size * config_.limit_partition_fill_rate();
+
+        // initialize new items, their control bytes are already empty.
+
+        TableItem* pbegin =
+            items_ + partition_id * num_buckets_per_partition_;
+        TableItem* iter = pbegin + partition_size_[partition_id];
+        TableItem* pend = pbegin + new_size;
+
+        for ( ; iter != pend; ++iter)
+            new (iter)TableItem();
+
+        partition_size_[partition_id] = new_size;
+        limit_items_per_partition_[partition_id]
+            = new_size * config_.limit_partition_fill_rate();
+    }
+
+    //! \name Spilling Mechanisms to External Memory Files
+    //! \{
+
+    //! Spill all items of a partition into an external memory File.
+    void SpillPartition(size_t partition_id) {
+
+        if (immediate_flush_) {
+            return FlushPartition(
+                partition_id, /* consume */ true, /* grow */ !mem::memory_exceeded);
+        }
+
+        LOG << "Spilling " << items_per_partition_[partition_id]
+            << " items of partition with id: " << partition_id;
+
+        if (items_per_partition_[partition_id] == 0)
+            return;
+
+        data::File::Writer writer = partition_files_[partition_id].GetWriter();
+
+        size_t offset = partition_id * num_buckets_per_partition_;
+        TableItem* pitems = items_ + offset;
+        uint8_t* pctrl = ctrl_ + offset;
+
+        for (size_t i = 0; i < partition_size_[partition_id]; ++i) {
+            if (pctrl[i] != Group::empty) {
+                writer.Put(pitems[i]);
+                pitems[i] = TableItem();
+                pctrl[i] = Group::empty;
+            }
+        }
+
+        // reset partition specific counter
+        num_items_ -= items_per_partition_[partition_id];
+        items_per_partition_[partition_id] = 0;
+        assert(num_items_ == this->num_items_calc());
+
+        LOG << "Spilled items of partition with id: " << partition_id;
+    }
+
+    //! Spill all items of an arbitrary partition into an external memory File.
+    void SpillAnyPartition() {
+        return SpillLargestPartition();
+    }
+
+    //! Spill all items of the largest partition into an external memory File.
+    void SpillLargestPartition() {
+        // get partition with max size
+        size_t size_max = 0, index = 0;
+
+        for (size_t i = 0; i < num_partitions_; ++i)
+        {
+            if (items_per_partition_[i] > size_max)
+            {
+                size_max = items_per_partition_[i];
+                index = i;
+            }
+        }
+
+        if (size_max == 0) {
+            return;
+        }
+
+        return SpillPartition(index);
+    }
+
+    //! \}
+
+    //! \name Flushing Mechanisms to Next Stage or Phase
+    //! \{
+
+    template <typename Emit>
+    void FlushPartitionEmit(
+        size_t partition_id, bool consume, bool grow, Emit emit) {
+
+        LOG << "Flushing " << items_per_partition_[partition_id]
+            << " items of partition: " << partition_id;
+
+        size_t offset = partition_id * num_buckets_per_partition_;
+        TableItem* pitems = items_ + offset;
+        uint8_t* pctrl = ctrl_ + offset;
+
+        for (size_t i = 0; i < partition_size_[partition_id]; ++i)
+        {
+            if (pctrl[i] != Group::empty) {
+                emit(partition_id, pitems[i]);
+
+                if (consume) {
+                    pitems[i] = TableItem();
+                    pctrl[i] = Group::empty;
+                }
+            }
+        }
+
+        if (consume) {
+            // reset partition specific counter
+            num_items_ -= items_per_partition_[partition_id];
+            items_per_partition_[partition_id] = 0;
+            assert(num_items_ == this->num_items_calc());
+        }
+
+        LOG << "Done flushed items of partition: " << partition_id;
+
+        if (grow)
+            GrowPartition(partition_id);
+    }
+
+    void FlushPartition(size_t partition_id, bool consume, bool grow) {
+        FlushPartitionEmit(
+            partition_id, consume, grow,
+            [this](const size_t& partition_id, const TableItem& p) {
+                this->emitter_.Emit(partition_id, p);
+            });
+    }
+
+    void FlushAll() {
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            FlushPartition(i, /* consume */ true, /* grow */ false);
+        }
+    }
+
+    //! \}
+
+public:
+    using Super::calculate_index;
+    using Super::calculate_key_index;
+
+private:
+    using Super::config_;
+    using Super::immediate_flush_;
+    using Super::index_function_;
+    using Super::items_per_partition_;
+    using Super::key;
+    using Super::key_equal_function_;
+    using Super::limit_memory_bytes_;
+    using Super::num_buckets_;
+    using Super::num_buckets_per_partition_;
+    using Super::num_items_;
+    using Super::num_partitions_;
+    using Super::partition_files_;
+    using Super::reduce;
+
+    //! Storing the actual hash table.
+    TableItem* items_ = nullptr;
+
+    //! Control bytes of the slots: empty or fingerprint of the item's hash.
+    uint8_t* ctrl_ = nullptr;
+
+    //! Current sizes of the partitions because the valid allocated areas grow
+    std::vector<size_t> partition_size_;
+
+    //! Current limits on the number of items in a partitions, different for
+    //! different partitions, because the valid allocated areas grow.
+    std::vector<size_t> limit_items_per_partition_;
+};
+
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction,
+          typename Emitter, const bool VolatileKey,
+          typename ReduceConfig, typename IndexFunction,
+          typename KeyEqualFunction>
+class ReduceTableSelect<
+        ReduceTableImpl::SIMD_PROBING,
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>
+{
+public:
+    using type = ReduceSimdProbingHashTable<
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig,
+        IndexFunction, KeyEqualFunction>;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+
+/******************************************************************************/
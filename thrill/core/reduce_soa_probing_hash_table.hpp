@@ -0,0 +1,671 @@
+/*******************************************************************************
+ * thrill/core/reduce_soa_probing_hash_table.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_SOA_PROBING_HASH_TABLE_HEADER
+#define THRILL_CORE_REDUCE_SOA_PROBING_HASH_TABLE_HEADER
+
+#include <thrill/common/functional.hpp>
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_table.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * The slot type stored in the value array of ReduceSoaProbingHashTable: the
+ * value of a std::pair<Key, Value> for VolatileKey, otherwise the whole item,
+ * from which the key is extracted.
+ */
+template <typename TableItem, bool VolatileKey>
+class ReduceSoaSlot
+{
+public:
+    using type = TableItem;
+
+    static const type& Value(const TableItem& t) { return t; }
+
+    template <typename Key>
+    static const TableItem& Item(const Key& /* k */, const type& v) {
+        return v;
+    }
+};
+
+template <typename TableItem>
+class ReduceSoaSlot<TableItem, /* VolatileKey */ true>
+{
+public:
+    using type = typename TableItem::second_type;
+
+    static const type& Value(const TableItem& t) { return t.second; }
+
+    template <typename Key>
+    static TableItem Item(const Key& k, const type& v) {
+        return TableItem(k, v);
+    }
+};
+
+/*!
+ * Element-wise accumulation of arithmetic types with a plain std::plus,
+ * common::minimum, or common::maximum operation. The primary template marks
+ * all other operations as not native.
+ */
+template <typename Operation, typename Type>
+class ReduceSoaNativeOp
+{
+public:
+    static constexpr bool native = false;
+};
+
+template <typename Type>
+class ReduceSoaNativeOp<std::plus<Type>, Type>
+{
+public:
+    static constexpr bool native = std::is_arithmetic<Type>::value;
+    static void Apply(Type& a, const Type& b) { a += b; }
+};
+
+template <typename Type>
+class ReduceSoaNativeOp<std::plus<>, Type>
+{
+public:
+    static constexpr bool native = std::is_arithmetic<Type>::value;
+    static void Apply(Type& a, const Type& b) { a += b; }
+};
+
+template <typename Type>
+class ReduceSoaNativeOp<common::minimum<Type>, Type>
+{
+public:
+    static constexpr bool native = std::is_arithmetic<Type>::value;
+    static void Apply(Type& a, const Type& b) { a = b < a ? b : a; }
+};
+
+template <typename Type>
+class ReduceSoaNativeOp<common::maximum<Type>, Type>
+{
+public:
+    static constexpr bool native = std::is_arithmetic<Type>::value;
+    static void Apply(Type& a, const Type& b) { a = a < b ? b : a; }
+};
+
+//! Component-wise sums, minima, or maxima of std::arrays of arithmetic types.
+template <typename Type, size_t N, typename Operation>
+class ReduceSoaNativeOp<
+        common::ComponentSum<std::array<Type, N>, Operation>,
+        std::array<Type, N> >
+{
+public:
+    static constexpr bool native = ReduceSoaNativeOp<Operation, Type>::native;
+    static void Apply(std::array<Type, N>& a, const std::array<Type, N>& b) {
+        for (size_t i = 0; i < N; ++i)
+            ReduceSoaNativeOp<Operation, Type>::Apply(a[i], b[i]);
+    }
+};
+
+/*!
+ * Accumulates a slot of ReduceSoaProbingHashTable in place. Plain sums, minima
+ * and maxima of arithmetic values, and common::ComponentSum of std::arrays of
+ * them, are applied directly on the value array. The fixed-length loop over a
+ * std::array is vectorized by the compiler, e.g. for rollups of counter
+ * vectors. All other reduce functions are called and their result is assigned
+ * to the slot.
+ */
+template <typename ReduceFunction, typename Slot,
+          bool Native = ReduceSoaNativeOp<ReduceFunction, Slot>::native>
+class ReduceSoaAccumulate
+{
+public:
+    static constexpr bool native = false;
+
+    static void Apply(ReduceFunction& reduce_function,
+                      Slot& a, const Slot& b) {
+        a = reduce_function(a, b);
+    }
+};
+
+template <typename ReduceFunction, typename Slot>
+class ReduceSoaAccumulate<ReduceFunction, Slot, /* Native */ true>
+{
+public:
+    static constexpr bool native = true;
+
+    static void Apply(ReduceFunction& /* reduce_function */,
+                      Slot& a, const Slot& b) {
+        ReduceSoaNativeOp<ReduceFunction, Slot>::Apply(a, b);
+    }
+};
+
+/*!
+ * A linear probing reduce table like ReduceProbingHashTable, which stores the
+ * keys and the values in two separate arrays (structure of arrays). Probing
+ * therefore only touches the compact key array, and never calls the key
+ * extractor on items already in the table. Hits are accumulated in place in the
+ * value array, see ReduceSoaAccumulate, which avoids constructing a new item
+ * per reduction for plain sum, minimum, and maximum reduce functions.
+ *
+ * This table is targeted at ReduceByKey() with small fixed-size numeric values,
+ * such as (key, counter) pairs, where the per-item overhead of the general
+ * tables dominates. The key Key() is the sentinel for empty slots, and
+ * reduced into one extra slot at the end, like in ReduceProbingHashTable.
+ * Partitions are grown in place in the same way.
+ */
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction, typename Emitter,
+          const bool VolatileKey,
+          typename ReduceConfig_,
+          typename IndexFunction,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class ReduceSoaProbingHashTable
+    : public ReduceTable<TableItem, Key, Value,
+                         KeyExtractor, ReduceFunction, Emitter,
+                         VolatileKey, ReduceConfig_,
+                         IndexFunction, KeyEqualFunction>
+{
+    using Super = ReduceTable<TableItem, Key, Value,
+                              KeyExtractor, ReduceFunction, Emitter,
+                              VolatileKey, ReduceConfig_, IndexFunction,
+                              KeyEqualFunction>;
+    using Super::debug;
+
+    using SoaSlot = ReduceSoaSlot<TableItem, VolatileKey>;
+    using Slot = typename SoaSlot::type;
+    using Accumulate = ReduceSoaAccumulate<ReduceFunction, Slot>;
+
+public:
+    using ReduceConfig = ReduceConfig_;
+
+    //! whether hits are accumulated without calling the reduce function
+    static constexpr bool native_accumulate = Accumulate::native;
+
+    ReduceSoaProbingHashTable(
+        Context& ctx, size_t dia_id,
+        const KeyExtractor& key_extractor,
+        const ReduceFunction& reduce_function,
+        Emitter& emitter,
+        size_t num_partitions,
+        const ReduceConfig& config = ReduceConfig(),
+        bool immediate_flush = false,
+        const IndexFunction& index_function = IndexFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : Super(ctx, dia_id,
+                key_extractor, reduce_function, emitter,
+                num_partitions, config, immediate_flush,
+                index_function, key_equal_function)
+    { assert(num_partitions > 0); }
+
+    //! Construct the key and value arrays. fill the keys with sentinels. have
+    //! one extra cell beyond the end for reducing the sentinel itself.
+    void Initialize(size_t limit_memory_bytes) {
+        assert(!keys_);
+
+        limit_memory_bytes_ = limit_memory_bytes;
+
+        // calculate num_buckets_per_partition_ from the memory limit and the
+        // number of partitions required, initialize partition_size_ array.
+
+        num_buckets_per_partition_ = std::max<size_t>(
+            1,
+            (size_t)(static_cast<double>(limit_memory_bytes_)
+                     / static_cast<double>(sizeof(Key) + sizeof(Slot))
+                     / static_cast<double>(num_partitions_)));
+
+        num_buckets_ = num_buckets_per_partition_ * num_partitions_;
+
+        assert(num_buckets_per_partition_ > 0);
+        assert(num_buckets_ > 0);
+
+        partition_size_.resize(
+            num_partitions_,
+            std::min(Super::initial_partition_size(),
+                     num_buckets_per_partition_));
+
+        // calculate limit on the number of items in a partition before these
+        // are spilled to disk or flushed to network.
+
+        double limit_fill_rate = config_.limit_partition_fill_rate();
+
+        assert(limit_fill_rate >= 0.0 && limit_fill_rate <= 1.0
+               && "limit_partition_fill_rate must be between 0.0 and 1.0. "
+               "with a fill rate of 0.0, items are immediately flushed.");
+
+        limit_items_per_partition_.resize(
+            num_partitions_,
+            static_cast<size_t>(
+                static_cast<double>(partition_size_[0]) * limit_fill_rate));
+
+        // actually allocate the arrays and initialize the valid ranges, the
+        // + 1 is for the sentinel's slot.
+
+        keys_ = static_cast<Key*>(
+            operator new ((num_buckets_ + 1) * sizeof(Key)));
+        values_ = static_cast<Slot*>(
+            operator new ((num_buckets_ + 1) * sizeof(Slot)));
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            size_t offset = id * num_buckets_per_partition_;
+            ConstructRange(offset, offset + partition_size_[id]);
+        }
+    }
+
+    ~ReduceSoaProbingHashTable() {
+        if (keys_) Dispose();
+    }
+
+    /*!
+     * Inserts a value into the table, potentially reducing it in case both the
+     * key of the value already in the table and the key of the value to be
+     * inserted are the same.
+     *
+     * An insert may trigger a resize of the partition, or a spill or flush of
+     * it if it cannot grow further.
+     *
+     * \param kv Value to be inserted into the table.
+     *
+     * \return true if a new key was inserted to the table
+     */
+    bool Insert(const TableItem& kv) {
+
+        // extract the key once for the index and all comparisons
+        const Key& k = key(kv);
+
+        typename IndexFunction::Result h = calculate_key_index(k);
+        assert(h.partition_id < num_partitions_);
+
+        if (TLX_UNLIKELY(key_equal_function_(k, Key()))) {
+            // handle pairs with sentinel key specially by reducing into the
+            // last slot.
+            if (sentinel_partition_ == invalid_partition_) {
+                // first occurrence of sentinel key
+                new (keys_ + num_buckets_)Key(k);
+                new (values_ + num_buckets_)Slot(SoaSlot::Value(kv));
+                sentinel_partition_ = h.partition_id;
+            }
+            else {
+                Accumulate::Apply(reduce_function_, values_[num_buckets_],
+                                  SoaSlot::Value(kv));
+                return false;
+            }
+            ++items_per_partition_[h.partition_id];
+            ++num_items_;
+
+            while (TLX_UNLIKELY(
+                       items_per_partition_[h.partition_id] >
+                       limit_items_per_partition_[h.partition_id])) {
+                GrowAndRehash(h.partition_id);
+            }
+
+            return true;
+        }
+
+        const size_t offset = h.partition_id * num_buckets_per_partition_;
+        const size_t psize = partition_size_[h.partition_id];
+        Key* pkeys = keys_ + offset;
+
+        // calculate local index depending on the current subtable's size
+        const size_t begin = h.local_index(psize);
+        size_t i = begin;
+
+        while (!key_equal_function_(pkeys[i], Key()))
+        {
+            if (key_equal_function_(pkeys[i], k))
+            {
+                Accumulate::Apply(reduce_function_, values_[offset + i],
+                                  SoaSlot::Value(kv));
+                return false;
+            }
+
+            ++i;
+
+            // wrap around if beyond the current partition
+            if (TLX_UNLIKELY(i == psize))
+                i = 0;
+
+            // flush partition and retry, if all slots are reserved
+            if (TLX_UNLIKELY(i == begin)) {
+                GrowAndRehash(h.partition_id);
+                return Insert(kv);
+            }
+        }
+
+        // insert new pair
+        pkeys[i] = k;
+        values_[offset + i] = SoaSlot::Value(kv);
+
+        // increase counter for partition
+        ++items_per_partition_[h.partition_id];
+        ++num_items_;
+
+        while (TLX_UNLIKELY(
+                   items_per_partition_[h.partition_id] >=
+                   limit_items_per_partition_[h.partition_id])) {
+            LOG << "Grow due to "
+                << items_per_partition_[h.partition_id] << " >= "
+                << limit_items_per_partition_[h.partition_id]
+                << " among " << partition_size_[h.partition_id];
+            GrowAndRehash(h.partition_id);
+        }
+
+        return true;
+    }
+
+    //! Deallocate items and memory
+    void Dispose() {
+        if (!keys_) return;
+
+        // dispose the keys and values by destructor
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            size_t offset = id * num_buckets_per_partition_;
+            DestroyRange(offset, offset + partition_size_[id]);
+        }
+
+        if (sentinel_partition_ != invalid_partition_) {
+            DestroyRange(num_buckets_, num_buckets_ + 1);
+            sentinel_partition_ = invalid_partition_;
+        }
+
+        operator delete (keys_);
+        keys_ = nullptr;
+        operator delete (values_);
+        values_ = nullptr;
+
+        Super::Dispose();
+    }
+
+    void GrowAndRehash(size_t partition_id) {
+
+        size_t old_size = partition_size_[partition_id];
+        GrowPartition(partition_id);
+        if (partition_size_[partition_id] == old_size) {
+            SpillPartition(partition_id);
+            return;
+        }
+
+        if (partition_size_[partition_id] % old_size != 0) {
+            // in place rehashing won't work properly so we spill rather than
+            // potentially blasting memory limits by using an extra vector for
+            // temporary item storage
+            SpillPartition(partition_id);
+            return;
+        }
+
+        // reinsert items in the old range until passed it and found a hole in
+        // the second half. Same as ReduceProbingHashTable::GrowAndRehash().
+        size_t offset = partition_id * num_buckets_per_partition_;
+
+        bool passed_first_half = false;
+        bool found_hole = false;
+        for (size_t i = offset; !passed_first_half || !found_hole; ++i) {
+            bool is_empty = key_equal_function_(keys_[i], Key());
+            if (!is_empty) {
+                --items_per_partition_[partition_id];
+                --num_items_;
+                TableItem item = SoaSlot::Item(keys_[i], values_[i]);
+                keys_[i] = Key();
+                values_[i] = Slot();
+                Insert(item);
+            }
+
+            found_hole = passed_first_half && is_empty;
+            passed_first_half = passed_first_half || i + 1 == offset + old_size;
+        }
+    }
+
+    //! Grow a partition after a spill or flush (if possible)
+    void GrowPartition(size_t partition_id) {
+
+        if (TLX_UNLIKELY(mem::memory_exceeded)) {
+            SpillPartition(partition_id);
+            return;
+        }
+
+        if (partition_size_[partition_id] == num_buckets_per_partition_)
+            return;
+
+        size_t new_size = std::min(
+            num_buckets_per_partition_, 2 * partition_size_[partition_id]);
+
+        sLOG << "Growing partition" << partition_id
+             << "from" << partition_size_[partition_id] << "to" << new_size
+             << "limit_items" << new_size * config_.limit_partition_fill_rate();
+
+        // initialize new keys and values
+
+        size_t offset = partition_id * num_buckets_per_partition_;
+        ConstructRange(offset + partition_size_[partition_id],
+                       offset + new_size);
+
+        partition_size_[partition_id] = new_size;
+        limit_items_per_partition_[partition_id]
+            = new_size * config_.limit_partition_fill_rate();
+    }
+
+    //! \name Spilling Mechanisms to External Memory Files
+    //! \{
+
+    //! Spill all items of a partition into an external memory File.
+    void SpillPartition(size_t partition_id) {
+
+        if (immediate_flush_) {
+            return FlushPartition(
+                partition_id, /* consume */ true, /* grow */ !mem::memory_exceeded);
+        }
+
+        LOG << "Spilling " << items_per_partition_[partition_id]
+            << " items of partition with id: " << partition_id;
+
+        if (items_per_partition_[partition_id] == 0)
+            return;
+
+        data::File::Writer writer = partition_files_[partition_id].GetWriter();
+
+        if (sentinel_partition_ == partition_id) {
+            writer.Put(
+                SoaSlot::Item(keys_[num_buckets_], values_[num_buckets_]));
+            DestroyRange(num_buckets_, num_buckets_ + 1);
+            sentinel_partition_ = invalid_partition_;
+        }
+
+        size_t i = partition_id * num_buckets_per_partition_;
+        size_t end = i + partition_size_[partition_id];
+
+        for ( ; i != end; ++i) {
+            if (!key_equal_function_(keys_[i], Key())) {
+                writer.Put(SoaSlot::Item(keys_[i], values_[i]));
+                keys_[i] = Key();
+                values_[i] = Slot();
+            }
+        }
+
+        // reset partition specific counter
+        num_items_ -= items_per_partition_[partition_id];
+        items_per_partition_[partition_id] = 0;
+        assert(num_items_ == this->num_items_calc());
+
+        LOG << "Spilled items of partition with id: " << partition_id;
+    }
+
+    //! Spill all items of an arbitrary partition into an external memory File.
+    void SpillAnyPartition() {
+        return SpillLargestPartition();
+    }
+
+    //! Spill all items of the largest partition into an external memory File.
+    void SpillLargestPartition() {
+        // get partition with max size
+        size_t size_max = 0, index = 0;
+
+        for (size_t i = 0; i < num_partitions_; ++i)
+        {
+            if (items_per_partition_[i] > size_max)
+            {
+                size_max = items_per_partition_[i];
+                index = i;
+            }
+        }
+
+        if (size_max == 0) {
+            return;
+        }
+
+        return SpillPartition(index);
+    }
+
+    //! \}
+
+    //! \name Flushing Mechanisms to Next Stage or Phase
+    //! \{
+
+    template <typename Emit>
+    void FlushPartitionEmit(
+        size_t partition_id, bool consume, bool grow, Emit emit) {
+
+        LOG << "Flushing " << items_per_partition_[partition_id]
+            << " items of partition: " << partition_id;
+
+        if (sentinel_partition_ == partition_id) {
+            emit(partition_id,
+                 SoaSlot::Item(keys_[num_buckets_], values_[num_buckets_]));
+            if (consume) {
+                DestroyRange(num_buckets_, num_buckets_ + 1);
+                sentinel_partition_ = invalid_partition_;
+            }
+        }
+
+        size_t i = partition_id * num_buckets_per_partition_;
+        size_t end = i + partition_size_[partition_id];
+
+        for ( ; i != end; ++i)
+        {
+            if (!key_equal_function_(keys_[i], Key())) {
+                emit(partition_id, SoaSlot::Item(keys_[i], values_[i]));
+
+                if (consume) {
+                    keys_[i] = Key();
+                    values_[i] = Slot();
+                }
+            }
+        }
+
+        if (consume) {
+            // reset partition specific counter
+            num_items_ -= items_per_partition_[partition_id];
+            items_per_partition_[partition_id] = 0;
+            assert(num_items_ == this->num_items_calc());
+        }
+
+        LOG << "Done flushed items of partition: " << partition_id;
+
+        if (grow)
+            GrowPartition(partition_id);
+    }
+
+    void FlushPartition(size_t partition_id, bool consume, bool grow) {
+        FlushPartitionEmit(
+            partition_id, consume, grow,
+            [this](const size_t& partition_id, const TableItem& p) {
+                this->emitter_.Emit(partition_id, p);
+            });
+    }
+
+    void FlushAll() {
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            FlushPartition(i, /* consume */ true, /* grow */ false);
+        }
+    }
+
+    //! \}
+
+public:
+    using Super::calculate_index;
+    using Super::calculate_key_index;
+
+private:
+    using Super::config_;
+    using Super::immediate_flush_;
+    using Super::index_function_;
+    using Super::items_per_partition_;
+    using Super::key;
+    using Super::key_equal_function_;
+    using Super::limit_memory_bytes_;
+    using Super::num_buckets_;
+    using Super::num_buckets_per_partition_;
+    using Super::num_items_;
+    using Super::num_partitions_;
+    using Super::partition_files_;
+    using Super::reduce_function_;
+
+    //! default construct the keys and values of slots [begin,end)
+    void ConstructRange(size_t begin, size_t end) {
+        for (size_t i = begin; i != end; ++i) {
+            new (keys_ + i)Key();
+            new (values_ + i)Slot();
+        }
+    }
+
+    //! destruct the keys and values of slots [begin,end)
+    void DestroyRange(size_t begin, size_t end) {
+        for (size_t i = begin; i != end; ++i) {
+            keys_[i].~Key();
+            values_[i].~Slot();
+        }
+    }
+
+    //! Storing the keys of the table, empty slots contain Key().
+    Key* keys_ = nullptr;
+
+    //! Storing the values of the table, in the same slots as the keys.
+    Slot* values_ = nullptr;
+
+    //! Current sizes of the partitions because the valid allocated areas grow
+    std::vector<size_t> partition_size_;
+
+    //! Current limits on the number of items in a partitions, different for
+    //! different partitions, because the valid allocated areas grow.
+    std::vector<size_t> limit_items_per_partition_;
+
+    //! sentinel for invalid partition or no sentinel.
+    static constexpr size_t invalid_partition_ = size_t(-1);
+
+    //! store the partition id of the sentinel key. implicitly this also stored
+    //! whether the sentinel key was found and reduced into the slot
+    //! num_buckets_.
+    size_t sentinel_partition_ = invalid_partition_;
+};
+
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction,
+          typename Emitter, const bool VolatileKey,
+          typename ReduceConfig, typename IndexFunction,
+          typename KeyEqualFunction>
+class ReduceTableSelect<
+        ReduceTableImpl::SOA_PROBING,
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>
+{
+public:
+    using type = ReduceSoaProbingHashTable<
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig,
+        IndexFunction, KeyEqualFunction>;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_SOA_PROBING_HASH_TABLE_HEADER
+
+/******************************************************************************/
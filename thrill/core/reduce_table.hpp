@@ -29,7 +29,7 @@ namespace core {
 
 //! Enum class to select a hash table implementation.
 enum class ReduceTableImpl {
-    PROBING, OLD_PROBING, BUCKET
+    PROBING, OLD_PROBING, BUCKET, SIMD_PROBING, ROBIN_HOOD, DENSE, SOA_PROBING
 };
 
 /*!
@@ -41,13 +41,40 @@ class DefaultReduceConfig
 {
 public:
     //! limit on the fill rate of a reduce table partition prior to triggering a
-    //! flush.
+    //! flush. ROBIN_HOOD tables run well up to about 0.9.
     double limit_partition_fill_rate_ = 0.5;
 
     //! only for BucketHashTable: ratio of number of buckets in a partition
     //! relative to the maximum possible number.
     double bucket_rate_ = 0.6;
 
+    //! only for ReducePrePhase: number of items at the beginning on which the
+    //! reduction rate of the table is sampled. Zero disables adaptive bypass.
+    size_t bypass_sample_items_ = 65536;
+
+    //! only for ReducePrePhase: if less than this fraction of the sampled items
+    //! were reduced into existing keys, the pre phase bypasses the table and
+    //! emits further items directly to their partitions.
+    double bypass_reduction_threshold_ = 0.05;
+
+    //! expected number of distinct keys in a table, e.g. the HyperLogLog
+    //! estimate of a previous run, or zero if unknown. Growing partitions of
+    //! probing tables start large enough for these keys, and if they fit into
+    //! its table, the ReducePrePhase pre-reduces without sampling for bypass.
+    size_t estimated_keys_ = 0;
+
+    //! only for ReducePrePhase: piggy-back a HyperLogLog estimate of the number
+    //! of distinct keys on the inserts, which is logged after the pre phase and
+    //! can be fed back into estimated_keys_ of later runs.
+    bool estimate_keys_ = false;
+
+    //! only for ReducePrePhase with integral keys: hint that most keys lie in
+    //! [0, key_domain_size_), e.g. hours of the week or country ids. If the
+    //! items of the whole domain take at most half of the phase's memory, the
+    //! pre phase reduces them in a flat array indexed by key, and only other
+    //! keys in the hash table. Zero disables the array.
+    size_t key_domain_size_ = 0;
+
     //! select the hash table in the reduce phase by enum
     static constexpr ReduceTableImpl table_impl_ = ReduceTableImpl::PROBING;
 
@@ -66,6 +93,16 @@ public:
     //! the pre and post phases simultaneously.
     static constexpr bool use_post_thread_ = true;
 
+    //! only for ReduceByHashPostPhase: re-reduce spilled partitions in
+    //! parallel on cores borrowed from idle local workers. This requires the
+    //! KeyExtractor and ReduceFunction to be callable from multiple threads.
+    static constexpr bool use_parallel_post_phase_ = true;
+
+    //! only for ReducePair with std::plus of numbers and integral keys:
+    //! pre-aggregate batches of pairs on an accelerator device, if one is
+    //! available, before inserting them into the pre phase table.
+    static constexpr bool use_accelerator_ = false;
+
     //! \name Accessors
     //! \{
 
@@ -76,6 +113,22 @@ public:
     //! Returns bucket_rate_
     double bucket_rate() const { return bucket_rate_; }
 
+    //! Returns bypass_sample_items_
+    size_t bypass_sample_items() const { return bypass_sample_items_; }
+
+    //! Returns bypass_reduction_threshold_
+    double bypass_reduction_threshold() const
+    { return bypass_reduction_threshold_; }
+
+    //! Returns estimated_keys_
+    size_t estimated_keys() const { return estimated_keys_; }
+
+    //! Returns estimate_keys_
+    bool estimate_keys() const { return estimate_keys_; }
+
+    //! Returns key_domain_size_
+    size_t key_domain_size() const { return key_domain_size_; }
+
     //! \}
 };
 
@@ -88,6 +141,15 @@ class DefaultReduceConfigSelect : public DefaultReduceConfig
 public:
     //! select the hash table in the reduce phase by enum
     static constexpr ReduceTableImpl table_impl_ = table_impl;
+
+    DefaultReduceConfigSelect() {
+        // Robin Hood hashing bounds probe lengths at high fill rates
+        if (table_impl == ReduceTableImpl::ROBIN_HOOD)
+            limit_partition_fill_rate_ = 0.9;
+        // a dense array never fills up, hence bypassing it never pays off
+        if (table_impl == ReduceTableImpl::DENSE)
+            bypass_sample_items_ = 0;
+    }
 };
 
 /*!
@@ -129,7 +191,8 @@ public:
           num_partitions_(num_partitions),
           config_(config),
           immediate_flush_(immediate_flush),
-          items_per_partition_(num_partitions_, 0) {
+          items_per_partition_(num_partitions_, 0),
+          reclaim_(ctx.block_pool()) {
 
         assert(num_partitions > 0);
 
@@ -182,6 +245,9 @@ public:
     //! Returns emitter_
     const Emitter& emitter() const { return emitter_; }
 
+    //! Returns config_
+    const ReduceConfig& config() const { return config_; }
+
     //! Returns index_function_
     const IndexFunction& index_function() const { return index_function_; }
 
@@ -212,6 +278,21 @@ public:
     size_t limit_items_per_partition() const
     { return limit_items_per_partition_; }
 
+    //! Returns the initial number of buckets of a growing partition: either
+    //! initial_items_per_partition_ of the config, or enough buckets for an
+    //! even share of its estimated_keys_ at the fill rate limit.
+    size_t initial_partition_size() const {
+        size_t size = config_.initial_items_per_partition_;
+        double fill_rate = config_.limit_partition_fill_rate();
+        if (config_.estimated_keys() != 0 && fill_rate > 0.0) {
+            size = std::max(
+                size, static_cast<size_t>(
+                    static_cast<double>(config_.estimated_keys())
+                    / static_cast<double>(num_partitions_) / fill_rate) + 1);
+        }
+        return size;
+    }
+
     //! Returns items_per_partition_
     size_t items_per_partition(size_t id) const {
         assert(id < items_per_partition_.size());
@@ -239,6 +320,10 @@ public:
             partition_id, num_buckets_per_partition_, num_buckets_);
     }
 
+    //! Returns whether the BlockPool asked to free memory since the last call,
+    //! the phases then spill a partition early.
+    bool reclaim_requested() { return reclaim_.test_and_clear(); }
+
     //! returns whether and partition has spilled data into external memory.
     bool has_spilled_data() const {
         for (const data::File& file : partition_files_) {
@@ -256,7 +341,8 @@ public:
     //! \name Switches for VolatileKey
     //! \{
 
-    Key key(const TableItem& t) const {
+    //! key of an item, a reference to the stored key for VolatileKey
+    decltype(auto) key(const TableItem& t) const {
         return MakeTableItem::GetKey(t, key_extractor_);
     }
 
@@ -265,8 +351,13 @@ public:
     }
 
     typename IndexFunction::Result calculate_index(const TableItem& kv) const {
+        return calculate_key_index(key(kv));
+    }
+
+    //! calculate the index of a key already extracted by the caller
+    typename IndexFunction::Result calculate_key_index(const Key& k) const {
         return index_function_(
-            key(kv), num_partitions_, num_buckets_per_partition_, num_buckets_);
+            k, num_partitions_, num_buckets_per_partition_, num_buckets_);
     }
 
     //! \}
@@ -334,6 +425,9 @@ protected:
     std::vector<size_t> items_per_partition_;
 
     //! \}
+
+    //! raised by the BlockPool when RAM approaches the hard limit
+    data::ReclaimFlag reclaim_;
 };
 
 //! Type selection via ReduceTableImpl enum
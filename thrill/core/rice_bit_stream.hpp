@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * thrill/core/rice_bit_stream.hpp
+ *
+ * Encode bit stream using Rice code, the per-value form of the Elias-Fano
+ * split, into Block Reader/Writers via BitStreamWriter/BitStreamReader.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_RICE_BIT_STREAM_HEADER
+#define THRILL_CORE_RICE_BIT_STREAM_HEADER
+
+#include <thrill/core/bit_stream.hpp>
+
+#include <tlx/math/integer_log2.hpp>
+
+#include <algorithm>
+
+namespace thrill {
+namespace core {
+
+/******************************************************************************/
+// RiceBitStreamWriter
+
+/*!
+ * Rice coder for deltas: each value is split into its low_bits lowest bits,
+ * which are stored verbatim, and the remaining high part, which is stored in
+ * unary. As in Elias-Fano coding, low_bits is chosen as floor(log2(u/n)) of
+ * the expected mean delta u/n. Contrary to the GolombBitStreamWriter, the
+ * parameter is stored in the stream, such that it can be tuned to each stream,
+ * and values are decoded without the truncated binary case distinction.
+ */
+template <typename BlockWriter>
+class RiceBitStreamWriter : public BitStreamWriter<BlockWriter>
+{
+private:
+    using Super = BitStreamWriter<BlockWriter>;
+
+    using Super::buffer_bits_;
+
+    enum : size_t { all_set = ~((size_t)0) };
+
+public:
+    //! create a Rice coder for values with the expected mean mean_delta.
+    RiceBitStreamWriter(BlockWriter& block_writer, const size_t& mean_delta)
+        : Super(block_writer),
+          low_bits_(tlx::integer_log2_floor(std::max(mean_delta, size_t(1)))) {
+        die_unless(block_writer.block_size() % sizeof(size_t) == 0);
+    }
+
+    //! non-copyable: delete copy-constructor
+    RiceBitStreamWriter(const RiceBitStreamWriter&) = delete;
+    //! non-copyable: delete assignment operator
+    RiceBitStreamWriter& operator = (const RiceBitStreamWriter&) = delete;
+    //! move-constructor: default
+    RiceBitStreamWriter(RiceBitStreamWriter&&) = default;
+    //! move-assignment operator: default
+    RiceBitStreamWriter& operator = (RiceBitStreamWriter&&) = default;
+
+    ~RiceBitStreamWriter() {
+        if (Super::pos_ != 0) {
+            // fill currently remaining buffer item with ones. the decoder will
+            // detect that no zero follows these ones.
+            unsigned bits = buffer_bits_ - Super::pos_;
+            Super::PutBits(all_set >> (buffer_bits_ - bits), bits);
+            assert(Super::pos_ == 0);
+        }
+    }
+
+    /*!
+     * Append new Rice-encoded value to bitset
+     */
+    void PutRice(const size_t& value) {
+
+        if (TLX_UNLIKELY(first_call_)) {
+            // The parameter and the first value, which can be very large, are
+            // stored verbatim.
+            Super::block_writer_.PutRaw(low_bits_);
+            Super::block_writer_.PutRaw(value);
+            first_call_ = false;
+            return;
+        }
+
+        size_t q = value >> low_bits_;
+        size_t r = value & ~(all_set << low_bits_);
+
+        while (q >= buffer_bits_) {
+            q -= buffer_bits_;
+            Super::PutBits(all_set, buffer_bits_);
+        }
+
+        // q ones followed by a zero
+        size_t res = (all_set >> (buffer_bits_ - q - 1)) - 1;
+
+        if (TLX_UNLIKELY(q + 1 + low_bits_ > buffer_bits_)) {
+            Super::PutBits(res, q + 1);
+            Super::PutBits(r, low_bits_);
+        }
+        else if (low_bits_ != 0) {
+            Super::PutBits((res << low_bits_) | r, q + 1 + low_bits_);
+        }
+        else {
+            Super::PutBits(res, q + 1);
+        }
+    }
+
+    void Put(size_t value) {
+        PutRice(value);
+    }
+
+    //! number of low bits stored verbatim
+    size_t low_bits() const { return low_bits_; }
+
+private:
+    //! number of low bits stored verbatim
+    size_t low_bits_;
+
+    //! false, when PutRice was called already
+    bool first_call_ = true;
+};
+
+/******************************************************************************/
+// RiceBitStreamReader
+
+template <typename BlockReader>
+class RiceBitStreamReader : public BitStreamReader<BlockReader>
+{
+private:
+    using Super = BitStreamReader<BlockReader>;
+
+public:
+    //! create a Rice decoder. The parameter is read from the stream, the
+    //! argument is only for interface compatibility with GolombBitStreamReader.
+    explicit RiceBitStreamReader(BlockReader& block_reader,
+                                 const size_t& /* mean_delta */ = 0)
+        : Super(block_reader) { }
+
+    //! non-copyable: delete copy-constructor
+    RiceBitStreamReader(const RiceBitStreamReader&) = delete;
+    //! non-copyable: delete assignment operator
+    RiceBitStreamReader& operator = (const RiceBitStreamReader&) = delete;
+    //! move-constructor: default
+    RiceBitStreamReader(RiceBitStreamReader&&) = default;
+    //! move-assignment operator: default
+    RiceBitStreamReader& operator = (RiceBitStreamReader&&) = default;
+
+    bool HasNext() {
+        if (TLX_UNLIKELY(first_call_))
+            return Super::block_reader_.HasNext();
+
+        return Super::HasNextZeroTest();
+    }
+
+    size_t GetRice() {
+        if (TLX_UNLIKELY(first_call_)) {
+            first_call_ = false;
+            low_bits_ = Super::block_reader_.template GetRaw<size_t>();
+            return Super::block_reader_.template GetRaw<size_t>();
+        }
+
+        size_t q = Super::GetNumberOfOnesUntilNextZero();
+        if (low_bits_ == 0) return q;
+
+        return (q << low_bits_) | Super::GetBits(low_bits_);
+    }
+
+    template <typename Type2>
+    size_t Next() {
+        static_assert(
+            std::is_same<size_t, Type2>::value, "Invalid Next() call");
+        return GetRice();
+    }
+
+private:
+    //! number of low bits stored verbatim, read from the stream
+    size_t low_bits_ = 0;
+
+    //! false, when GetRice was called already
+    bool first_call_ = true;
+};
+
+/******************************************************************************/
+// RiceCoder
+
+/*!
+ * Delta coder selecting RiceBitStreamWriter and RiceBitStreamReader in
+ * DuplicateDetection and LocationDetection. The parameter of each stream is the
+ * mean delta of its values, which the writers estimate from the hash range and
+ * the number of values they send.
+ */
+struct RiceCoder {
+    template <typename BlockWriter>
+    using Writer = RiceBitStreamWriter<BlockWriter>;
+
+    template <typename BlockReader>
+    using Reader = RiceBitStreamReader<BlockReader>;
+
+    //! parameter of a stream of about count values in a range of size range
+    static size_t Parameter(size_t /* golomb_param */,
+                            size_t range, size_t count) {
+        return range / std::max(count, size_t(1));
+    }
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_RICE_BIT_STREAM_HEADER
+
+/******************************************************************************/
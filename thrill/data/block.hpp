@@ -19,6 +19,7 @@
 #include <tlx/counting_ptr.hpp>
 
 #include <cassert>
+#include <chrono>
 #include <ostream>
 #include <string>
 
@@ -354,6 +355,14 @@ private:
     //! running read request
     foxxll::request_ptr req_;
 
+    //! time the read request was issued, for read latency statistics
+    std::chrono::steady_clock::time_point issue_time_;
+
+    //! buffer for reading a compressed block, decompressed on completion.
+    Byte* compressed_data_ = nullptr;
+    //! allocated size of compressed_data_
+    size_t compressed_alloc_ = 0;
+
     //! indication that the PinnedBlocks ready
     std::atomic<bool> ready_;
 
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * thrill/data/block_compression.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/block_compression.hpp>
+
+#if THRILL_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#include <limits>
+
+namespace thrill {
+namespace data {
+
+#if THRILL_HAVE_LZ4
+
+bool BlockCompressionAvailable() {
+    return true;
+}
+
+size_t BlockCompressBound(size_t size) {
+    return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+}
+
+size_t BlockCompress(const uint8_t* src, size_t size,
+                     uint8_t* dst, size_t dst_capacity) {
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return 0;
+    int r = LZ4_compress_default(
+        reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+        static_cast<int>(size), static_cast<int>(dst_capacity));
+    return r > 0 ? static_cast<size_t>(r) : 0;
+}
+
+bool BlockDecompress(const uint8_t* src, size_t size,
+                     uint8_t* dst, size_t dst_size) {
+    int r = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+        static_cast<int>(size), static_cast<int>(dst_size));
+    return r >= 0 && static_cast<size_t>(r) == dst_size;
+}
+
+#else   // !THRILL_HAVE_LZ4
+
+bool BlockCompressionAvailable() {
+    return false;
+}
+
+size_t BlockCompressBound(size_t size) {
+    return size;
+}
+
+size_t BlockCompress(const uint8_t* /* src */, size_t /* size */,
+                     uint8_t* /* dst */, size_t /* dst_capacity */) {
+    return 0;
+}
+
+bool BlockDecompress(const uint8_t* /* src */, size_t /* size */,
+                     uint8_t* /* dst */, size_t /* dst_size */) {
+    return false;
+}
+
+#endif  // !THRILL_HAVE_LZ4
+
+} // namespace data
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * thrill/data/block_compression.hpp
+ *
+ * Compression of the raw bytes of Blocks for network transfer and spilling
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_BLOCK_COMPRESSION_HEADER
+#define THRILL_DATA_BLOCK_COMPRESSION_HEADER
+
+#include <cstddef>
+#include <cstdint>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+//! true if Thrill was compiled with a block compression library
+bool BlockCompressionAvailable();
+
+//! maximum compressed size of size bytes, used to allocate the output buffer
+size_t BlockCompressBound(size_t size);
+
+/*!
+ * Compress size bytes from src into dst, which must have room for
+ * BlockCompressBound(size) bytes. Returns the compressed size, or zero if
+ * compression failed or is not available.
+ */
+size_t BlockCompress(const uint8_t* src, size_t size,
+                     uint8_t* dst, size_t dst_capacity);
+
+/*!
+ * Decompress size bytes from src into dst, which must decompress to exactly
+ * dst_size bytes. Returns false if the data is corrupt or decompression is not
+ * available.
+ */
+bool BlockDecompress(const uint8_t* src, size_t size,
+                     uint8_t* dst, size_t dst_size);
+
+/*!
+ * Adaptive switch deciding whether to compress blocks of a data flow. It is
+ * turned off when the observed compression ratio is poor, since compression
+ * then only costs CPU time.
+ */
+class BlockCompressionSwitch
+{
+public:
+    //! blocks compressed before the ratio is evaluated
+    static constexpr size_t probe_blocks_ = 4;
+
+    //! compression is disabled if compressed / raw exceeds this ratio
+    static constexpr double max_ratio_ = 0.9;
+
+    explicit BlockCompressionSwitch(bool enabled = false)
+        : enabled_(enabled && BlockCompressionAvailable()) { }
+
+    //! whether the next block should be compressed
+    bool enabled() const { return enabled_; }
+
+    //! record the result of compressing a block, compressed_size == 0 if the
+    //! block could not be compressed.
+    void Record(size_t raw_size, size_t compressed_size) {
+        ++blocks_;
+        raw_bytes_ += raw_size;
+        compressed_bytes_ += compressed_size ? compressed_size : raw_size;
+        if (blocks_ >= probe_blocks_ &&
+            compressed_bytes_ > max_ratio_ * raw_bytes_)
+            enabled_ = false;
+    }
+
+private:
+    bool enabled_;
+    size_t blocks_ = 0;
+    size_t raw_bytes_ = 0;
+    size_t compressed_bytes_ = 0;
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_BLOCK_COMPRESSION_HEADER
+
+/******************************************************************************/
@@ -10,19 +10,30 @@
 
 #include <thrill/common/logger.hpp>
 #include <thrill/common/math.hpp>
+#include <thrill/common/porting.hpp>
+#include <thrill/common/system_exception.hpp>
+#include <thrill/common/trace_event.hpp>
 #include <thrill/data/block.hpp>
+#include <thrill/data/block_compression.hpp>
 #include <thrill/data/block_pool.hpp>
+#include <thrill/data/eviction_policy.hpp>
+#include <thrill/data/file.hpp>
+#include <thrill/data/mmap_spill_area.hpp>
 #include <thrill/mem/aligned_allocator.hpp>
+#include <thrill/mem/huge_page_pool.hpp>
 #include <thrill/mem/pool.hpp>
 
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/iostats.hpp>
-#include <tlx/container/lru_cache.hpp>
 #include <tlx/die.hpp>
 #include <tlx/math/is_power_of_two.hpp>
 #include <tlx/string/join_generic.hpp>
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -50,6 +61,23 @@ static constexpr bool debug_mem = false;
 //! debug block eviction: evict, write complete, read complete
 static constexpr bool debug_em = false;
 
+//! maximum number of Blocks read ahead by File readers with automatic prefetch
+static constexpr size_t max_read_ahead_blocks = 64;
+
+/******************************************************************************/
+// compression of evicted blocks
+
+//! round size up to the alignment required for direct I/O
+static size_t RoundUpAlign(size_t size) {
+    return (size + THRILL_DEFAULT_ALIGN - 1)
+           / THRILL_DEFAULT_ALIGN * THRILL_DEFAULT_ALIGN;
+}
+
+//! size of the buffer used to compress a Block of given size for eviction
+static size_t SpillBufferSize(size_t size) {
+    return RoundUpAlign(BlockCompressBound(size));
+}
+
 /******************************************************************************/
 // std::new_handler() which gets called when malloc() returns nullptr
 
@@ -87,7 +115,7 @@ static void OurNewHandler() {
     if (!req) {
         // if no writing active, evict a block
         for (size_t i = 0; i < s_blockpools.size(); ++i) {
-            req = s_blockpools[s_iter]->EvictBlockLRU();
+            req = s_blockpools[s_iter]->EvictUnpinnedBlock();
             ++s_iter %= s_blockpools.size();
             if (req) break;
         }
@@ -242,6 +270,9 @@ using ReadingMap = std::unordered_map<
 class BlockPool::Data
 {
 public:
+    //! the BlockPool's logger, for trace events
+    common::JsonLogger& logger_;
+
     //! For waiting on hard memory limit
     std::condition_variable cv_memory_change_;
 
@@ -256,9 +287,9 @@ public:
     //! print a message on the first block evicted to external memory
     bool notify_em_used_ = false;
 
-    //! list of all blocks that are _in_memory_ but are _not_ pinned.
-    tlx::LruCacheSet<
-        ByteBlock*, mem::GPoolAllocator<ByteBlock*> > unpinned_blocks_;
+    //! set of all blocks that are _in_memory_ but are _not_ pinned, ordered by
+    //! the eviction policy, partitioned by job.
+    std::unique_ptr<JobEvictionPolicy> unpinned_blocks_;
 
     //! set of ByteBlocks currently begin written to EM.
     WritingMap writing_;
@@ -280,10 +311,51 @@ public:
     //! reference to io block manager
     foxxll::block_manager* bm_;
 
+    //! running counter of evicted Blocks, which selects their disk
+    size_t next_em_disk_ = 0;
+
     //! Allocator for ByteBlocks such that they are aligned for faster
     //! I/O. Allocations are counted via mem_manager_.
     mem::AlignedAllocator<Byte, mem::Allocator<char> > aligned_alloc_;
 
+    //! NUMA node of each local worker, empty if NUMA arenas are disabled or
+    //! the machine has only one node.
+    std::vector<size_t> worker_numa_node_;
+
+    //! optional pools of huge page backed chunks of default_block_size for
+    //! ByteBlocks, one per NUMA node if NUMA arenas are enabled. Chunks are
+    //! also counted via mem_manager_.
+    std::vector<std::unique_ptr<mem::HugePagePool> > huge_page_pools_;
+
+    //! print a message on the first failure to bind memory to a NUMA node
+    std::atomic<bool> notify_numa_failed_ { false };
+
+    //! maximum number of recycled ByteBlock buffers
+    static constexpr size_t max_recycled_blocks = 64;
+
+    //! size of recycled buffers: default_block_size at creation
+    size_t recycle_size_;
+
+    //! maximum number of bytes in recycled buffers
+    size_t recycle_limit_;
+
+    //! buffers of recycle_size_ released by destroyed or evicted ByteBlocks,
+    //! whose pages are already faulted in. Reused before allocating anew.
+    std::vector<Byte*> recycled_;
+
+    //! mutex protecting recycled_, which is also used without mutex_.
+    std::mutex recycle_mutex_;
+
+    //! number of bytes in recycled_, counted against the soft limit.
+    std::atomic<size_t> recycled_bytes_ { 0 };
+
+    //! number of allocations served from recycled_
+    std::atomic<size_t> recycle_hits_ { 0 };
+
+    //! optional memory-mapped file into which Blocks are swapped out instead
+    //! of writing them via foxxll.
+    std::unique_ptr<MmapSpillArea> mmap_spill_;
+
     //! next unique File id
     std::atomic<size_t> next_file_id_ { 0 };
 
@@ -305,6 +377,32 @@ public:
     //! number of bytes currently being read from to EM.
     Counter reading_bytes_;
 
+    //! statistics of completed reads from EM
+    ReadStats read_stats_;
+
+    //! external memory I/O by dia_id of the Blocks
+    std::unordered_map<size_t, DiaIoStats> dia_io_stats_;
+
+    //! count a Block swapped out to EM in dia_io_stats_
+    void IntCountEvicted(ByteBlock* block_ptr) {
+        DiaIoStats& s = dia_io_stats_[block_ptr->dia_id()];
+        s.evicted_blocks++;
+        s.evicted_bytes += block_ptr->size();
+    }
+
+    //! count a Block pinned back from EM in dia_io_stats_
+    void IntCountRead(ByteBlock* block_ptr) {
+        DiaIoStats& s = dia_io_stats_[block_ptr->dia_id()];
+        s.read_blocks++;
+        s.read_bytes += block_ptr->size();
+    }
+
+    //! adaptive switch whether to compress Blocks evicted to EM
+    BlockCompressionSwitch spill_compression_;
+
+    //! raw and compressed (aligned) size of Blocks evicted compressed
+    size_t spill_compress_raw_bytes_ = 0, spill_compress_bytes_ = 0;
+
     //! total number of ByteBlocks allocated
     size_t total_byte_blocks_ = 0;
 
@@ -321,6 +419,18 @@ public:
     //! also additionally reserved memory via BlockPoolMemoryHolder.
     Counter total_ram_bytes_;
 
+    //! callbacks of nodes which can free memory on request, by id.
+    std::unordered_map<
+        size_t, ReclaimCallback, std::hash<size_t>, std::equal_to<>,
+        mem::GPoolAllocator<std::pair<const size_t, ReclaimCallback> > >
+    reclaim_callbacks_;
+
+    //! next reclaim callback id
+    size_t next_reclaim_id_ = 0;
+
+    //! number of times the reclaim callbacks were invoked
+    size_t reclaim_signals_ = 0;
+
     //! last time statistics where outputted
     std::chrono::steady_clock::time_point tp_last_
         = std::chrono::steady_clock::now();
@@ -328,12 +438,125 @@ public:
 public:
     Data(BlockPool& block_pool,
          size_t soft_ram_limit, size_t hard_ram_limit,
-         size_t workers_per_host)
-        : soft_ram_limit_(soft_ram_limit),
+         size_t workers_per_host, bool compress_spills, bool huge_pages,
+         const std::string& eviction_policy, const std::string& mmap_spill_dir,
+         bool numa_arenas)
+        : logger_(block_pool.logger_),
+          soft_ram_limit_(soft_ram_limit),
           hard_ram_limit_(hard_ram_limit),
+          unpinned_blocks_(
+              MakeEvictionPolicy(eviction_policy)
+              ? std::make_unique<JobEvictionPolicy>(eviction_policy)
+              : nullptr),
           bm_(foxxll::block_manager::get_instance()),
           aligned_alloc_(mem::Allocator<char>(block_pool.mem_manager_)),
-          pin_count_(workers_per_host) { }
+          recycle_size_(default_block_size),
+          recycle_limit_(max_recycled_blocks * default_block_size),
+          pin_count_(workers_per_host),
+          spill_compression_(compress_spills) {
+        // leave most of the soft limit to Blocks in use
+        if (soft_ram_limit_ != 0)
+            recycle_limit_ = std::min(recycle_limit_, soft_ram_limit_ / 16);
+        if (!unpinned_blocks_)
+            die("BlockPool: unknown eviction policy " << eviction_policy);
+        if (numa_arenas && common::GetNumaNodeCount() > 1) {
+            // workers are pinned to the core of their id by the Context.
+            worker_numa_node_.resize(workers_per_host);
+            for (size_t w = 0; w < workers_per_host; ++w) {
+                worker_numa_node_[w] = common::GetNumaNode(
+                    w % std::thread::hardware_concurrency());
+            }
+        }
+        if (huge_pages && worker_numa_node_.empty()) {
+            huge_page_pools_.emplace_back(
+                std::make_unique<mem::HugePagePool>(
+                    block_pool.mem_manager_, default_block_size));
+        }
+        else if (huge_pages) {
+            size_t num_nodes = 1 + *std::max_element(
+                worker_numa_node_.begin(), worker_numa_node_.end());
+            for (size_t n = 0; n < num_nodes; ++n) {
+                huge_page_pools_.emplace_back(
+                    std::make_unique<mem::HugePagePool>(
+                        block_pool.mem_manager_, default_block_size,
+                        64 * 1024 * 1024, n));
+            }
+        }
+        if (!mmap_spill_dir.empty())
+            mmap_spill_ = std::make_unique<MmapSpillArea>(mmap_spill_dir);
+    }
+
+    //! allocate memory for the data of a ByteBlock used by the given worker,
+    //! from the huge page pool of its NUMA node if enabled and the size
+    //! matches, else from the aligned allocator and bound to its NUMA node.
+    Byte * AllocateBlockData(size_t size, size_t local_worker_id) {
+        size_t numa_node = worker_numa_node_.empty()
+                           ? 0 : worker_numa_node_[local_worker_id];
+
+        Byte* data = nullptr;
+        if (size == recycle_size_ && recycled_bytes_ != 0) {
+            std::unique_lock<std::mutex> lock(recycle_mutex_);
+            if (!recycled_.empty()) {
+                data = recycled_.back();
+                recycled_.pop_back();
+                recycled_bytes_ -= size;
+                ++recycle_hits_;
+            }
+        }
+
+        if (!data && !huge_page_pools_.empty() &&
+            size == huge_page_pools_[numa_node]->chunk_size()) {
+            if (void* ptr = huge_page_pools_[numa_node]->allocate())
+                return static_cast<Byte*>(ptr);
+        }
+
+        if (!data)
+            data = aligned_alloc_.allocate(size);
+
+        // mbind() works on whole pages, smaller blocks are left as they are.
+        // pages of recycled buffers on another NUMA node are moved.
+        if (!worker_numa_node_.empty() && size % THRILL_DEFAULT_ALIGN == 0 &&
+            !common::BindMemoryToNumaNode(data, size, numa_node) &&
+            !notify_numa_failed_.exchange(true)) {
+            LOG1 << "BlockPool: could not bind ByteBlock to NUMA node "
+                 << numa_node << ", continuing without NUMA arenas.";
+        }
+        return data;
+    }
+
+    //! deallocate memory of AllocateBlockData(), keeps buffers of
+    //! recycle_size_ for reuse up to recycle_limit_.
+    void DeallocateBlockData(Byte* data, size_t size) {
+        if (size == recycle_size_ &&
+            recycled_bytes_ + size <= recycle_limit_) {
+            std::unique_lock<std::mutex> lock(recycle_mutex_);
+            if (recycled_bytes_ + size <= recycle_limit_) {
+                recycled_.push_back(data);
+                recycled_bytes_ += size;
+                return;
+            }
+        }
+        FreeBlockData(data, size);
+    }
+
+    //! release memory of AllocateBlockData() to the pools or allocator.
+    void FreeBlockData(Byte* data, size_t size) {
+        for (auto& pool : huge_page_pools_) {
+            if (size == pool->chunk_size() && pool->deallocate(data))
+                return;
+        }
+        aligned_alloc_.deallocate(data, size);
+    }
+
+    //! free recycled buffers until at most keep_bytes remain.
+    void TrimRecycled(size_t keep_bytes) {
+        std::unique_lock<std::mutex> lock(recycle_mutex_);
+        while (recycled_bytes_ > keep_bytes) {
+            FreeBlockData(recycled_.back(), recycle_size_);
+            recycled_.pop_back();
+            recycled_bytes_ -= recycle_size_;
+        }
+    }
 
     //! Updates the memory manager for internal memory. If the hard limit is
     //! reached, the call is blocked intil memory is free'd
@@ -343,18 +566,34 @@ public:
     //! BlockPool::RequestInternalMemory calls
     void IntReleaseInternalMemory(size_t size);
 
+    //! Invoke all reclaim callbacks, asking their owners to free memory.
+    void IntSignalReclaim();
+
+    //! count a block entering RAM for its job's quota
+    void IntAddResident(ByteBlock* block_ptr) {
+        unpinned_blocks_->AddResident(block_ptr->job_id(), block_ptr->size());
+    }
+
+    //! count a block leaving RAM for its job's quota
+    void IntSubResident(ByteBlock* block_ptr) {
+        unpinned_blocks_->SubResident(block_ptr->job_id(), block_ptr->size());
+    }
+
     //! Unpins a block. If all pins are removed, the block might be swapped.
     //! Returns immediately. Actual unpinning is async.
     void IntUnpinBlock(
         BlockPool& bp, ByteBlock* block_ptr, size_t local_worker_id);
 
-    //! Evict a block from the lru list into external memory
-    foxxll::request_ptr IntEvictBlockLRU();
+    //! Evict the block selected by the eviction policy into external memory
+    foxxll::request_ptr IntEvictUnpinnedBlock();
 
     //! Evict a block into external memory. The block must be unpinned and not
     //! swapped.
     foxxll::request_ptr IntEvictBlock(ByteBlock* block_ptr);
 
+    //! Evict a block by copying it into a slot of mmap_spill_.
+    void IntEvictBlockMmap(ByteBlock* block_ptr, Byte* slot);
+
     //! \name Block Statistics
     //! \{
 
@@ -375,12 +614,16 @@ BlockPool::BlockPool(size_t workers_per_host)
 
 BlockPool::BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
                      common::JsonLogger* logger, mem::Manager* mem_manager,
-                     size_t workers_per_host)
+                     size_t workers_per_host, bool compress_spills,
+                     bool huge_pages, const std::string& eviction_policy,
+                     const std::string& mmap_spill_dir, bool numa_arenas)
     : logger_(logger),
       mem_manager_(mem_manager, "BlockPool"),
       workers_per_host_(workers_per_host),
       d_(std::make_unique<Data>(
-             *this, soft_ram_limit, hard_ram_limit, workers_per_host)) {
+             *this, soft_ram_limit, hard_ram_limit, workers_per_host,
+             compress_spills, huge_pages, eviction_policy, mmap_spill_dir,
+             numa_arenas)) {
 
     die_unless(hard_ram_limit >= soft_ram_limit);
     {
@@ -398,7 +641,11 @@ BlockPool::BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
     logger_ << "class" << "BlockPool"
             << "event" << "create"
             << "soft_ram_limit" << soft_ram_limit
-            << "hard_ram_limit" << hard_ram_limit;
+            << "hard_ram_limit" << hard_ram_limit
+            << "compress_spills" << d_->spill_compression_.enabled()
+            << "eviction_policy" << d_->unpinned_blocks_->name()
+            << "mmap_spill" << (d_->mmap_spill_ != nullptr)
+            << "numa_arenas" << !d_->worker_numa_node_.empty();
 }
 
 BlockPool::~BlockPool() {
@@ -463,7 +710,9 @@ BlockPool::~BlockPool() {
     d_->pin_count_.AssertZero();
     die_unequal(d_->total_ram_bytes_, 0u);
     die_unequal(d_->total_bytes_, 0u);
-    die_unequal(d_->unpinned_blocks_.size(), 0u);
+    die_unequal(d_->unpinned_blocks_->size(), 0u);
+
+    d_->TrimRecycled(0);
 
     LOGC(debug_pin)
         << "~BlockPool()"
@@ -498,7 +747,7 @@ BlockPool::AllocateByteBlock(size_t size, size_t local_worker_id) {
     // allocate block memory. -- unlock mutex for that time, since it may
     // require block eviction.
     lock.unlock();
-    Byte* data = d_->aligned_alloc_.allocate(size);
+    Byte* data = d_->AllocateBlockData(size, local_worker_id);
     LOGC(debug_alloc)
         << "ByteBlock aligned_alloc: " << (void*)data << " size " << size;
     lock.lock();
@@ -506,6 +755,8 @@ BlockPool::AllocateByteBlock(size_t size, size_t local_worker_id) {
     // create tlx::CountingPtr, no need for special make_shared()-equivalent
     PinnedByteBlockPtr block_ptr(
         mem::GPool().make<ByteBlock>(this, data, size), local_worker_id);
+    block_ptr->job_id_ = current_job_id();
+    d_->IntAddResident(block_ptr.get());
     ++d_->total_byte_blocks_;
     d_->total_bytes_ += size;
     d_->max_total_bytes_ = std::max(d_->max_total_bytes_, d_->total_bytes_.value);
@@ -531,6 +782,7 @@ ByteBlockPtr BlockPool::MapExternalBlock(
     // create tlx::CountingPtr, no need for special make_shared()-equivalent
     ByteBlockPtr block_ptr(
         mem::GPool().make<ByteBlock>(this, file, offset, size));
+    block_ptr->job_id_ = current_job_id();
     ++d_->total_byte_blocks_;
     d_->max_total_bytes_ = std::max(d_->max_total_bytes_, d_->total_bytes_.value);
     d_->total_bytes_ += size;
@@ -544,6 +796,41 @@ ByteBlockPtr BlockPool::MapExternalBlock(
     return block_ptr;
 }
 
+ByteBlockPtr BlockPool::MmapExternalBlock(
+    int fd, uint64_t offset, size_t size) {
+    // mmap() requires a page-aligned offset
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t skip = offset % page_size;
+
+    void* map = ::mmap(nullptr, skip + size, PROT_READ, MAP_PRIVATE,
+                       fd, static_cast<off_t>(offset - skip));
+    if (map == MAP_FAILED)
+        throw common::ErrnoException("BlockPool: mmap() failed", errno);
+
+    // data is read once sequentially, let the kernel read ahead.
+    ::madvise(map, skip + size, MADV_SEQUENTIAL);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // create tlx::CountingPtr, no need for special make_shared()-equivalent
+    ByteBlockPtr block_ptr(
+        mem::GPool().make<ByteBlock>(
+            this, reinterpret_cast<Byte*>(map) + skip, size));
+    block_ptr->ext_map_ = reinterpret_cast<Byte*>(map);
+    block_ptr->ext_map_size_ = skip + size;
+    block_ptr->job_id_ = current_job_id();
+    ++d_->total_byte_blocks_;
+    d_->max_total_bytes_ = std::max(d_->max_total_bytes_, d_->total_bytes_.value);
+    d_->total_bytes_ += size;
+
+    LOGC(debug_blc)
+        << "BlockPool::MmapExternalBlock()"
+        << " ptr=" << block_ptr.get()
+        << " offset=" << offset
+        << " size=" << size;
+
+    return block_ptr;
+}
+
 //! Pins a block by swapping it in if required.
 PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
     assert(local_worker_id < workers_per_host_);
@@ -556,7 +843,7 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         // PinnedBlock become Blocks when transfered between Files or delivered
         // via GetItemRange() or Scatter().
 
-        die_unless(!d_->unpinned_blocks_.exists(block_ptr));
+        die_unless(!d_->unpinned_blocks_->exists(block_ptr));
         die_unless(d_->reading_.find(block_ptr) == d_->reading_.end());
 
         LOGC(debug_pin)
@@ -573,7 +860,7 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         // This block was already pinned by another thread, hence we only need
         // to get a pin for the new thread.
 
-        die_unless(!d_->unpinned_blocks_.exists(block_ptr));
+        die_unless(!d_->unpinned_blocks_->exists(block_ptr));
         die_unless(d_->reading_.find(block_ptr) == d_->reading_.end());
 
         LOGC(debug_pin)
@@ -631,13 +918,29 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
     if (read_it != d_->reading_.end())
         return read_it->second;
 
+    if (block_ptr->ext_map_)
+    {
+        // memory-mapped block, the kernel pages in the data on access.
+
+        IntIncBlockPinCount(block_ptr, local_worker_id);
+        d_->pin_count_.Increment(local_worker_id, block_ptr->size());
+
+        LOGC(debug_pin)
+            << "BlockPool::PinBlock block=" << &block
+            << " pinned memory-mapped block"
+            << d_->pin_count_;
+
+        return PinRequestPtr(mem::GPool().make<PinRequest>(
+                                 this, PinnedBlock(block, local_worker_id)));
+    }
+
     if (block_ptr->in_memory())
     {
         // unpinned block in memory, no need to load from EM.
 
         // remove from unpinned list
-        die_unless(d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.erase(block_ptr);
+        die_unless(d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->erase(block_ptr);
         d_->unpinned_bytes_ -= block_ptr->size();
 
         IntIncBlockPinCount(block_ptr, local_worker_id);
@@ -652,6 +955,62 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
                                  this, PinnedBlock(block, local_worker_id)));
     }
 
+    if (block_ptr->em_map_)
+    {
+        // swapped out into the mmap spill area: copy back synchronously.
+        size_t size = block_ptr->size();
+        d_->IntRequestInternalMemory(lock, size);
+        d_->IntAddResident(block_ptr);
+
+        // the requested memory is already counted as a pin.
+        d_->pin_count_.Increment(local_worker_id, size);
+
+        // register as reading, such that concurrent pins wait for the copy.
+        PinRequestPtr read(
+            mem::GPool().make<PinRequest>(
+                this, PinnedBlock(block, local_worker_id), /* ready */ false));
+        d_->reading_[block_ptr] = read;
+        d_->reading_bytes_ += size;
+
+        d_->swapped_.erase(block_ptr);
+        d_->swapped_bytes_ -= size;
+        d_->unpinned_blocks_->swap_in_blocks_++;
+
+        // allocate and copy without the mutex, the kernel may have to page in
+        // the slot.
+        auto issue_time = std::chrono::steady_clock::now();
+        lock.unlock();
+        Byte* data = d_->AllocateBlockData(size, local_worker_id);
+        std::copy(block_ptr->em_map_, block_ptr->em_map_ + size, data);
+        lock.lock();
+
+        block_ptr->data_ = data;
+        d_->mmap_spill_->Deallocate(block_ptr->em_map_, size);
+        block_ptr->em_map_ = nullptr;
+
+        IntIncBlockPinCount(block_ptr, local_worker_id);
+
+        d_->IntCountRead(block_ptr);
+        d_->read_stats_.bytes += size;
+        d_->read_stats_.requests++;
+        d_->read_stats_.latency += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - issue_time).count();
+
+        LOGC(debug_em)
+            << "BlockPool::PinBlock block=" << block
+            << " copied from mmap spill area"
+            << d_->pin_count_;
+
+        // read still holds a reference, hence the PinRequest is not deleted
+        // while holding the mutex.
+        d_->reading_.erase(block_ptr);
+        d_->reading_bytes_ -= size;
+        read->ready_ = true;
+        cv_read_complete_.notify_all();
+
+        return read;
+    }
+
     // else need to initiate an async read to get the data.
 
     die_unless(block_ptr->em_bid_.storage);
@@ -659,6 +1018,7 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
     // maybe blocking call until memory is available, this also swaps out other
     // blocks.
     d_->IntRequestInternalMemory(lock, block_ptr->size());
+    d_->IntAddResident(block_ptr);
 
     // the requested memory is already counted as a pin.
     d_->pin_count_.Increment(local_worker_id, block_ptr->size());
@@ -670,15 +1030,25 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
             this, PinnedBlock(block, local_worker_id), /* ready */ false));
     d_->reading_[block_ptr] = read;
 
+    // compressed blocks are read into a separate buffer and decompressed by
+    // OnReadComplete().
+    size_t em_size = block_ptr->em_bid_.size;
+    bool em_compressed = (block_ptr->em_compressed_size_ != 0);
+
     // allocate block memory.
     lock.unlock();
     Byte* data = read->byte_block()->data_ =
-        d_->aligned_alloc_.allocate(block_ptr->size());
+        d_->AllocateBlockData(block_ptr->size(), local_worker_id);
+    if (em_compressed) {
+        read->compressed_alloc_ = em_size;
+        data = read->compressed_data_ = d_->aligned_alloc_.allocate(em_size);
+    }
     lock.lock();
 
     if (!block_ptr->ext_file_) {
         d_->swapped_.erase(block_ptr);
         d_->swapped_bytes_ -= block_ptr->size();
+        d_->unpinned_blocks_->swap_in_blocks_++;
     }
 
     LOGC(debug_em)
@@ -687,10 +1057,13 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         << d_->pin_count_;
 
     // issue I/O request, hold the reference to the request in the hashmap
+    common::TraceEvent(logger_, 'b', "block_pool", "PinRead",
+                       reinterpret_cast<uintptr_t>(block_ptr));
+    read->issue_time_ = std::chrono::steady_clock::now();
     read->req_ =
         block_ptr->em_bid_.storage->aread(
             // parameters for the read
-            data, block_ptr->em_bid_.offset, block_ptr->size(),
+            data, block_ptr->em_bid_.offset, em_size,
             // construct an immediate CompletionHandler callback
             foxxll::completion_handler::make<
                 PinRequest, &PinRequest::OnComplete>(*read));
@@ -700,6 +1073,24 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
     return read;
 }
 
+size_t BlockPool::ReadAheadSize() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // without limit, Blocks are never evicted, hence nothing to read ahead.
+    if (d_->hard_ram_limit_ == 0)
+        return File::default_prefetch_size_;
+
+    // RAM not pinned or requested by anyone, unpinned Blocks can be evicted
+    size_t used = d_->total_ram_bytes_ - d_->unpinned_bytes_
+                  + d_->requested_bytes_;
+    size_t avail = d_->hard_ram_limit_ - std::min(used, d_->hard_ram_limit_);
+
+    // take a quarter of the worker's share, in whole Blocks.
+    size_t blocks = avail / workers_per_host_ / 4 / default_block_size;
+    return std::max<size_t>(1, std::min(blocks, max_read_ahead_blocks))
+           * default_block_size;
+}
+
 std::pair<size_t, size_t> BlockPool::MaxMergeDegreePrefetch(size_t num_files) {
     size_t avail_bytes = hard_ram_limit() / workers_per_host_ / 2;
     size_t avail_blocks = avail_bytes / default_block_size;
@@ -722,11 +1113,29 @@ void PinRequest::OnComplete(foxxll::request* req, bool success) {
 
 void BlockPool::OnReadComplete(
     PinRequest* read, foxxll::request* req, bool success) {
-    std::unique_lock<std::mutex> lock(mutex_);
 
     ByteBlock* block_ptr = read->block_.byte_block().get();
     size_t block_size = block_ptr->size();
 
+    if (read->compressed_data_) {
+        // decompress in the I/O thread without holding the mutex, the
+        // PinRequest's memory is not accessible until it is ready.
+        if (success) {
+            die_unless(BlockDecompress(
+                           read->compressed_data_,
+                           block_ptr->em_compressed_size_,
+                           read->byte_block()->data_, block_size));
+        }
+        d_->aligned_alloc_.deallocate(
+            read->compressed_data_, read->compressed_alloc_);
+        read->compressed_data_ = nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    common::TraceEvent(logger_, 'e', "block_pool", "PinRead",
+                       reinterpret_cast<uintptr_t>(block_ptr));
+
     LOGC(debug_em)
         << "OnReadComplete():"
         << " req " << req << " block " << *block_ptr
@@ -748,9 +1157,10 @@ void BlockPool::OnReadComplete(
         sLOGC(debug_alloc)
             << "ByteBlock  deallocate"
             << (void*)read->byte_block()->data_ << "size" << block_size;
-        d_->aligned_alloc_.deallocate(read->byte_block()->data_, block_size);
+        d_->DeallocateBlockData(read->byte_block()->data_, block_size);
 
         d_->IntReleaseInternalMemory(block_size);
+        d_->IntSubResident(block_ptr);
 
         // the requested memory was already counted as a pin.
         d_->pin_count_.Decrement(read->block_.local_worker_id_, block_size);
@@ -766,7 +1176,14 @@ void BlockPool::OnReadComplete(
         if (!block_ptr->ext_file_) {
             d_->bm_->delete_block(block_ptr->em_bid_);
             block_ptr->em_bid_ = foxxll::BID<0>();
+            block_ptr->em_compressed_size_ = 0;
         }
+
+        d_->IntCountRead(block_ptr);
+        d_->read_stats_.bytes += block_size;
+        d_->read_stats_.requests++;
+        d_->read_stats_.latency += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - read->issue_time_).count();
     }
 
     read->ready_ = true;
@@ -852,9 +1269,12 @@ void BlockPool::Data::IntUnpinBlock(
         return;
     }
 
+    // memory-mapped blocks are not swapped out, the kernel drops their pages.
+    if (block_ptr->ext_map_) return;
+
     // if all per-thread pins are zero, allow this Block to be swapped out.
-    die_unless(!unpinned_blocks_.exists(block_ptr));
-    unpinned_blocks_.put(block_ptr);
+    die_unless(!unpinned_blocks_->exists(block_ptr));
+    unpinned_blocks_->put(block_ptr);
     unpinned_bytes_ += block_ptr->size();
 
     LOGC(debug_pin)
@@ -873,13 +1293,13 @@ size_t BlockPool::Data::int_total_blocks() noexcept {
 
     LOG << "BlockPool::total_blocks()"
         << " pinned_blocks_=" << pin_count_.total_pins_
-        << " unpinned_blocks_=" << unpinned_blocks_.size()
+        << " unpinned_blocks_=" << unpinned_blocks_->size()
         << " writing_.size()=" << writing_.size()
         << " swapped_.size()=" << swapped_.size()
         << " reading_.size()=" << reading_.size();
 
     return pin_count_.total_pins_
-           + unpinned_blocks_.size() + writing_.size()
+           + unpinned_blocks_->size() + writing_.size()
            + swapped_.size() + reading_.size();
 }
 
@@ -918,7 +1338,7 @@ size_t BlockPool::pinned_blocks() noexcept {
 
 size_t BlockPool::unpinned_blocks() noexcept {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->unpinned_blocks_.size();
+    return d_->unpinned_blocks_->size();
 }
 
 size_t BlockPool::writing_blocks() noexcept {
@@ -936,6 +1356,17 @@ size_t BlockPool::reading_blocks() noexcept {
     return d_->reading_.size();
 }
 
+BlockPool::ReadStats BlockPool::read_stats() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return d_->read_stats_;
+}
+
+std::map<size_t, BlockPool::DiaIoStats> BlockPool::dia_io_stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return std::map<size_t, DiaIoStats>(
+        d_->dia_io_stats_.begin(), d_->dia_io_stats_.end());
+}
+
 void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
     // this method is called by ByteBlockPtr's deleter when the reference
     // counter reaches zero to deallocate the block.
@@ -1011,24 +1442,35 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
     }
     while (0); // NOLINT
 
-    if (block_ptr->ext_file_ && block_ptr->in_memory())
+    if (block_ptr->ext_map_)
+    {
+        LOGC(debug_blc)
+            << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
+            << " memory-mapped block, unmap.";
+
+        ::munmap(block_ptr->ext_map_, block_ptr->ext_map_size_);
+        block_ptr->ext_map_ = nullptr;
+        block_ptr->data_ = nullptr;
+    }
+    else if (block_ptr->ext_file_ && block_ptr->in_memory())
     {
         LOGC(debug_blc)
             << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
             << " external block, in memory: release memory.";
 
-        die_unless(d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.erase(block_ptr);
+        die_unless(d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->erase(block_ptr);
         d_->unpinned_bytes_ -= block_ptr->size();
 
         // release memory
         sLOGC(debug_alloc)
             << "ByteBlock deallocate"
             << (void*)block_ptr->data_ << "size" << block_ptr->size();
-        d_->aligned_alloc_.deallocate(block_ptr->data_, block_ptr->size());
+        d_->DeallocateBlockData(block_ptr->data_, block_ptr->size());
         block_ptr->data_ = nullptr;
 
         d_->IntReleaseInternalMemory(block_ptr->size());
+        d_->IntSubResident(block_ptr);
     }
     else if (block_ptr->ext_file_)
     {
@@ -1043,8 +1485,8 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
             << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
             << " unpinned block in memory, remove from list";
 
-        if (d_->unpinned_blocks_.exists(block_ptr)) {
-            d_->unpinned_blocks_.erase(block_ptr);
+        if (d_->unpinned_blocks_->exists(block_ptr)) {
+            d_->unpinned_blocks_->erase(block_ptr);
             d_->unpinned_bytes_ -= block_ptr->size();
         }
 
@@ -1052,10 +1494,11 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
         sLOGC(debug_alloc)
             << "ByteBlock deallocate"
             << (void*)block_ptr->data_ << "size" << block_ptr->size();
-        d_->aligned_alloc_.deallocate(block_ptr->data_, block_ptr->size());
+        d_->DeallocateBlockData(block_ptr->data_, block_ptr->size());
         block_ptr->data_ = nullptr;
 
         d_->IntReleaseInternalMemory(block_ptr->size());
+        d_->IntSubResident(block_ptr);
     }
     else
     {
@@ -1069,8 +1512,15 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
         d_->swapped_.erase(it);
         d_->swapped_bytes_ -= block_ptr->size();
 
-        d_->bm_->delete_block(block_ptr->em_bid_);
-        block_ptr->em_bid_ = foxxll::BID<0>();
+        if (block_ptr->em_map_) {
+            d_->mmap_spill_->Deallocate(block_ptr->em_map_, block_ptr->size());
+            block_ptr->em_map_ = nullptr;
+        }
+        else {
+            d_->bm_->delete_block(block_ptr->em_bid_);
+            block_ptr->em_bid_ = foxxll::BID<0>();
+            block_ptr->em_compressed_size_ = 0;
+        }
     }
 
     assert(d_->total_byte_blocks_ > 0);
@@ -1090,6 +1540,15 @@ void BlockPool::Data::IntRequestInternalMemory(
 
     requested_bytes_ += size;
 
+    // recycled buffers are counted against the soft limit: free them first.
+    if (soft_ram_limit_ != 0 && recycled_bytes_ != 0 &&
+        total_ram_bytes_ + requested_bytes_ + recycled_bytes_ >
+        soft_ram_limit_ + writing_bytes_) {
+        size_t over = total_ram_bytes_ + requested_bytes_ + recycled_bytes_
+                      - soft_ram_limit_ - writing_bytes_;
+        TrimRecycled(recycled_bytes_ - std::min<size_t>(over, recycled_bytes_));
+    }
+
     LOGC(debug_mem)
         << "BlockPool::RequestInternalMemory()"
         << " size=" << size
@@ -1099,15 +1558,23 @@ void BlockPool::Data::IntRequestInternalMemory(
         << " soft_ram_limit_=" << soft_ram_limit_
         << " hard_ram_limit_=" << hard_ram_limit_
         << pin_count_
-        << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+        << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
         << " swapped_.size()=" << swapped_.size();
 
     while (soft_ram_limit_ != 0 &&
-           unpinned_blocks_.size() &&
+           unpinned_blocks_->size() &&
            total_ram_bytes_ + requested_bytes_ > soft_ram_limit_ + writing_bytes_)
     {
         // evict blocks: schedule async writing which increases writing_bytes_.
-        IntEvictBlockLRU();
+        IntEvictUnpinnedBlock();
+    }
+
+    // nothing left to evict while above the soft limit: ask nodes holding
+    // memory outside of Blocks to flush, before the hard limit blocks us.
+    if (soft_ram_limit_ != 0 && unpinned_blocks_->size() == 0 &&
+        total_ram_bytes_ + requested_bytes_ > soft_ram_limit_ + writing_bytes_)
+    {
+        IntSignalReclaim();
     }
 
     // wait up to 60 seconds for other threads to free up memory or pins
@@ -1119,13 +1586,16 @@ void BlockPool::Data::IntRequestInternalMemory(
     while (hard_ram_limit_ != 0 && total_ram_bytes_ + size > hard_ram_limit_)
     {
         while (hard_ram_limit_ != 0 &&
-               unpinned_blocks_.size() &&
+               unpinned_blocks_->size() &&
                total_ram_bytes_ + requested_bytes_ > hard_ram_limit_ + writing_bytes_)
         {
             // evict blocks: schedule async writing which increases writing_bytes_.
-            IntEvictBlockLRU();
+            IntEvictUnpinnedBlock();
         }
 
+        if (unpinned_blocks_->size() == 0)
+            IntSignalReclaim();
+
         cv_memory_change_.wait_for(lock, std::chrono::seconds(1));
 
         LOGC(debug_mem)
@@ -1136,7 +1606,7 @@ void BlockPool::Data::IntRequestInternalMemory(
             << " soft_ram_limit_=" << soft_ram_limit_
             << " hard_ram_limit_=" << hard_ram_limit_
             << pin_count_
-            << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+            << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
             << " swapped_.size()=" << swapped_.size();
 
         if (writing_bytes_ == 0 &&
@@ -1149,7 +1619,7 @@ void BlockPool::Data::IntRequestInternalMemory(
                  << " soft_ram_limit_=" << soft_ram_limit_
                  << " hard_ram_limit_=" << hard_ram_limit_
                  << pin_count_
-                 << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+                 << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
                  << " swapped_.size()=" << swapped_.size();
 
             if (writing_bytes_ == last_writing_bytes) {
@@ -1167,6 +1637,24 @@ void BlockPool::Data::IntRequestInternalMemory(
     total_ram_bytes_ += size;
 }
 
+void BlockPool::Data::IntSignalReclaim() {
+    ++reclaim_signals_;
+    for (auto& it : reclaim_callbacks_)
+        it.second();
+}
+
+size_t BlockPool::RegisterReclaimCallback(const ReclaimCallback& callback) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t id = d_->next_reclaim_id_++;
+    d_->reclaim_callbacks_.emplace(id, callback);
+    return id;
+}
+
+void BlockPool::UnregisterReclaimCallback(size_t id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    die_unless(d_->reclaim_callbacks_.erase(id) == 1);
+}
+
 void BlockPool::AdviseFree(size_t size) {
     std::unique_lock<std::mutex> lock(mutex_);
 
@@ -1179,14 +1667,14 @@ void BlockPool::AdviseFree(size_t size) {
         << " soft_ram_limit_=" << d_->soft_ram_limit_
         << " hard_ram_limit_=" << d_->hard_ram_limit_
         << d_->pin_count_
-        << " unpinned_blocks_.size()=" << d_->unpinned_blocks_.size()
+        << " unpinned_blocks_.size()=" << d_->unpinned_blocks_->size()
         << " swapped_.size()=" << d_->swapped_.size();
 
-    while (d_->soft_ram_limit_ != 0 && d_->unpinned_blocks_.size() &&
+    while (d_->soft_ram_limit_ != 0 && d_->unpinned_blocks_->size() &&
            d_->total_ram_bytes_ + d_->requested_bytes_ + size > d_->hard_ram_limit_ + d_->writing_bytes_)
     {
         // evict blocks: schedule async writing which increases writing_bytes_.
-        d_->IntEvictBlockLRU();
+        d_->IntEvictUnpinnedBlock();
     }
 }
 void BlockPool::ReleaseInternalMemory(size_t size) {
@@ -1212,8 +1700,8 @@ void BlockPool::EvictBlock(ByteBlock* block_ptr) {
 
     die_unless(block_ptr->in_memory());
 
-    die_unless(d_->unpinned_blocks_.exists(block_ptr));
-    d_->unpinned_blocks_.erase(block_ptr);
+    die_unless(d_->unpinned_blocks_->exists(block_ptr));
+    d_->unpinned_blocks_->erase(block_ptr);
     d_->unpinned_bytes_ -= block_ptr->size();
 
     d_->IntEvictBlock(block_ptr);
@@ -1225,16 +1713,16 @@ foxxll::request_ptr BlockPool::GetAnyWriting() {
     return d_->writing_.begin()->second;
 }
 
-foxxll::request_ptr BlockPool::EvictBlockLRU() {
+foxxll::request_ptr BlockPool::EvictUnpinnedBlock() {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->IntEvictBlockLRU();
+    return d_->IntEvictUnpinnedBlock();
 }
 
-foxxll::request_ptr BlockPool::Data::IntEvictBlockLRU() {
+foxxll::request_ptr BlockPool::Data::IntEvictUnpinnedBlock() {
 
-    if (!unpinned_blocks_.size()) return foxxll::request_ptr();
+    if (!unpinned_blocks_->size()) return foxxll::request_ptr();
 
-    ByteBlock* block_ptr = unpinned_blocks_.pop();
+    ByteBlock* block_ptr = unpinned_blocks_->pop();
     die_unless(block_ptr);
     unpinned_bytes_ -= block_ptr->size();
 
@@ -1245,6 +1733,10 @@ foxxll::request_ptr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
 
     // die_unless(block_ptr->block_pool_ == this);
 
+    // the block leaves RAM for its job's quota once selected, such that the
+    // next victim is selected with the bytes still being written discounted.
+    IntSubResident(block_ptr);
+
     if (block_ptr->ext_file_) {
         // if in external file -> free memory without writing
 
@@ -1256,7 +1748,7 @@ foxxll::request_ptr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
         sLOGC(debug_alloc)
             << "ByteBlock deallocate"
             << (void*)block_ptr->data_ << "size" << block_ptr->size();
-        aligned_alloc_.deallocate(block_ptr->data_, block_ptr->size());
+        DeallocateBlockData(block_ptr->data_, block_ptr->size());
         block_ptr->data_ = nullptr;
 
         IntReleaseInternalMemory(block_ptr->size());
@@ -1271,11 +1763,51 @@ foxxll::request_ptr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
         notify_em_used_ = true;
     }
 
+    if (mmap_spill_) {
+        // copy into the mmap spill area, unless it cannot grow anymore.
+        if (Byte* slot = mmap_spill_->Allocate(block_ptr->size())) {
+            IntEvictBlockMmap(block_ptr, slot);
+            return foxxll::request_ptr();
+        }
+    }
+
     die_unless(block_ptr->em_bid_.storage == nullptr);
 
-    // allocate EM block
-    block_ptr->em_bid_.size = block_ptr->size();
-    bm_->new_block(foxxll::fully_random(), block_ptr->em_bid_);
+    Byte* write_data = block_ptr->data_;
+    size_t write_size = block_ptr->size();
+
+    if (spill_compression_.enabled()) {
+        // compress into a temporary buffer, which is written instead of the
+        // Block's data if it saves at least one aligned unit of I/O.
+        size_t buffer_size = SpillBufferSize(block_ptr->size());
+        Byte* buffer = aligned_alloc_.allocate(buffer_size);
+
+        size_t csize = BlockCompress(
+            block_ptr->data_, block_ptr->size(), buffer, buffer_size);
+        size_t csize_aligned = RoundUpAlign(csize);
+
+        if (csize != 0 && csize_aligned < block_ptr->size()) {
+            spill_compression_.Record(block_ptr->size(), csize);
+            std::fill(buffer + csize, buffer + csize_aligned, 0);
+
+            block_ptr->em_compressed_data_ = buffer;
+            block_ptr->em_compressed_size_ = csize;
+            write_data = buffer;
+            write_size = csize_aligned;
+
+            spill_compress_raw_bytes_ += block_ptr->size();
+            spill_compress_bytes_ += csize_aligned;
+        }
+        else {
+            spill_compression_.Record(block_ptr->size(), 0);
+            aligned_alloc_.deallocate(buffer, buffer_size);
+        }
+    }
+
+    // allocate EM block, striped round-robin across the disks, such that the
+    // writes of consecutive evictions proceed on all disks in parallel.
+    block_ptr->em_bid_.size = write_size;
+    bm_->new_block(foxxll::striping(), block_ptr->em_bid_, next_em_disk_++);
 
     LOGC(debug_em)
         << "EvictBlock(): " << block_ptr << " - " << *block_ptr
@@ -1284,9 +1816,11 @@ foxxll::request_ptr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
     writing_bytes_ += block_ptr->size();
 
     // initiate writing to EM.
+    common::TraceEvent(logger_, 'b', "block_pool", "Evict",
+                       reinterpret_cast<uintptr_t>(block_ptr));
     foxxll::request_ptr req =
         block_ptr->em_bid_.storage->awrite(
-            block_ptr->data_, block_ptr->em_bid_.offset, block_ptr->size(),
+            write_data, block_ptr->em_bid_.offset, write_size,
             // construct an immediate CompletionHandler callback
             foxxll::completion_handler::make<
                 ByteBlock, &ByteBlock::OnWriteComplete>(block_ptr));
@@ -1294,6 +1828,32 @@ foxxll::request_ptr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
     return (writing_[block_ptr] = std::move(req));
 }
 
+void BlockPool::Data::IntEvictBlockMmap(ByteBlock* block_ptr, Byte* slot) {
+
+    LOGC(debug_em)
+        << "EvictBlock(): " << block_ptr << " - " << *block_ptr
+        << " to mmap spill slot " << static_cast<void*>(slot);
+
+    // the copy is done with the mutex held, it only dirties pages of the page
+    // cache, which the kernel writes back later.
+    std::copy(block_ptr->data_, block_ptr->data_ + block_ptr->size(), slot);
+    block_ptr->em_map_ = slot;
+
+    swapped_.insert(block_ptr);
+    swapped_bytes_ += block_ptr->size();
+    unpinned_blocks_->swap_out_blocks_++;
+    IntCountEvicted(block_ptr);
+
+    // release memory
+    sLOGC(debug_alloc)
+        << "ByteBlock deallocate"
+        << (void*)block_ptr->data_ << "size" << block_ptr->size();
+    DeallocateBlockData(block_ptr->data_, block_ptr->size());
+    block_ptr->data_ = nullptr;
+
+    IntReleaseInternalMemory(block_ptr->size());
+}
+
 void BlockPool::OnWriteComplete(
     ByteBlock* block_ptr, foxxll::request* req, bool success) {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -1302,12 +1862,22 @@ void BlockPool::OnWriteComplete(
         << "OnWriteComplete(): request " << req << " done,"
         << " block " << *block_ptr << " to " << block_ptr->em_bid_
         << " success = " << success;
+
+    common::TraceEvent(logger_, 'e', "block_pool", "Evict",
+                       reinterpret_cast<uintptr_t>(block_ptr));
     req->check_errors();
 
     die_unless(!block_ptr->ext_file_);
     die_unequal(d_->writing_.erase(block_ptr), 1u);
     d_->writing_bytes_ -= block_ptr->size();
 
+    if (block_ptr->em_compressed_data_) {
+        // release buffer of compressed data
+        d_->aligned_alloc_.deallocate(
+            block_ptr->em_compressed_data_, SpillBufferSize(block_ptr->size()));
+        block_ptr->em_compressed_data_ = nullptr;
+    }
+
     if (!success)
     {
         // request was canceled. this is not an I/O error, but intentional,
@@ -1315,13 +1885,16 @@ void BlockPool::OnWriteComplete(
         // written to disk.
 
         if (!block_ptr->is_deleted()) {
-            die_unless(!d_->unpinned_blocks_.exists(block_ptr));
-            d_->unpinned_blocks_.put(block_ptr);
+            die_unless(!d_->unpinned_blocks_->exists(block_ptr));
+            d_->unpinned_blocks_->put(block_ptr);
             d_->unpinned_bytes_ += block_ptr->size();
         }
+        // the data is still in RAM
+        d_->IntAddResident(block_ptr);
 
         d_->bm_->delete_block(block_ptr->em_bid_);
         block_ptr->em_bid_ = foxxll::BID<0>();
+        block_ptr->em_compressed_size_ = 0;
     }
     else
     {
@@ -1329,12 +1902,14 @@ void BlockPool::OnWriteComplete(
 
         d_->swapped_.insert(block_ptr);
         d_->swapped_bytes_ += block_ptr->size();
+        d_->unpinned_blocks_->swap_out_blocks_++;
+        d_->IntCountEvicted(block_ptr);
 
         // release memory
         sLOGC(debug_alloc)
             << "ByteBlock deallocate"
             << (void*)block_ptr->data_ << "size" << block_ptr->size();
-        d_->aligned_alloc_.deallocate(block_ptr->data_, block_ptr->size());
+        d_->DeallocateBlockData(block_ptr->data_, block_ptr->size());
         block_ptr->data_ = nullptr;
 
         d_->IntReleaseInternalMemory(block_ptr->size());
@@ -1372,7 +1947,7 @@ void BlockPool::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << (unpinned_bytes + pinned_bytes + writing_bytes + reading_bytes)
             << "pinned_blocks" << d_->pin_count_.total_pins_
             << "pinned_bytes" << pinned_bytes
-            << "unpinned_blocks" << d_->unpinned_blocks_.size()
+            << "unpinned_blocks" << d_->unpinned_blocks_->size()
             << "unpinned_bytes" << unpinned_bytes
             << "swapped_blocks" << d_->swapped_.size()
             << "swapped_bytes" << d_->swapped_bytes_.hmax_update()
@@ -1382,6 +1957,15 @@ void BlockPool::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << "writing_bytes" << writing_bytes
             << "reading_blocks" << d_->reading_.size()
             << "reading_bytes" << reading_bytes
+            << "spill_compress_raw_bytes" << d_->spill_compress_raw_bytes_
+            << "spill_compress_bytes" << d_->spill_compress_bytes_
+            << "mmap_spill_bytes"
+            << (d_->mmap_spill_ ? d_->mmap_spill_->used_bytes() : 0)
+            << "policy_swap_out_blocks" << d_->unpinned_blocks_->swap_out_blocks_
+            << "policy_swap_in_blocks" << d_->unpinned_blocks_->swap_in_blocks_
+            << "reclaim_signals" << d_->reclaim_signals_
+            << "recycled_bytes" << d_->recycled_bytes_.load()
+            << "recycle_hits" << d_->recycle_hits_.load()
             << "rd_ops_total" << stf.get_read_count()
             << "rd_bytes_total" << stf.get_read_bytes()
             << "wr_ops_total" << stf.get_write_count()
@@ -1395,6 +1979,83 @@ void BlockPool::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << "disk_allocation" << d_->bm_->current_allocation();
 }
 
+void BlockPool::CollectMetrics(common::MetricsWriter& mw) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    foxxll::stats_data stf =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - d_->io_stats_first_;
+
+    size_t pinned_bytes = d_->pin_count_.total_pinned_bytes_;
+
+    mw.Gauge("block_pool_total_bytes", "Bytes of all ByteBlocks.",
+             static_cast<size_t>(d_->total_bytes_));
+    mw.Gauge("block_pool_ram_bytes", "Bytes of ByteBlocks in RAM.",
+             static_cast<size_t>(d_->total_ram_bytes_));
+    mw.Gauge("block_pool_pinned_blocks", "Number of pins of ByteBlocks.",
+             d_->pin_count_.total_pins_);
+    mw.Gauge("block_pool_pinned_bytes", "Bytes of pinned ByteBlocks.",
+             pinned_bytes);
+    mw.Gauge("block_pool_unpinned_bytes", "Bytes of unpinned ByteBlocks.",
+             static_cast<size_t>(d_->unpinned_bytes_));
+    mw.Gauge("block_pool_swapped_bytes", "Bytes of ByteBlocks on disk.",
+             static_cast<size_t>(d_->swapped_bytes_));
+    mw.Gauge("block_pool_writing_bytes", "Bytes being written to disk.",
+             static_cast<size_t>(d_->writing_bytes_));
+    mw.Gauge("block_pool_reading_bytes", "Bytes being read from disk.",
+             static_cast<size_t>(d_->reading_bytes_));
+    mw.Counter("block_pool_reclaim_signals_total",
+               "Number of memory reclaim signals raised.",
+               d_->reclaim_signals_);
+    mw.Counter("block_pool_disk_read_bytes_total", "Bytes read from disk.",
+               stf.get_read_bytes());
+    mw.Counter("block_pool_disk_write_bytes_total", "Bytes written to disk.",
+               stf.get_write_bytes());
+}
+
+void BlockPool::SetEvictionSchedule(const std::vector<size_t>& dia_ids) {
+    SetJobEvictionSchedule(current_job_id(), dia_ids);
+}
+
+/******************************************************************************/
+// Jobs
+
+//! job id of the thread, set by BlockPool::JobScope
+static thread_local size_t s_job_id = 0;
+
+BlockPool::JobScope::JobScope(size_t job_id)
+    : prev_job_id_(s_job_id) {
+    s_job_id = job_id;
+}
+
+BlockPool::JobScope::~JobScope() {
+    s_job_id = prev_job_id_;
+}
+
+size_t BlockPool::current_job_id() {
+    return s_job_id;
+}
+
+void BlockPool::SetJobQuota(size_t job_id, size_t quota) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    d_->unpinned_blocks_->SetQuota(job_id, quota);
+}
+
+size_t BlockPool::job_resident_bytes(size_t job_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return d_->unpinned_blocks_->resident(job_id);
+}
+
+void BlockPool::ReleaseJob(size_t job_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    d_->unpinned_blocks_->ReleaseJob(job_id);
+}
+
+void BlockPool::SetJobEvictionSchedule(
+    size_t job_id, const std::vector<size_t>& dia_ids) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    d_->unpinned_blocks_->SetJobSchedule(job_id, dia_ids);
+}
+
 size_t BlockPool::next_file_id() {
     return ++d_->next_file_id_;
 }
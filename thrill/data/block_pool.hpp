@@ -13,6 +13,7 @@
 #define THRILL_DATA_BLOCK_POOL_HEADER
 
 #include <thrill/common/json_logger.hpp>
+#include <thrill/common/metrics_writer.hpp>
 #include <thrill/common/profile_task.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/data/byte_block.hpp>
@@ -22,8 +23,10 @@
 #include <foxxll/mng/block_manager.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <string>
 #include <utility>
@@ -70,10 +73,30 @@ public:
      * allocated. the BlockPool will create a child manager.
      *
      * \param workers_per_host number of workers on this host.
+     *
+     * \param compress_spills compress Blocks evicted to external memory, if a
+     * compression library is available.
+     *
+     * \param huge_pages carve ByteBlocks of default_block_size out of large
+     * slabs backed by huge pages.
+     *
+     * \param eviction_policy name of the policy selecting unpinned Blocks to
+     * evict: "lru", "mru", or "dia" (see data/eviction_policy.hpp).
+     *
+     * \param mmap_spill_dir if not empty, swap out Blocks into a memory-mapped
+     * file in this directory instead of foxxll's disks.
+     *
+     * \param numa_arenas on machines with multiple NUMA nodes, place the data
+     * of ByteBlocks on the node of the worker they are allocated or swapped in
+     * for.
      */
     BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
               common::JsonLogger* logger,
-              mem::Manager* mem_manager, size_t workers_per_host);
+              mem::Manager* mem_manager, size_t workers_per_host,
+              bool compress_spills = false, bool huge_pages = false,
+              const std::string& eviction_policy = "lru",
+              const std::string& mmap_spill_dir = std::string(),
+              bool numa_arenas = false);
 
     //! Checks that all blocks were freed
     ~BlockPool();
@@ -102,9 +125,74 @@ public:
     //! Return any currently being written block (for waiting on completion)
     foxxll::request_ptr GetAnyWriting();
 
-    //! Evict a Block from the LRU chain into external memory. This can return
-    //! nullptr if no blocks available, or if the Block was not dirty.
-    foxxll::request_ptr EvictBlockLRU();
+    //! Evict the unpinned Block selected by the eviction policy into external
+    //! memory. This can return nullptr if no blocks available, or if the Block
+    //! was not dirty.
+    foxxll::request_ptr EvictUnpinnedBlock();
+
+    //! Pass the dia_ids of the next Stages in order of execution to the
+    //! eviction policy of the calling thread's job. Called by the
+    //! StageBuilder.
+    void SetEvictionSchedule(const std::vector<size_t>& dia_ids);
+
+    //! Callback invoked when the RAM used by ByteBlocks approaches the hard
+    //! limit and no unpinned Blocks are left to evict. It is called from an
+    //! arbitrary thread with the BlockPool's mutex held, hence it must only
+    //! record the request, which the owner answers by freeing memory on its own
+    //! thread.
+    using ReclaimCallback = std::function<void()>;
+
+    //! Register a reclaim callback, returns an id for unregistering it.
+    size_t RegisterReclaimCallback(const ReclaimCallback& callback);
+
+    //! Unregister a reclaim callback. After return it is not invoked anymore.
+    void UnregisterReclaimCallback(size_t id);
+
+    //! \name Jobs
+    //! \{
+
+    /*!
+     * Tags the ByteBlocks allocated by the calling thread with a job id while
+     * the JobScope lives, such that several jobs can share the BlockPool
+     * without one job's spills evicting the others' Blocks. Threads outside a
+     * JobScope, e.g. those of the WorkPool, allocate for the default job 0.
+     */
+    class JobScope
+    {
+    public:
+        explicit JobScope(size_t job_id);
+        ~JobScope();
+
+        //! non-copyable: delete copy-constructor
+        JobScope(const JobScope&) = delete;
+        //! non-copyable: delete assignment operator
+        JobScope& operator = (const JobScope&) = delete;
+
+    private:
+        //! job id of the thread before the scope
+        size_t prev_job_id_;
+    };
+
+    //! job id of the calling thread set by a JobScope, or zero.
+    static size_t current_job_id();
+
+    //! Set the bytes of a job's ByteBlocks in RAM which are protected from
+    //! evictions caused by other jobs, or zero for none. The unpinned Blocks
+    //! of the job exceeding its quota the most are evicted first.
+    void SetJobQuota(size_t job_id, size_t quota);
+
+    //! Bytes of a job's ByteBlocks in RAM.
+    size_t job_resident_bytes(size_t job_id);
+
+    //! Drop the quota of a finished job, its remaining ByteBlocks are still
+    //! counted until deleted.
+    void ReleaseJob(size_t job_id);
+
+    //! Pass the dia_ids of the next Stages of a job to the eviction policy.
+    void SetJobEvictionSchedule(
+        size_t job_id, const std::vector<size_t>& dia_ids);
+
+    //! \}
 
     //! Allocates a byte block with the request size. May block this thread if
     //! the hard memory limit is reached, until memory is freed by another
@@ -117,6 +205,12 @@ public:
     ByteBlockPtr MapExternalBlock(
         const foxxll::file_ptr& file, uint64_t offset, size_t size);
 
+    //! Allocate a byte block as a read-only memory mapping of the range
+    //! [offset,offset+size) of the file descriptor fd, which may be closed
+    //! afterwards. The block is never swapped out, it is paged in by the kernel
+    //! on access, and only counted as RAM while pinned.
+    ByteBlockPtr MmapExternalBlock(int fd, uint64_t offset, size_t size);
+
     //! Increment a ByteBlock's pin count, requires the pin count to be > 0.
     void IncBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id);
 
@@ -160,6 +254,32 @@ public:
     //! Total number of blocks currently begin read from EM.
     size_t reading_blocks() noexcept;
 
+    //! Statistics of completed reads of blocks from EM.
+    struct ReadStats {
+        //! number of bytes read
+        size_t bytes = 0;
+        //! number of completed read requests
+        size_t requests = 0;
+        //! sum of the latencies of the read requests in seconds
+        double latency = 0.0;
+    };
+
+    //! Statistics of all reads of blocks from EM completed so far.
+    ReadStats read_stats() noexcept;
+
+    //! External memory I/O of the Blocks of one DIA node, as tagged by the
+    //! File they were first appended to.
+    struct DiaIoStats {
+        //! number of blocks and bytes swapped out to EM
+        size_t evicted_blocks = 0, evicted_bytes = 0;
+        //! number of blocks and bytes pinned back from EM
+        size_t read_blocks = 0, read_bytes = 0;
+    };
+
+    //! External memory I/O so far, by dia_id. Blocks not in a File of a DIA
+    //! node are counted as dia_id 0.
+    std::map<size_t, DiaIoStats> dia_io_stats();
+
     //! \}
 
     //! \name Methods for ProfileTask
@@ -167,11 +287,19 @@ public:
 
     void RunTask(const std::chrono::steady_clock::time_point& tp) final;
 
+    //! write the current memory and I/O counters as live metrics
+    void CollectMetrics(common::MetricsWriter& mw);
+
     //! \}
 
     //! Pins a block by swapping it in if required.
     PinRequestPtr PinBlock(const Block& block, size_t local_worker_id);
 
+    //! calculate the number of bytes a File reader with automatic prefetch
+    //! should read ahead, derived from the RAM which is neither pinned nor
+    //! requested, in whole Blocks.
+    size_t ReadAheadSize();
+
     //! calculate maximum merging degree from available memory and the number of
     //! files. additionally calculate the prefetch size of each File.
     std::pair<size_t, size_t> MaxMergeDegreePrefetch(size_t num_files);
@@ -251,6 +379,41 @@ private:
     size_t size_;
 };
 
+/*!
+ * RAII class registering a reclaim callback with a BlockPool which sets a flag.
+ * Nodes holding large amounts of memory outside of Blocks, like reduce tables
+ * or sort buffers, poll the flag and flush early when it is raised.
+ */
+class ReclaimFlag
+{
+public:
+    explicit ReclaimFlag(BlockPool& block_pool)
+        : block_pool_(block_pool),
+          id_(block_pool_.RegisterReclaimCallback(
+                  [this]() { flag_.store(true, std::memory_order_relaxed); })) { }
+
+    //! non-copyable: delete copy-constructor
+    ReclaimFlag(const ReclaimFlag&) = delete;
+    //! non-copyable: delete assignment operator
+    ReclaimFlag& operator = (const ReclaimFlag&) = delete;
+
+    ~ReclaimFlag() {
+        block_pool_.UnregisterReclaimCallback(id_);
+    }
+
+    //! check whether the BlockPool asked to free memory and reset the flag.
+    bool test_and_clear() {
+        return flag_.load(std::memory_order_relaxed) &&
+               flag_.exchange(false, std::memory_order_relaxed);
+    }
+
+private:
+    //! set by the callback, declared first as it is used during registration
+    std::atomic<bool> flag_ { false };
+    BlockPool& block_pool_;
+    size_t id_;
+};
+
 //! \}
 
 } // namespace data
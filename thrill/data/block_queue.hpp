@@ -14,7 +14,7 @@
 #define THRILL_DATA_BLOCK_QUEUE_HEADER
 
 #include <thrill/common/atomic_movable.hpp>
-#include <thrill/common/concurrent_bounded_queue.hpp>
+#include <thrill/common/concurrent_mpsc_queue.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/data/block_reader.hpp>
@@ -141,7 +141,8 @@ public:
     Reader GetReader(bool consume, size_t local_worker_id);
 
 private:
-    common::ConcurrentBoundedQueue<Block> queue_;
+    //! lock-free queue of Blocks, written by the single sender of this queue
+    common::ConcurrentMpscQueue<Block> queue_;
 
     common::AtomicMovable<bool> write_closed_ = { false };
 
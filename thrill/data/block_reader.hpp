@@ -16,6 +16,8 @@
 #include <thrill/common/item_serialization_tools.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/data/block.hpp>
+#include <thrill/data/lazy_item.hpp>
+#include <thrill/data/pinned_string_view.hpp>
 #include <thrill/data/serialization.hpp>
 
 #include <tlx/define.hpp>
@@ -23,6 +25,7 @@
 #include <tlx/string/hexdump.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -87,6 +90,14 @@ public:
     template <typename T>
     TLX_ATTRIBUTE_ALWAYS_INLINE
     T Next() {
+        return Next<T>(*this);
+    }
+
+    //! Next() reads a complete item T deserialized through the archive ar,
+    //! which forwards to this BlockReader.
+    template <typename T, typename Archive>
+    TLX_ATTRIBUTE_ALWAYS_INLINE
+    T Next(Archive& ar) {
         assert(HasNext());
         assert(num_items_ > 0);
         --num_items_;
@@ -101,7 +112,7 @@ public:
                     << " got " << tlx::hexdump_type(code));
             }
         }
-        return Serialization<BlockReader, T>::Deserialize(*this);
+        return Serialization<Archive, T>::Deserialize(ar);
     }
 
     //! Next() reads a complete item T, without item counter or self
@@ -113,6 +124,94 @@ public:
         return Serialization<BlockReader, T>::Deserialize(*this);
     }
 
+    /*!
+     * NextBatch() reads up to n items T into the array out and returns the
+     * number of items read, which is less than n only if the reader is
+     * exhausted. Runs of items whose serialization is their object
+     * representation (IsRawSerializable) are copied directly from the pinned
+     * Block, all other items and items split between Blocks are read with
+     * Next().
+     */
+    template <typename T>
+    size_t NextBatch(T* out, size_t n) {
+        size_t done = 0;
+        while (done < n && HasNext()) {
+            if (IsRawSerializable<T>::value &&
+                !(self_verify && typecode_verify_))
+            {
+                size_t run = std::min(
+                    { n - done, num_items_,
+                      static_cast<size_t>(end_ - current_) / sizeof(T) });
+                if (TLX_LIKELY(run != 0)) {
+                    std::memcpy(out + done, current_, run * sizeof(T));
+                    current_ += run * sizeof(T);
+                    num_items_ -= run;
+                    done += run;
+                    continue;
+                }
+            }
+            out[done++] = Next<T>();
+        }
+        return done;
+    }
+
+    /*!
+     * NextStringView() reads a complete std::string item as a PinnedStringView,
+     * which references the bytes inside the current pinned Block instead of
+     * copying them, unless the string is split between Blocks.
+     */
+    PinnedStringView NextStringView() {
+        assert(HasNext());
+        assert(num_items_ > 0);
+        --num_items_;
+
+        if (self_verify && typecode_verify_) {
+            // for self-verification, the string is prefixed with its hash code
+            size_t code = GetRaw<size_t>();
+            if (code != typeid(std::string).hash_code()) {
+                die("BlockReader::NextStringView() attempted to retrieve item "
+                    "with different typeid! - expected "
+                    << tlx::hexdump_type(typeid(std::string).hash_code())
+                    << " got " << tlx::hexdump_type(code));
+            }
+        }
+        return GetStringView();
+    }
+
+    /*!
+     * NextLazy() reads a complete raw serializable item T as a LazyItem, which
+     * references the bytes inside the current Block instead of deserializing
+     * them, unless the item is split between Blocks. The LazyItem is valid
+     * until the next read from this BlockReader.
+     */
+    template <typename T>
+    LazyItem<T> NextLazy() {
+        assert(HasNext());
+        assert(num_items_ > 0);
+        --num_items_;
+
+        if (self_verify && typecode_verify_) {
+            // for self-verification, T is prefixed with its hash code
+            size_t code = GetRaw<size_t>();
+            if (code != typeid(T).hash_code()) {
+                die("BlockReader::NextLazy() attempted to retrieve item "
+                    "with different typeid! - expected "
+                    << tlx::hexdump_type(typeid(T).hash_code())
+                    << " got " << tlx::hexdump_type(code));
+            }
+        }
+
+        LazyItem<T> item;
+        if (TLX_LIKELY(current_ + sizeof(T) <= end_)) {
+            item = LazyItem<T>(current_);
+            current_ += sizeof(T);
+        }
+        else {
+            Read(item.copy_buffer(), sizeof(T));
+        }
+        return item;
+    }
+
     //! HasNext() returns true if at least one more item is available.
     TLX_ATTRIBUTE_ALWAYS_INLINE
     bool HasNext() {
@@ -293,6 +392,19 @@ public:
         return out;
     }
 
+    //! Fetch a string serialized by PutString() as a PinnedStringView into
+    //! the current Block, or as an owned copy if it is split between Blocks.
+    PinnedStringView GetStringView() {
+        size_t size = this->GetVarint();
+        if (TLX_LIKELY(current_ + size <= end_)) {
+            PinnedStringView sv(
+                block_, reinterpret_cast<const char*>(current_), size);
+            current_ += size;
+            return sv;
+        }
+        return PinnedStringView(Read(size));
+    }
+
     //! Advance the cursor given number of bytes without reading them.
     BlockReader& Skip(size_t items, size_t bytes) {
         while (TLX_UNLIKELY(current_ + bytes > end_)) {
@@ -397,6 +509,34 @@ private:
     }
 };
 
+/*!
+ * Read all remaining items T of a reader and call function for each of
+ * them. Items of types with IsRawSerializable are read in batches with
+ * NextBatch(), which the Reader must provide.
+ */
+template <typename T, typename Reader, typename Function>
+void ReadEachItem(Reader& reader, const Function& function, std::false_type) {
+    while (reader.HasNext())
+        function(reader.template Next<T>());
+}
+
+template <typename T, typename Reader, typename Function>
+void ReadEachItem(Reader& reader, const Function& function, std::true_type) {
+    // about one page of items on the stack
+    static constexpr size_t batch_size = std::max<size_t>(1, 4096 / sizeof(T));
+    T batch[batch_size];
+    size_t n;
+    while ((n = reader.template NextBatch<T>(batch, batch_size)) != 0) {
+        for (size_t i = 0; i < n; ++i)
+            function(batch[i]);
+    }
+}
+
+template <typename T, typename Reader, typename Function>
+void ReadEachItem(Reader& reader, const Function& function) {
+    return ReadEachItem<T>(reader, function, IsRawSerializable<T>());
+}
+
 //! \}
 
 } // namespace data
@@ -21,6 +21,7 @@
 #include <tlx/die.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
 #include <string>
 #include <vector>
@@ -216,6 +217,19 @@ public:
             return PutSafe<T>(x);
     }
 
+    //! Put appends a complete item serialized through the archive ar, which
+    //! forwards to this BlockWriter, or fails with a FullException.
+    template <typename T, typename Archive>
+    TLX_ATTRIBUTE_ALWAYS_INLINE
+    BlockWriter& Put(const T& x, Archive& ar) {
+        assert(!closed_);
+
+        if (!BlockSink::allocate_can_fail_)
+            return PutUnsafe<T>(x, ar);
+        else
+            return PutSafe<T>(x, ar);
+    }
+
     //! PutNoSelfVerify appends a complete item without any self
     //! verification information, or fails with a FullException.
     template <typename T>
@@ -233,6 +247,14 @@ public:
     template <typename T, bool NoSelfVerify = false>
     TLX_ATTRIBUTE_ALWAYS_INLINE
     BlockWriter& PutSafe(const T& x) {
+        return PutSafe<T, NoSelfVerify>(x, *this);
+    }
+
+    //! appends a complete item serialized through the archive ar, or fails
+    //! safely with a FullException.
+    template <typename T, bool NoSelfVerify = false, typename Archive>
+    TLX_ATTRIBUTE_ALWAYS_INLINE
+    BlockWriter& PutSafe(const T& x, Archive& ar) {
         assert(!closed_);
 
         if (TLX_UNLIKELY(current_ == end_)) {
@@ -267,7 +289,7 @@ public:
                 // for self-verification, prefix T with its hash code
                 PutRaw(typeid(T).hash_code());
             }
-            Serialization<BlockWriter, T>::Serialize(x, *this);
+            Serialization<Archive, T>::Serialize(x, ar);
 
             // item fully serialized, push out finished blocks.
             while (!sink_queue_.empty()) {
@@ -309,6 +331,14 @@ public:
     template <typename T, bool NoSelfVerify = false>
     TLX_ATTRIBUTE_ALWAYS_INLINE
     BlockWriter& PutUnsafe(const T& x) {
+        return PutUnsafe<T, NoSelfVerify>(x, *this);
+    }
+
+    //! appends a complete item serialized through the archive ar, or aborts
+    //! with a FullException.
+    template <typename T, bool NoSelfVerify = false, typename Archive>
+    TLX_ATTRIBUTE_ALWAYS_INLINE
+    BlockWriter& PutUnsafe(const T& x, Archive& ar) {
         assert(!closed_);
 
         try {
@@ -324,7 +354,7 @@ public:
                 // for self-verification, prefix T with its hash code
                 PutRaw(typeid(T).hash_code());
             }
-            Serialization<BlockWriter, T>::Serialize(x, *this);
+            Serialization<Archive, T>::Serialize(x, ar);
         }
         catch (FullException&) {
             throw std::runtime_error(
@@ -334,6 +364,22 @@ public:
         return *this;
     }
 
+    /*!
+     * PutBatch appends n complete items from the array items. Runs of items
+     * whose serialization is their object representation (IsRawSerializable)
+     * are copied with memcpy into the current Block as far as they fit, other
+     * items are appended with Put(). Only items of the last run may be split
+     * between Blocks.
+     */
+    template <typename T>
+    BlockWriter& PutBatch(const T* items, size_t n) {
+        assert(!closed_);
+
+        if (self_verify || BlockSink::allocate_can_fail_)
+            return PutBatch(items, n, std::false_type());
+        return PutBatch(items, n, IsRawSerializable<T>());
+    }
+
     //! \}
 
     //! \name Appending Write Functions
@@ -405,6 +451,47 @@ public:
     //! \}
 
 private:
+    //! PutBatch for items which must be serialized one by one.
+    template <typename T>
+    BlockWriter& PutBatch(const T* items, size_t n, std::false_type) {
+        for (size_t i = 0; i < n; ++i)
+            Put(items[i]);
+        return *this;
+    }
+
+    //! PutBatch for raw items, into a BlockSink which cannot be full.
+    template <typename T>
+    BlockWriter& PutBatch(const T* items, size_t n, std::true_type) {
+        try {
+            while (n != 0) {
+                if (TLX_UNLIKELY(current_ == end_))
+                    Flush(), AllocateBlock();
+
+                size_t run = std::min(
+                    n, static_cast<size_t>(end_ - current_) / sizeof(T));
+
+                if (TLX_UNLIKELY(run == 0)) {
+                    // the next item is split between two Blocks.
+                    PutUnsafe<T>(*items++), --n;
+                    continue;
+                }
+
+                if (TLX_UNLIKELY(nitems_ == 0))
+                    first_offset_ = current_ - bytes_->begin();
+
+                std::memcpy(current_, items, run * sizeof(T));
+                current_ += run * sizeof(T);
+                nitems_ += run;
+                items += run, n -= run;
+            }
+        }
+        catch (FullException&) {
+            throw std::runtime_error(
+                      "BlockSink was full even though declared infinite");
+        }
+        return *this;
+    }
+
     //! Allocate a new block (overwriting the existing one).
     void AllocateBlock() {
         bytes_ = sink_.AllocateByteBlock(block_size_);
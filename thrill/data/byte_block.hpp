@@ -18,6 +18,7 @@
 #include <foxxll/mng/bid.hpp>
 #include <tlx/counting_ptr.hpp>
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -86,6 +87,9 @@ public:
     //! Returns whether the ByteBlock is in an external file.
     bool has_ext_file() const { return ext_file_.get() != nullptr; }
 
+    //! Returns whether the ByteBlock is a memory-mapped range of a file.
+    bool is_ext_mapped() const { return ext_map_ != nullptr; }
+
     //! return current pin count
     size_t pin_count(size_t local_worker_id) const {
         return pin_count_[local_worker_id];
@@ -110,6 +114,22 @@ public:
     //! decrement pin count, possibly signal block pool that if it reaches zero.
     void DecPinCount(size_t local_worker_id);
 
+    //! dia_id of the DIA node whose File the block was first appended to, or
+    //! zero. Used by the BlockPool's eviction policy.
+    size_t dia_id() const {
+        return dia_id_.load(std::memory_order_relaxed);
+    }
+
+    //! tag block with the dia_id of a File, if it is not tagged yet
+    void set_dia_id(size_t dia_id) {
+        if (dia_id_.load(std::memory_order_relaxed) == 0)
+            dia_id_.store(dia_id, std::memory_order_relaxed);
+    }
+
+    //! id of the job which allocated the block, zero for the default job.
+    //! Used by the BlockPool's per-job quotas.
+    size_t job_id() const { return job_id_; }
+
 private:
     //! the memory block itself is referenced as it is in a a separate memory
     //! region that can be swapped out
@@ -132,10 +152,35 @@ private:
     //! offset into the file, and (unfortunately) also the size.
     foxxll::BID<0> em_bid_;
 
+    //! size of the compressed data in em_bid_, or zero if the block was
+    //! swapped out uncompressed.
+    size_t em_compressed_size_ = 0;
+
+    //! buffer holding the compressed data while it is written to EM.
+    Byte* em_compressed_data_ = nullptr;
+
+    //! slot in the BlockPool's MmapSpillArea holding the data while the block
+    //! is swapped out there, instead of em_bid_.
+    Byte* em_map_ = nullptr;
+
     //! shared pointer to external file, if this is != nullptr then the Block
     //! was created for directly reading binary files.
     foxxll::file_ptr ext_file_;
 
+    //! page-aligned memory mapping of an external file containing data_, if
+    //! this is != nullptr then the Block was created by MmapExternalBlock().
+    Byte* ext_map_ = nullptr;
+
+    //! size of the mapping ext_map_
+    size_t ext_map_size_ = 0;
+
+    //! dia_id of the first File containing the block, written by File without
+    //! holding the BlockPool's mutex.
+    std::atomic<size_t> dia_id_ { 0 };
+
+    //! id of the allocating job, set by the BlockPool on construction
+    size_t job_id_ = 0;
+
     // BlockPool is a friend to call ctor and to manipulate data_.
     friend class BlockPool;
     // Block is a friend to call {Increase,Reduce}PinCount()
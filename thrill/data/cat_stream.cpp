@@ -15,7 +15,6 @@
 #include <thrill/data/multiplexer.hpp>
 #include <thrill/data/multiplexer_header.hpp>
 
-#include <tlx/math/round_to_power_of_two.hpp>
 #include <tlx/string/hexdump.hpp>
 
 #include <algorithm>
@@ -87,12 +86,7 @@ const char* CatStreamData::stream_type() {
 }
 
 CatStreamData::Writers CatStreamData::GetWriters() {
-    size_t hard_ram_limit = multiplexer_.block_pool_.hard_ram_limit();
-    size_t block_size_base = hard_ram_limit / 4
-                             / multiplexer_.num_workers() / multiplexer_.workers_per_host();
-    size_t block_size = tlx::round_down_to_power_of_two(block_size_base);
-    if (block_size == 0 || block_size > default_block_size)
-        block_size = default_block_size;
+    size_t block_size = multiplexer_.WriterBlockSize(MagicByte::CatStreamBlock);
 
     {
         std::unique_lock<std::mutex> lock(multiplexer_.mutex_);
@@ -104,8 +98,6 @@ CatStreamData::Writers CatStreamData::GetWriters() {
 
     LOGC(my_worker_rank() == 0 && 0)
         << "CatStreamData::GetWriters()"
-        << " hard_ram_limit=" << hard_ram_limit
-        << " block_size_base=" << block_size_base
         << " block_size=" << block_size
         << " active_streams=" << multiplexer_.active_streams_
         << " max_active_streams=" << multiplexer_.max_active_streams_;
@@ -190,6 +182,10 @@ CatStreamData::CatReader CatStreamData::GetReader(bool consume) {
     return GetCatReader(consume);
 }
 
+DynBlockReader CatStreamData::GetDynReader(bool consume) {
+    return ConstructDynBlockReader<CatBlockSource>(GetCatBlockSource(consume));
+}
+
 void CatStreamData::Close() {
     if (is_closed_) return;
     is_closed_ = true;
@@ -207,8 +203,15 @@ void CatStreamData::Close() {
     for (size_t i = 0; i < queues_.size() - workers_per_host(); ++i)
         sem_closing_blocks_.wait();
 
+    // with flow control, held Blocks may delay the close of writers
+    WaitWritersClosed();
     die_unless(all_writers_closed_);
 
+    // the average volume per target guides the Block size of later streams
+    multiplexer_.RecordTargetVolume(
+        MagicByte::CatStreamBlock,
+        (tx_net_bytes_ + tx_int_bytes_) / num_workers());
+
     {
         std::unique_lock<std::mutex> lock(multiplexer_.mutex_);
         multiplexer_.active_streams_--;
@@ -242,6 +245,7 @@ struct CatStreamData::SeqReordering {
 
 void CatStreamData::OnStreamBlock(size_t from, uint32_t seq, Block&& b) {
     assert(from < queues_.size());
+    std::unique_lock<std::mutex> lock(rx_mutex_);
     rx_timespan_.StartEventually();
 
     LOG << "OnCatStreamBlock"
@@ -254,8 +258,11 @@ void CatStreamData::OnStreamBlock(size_t from, uint32_t seq, Block&& b) {
              << tlx::hexdump(b.PinWait(local_worker_id_).ToString());
     }
 
+    // out of order, deliver all Blocks immediately, but closing ones only
+    // once all Blocks before them were delivered.
     if (TLX_UNLIKELY(seq != seq_[from].seq_ &&
-                     seq != StreamMultiplexerHeader::final_seq)) {
+                     seq != StreamMultiplexerHeader::final_seq &&
+                     !(out_of_order_ && b.IsValid()))) {
         // sequence mismatch: put into queue
         die_unless(seq >= seq_[from].seq_);
 
@@ -266,7 +273,30 @@ void CatStreamData::OnStreamBlock(size_t from, uint32_t seq, Block&& b) {
     }
 
     OnStreamBlockOrdered(from, std::move(b));
+    OnStreamBlockWaiting(from);
+}
 
+void CatStreamData::set_out_of_order(bool out_of_order) {
+    std::unique_lock<std::mutex> lock(rx_mutex_);
+    out_of_order_ = out_of_order;
+    if (!out_of_order_) return;
+
+    // deliver the Blocks which arrived before and wait for a gap
+    for (size_t from = 0; from < seq_.size(); ++from) {
+        std::map<uint32_t, Block>& waiting = seq_[from].waiting_;
+        for (auto it = waiting.begin(); it != waiting.end(); ) {
+            if (!it->second.IsValid()) {
+                ++it;
+                continue;
+            }
+            OnStreamBlockOrdered(from, std::move(it->second));
+            it = waiting.erase(it);
+        }
+        OnStreamBlockWaiting(from);
+    }
+}
+
+void CatStreamData::OnStreamBlockWaiting(size_t from) {
     // try to process additional queued blocks
     while (!seq_[from].waiting_.empty() &&
            (seq_[from].waiting_.begin()->first == seq_[from].seq_ ||
@@ -358,6 +388,14 @@ CatStream::CatReader CatStream::GetReader(bool consume) {
     return ptr_->GetReader(consume);
 }
 
+DynBlockReader CatStream::GetDynReader(bool consume) {
+    return ptr_->GetDynReader(consume);
+}
+
+void CatStream::set_out_of_order(bool out_of_order) {
+    return ptr_->set_out_of_order(out_of_order);
+}
+
 } // namespace data
 } // namespace thrill
 
@@ -109,6 +109,10 @@ public:
     //! Open a CatReader (function name matches a method in File and MixStream).
     CatReader GetReader(bool consume);
 
+    //! Creates a DynBlockReader which concatenates items from all workers in
+    //! worker rank order, with the same type as a File::Reader.
+    DynBlockReader GetDynReader(bool consume);
+
     //! shuts the stream down.
     void Close() final;
 
@@ -119,9 +123,29 @@ public:
     //! check if inbound queue is closed
     bool is_queue_closed(size_t from);
 
+    /*!
+     * Deliver the Blocks of each sender as they arrive, instead of holding
+     * Blocks with an unexpected sequence number until the gap is filled. This
+     * saves memory and latency when the Blocks are reordered on multiple
+     * lanes, but the Blocks of a sender are then queued in any order.
+     *
+     * Hence, it may only be enabled by consumers processing whole Blocks of
+     * each sender independently, e.g. counting their items via num_items() or
+     * hashing their bytes, by reading them via source().NextBlock() of the
+     * Readers. Item Readers would misparse items spanning Blocks. The closing
+     * of each sender still happens after all its Blocks.
+     */
+    void set_out_of_order(bool out_of_order);
+
+    //! whether Blocks are delivered out of order
+    bool out_of_order() const { return out_of_order_; }
+
 private:
     bool is_closed_ = false;
 
+    //! deliver Blocks as they arrive, protected by rx_mutex_
+    bool out_of_order_ = false;
+
     struct SeqReordering;
 
     //! Block Sequence numbers
@@ -139,6 +163,9 @@ private:
 
     void OnStreamBlockOrdered(size_t from, Block&& b);
 
+    //! deliver the waiting Blocks of a sender which are next in order
+    void OnStreamBlockWaiting(size_t from);
+
     //! Returns the loopback queue for the worker of this stream.
     BlockQueue * loopback_queue(size_t from_worker_id);
 };
@@ -191,6 +218,14 @@ public:
     //! Open a CatReader (function name matches a method in File and MixStream).
     CatReader GetReader(bool consume);
 
+    //! Creates a DynBlockReader which concatenates items from all workers in
+    //! worker rank order, with the same type as a File::Reader.
+    DynBlockReader GetDynReader(bool consume);
+
+    //! Deliver the Blocks of each sender as they arrive, see
+    //! CatStreamData::set_out_of_order().
+    void set_out_of_order(bool out_of_order = true);
+
 private:
     CatStreamDataPtr ptr_;
 };
@@ -0,0 +1,323 @@
+/*******************************************************************************
+ * thrill/data/column_block.hpp
+ *
+ * Column-oriented segments of fixed-size records: ColumnWriter collects rows of
+ * PODs and writes each field of a run of rows as one contiguous array, and
+ * ColumnReader returns these runs as ColumnSegments exposing the field arrays
+ * for vectorized loops.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_COLUMN_BLOCK_HEADER
+#define THRILL_DATA_COLUMN_BLOCK_HEADER
+
+#include <thrill/data/byte_block.hpp>
+#include <thrill/data/serialization.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+namespace detail {
+
+//! whether all Fields are PODs, and the sum of their sizes
+template <typename... Fields>
+struct ColumnFields {
+    static constexpr bool   all_pod = true;
+    static constexpr size_t row_size = 0;
+};
+
+template <typename Field, typename... Fields>
+struct ColumnFields<Field, Fields...> {
+    static constexpr bool   all_pod =
+        std::is_pod<Field>::value && ColumnFields<Fields...>::all_pod;
+    static constexpr size_t row_size =
+        sizeof(Field) + ColumnFields<Fields...>::row_size;
+};
+
+} // namespace detail
+
+/*!
+ * ColumnSegment stores a run of rows std::tuple<Fields...> of PODs column-wise:
+ * one std::vector per field. Loops over column<I>() run over a contiguous array
+ * of one field and are easily vectorized by the compiler.
+ *
+ * A ColumnSegment is serialized as an item of its own: the number of rows
+ * followed by the raw bytes of each column array.
+ */
+template <typename... Fields>
+class ColumnSegment
+{
+    static_assert(sizeof ... (Fields) > 0,
+                  "ColumnSegment needs at least one field");
+    static_assert(detail::ColumnFields<Fields...>::all_pod,
+                  "ColumnSegment requires fields of PODs");
+
+public:
+    //! type of a row
+    using Row = std::tuple<Fields...>;
+
+    //! type of field I
+    template <size_t I>
+    using Field = typename std::tuple_element<I, Row>::type;
+
+    //! number of fields
+    static constexpr size_t num_columns = sizeof ... (Fields);
+
+    //! sum of the field sizes of a row
+    static constexpr size_t row_size = detail::ColumnFields<Fields...>::row_size;
+
+    //! number of rows
+    size_t size() const { return std::get<0>(columns_).size(); }
+
+    //! whether the segment has no rows
+    bool empty() const { return size() == 0; }
+
+    //! remove all rows, keeping the allocated columns
+    void clear() { Apply(Clear()); }
+
+    //! reserve space for n rows in all columns
+    void reserve(size_t n) { Apply(Reserve { n }); }
+
+    //! append a row
+    void push_back(const Row& row) {
+        PushBack(row, std::index_sequence_for<Fields...>());
+    }
+
+    //! reconstruct row i
+    Row row(size_t i) const {
+        return MakeRow(i, std::index_sequence_for<Fields...>());
+    }
+
+    //! array of field I of all rows
+    template <size_t I>
+    const Field<I> * column() const { return std::get<I>(columns_).data(); }
+
+    //! array of field I of all rows
+    template <size_t I>
+    Field<I> * column() { return std::get<I>(columns_).data(); }
+
+    //! sum of field I over all rows
+    template <size_t I>
+    Field<I> Sum() const {
+        const Field<I>* c = column<I>();
+        Field<I> sum = Field<I>();
+        for (size_t i = 0; i < size(); ++i)
+            sum += c[i];
+        return sum;
+    }
+
+    //! \name Serialization via Class Methods
+    //! \{
+
+    static constexpr bool thrill_is_fixed_size = false;
+    static constexpr size_t thrill_fixed_size = 0;
+
+    template <typename Archive>
+    void ThrillSerialize(Archive& ar) const {
+        ar.PutVarint(size());
+        Apply(Write<Archive> { ar });
+    }
+
+    template <typename Archive>
+    static ColumnSegment ThrillDeserialize(Archive& ar) {
+        ColumnSegment seg;
+        seg.ReadFrom(ar);
+        return seg;
+    }
+
+    //! deserialize a segment from ar into this one, reusing its columns
+    template <typename Archive>
+    void ReadFrom(Archive& ar) {
+        size_t n = ar.GetVarint();
+        Apply(Read<Archive> { ar, n });
+    }
+
+    //! \}
+
+private:
+    //! the columns
+    std::tuple<std::vector<Fields>...> columns_;
+
+    struct Clear {
+        template <typename T>
+        void operator () (std::vector<T>& c) const { c.clear(); }
+    };
+
+    struct Reserve {
+        size_t n;
+        template <typename T>
+        void operator () (std::vector<T>& c) const { c.reserve(n); }
+    };
+
+    template <typename Archive>
+    struct Write {
+        Archive& ar;
+        template <typename T>
+        void operator () (const std::vector<T>& c) const {
+            ar.Append(c.data(), c.size() * sizeof(T));
+        }
+    };
+
+    template <typename Archive>
+    struct Read {
+        Archive& ar;
+        size_t n;
+        template <typename T>
+        void operator () (std::vector<T>& c) const {
+            c.resize(n);
+            ar.Read(c.data(), n * sizeof(T));
+        }
+    };
+
+    //! call f for each column
+    template <typename Functor>
+    void Apply(const Functor& f) {
+        ApplyImpl(f, std::index_sequence_for<Fields...>());
+    }
+
+    template <typename Functor>
+    void Apply(const Functor& f) const {
+        ApplyImpl(f, std::index_sequence_for<Fields...>());
+    }
+
+    template <typename Functor, size_t... Is>
+    void ApplyImpl(const Functor& f, std::index_sequence<Is...>) {
+        int dummy[] = { (f(std::get<Is>(columns_)), 0) ... };
+        (void)dummy;
+    }
+
+    template <typename Functor, size_t... Is>
+    void ApplyImpl(const Functor& f, std::index_sequence<Is...>) const {
+        int dummy[] = { (f(std::get<Is>(columns_)), 0) ... };
+        (void)dummy;
+    }
+
+    template <size_t... Is>
+    void PushBack(const Row& row, std::index_sequence<Is...>) {
+        int dummy[] = {
+            (std::get<Is>(columns_).push_back(std::get<Is>(row)), 0) ...
+        };
+        (void)dummy;
+    }
+
+    template <size_t... Is>
+    Row MakeRow(size_t i, std::index_sequence<Is...>) const {
+        return Row(std::get<Is>(columns_)[i] ...);
+    }
+};
+
+/*!
+ * ColumnWriter collects rows std::tuple<Fields...> of PODs and writes them to a
+ * BlockWriter as ColumnSegments of segment_rows rows. By default, a segment
+ * fills about one Block of default_block_size. The last partial segment is
+ * written by Flush() or the destructor.
+ */
+template <typename Writer, typename... Fields>
+class ColumnWriter
+{
+public:
+    using Segment = ColumnSegment<Fields...>;
+    using Row = typename Segment::Row;
+
+    explicit ColumnWriter(Writer& writer, size_t segment_rows = 0)
+        : writer_(writer),
+          segment_rows_(
+              segment_rows ? segment_rows
+              : std::max(default_block_size / Segment::row_size, size_t(1))) {
+        segment_.reserve(segment_rows_);
+    }
+
+    //! non-copyable: delete copy-constructor
+    ColumnWriter(const ColumnWriter&) = delete;
+    //! non-copyable: delete assignment operator
+    ColumnWriter& operator = (const ColumnWriter&) = delete;
+
+    //! flush the last partial segment
+    ~ColumnWriter() { Flush(); }
+
+    //! append a row, which writes a segment if it is full.
+    ColumnWriter& Put(const Row& row) {
+        segment_.push_back(row);
+        if (segment_.size() >= segment_rows_)
+            Flush();
+        return *this;
+    }
+
+    //! write the current partial segment, if it is not empty.
+    void Flush() {
+        if (segment_.empty()) return;
+        writer_.Put(segment_);
+        segment_.clear();
+    }
+
+    //! number of rows per segment
+    size_t segment_rows() const { return segment_rows_; }
+
+private:
+    //! underlying BlockWriter
+    Writer& writer_;
+
+    //! number of rows per segment
+    size_t segment_rows_;
+
+    //! current segment
+    Segment segment_;
+};
+
+/*!
+ * ColumnReader reads the ColumnSegments written by a ColumnWriter from a
+ * BlockReader one at a time.
+ */
+template <typename Reader, typename... Fields>
+class ColumnReader
+{
+public:
+    using Segment = ColumnSegment<Fields...>;
+    using Row = typename Segment::Row;
+
+    explicit ColumnReader(Reader& reader) : reader_(reader) { }
+
+    //! non-copyable: delete copy-constructor
+    ColumnReader(const ColumnReader&) = delete;
+    //! non-copyable: delete assignment operator
+    ColumnReader& operator = (const ColumnReader&) = delete;
+
+    //! HasNext() returns true if at least one more segment is available.
+    bool HasNext() { return reader_.HasNext(); }
+
+    //! read the next segment, which stays valid until the following call.
+    const Segment& NextSegment() {
+        segment_ = reader_.template Next<Segment>();
+        return segment_;
+    }
+
+private:
+    //! underlying BlockReader
+    Reader& reader_;
+
+    //! current segment
+    Segment segment_;
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_COLUMN_BLOCK_HEADER
+
+/******************************************************************************/
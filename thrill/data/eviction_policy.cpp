@@ -0,0 +1,246 @@
+/*******************************************************************************
+ * thrill/data/eviction_policy.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/eviction_policy.hpp>
+
+#include <tlx/die.hpp>
+
+#include <iterator>
+
+namespace thrill {
+namespace data {
+
+/******************************************************************************/
+// EvictionList
+
+void EvictionList::push_back(ByteBlock* bb) {
+    die_unless(!map_.count(bb));
+    list_.push_back(bb);
+    map_.emplace(bb, std::prev(list_.end()));
+}
+
+void EvictionList::erase(ByteBlock* bb) {
+    auto it = map_.find(bb);
+    die_unless(it != map_.end());
+    list_.erase(it->second);
+    map_.erase(it);
+}
+
+ByteBlock* EvictionList::pop_front() {
+    die_unless(!list_.empty());
+    ByteBlock* bb = list_.front();
+    list_.pop_front();
+    map_.erase(bb);
+    return bb;
+}
+
+ByteBlock* EvictionList::pop_back() {
+    die_unless(!list_.empty());
+    ByteBlock* bb = list_.back();
+    list_.pop_back();
+    map_.erase(bb);
+    return bb;
+}
+
+/******************************************************************************/
+// DiaEvictionPolicy
+
+void DiaEvictionPolicy::put(ByteBlock* bb) {
+    die_unless(!where_.count(bb));
+    pending_.push_back(bb);
+    where_[bb] = kPending;
+}
+
+bool DiaEvictionPolicy::exists(ByteBlock* bb) const {
+    return where_.count(bb) != 0;
+}
+
+void DiaEvictionPolicy::erase(ByteBlock* bb) {
+    auto it = where_.find(bb);
+    die_unless(it != where_.end());
+
+    if (it->second == kPending) {
+        pending_.erase(bb);
+    }
+    else {
+        auto b = buckets_.find(it->second);
+        b->second.erase(bb);
+        if (b->second.empty())
+            buckets_.erase(b);
+    }
+    where_.erase(it);
+}
+
+ByteBlock* DiaEvictionPolicy::pop() {
+    // sort new blocks into buckets by their current dia_id.
+    while (!pending_.empty()) {
+        ByteBlock* bb = pending_.pop_front();
+        size_t dia_id = bb->dia_id();
+        buckets_[dia_id].push_back(bb);
+        where_[bb] = dia_id;
+    }
+
+    die_unless(!buckets_.empty());
+
+    // select node whose Files are used furthest in the future.
+    auto victim = buckets_.begin();
+    size_t victim_dist = Distance(victim->first);
+    for (auto it = std::next(buckets_.begin()); it != buckets_.end(); ++it) {
+        size_t dist = Distance(it->first);
+        if (dist > victim_dist) {
+            victim = it;
+            victim_dist = dist;
+        }
+    }
+
+    ByteBlock* bb = victim->second.pop_back();
+    if (victim->second.empty())
+        buckets_.erase(victim);
+    where_.erase(bb);
+    return bb;
+}
+
+void DiaEvictionPolicy::SetSchedule(const std::vector<size_t>& dia_ids) {
+    schedule_.clear();
+    for (size_t i = 0; i < dia_ids.size(); ++i)
+        schedule_.emplace(dia_ids[i], i);
+}
+
+size_t DiaEvictionPolicy::Distance(size_t dia_id) const {
+    if (dia_id == 0) return 0;
+    auto it = schedule_.find(dia_id);
+    if (it == schedule_.end()) return size_t(-1);
+    // +1 to order blocks of the next Stage after untagged blocks.
+    return it->second + 1;
+}
+
+/******************************************************************************/
+// JobEvictionPolicy
+
+JobEvictionPolicy::JobEvictionPolicy(const std::string& inner_name)
+    : inner_name_(inner_name) {
+    default_name_ = GetJob(0).unpinned->name();
+}
+
+JobEvictionPolicy::Job& JobEvictionPolicy::GetJob(size_t job_id) {
+    auto it = jobs_.find(job_id);
+    if (it != jobs_.end()) return it->second;
+
+    Job& job = jobs_[job_id];
+    job.unpinned = MakeEvictionPolicy(inner_name_);
+    die_unless(job.unpinned);
+    return job;
+}
+
+void JobEvictionPolicy::MaybeEraseJob(JobMap::iterator it) {
+    if (it->second.released && it->second.resident == 0 &&
+        it->second.unpinned->size() == 0)
+        jobs_.erase(it);
+}
+
+void JobEvictionPolicy::put(ByteBlock* bb) {
+    GetJob(bb->job_id()).unpinned->put(bb);
+    ++size_;
+}
+
+bool JobEvictionPolicy::exists(ByteBlock* bb) const {
+    auto it = jobs_.find(bb->job_id());
+    return it != jobs_.end() && it->second.unpinned->exists(bb);
+}
+
+void JobEvictionPolicy::erase(ByteBlock* bb) {
+    auto it = jobs_.find(bb->job_id());
+    die_unless(it != jobs_.end());
+    it->second.unpinned->erase(bb);
+    --size_;
+    MaybeEraseJob(it);
+}
+
+ByteBlock* JobEvictionPolicy::pop() {
+    die_unless(size_ != 0);
+
+    // select the job whose resident bytes exceed its quota the most, the
+    // comparison a.resident - a.quota > b.resident - b.quota is rearranged to
+    // avoid negative values. Ties go to the smaller job id.
+    JobMap::iterator victim = jobs_.end();
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+        if (it->second.unpinned->size() == 0) continue;
+        if (victim == jobs_.end()) {
+            victim = it;
+            continue;
+        }
+        const Job& a = it->second;
+        const Job& b = victim->second;
+        size_t lhs = a.resident + b.quota, rhs = b.resident + a.quota;
+        if (lhs > rhs || (lhs == rhs && it->first < victim->first))
+            victim = it;
+    }
+    die_unless(victim != jobs_.end());
+
+    ByteBlock* bb = victim->second.unpinned->pop();
+    --size_;
+    return bb;
+}
+
+void JobEvictionPolicy::SetJobSchedule(
+    size_t job_id, const std::vector<size_t>& dia_ids) {
+    GetJob(job_id).unpinned->SetSchedule(dia_ids);
+}
+
+void JobEvictionPolicy::SetQuota(size_t job_id, size_t quota) {
+    GetJob(job_id).quota = quota;
+}
+
+size_t JobEvictionPolicy::quota(size_t job_id) const {
+    auto it = jobs_.find(job_id);
+    return it != jobs_.end() ? it->second.quota : 0;
+}
+
+void JobEvictionPolicy::AddResident(size_t job_id, size_t size) {
+    GetJob(job_id).resident += size;
+}
+
+void JobEvictionPolicy::SubResident(size_t job_id, size_t size) {
+    auto it = jobs_.find(job_id);
+    die_unless(it != jobs_.end());
+    die_unless(it->second.resident >= size);
+    it->second.resident -= size;
+    MaybeEraseJob(it);
+}
+
+size_t JobEvictionPolicy::resident(size_t job_id) const {
+    auto it = jobs_.find(job_id);
+    return it != jobs_.end() ? it->second.resident : 0;
+}
+
+void JobEvictionPolicy::ReleaseJob(size_t job_id) {
+    // the default job is never released
+    if (job_id == 0) return;
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end()) return;
+    it->second.quota = 0;
+    it->second.released = true;
+    MaybeEraseJob(it);
+}
+
+/******************************************************************************/
+
+std::unique_ptr<EvictionPolicy> MakeEvictionPolicy(const std::string& name) {
+    if (name == "lru")
+        return std::make_unique<LruEvictionPolicy>();
+    if (name == "mru")
+        return std::make_unique<MruEvictionPolicy>();
+    if (name == "dia")
+        return std::make_unique<DiaEvictionPolicy>();
+    return nullptr;
+}
+
+} // namespace data
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * thrill/data/eviction_policy.hpp
+ *
+ * Policies selecting which unpinned ByteBlock the BlockPool evicts next.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_EVICTION_POLICY_HEADER
+#define THRILL_DATA_EVICTION_POLICY_HEADER
+
+#include <thrill/data/byte_block.hpp>
+#include <thrill/mem/pool.hpp>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * Ordered set of ByteBlock pointers with O(1) insertion at the back, removal of
+ * arbitrary elements, and removal from both ends.
+ */
+class EvictionList
+{
+public:
+    //! append block, which must not be contained
+    void push_back(ByteBlock* bb);
+
+    //! returns true if the block is contained
+    bool exists(ByteBlock* bb) const { return map_.count(bb) != 0; }
+
+    //! remove the block, which must be contained
+    void erase(ByteBlock* bb);
+
+    //! remove and return the first block
+    ByteBlock * pop_front();
+
+    //! remove and return the last block
+    ByteBlock * pop_back();
+
+    //! number of blocks
+    size_t size() const { return map_.size(); }
+
+    //! returns true if no blocks are contained
+    bool empty() const { return map_.empty(); }
+
+private:
+    using List = std::list<ByteBlock*, mem::GPoolAllocator<ByteBlock*> >;
+
+    //! blocks in insertion order
+    List list_;
+
+    //! map from block to its position in list_
+    std::unordered_map<
+        ByteBlock*, List::iterator,
+        std::hash<ByteBlock*>, std::equal_to<>,
+        mem::GPoolAllocator<std::pair<ByteBlock* const, List::iterator> > >
+    map_;
+};
+
+/*!
+ * Interface of the BlockPool's set of unpinned ByteBlocks in RAM, which selects
+ * the next victim to evict into external memory. All methods are called with
+ * the BlockPool's mutex held.
+ */
+class EvictionPolicy
+{
+public:
+    virtual ~EvictionPolicy() { }
+
+    //! name of the policy for logging
+    virtual const char * name() const = 0;
+
+    //! insert a block which was fully unpinned
+    virtual void put(ByteBlock* bb) = 0;
+
+    //! returns true if the block is contained
+    virtual bool exists(ByteBlock* bb) const = 0;
+
+    //! remove a block which is pinned again or deleted
+    virtual void erase(ByteBlock* bb) = 0;
+
+    //! remove and return the block to evict next, the set must not be empty
+    virtual ByteBlock * pop() = 0;
+
+    //! number of contained blocks
+    virtual size_t size() const = 0;
+
+    /*!
+     * Inform the policy about the upcoming StageBuilder schedule: the dia_ids
+     * of the nodes whose Stages run next, in order of execution. Ignored by
+     * policies not using it.
+     */
+    virtual void SetSchedule(const std::vector<size_t>& /* dia_ids */) { }
+
+    //! \name Statistics
+    //! \{
+
+    //! number of blocks swapped out to external memory under this policy
+    size_t swap_out_blocks_ = 0;
+
+    //! number of blocks swapped in from external memory under this policy
+    size_t swap_in_blocks_ = 0;
+
+    //! \}
+};
+
+/*!
+ * Evicts the least recently unpinned block. This is the classic policy, which
+ * keeps recently used data in RAM.
+ */
+class LruEvictionPolicy final : public EvictionPolicy
+{
+public:
+    const char * name() const final { return "lru"; }
+
+    void put(ByteBlock* bb) final { list_.push_back(bb); }
+    bool exists(ByteBlock* bb) const final { return list_.exists(bb); }
+    void erase(ByteBlock* bb) final { list_.erase(bb); }
+    ByteBlock * pop() final { return list_.pop_front(); }
+    size_t size() const final { return list_.size(); }
+
+private:
+    EvictionList list_;
+};
+
+/*!
+ * Evicts the most recently unpinned block. This suits Files which are written
+ * completely and then read once from the front, e.g. runs of Sort, since the
+ * blocks read first stay in RAM.
+ */
+class MruEvictionPolicy final : public EvictionPolicy
+{
+public:
+    const char * name() const final { return "mru"; }
+
+    void put(ByteBlock* bb) final { list_.push_back(bb); }
+    bool exists(ByteBlock* bb) const final { return list_.exists(bb); }
+    void erase(ByteBlock* bb) final { list_.erase(bb); }
+    ByteBlock * pop() final { return list_.pop_back(); }
+    size_t size() const final { return list_.size(); }
+
+private:
+    EvictionList list_;
+};
+
+/*!
+ * Evicts blocks of the Files of the DIA node whose next consuming Stage is
+ * furthest away in the StageBuilder's schedule. Nodes not in the schedule are
+ * considered infinitely far. Blocks not belonging to any DIA node's File
+ * (dia_id zero), e.g. those in flight in Streams, are evicted last. Within a
+ * node, the most recently unpinned block is evicted first, because Files are
+ * read from the front.
+ *
+ * Blocks are tagged with their dia_id when appended to a File, which may
+ * happen after unpinning, hence newly put blocks are only sorted into their
+ * node's bucket when the next victim is selected.
+ */
+class DiaEvictionPolicy final : public EvictionPolicy
+{
+public:
+    const char * name() const final { return "dia"; }
+
+    void put(ByteBlock* bb) final;
+    bool exists(ByteBlock* bb) const final;
+    void erase(ByteBlock* bb) final;
+    ByteBlock * pop() final;
+    size_t size() const final { return where_.size(); }
+
+    void SetSchedule(const std::vector<size_t>& dia_ids) final;
+
+    //! distance of the next Stage using the dia_id's Files
+    size_t Distance(size_t dia_id) const;
+
+private:
+    //! key in where_ for blocks in pending_
+    static constexpr size_t kPending = size_t(-1);
+
+    //! blocks put since the last pop(), not yet sorted into buckets_
+    EvictionList pending_;
+
+    //! blocks per dia_id
+    std::unordered_map<
+        size_t, EvictionList, std::hash<size_t>, std::equal_to<>,
+        mem::GPoolAllocator<std::pair<const size_t, EvictionList> > >
+    buckets_;
+
+    //! map from block to its bucket key or kPending
+    std::unordered_map<
+        ByteBlock*, size_t, std::hash<ByteBlock*>, std::equal_to<>,
+        mem::GPoolAllocator<std::pair<ByteBlock* const, size_t> > >
+    where_;
+
+    //! map from dia_id to position in the current schedule
+    std::unordered_map<
+        size_t, size_t, std::hash<size_t>, std::equal_to<>,
+        mem::GPoolAllocator<std::pair<const size_t, size_t> > >
+    schedule_;
+};
+
+/*!
+ * Partitions the unpinned blocks by the job which allocated them, with one
+ * inner policy per job, such that several jobs can share one BlockPool. Each
+ * job may have a quota: bytes of its blocks in RAM which are protected from
+ * evictions caused by other jobs. The next victim is taken from the job whose
+ * resident blocks exceed its quota the most, and selected by the inner policy
+ * within that job. With a single job, this is just the inner policy.
+ *
+ * The resident bytes are maintained by the BlockPool: a block counts from
+ * allocation or swap-in until it is evicted or deleted.
+ */
+class JobEvictionPolicy final : public EvictionPolicy
+{
+public:
+    //! construct with the name of the inner policy, which must be valid.
+    explicit JobEvictionPolicy(const std::string& inner_name);
+
+    const char * name() const final { return default_name_; }
+
+    void put(ByteBlock* bb) final;
+    bool exists(ByteBlock* bb) const final;
+    void erase(ByteBlock* bb) final;
+    ByteBlock * pop() final;
+    size_t size() const final { return size_; }
+
+    //! set the schedule of the default job 0
+    void SetSchedule(const std::vector<size_t>& dia_ids) final {
+        SetJobSchedule(0, dia_ids);
+    }
+
+    //! set the schedule of the inner policy of a job
+    void SetJobSchedule(size_t job_id, const std::vector<size_t>& dia_ids);
+
+    //! set the protected bytes of a job, zero for none.
+    void SetQuota(size_t job_id, size_t quota);
+
+    //! quota of a job
+    size_t quota(size_t job_id) const;
+
+    //! count a block of the job entering RAM
+    void AddResident(size_t job_id, size_t size);
+
+    //! count a block of the job leaving RAM
+    void SubResident(size_t job_id, size_t size);
+
+    //! bytes of the job's blocks in RAM
+    size_t resident(size_t job_id) const;
+
+    //! drop the quota of a finished job, and its state once it holds no more
+    //! blocks in RAM.
+    void ReleaseJob(size_t job_id);
+
+    //! number of jobs with state, including the default job 0
+    size_t num_jobs() const { return jobs_.size(); }
+
+private:
+    struct Job {
+        //! unpinned blocks of the job
+        std::unique_ptr<EvictionPolicy> unpinned;
+        //! protected bytes
+        size_t quota = 0;
+        //! bytes of blocks in RAM
+        size_t resident = 0;
+        //! whether ReleaseJob() was called
+        bool released = false;
+    };
+
+    using JobMap = std::unordered_map<
+              size_t, Job, std::hash<size_t>, std::equal_to<>,
+              mem::GPoolAllocator<std::pair<const size_t, Job> > >;
+
+    //! get or create the state of a job
+    Job& GetJob(size_t job_id);
+
+    //! erase the state of a released job if it is empty
+    void MaybeEraseJob(JobMap::iterator it);
+
+    //! name of the inner policy
+    std::string inner_name_;
+
+    //! name() of the inner policy of job 0
+    const char* default_name_;
+
+    //! state per job
+    JobMap jobs_;
+
+    //! total number of unpinned blocks
+    size_t size_ = 0;
+};
+
+//! construct eviction policy by name: "lru", "mru", or "dia". Returns nullptr
+//! if the name is unknown.
+std::unique_ptr<EvictionPolicy> MakeEvictionPolicy(const std::string& name);
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_EVICTION_POLICY_HEADER
+
+/******************************************************************************/
@@ -110,10 +110,17 @@ KeepFileBlockSource::KeepFileBlockSource(
     size_t first_block, size_t first_item)
     : file_(file), local_worker_id_(local_worker_id),
       prefetch_size_(prefetch_size),
+      auto_prefetch_(prefetch_size == File::auto_prefetch_size_),
       fetching_bytes_(0),
       first_block_(first_block), current_block_(first_block),
-      first_item_(first_item)
-{ }
+      first_item_(first_item) {
+    UpdateReadAhead();
+}
+
+void KeepFileBlockSource::UpdateReadAhead() {
+    if (auto_prefetch_)
+        prefetch_size_ = file_.block_pool()->ReadAheadSize();
+}
 
 Block KeepFileBlockSource::MakeNextBlock() {
     if (current_block_ == first_block_) {
@@ -129,6 +136,8 @@ Block KeepFileBlockSource::MakeNextBlock() {
 }
 
 void KeepFileBlockSource::Prefetch(size_t prefetch_size) {
+    // an explicit prefetch size overrides automatic read ahead
+    auto_prefetch_ = false;
     if (prefetch_size >= prefetch_size_) {
         prefetch_size_ = prefetch_size;
         // prefetch #desired bytes
@@ -157,6 +166,8 @@ PinnedBlock KeepFileBlockSource::NextBlock() {
     }
     else
     {
+        UpdateReadAhead();
+
         // prefetch #desired bytes
         while (fetching_bytes_ < prefetch_size_ &&
                current_block_ < file_.num_blocks())
@@ -200,19 +211,29 @@ ConsumeFileBlockSource::ConsumeFileBlockSource(
     File* file, size_t local_worker_id, size_t prefetch_size)
     : file_(file), local_worker_id_(local_worker_id),
       prefetch_size_(prefetch_size),
+      auto_prefetch_(prefetch_size == File::auto_prefetch_size_),
       fetching_bytes_(0) {
-    Prefetch(prefetch_size_);
+    UpdateReadAhead();
+    // prefetch #desired bytes
+    while (fetching_bytes_ < prefetch_size_ && !file_->blocks_.empty()) {
+        Block& b = file_->blocks_.front();
+        fetching_bytes_ += b.size();
+        fetching_blocks_.emplace_back(b.Pin(local_worker_id_));
+        file_->blocks_.pop_front();
+    }
 }
 
 ConsumeFileBlockSource::ConsumeFileBlockSource(ConsumeFileBlockSource&& s)
     : file_(s.file_), local_worker_id_(s.local_worker_id_),
-      prefetch_size_(s.prefetch_size_),
+      prefetch_size_(s.prefetch_size_), auto_prefetch_(s.auto_prefetch_),
       fetching_blocks_(std::move(s.fetching_blocks_)),
       fetching_bytes_(s.fetching_bytes_) {
     s.file_ = nullptr;
 }
 
 void ConsumeFileBlockSource::Prefetch(size_t prefetch_size) {
+    // an explicit prefetch size overrides automatic read ahead
+    auto_prefetch_ = false;
     if (prefetch_size >= prefetch_size_) {
         prefetch_size_ = prefetch_size;
         // prefetch #desired bytes
@@ -241,6 +262,8 @@ PinnedBlock ConsumeFileBlockSource::NextBlock() {
         return f->Wait();
     }
 
+    UpdateReadAhead();
+
     // prefetch #desired bytes
     while (fetching_bytes_ < prefetch_size_ && !file_->blocks_.empty()) {
         Block& b = file_->blocks_.front();
@@ -275,6 +298,11 @@ Block ConsumeFileBlockSource::NextBlockUnpinned() {
     return b;
 }
 
+void ConsumeFileBlockSource::UpdateReadAhead() {
+    if (auto_prefetch_)
+        prefetch_size_ = file_->block_pool()->ReadAheadSize();
+}
+
 PinnedBlock ConsumeFileBlockSource::AcquirePin(const Block& block) {
     return block.PinWait(local_worker_id_);
 }
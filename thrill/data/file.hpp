@@ -65,6 +65,10 @@ public:
     //! prefetch in File readers
     static size_t default_prefetch_size_;
 
+    //! special prefetch size for File readers: read ahead as many Blocks as
+    //! BlockPool::ReadAheadSize() currently allows.
+    static constexpr size_t auto_prefetch_size_ = size_t(-1);
+
     //! Constructor from BlockPool
     File(BlockPool& block_pool, size_t local_worker_id, size_t dia_id);
 
@@ -87,6 +91,7 @@ public:
     //! items after the offset first.
     void AppendBlock(const Block& b) {
         if (b.size() == 0) return;
+        b.byte_block()->set_dia_id(dia_id_);
         num_items_sum_.push_back(num_items() + b.num_items());
         size_bytes_ += b.size();
         stats_bytes_ += b.size();
@@ -98,6 +103,7 @@ public:
     //! items after the offset first.
     void AppendBlock(Block&& b) {
         if (b.size() == 0) return;
+        b.byte_block()->set_dia_id(dia_id_);
         num_items_sum_.push_back(num_items() + b.num_items());
         size_bytes_ += b.size();
         stats_bytes_ += b.size();
@@ -374,6 +380,9 @@ protected:
     //! NextBlockUnpinned().
     Block MakeNextBlock();
 
+    //! recalculate prefetch_size_ if reading ahead automatically
+    void UpdateReadAhead();
+
 private:
     //! sentinel value for not changing the first_item item
     static constexpr size_t keep_first_item = size_t(-1);
@@ -387,6 +396,9 @@ private:
     //! number of bytes of prefetch for reader
     size_t prefetch_size_;
 
+    //! whether prefetch_size_ is taken from BlockPool::ReadAheadSize()
+    bool auto_prefetch_;
+
     //! current prefetch operations
     std::deque<PinRequestPtr> fetching_blocks_;
 
@@ -416,7 +428,8 @@ class ConsumeFileBlockSource
 public:
     //! Start reading a File. Creates a source for the given file and set the
     //! number of blocks that should be prefetched. 0 means that no blocks are
-    //! prefetched.
+    //! prefetched, File::auto_prefetch_size_ reads ahead depending on the
+    //! available RAM.
     ConsumeFileBlockSource(
         File* file, size_t local_worker_id,
         size_t prefetch_size = File::default_prefetch_size_);
@@ -445,6 +458,9 @@ public:
     ~ConsumeFileBlockSource();
 
 private:
+    //! recalculate prefetch_size_ if reading ahead automatically
+    void UpdateReadAhead();
+
     //! file to consume blocks from (ptr to make moving easier)
     File* file_;
 
@@ -454,6 +470,9 @@ private:
     //! number of bytes of prefetch for reader
     size_t prefetch_size_;
 
+    //! whether prefetch_size_ is taken from BlockPool::ReadAheadSize()
+    bool auto_prefetch_;
+
     //! current prefetch operations
     std::deque<PinRequestPtr> fetching_blocks_;
 
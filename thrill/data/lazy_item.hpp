@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * thrill/data/lazy_item.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_LAZY_ITEM_HEADER
+#define THRILL_DATA_LAZY_ITEM_HEADER
+
+#include <thrill/data/byte_block.hpp>
+#include <thrill/data/serialization.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * LazyItem is a not yet deserialized item of a fixed-layout type T, whose
+ * serialization is its object representation (IsRawSerializable). It
+ * references the item's bytes inside the reader's current Block, such that
+ * single fields, e.g. the key, can be loaded for comparisons or hashing
+ * without copying the whole item. Items split between two Blocks are copied
+ * into the LazyItem instead.
+ *
+ * Unlike PinnedStringView, a LazyItem does not pin its Block: it is valid only
+ * until the next read from the BlockReader which delivered it, see
+ * BlockReader::NextLazy().
+ */
+template <typename T>
+class LazyItem
+{
+    static_assert(IsRawSerializable<T>::value,
+                  "LazyItem requires a raw serializable item type");
+
+public:
+    //! create an empty lazy item
+    LazyItem() = default;
+
+    //! reference the item's bytes at data
+    explicit LazyItem(const Byte* data)
+        : data_(data) { }
+
+    LazyItem(const LazyItem& b) { *this = b; }
+
+    LazyItem& operator = (const LazyItem& b) {
+        if (b.owned()) {
+            std::memcpy(copy_, b.copy_, sizeof(T));
+            data_ = nullptr;
+        }
+        else {
+            data_ = b.data_;
+        }
+        return *this;
+    }
+
+    //! storage for a copy of an item split between Blocks
+    Byte * copy_buffer() { data_ = nullptr; return copy_; }
+
+    //! whether the item was copied instead of referenced
+    bool owned() const { return data_ == nullptr; }
+
+    //! pointer to the item's bytes, which may be unaligned
+    const Byte * data() const { return owned() ? copy_ : data_; }
+
+    //! load a field of type Field at the given byte offset in the item
+    template <typename Field>
+    Field Load(size_t offset) const {
+        static_assert(std::is_trivially_copyable<Field>::value,
+                      "only trivially copyable fields can be loaded");
+        assert(offset + sizeof(Field) <= sizeof(T));
+        Field f;
+        std::memcpy(&f, data() + offset, sizeof(Field));
+        return f;
+    }
+
+    //! load the field member of the item, e.g. Get(&Item::key).
+    template <typename Field>
+    Field Get(Field T::* member) const {
+        return Load<Field>(Offset(member));
+    }
+
+    //! deserialize the complete item
+    T Materialize() const {
+        T t;
+        std::memcpy(static_cast<void*>(&t), data(), sizeof(T));
+        return t;
+    }
+
+    //! byte offset of the field member in the object representation of T
+    template <typename Field>
+    static size_t Offset(Field T::* member) {
+        static const T probe { };
+        return static_cast<size_t>(
+            reinterpret_cast<const Byte*>(&(probe.*member))
+            - reinterpret_cast<const Byte*>(&probe));
+    }
+
+private:
+    //! referenced bytes inside a Block, or nullptr if copied into copy_
+    const Byte* data_ = nullptr;
+
+    //! copy of items split between two Blocks
+    alignas(T) Byte copy_[sizeof(T)];
+};
+
+/*!
+ * Key extractor and comparator on a field of LazyItem<T> and of T, such that
+ * the same functor works on lazy and on deserialized items.
+ */
+template <typename T, typename Field, Field T::* Member,
+          typename Compare = std::less<Field> >
+class LazyField
+{
+public:
+    //! load the field of a lazy item
+    Field operator () (const LazyItem<T>& item) const {
+        return item.Get(Member);
+    }
+
+    //! return the field of a deserialized item
+    const Field& operator () (const T& item) const {
+        return item.*Member;
+    }
+
+    //! compare the fields of two items
+    template <typename A, typename B>
+    bool operator () (const A& a, const B& b) const {
+        return Compare()(operator () (a), operator () (b));
+    }
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_LAZY_ITEM_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,225 @@
+/*******************************************************************************
+ * thrill/data/merge_prefetch_tuner.hpp
+ *
+ * Adaptive selection of merge degree and prefetch size for external multiway
+ * merges based on the observed read throughput of the BlockPool.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_MERGE_PREFETCH_TUNER_HEADER
+#define THRILL_DATA_MERGE_PREFETCH_TUNER_HEADER
+
+#include <thrill/common/logger.hpp>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/file.hpp>
+#include <tlx/define/likely.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * MergePrefetchTuner adapts the merge degree and the prefetch size of external
+ * multiway merges, which BlockPool::MaxMergeDegreePrefetch() otherwise chooses
+ * once from the RAM limit.
+ *
+ * - The merge degree of partial merges is lowered as far as possible without
+ *   increasing the number of merge passes, which leaves more prefetch per File
+ *   in the same amount of RAM.
+ *
+ * - During a merge, the read throughput and latency of the BlockPool are
+ *   sampled periodically. The prefetch size is doubled as long as the
+ *   throughput improves, up to twice the default RAM share of the merge, and
+ *   frozen once the device is saturated.
+ *
+ * The read statistics are host-global, which is what matters for a shared
+ * storage device. Statistics of each merge are returned by Finish() for the
+ * JSON log, also if adaptation is disabled.
+ */
+class MergePrefetchTuner
+{
+    static constexpr bool debug = false;
+
+public:
+    //! statistics of one merge
+    struct MergeStats {
+        //! merge degree
+        size_t degree = 0;
+        //! initial and final prefetch size per File
+        size_t prefetch_begin = 0, prefetch_end = 0;
+        //! bytes and requests read from EM during the merge
+        size_t read_bytes = 0, read_requests = 0;
+        //! duration of the merge and mean latency of the reads in seconds
+        double seconds = 0.0, read_latency = 0.0;
+        //! read throughput in bytes per second
+        double read_throughput = 0.0;
+    };
+
+    MergePrefetchTuner(BlockPool& block_pool, bool adaptive)
+        : block_pool_(block_pool), adaptive_(adaptive) { }
+
+    /*!
+     * Calculate merge degree and prefetch size of each File for merging
+     * num_files Files. If not all Files can be merged at once, then the degree
+     * is the lowest one that needs the same number of merge passes as the
+     * maximum degree.
+     */
+    std::pair<size_t, size_t> MergeDegreePrefetch(size_t num_files) {
+        size_t degree, prefetch;
+        std::tie(degree, prefetch) =
+            block_pool_.MaxMergeDegreePrefetch(num_files);
+
+        if (!adaptive_ || num_files <= degree || degree < 2)
+            return std::make_pair(degree, prefetch);
+
+        size_t passes = MergePasses(num_files, degree);
+        while (degree > 2 && MergePasses(num_files, degree - 1) <= passes)
+            --degree;
+
+        return std::make_pair(degree, RamShare() / degree);
+    }
+
+    //! Start prefetching of a merge of the readers.
+    template <typename Reader>
+    void Start(std::vector<Reader>& readers, size_t prefetch) {
+        StartPrefetch(readers, prefetch);
+
+        stats_ = MergeStats();
+        stats_.degree = readers.size();
+        stats_.prefetch_begin = stats_.prefetch_end = prefetch;
+
+        max_prefetch_ = 2 * RamShare() / std::max<size_t>(readers.size(), 1);
+        frozen_ = (!adaptive_ || prefetch == 0 || prefetch >= max_prefetch_);
+        best_throughput_ = 0.0;
+        counter_ = 0;
+
+        tp_begin_ = tp_last_ = std::chrono::steady_clock::now();
+        stats_begin_ = stats_last_ = block_pool_.read_stats();
+    }
+
+    //! Called for each merged item, periodically samples the read statistics
+    //! and increases the prefetch size of the readers.
+    template <typename Reader>
+    void Tick(std::vector<Reader>& readers) {
+        if (TLX_LIKELY(frozen_ || ++counter_ % check_items_ != 0)) return;
+
+        std::chrono::steady_clock::time_point tp =
+            std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(tp - tp_last_).count();
+        if (seconds < check_interval_) return;
+
+        BlockPool::ReadStats rs = block_pool_.read_stats();
+        size_t requests = rs.requests - stats_last_.requests;
+        if (requests == 0) return;
+
+        double throughput = (rs.bytes - stats_last_.bytes) / seconds;
+
+        sLOG << "MergePrefetchTuner: throughput" << throughput
+             << "latency" << (rs.latency - stats_last_.latency) / requests
+             << "prefetch" << stats_.prefetch_end;
+
+        tp_last_ = tp, stats_last_ = rs;
+
+        if (throughput < best_throughput_ * improvement_) {
+            // no gain from the last increase: device is saturated.
+            frozen_ = true;
+            return;
+        }
+        best_throughput_ = std::max(best_throughput_, throughput);
+
+        stats_.prefetch_end =
+            std::min(2 * stats_.prefetch_end, max_prefetch_);
+        for (Reader& r : readers)
+            r.source().Prefetch(stats_.prefetch_end);
+
+        frozen_ = (stats_.prefetch_end >= max_prefetch_);
+    }
+
+    //! Finish the merge and return its statistics.
+    MergeStats Finish() {
+        BlockPool::ReadStats rs = block_pool_.read_stats();
+        stats_.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - tp_begin_).count();
+        stats_.read_bytes = rs.bytes - stats_begin_.bytes;
+        stats_.read_requests = rs.requests - stats_begin_.requests;
+        if (stats_.read_requests != 0) {
+            stats_.read_latency =
+                (rs.latency - stats_begin_.latency) / stats_.read_requests;
+        }
+        if (stats_.seconds != 0)
+            stats_.read_throughput = stats_.read_bytes / stats_.seconds;
+        return stats_;
+    }
+
+private:
+    //! reference to the host's BlockPool
+    BlockPool& block_pool_;
+
+    //! whether to adapt merge degree and prefetch size
+    bool adaptive_;
+
+    //! number of items between checks of the clock
+    static constexpr size_t check_items_ = 4096;
+
+    //! minimum interval between samples of the read statistics in seconds
+    static constexpr double check_interval_ = 0.1;
+
+    //! throughput factor an increase of the prefetch size must gain
+    static constexpr double improvement_ = 1.05;
+
+    //! statistics of the current merge
+    MergeStats stats_;
+
+    //! maximum prefetch size per File
+    size_t max_prefetch_ = 0;
+
+    //! whether the prefetch size is no longer increased
+    bool frozen_ = true;
+
+    //! best sampled throughput of the current merge
+    double best_throughput_ = 0.0;
+
+    //! item counter
+    size_t counter_ = 0;
+
+    //! time and read statistics at the start and at the last sample
+    std::chrono::steady_clock::time_point tp_begin_, tp_last_;
+    BlockPool::ReadStats stats_begin_, stats_last_;
+
+    //! default RAM share of a merge of a worker, as in MaxMergeDegreePrefetch()
+    size_t RamShare() {
+        return block_pool_.hard_ram_limit() /
+               block_pool_.workers_per_host() / 2;
+    }
+
+    //! number of merge passes to merge num_files with the given degree
+    static size_t MergePasses(size_t num_files, size_t degree) {
+        size_t passes = 0;
+        while (num_files > 1) {
+            num_files = (num_files + degree - 1) / degree;
+            ++passes;
+        }
+        return passes;
+    }
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_MERGE_PREFETCH_TUNER_HEADER
+
+/******************************************************************************/
@@ -13,7 +13,7 @@
 #define THRILL_DATA_MIX_BLOCK_QUEUE_HEADER
 
 #include <thrill/common/atomic_movable.hpp>
-#include <thrill/common/concurrent_bounded_queue.hpp>
+#include <thrill/common/concurrent_mpsc_queue.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/data/block_queue.hpp>
@@ -22,6 +22,7 @@
 #include <thrill/data/dyn_block_reader.hpp>
 #include <thrill/data/file.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace thrill {
@@ -41,7 +42,8 @@ using MixStreamDataPtr = tlx::CountingPtr<MixStreamData>;
  *
  * When Blocks arrive from the net, the Multiplexer pushes (src, Blocks) pairs
  * to MixChannel, which pushes them into a MixBlockQueue. The
- * MixBlockQueue stores these in a ConcurrentBoundedQueue for atomic reading.
+ * MixBlockQueue stores these in a lock-free ConcurrentMpscQueue, since the
+ * dispatcher thread and local workers deliver Blocks concurrently.
  *
  * When the MixChannel should be read, MixBlockQueueReader is used, which
  * retrieves Blocks from the queue. The Reader contains one complete BlockReader
@@ -121,7 +123,7 @@ private:
     size_t local_worker_id_;
 
     //! the main mix queue, containing the block in the reception order.
-    common::ConcurrentBoundedQueue<SrcBlockPair> mix_queue_;
+    common::ConcurrentMpscQueue<SrcBlockPair> mix_queue_;
 
     //! total number of workers in system.
     size_t num_workers_;
@@ -215,6 +217,24 @@ public:
         }
     }
 
+    //! NextBatch() reads up to n items T into the array out and returns the
+    //! number of items read, see BlockReader::NextBatch().
+    template <typename T>
+    size_t NextBatch(T* out, size_t n) {
+        if (reread_)
+            return cat_reader_.template NextBatch<T>(out, n);
+
+        size_t done = 0;
+        while (done < n && HasNext()) {
+            assert(available_ > 0);
+            size_t k = readers_[selected_].template NextBatch<T>(
+                out + done, std::min(n - done, available_));
+            available_ -= k;
+            done += k;
+        }
+        return done;
+    }
+
 private:
     //! reference to mix queue
     MixBlockQueue& mix_queue_;
@@ -15,8 +15,6 @@
 #include <thrill/data/multiplexer.hpp>
 #include <thrill/data/multiplexer_header.hpp>
 
-#include <tlx/math/round_to_power_of_two.hpp>
-
 #include <algorithm>
 #include <map>
 #include <vector>
@@ -50,12 +48,7 @@ const char* MixStreamData::stream_type() {
 }
 
 MixStreamData::Writers MixStreamData::GetWriters() {
-    size_t hard_ram_limit = multiplexer_.block_pool_.hard_ram_limit();
-    size_t block_size_base = hard_ram_limit / 4
-                             / multiplexer_.num_workers() / multiplexer_.workers_per_host();
-    size_t block_size = tlx::round_down_to_power_of_two(block_size_base);
-    if (block_size == 0 || block_size > default_block_size)
-        block_size = default_block_size;
+    size_t block_size = multiplexer_.WriterBlockSize(MagicByte::MixStreamBlock);
 
     {
         std::unique_lock<std::mutex> lock(multiplexer_.mutex_);
@@ -67,8 +60,6 @@ MixStreamData::Writers MixStreamData::GetWriters() {
 
     LOGC(my_worker_rank() == 0 && 0)
         << "MixStreamData::GetWriters()"
-        << " hard_ram_limit=" << hard_ram_limit
-        << " block_size_base=" << block_size_base
         << " block_size=" << block_size
         << " active_streams=" << multiplexer_.active_streams_
         << " max_active_streams=" << multiplexer_.max_active_streams_;
@@ -133,8 +124,15 @@ void MixStreamData::Close() {
         sem_closing_blocks_.wait();
     }
 
+    // with flow control, held Blocks may delay the close of writers
+    WaitWritersClosed();
     die_unless(all_writers_closed_);
 
+    // the average volume per target guides the Block size of later streams
+    multiplexer_.RecordTargetVolume(
+        MagicByte::MixStreamBlock,
+        (tx_net_bytes_ + tx_int_bytes_) / num_workers());
+
     {
         std::unique_lock<std::mutex> lock(multiplexer_.mutex_);
         multiplexer_.active_streams_--;
@@ -167,6 +165,7 @@ struct MixStreamData::SeqReordering {
 
 void MixStreamData::OnStreamBlock(size_t from, uint32_t seq, Block&& b) {
     assert(from < num_workers());
+    std::unique_lock<std::mutex> lock(rx_mutex_);
     rx_timespan_.StartEventually();
 
     sLOG << "MixStreamData::OnStreamBlock" << b
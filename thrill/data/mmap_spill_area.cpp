@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * thrill/data/mmap_spill_area.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/mmap_spill_area.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/system_exception.hpp>
+
+#include <tlx/die.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace thrill {
+namespace data {
+
+static constexpr bool debug = false;
+
+MmapSpillArea::MmapSpillArea(const std::string& dir, size_t region_size)
+    : region_size_(region_size) {
+    std::string path = dir + "/thrill-spill-XXXXXX";
+    fd_ = ::mkstemp(&path[0]);
+    if (fd_ < 0)
+        throw common::ErrnoException(
+                  "Could not create spill file " + path, errno);
+
+    // unlink immediately, the file is removed when closed.
+    if (::unlink(path.c_str()) != 0)
+        throw common::ErrnoException(
+                  "Could not unlink spill file " + path, errno);
+
+    LOG << "MmapSpillArea: created spill file in " << dir;
+}
+
+MmapSpillArea::~MmapSpillArea() {
+    for (uint8_t* r : regions_)
+        ::munmap(r, region_size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+bool MmapSpillArea::AddRegion() {
+    size_t offset = regions_.size() * region_size_;
+
+    if (::ftruncate(fd_, static_cast<off_t>(offset + region_size_)) != 0) {
+        LOG1 << "MmapSpillArea: could not grow spill file: "
+             << strerror(errno);
+        return false;
+    }
+
+    void* ptr = ::mmap(nullptr, region_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd_, static_cast<off_t>(offset));
+    if (ptr == MAP_FAILED) {
+        LOG1 << "MmapSpillArea: could not map spill file region: "
+             << strerror(errno);
+        return false;
+    }
+
+    LOG << "MmapSpillArea: mapped region " << regions_.size()
+        << " at " << ptr;
+
+    regions_.push_back(static_cast<uint8_t*>(ptr));
+    region_used_ = 0;
+    return true;
+}
+
+uint8_t* MmapSpillArea::Allocate(size_t size) {
+    if (size == 0 || size > region_size_) return nullptr;
+
+    std::vector<uint8_t*>& list = free_[size];
+    if (!list.empty()) {
+        uint8_t* slot = list.back();
+        list.pop_back();
+        used_bytes_ += size;
+        return slot;
+    }
+
+    if (regions_.empty() || region_used_ + size > region_size_) {
+        if (!AddRegion()) return nullptr;
+    }
+
+    uint8_t* slot = regions_.back() + region_used_;
+    region_used_ += size;
+    used_bytes_ += size;
+    return slot;
+}
+
+void MmapSpillArea::Deallocate(uint8_t* slot, size_t size) {
+    die_unless(used_bytes_ >= size);
+    used_bytes_ -= size;
+
+#if defined(MADV_REMOVE)
+    // free the pages and disk space of the dead data instead of writing it
+    // back, fails if the file system does not support punching holes.
+    ::madvise(slot, size, MADV_REMOVE);
+#endif
+
+    free_[size].push_back(slot);
+}
+
+} // namespace data
+} // namespace thrill
+
+/******************************************************************************/
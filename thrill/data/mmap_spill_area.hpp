@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * thrill/data/mmap_spill_area.hpp
+ *
+ * Memory-mapped file into which the BlockPool swaps out ByteBlocks.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_MMAP_SPILL_AREA_HEADER
+#define THRILL_DATA_MMAP_SPILL_AREA_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * A spill tier for the BlockPool which maps an unlinked temporary file with
+ * MAP_SHARED and lets the kernel page it. Swapping out a Block copies its data
+ * into a slot of the mapping and releases the RAM, swapping in copies it back.
+ * Dirty pages are written back by the kernel whenever it chooses, hence fast
+ * local SSDs and a large page cache turn spilling into plain memcpy()s without
+ * the per-block I/O requests of foxxll.
+ *
+ * The file grows in regions of region_size bytes, each mapped separately such
+ * that slot addresses remain stable. Freed slots are kept in lists per size
+ * for reuse and their pages are discarded with MADV_REMOVE.
+ *
+ * This class is not thread-safe, the BlockPool calls it with its mutex held.
+ */
+class MmapSpillArea
+{
+public:
+    //! create spill file in the given directory. Throws ErrnoException if the
+    //! file cannot be created.
+    explicit MmapSpillArea(const std::string& dir,
+                           size_t region_size = 1024 * 1024 * 1024);
+
+    //! non-copyable: delete copy-constructor
+    MmapSpillArea(const MmapSpillArea&) = delete;
+    //! non-copyable: delete assignment operator
+    MmapSpillArea& operator = (const MmapSpillArea&) = delete;
+
+    //! unmap all regions and close the file
+    ~MmapSpillArea();
+
+    //! allocate a slot of size bytes, returns nullptr if the file cannot grow
+    //! or size is larger than a region.
+    uint8_t * Allocate(size_t size);
+
+    //! release a slot returned by Allocate()
+    void Deallocate(uint8_t* slot, size_t size);
+
+    //! number of bytes of the file in use by slots
+    size_t used_bytes() const { return used_bytes_; }
+
+    //! size of the file
+    size_t file_size() const { return regions_.size() * region_size_; }
+
+private:
+    //! file descriptor of the unlinked spill file
+    int fd_ = -1;
+
+    //! size of each mapped region of the file
+    size_t region_size_;
+
+    //! mapped regions in order of their file offset
+    std::vector<uint8_t*> regions_;
+
+    //! next unused offset in the last region
+    size_t region_used_ = 0;
+
+    //! free slots by size
+    std::unordered_map<size_t, std::vector<uint8_t*> > free_;
+
+    //! number of bytes in allocated slots
+    size_t used_bytes_ = 0;
+
+    //! map another region at the end of the file, returns false on failure.
+    bool AddRegion();
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_MMAP_SPILL_AREA_HEADER
+
+/******************************************************************************/
@@ -11,6 +11,8 @@
 
 #include <thrill/data/multiplexer.hpp>
 
+#include <thrill/common/trace_event.hpp>
+#include <thrill/data/block_compression.hpp>
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/mix_stream.hpp>
 #include <thrill/data/multiplexer_header.hpp>
@@ -20,7 +22,14 @@
 #include <tlx/math/round_to_power_of_two.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -34,6 +43,9 @@ namespace data {
  * addressd via and Id. Workers can allocate new Id independetly but
  * deterministically (the repository will issue the same id sequence to all
  * workers).  Objects are created inplace via argument forwarding.
+ *
+ * Ids are allocated per job: the job id is put above id_shift bits of the
+ * sequence, such that concurrent jobs do not disturb each other's sequences.
  */
 template <typename Object>
 class Repository
@@ -43,15 +55,24 @@ public:
     using ObjectPtr = tlx::CountingPtr<Object>;
 
     //! construct with initial ids 0.
-    explicit Repository(size_t num_workers_per_node)
-        : next_id_(num_workers_per_node, 0) { }
+    Repository(size_t num_workers_per_node, size_t id_shift)
+        : num_workers_per_node_(num_workers_per_node), id_shift_(id_shift) { }
 
-    //! Alllocates the next data target.
+    //! Alllocates the next data target of the job.
     //! Calls to this method alter the internal state -> order of calls is
     //! important and must be deterministic
-    size_t AllocateId(size_t local_worker_id) {
-        assert(local_worker_id < next_id_.size());
-        return ++next_id_[local_worker_id];
+    size_t AllocateId(size_t local_worker_id, size_t job_id = 0) {
+        assert(local_worker_id < num_workers_per_node_);
+        std::vector<size_t>& next_id = next_id_[job_id];
+        if (next_id.empty()) next_id.resize(num_workers_per_node_, 0);
+        size_t seq = ++next_id[local_worker_id];
+        die_unless(seq < (size_t(1) << id_shift_));
+        return (job_id << id_shift_) | seq;
+    }
+
+    //! drop the id sequences of a job, which restart at 1 if it is reused.
+    void ReleaseJob(size_t job_id) {
+        next_id_.erase(job_id);
     }
 
     //! Get object with given id, if it does not exist, create it.
@@ -103,8 +124,14 @@ public:
     std::unordered_map<Id, ObjectPtr>& map() { return map_; }
 
 private:
-    //! Next ID to generate, one for each local worker.
-    std::vector<size_t> next_id_;
+    //! number of local workers
+    size_t num_workers_per_node_;
+
+    //! bits of the sequence below the job id
+    size_t id_shift_;
+
+    //! Next ID to generate per job, one for each local worker.
+    std::unordered_map<size_t, std::vector<size_t> > next_id_;
 
     //! map containing value items
     std::unordered_map<Id, ObjectPtr> map_;
@@ -113,27 +140,93 @@ private:
 /******************************************************************************/
 // Multiplexer
 
+//! interval of the timer re-checking deferred credits
+static constexpr std::chrono::milliseconds credit_timer_interval { 10 };
+
+//! number of timer ticks after which deferred credits are granted anyway,
+//! since the receiver's workers may themselves wait for held Blocks.
+static constexpr size_t credit_max_deferral = 100;
+
+//! state shared with the credit timer, which may outlive the Multiplexer if the
+//! DispatcherThread is stopped first.
+struct CreditTimerState {
+    std::mutex   mutex;
+    Multiplexer* multiplexer = nullptr;
+};
+
 struct Multiplexer::Data {
     //! Streams have an ID in block headers. (worker id, stream id)
     Repository<StreamSetBase>         stream_sets_;
 
-    //! array of number of open requests
+    //! array of number of open requests, per peer and lane.
     std::vector<std::atomic<size_t> > ongoing_requests_;
 
-    explicit Data(size_t num_hosts, size_t workers_per_host)
-        : stream_sets_(workers_per_host),
-          ongoing_requests_(num_hosts) { }
+    //! number of final close messages received per (stream id, peer), only
+    //! used with multiple lanes.
+    std::map<std::pair<size_t, size_t>, size_t> final_closes_;
+
+    //! credits deferred while the BlockPool is over budget, with the number of
+    //! timer ticks they waited, protected by mutex_.
+    std::vector<std::pair<CreditMultiplexerHeader, size_t> > deferred_credits_;
+
+    //! whether the credit timer is registered, protected by mutex_.
+    bool credit_timer_active_ = false;
+
+    //! state shared with the credit timer
+    std::shared_ptr<CreditTimerState> credit_timer_;
+
+    //! protects job_send_bytes_
+    std::mutex job_send_mutex_;
+
+    //! signaled when queued bytes of a job were sent
+    std::condition_variable job_send_cv_;
+
+    //! bytes queued to send per job, only jobs with queued bytes are contained.
+    std::unordered_map<size_t, size_t> job_send_bytes_;
+
+    explicit Data(size_t num_links, size_t workers_per_host)
+        : stream_sets_(workers_per_host, Multiplexer::job_id_shift),
+          ongoing_requests_(num_links),
+          credit_timer_(std::make_shared<CreditTimerState>()) { }
 };
 
 Multiplexer::Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
                          net::DispatcherThread& dispatcher, net::Group& group,
-                         size_t workers_per_host)
+                         size_t workers_per_host, bool compress_blocks,
+                         bool flow_control, bool adaptive_block_size)
+    : Multiplexer(mem_manager, block_pool, dispatcher,
+                  std::vector<net::Group*>({ &group }),
+                  workers_per_host, compress_blocks, flow_control,
+                  adaptive_block_size) { }
+
+Multiplexer::Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
+                         net::DispatcherThread& dispatcher,
+                         const std::vector<net::Group*>& lanes,
+                         size_t workers_per_host, bool compress_blocks,
+                         bool flow_control, bool adaptive_block_size)
+    : Multiplexer(mem_manager, block_pool,
+                  std::vector<net::DispatcherThread*>({ &dispatcher }),
+                  lanes, workers_per_host, compress_blocks, flow_control,
+                  adaptive_block_size) { }
+
+Multiplexer::Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
+                         const std::vector<net::DispatcherThread*>& dispatchers,
+                         const std::vector<net::Group*>& lanes,
+                         size_t workers_per_host, bool compress_blocks,
+                         bool flow_control, bool adaptive_block_size)
     : mem_manager_(mem_manager),
       block_pool_(block_pool),
-      dispatcher_(dispatcher),
-      group_(group),
+      dispatchers_(dispatchers),
+      group_(*lanes.at(0)),
+      lanes_(lanes),
       workers_per_host_(workers_per_host),
-      d_(std::make_unique<Data>(group_.num_hosts(), workers_per_host)) {
+      compress_blocks_(compress_blocks),
+      flow_control_(flow_control),
+      adaptive_block_size_(adaptive_block_size),
+      d_(std::make_unique<Data>(
+             group_.num_hosts() * lanes.size(), workers_per_host)) {
+
+    die_unless(!dispatchers_.empty());
 
     num_parallel_async_ = group_.num_parallel_async();
     if (num_parallel_async_ == 0) {
@@ -152,14 +245,35 @@ Multiplexer::Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
     if (send_size_limit_ < 2 * default_block_size)
         send_size_limit_ = 2 * default_block_size;
 
-    // launch initial async reads
-    for (size_t id = 0; id < group_.num_hosts(); id++) {
-        if (id == group_.my_host_rank()) continue;
-        AsyncReadMultiplexerHeader(id, group_.connection(id));
+    job_send_limit_ = send_size_limit_ * workers_per_host;
+
+    // calculate the flow control window per StreamData and remote worker,
+    // such that all Blocks in flight to a host fit into half of its BlockPool.
+    flow_window_ = block_pool.hard_ram_limit() / workers_per_host
+                   / num_workers() / 2;
+    if (flow_window_ < 2 * default_block_size)
+        flow_window_ = 2 * default_block_size;
+
+    d_->credit_timer_->multiplexer = this;
+
+    // launch initial async reads on all lanes
+    for (size_t lane = 0; lane < lanes_.size(); ++lane) {
+        die_unless(lanes_[lane]->num_hosts() == group_.num_hosts());
+        for (size_t id = 0; id < group_.num_hosts(); id++) {
+            if (id == group_.my_host_rank()) continue;
+            AsyncReadMultiplexerHeader(
+                lane * group_.num_hosts() + id, connection(id, lane));
+        }
     }
 }
 
 void Multiplexer::Close() {
+    {
+        // detach the credit timer, which locks its state before mutex_.
+        std::unique_lock<std::mutex> timer_lock(d_->credit_timer_->mutex);
+        d_->credit_timer_->multiplexer = nullptr;
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
 
     if (!d_->stream_sets_.map().empty()) {
@@ -171,6 +285,9 @@ void Multiplexer::Close() {
     // destroy all still open Streams
     d_->stream_sets_.map().clear();
 
+    // drop deferred credits
+    d_->deferred_credits_.clear();
+
     closed_ = true;
 }
 
@@ -178,12 +295,89 @@ Multiplexer::~Multiplexer() {
     if (!closed_)
         Close();
 
-    group_.Close();
+    for (net::Group* lane : lanes_)
+        lane->Close();
 }
 
-size_t Multiplexer::AllocateCatStreamId(size_t local_worker_id) {
+void Multiplexer::CollectMetrics(common::MetricsWriter& mw) {
+    mw.Gauge("active_streams", "Number of active Cat/MixStreams.",
+             active_streams_.load());
+    mw.Gauge("max_active_streams", "Maximum number of active streams.",
+             max_active_streams_.load());
+
+    // (stream id, tx bytes, rx bytes) of each active stream
+    std::vector<std::tuple<size_t, size_t, size_t> > traffic;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto& s : d_->stream_sets_.map()) {
+            size_t tx = 0, rx = 0;
+            s.second->NetTraffic(&tx, &rx);
+            traffic.emplace_back(s.first, tx, rx);
+        }
+    }
+    std::sort(traffic.begin(), traffic.end());
+
+    auto label = [](size_t id) {
+                     return "stream=\"" + std::to_string(id) + "\"";
+                 };
+
+    mw.Family("stream_tx_bytes_total", "counter",
+              "Bytes sent over the network by an active stream.");
+    for (const auto& t : traffic)
+        mw.Sample(std::get<1>(t), label(std::get<0>(t)));
+
+    mw.Family("stream_rx_bytes_total", "counter",
+              "Bytes received over the network by an active stream.");
+    for (const auto& t : traffic)
+        mw.Sample(std::get<2>(t), label(std::get<0>(t)));
+}
+
+void Multiplexer::ReleaseJob(size_t job_id) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        d_->stream_sets_.ReleaseJob(job_id);
+    }
+    std::unique_lock<std::mutex> lock(d_->job_send_mutex_);
+    d_->job_send_bytes_.erase(job_id);
+    d_->job_send_cv_.notify_all();
+}
+
+void Multiplexer::AcquireJobSend(size_t job_id, size_t size) {
+    std::unique_lock<std::mutex> lock(d_->job_send_mutex_);
+    d_->job_send_cv_.wait(
+        lock, [this, job_id, size]() {
+            auto it = d_->job_send_bytes_.find(job_id);
+            // a job without queued bytes may always send, hence it is never
+            // starved, and a single job is not limited at all.
+            if (it == d_->job_send_bytes_.end() ||
+                d_->job_send_bytes_.size() == 1)
+                return true;
+            return it->second + size <=
+            job_send_limit_ / d_->job_send_bytes_.size();
+        });
+    d_->job_send_bytes_[job_id] += size;
+}
+
+void Multiplexer::ReleaseJobSend(size_t job_id, size_t size) {
+    std::unique_lock<std::mutex> lock(d_->job_send_mutex_);
+    auto it = d_->job_send_bytes_.find(job_id);
+    // the job may have been released already
+    if (it == d_->job_send_bytes_.end()) return;
+    it->second -= std::min(it->second, size);
+    if (it->second == 0)
+        d_->job_send_bytes_.erase(it);
+    d_->job_send_cv_.notify_all();
+}
+
+size_t Multiplexer::sending_jobs() {
+    std::unique_lock<std::mutex> lock(d_->job_send_mutex_);
+    return d_->job_send_bytes_.size();
+}
+
+size_t Multiplexer::AllocateCatStreamId(
+    size_t local_worker_id, size_t job_id) {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->stream_sets_.AllocateId(local_worker_id);
+    return d_->stream_sets_.AllocateId(local_worker_id, job_id);
 }
 
 CatStreamDataPtr Multiplexer::GetOrCreateCatStreamData(
@@ -192,11 +386,12 @@ CatStreamDataPtr Multiplexer::GetOrCreateCatStreamData(
     return IntGetOrCreateCatStreamData(id, local_worker_id, dia_id);
 }
 
-CatStreamPtr Multiplexer::GetNewCatStream(size_t local_worker_id, size_t dia_id) {
+CatStreamPtr Multiplexer::GetNewCatStream(
+    size_t local_worker_id, size_t dia_id, size_t job_id) {
     std::unique_lock<std::mutex> lock(mutex_);
     return tlx::make_counting<CatStream>(
         IntGetOrCreateCatStreamData(
-            d_->stream_sets_.AllocateId(local_worker_id),
+            d_->stream_sets_.AllocateId(local_worker_id, job_id),
             local_worker_id, dia_id));
 }
 
@@ -213,9 +408,10 @@ CatStreamDataPtr Multiplexer::IntGetOrCreateCatStreamData(
     return ptr;
 }
 
-size_t Multiplexer::AllocateMixStreamId(size_t local_worker_id) {
+size_t Multiplexer::AllocateMixStreamId(
+    size_t local_worker_id, size_t job_id) {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->stream_sets_.AllocateId(local_worker_id);
+    return d_->stream_sets_.AllocateId(local_worker_id, job_id);
 }
 
 MixStreamDataPtr Multiplexer::GetOrCreateMixStreamData(
@@ -224,11 +420,12 @@ MixStreamDataPtr Multiplexer::GetOrCreateMixStreamData(
     return IntGetOrCreateMixStreamData(id, local_worker_id, dia_id);
 }
 
-MixStreamPtr Multiplexer::GetNewMixStream(size_t local_worker_id, size_t dia_id) {
+MixStreamPtr Multiplexer::GetNewMixStream(
+    size_t local_worker_id, size_t dia_id, size_t job_id) {
     std::unique_lock<std::mutex> lock(mutex_);
     return tlx::make_counting<MixStream>(
         IntGetOrCreateMixStreamData(
-            d_->stream_sets_.AllocateId(local_worker_id),
+            d_->stream_sets_.AllocateId(local_worker_id, job_id),
             local_worker_id, dia_id));
 }
 
@@ -277,31 +474,212 @@ common::JsonLogger& Multiplexer::logger() {
     return block_pool_.logger();
 }
 
+void Multiplexer::SendProgress(const ProgressMultiplexerHeader& report) {
+    assert(my_host_rank() != 0);
+
+    net::BufferBuilder bb;
+    report.Serialize(bb);
+
+    net::Buffer buffer = bb.ToBuffer();
+    assert(buffer.size() == MultiplexerHeader::total_size);
+
+    // the header-only message uses one sequence number pair, like stream
+    // close messages.
+    net::Connection& conn = group_.connection(0);
+    dispatcher(0, 0).AsyncWrite(
+        conn, 42 + (conn.tx_seq_.fetch_add(2) & 0xFFFF), std::move(buffer));
+}
+
+void Multiplexer::set_progress_callback(const ProgressCallback& cb) {
+    std::unique_lock<std::mutex> lock(progress_mutex_);
+    progress_callback_ = cb;
+}
+
+/******************************************************************************/
+// Adaptive Block Size
+
+//! factor of default_block_size, up to which adaptive Block sizes may grow
+static constexpr size_t max_adaptive_block_factor = 4;
+
+size_t Multiplexer::WriterBlockSize(MagicByte magic) {
+    // the Blocks of the writers of all local workers to all workers should
+    // fit into a quarter of the BlockPool.
+    size_t block_size_base = block_pool_.hard_ram_limit() / 4
+                             / num_workers() / workers_per_host_;
+    size_t block_size = tlx::round_down_to_power_of_two(block_size_base);
+
+    if (!adaptive_block_size_) {
+        if (block_size == 0 || block_size > default_block_size)
+            block_size = default_block_size;
+        return block_size;
+    }
+
+    // bulk exchanges may use Blocks larger than default_block_size
+    size_t limit = max_adaptive_block_factor * default_block_size;
+    if (block_size != 0 && block_size < limit)
+        limit = block_size;
+
+    size_t volume;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        volume = target_volume_[magic == MagicByte::MixStreamBlock];
+    }
+    if (volume == 0)
+        return std::min(limit, default_block_size);
+
+    // fit the expected volume per target into one Block
+    size_t size = tlx::round_up_to_power_of_two(volume);
+    return std::min(std::max(size, start_block_size), limit);
+}
+
+void Multiplexer::RecordTargetVolume(MagicByte magic, size_t bytes_per_target) {
+    if (!adaptive_block_size_) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t& volume = target_volume_[magic == MagicByte::MixStreamBlock];
+    volume = volume == 0 ? bytes_per_target
+             : (3 * volume + bytes_per_target) / 4;
+}
+
+/******************************************************************************/
+// Flow Control
+
+bool Multiplexer::FlowOverBudget() {
+    size_t limit = block_pool_.hard_ram_limit();
+    return limit != 0 && block_pool_.total_bytes() > limit / 4 * 3;
+}
+
+void Multiplexer::GrantCredit(
+    const StreamMultiplexerHeader& header, size_t bytes) {
+    if (!flow_control_) return;
+
+    CreditMultiplexerHeader credit;
+    credit.sender_worker = static_cast<uint32_t>(
+        my_host_rank() * workers_per_host_ + header.receiver_local_worker);
+    credit.receiver_worker = header.sender_worker;
+    credit.stream_id = header.stream_id;
+    credit.bytes = bytes;
+
+    if (!FlowOverBudget())
+        return SendCredit(credit);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_) return;
+
+    sLOG << "Multiplexer::GrantCredit() defer credit"
+         << "stream" << credit.stream_id
+         << "to worker" << credit.receiver_worker
+         << "bytes" << credit.bytes;
+
+    d_->deferred_credits_.emplace_back(credit, 0);
+    if (d_->credit_timer_active_) return;
+
+    d_->credit_timer_active_ = true;
+    dispatcher().AddTimer(
+        credit_timer_interval,
+        [state = d_->credit_timer_]() {
+            std::unique_lock<std::mutex> timer_lock(state->mutex);
+            if (!state->multiplexer) return false;
+            return state->multiplexer->OnCreditTimer();
+        });
+}
+
+bool Multiplexer::OnCreditTimer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    bool over_budget = FlowOverBudget();
+    std::vector<std::pair<CreditMultiplexerHeader, size_t> >& deferred =
+        d_->deferred_credits_;
+
+    size_t keep = 0;
+    for (size_t i = 0; i < deferred.size(); ++i) {
+        if (!over_budget || ++deferred[i].second >= credit_max_deferral)
+            SendCredit(deferred[i].first);
+        else
+            deferred[keep++] = deferred[i];
+    }
+    deferred.resize(keep);
+
+    d_->credit_timer_active_ = !deferred.empty();
+    return d_->credit_timer_active_;
+}
+
+void Multiplexer::SendCredit(const CreditMultiplexerHeader& credit) {
+    size_t peer = credit.receiver_worker / workers_per_host_;
+    assert(peer != my_host_rank());
+
+    net::BufferBuilder bb;
+    credit.Serialize(bb);
+
+    net::Buffer buffer = bb.ToBuffer();
+    assert(buffer.size() == MultiplexerHeader::total_size);
+
+    // the header-only message uses one sequence number pair, like stream
+    // close messages.
+    net::Connection& conn = group_.connection(peer);
+    dispatcher(peer, 0).AsyncWrite(
+        conn, 42 + (conn.tx_seq_.fetch_add(2) & 0xFFFF), std::move(buffer));
+}
+
+void Multiplexer::OnCredit(const CreditMultiplexerHeader& credit) {
+    if (!flow_control_) return;
+
+    StreamDataPtr stream;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = d_->stream_sets_.map().find(credit.stream_id);
+        // the stream may already be closed and released
+        if (it == d_->stream_sets_.map().end()) return;
+        stream = it->second->PeerData(
+            credit.receiver_worker % workers_per_host_);
+    }
+
+    if (stream)
+        stream->OnCredit(credit.sender_worker, credit.bytes);
+}
+
 /******************************************************************************/
 
-void Multiplexer::AsyncReadMultiplexerHeader(size_t peer, Connection& s) {
+void Multiplexer::AsyncReadMultiplexerHeader(size_t link, Connection& s) {
 
-    while (d_->ongoing_requests_[peer] < num_parallel_async_) {
+    while (d_->ongoing_requests_[link] < num_parallel_async_) {
         uint32_t seq = 42 + (s.rx_seq_.fetch_add(2) & 0xFFFF);
-        dispatcher_.AsyncRead(
+        link_dispatcher(link).AsyncRead(
             s, seq, MultiplexerHeader::total_size,
-            [this, peer, seq](Connection& s, net::Buffer&& buffer) {
-                return OnMultiplexerHeader(peer, seq, s, std::move(buffer));
+            [this, link, seq](Connection& s, net::Buffer&& buffer) {
+                return OnMultiplexerHeader(link, seq, s, std::move(buffer));
             });
 
-        d_->ongoing_requests_[peer]++;
+        d_->ongoing_requests_[link]++;
     }
 }
 
+bool Multiplexer::OnFinalClose(size_t stream_id, size_t peer) {
+    if (lanes_.size() == 1) return true;
+
+    // the final close is sent on all lanes after all Blocks, hence the Blocks
+    // of all lanes have arrived once it was received on each. The lanes may
+    // be handled by different DispatcherThreads.
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto key = std::make_pair(stream_id, peer);
+    if (++d_->final_closes_[key] < lanes_.size())
+        return false;
+
+    d_->final_closes_.erase(key);
+    return true;
+}
+
 void Multiplexer::OnMultiplexerHeader(
-    size_t peer, uint32_t seq, Connection& s, net::Buffer&& buffer) {
+    size_t link, uint32_t seq, Connection& s, net::Buffer&& buffer) {
 
-    die_unless(d_->ongoing_requests_[peer] > 0);
-    d_->ongoing_requests_[peer]--;
+    die_unless(d_->ongoing_requests_[link] > 0);
+    d_->ongoing_requests_[link]--;
 
     // received invalid Buffer: the connection has closed?
     if (!buffer.IsValid()) return;
 
+    common::TraceScope trace(logger(), "multiplexer", "OnMultiplexerHeader");
+
     net::BufferReader br(buffer);
     StreamMultiplexerHeader header = StreamMultiplexerHeader::Parse(br);
 
@@ -313,12 +691,43 @@ void Multiplexer::OnMultiplexerHeader(
         << " typecode_verify=" << header.typecode_verify
         << " stream_id=" << header.stream_id;
 
+    if (header.magic == MagicByte::ProgressReport)
+    {
+        net::BufferReader pbr(buffer);
+        ProgressMultiplexerHeader report =
+            ProgressMultiplexerHeader::Parse(pbr);
+
+        sLOG << "progress report from host" << report.sender_host
+             << "dia_id" << report.dia_id << "items" << report.items;
+
+        {
+            std::unique_lock<std::mutex> lock(progress_mutex_);
+            if (progress_callback_) progress_callback_(report);
+        }
+
+        AsyncReadMultiplexerHeader(link, s);
+        return;
+    }
+
+    if (header.magic == MagicByte::StreamCredit)
+    {
+        net::BufferReader cbr(buffer);
+        OnCredit(CreditMultiplexerHeader::Parse(cbr));
+
+        AsyncReadMultiplexerHeader(link, s);
+        return;
+    }
+
     // received stream id
     StreamId id = header.stream_id;
     size_t local_worker = header.receiver_local_worker;
 
+    // size of the payload following the header
+    size_t payload_size =
+        header.compressed_size ? header.compressed_size : header.size;
+
     // round of allocation size to next power of two
-    size_t alloc_size = header.size;
+    size_t alloc_size = payload_size;
     if (alloc_size < THRILL_DEFAULT_ALIGN) alloc_size = THRILL_DEFAULT_ALIGN;
     alloc_size = tlx::round_up_to_power_of_two(alloc_size);
 
@@ -329,6 +738,11 @@ void Multiplexer::OnMultiplexerHeader(
                  << " my_host_rank=" << my_host_rank()
                  << " peer_host_rank=" << header.sender_worker / workers_per_host();
 
+            if (!OnFinalClose(id, header.sender_worker / workers_per_host())) {
+                AsyncReadMultiplexerHeader(link, s);
+                return;
+            }
+
             for (size_t w = 0; w < workers_per_host(); ++w) {
                 CatStreamDataPtr stream = GetOrCreateCatStreamData(
                     id, w, /* dia_id (unknown at this time) */ 0);
@@ -373,13 +787,13 @@ void Multiplexer::OnMultiplexerHeader(
                 alloc_size, local_worker);
             sLOG << "new PinnedByteBlockPtr bytes=" << *bytes;
 
-            d_->ongoing_requests_[peer]++;
+            d_->ongoing_requests_[link]++;
 
-            dispatcher_.AsyncRead(
-                s, seq + 1, header.size, std::move(bytes),
-                [this, peer, header, stream](
+            link_dispatcher(link).AsyncRead(
+                s, seq + 1, payload_size, std::move(bytes),
+                [this, link, header, stream](
                     Connection& s, PinnedByteBlockPtr&& bytes) {
-                    OnCatStreamBlock(peer, s, header, stream, std::move(bytes));
+                    OnCatStreamBlock(link, s, header, stream, std::move(bytes));
                 });
         }
     }
@@ -390,6 +804,11 @@ void Multiplexer::OnMultiplexerHeader(
                  << " my_host_rank=" << my_host_rank()
                  << " peer_host_rank=" << header.sender_worker / workers_per_host();
 
+            if (!OnFinalClose(id, header.sender_worker / workers_per_host())) {
+                AsyncReadMultiplexerHeader(link, s);
+                return;
+            }
+
             for (size_t w = 0; w < workers_per_host(); ++w) {
                 MixStreamDataPtr stream = GetOrCreateMixStreamData(
                     id, w, /* dia_id (unknown at this time) */ 0);
@@ -431,13 +850,13 @@ void Multiplexer::OnMultiplexerHeader(
             PinnedByteBlockPtr bytes = block_pool_.AllocateByteBlock(
                 alloc_size, local_worker);
 
-            d_->ongoing_requests_[peer]++;
+            d_->ongoing_requests_[link]++;
 
-            dispatcher_.AsyncRead(
-                s, seq + 1, header.size, std::move(bytes),
-                [this, peer, header, stream](
+            link_dispatcher(link).AsyncRead(
+                s, seq + 1, payload_size, std::move(bytes),
+                [this, link, header, stream](
                     Connection& s, PinnedByteBlockPtr&& bytes) mutable {
-                    OnMixStreamBlock(peer, s, header, stream, std::move(bytes));
+                    OnMixStreamBlock(link, s, header, stream, std::move(bytes));
                 });
         }
     }
@@ -445,15 +864,37 @@ void Multiplexer::OnMultiplexerHeader(
         die("Invalid magic byte in MultiplexerHeader");
     }
 
-    AsyncReadMultiplexerHeader(peer, s);
+    AsyncReadMultiplexerHeader(link, s);
+}
+
+PinnedByteBlockPtr Multiplexer::DecompressBlock(
+    const StreamMultiplexerHeader& header, PinnedByteBlockPtr&& compressed) {
+
+    size_t alloc_size = header.size;
+    if (alloc_size < THRILL_DEFAULT_ALIGN) alloc_size = THRILL_DEFAULT_ALIGN;
+    alloc_size = tlx::round_up_to_power_of_two(alloc_size);
+
+    PinnedByteBlockPtr bytes = block_pool_.AllocateByteBlock(
+        alloc_size, compressed.local_worker_id());
+
+    die_unless(BlockDecompress(
+                   compressed->begin(), header.compressed_size,
+                   bytes->begin(), header.size));
+
+    return bytes;
 }
 
 void Multiplexer::OnCatStreamBlock(
-    size_t peer, Connection& s, const StreamMultiplexerHeader& header,
+    size_t link, Connection& s, const StreamMultiplexerHeader& header,
     const CatStreamDataPtr& stream, PinnedByteBlockPtr&& bytes) {
 
-    die_unless(d_->ongoing_requests_[peer] > 0);
-    d_->ongoing_requests_[peer]--;
+    common::TraceScope trace(logger(), "multiplexer", "OnCatStreamBlock");
+
+    die_unless(d_->ongoing_requests_[link] > 0);
+    d_->ongoing_requests_[link]--;
+
+    if (header.compressed_size)
+        bytes = DecompressBlock(header, std::move(bytes));
 
     sLOG << "Multiplexer::OnCatStreamBlock()"
          << "got block" << *bytes << "seq" << header.seq << "on" << s
@@ -469,15 +910,25 @@ void Multiplexer::OnCatStreamBlock(
     if (header.is_last_block)
         stream->OnStreamBlock(header.sender_worker, header.seq + 1, Block());
 
-    AsyncReadMultiplexerHeader(peer, s);
+    // return the wire size of the Block, like the sender accounts it
+    size_t payload_size =
+        header.compressed_size ? header.compressed_size : header.size;
+    GrantCredit(header, MultiplexerHeader::total_size + payload_size);
+
+    AsyncReadMultiplexerHeader(link, s);
 }
 
 void Multiplexer::OnMixStreamBlock(
-    size_t peer, Connection& s, const StreamMultiplexerHeader& header,
+    size_t link, Connection& s, const StreamMultiplexerHeader& header,
     const MixStreamDataPtr& stream, PinnedByteBlockPtr&& bytes) {
 
-    die_unless(d_->ongoing_requests_[peer] > 0);
-    d_->ongoing_requests_[peer]--;
+    common::TraceScope trace(logger(), "multiplexer", "OnMixStreamBlock");
+
+    die_unless(d_->ongoing_requests_[link] > 0);
+    d_->ongoing_requests_[link]--;
+
+    if (header.compressed_size)
+        bytes = DecompressBlock(header, std::move(bytes));
 
     sLOG << "Multiplexer::OnMixStreamBlock()"
          << "got block" << *bytes << "seq" << header.seq << "on" << s
@@ -493,7 +944,12 @@ void Multiplexer::OnMixStreamBlock(
     if (header.is_last_block)
         stream->OnStreamBlock(header.sender_worker, header.seq + 1, Block());
 
-    AsyncReadMultiplexerHeader(peer, s);
+    // return the wire size of the Block, like the sender accounts it
+    size_t payload_size =
+        header.compressed_size ? header.compressed_size : header.size;
+    GrantCredit(header, MultiplexerHeader::total_size + payload_size);
+
+    AsyncReadMultiplexerHeader(link, s);
 }
 
 CatStreamDataPtr Multiplexer::CatLoopback(
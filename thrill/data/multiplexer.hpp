@@ -14,12 +14,18 @@
 #define THRILL_DATA_MULTIPLEXER_HEADER
 
 #include <thrill/common/json_logger.hpp>
+#include <thrill/common/metrics_writer.hpp>
 #include <thrill/net/dispatcher_thread.hpp>
 #include <thrill/net/group.hpp>
 
+#include <tlx/delegate.hpp>
+
 #include <algorithm>
 #include <atomic>
+#include <cassert>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace thrill {
 namespace data {
@@ -48,7 +54,11 @@ using MixStreamSet = StreamSet<MixStreamData>;
 class BlockQueue;
 class MixBlockQueueSink;
 
+enum class MagicByte : uint8_t;
+
 class StreamMultiplexerHeader;
+class ProgressMultiplexerHeader;
+class CreditMultiplexerHeader;
 
 /*!
  * Multiplexes virtual Connections on Dispatcher.
@@ -63,6 +73,30 @@ class StreamMultiplexerHeader;
  * All sockets are polled for headers. As soon as the a header arrives it is
  * either attached to an existing stream or a new stream instance is
  * created.
+ *
+ * The Multiplexer may use multiple Groups as parallel lanes to each peer, which
+ * saturate fast links better than a single connection. StreamSinks send their
+ * Blocks round-robin over the lanes, and the receivers restore the order using
+ * the Blocks' sequence numbers.
+ *
+ * The event handling of the connections may be sharded across several
+ * DispatcherThreads, such that it is not limited by one core. Each connection,
+ * i.e. each pair of peer and lane, is handled by exactly one of them, which
+ * keeps the order of reads and writes on a connection.
+ *
+ * With flow control, each StreamData may have at most a window of bytes in
+ * flight to each remote worker. The receiving Multiplexer returns the bytes of
+ * each Block as credit, but defers the credit while its BlockPool is over
+ * budget, such that the senders hold further Blocks, which the BlockPool can
+ * spill locally. Deferred credits are granted anyway after a timeout, hence
+ * flow control slows down senders, but cannot deadlock them.
+ *
+ * Several jobs may share the Multiplexer. The stream ids of each job are
+ * allocated in their own namespace, the job id in the upper bits, such that the
+ * jobs' workers agree on the ids independently of the other jobs. While more
+ * than one job sends, each may only have its fair share of the send limit
+ * queued at the dispatchers, hence one job's large exchange does not delay the
+ * Blocks of the others behind it.
  */
 class Multiplexer
 {
@@ -71,7 +105,23 @@ class Multiplexer
 public:
     Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
                 net::DispatcherThread& dispatcher, net::Group& group,
-                size_t workers_per_host);
+                size_t workers_per_host, bool compress_blocks = false,
+                bool flow_control = false, bool adaptive_block_size = false);
+
+    //! construct with multiple Groups as parallel lanes to each peer.
+    Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
+                net::DispatcherThread& dispatcher,
+                const std::vector<net::Group*>& lanes,
+                size_t workers_per_host, bool compress_blocks = false,
+                bool flow_control = false, bool adaptive_block_size = false);
+
+    //! construct with multiple Groups as parallel lanes to each peer, whose
+    //! connections are sharded across the DispatcherThreads.
+    Multiplexer(mem::Manager& mem_manager, BlockPool& block_pool,
+                const std::vector<net::DispatcherThread*>& dispatchers,
+                const std::vector<net::Group*>& lanes,
+                size_t workers_per_host, bool compress_blocks = false,
+                bool flow_control = false, bool adaptive_block_size = false);
 
     //! non-copyable: delete copy-constructor
     Multiplexer(const Multiplexer&) = delete;
@@ -110,24 +160,74 @@ public:
     //! Get the JsonLogger from the BlockPool
     common::JsonLogger& logger();
 
-    //! get network dispatcher
-    net::DispatcherThread& dispatcher() { return dispatcher_; }
+    //! write the active streams and the network traffic of each stream as
+    //! live metrics
+    void CollectMetrics(common::MetricsWriter& mw);
+
+    //! get first network dispatcher
+    net::DispatcherThread& dispatcher() { return *dispatchers_[0]; }
+
+    //! number of DispatcherThreads the connections are sharded across
+    size_t num_dispatchers() const { return dispatchers_.size(); }
+
+    //! get network dispatcher handling the connection to peer on the lane
+    net::DispatcherThread& dispatcher(size_t peer, size_t lane) {
+        assert(lane < lanes_.size());
+        return link_dispatcher(lane * num_hosts() + peer);
+    }
 
     //! get network group connection
     net::Group& group() { return group_; }
 
+    //! number of parallel connections to each peer
+    size_t num_lanes() const { return lanes_.size(); }
+
+    //! get connection to peer on the given lane
+    net::Connection& connection(size_t peer, size_t lane) {
+        assert(lane < lanes_.size());
+        return lanes_[lane]->connection(peer);
+    }
+
+    //! \name Jobs
+    //! \{
+
+    //! bits of a stream id below the job id
+    static constexpr size_t job_id_shift = 40;
+
+    //! job id of a stream id
+    static size_t StreamJobId(size_t stream_id) {
+        return stream_id >> job_id_shift;
+    }
+
+    //! drop the stream id counters and send share of a finished job. Must be
+    //! called after all the job's streams were allocated by all local workers.
+    void ReleaseJob(size_t job_id);
+
+    //! wait until the job may queue size more bytes at the dispatchers. Called
+    //! by StreamSinks on the worker threads.
+    void AcquireJobSend(size_t job_id, size_t size);
+
+    //! return bytes of the job which were sent.
+    void ReleaseJobSend(size_t job_id, size_t size);
+
+    //! number of jobs which currently have bytes queued to send
+    size_t sending_jobs();
+
+    //! \}
+
     //! \name CatStreamData
     //! \{
 
     //! Allocate the next stream
-    size_t AllocateCatStreamId(size_t local_worker_id);
+    size_t AllocateCatStreamId(size_t local_worker_id, size_t job_id = 0);
 
     //! Get stream with given id, if it does not exist, create it.
     CatStreamDataPtr GetOrCreateCatStreamData(
         size_t id, size_t local_worker_id, size_t dia_id);
 
     //! Request next stream.
-    CatStreamPtr GetNewCatStream(size_t local_worker_id, size_t dia_id);
+    CatStreamPtr GetNewCatStream(
+        size_t local_worker_id, size_t dia_id, size_t job_id = 0);
 
     //! \}
 
@@ -135,14 +235,58 @@ public:
     //! \{
 
     //! Allocate the next stream
-    size_t AllocateMixStreamId(size_t local_worker_id);
+    size_t AllocateMixStreamId(size_t local_worker_id, size_t job_id = 0);
 
     //! Get stream with given id, if it does not exist, create it.
     MixStreamDataPtr GetOrCreateMixStreamData(
         size_t id, size_t local_worker_id, size_t dia_id);
 
     //! Request next stream.
-    MixStreamPtr GetNewMixStream(size_t local_worker_id, size_t dia_id);
+    MixStreamPtr GetNewMixStream(
+        size_t local_worker_id, size_t dia_id, size_t job_id = 0);
+
+    //! \}
+
+    //! \name Progress Reports
+    //! \{
+
+    //! callback receiving progress reports on host 0
+    using ProgressCallback =
+        tlx::Delegate<void (const ProgressMultiplexerHeader&)>;
+
+    //! send a progress report to host 0, out-of-band of the Streams.
+    void SendProgress(const ProgressMultiplexerHeader& report);
+
+    //! set the callback which receives progress reports, or clear it.
+    void set_progress_callback(
+        const ProgressCallback& cb = ProgressCallback());
+
+    //! \}
+
+    //! \name Flow Control
+    //! \{
+
+    //! whether flow control with credits is enabled
+    bool flow_control() const { return flow_control_; }
+
+    //! bytes a StreamData may have in flight to each remote worker
+    size_t flow_window() const { return flow_window_; }
+
+    //! \}
+
+    //! \name Adaptive Block Size
+    //! \{
+
+    //! whether streams adapt their Block size and coalesce small Blocks
+    bool adaptive_block_size() const { return adaptive_block_size_; }
+
+    //! maximum Block size of the writers of a new stream of the given type.
+    //! It is bounded by the memory of the writers to all workers, and with
+    //! adaptive Block sizes, it follows the observed volume per target.
+    size_t WriterBlockSize(MagicByte magic);
+
+    //! record the average bytes written to each worker by a closed stream
+    void RecordTargetVolume(MagicByte magic, size_t bytes_per_target);
 
     //! \}
 
@@ -153,16 +297,37 @@ private:
     //! reference to host-global BlockPool.
     BlockPool& block_pool_;
 
-    //! dispatcher used for all communication by data::Multiplexer, the thread
-    //! never leaves the data components!
-    net::DispatcherThread& dispatcher_;
+    //! dispatchers used for all communication by data::Multiplexer, the
+    //! threads never leave the data components! Link l is handled by
+    //! dispatchers_[l % dispatchers_.size()].
+    std::vector<net::DispatcherThread*> dispatchers_;
 
     //! Holds NetConnections for outgoing Streams
     net::Group& group_;
 
+    //! Groups used as parallel lanes, the first is group_.
+    std::vector<net::Group*> lanes_;
+
     //! Number of workers per host
     size_t workers_per_host_;
 
+    //! compress Blocks sent over the network (if a compression library is
+    //! available), adaptively disabled per StreamSink.
+    bool compress_blocks_;
+
+    //! hold Blocks at the sender until the receiver returns credits
+    bool flow_control_;
+
+    //! bytes a StreamData may have in flight to each remote worker
+    size_t flow_window_;
+
+    //! adapt the Block size of streams, and coalesce small Blocks sent
+    bool adaptive_block_size_;
+
+    //! moving average of the bytes written per target worker by CatStreams
+    //! and MixStreams, protected by mutex_.
+    size_t target_volume_[2] = { 0, 0 };
+
     //! protects critical sections
     std::mutex mutex_;
 
@@ -175,12 +340,22 @@ private:
     //! Calculated send queue size limit for StreamData semaphores
     size_t send_size_limit_;
 
+    //! bytes all jobs together may have queued to send, split fairly among
+    //! the sending jobs.
+    size_t job_send_limit_;
+
     //! number of active Cat/MixStreams
     std::atomic<size_t> active_streams_ { 0 };
 
     //! maximu number of active Cat/MixStreams
     std::atomic<size_t> max_active_streams_ { 0 };
 
+    //! receives progress reports, protected by progress_mutex_
+    ProgressCallback progress_callback_;
+
+    //! protects progress_callback_
+    std::mutex progress_mutex_;
+
     //! friends for access to network components
     friend class CatStreamData;
     friend class MixStreamData;
@@ -213,23 +388,54 @@ private:
 
     using Connection = net::Connection;
 
+    //! dispatcher handling the connection of link = lane * num_hosts() + peer
+    net::DispatcherThread& link_dispatcher(size_t link) {
+        return *dispatchers_[link % dispatchers_.size()];
+    }
+
     //! expects the next MultiplexerHeader from a socket and passes to
-    //! OnMultiplexerHeader
-    void AsyncReadMultiplexerHeader(size_t peer, Connection& s);
+    //! OnMultiplexerHeader. link = lane * num_hosts() + peer identifies the
+    //! connection.
+    void AsyncReadMultiplexerHeader(size_t link, Connection& s);
 
     //! parses MultiplexerHeader and decides whether to receive Block or close
     //! Stream
     void OnMultiplexerHeader(
-        size_t peer, uint32_t seq, Connection& s, net::Buffer&& buffer);
+        size_t link, uint32_t seq, Connection& s, net::Buffer&& buffer);
+
+    //! counts final close messages of a stream from a peer, which are sent
+    //! on all lanes. Returns true once all lanes are drained.
+    bool OnFinalClose(size_t stream_id, size_t peer);
+
+    //! return the wire size of a received Block as credit to its sender, or
+    //! defer the credit while the BlockPool is over budget.
+    void GrantCredit(const StreamMultiplexerHeader& header, size_t bytes);
+
+    //! send a credit message to the host of its receiver_worker
+    void SendCredit(const CreditMultiplexerHeader& credit);
+
+    //! pass a received credit to the sending StreamData, if it still exists.
+    void OnCredit(const CreditMultiplexerHeader& credit);
+
+    //! whether the BlockPool is over the budget of ongoing receives
+    bool FlowOverBudget();
+
+    //! timer callback re-checking the deferred credits, returns whether it
+    //! should be called again.
+    bool OnCreditTimer();
+
+    //! Decompresses a received compressed Block payload into a new ByteBlock
+    PinnedByteBlockPtr DecompressBlock(
+        const StreamMultiplexerHeader& header, PinnedByteBlockPtr&& compressed);
 
     //! Receives and dispatches a Block to a CatStreamData
     void OnCatStreamBlock(
-        size_t peer, Connection& s, const StreamMultiplexerHeader& header,
+        size_t link, Connection& s, const StreamMultiplexerHeader& header,
         const CatStreamDataPtr& stream, PinnedByteBlockPtr&& bytes);
 
     //! Receives and dispatches a Block to a MixStream
     void OnMixStreamBlock(
-        size_t peer, Connection& s, const StreamMultiplexerHeader& header,
+        size_t link, Connection& s, const StreamMultiplexerHeader& header,
         const MixStreamDataPtr& stream, PinnedByteBlockPtr&& bytes);
 };
 
@@ -47,6 +47,8 @@ public:
     uint32_t typecode_verify : 1;
     //! is last block piggybacked indicator
     uint32_t is_last_block : 1;
+    //! size of the compressed payload, or zero if it is sent uncompressed
+    uint32_t compressed_size = 0;
 
     MultiplexerHeader() = default;
 
@@ -61,7 +63,7 @@ public:
     }
 
     static constexpr size_t header_size =
-        sizeof(MagicByte) + 3 * sizeof(uint32_t);
+        sizeof(MagicByte) + 4 * sizeof(uint32_t);
 
     static constexpr size_t total_size =
         header_size + sizeof(size_t) + 3 * sizeof(uint32_t);
@@ -165,6 +167,83 @@ static_assert(
     sizeof(PartitionMultiplexerHeader) == MultiplexerHeader::total_size,
     "PartitionMultiplexerHeader has invalid size");
 
+/*!
+ * Out-of-band report of the progress of a host's running stage, which the
+ * hosts send to host 0. It consists only of this header, which has the size of
+ * the other headers, such that the receiver can read it like them.
+ */
+class ProgressMultiplexerHeader
+{
+public:
+    MagicByte magic = MagicByte::ProgressReport;
+    //! phase of the stage, see api::ProgressPhase
+    uint8_t phase = 0;
+    //! unused, pads the header to total_size
+    uint8_t reserved[3] = { 0, 0, 0 };
+    //! rank of the sending host
+    uint32_t sender_host = 0;
+    //! id of the DIA node reporting
+    uint32_t dia_id = 0;
+    //! items and bytes processed, summed over the host's workers
+    uint64_t items = 0;
+    uint64_t bytes = 0;
+    //! expected total of items, or 0 if unknown
+    uint64_t total_items = 0;
+
+    //! Serializes the whole header into a buffer
+    void Serialize(net::BufferBuilder& bb) const {
+        bb.Reserve(MultiplexerHeader::total_size);
+        bb.Put<ProgressMultiplexerHeader>(*this);
+    }
+
+    //! Reads the header from a buffer
+    static ProgressMultiplexerHeader Parse(net::BufferReader& br) {
+        return br.Get<ProgressMultiplexerHeader>();
+    }
+} TLX_ATTRIBUTE_PACKED;
+
+static_assert(
+    sizeof(ProgressMultiplexerHeader) == MultiplexerHeader::total_size,
+    "ProgressMultiplexerHeader has invalid size");
+
+/*!
+ * Flow control credit, which the receiver of stream Blocks returns to their
+ * sender, once it can accept the bytes of the Blocks in flight again. It
+ * consists only of this header, which has the size of the other headers.
+ */
+class CreditMultiplexerHeader
+{
+public:
+    MagicByte magic = MagicByte::StreamCredit;
+    //! unused, pads the header to total_size
+    uint8_t reserved[4] = { 0, 0, 0, 0 };
+    //! global worker rank of the receiver of the Blocks, granting the credit
+    uint32_t sender_worker = 0;
+    //! global worker rank of the sender of the Blocks, receiving the credit
+    uint32_t receiver_worker = 0;
+    //! stream of the Blocks
+    uint64_t stream_id = 0;
+    //! bytes returned to the window, including the Blocks' headers
+    uint64_t bytes = 0;
+    //! unused, pads the header to total_size
+    uint64_t reserved2 = 0;
+
+    //! Serializes the whole header into a buffer
+    void Serialize(net::BufferBuilder& bb) const {
+        bb.Reserve(MultiplexerHeader::total_size);
+        bb.Put<CreditMultiplexerHeader>(*this);
+    }
+
+    //! Reads the header from a buffer
+    static CreditMultiplexerHeader Parse(net::BufferReader& br) {
+        return br.Get<CreditMultiplexerHeader>();
+    }
+} TLX_ATTRIBUTE_PACKED;
+
+static_assert(
+    sizeof(CreditMultiplexerHeader) == MultiplexerHeader::total_size,
+    "CreditMultiplexerHeader has invalid size");
+
 #if defined(_MSC_VER)
 #pragma pack(pop)
 #endif
@@ -0,0 +1,143 @@
+/*******************************************************************************
+ * thrill/data/pinned_string_view.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_PINNED_STRING_VIEW_HEADER
+#define THRILL_DATA_PINNED_STRING_VIEW_HEADER
+
+#include <thrill/data/block.hpp>
+#include <tlx/container/string_view.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * PinnedStringView is a borrowed string, which references the serialized bytes
+ * of a std::string item inside a pinned Block. The PinnedBlock is held, and
+ * thus the ByteBlock stays pinned, for the lifetime of the view, such that keys
+ * can be hashed and compared without allocating and copying them. Strings
+ * split between two Blocks cannot be referenced and are stored as an owned
+ * copy instead.
+ *
+ * Views are created by BlockReader::NextStringView() and GetStringView(). Keep
+ * them short-lived: each one prevents its Block from being evicted.
+ */
+class PinnedStringView
+{
+public:
+    //! create an empty view
+    PinnedStringView() = default;
+
+    //! reference size bytes at data inside the pinned Block block
+    PinnedStringView(const PinnedBlock& block, const char* data, size_t size)
+        : block_(block), data_(data), size_(size) { }
+
+    //! take ownership of a string, which could not be referenced
+    explicit PinnedStringView(std::string&& owned)
+        : owned_(std::move(owned)), size_(owned_.size()) { }
+
+    PinnedStringView(const PinnedStringView&) = default;
+    PinnedStringView(PinnedStringView&&) = default;
+    PinnedStringView& operator = (PinnedStringView&&) = default;
+
+    //! pointer to the characters
+    const char * data() const {
+        return block_.IsValid() ? data_ : owned_.data();
+    }
+
+    //! length of the string
+    size_t size() const { return size_; }
+
+    //! whether the string is empty
+    bool empty() const { return size_ == 0; }
+
+    //! whether the view references a pinned Block instead of owning a copy
+    bool borrowed() const { return block_.IsValid(); }
+
+    //! return a tlx::string_view of the characters
+    tlx::string_view view() const { return tlx::string_view(data(), size_); }
+
+    //! materialize an owned std::string
+    std::string ToString() const { return std::string(data(), size_); }
+
+    //! \name Comparison Operators
+    //! \{
+
+    int compare(const char* data, size_t size) const {
+        int r = std::memcmp(this->data(), data, std::min(size_, size));
+        if (r != 0) return r;
+        return size_ < size ? -1 : size_ > size ? 1 : 0;
+    }
+
+    int compare(const PinnedStringView& b) const {
+        return compare(b.data(), b.size());
+    }
+
+    int compare(const std::string& b) const {
+        return compare(b.data(), b.size());
+    }
+
+    bool operator == (const PinnedStringView& b) const {
+        return size_ == b.size_ && compare(b) == 0;
+    }
+    bool operator != (const PinnedStringView& b) const {
+        return !operator == (b);
+    }
+    bool operator < (const PinnedStringView& b) const {
+        return compare(b) < 0;
+    }
+
+    bool operator == (const std::string& b) const {
+        return size_ == b.size() && compare(b) == 0;
+    }
+    bool operator != (const std::string& b) const {
+        return !operator == (b);
+    }
+    bool operator < (const std::string& b) const {
+        return compare(b) < 0;
+    }
+
+    //! \}
+
+    //! make ostreamable for debugging
+    friend std::ostream&
+    operator << (std::ostream& os, const PinnedStringView& sv) {
+        return os.write(sv.data(), sv.size());
+    }
+
+private:
+    //! the pinned Block containing the referenced bytes, or invalid if owned_
+    PinnedBlock block_;
+
+    //! owned copy of strings which are split between Blocks
+    std::string owned_;
+
+    //! referenced bytes inside block_
+    const char* data_ = nullptr;
+
+    //! length of the string
+    size_t size_ = 0;
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_PINNED_STRING_VIEW_HEADER
+
+/******************************************************************************/
@@ -224,6 +224,30 @@ struct Serialization<Archive, std::array<T, N>,
     static constexpr size_t fixed_size = N * Serialization<Archive, T>::fixed_size;
 };
 
+/***************** Raw Copies of Serialized Items *****************************/
+
+/*!
+ * Whether the serialization of T is exactly its object representation, such
+ * that a contiguous run of serialized items can be copied as an array of T.
+ * This holds for PODs and for pairs of such types without padding.
+ */
+template <typename T, typename Enable = void>
+struct IsRawSerializable : public std::false_type { };
+
+template <typename T>
+struct IsRawSerializable<
+    T, typename std::enable_if<
+        std::is_pod<T>::value && !std::is_pointer<T>::value>::type>
+    : public std::true_type { };
+
+template <typename U, typename V>
+struct IsRawSerializable<std::pair<U, V> >
+    : public std::integral_constant<
+          bool,
+          IsRawSerializable<U>::value && IsRawSerializable<V>::value &&
+          std::is_trivially_copyable<std::pair<U, V> >::value &&
+          sizeof(U) + sizeof(V) == sizeof(std::pair<U, V>)>{ };
+
 /******************* Serialization via Class Methods **************************/
 
 TLX_MAKE_HAS_MEMBER(thrill_is_fixed_size);
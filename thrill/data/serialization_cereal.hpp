@@ -15,6 +15,7 @@
 #include <cereal/cereal.hpp>
 #include <cereal/details/traits.hpp>
 #include <thrill/common/functional.hpp>
+#include <thrill/data/serialization.hpp>
 #include <thrill/data/serialization_fwd.hpp>
 #include <tlx/meta/is_std_array.hpp>
 #include <tlx/meta/is_std_pair.hpp>
@@ -23,6 +24,7 @@
 
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 namespace thrill {
 namespace data {
@@ -187,11 +189,57 @@ void CEREAL_LOAD_FUNCTION_NAME(
 //! \addtogroup data_layer
 //! \{
 
+/*!
+ * Opt-in trait for cereal-serializable user types whose members are all
+ * fixed-size and trivially copyable: specialize it to std::true_type for T,
+ * e.g. via THRILL_CEREAL_RAW_COPY(T). Such T are serialized with a single raw
+ * copy of their object representation instead of field by field through
+ * cereal, are fixed-size items, and are IsRawSerializable, which enables the
+ * fixed-size fast paths of the Block readers and of Sort, Zip and ReadBinary.
+ *
+ * The raw representation includes padding bytes and depends on the platform,
+ * hence it must only be used between identical binaries.
+ */
+template <typename T>
+struct CerealRawCopy : public std::false_type { };
+
+template <typename T>
+struct IsRawSerializable<
+    T, typename std::enable_if<
+        CerealRawCopy<T>::value && !std::is_pod<T>::value>::type>
+    : public std::true_type {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "CerealRawCopy<T> requires a trivially copyable T");
+};
+
+/************** Raw copies of fixed-size cereal types *************************/
+
+template <typename Archive, typename T>
+struct Serialization<Archive, T, typename std::enable_if<
+                         CerealRawCopy<T>::value &&
+                         !std::is_pod<T>::value
+                         >::type> {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "CerealRawCopy<T> requires a trivially copyable T");
+
+    static void Serialize(const T& t, Archive& ar) {
+        ar.Append(&t, sizeof(T));
+    }
+    static T Deserialize(Archive& ar) {
+        T res;
+        ar.Read(&res, sizeof(T));
+        return res;
+    }
+    static constexpr bool   is_fixed_size = true;
+    static constexpr size_t fixed_size = sizeof(T);
+};
+
 /************** Use cereal if serialization function is given *****************/
 
 template <typename Archive, typename T>
 struct Serialization<Archive, T, typename std::enable_if<
                          cereal::traits::is_input_serializable<T, Archive>::value &&
+                         !CerealRawCopy<T>::value &&
                          !std::is_pod<T>::value &&
                          !std::is_same<T, std::string>::value &&
                          !tlx::is_std_pair<T>::value &&
@@ -223,6 +271,16 @@ struct Serialization<Archive, T, typename std::enable_if<
 } // namespace data
 } // namespace thrill
 
+//! Declare that the cereal-serializable Type is copied raw, see CerealRawCopy.
+//! Use it in the global namespace.
+#define THRILL_CEREAL_RAW_COPY(Type)                                    \
+    namespace thrill {                                                  \
+    namespace data {                                                    \
+    template <>                                                         \
+    struct CerealRawCopy<Type> : public std::true_type { };             \
+    } /* namespace data */                                              \
+    } /* namespace thrill */
+
 // register archives for polymorphic support
 // CEREAL_REGISTER_ARCHIVE(thrill::data::ThrillOutputArchive)
 // CEREAL_REGISTER_ARCHIVE(thrill::data::ThrillInputArchive)
@@ -0,0 +1,286 @@
+/*******************************************************************************
+ * thrill/data/serialization_compact.hpp
+ *
+ * Opt-in compact serialization archives: CompactWriter and CompactReader wrap a
+ * BlockWriter and BlockReader and store integral fields of items as varints
+ * and, optionally, strings of sorted runs as suffixes of the previous string.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_SERIALIZATION_COMPACT_HEADER
+#define THRILL_DATA_SERIALIZATION_COMPACT_HEADER
+
+#include <thrill/data/block_writer.hpp>
+#include <thrill/data/serialization.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+namespace detail {
+
+//! Whether PutRaw() and GetRaw() of a CompactWriter or CompactReader encode T
+//! as a varint. Single bytes and bools are never shorter as varint.
+template <typename T>
+struct IsCompactVarint
+    : public std::integral_constant<
+          bool, std::is_integral<T>::value && (sizeof(T) > 1)>{ };
+
+//! map signed integers to unsigned such that small magnitudes are small.
+template <typename T>
+uint64_t ZigZagEncode(const T& x, std::true_type /* signed */) {
+    int64_t v = static_cast<int64_t>(x);
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+template <typename T>
+uint64_t ZigZagEncode(const T& x, std::false_type /* signed */) {
+    return static_cast<uint64_t>(x);
+}
+
+template <typename T>
+T ZigZagDecode(uint64_t v, std::true_type /* signed */) {
+    return static_cast<T>(
+        static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1));
+}
+
+template <typename T>
+T ZigZagDecode(uint64_t v, std::false_type /* signed */) {
+    return static_cast<T>(v);
+}
+
+} // namespace detail
+
+/*!
+ * CompactWriter is an opt-in serialization archive around a BlockWriter. Items
+ * are put with Put() and serialized by the usual Serialization classes, except
+ * that all integral fields wider than one byte, which the POD serializers
+ * write with PutRaw(), are stored as (zigzag) varints. This shrinks items
+ * containing mostly small numbers, e.g. word counts.
+ *
+ * If prefix_strings is set, each string is stored as the length of its common
+ * prefix with the previous string written through this CompactWriter, followed
+ * by its remaining suffix. This pays off for sorted runs of strings, but the
+ * items can then only be read sequentially from the first one.
+ *
+ * Items must be read back with a CompactReader with the same prefix_strings
+ * setting. The item counts of the Blocks are maintained as usual.
+ */
+template <typename Writer>
+class CompactWriter
+{
+public:
+    explicit CompactWriter(Writer& writer, bool prefix_strings = false)
+        : writer_(writer), prefix_strings_(prefix_strings) { }
+
+    //! non-copyable: delete copy-constructor
+    CompactWriter(const CompactWriter&) = delete;
+    //! non-copyable: delete assignment operator
+    CompactWriter& operator = (const CompactWriter&) = delete;
+
+    //! Put appends a complete item, or fails with a FullException.
+    template <typename T>
+    CompactWriter& Put(const T& x) {
+        if (!prefix_strings_) {
+            writer_.Put(x, *this);
+            return *this;
+        }
+        // save the previous string, since an unwound item must not change it.
+        saved_ = last_;
+        try {
+            writer_.Put(x, *this);
+        }
+        catch (FullException&) {
+            last_.swap(saved_);
+            throw;
+        }
+        return *this;
+    }
+
+    //! whether strings are prefix-compressed
+    bool prefix_strings() const { return prefix_strings_; }
+
+    //! \name Archive Interface for Serialization
+    //! \{
+
+    CompactWriter& PutByte(Byte data) {
+        writer_.PutByte(data);
+        return *this;
+    }
+
+    CompactWriter& Append(const void* data, size_t size) {
+        writer_.Append(data, size);
+        return *this;
+    }
+
+    CompactWriter& PutVarint(uint64_t v) {
+        writer_.PutVarint(v);
+        return *this;
+    }
+
+    CompactWriter& PutVarint32(uint32_t v) {
+        writer_.PutVarint32(v);
+        return *this;
+    }
+
+    //! PutRaw() stores integral types as varints, other PODs verbatim
+    template <typename Type>
+    CompactWriter& PutRaw(const Type& item) {
+        return PutRaw(item, detail::IsCompactVarint<Type>());
+    }
+
+    CompactWriter& PutString(const char* data, size_t len) {
+        if (!prefix_strings_) {
+            writer_.PutString(data, len);
+            return *this;
+        }
+        size_t lcp = std::mismatch(
+            data, data + std::min(len, last_.size()), last_.data()).first - data;
+        writer_.PutVarint(lcp).PutVarint(len - lcp);
+        writer_.Append(data + lcp, len - lcp);
+        last_.assign(data, len);
+        return *this;
+    }
+
+    CompactWriter& PutString(const uint8_t* data, size_t len) {
+        return PutString(reinterpret_cast<const char*>(data), len);
+    }
+
+    CompactWriter& PutString(const std::string& str) {
+        return PutString(str.data(), str.size());
+    }
+
+    //! \}
+
+private:
+    //! underlying BlockWriter
+    Writer& writer_;
+
+    //! whether strings are prefix-compressed
+    bool prefix_strings_;
+
+    //! previous string written and its copy saved before each item
+    std::string last_, saved_;
+
+    template <typename Type>
+    CompactWriter& PutRaw(const Type& item, std::true_type /* varint */) {
+        writer_.PutVarint(
+            detail::ZigZagEncode(item, std::is_signed<Type>()));
+        return *this;
+    }
+
+    template <typename Type>
+    CompactWriter& PutRaw(const Type& item, std::false_type /* varint */) {
+        writer_.PutRaw(item);
+        return *this;
+    }
+};
+
+/*!
+ * CompactReader is the opt-in deserialization archive around a BlockReader,
+ * which reads items written by a CompactWriter.
+ */
+template <typename Reader>
+class CompactReader
+{
+public:
+    explicit CompactReader(Reader& reader, bool prefix_strings = false)
+        : reader_(reader), prefix_strings_(prefix_strings) { }
+
+    //! non-copyable: delete copy-constructor
+    CompactReader(const CompactReader&) = delete;
+    //! non-copyable: delete assignment operator
+    CompactReader& operator = (const CompactReader&) = delete;
+
+    //! HasNext() returns true if at least one more item is available.
+    bool HasNext() { return reader_.HasNext(); }
+
+    //! Next() reads a complete item T
+    template <typename T>
+    T Next() {
+        return reader_.template Next<T>(*this);
+    }
+
+    //! whether strings are prefix-compressed
+    bool prefix_strings() const { return prefix_strings_; }
+
+    //! \name Archive Interface for Deserialization
+    //! \{
+
+    Byte GetByte() { return reader_.GetByte(); }
+
+    CompactReader& Read(void* outdata, size_t size) {
+        reader_.Read(outdata, size);
+        return *this;
+    }
+
+    std::string Read(size_t datalen) { return reader_.Read(datalen); }
+
+    uint64_t GetVarint() { return reader_.GetVarint(); }
+
+    uint32_t GetVarint32() { return reader_.GetVarint32(); }
+
+    //! GetRaw() reads integral types as varints, other PODs verbatim
+    template <typename Type>
+    Type GetRaw() {
+        return GetRaw<Type>(detail::IsCompactVarint<Type>());
+    }
+
+    std::string GetString() {
+        if (!prefix_strings_)
+            return reader_.GetString();
+
+        size_t lcp = reader_.GetVarint();
+        size_t rest = reader_.GetVarint();
+        if (lcp > last_.size())
+            throw std::runtime_error(
+                      "CompactReader: string prefix longer than previous one.");
+        last_.resize(lcp + rest);
+        reader_.Read(&last_[lcp], rest);
+        return last_;
+    }
+
+    //! \}
+
+private:
+    //! underlying BlockReader
+    Reader& reader_;
+
+    //! whether strings are prefix-compressed
+    bool prefix_strings_;
+
+    //! previous string read
+    std::string last_;
+
+    template <typename Type>
+    Type GetRaw(std::true_type /* varint */) {
+        return detail::ZigZagDecode<Type>(
+            reader_.GetVarint(), std::is_signed<Type>());
+    }
+
+    template <typename Type>
+    Type GetRaw(std::false_type /* varint */) {
+        return reader_.template GetRaw<Type>();
+    }
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_SERIALIZATION_COMPACT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * thrill/data/serialization_macro.hpp
+ *
+ * THRILL_SERIALIZE(Type, fields...) macro generating a Serialization class for
+ * a user struct from the list of its data members.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_SERIALIZATION_MACRO_HEADER
+#define THRILL_DATA_SERIALIZATION_MACRO_HEADER
+
+#include <thrill/data/serialization.hpp>
+
+#include <cstddef>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_internal
+//! \{
+
+namespace detail {
+
+//! whether all member types are fixed-size, and the sum of their sizes
+template <typename Archive, typename... Members>
+struct MemberSerialization {
+    static constexpr bool   is_fixed_size = true;
+    static constexpr size_t fixed_size = 0;
+};
+
+template <typename Archive, typename Member, typename... Members>
+struct MemberSerialization<Archive, Member, Members...> {
+    static constexpr bool   is_fixed_size =
+        Serialization<Archive, Member>::is_fixed_size &&
+        MemberSerialization<Archive, Members...>::is_fixed_size;
+    static constexpr size_t fixed_size =
+        Serialization<Archive, Member>::fixed_size +
+        MemberSerialization<Archive, Members...>::fixed_size;
+};
+
+} // namespace detail
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+//! \cond
+
+// apply THRILL_SERIALIZE_##m(Type, field) to each of up to 16 fields
+#define THRILL_SERIALIZE_EACH_1(m, T, f) m(T, f)
+#define THRILL_SERIALIZE_EACH_2(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_1(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_3(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_2(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_4(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_3(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_5(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_4(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_6(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_5(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_7(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_6(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_8(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_7(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_9(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_8(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_10(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_9(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_11(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_10(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_12(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_11(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_13(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_12(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_14(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_13(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_15(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_14(m, T, __VA_ARGS__)
+#define THRILL_SERIALIZE_EACH_16(m, T, f, ...) \
+    m(T, f) THRILL_SERIALIZE_EACH_15(m, T, __VA_ARGS__)
+
+#define THRILL_SERIALIZE_SELECT(                                        \
+        _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, \
+        _16, NAME, ...) NAME
+
+#define THRILL_SERIALIZE_EACH(m, T, ...)                                \
+    THRILL_SERIALIZE_SELECT(                                            \
+        __VA_ARGS__,                                                    \
+        THRILL_SERIALIZE_EACH_16, THRILL_SERIALIZE_EACH_15,             \
+        THRILL_SERIALIZE_EACH_14, THRILL_SERIALIZE_EACH_13,             \
+        THRILL_SERIALIZE_EACH_12, THRILL_SERIALIZE_EACH_11,             \
+        THRILL_SERIALIZE_EACH_10, THRILL_SERIALIZE_EACH_9,              \
+        THRILL_SERIALIZE_EACH_8, THRILL_SERIALIZE_EACH_7,               \
+        THRILL_SERIALIZE_EACH_6, THRILL_SERIALIZE_EACH_5,               \
+        THRILL_SERIALIZE_EACH_4, THRILL_SERIALIZE_EACH_3,               \
+        THRILL_SERIALIZE_EACH_2, THRILL_SERIALIZE_EACH_1, )             \
+    (m, T, __VA_ARGS__)
+
+#define THRILL_SERIALIZE_TYPE(T, f) , decltype(T::f)
+
+#define THRILL_SERIALIZE_PUT(T, f) \
+    Serialization<Archive, decltype(T::f)>::Serialize(x.f, ar);
+
+#define THRILL_SERIALIZE_GET(T, f) \
+    x.f = Serialization<Archive, decltype(T::f)>::Deserialize(ar);
+
+//! \endcond
+
+/*!
+ * Generate a Serialization class for the struct Type from the list of its (up
+ * to 16) data members, which are serialized in the given order with their own
+ * Serialization classes. is_fixed_size and fixed_size are computed from the
+ * member types at compile time, so items of only fixed-size members take the
+ * fixed-size paths of the data layer. Type must be default-constructible and
+ * its members assignable. Use the macro in the global namespace.
+ */
+#define THRILL_SERIALIZE(Type, ...)                                     \
+    namespace thrill {                                                  \
+    namespace data {                                                    \
+    template <typename Archive>                                         \
+    struct Serialization<Archive, Type> {                               \
+        static void Serialize(const Type& x, Archive& ar) {             \
+            THRILL_SERIALIZE_EACH(THRILL_SERIALIZE_PUT, Type, __VA_ARGS__) \
+        }                                                               \
+        static Type Deserialize(Archive& ar) {                          \
+            Type x;                                                     \
+            THRILL_SERIALIZE_EACH(THRILL_SERIALIZE_GET, Type, __VA_ARGS__) \
+            return x;                                                   \
+        }                                                               \
+        using Members = detail::MemberSerialization<                    \
+            Archive THRILL_SERIALIZE_EACH(                              \
+                THRILL_SERIALIZE_TYPE, Type, __VA_ARGS__)>;             \
+        static constexpr bool   is_fixed_size = Members::is_fixed_size; \
+        static constexpr size_t fixed_size = Members::fixed_size;       \
+    };                                                                  \
+    } /* namespace data */                                              \
+    } /* namespace thrill */
+
+#endif // !THRILL_DATA_SERIALIZATION_MACRO_HEADER
+
+/******************************************************************************/
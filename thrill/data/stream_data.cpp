@@ -30,12 +30,17 @@ StreamData::StreamData(StreamSetBase* stream_set_base,
       stream_set_base_(stream_set_base),
       local_worker_id_(local_worker_id),
       dia_id_(dia_id),
-      multiplexer_(multiplexer)
-{ }
+      multiplexer_(multiplexer) {
+    tx_net_bytes_per_host_ =
+        std::vector<std::atomic<size_t> >(multiplexer_.num_hosts());
+    if (multiplexer_.flow_control())
+        credit_targets_.resize(multiplexer_.num_workers());
+}
 
 StreamData::~StreamData() = default;
 
 void StreamData::OnWriterClosed(size_t peer_worker_rank, bool sent) {
+    std::unique_lock<std::mutex> lock(tx_mutex_);
     ++writers_closed_;
 
     LOG << "StreamData::OnWriterClosed()"
@@ -55,10 +60,14 @@ void StreamData::OnWriterClosed(size_t peer_worker_rank, bool sent) {
 
         OnAllWritersClosed();
         all_writers_closed_ = true;
+        tx_cv_.notify_all();
     }
 }
 
 void StreamData::OnAllWritersClosed() {
+    std::vector<size_t> tx_net_bytes_per_host(
+        tx_net_bytes_per_host_.begin(), tx_net_bytes_per_host_.end());
+
     multiplexer_.logger()
         << "class" << "StreamData"
         << "event" << "close"
@@ -74,6 +83,10 @@ void StreamData::OnAllWritersClosed() {
         << "tx_net_items" << tx_net_items_
         << "tx_net_bytes" << tx_net_bytes_
         << "tx_net_blocks" << tx_net_blocks_
+        << "tx_net_bytes_per_host" << tx_net_bytes_per_host
+        << "tx_net_compress_raw_bytes" << tx_net_compress_raw_bytes_
+        << "tx_net_compress_bytes" << tx_net_compress_bytes_
+        << "tx_net_held_blocks" << tx_net_held_blocks_
         << "rx_int_items" << rx_int_items_
         << "rx_int_bytes" << rx_int_bytes_
         << "rx_int_blocks" << rx_int_blocks_
@@ -82,6 +95,113 @@ void StreamData::OnAllWritersClosed() {
         << "tx_int_blocks" << tx_int_blocks_;
 }
 
+void StreamData::SendRemoteBlock(size_t peer_worker_rank, size_t lane,
+                                 net::Buffer&& header, PinnedBlock&& block) {
+    if (!multiplexer_.flow_control()) {
+        return IntSendRemoteBlock(
+            peer_worker_rank, lane, std::move(header), std::move(block));
+    }
+
+    size_t size = header.size() + block.size();
+    {
+        std::unique_lock<std::mutex> lock(tx_mutex_);
+        CreditTarget& t = credit_targets_[peer_worker_rank];
+
+        if (!t.held.empty() || !FitsWindow(t, size)) {
+            // unpin the Block while it waits, such that it can be spilled.
+            t.held.emplace_back(
+                HeldBlock { lane, std::move(header),
+                            std::move(block).MoveToBlock() });
+            tx_net_held_blocks_++;
+            return;
+        }
+        t.in_flight += size;
+    }
+
+    IntSendRemoteBlock(
+        peer_worker_rank, lane, std::move(header), std::move(block));
+}
+
+void StreamData::OnRemoteWriterClosed(size_t peer_worker_rank, bool sent) {
+    if (multiplexer_.flow_control()) {
+        std::unique_lock<std::mutex> lock(tx_mutex_);
+        CreditTarget& t = credit_targets_[peer_worker_rank];
+
+        if (!t.held.empty() || t.sending != 0) {
+            t.close_pending = true;
+            t.close_sent = sent;
+            return;
+        }
+    }
+    OnWriterClosed(peer_worker_rank, sent);
+}
+
+void StreamData::OnCredit(size_t peer_worker_rank, size_t bytes) {
+    std::vector<HeldBlock> ready;
+    {
+        std::unique_lock<std::mutex> lock(tx_mutex_);
+        CreditTarget& t = credit_targets_[peer_worker_rank];
+
+        die_unless(t.in_flight >= bytes);
+        t.in_flight -= bytes;
+
+        while (!t.held.empty() &&
+               FitsWindow(t, t.held.front().header.size() +
+                          t.held.front().block.size())) {
+            t.in_flight +=
+                t.held.front().header.size() + t.held.front().block.size();
+            ready.emplace_back(std::move(t.held.front()));
+            t.held.pop_front();
+        }
+        t.sending += ready.size();
+    }
+
+    for (HeldBlock& h : ready) {
+        IntSendRemoteBlock(peer_worker_rank, h.lane, std::move(h.header),
+                           h.block.PinWait(local_worker_id_));
+    }
+
+    bool close = false, sent = false;
+    {
+        std::unique_lock<std::mutex> lock(tx_mutex_);
+        CreditTarget& t = credit_targets_[peer_worker_rank];
+
+        t.sending -= ready.size();
+        if (t.close_pending && t.held.empty() && t.sending == 0) {
+            t.close_pending = false;
+            close = true;
+            sent = t.close_sent;
+        }
+    }
+
+    // the StreamSink was closed, send its close after the held Blocks.
+    if (close)
+        OnWriterClosed(peer_worker_rank, sent);
+}
+
+void StreamData::WaitWritersClosed() {
+    if (!multiplexer_.flow_control()) return;
+    std::unique_lock<std::mutex> lock(tx_mutex_);
+    tx_cv_.wait(lock, [this]() { return all_writers_closed_; });
+}
+
+void StreamData::IntSendRemoteBlock(size_t peer_worker_rank, size_t lane,
+                                    net::Buffer&& header, PinnedBlock&& block) {
+    size_t peer_rank = peer_worker_rank / workers_per_host();
+    net::Connection& conn = multiplexer_.connection(peer_rank, lane);
+    size_t send_size = header.size() + block.size();
+
+    multiplexer_.dispatcher(peer_rank, lane).AsyncWrite(
+        conn, 42 + (conn.tx_seq_.fetch_add(2) & 0xFFFF),
+        // send out Buffer and Block, guaranteed to be successive
+        std::move(header), std::move(block),
+        [s = StreamDataPtr(this), send_size](net::Connection&) {
+            s->sem_queue_.signal(send_size);
+            s->multiplexer_.ReleaseJobSend(
+                Multiplexer::StreamJobId(s->id_), send_size);
+        });
+}
+
 /******************************************************************************/
 // StreamData::Writers
 
@@ -142,6 +262,23 @@ void StreamSet<StreamData>::Close() {
         c->Close();
 }
 
+template <typename StreamData>
+void StreamSet<StreamData>::NetTraffic(size_t* tx_bytes, size_t* rx_bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (StreamDataPtr& c : streams_) {
+        *tx_bytes += c->tx_net_bytes_;
+        *rx_bytes += c->rx_net_bytes_;
+    }
+}
+
+template <typename StreamData>
+tlx::CountingPtr<data::StreamData>
+StreamSet<StreamData>::PeerData(size_t local_worker_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    assert(local_worker_id < streams_.size());
+    return tlx::CountingPtr<data::StreamData>(streams_[local_worker_id]);
+}
+
 template <typename StreamData>
 void StreamSet<StreamData>::OnWriterClosed(size_t peer_worker_rank, bool sent) {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -193,17 +330,22 @@ void StreamSet<StreamData>::OnWriterClosed(size_t peer_worker_rank, bool sent) {
         header.receiver_local_worker = StreamMultiplexerHeader::all_workers;
         header.seq = StreamMultiplexerHeader::final_seq;
 
-        net::BufferBuilder bb;
-        header.Serialize(bb);
+        // send the final close on all lanes after the Blocks queued there,
+        // such that the receiver knows when all have arrived.
+        for (size_t lane = 0; lane < multiplexer_.num_lanes(); ++lane) {
+            net::BufferBuilder bb;
+            header.Serialize(bb);
 
-        net::Buffer buffer = bb.ToBuffer();
-        assert(buffer.size() == MultiplexerHeader::total_size);
+            net::Buffer buffer = bb.ToBuffer();
+            assert(buffer.size() == MultiplexerHeader::total_size);
 
-        net::Connection& conn = multiplexer_.group().connection(peer_host_rank);
+            net::Connection& conn =
+                multiplexer_.connection(peer_host_rank, lane);
 
-        multiplexer_.dispatcher().AsyncWrite(
-            conn, 42 + (conn.tx_seq_.fetch_add(2) & 0xFFFF),
-            std::move(buffer));
+            multiplexer_.dispatcher(peer_host_rank, lane).AsyncWrite(
+                conn, 42 + (conn.tx_seq_.fetch_add(2) & 0xFFFF),
+                std::move(buffer));
+        }
     }
 }
 
@@ -18,8 +18,12 @@
 #include <thrill/data/block_writer.hpp>
 #include <thrill/data/file.hpp>
 #include <thrill/data/multiplexer.hpp>
+#include <thrill/net/buffer.hpp>
 #include <tlx/semaphore.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <vector>
 
@@ -32,7 +36,8 @@ namespace data {
 using StreamId = size_t;
 
 enum class MagicByte : uint8_t {
-    Invalid, CatStreamBlock, MixStreamBlock, PartitionBlock
+    Invalid, CatStreamBlock, MixStreamBlock, PartitionBlock, ProgressReport,
+    StreamCredit
 };
 
 class StreamSink;
@@ -125,6 +130,28 @@ public:
     //! method called when all StreamSink writers have finished
     void OnAllWritersClosed();
 
+    //! \name Flow Control
+    //! \{
+
+    //! send a serialized StreamMultiplexerHeader and its Block to a remote
+    //! worker on the lane, or hold them while the worker's window is full.
+    void SendRemoteBlock(size_t peer_worker_rank, size_t lane,
+                         net::Buffer&& header, PinnedBlock&& block);
+
+    //! method called from a remote StreamSink when it is closed, which defers
+    //! the close until all held Blocks to the worker were sent.
+    void OnRemoteWriterClosed(size_t peer_worker_rank, bool sent);
+
+    //! method called by the Multiplexer when a remote worker returns credit,
+    //! sends the held Blocks which fit into the window again.
+    void OnCredit(size_t peer_worker_rank, size_t bytes);
+
+    //! wait until all writers are closed, which with flow control may happen
+    //! after the StreamSinks were closed.
+    void WaitWritersClosed();
+
+    //! \}
+
     /*------------------------------------------------------------------------*/
     ///////// expose these members - getters would be too java-ish /////////////
 
@@ -138,6 +165,18 @@ public:
     std::atomic<size_t>
     tx_net_items_ { 0 }, tx_net_bytes_ { 0 }, tx_net_blocks_ { 0 };
 
+    //! StatsCounters for outgoing compressed network transfer: the raw and the
+    //! compressed size of all Blocks which were sent compressed.
+    std::atomic<size_t>
+    tx_net_compress_raw_bytes_ { 0 }, tx_net_compress_bytes_ { 0 };
+
+    //! StatsCounters for outgoing network transfer to each peer host, such
+    //! that skewed data exchanges can be visualized as a traffic matrix.
+    std::vector<std::atomic<size_t> > tx_net_bytes_per_host_;
+
+    //! StatsCounter for outgoing Blocks held back by flow control
+    std::atomic<size_t> tx_net_held_blocks_ { 0 };
+
     //! StatsCounter for incoming data transfer.  Exclusively contains only
     //! loopback (internal) data transfer
     std::atomic<size_t>
@@ -183,12 +222,56 @@ protected:
     //! number of received stream closing Blocks.
     tlx::Semaphore sem_closing_blocks_;
 
+    //! serializes the delivery of received Blocks, since the lanes to a peer
+    //! may be handled by different DispatcherThreads.
+    std::mutex rx_mutex_;
+
     //! number of writers closed via StreamSink.
     size_t writers_closed_ = 0;
 
     //! bool if all writers were closed
     bool all_writers_closed_ = false;
 
+    //! a serialized header and its Block held back by flow control
+    struct HeldBlock {
+        size_t      lane;
+        net::Buffer header;
+        Block       block;
+    };
+
+    //! flow control state of the Blocks sent to a remote worker
+    struct CreditTarget {
+        //! bytes sent, for which no credit was returned yet
+        size_t                in_flight = 0;
+        //! Blocks waiting for credit, unpinned such that they can be spilled
+        std::deque<HeldBlock> held;
+        //! number of Blocks taken from held, which are being sent
+        size_t                sending = 0;
+        //! StreamSink was closed while Blocks were held, and whether it sent
+        //! its close piggy-backed
+        bool                  close_pending = false, close_sent = false;
+    };
+
+    //! flow control state per global worker, only used with flow control.
+    std::vector<CreditTarget> credit_targets_;
+
+    //! protects writers_closed_, all_writers_closed_, and credit_targets_,
+    //! since held Blocks are sent and closed by DispatcherThreads.
+    std::mutex tx_mutex_;
+
+    //! signaled when all_writers_closed_ is set
+    std::condition_variable tx_cv_;
+
+    //! pass the header and Block to the network.
+    void IntSendRemoteBlock(size_t peer_worker_rank, size_t lane,
+                            net::Buffer&& header, PinnedBlock&& block);
+
+    //! whether the Block fits into the window of the target.
+    bool FitsWindow(const CreditTarget& t, size_t size) const {
+        return t.in_flight == 0 ||
+               t.in_flight + size <= multiplexer_.flow_window();
+    }
+
     //! friends for access to multiplexer_
     friend class StreamSink;
 };
@@ -211,6 +294,12 @@ public:
     //! method called from StreamSink when it is closed, used to aggregate Close
     //! messages to remote hosts
     virtual void OnWriterClosed(size_t peer_worker_rank, bool sent) = 0;
+
+    //! add the network bytes sent and received by all streams in the set
+    virtual void NetTraffic(size_t* tx_bytes, size_t* rx_bytes) = 0;
+
+    //! Returns the stream of the local worker, or nullptr if it was released.
+    virtual StreamDataPtr PeerData(size_t local_worker_id) = 0;
 };
 
 /*!
@@ -243,6 +332,12 @@ public:
     //! messages to remote hosts
     void OnWriterClosed(size_t peer_worker_rank, bool sent);
 
+    //! add the network bytes sent and received by all streams in the set
+    void NetTraffic(size_t* tx_bytes, size_t* rx_bytes) final;
+
+    //! Returns the stream of the local worker, or nullptr if it was released.
+    tlx::CountingPtr<data::StreamData> PeerData(size_t local_worker_id) final;
+
     //! Returns my_host_rank
     size_t my_host_rank() const { return multiplexer_.my_host_rank(); }
     //! Number of hosts in system
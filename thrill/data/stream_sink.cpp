@@ -17,6 +17,8 @@
 
 #include <tlx/string/hexdump.hpp>
 
+#include <algorithm>
+
 namespace thrill {
 namespace data {
 
@@ -32,6 +34,9 @@ StreamSink::StreamSink(StreamDataPtr stream, BlockPool& block_pool,
       stream_(std::move(stream)),
       connection_(connection),
       magic_(magic),
+      compression_(stream_->multiplexer_.compress_blocks_),
+      coalesce_limit_(stream_->multiplexer_.adaptive_block_size_
+                      ? std::max<size_t>(default_block_size / 4, 1) : 0),
       id_(stream_id),
       host_rank_(host_rank),
       peer_rank_(peer_rank),
@@ -198,6 +203,61 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
             std::move(block).MoveToBlock());
     }
 
+    if (coalesce_limit_ != 0) {
+        if (block.size() < coalesce_limit_) {
+            // collect small Blocks into one, which saves their headers and
+            // the partially filled ByteBlocks at the receiver.
+            if (coalesce_bytes_.valid() &&
+                coalesce_size_ + block.size() > coalesce_bytes_->size())
+                SendCoalesced(/* is_last_block */ false);
+
+            Coalesce(block);
+
+            if (is_last_block)
+                SendCoalesced(/* is_last_block */ true);
+            return;
+        }
+        // send the coalesced Blocks before the large one
+        SendCoalesced(/* is_last_block */ false);
+    }
+
+    SendPinnedBlock(std::move(block), is_last_block);
+}
+
+void StreamSink::Coalesce(const PinnedBlock& block) {
+    if (!coalesce_bytes_.valid()) {
+        coalesce_bytes_ = AllocateByteBlock(4 * coalesce_limit_);
+        coalesce_size_ = 0;
+        coalesce_num_items_ = 0;
+    }
+
+    if (coalesce_num_items_ == 0 && block.num_items() != 0) {
+        coalesce_first_item_ = coalesce_size_ + block.first_item_relative();
+    }
+
+    std::copy(block.data_begin(), block.data_end(),
+              coalesce_bytes_->begin() + coalesce_size_);
+
+    coalesce_size_ += block.size();
+    coalesce_num_items_ += block.num_items();
+    coalesce_typecode_verify_ = block.typecode_verify();
+}
+
+void StreamSink::SendCoalesced(bool is_last_block) {
+    if (!coalesce_bytes_.valid()) return;
+
+    // without any item start, the first item is beyond the end.
+    size_t first_item =
+        coalesce_num_items_ != 0 ? coalesce_first_item_ : coalesce_size_;
+
+    SendPinnedBlock(
+        PinnedBlock(std::move(coalesce_bytes_), 0, coalesce_size_,
+                    first_item, coalesce_num_items_,
+                    coalesce_typecode_verify_),
+        is_last_block);
+}
+
+void StreamSink::SendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
     LOG0 << "StreamSink::AppendPinnedBlock()"
          << " data=" << tlx::hexdump(block.ToString());
 
@@ -205,9 +265,33 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
     header.stream_id = id_;
     header.sender_worker = my_worker_rank();
     header.receiver_local_worker = peer_local_worker_;
-    header.seq = block_counter_ - 1;
+    header.seq = net_seq_++;
     header.is_last_block = is_last_block;
 
+    if (compression_.enabled()) {
+        // compress the Block's data into a new ByteBlock, which is sent
+        // instead if it is actually smaller.
+        PinnedByteBlockPtr bytes = stream_->multiplexer_.block_pool_
+                                   .AllocateByteBlock(
+            BlockCompressBound(block.size()), local_worker_id_);
+
+        size_t csize = BlockCompress(
+            block.data_begin(), block.size(),
+            bytes->begin(), bytes->size());
+        if (csize >= block.size()) csize = 0;
+
+        compression_.Record(block.size(), csize);
+
+        if (csize != 0) {
+            stream_->tx_net_compress_raw_bytes_ += block.size();
+            stream_->tx_net_compress_bytes_ += csize;
+
+            header.compressed_size = static_cast<uint32_t>(csize);
+            block = PinnedBlock(std::move(bytes), 0, csize, 0, 0,
+                                /* typecode_verify */ false);
+        }
+    }
+
     net::BufferBuilder bb;
     header.Serialize(bb);
 
@@ -217,19 +301,26 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
     size_t send_size = buffer.size() + block.size();
     // stream_->sem_queue_.wait(send_size);
 
+    // wait for the job's share of the dispatchers' queues, returned once the
+    // Block was written.
+    stream_->multiplexer_.AcquireJobSend(
+        Multiplexer::StreamJobId(id_), send_size);
+
     // StreamData statistics for network transfer
     stream_->tx_net_items_ += block.num_items();
     stream_->tx_net_bytes_ += send_size;
+    stream_->tx_net_bytes_per_host_[peer_rank_] += send_size;
     stream_->tx_net_blocks_++;
     byte_counter_ += buffer.size();
 
-    stream_->multiplexer_.dispatcher_.AsyncWrite(
-        *connection_, 42 + (connection_->tx_seq_.fetch_add(2) & 0xFFFF),
-        // send out Buffer and Block, guaranteed to be successive
-        std::move(buffer), std::move(block),
-        [s = stream_, send_size](net::Connection&) {
-            s->sem_queue_.signal(send_size);
-        });
+    // send Blocks round-robin over the Multiplexer's lanes, the receiver
+    // reorders them by sequence number. With flow control, the StreamData may
+    // hold them until the receiver returns credits.
+    size_t lane =
+        (header.seq + peer_local_worker_) % stream_->multiplexer_.num_lanes();
+
+    stream_->SendRemoteBlock(
+        peer_worker_rank(), lane, std::move(buffer), std::move(block));
 
     if (is_last_block) {
         assert(!closed_);
@@ -242,7 +333,7 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
             << " to=" << peer_worker_rank()
             << " (host=" << peer_rank_ << ")";
 
-        stream_->OnWriterClosed(peer_worker_rank(), /* sent */ true);
+        stream_->OnRemoteWriterClosed(peer_worker_rank(), /* sent */ true);
 
         Finalize();
     }
@@ -250,6 +341,9 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
 
 void StreamSink::Close() {
     if (closed_) return;
+
+    // send the coalesced Blocks before the close
+    SendCoalesced(/* is_last_block */ false);
     closed_ = true;
 
     LOG << "StreamSink::Close() sending 'close stream' id=" << id_
@@ -274,7 +368,7 @@ void StreamSink::Close() {
             my_worker_rank(), block_counter_ - 1, Block());
     }
 
-    stream_->OnWriterClosed(peer_worker_rank(), /* sent */ false);
+    stream_->OnRemoteWriterClosed(peer_worker_rank(), /* sent */ false);
 
     Finalize();
 }
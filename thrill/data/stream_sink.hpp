@@ -16,6 +16,7 @@
 #include <thrill/common/stats_counter.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/data/block.hpp>
+#include <thrill/data/block_compression.hpp>
 #include <thrill/data/block_sink.hpp>
 #include <thrill/data/stream_data.hpp>
 #include <thrill/net/buffer.hpp>
@@ -34,6 +35,12 @@ using StreamDataPtr = tlx::CountingPtr<StreamData>;
 /*!
  * StreamSink is an BlockSink that sends data via a network socket to the
  * StreamData object on a different worker.
+ *
+ * For workers on the same host, the StreamSink instead hands the Blocks over
+ * by reference into the loopback BlockQueue or MixBlockQueue of the target
+ * worker. The ByteBlock is shared and its data is never copied; the receiving
+ * BlockReader pins and reads it in place. These transfers are counted in
+ * StreamData::tx_int_items_, tx_int_bytes_, and tx_int_blocks_.
  */
 class StreamSink final : public BlockSink
 {
@@ -111,6 +118,34 @@ private:
     net::Connection* connection_ = nullptr;
     MagicByte magic_ = MagicByte::Invalid;
 
+    //! adaptive switch whether to compress Blocks sent to the network
+    BlockCompressionSwitch compression_;
+
+    //! Blocks smaller than this are coalesced before sending, zero disables
+    //! coalescing.
+    size_t coalesce_limit_ = 0;
+
+    //! ByteBlock collecting small Blocks, and its used size
+    PinnedByteBlockPtr coalesce_bytes_;
+    size_t coalesce_size_ = 0;
+
+    //! first item offset, item count, and typecode flag of coalesced Blocks
+    size_t coalesce_first_item_ = 0;
+    size_t coalesce_num_items_ = 0;
+    bool coalesce_typecode_verify_ = false;
+
+    //! sequence number of the next Block sent to the network
+    uint32_t net_seq_ = 0;
+
+    //! copy a small Block to the end of the coalesced ones
+    void Coalesce(const PinnedBlock& block);
+
+    //! send the coalesced Blocks, if any.
+    void SendCoalesced(bool is_last_block);
+
+    //! send a Block to the network, and handle a piggy-backed close.
+    void SendPinnedBlock(PinnedBlock&& block, bool is_last_block);
+
     //! \}
 
     //! \name StreamSink To BlockQueue (CatStream Loopback)
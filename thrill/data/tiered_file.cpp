@@ -0,0 +1,154 @@
+/*******************************************************************************
+ * thrill/data/tiered_file.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/tiered_file.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/data/block_compression.hpp>
+
+#include <tlx/die.hpp>
+#include <tlx/vector_free.hpp>
+
+#include <cstring>
+#include <utility>
+
+namespace thrill {
+namespace data {
+
+static constexpr bool debug = false;
+
+//! keep warm Blocks only if they shrink to this fraction of their raw size
+static constexpr double warm_max_ratio = 0.9;
+
+TieredFile::TieredFile(File&& file, size_t dia_id,
+                       size_t hot_bytes, size_t warm_bytes)
+    : block_pool_(*file.block_pool()),
+      local_worker_id_(file.local_worker_id()),
+      dia_id_(dia_id),
+      num_items_(file.num_items()),
+      reclaim_(block_pool_) {
+
+    bool compress = BlockCompressionAvailable();
+    size_t hot_size = 0, warm_size = 0;
+
+    entries_.reserve(file.num_blocks());
+    for (const Block& b : file.blocks()) {
+        Entry e;
+        e.tier = Tier::Cold;
+        e.raw_size = b.size();
+        e.first_item = b.first_item_relative();
+        e.num_items = b.num_items();
+        e.typecode_verify = b.typecode_verify();
+
+        if (hot_size + b.size() <= hot_bytes) {
+            e.tier = Tier::Hot;
+            e.pinned = b.PinWait(local_worker_id_);
+            e.block = b;
+            hot_size += b.size();
+        }
+        else if (compress && warm_size + b.size() <= warm_bytes &&
+                 Compress(b, &e)) {
+            e.tier = Tier::Warm;
+            warm_size += b.size();
+            stats_.warm_raw_bytes += b.size();
+            stats_.warm_compressed_bytes += e.block.size();
+        }
+        else {
+            e.block = b;
+        }
+        entries_.emplace_back(std::move(e));
+    }
+    file.Clear();
+
+    LOG << "TieredFile() blocks=" << entries_.size()
+        << " hot_size=" << hot_size << " warm_size=" << warm_size
+        << " warm_compressed=" << stats_.warm_compressed_bytes;
+}
+
+bool TieredFile::Compress(const Block& block, Entry* entry) {
+    PinnedBlock pb = block.PinWait(local_worker_id_);
+
+    std::vector<uint8_t> buffer(BlockCompressBound(pb.size()));
+    size_t csize = BlockCompress(
+        pb.data_begin(), pb.size(), buffer.data(), buffer.size());
+
+    if (csize == 0 || csize >= warm_max_ratio * pb.size())
+        return false;
+
+    PinnedByteBlockPtr bytes =
+        block_pool_.AllocateByteBlock(csize, local_worker_id_);
+    std::memcpy(bytes->data(), buffer.data(), csize);
+    bytes->set_dia_id(dia_id_);
+
+    // the compressed Block carries no items, they are described by the Entry.
+    entry->block = PinnedBlock(
+        std::move(bytes), 0, csize, 0, 0, false).MoveToBlock();
+    return true;
+}
+
+Block TieredFile::Decompress(const Entry& entry) {
+    PinnedBlock pb = entry.block.PinWait(local_worker_id_);
+
+    PinnedByteBlockPtr bytes =
+        block_pool_.AllocateByteBlock(entry.raw_size, local_worker_id_);
+    die_unless(BlockDecompress(pb.data_begin(), pb.size(),
+                               bytes->data(), entry.raw_size));
+
+    return PinnedBlock(
+        std::move(bytes), 0, entry.raw_size, entry.first_item,
+        entry.num_items, entry.typecode_verify).MoveToBlock();
+}
+
+void TieredFile::DemoteHot() {
+    size_t demoted = 0;
+    for (Entry& e : entries_) {
+        if (e.tier != Tier::Hot) continue;
+        e.pinned.Reset();
+        e.tier = Tier::Cold;
+        ++demoted;
+    }
+    LOG << "TieredFile::DemoteHot() demoted=" << demoted;
+}
+
+File TieredFile::Assemble() {
+    if (reclaim_.test_and_clear())
+        DemoteHot();
+
+    stats_.reads++;
+    stats_.hot_blocks = stats_.warm_blocks = 0;
+    stats_.cold_blocks = stats_.cold_in_memory = 0;
+
+    File file(block_pool_, local_worker_id_, dia_id_);
+    for (const Entry& e : entries_) {
+        if (e.tier == Tier::Hot) {
+            stats_.hot_blocks++;
+            file.AppendBlock(e.block);
+        }
+        else if (e.tier == Tier::Warm) {
+            stats_.warm_blocks++;
+            file.AppendBlock(Decompress(e));
+        }
+        else {
+            stats_.cold_blocks++;
+            if (e.block.byte_block()->in_memory())
+                stats_.cold_in_memory++;
+            file.AppendBlock(e.block);
+        }
+    }
+    return file;
+}
+
+void TieredFile::Clear() {
+    tlx::vector_free(entries_);
+    num_items_ = 0;
+}
+
+} // namespace data
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * thrill/data/tiered_file.hpp
+ *
+ * Storage of a File in pinned, compressed, and spillable tiers.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_TIERED_FILE_HEADER
+#define THRILL_DATA_TIERED_FILE_HEADER
+
+#include <thrill/data/block.hpp>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/file.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * Stores the Blocks of a File which is read repeatedly, like a cached DIA in
+ * iterative algorithms, in three tiers:
+ *
+ * - hot: the first Blocks, up to hot_bytes, remain pinned in RAM.
+ *
+ * - warm: the following Blocks, up to warm_bytes of raw data, are compressed
+ *   into smaller ByteBlocks, which are decompressed on each read.
+ *
+ * - cold: the remaining Blocks are left to the BlockPool's eviction and are
+ *   read back with read-ahead.
+ *
+ * If the BlockPool runs out of unpinned Blocks to evict, it invokes the
+ * reclaim callback, and the hot Blocks are unpinned on the next read.
+ */
+class TieredFile
+{
+public:
+    //! statistics of the last Assemble()
+    struct Stats {
+        //! number of Assemble() calls so far
+        size_t reads = 0;
+        //! Blocks in each tier
+        size_t hot_blocks = 0, warm_blocks = 0, cold_blocks = 0;
+        //! cold Blocks found in RAM
+        size_t cold_in_memory = 0;
+        //! raw and compressed size of the warm tier
+        size_t warm_raw_bytes = 0, warm_compressed_bytes = 0;
+
+        //! fraction of Blocks read without swapping in
+        double hit_rate() const {
+            size_t total = hot_blocks + warm_blocks + cold_blocks;
+            if (total == 0) return 1.0;
+            return static_cast<double>(
+                hot_blocks + warm_blocks + cold_in_memory) / total;
+        }
+    };
+
+    //! take the Blocks of file and sort them into tiers
+    TieredFile(File&& file, size_t dia_id,
+               size_t hot_bytes, size_t warm_bytes);
+
+    //! non-copyable: delete copy-constructor
+    TieredFile(const TieredFile&) = delete;
+    //! non-copyable: delete assignment operator
+    TieredFile& operator = (const TieredFile&) = delete;
+
+    //! Return a File of all items: the hot and cold Blocks by reference and
+    //! the warm Blocks decompressed. Its Reader prefetches the cold Blocks.
+    File Assemble();
+
+    //! number of items stored
+    size_t num_items() const { return num_items_; }
+
+    //! statistics of the last Assemble()
+    const Stats& stats() const { return stats_; }
+
+    //! release all Blocks
+    void Clear();
+
+private:
+    enum class Tier { Hot, Warm, Cold };
+
+    //! a Block in a tier
+    struct Entry {
+        Tier        tier;
+        //! the Block, for warm Blocks that of the compressed data
+        Block       block;
+        //! pin of hot Blocks
+        PinnedBlock pinned;
+        //! raw size, first item, number of items, and typecode flag of the
+        //! uncompressed warm Block
+        size_t      raw_size;
+        size_t      first_item;
+        size_t      num_items;
+        bool        typecode_verify;
+    };
+
+    BlockPool& block_pool_;
+    size_t local_worker_id_;
+    size_t dia_id_;
+
+    std::vector<Entry> entries_;
+    size_t num_items_ = 0;
+
+    //! raised when the BlockPool asks to free memory
+    ReclaimFlag reclaim_;
+
+    Stats stats_;
+
+    //! compress the Block into a warm Entry, returns false if it does not
+    //! shrink.
+    bool Compress(const Block& block, Entry* entry);
+
+    //! unpin the hot Blocks, they become cold
+    void DemoteHot();
+
+    //! decompress a warm Entry into a new Block
+    Block Decompress(const Entry& entry);
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_TIERED_FILE_HEADER
+
+/******************************************************************************/
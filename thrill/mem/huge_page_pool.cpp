@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * thrill/mem/huge_page_pool.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/mem/huge_page_pool.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/porting.hpp>
+
+#include <tlx/die.hpp>
+#include <tlx/unused.hpp>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+
+namespace thrill {
+namespace mem {
+
+HugePagePool::HugePagePool(
+    Manager& manager, size_t chunk_size, size_t slab_size, size_t numa_node)
+    : manager_(manager), chunk_size_(chunk_size), numa_node_(numa_node) {
+    die_unless(chunk_size_ > 0);
+    // round slab up to multiple of the huge page size and to whole chunks.
+    slab_size = std::max(slab_size, chunk_size_);
+    slab_size = (slab_size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    chunks_per_slab_ = slab_size / chunk_size_;
+}
+
+HugePagePool::~HugePagePool() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& s : slabs_) {
+        if (s.second.free.size() != chunks_per_slab_)
+            LOG1 << "~HugePagePool() slab still contains used chunks";
+        UnmapSlab(s.second);
+    }
+}
+
+bool HugePagePool::MapSlab() {
+#if defined(__linux__)
+    size_t size = chunks_per_slab_ * chunk_size_;
+    size = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+
+    Slab slab;
+
+#if defined(MAP_HUGETLB)
+    // try to take preallocated pages from hugetlbfs
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        slab.map_base = slab.base = static_cast<char*>(ptr);
+        slab.map_size = size;
+        slab.hugetlb = true;
+    }
+    else
+#endif
+    {
+        // map additional space to align the slab to huge pages
+        size_t map_size = size + kHugePageSize;
+        void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) {
+            LOG1 << "HugePagePool: mmap() of slab failed";
+            return false;
+        }
+
+        uintptr_t begin = reinterpret_cast<uintptr_t>(map);
+        uintptr_t aligned =
+            (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+
+        slab.map_base = static_cast<char*>(map);
+        slab.map_size = map_size;
+        slab.base = reinterpret_cast<char*>(aligned);
+        slab.hugetlb = false;
+
+#if defined(MADV_HUGEPAGE)
+        if (madvise(slab.base, size, MADV_HUGEPAGE) != 0)
+            LOG << "HugePagePool: madvise(MADV_HUGEPAGE) failed";
+#endif
+    }
+
+    // set the memory policy before the pages are first touched
+    if (numa_node_ != kAnyNumaNode &&
+        !common::BindMemoryToNumaNode(slab.base, size, numa_node_))
+        LOG << "HugePagePool: could not bind slab to NUMA node " << numa_node_;
+
+    LOG << "HugePagePool: mapped slab " << static_cast<void*>(slab.base)
+        << " size " << size << " hugetlb " << slab.hugetlb;
+
+    // chunks are handed out from low to high addresses
+    slab.free.reserve(chunks_per_slab_);
+    for (size_t i = chunks_per_slab_; i != 0; --i)
+        slab.free.push_back(static_cast<uint32_t>(i - 1));
+    free_chunks_ += chunks_per_slab_;
+
+    uintptr_t key = reinterpret_cast<uintptr_t>(slab.base);
+    slabs_.emplace(key, std::move(slab));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HugePagePool::UnmapSlab(Slab& slab) {
+#if defined(__linux__)
+    munmap(slab.map_base, slab.map_size);
+#else
+    tlx::unused(slab);
+#endif
+}
+
+void* HugePagePool::allocate() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (free_chunks_ == 0 && !MapSlab())
+        return nullptr;
+
+    // take from the lowest slab with free chunks, such that higher ones may
+    // become empty and be unmapped.
+    for (auto& s : slabs_) {
+        Slab& slab = s.second;
+        if (slab.free.empty()) continue;
+
+        uint32_t index = slab.free.back();
+        slab.free.pop_back();
+        --free_chunks_;
+
+        manager_.add(chunk_size_);
+        return slab.base + index * chunk_size_;
+    }
+
+    die("HugePagePool: no free chunk found");
+}
+
+bool HugePagePool::deallocate(void* ptr) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+
+    // find slab with largest base <= ptr
+    auto it = slabs_.upper_bound(p);
+    if (it == slabs_.begin()) return false;
+    --it;
+
+    Slab& slab = it->second;
+    size_t offset = p - it->first;
+    if (offset >= chunks_per_slab_ * chunk_size_) return false;
+
+    die_unless(offset % chunk_size_ == 0);
+    slab.free.push_back(static_cast<uint32_t>(offset / chunk_size_));
+    ++free_chunks_;
+
+    manager_.subtract(chunk_size_);
+
+    // unmap empty slabs, but keep one spare slab of free chunks.
+    if (slab.free.size() == chunks_per_slab_ &&
+        free_chunks_ >= 2 * chunks_per_slab_)
+    {
+        LOG << "HugePagePool: unmapping slab " << static_cast<void*>(slab.base);
+        free_chunks_ -= chunks_per_slab_;
+        UnmapSlab(slab);
+        slabs_.erase(it);
+    }
+
+    return true;
+}
+
+size_t HugePagePool::num_slabs() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return slabs_.size();
+}
+
+size_t HugePagePool::num_hugetlb_slabs() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& s : slabs_)
+        count += s.second.hugetlb;
+    return count;
+}
+
+} // namespace mem
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * thrill/mem/huge_page_pool.hpp
+ *
+ * Pool of equally sized chunks carved out of large huge page backed slabs.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_MEM_HUGE_PAGE_POOL_HEADER
+#define THRILL_MEM_HUGE_PAGE_POOL_HEADER
+
+#include <thrill/mem/manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace thrill {
+namespace mem {
+
+/*!
+ * A pool of equally sized chunks, which are carved out of large slabs mapped
+ * with huge pages. Each slab is first mapped with MAP_HUGETLB from the
+ * preallocated hugetlbfs pages, and if none are available, mapped normally and
+ * marked for transparent huge pages via madvise(MADV_HUGEPAGE).
+ *
+ * Chunks remain resident while their slab is in use, slabs with no used chunks
+ * are unmapped except for one spare. Each used chunk is accounted to the
+ * Manager just like an allocation of its size.
+ */
+class HugePagePool
+{
+    static constexpr bool debug = false;
+
+public:
+    //! size of huge pages on x86_64, to which slabs are aligned
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    //! value of numa_node for slabs without a NUMA memory policy
+    static constexpr size_t kAnyNumaNode = size_t(-1);
+
+    //! construct pool of chunk_size chunks in slabs of at least slab_size. If
+    //! numa_node is given, slabs are bound to that NUMA node before use.
+    HugePagePool(Manager& manager, size_t chunk_size,
+                 size_t slab_size = 64 * 1024 * 1024,
+                 size_t numa_node = kAnyNumaNode);
+
+    //! non-copyable: delete copy-constructor
+    HugePagePool(const HugePagePool&) = delete;
+    //! non-copyable: delete assignment operator
+    HugePagePool& operator = (const HugePagePool&) = delete;
+
+    //! unmap all slabs
+    ~HugePagePool();
+
+    //! size of the chunks
+    size_t chunk_size() const { return chunk_size_; }
+
+    //! allocate a chunk, returns nullptr if no slab can be mapped.
+    void * allocate();
+
+    //! deallocate a chunk, returns false if ptr is not from this pool.
+    bool deallocate(void* ptr);
+
+    //! number of slabs mapped
+    size_t num_slabs() const;
+
+    //! number of slabs mapped with MAP_HUGETLB
+    size_t num_hugetlb_slabs() const;
+
+private:
+    //! a large mapped memory area containing chunks
+    struct Slab {
+        //! begin of the area
+        char* base;
+        //! size and begin of the mapped area for munmap()
+        size_t map_size;
+        char * map_base;
+        //! whether the slab was mapped with MAP_HUGETLB
+        bool hugetlb;
+        //! indexes of free chunks
+        std::vector<uint32_t> free;
+    };
+
+    //! memory manager to account chunks to
+    Manager& manager_;
+
+    //! size of each chunk
+    size_t chunk_size_;
+
+    //! number of chunks per slab
+    size_t chunks_per_slab_;
+
+    //! NUMA node to bind slabs to, or kAnyNumaNode
+    size_t numa_node_;
+
+    //! mutex protecting slabs_
+    mutable std::mutex mutex_;
+
+    //! slabs ordered by base address
+    std::map<uintptr_t, Slab> slabs_;
+
+    //! total number of free chunks in all slabs
+    size_t free_chunks_ = 0;
+
+    //! map a new slab, returns false on failure.
+    bool MapSlab();
+
+    //! unmap the slab
+    static void UnmapSlab(Slab& slab);
+};
+
+} // namespace mem
+} // namespace thrill
+
+#endif // !THRILL_MEM_HUGE_PAGE_POOL_HEADER
+
+/******************************************************************************/
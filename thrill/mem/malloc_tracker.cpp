@@ -18,6 +18,7 @@
 #include <thrill/mem/malloc_tracker.hpp>
 #include <tlx/backtrace.hpp>
 #include <tlx/define.hpp>
+#include <tlx/unused.hpp>
 
 #if __linux__ || __APPLE__ || __FreeBSD__
 
@@ -25,15 +26,23 @@
 
 #endif
 
+#if __linux__ || __FreeBSD__
+
+#include <execinfo.h>
+
+#endif
+
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #if defined(__clang__) || defined(__GNUC__)
 
@@ -141,6 +150,16 @@ static inline ssize_t sync_sub_and_fetch(CounterType& curr, ssize_t dec) {
 #endif
 }
 
+ATTRIBUTE_NO_SANITIZE
+static inline bool sync_compare_and_swap(
+    CounterType& curr, ssize_t expected, ssize_t desired) {
+#if defined(_MSC_VER) || USE_ATOMICS
+    return curr.compare_exchange_strong(expected, desired);
+#else
+    return __sync_bool_compare_and_swap(&curr, expected, desired);
+#endif
+}
+
 //! a simple memory heap for allocations prior to dlsym loading
 #define INIT_HEAP_SIZE 1024 * 1024
 static char init_heap[INIT_HEAP_SIZE];
@@ -188,9 +207,159 @@ struct LocalStats {
 #define HAVE_THREAD_LOCAL 0
 #endif
 
+#if defined(__GNUC__) && !defined(__APPLE__)
+//! the initial-exec TLS model avoids a call to __tls_get_addr() on each access
+#define ATTRIBUTE_TLS_INITIAL_EXEC \
+    __attribute__ ((tls_model("initial-exec"))) /* NOLINT */
+#else
+#define ATTRIBUTE_TLS_INITIAL_EXEC
+#endif
+
 #if HAVE_THREAD_LOCAL
-static thread_local LocalStats tl_stats = { 0, 0, 0 };
-static const ssize_t tl_delay_threshold = 1024 * 1024;
+//! thread-local statistics, which are folded into the global counters once the
+//! thread's allocated bytes diverge by more than tl_delay_threshold from them.
+static thread_local LocalStats tl_stats ATTRIBUTE_TLS_INITIAL_EXEC = { 0, 0, 0 };
+#endif
+
+//! number of bytes each thread's statistics may diverge from the global ones,
+//! which is also the per-thread error of memory_exceeded.
+static ssize_t tl_delay_threshold = 1024 * 1024;
+
+//! bounds of tl_delay_threshold when derived from the memory limit
+static constexpr ssize_t tl_delay_threshold_min = 64 * 1024;
+static constexpr ssize_t tl_delay_threshold_max = 16 * 1024 * 1024;
+
+/******************************************************************************/
+// Attribution of allocations to DIA nodes
+
+#if HAVE_THREAD_LOCAL
+//! DIA node executed by the thread, set by AllocationScope
+static thread_local size_t tl_dia_id ATTRIBUTE_TLS_INITIAL_EXEC = 0;
+static thread_local const char* tl_dia_label ATTRIBUTE_TLS_INITIAL_EXEC = nullptr;
+#endif
+
+//! net allocation counters of a DIA node, updated when the thread-local
+//! statistics are folded into the global ones.
+struct DiaSlot {
+    CounterType dia_id;
+    CounterType current;
+    CounterType peak;
+    CounterType allocs;
+};
+
+//! slots of DIA nodes, slot 0 holds dia_id 0 and all nodes without a free slot
+static constexpr size_t kDiaSlots = 1024;
+static DiaSlot s_dia_slots[kDiaSlots];
+
+//! find or claim the slot of a DIA node
+ATTRIBUTE_NO_SANITIZE
+static DiaSlot& dia_slot(size_t dia_id) {
+    ssize_t id = static_cast<ssize_t>(dia_id);
+    if (id == 0) return s_dia_slots[0];
+
+    // linear probing in slots 1..kDiaSlots-1
+    for (size_t i = 0; i < 16; ++i) {
+        DiaSlot& slot = s_dia_slots[1 + (dia_id + i) % (kDiaSlots - 1)];
+        if (get(slot.dia_id) == id) return slot;
+        if (get(slot.dia_id) == 0 &&
+            (sync_compare_and_swap(slot.dia_id, 0, id) ||
+             get(slot.dia_id) == id))
+            return slot;
+    }
+    return s_dia_slots[0];
+}
+
+/******************************************************************************/
+// Sampling of allocation call stacks
+
+#if HAVE_THREAD_LOCAL && (__linux__ || __FreeBSD__)
+#define HAVE_MALLOC_SAMPLING 1
+#else
+#define HAVE_MALLOC_SAMPLING 0
+#endif
+
+#if HAVE_MALLOC_SAMPLING
+
+//! number of bytes allocated by a thread between two samples, 0 = off.
+static ssize_t s_sample_interval = 0;
+
+//! bytes until the thread's next sample
+static thread_local ssize_t tl_sample_countdown ATTRIBUTE_TLS_INITIAL_EXEC = 0;
+
+//! set while the thread takes a sample, since backtrace() may allocate.
+static thread_local bool tl_in_sample ATTRIBUTE_TLS_INITIAL_EXEC = false;
+
+//! maximum number of frames captured per sample
+static constexpr size_t kSampleFrames = 32;
+
+//! number of distinct stacks kept, samples of further stacks are dropped
+static constexpr size_t kSampleSlots = 4096;
+
+//! maximum probes in the hash table of stacks
+static constexpr size_t kSampleProbes = 64;
+
+struct SampleSlot {
+    const char* label;
+    size_t      dia_id;
+    size_t      depth;
+    //! sampled bytes, 0 = empty slot
+    size_t      bytes;
+    void        * frames[kSampleFrames];
+};
+
+//! hash table of distinct stacks, protected by s_sample_lock
+static SampleSlot s_samples[kSampleSlots];
+static std::atomic_flag s_sample_lock = ATOMIC_FLAG_INIT;
+static size_t s_samples_dropped = 0;
+
+//! capture the stack of the calling thread, which crossed its sample interval.
+ATTRIBUTE_NO_SANITIZE __attribute__ ((noinline))
+static void sample_allocation() {
+    if (tl_in_sample) return;
+    tl_in_sample = true;
+
+    // one sample per interval crossed, such that large allocations weigh more
+    ssize_t interval = s_sample_interval;
+    ssize_t n = 1 + (-tl_sample_countdown) / interval;
+    tl_sample_countdown += n * interval;
+    size_t bytes = static_cast<size_t>(n * interval);
+
+    void* frames[kSampleFrames];
+    // skip the frame of sample_allocation()
+    size_t depth = std::max(backtrace(frames, kSampleFrames), 1) - 1;
+
+    size_t h = tl_dia_id;
+    for (size_t i = 0; i < depth; ++i)
+        h = h * 0x9E3779B97F4A7C15ull
+            + reinterpret_cast<uintptr_t>(frames[i + 1]);
+
+    while (s_sample_lock.test_and_set(std::memory_order_acquire)) { }
+
+    size_t p;
+    for (p = 0; p < kSampleProbes; ++p) {
+        SampleSlot& slot = s_samples[(h + p) % kSampleSlots];
+        if (slot.bytes == 0) {
+            slot.label = tl_dia_label;
+            slot.dia_id = tl_dia_id;
+            slot.depth = depth;
+            slot.bytes = bytes;
+            std::copy(frames + 1, frames + 1 + depth, slot.frames);
+            break;
+        }
+        if (slot.dia_id == tl_dia_id && slot.label == tl_dia_label &&
+            slot.depth == depth &&
+            std::equal(frames + 1, frames + 1 + depth, slot.frames)) {
+            slot.bytes += bytes;
+            break;
+        }
+    }
+    if (p == kSampleProbes) s_samples_dropped++;
+
+    s_sample_lock.clear(std::memory_order_release);
+
+    tl_in_sample = false;
+}
+
 #endif
 
 ATTRIBUTE_NO_SANITIZE
@@ -205,6 +374,12 @@ void flush_memory_statistics() {
     // no-operation of no thread_local is available.
     ssize_t mycurr = sync_add_and_fetch(float_curr, tl_stats.bytes);
 
+    DiaSlot& slot = dia_slot(tl_dia_id);
+    ssize_t dia_curr = sync_add_and_fetch(slot.current, tl_stats.bytes);
+    if (dia_curr > get(slot.peak))
+        slot.peak = dia_curr;
+    sync_add_and_fetch(slot.allocs, tl_stats.total_allocs);
+
     sync_add_and_fetch(total_bytes, tl_stats.bytes);
     sync_add_and_fetch(total_allocs, tl_stats.total_allocs);
     sync_add_and_fetch(current_allocs, tl_stats.current_allocs);
@@ -229,6 +404,14 @@ static void inc_count(size_t inc) {
 
     if (tl_stats.bytes > tl_delay_threshold)
         flush_memory_statistics();
+
+#if HAVE_MALLOC_SAMPLING
+    if (TLX_UNLIKELY(s_sample_interval != 0)) {
+        tl_sample_countdown -= inc;
+        if (tl_sample_countdown <= 0)
+            sample_allocation();
+    }
+#endif
 #else
     // no thread_local data structure -> update immediately (more contention)
     ssize_t mycurr = sync_add_and_fetch(float_curr, inc);
@@ -292,6 +475,92 @@ void malloc_tracker_print_status() {
 void set_memory_limit_indication(ssize_t size) {
     // fprintf(stderr, PPREFIX "set_memory_limit_indication %zu\n", size);
     memory_limit_indication = size;
+
+    // let each thread's statistics diverge by about 1/1024 of the limit, such
+    // that even many threads cause only a small error of memory_exceeded.
+    tl_delay_threshold = std::min(
+        std::max(size / 1024, tl_delay_threshold_min), tl_delay_threshold_max);
+
+    memory_exceeded = (get(float_curr) >= memory_limit_indication);
+}
+
+void set_memory_statistics_threshold(ssize_t size) {
+    tl_delay_threshold = size;
+}
+
+AllocationScope::AllocationScope(size_t dia_id, const char* label) {
+#if HAVE_THREAD_LOCAL
+    // fold the thread's statistics into those of the previous node
+    flush_memory_statistics();
+    prev_dia_id_ = tl_dia_id;
+    prev_label_ = tl_dia_label;
+    tl_dia_id = dia_id;
+    tl_dia_label = label;
+#else
+    tlx::unused(dia_id, label);
+    prev_dia_id_ = 0;
+    prev_label_ = nullptr;
+#endif
+}
+
+AllocationScope::~AllocationScope() {
+#if HAVE_THREAD_LOCAL
+    flush_memory_statistics();
+    tl_dia_id = prev_dia_id_;
+    tl_dia_label = prev_label_;
+#endif
+}
+
+std::vector<DiaAllocation> malloc_tracker_dia_allocations() {
+    std::vector<DiaAllocation> result;
+    for (size_t i = 0; i < kDiaSlots; ++i) {
+        const DiaSlot& slot = s_dia_slots[i];
+        if (i != 0 && get(slot.dia_id) == 0) continue;
+        result.emplace_back(DiaAllocation {
+                                static_cast<size_t>(get(slot.dia_id)),
+                                get(slot.current), get(slot.peak),
+                                static_cast<size_t>(get(slot.allocs))
+                            });
+    }
+    std::sort(result.begin(), result.end(),
+              [](const DiaAllocation& a, const DiaAllocation& b) {
+                  return a.dia_id < b.dia_id;
+              });
+    return result;
+}
+
+void malloc_tracker_start_sampling(size_t interval) {
+#if HAVE_MALLOC_SAMPLING
+    // backtrace() loads libgcc on its first call, do it outside of malloc().
+    void* warmup[4];
+    backtrace(warmup, 4);
+    s_sample_interval = static_cast<ssize_t>(interval);
+#else
+    tlx::unused(interval);
+#endif
+}
+
+void malloc_tracker_stop_sampling(const AllocationSampleCallback& cb) {
+#if HAVE_MALLOC_SAMPLING
+    s_sample_interval = 0;
+
+    // allocations by the callback are not sampled anymore.
+    while (s_sample_lock.test_and_set(std::memory_order_acquire)) { }
+    for (size_t i = 0; i < kSampleSlots; ++i) {
+        SampleSlot& slot = s_samples[i];
+        if (slot.bytes == 0) continue;
+        cb(slot.label, slot.dia_id, slot.frames, slot.depth, slot.bytes);
+        slot.bytes = 0;
+    }
+    if (s_samples_dropped) {
+        fprintf(stderr, PPREFIX "dropped %zu allocation samples\n",
+                s_samples_dropped);
+        s_samples_dropped = 0;
+    }
+    s_sample_lock.clear(std::memory_order_release);
+#else
+    tlx::unused(cb);
+#endif
 }
 
 /******************************************************************************/
@@ -378,6 +647,21 @@ void MemoryProfiler::RunTask(const std::chrono::steady_clock::time_point&) {
         << "high" << copy_base.high
         << "low" << copy_base.low
         << "close" << copy_base.close;
+
+    // net allocations of DIA nodes, if any were tagged
+    std::vector<DiaAllocation> dia = malloc_tracker_dia_allocations();
+    if (dia.size() > 1) {
+        std::vector<size_t> dia_ids;
+        std::vector<ssize_t> dia_current, dia_peak;
+        for (const DiaAllocation& d : dia) {
+            dia_ids.push_back(d.dia_id);
+            dia_current.push_back(d.current);
+            dia_peak.push_back(d.peak);
+        }
+        line << "dia_ids" << dia_ids
+             << "dia_current" << dia_current
+             << "dia_peak" << dia_peak;
+    }
 }
 
 void StartMemProfiler(common::ProfileThread& sched, common::JsonLogger& logger) {
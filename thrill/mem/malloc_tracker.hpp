@@ -13,6 +13,8 @@
 #define THRILL_MEM_MALLOC_TRACKER_HEADER
 
 #include <cstdlib>
+#include <functional>
+#include <vector>
 
 #if defined(_MSC_VER)
 // windows/msvc is a mess.
@@ -39,9 +41,15 @@ extern bool memory_exceeded;
 void flush_memory_statistics();
 
 //! set the malloc tracking system to set memory_exceeded when this limit is
-//! exceed. it does not actually limit allocation!
+//! exceed. it does not actually limit allocation! This also sets the threshold
+//! of thread-local statistics to about 1/1024 of the limit.
 void set_memory_limit_indication(ssize_t size);
 
+//! set the number of bytes by which the thread-local statistics may diverge
+//! before they are folded into the global counters. memory_exceeded has an
+//! error of at most this amount per thread.
+void set_memory_statistics_threshold(ssize_t size);
+
 //! bypass malloc tracker and access malloc() directly
 void * bypass_malloc(size_t size) noexcept;
 
@@ -75,6 +83,58 @@ void malloc_tracker_print_leaks();
 //! launch profiler task
 void StartMemProfiler(common::ProfileThread& sched, common::JsonLogger& logger);
 
+/*!
+ * Attributes the allocations and deallocations of the calling thread to a DIA
+ * node while the scope exists, set by the StageBuilder. The net bytes of each
+ * node are logged by the memory profiler. Memory allocated by one node and
+ * freed by another (or outside any node, dia_id 0) is subtracted there, hence
+ * the counters show which nodes hold memory while they run.
+ */
+class AllocationScope
+{
+public:
+    AllocationScope(size_t dia_id, const char* label);
+    ~AllocationScope();
+
+    //! non-copyable: delete copy-constructor
+    AllocationScope(const AllocationScope&) = delete;
+    //! non-copyable: delete assignment operator
+    AllocationScope& operator = (const AllocationScope&) = delete;
+
+private:
+    //! previous tag of the thread
+    size_t prev_dia_id_;
+    const char* prev_label_;
+};
+
+//! net allocation statistics of a DIA node
+struct DiaAllocation {
+    size_t  dia_id;
+    //! net bytes currently allocated, may be negative
+    ssize_t current;
+    //! maximum of current
+    ssize_t peak;
+    //! number of allocations
+    size_t  allocs;
+};
+
+//! returns the net allocations of all DIA nodes with tagged allocations, and
+//! of dia_id 0 for all others.
+std::vector<DiaAllocation> malloc_tracker_dia_allocations();
+
+//! start sampling the call stacks of allocations: each thread takes one sample
+//! per interval bytes allocated. Does nothing if not supported.
+void malloc_tracker_start_sampling(size_t interval);
+
+//! callback receiving a distinct sampled stack: DIA node label and dia_id,
+//! return addresses innermost first, and the sampled bytes.
+using AllocationSampleCallback = std::function<
+    void (const char* label, size_t dia_id,
+          void* const* frames, size_t depth, size_t bytes)>;
+
+//! stop sampling and deliver all samples to the callback
+void malloc_tracker_stop_sampling(const AllocationSampleCallback& cb);
+
 } // namespace mem
 } // namespace thrill
 
@@ -24,7 +24,7 @@ namespace mem {
 /******************************************************************************/
 
 Pool& GPool() {
-    static Pool* pool = new Pool();
+    static Pool* pool = new Pool(16384, /* thread_cache */ true);
     return *pool;
 }
 
@@ -402,11 +402,86 @@ static inline size_t bin_lower_bound(size_t bin) {
         return (size_t(1) << (bin - 1));
 }
 
+/******************************************************************************/
+// PoolThreadCache - per-thread magazines of free small object slots
+
+//! determine object size class for small allocations: 32, 64, 128, or 256.
+static inline size_t calc_object_class(size_t bytes) {
+    if (bytes <= 32) return 0;
+    if (bytes <= 64) return 1;
+    if (bytes <= 128) return 2;
+    return 3;
+}
+
+class PoolThreadCache
+{
+public:
+    //! number of object size classes
+    static constexpr size_t kClasses = 4;
+    //! maximum number of free slots cached per size class
+    static constexpr size_t kCapacity = 64;
+    //! number of slots moved between the cache and the Pool at once
+    static constexpr size_t kBatch = kCapacity / 2;
+
+    //! return the calling thread's cache if it may be used for pool. Each
+    //! thread caches slots of only the first thread-caching Pool it uses.
+    static PoolThreadCache * Get(Pool* pool) {
+        static thread_local PoolThreadCache s_cache;
+        if (s_cache.closed_) return nullptr;
+        if (s_cache.pool_ == nullptr) s_cache.pool_ = pool;
+        return s_cache.pool_ == pool ? &s_cache : nullptr;
+    }
+
+    //! return all cached slots to the Pool when the thread exits.
+    ~PoolThreadCache() {
+        Flush();
+        closed_ = true;
+    }
+
+    void * allocate(size_t cls) {
+        if (count_[cls] == 0) {
+            pool_->ObjectAllocateBatch(cls, slots_[cls], kBatch);
+            count_[cls] = kBatch;
+        }
+        return slots_[cls][--count_[cls]];
+    }
+
+    void deallocate(size_t cls, void* ptr) {
+        if (count_[cls] == kCapacity) {
+            count_[cls] -= kBatch;
+            pool_->ObjectDeallocateBatch(
+                cls, slots_[cls] + count_[cls], kBatch);
+        }
+        slots_[cls][count_[cls]++] = ptr;
+    }
+
+    //! return all cached slots to the Pool and release it.
+    void Flush() {
+        if (pool_ == nullptr) return;
+        for (size_t cls = 0; cls < kClasses; ++cls) {
+            pool_->ObjectDeallocateBatch(cls, slots_[cls], count_[cls]);
+            count_[cls] = 0;
+        }
+        pool_ = nullptr;
+    }
+
+private:
+    //! the Pool whose slots are cached
+    Pool* pool_ = nullptr;
+    //! set when the thread_local object was destroyed
+    bool closed_ = false;
+    //! number of cached slots per size class
+    size_t count_[kClasses] = { 0, 0, 0, 0 };
+    //! stacks of cached slots per size class
+    void* slots_[kClasses][kCapacity];
+};
+
 /******************************************************************************/
 // Pool
 
-Pool::Pool(size_t default_arena_size) noexcept
-    : default_arena_size_(default_arena_size) {
+Pool::Pool(size_t default_arena_size, bool thread_cache) noexcept
+    : default_arena_size_(default_arena_size),
+      thread_cache_(thread_cache && !debug_check_pairing) {
     std::unique_lock<std::mutex> lock(mutex_);
 
     for (size_t i = 0; i < num_bins + 1; ++i)
@@ -425,6 +500,12 @@ Pool::Pool(size_t default_arena_size) noexcept
 }
 
 Pool::~Pool() noexcept {
+    if (thread_cache_) {
+        // return the slots cached by the destroying thread
+        if (PoolThreadCache* tc = PoolThreadCache::Get(this))
+            tc->Flush();
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
     if (size_ != 0) {
         std::cout << "~Pool() pool still contains "
@@ -613,6 +694,28 @@ void Pool::IntDeallocateAll() {
     min_free_ = 0;
 }
 
+Pool::ObjectPool* Pool::object_pool(size_t cls) {
+    if (cls == 0) return object_32_;
+    if (cls == 1) return object_64_;
+    if (cls == 2) return object_128_;
+    return object_256_;
+}
+
+void Pool::ObjectAllocateBatch(size_t cls, void** ptrs, size_t n) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ObjectPool* op = object_pool(cls);
+    for (size_t i = 0; i < n; ++i)
+        ptrs[i] = op->allocate();
+}
+
+void Pool::ObjectDeallocateBatch(size_t cls, void* const* ptrs, size_t n) {
+    if (n == 0) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    ObjectPool* op = object_pool(cls);
+    for (size_t i = 0; i < n; ++i)
+        op->deallocate(ptrs[i]);
+}
+
 size_t Pool::max_size() const noexcept {
     return sizeof(Slot) * std::numeric_limits<uint32_t>::max();
 }
@@ -624,6 +727,11 @@ size_t Pool::bytes_per_arena(size_t arena_size) {
 void* Pool::allocate(size_t bytes) {
     // return malloc(bytes);
 
+    if (thread_cache_ && bytes <= 256) {
+        if (PoolThreadCache* tc = PoolThreadCache::Get(this))
+            return tc->allocate(calc_object_class(bytes));
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
 
     if (debug) {
@@ -702,6 +810,11 @@ void Pool::deallocate(void* ptr, size_t bytes) {
 
     if (ptr == nullptr) return;
 
+    if (thread_cache_ && bytes <= 256) {
+        if (PoolThreadCache* tc = PoolThreadCache::Get(this))
+            return tc->deallocate(calc_object_class(bytes), ptr);
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
     if (debug) {
         std::cout << "Pool::deallocate() ptr " << ptr
@@ -33,6 +33,8 @@
 namespace thrill {
 namespace mem {
 
+class PoolThreadCache;
+
 /******************************************************************************/
 // Pool - a simple memory allocation manager
 
@@ -70,6 +72,13 @@ namespace mem {
  * For faster allocation, Arenas are categorized into many bins. Bin k always
  * contains all Arenas with log_2(k) to log_2(k+1)-1 free space in them. On
  * allocation and deallocation, the Arenas are moved between bins.
+ *
+ * If constructed with thread_cache, small objects of up to 256 bytes are
+ * allocated from and deallocated into per-thread magazines of free slots,
+ * which are refilled and flushed in batches. Hence, most small allocations do
+ * not take the mutex. The slots cached by a thread are returned when it exits,
+ * hence such a Pool must outlive all threads using it except the one
+ * destroying it.
  */
 class Pool
 {
@@ -80,8 +89,10 @@ class Pool
     static constexpr size_t check_limit = 4 * 1024 * 1024;
 
 public:
-    //! construct with base allocator
-    explicit Pool(size_t default_arena_size = 16384) noexcept;
+    //! construct with base allocator, optionally with per-thread caches of
+    //! small object slots.
+    explicit Pool(size_t default_arena_size = 16384,
+                  bool thread_cache = false) noexcept;
 
     //! non-copyable: delete copy-constructor
     Pool(const Pool&) = delete;
@@ -139,6 +150,9 @@ private:
     //! pool of equally sized items
     class ObjectPool;
 
+    //! for access to the ObjectPools
+    friend class PoolThreadCache;
+
     //! mutex to protect data structures (remove this if you use it in another
     //! context than Thrill).
     std::mutex mutex_;
@@ -168,6 +182,9 @@ private:
     ObjectPool* object_128_;
     ObjectPool* object_256_;
 
+    //! whether small objects are cached in PoolThreadCache magazines
+    bool thread_cache_;
+
     //! array of allocations for checking
     std::vector<std::pair<void*, size_t> > allocs_;
 
@@ -182,6 +199,16 @@ private:
 
     //! deallocate all Arenas
     void IntDeallocateAll();
+
+    //! return ObjectPool of size class cls: 32, 64, 128, or 256 bytes.
+    ObjectPool * object_pool(size_t cls);
+
+    //! allocate n small objects of size class cls while holding the mutex once
+    void ObjectAllocateBatch(size_t cls, void** ptrs, size_t n);
+
+    //! deallocate n small objects of size class cls while holding the mutex
+    //! once
+    void ObjectDeallocateBatch(size_t cls, void* const* ptrs, size_t n);
 };
 
 //! singleton instance of global pool for I/O data structures
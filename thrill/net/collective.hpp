@@ -18,6 +18,7 @@
 #ifndef THRILL_NET_COLLECTIVE_HEADER
 #define THRILL_NET_COLLECTIVE_HEADER
 
+#include <thrill/common/component_combine.hpp>
 #include <thrill/common/functional.hpp>
 #include <thrill/net/group.hpp>
 #include <tlx/math/ffs.hpp>
@@ -25,7 +26,12 @@
 #include <tlx/math/is_power_of_two.hpp>
 #include <tlx/math/round_to_power_of_two.hpp>
 
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace thrill {
 namespace net {
@@ -149,6 +155,54 @@ void Group::PrefixSumHypercube(T& value, BinarySumOp sum_op) {
     sLOG << "PREFIX_SUM: host" << my_host_rank() << ": done";
 }
 
+/*!
+ * Calculate the component-wise prefix sums of large arrays of POD items. The
+ * hosts form a chain, through which the arrays are passed in segments of
+ * kCollectiveSegmentBytes: each host receives the prefix of a segment from its
+ * predecessor, combines it in place with its own items, and forwards the
+ * result while the next segment arrives. Hence each host sends and receives
+ * the array only once, instead of in each of the log(p) rounds of
+ * PrefixSumDoubling(), and std::plus of arithmetic items is combined with SIMD
+ * instructions by common::ComponentCombine().
+ *
+ * \param value The array of size items to be summed up
+ * \param size The number of items, which must be equal on all hosts
+ * \param op The operation combining two items
+ * \param initial Initial array of size items of the prefix sums
+ * \param inclusive Inclusive prefix sum if true (default)
+ */
+template <typename T, typename Operation>
+void Group::PrefixSumPipelined(T* value, size_t size, const Operation& op,
+                               const T* initial, bool inclusive) {
+    static constexpr bool debug = false;
+
+    const size_t my_rank = my_host_rank();
+    const size_t segment =
+        std::max<size_t>(1, kCollectiveSegmentBytes / sizeof(T));
+
+    sLOG << "PrefixSumPipelined: rank" << my_rank
+         << "size" << size << "segment" << segment;
+
+    // prefix of the segment of the hosts before this one
+    std::vector<T> prefix(std::min(segment, size));
+
+    for (size_t begin = 0; begin < size; begin += segment) {
+        size_t n = std::min(segment, size - begin);
+        if (my_rank == 0)
+            std::copy(initial + begin, initial + begin + n, prefix.begin());
+        else
+            connection(my_rank - 1).ReceiveN(prefix.data(), n);
+
+        // the values of hosts with lower ranks are the left operand
+        common::ComponentCombine(op, prefix.data(), value + begin, n);
+
+        if (my_rank + 1 < num_hosts())
+            connection(my_rank + 1).SendN(value + begin, n);
+        if (!inclusive)
+            std::copy(prefix.begin(), prefix.begin() + n, value + begin);
+    }
+}
+
 //! select prefixsum implementation (often due to total number of processors)
 template <typename T, typename BinarySumOp>
 void Group::PrefixSumSelect(T& value, BinarySumOp sum_op,
@@ -156,6 +210,39 @@ void Group::PrefixSumSelect(T& value, BinarySumOp sum_op,
     return PrefixSumDoubling(value, sum_op, initial, inclusive);
 }
 
+//! select prefixsum implementation for component-wise sums of std::vectors of
+//! POD items: large vectors are pipelined, if initial has their size.
+template <typename T, typename Operation>
+typename std::enable_if<
+    std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+Group::PrefixSumSelect(
+    std::vector<T>& value,
+    common::ComponentSum<std::vector<T>, Operation> sum_op,
+    const std::vector<T>& initial, bool inclusive) {
+    if (initial.size() == value.size() &&
+        UsePrefixSumPipelined(value.size() * sizeof(T)))
+        PrefixSumPipelined(value.data(), value.size(), sum_op.op(),
+                           initial.data(), inclusive);
+    else
+        PrefixSumDoubling(value, sum_op, initial, inclusive);
+}
+
+//! select prefixsum implementation for component-wise sums of std::arrays of
+//! POD items: large arrays are pipelined.
+template <typename T, size_t N, typename Operation>
+typename std::enable_if<
+    std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+Group::PrefixSumSelect(
+    std::array<T, N>& value,
+    common::ComponentSum<std::array<T, N>, Operation> sum_op,
+    const std::array<T, N>& initial, bool inclusive) {
+    if (UsePrefixSumPipelined(N * sizeof(T)))
+        PrefixSumPipelined(value.data(), N, sum_op.op(),
+                           initial.data(), inclusive);
+    else
+        PrefixSumDoubling(value, sum_op, initial, inclusive);
+}
+
 template <typename T, typename BinarySumOp>
 void Group::PrefixSum(T& value, BinarySumOp sum_op, const T& initial) {
     return PrefixSumSelect(value, sum_op, initial, true);
@@ -234,12 +321,82 @@ void Group::BroadcastBinomialTree(T& value, size_t origin) {
     }
 }
 
+/*!
+ * Broadcasts a std::vector of POD items from the worker "origin" to all the
+ * others. This is a pipelined binomial tree broadcast: first the number of
+ * items is sent down the tree, then the items are forwarded in segments of
+ * kCollectiveSegmentBytes, such that inner hosts pass on one segment to their
+ * successors while the next one arrives. Vectors smaller than a segment are
+ * sent as one message.
+ *
+ * \param value The vector to be broadcast / receive into.
+ *
+ * \param origin The PE to broadcast value from.
+ */
+template <typename T>
+void Group::BroadcastBinomialTreePipelined(std::vector<T>& value, size_t origin) {
+    static constexpr bool debug = false;
+
+    size_t num_hosts = this->num_hosts();
+    // calculate rank in cyclically shifted binomial tree
+    size_t my_rank = (my_host_rank() + num_hosts - origin) % num_hosts;
+    size_t r = 0, d = 1, from = 0;
+    // determine predecessor, as in BroadcastBinomialTree()
+    if (my_rank > 0) {
+        r = tlx::ffs(my_rank) - 1;
+        d <<= r;
+        from = ((my_rank ^ d) + origin) % num_hosts;
+    }
+    else {
+        d = tlx::round_up_to_power_of_two(num_hosts);
+    }
+    // collect successors, largest subtree first
+    std::vector<size_t> to;
+    for (d >>= 1; d > 0; d >>= 1) {
+        if (my_rank + d < num_hosts)
+            to.push_back((my_rank + d + origin) % num_hosts);
+    }
+
+    // pass on number of items
+    size_t size = value.size();
+    if (my_rank > 0) {
+        ReceiveFrom(from, &size);
+        value.resize(size);
+    }
+    for (const size_t& t : to)
+        SendTo(t, size);
+
+    // pass on segments
+    const size_t segment =
+        std::max<size_t>(1, kCollectiveSegmentBytes / sizeof(T));
+
+    sLOG << "BroadcastPipelined: rank" << my_rank
+         << "size" << size << "segment" << segment << "successors" << to.size();
+
+    for (size_t begin = 0; begin < size; begin += segment) {
+        size_t n = std::min(segment, size - begin);
+        if (my_rank > 0)
+            connection(from).ReceiveN(value.data() + begin, n);
+        for (const size_t& t : to)
+            connection(t).SendN(value.data() + begin, n);
+    }
+}
+
 //! select broadcast implementation (often due to total number of processors)
 template <typename T>
 void Group::BroadcastSelect(T& value, size_t origin) {
     return BroadcastBinomialTree(value, origin);
 }
 
+//! select broadcast implementation for std::vectors of POD items: these are
+//! always broadcast pipelined, since only the origin knows their size.
+template <typename T>
+typename std::enable_if<
+    std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+Group::BroadcastSelect(std::vector<T>& value, size_t origin) {
+    return BroadcastBinomialTreePipelined(value, origin);
+}
+
 /*!
  * Broadcasts the value of the worker with index 0 to all the others. This is a
  * binomial tree broadcast method.
@@ -546,6 +703,115 @@ void Group::AllReduceEliminationProcess(
     }
 }
 
+/*!
+ * Perform an All-Reduce of large std::vectors of POD items, which are reduced
+ * component-wise, using the algorithm described in R. Rabenseifner.
+ * "Optimization of Collective Reduction Operations." In Computational Science
+ * - ICCS 2004, 1–9. LNCS 3036. Springer, 2004.
+ *
+ * The vector is split into one segment per host. A reduce-scatter by recursive
+ * halving leaves each host with the reduced values of one segment, which are
+ * then collected on all hosts by an allgather using recursive doubling. Hence,
+ * each host sends and receives only about twice the vector's size, instead of
+ * the whole vector in each of the log(p) rounds. For non-powers of two, the
+ * first 2r hosts combine pairwise before and receive the result after.
+ *
+ * The order of summation is kept as in the other algorithms: the values of
+ * hosts with lower ranks are always the left operand.
+ *
+ * \param value The vector to be added to the aggregation
+ * \param sum_op A component-wise summation operator on std::vectors
+ */
+template <typename T, typename BinarySumOp>
+void Group::AllReduceRabenseifner(std::vector<T>& value, BinarySumOp sum_op) {
+    static constexpr bool debug = false;
+
+    const size_t size = value.size();
+    const size_t num_hosts = this->num_hosts();
+    const size_t my_rank = my_host_rank();
+    const size_t p = tlx::round_down_to_power_of_two(num_hosts);
+    const size_t r = num_hosts - p;
+
+    // eliminate the first 2r hosts pairwise, even ranks pass on their vector
+    // to the next odd one.
+    if (my_rank < 2 * r && my_rank % 2 == 0) {
+        connection(my_rank + 1).SendN(value.data(), size);
+        connection(my_rank + 1).ReceiveN(value.data(), size);
+        return;
+    }
+    if (my_rank < 2 * r) {
+        std::vector<T> recv_data(size);
+        connection(my_rank - 1).ReceiveN(recv_data.data(), size);
+        value = sum_op(recv_data, value);
+    }
+
+    // rank within the remaining power of two hosts, and back.
+    const size_t vrank = my_rank < 2 * r ? my_rank / 2 : my_rank - r;
+    auto real_rank = [r](size_t v) { return v < r ? 2 * v + 1 : v + r; };
+    // first item of segment i
+    auto bound = [size, p](size_t i) { return size * i / p; };
+
+    // reduce-scatter: halve the range of segments in each round, keeping the
+    // host ranks of the reduced values contiguous.
+    std::vector<std::pair<size_t, size_t> > ranges;
+    size_t lo = 0, hi = p;
+    for (size_t d = 1; d < p; d <<= 1) {
+        ranges.emplace_back(lo, hi);
+        size_t peer = real_rank(vrank ^ d);
+        size_t mid = (lo + hi) / 2;
+
+        size_t send_lo = (vrank & d) ? lo : mid, send_hi = (vrank & d) ? mid : hi;
+        if (vrank & d) lo = mid;
+        else hi = mid;
+
+        sLOG << "AllReduceRabenseifner: rank" << my_rank << "peer" << peer
+             << "keep" << lo << hi;
+
+        std::vector<T> recv_data(bound(hi) - bound(lo));
+        const void* send_ptr = value.data() + bound(send_lo);
+        size_t send_size = (bound(send_hi) - bound(send_lo)) * sizeof(T);
+        if (vrank & d) {
+            connection(peer).SyncSendRecv(
+                send_ptr, send_size,
+                recv_data.data(), recv_data.size() * sizeof(T));
+        }
+        else {
+            connection(peer).SyncRecvSend(
+                send_ptr, send_size,
+                recv_data.data(), recv_data.size() * sizeof(T));
+        }
+
+        std::vector<T> local(value.begin() + bound(lo),
+                             value.begin() + bound(hi));
+        local = (vrank & d) ? sum_op(recv_data, local) : sum_op(local, recv_data);
+        std::copy(local.begin(), local.end(), value.begin() + bound(lo));
+    }
+
+    // allgather: exchange the reduced halves in reverse order
+    for (size_t d = p >> 1; d > 0; d >>= 1) {
+        size_t peer = real_rank(vrank ^ d);
+        lo = ranges.back().first, hi = ranges.back().second;
+        ranges.pop_back();
+        size_t mid = (lo + hi) / 2;
+
+        size_t recv_lo = (vrank & d) ? lo : mid, recv_hi = (vrank & d) ? mid : hi;
+        size_t send_lo = (vrank & d) ? mid : lo, send_hi = (vrank & d) ? hi : mid;
+
+        const void* send_ptr = value.data() + bound(send_lo);
+        size_t send_size = (bound(send_hi) - bound(send_lo)) * sizeof(T);
+        void* recv_ptr = value.data() + bound(recv_lo);
+        size_t recv_size = (bound(recv_hi) - bound(recv_lo)) * sizeof(T);
+        if (vrank & d)
+            connection(peer).SyncSendRecv(send_ptr, send_size, recv_ptr, recv_size);
+        else
+            connection(peer).SyncRecvSend(send_ptr, send_size, recv_ptr, recv_size);
+    }
+
+    // return result to the eliminated hosts
+    if (my_rank < 2 * r)
+        connection(my_rank - 1).SendN(value.data(), size);
+}
+
 //! select allreduce implementation (often due to total number of processors)
 template <typename T, typename BinarySumOp>
 void Group::AllReduceSelect(T& value, BinarySumOp sum_op) {
@@ -557,6 +823,21 @@ void Group::AllReduceSelect(T& value, BinarySumOp sum_op) {
         AllReduceAtRoot(value, sum_op);*/
 }
 
+//! select allreduce implementation for component-wise sums of std::vectors of
+//! POD items: large vectors are reduced segmented.
+template <typename T, typename Operation>
+typename std::enable_if<
+    std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+Group::AllReduceSelect(
+    std::vector<T>& value,
+    common::ComponentSum<std::vector<T>, Operation> sum_op) {
+    if (value.size() >= num_hosts() &&
+        value.size() * sizeof(T) >= kCollectiveSegmentedBytes)
+        AllReduceRabenseifner(value, sum_op);
+    else
+        AllReduceElimination(value, sum_op);
+}
+
 /*!
  * Perform an All-Reduce on the workers.  This is done by aggregating all values
  * according to a summation operator and sending them backto all workers.
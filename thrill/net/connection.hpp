@@ -27,6 +27,7 @@
 #include <array>
 #include <cassert>
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
@@ -62,7 +63,11 @@ public:
         NoFlags = 0,
         //! indicate that more data is coming, hence, sending a packet may be
         //! delayed. currently only applies to TCP.
-        MsgMore = 1
+        MsgMore = 1,
+        //! send the pages of the data without copying them, if zero_copy().
+        //! The data must not be modified or freed until ZeroCopyCompleted()
+        //! covers the send. currently only applies to TCP.
+        MsgZeroCopy = 2
     };
 
     //! operator to combine flags
@@ -98,6 +103,50 @@ public:
     virtual ssize_t SendOne(const void* data, size_t size,
                             Flags flags = NoFlags) = 0;
 
+    //! a (data,size) piece of a vectored send
+    struct IoVec {
+        const void* data;
+        size_t      size;
+    };
+
+    //! Non-blocking send of count successive (data,size) pieces, which the
+    //! backend may combine into one system call. returns number of bytes of
+    //! the concatenation possible to send. check errno for errors.
+    virtual ssize_t SendV(const IoVec* iov, size_t count,
+                          Flags flags = NoFlags) {
+        // default: send only the first non-empty piece
+        for (size_t i = 0; i < count; ++i) {
+            if (iov[i].size == 0) continue;
+            return SendOne(iov[i].data, iov[i].size,
+                           i + 1 < count ? flags | MsgMore : flags);
+        }
+        return 0;
+    }
+
+    //! whether sends with MsgZeroCopy are sent without copying
+    virtual bool zero_copy() const { return false; }
+
+    //! number of successful sends with MsgZeroCopy so far. The n-th of them
+    //! has the id n - 1, modulo 2^32.
+    virtual uint32_t zero_copy_sends() const { return 0; }
+
+    //! read completion notifications without blocking, and return the number
+    //! of sends with MsgZeroCopy, counted from the first, whose data the
+    //! backend no longer references.
+    virtual uint32_t ZeroCopyCompleted() { return 0; }
+
+    //! Non-blocking send of two successive (data,size) messages, which the
+    //! backend may combine into one system call. returns number of bytes of
+    //! the concatenation possible to send. check errno for errors.
+    ssize_t SendTwo(const void* data1, size_t size1,
+                    const void* data2, size_t size2,
+                    Flags flags = NoFlags) {
+        IoVec iov[2] = {
+            { data1, size1 }, { data2, size2 }
+        };
+        return SendV(iov, 2, flags);
+    }
+
     //! Send any serializable POD item T. if sending fails, a net::Exception is
     //! thrown.
     template <typename T>
@@ -623,6 +672,12 @@ public:
     //! active recv requests
     std::atomic<size_t> rx_active_ = { 0 };
 
+    //! number of batches sent by the dispatcher's coalescing write queue
+    std::atomic<size_t> tx_batches_ { 0 };
+
+    //! number of pieces in all sent batches
+    std::atomic<size_t> tx_batch_pieces_ { 0 };
+
     //! }
 
     //! make ostreamable
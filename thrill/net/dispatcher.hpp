@@ -30,6 +30,9 @@
 #include <functional>
 #include <queue>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -501,6 +504,346 @@ private:
 
 /******************************************************************************/
 
+/*!
+ * Writer for a Buffer immediately followed by a Block, as used for the header
+ * and payload of Blocks in data::Multiplexer. Both are passed to
+ * Connection::SendTwo(), such that the TCP backend sends them with one system
+ * call instead of two.
+ */
+class AsyncWriteBufferBlock
+{
+public:
+    //! Construct buffer and block writer with callback
+    AsyncWriteBufferBlock(Connection& conn, Buffer&& buffer,
+                          data::PinnedBlock&& block,
+                          const AsyncWriteCallback& callback)
+        : conn_(&conn),
+          buffer_(std::move(buffer)),
+          block_(std::move(block)),
+          callback_(callback) {
+        LOGC(debug_async)
+            << "AsyncWriteBufferBlock()"
+            << " buffer_.size()=" << buffer_.size()
+            << " block_=" << block_;
+        conn_->tx_active_++;
+    }
+
+    //! non-copyable: delete copy-constructor
+    AsyncWriteBufferBlock(const AsyncWriteBufferBlock&) = delete;
+    //! non-copyable: delete assignment operator
+    AsyncWriteBufferBlock& operator = (const AsyncWriteBufferBlock&) = delete;
+    //! move-constructor: default
+    AsyncWriteBufferBlock(AsyncWriteBufferBlock&&) = default;
+    //! move-assignment operator: default
+    AsyncWriteBufferBlock& operator = (AsyncWriteBufferBlock&&) = default;
+
+    ~AsyncWriteBufferBlock() {
+        LOGC(debug_async)
+            << "~AsyncWriteBufferBlock()"
+            << " block_=" << block_;
+    }
+
+    //! Should be called when the socket is writable
+    bool operator () () {
+        LOGC(debug_async_send)
+            << "AsyncWriteBufferBlock() send"
+            << " offset=" << written_size_
+            << " size=" << size() - written_size_;
+
+        ssize_t r;
+        if (written_size_ < buffer_.size()) {
+            r = conn_->SendTwo(
+                buffer_.data() + written_size_, buffer_.size() - written_size_,
+                block_.data_begin(), block_.size());
+        }
+        else {
+            size_t offset = written_size_ - buffer_.size();
+            r = conn_->SendOne(
+                block_.data_begin() + offset, block_.size() - offset);
+        }
+
+        if (r <= 0) {
+            if (errno == EINTR || errno == EAGAIN) return true;
+
+            // signal artificial IsDone, for clean up.
+            written_size_ = size();
+
+            if (errno == EPIPE) {
+                LOG1 << "AsyncWriteBufferBlock() got EPIPE";
+                DoCallback();
+                return false;
+            }
+            throw Exception("AsyncWriteBufferBlock() error in send", errno);
+        }
+
+        written_size_ += r;
+
+        if (written_size_ == size()) {
+            DoCallback();
+            conn_->tx_active_--;
+            return false;
+        }
+        else {
+            return true;
+        }
+    }
+
+    bool IsDone() const { return written_size_ == size(); }
+
+    void DoCallback() {
+        if (callback_) {
+            callback_(*conn_);
+            callback_ = AsyncWriteCallback();
+        }
+        // release Pin
+        block_.Reset();
+    }
+
+    //! Returns conn_
+    Connection * connection() const { return conn_; }
+
+    //! total size of buffer and block
+    size_t size() const { return buffer_.size() + block_.size(); }
+
+private:
+    //! Connection reference
+    Connection* conn_;
+
+    //! Send buffer (owned by this writer)
+    Buffer buffer_;
+
+    //! Send block (holds a pin on the underlying ByteBlock)
+    data::PinnedBlock block_;
+
+    //! total size currently written
+    size_t written_size_ = 0;
+
+    //! functional object to call once data is complete
+    AsyncWriteCallback callback_;
+};
+
+/******************************************************************************/
+
+/*!
+ * Queue of all writes to one connection, used by dispatchers which coalesce
+ * writes. Each time the connection is writable, the queued Buffers and Blocks
+ * are passed to Connection::SendV() as one batch of up to kMaxPieces pieces,
+ * which is bounded by a byte budget. Hence, many small Blocks flushed by a
+ * MixStream are sent by one system call.
+ */
+class AsyncWriteQueue
+{
+public:
+    //! maximum number of pieces per batch
+    static constexpr size_t kMaxPieces = 64;
+
+    //! minimum bytes of a batch sent with MsgZeroCopy, below which copying is
+    //! cheaper than pinning the pages and reaping the completion.
+    static constexpr size_t kZeroCopyMinBytes = 16 * 1024;
+
+    //! Construct write queue for the connection with the byte budget of a batch
+    AsyncWriteQueue(Connection& conn, size_t batch_bytes)
+        : conn_(&conn), batch_bytes_(batch_bytes) { }
+
+    //! non-copyable: delete copy-constructor
+    AsyncWriteQueue(const AsyncWriteQueue&) = delete;
+    //! non-copyable: delete assignment operator
+    AsyncWriteQueue& operator = (const AsyncWriteQueue&) = delete;
+
+    //! Append a buffer and/or block. Returns true if the queue was idle, and
+    //! the write callback must be registered.
+    bool Push(Buffer&& buffer, data::PinnedBlock&& block,
+              const AsyncWriteCallback& callback) {
+        LOGC(debug_async)
+            << "AsyncWriteQueue::Push()"
+            << " buffer.size()=" << buffer.size()
+            << " block.size()=" << block.size()
+            << " queued=" << items_.size();
+        items_.emplace_back(std::move(buffer), std::move(block), callback);
+        conn_->tx_active_++;
+        if (active_) return false;
+        active_ = true;
+        return true;
+    }
+
+    //! Should be called when the socket is writable
+    bool operator () () {
+        ReapZeroCopy();
+
+        Connection::IoVec iov[kMaxPieces];
+        size_t count = 0, bytes = 0, touched = 0;
+
+        for (auto it = items_.begin();
+             it != items_.end() && count + 2 <= kMaxPieces &&
+             bytes < batch_bytes_; ++it, ++touched)
+        {
+            size_t bsize = it->buffer.size(), offset = it->written_size;
+            if (offset < bsize) {
+                iov[count++] = { it->buffer.data() + offset, bsize - offset };
+                bytes += bsize - offset;
+                offset = 0;
+            }
+            else {
+                offset -= bsize;
+            }
+            if (offset < it->block.size()) {
+                iov[count++] = {
+                    it->block.data_begin() + offset, it->block.size() - offset
+                };
+                bytes += it->block.size() - offset;
+            }
+        }
+
+        LOGC(debug_async_send)
+            << "AsyncWriteQueue() send"
+            << " pieces=" << count
+            << " bytes=" << bytes;
+
+        bool zero_copy = conn_->zero_copy() && bytes >= kZeroCopyMinBytes;
+        uint32_t zc_sends = conn_->zero_copy_sends();
+
+        ssize_t r = conn_->SendV(
+            iov, count,
+            zero_copy ? Connection::MsgZeroCopy : Connection::NoFlags);
+
+        // the kernel may reference the pages of all pieces of the batch until
+        // the completion, even if it fell back to copying.
+        if (r > 0 && conn_->zero_copy_sends() != zc_sends) {
+            for (size_t i = 0; i < touched; ++i)
+                items_[i].zero_copy = true;
+        }
+
+        if (r <= 0) {
+            if (errno == EINTR || errno == EAGAIN) return true;
+
+            if (errno == EPIPE) {
+                LOG1 << "AsyncWriteQueue() got EPIPE";
+                // signal artificial completion, for clean up.
+                while (!items_.empty()) PopFront();
+                active_ = false;
+                return false;
+            }
+            throw Exception("AsyncWriteQueue() error in send", errno);
+        }
+
+        conn_->tx_batches_++;
+        conn_->tx_batch_pieces_ += count;
+
+        // complete items which were fully sent
+        size_t written = r;
+        while (written != 0) {
+            Item& front = items_.front();
+            size_t remaining = front.size() - front.written_size;
+            if (written < remaining) {
+                front.written_size += written;
+                break;
+            }
+            written -= remaining;
+            PopFront();
+        }
+
+        if (items_.empty()) {
+            active_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    //! number of queued writes
+    size_t size() const { return items_.size(); }
+
+    //! whether sends with MsgZeroCopy may still have to be reaped
+    bool zero_copy_outstanding() const {
+        return conn_->zero_copy_sends() != zero_copy_completed_;
+    }
+
+    //! number of sent Buffers and Blocks held until their zero-copy completion
+    size_t zero_copy_pending() const { return pending_.size(); }
+
+    //! read zero-copy completions and release the Buffers and Blocks whose
+    //! sends are completed.
+    void ReapZeroCopy() {
+        if (!zero_copy_outstanding()) return;
+        zero_copy_completed_ = conn_->ZeroCopyCompleted();
+        while (!pending_.empty() &&
+               static_cast<int32_t>(
+                   zero_copy_completed_ - pending_.front().sends) >= 0) {
+            pending_.pop_front();
+        }
+    }
+
+private:
+    //! a queued write
+    struct Item {
+        //! Send buffer (owned by this queue)
+        Buffer            buffer;
+        //! Send block (holds a pin on the underlying ByteBlock)
+        data::PinnedBlock block;
+        //! functional object to call once data is complete
+        AsyncWriteCallback callback;
+        //! total size currently written
+        size_t            written_size = 0;
+        //! whether a part was sent with MsgZeroCopy
+        bool              zero_copy = false;
+
+        Item(Buffer&& _buffer, data::PinnedBlock&& _block,
+             const AsyncWriteCallback& _callback)
+            : buffer(std::move(_buffer)), block(std::move(_block)),
+              callback(_callback) { }
+
+        //! total size of buffer and block
+        size_t size() const { return buffer.size() + block.size(); }
+    };
+
+    //! Connection reference
+    Connection* conn_;
+
+    //! byte budget of a batch
+    size_t batch_bytes_;
+
+    //! queued writes in order
+    std::deque<Item, mem::GPoolAllocator<Item> > items_;
+
+    //! whether the write callback is registered
+    bool active_ = false;
+
+    //! a sent Buffer and Block, which the kernel may still read from
+    struct Pending {
+        Buffer            buffer;
+        data::PinnedBlock block;
+        //! released when this many sends with MsgZeroCopy are completed
+        uint32_t          sends;
+
+        Pending(Buffer&& _buffer, data::PinnedBlock&& _block, uint32_t _sends)
+            : buffer(std::move(_buffer)), block(std::move(_block)),
+              sends(_sends) { }
+    };
+
+    //! Buffers and Blocks held until their zero-copy completion, in order
+    std::deque<Pending, mem::GPoolAllocator<Pending> > pending_;
+
+    //! number of completed sends with MsgZeroCopy seen by ReapZeroCopy()
+    uint32_t zero_copy_completed_ = 0;
+
+    //! remove the front item and run its callback, which may queue more.
+    void PopFront() {
+        Item& front = items_.front();
+        AsyncWriteCallback callback = std::move(front.callback);
+        if (front.zero_copy) {
+            // keep the Buffer and Pin until all sends so far are completed.
+            pending_.emplace_back(std::move(front.buffer),
+                                  std::move(front.block),
+                                  conn_->zero_copy_sends());
+        }
+        // release Buffer and Pin
+        items_.pop_front();
+        conn_->tx_active_--;
+        if (callback) callback(*conn_);
+    }
+};
+
+/******************************************************************************/
+
 /*!
  * Dispatcher is a high level wrapper for asynchronous callback processing.. One
  * can register Connection objects for readability and writability checks,
@@ -616,6 +959,9 @@ public:
             return;
         }
 
+        if (coalesce_writes_)
+            return QueueWrite(c, std::move(buffer), data::PinnedBlock(), done_cb);
+
         // add new async writer object
         async_write_.emplace_back(c, std::move(buffer), done_cb);
 
@@ -637,6 +983,9 @@ public:
             return;
         }
 
+        if (coalesce_writes_)
+            return QueueWrite(c, Buffer(), std::move(block), done_cb);
+
         // add new async writer object
         async_write_block_.emplace_back(c, std::move(block), done_cb);
 
@@ -646,6 +995,30 @@ public:
                      AsyncWriteBlock, &AsyncWriteBlock::operator ()>(&awb));
     }
 
+    //! asynchronously write buffer followed by block and callback when both
+    //! are delivered. Both are MOVED into the async writer. The block is sent
+    //! with sequence number seq + 1 by backends using separate messages.
+    virtual void AsyncWrite(
+        Connection& c, uint32_t /* seq */, Buffer&& buffer,
+        data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) {
+        assert(c.IsValid());
+        assert(block.size() != 0);
+
+        if (coalesce_writes_)
+            return QueueWrite(c, std::move(buffer), std::move(block), done_cb);
+
+        // add new async writer object
+        async_write_buffer_block_.emplace_back(
+            c, std::move(buffer), std::move(block), done_cb);
+
+        // register write callback
+        AsyncWriteBufferBlock& awbb = async_write_buffer_block_.back();
+        AddWrite(c, AsyncCallback::make<
+                     AsyncWriteBufferBlock,
+                     &AsyncWriteBufferBlock::operator ()>(&awbb));
+    }
+
     //! asynchronously write buffer and callback when delivered. COPIES the data
     //! into a Buffer!
     void AsyncWriteCopy(
@@ -716,6 +1089,15 @@ public:
         while (async_write_block_.size() && async_write_block_.front().IsDone()) {
             async_write_block_.pop_front();
         }
+        while (async_write_buffer_block_.size() &&
+               async_write_buffer_block_.front().IsDone()) {
+            async_write_buffer_block_.pop_front();
+        }
+
+        // drain zero-copy completions, which also clears EPOLLERR
+        for (auto& wq : write_queues_) {
+            wq.second.ReapZeroCopy();
+        }
     }
 
     //! Loop over Dispatch() until terminate_ flag is set.
@@ -737,7 +1119,13 @@ public:
 
     //! Check whether there are still AsyncWrite()s in the queue.
     bool HasAsyncWrites() const {
-        return (async_write_.size() != 0) || (async_write_block_.size() != 0);
+        if ((async_write_.size() != 0) || (async_write_block_.size() != 0) ||
+            (async_write_buffer_block_.size() != 0))
+            return true;
+        for (const auto& wq : write_queues_) {
+            if (wq.second.size() != 0) return true;
+        }
+        return false;
     }
 
     //! \}
@@ -756,6 +1144,32 @@ protected:
     //! true if dispatcher needs to stop
     std::atomic<bool> terminate_ { false };
 
+    //! byte budget of a coalesced write batch
+    static constexpr size_t kWriteBatchBytes = 256 * 1024;
+
+    //! whether AsyncWrite()s are coalesced per connection by AsyncWriteQueue
+    //! objects instead of one write callback per Buffer or Block. Enabled by
+    //! dispatchers whose connections implement SendV() with one system call.
+    bool coalesce_writes_ = false;
+
+    //! append buffer and block to the connection's write queue, and register
+    //! the queue as write callback if it was idle.
+    void QueueWrite(Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+                    const AsyncWriteCallback& done_cb) {
+        auto it = write_queues_.find(&c);
+        if (it == write_queues_.end()) {
+            it = write_queues_.emplace(
+                std::piecewise_construct, std::forward_as_tuple(&c),
+                std::forward_as_tuple(c, kWriteBatchBytes)).first;
+        }
+
+        AsyncWriteQueue& awq = it->second;
+        if (awq.Push(std::move(buffer), std::move(block), done_cb)) {
+            AddWrite(c, AsyncCallback::make<
+                         AsyncWriteQueue, &AsyncWriteQueue::operator ()>(&awq));
+        }
+    }
+
     /*------------------------------------------------------------------------*/
 
     //! struct for timer callbacks
@@ -804,6 +1218,14 @@ protected:
     //! deque of asynchronous writers
     std::deque<AsyncWriteBlock,
                mem::GPoolAllocator<AsyncWriteBlock> > async_write_block_;
+
+    //! deque of asynchronous writers of a buffer followed by a block
+    std::deque<AsyncWriteBufferBlock,
+               mem::GPoolAllocator<AsyncWriteBufferBlock> >
+    async_write_buffer_block_;
+
+    //! write queues per connection, if coalesce_writes_ is set.
+    std::unordered_map<Connection*, AsyncWriteQueue> write_queues_;
 };
 
 //! \}
@@ -8,6 +8,7 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <thrill/common/cpu_placement.hpp>
 #include <thrill/net/dispatcher.hpp>
 #include <thrill/net/dispatcher_thread.hpp>
 #include <thrill/net/group.hpp>
@@ -20,9 +21,10 @@ namespace thrill {
 namespace net {
 
 DispatcherThread::DispatcherThread(
-    std::unique_ptr<class Dispatcher> dispatcher, size_t host_rank)
+    std::unique_ptr<class Dispatcher> dispatcher, size_t host_rank,
+    size_t core)
     : dispatcher_(std::move(dispatcher)),
-      host_rank_(host_rank) {
+      host_rank_(host_rank), core_(core) {
     // start thread
     thread_ = std::thread(&DispatcherThread::Work, this);
 }
@@ -81,6 +83,7 @@ void DispatcherThread::Cancel(Connection& c) {
 void DispatcherThread::AsyncRead(
     Connection& c, uint32_t seq, size_t size,
     const AsyncReadCallback& done_cb) {
+    stats_.read_bytes.Add(size);
     Enqueue([=, &c]() {
                 dispatcher_->AsyncRead(c, seq, size, done_cb);
             });
@@ -91,6 +94,7 @@ void DispatcherThread::AsyncRead(
     Connection& c, uint32_t seq, size_t size, data::PinnedByteBlockPtr&& block,
     const AsyncReadByteBlockCallback& done_cb) {
     assert(block.valid());
+    stats_.read_bytes.Add(size);
     Enqueue([=, &c, b = std::move(block)]() mutable {
                 dispatcher_->AsyncRead(c, seq, size, std::move(b), done_cb);
             });
@@ -100,8 +104,9 @@ void DispatcherThread::AsyncRead(
 void DispatcherThread::AsyncWrite(
     Connection& c, uint32_t seq, Buffer&& buffer, const AsyncWriteCallback& done_cb) {
     // the following captures the move-only buffer in a lambda.
-    Enqueue([=, &c, b = std::move(buffer)]() mutable {
-                dispatcher_->AsyncWrite(c, seq, std::move(b), done_cb);
+    Enqueue([=, &c, b = std::move(buffer),
+             cb = TimeWrite(done_cb)]() mutable {
+                dispatcher_->AsyncWrite(c, seq, std::move(b), cb);
             });
     WakeUpThread();
 }
@@ -112,9 +117,10 @@ void DispatcherThread::AsyncWrite(
     assert(block.IsValid());
     // the following captures the move-only buffer in a lambda.
     Enqueue([=, &c,
-             b1 = std::move(buffer), b2 = std::move(block)]() mutable {
-                dispatcher_->AsyncWrite(c, seq, std::move(b1));
-                dispatcher_->AsyncWrite(c, seq + 1, std::move(b2), done_cb);
+             b1 = std::move(buffer), b2 = std::move(block),
+             cb = TimeWrite(done_cb)]() mutable {
+                dispatcher_->AsyncWrite(
+                    c, seq, std::move(b1), std::move(b2), cb);
             });
     WakeUpThread();
 }
@@ -132,38 +138,62 @@ void DispatcherThread::AsyncWriteCopy(
 }
 
 void DispatcherThread::Enqueue(Job&& job) {
-    return jobqueue_.push(std::move(job));
+    return jobqueue_.push(QueuedJob { std::move(job), steady_clock::now() });
+}
+
+void DispatcherThread::RunJob(QueuedJob& qj) {
+    stats_.queue_wait_us.Add(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            steady_clock::now() - qj.enqueued).count());
+    qj.job();
+}
+
+AsyncWriteCallback DispatcherThread::TimeWrite(
+    const AsyncWriteCallback& done_cb) {
+    steady_clock::time_point start = steady_clock::now();
+    return [this, start, done_cb](Connection& c) {
+               stats_.write_latency_us.Add(
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       steady_clock::now() - start).count());
+               if (done_cb) done_cb(c);
+           };
 }
 
 void DispatcherThread::Work() {
     common::NameThisThread(
         "host " + std::to_string(host_rank_) + " dispatcher");
-    // pin DispatcherThread to last core
-    common::SetCpuAffinity(std::thread::hardware_concurrency() - 1);
+    // pin DispatcherThread to its core, by default the last placement slot
+    common::SetCpuAffinity(
+        core_ != size_t(-1) ? core_ :
+        common::CpuPlacementCpu(common::CpuPlacementSlots() - 1));
 
     while (!terminate_ ||
            dispatcher_->HasAsyncWrites() || !jobqueue_.empty())
     {
         // process jobs in jobqueue_
         {
-            Job job;
-            while (jobqueue_.try_pop(job))
-                job();
+            QueuedJob qj;
+            while (jobqueue_.try_pop(qj))
+                RunJob(qj);
         }
 
         // set busy flag, but check once again for jobs.
         busy_ = true;
         {
-            Job job;
-            if (jobqueue_.try_pop(job)) {
+            QueuedJob qj;
+            if (jobqueue_.try_pop(qj)) {
                 busy_ = false;
-                job();
+                RunJob(qj);
                 continue;
             }
         }
 
         // run one dispatch
+        steady_clock::time_point start = steady_clock::now();
         dispatcher_->Dispatch();
+        stats_.dispatch_us.Add(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                steady_clock::now() - start).count());
 
         busy_ = false;
     }
@@ -176,6 +206,35 @@ void DispatcherThread::WakeUpThread() {
         dispatcher_->Interrupt();
 }
 
+/******************************************************************************/
+// DispatcherProfiler
+
+void DispatcherProfiler::RunTask(const std::chrono::steady_clock::time_point&) {
+    const DispatcherThread::Stats& stats = dispatcher_.stats();
+
+    common::LogHistogram::Snapshot queue_wait =
+        stats.queue_wait_us.GetSnapshot();
+    common::LogHistogram::Snapshot write_latency =
+        stats.write_latency_us.GetSnapshot();
+    common::LogHistogram::Snapshot read_bytes =
+        stats.read_bytes.GetSnapshot();
+    common::LogHistogram::Snapshot dispatch =
+        stats.dispatch_us.GetSnapshot();
+
+    common::JsonLine line = logger_.line();
+    line << "class" << "NetDispatcher"
+         << "event" << "profile";
+    (queue_wait - prev_queue_wait_).Log(line, "queue_wait_us");
+    (write_latency - prev_write_latency_).Log(line, "write_latency_us");
+    (read_bytes - prev_read_bytes_).Log(line, "read_bytes");
+    (dispatch - prev_dispatch_).Log(line, "dispatch_us");
+
+    prev_queue_wait_ = queue_wait;
+    prev_write_latency_ = write_latency;
+    prev_read_bytes_ = read_bytes;
+    prev_dispatch_ = dispatch;
+}
+
 } // namespace net
 } // namespace thrill
 
@@ -16,12 +16,16 @@
 #define THRILL_NET_DISPATCHER_THREAD_HEADER
 
 #include <thrill/common/concurrent_queue.hpp>
+#include <thrill/common/json_logger.hpp>
+#include <thrill/common/log_histogram.hpp>
+#include <thrill/common/profile_task.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/mem/allocator.hpp>
 #include <thrill/net/buffer.hpp>
 #include <thrill/net/connection.hpp>
 #include <tlx/delegate.hpp>
 
+#include <chrono>
 #include <string>
 
 namespace thrill {
@@ -65,9 +69,11 @@ public:
     //! Signature of async jobs to be run by the dispatcher thread.
     using Job = tlx::delegate<void (), mem::GPoolAllocator<char> >;
 
+    //! construct and start the thread, which is pinned to the given core, or
+    //! to the last placement slot if core == size_t(-1).
     DispatcherThread(
         std::unique_ptr<class Dispatcher> dispatcher,
-        size_t host_rank);
+        size_t host_rank, size_t core = size_t(-1));
 
     ~DispatcherThread();
 
@@ -143,7 +149,30 @@ public:
 
     //! \}
 
+    //! latency histograms of the dispatcher thread
+    struct Stats {
+        //! time jobs wait in the queue until the thread runs them
+        common::LogHistogram queue_wait_us;
+        //! time from AsyncWrite() until the write's callback is run
+        common::LogHistogram write_latency_us;
+        //! size of AsyncRead()s
+        common::LogHistogram read_bytes;
+        //! duration of Dispatcher::Dispatch(), including waiting for events
+        common::LogHistogram dispatch_us;
+    };
+
+    //! latency histograms of the dispatcher thread
+    const Stats& stats() const { return stats_; }
+
 private:
+    using steady_clock = std::chrono::steady_clock;
+
+    //! a job and the time it was enqueued
+    struct QueuedJob {
+        Job                      job;
+        steady_clock::time_point enqueued;
+    };
+
     //! Enqueue job in queue for dispatching thread to run at its discretion.
     void Enqueue(Job&& job);
 
@@ -153,9 +182,16 @@ private:
     //! wake up select() in dispatching thread.
     void WakeUpThread();
 
+    //! run a job from the queue and record its queue wait time
+    void RunJob(QueuedJob& qj);
+
+    //! wrap the callback of an AsyncWrite() to record its latency
+    AsyncWriteCallback TimeWrite(const AsyncWriteCallback& done_cb);
+
 private:
     //! Queue of jobs to be run by dispatching thread at its discretion.
-    common::ConcurrentQueue<Job, mem::GPoolAllocator<Job> > jobqueue_;
+    common::ConcurrentQueue<QueuedJob, mem::GPoolAllocator<QueuedJob> >
+    jobqueue_;
 
     //! thread of dispatcher
     std::thread thread_;
@@ -171,6 +207,38 @@ private:
 
     //! for thread name for logging
     size_t host_rank_;
+
+    //! core the thread is pinned to, or size_t(-1) for the last slot
+    size_t core_;
+
+    //! latency histograms
+    Stats stats_;
+};
+
+/*!
+ * ProfileTask which logs percentiles of the latency histograms of a
+ * DispatcherThread recorded since the previous run, such that one sees when
+ * the single dispatcher thread becomes a bottleneck.
+ */
+class DispatcherProfiler final : public common::ProfileTask
+{
+public:
+    DispatcherProfiler(const DispatcherThread& dispatcher,
+                       common::JsonLogger& logger)
+        : dispatcher_(dispatcher), logger_(logger) { }
+
+    void RunTask(const std::chrono::steady_clock::time_point& tp) final;
+
+private:
+    //! dispatcher thread whose Stats are logged
+    const DispatcherThread& dispatcher_;
+
+    //! JsonLogger for statistics output
+    common::JsonLogger& logger_;
+
+    //! histograms at the previous run
+    common::LogHistogram::Snapshot prev_queue_wait_, prev_write_latency_,
+        prev_read_bytes_, prev_dispatch_;
 };
 
 //! \}
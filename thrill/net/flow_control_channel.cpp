@@ -10,23 +10,118 @@
 
 #include <thrill/net/flow_control_channel.hpp>
 
+#include <thrill/common/logger.hpp>
+#include <thrill/net/sub_group.hpp>
+
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace thrill {
 namespace net {
 
+/******************************************************************************/
+// HostRacks
+
+HostRacks::HostRacks(Group& group, const std::vector<size_t>& rack_ids) {
+    assert(IsValid(rack_ids, group.num_hosts()));
+
+    rack_.resize(rack_ids.size());
+    for (size_t h = 0; h < rack_ids.size(); ++h) {
+        if (h == 0 || rack_ids[h] != rack_ids[h - 1])
+            begin_.push_back(h);
+        rack_[h] = begin_.size() - 1;
+    }
+
+    size_t my_rack = rack_[group.my_host_rank()];
+    size_t end = my_rack + 1 < begin_.size()
+                 ? begin_[my_rack + 1] : rack_ids.size();
+
+    std::vector<size_t> hosts;
+    for (size_t h = begin_[my_rack]; h < end; ++h)
+        hosts.push_back(h);
+    rack_group_ = std::make_unique<SubGroup>(group, hosts);
+
+    if (group.my_host_rank() == begin_[my_rack])
+        leader_group_ = std::make_unique<SubGroup>(group, begin_);
+}
+
+bool HostRacks::IsValid(const std::vector<size_t>& rack_ids, size_t num_hosts) {
+    if (rack_ids.size() != num_hosts || num_hosts == 0)
+        return false;
+
+    // check that each rack id occurs in only one contiguous range
+    std::vector<size_t> seen;
+    for (size_t h = 0; h < rack_ids.size(); ++h) {
+        if (h != 0 && rack_ids[h] == rack_ids[h - 1]) continue;
+        if (std::find(seen.begin(), seen.end(), rack_ids[h]) != seen.end())
+            return false;
+        seen.push_back(rack_ids[h]);
+    }
+
+    // a hierarchy with one rack or one host per rack is useless
+    return seen.size() > 1 && seen.size() < num_hosts;
+}
+
+/******************************************************************************/
+// AsyncCollectiveThread
+
+AsyncCollectiveThread::~AsyncCollectiveThread() {
+    WaitIdle();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        terminate_ = true;
+        cv_jobs_.notify_one();
+    }
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void AsyncCollectiveThread::Enqueue(Job&& job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!thread_.joinable())
+        thread_ = std::thread([this]() { Work(); });
+    ++pending_;
+    jobs_.emplace_back(std::move(job));
+    cv_jobs_.notify_one();
+}
+
+void AsyncCollectiveThread::Work() {
+    common::NameThisThread("async-collective");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        while (jobs_.empty() && !terminate_)
+            cv_jobs_.wait(lock);
+        if (jobs_.empty()) break;
+
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (--pending_ == 0)
+            cv_idle_.notify_all();
+    }
+}
+
 /******************************************************************************/
 // FlowControlChannel
 
 FlowControlChannel::FlowControlChannel(
     Group& group, size_t local_id, size_t thread_count,
     common::ThreadBarrier& barrier, LocalData* shmem,
-    std::atomic<size_t>& generation)
+    std::atomic<size_t>& generation, AsyncCollectiveThread& async,
+    HostRacks* racks)
     : group_(group),
       host_rank_(group_.my_host_rank()), num_hosts_(group_.num_hosts()),
       local_id_(local_id),
       thread_count_(thread_count),
-      barrier_(barrier), shmem_(shmem), generation_(generation) { }
+      barrier_(barrier), racks_(racks), async_(async),
+      shmem_(shmem), generation_(generation) { }
 
 FlowControlChannel::~FlowControlChannel() {
     sLOGC(enable_stats)
@@ -62,7 +157,8 @@ void FlowControlChannel::Barrier() {
 
             // Global all reduce
             size_t i = 0;
-            group_.AllReduce(i);
+            WaitAsync();
+            HostAllReduce(i, std::plus<size_t>());
 
             LOG << "FCC::Barrier() COMMUNICATE END"
                 << " count=" << count_barrier_;
@@ -21,10 +21,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +40,92 @@ namespace net {
 //! \addtogroup net_layer
 //! \{
 
+/*!
+ * Assignment of the hosts to racks, used by FlowControlChannel to run
+ * hierarchical collectives: values are first combined within each rack, then
+ * among the first hosts of the racks, and then distributed back within the
+ * racks. The racks must be contiguous ranges of hosts, such that the order of
+ * summation is kept.
+ */
+class HostRacks
+{
+public:
+    //! Construct from a rack id for each host of group.
+    HostRacks(Group& group, const std::vector<size_t>& rack_ids);
+
+    //! Check that there is one rack id for each host, the racks are
+    //! contiguous, and that a hierarchy is useful.
+    static bool IsValid(const std::vector<size_t>& rack_ids, size_t num_hosts);
+
+    //! rack index of each host
+    std::vector<size_t> rack_;
+
+    //! first host of each rack
+    std::vector<size_t> begin_;
+
+    //! the hosts of this host's rack
+    std::unique_ptr<Group> rack_group_;
+
+    //! the first hosts of all racks, only set on those.
+    std::unique_ptr<Group> leader_group_;
+};
+
+/*!
+ * Background thread of a host which runs the network part of asynchronous
+ * collectives in the order they were started. Since all hosts start the
+ * collectives in the same order, they are matched. Synchronous collectives
+ * call WaitIdle() before communicating, such that they never overlap with
+ * asynchronous ones on the same Group. The thread is started on first use.
+ */
+class AsyncCollectiveThread
+{
+public:
+    using Job = std::function<void()>;
+
+    AsyncCollectiveThread() = default;
+
+    //! non-copyable: delete copy-constructor
+    AsyncCollectiveThread(const AsyncCollectiveThread&) = delete;
+    //! non-copyable: delete assignment operator
+    AsyncCollectiveThread& operator = (const AsyncCollectiveThread&) = delete;
+
+    //! waits for all jobs and joins the thread
+    ~AsyncCollectiveThread();
+
+    //! enqueue a job, which must not throw.
+    void Enqueue(Job&& job);
+
+    //! wait until all enqueued jobs are done.
+    void WaitIdle() {
+        if (pending_.load(std::memory_order_acquire) == 0) return;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (pending_ != 0)
+            cv_idle_.wait(lock);
+    }
+
+private:
+    //! mutex protecting the queue
+    std::mutex mutex_;
+
+    //! condition variables signaling new jobs and idleness
+    std::condition_variable cv_jobs_, cv_idle_;
+
+    //! queue of jobs
+    std::deque<Job> jobs_;
+
+    //! number of enqueued and running jobs
+    std::atomic<size_t> pending_ { 0 };
+
+    //! flag to stop the thread
+    bool terminate_ = false;
+
+    //! the thread, started by the first Enqueue().
+    std::thread thread_;
+
+    //! thread main loop
+    void Work();
+};
+
 /*!
  * Provides a blocking collection for communication.
  *
@@ -93,6 +185,12 @@ private:
     //! node.
     common::ThreadBarrier& barrier_;
 
+    //! Rack assignment for hierarchical collectives, or nullptr.
+    HostRacks* racks_;
+
+    //! The host's background thread for asynchronous collectives.
+    AsyncCollectiveThread& async_;
+
     //! Thread local data structure: aligned such that no cache line is
     //! shared. The actual vector is in the FlowControlChannelManager.
     class LocalData
@@ -183,12 +281,101 @@ private:
 
     //! \}
 
+    //! \name Host Collectives, which are hierarchical if racks_ is set.
+    //! \{
+
+    //! wait for outstanding asynchronous collectives on the Group
+    void WaitAsync() { async_.WaitIdle(); }
+
+    //! whether all workers are on this host, in which case the collectives are
+    //! complete after the local step and skip the Group.
+    bool single_host() const { return num_hosts_ == 1; }
+
+    //! run the Group step of an asynchronous collective on the background
+    //! thread, or directly on a single host, where it only sets the promises.
+    void RunAsync(AsyncCollectiveThread::Job&& job) {
+        if (single_host()) return job();
+        async_.Enqueue(std::move(job));
+    }
+
+    template <typename T, typename BinarySumOp>
+    void HostExPrefixSum(T& value, const BinarySumOp& sum_op, const T& initial) {
+        if (single_host()) {
+            value = initial;
+            return;
+        }
+        if (!racks_)
+            return group_.ExPrefixSum(value, sum_op, initial);
+
+        Group& rack = *racks_->rack_group_;
+        if (rack.my_host_rank() != 0) {
+            // send value to the rack's first host and receive prefix back
+            rack.SendTo(0, value);
+            rack.ReceiveFrom(0, &value);
+            return;
+        }
+
+        // gather and calculate inclusive prefix sums within the rack
+        std::vector<T> values(rack.num_hosts());
+        values[0] = value;
+        for (size_t i = 1; i < rack.num_hosts(); ++i) {
+            rack.ReceiveFrom(i, &values[i]);
+            values[i] = sum_op(values[i - 1], values[i]);
+        }
+
+        // exclusive prefix sum of the rack totals
+        value = values.back();
+        racks_->leader_group_->ExPrefixSum(value, sum_op, initial);
+
+        for (size_t i = 1; i < rack.num_hosts(); ++i)
+            rack.SendTo(i, sum_op(value, values[i - 1]));
+    }
+
+    template <typename T>
+    void HostBroadcast(T& value, size_t origin) {
+        if (single_host())
+            return;
+        if (!racks_)
+            return group_.Broadcast(value, origin);
+
+        // pass value to the first host of the origin's rack
+        size_t origin_rack = racks_->rack_[origin];
+        size_t origin_leader = racks_->begin_[origin_rack];
+        if (origin != origin_leader) {
+            if (host_rank_ == origin)
+                group_.SendTo(origin_leader, value);
+            else if (host_rank_ == origin_leader)
+                group_.ReceiveFrom(origin, &value);
+        }
+
+        if (racks_->leader_group_)
+            racks_->leader_group_->Broadcast(value, origin_rack);
+        racks_->rack_group_->Broadcast(value, 0);
+    }
+
+    template <typename T, typename BinarySumOp>
+    void HostAllReduce(T& value, const BinarySumOp& sum_op) {
+        if (single_host())
+            return;
+        if (!racks_)
+            return group_.AllReduce(value, sum_op);
+
+        racks_->rack_group_->Reduce(value, 0, sum_op);
+        if (racks_->leader_group_)
+            racks_->leader_group_->AllReduce(value, sum_op);
+        racks_->rack_group_->Broadcast(value, 0);
+    }
+
+    //! \}
+
 public:
-    //! Creates a new instance of this class, wrapping a net::Group.
+    //! Creates a new instance of this class, wrapping a net::Group. If racks
+    //! is given, the collectives are run hierarchically.
     FlowControlChannel(
         Group& group, size_t local_id, size_t thread_count,
         common::ThreadBarrier& barrier, LocalData* shmem,
-        std::atomic<size_t>& generation);
+        std::atomic<size_t>& generation, AsyncCollectiveThread& async,
+        HostRacks* racks = nullptr);
 
     //! Return the associated net::Group. USE AT YOUR OWN RISK.
     Group& group() { return group_; }
@@ -266,7 +453,8 @@ public:
                 }
 
                 T base_sum = local_sum;
-                group_.ExPrefixSum(base_sum, sum_op, initial);
+                WaitAsync();
+                HostExPrefixSum(base_sum, sum_op, initial);
 
                 if (inclusive) {
                     for (size_t i = 0; i < thread_count_; i++) {
@@ -382,12 +570,13 @@ public:
                 }
 
                 T base_sum = local_sum;
-                group_.ExPrefixSum(base_sum, sum_op, initial);
+                WaitAsync();
+                HostExPrefixSum(base_sum, sum_op, initial);
 
                 T total_sum;
                 if (host_rank_ + 1 == num_hosts_)
                     total_sum = sum_op(base_sum, local_sum);
-                group_.Broadcast(total_sum, num_hosts_ - 1);
+                HostBroadcast(total_sum, num_hosts_ - 1);
 
                 for (size_t i = thread_count_ - 1; i > 0; --i) {
                     *(locals[i]->first) = sum_op(base_sum, *(locals[i - 1]->first));
@@ -438,7 +627,8 @@ public:
 
         if (local_id_ == primary_pe) {
             RunTimer net_timer(timer_communication_);
-            group_.Broadcast(local, origin / thread_count_);
+            WaitAsync();
+            HostBroadcast(local, origin / thread_count_);
         }
 
         barrier_.wait(
@@ -461,6 +651,109 @@ public:
         return local;
     }
 
+    /*!
+     * Broadcasts a value of a serializable type T from the worker origin to all
+     * other workers, like Broadcast(), but delivers one immutable copy per host,
+     * which is shared by all local workers. This avoids a copy in each worker
+     * for large values, like the centroids of k-means.
+     *
+     * \param value The value to broadcast. This value is ignored for each
+     * worker except origin.
+     *
+     * \param origin Worker number to broadcast value from.
+     *
+     * \return Shared pointer to the value sent by origin.
+     */
+    template <typename T>
+    std::shared_ptr<const T> TLX_ATTRIBUTE_WARN_UNUSED_RESULT
+    BroadcastShared(const T& value, size_t origin = 0) {
+
+        RunTimer run_timer(timer_broadcast_);
+        if (enable_stats || debug) ++count_broadcast_;
+        LOG << "FCC::BroadcastShared() ENTER count=" << count_broadcast_;
+
+        using SharedT = std::shared_ptr<const T>;
+
+        std::pair<const T*, SharedT> local(&value, SharedT());
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, &local);
+
+        barrier_.wait(
+            [&]() {
+                RunTimer net_timer(timer_communication_);
+
+                size_t primary_pe = origin % thread_count_;
+
+                // one copy per host, received on all hosts except origin's
+                auto shared = std::make_shared<T>(
+                    *GetLocalShared<std::pair<const T*, SharedT> >(
+                        step, primary_pe)->first);
+
+                WaitAsync();
+                HostBroadcast(*shared, origin / thread_count_);
+
+                // distribute shared pointer to worker threads
+                for (size_t i = 0; i < thread_count_; i++) {
+                    GetLocalShared<std::pair<const T*, SharedT> >(step, i)->second = shared;
+                }
+            });
+
+        LOG << "FCC::BroadcastShared() EXIT count=" << count_broadcast_;
+
+        return local.second;
+    }
+
+    /*!
+     * Combines a value of each local worker into one immutable value, which is
+     * shared by all local workers of the host. This is a collective operation
+     * of the local workers only, which does not communicate with other hosts.
+     *
+     * \param value The value this worker contributes. It may be moved from by
+     * combine.
+     *
+     * \param combine Function called on one local worker with a std::vector of
+     * pointers to the values of all local workers, ordered by local id, which
+     * returns the combined Result.
+     *
+     * \return Shared pointer to the combined value.
+     */
+    template <typename Result, typename T, typename CombineFunction>
+    std::shared_ptr<const Result> TLX_ATTRIBUTE_WARN_UNUSED_RESULT
+    LocalCombineShared(T& value, const CombineFunction& combine) {
+
+        LOG << "FCC::LocalCombineShared() ENTER";
+
+        using SharedResult = std::shared_ptr<const Result>;
+
+        std::pair<T*, SharedResult> local(&value, SharedResult());
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, &local);
+
+        barrier_.wait(
+            [&]() {
+                std::vector<T*> locals(thread_count_);
+                for (size_t i = 0; i < thread_count_; i++) {
+                    locals[i] =
+                        GetLocalShared<std::pair<T*, SharedResult> >(step, i)
+                        ->first;
+                }
+
+                SharedResult shared = std::make_shared<Result>(combine(locals));
+
+                // distribute shared pointer to worker threads
+                for (size_t i = 0; i < thread_count_; i++) {
+                    GetLocalShared<std::pair<T*, SharedResult> >(step, i)
+                    ->second = shared;
+                }
+            });
+
+        LOG << "FCC::LocalCombineShared() EXIT";
+
+        return local.second;
+    }
+
     /*!
      * Gathers the value of a serializable type T over all workers and
      * provides result to all workers as a shared pointer to a
@@ -495,7 +788,16 @@ public:
                 // allocate shared vector of correct final size
                 auto local_gather = std::make_shared<std::vector<T> >(n);
 
-                if (tlx::is_power_of_two(group().num_hosts())) {
+                WaitAsync();
+
+                if (single_host()) {
+                    // the local values are all values
+                    for (size_t i = 0; i < thread_count_; i++) {
+                        local_gather->at(i) =
+                            GetLocalShared<std::pair<T, SharedVectorT> >(step, i)->first;
+                    }
+                }
+                else if (tlx::is_power_of_two(group().num_hosts())) {
                     // gather local values and insert at correct final positions in the vector
                     for (size_t i = 0; i < thread_count_; i++) {
                         local_gather->at(thread_count_ * group_.my_host_rank() + i) =
@@ -567,7 +869,10 @@ public:
                 }
 
                 // global reduce
-                group_.Reduce(local_sum, root / thread_count_, sum_op);
+                if (!single_host()) {
+                    WaitAsync();
+                    group_.Reduce(local_sum, root / thread_count_, sum_op);
+                }
 
                 // set the local value only at the root
                 if (root / thread_count_ == group_.my_host_rank())
@@ -621,7 +926,8 @@ public:
                 }
 
                 // global reduce
-                group_.AllReduce(local_sum, sum_op);
+                WaitAsync();
+                HostAllReduce(local_sum, sum_op);
 
                 // distribute back to local workers
                 for (size_t i = 0; i < thread_count_; i++) {
@@ -637,6 +943,200 @@ public:
         return local;
     }
 
+    /*!
+     * Starts a reduction of a value of a serializable type T over all workers
+     * given a certain reduce function, and returns a future of the result.
+     *
+     * Only the local workers are synchronized, the network part of the
+     * reduction is run by the host's AsyncCollectiveThread, such that the
+     * workers can continue until they need the result. Asynchronous
+     * collectives are completed in the order they were started, and before
+     * any following synchronous collective.
+     *
+     * \param value The value to use for the reduce operation.
+     * \param sum_op The operation to use for calculating the reduced value. The
+     * default operation is a normal addition.
+     * \return A future of the result of the reduce operation.
+     */
+    template <typename T, typename BinarySumOp = std::plus<T> >
+    std::shared_future<T> TLX_ATTRIBUTE_WARN_UNUSED_RESULT
+    AllReduceAsync(const T& value, const BinarySumOp& sum_op = BinarySumOp()) {
+
+        RunTimer run_timer(timer_allreduce_);
+        if (enable_stats || debug) ++count_allreduce_;
+        LOG << "FCC::AllReduceAsync() ENTER count=" << count_allreduce_;
+
+        using Local = std::pair<T, std::shared_future<T> >;
+        Local local(value, std::shared_future<T>());
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, &local);
+
+        barrier_.wait(
+            [&]() {
+                // local reduce
+                T local_sum = GetLocalShared<Local>(step, 0)->first;
+                for (size_t i = 1; i < thread_count_; i++) {
+                    local_sum = sum_op(
+                        local_sum, GetLocalShared<Local>(step, i)->first);
+                }
+
+                // enqueue global reduce
+                auto promise = std::make_shared<std::promise<T> >();
+                std::shared_future<T> future = promise->get_future().share();
+
+                RunAsync(
+                    [this, promise, local_sum, sum_op]() mutable {
+                        try {
+                            HostAllReduce(local_sum, sum_op);
+                            promise->set_value(local_sum);
+                        }
+                        catch (...) {
+                            promise->set_exception(std::current_exception());
+                        }
+                    });
+
+                // distribute future to local workers
+                for (size_t i = 0; i < thread_count_; i++) {
+                    GetLocalShared<Local>(step, i)->second = future;
+                }
+            });
+
+        LOG << "FCC::AllReduceAsync() EXIT count=" << count_allreduce_;
+
+        return local.second;
+    }
+
+    /*!
+     * Starts a broadcast of a value of a serializable type T from the given
+     * worker to all other workers, and returns a future of the value. See
+     * AllReduceAsync() for the ordering of asynchronous collectives.
+     *
+     * \param value The value to broadcast, ignored except on origin.
+     *
+     * \param origin Worker number to broadcast value from.
+     *
+     * \return A future of the value sent by origin.
+     */
+    template <typename T>
+    std::shared_future<T> TLX_ATTRIBUTE_WARN_UNUSED_RESULT
+    BroadcastAsync(const T& value, size_t origin = 0) {
+
+        RunTimer run_timer(timer_broadcast_);
+        if (enable_stats || debug) ++count_broadcast_;
+        LOG << "FCC::BroadcastAsync() ENTER count=" << count_broadcast_;
+
+        using Local = std::pair<T, std::shared_future<T> >;
+        Local local(value, std::shared_future<T>());
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, &local);
+
+        barrier_.wait(
+            [&]() {
+                T host_value =
+                    GetLocalShared<Local>(step, origin % thread_count_)->first;
+                size_t origin_host = origin / thread_count_;
+
+                // enqueue global broadcast
+                auto promise = std::make_shared<std::promise<T> >();
+                std::shared_future<T> future = promise->get_future().share();
+
+                RunAsync(
+                    [this, promise, host_value, origin_host]() mutable {
+                        try {
+                            HostBroadcast(host_value, origin_host);
+                            promise->set_value(host_value);
+                        }
+                        catch (...) {
+                            promise->set_exception(std::current_exception());
+                        }
+                    });
+
+                // distribute future to local workers
+                for (size_t i = 0; i < thread_count_; i++) {
+                    GetLocalShared<Local>(step, i)->second = future;
+                }
+            });
+
+        LOG << "FCC::BroadcastAsync() EXIT count=" << count_broadcast_;
+
+        return local.second;
+    }
+
+    /*!
+     * Starts an exclusive prefix sum over all workers, given a certain sum
+     * operation, and returns a future of the result. See AllReduceAsync() for
+     * the ordering of asynchronous collectives.
+     *
+     * \param value The local value of this worker.
+     * \param sum_op The operation to use for calculating the prefix sum. The
+     * default operation is a normal addition.
+     * \param initial The initial element used on the first worker.
+     * \return A future of the exclusive prefix sum for this worker.
+     */
+    template <typename T, typename BinarySumOp = std::plus<T> >
+    std::shared_future<T> TLX_ATTRIBUTE_WARN_UNUSED_RESULT
+    ExPrefixSumAsync(const T& value, const BinarySumOp& sum_op = BinarySumOp(),
+                     const T& initial = T()) {
+
+        RunTimer run_timer(timer_prefixsum_);
+        if (enable_stats || debug) ++count_prefixsum_;
+        LOG << "FCC::ExPrefixSumAsync() ENTER count=" << count_prefixsum_;
+
+        using Local = std::pair<T, std::shared_future<T> >;
+        Local local(value, std::shared_future<T>());
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, &local);
+
+        barrier_.wait(
+            [&]() {
+                // local inclusive prefix sums
+                std::vector<T> locals;
+                locals.reserve(thread_count_);
+                locals.push_back(GetLocalShared<Local>(step, 0)->first);
+                for (size_t i = 1; i < thread_count_; i++) {
+                    locals.push_back(sum_op(
+                                         locals.back(),
+                                         GetLocalShared<Local>(step, i)->first));
+                }
+
+                // enqueue global prefix sum, one promise per local worker
+                using PromisePtr = std::shared_ptr<std::promise<T> >;
+                std::vector<PromisePtr> promises;
+                for (size_t i = 0; i < thread_count_; i++) {
+                    promises.emplace_back(std::make_shared<std::promise<T> >());
+                    GetLocalShared<Local>(step, i)->second =
+                        promises.back()->get_future().share();
+                }
+
+                RunAsync(
+                    [this, promises, locals, sum_op, initial]() mutable {
+                        std::vector<T> results;
+                        try {
+                            T base_sum = locals.back();
+                            HostExPrefixSum(base_sum, sum_op, initial);
+
+                            results.push_back(base_sum);
+                            for (size_t i = 1; i < locals.size(); i++)
+                                results.push_back(sum_op(base_sum, locals[i - 1]));
+                        }
+                        catch (...) {
+                            for (PromisePtr& p : promises)
+                                p->set_exception(std::current_exception());
+                            return;
+                        }
+                        for (size_t i = 0; i < promises.size(); i++)
+                            promises[i]->set_value(std::move(results[i]));
+                    });
+            });
+
+        LOG << "FCC::ExPrefixSumAsync() EXIT count=" << count_prefixsum_;
+
+        return local.second;
+    }
+
     /*!
      * Collects up to k predecessors of type T from preceding PEs. k must be
      * equal on all PEs.
@@ -675,6 +1175,7 @@ public:
                 shmem_[local_id_].IncCounter();
             }
             else if (host_rank_ + 1 != num_hosts_) {
+                WaitAsync();
                 if (my_values.size() > k) {
                     std::vector<T> send_values_next(my_values.end() - k, my_values.end());
                     group_.SendTo(host_rank_ + 1, send_values_next);
@@ -706,6 +1207,7 @@ public:
                     pre->size() <= k ? pre->begin() : pre->end() - k, pre->end());
             }
             else if (host_rank_ != 0) {
+                WaitAsync();
                 group_.ReceiveFrom(host_rank_ - 1, &result);
             }
         }
@@ -726,6 +1228,7 @@ public:
                     pre->size() <= k ? pre->begin() : pre->end() - k, pre->end());
             }
             else if (host_rank_ != 0) {
+                WaitAsync();
                 group_.ReceiveFrom(host_rank_ - 1, &result);
             }
 
@@ -753,6 +1256,7 @@ public:
                 shmem_[local_id_].IncCounter();
             }
             else if (host_rank_ + 1 != num_hosts_) {
+                WaitAsync();
                 group_.SendTo(host_rank_ + 1, send_values);
                 // increment generation counter for synchronizing
                 shmem_[local_id_].IncCounter();
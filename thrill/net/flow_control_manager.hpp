@@ -13,10 +13,12 @@
 #define THRILL_NET_FLOW_CONTROL_MANAGER_HEADER
 
 #include <thrill/common/config.hpp>
+#include <thrill/common/logger.hpp>
 #include <thrill/common/thread_barrier.hpp>
 #include <thrill/net/flow_control_channel.hpp>
 #include <thrill/net/group.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -45,21 +47,41 @@ private:
     //! Host-global generation counter
     std::atomic<size_t> generation_ { 0 };
 
+    //! Rack assignment for hierarchical collectives, if enabled.
+    std::unique_ptr<HostRacks> racks_;
+
+    //! Background thread for asynchronous collectives, which must be
+    //! destroyed first.
+    AsyncCollectiveThread async_;
+
 public:
     /*!
      * Initializes a certain count of flow control channels.
      *
      * \param group The net group to use for initialization.
      * \param local_worker_count The count of threads to spawn flow channels for.
+     * \param rack_ids Optional rack id of each host, which enables
+     * hierarchical collectives if the racks are contiguous ranges of hosts.
      */
-    FlowControlChannelManager(Group& group, size_t local_worker_count)
+    FlowControlChannelManager(
+        Group& group, size_t local_worker_count,
+        const std::vector<size_t>& rack_ids = std::vector<size_t>())
         : barrier_(local_worker_count),
           shmem_(local_worker_count) {
         assert(shmem_.size() == local_worker_count);
+        if (HostRacks::IsValid(rack_ids, group.num_hosts())) {
+            racks_ = std::make_unique<HostRacks>(group, rack_ids);
+        }
+        else if (!rack_ids.empty()) {
+            LOG1 << "FlowControlChannelManager: rack assignment is not usable"
+                 << " for hierarchical collectives, it must contain one rack"
+                 << " id per host and the racks must be contiguous ranges.";
+        }
         channels_.reserve(local_worker_count);
         for (size_t i = 0; i < local_worker_count; i++) {
             channels_.emplace_back(group, i, local_worker_count,
-                                   barrier_, shmem_.data(), generation_);
+                                   barrier_, shmem_.data(), generation_,
+                                   async_, racks_.get());
         }
     }
 
@@ -17,7 +17,11 @@
 #include <thrill/net/tcp/group.hpp>
 #endif
 
+#include <tlx/math/integer_log2.hpp>
+
 #include <functional>
+#include <iterator>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -49,17 +53,18 @@ std::ostream& operator << (std::ostream& os, const Traffic& t) {
 
 Manager::Manager(std::array<GroupPtr, kGroupCount>&& groups,
                  common::JsonLogger& logger) noexcept
-    : groups_(std::move(groups)), logger_(logger) { }
+    : groups_(std::make_move_iterator(groups.begin()),
+              std::make_move_iterator(groups.end())),
+      logger_(logger) { }
 
 Manager::Manager(std::vector<GroupPtr>&& groups,
                  common::JsonLogger& logger) noexcept
-    : logger_(logger) {
-    assert(groups.size() == kGroupCount);
-    std::move(groups.begin(), groups.end(), groups_.begin());
+    : groups_(std::move(groups)), logger_(logger) {
+    assert(groups_.size() >= kGroupCount);
 }
 
 void Manager::Close() {
-    for (size_t i = 0; i < kGroupCount; i++) {
+    for (size_t i = 0; i < groups_.size(); i++) {
         groups_[i]->Close();
     }
 }
@@ -67,7 +72,7 @@ void Manager::Close() {
 net::Traffic Manager::Traffic() const {
     size_t total_tx = 0, total_rx = 0;
 
-    for (size_t g = 0; g < kGroupCount; ++g) {
+    for (size_t g = 0; g < groups_.size(); ++g) {
         Group& group = *groups_[g];
 
         for (size_t h = 0; h < group.num_hosts(); ++h) {
@@ -94,13 +99,15 @@ void Manager::RunTask(const std::chrono::steady_clock::time_point& tp) {
     size_t total_tx = 0, total_rx = 0;
     size_t prev_total_tx = 0, prev_total_rx = 0;
     size_t total_tx_active = 0, total_rx_active = 0;
+    size_t total_tx_batches = 0, total_tx_batch_pieces = 0;
 
-    for (size_t g = 0; g < kGroupCount; ++g) {
+    for (size_t g = 0; g < groups_.size(); ++g) {
         Group& group = *groups_[g];
 
         size_t group_tx = 0, group_rx = 0;
         size_t prev_group_tx = 0, prev_group_rx = 0;
         size_t group_tx_active = 0, group_rx_active = 0;
+        size_t group_tx_batches = 0, group_tx_batch_pieces = 0;
         std::vector<size_t> tx_per_host(group.num_hosts());
         std::vector<size_t> rx_per_host(group.num_hosts());
 
@@ -124,11 +131,15 @@ void Manager::RunTask(const std::chrono::steady_clock::time_point& tp) {
             group.connection(h).prev_rx_bytes_ = rx;
             group_rx_active += conn.rx_active_;
 
+            group_tx_batches += conn.tx_batches_;
+            group_tx_batch_pieces += conn.tx_batch_pieces_;
+
             tx_per_host[h] = tx;
             rx_per_host[h] = rx;
         }
 
-        line.sub(g == 0 ? "flow" : g == 1 ? "data" : "???")
+        line.sub(g == 0 ? std::string("flow") : g == 1 ? std::string("data")
+                 : "data" + std::to_string(g - kGroupCount + 1))
             << "tx_bytes" << group_tx
             << "rx_bytes" << group_rx
             << "tx_speed"
@@ -136,7 +147,9 @@ void Manager::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << "rx_speed"
             << static_cast<double>(group_rx - prev_group_rx) / elapsed
             << "tx_per_host" << tx_per_host
-            << "rx_per_host" << rx_per_host;
+            << "rx_per_host" << rx_per_host
+            << "tx_batches" << group_tx_batches
+            << "tx_batch_pieces" << group_tx_batch_pieces;
 
         total_tx += group_tx;
         total_rx += group_rx;
@@ -144,6 +157,8 @@ void Manager::RunTask(const std::chrono::steady_clock::time_point& tp) {
         prev_total_rx += prev_group_rx;
         total_tx_active += group_tx_active;
         total_rx_active += group_rx_active;
+        total_tx_batches += group_tx_batches;
+        total_tx_batch_pieces += group_tx_batch_pieces;
 
         tp_last_ = tp;
     }
@@ -157,7 +172,9 @@ void Manager::RunTask(const std::chrono::steady_clock::time_point& tp) {
         << "rx_speed"
         << static_cast<double>(total_rx - prev_total_rx) / elapsed
         << "tx_active" << total_tx_active
-        << "rx_active" << total_rx_active;
+        << "rx_active" << total_rx_active
+        << "tx_batches" << total_tx_batches
+        << "tx_batch_pieces" << total_tx_batch_pieces;
 }
 
 /******************************************************************************/
@@ -167,6 +184,15 @@ size_t Group::num_parallel_async() const {
     return 0;
 }
 
+bool Group::UsePrefixSumPipelined(size_t size) const {
+    // the last host of the chain completes after p - 2 + size / segment
+    // segment transfers, the doubling algorithm after log(p) whole arrays.
+    size_t p = num_hosts();
+    return p >= 2 && size >= kCollectiveSegmentedBytes &&
+           (tlx::integer_log2_ceil(p) - 1) * size >=
+           (p - 2) * kCollectiveSegmentBytes;
+}
+
 /*[[[perl
   for my $e (
     ["int", "Int"], ["unsigned int", "UnsignedInt"],
@@ -23,9 +23,11 @@
 #include <thrill/net/connection.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <functional>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace thrill {
@@ -168,6 +170,29 @@ public:
     template <typename T, typename BinarySumOp = std::plus<T> >
     void PrefixSumHypercube(T& value, BinarySumOp sum_op = BinarySumOp());
 
+    template <typename T, typename Operation>
+    typename std::enable_if<
+        std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+    PrefixSumSelect(
+        std::vector<T>& value,
+        common::ComponentSum<std::vector<T>, Operation> sum_op,
+        const std::vector<T>& initial, bool inclusive = true);
+
+    template <typename T, size_t N, typename Operation>
+    typename std::enable_if<
+        std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+    PrefixSumSelect(
+        std::array<T, N>& value,
+        common::ComponentSum<std::array<T, N>, Operation> sum_op,
+        const std::array<T, N>& initial, bool inclusive = true);
+
+    template <typename T, typename Operation>
+    void PrefixSumPipelined(T* value, size_t size, const Operation& op,
+                            const T* initial, bool inclusive = true);
+
+    //! whether a prefix sum of size bytes is pipelined
+    bool UsePrefixSumPipelined(size_t size) const;
+
     /**************************************************************************/
 
     template <typename T>
@@ -176,9 +201,18 @@ public:
     template <typename T>
     void BroadcastTrivial(T& value, size_t origin = 0);
 
+    template <typename T>
+    typename std::enable_if<
+        std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+    BroadcastSelect(std::vector<T>& value, size_t origin = 0);
+
     template <typename T>
     void BroadcastBinomialTree(T& value, size_t origin = 0);
 
+    template <typename T>
+    void BroadcastBinomialTreePipelined(
+        std::vector<T>& value, size_t origin = 0);
+
     /**************************************************************************/
 
     template <typename T>
@@ -201,9 +235,25 @@ public:
     template <typename T, typename BinarySumOp = std::plus<T> >
     void AllReduceHypercube(T& value, BinarySumOp sum_op = BinarySumOp());
 
+    template <typename T, typename Operation>
+    typename std::enable_if<
+        std::is_pod<T>::value && !std::is_same<T, bool>::value, void>::type
+    AllReduceSelect(
+        std::vector<T>& value,
+        common::ComponentSum<std::vector<T>, Operation> sum_op);
+
     template <typename T, typename BinarySumOp = std::plus<T> >
     void AllReduceElimination(T& value, BinarySumOp sum_op = BinarySumOp());
 
+    template <typename T, typename BinarySumOp>
+    void AllReduceRabenseifner(std::vector<T>& value, BinarySumOp sum_op);
+
+    //! size of segments sent by pipelined and segmented collectives
+    static constexpr size_t kCollectiveSegmentBytes = 64 * 1024;
+
+    //! minimum size of vectors reduced by the segmented AllReduce
+    static constexpr size_t kCollectiveSegmentedBytes = 256 * 1024;
+
     /**************************************************************************/
 
 protected:
@@ -0,0 +1,366 @@
+/*******************************************************************************
+ * thrill/net/ib/dispatcher.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/ib/dispatcher.hpp>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace thrill {
+namespace net {
+namespace ib {
+
+/******************************************************************************/
+// ib::AsyncRdmaWrite
+
+bool AsyncRdmaWrite::operator () () {
+    if (conn_->remote_blocks_.empty() ||
+        conn_->rdma_writes_ >= Connection::kMaxRdmaWrites)
+        return true;
+
+    Connection::RemoteBlock rb = conn_->remote_blocks_.front();
+    conn_->remote_blocks_.pop_front();
+
+    if (rb.size != block_.size())
+        throw Exception(
+                  "ib: RDMA write of Block with size "
+                  + std::to_string(block_.size()) + " into ByteBlock of size "
+                  + std::to_string(rb.size));
+
+    // register the Block's memory only for the duration of the transfer.
+    mr_ = ibv_reg_mr(Device::Get().pd(),
+                     const_cast<uint8_t*>(block_.data_begin()),
+                     block_.size(), 0);
+    if (mr_ == nullptr)
+        throw Exception("ib: error in ibv_reg_mr() of Block", errno);
+
+    ibv_sge sge;
+    sge.addr = reinterpret_cast<uintptr_t>(block_.data_begin());
+    sge.length = static_cast<uint32_t>(block_.size());
+    sge.lkey = mr_->lkey;
+
+    ibv_send_wr wr, * bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = reinterpret_cast<uintptr_t>(this);
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.imm_data = htonl(Connection::ImmBlock);
+    wr.wr.rdma.remote_addr = rb.addr;
+    wr.wr.rdma.rkey = rb.rkey;
+
+    int r = ibv_post_send(conn_->qp_, &wr, &bad_wr);
+    if (r != 0)
+        throw Exception("ib: error in ibv_post_send() of RDMA write", r);
+
+    conn_->rdma_writes_++;
+    conn_->tx_ops_++;
+    conn_->tx_bytes_ += block_.size();
+    return false;
+}
+
+void AsyncRdmaWrite::OnComplete() {
+    ibv_dereg_mr(mr_);
+    mr_ = nullptr;
+
+    done_ = true;
+    conn_->tx_active_--;
+    if (callback_) {
+        callback_(*conn_);
+        callback_ = AsyncWriteCallback();
+    }
+    // release Pin
+    block_.Reset();
+}
+
+/******************************************************************************/
+// ib::AsyncRdmaRead
+
+void AsyncRdmaRead::Start() {
+    mr_ = ibv_reg_mr(Device::Get().pd(), block_->data(), size_,
+                     IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+    if (mr_ == nullptr)
+        throw Exception("ib: error in ibv_reg_mr() of ByteBlock", errno);
+
+    // announce the ByteBlock to the peer
+    Connection::RemoteBlock rb;
+    rb.addr = reinterpret_cast<uintptr_t>(block_->data());
+    rb.rkey = mr_->rkey;
+    rb.size = static_cast<uint32_t>(size_);
+
+    conn_->ctrl_queue_.push_back(rb);
+    conn_->PumpControl();
+}
+
+void AsyncRdmaRead::OnComplete(size_t size) {
+    if (size != size_)
+        throw Exception(
+                  "ib: RDMA write of size " + std::to_string(size)
+                  + " into ByteBlock expecting " + std::to_string(size_));
+
+    ibv_dereg_mr(mr_);
+    mr_ = nullptr;
+
+    done_ = true;
+    conn_->rx_bytes_ += size_;
+    conn_->rx_active_--;
+    if (callback_) {
+        callback_(*conn_, std::move(block_));
+        callback_ = AsyncReadByteBlockCallback();
+    }
+}
+
+/******************************************************************************/
+// ib::Dispatcher
+
+Dispatcher::Dispatcher()
+    : device_(Device::Get()), wc_(64) {
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (event_fd_ < 0)
+        throw Exception("ib: error in eventfd()", errno);
+}
+
+Dispatcher::~Dispatcher() {
+    ::close(event_fd_);
+}
+
+void Dispatcher::AsyncRead(
+    net::Connection& c, uint32_t /* seq */, size_t size,
+    data::PinnedByteBlockPtr&& block,
+    const AsyncReadByteBlockCallback& done_cb) {
+    assert(c.IsValid());
+    assert(dynamic_cast<Connection*>(&c));
+
+    if (size == 0) {
+        if (done_cb) done_cb(c, std::move(block));
+        return;
+    }
+
+    async_rdma_read_.emplace_back(
+        static_cast<Connection&>(c), size, std::move(block), done_cb);
+    async_rdma_read_.back().Start();
+}
+
+void Dispatcher::AsyncWrite(
+    net::Connection& c, uint32_t /* seq */, data::PinnedBlock&& block,
+    const AsyncWriteCallback& done_cb) {
+    assert(c.IsValid());
+    assert(dynamic_cast<Connection*>(&c));
+
+    if (block.size() == 0) {
+        if (done_cb) done_cb(c);
+        return;
+    }
+
+    Connection& ic = static_cast<Connection&>(c);
+
+    // add new RDMA writer object, registered as write callback to keep the
+    // order with Buffers sent before and after the Block.
+    async_rdma_write_.emplace_back(ic, std::move(block), done_cb);
+
+    AsyncRdmaWrite& arw = async_rdma_write_.back();
+    AddWrite(ic, AsyncCallback::make<
+                 AsyncRdmaWrite, &AsyncRdmaWrite::operator ()>(&arw));
+}
+
+bool Dispatcher::PollCompletions() {
+    bool found = false;
+    int n;
+    do {
+        n = ibv_poll_cq(device_.cq(), static_cast<int>(wc_.size()), wc_.data());
+        if (n < 0)
+            throw Exception("ib: error in ibv_poll_cq()");
+
+        for (int i = 0; i < n; ++i)
+            HandleCompletion(wc_[i]);
+
+        found |= (n > 0);
+    } while (static_cast<size_t>(n) == wc_.size());
+
+    return found;
+}
+
+void Dispatcher::HandleCompletion(const ibv_wc& wc) {
+    Connection* c = device_.Find(wc.qp_num);
+    // work request flushed from a destroyed connection
+    if (c == nullptr) return;
+
+    if (wc.status != IBV_WC_SUCCESS)
+        throw Exception(
+                  std::string("ib: work completion error: ")
+                  + ibv_wc_status_str(wc.status) + " on " + c->ToString());
+
+    switch (wc.opcode) {
+    case IBV_WC_SEND: {
+        uint32_t index = static_cast<uint32_t>(wc.wr_id);
+        if (index >= Connection::kRecvSlots + Connection::kSendSlots) {
+            c->ctrl_free_.push_back(index);
+            c->PumpControl();
+        }
+        else {
+            c->send_free_.push_back(index);
+            c->writable_ = true;
+        }
+        break;
+    }
+    case IBV_WC_RDMA_WRITE: {
+        AsyncRdmaWrite* arw = reinterpret_cast<AsyncRdmaWrite*>(wc.wr_id);
+        c->rdma_writes_--;
+        c->writable_ = true;
+        arw->OnComplete();
+        break;
+    }
+    case IBV_WC_RECV: {
+        uint32_t index = static_cast<uint32_t>(wc.wr_id);
+        uint32_t imm = ntohl(wc.imm_data);
+        if (imm == Connection::ImmCts) {
+            // clear-to-send: the peer announced a ByteBlock
+            Connection::RemoteBlock rb;
+            memcpy(&rb, c->slot(index), sizeof(rb));
+            c->PostRecv(index);
+            c->remote_blocks_.push_back(rb);
+            c->writable_ = true;
+        }
+        else {
+            c->recv_ready_.push_back(
+                Connection::RecvSlot { index, wc.byte_len, 0 });
+        }
+        break;
+    }
+    case IBV_WC_RECV_RDMA_WITH_IMM: {
+        // the RDMA write consumed a receive slot without data
+        c->PostRecv(static_cast<uint32_t>(wc.wr_id));
+        // RDMA writes are completed in the order of the announcements
+        for (AsyncRdmaRead& arr : async_rdma_read_) {
+            if (arr.IsDone() || arr.connection() != c) continue;
+            arr.OnComplete(wc.byte_len);
+            return;
+        }
+        throw Exception("ib: RDMA write without announced ByteBlock on "
+                        + c->ToString());
+    }
+    default:
+        LOG1 << "ib::Dispatcher: unexpected work completion opcode "
+             << wc.opcode;
+        break;
+    }
+}
+
+bool Dispatcher::RunCallbacks() {
+    bool progress = false;
+
+    // callbacks may call AddRead() or AddWrite(), which may append to active_
+    for (size_t i = 0; i < active_.size(); ++i) {
+        Connection* cp = device_.Find(active_[i]);
+        if (cp == nullptr) {
+            // connection was destroyed
+            active_.erase(active_.begin() + i--);
+            continue;
+        }
+        Connection& c = *cp;
+
+        // run read callbacks while data remains, each call consumes some.
+        while (!c.read_cb_.empty() && !c.recv_ready_.empty()) {
+            if (!c.read_cb_.front()())
+                c.read_cb_.pop_front();
+            progress = true;
+        }
+
+        // run write callbacks until they cannot post any more messages.
+        while (c.writable_ && !c.write_cb_.empty()) {
+            size_t tx_ops = c.tx_ops_;
+            if (!c.write_cb_.front()()) {
+                c.write_cb_.pop_front();
+                progress = true;
+            }
+            else if (c.tx_ops_ != tx_ops) {
+                progress = true;
+            }
+            else {
+                c.writable_ = false;
+            }
+        }
+    }
+
+    return progress;
+}
+
+void Dispatcher::CleanUp() {
+    while (async_rdma_write_.size() && async_rdma_write_.front().IsDone())
+        async_rdma_write_.pop_front();
+    while (async_rdma_read_.size() && async_rdma_read_.front().IsDone())
+        async_rdma_read_.pop_front();
+}
+
+void Dispatcher::DispatchOne(const std::chrono::milliseconds& timeout) {
+
+    bool progress = PollCompletions();
+    progress |= RunCallbacks();
+    CleanUp();
+
+    if (progress) return;
+
+    // arm the completion channel, and poll again to catch completions which
+    // arrived before arming.
+    int r = ibv_req_notify_cq(device_.cq(), 0);
+    if (r != 0)
+        throw Exception("ib: error in ibv_req_notify_cq()", r);
+
+    if (PollCompletions()) {
+        RunCallbacks();
+        CleanUp();
+        return;
+    }
+
+    struct pollfd fds[2];
+    fds[0].fd = device_.channel()->fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = event_fd_;
+    fds[1].events = POLLIN;
+
+    r = ::poll(fds, 2, static_cast<int>(timeout.count()));
+    if (r < 0) {
+        if (errno == EINTR) return;
+        throw Exception("ib: error in poll()", errno);
+    }
+
+    if (fds[0].revents & POLLIN) {
+        ibv_cq* cq;
+        void* cq_context;
+        if (ibv_get_cq_event(device_.channel(), &cq, &cq_context) == 0)
+            ibv_ack_cq_events(cq, 1);
+    }
+    if (fds[1].revents & POLLIN) {
+        uint64_t value;
+        if (::read(event_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN)
+            throw Exception("ib: error reading eventfd", errno);
+    }
+
+    PollCompletions();
+    RunCallbacks();
+    CleanUp();
+}
+
+void Dispatcher::Interrupt() {
+    uint64_t value = 1;
+    if (::write(event_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN)
+        throw Exception("ib: error writing eventfd", errno);
+}
+
+} // namespace ib
+} // namespace net
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * thrill/net/ib/dispatcher.hpp
+ *
+ * Asynchronous callback dispatcher for the InfiniBand verbs backend. See
+ * group.hpp for more.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_IB_DISPATCHER_HEADER
+#define THRILL_NET_IB_DISPATCHER_HEADER
+
+#include <thrill/common/logger.hpp>
+#include <thrill/data/block.hpp>
+#include <thrill/net/dispatcher.hpp>
+#include <thrill/net/ib/group.hpp>
+
+#include <infiniband/verbs.h>
+
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace ib {
+
+//! \addtogroup net_ib InfiniBand Network API
+//! \ingroup net
+//! \{
+
+/*!
+ * Writer of a Block via RDMA write, registered as write callback of the
+ * connection. It waits for the peer to announce the ByteBlock to receive it,
+ * registers the Block's memory, and posts an RDMA write with immediate data
+ * directly from it. The callback is run when the write is completed.
+ */
+class AsyncRdmaWrite
+{
+public:
+    AsyncRdmaWrite(Connection& conn, data::PinnedBlock&& block,
+                   const AsyncWriteCallback& callback)
+        : conn_(&conn),
+          block_(std::move(block)),
+          callback_(callback) {
+        conn_->tx_active_++;
+    }
+
+    //! non-copyable: delete copy-constructor
+    AsyncRdmaWrite(const AsyncRdmaWrite&) = delete;
+    //! non-copyable: delete assignment operator
+    AsyncRdmaWrite& operator = (const AsyncRdmaWrite&) = delete;
+
+    //! Called as write callback: posts the RDMA write once the peer's ByteBlock
+    //! is known. Returns true while waiting.
+    bool operator () ();
+
+    //! Called when the RDMA write is completed
+    void OnComplete();
+
+    bool IsDone() const { return done_; }
+
+private:
+    //! Connection reference
+    Connection* conn_;
+
+    //! Send block (holds a pin on the underlying ByteBlock)
+    data::PinnedBlock block_;
+
+    //! memory region of the Block while the write is outstanding
+    ibv_mr* mr_ = nullptr;
+
+    //! whether the write was completed
+    bool done_ = false;
+
+    //! functional object to call once data is complete
+    AsyncWriteCallback callback_;
+};
+
+/*!
+ * Reader of a ByteBlock filled by an RDMA write from the peer. It registers the
+ * ByteBlock's memory and sends its address and key to the peer. The callback
+ * is run when the peer signals completion of the write.
+ */
+class AsyncRdmaRead
+{
+public:
+    AsyncRdmaRead(Connection& conn, size_t size,
+                  data::PinnedByteBlockPtr&& block,
+                  const AsyncReadByteBlockCallback& callback)
+        : conn_(&conn), size_(size),
+          block_(std::move(block)),
+          callback_(callback) {
+        conn_->rx_active_++;
+    }
+
+    //! non-copyable: delete copy-constructor
+    AsyncRdmaRead(const AsyncRdmaRead&) = delete;
+    //! non-copyable: delete assignment operator
+    AsyncRdmaRead& operator = (const AsyncRdmaRead&) = delete;
+
+    //! register the ByteBlock and announce it to the peer.
+    void Start();
+
+    //! Called when the peer's RDMA write is completed
+    void OnComplete(size_t size);
+
+    bool IsDone() const { return done_; }
+
+    //! Returns conn_
+    Connection * connection() const { return conn_; }
+
+private:
+    //! Connection reference
+    Connection* conn_;
+
+    //! size of the data to receive
+    size_t size_;
+
+    //! receive block, holds a pin on the underlying ByteBlock
+    data::PinnedByteBlockPtr block_;
+
+    //! memory region of the ByteBlock while the write is outstanding
+    ibv_mr* mr_ = nullptr;
+
+    //! whether the read was completed
+    bool done_ = false;
+
+    //! functional object to call once data is complete
+    AsyncReadByteBlockCallback callback_;
+};
+
+/*!
+ * Dispatcher for ib::Connections. It polls the shared completion queue, runs
+ * the read and write callbacks of connections that can make progress, and
+ * otherwise waits on the completion channel and an eventfd for Interrupt().
+ *
+ * Buffers are read and written via the generic AsyncReadBuffer and
+ * AsyncWriteBuffer objects using RecvOne() and SendOne(), while Blocks are
+ * transferred using RDMA writes by AsyncRdmaWrite and AsyncRdmaRead.
+ */
+class Dispatcher final : public net::Dispatcher
+{
+    static constexpr bool debug = false;
+
+public:
+    //! type for connection readiness callbacks
+    using Callback = AsyncCallback;
+
+    //! constructor
+    Dispatcher();
+
+    //! non-copyable: delete copy-constructor
+    Dispatcher(const Dispatcher&) = delete;
+    //! non-copyable: delete assignment operator
+    Dispatcher& operator = (const Dispatcher&) = delete;
+
+    ~Dispatcher();
+
+    //! Register a buffered read callback, called when data has arrived.
+    void AddRead(net::Connection& c, const Callback& read_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& ic = static_cast<Connection&>(c);
+        ic.read_cb_.emplace_back(read_cb);
+        Watch(ic);
+    }
+
+    //! Register a buffered write callback, called when messages can be sent.
+    void AddWrite(net::Connection& c, const Callback& write_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& ic = static_cast<Connection&>(c);
+        ic.write_cb_.emplace_back(write_cb);
+        ic.writable_ = true;
+        Watch(ic);
+    }
+
+    //! Cancel all callbacks on a given connection.
+    void Cancel(net::Connection& c) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& ic = static_cast<Connection&>(c);
+
+        if (ic.read_cb_.size() == 0 && ic.write_cb_.size() == 0)
+            LOG << "ib::Dispatcher::Cancel() " << ic
+                << " called with no callbacks registered.";
+
+        ic.read_cb_.clear();
+        ic.write_cb_.clear();
+    }
+
+    //! import Buffer reads and writes, which use RecvOne() and SendOne().
+    using net::Dispatcher::AsyncRead;
+    using net::Dispatcher::AsyncWrite;
+
+    //! asynchronously receive a ByteBlock written by the peer via RDMA.
+    void AsyncRead(net::Connection& c, uint32_t seq, size_t size,
+                   data::PinnedByteBlockPtr&& block,
+                   const AsyncReadByteBlockCallback& done_cb) final;
+
+    //! asynchronously RDMA write a Block into the peer's ByteBlock.
+    void AsyncWrite(
+        net::Connection& c, uint32_t seq, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final;
+
+    //! header Buffer and Block are sent as a message and an RDMA write.
+    void AsyncWrite(
+        net::Connection& c, uint32_t seq, Buffer&& buffer,
+        data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        AsyncWrite(c, seq, std::move(buffer));
+        AsyncWrite(c, seq + 1, std::move(block), done_cb);
+    }
+
+    //! Run one iteration of dispatching completions and callbacks.
+    void DispatchOne(const std::chrono::milliseconds& timeout) final;
+
+    //! Interrupt a waiting DispatchOne() via the eventfd
+    void Interrupt() final;
+
+private:
+    //! the shared device
+    Device& device_;
+
+    //! eventfd to wake up a waiting DispatchOne().
+    int event_fd_;
+
+    //! queue pair numbers of connections with registered callbacks, which
+    //! are looked up in the Device in case the connection was destroyed.
+    std::vector<uint32_t> active_;
+
+    //! outstanding RDMA writes
+    std::deque<AsyncRdmaWrite> async_rdma_write_;
+
+    //! outstanding RDMA reads
+    std::deque<AsyncRdmaRead> async_rdma_read_;
+
+    //! buffer for work completions returned by ibv_poll_cq()
+    std::vector<ibv_wc> wc_;
+
+    //! add connection to the active list
+    void Watch(Connection& c) {
+        if (c.watched_) return;
+        c.watched_ = true;
+        active_.push_back(c.qp_->qp_num);
+    }
+
+    //! poll the completion queue, returns true if any completions were found.
+    bool PollCompletions();
+
+    //! process one work completion
+    void HandleCompletion(const ibv_wc& wc);
+
+    //! run read and write callbacks which can make progress, returns true if
+    //! any did.
+    bool RunCallbacks();
+
+    //! remove completed RDMA reads and writes
+    void CleanUp();
+};
+
+//! \}
+
+} // namespace ib
+} // namespace net
+} // namespace thrill
+
+#endif // !THRILL_NET_IB_DISPATCHER_HEADER
+
+/******************************************************************************/
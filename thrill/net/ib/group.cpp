@@ -0,0 +1,595 @@
+/*******************************************************************************
+ * thrill/net/ib/group.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/ib/dispatcher.hpp>
+#include <thrill/net/ib/group.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace ib {
+
+//! mutex for all calls to the MPI library, which is only used to bootstrap.
+static std::mutex g_mutex;
+
+/******************************************************************************/
+// ib::Device
+
+Device& Device::Get() {
+    static Device device;
+    return device;
+}
+
+Device::Device() {
+    int num_devices;
+    ibv_device** list = ibv_get_device_list(&num_devices);
+    if (list == nullptr)
+        throw Exception("ib: error in ibv_get_device_list()", errno);
+
+    const char* env_device = getenv("THRILL_IB_DEVICE");
+
+    ibv_device* device = nullptr;
+    for (int i = 0; i < num_devices; ++i) {
+        if (env_device == nullptr ||
+            strcmp(ibv_get_device_name(list[i]), env_device) == 0) {
+            device = list[i];
+            break;
+        }
+    }
+    if (device == nullptr) {
+        ibv_free_device_list(list);
+        throw Exception(
+                  std::string("ib: no InfiniBand device found")
+                  + (env_device ? std::string(" named ") + env_device : ""));
+    }
+
+    context_ = ibv_open_device(device);
+    ibv_free_device_list(list);
+    if (context_ == nullptr)
+        throw Exception("ib: error in ibv_open_device()", errno);
+
+    if (const char* env_port = getenv("THRILL_IB_PORT"))
+        port_ = static_cast<uint8_t>(atoi(env_port));
+    if (const char* env_gid_index = getenv("THRILL_IB_GID_INDEX"))
+        gid_index_ = atoi(env_gid_index);
+
+    ibv_port_attr port_attr;
+    int r = ibv_query_port(context_, port_, &port_attr);
+    if (r != 0)
+        throw Exception("ib: error in ibv_query_port()", r);
+    if (port_attr.state != IBV_PORT_ACTIVE)
+        throw Exception("ib: port " + std::to_string(port_) + " is not active");
+
+    lid_ = port_attr.lid;
+    mtu_ = port_attr.active_mtu;
+
+    r = ibv_query_gid(context_, port_, gid_index_, &gid_);
+    if (r != 0)
+        throw Exception("ib: error in ibv_query_gid()", r);
+
+    ibv_device_attr device_attr;
+    r = ibv_query_device(context_, &device_attr);
+    if (r != 0)
+        throw Exception("ib: error in ibv_query_device()", r);
+
+    pd_ = ibv_alloc_pd(context_);
+    if (pd_ == nullptr)
+        throw Exception("ib: error in ibv_alloc_pd()", errno);
+
+    channel_ = ibv_create_comp_channel(context_);
+    if (channel_ == nullptr)
+        throw Exception("ib: error in ibv_create_comp_channel()", errno);
+
+    // the dispatcher polls the channel's fd, hence make it non-blocking.
+    int flags = fcntl(channel_->fd, F_GETFL);
+    if (fcntl(channel_->fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        throw Exception("ib: error setting completion channel non-blocking",
+                        errno);
+
+    cq_ = ibv_create_cq(context_, std::min(device_attr.max_cqe, 65536),
+                        nullptr, channel_, 0);
+    if (cq_ == nullptr)
+        throw Exception("ib: error in ibv_create_cq()", errno);
+
+    LOG << "ib::Device() opened " << ibv_get_device_name(context_->device)
+        << " port " << unsigned(port_) << " lid " << lid_;
+}
+
+Device::~Device() {
+    if (cq_) ibv_destroy_cq(cq_);
+    if (channel_) ibv_destroy_comp_channel(channel_);
+    if (pd_) ibv_dealloc_pd(pd_);
+    if (context_) ibv_close_device(context_);
+}
+
+void Device::Register(uint32_t qp_num, Connection* c) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    qps_[qp_num] = c;
+}
+
+void Device::Unregister(uint32_t qp_num) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    qps_.erase(qp_num);
+}
+
+Connection* Device::Find(uint32_t qp_num) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = qps_.find(qp_num);
+    return it != qps_.end() ? it->second : nullptr;
+}
+
+/******************************************************************************/
+// ib::Connection
+
+Connection::~Connection() {
+    if (qp_) {
+        Device::Get().Unregister(qp_->qp_num);
+        ibv_destroy_qp(qp_);
+    }
+    if (mr_) ibv_dereg_mr(mr_);
+    delete[] slots_;
+}
+
+void Connection::Initialize(Group* group, size_t peer) {
+    group_ = group;
+    peer_ = peer;
+
+    Device& device = Device::Get();
+
+    static constexpr size_t num_slots = kRecvSlots + kSendSlots + kCtrlSlots;
+    slots_ = new uint8_t[num_slots * kSlotSize];
+
+    mr_ = ibv_reg_mr(device.pd(), slots_, num_slots * kSlotSize,
+                     IBV_ACCESS_LOCAL_WRITE);
+    if (mr_ == nullptr)
+        throw Exception("ib: error in ibv_reg_mr()", errno);
+
+    ibv_qp_init_attr init_attr;
+    memset(&init_attr, 0, sizeof(init_attr));
+    init_attr.send_cq = device.cq();
+    init_attr.recv_cq = device.cq();
+    init_attr.cap.max_send_wr = kSendSlots + kCtrlSlots + kMaxRdmaWrites;
+    init_attr.cap.max_recv_wr = kRecvSlots;
+    init_attr.cap.max_send_sge = 1;
+    init_attr.cap.max_recv_sge = 1;
+    init_attr.qp_type = IBV_QPT_RC;
+    init_attr.sq_sig_all = 1;
+
+    qp_ = ibv_create_qp(device.pd(), &init_attr);
+    if (qp_ == nullptr)
+        throw Exception("ib: error in ibv_create_qp()", errno);
+
+    device.Register(qp_->qp_num, this);
+
+    ibv_qp_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.qp_state = IBV_QPS_INIT;
+    attr.pkey_index = 0;
+    attr.port_num = device.port();
+    attr.qp_access_flags = IBV_ACCESS_REMOTE_WRITE;
+
+    int r = ibv_modify_qp(
+        qp_, &attr,
+        IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS);
+    if (r != 0)
+        throw Exception("ib: error in ibv_modify_qp() to INIT", r);
+
+    // receives may be posted in INIT state
+    for (uint32_t i = 0; i < kRecvSlots; ++i)
+        PostRecv(i);
+
+    for (uint32_t i = 0; i < kSendSlots; ++i)
+        send_free_.push_back(kRecvSlots + i);
+    for (uint32_t i = 0; i < kCtrlSlots; ++i)
+        ctrl_free_.push_back(kRecvSlots + kSendSlots + i);
+
+    std::random_device rd;
+    psn_ = rd() & 0xFFFFFF;
+}
+
+Connection::Address Connection::local_address() const {
+    Address a;
+    memset(&a, 0, sizeof(a));
+    if (!qp_) return a;
+
+    const Device& device = Device::Get();
+    a.qp_num = qp_->qp_num;
+    a.psn = psn_;
+    a.lid = device.lid();
+    memcpy(a.gid, device.gid().raw, sizeof(a.gid));
+    return a;
+}
+
+void Connection::Connect(const Address& remote) {
+    const Device& device = Device::Get();
+
+    ibv_qp_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.qp_state = IBV_QPS_RTR;
+    attr.path_mtu = device.mtu();
+    attr.dest_qp_num = remote.qp_num;
+    attr.rq_psn = remote.psn;
+    attr.max_dest_rd_atomic = 1;
+    attr.min_rnr_timer = 12;
+    attr.ah_attr.dlid = remote.lid;
+    attr.ah_attr.sl = 0;
+    attr.ah_attr.src_path_bits = 0;
+    attr.ah_attr.port_num = device.port();
+
+    if (remote.lid == 0) {
+        // RoCE fabric: route via GID
+        attr.ah_attr.is_global = 1;
+        memcpy(attr.ah_attr.grh.dgid.raw, remote.gid, sizeof(remote.gid));
+        attr.ah_attr.grh.sgid_index = device.gid_index();
+        attr.ah_attr.grh.hop_limit = 1;
+    }
+
+    int r = ibv_modify_qp(
+        qp_, &attr,
+        IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
+        IBV_QP_RQ_PSN | IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER);
+    if (r != 0)
+        throw Exception("ib: error in ibv_modify_qp() to RTR", r);
+
+    memset(&attr, 0, sizeof(attr));
+    attr.qp_state = IBV_QPS_RTS;
+    attr.timeout = 14;
+    attr.retry_cnt = 7;
+    // retry infinitely if the receiver has no posted receive slot
+    attr.rnr_retry = 7;
+    attr.sq_psn = psn_;
+    attr.max_rd_atomic = 1;
+
+    r = ibv_modify_qp(
+        qp_, &attr,
+        IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+        IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC);
+    if (r != 0)
+        throw Exception("ib: error in ibv_modify_qp() to RTS", r);
+}
+
+std::string Connection::ToString() const {
+    return "peer: " + std::to_string(peer_);
+}
+
+std::ostream& Connection::OutputOstream(std::ostream& os) const {
+    return os << "[ib::Connection"
+              << " peer_=" << peer_
+              << " qp_num=" << (qp_ ? qp_->qp_num : 0)
+              << "]";
+}
+
+void Connection::PostRecv(uint32_t index) {
+    ibv_sge sge;
+    sge.addr = reinterpret_cast<uintptr_t>(slot(index));
+    sge.length = kSlotSize;
+    sge.lkey = mr_->lkey;
+
+    ibv_recv_wr wr, * bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = index;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+
+    int r = ibv_post_recv(qp_, &wr, &bad_wr);
+    if (r != 0)
+        throw Exception("ib: error in ibv_post_recv()", r);
+}
+
+void Connection::PostSend(uint32_t index, size_t size, Imm imm) {
+    ibv_sge sge;
+    sge.addr = reinterpret_cast<uintptr_t>(slot(index));
+    sge.length = static_cast<uint32_t>(size);
+    sge.lkey = mr_->lkey;
+
+    ibv_send_wr wr, * bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = index;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_SEND_WITH_IMM;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.imm_data = htonl(imm);
+
+    int r = ibv_post_send(qp_, &wr, &bad_wr);
+    if (r != 0)
+        throw Exception("ib: error in ibv_post_send()", r);
+}
+
+void Connection::PumpControl() {
+    while (!ctrl_queue_.empty() && !ctrl_free_.empty()) {
+        uint32_t index = ctrl_free_.back();
+        ctrl_free_.pop_back();
+
+        memcpy(slot(index), &ctrl_queue_.front(), sizeof(RemoteBlock));
+        ctrl_queue_.pop_front();
+
+        PostSend(index, sizeof(RemoteBlock), ImmCts);
+    }
+}
+
+ssize_t Connection::SendOne(const void* data, size_t size, Flags /* flags */) {
+    if (send_free_.empty()) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    uint32_t index = send_free_.back();
+    send_free_.pop_back();
+
+    size = std::min(size, kSlotSize);
+    memcpy(slot(index), data, size);
+    PostSend(index, size, ImmData);
+
+    ++tx_ops_;
+    tx_bytes_ += size;
+    return size;
+}
+
+ssize_t Connection::RecvOne(void* out_data, size_t size) {
+    if (recv_ready_.empty()) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    RecvSlot& s = recv_ready_.front();
+    size = std::min(size, static_cast<size_t>(s.size - s.offset));
+    memcpy(out_data, slot(s.index) + s.offset, size);
+    s.offset += static_cast<uint32_t>(size);
+
+    if (s.offset == s.size) {
+        // repost the emptied slot
+        PostRecv(s.index);
+        recv_ready_.pop_front();
+    }
+
+    rx_bytes_ += size;
+    return size;
+}
+
+void Connection::SyncSend(const void* data, size_t size, Flags /* flags */) {
+
+    LOG << "SyncSend()"
+        << " data=" << data
+        << " size=" << size
+        << " peer_=" << peer_;
+
+    std::atomic<bool> done { false };
+    group_->dispatcher().AsyncWrite(
+        *this, /* seq */ 0, Buffer(data, size),
+        [&done](net::Connection&) { done = true; });
+
+    while (!done)
+        std::this_thread::yield();
+}
+
+void Connection::SyncRecv(void* out_data, size_t size) {
+
+    LOG << "SyncRecv()"
+        << " out_data=" << out_data
+        << " size=" << size
+        << " peer_=" << peer_;
+
+    std::atomic<bool> done { false };
+    group_->dispatcher().AsyncRead(
+        *this, /* seq */ 0, size,
+        [out_data, size, &done](net::Connection&, Buffer&& buffer) {
+            assert(buffer.size() == size);
+            std::copy(buffer.begin(), buffer.end(),
+                      reinterpret_cast<uint8_t*>(out_data));
+            done = true;
+        });
+
+    while (!done)
+        std::this_thread::yield();
+}
+
+void Connection::SyncSendRecv(const void* send_data, size_t send_size,
+                              void* recv_data, size_t recv_size) {
+
+    LOG << "SyncSendRecv()"
+        << " send_data=" << send_data
+        << " send_size=" << send_size
+        << " recv_data=" << recv_data
+        << " recv_size=" << recv_size
+        << " peer_=" << peer_;
+
+    std::atomic<unsigned> done { 0 };
+    group_->dispatcher().AsyncWrite(
+        *this, /* seq */ 0, Buffer(send_data, send_size),
+        [&done](net::Connection&) { ++done; });
+    group_->dispatcher().AsyncRead(
+        *this, /* seq */ 0, recv_size,
+        [recv_data, recv_size, &done](net::Connection&, Buffer&& buffer) {
+            assert(buffer.size() == recv_size);
+            std::copy(buffer.begin(), buffer.end(),
+                      reinterpret_cast<uint8_t*>(recv_data));
+            ++done;
+        });
+
+    while (done != 2)
+        std::this_thread::yield();
+}
+
+void Connection::SyncRecvSend(const void* send_data, size_t send_size,
+                              void* recv_data, size_t recv_size) {
+    // both directions are independent queues, hence the order does not matter.
+    SyncSendRecv(send_data, send_size, recv_data, recv_size);
+}
+
+/******************************************************************************/
+// ib::Group
+
+Group::Group(size_t my_rank, size_t group_size, DispatcherThread& dispatcher)
+    : net::Group(my_rank),
+      conns_(group_size),
+      dispatcher_(dispatcher) {
+    // create queue pairs to all peers, if this host is part of the group.
+    if (my_rank >= group_size) return;
+    for (size_t i = 0; i < group_size; ++i) {
+        if (i == my_rank) continue;
+        conns_[i].Initialize(this, i);
+    }
+}
+
+size_t Group::num_parallel_async() const {
+    return 16;
+}
+
+std::unique_ptr<net::Dispatcher> Group::ConstructDispatcher() const {
+    // construct ib::Dispatcher
+    return std::make_unique<Dispatcher>();
+}
+
+void Group::Barrier() {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    int r = MPI_Barrier(MPI_COMM_WORLD);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Barrier()");
+}
+
+/******************************************************************************/
+// ib::Construct
+
+//! atexit() method to deinitialize the MPI library.
+static inline void Deinitialize() {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    MPI_Finalize();
+}
+
+//! run MPI_Init() if not already done (can be called multiple times).
+static inline void Initialize() {
+
+    int flag;
+    int r = MPI_Initialized(&flag);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Initialized()");
+
+    if (!flag) {
+        // fake command line
+        int argc = 1;
+        const char* argv[] = { "thrill", nullptr };
+
+        r = MPI_Init(&argc, reinterpret_cast<char***>(&argv));
+        if (r != MPI_SUCCESS)
+            throw Exception("ib: error during MPI_Init()");
+
+        // register atexit method
+        atexit(&Deinitialize);
+    }
+}
+
+bool Construct(size_t group_size, DispatcherThread& dispatcher,
+               std::unique_ptr<Group>* groups, size_t group_count) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    Initialize();
+
+    int my_rank;
+    int r = MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Comm_rank()");
+
+    int num_mpi_hosts;
+    r = MPI_Comm_size(MPI_COMM_WORLD, &num_mpi_hosts);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Comm_size()");
+
+    if (group_size > static_cast<size_t>(num_mpi_hosts))
+        throw Exception("ib::Construct(): fewer MPI processes than hosts requested.");
+
+    for (size_t i = 0; i < group_count; i++) {
+        groups[i] = std::make_unique<Group>(my_rank, group_size, dispatcher);
+    }
+
+    // exchange addresses of all queue pairs: entry [g][p] of host h is the
+    // queue pair in group g of host h to peer p.
+    size_t per_host = group_count * group_size;
+    std::vector<Connection::Address> local(per_host), remote(
+        per_host * num_mpi_hosts);
+
+    for (size_t g = 0; g < group_count; ++g) {
+        for (size_t p = 0; p < group_size; ++p) {
+            local[g * group_size + p] =
+                static_cast<Connection&>(groups[g]->connection(p))
+                .local_address();
+        }
+    }
+
+    r = MPI_Allgather(
+        local.data(), static_cast<int>(per_host * sizeof(Connection::Address)),
+        MPI_BYTE,
+        remote.data(), static_cast<int>(per_host * sizeof(Connection::Address)),
+        MPI_BYTE, MPI_COMM_WORLD);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Allgather()");
+
+    bool participate = (static_cast<size_t>(my_rank) < group_size);
+
+    for (size_t g = 0; participate && g < group_count; ++g) {
+        for (size_t p = 0; p < group_size; ++p) {
+            if (p == static_cast<size_t>(my_rank)) continue;
+            static_cast<Connection&>(groups[g]->connection(p)).Connect(
+                remote[p * per_host + g * group_size + my_rank]);
+        }
+    }
+
+    // wait for all queue pairs to be ready to receive before sending.
+    r = MPI_Barrier(MPI_COMM_WORLD);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Barrier()");
+
+    return participate;
+}
+
+size_t NumMpiProcesses() {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    Initialize();
+
+    int num_mpi_hosts;
+    int r = MPI_Comm_size(MPI_COMM_WORLD, &num_mpi_hosts);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Comm_size()");
+
+    return static_cast<size_t>(num_mpi_hosts);
+}
+
+size_t MpiRank() {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    Initialize();
+
+    int mpi_rank;
+    int r = MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    if (r != MPI_SUCCESS)
+        throw Exception("ib: error during MPI_Comm_rank()");
+
+    return static_cast<size_t>(mpi_rank);
+}
+
+} // namespace ib
+} // namespace net
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,408 @@
+/*******************************************************************************
+ * thrill/net/ib/group.hpp
+ *
+ * A Thrill network layer implementation which uses InfiniBand verbs to
+ * transmit messages to peers via reliable connected (RC) queue pairs. MPI is
+ * only used to bootstrap the network: to determine the hosts and to exchange
+ * the queue pair addresses.
+ *
+ * Small messages are copied into registered send slots and delivered with
+ * IBV_WR_SEND into receive slots posted by the peer. Blocks are transferred
+ * using a rendezvous protocol: the receiver registers the ByteBlock and sends
+ * its address and key to the sender, which then RDMA writes the payload
+ * directly from the PinnedBlock's memory into it.
+ *
+ * As with the mpi backend, the ib::Group allows only **one Thrill host**
+ * within a system process, since all queue pairs share one completion queue.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_IB_GROUP_HEADER
+#define THRILL_NET_IB_GROUP_HEADER
+
+#include <thrill/mem/allocator.hpp>
+#include <thrill/net/dispatcher_thread.hpp>
+#include <thrill/net/group.hpp>
+
+#include <infiniband/verbs.h>
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace ib {
+
+//! \addtogroup net_ib InfiniBand Network API
+//! \ingroup net
+//! \{
+
+class AsyncRdmaRead;
+class AsyncRdmaWrite;
+class Connection;
+class Dispatcher;
+class Group;
+
+/*!
+ * A derived exception class for errors from the ibverbs library.
+ */
+class Exception : public net::Exception
+{
+public:
+    explicit Exception(const std::string& what)
+        : net::Exception(what) { }
+
+    Exception(const std::string& what, int errno_value)
+        : net::Exception(what, errno_value) { }
+};
+
+/*!
+ * The InfiniBand device resources shared by all ib::Groups of the process: the
+ * opened HCA, its protection domain, and one completion queue with completion
+ * channel for all queue pairs. The device is selected by THRILL_IB_DEVICE
+ * (default: the first one), the port by THRILL_IB_PORT (default: 1), and the
+ * GID index used on RoCE fabrics by THRILL_IB_GID_INDEX (default: 0).
+ */
+class Device
+{
+    static constexpr bool debug = false;
+
+public:
+    //! return the process-wide device, which is opened on first use.
+    static Device& Get();
+
+    //! non-copyable: delete copy-constructor
+    Device(const Device&) = delete;
+    //! non-copyable: delete assignment operator
+    Device& operator = (const Device&) = delete;
+
+    ibv_context * context() const { return context_; }
+    ibv_pd * pd() const { return pd_; }
+    ibv_cq * cq() const { return cq_; }
+    ibv_comp_channel * channel() const { return channel_; }
+
+    //! port number of the HCA used
+    uint8_t port() const { return port_; }
+    //! local id of the port, zero on RoCE fabrics.
+    uint16_t lid() const { return lid_; }
+    //! GID of the port, used for global routing if lid() is zero.
+    const ibv_gid& gid() const { return gid_; }
+    //! GID table index of gid()
+    int gid_index() const { return gid_index_; }
+    //! active MTU of the port
+    ibv_mtu mtu() const { return mtu_; }
+
+    //! register a connection's queue pair for completion dispatching
+    void Register(uint32_t qp_num, Connection* c);
+
+    //! unregister a connection's queue pair
+    void Unregister(uint32_t qp_num);
+
+    //! find the connection of a queue pair, returns nullptr if unknown.
+    Connection * Find(uint32_t qp_num);
+
+private:
+    Device();
+    ~Device();
+
+    ibv_context* context_ = nullptr;
+    ibv_pd* pd_ = nullptr;
+    ibv_comp_channel* channel_ = nullptr;
+    ibv_cq* cq_ = nullptr;
+
+    uint8_t port_ = 1;
+    uint16_t lid_ = 0;
+    ibv_gid gid_;
+    int gid_index_ = 0;
+    ibv_mtu mtu_ = IBV_MTU_1024;
+
+    //! mutex protecting qps_
+    std::mutex mutex_;
+
+    //! map of queue pair numbers to connections
+    std::unordered_map<uint32_t, Connection*> qps_;
+};
+
+/*!
+ * InfiniBand connection to one peer via an RC queue pair. Each connection owns
+ * registered memory for kRecvSlots receive slots, which are always posted, and
+ * for kSendSlots + kCtrlSlots send slots.
+ *
+ * SendOne() and RecvOne() are non-blocking and may only be called from the
+ * ib::Dispatcher's thread; they copy data into and out of the slots. The
+ * synchronous methods enqueue asynchronous operations into the dispatcher and
+ * wait for them, such that all verbs calls are made by one thread.
+ */
+class Connection final : public net::Connection
+{
+    static constexpr bool debug = false;
+
+public:
+    //! size of each registered send and receive slot
+    static constexpr size_t kSlotSize = 64 * 1024;
+    //! number of receive slots, which are all posted to the queue pair.
+    static constexpr size_t kRecvSlots = 32;
+    //! number of send slots for data messages
+    static constexpr size_t kSendSlots = 16;
+    //! number of send slots reserved for rendezvous control messages
+    static constexpr size_t kCtrlSlots = 4;
+    //! maximum number of outstanding RDMA writes
+    static constexpr size_t kMaxRdmaWrites = 16;
+
+    //! immediate data tags distinguishing messages on the queue pair
+    enum Imm : uint32_t {
+        //! data message in a receive slot
+        ImmData = 0,
+        //! clear-to-send control message carrying a RemoteBlock
+        ImmCts = 1,
+        //! RDMA write of a Block into the receiver's ByteBlock completed
+        ImmBlock = 2
+    };
+
+    //! queue pair address exchanged between hosts during construction
+    struct Address {
+        uint32_t qp_num;
+        uint32_t psn;
+        uint16_t lid;
+        uint8_t  gid[16];
+    };
+
+    //! address and key of a registered ByteBlock at the receiver
+    struct RemoteBlock {
+        uint64_t addr;
+        uint32_t rkey;
+        uint32_t size;
+    };
+
+    Connection() = default;
+
+    //! non-copyable: delete copy-constructor
+    Connection(const Connection&) = delete;
+    //! non-copyable: delete assignment operator
+    Connection& operator = (const Connection&) = delete;
+
+    ~Connection();
+
+    //! create the queue pair and register the slots
+    void Initialize(Group* group, size_t peer);
+
+    //! return the address of the queue pair for the remote peer
+    Address local_address() const;
+
+    //! move the queue pair into ready-to-send state connected to the peer.
+    void Connect(const Address& remote);
+
+    //! \name Base Status Functions
+    //! \{
+
+    bool IsValid() const final { return qp_ != nullptr; }
+
+    //! return the peer's rank
+    size_t peer() const { return peer_; }
+
+    std::string ToString() const final;
+
+    std::ostream& OutputOstream(std::ostream& os) const final;
+
+    //! \}
+
+    //! \name Send Functions
+    //! \{
+
+    void SyncSend(
+        const void* data, size_t size, Flags /* flags */ = NoFlags) final;
+
+    //! Non-blocking send of at most kSlotSize bytes, returns -1 with errno
+    //! EAGAIN if no send slot is free.
+    ssize_t SendOne(
+        const void* data, size_t size, Flags /* flags */ = NoFlags) final;
+
+    //! \}
+
+    //! \name Receive Functions
+    //! \{
+
+    void SyncRecv(void* out_data, size_t size) final;
+
+    //! Non-blocking receive from the filled receive slots, returns -1 with
+    //! errno EAGAIN if no data has arrived.
+    ssize_t RecvOne(void* out_data, size_t size) final;
+
+    //! \}
+
+    //! \name Paired SendReceive Methods
+    //! \{
+
+    void SyncSendRecv(const void* send_data, size_t send_size,
+                      void* recv_data, size_t recv_size) final;
+    void SyncRecvSend(const void* send_data, size_t send_size,
+                      void* recv_data, size_t recv_size) final;
+
+    //! \}
+
+private:
+    //! for access to slots, queue pair and callbacks
+    friend class Dispatcher;
+    friend class AsyncRdmaRead;
+    friend class AsyncRdmaWrite;
+
+    //! Group reference
+    Group* group_ = nullptr;
+
+    //! rank of the peer
+    size_t peer_ = 0;
+
+    //! the RC queue pair
+    ibv_qp* qp_ = nullptr;
+
+    //! initial packet sequence number
+    uint32_t psn_ = 0;
+
+    //! memory of all slots: receive, then send, then control slots.
+    uint8_t* slots_ = nullptr;
+
+    //! memory region of slots_
+    ibv_mr* mr_ = nullptr;
+
+    //! a filled receive slot
+    struct RecvSlot {
+        uint32_t index;
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    //! filled receive slots with data messages in arrival order
+    std::deque<RecvSlot> recv_ready_;
+
+    //! free send slots for data messages
+    std::vector<uint32_t> send_free_;
+
+    //! free send slots for control messages
+    std::vector<uint32_t> ctrl_free_;
+
+    //! ByteBlocks announced by the peer, to be filled by RDMA writes.
+    std::deque<RemoteBlock> remote_blocks_;
+
+    //! control messages waiting for a free control slot
+    std::deque<RemoteBlock> ctrl_queue_;
+
+    //! number of outstanding RDMA writes
+    size_t rdma_writes_ = 0;
+
+    //! \name Callbacks managed by ib::Dispatcher
+    //! \{
+
+    std::deque<AsyncCallback, mem::GPoolAllocator<AsyncCallback> >
+    read_cb_, write_cb_;
+
+    //! whether the write callbacks may make progress
+    bool writable_ = false;
+
+    //! number of messages posted by write callbacks, to detect progress
+    size_t tx_ops_ = 0;
+
+    //! whether connection is in the dispatcher's active list
+    bool watched_ = false;
+
+    //! \}
+
+    //! pointer to slot memory
+    uint8_t * slot(size_t index) const { return slots_ + index * kSlotSize; }
+
+    //! post a receive slot to the queue pair
+    void PostRecv(uint32_t index);
+
+    //! post a send slot with immediate data to the queue pair
+    void PostSend(uint32_t index, size_t size, Imm imm);
+
+    //! send queued control messages while control slots are free
+    void PumpControl();
+};
+
+/*!
+ * A net group backed by InfiniBand RC queue pairs. The host ranks are the MPI
+ * ranks, but all data is transmitted using verbs.
+ */
+class Group final : public net::Group
+{
+    static constexpr bool debug = false;
+
+public:
+    //! \name Base Functions
+    //! \{
+
+    //! Initialize a Group for the given size and rank, creates queue pairs
+    //! which are connected by ib::Construct().
+    Group(size_t my_rank, size_t group_size, DispatcherThread& dispatcher);
+
+    //! number of hosts configured.
+    size_t num_hosts() const final { return conns_.size(); }
+
+    //! reference to the main dispatcher thread
+    DispatcherThread& dispatcher() { return dispatcher_; }
+
+    net::Connection& connection(size_t peer) final {
+        assert(peer < conns_.size());
+        return conns_[peer];
+    }
+
+    void Close() final { }
+
+    //! Number of parallel sends or recvs requests supported by net backend
+    size_t num_parallel_async() const final;
+
+    //! Construct a network dispatcher object for the network backend used by
+    //! this group, matching its internal implementation. A dispatcher may be
+    //! shared between groups of the same type.
+    std::unique_ptr<net::Dispatcher> ConstructDispatcher() const final;
+
+    //! run a MPI_Barrier() for synchronization.
+    void Barrier();
+
+    //! \}
+
+private:
+    //! connection objects to remote peers, invalid for my_rank_.
+    std::deque<Connection> conns_;
+
+    //! reference to the main dispatcher thread
+    DispatcherThread& dispatcher_;
+};
+
+/*!
+ * Construct Group which connects to peers using InfiniBand. The hosts are the
+ * processes of the MPI environment, which is also used to exchange the queue
+ * pair addresses. Constructs group_count ib::Group objects at once. Within
+ * each Group this host has its MPI rank.
+ *
+ * As with mpi::Construct(), group_size may be smaller than the number of MPI
+ * processes. Returns true if this Thrill host participates in the Group.
+ */
+bool Construct(size_t group_size, DispatcherThread& dispatcher,
+               std::unique_ptr<Group>* groups, size_t group_count);
+
+/*!
+ * Return the number of MPI processes. This is the maximum group size.
+ */
+size_t NumMpiProcesses();
+
+//! Return the rank of this process in the MPI COMM WORLD.
+size_t MpiRank();
+
+//! \}
+
+} // namespace ib
+} // namespace net
+} // namespace thrill
+
+#endif // !THRILL_NET_IB_GROUP_HEADER
+
+/******************************************************************************/
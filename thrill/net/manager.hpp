@@ -77,7 +77,8 @@ public:
     Manager(std::array<GroupPtr, kGroupCount>&& groups,
             common::JsonLogger& logger) noexcept;
 
-    //! Construct Manager from already initialized net::Groups.
+    //! Construct Manager from already initialized net::Groups. Groups beyond
+    //! kGroupCount are additional connections for the data manager.
     Manager(std::vector<GroupPtr>&& groups,
             common::JsonLogger& logger) noexcept;
 
@@ -91,6 +92,21 @@ public:
         return *groups_[1];
     }
 
+    //! Returns the number of parallel connections per peer of the data
+    //! manager, each one a separate net::Group.
+    size_t num_data_lanes() const {
+        return groups_.size() - kGroupCount + 1;
+    }
+
+    //! Returns all net::Groups of the data manager, starting with
+    //! GetDataGroup().
+    std::vector<Group*> GetDataGroups() {
+        std::vector<Group*> lanes = { groups_[1].get() };
+        for (size_t g = kGroupCount; g < groups_.size(); ++g)
+            lanes.push_back(groups_[g].get());
+        return lanes;
+    }
+
     void Close();
 
     //! calculate overall traffic for final stats
@@ -104,8 +120,9 @@ public:
     //! \}
 
 private:
-    //! The Groups initialized and managed by this Manager.
-    std::array<GroupPtr, kGroupCount> groups_;
+    //! The Groups initialized and managed by this Manager: flow, data, and
+    //! then additional data lanes.
+    std::vector<GroupPtr> groups_;
 
     //! JsonLogger for statistics output
     common::JsonLogger& logger_;
@@ -9,24 +9,224 @@
  ******************************************************************************/
 
 #include <thrill/common/concurrent_bounded_queue.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/net/exception.hpp>
 #include <thrill/net/mock/group.hpp>
 
 #include <tlx/die.hpp>
 #include <tlx/string/hexdump.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
+#include <cstdlib>
 #include <deque>
 #include <map>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace thrill {
 namespace net {
 namespace mock {
 
+/******************************************************************************/
+// mock::NetworkModel
+
+//! parse a non-negative number of microseconds from environment variable
+static bool ParseLatency(const char* name, double* out) {
+    const char* env = getenv(name);
+    if (env == nullptr || *env == 0) return false;
+
+    char* endptr;
+    *out = std::strtod(env, &endptr);
+    if (endptr == nullptr || *endptr != 0 || !(*out >= 0))
+        throw Exception(std::string("environment variable ") + name + "="
+                        + env + " is not a valid latency in microseconds.");
+    return true;
+}
+
+//! parse a bandwidth in bytes per second from environment variable
+static bool ParseBandwidth(const char* name, double* out) {
+    const char* env = getenv(name);
+    if (env == nullptr || *env == 0) return false;
+
+    uint64_t bandwidth;
+    if (!tlx::parse_si_iec_units(env, &bandwidth))
+        throw Exception(std::string("environment variable ") + name + "="
+                        + env + " is not a valid bandwidth in bytes/s.");
+    *out = static_cast<double>(bandwidth);
+    return true;
+}
+
+NetworkModel NetworkModel::FromEnvironment() {
+    NetworkModel m;
+    ParseLatency("THRILL_MOCK_LATENCY", &m.latency_us);
+    ParseBandwidth("THRILL_MOCK_BANDWIDTH", &m.bandwidth);
+
+    const char* env_rack_size = getenv("THRILL_MOCK_RACK_SIZE");
+    if (env_rack_size != nullptr && *env_rack_size != 0) {
+        char* endptr;
+        m.rack_size = std::strtoul(env_rack_size, &endptr, 10);
+        if (endptr == nullptr || *endptr != 0)
+            throw Exception(std::string("environment variable ")
+                            + "THRILL_MOCK_RACK_SIZE=" + env_rack_size
+                            + " is not a valid number of hosts.");
+    }
+
+    if (!ParseLatency("THRILL_MOCK_RACK_LATENCY", &m.rack_latency_us))
+        m.rack_latency_us = m.latency_us;
+    if (!ParseBandwidth("THRILL_MOCK_RACK_BANDWIDTH", &m.rack_bandwidth))
+        m.rack_bandwidth = m.bandwidth;
+    return m;
+}
+
+/******************************************************************************/
+// mock::Network
+
+/*!
+ * Simulated links of a mock network: Send() calculates the delivery time of
+ * a message from the NetworkModel, and a thread hands the message over to the
+ * peer's Connection when it is due. Messages on one link are delivered in
+ * order, since their delivery times are increasing.
+ */
+class Network
+{
+    static constexpr bool debug = false;
+
+    using steady_clock = std::chrono::steady_clock;
+
+public:
+    Network(const NetworkModel& model, std::vector<Group*> groups)
+        : model_(model), groups_(std::move(groups)),
+          link_free_(groups_.size() * groups_.size()) {
+        thread_ = common::CreateThread(
+            [this]() {
+                common::NameThisThread("mock network");
+                Work();
+            });
+    }
+
+    //! non-copyable: delete copy-constructor
+    Network(const Network&) = delete;
+    //! non-copyable: delete assignment operator
+    Network& operator = (const Network&) = delete;
+
+    //! drop undelivered messages and stop the thread
+    ~Network() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            terminate_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    //! enqueue message from host src to tgt with the link's delay
+    void Send(size_t src, size_t tgt, net::Buffer&& msg) {
+        bool remote = model_.rack_size != 0 &&
+                      src / model_.rack_size != tgt / model_.rack_size;
+        double latency_us = remote ? model_.rack_latency_us : model_.latency_us;
+        double bandwidth = remote ? model_.rack_bandwidth : model_.bandwidth;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // the link transmits one message after another
+        steady_clock::time_point& link_free =
+            link_free_[src * groups_.size() + tgt];
+        link_free = std::max(link_free, steady_clock::now());
+        if (bandwidth > 0) {
+            link_free += std::chrono::duration_cast<steady_clock::duration>(
+                std::chrono::duration<double>(msg.size() / bandwidth));
+        }
+        steady_clock::time_point deliver =
+            link_free + std::chrono::duration_cast<steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(latency_us));
+
+        bool earliest = queue_.empty() || deliver < queue_.front().deliver;
+        queue_.emplace_back(deliver, seq_++, src, tgt, std::move(msg));
+        std::push_heap(queue_.begin(), queue_.end());
+        if (earliest) cv_.notify_one();
+    }
+
+    //! forget about a destroyed Group, and drop messages to it
+    void Remove(size_t rank) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        groups_[rank] = nullptr;
+    }
+
+private:
+    //! a message in transfer
+    struct Packet {
+        steady_clock::time_point deliver;
+        //! sequence number to break ties in FIFO order
+        size_t seq;
+        size_t src, tgt;
+        net::Buffer msg;
+
+        Packet(steady_clock::time_point _deliver, size_t _seq,
+               size_t _src, size_t _tgt, net::Buffer&& _msg)
+            : deliver(_deliver), seq(_seq), src(_src), tgt(_tgt),
+              msg(std::move(_msg)) { }
+
+        //! reversed order, such that the heap's top is the earliest
+        bool operator < (const Packet& b) const {
+            return deliver != b.deliver ? deliver > b.deliver : seq > b.seq;
+        }
+    };
+
+    NetworkModel model_;
+
+    //! Groups of the mesh by rank, nullptr if destroyed
+    std::vector<Group*> groups_;
+
+    //! time when each directed link finished transmitting its last message
+    std::vector<steady_clock::time_point> link_free_;
+
+    //! heap of messages in transfer
+    std::vector<Packet> queue_;
+
+    //! next sequence number
+    size_t seq_ = 0;
+
+    //! lock for the queue, links, and groups
+    std::mutex mutex_;
+
+    //! signaled on earlier messages and termination
+    std::condition_variable cv_;
+
+    bool terminate_ = false;
+
+    //! delivery thread
+    std::thread thread_;
+
+    //! deliver due messages until terminated
+    void Work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!terminate_) {
+            if (queue_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            if (steady_clock::now() < queue_.front().deliver) {
+                cv_.wait_until(lock, queue_.front().deliver);
+                continue;
+            }
+
+            std::pop_heap(queue_.begin(), queue_.end());
+            Packet p = std::move(queue_.back());
+            queue_.pop_back();
+
+            // deliver while holding the lock, such that the Group stays alive
+            if (Group* g = groups_[p.tgt])
+                g->conns_[p.src].InboundMsg(std::move(p.msg));
+        }
+    }
+};
+
 /******************************************************************************/
 // mock::Connection
 
@@ -139,6 +339,7 @@ Group::Group(size_t my_rank, size_t group_size)
 }
 
 Group::~Group() {
+    if (network_) network_->Remove(my_rank_);
     delete[] conns_;
 }
 
@@ -160,6 +361,11 @@ std::unique_ptr<net::Dispatcher> Group::ConstructDispatcher() const {
 
 std::vector<std::unique_ptr<Group> >
 Group::ConstructLoopbackMesh(size_t num_hosts) {
+    return ConstructLoopbackMesh(num_hosts, NetworkModel::FromEnvironment());
+}
+
+std::vector<std::unique_ptr<Group> >
+Group::ConstructLoopbackMesh(size_t num_hosts, const NetworkModel& model) {
 
     std::vector<std::unique_ptr<Group> > groups(num_hosts);
 
@@ -175,6 +381,18 @@ Group::ConstructLoopbackMesh(size_t num_hosts) {
         }
     }
 
+    // and simulate the links, if the model delays messages
+    if (model.enabled()) {
+        std::vector<Group*> list;
+        for (size_t i = 0; i < groups.size(); ++i)
+            list.push_back(groups[i].get());
+
+        std::shared_ptr<Network> network =
+            std::make_shared<Network>(model, std::move(list));
+        for (size_t i = 0; i < groups.size(); ++i)
+            groups[i]->network_ = network;
+    }
+
     return groups;
 }
 
@@ -193,7 +411,10 @@ void Group::Send(size_t tgt, net::Buffer&& msg) {
              << "msg" << MaybeHexdump(msg.data(), msg.size());
     }
 
-    peers_[tgt]->conns_[my_rank_].InboundMsg(std::move(msg));
+    if (network_)
+        network_->Send(my_rank_, tgt, std::move(msg));
+    else
+        peers_[tgt]->conns_[my_rank_].InboundMsg(std::move(msg));
 }
 
 /******************************************************************************/
@@ -19,6 +19,7 @@
 #include <thrill/net/dispatcher.hpp>
 #include <thrill/net/group.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,42 @@ namespace mock {
 
 class Group;
 class Dispatcher;
+class Network;
+
+/*!
+ * Simulated links of a mock network, for predicting the scaling of jobs with
+ * local runs. Each directed link between two hosts transmits its messages one
+ * after another at the bandwidth, and delivers them after the latency. Links
+ * between hosts in different racks of rack_size consecutive hosts use the
+ * rack_ parameters instead.
+ */
+struct NetworkModel {
+    //! latency of a link in microseconds
+    double latency_us = 0;
+    //! bandwidth of a link in bytes per second, zero is unlimited
+    double bandwidth = 0;
+    //! number of consecutive hosts per rack, zero means one rack
+    size_t rack_size = 0;
+    //! latency of a link between racks in microseconds
+    double rack_latency_us = 0;
+    //! bandwidth of a link between racks in bytes per second
+    double rack_bandwidth = 0;
+
+    //! whether messages are delayed at all
+    bool enabled() const {
+        return latency_us > 0 || bandwidth > 0 ||
+               (rack_size != 0 && (rack_latency_us > 0 || rack_bandwidth > 0));
+    }
+
+    /*!
+     * Read the model from THRILL_MOCK_LATENCY and THRILL_MOCK_RACK_LATENCY in
+     * microseconds, THRILL_MOCK_BANDWIDTH and THRILL_MOCK_RACK_BANDWIDTH in
+     * bytes per second with SI or IEC units (e.g. 1G or 100Mi), and
+     * THRILL_MOCK_RACK_SIZE. The rack links default to the others. Throws an
+     * Exception on invalid values.
+     */
+    static NetworkModel FromEnvironment();
+};
 
 /*!
  * A virtual connection through the mock network: each Group has p Connections
@@ -141,11 +178,19 @@ public:
 
     /*!
      * Construct a mock network with num_hosts peers and deliver Group contexts
-     * for each of them.
+     * for each of them. The links are simulated with the NetworkModel read
+     * from the environment.
      */
     static std::vector<std::unique_ptr<Group> > ConstructLoopbackMesh(
         size_t num_hosts);
 
+    /*!
+     * Construct a mock network with num_hosts peers whose links are simulated
+     * by the model, and deliver Group contexts for each of them.
+     */
+    static std::vector<std::unique_ptr<Group> > ConstructLoopbackMesh(
+        size_t num_hosts, const NetworkModel& model);
+
     //! return hexdump or just [data] if not debugging
     static std::string MaybeHexdump(const void* data, size_t size);
 
@@ -156,11 +201,18 @@ private:
     //! vector of virtual connection objects to remote peers
     Connection* conns_;
 
+    //! simulated links delaying messages, shared by the Groups of the mesh, or
+    //! nullptr if messages are delivered instantly.
+    std::shared_ptr<Network> network_;
+
     //! Send a buffer to peer tgt. Blocking, ... sort of.
     void Send(size_t tgt, net::Buffer&& msg);
 
     //! for access to Send()
     friend class Connection;
+
+    //! for delivery of delayed messages
+    friend class Network;
 };
 
 /*!
@@ -60,13 +60,12 @@ Dispatcher::~Dispatcher() {
 
 MPI_Request Dispatcher::ISend(
     Connection& c, uint32_t seq, const void* data, size_t size) {
-    // lock the GMLIM
-    std::unique_lock<std::mutex> lock(g_mutex);
+    // the caller holds the GMLIM
 
     MPI_Request request;
     int r = MPI_Isend(const_cast<void*>(data), static_cast<int>(size), MPI_BYTE,
                       c.peer(), static_cast<int>(seq),
-                      MPI_COMM_WORLD, &request);
+                      c.comm(), &request);
 
     if (r != MPI_SUCCESS)
         throw Exception("Error during MPI_Isend()", r);
@@ -82,13 +81,12 @@ MPI_Request Dispatcher::ISend(
 
 MPI_Request Dispatcher::IRecv(
     Connection& c, uint32_t seq, void* data, size_t size) {
-    // lock the GMLIM
-    std::unique_lock<std::mutex> lock(g_mutex);
+    // the caller holds the GMLIM
 
     MPI_Request request;
     int r = MPI_Irecv(data, static_cast<int>(size), MPI_BYTE,
                       c.peer(), static_cast<int>(seq),
-                      MPI_COMM_WORLD, &request);
+                      c.comm(), &request);
 
     if (r != MPI_SUCCESS)
         throw Exception("Error during MPI_Irecv()", r);
@@ -122,6 +120,7 @@ void Dispatcher::QueueAsyncSend(net::Connection& c, MpiAsync&& a) {
     int peer = mpic->peer();
     if (send_active_[peer] < g_simultaneous) {
         // perform immediately
+        std::unique_lock<std::mutex> lock(g_mutex);
         PerformAsync(std::move(a));
     }
     else {
@@ -130,6 +129,7 @@ void Dispatcher::QueueAsyncSend(net::Connection& c, MpiAsync&& a) {
 #else
     tlx::unused(c);
     // perform immediately
+    std::unique_lock<std::mutex> lock(g_mutex);
     PerformAsync(std::move(a));
 #endif
 }
@@ -143,6 +143,7 @@ void Dispatcher::QueueAsyncRecv(net::Connection& c, MpiAsync&& a) {
 
     if (recv_active_[peer] < g_simultaneous) {
         // perform immediately
+        std::unique_lock<std::mutex> lock(g_mutex);
         PerformAsync(std::move(a));
     }
     else {
@@ -151,6 +152,7 @@ void Dispatcher::QueueAsyncRecv(net::Connection& c, MpiAsync&& a) {
 #else
     tlx::unused(c);
     // perform immediately
+    std::unique_lock<std::mutex> lock(g_mutex);
     PerformAsync(std::move(a));
 #endif
 }
@@ -342,7 +344,8 @@ void Dispatcher::DispatchOne(const std::chrono::milliseconds& /* timeout */) {
                             send_active_[peer]--;
                             LOG << "DispatchOne() send_active_[" << peer << "]="
                                 << send_active_[peer];
-                            PumpSendQueue(peer);
+                            if (!send_queue_[peer].empty())
+                                pump_send_.push_back(peer);
                         }
                         else if (a_type == MpiAsync::READ_BUFFER ||
                                  a_type == MpiAsync::READ_BYTE_BLOCK)
@@ -351,7 +354,8 @@ void Dispatcher::DispatchOne(const std::chrono::milliseconds& /* timeout */) {
                             recv_active_[peer]--;
                             LOG << "DispatchOne() recv_active_[" << peer << "]="
                                 << recv_active_[peer];
-                            PumpRecvQueue(peer);
+                            if (!recv_queue_[peer].empty())
+                                pump_recv_.push_back(peer);
                         }
 #endif
                         // skip over finished request
@@ -372,6 +376,22 @@ void Dispatcher::DispatchOne(const std::chrono::milliseconds& /* timeout */) {
                 mpi_async_out_.resize(out);
                 mpi_status_out_.resize(out);
             }
+
+#if THRILL_NET_MPI_QUEUES
+            // issue all waiting requests of the peers which got free slots
+            // while holding the GMLIM only once.
+            if (!pump_send_.empty() || !pump_recv_.empty()) {
+                lock.lock();
+                for (int peer : pump_send_)
+                    PumpSendQueue(peer);
+                for (int peer : pump_recv_)
+                    PumpRecvQueue(peer);
+                lock.unlock();
+
+                pump_send_.clear();
+                pump_recv_.clear();
+            }
+#endif
         }
 #else
         int out_index = 0, out_flag = 0;
@@ -430,7 +450,9 @@ void Dispatcher::DispatchOne(const std::chrono::milliseconds& /* timeout */) {
                 send_active_[peer]--;
                 LOG << "DispatchOne() send_active_[" << peer << "]="
                     << send_active_[peer];
+                lock.lock();
                 PumpSendQueue(peer);
+                lock.unlock();
             }
             else if (a_type == MpiAsync::READ_BUFFER ||
                      a_type == MpiAsync::READ_BYTE_BLOCK)
@@ -439,7 +461,9 @@ void Dispatcher::DispatchOne(const std::chrono::milliseconds& /* timeout */) {
                 recv_active_[peer]--;
                 LOG << "DispatchOne() recv_active_[" << peer << "]="
                     << recv_active_[peer];
+                lock.lock();
                 PumpRecvQueue(peer);
+                lock.unlock();
             }
 #endif
         }
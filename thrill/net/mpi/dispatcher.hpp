@@ -138,8 +138,12 @@ public:
         watch_active_--;
     }
 
+    //! Post MPI_Isend() on the Connection's communicator, the caller must hold
+    //! the GMLIM.
     MPI_Request ISend(
         Connection& c, uint32_t seq, const void* data, size_t size);
+    //! Post MPI_Irecv() on the Connection's communicator, the caller must hold
+    //! the GMLIM.
     MPI_Request IRecv(
         Connection& c, uint32_t seq, void* data, size_t size);
 
@@ -172,6 +176,15 @@ public:
         QueueAsyncSend(c, MpiAsync(c, seq, std::move(block), done_cb));
     }
 
+    void AsyncWrite(
+        net::Connection& c, uint32_t seq, Buffer&& buffer,
+        data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        // MPI sends header and block as separate messages.
+        AsyncWrite(c, seq, std::move(buffer));
+        AsyncWrite(c, seq + 1, std::move(block), done_cb);
+    }
+
     void AsyncRead(net::Connection& c, uint32_t seq, size_t size,
                    const AsyncReadBufferCallback& done_cb
                        = AsyncReadBufferCallback()) final {
@@ -205,13 +218,16 @@ public:
     //! Enqueue and run the encapsulated result
     void QueueAsyncRecv(net::Connection& c, MpiAsync&& a);
 
-    //! Issue the encapsulated request to the MPI layer
+    //! Issue the encapsulated request to the MPI layer, the caller must hold
+    //! the GMLIM.
     void PerformAsync(MpiAsync&& a);
 
-    //! Check send queue and perform waiting requests
+    //! Check send queue and perform waiting requests, the caller must hold the
+    //! GMLIM.
     void PumpSendQueue(int peer);
 
-    //! Check recv queue and perform waiting requests
+    //! Check recv queue and perform waiting requests, the caller must hold the
+    //! GMLIM.
     void PumpRecvQueue(int peer);
 
     //! Run one iteration of dispatching using MPI_Iprobe().
@@ -435,6 +451,12 @@ private:
 
     //! number of active requests
     std::vector<size_t> recv_active_;
+
+    //! peers whose send queues are pumped after processing MPI_Testsome()
+    std::vector<int> pump_send_;
+
+    //! peers whose recv queues are pumped after processing MPI_Testsome()
+    std::vector<int> pump_recv_;
 #endif
 };
 
@@ -47,6 +47,10 @@ std::string Connection::ToString() const {
     return "peer: " + std::to_string(peer_);
 }
 
+MPI_Comm Connection::comm() const {
+    return group_->comm();
+}
+
 std::ostream& Connection::OutputOstream(std::ostream& os) const {
     return os << "[mpi::Connection"
               << " group_tag_=" << group_->group_tag()
@@ -70,8 +74,10 @@ void Connection::SyncSend(const void* data, size_t size, Flags /* flags */) {
 
             auto& disp = static_cast<mpi::Dispatcher&>(dispatcher);
 
+            std::unique_lock<std::mutex> lock(g_mutex);
             MPI_Request request =
                 disp.ISend(*this, /* seq */ 0, data, size);
+            lock.unlock();
 
             disp.AddAsyncRequest(
                 request, [&done](MPI_Status&) { done = true; });
@@ -99,8 +105,10 @@ void Connection::SyncRecv(void* out_data, size_t size) {
 
             auto& disp = static_cast<mpi::Dispatcher&>(dispatcher);
 
+            std::unique_lock<std::mutex> lock(g_mutex);
             MPI_Request request =
                 disp.IRecv(*this, /* seq */ 0, out_data, size);
+            lock.unlock();
 
             disp.AddAsyncRequest(
                 request, [&done, size](MPI_Status& status) {
@@ -141,12 +149,16 @@ void Connection::SyncSendRecv(const void* send_data, size_t send_size,
         [=, &done](net::Dispatcher& dispatcher) {
             auto& disp = static_cast<mpi::Dispatcher&>(dispatcher);
 
+            std::unique_lock<std::mutex> lock(g_mutex);
+
             MPI_Request send_request =
                 disp.ISend(*this, /* seq */ 0, send_data, send_size);
 
             MPI_Request recv_request =
                 disp.IRecv(*this, /* seq */ 0, recv_data, recv_size);
 
+            lock.unlock();
+
             disp.AddAsyncRequest(
                 send_request, [&done](MPI_Status&) { ++done; });
             disp.AddAsyncRequest(
@@ -178,6 +190,15 @@ void Connection::SyncRecvSend(const void* send_data, size_t send_size,
 /******************************************************************************/
 // mpi::Group
 
+Group::~Group() {
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    int flag;
+    int r = MPI_Finalized(&flag);
+    if (r == MPI_SUCCESS && !flag)
+        MPI_Comm_free(&comm_);
+}
+
 size_t Group::num_parallel_async() const {
     return 16;
 }
@@ -195,7 +216,7 @@ void Group::Barrier() {
             std::unique_lock<std::mutex> lock(g_mutex);
 
             MPI_Request request;
-            int r = MPI_Ibarrier(MPI_COMM_WORLD, &request);
+            int r = MPI_Ibarrier(comm_, &request);
             if (r != MPI_SUCCESS)
                 throw Exception("Error during MPI_Barrier()", r);
 
@@ -252,7 +273,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "    WaitForRequest(\n";
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,\n";
-    print "                             MPI_SUM, MPI_COMM_WORLD, &request);\n";
+    print "                             MPI_SUM, comm_, &request);\n";
     print "        });\n";
     print "    value += initial;\n";
     print "}\n";
@@ -262,7 +283,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "    WaitForRequest(\n";
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_$$e[2],\n";
-    print "                               MPI_SUM, MPI_COMM_WORLD, &request);\n";
+    print "                               MPI_SUM, comm_, &request);\n";
     print "        });\n";
     print "    value = (my_rank_ == 0 ? initial : value + initial);\n";
     print "}\n";
@@ -272,7 +293,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "    WaitForRequest(\n";
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Ibcast(&value, 1, MPI_$$e[2], origin,\n";
-    print "                              MPI_COMM_WORLD, &request);\n";
+    print "                              comm_, &request);\n";
     print "        });\n";
     print "}\n";
 
@@ -282,7 +303,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Iallreduce(\n";
     print "                MPI_IN_PLACE, &value, 1, MPI_$$e[2],\n";
-    print "                MPI_SUM, MPI_COMM_WORLD, &request);\n";
+    print "                MPI_SUM, comm_, &request);\n";
     print "        });\n";
     print "}\n";
 
@@ -292,7 +313,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Iallreduce(\n";
     print "                MPI_IN_PLACE, &value, 1, MPI_$$e[2],\n";
-    print "                MPI_MIN, MPI_COMM_WORLD, &request);\n";
+    print "                MPI_MIN, comm_, &request);\n";
     print "        });\n";
     print "}\n";
 
@@ -302,7 +323,7 @@ void Group::WaitForRequest(MpiCall call) {
     print "        [&](MPI_Request& request) {\n";
     print "            return MPI_Iallreduce(\n";
     print "                MPI_IN_PLACE, &value, 1, MPI_$$e[2],\n";
-    print "                 MPI_MAX, MPI_COMM_WORLD, &request);\n";
+    print "                 MPI_MAX, comm_, &request);\n";
     print "        });\n";
     print "}\n";
   }
@@ -312,7 +333,7 @@ void Group::PrefixSumPlusInt(int& value, const int& initial) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -321,7 +342,7 @@ void Group::ExPrefixSumPlusInt(int& value, const int& initial) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -330,7 +351,7 @@ void Group::BroadcastInt(int& value, size_t origin) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_INT, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusInt(int& value) {
@@ -339,7 +360,7 @@ void Group::AllReducePlusInt(int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_INT,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumInt(int& value) {
@@ -348,7 +369,7 @@ void Group::AllReduceMinimumInt(int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_INT,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumInt(int& value) {
@@ -357,7 +378,7 @@ void Group::AllReduceMaximumInt(int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_INT,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 void Group::PrefixSumPlusUnsignedInt(unsigned int& value, const unsigned int& initial) {
@@ -365,7 +386,7 @@ void Group::PrefixSumPlusUnsignedInt(unsigned int& value, const unsigned int& in
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -374,7 +395,7 @@ void Group::ExPrefixSumPlusUnsignedInt(unsigned int& value, const unsigned int&
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_UNSIGNED,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -383,7 +404,7 @@ void Group::BroadcastUnsignedInt(unsigned int& value, size_t origin) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_UNSIGNED, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusUnsignedInt(unsigned int& value) {
@@ -392,7 +413,7 @@ void Group::AllReducePlusUnsignedInt(unsigned int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumUnsignedInt(unsigned int& value) {
@@ -401,7 +422,7 @@ void Group::AllReduceMinimumUnsignedInt(unsigned int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumUnsignedInt(unsigned int& value) {
@@ -410,7 +431,7 @@ void Group::AllReduceMaximumUnsignedInt(unsigned int& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 void Group::PrefixSumPlusLong(long& value, const long& initial) {
@@ -418,7 +439,7 @@ void Group::PrefixSumPlusLong(long& value, const long& initial) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -427,7 +448,7 @@ void Group::ExPrefixSumPlusLong(long& value, const long& initial) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_LONG,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -436,7 +457,7 @@ void Group::BroadcastLong(long& value, size_t origin) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_LONG, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusLong(long& value) {
@@ -445,7 +466,7 @@ void Group::AllReducePlusLong(long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumLong(long& value) {
@@ -454,7 +475,7 @@ void Group::AllReduceMinimumLong(long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumLong(long& value) {
@@ -463,7 +484,7 @@ void Group::AllReduceMaximumLong(long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 void Group::PrefixSumPlusUnsignedLong(unsigned long& value, const unsigned long& initial) {
@@ -471,7 +492,7 @@ void Group::PrefixSumPlusUnsignedLong(unsigned long& value, const unsigned long&
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -480,7 +501,7 @@ void Group::ExPrefixSumPlusUnsignedLong(unsigned long& value, const unsigned lon
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -489,7 +510,7 @@ void Group::BroadcastUnsignedLong(unsigned long& value, size_t origin) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_UNSIGNED_LONG, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusUnsignedLong(unsigned long& value) {
@@ -498,7 +519,7 @@ void Group::AllReducePlusUnsignedLong(unsigned long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumUnsignedLong(unsigned long& value) {
@@ -507,7 +528,7 @@ void Group::AllReduceMinimumUnsignedLong(unsigned long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumUnsignedLong(unsigned long& value) {
@@ -516,7 +537,7 @@ void Group::AllReduceMaximumUnsignedLong(unsigned long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 void Group::PrefixSumPlusLongLong(long long& value, const long long& initial) {
@@ -524,7 +545,7 @@ void Group::PrefixSumPlusLongLong(long long& value, const long long& initial) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -533,7 +554,7 @@ void Group::ExPrefixSumPlusLongLong(long long& value, const long long& initial)
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_LONG_LONG,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -542,7 +563,7 @@ void Group::BroadcastLongLong(long long& value, size_t origin) {
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_LONG_LONG, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusLongLong(long long& value) {
@@ -551,7 +572,7 @@ void Group::AllReducePlusLongLong(long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG_LONG,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumLongLong(long long& value) {
@@ -560,7 +581,7 @@ void Group::AllReduceMinimumLongLong(long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG_LONG,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumLongLong(long long& value) {
@@ -569,7 +590,7 @@ void Group::AllReduceMaximumLongLong(long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_LONG_LONG,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 void Group::PrefixSumPlusUnsignedLongLong(unsigned long long& value, const unsigned long long& initial) {
@@ -577,7 +598,7 @@ void Group::PrefixSumPlusUnsignedLongLong(unsigned long long& value, const unsig
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iscan(MPI_IN_PLACE, &value, 1, MPI_INT,
-                             MPI_SUM, MPI_COMM_WORLD, &request);
+                             MPI_SUM, comm_, &request);
         });
     value += initial;
 }
@@ -586,7 +607,7 @@ void Group::ExPrefixSumPlusUnsignedLongLong(unsigned long long& value, const uns
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Iexscan(MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG_LONG,
-                               MPI_SUM, MPI_COMM_WORLD, &request);
+                               MPI_SUM, comm_, &request);
         });
     value = (my_rank_ == 0 ? initial : value + initial);
 }
@@ -595,7 +616,7 @@ void Group::BroadcastUnsignedLongLong(unsigned long long& value, size_t origin)
     WaitForRequest(
         [&](MPI_Request& request) {
             return MPI_Ibcast(&value, 1, MPI_UNSIGNED_LONG_LONG, origin,
-                              MPI_COMM_WORLD, &request);
+                              comm_, &request);
         });
 }
 void Group::AllReducePlusUnsignedLongLong(unsigned long long& value) {
@@ -604,7 +625,7 @@ void Group::AllReducePlusUnsignedLongLong(unsigned long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG_LONG,
-                MPI_SUM, MPI_COMM_WORLD, &request);
+                MPI_SUM, comm_, &request);
         });
 }
 void Group::AllReduceMinimumUnsignedLongLong(unsigned long long& value) {
@@ -613,7 +634,7 @@ void Group::AllReduceMinimumUnsignedLongLong(unsigned long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG_LONG,
-                MPI_MIN, MPI_COMM_WORLD, &request);
+                MPI_MIN, comm_, &request);
         });
 }
 void Group::AllReduceMaximumUnsignedLongLong(unsigned long long& value) {
@@ -622,7 +643,7 @@ void Group::AllReduceMaximumUnsignedLongLong(unsigned long long& value) {
         [&](MPI_Request& request) {
             return MPI_Iallreduce(
                 MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG_LONG,
-                MPI_MAX, MPI_COMM_WORLD, &request);
+                MPI_MAX, comm_, &request);
         });
 }
 // [[[end]]]
@@ -667,8 +688,8 @@ static inline void Initialize() {
 /*!
  * Construct Group which connects to peers using MPI. As the MPI environment
  * already defines the connections, no hosts or parameters can be
- * given. Constructs group_count mpi::Group objects at once. Within each Group
- * this host has its MPI rank.
+ * given. Constructs group_count mpi::Group objects at once, each with its own
+ * MPI communicator. Within each Group this host has its MPI rank.
  *
  * Returns true if this Thrill host participates in the Group.
  */
@@ -692,7 +713,14 @@ bool Construct(size_t group_size, DispatcherThread& dispatcher,
         throw Exception("mpi::Construct(): fewer MPI processes than hosts requested.");
 
     for (size_t i = 0; i < group_count; i++) {
-        groups[i] = std::make_unique<Group>(my_rank, i, group_size, dispatcher);
+        // a communicator per Group separates its messages from all others.
+        MPI_Comm comm;
+        r = MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+        if (r != MPI_SUCCESS)
+            throw Exception("Error during MPI_Comm_dup()", r);
+
+        groups[i] = std::make_unique<Group>(
+            my_rank, static_cast<int>(i), group_size, comm, dispatcher);
     }
 
     return (static_cast<size_t>(my_rank) < group_size);
@@ -25,6 +25,8 @@
 #include <thrill/net/dispatcher_thread.hpp>
 #include <thrill/net/group.hpp>
 
+#include <mpi.h>
+
 #include <algorithm>
 #include <string>
 #include <vector>
@@ -78,6 +80,9 @@ public:
     //! return the MPI peer number
     int peer() const { return peer_; }
 
+    //! return the MPI communicator of the Group
+    MPI_Comm comm() const;
+
     std::string ToString() const final;
 
     std::ostream& OutputOstream(std::ostream& os) const final;
@@ -130,9 +135,10 @@ private:
 
 /*!
  * A net group backed by virtual MPI connection. As MPI already sets up
- * communication, not much is done. Each Group communicates using a unique MPI
- * tag, the group id. Each host's rank within the group is plaining its MPI
- * rank.
+ * communication, not much is done. Each Group communicates using its own
+ * duplicate of MPI_COMM_WORLD, such that messages of different Groups are
+ * matched in separate queues inside the MPI library. Each host's rank within
+ * the group is plaining its MPI rank.
  */
 class Group final : public net::Group
 {
@@ -142,11 +148,13 @@ public:
     //! \name Base Functions
     //! \{
 
-    //! Initialize a Group for the given size and rank
+    //! Initialize a Group for the given size and rank, takes ownership of the
+    //! MPI communicator comm.
     Group(size_t my_rank, int group_tag, size_t group_size,
-          DispatcherThread& dispatcher)
+          MPI_Comm comm, DispatcherThread& dispatcher)
         : net::Group(my_rank),
           group_tag_(group_tag),
+          comm_(comm),
           conns_(group_size),
           dispatcher_(dispatcher) {
         // create virtual connections
@@ -154,9 +162,20 @@ public:
             conns_[i].Initialize(this, static_cast<int>(i));
     }
 
+    //! non-copyable: delete copy-constructor
+    Group(const Group&) = delete;
+    //! non-copyable: delete assignment operator
+    Group& operator = (const Group&) = delete;
+
+    //! free the MPI communicator
+    ~Group();
+
     //! return MPI tag used to communicate
     int group_tag() const { return group_tag_; }
 
+    //! return the MPI communicator of this Group
+    MPI_Comm comm() const { return comm_; }
+
     //! number of hosts configured.
     size_t num_hosts() const final { return conns_.size(); }
 
@@ -187,6 +206,9 @@ private:
     //! this group's MPI tag
     int group_tag_;
 
+    //! this group's MPI communicator, duplicated from MPI_COMM_WORLD
+    MPI_Comm comm_;
+
     //! vector of virtual connection objects to remote peers
     std::vector<Connection> conns_;
 
@@ -257,8 +279,9 @@ private:
 /*!
  * Construct Group which connects to peers using MPI. As the MPI environment
  * already defines the connections, no hosts or parameters can be
- * given. Constructs group_count mpi::Group objects at once. Within each Group
- * this host has its MPI rank.
+ * given. Constructs group_count mpi::Group objects at once, each with its own
+ * MPI communicator. Within each Group this host has its MPI rank. This is a
+ * collective call over all MPI processes.
  *
  * To enable tests with smaller group sizes, the Construct method takes
  * group_size and returns a Group with *less* hosts than actual MPI processes!
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * thrill/net/sub_group.hpp
+ *
+ * A net::Group view of a subset of the hosts of another Group.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_SUB_GROUP_HEADER
+#define THRILL_NET_SUB_GROUP_HEADER
+
+#include <thrill/net/group.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace thrill {
+namespace net {
+
+//! \addtogroup net_layer
+//! \{
+
+/*!
+ * A SubGroup is a view of a subset of the hosts of a parent Group, which must
+ * include this host. Host i of the SubGroup is host hosts[i] of the parent, and
+ * all communication uses the parent's connections. Hence, the generic
+ * collectives of Group can be run on parts of the network, e.g. within a rack.
+ *
+ * Collectives on a SubGroup must not overlap with collectives on the parent
+ * Group or other SubGroups of it.
+ */
+class SubGroup final : public Group
+{
+public:
+    //! construct view of the given hosts of parent.
+    SubGroup(Group& parent, const std::vector<size_t>& hosts)
+        : Group(FindRank(parent, hosts)), parent_(parent), hosts_(hosts) { }
+
+    size_t num_hosts() const final { return hosts_.size(); }
+
+    Connection& connection(size_t id) final {
+        assert(id < hosts_.size());
+        return parent_.connection(hosts_[id]);
+    }
+
+    //! the connections are owned by the parent
+    void Close() final { }
+
+    size_t num_parallel_async() const final {
+        return parent_.num_parallel_async();
+    }
+
+    std::unique_ptr<Dispatcher> ConstructDispatcher() const final {
+        return parent_.ConstructDispatcher();
+    }
+
+    //! rank of host id in the parent Group
+    size_t parent_rank(size_t id) const { return hosts_[id]; }
+
+private:
+    //! the parent Group
+    Group& parent_;
+
+    //! parent ranks of the hosts in this view
+    std::vector<size_t> hosts_;
+
+    //! find this host's rank in the view
+    static size_t FindRank(const Group& parent, const std::vector<size_t>& hosts) {
+        auto it = std::find(hosts.begin(), hosts.end(), parent.my_host_rank());
+        assert(it != hosts.end());
+        return static_cast<size_t>(it - hosts.begin());
+    }
+};
+
+//! \}
+
+} // namespace net
+} // namespace thrill
+
+#endif // !THRILL_NET_SUB_GROUP_HEADER
+
+/******************************************************************************/
@@ -19,6 +19,7 @@
 #include <thrill/net/connection.hpp>
 #include <thrill/net/tcp/socket.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstdio>
@@ -56,6 +57,9 @@ class Connection final : public net::Connection
     static constexpr bool debug = false;
 
 public:
+    //! maximum number of pieces sent by one SendV() call
+    static constexpr size_t kMaxIov = 64;
+
     //! default construction, contains invalid socket
     Connection() = default;
 
@@ -76,7 +80,10 @@ public:
         : socket_(std::move(other.socket_)),
           state_(other.state_),
           group_id_(other.group_id_),
-          peer_id_(other.peer_id_) {
+          peer_id_(other.peer_id_),
+          zero_copy_(other.zero_copy_),
+          zero_copy_sends_(other.zero_copy_sends_),
+          zero_copy_completed_(other.zero_copy_completed_) {
         other.state_ = ConnectionState::Invalid;
     }
 
@@ -90,6 +97,9 @@ public:
         state_ = other.state_;
         group_id_ = other.group_id_;
         peer_id_ = other.peer_id_;
+        zero_copy_ = other.zero_copy_;
+        zero_copy_sends_ = other.zero_copy_sends_;
+        zero_copy_completed_ = other.zero_copy_completed_;
 
         other.state_ = ConnectionState::Invalid;
         return *this;
@@ -144,6 +154,27 @@ public:
             throw Exception("Error setting socket non-blocking flag", errno);
     }
 
+    //! Enable sends without copying for MsgZeroCopy, returns false if the
+    //! kernel does not support it.
+    bool EnableZeroCopy() {
+        zero_copy_ = socket_.SetZeroCopy(true);
+        return zero_copy_;
+    }
+
+    bool zero_copy() const final { return zero_copy_; }
+
+    uint32_t zero_copy_sends() const final { return zero_copy_sends_; }
+
+    uint32_t ZeroCopyCompleted() final {
+        uint32_t lo, hi;
+        while (zero_copy_ && socket_.recv_zerocopy_completion(&lo, &hi)) {
+            // ranges are reported in order, but may be merged
+            if (static_cast<int32_t>(hi + 1 - zero_copy_completed_) > 0)
+                zero_copy_completed_ = hi + 1;
+        }
+        return zero_copy_completed_;
+    }
+
     //! Return the socket peer address
     std::string GetPeerAddress() const
     { return socket_.GetPeerAddress().ToStringHostPort(); }
@@ -180,6 +211,40 @@ public:
         return wb;
     }
 
+    ssize_t SendV(const IoVec* iov, size_t count, Flags flags) final {
+#if __APPLE__
+        // MacOSX has no MSG_DONTWAIT
+        SetNonBlocking(true);
+#endif
+        int f = MSG_DONTWAIT;
+        if (flags & MsgMore) f |= MSG_MORE;
+
+        // convert pieces, a short-send of the first kMaxIov is fine.
+        struct iovec siov[kMaxIov];
+        count = std::min(count, kMaxIov);
+        for (size_t i = 0; i < count; ++i) {
+            siov[i].iov_base = const_cast<void*>(iov[i].data);
+            siov[i].iov_len = iov[i].size;
+        }
+
+#if defined(MSG_ZEROCOPY)
+        if (zero_copy_ && (flags & MsgZeroCopy)) {
+            ssize_t wb = socket_.sendv_one(siov, count, f | MSG_ZEROCOPY);
+            if (wb > 0) {
+                tx_bytes_ += wb;
+                ++zero_copy_sends_;
+                return wb;
+            }
+            // ENOBUFS: out of option memory for pinning pages, copy instead.
+            if (wb == 0 || errno != ENOBUFS) return wb;
+        }
+#endif
+
+        ssize_t wb = socket_.sendv_one(siov, count, f);
+        if (wb > 0) tx_bytes_ += wb;
+        return wb;
+    }
+
     void SyncRecv(void* out_data, size_t size) final {
         SetNonBlocking(false);
         if (socket_.recv(out_data, size) != static_cast<ssize_t>(size))
@@ -238,6 +303,16 @@ private:
 
     //! The id of the worker this connection is connected to.
     size_t peer_id_ = size_t(-1);
+
+    //! whether SO_ZEROCOPY was enabled on the socket
+    bool zero_copy_ = false;
+
+    //! number of sends with MSG_ZEROCOPY, which the kernel numbers
+    //! consecutively starting with zero.
+    uint32_t zero_copy_sends_ = 0;
+
+    //! number of MSG_ZEROCOPY sends reported completed in the error queue
+    uint32_t zero_copy_completed_ = 0;
 };
 
 // \}
@@ -12,11 +12,15 @@
 #include <thrill/net/tcp/connection.hpp>
 #include <thrill/net/tcp/construct.hpp>
 #include <thrill/net/tcp/group.hpp>
-#include <thrill/net/tcp/select_dispatcher.hpp>
+#include <thrill/net/dispatcher.hpp>
 
 #include <tlx/die.hpp>
+#include <tlx/unused.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <deque>
+#include <cstring>
 #include <map>
 #include <string>
 #include <utility>
@@ -33,12 +37,20 @@ class Construction
 {
     static constexpr bool debug = false;
 
+    //! whether to log the timing of the phases on all hosts, otherwise only
+    //! rank 0 does, which waits for connections from all others.
+    static constexpr bool debug_timing = false;
+
+    using steady_clock = std::chrono::steady_clock;
+
 public:
-    Construction(SelectDispatcher& dispatcher,
-                 std::unique_ptr<Group>* groups, size_t group_count)
+    Construction(net::Dispatcher& dispatcher,
+                 std::unique_ptr<Group>* groups, size_t group_count,
+                 bool unix_sockets)
         : dispatcher_(dispatcher),
           groups_(groups),
-          group_count_(group_count)
+          group_count_(group_count),
+          unix_sockets_(unix_sockets)
     { }
 
     /*!
@@ -55,6 +67,8 @@ public:
         this->my_rank_ = my_rank_;
         die_unless(my_rank_ < endpoints.size());
 
+        start_ = steady_clock::now();
+
         LOG << "Client " << my_rank_ << " starting: " << endpoints[my_rank_];
 
         for (size_t i = 0; i < group_count_; i++) {
@@ -65,10 +79,24 @@ public:
         std::vector<SocketAddress> address_list
             = GetAddressList(endpoints);
 
+        size_t time_resolve = elapsed_ms();
+
+        // peers with the same address run on this host, and are connected via
+        // Unix domain sockets, which bypass the TCP/IP stack.
+        same_host_.resize(address_list.size());
+        bool same_host_lower = false;
+        for (size_t id = 0; id < address_list.size(); ++id) {
+            same_host_[id] =
+                unix_sockets_ && id != my_rank_ &&
+                IsSameHost(address_list[id], address_list[my_rank_]);
+            if (same_host_[id] && id < my_rank_) same_host_lower = true;
+        }
+
         // Create listening socket.
         {
             Socket listen_socket = Socket::Create();
             listen_socket.SetReuseAddr();
+            listen_socket.SetNonBlocking(true);
 
             SocketAddress& lsa = address_list[my_rank_];
 
@@ -76,15 +104,44 @@ public:
                 throw Exception("Could not bind listen socket to "
                                 + lsa.ToStringHostPort(), errno);
 
-            if (!listen_socket.listen())
+            // all hosts with lower rank connect to us concurrently, the
+            // backlog must hold them all or SYNs are dropped and retried by
+            // the kernel only after a second. The kernel caps it at somaxconn.
+            int backlog = static_cast<int>(
+                std::max<size_t>(SOMAXCONN, my_rank_ * group_count_));
+
+            if (!listen_socket.listen(backlog))
                 throw Exception("Could not listen on socket "
                                 + lsa.ToStringHostPort(), errno);
 
             listener_ = Connection(std::move(listen_socket));
         }
 
+        // Create Unix domain listening socket for lower ranks on this host.
+        if (same_host_lower) {
+            Socket listen_socket = Socket::CreateUnix();
+            listen_socket.SetNonBlocking(true);
+
+            std::string name = UnixSocketName(address_list[my_rank_]);
+
+            if (!listen_socket.bind_unix(name))
+                throw Exception("Could not bind Unix domain socket to "
+                                + name, errno);
+
+            int backlog = static_cast<int>(
+                std::max<size_t>(SOMAXCONN, my_rank_ * group_count_));
+
+            if (!listen_socket.listen(backlog))
+                throw Exception("Could not listen on Unix domain socket "
+                                + name, errno);
+
+            unix_listener_ = Connection(std::move(listen_socket));
+        }
+
         LOG << "Client " << my_rank_ << " listening: " << endpoints[my_rank_];
 
+        size_t time_listen = elapsed_ms();
+
         // Initiate connections to all hosts with higher id.
         for (uint32_t g = 0; g < group_count_; g++) {
             for (size_t id = my_rank_ + 1; id < address_list.size(); ++id) {
@@ -97,6 +154,12 @@ public:
                             [=]() {
                                 return OnIncomingConnection(listener_);
                             });
+        if (unix_listener_.IsValid()) {
+            dispatcher_.AddRead(unix_listener_,
+                                [=]() {
+                                    return OnIncomingConnection(unix_listener_);
+                                });
+        }
 
         // Dispatch until everything is connected.
         while (!IsInitializationFinished())
@@ -110,8 +173,25 @@ public:
         // All connected, Dispose listener.
         listener_.Close();
 
+        if (unix_listener_.IsValid()) {
+            dispatcher_.Cancel(unix_listener_);
+            unix_listener_.Close();
+        }
+
+        size_t time_connect = elapsed_ms();
+
         LOG << "Client " << my_rank_ << " done";
 
+        LOGC(debug_timing || my_rank_ == 0)
+            << "tcp::Construct() rank " << my_rank_
+            << " of " << endpoints.size()
+            << ": resolve " << time_resolve << " ms"
+            << ", listen " << time_listen - time_resolve << " ms"
+            << ", connect " << time_connect - time_listen << " ms"
+            << " with " << connect_retries_ << " retries"
+            << ", last link to rank " << last_peer_
+            << " after " << last_connected_ << " ms";
+
         for (size_t j = 0; j < group_count_; j++) {
             // output list of file descriptors connected to partners
             for (size_t i = 0; i != address_list.size(); ++i) {
@@ -128,7 +208,7 @@ private:
     mem::Manager mem_manager_ { nullptr, "Construction" };
 
     //! Dispatcher instance used by this Manager to perform async operations.
-    SelectDispatcher& dispatcher_;
+    net::Dispatcher& dispatcher_;
 
     //! Link to groups to initialize
     std::unique_ptr<Group>* groups_;
@@ -139,9 +219,19 @@ private:
     //! The rank associated with the local worker.
     size_t my_rank_ = size_t(-1);
 
+    //! whether to connect peers on the same host via Unix domain sockets
+    bool unix_sockets_;
+
     //! The Connections responsible for listening to incoming connections.
     Connection listener_;
 
+    //! Unix domain socket listening to connections from lower ranks on this
+    //! host, if there are any.
+    Connection unix_listener_;
+
+    //! whether the peer's endpoint has the same address as ours
+    std::vector<bool> same_host_;
+
     //! Some definitions for convenience
     using GroupNodeIdPair = std::pair<size_t, size_t>;
 
@@ -150,16 +240,50 @@ private:
     //! Connection is moved out of the deque into the right Group.
     std::deque<Connection> connections_;
 
+    //! state of the reconnect backoff of a (group,id) connection
+    struct Backoff {
+        //! current timeout in millisec
+        size_t timeout;
+        //! total time waited in millisec
+        size_t waited;
+    };
+
     //! Array of connect timeouts which are exponentially increased from 10msec
     //! on failed connects.
-    std::map<GroupNodeIdPair, size_t> timeouts_;
+    std::map<GroupNodeIdPair, Backoff> timeouts_;
 
     //! start connect backoff at 10msec
     const size_t initial_timeout_ = 10;
 
-    //! maximum connect backoff, after which the program fails. Total waiting
-    //! time is about 2 * final_timeout_ (in millisec).
-    const size_t final_timeout_ = 40960;
+    //! maximum connect backoff, such that a host starting late is connected
+    //! to soon after it is listening.
+    const size_t max_timeout_ = 1000;
+
+    //! total waiting time for a connection, after which the program fails.
+    const size_t final_timeout_ = 80000;
+
+    //! start of construction
+    steady_clock::time_point start_;
+
+    //! number of reconnects due to refused or timed out connects
+    size_t connect_retries_ = 0;
+
+    //! peer rank of the connection completed last, and when
+    size_t last_peer_ = 0, last_connected_ = 0;
+
+    //! return millisec since start of construction
+    size_t elapsed_ms() const {
+        return static_cast<size_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                steady_clock::now() - start_).count());
+    }
+
+    //! mark connection as established
+    void SetConnected(Connection& tcp) {
+        tcp.set_state(ConnectionState::Connected);
+        last_peer_ = tcp.peer_id();
+        last_connected_ = elapsed_ms();
+    }
 
     //! Represents a welcome message that is exchanged by Connections during
     //! network initialization.
@@ -200,6 +324,34 @@ private:
         return addressList;
     }
 
+    //! whether the two addresses are equal or both loopback addresses, in
+    //! which case the Unix domain socket abstract namespace is shared.
+    static bool IsSameHost(const SocketAddress& a, const SocketAddress& b) {
+#if __linux__
+        if (a.IsLoopback() && b.IsLoopback()) return true;
+        if (a.IsIPv4() && b.IsIPv4()) {
+            return a.sockaddr_in()->sin_addr.s_addr ==
+                   b.sockaddr_in()->sin_addr.s_addr;
+        }
+        if (a.IsIPv6() && b.IsIPv6()) {
+            return memcmp(&a.sockaddr_in6()->sin6_addr,
+                          &b.sockaddr_in6()->sin6_addr,
+                          sizeof(struct in6_addr)) == 0;
+        }
+        return false;
+#else
+        // the abstract namespace is a Linux extension
+        tlx::unused(a, b);
+        return false;
+#endif
+    }
+
+    //! name of the Unix domain socket of the endpoint, which is unique on the
+    //! host like the address of its TCP listener.
+    static std::string UnixSocketName(const SocketAddress& address) {
+        return "thrill-" + address.ToStringHostPort();
+    }
+
     /*!
      * Returns wether the initialization is completed.  Checks the Groups
      * associated with this Manager and returns true or false wether the
@@ -238,14 +390,19 @@ private:
         Connection& tcp = static_cast<Connection&>(nc);
 
         // Start asynchronous connect.
+        bool same_host = same_host_[tcp.peer_id()];
         tcp.GetSocket().SetNonBlocking(true);
-        int res = tcp.GetSocket().connect(address);
+        int res = same_host
+                  ? tcp.GetSocket().connect_unix(UnixSocketName(address))
+                  : tcp.GetSocket().connect(address);
 
         tcp.set_state(ConnectionState::Connecting);
 
         if (res == 0) {
-            LOG << "Early connect success. This should not happen.";
-            // connect() already successful? this should not be.
+            // connect() already successful? this should not be for TCP, but
+            // Unix domain sockets connect immediately.
+            if (!same_host)
+                LOG << "Early connect success. This should not happen.";
             OnConnected(tcp, address);
         }
         else if (errno == EINPROGRESS) {
@@ -254,10 +411,12 @@ private:
                                      return OnConnected(tcp, address);
                                  });
         }
-        else if (errno == ECONNREFUSED) {
+        else if (errno == ECONNREFUSED ||
+                 (same_host && (errno == EAGAIN || errno == ENOENT))) {
             LOG << "Early connect refused.";
-            // connect() already refused connection?
-            OnConnected(tcp, address, errno);
+            // connect() already refused connection? A Unix domain socket
+            // refuses if the peer is not listening yet or its backlog is full.
+            OnConnected(tcp, address, ECONNREFUSED);
         }
         else {
             // Failed to even try the connection - this might be a permanent
@@ -285,7 +444,8 @@ private:
         Connection& nc = groups_[group]->tcp_connection(id);
         if (nc.IsValid()) nc.Close();
 
-        nc = Connection(Socket::Create());
+        nc = Connection(
+            same_host_[id] ? Socket::CreateUnix() : Socket::Create());
         nc.set_group_id(group);
         nc.set_peer_id(id);
 
@@ -306,7 +466,7 @@ private:
             tcp.set_state(ConnectionState::HelloSent);
         }
         else if (tcp.state() == ConnectionState::HelloReceived) {
-            tcp.set_state(ConnectionState::Connected);
+            SetConnected(tcp);
         }
         else {
             die("State mismatch: " + std::to_string(tcp.state()));
@@ -316,22 +476,26 @@ private:
     //! calculate the next timeout on connect() errors
     size_t NextConnectTimeout(size_t group, size_t id,
                               const SocketAddress& address) {
+        ++connect_retries_;
+
         GroupNodeIdPair gnip(group, id);
         auto it = timeouts_.find(gnip);
         if (it == timeouts_.end()) {
-            it = timeouts_.insert(std::make_pair(gnip, initial_timeout_)).first;
+            it = timeouts_.insert(
+                std::make_pair(gnip, Backoff { initial_timeout_, 0 })).first;
         }
         else {
-            // exponential backoff of reconnects.
-            it->second = 2 * it->second;
+            // exponential backoff of reconnects, up to max_timeout_.
+            it->second.timeout = std::min(2 * it->second.timeout, max_timeout_);
 
-            if (it->second >= final_timeout_) {
+            if (it->second.waited >= final_timeout_) {
                 throw Exception("Timeout error connecting to client "
                                 + std::to_string(id) + " via "
                                 + address.ToStringHostPort());
             }
         }
-        return it->second;
+        it->second.waited += it->second.timeout;
+        return it->second.timeout;
     }
 
     /*!
@@ -455,7 +619,7 @@ private:
         die_unequal(tcp.peer_id(), msg->id);
         die_unequal(tcp.group_id(), msg->group_id);
 
-        tcp.set_state(ConnectionState::Connected);
+        SetConnected(tcp);
     }
 
     /*!
@@ -517,43 +681,55 @@ private:
         assert(dynamic_cast<Connection*>(&conn));
         Connection& tcp = static_cast<Connection&>(conn);
 
-        // accept listening socket
-        connections_.emplace_back(tcp.GetSocket().accept());
-        die_unless(connections_.back().GetSocket().IsValid());
+        // accept all pending connections from the non-blocking listener
+        while (true) {
+            Socket socket = tcp.GetSocket().accept();
+            if (!socket.IsValid()) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK ||
+                    errno == EINTR || errno == ECONNABORTED)
+                    break;
+                throw Exception("Error accepting connection", errno);
+            }
+            connections_.emplace_back(std::move(socket));
 
-        tcp.set_state(ConnectionState::TransportConnected);
+            tcp.set_state(ConnectionState::TransportConnected);
 
-        LOG << "OnIncomingConnection() " << my_rank_ << " accepted connection"
-            << " fd=" << connections_.back().GetSocket().fd()
-            << " from=" << connections_.back().GetPeerAddress();
+            LOG << "OnIncomingConnection() " << my_rank_ << " accepted connection"
+                << " fd=" << connections_.back().GetSocket().fd()
+                << " from=" << connections_.back().GetPeerAddress();
 
-        // wait for welcome message from other side
-        dispatcher_.AsyncRead(
-            connections_.back(), /* seq */ 0, sizeof(WelcomeMsg),
-            AsyncReadBufferCallback::make<
-                Construction, &Construction::OnIncomingWelcomeAndReply>(this));
+            // wait for welcome message from other side
+            dispatcher_.AsyncRead(
+                connections_.back(), /* seq */ 0, sizeof(WelcomeMsg),
+                AsyncReadBufferCallback::make<
+                    Construction, &Construction::OnIncomingWelcomeAndReply>(this));
+        }
 
         // wait for more connections.
         return true;
     }
 };
 
-//! Connect to peers via endpoints using TCP sockets. Construct a group_count
+//! Connect to peers via endpoints using TCP sockets, or Unix domain sockets for
+//! peers on the same host if unix_sockets is set. Construct a group_count
 //! tcp::Group objects at once. Within each Group this host has my_rank.
-void Construct(SelectDispatcher& dispatcher, size_t my_rank,
+void Construct(net::Dispatcher& dispatcher, size_t my_rank,
                const std::vector<std::string>& endpoints,
-               std::unique_ptr<Group>* groups, size_t group_count) {
-    Construction(dispatcher, groups, group_count)
+               std::unique_ptr<Group>* groups, size_t group_count,
+               bool unix_sockets) {
+    Construction(dispatcher, groups, group_count, unix_sockets)
     .Initialize(my_rank, endpoints);
 }
 
-//! Connect to peers via endpoints using TCP sockets. Construct a group_count
+//! Connect to peers via endpoints using TCP sockets, or Unix domain sockets for
+//! peers on the same host if unix_sockets is set. Construct a group_count
 //! net::Group objects at once. Within each Group this host has my_rank.
 std::vector<std::unique_ptr<net::Group> >
-Construct(SelectDispatcher& dispatcher, size_t my_rank,
-          const std::vector<std::string>& endpoints, size_t group_count) {
+Construct(net::Dispatcher& dispatcher, size_t my_rank,
+          const std::vector<std::string>& endpoints, size_t group_count,
+          bool unix_sockets) {
     std::vector<std::unique_ptr<tcp::Group> > tcp_groups(group_count);
-    Construction(dispatcher, &tcp_groups[0], tcp_groups.size())
+    Construction(dispatcher, &tcp_groups[0], tcp_groups.size(), unix_sockets)
     .Initialize(my_rank, endpoints);
     std::vector<std::unique_ptr<net::Group> > groups(group_count);
     std::move(tcp_groups.begin(), tcp_groups.end(), groups.begin());
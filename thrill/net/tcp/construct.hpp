@@ -26,17 +26,21 @@ namespace tcp {
 //! \addtogroup net_tcp TCP Socket API
 //! \{
 
-//! Connect to peers via endpoints using TCP sockets. Construct a group_count
+//! Connect to peers via endpoints using TCP sockets, or Unix domain sockets for
+//! peers on the same host if unix_sockets is set. Construct a group_count
 //! tcp::Group objects at once. Within each Group this host has my_rank.
-void Construct(SelectDispatcher& dispatcher, size_t my_rank,
+void Construct(net::Dispatcher& dispatcher, size_t my_rank,
                const std::vector<std::string>& endpoints,
-               std::unique_ptr<Group>* groups, size_t group_count);
+               std::unique_ptr<Group>* groups, size_t group_count,
+               bool unix_sockets = true);
 
-//! Connect to peers via endpoints using TCP sockets. Construct a group_count
+//! Connect to peers via endpoints using TCP sockets, or Unix domain sockets for
+//! peers on the same host if unix_sockets is set. Construct a group_count
 //! net::Group objects at once. Within each Group this host has my_rank.
 std::vector<std::unique_ptr<net::Group> >
-Construct(SelectDispatcher& dispatcher, size_t my_rank,
-          const std::vector<std::string>& endpoints, size_t group_count);
+Construct(net::Dispatcher& dispatcher, size_t my_rank,
+          const std::vector<std::string>& endpoints, size_t group_count,
+          bool unix_sockets = true);
 
 //! \}
 
@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * thrill/net/tcp/epoll_dispatcher.cpp
+ *
+ * Asynchronous callback wrapper around Linux's epoll()
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
+
+#if __linux__
+
+#include <tlx/die.hpp>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdint>
+
+namespace thrill {
+namespace net {
+namespace tcp {
+
+EPollDispatcher::EPollDispatcher()
+    : net::Dispatcher(), events_(256) {
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        throw Exception("EPollDispatcher() epoll_create1() failed!", errno);
+
+    event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0)
+        throw Exception("EPollDispatcher() eventfd() failed!", errno);
+
+    // Ignore PIPE signals (received when writing to closed sockets)
+    signal(SIGPIPE, SIG_IGN);
+
+    // send queued writes in batches via sendmsg()
+    coalesce_writes_ = true;
+
+    // wait interrupts via eventfd.
+    AddRead(event_fd_,
+            Callback::make<EPollDispatcher,
+                           & EPollDispatcher::EventFdCallback>(this));
+}
+
+EPollDispatcher::~EPollDispatcher() {
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+void EPollDispatcher::Update(int fd) {
+    Watch& w = watch_[fd];
+
+    uint32_t events = 0;
+    if (w.read_cb.size()) events |= EPOLLIN;
+    if (w.write_cb.size()) events |= EPOLLOUT;
+
+    if (events == 0 && !w.except_cb) {
+        // no more callbacks: remove from epoll set. this fails harmlessly if
+        // the fd was already closed, which removes it automatically.
+        if (w.in_epoll) {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            w.in_epoll = false;
+        }
+        return;
+    }
+
+    if (w.in_epoll && w.events == events) return;
+
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.u64 = 0;
+    ev.data.fd = fd;
+
+    LOG << "EPollDispatcher::Update() fd=" << fd
+        << " events=" << events << " in_epoll=" << w.in_epoll;
+
+    if (w.in_epoll && ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0) {
+        w.events = events;
+        return;
+    }
+
+    // not in the epoll set, or the fd was closed and its number reused.
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        if (errno != EEXIST ||
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) != 0)
+            throw Exception("EPollDispatcher() epoll_ctl() failed!", errno);
+    }
+    w.in_epoll = true;
+    w.events = events;
+}
+
+//! Run one iteration of dispatching epoll_wait().
+void EPollDispatcher::DispatchOne(const std::chrono::milliseconds& timeout) {
+
+    int r = ::epoll_wait(epoll_fd_, events_.data(),
+                         static_cast<int>(events_.size()),
+                         static_cast<int>(timeout.count()));
+
+    if (r < 0) {
+        // if we caught a signal, this is intended to interrupt epoll_wait().
+        if (errno == EINTR) {
+            LOG << "Dispatch(): epoll_wait() was interrupted due to a signal.";
+            return;
+        }
+
+        throw Exception("Dispatch::EPoll() failed!", errno);
+    }
+
+    for (int i = 0; i < r; ++i)
+    {
+        int fd = events_[i].data.fd;
+        uint32_t ev = events_[i].events;
+
+        if (static_cast<size_t>(fd) >= watch_.size()) continue;
+
+        // we use a pointer into the watch_ table. however, since the
+        // std::vector may regrow when callback handlers are called, this
+        // pointer is reset a lot of times.
+        Watch* w = &watch_[fd];
+
+        if (!w->active) continue;
+
+        // errors and hang-ups are delivered to the read and write callbacks,
+        // which will get the error from the socket operation.
+        bool error = (ev & (EPOLLERR | EPOLLHUP)) != 0;
+        bool handled = false;
+
+        if ((ev & EPOLLIN) || (error && w->read_cb.size()))
+        {
+            handled = true;
+            // run read callbacks until one returns true (in which case it
+            // wants to be called again), or the read_cb list is empty.
+            while (w->read_cb.size() && w->read_cb.front()() == false) {
+                w = &watch_[fd];
+                w->read_cb.pop_front();
+            }
+            w = &watch_[fd];
+        }
+
+        if ((ev & EPOLLOUT) || (error && w->write_cb.size()))
+        {
+            handled = true;
+            // run write callbacks until one returns true (in which case it
+            // wants to be called again), or the write_cb list is empty.
+            while (w->write_cb.size() && w->write_cb.front()() == false) {
+                w = &watch_[fd];
+                w->write_cb.pop_front();
+            }
+            w = &watch_[fd];
+        }
+
+        if (error && !handled)
+        {
+            if (w->except_cb) {
+                if (!w->except_cb()) {
+                    // callback returned false: remove exception callback
+                    w = &watch_[fd];
+                    w->except_cb = Callback();
+                }
+                w = &watch_[fd];
+            }
+            else {
+                DefaultExceptionCallback();
+            }
+        }
+
+        if (w->read_cb.size() == 0 && w->write_cb.size() == 0 &&
+            !w->except_cb)
+            w->active = false;
+
+        // stop listening for events without callbacks
+        Update(fd);
+    }
+}
+
+void EPollDispatcher::Interrupt() {
+    // increment the eventfd counter to wake up epoll_wait().
+    uint64_t one = 1;
+    ssize_t wb;
+    while ((wb = write(event_fd_, &one, sizeof(one))) < 0 && errno == EINTR) {
+        LOG1 << "WakeUp: error sending to eventfd: " << errno;
+    }
+    // EAGAIN means counter overflow, in which case a wake up is pending.
+    die_unless(wb == sizeof(one) || errno == EAGAIN);
+}
+
+bool EPollDispatcher::EventFdCallback() {
+    uint64_t counter;
+    while (read(event_fd_, &counter, sizeof(counter)) > 0) {
+        /* repeat, until counter is reset */
+    }
+    return true;
+}
+
+} // namespace tcp
+} // namespace net
+} // namespace thrill
+
+#endif // __linux__
+
+/******************************************************************************/
@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * thrill/net/tcp/epoll_dispatcher.hpp
+ *
+ * Asynchronous callback wrapper around Linux's epoll()
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+#define THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+
+#if __linux__
+
+#include <thrill/common/logger.hpp>
+#include <thrill/mem/allocator.hpp>
+#include <thrill/net/connection.hpp>
+#include <thrill/net/dispatcher.hpp>
+#include <thrill/net/exception.hpp>
+#include <thrill/net/tcp/connection.hpp>
+#include <thrill/net/tcp/socket.hpp>
+
+#include <sys/epoll.h>
+
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace tcp {
+
+//! \addtogroup net_tcp TCP Socket API
+//! \{
+
+/*!
+ * EPollDispatcher is a higher level wrapper for Linux's epoll(). It provides
+ * the same interface as SelectDispatcher, but the kernel keeps the set of
+ * watched file descriptors, hence DispatchOne() only visits ready ones and
+ * there is no FD_SETSIZE limit. Interrupt() wakes up epoll_wait() via an
+ * eventfd.
+ *
+ * The epoll set is level-triggered, and error or hang-up events are delivered
+ * to the read and write callbacks, which then get the error from recv() or
+ * send(), as with select().
+ */
+class EPollDispatcher final : public net::Dispatcher
+{
+    static constexpr bool debug = false;
+
+public:
+    //! type for file descriptor readiness callbacks
+    using Callback = AsyncCallback;
+
+    //! constructor
+    EPollDispatcher();
+
+    //! non-copyable: delete copy-constructor
+    EPollDispatcher(const EPollDispatcher&) = delete;
+    //! non-copyable: delete assignment operator
+    EPollDispatcher& operator = (const EPollDispatcher&) = delete;
+
+    ~EPollDispatcher();
+
+    //! Grow table if needed
+    void CheckSize(int fd) {
+        assert(fd >= 0);
+        if (static_cast<size_t>(fd) >= watch_.size())
+            watch_.resize(fd + 1);
+    }
+
+    //! Register a buffered read callback and a default exception callback.
+    void AddRead(int fd, const Callback& read_cb) {
+        CheckSize(fd);
+        watch_[fd].active = true;
+        watch_[fd].read_cb.emplace_back(read_cb);
+        Update(fd);
+    }
+
+    //! Register a buffered read callback and a default exception callback.
+    void AddRead(net::Connection& c, const Callback& read_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        return AddRead(tc.GetSocket().fd(), read_cb);
+    }
+
+    //! Register a buffered write callback and a default exception callback.
+    void AddWrite(net::Connection& c, const Callback& write_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        int fd = tc.GetSocket().fd();
+        CheckSize(fd);
+        watch_[fd].active = true;
+        watch_[fd].write_cb.emplace_back(write_cb);
+        Update(fd);
+    }
+
+    //! Register an exception callback, called on errors if neither read nor
+    //! write callbacks are registered.
+    void SetExcept(net::Connection& c, const Callback& except_cb) {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        int fd = tc.GetSocket().fd();
+        CheckSize(fd);
+        watch_[fd].active = true;
+        watch_[fd].except_cb = except_cb;
+        Update(fd);
+    }
+
+    //! Cancel all callbacks on a given fd.
+    void Cancel(net::Connection& c) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        int fd = tc.GetSocket().fd();
+        CheckSize(fd);
+
+        Watch& w = watch_[fd];
+        if (w.read_cb.size() == 0 && w.write_cb.size() == 0)
+            LOG << "EPollDispatcher::Cancel() fd=" << fd
+                << " called with no callbacks registered.";
+
+        w.read_cb.clear();
+        w.write_cb.clear();
+        w.except_cb = Callback();
+        w.active = false;
+        Update(fd);
+    }
+
+    //! Run one iteration of dispatching epoll_wait().
+    void DispatchOne(const std::chrono::milliseconds& timeout) final;
+
+    //! Interrupt the current epoll_wait() via the eventfd
+    void Interrupt() final;
+
+private:
+    //! epoll file descriptor
+    int epoll_fd_;
+
+    //! eventfd to wake up epoll_wait().
+    int event_fd_;
+
+    //! callback vectors per watched file descriptor
+    struct Watch {
+        //! boolean check whether any callbacks are registered
+        bool     active = false;
+        //! whether the fd is registered in the epoll set
+        bool     in_epoll = false;
+        //! events currently registered in the epoll set
+        uint32_t events = 0;
+        //! queue of callbacks for fd.
+        std::deque<Callback, mem::GPoolAllocator<Callback> >
+                 read_cb, write_cb;
+        //! only one exception callback for the fd.
+        Callback except_cb;
+    };
+
+    //! handlers for all registered file descriptors.
+    std::vector<Watch> watch_;
+
+    //! buffer for events returned by epoll_wait()
+    std::vector<struct epoll_event> events_;
+
+    //! Update the fd's registration in the epoll set from its callbacks.
+    void Update(int fd);
+
+    //! Default exception handler
+    static bool DefaultExceptionCallback() {
+        throw Exception("EPollDispatcher() exception on socket!", errno);
+    }
+
+    //! eventfd callback
+    bool EventFdCallback();
+};
+
+//! \}
+
+} // namespace tcp
+} // namespace net
+} // namespace thrill
+
+#endif // __linux__
+
+#endif // !THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+
+/******************************************************************************/
@@ -14,6 +14,7 @@
 
 #include <thrill/common/logger.hpp>
 #include <thrill/net/tcp/construct.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
 #include <thrill/net/tcp/group.hpp>
 #include <thrill/net/tcp/select_dispatcher.hpp>
 
@@ -29,8 +30,8 @@ namespace tcp {
 
 std::unique_ptr<Dispatcher>
 Group::ConstructDispatcher() const {
-    // construct tcp::SelectDispatcher
-    return std::make_unique<SelectDispatcher>();
+    // construct tcp::EPollDispatcher or tcp::SelectDispatcher
+    return std::make_unique<Dispatcher>();
 }
 
 std::vector<std::unique_ptr<Group> > Group::ConstructLoopbackMesh(
@@ -62,7 +63,7 @@ std::vector<std::unique_ptr<Group> > Group::ConstructLoopbackMesh(
 }
 
 std::vector<std::unique_ptr<Group> > Group::ConstructLocalRealTCPMesh(
-    size_t num_hosts) {
+    size_t num_hosts, bool unix_sockets) {
 
     // randomize base port number for test
     std::default_random_engine generator(std::random_device { } ());
@@ -86,10 +87,11 @@ std::vector<std::unique_ptr<Group> > Group::ConstructLocalRealTCPMesh(
 
     for (size_t i = 0; i < num_hosts; i++) {
         threads[i] = std::thread(
-            [i, &endpoints, &groups]() {
+            [i, &endpoints, &groups, unix_sockets]() {
                 // construct Group i with endpoints -- with temporary Dispatcher
-                net::tcp::SelectDispatcher dispatcher;
-                Construct(dispatcher, i, endpoints, groups.data() + i, 1);
+                Group::Dispatcher dispatcher;
+                Construct(dispatcher, i, endpoints, groups.data() + i, 1,
+                          unix_sockets);
             });
     }
 
@@ -35,6 +35,7 @@ namespace tcp {
 //! \{
 
 class SelectDispatcher;
+class EPollDispatcher;
 
 /*!
  * Collection of NetConnections to workers, allows point-to-point client
@@ -59,10 +60,11 @@ public:
 
     /*!
      * Construct a test network with an underlying full mesh of *REAL* tcp
-     * streams interconnected via localhost ports.
+     * streams interconnected via localhost ports, or of Unix domain sockets
+     * as used for peers on the same host if unix_sockets is set.
      */
     static std::vector<std::unique_ptr<Group> > ConstructLocalRealTCPMesh(
-        size_t num_hosts);
+        size_t num_hosts, bool unix_sockets = false);
 
     //! Initializing constructor, used by tests for creating Groups.
     Group(size_t my_rank, size_t group_size)
@@ -101,7 +103,12 @@ public:
         return tcp_connection(id);
     }
 
+    //! epoll() based dispatcher on Linux, select() based elsewhere
+#if __linux__
+    using Dispatcher = tcp::EPollDispatcher;
+#else
     using Dispatcher = tcp::SelectDispatcher;
+#endif
 
     std::unique_ptr<net::Dispatcher> ConstructDispatcher() const final;
 
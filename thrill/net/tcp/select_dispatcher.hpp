@@ -70,6 +70,9 @@ public:
         // Ignore PIPE signals (received when writing to closed sockets)
         signal(SIGPIPE, SIG_IGN);
 
+        // send queued writes in batches via sendmsg()
+        coalesce_writes_ = true;
+
         // wait interrupts via self-pipe.
         AddRead(self_pipe_[0],
                 Callback::make<SelectDispatcher,
@@ -12,9 +12,19 @@
 
 #include <thrill/net/tcp/socket.hpp>
 
+#include <tlx/unused.hpp>
+
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <sys/un.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#if __linux__
+#include <linux/errqueue.h>
+#endif
 
 namespace thrill {
 namespace net {
@@ -57,6 +67,70 @@ void Socket::SetReuseAddr(bool activate) {
 #endif
 }
 
+#if __linux__
+//! fill sockaddr_un with the name in the abstract namespace, which starts with
+//! a zero byte and is not zero terminated. Returns the address length.
+static socklen_t MakeAbstractUnixAddress(
+    const std::string& name, struct sockaddr_un* sa) {
+    memset(sa, 0, sizeof(*sa));
+    sa->sun_family = AF_UNIX;
+    size_t size = std::min(name.size(), sizeof(sa->sun_path) - 1);
+    memcpy(sa->sun_path + 1, name.data(), size);
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) +
+                                  1 + size);
+}
+#endif
+
+bool Socket::bind_unix(const std::string& name) {
+    assert(IsValid());
+
+#if __linux__
+    struct sockaddr_un sa;
+    socklen_t salen = MakeAbstractUnixAddress(name, &sa);
+
+    int r = ::bind(fd_, reinterpret_cast<struct sockaddr*>(&sa), salen);
+
+    if (r != 0) {
+        LOG << "Socket::bind_unix()"
+            << " fd_=" << fd_
+            << " name=" << name
+            << " return=" << r
+            << " error=" << strerror(errno);
+    }
+
+    return (r == 0);
+#else
+    tlx::unused(name);
+    errno = EAFNOSUPPORT;
+    return false;
+#endif
+}
+
+int Socket::connect_unix(const std::string& name) {
+    assert(IsValid());
+
+#if __linux__
+    struct sockaddr_un sa;
+    socklen_t salen = MakeAbstractUnixAddress(name, &sa);
+
+    int r = ::connect(fd_, reinterpret_cast<struct sockaddr*>(&sa), salen);
+
+    if (r != 0) {
+        LOG << "Socket::connect_unix()"
+            << " fd_=" << fd_
+            << " name=" << name
+            << " return=" << r
+            << " error=" << strerror(errno);
+    }
+
+    return r;
+#else
+    tlx::unused(name);
+    errno = EAFNOSUPPORT;
+    return -1;
+#endif
+}
+
 void Socket::SetNoDelay(bool activate) {
     assert(IsValid());
 
@@ -128,6 +202,96 @@ void Socket::SetRcvBuf(size_t size) {
 #endif
 }
 
+bool Socket::SetZeroCopy(bool activate) {
+    assert(IsValid());
+
+#if __linux__ && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    int sockoptflag = (activate ? 1 : 0);
+
+    /*
+     * SO_ZEROCOPY allows sendmsg() with MSG_ZEROCOPY, which pins the pages of
+     * the sent data instead of copying them into kernel buffers. The pages
+     * must not be modified until the kernel posts a completion notification
+     * on the socket's error queue. Available since Linux 4.14.
+     */
+    if (::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY,
+                     &sockoptflag, sizeof(sockoptflag)) != 0)
+    {
+        LOG << "Cannot set SO_ZEROCOPY on socket fd " << fd_
+            << ": " << strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    tlx::unused(activate);
+    return false;
+#endif
+}
+
+void Socket::SetBusyPoll(size_t usec) {
+    assert(IsValid());
+
+#if __linux__ && defined(SO_BUSY_POLL)
+    int sockoptflag = static_cast<int>(usec);
+
+    /*
+     * SO_BUSY_POLL sets the approximate time in microseconds to busy poll on
+     * a blocking receive when there is no data. Increasing this value may
+     * require CAP_NET_ADMIN.
+     */
+    if (::setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL,
+                     &sockoptflag, sizeof(sockoptflag)) != 0)
+    {
+        LOG << "Cannot set SO_BUSY_POLL on socket fd " << fd_
+            << ": " << strerror(errno);
+    }
+#else
+    tlx::unused(usec);
+#endif
+}
+
+bool Socket::recv_zerocopy_completion(uint32_t* lo, uint32_t* hi) {
+    assert(IsValid());
+
+#if __linux__ && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    char control[128];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    while (true) {
+        if (::recvmsg(fd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            return false;
+
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+             cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 &&
+                   cm->cmsg_type == IPV6_RECVERR)))
+                continue;
+
+            const struct sock_extended_err* serr =
+                reinterpret_cast<const struct sock_extended_err*>(
+                    CMSG_DATA(cm));
+            if (serr->ee_errno != 0 ||
+                serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+
+            *lo = serr->ee_info;
+            *hi = serr->ee_data;
+            return true;
+        }
+        // other error queue message: skip it
+        msg.msg_controllen = sizeof(control);
+    }
+#else
+    tlx::unused(lo, hi);
+    return false;
+#endif
+}
+
 } // namespace tcp
 } // namespace net
 } // namespace thrill
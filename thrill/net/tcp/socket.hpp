@@ -24,10 +24,12 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <cassert>
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <utility>
@@ -102,6 +104,30 @@ public:
                 << " error=" << strerror(errno);
         }
 
+#ifndef SOCK_CLOEXEC
+        if (fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+            throw common::ErrnoException(
+                      "Error setting FD_CLOEXEC on network socket");
+        }
+#endif
+
+        return Socket(fd);
+    }
+
+    //! Create a new Unix domain stream socket, for connecting to peers on the
+    //! same host with bind_unix() and connect_unix().
+    static Socket CreateUnix() {
+#ifdef SOCK_CLOEXEC
+        int fd = ::socket(PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+        int fd = ::socket(PF_UNIX, SOCK_STREAM, 0);
+#endif
+        if (fd < 0) {
+            LOG << "Socket::CreateUnix()"
+                << " fd=" << fd
+                << " error=" << strerror(errno);
+        }
+
 #ifndef SOCK_CLOEXEC
         if (fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
             throw common::ErrnoException(
@@ -300,6 +326,14 @@ public:
         return r;
     }
 
+    //! Bind a Unix domain socket to the name in the abstract namespace, which
+    //! is only supported on Linux.
+    bool bind_unix(const std::string& name);
+
+    //! Initial connection of a Unix domain socket to the name in the abstract
+    //! namespace, which is only supported on Linux.
+    int connect_unix(const std::string& name);
+
     //! Turn socket into listener state to accept incoming connections.
     bool listen(int backlog = 0) {
         assert(IsValid());
@@ -371,6 +405,26 @@ public:
         return r;
     }
 
+    //! Send count successive buffers to socket with a single sendmsg() call,
+    //! no retries for short-sends.
+    ssize_t sendv_one(const struct iovec* iov, size_t count, int flags = 0) {
+        assert(IsValid());
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = count;
+
+        ssize_t r = ::sendmsg(fd_, &msg, flags);
+
+        LOG << "done Socket::sendv_one()"
+            << " fd_=" << fd_
+            << " count=" << count
+            << " return=" << r;
+
+        return r;
+    }
+
     //! Send (data,size) to socket, retry sends if short-sends occur.
     ssize_t send(const void* data, size_t size, int flags = 0) {
         assert(IsValid());
@@ -596,6 +650,19 @@ public:
     //! Set SO_RCVBUF socket option.
     void SetRcvBuf(size_t size);
 
+    //! Enable SO_ZEROCOPY, such that sends with MSG_ZEROCOPY reference the
+    //! pages instead of copying them. Returns false if not supported.
+    bool SetZeroCopy(bool activate = true);
+
+    //! Set SO_BUSY_POLL: busy poll the device queue for up to usec
+    //! microseconds in blocking receives instead of sleeping.
+    void SetBusyPoll(size_t usec);
+
+    //! Read one MSG_ZEROCOPY completion notification from the error queue
+    //! without blocking. Returns false if none is queued, otherwise sets the
+    //! range [lo,hi] of completed zero copy send calls, numbered from zero.
+    bool recv_zerocopy_completion(uint32_t* lo, uint32_t* hi);
+
     //! \}
 
 private:
@@ -110,6 +110,15 @@ public:
         return (sockaddr()->sa_family == AF_INET6);
     }
 
+    //! Returns true if the enclosed socket address is in 127.0.0.0/8 or ::1.
+    bool IsLoopback() const {
+        if (IsIPv4())
+            return (ntohl(sockaddr_in()->sin_addr.s_addr) >> 24) == 127;
+        if (IsIPv6())
+            return IN6_IS_ADDR_LOOPBACK(&sockaddr_in6()->sin6_addr);
+        return false;
+    }
+
     //! Cast the enclosed sockaddr into the sockaddr_in IPv4 structure.
     struct sockaddr_in * sockaddr_in() {
         return &sockaddr_.in;
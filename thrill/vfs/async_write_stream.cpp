@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * thrill/vfs/async_write_stream.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/async_write_stream.hpp>
+
+#include <thrill/common/logger.hpp>
+
+#include <tlx/die.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace vfs {
+
+class AsyncWriteStream final : public virtual WriteStream
+{
+    static constexpr bool debug = false;
+
+public:
+    AsyncWriteStream(const WriteStreamPtr& output,
+                     size_t buffer_size, size_t queue_size)
+        : output_(output),
+          buffer_size_(std::max<size_t>(buffer_size, 1)),
+          queue_size_(std::max<size_t>(queue_size, 1)) {
+        buffer_.reserve(buffer_size_);
+        thread_ = std::thread([this]() { Worker(); });
+    }
+
+    ~AsyncWriteStream() {
+        if (!closed_) {
+            try {
+                close();
+            }
+            catch (std::exception& e) {
+                LOG1 << "AsyncWriteStream: error while closing: " << e.what();
+            }
+        }
+    }
+
+    ssize_t write(const void* data, const size_t size) final {
+        const char* cdata = reinterpret_cast<const char*>(data);
+        size_t rest = size;
+        while (rest != 0) {
+            size_t n = std::min(rest, buffer_size_ - buffer_.size());
+            buffer_.insert(buffer_.end(), cdata, cdata + n);
+            cdata += n;
+            rest -= n;
+
+            if (buffer_.size() == buffer_size_)
+                Enqueue();
+        }
+        return size;
+    }
+
+    void close() final {
+        if (closed_) return;
+        closed_ = true;
+
+        if (!buffer_.empty())
+            Enqueue();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_ = true;
+            cv_.notify_all();
+        }
+        thread_.join();
+
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+
+private:
+    //! output stream written by the thread
+    WriteStreamPtr output_;
+
+    //! size of the buffers handed to the thread
+    const size_t buffer_size_;
+
+    //! maximum number of full buffers in the queue
+    const size_t queue_size_;
+
+    //! buffer currently filled by write()
+    std::vector<char> buffer_;
+
+    //! full buffers waiting for the thread
+    std::deque<std::vector<char> > queue_;
+
+    //! written buffers returned for reuse
+    std::vector<std::vector<char> > free_;
+
+    //! lock for queue_, free_, done_, and error_
+    std::mutex mutex_;
+
+    //! signals changes of queue_ to both sides
+    std::condition_variable cv_;
+
+    //! set by close(), after which the thread drains the queue and stops
+    bool done_ = false;
+
+    //! whether close() was called
+    bool closed_ = false;
+
+    //! first exception of the thread
+    std::exception_ptr error_;
+
+    //! background thread writing to output_
+    std::thread thread_;
+
+    //! hand buffer_ to the thread, wait while the queue is full
+    void Enqueue() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() {
+                     return queue_.size() < queue_size_ || error_;
+                 });
+        if (error_) {
+            closed_ = true;
+            done_ = true;
+            cv_.notify_all();
+            lock.unlock();
+            thread_.join();
+            std::rethrow_exception(error_);
+        }
+
+        queue_.emplace_back(std::move(buffer_));
+        cv_.notify_all();
+
+        if (!free_.empty()) {
+            buffer_ = std::move(free_.back());
+            free_.pop_back();
+        }
+        else {
+            buffer_ = std::vector<char>();
+            buffer_.reserve(buffer_size_);
+        }
+        buffer_.clear();
+    }
+
+    void Worker() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return !queue_.empty() || done_; });
+            if (queue_.empty()) break;
+
+            std::vector<char> buffer = std::move(queue_.front());
+            queue_.pop_front();
+            cv_.notify_all();
+
+            lock.unlock();
+            try {
+                output_->write(buffer.data(), buffer.size());
+            }
+            catch (...) {
+                lock.lock();
+                error_ = std::current_exception();
+                cv_.notify_all();
+                return;
+            }
+            lock.lock();
+
+            free_.emplace_back(std::move(buffer));
+        }
+        lock.unlock();
+
+        try {
+            output_->close();
+        }
+        catch (...) {
+            lock.lock();
+            error_ = std::current_exception();
+        }
+    }
+};
+
+WriteStreamPtr MakeAsyncWriteStream(
+    const WriteStreamPtr& output, size_t buffer_size, size_t queue_size) {
+    die_unless(output);
+    return tlx::make_counting<AsyncWriteStream>(
+        output, buffer_size, queue_size);
+}
+
+WriteStreamPtr OpenAsyncWriteStream(
+    const std::string& path, size_t buffer_size, size_t queue_size) {
+    WriteStreamPtr stream = OpenWriteStream(path);
+    if (queue_size == 0)
+        return stream;
+    return MakeAsyncWriteStream(stream, buffer_size, queue_size);
+}
+
+} // namespace vfs
+} // namespace thrill
+
+/******************************************************************************/
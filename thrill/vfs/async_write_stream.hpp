@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * thrill/vfs/async_write_stream.hpp
+ *
+ * WriteStream which writes buffers to another stream in a background thread.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_VFS_ASYNC_WRITE_STREAM_HEADER
+#define THRILL_VFS_ASYNC_WRITE_STREAM_HEADER
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace thrill {
+namespace vfs {
+
+/*!
+ * Wrap output into a stream which collects the written bytes in buffers of
+ * buffer_size bytes and hands full buffers to a background thread, which
+ * writes them to output. At most queue_size full buffers wait in the queue,
+ * further writes block until the thread catches up. Hence, the caller's
+ * serialization overlaps with the compression filters and the I/O of output.
+ *
+ * Errors of the background thread are rethrown by the next write() or by
+ * close(), which waits for all buffers to be written and closes output.
+ */
+WriteStreamPtr MakeAsyncWriteStream(
+    const WriteStreamPtr& output, size_t buffer_size, size_t queue_size);
+
+//! open path with OpenWriteStream() and wrap it with MakeAsyncWriteStream(),
+//! unless queue_size is zero.
+WriteStreamPtr OpenAsyncWriteStream(
+    const std::string& path, size_t buffer_size, size_t queue_size);
+
+} // namespace vfs
+} // namespace thrill
+
+#endif // !THRILL_VFS_ASYNC_WRITE_STREAM_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,397 @@
+/*******************************************************************************
+ * thrill/vfs/bgzf_filter.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/bgzf_filter.hpp>
+
+#include <thrill/common/logger.hpp>
+
+#include <tlx/die.hpp>
+#include <tlx/string/ends_with.hpp>
+
+#if THRILL_HAVE_ZLIB
+#include <zlib.h>
+#else
+//! placeholder to destroy BgzfReader::z_stream_ without zlib
+struct z_stream_s { };
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace thrill {
+namespace vfs {
+
+/******************************************************************************/
+
+//! bytes of the BGZF header which are fixed: gzip magic, deflate, FEXTRA, the
+//! extra length 6 and the "BC" subfield of length 2. MTIME, XFL, and OS vary.
+static const uint8_t bgzf_magic[4] = { 0x1f, 0x8b, 0x08, 0x04 };
+static const uint8_t bgzf_extra[6] = { 0x06, 0x00, 'B', 'C', 0x02, 0x00 };
+
+//! empty block marking the end of a BGZF file
+static const uint8_t bgzf_eof_block[28] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+    0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+//! number of bytes following the compressed data: CRC32 and ISIZE
+static constexpr size_t bgzf_footer_size = 8;
+
+//! uncompressed bytes per block written, leaves room for incompressible data
+static constexpr size_t bgzf_write_size = 0xff00;
+
+static uint32_t GetLE16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+static uint32_t GetLE32(const uint8_t* p) {
+    return GetLE16(p) | (GetLE16(p + 2) << 16);
+}
+
+static void PutLE16(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static void PutLE32(uint8_t* p, uint32_t v) {
+    PutLE16(p, v);
+    PutLE16(p + 2, v >> 16);
+}
+
+size_t BgzfReader::BlockSize(const uint8_t* p) {
+    if (memcmp(p, bgzf_magic, sizeof(bgzf_magic)) != 0 ||
+        memcmp(p + 10, bgzf_extra, sizeof(bgzf_extra)) != 0)
+        return 0;
+    size_t size = GetLE16(p + 16) + 1;
+    return size >= header_size + bgzf_footer_size ? size : 0;
+}
+
+#if THRILL_HAVE_ZLIB
+
+bool IsBgzf(const std::string& path) {
+    if (!tlx::ends_with(path, ".gz") && !tlx::ends_with(path, ".bgz"))
+        return false;
+
+    ReadStreamPtr stream = OpenRawReadStream(path);
+    uint8_t header[BgzfReader::header_size];
+    size_t size = 0;
+    while (size < sizeof(header)) {
+        ssize_t rb = stream->read(header + size, sizeof(header) - size);
+        if (rb <= 0) break;
+        size += rb;
+    }
+    stream->close();
+
+    return size == sizeof(header) && BgzfReader::BlockSize(header) != 0;
+}
+
+/******************************************************************************/
+// BgzfWriteFilter - compress into independent gzip blocks
+
+//! blocks compressed per thread in one batch of parallel compression
+static constexpr size_t bgzf_batch_per_thread = 4;
+
+class BgzfWriteFilter final : public virtual WriteStream
+{
+public:
+    BgzfWriteFilter(const WriteStreamPtr& output, size_t threads)
+        : output_(output), threads_(std::max<size_t>(threads, 1)),
+          slots_(threads_ == 1 ? 1 : threads_ * bgzf_batch_per_thread) {
+        for (Slot& slot : slots_) {
+            memset(&slot.zs, 0, sizeof(slot.zs));
+
+            // negative windowBits: raw deflate, the header is written by us.
+            int err = deflateInit2(
+                &slot.zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                -15, /* memLevel */ 8, Z_DEFAULT_STRATEGY);
+            die_unequal(err, Z_OK);
+
+            slot.input.reserve(bgzf_write_size);
+            slot.block.resize(BgzfReader::max_block_size);
+        }
+
+        initialized_ = true;
+    }
+
+    ~BgzfWriteFilter() {
+        close();
+    }
+
+    ssize_t write(const void* data, const size_t size) final {
+        const uint8_t* cdata = reinterpret_cast<const uint8_t*>(data);
+        size_t rest = size;
+        while (rest != 0) {
+            std::vector<uint8_t>& input = slots_[filled_].input;
+            size_t n = std::min(rest, bgzf_write_size - input.size());
+            input.insert(input.end(), cdata, cdata + n);
+            cdata += n;
+            rest -= n;
+
+            if (input.size() == bgzf_write_size && ++filled_ == slots_.size())
+                WriteBlocks();
+        }
+        return size;
+    }
+
+    void close() final {
+        if (!initialized_) return;
+
+        if (!slots_[filled_].input.empty())
+            ++filled_;
+        WriteBlocks();
+        output_->write(bgzf_eof_block, sizeof(bgzf_eof_block));
+        output_->close();
+
+        for (Slot& slot : slots_)
+            deflateEnd(&slot.zs);
+        initialized_ = false;
+    }
+
+private:
+    //! uncompressed data of a block, its zlib context and compressed block
+    struct Slot {
+        //! zlib context
+        z_stream zs;
+        //! uncompressed data of the block
+        std::vector<uint8_t> input;
+        //! compressed block including header and footer
+        std::vector<uint8_t> block;
+        //! size of the compressed block
+        size_t size;
+    };
+
+    //! if the z_streams are initialized
+    bool initialized_;
+
+    //! output stream for writing data somewhere
+    WriteStreamPtr output_;
+
+    //! threads compressing the blocks of a batch
+    size_t threads_;
+
+    //! a batch of independent blocks, compressed in parallel
+    std::vector<Slot> slots_;
+
+    //! number of full slots, slots_[filled_] is being filled
+    size_t filled_ = 0;
+
+    //! compress the filled slots, using threads_ threads, and write them in
+    //! order
+    void WriteBlocks() {
+        if (filled_ == 1 || threads_ == 1) {
+            for (size_t i = 0; i < filled_; ++i)
+                CompressBlock(slots_[i]);
+        }
+        else {
+            size_t threads = std::min(threads_, filled_);
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (size_t t = 1; t < threads; ++t) {
+                workers.emplace_back([this, t, threads]() {
+                                         for (size_t i = t; i < filled_;
+                                              i += threads)
+                                             CompressBlock(slots_[i]);
+                                     });
+            }
+            for (size_t i = 0; i < filled_; i += threads)
+                CompressBlock(slots_[i]);
+            for (std::thread& w : workers)
+                w.join();
+        }
+
+        for (size_t i = 0; i < filled_; ++i) {
+            output_->write(slots_[i].block.data(), slots_[i].size);
+            slots_[i].input.clear();
+        }
+        filled_ = 0;
+    }
+
+    //! compress the input of slot into one block
+    static void CompressBlock(Slot& slot) {
+        const size_t header_size = BgzfReader::header_size;
+        z_stream& zs = slot.zs;
+        std::vector<uint8_t>& block = slot.block;
+
+        int err = deflateReset(&zs);
+        die_unequal(err, Z_OK);
+
+        zs.next_in = slot.input.data();
+        zs.avail_in = static_cast<uInt>(slot.input.size());
+        zs.next_out = block.data() + header_size;
+        zs.avail_out = static_cast<uInt>(
+            block.size() - header_size - bgzf_footer_size);
+
+        // bgzf_write_size bytes always fit, even if incompressible.
+        err = deflate(&zs, Z_FINISH);
+        die_unequal(err, Z_STREAM_END);
+
+        size_t size = header_size + zs.total_out + bgzf_footer_size;
+
+        memcpy(block.data(), bgzf_magic, sizeof(bgzf_magic));
+        memset(block.data() + 4, 0, 6);
+        block[9] = 0xff; // OS unknown
+        memcpy(block.data() + 10, bgzf_extra, sizeof(bgzf_extra));
+        PutLE16(block.data() + 16, static_cast<uint32_t>(size - 1));
+
+        uint8_t* footer = block.data() + size - bgzf_footer_size;
+        PutLE32(footer, static_cast<uint32_t>(
+                    crc32(0, slot.input.data(),
+                          static_cast<uInt>(slot.input.size()))));
+        PutLE32(footer + 4, static_cast<uint32_t>(slot.input.size()));
+
+        slot.size = size;
+    }
+};
+
+WriteStreamPtr MakeBgzfWriteFilter(
+    const WriteStreamPtr& stream, size_t threads) {
+    die_unless(stream);
+    return tlx::make_counting<BgzfWriteFilter>(stream, threads);
+}
+
+/******************************************************************************/
+// BgzfReader
+
+BgzfReader::BgzfReader(const std::string& path, uint64_t offset)
+    : stream_(OpenRawReadStream(path, common::Range(offset, 0))),
+      in_(4 * max_block_size), in_offset_(offset),
+      z_stream_(std::make_unique<z_stream_s>()) {
+
+    memset(z_stream_.get(), 0, sizeof(z_stream_s));
+    int err = inflateInit2(z_stream_.get(), -15);
+    die_unequal(err, Z_OK);
+
+    if (offset != 0)
+        SeekBlock();
+}
+
+BgzfReader::~BgzfReader() {
+    inflateEnd(z_stream_.get());
+    stream_->close();
+}
+
+void BgzfReader::Fill(size_t size) {
+    if (in_end_ - in_pos_ >= size || eof_) return;
+
+    // move remaining data to the front
+    memmove(in_.data(), in_.data() + in_pos_, in_end_ - in_pos_);
+    in_offset_ += in_pos_;
+    in_end_ -= in_pos_;
+    in_pos_ = 0;
+
+    while (in_end_ < size) {
+        ssize_t rb = stream_->read(in_.data() + in_end_, in_.size() - in_end_);
+        if (rb < 0)
+            throw common::ErrnoException("BgzfReader: read error");
+        if (rb == 0) {
+            eof_ = true;
+            break;
+        }
+        in_end_ += rb;
+    }
+}
+
+void BgzfReader::SeekBlock() {
+    while (true) {
+        // a candidate header and the header of the following block
+        Fill(max_block_size + header_size);
+        if (in_end_ - in_pos_ < header_size) {
+            in_pos_ = in_end_;
+            return;
+        }
+
+        size_t size = BlockSize(in_.data() + in_pos_);
+        if (size != 0) {
+            size_t next = in_pos_ + size;
+            if ((eof_ && next == in_end_) ||
+                (next + header_size <= in_end_ &&
+                 BlockSize(in_.data() + next) != 0)) {
+                LOG << "BgzfReader: found block at offset "
+                    << in_offset_ + in_pos_;
+                return;
+            }
+        }
+
+        // skip to the next possible magic byte
+        const void* p = memchr(in_.data() + in_pos_ + 1, bgzf_magic[0],
+                               in_end_ - in_pos_ - 1);
+        in_pos_ = p ? static_cast<const uint8_t*>(p) - in_.data() : in_end_;
+    }
+}
+
+bool BgzfReader::ReadBlock(void* data, size_t* size) {
+    Fill(header_size);
+    if (in_pos_ == in_end_)
+        return false;
+
+    block_offset_ = in_offset_ + in_pos_;
+
+    size_t bsize = in_end_ - in_pos_ >= header_size
+                   ? BlockSize(in_.data() + in_pos_) : 0;
+    if (bsize == 0)
+        die("BgzfReader: invalid block header at offset " << block_offset_);
+
+    Fill(bsize);
+    if (in_end_ - in_pos_ < bsize)
+        die("BgzfReader: truncated block at offset " << block_offset_);
+
+    const uint8_t* block = in_.data() + in_pos_;
+
+    int err = inflateReset(z_stream_.get());
+    die_unequal(err, Z_OK);
+
+    z_stream_->next_in = const_cast<Bytef*>(block + header_size);
+    z_stream_->avail_in = static_cast<uInt>(
+        bsize - header_size - bgzf_footer_size);
+    z_stream_->next_out = reinterpret_cast<Bytef*>(data);
+    z_stream_->avail_out = static_cast<uInt>(max_block_size);
+
+    err = inflate(z_stream_.get(), Z_FINISH);
+    if (err != Z_STREAM_END)
+        die("BgzfReader: corrupt block at offset " << block_offset_);
+
+    *size = z_stream_->total_out;
+    die_unequal(*size, GetLE32(block + bsize - 4));
+
+    in_pos_ += bsize;
+    return true;
+}
+
+/******************************************************************************/
+
+#else   // !THRILL_HAVE_ZLIB
+
+bool IsBgzf(const std::string&) {
+    return false;
+}
+
+WriteStreamPtr MakeBgzfWriteFilter(const WriteStreamPtr&, size_t) {
+    die(".bgz compression is not available, "
+        "because Thrill was built without zlib.");
+}
+
+BgzfReader::BgzfReader(const std::string&, uint64_t) {
+    die(".bgz decompression is not available, "
+        "because Thrill was built without zlib.");
+}
+
+BgzfReader::~BgzfReader() { }
+
+bool BgzfReader::ReadBlock(void*, size_t*) {
+    return false;
+}
+
+#endif
+
+} // namespace vfs
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * thrill/vfs/bgzf_filter.hpp
+ *
+ * Blocked gzip (BGZF) files as written by bgzip, which can be split between
+ * workers at block boundaries.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_VFS_BGZF_FILTER_HEADER
+#define THRILL_VFS_BGZF_FILTER_HEADER
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+
+namespace thrill {
+namespace vfs {
+
+//! Returns true if the file at path is a .gz or .bgz file starting with a BGZF
+//! block header. Always false if Thrill was built without zlib.
+bool IsBgzf(const std::string& path);
+
+//! Compress into BGZF blocks, the output is a valid gzip file. With more than
+//! one thread, batches of blocks are compressed in parallel.
+WriteStreamPtr MakeBgzfWriteFilter(
+    const WriteStreamPtr& stream, size_t threads = 1);
+
+/*!
+ * Reader for the blocks of a BGZF file. A BGZF file is a sequence of gzip
+ * members, each at most 64 KiB compressed and uncompressed, with an extra
+ * header field containing the compressed size. Hence blocks can be found from
+ * any byte offset by scanning for a header and decompressed independently.
+ *
+ * The reader starts at the first block beginning at or after the given offset.
+ * Candidate headers are verified by checking that the next block follows
+ * directly.
+ */
+class BgzfReader
+{
+    static constexpr bool debug = false;
+
+public:
+    //! maximum uncompressed and compressed size of a block
+    static constexpr size_t max_block_size = 65536;
+
+    //! size of the block header
+    static constexpr size_t header_size = 18;
+
+    //! open file at path and find the first block at or after offset.
+    BgzfReader(const std::string& path, uint64_t offset);
+
+    //! non-copyable: delete copy-constructor
+    BgzfReader(const BgzfReader&) = delete;
+    //! non-copyable: delete assignment operator
+    BgzfReader& operator = (const BgzfReader&) = delete;
+
+    ~BgzfReader();
+
+    //! decompress the next block into data, which must hold max_block_size
+    //! bytes. Returns false at the end of the file.
+    bool ReadBlock(void* data, size_t* size);
+
+    //! file offset of the block returned by the last ReadBlock().
+    uint64_t block_offset() const { return block_offset_; }
+
+    //! check whether p points to a BGZF block header, returns the compressed
+    //! size of the block or zero.
+    static size_t BlockSize(const uint8_t* p);
+
+private:
+    //! raw stream of the file
+    ReadStreamPtr stream_;
+
+    //! input buffer holding at least two blocks
+    std::vector<uint8_t> in_;
+
+    //! window [in_pos_, in_end_) of unprocessed data in in_
+    size_t in_pos_ = 0, in_end_ = 0;
+
+    //! file offset of in_[0]
+    uint64_t in_offset_;
+
+    //! stream_ reached the end of the file
+    bool eof_ = false;
+
+    //! file offset of the last block returned
+    uint64_t block_offset_ = 0;
+
+    //! zlib context for raw inflate
+    std::unique_ptr<z_stream_s> z_stream_;
+
+    //! read more data until at least size bytes are available or EOF.
+    void Fill(size_t size);
+
+    //! advance in_pos_ to the first verified block header.
+    void SeekBlock();
+};
+
+} // namespace vfs
+} // namespace thrill
+
+#endif // !THRILL_VFS_BGZF_FILTER_HEADER
+
+/******************************************************************************/
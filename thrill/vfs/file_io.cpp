@@ -12,11 +12,14 @@
 #include <thrill/vfs/file_io.hpp>
 
 #include <thrill/common/string.hpp>
+#include <thrill/vfs/bgzf_filter.hpp>
 #include <thrill/vfs/bzip2_filter.hpp>
 #include <thrill/vfs/gzip_filter.hpp>
 #include <thrill/vfs/hdfs3_file.hpp>
+#include <thrill/vfs/lz4_filter.hpp>
 #include <thrill/vfs/s3_file.hpp>
 #include <thrill/vfs/sys_file.hpp>
+#include <thrill/vfs/zstd_filter.hpp>
 
 #include <tlx/die.hpp>
 #include <tlx/string/ends_with.hpp>
@@ -24,7 +27,14 @@
 #include <tlx/string/starts_with.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -46,10 +56,12 @@ void Deinitialize() {
 
 bool IsCompressed(const std::string& path) {
     return tlx::ends_with(path, ".gz") ||
+           tlx::ends_with(path, ".bgz") ||
            tlx::ends_with(path, ".bz2") ||
            tlx::ends_with(path, ".xz") ||
            tlx::ends_with(path, ".lzo") ||
-           tlx::ends_with(path, ".lz4");
+           tlx::ends_with(path, ".lz4") ||
+           tlx::ends_with(path, ".zst");
 }
 
 bool IsRemoteUri(const std::string& path) {
@@ -125,12 +137,87 @@ std::string FillFilePattern(const std::string& pathbase,
 
 /******************************************************************************/
 
+//! cached listing of a remote glob
+struct GlobCacheEntry {
+    std::chrono::steady_clock::time_point time;
+    std::vector<FileInfo> files;
+};
+
+//! process-wide cache of remote listings, shared by all workers of the host
+static std::mutex s_glob_cache_mutex;
+static std::map<std::pair<std::string, GlobType>, GlobCacheEntry> s_glob_cache;
+
+//! seconds for which remote listings are cached (THRILL_GLOB_CACHE_EXPIRY)
+static std::chrono::seconds GlobCacheExpiry() {
+    static const std::chrono::seconds expiry(
+        [] {
+            const char* env = getenv("THRILL_GLOB_CACHE_EXPIRY");
+            return env != nullptr && *env != 0 ? std::strtoul(env, nullptr, 10)
+                   : 60;
+        } ());
+    return expiry;
+}
+
+void ClearGlobCache() {
+    std::unique_lock<std::mutex> lock(s_glob_cache_mutex);
+    s_glob_cache.clear();
+}
+
+//! run glob_fn for a remote path, or append its cached listing.
+template <typename GlobFunction>
+static void CachedGlob(const std::string& path, const GlobType& gtype,
+                       FileList& filelist, GlobFunction glob_fn) {
+    std::chrono::seconds expiry = GlobCacheExpiry();
+    if (expiry.count() == 0)
+        return glob_fn(path, gtype, filelist);
+
+    auto key = std::make_pair(path, gtype);
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(s_glob_cache_mutex);
+        auto it = s_glob_cache.find(key);
+        if (it != s_glob_cache.end() && now - it->second.time < expiry) {
+            filelist.insert(filelist.end(),
+                            it->second.files.begin(), it->second.files.end());
+            return;
+        }
+    }
+
+    // list without holding the lock, concurrent misses list twice.
+    FileList listed;
+    glob_fn(path, gtype, listed);
+    filelist.insert(filelist.end(), listed.begin(), listed.end());
+
+    std::unique_lock<std::mutex> lock(s_glob_cache_mutex);
+    s_glob_cache[key] = GlobCacheEntry { now, std::move(listed) };
+}
+
+void FileList::CalculateStats() {
+    contains_compressed = false;
+    contains_remote_uri = false;
+    contains_block_locations = false;
+    total_size = 0;
+    uint64_t size_ex_psum = 0;
+
+    for (FileInfo& fi : *this)
+    {
+        uint64_t size_next = size_ex_psum + fi.size;
+        fi.size_ex_psum = size_ex_psum;
+        size_ex_psum = size_next;
+
+        contains_compressed |= fi.IsCompressed();
+        contains_remote_uri |= fi.IsRemoteUri();
+        contains_block_locations |= !fi.blocks.empty();
+        total_size += fi.size;
+    }
+}
+
 FileList Glob(const std::vector<std::string>& globlist, const GlobType& gtype) {
     FileList filelist;
 
     // run through globs and collect files. The sub-Glob() methods must only
-    // fill in the fields "path" and "size" of FileInfo, overall stats are
-    // calculated afterwards.
+    // fill in the fields "path", "size", and optionally "blocks" of FileInfo,
+    // overall stats are calculated afterwards.
     for (const std::string& path : globlist)
     {
         if (tlx::starts_with(path, "file://")) {
@@ -138,10 +225,10 @@ FileList Glob(const std::vector<std::string>& globlist, const GlobType& gtype) {
             SysGlob(path.substr(7), gtype, filelist);
         }
         else if (tlx::starts_with(path, "s3://")) {
-            S3Glob(path, gtype, filelist);
+            CachedGlob(path, gtype, filelist, S3Glob);
         }
         else if (tlx::starts_with(path, "hdfs://")) {
-            Hdfs3Glob(path, gtype, filelist);
+            CachedGlob(path, gtype, filelist, Hdfs3Glob);
         }
         else {
             SysGlob(path, gtype, filelist);
@@ -149,24 +236,104 @@ FileList Glob(const std::vector<std::string>& globlist, const GlobType& gtype) {
     }
 
     // calculate exclusive prefix sum and overall stats
+    filelist.CalculateStats();
 
-    filelist.contains_compressed = false;
-    filelist.contains_remote_uri = false;
-    filelist.total_size = 0;
-    uint64_t size_ex_psum = 0;
+    return filelist;
+}
 
-    for (FileInfo& fi : filelist)
-    {
-        uint64_t size_next = size_ex_psum + fi.size;
-        fi.size_ex_psum = size_ex_psum;
-        size_ex_psum = size_next;
+//! host name without domain, as distributed file systems may report fully
+//! qualified names.
+static std::string ShortHostname(const std::string& host) {
+    return host.substr(0, host.find('.'));
+}
 
-        filelist.contains_compressed |= fi.IsCompressed();
-        filelist.contains_remote_uri |= fi.IsRemoteUri();
-        filelist.total_size += fi.size;
+std::vector<size_t> AssignPartsByLocality(
+    const FileList& files, uint64_t global_size, uint64_t unit_size,
+    const std::vector<std::string>& worker_hosts) {
+
+    size_t num_parts = worker_hosts.size();
+
+    // free workers on each host, in order of their rank
+    std::map<std::string, std::deque<size_t> > host_workers;
+    for (size_t w = 0; w < num_parts; ++w)
+        host_workers[ShortHostname(worker_hosts[w])].push_back(w);
+
+    // bytes of each part stored on each host: sweep over the parts and the
+    // blocks in order of their global byte offsets.
+    struct Candidate {
+        uint64_t    bytes;
+        size_t      part;
+        std::string host;
+    };
+    std::vector<Candidate> candidates;
+
+    size_t file_nr = 0, block_nr = 0;
+    for (size_t p = 0; p < num_parts; ++p) {
+        common::Range r =
+            common::CalculateLocalRange(global_size, num_parts, p);
+        uint64_t begin = r.begin * unit_size, end = r.end * unit_size;
+
+        std::map<std::string, uint64_t> host_bytes;
+
+        while (file_nr < files.size()) {
+            const FileInfo& fi = files[file_nr];
+            if (block_nr >= fi.blocks.size()) {
+                ++file_nr, block_nr = 0;
+                continue;
+            }
+
+            const FileBlock& fb = fi.blocks[block_nr];
+            uint64_t block_begin = fi.size_ex_psum + fb.offset;
+            uint64_t block_end = block_begin + fb.size;
+            if (block_begin >= end) break;
+
+            if (block_end > begin) {
+                uint64_t overlap =
+                    std::min(block_end, end) - std::max(block_begin, begin);
+                for (const std::string& host : fb.hosts)
+                    host_bytes[ShortHostname(host)] += overlap;
+            }
+
+            // keep blocks reaching into the next part
+            if (block_end > end) break;
+            ++block_nr;
+        }
+
+        for (const auto& hb : host_bytes) {
+            if (host_workers.count(hb.first))
+                candidates.emplace_back(Candidate { hb.second, p, hb.first });
+        }
     }
 
-    return filelist;
+    // greedily assign parts with the most local bytes first
+    std::stable_sort(
+        candidates.begin(), candidates.end(),
+        [](const Candidate& a, const Candidate& b) {
+            return a.bytes > b.bytes;
+        });
+
+    static constexpr size_t none = std::numeric_limits<size_t>::max();
+    std::vector<size_t> worker_part(num_parts, none);
+    std::vector<bool> part_done(num_parts, false);
+
+    for (const Candidate& c : candidates) {
+        std::deque<size_t>& free = host_workers[c.host];
+        if (part_done[c.part] || free.empty()) continue;
+        worker_part[free.front()] = c.part;
+        free.pop_front();
+        part_done[c.part] = true;
+    }
+
+    // assign remaining parts to remaining workers in order
+    size_t p = 0;
+    for (size_t w = 0; w < num_parts; ++w) {
+        if (worker_part[w] != none) continue;
+        while (part_done[p]) ++p;
+        worker_part[w] = p;
+        part_done[p] = true;
+    }
+
+    return worker_part;
 }
 
 FileList Glob(const std::string& glob, const GlobType& gtype) {
@@ -177,7 +344,7 @@ FileList Glob(const std::string& glob, const GlobType& gtype) {
 
 ReadStream::~ReadStream() { }
 
-ReadStreamPtr OpenReadStream(
+ReadStreamPtr OpenRawReadStream(
     const std::string& path, const common::Range& range) {
 
     ReadStreamPtr p;
@@ -194,7 +361,16 @@ ReadStreamPtr OpenReadStream(
         p = SysOpenReadStream(path, range);
     }
 
-    if (tlx::ends_with(path, ".gz")) {
+    return p;
+}
+
+ReadStreamPtr OpenReadStream(
+    const std::string& path, const common::Range& range) {
+
+    ReadStreamPtr p = OpenRawReadStream(path, range);
+
+    // BGZF files are gzip files consisting of many members
+    if (tlx::ends_with(path, ".gz") || tlx::ends_with(path, ".bgz")) {
         p = MakeGZipReadFilter(p);
         die_unless(range.begin == 0 || "Cannot seek in compressed streams.");
     }
@@ -202,6 +378,18 @@ ReadStreamPtr OpenReadStream(
         p = MakeBZip2ReadFilter(p);
         die_unless(range.begin == 0 || "Cannot seek in compressed streams.");
     }
+#if THRILL_HAVE_ZSTD
+    else if (tlx::ends_with(path, ".zst")) {
+        p = MakeZstdReadFilter(p);
+        die_unless(range.begin == 0 || "Cannot seek in compressed streams.");
+    }
+#endif
+#if THRILL_HAVE_LZ4
+    else if (tlx::ends_with(path, ".lz4")) {
+        p = MakeLz4ReadFilter(p);
+        die_unless(range.begin == 0 || "Cannot seek in compressed streams.");
+    }
+#endif
 
     return p;
 }
@@ -215,9 +403,12 @@ WriteStreamPtr OpenWriteStream(const std::string& path) {
         p = SysOpenWriteStream(path.substr(7));
     }
     else if (tlx::starts_with(path, "s3://")) {
+        // the cached listings may miss the new object
+        ClearGlobCache();
         p = S3OpenWriteStream(path);
     }
     else if (tlx::starts_with(path, "hdfs://")) {
+        ClearGlobCache();
         p = Hdfs3OpenWriteStream(path);
     }
     else {
@@ -227,9 +418,34 @@ WriteStreamPtr OpenWriteStream(const std::string& path) {
     if (tlx::ends_with(path, ".gz")) {
         p = MakeGZipWriteFilter(p);
     }
+    else if (tlx::ends_with(path, ".bgz")) {
+        size_t threads = 1;
+        if (const char* env_threads = getenv("THRILL_BGZF_THREADS"))
+            threads = static_cast<size_t>(atoi(env_threads));
+        p = MakeBgzfWriteFilter(p, threads);
+    }
     else if (tlx::ends_with(path, ".bz2")) {
         p = MakeBZip2WriteFilter(p);
     }
+#if THRILL_HAVE_ZSTD
+    else if (tlx::ends_with(path, ".zst")) {
+        int level = 3;
+        unsigned threads = 0;
+        if (const char* env_level = getenv("THRILL_ZSTD_LEVEL"))
+            level = atoi(env_level);
+        if (const char* env_threads = getenv("THRILL_ZSTD_THREADS"))
+            threads = static_cast<unsigned>(atoi(env_threads));
+        p = MakeZstdWriteFilter(p, level, threads);
+    }
+#endif
+#if THRILL_HAVE_LZ4
+    else if (tlx::ends_with(path, ".lz4")) {
+        int level = 0;
+        if (const char* env_level = getenv("THRILL_LZ4_LEVEL"))
+            level = atoi(env_level);
+        p = MakeLz4WriteFilter(p, level);
+    }
+#endif
 
     return p;
 }
@@ -42,7 +42,7 @@ std::string FillFilePattern(const std::string& pathbase,
                             size_t worker, size_t file_part);
 
 //! Returns true, if file at filepath is compressed (e.g, ends with
-//! '.{gz,bz2,xz,lzo}')
+//! '.{gz,bgz,bz2,xz,lzo,lz4,zst}')
 bool IsCompressed(const std::string& path);
 
 //! Returns true, if file at filepath is a remote uri like s3:// or hdfs://
@@ -53,6 +53,16 @@ enum class Type { File, Directory };
 
 std::ostream& operator << (std::ostream& os, const Type& t);
 
+//! Location of a block of a file on a distributed file system.
+struct FileBlock {
+    //! byte offset of the block in the file
+    uint64_t                 offset;
+    //! size of the block
+    uint64_t                 size;
+    //! hosts storing replicas of the block
+    std::vector<std::string> hosts;
+};
+
 //! General information of vfs file.
 struct FileInfo {
     //! type of entry
@@ -63,6 +73,10 @@ struct FileInfo {
     uint64_t    size;
     //! exclusive prefix sum of file sizes.
     uint64_t    size_ex_psum;
+    //! modification time in seconds since the epoch, zero if unknown.
+    uint64_t    mtime = 0;
+    //! block locations on a distributed file system, empty if unknown.
+    std::vector<FileBlock> blocks;
 
     //! inclusive prefix sum of file sizes.
     uint64_t size_inc_psum() const { return size_ex_psum + size; }
@@ -86,6 +100,9 @@ struct FileList : public std::vector<FileInfo> {
     //! whether the list contains a remote-uri file.
     bool     contains_remote_uri;
 
+    //! whether the list contains a file with block locations.
+    bool     contains_block_locations;
+
     //! inclusive prefix sum of file sizes (only for symmetry with ex_psum)
     uint64_t size_inc_psum(size_t i) const
     { return operator [] (i).size_inc_psum(); }
@@ -93,6 +110,10 @@ struct FileList : public std::vector<FileInfo> {
     //! exclusive prefix sum of file sizes with total_size as sentinel
     uint64_t size_ex_psum(size_t i) const
     { return i < size() ? operator [] (i).size_ex_psum : total_size; }
+
+    //! calculate the prefix sums of the sizes and the overall info from the
+    //! entries' path, size, and blocks.
+    void CalculateStats();
 };
 
 //! Type of objects to include in glob result.
@@ -111,6 +132,23 @@ FileList Glob(const std::string& glob, const GlobType& gtype = GlobType::All);
 FileList Glob(const std::vector<std::string>& globlist,
               const GlobType& gtype = GlobType::All);
 
+/*!
+ * Drop the process-wide cache of s3:// and hdfs:// listings, which Glob() keeps
+ * for THRILL_GLOB_CACHE_EXPIRY seconds (default: 60, 0 disables it). Opening a
+ * remote write stream clears the cache.
+ */
+void ClearGlobCache();
+
+/*!
+ * Assigns the parts of an equal split of global_size units of unit_size bytes
+ * of the files to the workers running on worker_hosts, such that workers
+ * preferably get a part whose blocks are stored on their host. Returns the
+ * index of the part of each worker.
+ */
+std::vector<size_t> AssignPartsByLocality(
+    const FileList& files, uint64_t global_size, uint64_t unit_size,
+    const std::vector<std::string>& worker_hosts);
+
 /******************************************************************************/
 
 /*!
@@ -161,6 +199,13 @@ using WriteStreamPtr = tlx::CountingPtr<WriteStream>;
 ReadStreamPtr OpenReadStream(
     const std::string& path, const common::Range& range = common::Range());
 
+/*!
+ * Construct reader for given path uri like OpenReadStream(), but without the
+ * decompression filter selected by the file's extension.
+ */
+ReadStreamPtr OpenRawReadStream(
+    const std::string& path, const common::Range& range = common::Range());
+
 WriteStreamPtr OpenWriteStream(const std::string& path);
 
 /******************************************************************************/
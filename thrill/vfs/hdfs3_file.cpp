@@ -20,6 +20,8 @@
 #endif
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <mutex>
 #include <string>
@@ -96,6 +98,13 @@ hdfsFS Hdfs3FindConnection(const std::string& hostport) {
     if (user)
         hdfsBuilderSetUserName(builder, user);
 
+    // read blocks stored on this host directly from the local disk via the
+    // datanode's domain socket.
+    if (const char* env_socket = getenv("THRILL_HDFS_DOMAIN_SOCKET")) {
+        hdfsBuilderConfSetStr(builder, "dfs.client.read.shortcircuit", "true");
+        hdfsBuilderConfSetStr(builder, "dfs.domain.socket.path", env_socket);
+    }
+
     hdfsFS hdfs = hdfsBuilderConnect(builder);
     if (!hdfs)
         die("Could not connect to HDFS server \"" << hostport << "\""
@@ -108,6 +117,31 @@ hdfsFS Hdfs3FindConnection(const std::string& hostport) {
 /******************************************************************************/
 // List Directory Contents on HDFS
 
+//! fill in the locations of the blocks of the file at path
+static void Hdfs3GetBlocks(hdfsFS fs, const char* path, FileInfo& fi) {
+    int num_blocks = 0;
+    BlockLocation* blocks = hdfsGetFileBlockLocations(
+        fs, path, /* start */ 0, /* length */ fi.size, &num_blocks);
+    if (!blocks) {
+        LOG1 << "Could not get block locations of HDFS file \"" << path << "\""
+             << ": " << hdfsGetLastError();
+        return;
+    }
+
+    for (int b = 0; b < num_blocks; ++b) {
+        FileBlock fb;
+        fb.offset = blocks[b].offset;
+        fb.size = blocks[b].length;
+        for (int h = 0; h < blocks[b].numOfNodes; ++h)
+            fb.hosts.emplace_back(blocks[b].hosts[h]);
+        fi.blocks.emplace_back(std::move(fb));
+    }
+
+    hdfsFreeFileBlockLocations(blocks, num_blocks);
+
+    sLOG << "Hdfs3Glob:" << path << "has" << fi.blocks.size() << "blocks";
+}
+
 void Hdfs3Glob(const std::string& _path, const GlobType& gtype,
                FileList& filelist) {
 
@@ -125,6 +159,10 @@ void Hdfs3Glob(const std::string& _path, const GlobType& gtype,
     // prepend root /
     splitted[1] = "/" + splitted[1];
 
+    // query block locations for locality-aware reading
+    const char* env_locality = getenv("THRILL_HDFS_LOCALITY");
+    bool locality = env_locality && strcmp(env_locality, "1") == 0;
+
     // list directory
     int num_entries = 0;
     hdfsFileInfo* list = hdfsListDirectory(
@@ -150,6 +188,9 @@ void Hdfs3Glob(const std::string& _path, const GlobType& gtype,
                     fi.path.resize(fi.path.size() - 1);
                 fi.type = Type::File;
                 fi.size = list[i].mSize;
+                fi.mtime = static_cast<uint64_t>(list[i].mLastMod);
+                if (locality)
+                    Hdfs3GetBlocks(fs, list[i].mName, fi);
                 filelist.emplace_back(fi);
             }
         }
@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * thrill/vfs/lz4_filter.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/lz4_filter.hpp>
+
+#include <thrill/common/system_exception.hpp>
+
+#include <tlx/die.hpp>
+
+#if THRILL_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace thrill {
+namespace vfs {
+
+#if THRILL_HAVE_LZ4
+
+/******************************************************************************/
+// Lz4WriteFilter - on-the-fly lz4 frame compressor
+
+class Lz4WriteFilter final : public virtual WriteStream
+{
+public:
+    Lz4WriteFilter(const WriteStreamPtr& output, int level)
+        : output_(output) {
+        size_t ret = LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION);
+        if (LZ4F_isError(ret))
+            die("LZ4F_createCompressionContext() failed: "
+                << LZ4F_getErrorName(ret));
+
+        memset(&prefs_, 0, sizeof(prefs_));
+        prefs_.compressionLevel = level;
+        prefs_.frameInfo.blockSizeID = LZ4F_max256KB;
+        prefs_.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+        // output buffer large enough for any chunk plus buffered data
+        buffer_.resize(LZ4F_compressBound(chunk_size, &prefs_));
+
+        ret = LZ4F_compressBegin(
+            cctx_, buffer_.data(), buffer_.size(), &prefs_);
+        Write(ret, "LZ4F_compressBegin");
+
+        initialized_ = true;
+    }
+
+    ~Lz4WriteFilter() {
+        close();
+    }
+
+    ssize_t write(const void* data, const size_t size) final {
+        const char* cdata = reinterpret_cast<const char*>(data);
+        size_t rest = size;
+        while (rest != 0) {
+            size_t n = std::min(rest, chunk_size);
+            size_t ret = LZ4F_compressUpdate(
+                cctx_, buffer_.data(), buffer_.size(), cdata, n, nullptr);
+            Write(ret, "LZ4F_compressUpdate");
+            cdata += n;
+            rest -= n;
+        }
+        return size;
+    }
+
+    void close() final {
+        if (!initialized_) return;
+
+        size_t ret = LZ4F_compressEnd(
+            cctx_, buffer_.data(), buffer_.size(), nullptr);
+        Write(ret, "LZ4F_compressEnd");
+
+        output_->close();
+
+        LZ4F_freeCompressionContext(cctx_);
+        initialized_ = false;
+    }
+
+private:
+    //! maximum input size passed to LZ4F_compressUpdate()
+    static constexpr size_t chunk_size = 1024 * 1024;
+
+    //! if cctx_ is initialized
+    bool initialized_ = false;
+
+    //! lz4 frame context
+    LZ4F_cctx* cctx_;
+
+    //! frame parameters
+    LZ4F_preferences_t prefs_;
+
+    //! compression buffer, flushed to output after each call
+    std::vector<char> buffer_;
+
+    //! output stream for writing data somewhere
+    WriteStreamPtr output_;
+
+    //! check result of an LZ4F function and write its output
+    void Write(size_t ret, const char* func) {
+        if (LZ4F_isError(ret))
+            die(func << "() failed: " << LZ4F_getErrorName(ret));
+        if (ret != 0)
+            output_->write(buffer_.data(), ret);
+    }
+};
+
+WriteStreamPtr MakeLz4WriteFilter(const WriteStreamPtr& stream, int level) {
+    die_unless(stream);
+    return tlx::make_counting<Lz4WriteFilter>(stream, level);
+}
+
+/******************************************************************************/
+// Lz4ReadFilter - on-the-fly lz4 frame decompressor
+
+class Lz4ReadFilter : public virtual ReadStream
+{
+public:
+    explicit Lz4ReadFilter(const ReadStreamPtr& input)
+        : input_(input) {
+        size_t ret = LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION);
+        if (LZ4F_isError(ret))
+            die("LZ4F_createDecompressionContext() failed: "
+                << LZ4F_getErrorName(ret));
+
+        // input buffer
+        buffer_.resize(256 * 1024);
+
+        initialized_ = true;
+    }
+
+    ~Lz4ReadFilter() {
+        close();
+    }
+
+    ssize_t read(void* data, size_t size) final {
+        char* cdata = reinterpret_cast<char*>(data);
+        size_t done = 0;
+
+        while (done != size) {
+            if (in_pos_ == in_end_ && !flush_) {
+                // input buffer empty, so read from input_
+                ssize_t rb = input_->read(buffer_.data(), buffer_.size());
+                if (rb < 0)
+                    throw common::ErrnoException("Lz4ReadFilter: read error");
+                if (rb == 0)
+                    break;
+                in_pos_ = 0;
+                in_end_ = rb;
+            }
+
+            size_t out_size = size - done;
+            size_t in_size = in_end_ - in_pos_;
+            size_t ret = LZ4F_decompress(
+                dctx_, cdata + done, &out_size,
+                buffer_.data() + in_pos_, &in_size, nullptr);
+            if (LZ4F_isError(ret))
+                die("LZ4F_decompress() failed: " << LZ4F_getErrorName(ret));
+
+            in_pos_ += in_size;
+            done += out_size;
+
+            // if the output is full, the decoder may hold more data. Call it
+            // again before reading more input.
+            flush_ = (done == size);
+        }
+
+        return done;
+    }
+
+    void close() final {
+        if (!initialized_) return;
+
+        LZ4F_freeDecompressionContext(dctx_);
+        input_->close();
+
+        initialized_ = false;
+    }
+
+private:
+    //! if dctx_ is initialized
+    bool initialized_ = false;
+
+    //! lz4 frame context
+    LZ4F_dctx* dctx_;
+
+    //! window [in_pos_, in_end_) of unprocessed data in buffer_
+    size_t in_pos_ = 0, in_end_ = 0;
+
+    //! decoder filled the output on the last call
+    bool flush_ = false;
+
+    //! decompression buffer, filled from the input when empty
+    std::vector<char> buffer_;
+
+    //! input stream for reading data from somewhere
+    ReadStreamPtr input_;
+};
+
+ReadStreamPtr MakeLz4ReadFilter(const ReadStreamPtr& stream) {
+    die_unless(stream);
+    return tlx::make_counting<Lz4ReadFilter>(stream);
+}
+
+/******************************************************************************/
+
+#else   // !THRILL_HAVE_LZ4
+
+WriteStreamPtr MakeLz4WriteFilter(const WriteStreamPtr&, int) {
+    die(".lz4 compression is not available, "
+        "because Thrill was built without liblz4.");
+}
+
+ReadStreamPtr MakeLz4ReadFilter(const ReadStreamPtr&) {
+    die(".lz4 decompression is not available, "
+        "because Thrill was built without liblz4.");
+}
+
+#endif
+
+} // namespace vfs
+} // namespace thrill
+
+/******************************************************************************/
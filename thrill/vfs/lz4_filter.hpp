@@ -0,0 +1,31 @@
+/*******************************************************************************
+ * thrill/vfs/lz4_filter.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_VFS_LZ4_FILTER_HEADER
+#define THRILL_VFS_LZ4_FILTER_HEADER
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <string>
+
+namespace thrill {
+namespace vfs {
+
+ReadStreamPtr MakeLz4ReadFilter(const ReadStreamPtr& stream);
+
+//! Compress into the LZ4 frame format, as written by the lz4 tool. Levels of
+//! three and above use the slower high compression mode.
+WriteStreamPtr MakeLz4WriteFilter(const WriteStreamPtr& stream, int level = 0);
+
+} // namespace vfs
+} // namespace thrill
+
+#endif // !THRILL_VFS_LZ4_FILTER_HEADER
+
+/******************************************************************************/
@@ -15,6 +15,7 @@
 #include <thrill/common/string.hpp>
 
 #include <tlx/die.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
 #include <tlx/string/split.hpp>
 #include <tlx/string/starts_with.hpp>
 
@@ -23,8 +24,16 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -224,6 +233,7 @@ private:
             fi.type = Type::File;
             fi.path = path_prefix_ + contents[i].key;
             fi.size = contents[i].size;
+            fi.mtime = static_cast<uint64_t>(contents[i].lastModified);
             filelist_.emplace_back(fi);
         }
         for (int i = 0; i < common_prefixes_count; ++i) {
@@ -289,38 +299,59 @@ void S3Glob(const std::string& _path, const GlobType& gtype,
 /******************************************************************************/
 // Stream Reading from S3
 
+//! process-wide counters of S3ReadStream requests
+static std::atomic<uint64_t> s_read_requests { 0 };
+static std::atomic<uint64_t> s_read_retries { 0 };
+static std::atomic<uint64_t> s_read_bytes { 0 };
+
+S3ReadStats S3GetReadStats() {
+    S3ReadStats stats;
+    stats.requests = s_read_requests;
+    stats.retries = s_read_retries;
+    stats.bytes = s_read_bytes;
+    return stats;
+}
+
 class S3ReadStream : public ReadStream
 {
 public:
     S3ReadStream(const std::string& bucket, const std::string& key,
                  const S3GetConditions* get_conditions,
                  uint64_t start_byte, uint64_t byte_count)
-        : bucket_(bucket), key_(key) {
+        : bucket_(bucket), key_(key), get_conditions_(get_conditions),
+          next_offset_(start_byte) {
 
         // construct bucket
-        S3BucketContext bucket_context;
-        FillS3BucketContext(bucket_context, bucket_);
+        FillS3BucketContext(bucket_context_, bucket_);
 
         // construct handlers
-        S3GetObjectHandler handler;
-        memset(&handler, 0, sizeof(handler));
+        memset(&handler_, 0, sizeof(handler_));
 
-        handler.responseHandler.propertiesCallback =
+        handler_.responseHandler.propertiesCallback =
             &ResponsePropertiesCallback;
-        handler.responseHandler.completeCallback =
+        handler_.responseHandler.completeCallback =
             &S3ReadStream::ResponseCompleteCallback;
-        handler.getObjectDataCallback = &S3ReadStream::GetObjectDataCallback;
+        handler_.getObjectDataCallback = &S3ReadStream::GetObjectDataCallback;
+
+        if (const char* env_parallel = getenv("THRILL_S3_READ_PARALLEL"))
+            parallel_ = std::max(1, atoi(env_parallel));
+
+        if (const char* env_chunk = getenv("THRILL_S3_READ_CHUNK")) {
+            uint64_t chunk;
+            if (tlx::parse_si_iec_units(env_chunk, &chunk) && chunk != 0)
+                chunk_size_ = chunk;
+        }
+
+        // ranges must be known to split them, query object size if open-ended
+        end_offset_ = byte_count != 0 ? start_byte + byte_count : ObjectSize();
 
         // create request context
         S3Status status = S3_create_request_context(&req_ctx_);
         if (status != S3StatusOK || req_ctx_ == nullptr)
             die("S3_create_request_context() failed.");
 
-        // issue request but do not wait for data
-        S3_get_object(
-            &bucket_context, key_.c_str(), get_conditions,
-            start_byte, byte_count, /* request_context */ req_ctx_,
-            /* timeoutMs */ 0, &handler, this);
+        // issue requests but do not wait for data
+        IssueRequests();
     }
 
     //! simpler constructor
@@ -341,124 +372,230 @@ public:
     ssize_t read(void* data, size_t size) final {
         assert(req_ctx_);
 
-        if (status_ != S3StatusOK)
-            die("S3-ERROR during read: " << S3_get_status_name(status_));
-
-        status_ = S3StatusOK;
         uint8_t* output_begin = reinterpret_cast<uint8_t*>(data);
-        output_ = output_begin;
-        output_end_ = output_ + size;
-
-        // copy data from reception buffer
-        size_t wb = std::min(size, buffer_.size());
-        std::copy(buffer_.begin(), buffer_.begin() + wb, output_);
-        output_ += wb;
-        buffer_.erase(buffer_.begin(), buffer_.begin() + wb);
-
-        // wait for more callbacks to deliver data, use select() to wait
-        int remaining_requests = 1;
-        while (status_ == S3StatusOK &&
-               output_ < output_end_ && remaining_requests)
+        uint8_t* output = output_begin;
+        uint8_t* output_end = output + size;
+
+        // deliver chunks in order, only wait if nothing was delivered yet
+        while (output < output_end && !chunks_.empty())
         {
-            // perform a select() waiting on new data
-            fd_set read_fds, write_fds, except_fds;
-            FD_ZERO(&read_fds);
-            FD_ZERO(&write_fds);
-            FD_ZERO(&except_fds);
-            int max_fd;
-
-            S3Status status = S3_get_request_context_fdsets(
-                req_ctx_, &read_fds, &write_fds, &except_fds, &max_fd);
-            die_unless(status == S3StatusOK);
-
-            if (max_fd != -1) {
-                int64_t timeout = S3_get_request_context_timeout(req_ctx_);
-                struct timeval tv = { timeout / 1000, (timeout % 1000) * 1000 };
-                int r = select(max_fd + 1, &read_fds, &write_fds, &except_fds,
-                               /* timeout */ (timeout == -1) ? 0 : &tv);
-                die_unless(r >= 0);
+            Chunk& c = *chunks_.front();
+
+            size_t wb = std::min(
+                static_cast<size_t>(output_end - output),
+                c.data.size() - c.pos);
+            std::copy(c.data.begin() + c.pos, c.data.begin() + c.pos + wb,
+                      output);
+            output += wb;
+            c.pos += wb;
+
+            if (c.done && c.status == S3StatusOK && c.pos == c.data.size()) {
+                chunks_.pop_front();
+                IssueRequests();
+            }
+            else if (output == output_begin) {
+                Wait();
+            }
+            else {
+                break;
             }
-
-            // run callbacks
-            S3_runonce_request_context(req_ctx_, &remaining_requests);
         }
 
-        return output_ - output_begin;
+        return output - output_begin;
     }
 
     void close() final {
         if (req_ctx_ == nullptr) return;
 
+        sLOG << "S3ReadStream: closed" << key_
+             << "requests" << requests_ << "retries" << retries_;
+
         S3_destroy_request_context(req_ctx_);
         req_ctx_ = nullptr;
+        chunks_.clear();
     }
 
 private:
+    //! a ranged GET request of the stream and its received data
+    struct Chunk {
+        //! byte range of the request in the object
+        uint64_t offset, size;
+        //! received data
+        std::vector<uint8_t> data;
+        //! bytes delivered to read()
+        size_t pos = 0;
+        //! request finished with status
+        bool done = false;
+        S3Status status = S3StatusOK;
+        //! number of retries
+        size_t retries = 0;
+    };
+
+    //! maximum number of retries of a failed chunk request
+    static constexpr size_t max_retries = 5;
+
     //! request context for waiting on more data
     S3RequestContext* req_ctx_ = nullptr;
 
-    //! status of request
-    S3Status status_ = S3StatusOK;
-
     //! bucket for upload
     std::string bucket_;
 
     //! bucket key for upload
     std::string key_;
 
-    //! reception buffer containing unneeded bytes from callback
-    std::vector<uint8_t> buffer_;
+    //! bucket context for requests, references bucket_
+    S3BucketContext bucket_context_;
 
-    //! output buffer for read()
-    uint8_t* output_;
+    //! handlers of GET requests
+    S3GetObjectHandler handler_;
 
-    //! end of output buffer for read()
-    uint8_t* output_end_;
+    //! conditions of GET requests
+    const S3GetConditions* get_conditions_;
 
-    /**************************************************************************/
+    //! number of concurrent ranged GET requests, bounds the read-ahead
+    size_t parallel_ = 4;
 
-    //! completion callback, check for errors
-    void ResponseCompleteCallback(
-        S3Status status, const S3ErrorDetails* error) {
-        status_ = status;
+    //! size of each ranged GET request
+    uint64_t chunk_size_ = 8 * 1024 * 1024;
 
-        if (status != S3StatusOK && status != S3StatusInterrupted)
-            LibS3LogError(status, error);
+    //! next offset and end of the byte range to request
+    uint64_t next_offset_, end_offset_;
+
+    //! outstanding and received chunks in order of their offsets
+    std::deque<std::unique_ptr<Chunk> > chunks_;
+
+    //! number of requests and retries of this stream
+    size_t requests_ = 0, retries_ = 0;
+
+    //! return object size with a blocking HEAD request
+    uint64_t ObjectSize() {
+        S3ResponseHandler handler;
+        memset(&handler, 0, sizeof(handler));
+        handler.propertiesCallback = &S3ReadStream::HeadPropertiesCallback;
+        handler.completeCallback = &S3ReadStream::HeadCompleteCallback;
+
+        std::pair<uint64_t, S3Status> result(0, S3StatusOK);
+        S3_head_object(&bucket_context_, key_.c_str(),
+                       /* request_context */ nullptr, /* timeoutMs */ 0,
+                       &handler, &result);
+        if (result.second != S3StatusOK)
+            die("S3-ERROR during head: " << S3_get_status_name(result.second));
+        return result.first;
     }
 
-    //! static wrapper to call
-    static void ResponseCompleteCallback(
-        S3Status status, const S3ErrorDetails* error, void* cookie) {
-        S3ReadStream* t = reinterpret_cast<S3ReadStream*>(cookie);
-        return t->ResponseCompleteCallback(status, error);
+    //! fill up to parallel_ chunk requests
+    void IssueRequests() {
+        while (chunks_.size() < parallel_ && next_offset_ < end_offset_) {
+            std::unique_ptr<Chunk> c = std::make_unique<Chunk>();
+            c->offset = next_offset_;
+            c->size = std::min(chunk_size_, end_offset_ - next_offset_);
+            c->data.reserve(c->size);
+            next_offset_ += c->size;
+
+            StartRequest(c.get());
+            chunks_.emplace_back(std::move(c));
+        }
     }
 
-    //! callback receiving data
-    S3Status GetObjectDataCallback(int bufferSize, const char* buffer) {
+    //! issue GET request for the remaining bytes of a chunk
+    void StartRequest(Chunk* c) {
+        c->done = false;
+        c->status = S3StatusOK;
 
-        // copy as much data into output_ as fits
-        size_t wb = std::min(
-            output_end_ - output_, static_cast<intptr_t>(bufferSize));
-        std::copy(buffer, buffer + wb, output_);
-        output_ += wb;
+        S3_get_object(
+            &bucket_context_, key_.c_str(), get_conditions_,
+            c->offset + c->data.size(), c->size - c->data.size(),
+            /* request_context */ req_ctx_, /* timeoutMs */ 0, &handler_, c);
 
-        // store remaining unneeded bytes in buffer_
-        if (wb != static_cast<uintptr_t>(bufferSize))
-        {
-            die_unless(output_ == output_end_);
-            die_unless(buffer_.empty());
-            buffer_.resize(bufferSize - wb);
-            std::copy(buffer + wb, buffer + bufferSize, buffer_.data());
+        ++requests_;
+        ++s_read_requests;
+    }
+
+    //! wait for callbacks to deliver data, and retry failed requests
+    void Wait() {
+        // perform a select() waiting on new data
+        fd_set read_fds, write_fds, except_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_ZERO(&except_fds);
+        int max_fd;
+
+        S3Status status = S3_get_request_context_fdsets(
+            req_ctx_, &read_fds, &write_fds, &except_fds, &max_fd);
+        die_unless(status == S3StatusOK);
+
+        if (max_fd != -1) {
+            int64_t timeout = S3_get_request_context_timeout(req_ctx_);
+            struct timeval tv = { timeout / 1000, (timeout % 1000) * 1000 };
+            int r = select(max_fd + 1, &read_fds, &write_fds, &except_fds,
+                           /* timeout */ (timeout == -1) ? 0 : &tv);
+            die_unless(r >= 0);
         }
 
-        return S3StatusOK;
+        // run callbacks
+        int remaining_requests;
+        S3_runonce_request_context(req_ctx_, &remaining_requests);
+
+        // retry failed requests for their remaining bytes
+
+        for (std::unique_ptr<Chunk>& c : chunks_) {
+            if (!c->done || c->status == S3StatusOK) continue;
+
+            if (!S3_status_is_retryable(c->status) ||
+                c->retries >= max_retries) {
+                die("S3-ERROR during read: "
+                    << S3_get_status_name(c->status));
+            }
+
+            LOG1 << "S3-WARNING - retrying read of " << key_
+                 << " at offset " << c->offset + c->data.size()
+                 << " after " << S3_get_status_name(c->status);
+
+            ++c->retries;
+            ++retries_;
+            ++s_read_retries;
+            StartRequest(c.get());
+        }
+
+    }
+
+    /**************************************************************************/
+
+    //! completion callback, check for errors
+    static void ResponseCompleteCallback(
+        S3Status status, const S3ErrorDetails* error, void* cookie) {
+        Chunk* c = reinterpret_cast<Chunk*>(cookie);
+        c->done = true;
+        c->status = status;
+
+        if (status != S3StatusOK && status != S3StatusInterrupted)
+            LibS3LogError(status, error);
     }
 
-    //! static wrapper to call GetObjectDataCallback
+    //! callback receiving data
     static S3Status GetObjectDataCallback(
         int bufferSize, const char* buffer, void* cookie) {
-        S3ReadStream* t = reinterpret_cast<S3ReadStream*>(cookie);
-        return t->GetObjectDataCallback(bufferSize, buffer);
+        Chunk* c = reinterpret_cast<Chunk*>(cookie);
+        c->data.insert(c->data.end(), buffer, buffer + bufferSize);
+        s_read_bytes += bufferSize;
+        return S3StatusOK;
+    }
+
+    //! properties callback of HEAD request, receives object size
+    static S3Status HeadPropertiesCallback(
+        const S3ResponseProperties* properties, void* cookie) {
+        auto* result = reinterpret_cast<std::pair<uint64_t, S3Status>*>(cookie);
+        result->first = properties->contentLength;
+        return ResponsePropertiesCallback(properties, nullptr);
+    }
+
+    //! completion callback of HEAD request
+    static void HeadCompleteCallback(
+        S3Status status, const S3ErrorDetails* error, void* cookie) {
+        auto* result = reinterpret_cast<std::pair<uint64_t, S3Status>*>(cookie);
+        result->second = status;
+        if (status != S3StatusOK)
+            LibS3LogError(status, error);
     }
 };
 
@@ -480,6 +617,20 @@ ReadStreamPtr S3OpenReadStream(
 }
 
 /******************************************************************************/
+// Stream Writing to S3
+
+//! process-wide counters of S3WriteStream part uploads
+static std::atomic<uint64_t> s_write_requests { 0 };
+static std::atomic<uint64_t> s_write_retries { 0 };
+static std::atomic<uint64_t> s_write_bytes { 0 };
+
+S3WriteStats S3GetWriteStats() {
+    S3WriteStats stats;
+    stats.requests = s_write_requests;
+    stats.retries = s_write_retries;
+    stats.bytes = s_write_bytes;
+    return stats;
+}
 
 class S3WriteStream : public WriteStream
 {
@@ -489,8 +640,18 @@ public:
         : bucket_(bucket), key_(key),
           put_properties_(put_properties) {
 
-        S3BucketContext bucket_context;
-        FillS3BucketContext(bucket_context, bucket);
+        FillS3BucketContext(bucket_context_, bucket_);
+
+        if (const char* env_parallel = getenv("THRILL_S3_WRITE_PARALLEL"))
+            parallel_ = std::max(1, atoi(env_parallel));
+
+        if (const char* env_part = getenv("THRILL_S3_PART_SIZE")) {
+            uint64_t part;
+            if (tlx::parse_si_iec_units(env_part, &part) && part != 0) {
+                // S3 requires parts of at least 5 MiB, except the last
+                buffer_max_ = std::max<uint64_t>(part, 5 * 1024 * 1024);
+            }
+        }
 
         // construct handlers
         S3MultipartInitialHandler handler;
@@ -505,8 +666,18 @@ public:
 
         // create new multi part upload
         S3_initiate_multipart(
-            &bucket_context, key_.c_str(), put_properties, &handler,
+            &bucket_context_, key_.c_str(), put_properties, &handler,
             /* request_context */ nullptr, /* timeoutMs */ 0, this);
+
+        if (status_ != S3StatusOK || upload_id_.empty())
+            die("S3-ERROR during initiate multipart upload of " << key_);
+
+        // create request context for the part uploads
+        S3Status status = S3_create_request_context(&req_ctx_);
+        if (status != S3StatusOK || req_ctx_ == nullptr)
+            die("S3_create_request_context() failed.");
+
+        upload_thread_ = std::thread([this]() { UploadThread(); });
     }
 
     ~S3WriteStream() override {
@@ -515,19 +686,20 @@ public:
 
     ssize_t write(const void* _data, size_t size) final {
         const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
+        size_t rest = size;
 
-        while (size > 0)
+        while (rest > 0)
         {
             // copy data to buffer
             size_t buffer_pos = buffer_.size();
-            size_t wb = std::min(size, buffer_max_ - buffer_pos);
+            size_t wb = std::min(rest, buffer_max_ - buffer_pos);
             buffer_.resize(buffer_pos + wb);
             std::copy(data, data + wb, buffer_.data() + buffer_pos);
             data += wb;
-            size -= wb;
+            rest -= wb;
 
-            if (buffer_.size() >= buffer_max_)
-                UploadMultipart();
+            if (buffer_.size() >= buffer_max_ && !EnqueuePart())
+                Abort();
         }
 
         return size;
@@ -536,11 +708,17 @@ public:
     void close() final {
         if (upload_id_.empty()) return;
 
-        // upload last multipart piece
-        if (!buffer_.empty())
-            UploadMultipart();
+        // upload last multipart piece, S3 requires at least one part.
+        if ((!buffer_.empty() || upload_seq_ == 1) && !EnqueuePart())
+            Abort();
+
+        // wait for all parts
+        StopUploadThread();
+        if (!error_.empty())
+            Abort();
 
-        LOG1 << "commit multipart";
+        sLOG << "S3-INFO - commit multipart" << key_
+             << "parts" << part_etag_.size() << "retries" << retries_;
 
         // construct commit XML
 
@@ -555,12 +733,9 @@ public:
         xml << "</CompleteMultipartUpload>";
 
         // put commit message into buffer_
+        Part commit;
         std::string xml_str = xml.str();
-        upload_ = reinterpret_cast<const uint8_t*>(xml_str.data());
-        upload_end_ = upload_ + xml_str.size();
-
-        S3BucketContext bucket_context;
-        FillS3BucketContext(bucket_context, bucket_);
+        commit.data.assign(xml_str.begin(), xml_str.end());
 
         // construct handlers
         S3MultipartCommitHandler handler;
@@ -575,17 +750,43 @@ public:
         handler.responseXmlCallback =
             &S3WriteStream::MultipartCommitResponseCallback;
 
-        // synchronous upload of multi part data
+        // synchronous upload of commit message, the callbacks get the stream
+        // as cookie, which reads commit_.
+        commit_ = &commit;
         S3_complete_multipart_upload(
-            &bucket_context, key_.c_str(), &handler, upload_id_.c_str(),
+            &bucket_context_, key_.c_str(), &handler, upload_id_.c_str(),
             /* content_length */ xml_str.size(),
             /* request_context */ nullptr, /* timeoutMs */ 0, this);
+        commit_ = nullptr;
+
+        if (status_ != S3StatusOK)
+            die("S3-ERROR during commit multipart upload of " << key_);
 
         upload_id_.clear();
     }
 
 private:
-    //! status of request
+    //! a part of the multipart upload and its state
+    struct Part {
+        //! part number, starting with 1
+        int seq = 0;
+        //! content of the part
+        std::vector<uint8_t> data;
+        //! current upload position in data
+        size_t pos = 0;
+        //! ETag returned by S3
+        std::string etag;
+        //! request finished with status
+        bool done = false;
+        S3Status status = S3StatusOK;
+        //! number of retries
+        size_t retries = 0;
+    };
+
+    //! maximum number of retries of a failed part upload
+    static constexpr size_t max_retries = 5;
+
+    //! status of synchronous requests
     S3Status status_ = S3StatusOK;
 
     //! bucket for upload
@@ -594,6 +795,9 @@ private:
     //! bucket key for upload
     std::string key_;
 
+    //! bucket context for requests, references bucket_
+    S3BucketContext bucket_context_;
+
     //! put properties
     S3PutProperties* put_properties_;
 
@@ -606,18 +810,209 @@ private:
     //! block size to upload as multi part
     size_t buffer_max_ = 16 * 1024 * 1024;
 
-    //! output buffer, if this grows to 16 MiB a part upload is initiated.
-    std::vector<uint8_t> buffer_;
-
-    //! current upload position in buffer_ or other memory areas
-    const uint8_t* upload_;
+    //! number of parts uploaded concurrently, further parts wait in write()
+    size_t parallel_ = 4;
 
-    //! end position of upload area
-    const uint8_t* upload_end_;
+    //! output buffer, if this grows to buffer_max_ a part upload is initiated.
+    std::vector<uint8_t> buffer_;
 
     //! list of ETags of uploaded multiparts
     std::vector<std::string> part_etag_;
 
+    //! request context of part uploads, used only by upload_thread_
+    S3RequestContext* req_ctx_ = nullptr;
+
+    //! thread running the part uploads, such that they overlap with write()
+    std::thread upload_thread_;
+
+    //! mutex protecting queued_, num_parts_, closing_, error_, part_etag_
+    std::mutex mutex_;
+
+    //! condition variable signaling new and finished parts
+    std::condition_variable cv_;
+
+    //! parts queued by write(), not yet started by upload_thread_
+    std::deque<std::unique_ptr<Part> > queued_;
+
+    //! number of parts queued or uploading
+    size_t num_parts_ = 0;
+
+    //! no more parts are queued after all are finished
+    bool closing_ = false;
+
+    //! error message of a failed part upload
+    std::string error_;
+
+    //! message of the synchronous commit upload
+    Part* commit_ = nullptr;
+
+    //! number of retries of this stream
+    size_t retries_ = 0;
+
+    //! hand buffer_ to the upload thread, waits if parallel_ are in flight.
+    //! Returns false if a part upload failed.
+    bool EnqueuePart() {
+        std::unique_ptr<Part> p = std::make_unique<Part>();
+        p->seq = upload_seq_++;
+        std::swap(p->data, buffer_);
+        buffer_.reserve(buffer_max_);
+
+        LOG << "S3-INFO - Upload multipart[" << p->seq << "]"
+            << " size " << p->data.size();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() {
+                     return num_parts_ < parallel_ || !error_.empty();
+                 });
+        if (!error_.empty())
+            return false;
+
+        ++num_parts_;
+        queued_.emplace_back(std::move(p));
+        part_etag_.resize(upload_seq_ - 1);
+        cv_.notify_all();
+        return true;
+    }
+
+    //! finish all queued parts and stop the upload thread
+    void StopUploadThread() {
+        if (!upload_thread_.joinable()) return;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            closing_ = true;
+            cv_.notify_all();
+        }
+        upload_thread_.join();
+
+        S3_destroy_request_context(req_ctx_);
+        req_ctx_ = nullptr;
+    }
+
+    //! abandon the multipart upload after a failed part
+    void Abort() {
+        StopUploadThread();
+        upload_id_.clear();
+        die("S3-ERROR during upload of " << key_ << ": " << error_);
+    }
+
+    //! issue asynchronous upload of a part
+    void StartUpload(Part* p) {
+        p->pos = 0;
+        p->done = false;
+        p->status = S3StatusOK;
+
+        S3PutObjectHandler handler;
+        memset(&handler, 0, sizeof(handler));
+
+        handler.responseHandler.propertiesCallback =
+            &S3WriteStream::PartPropertiesCallback;
+        handler.responseHandler.completeCallback =
+            &S3WriteStream::PartCompleteCallback;
+        handler.putObjectDataCallback =
+            &S3WriteStream::PartDataCallback;
+
+        S3_upload_part(&bucket_context_, key_.c_str(), put_properties_,
+                       &handler, p->seq, upload_id_.c_str(),
+                       /* partContentLength */ p->data.size(),
+                       /* request_context */ req_ctx_,
+                       /* timeoutMs */ 0, p);
+
+        ++s_write_requests;
+    }
+
+    //! run part uploads until closing_ is set and all parts are finished
+    void UploadThread() {
+        std::vector<std::unique_ptr<Part> > active;
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]() {
+                         return !active.empty() || !queued_.empty() ||
+                         closing_;
+                     });
+            if (active.empty() && queued_.empty() && closing_)
+                break;
+
+            size_t num_active = active.size();
+            while (!queued_.empty()) {
+                active.emplace_back(std::move(queued_.front()));
+                queued_.pop_front();
+            }
+            lock.unlock();
+
+            for (size_t i = num_active; i < active.size(); ++i)
+                StartUpload(active[i].get());
+
+            Wait();
+
+            // collect finished parts, retry failed ones
+            for (size_t i = 0; i < active.size(); ) {
+                Part* p = active[i].get();
+                if (!p->done) {
+                    ++i;
+                    continue;
+                }
+
+                if (p->status != S3StatusOK &&
+                    S3_status_is_retryable(p->status) &&
+                    p->retries < max_retries) {
+                    LOG1 << "S3-WARNING - retrying upload of " << key_
+                         << " part " << p->seq
+                         << " after " << S3_get_status_name(p->status);
+                    ++p->retries;
+                    ++retries_;
+                    ++s_write_retries;
+                    StartUpload(p);
+                    ++i;
+                    continue;
+                }
+
+                lock.lock();
+                if (p->status == S3StatusOK) {
+                    part_etag_[p->seq - 1] = p->etag;
+                    s_write_bytes += p->data.size();
+                }
+                else if (error_.empty()) {
+                    error_ = S3_get_status_name(p->status);
+                }
+                --num_parts_;
+                cv_.notify_all();
+                lock.unlock();
+
+                active.erase(active.begin() + i);
+            }
+        }
+    }
+
+    //! wait for progress on the part uploads
+    void Wait() {
+        // perform a select() waiting on the connections
+        fd_set read_fds, write_fds, except_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_ZERO(&except_fds);
+        int max_fd;
+
+        S3Status status = S3_get_request_context_fdsets(
+            req_ctx_, &read_fds, &write_fds, &except_fds, &max_fd);
+        die_unless(status == S3StatusOK);
+
+        if (max_fd != -1) {
+            // bounded timeout to pick up newly queued parts
+            int64_t timeout = S3_get_request_context_timeout(req_ctx_);
+            if (timeout == -1 || timeout > 10) timeout = 10;
+            struct timeval tv = { timeout / 1000, (timeout % 1000) * 1000 };
+            int r = select(max_fd + 1, &read_fds, &write_fds, &except_fds,
+                           &tv);
+            die_unless(r >= 0);
+        }
+
+        // run callbacks
+        int remaining_requests;
+        S3_runonce_request_context(req_ctx_, &remaining_requests);
+    }
+
     /**************************************************************************/
 
     //! completion callback, check for errors
@@ -651,65 +1046,46 @@ private:
         return S3StatusOK;
     }
 
-    /**************************************************************************/
-
-    void UploadMultipart() {
-        LOG1 << "S3-INFO - Upload multipart[" << upload_seq_ << "]"
-             << " size " << buffer_.size();
-
-        S3BucketContext bucket_context;
-        FillS3BucketContext(bucket_context, bucket_);
-
-        // construct handlers
-        S3PutObjectHandler handler;
-        memset(&handler, 0, sizeof(handler));
-
-        handler.responseHandler.propertiesCallback =
-            &S3WriteStream::MultipartPropertiesCallback;
-        handler.responseHandler.completeCallback =
-            &S3WriteStream::ResponseCompleteCallback;
-        handler.putObjectDataCallback =
-            &S3WriteStream::PutObjectDataCallback;
-
-        // synchronous upload of multi part data
-        upload_ = buffer_.data();
-        upload_end_ = buffer_.data() + buffer_.size();
-        S3_upload_part(&bucket_context, key_.c_str(), put_properties_,
-                       &handler, upload_seq_++, upload_id_.c_str(),
-                       /* partContentLength */ buffer_.size(),
-                       /* request_context */ nullptr,
-                       /* timeoutMs */ 0, this);
-
-        buffer_.clear();
+    //! data callback of the commit message
+    static int PutObjectDataCallback(
+        int bufferSize, char* buffer, void* cookie) {
+        S3WriteStream* t = reinterpret_cast<S3WriteStream*>(cookie);
+        return PartDataCallback(bufferSize, buffer, t->commit_);
     }
 
-    S3Status MultipartPropertiesCallback(
-        const S3ResponseProperties* properties) {
+    /**************************************************************************/
 
-        part_etag_.emplace_back(properties->eTag);
+    //! properties callback of part uploads, receives ETag
+    static S3Status PartPropertiesCallback(
+        const S3ResponseProperties* properties, void* cookie) {
+        Part* p = reinterpret_cast<Part*>(cookie);
+        if (properties->eTag != nullptr)
+            p->etag = properties->eTag;
         // output properties
         ResponsePropertiesCallback(properties, nullptr);
         return S3StatusOK;
     }
 
-    static S3Status MultipartPropertiesCallback(
-        const S3ResponseProperties* properties, void* cookie) {
-        S3WriteStream* t = reinterpret_cast<S3WriteStream*>(cookie);
-        return t->MultipartPropertiesCallback(properties);
-    }
+    //! completion callback of part uploads
+    static void PartCompleteCallback(
+        S3Status status, const S3ErrorDetails* error, void* cookie) {
+        Part* p = reinterpret_cast<Part*>(cookie);
+        p->done = true;
+        p->status = status;
 
-    int PutObjectDataCallback(int bufferSize, char* buffer) {
-        size_t wb = std::min(
-            static_cast<intptr_t>(bufferSize), upload_end_ - upload_);
-        std::copy(upload_, upload_ + wb, buffer);
-        upload_ += wb;
-        return wb;
+        if (status != S3StatusOK)
+            LibS3LogError(status, error);
     }
 
-    static int PutObjectDataCallback(
-        int bufferSize, char* buffer, void* cookie) {
-        S3WriteStream* t = reinterpret_cast<S3WriteStream*>(cookie);
-        return t->PutObjectDataCallback(bufferSize, buffer);
+    //! data callback of part uploads
+    static int PartDataCallback(int bufferSize, char* buffer, void* cookie) {
+        Part* p = reinterpret_cast<Part*>(cookie);
+        size_t wb = std::min(static_cast<size_t>(bufferSize),
+                             p->data.size() - p->pos);
+        std::copy(p->data.begin() + p->pos, p->data.begin() + p->pos + wb,
+                  buffer);
+        p->pos += wb;
+        return static_cast<int>(wb);
     }
 };
 
@@ -744,6 +1120,14 @@ ReadStreamPtr S3OpenReadStream(
     die("s3:// is not available, because Thrill was built without libS3.");
 }
 
+S3ReadStats S3GetReadStats() {
+    return S3ReadStats();
+}
+
+S3WriteStats S3GetWriteStats() {
+    return S3WriteStats();
+}
+
 WriteStreamPtr S3OpenWriteStream(const std::string& /* path */) {
     die("s3:// is not available, because Thrill was built without libS3.");
 }
@@ -28,12 +28,42 @@ void S3Deinitialize();
 
 void S3Glob(const std::string& path, const GlobType& gtype, FileList& filelist);
 
+//! Open object for reading. The range is fetched with several concurrent
+//! ranged GET requests of THRILL_S3_READ_CHUNK bytes (default 8 MiB), at most
+//! THRILL_S3_READ_PARALLEL (default 4) of which are outstanding or buffered.
 ReadStreamPtr S3OpenReadStream(
     const std::string& path, const common::Range& range = common::Range());
 
+//! Open object for writing with a multipart upload. Parts of
+//! THRILL_S3_PART_SIZE bytes (default 16 MiB, at least 5 MiB) are uploaded by a
+//! background thread, at most THRILL_S3_WRITE_PARALLEL (default 4) at once.
 WriteStreamPtr S3OpenWriteStream(
     const std::string& path);
 
+//! process-wide statistics of S3 read streams
+struct S3ReadStats {
+    //! number of ranged GET requests issued, including retries
+    uint64_t requests = 0;
+    //! number of retried requests
+    uint64_t retries = 0;
+    //! bytes received
+    uint64_t bytes = 0;
+};
+
+S3ReadStats S3GetReadStats();
+
+//! process-wide statistics of S3 write streams
+struct S3WriteStats {
+    //! number of part upload requests issued, including retries
+    uint64_t requests = 0;
+    //! number of retried part uploads
+    uint64_t retries = 0;
+    //! bytes uploaded in parts
+    uint64_t bytes = 0;
+};
+
+S3WriteStats S3GetWriteStats();
+
 } // namespace vfs
 } // namespace thrill
 
@@ -19,6 +19,7 @@
 
 #include <tlx/die.hpp>
 #include <tlx/string/ends_with.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
 
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -44,6 +45,11 @@
 #endif
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -78,6 +84,10 @@ static void SysGlobWalkRecursive(const std::string& path, FileList& filelist) {
             fi.path = path + "\\" + ff.cFileName;
             fi.size = (static_cast<uint64_t>(ff.nFileSizeHigh) * (MAXDWORD + 1))
                       + static_cast<uint64_t>(ff.nFileSizeLow);
+            // FILETIME counts 100ns intervals since 1601-01-01
+            const FILETIME& ft = ff.ftLastWriteTime;
+            fi.mtime = ((static_cast<uint64_t>(ft.dwHighDateTime) << 32)
+                        | ft.dwLowDateTime) / 10000000 - 11644473600ull;
             tmp_list.emplace_back(fi);
         }
     } while (FindNextFile(h, &ff) != 0);
@@ -135,6 +145,7 @@ static void SysGlobWalkRecursive(const std::string& path, FileList& filelist) {
             fi.type = Type::File;
             fi.path = entry;
             fi.size = static_cast<uint64_t>(st.st_size);
+            fi.mtime = static_cast<uint64_t>(st.st_mtime);
             filelist.emplace_back(fi);
         }
     }
@@ -180,6 +191,7 @@ void SysGlob(const std::string& path, const GlobType& gtype,
                 fi.type = Type::File;
                 fi.path = file;
                 fi.size = static_cast<uint64_t>(filestat.st_size);
+                fi.mtime = static_cast<uint64_t>(filestat.st_mtime);
                 filelist.emplace_back(fi);
             }
         }
@@ -320,6 +332,218 @@ void SysFile::close() {
 
 /******************************************************************************/
 
+#if !defined(_MSC_VER)
+
+/*!
+ * Reads a regular file in large aligned blocks with pread(), while the next
+ * block is read by an asynchronous task. The file is either opened with
+ * O_DIRECT, which bypasses the page cache, or the page cache is told to drop
+ * each block after reading it with posix_fadvise(). Both keep scans of large
+ * inputs from evicting the page cache, which is used for spill files.
+ */
+class SysDirectReadFile final : public virtual ReadStream
+{
+    static constexpr bool debug = false;
+
+public:
+    //! O_DIRECT requires aligned file offsets, buffer addresses, and sizes.
+    static constexpr size_t alignment = 4096;
+
+    //! read fd from byte offset on, using O_DIRECT if direct.
+    SysDirectReadFile(int fd, uint64_t offset, size_t block_size, bool direct)
+        : fd_(fd), direct_(direct),
+          block_size_((block_size + alignment - 1) / alignment * alignment),
+          file_pos_(offset - offset % alignment),
+          skip_(offset % alignment) {
+
+        for (size_t i = 0; i < 2; ++i) {
+            if (posix_memalign(reinterpret_cast<void**>(&buffer_[i]),
+                               alignment, block_size_) != 0)
+                throw std::bad_alloc();
+        }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        Prefetch();
+    }
+
+    //! non-copyable: delete copy-constructor
+    SysDirectReadFile(const SysDirectReadFile&) = delete;
+    //! non-copyable: delete assignment operator
+    SysDirectReadFile& operator = (const SysDirectReadFile&) = delete;
+
+    ~SysDirectReadFile() {
+        close();
+        free(buffer_[0]);
+        free(buffer_[1]);
+    }
+
+    ssize_t read(void* data, size_t count) final {
+        uint8_t* cdata = reinterpret_cast<uint8_t*>(data);
+        size_t done = 0;
+        while (done < count) {
+            if (pos_ == end_ && !NextBlock())
+                break;
+            size_t n = std::min(count - done, end_ - pos_);
+            memcpy(cdata + done, buffer_[current_] + pos_, n);
+            pos_ += n, done += n;
+        }
+        return done;
+    }
+
+    void close() final {
+        if (fd_ < 0) return;
+        // wait for the outstanding read, it writes into our buffer.
+        if (next_.valid())
+            next_.wait();
+        sLOG << "SysDirectReadFile::close(): fd" << fd_;
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    //! file descriptor
+    int fd_;
+
+    //! true, if fd_ was opened with O_DIRECT, else drop pages after reading.
+    bool direct_;
+
+    //! size of the blocks read, a multiple of alignment
+    size_t block_size_;
+
+    //! file offset of the next block to read
+    uint64_t file_pos_;
+
+    //! bytes to skip in the first block to get to the requested offset
+    size_t skip_;
+
+    //! two aligned buffers: one is consumed, the next block is read into the
+    //! other.
+    uint8_t* buffer_[2] = { nullptr, nullptr };
+
+    //! index of buffer currently consumed
+    size_t current_ = 1;
+
+    //! range [pos_,end_) of unconsumed data in current buffer
+    size_t pos_ = 0, end_ = 0;
+
+    //! outstanding read of the next block, returns size or -errno.
+    std::future<ssize_t> next_;
+
+    //! a short read was seen, there are no more blocks
+    bool eof_ = false;
+
+    //! start reading the next block into the buffer not consumed.
+    void Prefetch() {
+        int fd = fd_;
+        bool direct = direct_;
+        uint8_t* buffer = buffer_[current_ ^ 1];
+        size_t size = block_size_;
+        uint64_t offset = file_pos_;
+
+        next_ = std::async(
+            std::launch::async, [=]() -> ssize_t {
+                ssize_t rb;
+                do {
+                    rb = ::pread(fd, buffer, size, offset);
+                } while (rb < 0 && errno == EINTR);
+                if (rb < 0)
+                    return -errno;
+#if defined(POSIX_FADV_DONTNEED)
+                // the data was copied into our buffer, drop it from the cache
+                if (!direct && rb > 0)
+                    posix_fadvise(fd, offset, rb, POSIX_FADV_DONTNEED);
+#endif
+                return rb;
+            });
+
+        file_pos_ += block_size_;
+    }
+
+    //! wait for the outstanding read and switch buffers. Returns false at the
+    //! end of the file.
+    bool NextBlock() {
+        if (eof_) return false;
+
+        ssize_t rb = next_.get();
+        if (rb < 0) {
+            throw common::ErrnoException(
+                      "SysDirectReadFile: pread() failed", static_cast<int>(-rb));
+        }
+
+        current_ ^= 1;
+        end_ = static_cast<size_t>(rb);
+        pos_ = std::min(skip_, end_);
+        skip_ = 0;
+
+        // regular files only return short reads at the end
+        if (end_ < block_size_)
+            eof_ = true;
+        else
+            Prefetch();
+
+        LOG << "SysDirectReadFile: read block of " << rb << " bytes";
+        return true;
+    }
+};
+
+//! read modes for regular files selected by THRILL_SYS_READ_MODE
+enum class SysReadMode { Plain, Direct, NoCache };
+
+static SysReadMode GetSysReadMode() {
+    const char* env_mode = getenv("THRILL_SYS_READ_MODE");
+    if (env_mode == nullptr || *env_mode == 0)
+        return SysReadMode::Plain;
+    if (strcmp(env_mode, "direct") == 0)
+        return SysReadMode::Direct;
+    if (strcmp(env_mode, "nocache") == 0)
+        return SysReadMode::NoCache;
+    die("THRILL_SYS_READ_MODE must be empty, \"direct\", or \"nocache\"");
+}
+
+static size_t GetSysReadBlockSize() {
+    uint64_t size = 8 * 1024 * 1024;
+    if (const char* env_block = getenv("THRILL_SYS_READ_BLOCK")) {
+        if (!tlx::parse_si_iec_units(env_block, &size) || size == 0)
+            die("THRILL_SYS_READ_BLOCK is not a valid size: " << env_block);
+    }
+    return size;
+}
+
+//! open a regular file in fd using SysDirectReadFile if selected by
+//! THRILL_SYS_READ_MODE, otherwise returns nullptr.
+static ReadStreamPtr SysOpenDirectReadStream(
+    int fd, const common::Range& range) {
+
+    static constexpr bool debug = false;
+
+    SysReadMode mode = GetSysReadMode();
+    if (mode == SysReadMode::Plain)
+        return ReadStreamPtr();
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return ReadStreamPtr();
+
+    bool direct = false;
+#if defined(O_DIRECT)
+    if (mode == SysReadMode::Direct) {
+        // not all file systems support O_DIRECT, then fall back to nocache.
+        int flags = fcntl(fd, F_GETFL);
+        direct = (flags >= 0 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0);
+        sLOG << "SysOpenDirectReadStream(): O_DIRECT" << direct;
+    }
+#endif
+
+    return tlx::make_counting<SysDirectReadFile>(
+        fd, range.begin, GetSysReadBlockSize(), direct);
+}
+
+#endif  // !defined(_MSC_VER)
+
+/******************************************************************************/
+
 ReadStreamPtr SysOpenReadStream(
     const std::string& path, const common::Range& range) {
 
@@ -342,15 +566,27 @@ ReadStreamPtr SysOpenReadStream(
     else if (tlx::ends_with(path, ".lzo")) {
         decompressor = "lzop";
     }
+#if !THRILL_HAVE_LZ4
     else if (tlx::ends_with(path, ".lz4")) {
         decompressor = "lz4";
     }
+#endif
+#if !THRILL_HAVE_ZSTD
+    else if (tlx::ends_with(path, ".zst")) {
+        decompressor = "zstd";
+    }
+#endif
     else {
         // not a compressed file
         common::PortSetCloseOnExec(fd);
 
         sLOG << "SysFile::OpenForRead(): filefd" << fd;
 
+#if !defined(_MSC_VER)
+        if (ReadStreamPtr stream = SysOpenDirectReadStream(fd, range))
+            return stream;
+#endif
+
         if (range.begin) {
             //! POSIX lseek function from current position.
             ::lseek(fd, range.begin, SEEK_CUR);
@@ -432,9 +668,16 @@ WriteStreamPtr SysOpenWriteStream(const std::string& path) {
     else if (tlx::ends_with(path, ".lzo")) {
         compressor = "lzop";
     }
+#if !THRILL_HAVE_LZ4
     else if (tlx::ends_with(path, ".lz4")) {
         compressor = "lz4";
     }
+#endif
+#if !THRILL_HAVE_ZSTD
+    else if (tlx::ends_with(path, ".zst")) {
+        compressor = "zstd";
+    }
+#endif
     else {
         // not a compressed file
         common::PortSetCloseOnExec(fd);
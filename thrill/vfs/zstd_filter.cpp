@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * thrill/vfs/zstd_filter.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/vfs/zstd_filter.hpp>
+
+#include <thrill/common/logger.hpp>
+#include <thrill/common/system_exception.hpp>
+
+#include <tlx/die.hpp>
+
+#if THRILL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <vector>
+
+namespace thrill {
+namespace vfs {
+
+#if THRILL_HAVE_ZSTD
+
+/******************************************************************************/
+// ZstdWriteFilter - on-the-fly zstd compressor
+
+class ZstdWriteFilter final : public virtual WriteStream
+{
+public:
+    ZstdWriteFilter(const WriteStreamPtr& output, int level, unsigned threads)
+        : output_(output) {
+        cctx_ = ZSTD_createCCtx();
+        die_unless(cctx_);
+
+        size_t ret = ZSTD_CCtx_setParameter(
+            cctx_, ZSTD_c_compressionLevel, level);
+        if (ZSTD_isError(ret))
+            die("ZSTD_CCtx_setParameter() failed: " << ZSTD_getErrorName(ret));
+
+        if (threads != 0) {
+            ret = ZSTD_CCtx_setParameter(
+                cctx_, ZSTD_c_nbWorkers, static_cast<int>(threads));
+            if (ZSTD_isError(ret)) {
+                LOG1 << "ZstdWriteFilter: libzstd does not support"
+                     << " multi-threaded compression, using one thread.";
+            }
+        }
+
+        // output buffer
+        buffer_.resize(ZSTD_CStreamOutSize());
+
+        initialized_ = true;
+    }
+
+    ~ZstdWriteFilter() {
+        close();
+    }
+
+    ssize_t write(const void* data, const size_t size) final {
+        ZSTD_inBuffer input = { data, size, 0 };
+        while (input.pos != input.size)
+            Compress(&input, ZSTD_e_continue);
+        return size;
+    }
+
+    void close() final {
+        if (!initialized_) return;
+
+        ZSTD_inBuffer input = { nullptr, 0, 0 };
+        while (Compress(&input, ZSTD_e_end) != 0) { }
+
+        output_->close();
+
+        ZSTD_freeCCtx(cctx_);
+        initialized_ = false;
+    }
+
+private:
+    static constexpr bool debug = false;
+
+    //! if cctx_ is initialized
+    bool initialized_;
+
+    //! zstd context
+    ZSTD_CCtx* cctx_;
+
+    //! compression buffer, flushed to output after each call
+    std::vector<char> buffer_;
+
+    //! output stream for writing data somewhere
+    WriteStreamPtr output_;
+
+    //! run compressor once and write the output, returns zstd's estimate of
+    //! the remaining bytes to flush.
+    size_t Compress(ZSTD_inBuffer* input, ZSTD_EndDirective mode) {
+        ZSTD_outBuffer output = { buffer_.data(), buffer_.size(), 0 };
+        size_t ret = ZSTD_compressStream2(cctx_, &output, input, mode);
+        if (ZSTD_isError(ret))
+            die("ZSTD_compressStream2() failed: " << ZSTD_getErrorName(ret));
+
+        if (output.pos != 0)
+            output_->write(buffer_.data(), output.pos);
+        return ret;
+    }
+};
+
+WriteStreamPtr MakeZstdWriteFilter(
+    const WriteStreamPtr& stream, int level, unsigned threads) {
+    die_unless(stream);
+    return tlx::make_counting<ZstdWriteFilter>(stream, level, threads);
+}
+
+/******************************************************************************/
+// ZstdReadFilter - on-the-fly zstd decompressor
+
+class ZstdReadFilter : public virtual ReadStream
+{
+public:
+    explicit ZstdReadFilter(const ReadStreamPtr& input)
+        : input_(input) {
+        dctx_ = ZSTD_createDCtx();
+        die_unless(dctx_);
+
+        // input buffer
+        buffer_.resize(ZSTD_DStreamInSize());
+        zinput_ = ZSTD_inBuffer { buffer_.data(), 0, 0 };
+
+        initialized_ = true;
+    }
+
+    ~ZstdReadFilter() {
+        close();
+    }
+
+    ssize_t read(void* data, size_t size) final {
+        ZSTD_outBuffer output = { data, size, 0 };
+
+        while (output.pos != output.size) {
+            if (zinput_.pos == zinput_.size && !flush_) {
+                // input buffer empty, so read from input_
+                ssize_t rb = input_->read(buffer_.data(), buffer_.size());
+                if (rb < 0)
+                    throw common::ErrnoException("ZstdReadFilter: read error");
+                if (rb == 0)
+                    break;
+                zinput_ = ZSTD_inBuffer { buffer_.data(), size_t(rb), 0 };
+            }
+
+            size_t ret = ZSTD_decompressStream(dctx_, &output, &zinput_);
+            if (ZSTD_isError(ret)) {
+                die("ZSTD_decompressStream() failed: "
+                    << ZSTD_getErrorName(ret));
+            }
+
+            // if the output is full, the decoder may hold more data. Call it
+            // again before reading more input.
+            flush_ = (output.pos == output.size);
+        }
+
+        return output.pos;
+    }
+
+    void close() final {
+        if (!initialized_) return;
+
+        ZSTD_freeDCtx(dctx_);
+        input_->close();
+
+        initialized_ = false;
+    }
+
+private:
+    //! if dctx_ is initialized
+    bool initialized_;
+
+    //! zstd context
+    ZSTD_DCtx* dctx_;
+
+    //! window of unprocessed data in buffer_
+    ZSTD_inBuffer zinput_;
+
+    //! decoder filled the output on the last call
+    bool flush_ = false;
+
+    //! decompression buffer, filled from the input when empty
+    std::vector<char> buffer_;
+
+    //! input stream for reading data from somewhere
+    ReadStreamPtr input_;
+};
+
+ReadStreamPtr MakeZstdReadFilter(const ReadStreamPtr& stream) {
+    die_unless(stream);
+    return tlx::make_counting<ZstdReadFilter>(stream);
+}
+
+/******************************************************************************/
+
+#else   // !THRILL_HAVE_ZSTD
+
+WriteStreamPtr MakeZstdWriteFilter(const WriteStreamPtr&, int, unsigned) {
+    die(".zst compression is not available, "
+        "because Thrill was built without libzstd.");
+}
+
+ReadStreamPtr MakeZstdReadFilter(const ReadStreamPtr&) {
+    die(".zst decompression is not available, "
+        "because Thrill was built without libzstd.");
+}
+
+#endif
+
+} // namespace vfs
+} // namespace thrill
+
+/******************************************************************************/
@@ -0,0 +1,33 @@
+/*******************************************************************************
+ * thrill/vfs/zstd_filter.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_VFS_ZSTD_FILTER_HEADER
+#define THRILL_VFS_ZSTD_FILTER_HEADER
+
+#include <thrill/vfs/file_io.hpp>
+
+#include <string>
+
+namespace thrill {
+namespace vfs {
+
+ReadStreamPtr MakeZstdReadFilter(const ReadStreamPtr& stream);
+
+//! Compress with the given zstd level. If threads is non-zero, zstd compresses
+//! jobs of the input in parallel using that many background threads, which is
+//! ignored if libzstd was built without multi-threading support.
+WriteStreamPtr MakeZstdWriteFilter(const WriteStreamPtr& stream,
+                                   int level = 3, unsigned threads = 0);
+
+} // namespace vfs
+} // namespace thrill
+
+#endif // !THRILL_VFS_ZSTD_FILTER_HEADER
+
+/******************************************************************************/